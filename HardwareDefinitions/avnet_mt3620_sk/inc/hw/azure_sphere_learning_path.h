@@ -45,3 +45,9 @@
 // Blue LED
 #define LED_BLUE AVNET_MT3620_SK_USER_LED_BLUE
 
+// RGB LED PWM controller, channels 0, 1 and 2 are red, green and blue
+#define LED_PWM_CONTROLLER AVNET_MT3620_SK_PWM_CONTROLLER2
+
+// ADC controller 0, the light sensor is on channel 0
+#define ADC_CONTROLLER AVNET_MT3620_SK_ADC_CONTROLLER0
+
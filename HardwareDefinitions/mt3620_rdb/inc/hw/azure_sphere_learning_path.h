@@ -48,3 +48,9 @@
 // MT3620 RDB: LED 1
 #define LED_BLUE MT3620_RDB_LED1_BLUE
 
+// MT3620 RDB: LED 1 PWM controller, channels 0, 1 and 2 are red, green and blue
+#define LED_PWM_CONTROLLER MT3620_RDB_LED_PWM_CONTROLLER2
+
+// MT3620 RDB: ADC controller 0, channels 0 to 7 on pins 41 to 48
+#define ADC_CONTROLLER MT3620_RDB_ADC_CONTROLLER0
+
@@ -38,6 +38,7 @@
 
 // Learning Path Libraries
 #include "azure_iot.h"
+#include "event_loop.h"
 #include "exit_codes.h"
 #include "globals.h"
 #include "peripheral_gpio.h"
@@ -74,8 +75,8 @@ static void ClosePeripheralsAndHandlers(void);
 static void Led1BlinkHandler(EventLoopTimer* eventLoopTimer);
 static void Led2OffHandler(EventLoopTimer* eventLoopTimer);
 static void MeasureSensorHandler(EventLoopTimer* eventLoopTimer);
-static void ButtonPressCheckHandler(EventLoopTimer* eventLoopTimer);
-static void NetworkConnectionStatusHandler(EventLoopTimer* eventLoopTimer);
+static void ButtonPressedHandler(LP_PERIPHERAL_GPIO* peripheralGpio, bool pressed);
+static void NetworkStateChanged(bool networkReady);
 
 static char msgBuffer[JSON_MESSAGE_BYTES] = { 0 };
 
@@ -86,8 +87,8 @@ static const struct timespec led1BlinkIntervals[] = { {0, 125000000}, {0, 250000
 static const int led1BlinkIntervalsCount = NELEMS(led1BlinkIntervals);
 
 // GPIO Input Peripherals
-static LP_PERIPHERAL_GPIO buttonA = { .pin = BUTTON_A, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = "buttonA" };
-static LP_PERIPHERAL_GPIO buttonB = { .pin = BUTTON_B, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = "buttonB" };
+static LP_PERIPHERAL_GPIO buttonA = { .pin = BUTTON_A, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = "buttonA", .onEdge = ButtonPressedHandler };
+static LP_PERIPHERAL_GPIO buttonB = { .pin = BUTTON_B, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = "buttonB", .onEdge = ButtonPressedHandler };
 
 // GPIO Output Peripherals
 static LP_PERIPHERAL_GPIO led1 = { .pin = LED1, .direction = LP_OUTPUT, .initialState = GPIO_Value_Low, .invertPin = true,
@@ -102,13 +103,12 @@ static LP_PERIPHERAL_GPIO networkConnectedLed = { .pin = NETWORK_CONNECTED_LED,
 // Timers
 static LP_TIMER led1BlinkTimer = { .period = { 0, 125000000 }, .name = "led1BlinkTimer", .handler = Led1BlinkHandler };
 static LP_TIMER led2BlinkOffOneShotTimer = { .period = { 0, 0 }, .name = "led2BlinkOffOneShotTimer", .handler = Led2OffHandler };
-static LP_TIMER buttonPressCheckTimer = { .period = { 0, 1000000 }, .name = "buttonPressCheckTimer", .handler = ButtonPressCheckHandler };
-static LP_TIMER networkConnectionStatusTimer = { .period = { 5, 0 }, .name = "networkConnectionStatusTimer", .handler = NetworkConnectionStatusHandler };
 static LP_TIMER measureSensorTimer = { .period = { 10, 0 }, .name = "measureSensorTimer", .handler = MeasureSensorHandler };
+static const struct timespec sensorPrefetchLead = { 0, 250 * 1000000 };	// the sensors are read this far ahead of measureSensorTimer
 
 // Initialize Sets
 LP_PERIPHERAL_GPIO* peripheralSet[] = { &buttonA, &buttonB, &led1, &led2, &networkConnectedLed };
-LP_TIMER* timerSet[] = { &led1BlinkTimer, &led2BlinkOffOneShotTimer, &buttonPressCheckTimer, &networkConnectionStatusTimer, &measureSensorTimer };
+LP_TIMER* timerSet[] = { &led1BlinkTimer, &led2BlinkOffOneShotTimer, &measureSensorTimer };
 
 
 int main(int argc, char* argv[])
@@ -118,15 +118,7 @@ int main(int argc, char* argv[])
 	InitPeripheralsAndHandlers();
 
 	// Main loop
-	while (!lp_isTerminationRequired())
-	{
-		int result = EventLoop_Run(lp_getTimerEventLoop(), -1, true);
-		// Continue if interrupted by signal, e.g. due to breakpoint being set.
-		if (result == -1 && errno != EINTR)
-		{
-			lp_terminate(ExitCode_Main_EventLoopFail);
-		}
-	}
+	lp_runEventLoop();
 
 	ClosePeripheralsAndHandlers();
 
@@ -135,17 +127,11 @@ int main(int argc, char* argv[])
 }
 
 /// <summary>
-/// Check status of connection to Azure IoT
+/// Network ready LED, called by the library when networking readiness changes
 /// </summary>
-static void NetworkConnectionStatusHandler(EventLoopTimer* eventLoopTimer)
+static void NetworkStateChanged(bool networkReady)
 {
-	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
-	{
-		lp_terminate(ExitCode_ConsumeEventLoopTimeEvent);
-		return;
-	}
-
-	if (lp_isNetworkReady())
+	if (networkReady)
 	{
 		lp_gpioOn(&networkConnectedLed);
 	}
@@ -203,24 +189,14 @@ static void MeasureSensorHandler(EventLoopTimer* eventLoopTimer)
 }
 
 /// <summary>
-/// Handler to check for Button Presses
+/// Button A or B pressed or released, debounced by the GPIO scan
 /// </summary>
-static void ButtonPressCheckHandler(EventLoopTimer* eventLoopTimer)
+static void ButtonPressedHandler(LP_PERIPHERAL_GPIO* peripheralGpio, bool pressed)
 {
-	static GPIO_Value_Type buttonAState;
-	static GPIO_Value_Type buttonBState;
+	if (!pressed) { return; }
 
-	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
-	{
-		lp_terminate(ExitCode_ConsumeEventLoopTimeEvent);
-		return;
-	}
-
-	if (lp_gpioGetState(&buttonA, &buttonAState) || lp_gpioGetState(&buttonB, &buttonBState))
-	{
-		led1BlinkIntervalIndex = (led1BlinkIntervalIndex + 1) % led1BlinkIntervalsCount;
-		lp_changeTimer(&led1BlinkTimer, &led1BlinkIntervals[led1BlinkIntervalIndex]);
-	}
+	led1BlinkIntervalIndex = (led1BlinkIntervalIndex + 1) % led1BlinkIntervalsCount;
+	lp_changeTimer(&led1BlinkTimer, &led1BlinkIntervals[led1BlinkIntervalIndex]);
 }
 
 /// <summary>
@@ -252,6 +228,8 @@ static void InitPeripheralsAndHandlers(void)
 
 	lp_openPeripheralGpioSet(peripheralSet, NELEMS(peripheralSet));
 	lp_startTimerSet(timerSet, NELEMS(timerSet));
+	lp_setSensorPrefetch(&measureSensorTimer, &sensorPrefetchLead);	// MeasureSensorHandler sends readings a lead old, never waits on the bus
+	lp_setNetworkStateCallback(NetworkStateChanged);
 }
 
 /// <summary>
@@ -261,6 +239,7 @@ static void ClosePeripheralsAndHandlers(void)
 {
 	Log_Debug("Closing file descriptors\n");
 
+	lp_stopNetworkState();
 	lp_stopTimerSet();
 	lp_closePeripheralGpioSet();
 	lp_closeDevKit();
@@ -38,9 +38,12 @@
 
 // Learning Path Libraries
 #include "azure_iot.h"
+#include "event_loop.h"
 #include "exit_codes.h"
 #include "globals.h"
 #include "peripheral_gpio.h"
+#include "soak_monitor.h"
+#include "synthetic_load.h"
 #include "terminate.h"
 #include "timer.h"
 
@@ -51,6 +54,7 @@
 #include <applibs/powermanagement.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 
 // Hardware specific
@@ -71,7 +75,7 @@
 static void Led1BlinkHandler(EventLoopTimer* eventLoopTimer);
 static void LedOffHandler(EventLoopTimer* eventLoopTimer);
 static void MeasureSensorHandler(EventLoopTimer* eventLoopTimer);
-static void ButtonPressCheckHandler(EventLoopTimer* eventLoopTimer);
+static void ButtonPressedHandler(LP_PERIPHERAL_GPIO* peripheralGpio, bool pressed);
 static void NetworkConnectionStatusHandler(EventLoopTimer* eventLoopTimer);
 
 static char msgBuffer[JSON_MESSAGE_BYTES] = { 0 };
@@ -83,8 +87,8 @@ static const struct timespec led1BlinkIntervals[] = { {0, 125000000}, {0, 250000
 static const int led1BlinkIntervalsCount = NELEMS(led1BlinkIntervals);
 
 // GPIO Input Peripherals
-static LP_PERIPHERAL_GPIO buttonA = { .pin = BUTTON_A, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = "buttonA" };
-static LP_PERIPHERAL_GPIO buttonB = { .pin = BUTTON_B, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = "buttonB" };
+static LP_PERIPHERAL_GPIO buttonA = { .pin = BUTTON_A, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = "buttonA", .onEdge = ButtonPressedHandler };
+static LP_PERIPHERAL_GPIO buttonB = { .pin = BUTTON_B, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = "buttonB", .onEdge = ButtonPressedHandler };
 
 // GPIO Output PeripheralGpios
 static LP_PERIPHERAL_GPIO led1 = { .pin = LED1, .direction = LP_OUTPUT, .initialState = GPIO_Value_Low, .invertPin = true,
@@ -99,13 +103,13 @@ static LP_PERIPHERAL_GPIO networkConnectedLed = { .pin = NETWORK_CONNECTED_LED,
 // Timers
 static LP_TIMER led1BlinkTimer = { .period = { 0, 125000000 }, .name = "led1BlinkTimer", .handler = Led1BlinkHandler };
 static LP_TIMER sendMsgLedOffOneShotTimer = { .period = { 0, 0 }, .name = "sendMsgLedOffOneShotTimer", .handler = LedOffHandler };
-static LP_TIMER buttonPressCheckTimer = { .period = { 0, 1000000 }, .name = "buttonPressCheckTimer", .handler = ButtonPressCheckHandler };
 static LP_TIMER networkConnectionStatusTimer = { .period = { 5, 0 }, .name = "networkConnectionStatusTimer", .handler = NetworkConnectionStatusHandler };
 static LP_TIMER measureSensorTimer = { .period = { 10, 0 }, .name = "measureSensorTimer", .handler = MeasureSensorHandler };
+static const struct timespec sensorPrefetchLead = { 0, 250 * 1000000 };	// the sensors are read this far ahead of measureSensorTimer
 
 // Initialize Sets
 LP_PERIPHERAL_GPIO* peripheralGpioSet[] = { &buttonA, &buttonB, &led1, &sendMsgLed, &networkConnectedLed };
-LP_TIMER* timerSet[] = { &led1BlinkTimer, &sendMsgLedOffOneShotTimer, &buttonPressCheckTimer, &networkConnectionStatusTimer, &measureSensorTimer };
+LP_TIMER* timerSet[] = { &led1BlinkTimer, &sendMsgLedOffOneShotTimer, &networkConnectionStatusTimer, &measureSensorTimer };
 
 // Message templates and property sets
 
@@ -219,26 +223,16 @@ void SendAlertMessage(const char* key, const char* value)
 }
 
 /// <summary>
-/// Handler to check for Button Presses
+/// Button A or B pressed or released, debounced by the GPIO scan
 /// </summary>
-static void ButtonPressCheckHandler(EventLoopTimer* eventLoopTimer)
+static void ButtonPressedHandler(LP_PERIPHERAL_GPIO* peripheralGpio, bool pressed)
 {
-	static GPIO_Value_Type buttonAState;
-	static GPIO_Value_Type buttonBState;
+	if (!pressed) { return; }
 
-	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
-	{
-		lp_terminate(ExitCode_ConsumeEventLoopTimeEvent);
-		return;
-	}
+	led1BlinkIntervalIndex = (led1BlinkIntervalIndex + 1) % led1BlinkIntervalsCount;
+	lp_changeTimer(&led1BlinkTimer, &led1BlinkIntervals[led1BlinkIntervalIndex]);
 
-	if (lp_gpioGetState(&buttonA, &buttonAState) || lp_gpioGetState(&buttonB, &buttonBState))
-	{
-		led1BlinkIntervalIndex = (led1BlinkIntervalIndex + 1) % led1BlinkIntervalsCount;
-		lp_changeTimer(&led1BlinkTimer, &led1BlinkIntervals[led1BlinkIntervalIndex]);
-
-		SendAlertMessage("button_a", "pressed");
-	}
+	SendAlertMessage("button_a", "pressed");
 }
 
 /// <summary>
@@ -267,11 +261,31 @@ static void Led1BlinkHandler(EventLoopTimer* eventLoopTimer)
 /// <returns>0 on success, or -1 on failure</returns>
 static void InitPeripheralsAndHandlers(void)
 {
+	lp_setInitMode(LP_INIT_CONCURRENT);	// provisioning starts on the first event loop pass, the sensors set up alongside it
+	lp_startCloudToDevice();
+
 	lp_initializeDevKit();
+	lp_bootMark("devkit");
 
 	lp_openPeripheralGpioSet(peripheralGpioSet, NELEMS(peripheralGpioSet));
+	lp_bootMark("gpio");
 
 	lp_startTimerSet(timerSet, NELEMS(timerSet));
+	lp_bootMark("timers");
+	lp_setSensorPrefetch(&measureSensorTimer, &sensorPrefetchLead);	// MeasureSensorHandler sends readings a lead old, never waits on the bus
+
+	// optional, add --load=messages=50,bytes=256,seconds=60 to the CmdArgs to stress the telemetry pipeline
+	LP_SYNTHETIC_LOAD load;
+	if (syntheticLoadArgs != NULL && lp_parseSyntheticLoad(syntheticLoadArgs, &load))
+	{
+		lp_startSyntheticLoad(&load);
+	}
+
+	// optional, add --soak=3600 to the CmdArgs, with a --load= or the lab's own telemetry, to watch for slow leaks
+	if (soakArgs != NULL)
+	{
+		lp_startSoakMonitor(atoi(soakArgs));
+	}
 }
 
 /// <summary>
@@ -281,6 +295,8 @@ static void ClosePeripheralsAndHandlers(void)
 {
 	Log_Debug("Closing file descriptors\n");
 
+	lp_stopSoakMonitor();
+	lp_stopSyntheticLoad();
 	lp_stopTimerSet();
 	lp_stopCloudToDevice();
 
@@ -306,15 +322,7 @@ int main(int argc, char* argv[])
 	InitPeripheralsAndHandlers();
 
 	// Main loop
-	while (!lp_isTerminationRequired())
-	{
-		int result = EventLoop_Run(lp_getTimerEventLoop(), -1, true);
-		// Continue if interrupted by signal, e.g. due to breakpoint being set.
-		if (result == -1 && errno != EINTR)
-		{
-			lp_terminate(ExitCode_Main_EventLoopFail);
-		}
-	}
+	lp_runEventLoop();
 
 	ClosePeripheralsAndHandlers();
 
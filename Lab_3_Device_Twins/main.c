@@ -38,6 +38,7 @@
 
 // Learning Path Libraries
 #include "azure_iot.h"
+#include "event_loop.h"
 #include "exit_codes.h"
 #include "globals.h"
 #include "peripheral_gpio.h"
@@ -71,9 +72,11 @@
 static void TemperatureStatusBlinkHandler(EventLoopTimer* eventLoopTimer);
 static void SendMsgLedOffHandler(EventLoopTimer* eventLoopTimer);
 static void MeasureSensorHandler(EventLoopTimer* eventLoopTimer);
-static void ButtonPressCheckHandler(EventLoopTimer* eventLoopTimer);
+static void ButtonPressedHandler(LP_PERIPHERAL_GPIO* peripheralGpio, bool pressed);
 static void NetworkConnectionStatusHandler(EventLoopTimer* eventLoopTimer);
 static void DeviceTwinSetTemperatureHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+static void DeviceTwinSamplingPolicyHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+static void DeviceTwinReconnectBackoffHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
 
 static char msgBuffer[JSON_MESSAGE_BYTES] = { 0 };
 
@@ -91,14 +94,15 @@ static float desired_temperature = 0;
 static float last_temperature = 0;
 
 // GPIO Input PeripheralGpios
-static LP_PERIPHERAL_GPIO buttonA = { .pin = BUTTON_A, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = "buttonA" };
-static LP_PERIPHERAL_GPIO buttonB = { .pin = BUTTON_B, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = "buttonB" };
+static LP_PERIPHERAL_GPIO buttonA = { .pin = BUTTON_A, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = "buttonA", .onEdge = ButtonPressedHandler };
+static LP_PERIPHERAL_GPIO buttonB = { .pin = BUTTON_B, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = "buttonB", .onEdge = ButtonPressedHandler };
 
 // GPIO Output PeripheralGpios
 static LP_PERIPHERAL_GPIO ledRed = { .pin = LED_RED, .direction = LP_OUTPUT, .initialState = GPIO_Value_Low, .invertPin = true, .initialise = lp_openPeripheralGpio, .name = "red led" };
 static LP_PERIPHERAL_GPIO ledGreen = { .pin = LED_GREEN, .direction = LP_OUTPUT, .initialState = GPIO_Value_Low, .invertPin = true, .initialise = lp_openPeripheralGpio, .name = "green led" };
 static LP_PERIPHERAL_GPIO ledBlue = { .pin = LED_BLUE, .direction = LP_OUTPUT, .initialState = GPIO_Value_Low, .invertPin = true, .initialise = lp_openPeripheralGpio, .name = "blue led" };
 static LP_PERIPHERAL_GPIO* rgbLed[] = { &ledRed, &ledGreen, &ledBlue };
+static LP_PERIPHERAL_GPIO_GROUP rgbLedGroup = { .peripherals = rgbLed, .count = NELEMS(rgbLed) };
 
 static LP_PERIPHERAL_GPIO sendMsgLed = { .pin = LED2, .direction = LP_OUTPUT, .initialState = GPIO_Value_Low, .invertPin = true, .initialise = lp_openPeripheralGpio, .name = "sendMsgLed" };
 static LP_PERIPHERAL_GPIO networkConnectedLed = { .pin = NETWORK_CONNECTED_LED, .direction = LP_OUTPUT, .initialState = GPIO_Value_Low, .invertPin = true, .initialise = lp_openPeripheralGpio, .name = "networkConnectedLed" };
@@ -108,16 +112,18 @@ static LP_TIMER temperatureStatusBlinkTimer = { .period = {0, 500000000}, .name
 static LP_TIMER sendMsgLedOffOneShotTimer = { .period = {0, 0}, .name = "sendMsgLedOffOneShotTimer", .handler = SendMsgLedOffHandler };
 static LP_TIMER networkConnectionStatusTimer = { .period = {5, 0}, .name = "networkConnectionStatusTimer", .handler = NetworkConnectionStatusHandler };
 static LP_TIMER measureSensorTimer = { .period = {10, 0}, .name = "measureSensorTimer", .handler = MeasureSensorHandler };
-static LP_TIMER buttonPressCheckTimer = { .period = { 0, 1000000 }, .name = "buttonPressCheckTimer", .handler = ButtonPressCheckHandler };
+static const struct timespec sensorPrefetchLead = { 0, 250 * 1000000 };	// the sensors are read this far ahead of measureSensorTimer
 
 // Azure IoT Device Twins
 static LP_DEVICE_TWIN_BINDING desiredTemperature = { .twinProperty = "DesiredTemperature", .twinType = LP_TYPE_FLOAT, .handler = DeviceTwinSetTemperatureHandler };
 static LP_DEVICE_TWIN_BINDING actualTemperature = { .twinProperty = "ActualTemperature", .twinType = LP_TYPE_FLOAT };
+static LP_DEVICE_TWIN_BINDING samplingPolicy = { .twinProperty = "SamplingPolicy", .twinType = LP_TYPE_STRING, .handler = DeviceTwinSamplingPolicyHandler };
+static LP_DEVICE_TWIN_BINDING reconnectBackoff = { .twinProperty = "ReconnectBackoff", .twinType = LP_TYPE_STRING, .handler = DeviceTwinReconnectBackoffHandler };
 
 // Initialize Sets
 LP_PERIPHERAL_GPIO* PeripheralGpioSet[] = { &buttonA, &buttonB, &ledRed, &ledGreen, &ledBlue, &sendMsgLed, &networkConnectedLed };
-LP_TIMER* timerSet[] = { &temperatureStatusBlinkTimer, &sendMsgLedOffOneShotTimer, &networkConnectionStatusTimer, &measureSensorTimer, &buttonPressCheckTimer };
-LP_DEVICE_TWIN_BINDING* deviceTwinBindingSet[] = { &desiredTemperature, &actualTemperature };
+LP_TIMER* timerSet[] = { &temperatureStatusBlinkTimer, &sendMsgLedOffOneShotTimer, &networkConnectionStatusTimer, &measureSensorTimer };
+LP_DEVICE_TWIN_BINDING* deviceTwinBindingSet[] = { &desiredTemperature, &actualTemperature, &samplingPolicy, &reconnectBackoff };
 
 // Message templates and property sets
 
@@ -255,7 +261,7 @@ static void TemperatureStatusBlinkHandler(EventLoopTimer* eventLoopTimer)
 
 	if (previous_led != current_led)
 	{
-		lp_gpioOff(rgbLed[(int)previous_led]); // turn off old current colour
+		lp_gpioGroupSet(&rgbLedGroup, (size_t)previous_led, false); // turn off old current colour
 		previous_led = current_led;
 
 		// send alert message as the HVAC state has changed
@@ -264,8 +270,8 @@ static void TemperatureStatusBlinkHandler(EventLoopTimer* eventLoopTimer)
 
 	led_state = !led_state;
 
-	if (led_state) { lp_gpioOff(rgbLed[(int)current_led]); }
-	else { lp_gpioOn(rgbLed[(int)current_led]); }
+	lp_gpioGroupSet(&rgbLedGroup, (size_t)current_led, !led_state);
+	lp_gpioGroupApply(&rgbLedGroup);
 }
 
 /// <summary>
@@ -290,28 +296,75 @@ static void DeviceTwinSetTemperatureHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBi
 }
 
 /// <summary>
-/// Handler to check for Button Presses.
+/// Device Twin Handler for the sampling policy, "telemetry seconds,accelerometer Hz,gyro Hz,pressure Hz" such as "10,12,0,10".
+/// A rate of zero powers that sensor down, the policy as applied is reported back
 /// </summary>
-static void ButtonPressCheckHandler(EventLoopTimer* eventLoopTimer)
+static void DeviceTwinSamplingPolicyHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding)
 {
-	static GPIO_Value_Type buttonAState;
-	static GPIO_Value_Type buttonBState;
+	char reported[64];
+	unsigned int seconds, accelerometerHz, gyroHz, pressureHz;
 
-	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
+	if (sscanf((char*)deviceTwinBinding->twinState, "%u,%u,%u,%u", &seconds, &accelerometerHz, &gyroHz, &pressureHz) != 4 ||
+		seconds == 0 || seconds > 3600 || accelerometerHz > UINT16_MAX || gyroHz > UINT16_MAX || pressureHz > UINT16_MAX)
 	{
-		lp_terminate(ExitCode_ConsumeEventLoopTimeEvent);
+		Log_Debug("SamplingPolicy '%s' is not telemetry seconds,accelerometer Hz,gyro Hz,pressure Hz\n", (char*)deviceTwinBinding->twinState);
 		return;
 	}
 
-	if (lp_gpioGetState(&buttonA, &buttonAState) || lp_gpioGetState(&buttonB, &buttonBState))
-	{
-		led1BlinkIntervalIndex = (led1BlinkIntervalIndex + 1) % led1BlinkIntervalsCount;
-		lp_changeTimer(&temperatureStatusBlinkTimer, &led1BlinkIntervals[led1BlinkIntervalIndex]);
+	lp_changeTimer(&measureSensorTimer, &(struct timespec){ (time_t)seconds, 0 });
+
+#ifdef OEM_AVNET
+	LP_IMU_POLICY policy = { .accelerometerHz = (uint16_t)accelerometerHz, .gyroHz = (uint16_t)gyroHz, .pressureHz = (uint16_t)pressureHz };
+
+	lp_imu_set_policy(&policy);
+	lp_imu_get_policy(&policy);
+	accelerometerHz = policy.accelerometerHz;
+	gyroHz = policy.gyroHz;
+	pressureHz = policy.pressureHz;
+#else
+	accelerometerHz = gyroHz = pressureHz = 0;	// no IMU on this board, only the telemetry period applies
+#endif // OEM_AVNET
 
-		lp_deviceTwinReportState(&actualTemperature, &last_temperature);	// TwinType = LP_TYPE_FLOAT
+	snprintf(reported, sizeof(reported), "%u,%u,%u,%u", seconds, accelerometerHz, gyroHz, pressureHz);
+	lp_deviceTwinReportState(deviceTwinBinding, reported);
+}
 
-		SendAlertMessage("button_a", "pressed");
+/// <summary>
+/// Device Twin Handler for the reconnect back off, "base ms,cap ms,hold off ms" such as "1000,60000,5000", set per fleet
+/// so devices that lose the same hub or access point spread their reconnects out. The back off as applied is reported back
+/// </summary>
+static void DeviceTwinReconnectBackoffHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding)
+{
+	char reported[48];
+	int baseMs, capMs, holdoffMaxMs;
+
+	if (sscanf((char*)deviceTwinBinding->twinState, "%d,%d,%d", &baseMs, &capMs, &holdoffMaxMs) != 3 ||
+		baseMs <= 0 || capMs > 3600000 || holdoffMaxMs < 0 || holdoffMaxMs > 3600000)
+	{
+		Log_Debug("ReconnectBackoff '%s' is not base ms,cap ms,hold off ms\n", (char*)deviceTwinBinding->twinState);
+		return;
 	}
+
+	lp_setReconnectBackoff(baseMs, capMs, holdoffMaxMs);
+	lp_getReconnectBackoff(&baseMs, &capMs, &holdoffMaxMs);
+
+	snprintf(reported, sizeof(reported), "%d,%d,%d", baseMs, capMs, holdoffMaxMs);
+	lp_deviceTwinReportState(deviceTwinBinding, reported);
+}
+
+/// <summary>
+/// Button A or B pressed or released, debounced by the GPIO scan
+/// </summary>
+static void ButtonPressedHandler(LP_PERIPHERAL_GPIO* peripheralGpio, bool pressed)
+{
+	if (!pressed) { return; }
+
+	led1BlinkIntervalIndex = (led1BlinkIntervalIndex + 1) % led1BlinkIntervalsCount;
+	lp_changeTimer(&temperatureStatusBlinkTimer, &led1BlinkIntervals[led1BlinkIntervalIndex]);
+
+	lp_deviceTwinReportState(&actualTemperature, &last_temperature);	// TwinType = LP_TYPE_FLOAT
+
+	SendAlertMessage("button_a", "pressed");
 }
 
 /// <summary>
@@ -320,13 +373,21 @@ static void ButtonPressCheckHandler(EventLoopTimer* eventLoopTimer)
 /// <returns>0 on success, or -1 on failure</returns>
 static void InitPeripheralAndHandlers(void)
 {
+	lp_setInitMode(LP_INIT_CONCURRENT);	// provisioning starts on the first event loop pass, the sensors set up alongside it
+	lp_startCloudToDevice();
+	lp_setBootTimelineTwin("BootTimeline");	// logged and reported once the first message is confirmed
+
 	lp_initializeDevKit();
+	lp_bootMark("devkit");
 
 	lp_openPeripheralGpioSet(PeripheralGpioSet, NELEMS(PeripheralGpioSet));
+	lp_bootMark("gpio");
 	lp_openDeviceTwinSet(deviceTwinBindingSet, NELEMS(deviceTwinBindingSet));
+	lp_bootMark("device twins");
 
 	lp_startTimerSet(timerSet, NELEMS(timerSet));
-	lp_startCloudToDevice();
+	lp_bootMark("timers");
+	lp_setSensorPrefetch(&measureSensorTimer, &sensorPrefetchLead);	// MeasureSensorHandler sends readings a lead old, never waits on the bus
 }
 
 /// <summary>
@@ -362,15 +423,7 @@ int main(int argc, char* argv[])
 	InitPeripheralAndHandlers();
 
 	// Main loop
-	while (!lp_isTerminationRequired())
-	{
-		int result = EventLoop_Run(lp_getTimerEventLoop(), -1, true);
-		// Continue if interrupted by signal, e.g. due to breakpoint being set.
-		if (result == -1 && errno != EINTR)
-		{
-			lp_terminate(ExitCode_Main_EventLoopFail);
-		}
-	}
+	lp_runEventLoop();
 
 	ClosePeripheralAndHandlers();
 
@@ -38,6 +38,8 @@
 
 // Learning Path Libraries
 #include "azure_iot.h"
+#include "coroutine.h"
+#include "event_loop.h"
 #include "exit_codes.h"
 #include "globals.h"
 #include "peripheral_gpio.h"
@@ -72,7 +74,7 @@ static void InitPeripheralAndHandlers(void);
 static void ClosePeripheralAndHandlers(void);
 static void Led1BlinkHandler(EventLoopTimer* eventLoopTimer);
 static void NetworkConnectionStatusHandler(EventLoopTimer* eventLoopTimer);
-static void ResetDeviceHandler(EventLoopTimer* eventLoopTimer);
+static LP_COROUTINE_STATUS ResetDeviceFlow(LP_COROUTINE* coroutine);
 static LP_DIRECT_METHOD_RESPONSE_CODE ResetDirectMethodHandler(JSON_Object* json, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg);
 
 static char msgBuffer[JSON_MESSAGE_BYTES] = { 0 };
@@ -84,9 +86,12 @@ static LP_PERIPHERAL_GPIO networkConnectedLed = { .pin = NETWORK_CONNECTED_LED,
 
 // Timers
 static LP_TIMER networkConnectionStatusTimer = { .period = {5, 0}, .name = "networkConnectionStatusTimer", .handler = NetworkConnectionStatusHandler };
-static LP_TIMER resetDeviceOneShotTimer = { .period = {0, 0}, .name = "resetDeviceOneShotTimer", .handler = ResetDeviceHandler };
 static LP_TIMER led1BlinkTimer = { .period = { 0, 125000000 }, .name = "led1BlinkTimer", .handler = Led1BlinkHandler };
 
+// Reset flow, the reset seconds the direct method asked for are kept across its awaits
+static LP_COROUTINE resetDeviceFlow = { .run = ResetDeviceFlow, .name = "resetDeviceFlow" };
+static int resetSeconds;
+
 // Azure IoT Device Twins
 static LP_DEVICE_TWIN_BINDING deviceResetUtc = { .twinProperty = "DeviceResetUTC", .twinType = LP_TYPE_STRING };
 
@@ -95,9 +100,9 @@ static LP_DIRECT_METHOD_BINDING resetDevice = { .methodName = "ResetMethod", .ha
 
 // Initialize Sets
 LP_PERIPHERAL_GPIO* PeripheralGpioSet[] = { &led1, &networkConnectedLed };
-LP_TIMER* timerSet[] = {&networkConnectionStatusTimer, &led1BlinkTimer, &resetDeviceOneShotTimer };
+LP_TIMER* timerSet[] = {&networkConnectionStatusTimer, &led1BlinkTimer };
 LP_DEVICE_TWIN_BINDING* deviceTwinBindingSet[] = { &deviceResetUtc };
-LP_DIRECT_METHOD_BINDING* directMethodBindingSet[] = { &resetDevice };
+LP_DIRECT_METHOD_BINDING* directMethodBindingSet[] = { &lp_batchDirectMethod, &resetDevice };	// Batch runs several methods in one invocation
 
 
 /// <summary>
@@ -135,16 +140,28 @@ static void Led1BlinkHandler(EventLoopTimer* eventLoopTimer)
 }
 
 /// <summary>
-/// Reset the Device
+/// Reset the Device, report the reset time, wait for IoT Hub to acknowledge it and reboot within resetSeconds
 /// </summary>
-static void ResetDeviceHandler(EventLoopTimer* eventLoopTimer)
+static LP_COROUTINE_STATUS ResetDeviceFlow(LP_COROUTINE* coroutine)
 {
-	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
+	LP_COROUTINE_BEGIN(coroutine);
+
+	// Report Device Reset UTC
+	lp_deviceTwinReportState(&deviceResetUtc, lp_getCurrentUtc(msgBuffer, sizeof(msgBuffer))); // LP_TYPE_STRING
+	lp_flushReportedState();
+
+	LP_AWAIT_UNTIL(coroutine, deviceResetUtc.reportState == LP_REPORT_ACKED, (resetSeconds - 1) * 1000);
+	if (coroutine->timedOut)
 	{
-		lp_terminate(ExitCode_ConsumeEventLoopTimeEvent);
-		return;
+		Log_Debug("DeviceResetUTC was not acknowledged, resetting anyway\n");
 	}
+
+	// a second for the direct method response and the acknowledgement to clear before the restart
+	LP_AWAIT_MS(coroutine, 1000);
+
 	PowerManagement_ForceSystemReboot();
+
+	LP_COROUTINE_END(coroutine);
 }
 
 /// <summary>
@@ -153,11 +170,6 @@ static void ResetDeviceHandler(EventLoopTimer* eventLoopTimer)
 static LP_DIRECT_METHOD_RESPONSE_CODE ResetDirectMethodHandler(JSON_Object* json, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg)
 {
 	const char propertyName[] = "reset_timer";
-	const size_t responseLen = 60; // Allocate and initialize a response message buffer. The calling function is responsible for the freeing memory
-	static struct timespec period;
-
-	*responseMsg = (char*)malloc(responseLen);
-	memset(*responseMsg, 0, responseLen);
 
 	if (!json_object_has_value_of_type(json, propertyName, JSONNumber))
 	{
@@ -165,24 +177,27 @@ static LP_DIRECT_METHOD_RESPONSE_CODE ResetDirectMethodHandler(JSON_Object* json
 	}
 	int seconds = (int)json_object_get_number(json, propertyName);
 
+	if (lp_isCoroutineRunning(&resetDeviceFlow))
+	{
+		lp_setMethodResponse("%s called. Reset already pending", directMethodBinding->methodName);
+		return LP_METHOD_FAILED;
+	}
+
 	// leave enough time for the device twin deviceResetUtc to update before restarting the device
 	if (seconds > 2 && seconds < 10)
 	{
-		// Report Device Reset UTC
-		lp_deviceTwinReportState(&deviceResetUtc, lp_getCurrentUtc(msgBuffer, sizeof(msgBuffer))); // LP_TYPE_STRING
-
-		// Create Direct Method Response
-		snprintf(*responseMsg, responseLen, "%s called. Reset in %d seconds", directMethodBinding->methodName, seconds);
+		// Create Direct Method Response, written into the library response buffer
+		lp_setMethodResponse("%s called. Reset within %d seconds", directMethodBinding->methodName, seconds);
 
-		// Set One Shot LP_TIMER
-		period = (struct timespec){ .tv_sec = seconds, .tv_nsec = 0 };
-		lp_setOneShotTimer(&resetDeviceOneShotTimer, &period);
+		// Report the reset time, wait for its acknowledgement and reboot, without blocking the event loop
+		resetSeconds = seconds;
+		lp_startCoroutine(&resetDeviceFlow);
 
 		return LP_METHOD_SUCCEEDED;
 	}
 	else
 	{
-		snprintf(*responseMsg, responseLen, "%s called. Reset Failed. Seconds out of range: %d", directMethodBinding->methodName, seconds);
+		lp_setMethodResponse("%s called. Reset Failed. Seconds out of range: %d", directMethodBinding->methodName, seconds);
 		return LP_METHOD_FAILED;
 	}
 }
@@ -192,14 +207,21 @@ static LP_DIRECT_METHOD_RESPONSE_CODE ResetDirectMethodHandler(JSON_Object* json
 /// </summary>
 static void InitPeripheralAndHandlers(void)
 {
+	lp_setInitMode(LP_INIT_CONCURRENT);	// provisioning starts on the first event loop pass, the sensors set up alongside it
+	lp_startCloudToDevice();
+	lp_setBootTimelineTwin("BootTimeline");	// logged and reported once the first message is confirmed
+
 	lp_initializeDevKit();
+	lp_bootMark("devkit");
 
 	lp_openPeripheralGpioSet(PeripheralGpioSet, NELEMS(PeripheralGpioSet));
+	lp_bootMark("gpio");
 	lp_openDeviceTwinSet(deviceTwinBindingSet, NELEMS(deviceTwinBindingSet));
+	lp_bootMark("device twins");
 	lp_openDirectMethodSet(directMethodBindingSet, NELEMS(directMethodBindingSet));
 
 	lp_startTimerSet(timerSet, NELEMS(timerSet));
-	lp_startCloudToDevice();
+	lp_bootMark("timers");
 }
 
 /// <summary>
@@ -209,6 +231,7 @@ static void ClosePeripheralAndHandlers(void)
 {
 	Log_Debug("Closing file descriptors\n");
 
+	lp_stopCoroutines();
 	lp_stopTimerSet();
 	lp_stopCloudToDevice();
 
@@ -235,15 +258,7 @@ int main(int argc, char* argv[])
 	InitPeripheralAndHandlers();
 
 	// Main loop
-	while (!lp_isTerminationRequired())
-	{
-		int result = EventLoop_Run(lp_getTimerEventLoop(), -1, true);
-		// Continue if interrupted by signal, e.g. due to breakpoint being set.
-		if (result == -1 && errno != EINTR)
-		{
-			lp_terminate(ExitCode_Main_EventLoopFail);
-		}
-	}
+	lp_runEventLoop();
 
 	ClosePeripheralAndHandlers();
 
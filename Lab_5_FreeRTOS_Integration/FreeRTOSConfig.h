@@ -55,8 +55,10 @@ errata. */
 #define configTICK_RATE_HZ						( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES					( 10 )
 #define configMINIMAL_STACK_SIZE				( ( unsigned short ) 130 )
-#define configTOTAL_HEAP_SIZE					( ( size_t ) ( 64 * 1024 ) )
-#define configMAX_TASK_NAME_LEN					( 10 )
+#define configTCM_HEAP_SIZE						( ( size_t ) ( 8 * 1024 ) )	/* heap_5, kernel objects and small buffers, the app allocates at compile time */
+#define configSYSRAM_HEAP_SIZE					( ( size_t ) ( 24 * 1024 ) )	/* heap_5, DMA buffers, the OS HAL drivers' and pvPortMallocRegion( portHEAP_REGION_SYSRAM ) */
+#define configTOTAL_HEAP_SIZE					( configTCM_HEAP_SIZE + configSYSRAM_HEAP_SIZE )
+#define configMAX_TASK_NAME_LEN					( 16 )	/* LP_IC_THREAD_NAME_SIZE, names reach the A7 app whole */
 #define configUSE_TRACE_FACILITY				1
 #define configUSE_16_BIT_TICKS					0
 #define configIDLE_SHOULD_YIELD					1
@@ -67,9 +69,11 @@ errata. */
 #define configUSE_MALLOC_FAILED_HOOK			1
 #define configUSE_APPLICATION_TASK_TAG			1
 #define configUSE_COUNTING_SEMAPHORES			1
-#define configGENERATE_RUN_TIME_STATS			0
+#define configGENERATE_RUN_TIME_STATS			1
 #define configUSE_TIME_SLICING					0
-#define configHEAP_IN_SYSRAM					1
+#define configSUPPORT_STATIC_ALLOCATION			1
+#define configSUPPORT_DYNAMIC_ALLOCATION		1
+#define configUSE_TICKLESS_IDLE					1	/* vPortSuppressTicksAndSleep in tickless_idle.c sleeps on GPT0 */
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 			0
@@ -90,6 +94,17 @@ to exclude the API function. */
 #define INCLUDE_vTaskSuspend			1
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_xTaskGetIdleTaskHandle	1
+#define INCLUDE_xTaskGetCurrentTaskHandle	1	/* rtos_event_wait notifies the task waiting */
+
+/* Run time statistics, counted by task_profile.c on the 32 kHz free-running GPT2 and switches per task
+from the trace hook. Interrupts are charged to the task they interrupt. */
+void task_profile_clock_init(void);
+uint32_t task_profile_clock(void);
+void task_profile_switched_in(uint32_t task_number);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	task_profile_clock_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()			task_profile_clock()
+#define traceTASK_SWITCHED_IN()						task_profile_switched_in( pxCurrentTCB->uxTCBNumber )
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -75,6 +75,19 @@ typedef unsigned long UBaseType_t;
 #define portBYTE_ALIGNMENT			8
 /*-----------------------------------------------------------*/
 
+/* MT3620 heap regions, see heap_5.c.  pvPortMalloc() takes TCM first and
+SYSRAM once TCM is exhausted, pvPortMallocRegion() only the region named, so
+anything a DMA engine touches asks for portHEAP_REGION_SYSRAM - the DMA engines
+cannot reach TCM. */
+#define portHEAP_REGION_TCM			0
+#define portHEAP_REGION_SYSRAM		1
+#define portHEAP_REGIONS			2
+
+void *pvPortMallocRegion( size_t xWantedSize, BaseType_t xRegion );
+size_t xPortGetFreeHeapRegionSize( BaseType_t xRegion );
+size_t xPortGetMinimumEverFreeHeapRegionSize( BaseType_t xRegion );
+/*-----------------------------------------------------------*/
+
 /* Scheduler utilities. */
 #define portYIELD() 															\
 {																				\
@@ -143,6 +143,9 @@ typedef enum {
 	OS_HAL_I2C_ISU_MAX
 } i2c_num;
 
+/** Completion of mtk_os_hal_i2c_write_read_async(), called from interrupt context */
+typedef void (*i2c_xfer_done_callback)(int result, void *user_data);
+
 /**
   * @}
   */
@@ -253,6 +256,57 @@ int mtk_os_hal_i2c_write(i2c_num bus_num, u8 device_addr, u8 *buffer, u16 len);
 int mtk_os_hal_i2c_write_read(i2c_num bus_num, u8 device_addr,
 			      u8 *wr_buf, u8 *rd_buf, u16 wr_len, u16 rd_len);
 
+/**
+ *  @brief I2C master write then read without waiting for completion.
+ *
+ *  The transfer runs from the I2C and DMA interrupts and callback is
+ *  called from interrupt context when it completes, so the caller can
+ *  block on its own semaphore or event while the bus is busy.
+ *  Transfers longer than 8 bytes use DMA and their buffers must be in
+ *  SYSRAM. The buffers must stay valid until the callback.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *
+ *  @param [in] device_addr : slave device address.
+ *
+ *  @param [in] wr_buf : write data buffer.
+ *
+ *  @param [in] rd_buf : read data buffer.
+ *
+ *  @param [in] wr_len : write data length.
+ *
+ *  @param [in] rd_len : read data length.
+ *
+ *  @param [in] callback : called with the transfer result, 0 on success.
+ *
+ *  @param [in] user_data : passed to callback.
+ *
+ *  @return negative value means the transfer was not started.
+ *
+ *  @return -#I2C_EBUSY if a split transfer is already in progress.
+ *
+ *  @return "0" if the transfer was started.
+ */
+int mtk_os_hal_i2c_write_read_async(i2c_num bus_num, u8 device_addr,
+				    u8 *wr_buf, u8 *rd_buf, u16 wr_len,
+				    u16 rd_len,
+				    i2c_xfer_done_callback callback,
+				    void *user_data);
+
+/**
+ *  @brief Abandon a split transfer whose callback has not arrived
+ *  and reset the controller, for callers whose wait timed out.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *
+ *  @return "0" if a pending transfer was abandoned.
+ *
+ *  @return -#I2C_EINVAL if no split transfer is in progress.
+ */
+int mtk_os_hal_i2c_abort_async(i2c_num bus_num);
+
 /**
  *  @brief Set I2C slave address before transfer when I2C hardware
  *  controller is set as a slave role, it which means does not call
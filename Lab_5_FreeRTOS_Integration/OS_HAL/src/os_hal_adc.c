@@ -195,7 +195,7 @@ int mtk_os_hal_adc_ctlr_init(adc_pmode pmode, adc_fifo_mode fifo_mode,
 #ifdef OSAI_ENABLE_DMA
 
 #ifdef OSAI_FREERTOS
-		ctlr->adc_fsm_parameter->dma_vfifo_addr = pvPortMalloc(ADC_DMA_BUF_WORD_SIZE);
+		ctlr->adc_fsm_parameter->dma_vfifo_addr = pvPortMallocRegion(ADC_DMA_BUF_WORD_SIZE, portHEAP_REGION_SYSRAM);
 		ctlr->adc_fsm_parameter->dma_vfifo_len = ADC_DMA_BUF_WORD_SIZE;
 #else
 		ctlr->adc_fsm_parameter->dma_vfifo_addr = (u32 *)adc_dma_buf;
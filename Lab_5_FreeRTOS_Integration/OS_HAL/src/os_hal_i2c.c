@@ -95,12 +95,31 @@ struct mtk_i2c_ctrl_rtos {
 #else
 	volatile u8 xfer_completion;
 #endif
+
+	/* split transfer, completed from the interrupt instead of a wait */
+	struct i2c_msg async_msgs[2];
+	i2c_xfer_done_callback volatile done_callback;
+	void *done_data;
 };
 
 static struct mtk_i2c_ctrl_rtos g_i2c_ctrl_rtos[OS_HAL_I2C_ISU_MAX];
 struct mtk_i2c_controller g_i2c_ctrl[OS_HAL_I2C_ISU_MAX];
 struct mtk_i2c_private g_i2c_mdata[OS_HAL_I2C_ISU_MAX];
 
+static void _mtk_os_hal_i2c_complete_async(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+	i2c_xfer_done_callback callback = ctrl_rtos->done_callback;
+	int ret;
+
+	ctrl_rtos->done_callback = NULL;
+
+	ret = mtk_mhal_i2c_result_handle(ctrl_rtos->i2c);
+	if (ret)
+		mtk_mhal_i2c_init_hw(ctrl_rtos->i2c);
+
+	callback(ret, ctrl_rtos->done_data);
+}
+
 static void _mtk_os_hal_i2c_irq_handler(int bus_num)
 {
 	u8 ret = 0;
@@ -115,6 +134,10 @@ static void _mtk_os_hal_i2c_irq_handler(int bus_num)
 	 * 2. DMA mode: return completion done in DMA irq handler
 	 */
 	if (!ret) {
+		if (ctrl_rtos->done_callback) {
+			_mtk_os_hal_i2c_complete_async(ctrl_rtos);
+			return;
+		}
 #ifdef OSAI_FREERTOS
 		xSemaphoreGiveFromISR(ctrl_rtos->xfer_completion,
 				      &x_higher_priority_task_woken);
@@ -204,6 +227,10 @@ static void _mtk_os_hal_i2c_free_irq(int bus_num)
 
 static int _mtk_os_hal_i2c_dma_done_callback(void *data)
 {
+	if (((struct mtk_i2c_ctrl_rtos *)data)->done_callback) {
+		_mtk_os_hal_i2c_complete_async(data);
+		return 0;
+	}
 #ifdef OSAI_FREERTOS
 	BaseType_t x_higher_priority_task_woken = pdFALSE;
 	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
@@ -520,6 +547,90 @@ int mtk_os_hal_i2c_write_read(i2c_num bus_num, u8 device_addr,
 	return ret;
 }
 
+int mtk_os_hal_i2c_write_read_async(i2c_num bus_num, u8 device_addr,
+				    u8 *wr_buf, u8 *rd_buf, u16 wr_len,
+				    u16 rd_len,
+				    i2c_xfer_done_callback callback,
+				    void *user_data)
+{
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+	struct mtk_i2c_controller *i2c;
+	struct i2c_msg *msgs;
+	int ret = I2C_OK;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX || !callback)
+		return -I2C_EINVAL;
+
+#ifndef OSAI_ENABLE_DMA
+	if (wr_len > PIO_I2C_MAX_LEN || rd_len > PIO_I2C_MAX_LEN) {
+		printf("Error! buf length should be less than or equal to %d\n", PIO_I2C_MAX_LEN);
+		return -I2C_EINVAL;
+	}
+#endif
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
+
+	i2c = ctrl_rtos->i2c;
+	if (!i2c) {
+		printf("i2c%d *i2c is NULL Pointer\n", bus_num);
+		return -I2C_EPTR;
+	}
+
+	if (ctrl_rtos->done_callback)
+		return -I2C_EBUSY;
+
+	i2c->msg_num = 2;
+	i2c->dma_en = false;
+	i2c->i2c_mode = I2C_MASTER_MODE;
+	i2c->timeout = 2000;
+	i2c->irq_stat = 0;
+
+	/* the messages must outlive this call */
+	msgs = ctrl_rtos->async_msgs;
+
+	msgs[0].addr = device_addr;
+	msgs[0].flags = I2C_MASTER_WR;
+	msgs[0].len = wr_len;
+	msgs[0].buf = wr_buf;
+
+	msgs[1].addr = device_addr;
+	msgs[1].flags = I2C_MASTER_RD;
+	msgs[1].len = rd_len;
+	msgs[1].buf = rd_buf;
+
+	i2c->msg = msgs;
+
+	/* set before the trigger, the interrupt can complete the transfer at once */
+	ctrl_rtos->done_data = user_data;
+	ctrl_rtos->done_callback = callback;
+
+	ret = mtk_mhal_i2c_trigger_transfer(i2c);
+	if (ret) {
+		ctrl_rtos->done_callback = NULL;
+		printf("i2c%d trigger transfer fail\n", bus_num);
+	}
+
+	return ret;
+}
+
+int mtk_os_hal_i2c_abort_async(i2c_num bus_num)
+{
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX)
+		return -I2C_EINVAL;
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
+	if (!ctrl_rtos->i2c || !ctrl_rtos->done_callback)
+		return -I2C_EINVAL;
+
+	ctrl_rtos->done_callback = NULL;
+	mtk_mhal_i2c_dump_register(ctrl_rtos->i2c);
+	mtk_mhal_i2c_init_hw(ctrl_rtos->i2c);
+
+	return 0;
+}
+
 int mtk_os_hal_i2c_set_slave_addr(i2c_num bus_num, u8 slv_addr)
 {
 	int ret = I2C_OK;
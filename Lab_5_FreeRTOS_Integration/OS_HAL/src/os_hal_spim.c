@@ -298,11 +298,11 @@ int mtk_os_hal_spim_ctlr_init(spim_num bus_num)
 	ctlr = ctlr_rtos->ctlr;
 	ctlr->mdata = &g_spim_mdata[bus_num];
 
-	/* Allocated by pvPortMalloc to guard memory is in sram */
+	/* Allocated from the SYSRAM heap region to guard memory is in sram */
 #ifdef OSAI_ENABLE_DMA
 
 #ifdef OSAI_FREERTOS
-	ctlr->dma_tmp_tx_buf = pvPortMalloc(MTK_SPIM_DMA_BUFFER_BYTES);
+	ctlr->dma_tmp_tx_buf = pvPortMallocRegion(MTK_SPIM_DMA_BUFFER_BYTES, portHEAP_REGION_SYSRAM);
 #else
 	ctlr->dma_tmp_tx_buf = spim_dma_buf;
 #endif
@@ -43,90 +43,24 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <time.h>
-#include <stdlib.h>
-#include <math.h>
 
 #include "FreeRTOS.h"
 #include "task.h"
 #include "printf.h"
 #include "mt3620.h"
 
-#include "os_hal_gpio.h"
 #include "os_hal_uart.h"
 
-#include "semphr.h"
-
-
-#ifdef OEM_AVNET
-#include "lsm6dso_driver.h"
-#include "lsm6dso_reg.h"
-#include "i2c.h"
-#endif // OEM_AVNET
-
-
-#include "hw/azure_sphere_learning_path.h"
+#include "rtcore_app.h"
+#include "rtos_bench.h"
+#include "uart_log.h"
 
 
  /******************************************************************************/
  /* Configurations */
  /******************************************************************************/
 
-enum LP_INTER_CORE_CMD
-{
-	LP_IC_UNKNOWN,
-	LP_IC_HEARTBEAT,
-	LP_IC_TEMPERATURE_PRESSURE_HUMIDITY,
-	LP_IC_EVENT_BUTTON_A,
-	LP_IC_EVENT_BUTTON_B,
-	LP_IC_SET_DESIRED_TEMPERATURE,
-	LP_IC_BLINK_RATE
-};
-
-typedef struct LP_INTER_CORE_BLOCK
-{
-	enum LP_INTER_CORE_CMD cmd;
-	float	temperature;
-	float	pressure;
-	float	humidity;
-	int		blinkRate;
-
-} LP_INTER_CORE_BLOCK;
-
-static LP_INTER_CORE_BLOCK ic_control_block;
-
 #define UART_PORT_NUM OS_HAL_UART_ISU0
-#define APP_STACK_SIZE_BYTES (1024 / 4)
-
-
-static const int blinkIntervalsMs[] = { 125, 250, 500, 750, 1000, 2000 };
-static int blinkIntervalIndex = 3;
-static const int numBlinkIntervals = sizeof(blinkIntervalsMs) / sizeof(blinkIntervalsMs[0]);
-static SemaphoreHandle_t LEDSemphr;
-
-
-// Inter-core Communications
-#include "mt3620-intercore.h" // Support for inter Core Communications
-static const size_t payloadStart = 20;
-static uint8_t buf[256];
-static uint32_t dataSize;
-static BufferHeader* outbound, * inbound;
-static uint32_t sharedBufSize = 0;
-
-bool HLAppReady = false;
-int desired_temperature = 0.0;
-int last_temperature = 0;
-
-enum LEDS
-{
-	RED,
-	GREEN,
-	BLUE
-};
-
-static enum LEDS current_led = RED;
-static int leds[] = { LED_RED, LED_GREEN, LED_BLUE };
-static bool led_state[] = { false, false, false };
 
 
 /******************************************************************************/
@@ -144,63 +78,38 @@ void vApplicationMallocFailedHook(void)
 	printf("%s\n", __func__);
 }
 
-// Hook for "printf".
-void _putchar(char character)
+// Kernel task memory, static allocation has the application provide it.
+void vApplicationGetIdleTaskMemory(StaticTask_t** ppxIdleTaskTCBBuffer, StackType_t** ppxIdleTaskStackBuffer, uint32_t* pulIdleTaskStackSize)
 {
-	mtk_os_hal_uart_put_char(UART_PORT_NUM, character);
-	if (character == '\n')
-		mtk_os_hal_uart_put_char(UART_PORT_NUM, '\r');
+	static StaticTask_t tcb;
+	static StackType_t stack[configMINIMAL_STACK_SIZE];
+
+	*ppxIdleTaskTCBBuffer = &tcb;
+	*ppxIdleTaskStackBuffer = stack;
+	*pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
 }
 
-/******************************************************************************/
-/* Functions */
-/******************************************************************************/
-static int gpio_output(u8 gpio_no, u8 level)
+void vApplicationGetTimerTaskMemory(StaticTask_t** ppxTimerTaskTCBBuffer, StackType_t** ppxTimerTaskStackBuffer, uint32_t* pulTimerTaskStackSize)
 {
-	int ret;
+	static StaticTask_t tcb;
+	static StackType_t stack[configTIMER_TASK_STACK_DEPTH];
 
-	ret = mtk_os_hal_gpio_request(gpio_no);
-	if (ret != 0)
-	{
-		printf("request gpio[%d] fail\n", gpio_no);
-		return ret;
-	}
-	mtk_os_hal_gpio_set_direction(gpio_no, OS_HAL_GPIO_DIR_OUTPUT);
-	mtk_os_hal_gpio_set_output(gpio_no, level);
-	ret = mtk_os_hal_gpio_free(gpio_no);
-	if (ret != 0)
-	{
-		printf("free gpio[%d] fail\n", gpio_no);
-		return ret;
-	}
-	return 0;
+	*ppxTimerTaskTCBBuffer = &tcb;
+	*ppxTimerTaskStackBuffer = stack;
+	*pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
 }
 
-static int gpio_input(u8 gpio_no, os_hal_gpio_data* pvalue)
+// Hook for "printf", queued for the UART transmit interrupt so printf never waits on the line.
+void _putchar(char character)
 {
-	u8 ret;
-
-	ret = mtk_os_hal_gpio_request(gpio_no);
-	if (ret != 0)
-	{
-		printf("request gpio[%d] fail\n", gpio_no);
-		return ret;
-	}
-	mtk_os_hal_gpio_set_direction(gpio_no, OS_HAL_GPIO_DIR_INPUT);
-	vTaskDelay(pdMS_TO_TICKS(10));
-
-	mtk_os_hal_gpio_get_input(gpio_no, pvalue);
-
-	ret = mtk_os_hal_gpio_free(gpio_no);
-	if (ret != 0)
-	{
-		printf("free gpio[%d] fail\n", gpio_no);
-		return ret;
-	}
-
-	return 0;
+	uart_log_putc(character);
+	if (character == '\n')
+		uart_log_putc('\r');
 }
 
+/******************************************************************************/
+/* Functions */
+/******************************************************************************/
 //https://embeddedartistry.com/blog/2018/01/15/implementing-malloc-with-freertos/
 
 /*
@@ -230,221 +139,20 @@ void free(void* ptr)
 	}
 }
 
-void send_inter_core_msg(void)
-{
-	if (HLAppReady)
-	{
-		memcpy((void*)&buf[payloadStart], (void*)&ic_control_block, sizeof(ic_control_block));
-		dataSize = payloadStart + sizeof(ic_control_block);
-
-		EnqueueData(inbound, outbound, sharedBufSize, buf, dataSize);
-	}
-}
-
-static void ButtonTask(void* pParameters)
-{
-	static os_hal_gpio_data oldStateButtonA = OS_HAL_GPIO_DATA_LOW;
-	static os_hal_gpio_data oldStateButtonB = OS_HAL_GPIO_DATA_LOW;
-	os_hal_gpio_data value = 0;
-
-	while (1)
-	{
-		// Get Button_A status
-		gpio_input(BUTTON_A, &value);
-		if ((value != oldStateButtonA) && (value == OS_HAL_GPIO_DATA_LOW))
-		{
-			blinkIntervalIndex = (blinkIntervalIndex + 1) % numBlinkIntervals;
-
-			ic_control_block.cmd = LP_IC_EVENT_BUTTON_A;
-			send_inter_core_msg();
-
-			ic_control_block.cmd = LP_IC_BLINK_RATE;
-			ic_control_block.blinkRate = blinkIntervalIndex;
-			send_inter_core_msg();
-		}
-		oldStateButtonA = value;
-
-		// Get Button_B status
-		gpio_input(BUTTON_B, &value);
-		if ((value != oldStateButtonB) && (value == OS_HAL_GPIO_DATA_LOW))
-		{
-			ic_control_block.cmd = LP_IC_EVENT_BUTTON_B;
-			send_inter_core_msg();
-		}
-		oldStateButtonB = value;
-
-		// Delay for 100ms
-		vTaskDelay(pdMS_TO_TICKS(100));
-	}
+/// <summary>
+/// After each diagnostics report, the heap itself goes to the A7 app as an LP_IC_HEAP_PROFILE
+/// </summary>
+void rtcore_app_report_memory(void)
+{
+	printf("heap %u of %u bytes free, %u at the least\n", (unsigned)xPortGetFreeHeapSize(), (unsigned)configTOTAL_HEAP_SIZE,
+		(unsigned)xPortGetMinimumEverFreeHeapSize());
+	printf("heap TCM %u of %u free, %u at the least, SYSRAM %u of %u free, %u at the least\n",
+		(unsigned)xPortGetFreeHeapRegionSize(portHEAP_REGION_TCM), (unsigned)configTCM_HEAP_SIZE,
+		(unsigned)xPortGetMinimumEverFreeHeapRegionSize(portHEAP_REGION_TCM),
+		(unsigned)xPortGetFreeHeapRegionSize(portHEAP_REGION_SYSRAM), (unsigned)configSYSRAM_HEAP_SIZE,
+		(unsigned)xPortGetMinimumEverFreeHeapRegionSize(portHEAP_REGION_SYSRAM));
 }
 
-static void SetLedBlinkRateTask(void* pParameters)
-{
-	// ensure LEDs are turned off
-	gpio_output(LED_RED, true);
-	gpio_output(LED_GREEN, true);
-	gpio_output(LED_BLUE, true);
-
-	while (1)
-	{
-		vTaskDelay(pdMS_TO_TICKS(blinkIntervalsMs[blinkIntervalIndex]));
-		xSemaphoreGive(LEDSemphr);
-	}
-}
-
-static void LedTask(void* pParameters)
-{
-	BaseType_t rt;
-	static enum LEDS previous_led = RED;
-
-	while (1)
-	{
-		rt = xSemaphoreTake(LEDSemphr, portMAX_DELAY);
-		if (rt == pdPASS)
-		{
-			if (previous_led != current_led)
-			{
-				gpio_output(leds[(int)previous_led], true); // turn off old current colour
-				previous_led = current_led;
-			}
-
-			led_state[(int)current_led] = !led_state[(int)current_led];
-			gpio_output(leds[(int)current_led], led_state[(int)current_led]);
-		}
-	}
-}
-
-void SetTemperatureStatus(int temperature)
-{
-	if (temperature == desired_temperature)
-	{
-		current_led = GREEN;
-	}
-
-	if (temperature < desired_temperature)
-	{
-		current_led = BLUE;
-	}
-
-	if (temperature > desired_temperature)
-	{
-		current_led = RED;
-	}
-}
-
-static void RTCoreMsgTask(void* pParameters)
-{
-	int rand_number;
-
-#ifdef OEM_AVNET
-	mtk_os_hal_i2c_ctrl_init(i2c_port_num);		// Initialize MT3620 I2C bus
-	i2c_enum();									// Enumerate I2C Bus
-	i2c_init();
-	lsm6dso_init(i2c_write, i2c_read);
-#endif // OEM_AVNET	
-
-	srand((unsigned int)time(NULL)); // seed the random number generator for fake telemetry
-
-	while (1)
-	{
-		dataSize = sizeof(buf);
-		int r = DequeueData(outbound, inbound, sharedBufSize, buf, &dataSize);
-		
-		if (r == 0 && dataSize > payloadStart)
-		{
-			HLAppReady = true;
-
-			memcpy((void*)&ic_control_block, (void*)&buf[payloadStart], sizeof(ic_control_block));
-
-			switch (ic_control_block.cmd)
-			{
-			case LP_IC_HEARTBEAT:
-				break;
-			case LP_IC_SET_DESIRED_TEMPERATURE:
-				desired_temperature = round(ic_control_block.temperature);
-				SetTemperatureStatus(last_temperature);
-				break;
-			case LP_IC_BLINK_RATE:
-				blinkIntervalIndex = ic_control_block.blinkRate % numBlinkIntervals;
-				break;
-			case LP_IC_TEMPERATURE_PRESSURE_HUMIDITY:
-
-#ifdef OEM_AVNET
-
-				ic_control_block.cmd = LP_IC_TEMPERATURE_PRESSURE_HUMIDITY;
-				ic_control_block.temperature = get_temperature();
-
-				rand_number = (rand() % 20) - 10;
-				ic_control_block.humidity = (float)(50.0 + rand_number);
-
-				rand_number = (rand() % 50) - 25;
-				ic_control_block.pressure = (float)(1000.0 + rand_number);
-
-#endif // OEM_AVNET
-
-// The Seeed Studio Developer boards do not include any sensors so create some fake telemetry
-#if defined(OEM_SEEED_STUDIO) || defined (OEM_SEEED_STUDIO_MINI)
-
-				ic_control_block.cmd = LP_IC_TEMPERATURE_PRESSURE_HUMIDITY;
-
-				rand_number = (rand() % 10) - 5;
-				ic_control_block.temperature = (float)(25.0 + rand_number);
-
-				rand_number = (rand() % 20) - 10;
-				ic_control_block.humidity = (float)(50.0 + rand_number);
-
-				rand_number = (rand() % 50) - 25;
-				ic_control_block.pressure = (float)(1000.0 + rand_number);				
-
-#endif // OEM_SEEED_STUDIO
-
-				send_inter_core_msg();
-
-				last_temperature = round(ic_control_block.temperature);
-				SetTemperatureStatus(last_temperature);
-
-				break;
-			default:
-				break;
-			}
-		}
-
-		// Delay for 100ms
-		vTaskDelay(pdMS_TO_TICKS(100));
-	}
-}
-
-#ifdef OEM_SEEED_STUDIO_MINI
-static void VirtualButtonTask(void* pParameters)
-{
-	static bool toggle = false;
-	printf("Button Task Started\n");
-
-	while (1)
-	{
-		if (toggle)
-		{
-			blinkIntervalIndex = (blinkIntervalIndex + 1) % numBlinkIntervals;
-			ic_control_block.cmd = LP_IC_EVENT_BUTTON_A;
-			send_inter_core_msg();
-		}
-		else
-		{
-			ic_control_block.cmd = LP_IC_EVENT_BUTTON_B;
-			send_inter_core_msg();
-
-			ic_control_block.cmd = LP_IC_BLINK_RATE;
-			ic_control_block.blinkRate = blinkIntervalIndex;
-			send_inter_core_msg();
-		}
-
-		toggle = !toggle;
-
-		vTaskDelay(pdMS_TO_TICKS(10000));	// 10 seconds
-	}
-}
-#endif
-
 
 _Noreturn void RTCoreMain(void)
 {
@@ -453,27 +161,16 @@ _Noreturn void RTCoreMain(void)
 
 	// Init UART
 	mtk_os_hal_uart_ctlr_init(UART_PORT_NUM);
+	uart_log_open(UART_PORT_NUM);
 	printf("\nFreeRTOS GPIO Demo\n");
 
-
-	// Initialize Inter-Core Communications
-	if (GetIntercoreBuffers(&outbound, &inbound, &sharedBufSize) == -1)
-	{
-		for (;;)
-		{
-			// empty.
-		}
-	}
-
-	LEDSemphr = xSemaphoreCreateBinary();
-
-	xTaskCreate(SetLedBlinkRateTask, "Periodic Task", APP_STACK_SIZE_BYTES, NULL, 6, NULL);
-	xTaskCreate(LedTask, "LED Task", APP_STACK_SIZE_BYTES, NULL, 5, NULL);
-	xTaskCreate(ButtonTask, "GPIO Task", APP_STACK_SIZE_BYTES, NULL, 4, NULL);
-#ifdef OEM_SEEED_STUDIO_MINI
-	xTaskCreate(VirtualButtonTask, "GPIO Task", APP_STACK_SIZE_BYTES, NULL, 4, NULL);
-#endif
-	xTaskCreate(RTCoreMsgTask, "RTCore Msg Task", APP_STACK_SIZE_BYTES, NULL, 2, NULL);
+#ifdef RTOS_BENCH
+	// the kernel benchmarks in place of the application, the same source as the ThreadX lab runs
+	rtos_bench_start();
+#else
+	// the application is shared with the ThreadX lab, see LearningPathLibrary/rtcore
+	rtcore_app_start();
+#endif // RTOS_BENCH
 	vTaskStartScheduler();
 
 	for (;;)
@@ -481,4 +178,3 @@ _Noreturn void RTCoreMain(void)
 		__asm__("wfi");
 	}
 }
-
@@ -0,0 +1,116 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mt3620.h"
+#include "os_hal_gpt.h"
+
+/* Tickless idle on the GPT rather than the SysTick: at 197.6 MHz the 24 bit SysTick cannot count past
+   84 ms, GPT0 sleeps for up to an hour in one go. GPT0 only wakes the core, the time slept is read off
+   the free-running GPT2 the run time statistics also count on, so a sleep ended early by any other
+   interrupt is accounted for too. The core only clock gates in WFI, deeper sleeps would stop the
+   mailbox and UART interrupts from waking it. */
+#define TICKLESS_WAKE_GPT OS_HAL_GPT0		/* one-shot, counts down at 32 kHz and interrupts at zero */
+#define TICKLESS_CLOCK_GPT OS_HAL_GPT2		/* free-running at 32 kHz */
+#define TICKLESS_GPT_HZ 32768
+#define TICKLESS_MAX_TICKS (3600 * configTICK_RATE_HZ)
+#define SYSTICK_COUNTS_PER_TICK (configCPU_CLOCK_HZ / configTICK_RATE_HZ)
+
+static bool gpt_ready = false;
+
+/* the interrupt only has to end the WFI */
+static void tickless_wake(void *data) {
+}
+
+static struct os_gpt_int wake_int = { .gpt_cb_hdl = tickless_wake, .gpt_cb_data = NULL };
+
+static void tickless_gpt_init(void) {
+	mtk_os_hal_gpt_init();
+	mtk_os_hal_gpt_config(TICKLESS_WAKE_GPT, true, &wake_int);
+
+	/* both fail harmlessly when the run time statistics already started GPT2 */
+	mtk_os_hal_gpt_config(TICKLESS_CLOCK_GPT, true, NULL);
+	mtk_os_hal_gpt_start(TICKLESS_CLOCK_GPT);
+
+	gpt_ready = true;
+}
+
+static void systick_restart(uint32_t counts) {
+	if (counts == 0 || counts > SYSTICK_COUNTS_PER_TICK)
+		counts = SYSTICK_COUNTS_PER_TICK;
+
+	/* the first tick comes after counts, the ones after it a full period apart */
+	SysTick->LOAD = counts - 1;
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+	SysTick->LOAD = SYSTICK_COUNTS_PER_TICK - 1;
+}
+
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime) {
+	TickType_t idle_time;
+	uint32_t tick_left, start, ticks;
+	uint64_t sleep_counts, phase;
+
+	if (!gpt_ready)
+		tickless_gpt_init();
+
+	if (xExpectedIdleTime > TICKLESS_MAX_TICKS)
+		xExpectedIdleTime = TICKLESS_MAX_TICKS;
+
+	/* PRIMASK, not BASEPRI, so the interrupt that ends the sleep still wakes the core */
+	__asm volatile("cpsid i" ::: "memory");
+	__asm volatile("dsb");
+	__asm volatile("isb");
+
+	if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+		__asm volatile("cpsie i" ::: "memory");
+		return;
+	}
+
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+	/* a tick that fell due before the SysTick stopped is left for the kernel to take */
+	if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+		SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+		__asm volatile("cpsie i" ::: "memory");
+		return;
+	}
+
+	tick_left = SysTick->VAL;
+	start = mtk_os_hal_gpt_get_cur_count(TICKLESS_CLOCK_GPT);
+
+	/* wake on the tick the kernel expects to unblock a task on, part of the current tick is already gone */
+	sleep_counts = ((uint64_t)tick_left + (uint64_t)(xExpectedIdleTime - 1) * SYSTICK_COUNTS_PER_TICK) *
+		TICKLESS_GPT_HZ / configCPU_CLOCK_HZ;
+	if (sleep_counts == 0)
+		sleep_counts = 1;
+
+	mtk_os_hal_gpt_reset_timer(TICKLESS_WAKE_GPT, (unsigned int)sleep_counts, false);
+	mtk_os_hal_gpt_restart(TICKLESS_WAKE_GPT);
+	mtk_os_hal_gpt_start(TICKLESS_WAKE_GPT);
+
+	idle_time = xExpectedIdleTime;
+	configPRE_SLEEP_PROCESSING(idle_time);
+	if (idle_time > 0) {
+		__asm volatile("dsb" ::: "memory");
+		__asm volatile("wfi");
+		__asm volatile("isb");
+	}
+	configPOST_SLEEP_PROCESSING(xExpectedIdleTime);
+
+	mtk_os_hal_gpt_stop(TICKLESS_WAKE_GPT);
+
+	/* SysTick counts since the tick boundary before the sleep */
+	phase = (SYSTICK_COUNTS_PER_TICK - tick_left) +
+		(uint64_t)(uint32_t)(mtk_os_hal_gpt_get_cur_count(TICKLESS_CLOCK_GPT) - start) * configCPU_CLOCK_HZ / TICKLESS_GPT_HZ;
+	ticks = (uint32_t)(phase / SYSTICK_COUNTS_PER_TICK);
+
+	if (ticks >= xExpectedIdleTime) {
+		/* the unblocking tick is due, the tick interrupt takes it once the interrupts are enabled */
+		vTaskStepTick(xExpectedIdleTime - 1);
+		SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+	} else {
+		vTaskStepTick(ticks);		/* woken early by another interrupt */
+	}
+	systick_restart(SYSTICK_COUNTS_PER_TICK - (uint32_t)(phase % SYSTICK_COUNTS_PER_TICK));
+
+	__asm volatile("cpsie i" ::: "memory");
+}
@@ -40,6 +40,7 @@
 #include "printf.h"
 #include "mt3620.h"
 #include "os_hal_uart.h"
+#include "uart_log.h"
 
 /******************************************************************************/
 /* Configurations */
@@ -51,12 +52,12 @@ int main(void);
 /******************************************************************************/
 /* Application Hooks */
 /******************************************************************************/
-// Hook for "printf".
+// Hook for "printf", queued for the UART transmit interrupt so printf never waits on the line.
 void _putchar(char character)
 {
-    mtk_os_hal_uart_put_char(uart_port_num, character);
+    uart_log_putc(character);
     if (character == '\n')
-        mtk_os_hal_uart_put_char(uart_port_num, '\r');
+        uart_log_putc('\r');
 }
 
 _Noreturn void RTCoreMain(void)
@@ -67,6 +68,7 @@ _Noreturn void RTCoreMain(void)
 
     // Init UART
     mtk_os_hal_uart_ctlr_init(uart_port_num);
+    uart_log_open(uart_port_num);
     printf("UART Initialized (port_num=%d)\n", uart_port_num);
 
     main();
@@ -0,0 +1,151 @@
+#include "tx_api.h"
+#include "tx_timer.h"
+#include "os_hal_gpt.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef TX_LOW_POWER
+
+/* Tickless idle for ThreadX, the scheduler's idle loop calls tx_low_power_enter before its WFI and
+   tx_low_power_exit after it, with interrupts disabled. The 100 Hz SysTick is stopped for as long as no timer
+   list is due and GPT0 wakes the core on the tick that is, as tickless_idle.c does for FreeRTOS in Lab 5. The
+   time slept is read off the free-running GPT2, so a sleep ended early by any other interrupt is accounted for
+   too, and the skipped ticks are added to the system clock and the timer wheel. The core only clock gates in
+   WFI, deeper sleeps would stop the mailbox and UART interrupts from waking it. */
+#define TICKLESS_WAKE_GPT OS_HAL_GPT0		/* one-shot, counts down at 32 kHz and interrupts at zero */
+#define TICKLESS_CLOCK_GPT OS_HAL_GPT2		/* free-running at 32 kHz */
+#define TICKLESS_GPT_HZ 32768
+#define TICKLESS_CPU_HZ 197600000			/* the core clock the SysTick counts */
+#define TICKLESS_MAX_TICKS (10 * TX_TIMER_TICKS_PER_SECOND)	/* with no timer active, inside a wrap of the profiler's cycle counter */
+#define SYSTICK_COUNTS_PER_TICK (200000000 / TX_TIMER_TICKS_PER_SECOND)	/* the reload tx_initialize_low_level.S sets */
+
+/* SysTick and SCB by address, mt3620.h clashes with the ThreadX types */
+#define SYST_CSR (*(volatile ULONG *)0xE000E010)
+#define SYST_RVR (*(volatile ULONG *)0xE000E014)
+#define SYST_CVR (*(volatile ULONG *)0xE000E018)
+#define SYST_CSR_ENABLE (1UL << 0)
+#define SCB_ICSR (*(volatile ULONG *)0xE000ED04)
+#define SCB_ICSR_PENDSTSET (1UL << 26)
+
+VOID tx_low_power_enter(VOID);
+VOID tx_low_power_exit(VOID);
+
+static bool gpt_ready = false;
+static bool sleeping = false;		/* the SysTick is stopped and GPT0 armed */
+static ULONG sleep_ticks;			/* the tick the sleep ends on, a timer list may be due on it */
+static ULONG tick_left;				/* SysTick counts to the tick boundary when it stopped */
+static uint32_t sleep_start;
+
+/* the interrupt only has to end the WFI */
+static void tickless_wake(void *data) {
+}
+
+static struct os_gpt_int wake_int = { .gpt_cb_hdl = tickless_wake, .gpt_cb_data = NULL };
+
+static void tickless_gpt_init(void) {
+	mtk_os_hal_gpt_init();
+	mtk_os_hal_gpt_config(TICKLESS_WAKE_GPT, true, &wake_int);
+	mtk_os_hal_gpt_config(TICKLESS_CLOCK_GPT, true, NULL);
+	mtk_os_hal_gpt_start(TICKLESS_CLOCK_GPT);
+
+	gpt_ready = true;
+}
+
+/* Ticks to the first timer list that is not empty, the sleep must not pass the tick it is due on. A list may
+   hold a timer a wheel turn or more away, the core still wakes for it so the tick interrupt moves it on */
+static ULONG ticks_to_next_list(void) {
+	TX_TIMER_INTERNAL **list = _tx_timer_current_ptr;
+	ULONG ticks;
+
+	for (ticks = 1; ticks <= TX_TIMER_ENTRIES; ticks++) {
+		if (*list != TX_NULL)
+			return ticks;
+		if (++list == _tx_timer_list_end)
+			list = _tx_timer_list_start;
+	}
+	return TICKLESS_MAX_TICKS;
+}
+
+/* what the tick interrupt would have done for ticks that found every list they passed empty */
+static void skip_ticks(ULONG ticks) {
+	ULONG slot = (ULONG)(_tx_timer_current_ptr - _tx_timer_list_start);
+
+	_tx_timer_system_clock += ticks;
+	_tx_timer_current_ptr = _tx_timer_list_start + (slot + ticks) % TX_TIMER_ENTRIES;
+}
+
+static void systick_restart(ULONG counts) {
+	if (counts == 0 || counts > SYSTICK_COUNTS_PER_TICK)
+		counts = SYSTICK_COUNTS_PER_TICK;
+
+	/* the first tick comes after counts, the ones after it a full period apart */
+	SYST_RVR = counts - 1;
+	SYST_CVR = 0;
+	SYST_CSR |= SYST_CSR_ENABLE;
+	SYST_RVR = SYSTICK_COUNTS_PER_TICK - 1;
+}
+
+VOID tx_low_power_enter(VOID) {
+	uint64_t sleep_counts;
+
+	sleeping = false;
+	if (!gpt_ready)
+		tickless_gpt_init();
+
+	/* a time slice counts down on every tick and expiries are still being processed, keep the tick */
+	if (_tx_timer_time_slice != 0 || _tx_timer_expired)
+		return;
+
+	sleep_ticks = ticks_to_next_list();
+	if (sleep_ticks < 2)
+		return;		/* due on the next tick, the SysTick wakes the core for it */
+
+	SYST_CSR &= ~SYST_CSR_ENABLE;
+
+	/* a tick that fell due before the SysTick stopped is left for the tick interrupt to take */
+	if (SCB_ICSR & SCB_ICSR_PENDSTSET) {
+		SYST_CSR |= SYST_CSR_ENABLE;
+		return;
+	}
+
+	tick_left = SYST_CVR;
+	sleep_start = mtk_os_hal_gpt_get_cur_count(TICKLESS_CLOCK_GPT);
+
+	/* wake on the tick the next list is due on, part of the current tick is already gone */
+	sleep_counts = ((uint64_t)tick_left + (uint64_t)(sleep_ticks - 1) * SYSTICK_COUNTS_PER_TICK) *
+		TICKLESS_GPT_HZ / TICKLESS_CPU_HZ;
+	if (sleep_counts == 0)
+		sleep_counts = 1;
+
+	mtk_os_hal_gpt_reset_timer(TICKLESS_WAKE_GPT, (unsigned int)sleep_counts, false);
+	mtk_os_hal_gpt_restart(TICKLESS_WAKE_GPT);
+	mtk_os_hal_gpt_start(TICKLESS_WAKE_GPT);
+	sleeping = true;
+}
+
+VOID tx_low_power_exit(VOID) {
+	uint64_t phase;
+	ULONG ticks;
+
+	if (!sleeping)
+		return;
+	sleeping = false;
+
+	mtk_os_hal_gpt_stop(TICKLESS_WAKE_GPT);
+
+	/* SysTick counts since the tick boundary before the sleep */
+	phase = (SYSTICK_COUNTS_PER_TICK - tick_left) +
+		(uint64_t)(uint32_t)(mtk_os_hal_gpt_get_cur_count(TICKLESS_CLOCK_GPT) - sleep_start) * TICKLESS_CPU_HZ / TICKLESS_GPT_HZ;
+	ticks = (ULONG)(phase / SYSTICK_COUNTS_PER_TICK);
+
+	if (ticks >= sleep_ticks) {
+		/* the tick the list is due on, the tick interrupt takes it once the interrupts are enabled */
+		skip_ticks(sleep_ticks - 1);
+		SCB_ICSR = SCB_ICSR_PENDSTSET;
+	} else {
+		skip_ticks(ticks);		/* woken early by another interrupt */
+	}
+	systick_restart(SYSTICK_COUNTS_PER_TICK - (ULONG)(phase % SYSTICK_COUNTS_PER_TICK));
+}
+
+#endif /* TX_LOW_POWER */
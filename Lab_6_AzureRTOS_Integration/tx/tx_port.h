@@ -167,7 +167,16 @@ typedef unsigned short                          USHORT;
 #define TX_THREAD_EXTENSION_0          
 #define TX_THREAD_EXTENSION_1                  
 #define TX_THREAD_EXTENSION_2                   
+#ifdef TX_EXECUTION_PROFILE_ENABLE
+#ifndef TX_ENABLE_EXECUTION_CHANGE_NOTIFY
+#define TX_ENABLE_EXECUTION_CHANGE_NOTIFY
+#endif
+#define TX_THREAD_EXTENSION_3           unsigned long long  tx_thread_execution_time_total; \
+                                        unsigned long long  tx_thread_execution_time_last_start; \
+                                        unsigned long long  tx_thread_execution_time_reported;
+#else
 #define TX_THREAD_EXTENSION_3          
+#endif
 
 
 /* Define the port extensions of the remaining ThreadX objects.  */
@@ -38,12 +38,20 @@
 
 // Learning Path Libraries
 #include "azure_iot.h"
+#include "binding_tables.h"
+#include "control_latency.h"
+#include "dcm_model.h"		// generated at build time from iot_central/Azure_Sphere_Developer_Learning_Path.json
+#include "event_loop.h"
 #include "exit_codes.h"
 #include "globals.h"
+#include "health_telemetry.h"
 #include "inter_core.h"
+#include "memory_governor.h"
 #include "peripheral_gpio.h"
+#include "shared/anomaly_model_format.h"
 #include "terminate.h"
 #include "timer.h"
+#include "update_deferral.h"
 
 // System Libraries
 #include "applibs_versions.h"
@@ -52,6 +60,7 @@
 #include <applibs/powermanagement.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 
 // Hardware specific
@@ -67,55 +76,117 @@
 #endif // SEEED_STUDIO
 
 #define JSON_MESSAGE_BYTES 256  // Number of bytes to allocate for the JSON telemetry message for IoT Central
+#define EVENT_RULES_BYTES 160	// longest EventRules twin string, four rules
+#define MODBUS_POLLS_BYTES 192	// longest ModbusPolls twin string, eight polls
 
 // Forward signatures
 static void Led2OffHandler(EventLoopTimer* eventLoopTimer);
 static void MeasureSensorHandler(EventLoopTimer* eventLoopTimer);
 static void NetworkConnectionStatusHandler(EventLoopTimer* eventLoopTimer);
 static void InterCoreHandler(LP_INTER_CORE_BLOCK* ic_message_block);
+static void ProcessInterCoreMessage(void* context);
+static void MeasureSensorResponseHandler(LP_INTER_CORE_BLOCK* ic_message_block, bool timedOut);
 static void ResetDeviceHandler(EventLoopTimer* eventLoopTimer);
-static void DeviceTwinSetTemperatureHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
-static void DeviceTwinBlinkRateHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+static void DeviceTwinCommitHandler(LP_DEVICE_TWIN_BINDING* changed[], size_t changedCount);
 static void DeviceTwinRelay1Handler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+static void DeviceTwinEventRulesHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+static LP_C2D_DISPOSITION EventRulesMessageHandler(const unsigned char* body, size_t length, LP_CLOUD_MESSAGE_BINDING* cloudMessageBinding);
+static LP_C2D_DISPOSITION AnomalyModelMessageHandler(const unsigned char* body, size_t length, LP_CLOUD_MESSAGE_BINDING* cloudMessageBinding);
+static void DeviceTwinProfilePeriodHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+static void DeviceTwinAudioPeriodHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+static void DeviceTwinModbusPollsHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+static void DeviceTwinThermostatHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+static void DeviceTwinSamplingPolicyHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
 static LP_DIRECT_METHOD_RESPONSE_CODE ResetDirectMethodHandler(JSON_Object* json, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg);
 
 static char msgBuffer[JSON_MESSAGE_BYTES] = { 0 };
 static const char cstrJsonEvent[] = "{\"%s\":\"occurred\"}";
+static const char cstrJsonRuleEvent[] = "{\"RuleEvent\":{\"rule\":%u,\"channel\":\"%s\",\"active\":%s,\"value\":%.2f}}";
+static const char cstrJsonTelemetrySummary[] = "{\"TelemetrySummary\":{\"channel\":\"%s\",\"samples\":%u,\"min\":%.2f,\"max\":%.2f,\"mean\":%.2f,\"stddev\":%.2f,\"last\":%.2f}}";
+static const char cstrJsonThreadProfile[] = "{\"ThreadProfile\":{\"index\":%u,\"count\":%u,\"thread\":\"%s\",\"cpu\":%.1f,\"switches\":%u,\"stackUsed\":%u,\"stackSize\":%u}}";
+static const char cstrJsonHeapProfile[] = "{\"HeapProfile\":{\"size\":%u,\"free\":%u,\"minFree\":%u}}";
+static const char cstrJsonBusProfile[] = "{\"BusProfile\":{\"busy\":%.1f,\"requests\":%u,\"transfers\":%u,\"bytes\":%u,\"maxWaitUs\":%u,\"errors\":%u}}";
+static const char cstrJsonWatchdog[] = "{\"Watchdog\":{\"reset\":\"%s\",\"task\":\"%s\"}}";
+static const char cstrJsonAudioFeatures[] = "{\"AudioFeatures\":{\"periodMs\":%u,\"frames\":%u,\"rms\":%.1f,\"peak\":%.1f,\"bands\":[%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f]}}";
+static const char cstrJsonSampleJitter[] = "{\"SampleJitter\":{\"periodUs\":%u,\"intervals\":%u,\"missed\":%u,\"minErrorUs\":%d,\"maxErrorUs\":%d,\"maxLateUs\":%u,\"histogram\":[%u,%u,%u,%u,%u,%u,%u,%u]}}";
+static const char cstrJsonThermostat[] = "{\"Thermostat\":{\"mode\":\"%s\",\"relay\":%s,\"temperature\":%.2f,\"setpoint\":%.2f,\"output\":%.2f}}";
+static const char cstrJsonAnomaly[] = "{\"Anomaly\":{\"active\":%s,\"score\":%.3f,\"threshold\":%.3f,\"model\":%u,\"windows\":%u}}";
+static const char cstrJsonModbusReadings[] = "{\"ModbusReadings\":{\"poll\":%u,\"slave\":%u,\"first\":%u,\"status\":%u,\"values\":[";
+static const char* resetCauseNames[] = { [LP_IC_RESET_POWER_ON] = "power_on", [LP_IC_RESET_SOFTWARE] = "software", [LP_IC_RESET_WATCHDOG] = "watchdog" };
+static const char* channelNames[LP_IC_CHANNEL_COUNT] = { [LP_IC_CHANNEL_ACCELERATION] = "acceleration", [LP_IC_CHANNEL_ANGULAR_RATE] = "angular_rate" };
+static const char* ruleKindNames[] = { [LP_IC_RULE_ABOVE] = "above", [LP_IC_RULE_BELOW] = "below", [LP_IC_RULE_RATE] = "rate" };
+static const char* thermostatModeNames[] = { [LP_IC_THERMOSTAT_OFF] = "off", [LP_IC_THERMOSTAT_HYSTERESIS] = "hysteresis", [LP_IC_THERMOSTAT_PID] = "pid" };
+static const char* thermostatActionNames[] = { "heat", "cool" };
 static const struct timespec sendMsgLedBlinkPeriod = { 0, 500 * 1000 * 1000 };
+static const unsigned int telemetryTraceEvery = 0;	// sensor readings per latency trace, 0 for none, see tools/telemetry-trace
+static const int timeSyncPeriodMs = 10000;	// how often the real-time core's clock is related to this one, its readings carry their sample time
+// NULL, or "ControlLatency" to report how long each LedBlinkRate and Relay1 change takes to reach its actuator, see
+// tools/device-twin-test/dt_latency.py
+static const char* controlLatencyProperty = NULL;
+// sheds load well short of the high-level app's 256 KiB limit, a large method payload is refused rather than parsed
+static const LP_MEMORY_WATERMARKS memoryWatermarks = { .elevatedKB = 176, .criticalKB = 216, .maxPayloadBytes = 4096 };
 LP_INTER_CORE_BLOCK ic_control_block;
 
 
 // GPIO Output PeripheralGpios
-static LP_PERIPHERAL_GPIO led2 = { .pin = LED2, .direction = LP_OUTPUT, .initialState = GPIO_Value_Low, .invertPin = true,
-	.initialise = lp_openPeripheralGpio, .name = "led2" };
-
-static LP_PERIPHERAL_GPIO networkConnectedLed = { .pin = NETWORK_CONNECTED_LED, .direction = LP_OUTPUT, .initialState = GPIO_Value_Low, .invertPin = true,
-	.initialise = lp_openPeripheralGpio, .name = "networkConnectedLed" };
-
-static LP_PERIPHERAL_GPIO relay1 = { .pin = RELAY, .direction = LP_OUTPUT, .initialState = GPIO_Value_Low, .invertPin = false,
-	.initialise = lp_openPeripheralGpio, .name = "relay1" };
+#define PERIPHERAL_GPIOS(GPIO_OUTPUT, GPIO_INPUT, BINDING) \
+	GPIO_OUTPUT(networkConnectedLed, NETWORK_CONNECTED_LED, GPIO_Value_Low, true) \
+	GPIO_OUTPUT(led2, LED2, GPIO_Value_Low, true) \
+	GPIO_OUTPUT(relay1, RELAY, GPIO_Value_Low, false)
 
 // Timers
-static LP_TIMER led2BlinkOffOneShotTimer = { .period = { 0, 0 }, .name = "led2BlinkOffOneShotTimer", .handler = Led2OffHandler };
-static LP_TIMER networkConnectionStatusTimer = { .period = { 5, 0 }, .name = "networkConnectionStatusTimer", .handler = NetworkConnectionStatusHandler };
-static LP_TIMER measureSensorTimer = { .period = { 10, 0 }, .name = "measureSensorTimer", .handler = MeasureSensorHandler };
-static LP_TIMER resetDeviceOneShotTimer = { .period = { 0, 0 }, .name = "resetDeviceOneShotTimer", .handler = ResetDeviceHandler };
-
-// Azure IoT Device Twins
-static LP_DEVICE_TWIN_BINDING buttonPressed = { .twinProperty = "ButtonPressed", .twinType = LP_TYPE_STRING };
-static LP_DEVICE_TWIN_BINDING desiredTemperature = { .twinProperty = "DesiredTemperature", .twinType = LP_TYPE_FLOAT, .handler = DeviceTwinSetTemperatureHandler };
-static LP_DEVICE_TWIN_BINDING led1BlinkRate = { .twinProperty = "LedBlinkRate", .twinType = LP_TYPE_INT, .handler = DeviceTwinBlinkRateHandler };
-static LP_DEVICE_TWIN_BINDING relay1DeviceTwin = { .twinProperty = "Relay1", .twinType = LP_TYPE_BOOL, .handler = DeviceTwinRelay1Handler };
-static LP_DEVICE_TWIN_BINDING deviceResetUtc = { .twinProperty = "DeviceResetUTC", .twinType = LP_TYPE_STRING };
+// slack lets the status and sensor timers share a wakeup, the 5 and 10 second periods then align
+static LP_TIMER networkConnectionStatusTimer = { .period = { 5, 0 }, .name = "networkConnectionStatusTimer", .handler = NetworkConnectionStatusHandler, .slack = { 1, 0 } };
+static LP_TIMER measureSensorTimer = { .period = { 10, 0 }, .name = "measureSensorTimer", .handler = MeasureSensorHandler, .slack = { 1, 0 } };
+static unsigned telemetryPeriodSeconds = 10;	// measureSensorTimer, reported with the SamplingPolicy
+
+// Cloud to device messages with a maxSize
+static LP_CLOUD_MESSAGE_BINDING anomalyModelMessage = { .messageType = "AnomalyModel", .handler = AnomalyModelMessageHandler, .maxSize = LP_ANOMALY_MAX_SIZE };
+
+// Direct methods the real-time app answers, the payload goes to it unparsed and its reply is the response
+static LP_DIRECT_METHOD_BINDING rtStatusDirectMethod = { .methodName = "RtStatus", .forwardCode = LP_IC_METHOD_RT_STATUS };
+
+#define TIMERS(TIMER, BINDING) \
+	TIMER(led2BlinkOffOneShotTimer, 0, 0, Led2OffHandler) \
+	BINDING(networkConnectionStatusTimer) \
+	BINDING(measureSensorTimer) \
+	TIMER(resetDeviceOneShotTimer, 0, 0, ResetDeviceHandler)
+
+// Azure IoT Device Twins, in property name order so the library searches the set in place
+// DesiredTemperature and DeviceResetUTC bindings are generated from the IoT Central device template, see dcm_model.h
+#define DEVICE_TWINS(TWIN, BINDING) \
+	TWIN(anomalyModelVersion, "AnomalyModelVersion", LP_TYPE_INT, NULL) \
+	TWIN(audioPeriod, "AudioPeriod", LP_TYPE_INT, DeviceTwinAudioPeriodHandler) \
+	TWIN(buttonPressed, "ButtonPressed", LP_TYPE_STRING, NULL) \
+	BINDING(dcm_DesiredTemperature) \
+	BINDING(dcm_DeviceResetUTC) \
+	TWIN(eventRules, "EventRules", LP_TYPE_STRING, DeviceTwinEventRulesHandler) \
+	TWIN(led1BlinkRate, "LedBlinkRate", LP_TYPE_INT, NULL) \
+	TWIN(modbusPolls, "ModbusPolls", LP_TYPE_STRING, DeviceTwinModbusPollsHandler) \
+	TWIN(relay1DeviceTwin, "Relay1", LP_TYPE_BOOL, DeviceTwinRelay1Handler) \
+	TWIN(rtProfilePeriod, "RtProfilePeriod", LP_TYPE_INT, DeviceTwinProfilePeriodHandler) \
+	TWIN(samplingPolicy, "SamplingPolicy", LP_TYPE_STRING, DeviceTwinSamplingPolicyHandler) \
+	TWIN(telemetryDictionary, "TelemetryDictionary", LP_TYPE_STRING, NULL) \
+	TWIN(thermostat, "Thermostat", LP_TYPE_STRING, DeviceTwinThermostatHandler)
 
 // Azure IoT Direct Methods
-static LP_DIRECT_METHOD_BINDING resetDevice = { .methodName = "ResetMethod", .handler = ResetDirectMethodHandler };
+#define DIRECT_METHODS(METHOD, BINDING) \
+	BINDING(lp_batchDirectMethod) \
+	METHOD(resetDevice, "ResetMethod", ResetDirectMethodHandler) \
+	BINDING(rtStatusDirectMethod) \
+	BINDING(lp_timerProfileDirectMethod)
+
+// Cloud to device messages, dispatched on their type property
+#define CLOUD_MESSAGES(MESSAGE, BINDING) \
+	BINDING(anomalyModelMessage) \
+	MESSAGE(eventRulesMessage, "EventRules", EventRulesMessageHandler)
 
 // Initialize Sets
-LP_PERIPHERAL_GPIO* peripheralGpioSet[] = { &networkConnectedLed, &led2, &relay1 };
-LP_TIMER* timerSet[] = { &led2BlinkOffOneShotTimer, &networkConnectionStatusTimer, &measureSensorTimer, &resetDeviceOneShotTimer };
-LP_DEVICE_TWIN_BINDING* deviceTwinBindingSet[] = { &led1BlinkRate, &buttonPressed, &desiredTemperature, &relay1DeviceTwin, &deviceResetUtc };
-LP_DIRECT_METHOD_BINDING* directMethodBindingSet[] = { &resetDevice };
+LP_PERIPHERAL_GPIO_TABLE(peripheralGpioSet, PERIPHERAL_GPIOS);
+LP_TIMER_TABLE(timerSet, TIMERS);
+LP_DEVICE_TWIN_TABLE(deviceTwinBindingSet, DEVICE_TWINS);
+LP_DIRECT_METHOD_TABLE(directMethodBindingSet, DIRECT_METHODS);
+LP_CLOUD_MESSAGE_TABLE(cloudMessageBindingSet, CLOUD_MESSAGES);
 
 // Message property set
 static LP_MESSAGE_PROPERTY messageAppId = { .key = "appid", .value = "hvac" };
@@ -123,6 +194,17 @@ static LP_MESSAGE_PROPERTY messageType = { .key = "type", .value = "telemetry" }
 static LP_MESSAGE_PROPERTY messageFormat = { .key = "format", .value = "json" };
 static LP_MESSAGE_PROPERTY messageVersion = { .key = "version", .value = "1" };
 static LP_MESSAGE_PROPERTY* telemetryMessageProperties[] = { &messageAppId, &messageType, &messageFormat, &messageVersion };
+static LP_MESSAGE_PROPERTY_TEMPLATE telemetryPropertyTemplate;
+
+// add_compile_definitions(TELEMETRY_COMPACT_KEYS) in CMakeLists.txt sends the sensor telemetry with the short keys of
+// dcm_telemetryDictionary, reported as TelemetryDictionary, for a hub route that expands them, see tools/telemetry-dictionary.
+// IoT Central reads only the full names.
+#ifdef TELEMETRY_COMPACT_KEYS
+static LP_MESSAGE_PROPERTY messageDictionary = { .key = "dict", .value = DCM_DICTIONARY_VERSION };
+static LP_MESSAGE_PROPERTY* compactMessageProperties[] = { &messageAppId, &messageType, &messageFormat, &messageVersion, &messageDictionary };
+static LP_MESSAGE_PROPERTY_TEMPLATE compactPropertyTemplate;
+static bool dictionaryReported = false;
+#endif
 
 
 /// <summary>
@@ -147,13 +229,28 @@ static void NetworkConnectionStatusHandler(EventLoopTimer* eventLoopTimer)
 }
 
 /// <summary>
-/// Device Twin Handler to set the desired temperature value on the Real-Time Core
+/// Device Twin commit, once all changed values of a twin update are applied. A new "DesiredTemperature" and
+/// "LedBlinkRate": {"value": 0} are queued for the Real-Time Core, they go as one inter-core message with any other
+/// settings the update changed.
 /// </summary>
-static void DeviceTwinSetTemperatureHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding)
+static void DeviceTwinCommitHandler(LP_DEVICE_TWIN_BINDING* changed[], size_t changedCount)
 {
-	ic_control_block.cmd = LP_IC_SET_DESIRED_TEMPERATURE;
-	ic_control_block.temperature = *(float*)deviceTwinBinding->twinState;
-	lp_sendInterCoreMessage(&ic_control_block, sizeof(ic_control_block));
+	for (size_t i = 0; i < changedCount; i++)
+	{
+		if (changed[i] == &dcm_DesiredTemperature)
+		{
+			lp_queueInterCoreMessage(&(LP_INTER_CORE_BLOCK){ .cmd = LP_IC_SET_DESIRED_TEMPERATURE, .temperature = *(float*)changed[i]->twinState });
+		}
+		else if (changed[i] == &led1BlinkRate)
+		{
+			LP_INTER_CORE_BLOCK blinkRate = { .cmd = LP_IC_BLINK_RATE, .blinkRate = *(int*)changed[i]->twinState };
+
+			if (!lp_controlLatencyRequest("LedBlinkRate", &blinkRate))		// benchmarking, sent now and answered once applied
+			{
+				lp_queueInterCoreMessage(&blinkRate);
+			}
+		}
+	}
 }
 
 /// <summary>
@@ -163,34 +260,357 @@ static void DeviceTwinRelay1Handler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding)
 {
 	if (*(bool*)deviceTwinBinding->twinState) { lp_gpioOn(&relay1); }
 	else { lp_gpioOff(&relay1); }
+	lp_controlLatencyActuated("Relay1");
+}
+
+/// <summary>
+/// Index of name in names, -1 when not found
+/// </summary>
+static int FindName(const char* const* names, size_t count, const char* name)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		if (names[i] != NULL && strcmp(names[i], name) == 0)
+		{
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+/// <summary>
+/// Parse event rules and queue them for the Real-Time Core, false when a rule was not understood or not queued
+/// "above,acceleration,1500,100;rate,angular_rate,300,50"
+/// Each rule is kind,channel,threshold,hysteresis, the rule id is its position and rules left out are cleared.
+/// Kind is above, below or rate (per second), channel is acceleration (mg) or angular_rate (dps)
+/// </summary>
+static bool ApplyEventRules(const char* text)
+{
+	LP_INTER_CORE_BLOCK rules[LP_IC_MAX_RULES] = { 0 };
+	char copy[EVENT_RULES_BYTES];
+	char kind[16], channel[16];
+	char* next = NULL;
+	char* rule;
+	int id = 0;
+	bool queued = true;
+
+	if (strlen(text) >= sizeof(copy))
+	{
+		Log_Debug("EventRules too long, not applied\n");
+		return false;
+	}
+	strcpy(copy, text);
+
+	for (rule = strtok_r(copy, ";", &next); rule != NULL; rule = strtok_r(NULL, ";", &next))
+	{
+		LP_INTER_CORE_BLOCK* block = &rules[id];
+		int kindIndex, channelIndex;
+
+		if (id == LP_IC_MAX_RULES ||
+			sscanf(rule, " %15[^,],%15[^,],%f,%f", kind, channel, &block->ruleThreshold, &block->ruleHysteresis) != 4 ||
+			(kindIndex = FindName(ruleKindNames, NELEMS(ruleKindNames), kind)) < 0 ||
+			(channelIndex = FindName(channelNames, NELEMS(channelNames), channel)) < 0)
+		{
+			Log_Debug("EventRules rule %d '%s' not understood, rules not applied\n", id, id == LP_IC_MAX_RULES ? "too many rules" : rule);
+			return false;
+		}
+
+		block->ruleKind = (uint8_t)kindIndex;
+		block->telemetryChannel = (uint8_t)channelIndex;
+		id++;
+	}
+
+	for (id = 0; id < LP_IC_MAX_RULES; id++)
+	{
+		rules[id].cmd = LP_IC_RULE;
+		rules[id].ruleId = (uint8_t)id;		// unused rules stay LP_IC_RULE_NONE and are cleared
+		if (!lp_queueInterCoreMessage(&rules[id]))
+		{
+			queued = false;
+		}
+	}
+
+	return queued;
+}
+
+/// <summary>
+/// Device Twin to set the event rules evaluated on the Real-Time Core
+/// "EventRules": {"value": "above,acceleration,1500,100;rate,angular_rate,300,50"}, see ApplyEventRules
+/// </summary>
+static void DeviceTwinEventRulesHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding)
+{
+	if (ApplyEventRules((char*)deviceTwinBinding->twinState))
+	{
+		lp_deviceTwinReportState(deviceTwinBinding, deviceTwinBinding->twinState);	// TwinType = LP_TYPE_STRING
+	}
+}
+
+/// <summary>
+/// Cloud to device message with the property type=EventRules and the rules as its body, as the EventRules twin
+/// takes them, for a rule set a back-end service sends rather than writes to the twin. The rules applied are
+/// reported on the EventRules property.
+/// </summary>
+static LP_C2D_DISPOSITION EventRulesMessageHandler(const unsigned char* body, size_t length, LP_CLOUD_MESSAGE_BINDING* cloudMessageBinding)
+{
+	char rules[EVENT_RULES_BYTES];
+
+	if (length >= sizeof(rules))
+	{
+		Log_Debug("EventRules message of %zu bytes too long, not applied\n", length);
+		return LP_C2D_REJECTED;
+	}
+	memcpy(rules, body, length);
+	rules[length] = 0;
+
+	if (!ApplyEventRules(rules))
+	{
+		return LP_C2D_REJECTED;
+	}
+
+	lp_deviceTwinReportState(&eventRules, rules);
+	return LP_C2D_ACCEPTED;
+}
+
+/// <summary>
+/// Cloud to device message with the property type=AnomalyModel and a model built by tools/anomaly-model as its body, for
+/// the anomaly scoring on the Real-Time Core. The model is checked here and sent on over inter-core, the Real-Time Core
+/// scores with it from its next feature window and the version it runs is reported on the AnomalyModelVersion property
+/// </summary>
+static LP_C2D_DISPOSITION AnomalyModelMessageHandler(const unsigned char* body, size_t length, LP_CLOUD_MESSAGE_BINDING* cloudMessageBinding)
+{
+	LP_ANOMALY_MODEL model;
+
+	if (!lp_anomalyModelParse(&model, body, length))
+	{
+		Log_Debug("AnomalyModel message of %zu bytes is not a model the Real-Time Core runs, not sent\n", length);
+		return LP_C2D_REJECTED;
+	}
+
+	if (!lp_sendInterCoreLarge(LP_IC_ANOMALY_MODEL, body, length))
+	{
+		return LP_C2D_ABANDONED;	// the model before is still going out, the hub redelivers this one
+	}
+
+	Log_Debug("AnomalyModel version %u sent to the Real-Time Core\n", model.version);
+	return LP_C2D_ACCEPTED;
+}
+
+/// <summary>
+/// Device Twin to profile the Real-Time Core threads "RtProfilePeriod": {"value": 60}, seconds between reports, 0 stops them
+/// </summary>
+static void DeviceTwinProfilePeriodHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding)
+{
+	int period = *(int*)deviceTwinBinding->twinState;
+
+	ic_control_block.cmd = LP_IC_PROFILE_REQUEST;
+	ic_control_block.profilePeriod = (uint16_t)(period < 0 ? 0 : period > UINT16_MAX ? UINT16_MAX : period);
+	if (lp_queueInterCoreMessage(&ic_control_block))
+	{
+		lp_deviceTwinReportState(deviceTwinBinding, deviceTwinBinding->twinState);	// TwinType = LP_TYPE_INT
+	}
+}
+
+/// <summary>
+/// Device Twin to capture audio on the Real-Time Core "AudioPeriod": {"value": 1000}, milliseconds per sound level report, 0 stops capture
+/// </summary>
+static void DeviceTwinAudioPeriodHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding)
+{
+	int period = *(int*)deviceTwinBinding->twinState;
+
+	ic_control_block.cmd = LP_IC_AUDIO_CAPTURE;
+	ic_control_block.audioPeriodMs = (uint16_t)(period < 0 ? 0 : period > UINT16_MAX ? UINT16_MAX : period);
+	if (lp_queueInterCoreMessage(&ic_control_block))
+	{
+		lp_deviceTwinReportState(deviceTwinBinding, deviceTwinBinding->twinState);	// TwinType = LP_TYPE_INT
+	}
 }
 
 /// <summary>
-/// Set Blink Rate using Device Twin "LedBlinkRate": {"value": 0}
+/// Device Twin to set the Modbus registers the Real-Time Core reads, "ModbusPolls": {"value": "1,0,4,5000;1,10,2,5000;2,100,8,60000"}
+/// Each poll is slave,first register,count,period ms, the poll number is its position and polls left out are cleared.
+/// Polls on one slave due together are read in one request where their registers are close
 /// </summary>
-static void DeviceTwinBlinkRateHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding)
+static void DeviceTwinModbusPollsHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding)
 {
-	// send request to Real-Time core app to change blink rate
-	ic_control_block.cmd = LP_IC_BLINK_RATE;
-	ic_control_block.blinkRate = *(int*)deviceTwinBinding->twinState;
-	lp_sendInterCoreMessage(&ic_control_block, sizeof(ic_control_block));
+	LP_INTER_CORE_BLOCK polls[LP_IC_MODBUS_POLLS] = { 0 };
+	char copy[MODBUS_POLLS_BYTES];
+	char* next = NULL;
+	char* poll;
+	unsigned slave, first, count, period;
+	int id = 0;
+	bool queued = true;
+
+	if (strlen((char*)deviceTwinBinding->twinState) >= sizeof(copy))
+	{
+		Log_Debug("ModbusPolls too long, not applied\n");
+		return;
+	}
+	strcpy(copy, (char*)deviceTwinBinding->twinState);
+
+	for (poll = strtok_r(copy, ";", &next); poll != NULL; poll = strtok_r(NULL, ";", &next))
+	{
+		if (id == LP_IC_MODBUS_POLLS || sscanf(poll, " %u,%u,%u,%u", &slave, &first, &count, &period) != 4 ||
+			slave < 1 || slave > 247 || count < 1 || count > LP_IC_MODBUS_REGISTERS || first + count > UINT16_MAX + 1)
+		{
+			Log_Debug("ModbusPolls poll %d '%s' not understood, polls not applied\n", id, id == LP_IC_MODBUS_POLLS ? "too many polls" : poll);
+			return;
+		}
+
+		polls[id].modbusSlave = (uint8_t)slave;
+		polls[id].modbusFirst = (uint16_t)first;
+		polls[id].modbusCount = (uint8_t)count;
+		polls[id].modbusPeriodMs = period;
+		id++;
+	}
+
+	for (id = 0; id < LP_IC_MODBUS_POLLS; id++)
+	{
+		polls[id].cmd = LP_IC_MODBUS_POLL;
+		polls[id].modbusPoll = (uint8_t)id;		// unused polls keep a count of zero and are cleared
+		if (!lp_queueInterCoreMessage(&polls[id]))
+		{
+			queued = false;
+		}
+	}
+
+	if (queued)
+	{
+		lp_deviceTwinReportState(deviceTwinBinding, deviceTwinBinding->twinState);	// TwinType = LP_TYPE_STRING
+	}
+}
+
+/// <summary>
+/// Device Twin to set how the Real-Time Core drives the relay from the temperature, against the DesiredTemperature setpoint
+/// "Thermostat": {"value": "hysteresis,heat,0.5"}, degrees either side of the setpoint
+/// "Thermostat": {"value": "pid,cool,0.5,0.002,30,20000"}, kp per degree, ki per degree second, kd per degree per second, window ms
+/// "Thermostat": {"value": "off"}, the relay is held open
+/// </summary>
+static void DeviceTwinThermostatHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding)
+{
+	LP_INTER_CORE_BLOCK settings = { .cmd = LP_IC_THERMOSTAT };
+	char mode[16], action[16];
+	float values[3] = { 0 };
+	unsigned window = 0;
+	int modeIndex = -1, actionIndex = 0;
+
+	int fields = sscanf((char*)deviceTwinBinding->twinState, " %15[^,],%15[^,],%f,%f,%f,%u", mode, action, &values[0], &values[1], &values[2], &window);
+
+	if (fields >= 1)
+	{
+		modeIndex = FindName(thermostatModeNames, NELEMS(thermostatModeNames), mode);
+	}
+	if (fields >= 2)
+	{
+		actionIndex = FindName(thermostatActionNames, NELEMS(thermostatActionNames), action);
+	}
+
+	if (actionIndex < 0 || !((modeIndex == LP_IC_THERMOSTAT_OFF && fields == 1) || (modeIndex == LP_IC_THERMOSTAT_HYSTERESIS && fields == 3) ||
+		(modeIndex == LP_IC_THERMOSTAT_PID && fields == 6)))
+	{
+		Log_Debug("Thermostat '%s' not understood, not applied\n", (char*)deviceTwinBinding->twinState);
+		return;
+	}
+
+	settings.thermostatMode = (uint8_t)modeIndex;
+	settings.thermostatCooling = (uint8_t)actionIndex;
+	if (modeIndex == LP_IC_THERMOSTAT_HYSTERESIS)
+	{
+		settings.thermostatHysteresis = values[0];
+	}
+	else if (modeIndex == LP_IC_THERMOSTAT_PID)
+	{
+		memcpy(settings.thermostatGains, values, sizeof(settings.thermostatGains));
+		settings.thermostatWindowMs = window;
+	}
+
+	if (lp_queueInterCoreMessage(&settings))
+	{
+		lp_deviceTwinReportState(deviceTwinBinding, deviceTwinBinding->twinState);	// TwinType = LP_TYPE_STRING
+	}
+}
+
+/// <summary>
+/// Device Twin to set the telemetry period and how the Real-Time Core samples the IMU
+/// "SamplingPolicy": {"value": "10,104,64,1"}, telemetry seconds, IMU Hz, FIFO watermark words, gyro on
+/// "SamplingPolicy": {"value": "60,0,0,0"}, the IMU powered down, a watermark of zero is the real-time app's default
+/// The policy is reported once the Real-Time Core answers with the rate and watermark it set
+/// </summary>
+static void DeviceTwinSamplingPolicyHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding)
+{
+	unsigned seconds, odrHz, watermark, gyro;
+
+	if (sscanf((char*)deviceTwinBinding->twinState, " %u,%u,%u,%u", &seconds, &odrHz, &watermark, &gyro) != 4 ||
+		seconds == 0 || seconds > 3600 || odrHz > UINT16_MAX || watermark > UINT16_MAX || gyro > 1)
+	{
+		Log_Debug("SamplingPolicy '%s' not understood, not applied\n", (char*)deviceTwinBinding->twinState);
+		return;
+	}
+
+	telemetryPeriodSeconds = seconds;
+	lp_changeTimer(&measureSensorTimer, &(struct timespec){ (time_t)seconds, 0 });
+
+	lp_queueInterCoreMessage(&(LP_INTER_CORE_BLOCK){ .cmd = LP_IC_SENSOR_POLICY, .policyOdrHz = (uint16_t)odrHz,
+		.policyWatermark = (uint16_t)watermark, .policyGyro = (uint8_t)gyro });
+}
+
+/// <summary>
+/// ModbusReadings telemetry into msgBuffer, the values are left empty unless the read succeeded, returns 0 if it does not fit
+/// </summary>
+static int FormatModbusReadings(const LP_INTER_CORE_BLOCK* block)
+{
+	int count = block->modbusStatus == LP_IC_MODBUS_OK ? block->modbusCount : 0;
+	int len = snprintf(msgBuffer, JSON_MESSAGE_BYTES, cstrJsonModbusReadings, block->modbusPoll, block->modbusSlave, block->modbusFirst,
+		block->modbusStatus);
+
+	for (int i = 0; i < count && i < LP_IC_MODBUS_REGISTERS && len > 0 && len < JSON_MESSAGE_BYTES; i++)
+	{
+		len += snprintf(msgBuffer + len, (size_t)(JSON_MESSAGE_BYTES - len), i == 0 ? "%u" : ",%u", block->modbusValues[i]);
+	}
+	if (len > 0 && len < JSON_MESSAGE_BYTES)
+	{
+		len += snprintf(msgBuffer + len, (size_t)(JSON_MESSAGE_BYTES - len), "]}}");
+	}
+
+	return len > 0 && len < JSON_MESSAGE_BYTES ? len : 0;
+}
+
+/// <summary>
+/// Add the time a stamped record was sampled on the real-time core to the JSON object in msgBuffer, rather than the
+/// time it arrived here, so readings batched together keep their own times. Returns the new length, or len unchanged
+/// </summary>
+static int AddSampleTime(const LP_INTER_CORE_BLOCK* block, int len)
+{
+	struct timespec sampledAt;
+	char utc[LP_UTC_LENGTH];
+
+	if (!block->stamped || len < 2 || msgBuffer[len - 1] != '}' || !lp_interCoreStampToMonotonic(block->stampUs, &sampledAt))
+	{
+		return len;
+	}
+
+	int added = snprintf(msgBuffer + len - 1, (size_t)(JSON_MESSAGE_BYTES - len + 1), ",\"sampledAt\":\"%s\"}",
+		lp_getMonotonicUtc(&sampledAt, utc, sizeof(utc)));
+
+	if (added <= 0 || len - 1 + added >= JSON_MESSAGE_BYTES)
+	{
+		msgBuffer[len - 1] = '}';
+		msgBuffer[len] = '\0';
+		return len;
+	}
+
+	return len - 1 + added;
 }
 
 /// <summary>
 /// Turn on LED2, send message to Azure IoT and set a one shot timer to turn LED2 off
 /// </summary>
-static void SendMsgLed2On(char* message)
+static void SendMsgLed2On(char* message, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate)
 {
 	lp_gpioOn(&led2);
 	Log_Debug("%s\n", message);
 
 	// optional: message properties can be used for message routing in IOT Hub
-	lp_setMessageProperties(telemetryMessageProperties, NELEMS(telemetryMessageProperties));
-
-	lp_sendMsg(message);
-
-	// optional: clear if you are sending other message types that don't require these properties
-	lp_clearMessageProperties();
+	lp_sendMsgWithProperties(message, propertyTemplate, NULL, 0);
 
 	lp_setOneShotTimer(&led2BlinkOffOneShotTimer, &sendMsgLedBlinkPeriod);
 }
@@ -219,9 +639,29 @@ static void MeasureSensorHandler(EventLoopTimer* eventLoopTimer)
 		return;
 	}
 
-	// send request to Real-Time core app to read temperature, pressure, and humidity
+	// the Real-Time core can not keep up with its outbound messages, skip this reading
+	if (lp_isInterCoreCongested())
+	{
+		return;
+	}
+
+	// send request to Real-Time core app to read temperature, pressure, and humidity, skipped while a reading is still pending
 	ic_control_block.cmd = LP_IC_TEMPERATURE_PRESSURE_HUMIDITY;
-	lp_sendInterCoreMessage(&ic_control_block, sizeof(ic_control_block));
+	lp_interCoreRequest(&ic_control_block, 2000, MeasureSensorResponseHandler);
+}
+
+/// <summary>
+/// Response to the sensor reading request, sent to Azure IoT as deferred work
+/// </summary>
+static void MeasureSensorResponseHandler(LP_INTER_CORE_BLOCK* ic_message_block, bool timedOut)
+{
+	if (timedOut)
+	{
+		Log_Debug("Real-Time core did not answer the sensor reading request\n");
+		return;
+	}
+
+	lp_deferWorkCopy(ProcessInterCoreMessage, ic_message_block, sizeof(LP_INTER_CORE_BLOCK));
 }
 
 /// <summary>
@@ -229,8 +669,18 @@ static void MeasureSensorHandler(EventLoopTimer* eventLoopTimer)
 /// </summary>
 static void InterCoreHandler(LP_INTER_CORE_BLOCK* ic_message_block)
 {
-	static const char* msgTemplate = "{ \"Temperature\": \"%3.2f\", \"Humidity\": \"%3.1f\", \"Pressure\":\"%3.1f\", \"Light\":%d, \"MsgId\":%d }";
-	static int msgId = 0;
+	// return to the event loop straight away, twin reporting and telemetry run as deferred work
+	lp_deferWorkCopy(ProcessInterCoreMessage, ic_message_block, sizeof(LP_INTER_CORE_BLOCK));
+}
+
+/// <summary>
+/// Report and send a message from the real-time core, context is a copy of the LP_INTER_CORE_BLOCK
+/// </summary>
+static void ProcessInterCoreMessage(void* context)
+{
+	LP_INTER_CORE_BLOCK* ic_message_block = (LP_INTER_CORE_BLOCK*)context;
+	const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate = &telemetryPropertyTemplate;
+	static DCM_TELEMETRY telemetry = { 0 };
 	int len = 0;
 
 	switch (ic_message_block->cmd)
@@ -244,18 +694,112 @@ static void InterCoreHandler(LP_INTER_CORE_BLOCK* ic_message_block)
 		lp_deviceTwinReportState(&buttonPressed, "ButtonB");					// TwinType = TYPE_STRING
 		break;
 	case LP_IC_TEMPERATURE_PRESSURE_HUMIDITY:
-		len = snprintf(msgBuffer, JSON_MESSAGE_BYTES, msgTemplate, ic_message_block->temperature, ic_message_block->humidity, ic_message_block->pressure, 0, msgId++);
+		telemetry.Temperature = ic_message_block->temperature;
+		telemetry.Humidity = ic_message_block->humidity;
+		telemetry.Pressure = ic_message_block->pressure;
+#ifdef TELEMETRY_COMPACT_KEYS
+		// reported until the twin update is accepted, the expander needs it before the first message
+		if (!dictionaryReported)
+		{
+			dictionaryReported = lp_deviceTwinReportState(&telemetryDictionary, (void*)dcm_telemetryDictionary);	// TwinType = LP_TYPE_STRING
+		}
+		len = (int)dcm_serializeTelemetryCompact(&telemetry, msgBuffer, sizeof(msgBuffer));
+		propertyTemplate = &compactPropertyTemplate;
+#else
+		len = (int)dcm_serializeTelemetry(&telemetry, msgBuffer, sizeof(msgBuffer));	// msgBuffer must hold DCM_TELEMETRY_MAX_BYTES
+#endif
+		telemetry.MsgId++;
+		lp_traceNextMessage(ic_message_block);		// no-op unless the reading was traced
 		break;
 	case LP_IC_BLINK_RATE:
 		lp_deviceTwinReportState(&led1BlinkRate, &ic_message_block->blinkRate);
 		break;
+	case LP_IC_RULE_EVENT:
+		if (ic_message_block->telemetryChannel < LP_IC_CHANNEL_COUNT)
+		{
+			len = snprintf(msgBuffer, JSON_MESSAGE_BYTES, cstrJsonRuleEvent, ic_message_block->ruleId, channelNames[ic_message_block->telemetryChannel],
+				ic_message_block->ruleActive ? "true" : "false", ic_message_block->ruleValue);
+		}
+		break;
+	case LP_IC_ANOMALY_SCORE:
+	{
+		static int reportedAnomalyModel = -1;
+		int version = ic_message_block->anomalyModel;
+
+		if (version != reportedAnomalyModel)
+		{
+			lp_deviceTwinReportState(&anomalyModelVersion, &version);		// TwinType = LP_TYPE_INT
+			reportedAnomalyModel = version;
+		}
+		len = snprintf(msgBuffer, JSON_MESSAGE_BYTES, cstrJsonAnomaly, ic_message_block->anomalyActive ? "true" : "false",
+			ic_message_block->anomalyScore, ic_message_block->anomalyThreshold, ic_message_block->anomalyModel, ic_message_block->anomalyWindows);
+		break;
+	}
+	case LP_IC_THREAD_PROFILE:
+		len = snprintf(msgBuffer, JSON_MESSAGE_BYTES, cstrJsonThreadProfile, ic_message_block->profileThread, ic_message_block->profileThreads,
+			ic_message_block->profileName, ic_message_block->profileCpuPermille / 10.0, ic_message_block->profileSwitches,
+			ic_message_block->profileStackUsed, ic_message_block->profileStackSize);
+		break;
+	case LP_IC_HEAP_PROFILE:
+		len = snprintf(msgBuffer, JSON_MESSAGE_BYTES, cstrJsonHeapProfile, ic_message_block->heapSize, ic_message_block->heapFree,
+			ic_message_block->heapMinFree);
+		break;
+	case LP_IC_BUS_PROFILE:
+		len = snprintf(msgBuffer, JSON_MESSAGE_BYTES, cstrJsonBusProfile, ic_message_block->busPermille / 10.0, ic_message_block->busRequests,
+			ic_message_block->busTransfers, ic_message_block->busBytes, ic_message_block->busMaxWaitUs, ic_message_block->busErrors);
+		break;
+	case LP_IC_WATCHDOG:
+		if (ic_message_block->watchdogReset < sizeof(resetCauseNames) / sizeof(resetCauseNames[0]))
+		{
+			len = snprintf(msgBuffer, JSON_MESSAGE_BYTES, cstrJsonWatchdog, resetCauseNames[ic_message_block->watchdogReset],
+				ic_message_block->watchdogTask);
+		}
+		break;
+	case LP_IC_TELEMETRY_SUMMARY:
+		if (ic_message_block->telemetryChannel < LP_IC_CHANNEL_COUNT)
+		{
+			len = snprintf(msgBuffer, JSON_MESSAGE_BYTES, cstrJsonTelemetrySummary, channelNames[ic_message_block->telemetryChannel],
+				ic_message_block->telemetrySamples, ic_message_block->telemetryMin, ic_message_block->telemetryMax,
+				ic_message_block->telemetryMean, ic_message_block->telemetryStdDev, ic_message_block->telemetryLast);
+		}
+		break;
+	case LP_IC_AUDIO_FEATURES:
+		len = snprintf(msgBuffer, JSON_MESSAGE_BYTES, cstrJsonAudioFeatures, ic_message_block->audioPeriodMs, ic_message_block->audioFrames,
+			ic_message_block->audioRmsDbfs, ic_message_block->audioPeakDbfs, ic_message_block->audioBandDbfs[0], ic_message_block->audioBandDbfs[1],
+			ic_message_block->audioBandDbfs[2], ic_message_block->audioBandDbfs[3], ic_message_block->audioBandDbfs[4],
+			ic_message_block->audioBandDbfs[5], ic_message_block->audioBandDbfs[6], ic_message_block->audioBandDbfs[7]);
+		break;
+	case LP_IC_MODBUS_READINGS:
+		len = FormatModbusReadings(ic_message_block);
+		break;
+	case LP_IC_THERMOSTAT_STATUS:
+		if (ic_message_block->thermostatMode < NELEMS(thermostatModeNames))
+		{
+			len = snprintf(msgBuffer, JSON_MESSAGE_BYTES, cstrJsonThermostat, thermostatModeNames[ic_message_block->thermostatMode],
+				ic_message_block->thermostatRelay ? "true" : "false", ic_message_block->temperature, ic_message_block->thermostatSetpoint,
+				ic_message_block->thermostatOutput);
+		}
+		break;
+	case LP_IC_SENSOR_POLICY:
+		snprintf(msgBuffer, JSON_MESSAGE_BYTES, "%u,%u,%u,%u", telemetryPeriodSeconds, ic_message_block->policyOdrHz,
+			ic_message_block->policyWatermark, ic_message_block->policyGyro);
+		lp_deviceTwinReportState(&samplingPolicy, msgBuffer);		// the policy as the real-time app set it
+		break;
+	case LP_IC_SAMPLE_JITTER:
+		len = snprintf(msgBuffer, JSON_MESSAGE_BYTES, cstrJsonSampleJitter, ic_message_block->jitterPeriodUs, ic_message_block->jitterIntervals,
+			ic_message_block->jitterMissed, ic_message_block->jitterMinErrorUs, ic_message_block->jitterMaxErrorUs, ic_message_block->jitterMaxLateUs,
+			ic_message_block->jitterHistogram[0], ic_message_block->jitterHistogram[1], ic_message_block->jitterHistogram[2],
+			ic_message_block->jitterHistogram[3], ic_message_block->jitterHistogram[4], ic_message_block->jitterHistogram[5],
+			ic_message_block->jitterHistogram[6], ic_message_block->jitterHistogram[7]);
+		break;
 	default:
 		break;
 	}
 
 	if (len > 0)
 	{
-		SendMsgLed2On(msgBuffer);
+		len = AddSampleTime(ic_message_block, len);
+		SendMsgLed2On(msgBuffer, propertyTemplate);
 	}
 }
 
@@ -278,26 +822,22 @@ static void ResetDeviceHandler(EventLoopTimer* eventLoopTimer)
 static LP_DIRECT_METHOD_RESPONSE_CODE ResetDirectMethodHandler(JSON_Object* json, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg)
 {
 	const char propertyName[] = "reset_timer";
-	const size_t responseLen = 60; // Allocate and initialize a response message buffer. The calling function is responsible for the freeing memory
 	static struct timespec period;
 
-	*responseMsg = (char*)malloc(responseLen);
-	memset(*responseMsg, 0, responseLen);
-
 	if (!json_object_has_value_of_type(json, propertyName, JSONNumber))
 	{
 		return LP_METHOD_FAILED;
 	}
 	int seconds = (int)json_object_get_number(json, propertyName);
 
-	// leave enough time for the device twin deviceResetUtc to update before restarting the device
+	// leave enough time for the device twin DeviceResetUTC to update before restarting the device
 	if (seconds > 2 && seconds < 10)
 	{
 		// Report Device Reset UTC
-		lp_deviceTwinReportState(&deviceResetUtc, lp_getCurrentUtc(msgBuffer, sizeof(msgBuffer)));			// LP_TYPE_STRING
+		lp_deviceTwinReportState(&dcm_DeviceResetUTC, lp_getCurrentUtc(msgBuffer, sizeof(msgBuffer)));			// LP_TYPE_STRING
 
-		// Create Direct Method Response
-		snprintf(*responseMsg, responseLen, "%s called. Reset in %d seconds", directMethodBinding->methodName, seconds);
+		// Create Direct Method Response, written into the library response buffer
+		lp_setMethodResponse("%s called. Reset in %d seconds", directMethodBinding->methodName, seconds);
 
 		// Set One Shot LP_TIMER
 		period = (struct timespec){ .tv_sec = seconds, .tv_nsec = 0 };
@@ -307,7 +847,7 @@ static LP_DIRECT_METHOD_RESPONSE_CODE ResetDirectMethodHandler(JSON_Object* json
 	}
 	else
 	{
-		snprintf(*responseMsg, responseLen, "%s called. Reset Failed. Seconds out of range: %d", directMethodBinding->methodName, seconds);
+		lp_setMethodResponse("%s called. Reset Failed. Seconds out of range: %d", directMethodBinding->methodName, seconds);
 		return LP_METHOD_FAILED;
 	}
 }
@@ -319,16 +859,30 @@ static LP_DIRECT_METHOD_RESPONSE_CODE ResetDirectMethodHandler(JSON_Object* json
 static void InitPeripheralAndHandlers(void)
 {
 	lp_openPeripheralGpioSet(peripheralGpioSet, NELEMS(peripheralGpioSet));
+	lp_setDeviceTwinCommitHandler(DeviceTwinCommitHandler);		// temperature and blink rate go to the RT core together
+	lp_setReportedStateFlushInterval(1000);		// coalesce reported properties into one twin update per second
+	lp_setWritablePropertyAcks(true);			// IoT Central shows each desired change as accepted once acknowledged
+	lp_enableDeviceTwinCache();					// relay, blink rate and temperature resume from the last desired values
+	lp_enableControlLatency(controlLatencyProperty);
 	lp_openDeviceTwinSet(deviceTwinBindingSet, NELEMS(deviceTwinBindingSet));
 	lp_openDirectMethodSet(directMethodBindingSet, NELEMS(directMethodBindingSet));
+	lp_openCloudMessageSet(cloudMessageBindingSet, NELEMS(cloudMessageBindingSet));		// before the first connect subscribes
+
+	lp_compileMessagePropertyTemplate(&telemetryPropertyTemplate, telemetryMessageProperties, NELEMS(telemetryMessageProperties));
+#ifdef TELEMETRY_COMPACT_KEYS
+	lp_compileMessagePropertyTemplate(&compactPropertyTemplate, compactMessageProperties, NELEMS(compactMessageProperties));
+#endif
 
 	lp_startTimerSet(timerSet, NELEMS(timerSet));
 	lp_startCloudToDevice();
+	lp_startHealthTelemetry(LP_HEALTH_DEFAULT_PERIOD_SECONDS);		// library counters, routed on the type=health property
+	lp_startMemoryGovernor(&memoryWatermarks, LP_MEMORY_DEFAULT_PERIOD_MS);
+	lp_startUpdateDeferral(10, LP_UPDATE_DEFAULT_FLUSH_MS);		// an OTA update waits up to 10 minutes for the offline queue to drain
 
-	lp_enableInterCoreCommunications(rtAppComponentId, InterCoreHandler);  // Initialize Inter Core Communications
+	lp_enableInterCoreCommunications(rtAppComponentId, InterCoreHandler);  // Handshakes with the RT core, which streams from then on
+	lp_setInterCoreTraceSampling(telemetryTraceEvery);
 
-	ic_control_block.cmd = LP_IC_HEARTBEAT;		// Prime RT Core with Component ID Signature
-	lp_sendInterCoreMessage(&ic_control_block, sizeof(ic_control_block));
+	lp_setInterCoreTimeSync(timeSyncPeriodMs);	// after the handshake heartbeat, the RT core answers the component it came from
 }
 
 /// <summary>
@@ -339,12 +893,22 @@ static void ClosePeripheralAndHandlers(void)
 	Log_Debug("Closing file descriptors\n");
 
 	lp_stopTimerSet();
+	lp_setInterCoreTimeSync(0);
+	lp_stopHealthTelemetry();
+	lp_stopUpdateDeferral();
+	lp_stopMemoryGovernor();
+	lp_cancelDeferredWork();
 	lp_stopCloudToDevice();
 
 	lp_closePeripheralGpioSet();
 	lp_closeDeviceTwinSet();
 	lp_closeDirectMethodSet();
+	lp_closeCloudMessageSet();
 
+	lp_freeMessagePropertyTemplate(&telemetryPropertyTemplate);
+#ifdef TELEMETRY_COMPACT_KEYS
+	lp_freeMessagePropertyTemplate(&compactPropertyTemplate);
+#endif
 
 	lp_stopTimerEventLoop();
 }
@@ -363,15 +927,7 @@ int main(int argc, char* argv[])
 	InitPeripheralAndHandlers();
 
 	// Main loop
-	while (!lp_isTerminationRequired())
-	{
-		int result = EventLoop_Run(lp_getTimerEventLoop(), -1, true);
-		// Continue if interrupted by signal, e.g. due to breakpoint being set.
-		if (result == -1 && errno != EINTR)
-		{
-			lp_terminate(ExitCode_Main_EventLoopFail);
-		}
-	}
+	lp_runEventLoop();
 
 	ClosePeripheralAndHandlers();
 
@@ -1,12 +1,20 @@
 #include "board.h"
 
 
-/// <summary>
-///     Reads telemetry and returns the length of JSON data.
-/// </summary>
-bool lp_readTelemetry(LP_ENVIRONMENT* environment)
+static bool ReadImu(float values[LP_SENSOR_VALUES]);
+static bool ReadHumidity(float values[LP_SENSOR_VALUES]);
+static bool ReadLight(float values[LP_SENSOR_VALUES]);
+
+// the LPS22HH runs at 10 Hz, telemetry needs far less, the costly burst is read ahead of telemetry once the app sets a prefetch
+static LP_SENSOR imuSensor = { .name = "imu", .read = ReadImu, .period = { 1, 0 }, .readCostUs = 2000, .prefetch = true, .offload = true };
+static LP_SENSOR humiditySensor = { .name = "humidity", .read = ReadHumidity, .period = { 1, 0 }, .readCostUs = 1 };
+static LP_SENSOR lightSensor = { .name = "light", .read = ReadLight, .period = { 1, 0 }, .readCostUs = 1 };
+static LP_SENSOR* sensorSet[] = { &imuSensor, &humiditySensor, &lightSensor };
+static bool workerPoolOpened;	// by the board for the IMU reads, the app may have opened it first
+
+static bool ReadImu(float values[LP_SENSOR_VALUES])
 {
-	//ENSURE lp_calibrate_angular_rate(); call from lp_initializeDevKit before calling lp_get_angular_rate()
+	//ENSURE lp_calibrate_angular_rate(); call from lp_initializeDevKit, lp_get_angular_rate() is uncalibrated until lp_angular_rate_calibrated()
 
 	//AngularRateDegreesPerSecond ardps = lp_get_angular_rate();
 	//AccelerationMilligForce amf = lp_get_acceleration();
@@ -14,33 +22,103 @@ bool lp_readTelemetry(LP_ENVIRONMENT* environment)
 	//Log_Debug("\nLSM6DSO: Angular rate [degrees per second] : %4.2f, %4.2f, %4.2f\n", ardps.x, ardps.y, ardps.z);
 	//Log_Debug("\nLSM6DSO: Acceleration [millig force]  : %.4lf, %.4lf, %.4lf\n", amgf.x, amgf.y, amgf.z);
 
-	environment->temperature = lp_get_temperature();
-	environment->pressure = lp_get_pressure();
+	LP_IMU_SNAPSHOT imu;
 
-	//light = lp_GetLightLevel();
-	environment->light = 0;
+	// one burst covers the LSM6DSO outputs and the sensor hub copy of the LPS22HH
+	if (!lp_imu_read_all(&imu)) { return false; }
 
+	values[0] = imu.temperature;
+	values[1] = imu.pressure;
+	return true;
+}
+
+static bool ReadHumidity(float values[LP_SENSOR_VALUES])
+{
 	int rnd = (rand() % 10) - 5;
-	environment->humidity = (float)(50.0 + rnd);
+	values[0] = (float)(50.0 + rnd);
+	return true;
+}
 
+static bool ReadLight(float values[LP_SENSOR_VALUES])
+{
+	//light = lp_GetLightLevel();
+	values[0] = 0;
 	return true;
 }
 
-bool lp_initializeDevKit(void)
+static void OldestSample(LP_ENVIRONMENT* environment, const LP_SENSOR* sensor)
 {
-	srand((unsigned int)time(NULL)); // seed the random number generator for fake telemetry
+	if (sensor->sampledAt.tv_sec < environment->sampledAt.tv_sec ||
+		(sensor->sampledAt.tv_sec == environment->sampledAt.tv_sec && sensor->sampledAt.tv_nsec < environment->sampledAt.tv_nsec))
+	{
+		environment->sampledAt = sensor->sampledAt;
+	}
+
+	environment->stale = environment->stale || lp_sensorIsStale(sensor);
+}
 
+/// <summary>
+///     The latest values the sensor timers read, NAN for a sensor that has never answered
+/// </summary>
+bool lp_readTelemetry(LP_ENVIRONMENT* environment)
+{
+	bool imuRead = imuSensor.sampledAt.tv_sec != 0 || imuSensor.sampledAt.tv_nsec != 0;
+
+	environment->temperature = imuRead ? imuSensor.values[0] : NAN;
+	environment->pressure = imuRead ? imuSensor.values[1] : NAN;
+	environment->humidity = humiditySensor.values[0];
+	environment->light = (int)lightSensor.values[0];
+
+	environment->sampledAt = (struct timespec){ INT32_MAX, 0 };
+	environment->stale = false;
+	for (size_t i = 0; i < NELEMS(sensorSet); i++)
+	{
+		OldestSample(environment, sensorSet[i]);
+	}
+
+	return true;
+}
+
+static void InitializeSensors(void* context)
+{
 	lp_imu_initialize();
 
-	//lp_calibrate_angular_rate(); // call if using gyro
+	//lp_calibrate_angular_rate(); // call if using gyro, calibration continues on the event loop
 
 	//lp_OpenADC();
 
+	// the IMU burst blocks for up to the 100 ms I2C timeout on a stalled bus, read it on a worker
+	workerPoolOpened = !lp_isWorkerPoolRunning() && lp_openWorkerPool(1);
+
+	lp_startSensorSet(sensorSet, NELEMS(sensorSet));
+	lp_bootMark("sensors ready");
+}
+
+bool lp_initializeDevKit(void)
+{
+	srand((unsigned int)time(NULL)); // seed the random number generator for fake telemetry
+
+	// concurrent start up sets the sensors up from the event loop, between the first provisioning steps
+	if (lp_getInitMode() == LP_INIT_CONCURRENT)
+	{
+		lp_deferWork(InitializeSensors, NULL);
+	}
+	else
+	{
+		InitializeSensors(NULL);
+	}
+
 	return true;
 }
 
 bool lp_closeDevKit(void)
 {
+	lp_stopSensorSet();
+	if (workerPoolOpened)
+	{
+		lp_closeWorkerPool();	// waits for a read still on the bus
+		workerPoolOpened = false;
+	}
 	//closeI2c();
 	return true;
 }
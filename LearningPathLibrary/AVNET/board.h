@@ -1,6 +1,9 @@
 #pragma once
 
 #include "hw/azure_sphere_learning_path.h"
+#include "boot_profile.h"
+#include "deferred_work.h"
+#include "sensor_cache.h"
 #include "imu_temp_pressure.h"
 #include "light_sensor.h"
 #include <stdbool.h>
@@ -15,8 +18,10 @@ typedef struct
 	float humidity;
 	float pressure;
 	int light;
+	struct timespec sampledAt;	// CLOCK_MONOTONIC of the oldest value
+	bool stale;					// a sensor missed its recent reads, its values are the last good ones
 } LP_ENVIRONMENT;
 
-bool lp_readTelemetry(LP_ENVIRONMENT* environment);
+bool lp_readTelemetry(LP_ENVIRONMENT* environment);	// the cached latest values, never waits for a sensor
 bool lp_initializeDevKit(void);
 bool lp_closeDevKit(void);
@@ -95,10 +95,34 @@ static uint8_t whoamI, rst;
 //static uint8_t tx_buffer[1000];
 
 static int i2cHandle = -1;
+static pthread_mutex_t busLock;		// recursive, lp_imu_read_all may run on a worker while the event loop configures
+static pthread_once_t busLockOnce = PTHREAD_ONCE_INIT;
 static stmdev_ctx_t dev_ctx;
-static stmdev_ctx_t pressure_ctx;
+static stmdev_ctx_t pressure_ctx;		// pass-through access, used only while configuring the LPS22HH
 static bool lps22hhDetected;
+static bool sensorHubRunning;
+static float pressure_hPa = NAN;
+static float lps22hhTemperature_degC = NAN;
 static bool initialized = false;
+static LP_IMU_POLICY imuPolicy = { .accelerometerHz = 12, .gyroHz = 12, .pressureHz = 10 };	// as lp_imu_initialize sets them
+
+// LSM6DSO accelerometer and gyro rates, the ODR setting for each is its index plus one, 12 is 12.5 Hz
+static const uint16_t imuRatesHz[] = { 12, 26, 52, 104, 208, 417, 833 };
+
+// LPS22HH rates, each with the slowest sensor hub rate that still copies every sample
+static const struct
+{
+	uint16_t hz;
+	lps22hh_odr_t odr;
+	lsm6dso_shub_odr_t hubOdr;
+	uint16_t hubHz;
+} pressureRates[] = {
+	{ 1, LPS22HH_1_Hz_LOW_NOISE, LSM6DSO_SH_ODR_13Hz, 13 },
+	{ 10, LPS22HH_10_Hz_LOW_NOISE, LSM6DSO_SH_ODR_13Hz, 13 },
+	{ 25, LPS22HH_25_Hz_LOW_NOISE, LSM6DSO_SH_ODR_26Hz, 26 },
+	{ 50, LPS22HH_50_Hz_LOW_NOISE, LSM6DSO_SH_ODR_52Hz, 52 },
+	{ 75, LPS22HH_75_Hz_LOW_NOISE, LSM6DSO_SH_ODR_104Hz, 104 }
+};
 
 /* Extern variables ----------------------------------------------------------*/
 
@@ -114,8 +138,11 @@ static int32_t platform_write(void* handle, uint8_t reg, uint8_t* bufp, uint16_t
 static int32_t platform_read(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len);
 static void platform_delay(uint32_t ms);
 static void platform_init(void);
+static bool platform_read_burst(uint8_t reg, uint8_t* bufp, size_t len);
 static int32_t lsm6dso_read_lps22hh_cx(void* ctx, uint8_t reg, uint8_t* data, uint16_t len);
 static int32_t lsm6dso_write_lps22hh_cx(void* ctx, uint8_t reg, uint8_t* data, uint16_t len);
+static void lock_bus(void);
+static void unlock_bus(void);
 
 
 /*
@@ -134,7 +161,9 @@ static int32_t platform_write(void* handle, uint8_t reg, uint8_t* bufp, uint16_t
 	cmdBuffer[0] = reg;
 	memcpy(&cmdBuffer[1], bufp, (size_t)len);
 
+	lock_bus();
 	int32_t retVal = I2CMaster_Write(*(int*)handle, LSM6DSO_ADDRESS, cmdBuffer, (size_t)(len + 1));
+	unlock_bus();
 	if (retVal != len + 1)
 	{
 		Log_Debug("ERROR: Expected return value to match count\n");
@@ -156,7 +185,9 @@ static int32_t platform_write(void* handle, uint8_t reg, uint8_t* bufp, uint16_t
  */
 static int32_t platform_read(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
 {
+	lock_bus();
 	int32_t retVal = I2CMaster_WriteThenRead(*(int*)handle, LSM6DSO_ADDRESS, &reg, 1, bufp, (size_t)len);
+	unlock_bus();
 	if (retVal < 0)
 	{
 		Log_Debug("ERROR: Expected return value to match count\n");
@@ -166,6 +197,57 @@ static int32_t platform_read(void* handle, uint8_t reg, uint8_t* bufp, uint16_t
 }
 
 
+/*
+ * @brief  Read consecutive registers in one I2C transfer, reporting bus errors
+ *
+ * @param  reg       first register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ */
+static bool platform_read_burst(uint8_t reg, uint8_t* bufp, size_t len)
+{
+	lock_bus();
+	ssize_t result = I2CMaster_WriteThenRead(i2cHandle, LSM6DSO_ADDRESS, &reg, 1, bufp, len);
+	unlock_bus();
+
+	if (result < 0)
+	{
+		Log_Debug("ERROR: I2CMaster_WriteThenRead: errno=%d (%s)\n", errno, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+
+static void init_bus_lock(void)
+{
+	pthread_mutexattr_t attributes;
+
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);	// sequences hold it across the transfers they make
+	pthread_mutex_init(&busLock, &attributes);
+	pthread_mutexattr_destroy(&attributes);
+}
+
+
+/*
+ * @brief  Serialise the transfers and register sequences of the event loop and a worker
+ */
+static void lock_bus(void)
+{
+	pthread_once(&busLockOnce, init_bus_lock);
+	pthread_mutex_lock(&busLock);
+}
+
+
+static void unlock_bus(void)
+{
+	pthread_mutex_unlock(&busLock);
+}
+
+
 /*
  * @brief  platform specific delay (platform dependent)
  *
@@ -196,7 +278,12 @@ static void platform_init(void)
 		return;
 	}
 
-	int result = I2CMaster_SetBusSpeed(i2cHandle, I2C_BUS_SPEED_STANDARD);
+	int result = I2CMaster_SetBusSpeed(i2cHandle, LP_IMU_I2C_BUS_SPEED);
+	if (result != 0 && LP_IMU_I2C_BUS_SPEED != I2C_BUS_SPEED_STANDARD)
+	{
+		Log_Debug("ERROR: I2CMaster_SetBusSpeed %u: errno=%d (%s), using standard mode\n", LP_IMU_I2C_BUS_SPEED, errno, strerror(errno));
+		result = I2CMaster_SetBusSpeed(i2cHandle, I2C_BUS_SPEED_STANDARD);
+	}
 	if (result != 0)
 	{
 		Log_Debug("ERROR: I2CMaster_SetBusSpeed: errno=%d (%s)\n", errno, strerror(errno));
@@ -321,33 +408,66 @@ AngularRateDegreesPerSecond lp_get_angular_rate(void)
 }
 
 
-float lp_get_temperature_lps22h(void)	// get_temperature() from lsm6dso is faster
+/// <summary>
+///     Reads the LPS22HH status and output registers the sensor hub copies into SENSOR_HUB_1..6
+///     on every accelerometer sample, one transfer plus a register bank switch either side
+/// </summary>
+static bool read_lps22hh_sensor_hub(void)
 {
-	lps22hh_reg_t lps22hhReg;
+	lsm6dso_func_cfg_access_t bank = { 0 };
+	lps22hh_status_t status;
+	uint8_t hub[LPS22HH_TEMP_OUT_H - LPS22HH_STATUS + 1];
+	uint32_t ui32bit;
 	int16_t i16bit;
-	static float lps22hhTemperature_degC = NAN;
+	bool ok;
 
-	if (!initialized)
+	// FUNC_CFG_ACCESS holds only the bank select, so write it rather than read-modify-write
+	// held across the bank switch, any other access in between would go to the sensor hub bank
+	lock_bus();
+	bank.reg_access = LSM6DSO_SENSOR_HUB_BANK;
+	lsm6dso_write_reg(&dev_ctx, LSM6DSO_FUNC_CFG_ACCESS, (uint8_t*)&bank, 1);
+
+	ok = platform_read_burst(LSM6DSO_SENSOR_HUB_1, hub, sizeof(hub));
+
+	bank.reg_access = LSM6DSO_USER_BANK;
+	lsm6dso_write_reg(&dev_ctx, LSM6DSO_FUNC_CFG_ACCESS, (uint8_t*)&bank, 1);
+	unlock_bus();
+
+	if (!ok)
 	{
-		return NAN;
+		return false;
 	}
 
-	if (lps22hhDetected)
+	memcpy(&status, &hub[0], sizeof(status));
+
+	if (status.p_da)
 	{
-		i16bit = 0;
+		ui32bit = ((uint32_t)hub[LPS22HH_PRESS_OUT_XL - LPS22HH_STATUS + 2] << 16) |
+			((uint32_t)hub[LPS22HH_PRESS_OUT_XL - LPS22HH_STATUS + 1] << 8) |
+			hub[LPS22HH_PRESS_OUT_XL - LPS22HH_STATUS];
+		pressure_hPa = lps22hh_from_lsb_to_hpa(ui32bit * 256);
+	}
 
-		lps22hh_read_reg(&pressure_ctx, LPS22HH_STATUS, (uint8_t*)&lps22hhReg, 1);
+	if (status.t_da)
+	{
+		i16bit = (int16_t)((hub[LPS22HH_TEMP_OUT_H - LPS22HH_STATUS] << 8) | hub[LPS22HH_TEMP_OUT_H - LPS22HH_STATUS - 1]);
+		lps22hhTemperature_degC = lps22hh_from_lsb_to_celsius(i16bit);
+	}
 
-		//Read output only if new value is available
+	return true;
+}
 
-		if ((lps22hhReg.status.p_da == 1) && (lps22hhReg.status.t_da == 1))
-		{
-			lps22hh_temperature_raw_get(&pressure_ctx, &i16bit);
-			lps22hhTemperature_degC = lps22hh_from_lsb_to_celsius(i16bit);
-		}
-		return lps22hhTemperature_degC;
+
+float lp_get_temperature_lps22h(void)	// get_temperature() from lsm6dso is faster
+{
+	if (!initialized || !sensorHubRunning)
+	{
+		return NAN;
 	}
-	return NAN;
+
+	read_lps22hh_sensor_hub();
+
+	return lps22hhTemperature_degC;
 }
 
 
@@ -375,96 +495,195 @@ float lp_get_temperature(void)
 }
 
 
-float lp_get_pressure(void)
+static bool read_all(LP_IMU_SNAPSHOT* snapshot)
 {
-	lps22hh_reg_t lps22hhReg;
-	uint32_t ui32bit;
-	static float pressure_hPa = NAN;
+	static float temperature_degC = NAN;
+	uint8_t burst[LSM6DSO_OUTZ_H_A - LSM6DSO_STATUS_REG + 1];
+	lsm6dso_status_reg_t status;
+	axis1bit16_t data_raw_temperature;
 
-	if (!initialized)
+	if (!initialized || snapshot == NULL)
 	{
-		return NAN;
+		return false;
 	}
 
-	if (lps22hhDetected)
+	// register auto increment is on by default, the read runs on across the reserved 0x1F
+	if (!platform_read_burst(LSM6DSO_STATUS_REG, burst, sizeof(burst)))
 	{
-		ui32bit = 0;
+		return false;
+	}
 
-		lps22hh_read_reg(&pressure_ctx, LPS22HH_STATUS, (uint8_t*)&lps22hhReg, 1);
+	memcpy(&status, &burst[0], sizeof(status));
 
-		//Read output only if new value is available
+	if (status.tda)
+	{
+		memcpy(data_raw_temperature.u8bit, &burst[LSM6DSO_OUT_TEMP_L - LSM6DSO_STATUS_REG], sizeof(int16_t));
+		temperature_degC = lsm6dso_from_lsb_to_celsius(data_raw_temperature.i16bit);
+	}
 
-		if ((lps22hhReg.status.p_da == 1) && (lps22hhReg.status.t_da == 1))
-		{
-			lps22hh_pressure_raw_get(&pressure_ctx, &ui32bit);
-			pressure_hPa = lps22hh_from_lsb_to_hpa(ui32bit);
-		}
-		return pressure_hPa;
+	if (status.gda)
+	{
+		memcpy(data_raw_angular_rate.u8bit, &burst[LSM6DSO_OUTX_L_G - LSM6DSO_STATUS_REG], 3 * sizeof(int16_t));
+
+		angularRateDps.x = (lsm6dso_from_fs2000_to_mdps(data_raw_angular_rate.i16bit[0] - raw_angular_rate_calibration.i16bit[0])) / 1000.0;
+		angularRateDps.y = (lsm6dso_from_fs2000_to_mdps(data_raw_angular_rate.i16bit[1] - raw_angular_rate_calibration.i16bit[1])) / 1000.0;
+		angularRateDps.z = (lsm6dso_from_fs2000_to_mdps(data_raw_angular_rate.i16bit[2] - raw_angular_rate_calibration.i16bit[2])) / 1000.0;
 	}
-	return NAN;
+
+	if (status.xlda)
+	{
+		memcpy(data_raw_acceleration.u8bit, &burst[LSM6DSO_OUTX_L_A - LSM6DSO_STATUS_REG], 3 * sizeof(int16_t));
+
+		accelerationMilligForce.x = lsm6dso_from_fs2_to_mg(data_raw_acceleration.i16bit[0]);
+		accelerationMilligForce.y = lsm6dso_from_fs2_to_mg(data_raw_acceleration.i16bit[1]);
+		accelerationMilligForce.z = lsm6dso_from_fs2_to_mg(data_raw_acceleration.i16bit[2]);
+	}
+
+	if (sensorHubRunning && !read_lps22hh_sensor_hub())
+	{
+		return false;
+	}
+
+	snapshot->temperature = temperature_degC;
+	snapshot->pressure = pressure_hPa;
+	snapshot->angularRate = angularRateDps;
+	snapshot->acceleration = accelerationMilligForce;
+
+	return true;
 }
 
 
-void lp_calibrate_angular_rate(void)
+/// <summary>
+///     Reads STATUS_REG through OUTZ_H_A in one I2C transfer, replacing the status then data
+///     transfer pair each lp_get_ call makes, then the LPS22HH copy in the sensor hub registers.
+///     Readings without new data keep their previous value. Safe from a worker thread, the bus is held
+///     for the whole read, so a stalled transfer blocks the worker and not the event loop unless it
+///     reads or configures the IMU at the same time.
+/// </summary>
+bool lp_imu_read_all(LP_IMU_SNAPSHOT* snapshot)
 {
-	if (!initialized)
+	bool ok;
+
+	lock_bus();
+	ok = read_all(snapshot);
+	unlock_bus();
+
+	return ok;
+}
+
+
+float lp_get_pressure(void)
+{
+	if (!initialized || !sensorHubRunning)
 	{
-		return;
+		return NAN;
 	}
 
-	// Read the raw angular rate data from the device to use as offsets.  We're making the assumption that the device
-	// is stationary.
+	read_lps22hh_sensor_hub();
+
+	return pressure_hPa;
+}
+
+
+static void AngularRateCalibrationHandler(EventLoopTimer* eventLoopTimer);
+
+static LP_TIMER angularRateCalibrationTimer = {
+	.period = { 0, LP_IMU_CALIBRATION_POLL_MS * 1000000L },	// polls for gyro data while calibration runs, stopped when done
+	.name = "angularRateCalibrationTimer",
+	.handler = &AngularRateCalibrationHandler
+};
 
+// capture a raw reading as the offset, then check the next reading is zero with it applied
+static enum { CALIBRATION_IDLE, CALIBRATION_CAPTURE, CALIBRATION_VERIFY } calibrationState = CALIBRATION_IDLE;
+static axis3bit16_t candidate_calibration;
+static int calibrationAttempts;
+static bool angularRateCalibrated = false;
+
+static void AngularRateCalibrationHandler(EventLoopTimer* eventLoopTimer)
+{
+	axis3bit16_t raw;
 	uint8_t reg;
 
-	Log_Debug("LSM6DSO: Calibrating angular rate . . .\n");
-	Log_Debug("LSM6DSO: Please make sure the device is stationary.\n");
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
+	{
+		lp_terminate(ExitCode_ImuCalibrationHandler);
+		return;
+	}
 
-	do
+	if (!initialized)
 	{
+		lp_stopTimer(&angularRateCalibrationTimer);
+		calibrationState = CALIBRATION_IDLE;
+		return;
+	}
 
-		// Delay and read the device until we have data!
-		do
-		{
-			// Read the calibration values
-			platform_delay(500);
-			lsm6dso_gy_flag_data_ready_get(&dev_ctx, &reg);
-		} while (!reg);
+	// nothing new since the last poll, try again next period
+	lsm6dso_gy_flag_data_ready_get(&dev_ctx, &reg);
+	if (!reg)
+	{
+		return;
+	}
 
-		if (reg)
-		{
-			// Read angular rate field data to use for calibration offsets
-			memset(data_raw_angular_rate.u8bit, 0x00, 3 * sizeof(int16_t));
-			lsm6dso_angular_rate_raw_get(&dev_ctx, raw_angular_rate_calibration.u8bit);
-		}
+	if (calibrationState == CALIBRATION_CAPTURE)
+	{
+		// We're making the assumption that the device is stationary.
+		lsm6dso_angular_rate_raw_get(&dev_ctx, candidate_calibration.u8bit);
+		calibrationState = CALIBRATION_VERIFY;
+		return;
+	}
 
-		// Delay and read the device until we have data!
-		do
-		{
-			// Read the calibration values
-			platform_delay(500);
-			lsm6dso_gy_flag_data_ready_get(&dev_ctx, &reg);
-		} while (!reg);
+	lsm6dso_angular_rate_raw_get(&dev_ctx, raw.u8bit);
 
-		// Read the angular data rate again and verify that after applying the calibration, we have 0 angular rate in all directions
-		if (reg)
+	// If the reading after applying the offset is not 0 in all directions, capture again
+	if (raw.i16bit[0] != candidate_calibration.i16bit[0] || raw.i16bit[1] != candidate_calibration.i16bit[1] ||
+		raw.i16bit[2] != candidate_calibration.i16bit[2])
+	{
+		if (++calibrationAttempts < LP_IMU_CALIBRATION_MAX_ATTEMPTS)
 		{
-			// Read angular rate field data
-			memset(data_raw_angular_rate.u8bit, 0x00, 3 * sizeof(int16_t));
-			lsm6dso_angular_rate_raw_get(&dev_ctx, data_raw_angular_rate.u8bit);
-
-			// Before we store the mdps values subtract the calibration data we captured at startup.
-			angularRateDps.x = lsm6dso_from_fs2000_to_mdps((int16_t)(data_raw_angular_rate.i16bit[0] - (int)raw_angular_rate_calibration.i16bit[0]));
-			angularRateDps.y = lsm6dso_from_fs2000_to_mdps((int16_t)(data_raw_angular_rate.i16bit[1] - raw_angular_rate_calibration.i16bit[1]));
-			angularRateDps.z = lsm6dso_from_fs2000_to_mdps((int16_t)(data_raw_angular_rate.i16bit[2] - raw_angular_rate_calibration.i16bit[2]));
+			calibrationState = CALIBRATION_CAPTURE;
+			return;
 		}
+		Log_Debug("LSM6DSO: Angular rate not stable after %d attempts, using the last offsets\n", calibrationAttempts);
+	}
+
+	raw_angular_rate_calibration = candidate_calibration;
+	angularRateCalibrated = true;
 
-		// If the angular values after applying the offset are not all 0.0s, then do it again!
-	} while ((angularRateDps.x != 0.0) || (angularRateDps.y != 0.0) || (angularRateDps.z != 0.0));
+	lp_stopTimer(&angularRateCalibrationTimer);
+	calibrationState = CALIBRATION_IDLE;
 
 	Log_Debug("LSM6DSO: Calibrating angular rate complete!\n");
 }
 
+/// <summary>
+///     Starts angular rate calibration and returns, the readings are sampled from a timer on the event loop.
+///     lp_get_angular_rate applies the offsets once lp_angular_rate_calibrated returns true.
+/// </summary>
+void lp_calibrate_angular_rate(void)
+{
+	if (!initialized || calibrationState != CALIBRATION_IDLE)
+	{
+		return;
+	}
+
+	Log_Debug("LSM6DSO: Calibrating angular rate . . .\n");
+	Log_Debug("LSM6DSO: Please make sure the device is stationary.\n");
+
+	calibrationAttempts = 0;
+	calibrationState = CALIBRATION_CAPTURE;
+
+	if (!lp_startTimer(&angularRateCalibrationTimer))
+	{
+		Log_Debug("ERROR: Could not start the angular rate calibration timer\n");
+		calibrationState = CALIBRATION_IDLE;
+	}
+}
+
+bool lp_angular_rate_calibrated(void)
+{
+	return angularRateCalibrated;
+}
+
 
 static void detect_lps22hh(void)
 {
@@ -518,6 +737,37 @@ static void detect_lps22hh(void)
 }
 
 
+/// <summary>
+///     Puts the LSM6DSO I2C master into continuous mode, it reads the LPS22HH status and output
+///     registers into its sensor hub registers on every accelerometer sample with no host traffic
+/// </summary>
+static void start_lps22hh_sensor_hub(lsm6dso_shub_odr_t hubOdr, lsm6dso_odr_xl_t accelerometerOdr)
+{
+	lsm6dso_sh_cfg_read_t sh_cfg_read;
+
+	/* The pass-through accesses leave the accelerometer, which triggers the hub, stopped. */
+	lsm6dso_xl_data_rate_set(&dev_ctx, LSM6DSO_XL_ODR_OFF);
+
+	if (lps22hhDetected)
+	{
+		sh_cfg_read.slv_add = (LPS22HH_I2C_ADD_L & 0xFEU) >> 1; /* 7bit I2C address */
+		sh_cfg_read.slv_subadd = LPS22HH_STATUS;
+		sh_cfg_read.slv_len = LPS22HH_TEMP_OUT_H - LPS22HH_STATUS + 1;
+
+		lsm6dso_sh_slv0_cfg_read(&dev_ctx, &sh_cfg_read);
+		lsm6dso_sh_slave_connected_set(&dev_ctx, LSM6DSO_SLV_0);
+		lsm6dso_sh_data_rate_set(&dev_ctx, hubOdr);	// just above the LPS22HH output rate
+		lsm6dso_sh_syncro_mode_set(&dev_ctx, LSM6DSO_XL_GY_DRDY);
+		lsm6dso_sh_master_set(&dev_ctx, PROPERTY_ENABLE);
+
+		sensorHubRunning = true;
+	}
+
+	/* Restart the accelerometer at the rate asked for, each sample now runs a hub cycle. */
+	lsm6dso_xl_data_rate_set(&dev_ctx, accelerometerOdr);
+}
+
+
 void lp_imu_initialize(void)
 {
 	if (initialized) { return; }
@@ -577,6 +827,7 @@ void lp_imu_initialize(void)
 	//lp_calibrate_angular_rate();
 
 	detect_lps22hh();
+	start_lps22hh_sensor_hub(LSM6DSO_SH_ODR_13Hz, LSM6DSO_XL_ODR_12Hz5);	// just above the 10 Hz LPS22HH output rate
 
 	initialized = true;
 
@@ -586,6 +837,117 @@ void lp_imu_initialize(void)
 }
 
 
+/// <summary>
+///     The ODR setting of the supported accelerometer and gyro rate nearest hz, LSM6DSO_XL_ODR_OFF for zero.
+///     The XL and GY enums share the encoding.
+/// </summary>
+static uint8_t NearestImuRate(uint16_t hz, uint16_t* appliedHz)
+{
+	size_t i;
+
+	if (hz == 0)
+	{
+		*appliedHz = 0;
+		return LSM6DSO_XL_ODR_OFF;
+	}
+
+	for (i = 0; i + 1 < NELEMS(imuRatesHz); i++)
+	{
+		if (hz < (imuRatesHz[i] + imuRatesHz[i + 1]) / 2)
+		{
+			break;
+		}
+	}
+
+	*appliedHz = imuRatesHz[i];
+	return (uint8_t)(i + 1);
+}
+
+/// <summary>
+///     Sets the output data rates, a rate of zero powers that sensor down. Rates go to the nearest the sensors
+///     have. The accelerometer triggers the sensor hub copy of the LPS22HH, so while pressure is read it runs at
+///     least at the hub rate. Changing the pressure rate is a pass-through write to the LPS22HH, which blocks for
+///     a few accelerometer samples, the accelerometer and gyro rates alone are a register write each.
+/// </summary>
+bool lp_imu_set_policy(const LP_IMU_POLICY* policy)
+{
+	LP_IMU_POLICY applied = { 0 };
+	size_t pressure = 0;
+	uint8_t accelerometerOdr, gyroOdr;
+
+	if (!initialized || policy == NULL)
+	{
+		return false;
+	}
+
+	if (policy->pressureHz != 0 && lps22hhDetected)
+	{
+		while (pressure + 1 < NELEMS(pressureRates) &&
+			policy->pressureHz >= (pressureRates[pressure].hz + pressureRates[pressure + 1].hz) / 2)
+		{
+			pressure++;
+		}
+		applied.pressureHz = pressureRates[pressure].hz;
+	}
+
+	accelerometerOdr = NearestImuRate(policy->accelerometerHz, &applied.accelerometerHz);
+	if (applied.pressureHz != 0 && applied.accelerometerHz < pressureRates[pressure].hubHz)
+	{
+		accelerometerOdr = NearestImuRate(pressureRates[pressure].hubHz, &applied.accelerometerHz);
+	}
+	gyroOdr = NearestImuRate(policy->gyroHz, &applied.gyroHz);
+
+	// calibration polls for gyro samples, it would never finish with the gyro off
+	if (applied.gyroHz == 0 && calibrationState != CALIBRATION_IDLE)
+	{
+		lp_stopTimer(&angularRateCalibrationTimer);
+		calibrationState = CALIBRATION_IDLE;
+	}
+
+	lock_bus();	// a read from a worker does not see the sensor hub half configured
+
+	if (applied.pressureHz != imuPolicy.pressureHz)
+	{
+		// the pass-through accesses reconfigure slave 0, the hub is started again once the LPS22HH is set
+		lsm6dso_sh_master_set(&dev_ctx, PROPERTY_DISABLE);
+		sensorHubRunning = false;
+
+		if (lps22hhDetected)
+		{
+			lps22hh_data_rate_set(&pressure_ctx, applied.pressureHz != 0 ? pressureRates[pressure].odr : LPS22HH_POWER_DOWN);
+		}
+
+		if (applied.pressureHz != 0)
+		{
+			start_lps22hh_sensor_hub(pressureRates[pressure].hubOdr, (lsm6dso_odr_xl_t)accelerometerOdr);
+		}
+		else
+		{
+			pressure_hPa = NAN;
+			lps22hhTemperature_degC = NAN;
+		}
+	}
+
+	lsm6dso_xl_data_rate_set(&dev_ctx, (lsm6dso_odr_xl_t)accelerometerOdr);
+	lsm6dso_gy_data_rate_set(&dev_ctx, (lsm6dso_odr_g_t)gyroOdr);
+
+	unlock_bus();
+
+	imuPolicy = applied;
+	Log_Debug("IMU policy: accelerometer %u Hz, gyro %u Hz, pressure %u Hz\n", applied.accelerometerHz, applied.gyroHz, applied.pressureHz);
+
+	return true;
+}
+
+/// <summary>
+///     The rates as set, after rounding and the accelerometer floor the sensor hub needs
+/// </summary>
+void lp_imu_get_policy(LP_IMU_POLICY* policy)
+{
+	*policy = imuPolicy;
+}
+
+
 /// <summary>
 ///     Closes a file descriptor and prints an error on failure.
 /// </summary>
@@ -610,7 +972,9 @@ static void CloseFdPrintError(int fd, const char* fdName)
 /// </summary>
 void lp_imu_close(void)
 {
+	lock_bus();
 	CloseFdPrintError(i2cHandle, "i2c");
+	unlock_bus();
 }
 
 
@@ -3,9 +3,12 @@
 #include "hw/azure_sphere_learning_path.h"
 #include "lsm6dso_reg.h"
 #include "lps22hh_reg.h"
+#include "terminate.h"
+#include "timer.h"
 #include <applibs/i2c.h>
 #include <applibs/log.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -14,6 +17,13 @@
 
 #define LSM6DSO_ADDRESS	   0x6A	  // I2C Address
 
+#define LP_IMU_CALIBRATION_POLL_MS 500		// gyro data ready poll while calibrating
+#define LP_IMU_CALIBRATION_MAX_ATTEMPTS 20	// capture and verify rounds before the last offsets are accepted
+
+#ifndef LP_IMU_I2C_BUS_SPEED
+#define LP_IMU_I2C_BUS_SPEED I2C_BUS_SPEED_FAST	  // 400 kHz, define as I2C_BUS_SPEED_FAST_PLUS for 1 MHz or I2C_BUS_SPEED_STANDARD for 100 kHz
+#endif
+
 typedef struct
 {
 	float x;
@@ -28,11 +38,30 @@ typedef struct
 	float z;
 } AccelerationMilligForce;
 
+typedef struct
+{
+	AccelerationMilligForce acceleration;
+	AngularRateDegreesPerSecond angularRate;
+	float temperature;
+	float pressure;		// hPa, read from the LPS22HH by the LSM6DSO sensor hub
+} LP_IMU_SNAPSHOT;
+
+typedef struct
+{
+	uint16_t accelerometerHz;	// output data rates, zero powers the sensor down
+	uint16_t gyroHz;
+	uint16_t pressureHz;		// the LPS22HH and the sensor hub that reads it
+} LP_IMU_POLICY;
+
 void lp_imu_initialize(void);
 void lp_imu_close(void);
 float lp_get_temperature(void);
 float lp_get_pressure(void);
 float lp_get_temperature_lps22h(void);	// get_temperature() from lsm6dso is faster
-void lp_calibrate_angular_rate(void);
+void lp_calibrate_angular_rate(void);	// returns at once, calibration runs from the event loop
+bool lp_angular_rate_calibrated(void);
 AngularRateDegreesPerSecond lp_get_angular_rate(void);
 AccelerationMilligForce lp_get_acceleration(void);
+bool lp_imu_read_all(LP_IMU_SNAPSHOT* snapshot);	// may be called from a worker thread, the other calls are the event loop's
+bool lp_imu_set_policy(const LP_IMU_POLICY* policy);	// rates go to the nearest the sensors support
+void lp_imu_get_policy(LP_IMU_POLICY* policy);	// IMU status and outputs in one I2C transfer, plus the sensor hub copy of the LPS22HH
@@ -1,29 +1,64 @@
 #include "board.h"
+#include "globals.h"
 
-/// <summary>
-///     Reads telemetry and returns the length of JSON data.
-/// </summary>
-bool lp_readTelemetry(LP_ENVIRONMENT* environment)
+static bool ReadSimulated(float values[LP_SENSOR_VALUES]);
+
+static LP_SENSOR simulatedSensor = { .name = "simulated", .read = ReadSimulated, .period = { 1, 0 }, .readCostUs = 1, .prefetch = true };
+static LP_SENSOR* sensorSet[] = { &simulatedSensor };
+
+// temperature, humidity, pressure and light, the board has no sensors
+static bool ReadSimulated(float values[LP_SENSOR_VALUES])
 {
 	int rnd = (rand() % 10) - 5;
-	environment->temperature = (float)(25.0 + rnd);
-	environment->humidity = (float)(50.0 + rnd);
+	values[0] = (float)(25.0 + rnd);
+	values[1] = (float)(50.0 + rnd);
 
 	rnd = (rand() % 50) - 25;
-	environment->pressure = (float)(1000.0 + rnd);
-	environment->light = 0;
+	values[2] = (float)(1000.0 + rnd);
+	values[3] = 0;
 
 	return true;
 }
 
+/// <summary>
+///     The latest values the sensor timer read, never waits
+/// </summary>
+bool lp_readTelemetry(LP_ENVIRONMENT* environment)
+{
+	environment->temperature = simulatedSensor.values[0];
+	environment->humidity = simulatedSensor.values[1];
+	environment->pressure = simulatedSensor.values[2];
+	environment->light = (int)simulatedSensor.values[3];
+	environment->sampledAt = simulatedSensor.sampledAt;
+	environment->stale = lp_sensorIsStale(&simulatedSensor);
+
+	return true;
+}
+
+static void InitializeSensors(void* context) {
+
+	lp_startSensorSet(sensorSet, NELEMS(sensorSet));
+	lp_bootMark("sensors ready");
+}
+
 bool lp_initializeDevKit(void) {
 
 	srand((unsigned int)time(NULL)); // seed the random number generator for fake telemetry
 
+	// concurrent start up sets the sensors up from the event loop, between the first provisioning steps
+	if (lp_getInitMode() == LP_INIT_CONCURRENT) {
+		lp_deferWork(InitializeSensors, NULL);
+	}
+	else {
+		InitializeSensors(NULL);
+	}
+
 	return true;
 }
 
 bool lp_closeDevKit(void) {
 
+	lp_stopSensorSet();
+
 	return true;
-}
\ No newline at end of file
+}
@@ -1,22 +1,184 @@
 #include "azure_iot.h"
+#include "cloud_messages.h"
+#include "comms_thread.h"
+#include "event_trace.h"
+#include "inter_core.h"
+#include "rate_limit.h"
+#include "worker_pool.h"
+#include <azure_prov_client/prov_device_ll_client.h>
+#include <azure_prov_client/prov_security_factory.h>
+#include <azure_prov_client/prov_transport_mqtt_client.h>
+#include <iothub_client_core_ll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/random.h>
 #include <time.h>
 
-static const char* getAzureSphereProvisioningResultString(AZURE_SPHERE_PROV_RETURN_VALUE provisioningResult);
 static const char* GetReasonString(IOTHUB_CLIENT_CONNECTION_STATUS_REASON reason);
 static void SendMessageCallback(IOTHUB_CLIENT_CONFIRMATION_RESULT, void*);
 static bool SetupAzureClient(void);
 static void HubConnectionStatusCallback(IOTHUB_CLIENT_CONNECTION_STATUS, IOTHUB_CLIENT_CONNECTION_STATUS_REASON, void*);
 static void AzureCloudToDeviceHandler(EventLoopTimer*);
+static void TelemetryBatchFlushHandler(EventLoopTimer*);
+static bool SendMessage(const char* msg, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PROPERTY** overrides, size_t overrideCount);
+static bool SendToHub(const char* msg, LP_MESSAGE_PRIORITY priority);
+static bool SendToHubWithProperties(const char* msg, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PROPERTY** overrides, size_t overrideCount);
+static bool SendPayload(const uint8_t* payload, size_t length, const char* contentType, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PROPERTY** overrides, size_t overrideCount);
+static bool SendMessageHandle(IOTHUB_MESSAGE_HANDLE messageHandle, size_t meteredLength, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PROPERTY** overrides, size_t overrideCount);
+static void DrainOfflineQueue(void);
+static bool StartDpsRegistration(void);
+static bool CreateHubClient(const char* hubHostName);
+static int RunConnectionStateMachine(void);
 
 static IOTHUB_DEVICE_CLIENT_LL_HANDLE iothubClientHandle = NULL;
 static bool iothubAuthenticated = false;
-static const int keepalivePeriodSeconds = 20;
+static int _keepAliveMinSeconds = LP_KEEPALIVE_MIN_SECONDS;
+static int _keepAliveMaxSeconds = LP_KEEPALIVE_MAX_SECONDS;
+static int _keepAliveSeconds = LP_KEEPALIVE_MIN_SECONDS;	// negotiated by the next hub client
+static int _keepAliveInUseSeconds = 0;						// negotiated by the current hub client
+static struct timespec _keepAlivePeriodStart = { 0, 0 };
+static uint32_t _keepAlivePeriodSent = 0;
+static int _keepAliveBusyPeriods = 0;
 static const char* _connectionString = NULL;
 
+#define LP_HUB_HOSTNAME_MAX 128
+#define LP_DPS_TIMEOUT_MS 10000
+#define LP_DPS_POLL_MS 100
+
+typedef enum {
+	LP_DPS_PENDING,
+	LP_DPS_ASSIGNED,
+	LP_DPS_FAILED
+} LP_DPS_STATUS;
+
+static const char* dpsUrl = "global.azure-devices-provisioning.net";
+static const int deviceIdForDaaCertUsage = 1;	// authenticate with the Azure Sphere device certificate
+static char _hubHostName[LP_HUB_HOSTNAME_MAX];	// IoT Hub assigned by DPS, cached so reconnects skip the DPS round trip
+static bool _hubHostNameVerified = false;		// cached hub has authenticated at least once since it was provisioned
+static LP_DPS_STATUS _dpsStatus = LP_DPS_PENDING;
+static PROV_DEVICE_LL_HANDLE _provHandle = NULL;
+
+static _Atomic LP_CONNECTION_STATE _connectionState = LP_CONNECTION_NETWORK_WAIT;	// read from the app thread in comms thread mode
+static struct timespec _connectionStateEnteredAt = { 0, 0 };
+static bool _hubConnectionLost = false;		// set from the connection status callback, acted on outside DoWork
+static bool _hubRenewing = false;			// the SAS token expired, the SDK is reconnecting the same client with a new one
+static uint32_t _backoffAttempts = 0;			// failures since the last authenticated connection
+static bool _holdoffPending = true;			// the network has just come up, boot or recovery, wait out a random hold off first
+static uint32_t _jitterState = 0;			// xorshift32, seeded from getrandom so a fleet does not share a sequence
+static LP_CONNECTION_STATS _connectionStats;
+static pthread_mutex_t _connectionStatsLock = PTHREAD_MUTEX_INITIALIZER;	// the state machine may be on the comms thread
+static struct timespec _disconnectedAt = { 0, 0 };	// when the last authenticated connection was lost
+static struct timespec _lastDoWorkAt = { 0, 0 };
+static bool _doWorkIntervalOpen = false;		// cleared by a back off, the first DoWork of a connection has no interval
+static uint32_t _doWorkIntervals = 0;
+static uint64_t _doWorkIntervalTotalMs = 0;
+
 static LP_MESSAGE_PROPERTY** _messageProperties = NULL;
 static size_t _messagePropertyCount = 0;
 
-static const int maxPeriodSeconds = 5; // defines the max back off period for DoWork with lost network
+static int _backoffBaseMs = 1000;			// reconnect back off ceiling after the first failure, doubling with each one after
+static int _backoffCapMs = 60000;			// the ceiling stops doubling here
+static int _holdoffMaxMs = 5000;			// hold off after boot or the network coming back, 0 connects straight away
+static const int networkWaitPeriodMs = 1000;
+static const int connectTimeoutMs = 30000;	// CONNECTING gives up and backs off if the hub has not authenticated by then
+static size_t _offlineDrainPerTick = 1;
+static int _doWorkBusyPeriodMs = 50;		// DoWork cadence while messages or confirmations are outstanding
+static int _doWorkMaxIdlePeriodMs = 1000;	// DoWork idle back off ceiling, bounds inbound twin and direct method latency
+static int _doWorkIdlePeriodMs = 50;
+static uint32_t _eventsHandedOver = 0;		// messages the client accepted, counted where the client runs for the keep-alive
+static uint32_t _clientsDestroyed = 0;		// hub clients torn down, where the client runs
+static uint32_t _clientsAbandoned = 0;		// teardowns whose method handles the app thread has dropped
+
+// comms thread mode, the state machine runs on the comms thread and everything else on the app thread
+static uint32_t _commsInFlight = 0;				// comms thread, messages handed over and not confirmed
+static _Atomic uint32_t _appBacklog = 0;		// offline queue depth the app thread last saw
+static _Atomic bool _appServicePosted = false;	// a drain of the offline queue is queued to the app thread
+
+#define LP_COMPRESS_MIN_BYTES 128		// below this the LZ4 token overhead outweighs the saving
+#define LP_WORKER_BATCH_MIN_BYTES 4096	// LZ4 batches this large are compressed on the worker pool once it is open
+
+#define LP_SEND_CONTEXT_POOL_SIZE 32
+#define LP_LATENCY_BUCKETS 18				// power of two millisecond buckets, the last bucket holds >= 65 seconds
+
+#define LP_TRACE_PROPERTY "lp-trace"
+#define LP_TRACE_PROPERTY_SIZE 160
+
+typedef struct {
+	bool inUse;
+	uint32_t sequence;
+	uint32_t traceId;			// lp-trace id carried by the message, zero when untraced
+	struct timespec sentAt;
+} LP_SEND_CONTEXT;
+
+// hops of the inter-core record the next message traces, times in microseconds
+typedef struct {
+	bool armed;
+	uint32_t waitUs;
+	uint32_t sampleUs;
+	uint32_t roundTripUs;
+	uint32_t receivedUs;
+	uint32_t deliveredUs;
+} LP_MESSAGE_TRACE;
+
+// calls between the app and comms threads, each allocated by the poster and freed by its last call
+typedef struct {
+	IOTHUB_MESSAGE_HANDLE message;
+	LP_SEND_CONTEXT* sendContext;
+	IOTHUB_CLIENT_CONFIRMATION_RESULT result;
+} LP_COMMS_EVENT;
+
+typedef struct {
+	IOTHUB_CLIENT_REPORTED_STATE_CALLBACK callback;
+	void* context;
+	int statusCode;
+	size_t length;
+	unsigned char document[];
+} LP_COMMS_REPORT;
+
+typedef struct {
+	METHOD_HANDLE methodId;
+	uint32_t client;			// teardowns the app thread had seen, a response to an older client's handle is dropped
+	int statusCode;
+	size_t length;
+	unsigned char response[];
+} LP_COMMS_METHOD_RESPONSE;
+
+typedef struct {
+	METHOD_HANDLE methodId;
+	const char* methodName;		// after the payload
+	size_t length;
+	unsigned char payload[];
+} LP_COMMS_METHOD;
+
+typedef struct {
+	DEVICE_TWIN_UPDATE_STATE updateState;
+	size_t length;
+	unsigned char payload[];
+} LP_COMMS_TWIN;
+
+// a cloud to device message, the properties are NUL terminated after the body
+typedef struct {
+	LP_CLOUD_MESSAGE message;
+	unsigned char payload[];
+} LP_COMMS_CLOUD_MESSAGE;
+
+// a telemetry batch compressed on the worker pool, the event loop allocates and frees all of it
+typedef struct {
+	char* json;					// the batch buffer it was flushed from, NUL terminated
+	size_t length;
+	const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate;
+	uint8_t* compressed;		// length bytes
+	size_t compressedLength;	// 0 when the batch did not compress
+} LP_BATCH_JOB;
+
+static LP_SEND_CONTEXT _sendContexts[LP_SEND_CONTEXT_POOL_SIZE];
+static uint32_t _sendSequence = 0;
+static LP_TELEMETRY_STATS _telemetryStats;
+static uint32_t _latencyHistogram[LP_LATENCY_BUCKETS];
+static LP_MESSAGE_TRACE _nextTrace;
+static uint32_t _traceId = 0;
+static uint32_t _traceAckId = 0;		// last traced message the hub confirmed, reported on the next traced message
+static uint32_t _traceAckUs = 0;
 
 static LP_TIMER cloudToDeviceTimer = {
 	.period = { 0, 0 },			// one-shot timer
@@ -24,10 +186,63 @@ static LP_TIMER cloudToDeviceTimer = {
 	.handler = &AzureCloudToDeviceHandler
 };
 
+static char* _batchBuffer = NULL;
+static size_t _batchBufferSize = 0;
+static size_t _batchLength = 0;
+static size_t _batchCount = 0;
+static size_t _batchMaxMessages = 0;
+static unsigned int _batchDivisor = 1;		// lp_scaleTelemetryBatch, batches flush at this fraction of their size
+static struct timespec _batchMaxLatency = { 0, 0 };
+static const LP_MESSAGE_PROPERTY_TEMPLATE* _batchTemplate = NULL;
+static size_t _billingUnitBytes = LP_BILLING_UNIT_BYTES;
+
+static const char* _bootTimelineTwin = NULL;
+static uint32_t _batchJobs = 0;			// telemetry batches compressing on the worker pool
+static bool _shutdownFlushed = false;	// the shutdown hook flushed the batch and kicked DoWork
+
+static LP_TIMER telemetryBatchTimer = {
+	.period = { 0, 0 },			// one-shot timer, armed when the first reading of a batch is enqueued
+	.name = "telemetryBatchTimer",
+	.handler = &TelemetryBatchFlushHandler
+};
+
+/// <summary>
+///     Shutdown hook, flush the telemetry batch and kick DoWork once, DoWork then stays at the busy cadence until
+///     what was sent is confirmed and the offline queue drained. Finally persist what is left in the offline queue,
+///     messages handed to the SDK and not confirmed are lost with the client.
+/// </summary>
+static bool CloudToDeviceShutdown(bool final) {
+	if (final) {
+		size_t queued = lp_offlineQueueCount();
+		bool persisted = lp_offlineQueuePersist();		// commits the spill journal's batch too
+
+		if (queued > 0 || _telemetryStats.inFlight > 0) {
+			LP_LOG(LP_LOG_WARNING, "Shutdown with %u messages unconfirmed, %u queued %s\n", _telemetryStats.inFlight, (unsigned)queued,
+				persisted ? "persisted" : "not persisted");
+		}
+		return false;
+	}
+
+	if (!_shutdownFlushed) {
+		_shutdownFlushed = true;
+		lp_flushTelemetry();
+		lp_kickCloudToDevice();
+	}
+
+	// nothing is confirmed or drained without a connection, a compressing batch still reaches the offline queue
+	if (_connectionState != LP_CONNECTION_AUTHENTICATED) {
+		return _batchJobs > 0;
+	}
+	return _batchJobs > 0 || _telemetryStats.inFlight > 0 || lp_offlineQueueCount() > 0;
+}
+
 void lp_startCloudToDevice(void) {
-	if (cloudToDeviceTimer.eventLoopTimer == NULL) {
+	lp_addShutdownHook(CloudToDeviceShutdown);
+
+	if (cloudToDeviceTimer.eventLoopTimer == NULL && !lp_isCommsThreadRunning()) {
 		lp_startTimer(&cloudToDeviceTimer);
-		lp_setOneShotTimer(&cloudToDeviceTimer, &(struct timespec){1, 0});
+		// concurrent start up begins provisioning on the first event loop iteration, alongside the device set up
+		lp_setOneShotTimer(&cloudToDeviceTimer, lp_getInitMode() == LP_INIT_CONCURRENT ? &(struct timespec){0, 1} : &(struct timespec){1, 0});
 	}
 }
 
@@ -41,39 +256,303 @@ void lp_setConnectionString(const char* connectionString) {
 	_connectionString = connectionString;
 }
 
+/// <summary>
+///     Log the boot timeline once the first message is confirmed and report it when a twin is set
+/// </summary>
+static void BootTimelineComplete(void* context) {
+	lp_logBootTimeline();
+
+	if (_bootTimelineTwin != NULL) {
+		lp_reportBootTimeline(_bootTimelineTwin);
+	}
+}
+
 /// <summary>
 ///     Callback confirming message delivered to IoT Hub.
 /// </summary>
 /// <param name="result">Message delivery status</param>
 /// <param name="context">User specified context</param>
 static void SendMessageCallback(IOTHUB_CLIENT_CONFIRMATION_RESULT result, void* context) {
-	Log_Debug("INFO: Message received by IoT Hub. Result is: %d\n", result);
+	LP_SEND_CONTEXT* sendContext = (LP_SEND_CONTEXT*)context;
+	struct timespec now;
+
+	if (_telemetryStats.inFlight > 0) {
+		_telemetryStats.inFlight--;
+	}
+
+	switch (result) {
+	case IOTHUB_CLIENT_CONFIRMATION_OK:
+		_telemetryStats.confirmed++;
+		if (!lp_bootMarked("first message")) {
+			lp_bootMark("first message");
+			lp_deferWork(BootTimelineComplete, NULL);	// report outside DoWork
+		}
+		break;
+	case IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT:
+		_telemetryStats.timeouts++;
+		break;
+	default:
+		_telemetryStats.failed++;
+		break;
+	}
+
+	if (sendContext != NULL) {
+		if (result == IOTHUB_CLIENT_CONFIRMATION_OK) {
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			int64_t latencyMs = (now.tv_sec - sendContext->sentAt.tv_sec) * 1000 + (now.tv_nsec - sendContext->sentAt.tv_nsec) / 1000000;
+			uint32_t bucket = 0;
+
+			while (bucket < LP_LATENCY_BUCKETS - 1 && latencyMs >= (1LL << bucket)) {
+				bucket++;
+			}
+			_latencyHistogram[bucket]++;
+
+			if (latencyMs > _telemetryStats.latencyMaxMs) {
+				_telemetryStats.latencyMaxMs = (uint32_t)latencyMs;
+			}
+
+			// weight one eighth, a handful of confirmations move it
+			int64_t recentMs = _telemetryStats.latencyRecentMs;
+			_telemetryStats.latencyRecentMs = (uint32_t)(recentMs == 0 ? latencyMs : recentMs + (latencyMs - recentMs) / 8);
+
+			if (sendContext->traceId != 0) {
+				_traceAckId = sendContext->traceId;
+				_traceAckUs = (uint32_t)((now.tv_sec - sendContext->sentAt.tv_sec) * 1000000 + (now.tv_nsec - sendContext->sentAt.tv_nsec) / 1000);
+			}
+		}
+
+		LP_LOG(LP_LOG_DEBUG, "INFO: Message %u received by IoT Hub. Result is: %d\n", sendContext->sequence, result);
+		sendContext->inUse = false;
+	}
+	else {
+		LP_LOG(LP_LOG_DEBUG, "INFO: Message received by IoT Hub. Result is: %d\n", result);
+	}
 }
 
 /// <summary>
-///     Azure IoT Hub DoWork Handler with back off up to 5 seconds for network disconnect
+///     Returns the upper bound in milliseconds of the histogram bucket holding the given percentile
 /// </summary>
-static void AzureCloudToDeviceHandler(EventLoopTimer* eventLoopTimer) {
-	static int period = 1; //  initialize period to 1 second
+static uint32_t LatencyPercentile(uint32_t percentile) {
+	uint32_t total = 0;
+	uint32_t running = 0;
 
-	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
-		lp_terminate(ExitCode_AzureCloudToDeviceHandler);
+	for (int i = 0; i < LP_LATENCY_BUCKETS; i++) {
+		total += _latencyHistogram[i];
+	}
+
+	if (total == 0) {
+		return 0;
+	}
+
+	for (int i = 0; i < LP_LATENCY_BUCKETS; i++) {
+		running += _latencyHistogram[i];
+		if ((uint64_t)running * 100 >= (uint64_t)total * percentile) {
+			return 1u << i;
+		}
+	}
+
+	return 1u << (LP_LATENCY_BUCKETS - 1);
+}
+
+/// <summary>
+///     Snapshot of telemetry delivery counters and acknowledgement latency percentiles
+/// </summary>
+void lp_getTelemetryStats(LP_TELEMETRY_STATS* stats) {
+	if (stats == NULL) {
 		return;
 	}
 
-	if (iothubAuthenticated && iothubClientHandle != NULL) {
-		IoTHubDeviceClient_LL_DoWork(iothubClientHandle);
-		period = 1;
+	_telemetryStats.latencyP50Ms = LatencyPercentile(50);
+	_telemetryStats.latencyP95Ms = LatencyPercentile(95);
+	_telemetryStats.latencyP99Ms = LatencyPercentile(99);
+	_telemetryStats.packingPercent = _telemetryStats.billedUnits > 0 ?
+		(uint32_t)((uint64_t)_telemetryStats.meteredBytes * 100 / ((uint64_t)_telemetryStats.billedUnits * _billingUnitBytes)) : 0;
+
+	*stats = _telemetryStats;
+}
+
+void lp_resetTelemetryStats(void) {
+	uint32_t inFlight = _telemetryStats.inFlight;
+
+	memset(&_telemetryStats, 0, sizeof(_telemetryStats));
+	memset(_latencyHistogram, 0, sizeof(_latencyHistogram));
+	_telemetryStats.inFlight = inFlight;
+}
+
+/// <summary>
+///     Report the telemetry stats as a device twin reported property object named twinProperty
+/// </summary>
+bool lp_reportTelemetryStats(const char* twinProperty) {
+	LP_TELEMETRY_STATS stats;
+	LP_JSON_ARENA_STATS arenaStats;
+	LP_TIMER_STATS timerStats;
+	char reportedProperties[640];
+
+	if (twinProperty == NULL || !lp_connectToAzureIot()) {
+		return false;
 	}
-	else {
-		if (lp_connectToAzureIot()) {
-			period = 1;
+
+	lp_getTelemetryStats(&stats);
+	lp_getJsonArenaStats(&arenaStats);
+	lp_getTimerStats(&timerStats);
+
+	int len = snprintf(reportedProperties, sizeof(reportedProperties),
+		"{\"%s\":{\"sent\":%u,\"confirmed\":%u,\"failed\":%u,\"timeouts\":%u,\"inFlight\":%u,\"p50Ms\":%u,\"p95Ms\":%u,\"p99Ms\":%u,\"maxMs\":%u,\"payloadBytes\":%u,\"wireBytes\":%u,\"billedUnits\":%u,\"packingPct\":%u,\"arenaHighWater\":%u,\"arenaOverflows\":%u,\"jsonNodesReused\":%lu,\"jsonNodesAllocated\":%lu,\"timerWakeups\":%u,\"timerWakeupsSaved\":%u}}",
+		twinProperty, stats.sent, stats.confirmed, stats.failed, stats.timeouts, stats.inFlight,
+		stats.latencyP50Ms, stats.latencyP95Ms, stats.latencyP99Ms, stats.latencyMaxMs, stats.payloadBytes, stats.wireBytes,
+		stats.billedUnits, stats.packingPercent, (unsigned int)arenaStats.highWater, arenaStats.overflows,
+		arenaStats.nodesReused, arenaStats.nodesAllocated, timerStats.wakeups, timerStats.wakeupsSaved);
+
+	if (len < 0 || len >= (int)sizeof(reportedProperties)) {
+		return false;
+	}
+
+	lp_rateLimitTake(LP_RATE_REPORTED);		// one-off diagnostics, they take a token but are not held back
+
+	if (!lp_sendReportedState((unsigned char*)reportedProperties, (size_t)len, lp_deviceTwinsReportStatusCallback, 0)) {
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: failed to report telemetry stats\n");
+		return false;
+	}
+
+	lp_pumpCloudToDevice();
+
+	return true;
+}
+
+/// <summary>
+///     Report the boot timeline as a device twin reported property object named twinProperty
+/// </summary>
+bool lp_reportBootTimeline(const char* twinProperty) {
+	char reportedProperties[512];
+	char timeline[448];
+
+	if (twinProperty == NULL || !lp_connectToAzureIot() || lp_formatBootTimeline(timeline, sizeof(timeline)) < 0) {
+		return false;
+	}
+
+	int len = snprintf(reportedProperties, sizeof(reportedProperties), "{\"%s\":%s}", twinProperty, timeline);
+	if (len < 0 || len >= (int)sizeof(reportedProperties)) {
+		return false;
+	}
+
+	lp_rateLimitTake(LP_RATE_REPORTED);		// one-off diagnostics, they take a token but are not held back
+
+	if (!lp_sendReportedState((unsigned char*)reportedProperties, (size_t)len, lp_deviceTwinsReportStatusCallback, 0)) {
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: failed to report the boot timeline\n");
+		return false;
+	}
+
+	lp_pumpCloudToDevice();
+
+	return true;
+}
+
+/// <summary>
+///     Log the boot timeline once the first message is confirmed and report it as twinProperty, NULL only logs
+/// </summary>
+void lp_setBootTimelineTwin(const char* twinProperty) {
+	_bootTimelineTwin = twinProperty;
+}
+
+/// <summary>
+///     Take a context from the fixed pool so no allocation is needed per message.
+///     Returns NULL when more messages are in flight than the pool holds, those messages are counted but not timed.
+/// </summary>
+static LP_SEND_CONTEXT* AcquireSendContext(void) {
+	for (int i = 0; i < LP_SEND_CONTEXT_POOL_SIZE; i++) {
+		if (!_sendContexts[i].inUse) {
+			_sendContexts[i].inUse = true;
+			_sendContexts[i].sequence = _sendSequence;
+			_sendContexts[i].traceId = 0;
+			clock_gettime(CLOCK_MONOTONIC, &_sendContexts[i].sentAt);
+			return &_sendContexts[i];
 		}
-		else {
-			if (period < maxPeriodSeconds) { period++; }
+	}
+	return NULL;
+}
+
+/// <summary>
+///     Set the DoWork cadence used while outbound messages or confirmations are pending and the
+///     ceiling the cadence backs off to exponentially when the connection is idle
+/// </summary>
+void lp_setDoWorkCadence(int busyPeriodMs, int maxIdlePeriodMs) {
+	_doWorkBusyPeriodMs = busyPeriodMs < 1 ? 1 : busyPeriodMs;
+	_doWorkMaxIdlePeriodMs = maxIdlePeriodMs < _doWorkBusyPeriodMs ? _doWorkBusyPeriodMs : maxIdlePeriodMs;
+	_doWorkIdlePeriodMs = _doWorkBusyPeriodMs;
+}
+
+/// <summary>
+///     Bound the MQTT keep-alive, equal bounds fix it. It starts at minSeconds, doubles towards maxSeconds while
+///     every keep-alive period carries messages and halves after the hub stops answering pings. The SDK
+///     reconnects to change the keep-alive of a live client, so a new value is negotiated by the next connection.
+/// </summary>
+void lp_setKeepAlive(int minSeconds, int maxSeconds) {
+	_keepAliveMinSeconds = minSeconds < 1 ? 1 : minSeconds;
+	_keepAliveMaxSeconds = maxSeconds < _keepAliveMinSeconds ? _keepAliveMinSeconds : maxSeconds;
+	_keepAliveSeconds = _keepAliveMinSeconds;
+	_keepAliveBusyPeriods = 0;
+}
+
+/// <summary>
+///     Set the reconnect back off. Each failure waits a random time up to a ceiling that starts at baseMs and doubles
+///     per failure to capMs, full jitter, so devices that lost the same hub or access point spread their retries out.
+///     The first connection after boot or after the network comes back waits a random time up to holdoffMaxMs.
+///     Takes effect from the next back off, the failure count is kept.
+/// </summary>
+void lp_setReconnectBackoff(int baseMs, int capMs, int holdoffMaxMs) {
+	_backoffBaseMs = baseMs < 1 ? 1 : baseMs;
+	_backoffCapMs = capMs < _backoffBaseMs ? _backoffBaseMs : capMs;
+	_holdoffMaxMs = holdoffMaxMs < 0 ? 0 : holdoffMaxMs;
+}
+
+/// <summary>
+///     Read the reconnect back off as set, for reporting it back
+/// </summary>
+void lp_getReconnectBackoff(int* baseMs, int* capMs, int* holdoffMaxMs) {
+	*baseMs = _backoffBaseMs;
+	*capMs = _backoffCapMs;
+	*holdoffMaxMs = _holdoffMaxMs;
+}
+
+/// <summary>
+///     Pull the next DoWork forward to the busy cadence. Called when there is outbound work queued
+///     or inbound cloud to device activity, so follow up traffic is pumped without waiting for the idle period.
+/// </summary>
+void lp_kickCloudToDevice(void) {
+	if (lp_isCommsThreadRunning()) {
+		// the comms thread resets the idle period itself and runs the step straight away
+		if (_connectionState == LP_CONNECTION_CONNECTING || _connectionState == LP_CONNECTION_AUTHENTICATED) {
+			lp_kickCommsThread();
 		}
+		return;
+	}
+
+	_doWorkIdlePeriodMs = _doWorkBusyPeriodMs;
+
+	if (cloudToDeviceTimer.eventLoopTimer != NULL &&
+		(_connectionState == LP_CONNECTION_CONNECTING || _connectionState == LP_CONNECTION_AUTHENTICATED)) {
+		lp_setTimerSlack(&cloudToDeviceTimer, &(struct timespec){0, 0});
+		lp_setOneShotTimer(&cloudToDeviceTimer, &(struct timespec){_doWorkBusyPeriodMs / 1000, (_doWorkBusyPeriodMs % 1000) * 1000000});
+	}
+}
+
+/// <summary>
+///     Azure IoT Hub DoWork Handler, drives the connection state machine from the event loop
+/// </summary>
+static void AzureCloudToDeviceHandler(EventLoopTimer* eventLoopTimer) {
+	int delayMs;
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_AzureCloudToDeviceHandler);
+		return;
 	}
-	lp_setOneShotTimer(&cloudToDeviceTimer, &(struct timespec){period, 0});
+
+	delayMs = RunConnectionStateMachine();
+
+	// idle polls may drift a quarter of their period to share a wakeup, busy polls stay exact
+	int slackMs = delayMs > _doWorkBusyPeriodMs ? delayMs / 4 : 0;
+	lp_setTimerSlack(&cloudToDeviceTimer, &(struct timespec){slackMs / 1000, (slackMs % 1000) * 1000000});
+	lp_setOneShotTimer(&cloudToDeviceTimer, &(struct timespec){delayMs / 1000, (delayMs % 1000) * 1000000});
 }
 
 void lp_setMessageProperties(LP_MESSAGE_PROPERTY** messageProperties, size_t messagePropertyCount)
@@ -88,165 +567,1568 @@ void lp_clearMessageProperties(void)
 	_messagePropertyCount = 0;
 }
 
+/// <summary>
+///     Take a telemetry token, critical messages are sent whether or not there is one
+/// </summary>
+static bool AdmitMessage(LP_MESSAGE_PRIORITY priority) {
+	return lp_rateLimitTake(LP_RATE_TELEMETRY) || priority == LP_PRIORITY_CRITICAL;
+}
+
 bool lp_sendMsg(const char* msg) {
-	if (strlen(msg) < 1) {
+	return lp_sendMsgWithPriority(msg, LP_PRIORITY_NORMAL);
+}
+
+/// <summary>
+///     Send msg in a priority class. Bulk messages join the telemetry batch when one is open, critical
+///     messages are never batched and, if they cannot be sent now, are resent ahead of everything else queued.
+/// </summary>
+bool lp_sendMsgWithPriority(const char* msg, LP_MESSAGE_PRIORITY priority) {
+	size_t msgLength = strlen(msg);
+
+	if (msgLength < 1) {
 		return true;
 	}
 
-	if (!lp_connectToAzureIot()) {
-		return false;
+	if (priority == LP_PRIORITY_BULK && _batchBuffer != NULL) {
+		return lp_enqueueTelemetry(msg);
 	}
 
-	IOTHUB_MESSAGE_HANDLE messageHandle = IoTHubMessage_CreateFromString(msg);
+	lp_publishLocal(msg, msgLength);
+	return SendToHub(msg, priority);
+}
 
-	if (messageHandle == 0) {
-		Log_Debug("WARNING: unable to create a new IoTHubMessage\n");
+/// <summary>
+///     Send msg to the hub only, or queue it to send once reconnected
+/// </summary>
+static bool SendToHub(const char* msg, LP_MESSAGE_PRIORITY priority) {
+	if (!lp_connectToAzureIot() || !AdmitMessage(priority) || !SendMessage(msg, NULL, NULL, 0)) {
+		// store and forward, AzureCloudToDeviceHandler drains the offline queue once reconnected
+		lp_offlineQueuePush(msg, priority);
 		return false;
 	}
 
-	if (_messageProperties != NULL)
-	{
-		for (size_t i = 0; i < _messagePropertyCount; i++)
-		{
-			if (_messageProperties[i]->key != NULL && _messageProperties[i]->value != NULL)
-			{
-				IoTHubMessage_SetProperty(messageHandle, _messageProperties[i]->key, _messageProperties[i]->value);
-			}
-		}
-	}
+	return true;
+}
 
-	if (IoTHubDeviceClient_LL_SendEventAsync(iothubClientHandle, messageHandle, SendMessageCallback,
-		/*&callback_param*/ 0) != IOTHUB_CLIENT_OK) {
-		Log_Debug("WARNING: failed to hand over the message to IoTHubClient\n");
-		return false;
-	}
-	else {
-		Log_Debug("INFO: IoTHubClient accepted the message for delivery\n");
+/// <summary>
+///     Set the maximum number of offline queued messages resent per DoWork tick once reconnected
+///     so draining the backlog does not starve device twin and direct method traffic
+/// </summary>
+void lp_setOfflineQueueDrainRate(size_t messagesPerTick) {
+	_offlineDrainPerTick = messagesPerTick < 1 ? 1 : messagesPerTick;
+}
+
+/// <summary>
+///     Send a message with a compiled property template. Overrides replace the template value for a matching
+///     key, or are added when the key is not in the template.
+/// </summary>
+bool lp_sendMsgWithProperties(const char* msg, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PROPERTY** overrides, size_t overrideCount) {
+	size_t msgLength = strlen(msg);
+
+	if (msgLength < 1) {
+		return true;
 	}
 
-	IoTHubMessage_Destroy(messageHandle);
+	lp_publishLocal(msg, msgLength);
+	return SendToHubWithProperties(msg, propertyTemplate, overrides, overrideCount);
+}
 
-	IoTHubDeviceClient_LL_DoWork(iothubClientHandle);
+static bool SendToHubWithProperties(const char* msg, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PROPERTY** overrides, size_t overrideCount) {
+	if (!lp_connectToAzureIot() || !AdmitMessage(propertyTemplate != NULL ? propertyTemplate->priority : LP_PRIORITY_NORMAL) ||
+		!SendMessage(msg, propertyTemplate, overrides, overrideCount)) {
+		lp_offlineQueuePush(msg, propertyTemplate != NULL ? propertyTemplate->priority : LP_PRIORITY_NORMAL);
+		return false;
+	}
 
 	return true;
 }
 
-bool lp_isNetworkReady(void) {
-	bool isNetworkReady = false;
-	if (Networking_IsNetworkingReady(&isNetworkReady) != -1) {
-		if (isNetworkReady) {
-			return true;
-		}
-		else {
-			Log_Debug("\nNetwork not ready.\nFrom azure sphere command prompt, run azsphere device wifi show-status\n\n");
-			return false;
-		}
-	}
-	else {
-		Log_Debug("Failed to get Network state\n");
+/// <summary>
+///     Send a message built with the telemetry encoder. JSON messages go through lp_sendMsgWithProperties
+///     (offline queue included), CBOR messages are sent with contentType application/cbor and are
+///     not queued while disconnected as the offline queue holds text.
+/// </summary>
+bool lp_sendTelemetry(LP_TELEMETRY_ENCODER* encoder, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate) {
+	if (encoder == NULL || encoder->overflow || encoder->length == 0) {
 		return false;
 	}
-}
 
+	if (encoder->format == LP_TELEMETRY_JSON) {
+		return lp_sendMsgWithProperties((const char*)encoder->buffer, propertyTemplate, NULL, 0);
+	}
 
-IOTHUB_DEVICE_CLIENT_LL_HANDLE lp_getAzureIotClientHandle(void) {
-	return iothubClientHandle;
-}
+	if (!lp_connectToAzureIot() || !AdmitMessage(propertyTemplate != NULL ? propertyTemplate->priority : LP_PRIORITY_NORMAL)) {
+		return false;
+	}
 
+	return SendPayload(encoder->buffer, encoder->length, lp_telemetryContentType(encoder), propertyTemplate, NULL, 0);
+}
 
 /// <summary>
-///     Check if network connected or already connected, else sets up connection to Azure IoT
+///     Send a time series block as one message with contentType LP_TIMESERIES_CONTENT_TYPE. Like CBOR it is
+///     not queued while disconnected, keep the block and send it again, or start the next one, on false.
 /// </summary>
-bool lp_connectToAzureIot(void) {
-	if (!lp_isNetworkReady()) {
+bool lp_sendTimeseries(const LP_TIMESERIES_BLOCK* block, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate) {
+	if (block == NULL || block->buffer == NULL || block->count == 0) {
 		return false;
 	}
-	else {
-		if (iothubAuthenticated) {
-			return true;
-		}
-		else {
-			return SetupAzureClient();
-		}
+
+	if (!lp_connectToAzureIot() || !AdmitMessage(propertyTemplate != NULL ? propertyTemplate->priority : LP_PRIORITY_NORMAL)) {
+		return false;
 	}
-}
 
+	return SendPayload(block->buffer, lp_timeseriesLength(block), LP_TIMESERIES_CONTENT_TYPE, propertyTemplate, NULL, 0);
+}
 
 /// <summary>
-///     Sets up the Azure IoT Hub connection (creates the iothubClientHandle)
-///     When the SAS Token for a device expires the connection needs to be recreated
-///     which is why this is not simply a one time call.
+///     Validate a message property set once and copy the keys and values into a single allocation owned by
+///     the template so it can be attached to any number of messages without being rechecked
 /// </summary>
-static bool SetupAzureClient() {
-	if (iothubClientHandle != NULL) {
-		IoTHubDeviceClient_LL_Destroy(iothubClientHandle);
+bool lp_compileMessagePropertyTemplate(LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PROPERTY** messageProperties, size_t messagePropertyCount) {
+	size_t stringBytes = 0;
+	char* strings;
+
+	if (propertyTemplate == NULL || (messageProperties == NULL && messagePropertyCount > 0)) {
+		return false;
 	}
 
-	// For lab purposes only where the device tenant and associated x500 certificate may not be available
-	// DO NOT use connection strings in production
-	if (_connectionString != NULL && strlen(_connectionString) != 0) {
-		IOTHUB_CLIENT_TRANSPORT_PROVIDER protocol = MQTT_Protocol;
-		iothubClientHandle = IoTHubDeviceClient_LL_CreateFromConnectionString(_connectionString, protocol);
-		if (iothubClientHandle == NULL) {
-			Log_Debug("Failure to create IoT Hub Client from connection string");
+	memset(propertyTemplate, 0, sizeof(LP_MESSAGE_PROPERTY_TEMPLATE));
+
+	for (size_t i = 0; i < messagePropertyCount; i++) {
+		if (messageProperties[i] == NULL || messageProperties[i]->key == NULL || strlen(messageProperties[i]->key) == 0 || messageProperties[i]->value == NULL) {
+			LP_LOG(LP_LOG_ERROR, "ERROR: message property %u is missing a key or value\n", (unsigned int)i);
 			return false;
 		}
-	}
-	else {
-		AZURE_SPHERE_PROV_RETURN_VALUE provResult = IoTHubDeviceClient_LL_CreateWithAzureSphereDeviceAuthProvisioning(scopeId, 10000, &iothubClientHandle);
-		Log_Debug("IoTHubDeviceClient_LL_CreateWithAzureSphereDeviceAuthProvisioning returned '%s'.\n", getAzureSphereProvisioningResultString(provResult));
-		if (provResult.result != AZURE_SPHERE_PROV_RESULT_OK) {
-			Log_Debug("ERROR: failure to create IoTHub Handle.\n");
-			return false;
+
+		for (size_t j = 0; j < i; j++) {
+			if (strcmp(messageProperties[i]->key, messageProperties[j]->key) == 0) {
+				LP_LOG(LP_LOG_ERROR, "ERROR: duplicate message property key '%s'\n", messageProperties[i]->key);
+				return false;
+			}
 		}
+
+		stringBytes += strlen(messageProperties[i]->key) + strlen(messageProperties[i]->value) + 2;
 	}
-	   
-	if (IoTHubDeviceClient_LL_SetOption(iothubClientHandle, OPTION_KEEP_ALIVE, &keepalivePeriodSeconds) != IOTHUB_CLIENT_OK) {
-		Log_Debug("ERROR: failure setting option \"%s\"\n", OPTION_KEEP_ALIVE);
+
+	if (messagePropertyCount == 0) {
+		return true;
+	}
+
+	// one allocation holds the property array followed by the key and value strings
+	propertyTemplate->properties = (LP_MESSAGE_PROPERTY*)lp_heapMalloc(LP_HEAP_TELEMETRY, messagePropertyCount * sizeof(LP_MESSAGE_PROPERTY) + stringBytes);
+	if (propertyTemplate->properties == NULL) {
 		return false;
 	}
 
-	iothubAuthenticated = true;
+	strings = (char*)(propertyTemplate->properties + messagePropertyCount);
 
-	IoTHubDeviceClient_LL_SetDeviceTwinCallback(iothubClientHandle, lp_twinCallback, NULL);
-	IoTHubDeviceClient_LL_SetDeviceMethodCallback(iothubClientHandle, lp_azureDirectMethodHandler, NULL);
-	IoTHubDeviceClient_LL_SetConnectionStatusCallback(iothubClientHandle, HubConnectionStatusCallback, NULL);
+	for (size_t i = 0; i < messagePropertyCount; i++) {
+		size_t keyLength = strlen(messageProperties[i]->key) + 1;
+		size_t valueLength = strlen(messageProperties[i]->value) + 1;
+
+		memcpy(strings, messageProperties[i]->key, keyLength);
+		propertyTemplate->properties[i].key = strings;
+		strings += keyLength;
+
+		memcpy(strings, messageProperties[i]->value, valueLength);
+		propertyTemplate->properties[i].value = strings;
+		strings += valueLength;
+	}
 
-	IoTHubDeviceClient_LL_DoWork(iothubClientHandle);
+	propertyTemplate->propertyCount = messagePropertyCount;
+	propertyTemplate->bytes = stringBytes;
+
+	return true;
+}
+
+/// <summary>
+///     Select the payload encoding for messages sent with this template, compression is skipped
+///     for payloads under LP_COMPRESS_MIN_BYTES and whenever it would not save bytes
+/// </summary>
+void lp_setMessageEncoding(LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_PAYLOAD_ENCODING encoding) {
+	if (propertyTemplate != NULL) {
+		propertyTemplate->encoding = encoding;
+	}
+}
+
+/// <summary>
+///     Select the offline queue priority class for messages sent with this template
+/// </summary>
+void lp_setMessagePriority(LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PRIORITY priority) {
+	if (propertyTemplate != NULL) {
+		propertyTemplate->priority = priority;
+	}
+}
+
+void lp_freeMessagePropertyTemplate(LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate) {
+	if (propertyTemplate != NULL && propertyTemplate->properties != NULL) {
+		lp_heapFree(LP_HEAP_TELEMETRY, propertyTemplate->properties);
+		memset(propertyTemplate, 0, sizeof(LP_MESSAGE_PROPERTY_TEMPLATE));
+	}
+}
+
+static const char* FindPropertyOverride(const char* key, LP_MESSAGE_PROPERTY** overrides, size_t overrideCount) {
+	for (size_t i = 0; i < overrideCount; i++) {
+		if (overrides[i] != NULL && overrides[i]->key != NULL && strcmp(overrides[i]->key, key) == 0) {
+			return overrides[i]->value;
+		}
+	}
+	return NULL;
+}
+
+/// <summary>
+///     Wrap the LZ4 block of a length byte payload in a message tagged contentEncoding lz4
+/// </summary>
+static IOTHUB_MESSAGE_HANDLE CreateLz4Message(const uint8_t* compressed, size_t compressedLength, size_t length, const char* contentType, size_t* wireLength) {
+	IOTHUB_MESSAGE_HANDLE messageHandle = IoTHubMessage_CreateFromByteArray(compressed, compressedLength);
+
+	if (messageHandle != NULL) {
+		IoTHubMessage_SetContentTypeSystemProperty(messageHandle, contentType != NULL ? contentType : "application/json");
+		IoTHubMessage_SetContentEncodingSystemProperty(messageHandle, "lz4");
+		_telemetryStats.payloadBytes += (uint32_t)length;
+		_telemetryStats.wireBytes += (uint32_t)compressedLength;
+		*wireLength = compressedLength;
+	}
+
+	return messageHandle;
+}
+
+/// <summary>
+///     Create the message handle, LZ4 compressing the payload when the encoding asks for it and it saves bytes.
+///     Compressed messages carry contentEncoding lz4 (raw LZ4 block, at most LP_COMPRESS_MAX_INPUT bytes decompressed).
+///     A NULL contentType is a null terminated JSON string sent as before.
+/// </summary>
+static IOTHUB_MESSAGE_HANDLE CreateMessage(const uint8_t* payload, size_t length, const char* contentType, LP_PAYLOAD_ENCODING encoding, size_t* wireLength) {
+	IOTHUB_MESSAGE_HANDLE messageHandle = NULL;
+
+	if (encoding == LP_ENCODING_LZ4 && length >= LP_COMPRESS_MIN_BYTES && length <= LP_COMPRESS_MAX_INPUT) {
+		uint8_t* compressed = (uint8_t*)lp_heapMalloc(LP_HEAP_TELEMETRY, length);
+		size_t compressedLength = compressed != NULL ? lp_compressLz4(payload, length, compressed, length - 1) : 0;
+
+		if (compressedLength > 0) {
+			messageHandle = CreateLz4Message(compressed, compressedLength, length, contentType, wireLength);
+		}
+
+		lp_heapFree(LP_HEAP_TELEMETRY, compressed);
+
+		if (messageHandle != NULL) {
+			return messageHandle;
+		}
+	}
+
+	if (contentType == NULL) {
+		messageHandle = IoTHubMessage_CreateFromString((const char*)payload);
+	}
+	else if ((messageHandle = IoTHubMessage_CreateFromByteArray(payload, length)) != NULL) {
+		IoTHubMessage_SetContentTypeSystemProperty(messageHandle, contentType);
+	}
+
+	if (messageHandle != NULL) {
+		_telemetryStats.payloadBytes += (uint32_t)length;
+		_telemetryStats.wireBytes += (uint32_t)length;
+		*wireLength = length;
+	}
+
+	return messageHandle;
+}
+
+/// <summary>
+///     Trace the inter-core record behind the next message sent. The message carries an lp-trace property of
+///     the record's hops in microseconds: wait, the real-time app from request to sample; sample, from the sample
+///     to the frame write; transport, half the request round trip less the real-time app's share; dispatch,
+///     ProcessMsg to the inter-core callback; handler, the callback to the send. sent is the UTC send time in
+///     milliseconds, to compare with iothub-enqueuedtime, and ack the confirmation time of the previous traced
+///     message, which is not known until after that message has gone. False when the record is not traced.
+/// </summary>
+bool lp_traceNextMessage(const LP_INTER_CORE_BLOCK* source) {
+	if (source == NULL || !source->traced) {
+		return false;
+	}
+
+	_nextTrace = (LP_MESSAGE_TRACE){ .armed = true, .waitUs = source->traceWaitUs, .sampleUs = source->traceSampleUs,
+		.roundTripUs = source->traceRoundTripUs, .receivedUs = source->traceReceivedUs, .deliveredUs = source->traceDeliveredUs };
+
+	return true;
+}
+
+static void AttachTrace(IOTHUB_MESSAGE_HANDLE messageHandle, LP_SEND_CONTEXT* sendContext) {
+	char property[LP_TRACE_PROPERTY_SIZE];
+	uint32_t realTimeUs = _nextTrace.waitUs + _nextTrace.sampleUs;
+	struct timespec utc;
+	int length;
+
+	_nextTrace.armed = false;
+
+	if (++_traceId == 0) {
+		_traceId = 1;
+	}
+
+	clock_gettime(CLOCK_REALTIME, &utc);
+
+	length = snprintf(property, sizeof(property), "id=%u;wait=%u;sample=%u;transport=%u;dispatch=%u;handler=%u;sent=%lld",
+		_traceId, _nextTrace.waitUs, _nextTrace.sampleUs,
+		_nextTrace.roundTripUs > realTimeUs ? (_nextTrace.roundTripUs - realTimeUs) / 2 : 0,
+		_nextTrace.deliveredUs - _nextTrace.receivedUs, lp_interCoreTraceClockUs() - _nextTrace.deliveredUs,
+		(long long)utc.tv_sec * 1000 + utc.tv_nsec / 1000000);
+
+	if (_traceAckId != 0 && length > 0 && (size_t)length < sizeof(property)) {
+		snprintf(property + length, sizeof(property) - (size_t)length, ";ack=%u:%u", _traceAckId, _traceAckUs);
+		_traceAckId = 0;
+	}
+
+	IoTHubMessage_SetProperty(messageHandle, LP_TRACE_PROPERTY, property);
+
+	if (sendContext != NULL) {
+		sendContext->traceId = _traceId;
+	}
+}
+
+/// <summary>
+///     Set an application property, returns the bytes it adds to the metered message size
+/// </summary>
+static size_t SetMeteredProperty(IOTHUB_MESSAGE_HANDLE messageHandle, const char* key, const char* value) {
+	IoTHubMessage_SetProperty(messageHandle, key, value);
+	return strlen(key) + strlen(value);
+}
+
+/// <summary>
+///     Count a sent message against the billing unit, the hub rounds every message up to a whole unit
+/// </summary>
+static void MeterMessage(size_t meteredLength) {
+	_telemetryStats.meteredBytes += (uint32_t)meteredLength;
+	_telemetryStats.billedUnits += (uint32_t)((meteredLength + _billingUnitBytes - 1) / _billingUnitBytes);
+}
+
+static void EventConfirmedOnApp(void* context) {
+	LP_COMMS_EVENT* event = (LP_COMMS_EVENT*)context;
+
+	SendMessageCallback(event->result, event->sendContext);
+	free(event);
+}
+
+static void CommsEventConfirmed(IOTHUB_CLIENT_CONFIRMATION_RESULT result, void* context) {
+	LP_COMMS_EVENT* event = (LP_COMMS_EVENT*)context;
+
+	if (_commsInFlight > 0) {
+		_commsInFlight--;
+	}
+	event->result = result;
+	lp_postToAppThread(EventConfirmedOnApp, event);
+}
+
+/// <summary>
+///     Comms thread side of HandOverEvent, a message the client will not take is confirmed as failed
+/// </summary>
+static void SendEventOnComms(void* context) {
+	LP_COMMS_EVENT* event = (LP_COMMS_EVENT*)context;
+
+	if (iothubClientHandle == NULL ||
+		IoTHubDeviceClient_LL_SendEventAsync(iothubClientHandle, event->message, CommsEventConfirmed, event) != IOTHUB_CLIENT_OK) {
+		IoTHubMessage_Destroy(event->message);
+		event->result = IOTHUB_CLIENT_CONFIRMATION_ERROR;
+		lp_postToAppThread(EventConfirmedOnApp, event);
+		return;
+	}
+
+	IoTHubMessage_Destroy(event->message);
+	_eventsHandedOver++;
+	_commsInFlight++;
+	lp_kickCommsThread();
+}
+
+/// <summary>
+///     Give the message to the IoT Hub client, or queue it to the comms thread when the client runs there.
+///     Takes the message handle either way, false when it was not accepted.
+/// </summary>
+static bool HandOverEvent(IOTHUB_MESSAGE_HANDLE messageHandle, LP_SEND_CONTEXT* sendContext) {
+	if (!lp_isCommsThreadRunning()) {
+		bool accepted = IoTHubDeviceClient_LL_SendEventAsync(iothubClientHandle, messageHandle, SendMessageCallback, sendContext) == IOTHUB_CLIENT_OK;
+
+		IoTHubMessage_Destroy(messageHandle);
+		_eventsHandedOver += accepted ? 1 : 0;
+		return accepted;
+	}
+
+	LP_COMMS_EVENT* event = malloc(sizeof(LP_COMMS_EVENT));
+
+	if (event != NULL) {
+		*event = (LP_COMMS_EVENT){ .message = messageHandle, .sendContext = sendContext };
+		if (lp_postToCommsThread(SendEventOnComms, event)) {
+			return true;
+		}
+		free(event);
+	}
+
+	IoTHubMessage_Destroy(messageHandle);
+	return false;
+}
+
+static void ReportConfirmedOnApp(void* context) {
+	LP_COMMS_REPORT* report = (LP_COMMS_REPORT*)context;
+
+	if (report->callback != NULL) {
+		report->callback(report->statusCode, report->context);
+	}
+	free(report);
+}
+
+static void CommsReportConfirmed(int statusCode, void* context) {
+	LP_COMMS_REPORT* report = (LP_COMMS_REPORT*)context;
+
+	report->statusCode = statusCode;
+	lp_postToAppThread(ReportConfirmedOnApp, report);
+}
+
+static void SendReportOnComms(void* context) {
+	LP_COMMS_REPORT* report = (LP_COMMS_REPORT*)context;
+
+	if (iothubClientHandle == NULL ||
+		IoTHubDeviceClient_LL_SendReportedState(iothubClientHandle, report->document, report->length, CommsReportConfirmed, report) != IOTHUB_CLIENT_OK) {
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: the comms thread could not send a reported state update\n");
+		free(report);
+		return;
+	}
+
+	lp_kickCommsThread();
+}
+
+/// <summary>
+///     Send a reported properties document, the SDK or the comms thread queue takes a copy of it.
+///     In comms thread mode the callback runs on the app thread.
+/// </summary>
+bool lp_sendReportedState(const unsigned char* document, size_t length, IOTHUB_CLIENT_REPORTED_STATE_CALLBACK callback, void* context) {
+	if (!lp_isCommsThreadRunning()) {
+		return IoTHubDeviceClient_LL_SendReportedState(iothubClientHandle, document, length, callback, context) == IOTHUB_CLIENT_OK;
+	}
+
+	LP_COMMS_REPORT* report = malloc(sizeof(LP_COMMS_REPORT) + length);
+
+	if (report == NULL) {
+		return false;
+	}
+
+	*report = (LP_COMMS_REPORT){ .callback = callback, .context = context, .length = length };
+	memcpy(report->document, document, length);
+
+	if (!lp_postToCommsThread(SendReportOnComms, report)) {
+		free(report);
+		return false;
+	}
+
+	return true;
+}
+
+static void SendMethodResponseOnComms(void* context) {
+	LP_COMMS_METHOD_RESPONSE* response = (LP_COMMS_METHOD_RESPONSE*)context;
+
+	// the handle is only valid on the client that delivered the invocation
+	if (iothubClientHandle != NULL && response->client == _clientsDestroyed) {
+		IoTHubDeviceClient_LL_DeviceMethodResponse(iothubClientHandle, response->methodId, response->response, response->length, response->statusCode);
+		lp_kickCommsThread();
+	}
+	free(response);
+}
+
+/// <summary>
+///     Answer a direct method invocation delivered through the inbound method callback, the SDK or the comms
+///     thread queue takes a copy of the response
+/// </summary>
+bool lp_sendMethodResponse(METHOD_HANDLE methodId, int statusCode, const unsigned char* response, size_t length) {
+	if (!lp_isCommsThreadRunning()) {
+		return iothubClientHandle != NULL &&
+			IoTHubDeviceClient_LL_DeviceMethodResponse(iothubClientHandle, methodId, response, length, statusCode) == IOTHUB_CLIENT_OK;
+	}
+
+	LP_COMMS_METHOD_RESPONSE* methodResponse = malloc(sizeof(LP_COMMS_METHOD_RESPONSE) + length);
+
+	if (methodResponse == NULL) {
+		return false;
+	}
+
+	*methodResponse = (LP_COMMS_METHOD_RESPONSE){ .methodId = methodId, .client = _clientsAbandoned, .statusCode = statusCode, .length = length };
+	memcpy(methodResponse->response, response, length);
+
+	if (!lp_postToCommsThread(SendMethodResponseOnComms, methodResponse)) {
+		free(methodResponse);
+		return false;
+	}
+
+	return true;
+}
+
+static bool SendMessage(const char* msg, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PROPERTY** overrides, size_t overrideCount) {
+	return SendPayload((const uint8_t*)msg, strlen(msg), NULL, propertyTemplate, overrides, overrideCount);
+}
+
+static bool SendPayload(const uint8_t* payload, size_t length, const char* contentType, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PROPERTY** overrides, size_t overrideCount) {
+	size_t meteredLength = 0;
+	IOTHUB_MESSAGE_HANDLE messageHandle = CreateMessage(payload, length, contentType, propertyTemplate != NULL ? propertyTemplate->encoding : LP_ENCODING_NONE, &meteredLength);
+
+	if (messageHandle == 0) {
+		LP_LOG_LIMITED(LP_LOG_WARNING, LP_LOG_LIMIT_MS, "WARNING: unable to create a new IoTHubMessage\n");
+		return false;
+	}
+
+	return SendMessageHandle(messageHandle, meteredLength, propertyTemplate, overrides, overrideCount);
+}
+
+/// <summary>
+///     Attach the message properties and hand the message over, meteredLength is its wire length so far
+/// </summary>
+static bool SendMessageHandle(IOTHUB_MESSAGE_HANDLE messageHandle, size_t meteredLength, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PROPERTY** overrides, size_t overrideCount) {
+	uint32_t tracedUs = lp_traceNow();
+
+	if (propertyTemplate != NULL || overrides != NULL) {
+		// template entries were validated when compiled, only the overrides need checking
+		if (propertyTemplate != NULL) {
+			for (size_t i = 0; i < propertyTemplate->propertyCount; i++) {
+				const char* value = overrideCount > 0 ? FindPropertyOverride(propertyTemplate->properties[i].key, overrides, overrideCount) : NULL;
+				meteredLength += SetMeteredProperty(messageHandle, propertyTemplate->properties[i].key, value != NULL ? value : propertyTemplate->properties[i].value);
+			}
+		}
+
+		for (size_t i = 0; i < overrideCount; i++) {
+			if (overrides[i] == NULL || overrides[i]->key == NULL || overrides[i]->value == NULL) {
+				continue;
+			}
+
+			bool inTemplate = false;
+			for (size_t j = 0; propertyTemplate != NULL && j < propertyTemplate->propertyCount && !inTemplate; j++) {
+				inTemplate = strcmp(propertyTemplate->properties[j].key, overrides[i]->key) == 0;
+			}
+
+			if (!inTemplate) {
+				meteredLength += SetMeteredProperty(messageHandle, overrides[i]->key, overrides[i]->value);
+			}
+		}
+	}
+	else if (_messageProperties != NULL)
+	{
+		for (size_t i = 0; i < _messagePropertyCount; i++)
+		{
+			if (_messageProperties[i]->key != NULL && _messageProperties[i]->value != NULL)
+			{
+				meteredLength += SetMeteredProperty(messageHandle, _messageProperties[i]->key, _messageProperties[i]->value);
+			}
+		}
+	}
+
+	LP_SEND_CONTEXT* sendContext = AcquireSendContext();
+
+	if (_nextTrace.armed) {
+		AttachTrace(messageHandle, sendContext);
+	}
+
+	if (!HandOverEvent(messageHandle, sendContext)) {
+		LP_LOG_LIMITED(LP_LOG_WARNING, LP_LOG_LIMIT_MS, "WARNING: failed to hand over the message to IoTHubClient\n");
+		if (sendContext != NULL) {
+			sendContext->inUse = false;
+		}
+		return false;
+	}
+	else {
+		LP_LOG(LP_LOG_DEBUG, "INFO: IoTHubClient accepted the message for delivery\n");
+	}
+
+	_sendSequence++;
+	_telemetryStats.sent++;
+	_telemetryStats.inFlight++;
+	MeterMessage(meteredLength);
+	lp_traceSpan(LP_TRACE_SEND, NULL, tracedUs, (uint32_t)meteredLength);
+
+	lp_pumpCloudToDevice();
+
+	return true;
+}
+
+/// <summary>
+///     Outbound calls pull the DoWork timer forward to the busy cadence, the timer is always running
+///     once lp_connectToAzureIot has been called
+/// </summary>
+void lp_pumpCloudToDevice(void) {
+	lp_kickCloudToDevice();
+}
+
+/// <summary>
+///     Resend every critical message and up to _offlineDrainPerTick others held in the offline queue
+/// </summary>
+static void DrainOfflineQueue(void) {
+	const char* msg;
+	size_t critical = lp_offlineQueuePriorityCount(LP_PRIORITY_CRITICAL);		// peeked first, not rate limited
+	size_t limit = _offlineDrainPerTick + critical;
+
+	for (size_t i = 0; i < limit; i++) {
+		// a message waiting for a token is already counted as deferred, wait without taking
+		if ((msg = lp_offlineQueuePeek()) == NULL || (i >= critical && lp_rateLimitWaitMs(LP_RATE_TELEMETRY) > 0)) {
+			break;
+		}
+
+		AdmitMessage(i < critical ? LP_PRIORITY_CRITICAL : LP_PRIORITY_NORMAL);
+
+		if (!SendMessage(msg, NULL, NULL, 0)) {
+			break;
+		}
+
+		lp_offlineQueuePop();
+	}
+}
+
+/// <summary>
+///     Allocate the telemetry batch buffer. Readings passed to lp_enqueueTelemetry are collected into one
+///     JSON array message which is sent when maxMessages readings are queued, the next reading would take the
+///     batch past its packing limit, or maxLatencyMs has elapsed since the first reading of the batch was queued.
+///     The packing limit is the most whole billing units that fit in maxBytes, less the batch template's properties
+///     and LP_BILLING_HEADROOM_BYTES, so a full batch is billed as just under that many units. Give maxBytes a
+///     multiple of the billing unit and a maxMessages large enough that size, not count, flushes the batch.
+///     With the worker pool open, LZ4 batches of LP_WORKER_BATCH_MIN_BYTES or more are compressed on a worker and
+///     sent from its completion, the flush returns true once a batch is handed over.
+/// </summary>
+bool lp_openTelemetryBatch(size_t maxMessages, size_t maxBytes, int maxLatencyMs) {
+	if (_batchBuffer != NULL) {
+		return true;
+	}
+
+	if (maxMessages < 1 || maxBytes < 3 || maxLatencyMs < 1) {
+		return false;
+	}
+
+	_batchBuffer = (char*)lp_heapMalloc(LP_HEAP_TELEMETRY, maxBytes);
+	if (_batchBuffer == NULL) {
+		return false;
+	}
+
+	_batchBufferSize = maxBytes;
+	_batchMaxMessages = maxMessages;
+	_batchMaxLatency.tv_sec = maxLatencyMs / 1000;
+	_batchMaxLatency.tv_nsec = (maxLatencyMs % 1000) * 1000000;
+	_batchLength = 0;
+	_batchCount = 0;
+
+	if (!lp_startTimer(&telemetryBatchTimer)) {
+		lp_heapFree(LP_HEAP_TELEMETRY, _batchBuffer);
+		_batchBuffer = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/// <summary>
+///     Send any readings still queued and release the telemetry batch buffer
+/// </summary>
+void lp_closeTelemetryBatch(void) {
+	lp_flushTelemetry();
+	lp_stopTimer(&telemetryBatchTimer);
+
+	if (_batchBuffer != NULL) {
+		lp_heapFree(LP_HEAP_TELEMETRY, _batchBuffer);
+		_batchBuffer = NULL;
+	}
+	_batchBufferSize = 0;
+}
+
+/// <summary>
+///     Bytes of JSON a batch may hold before it is flushed, a whole number of billing units less the message's
+///     other metered bytes. LZ4 batches are packed to the buffer, their wire size is not known until compressed.
+/// </summary>
+static size_t BatchPackingLimit(void) {
+	size_t overhead = LP_BILLING_HEADROOM_BYTES + (_batchTemplate != NULL ? _batchTemplate->bytes : 0);
+	size_t units = _batchBufferSize / _billingUnitBytes;
+
+	if ((_batchTemplate != NULL && _batchTemplate->encoding == LP_ENCODING_LZ4) || units == 0 || units * _billingUnitBytes <= overhead) {
+		return _batchBufferSize / _batchDivisor;
+	}
+
+	return (units * _billingUnitBytes - overhead) / _batchDivisor;
+}
+
+/// <summary>
+///     Append a JSON reading to the current batch. Falls back to lp_sendMsg if batching is not open
+///     or the reading is too large to ever fit in the batch buffer.
+/// </summary>
+bool lp_enqueueTelemetry(const char* msg) {
+	size_t msgLength = strlen(msg);
+	bool result = true;
+
+	if (msgLength < 1) {
+		return true;
+	}
+
+	// allow for the opening bracket, the closing bracket and NULL termination
+	if (_batchBuffer == NULL || msgLength + 3 > _batchBufferSize) {
+		return lp_sendMsg(msg);
+	}
+
+	// the LAN gets the reading now, the hub with the batch
+	lp_publishLocal(msg, msgLength);
+
+	// allow for a comma separator, the closing bracket and NULL termination
+	if (_batchCount > 0 && _batchLength + msgLength + 3 > BatchPackingLimit()) {
+		result = lp_flushTelemetry();
+	}
+
+	_batchBuffer[_batchLength++] = _batchCount == 0 ? '[' : ',';
+	memcpy(_batchBuffer + _batchLength, msg, msgLength);
+	_batchLength += msgLength;
+
+	if (++_batchCount == 1) {
+		lp_setOneShotTimer(&telemetryBatchTimer, &_batchMaxLatency);
+	}
+
+	if (_batchCount >= _batchMaxMessages / _batchDivisor) {
+		result = lp_flushTelemetry() && result;
+	}
+
+	return result;
+}
+
+static void CompressBatchWork(void* context) {
+	LP_BATCH_JOB* job = (LP_BATCH_JOB*)context;
+	uint16_t hashTable[LP_COMPRESS_TABLE_ENTRIES];		// on the worker's stack, the shared table belongs to the event loop
+
+	job->compressedLength = lp_compressLz4WithTable((const uint8_t*)job->json, job->length, job->compressed, job->length - 1, hashTable);
+}
+
+/// <summary>
+///     Send a batch the worker pool compressed, as lp_sendMsgWithProperties would have sent it
+/// </summary>
+static void CompressBatchDone(void* context) {
+	LP_BATCH_JOB* job = (LP_BATCH_JOB*)context;
+	LP_MESSAGE_PRIORITY priority = job->propertyTemplate->priority;
+	IOTHUB_MESSAGE_HANDLE messageHandle = NULL;
+	size_t wireLength = 0;
+
+	_batchJobs--;
+
+	if (lp_connectToAzureIot() && AdmitMessage(priority)) {
+		// a batch that did not compress goes as it is, compressing it again on the event loop would not help
+		messageHandle = job->compressedLength > 0 ?
+			CreateLz4Message(job->compressed, job->compressedLength, job->length, NULL, &wireLength) :
+			CreateMessage((const uint8_t*)job->json, job->length, NULL, LP_ENCODING_NONE, &wireLength);
+	}
+
+	if (messageHandle == NULL || !SendMessageHandle(messageHandle, wireLength, job->propertyTemplate, NULL, 0)) {
+		lp_offlineQueuePush(job->json, priority);
+	}
+
+	lp_heapFree(LP_HEAP_TELEMETRY, job->json);
+	lp_heapFree(LP_HEAP_TELEMETRY, job->compressed);
+	lp_heapFree(LP_HEAP_TELEMETRY, job);
+}
+
+/// <summary>
+///     Hand a large LZ4 batch to the worker pool for compression, the batch buffer goes with it and a fresh one
+///     takes its place. False when the batch is sent from here, the pool is closed, busy or memory is short.
+/// </summary>
+static bool SubmitBatch(void) {
+	if (!lp_isWorkerPoolRunning() || _batchTemplate == NULL || _batchTemplate->encoding != LP_ENCODING_LZ4 ||
+		_batchLength < LP_WORKER_BATCH_MIN_BYTES || _batchLength > LP_COMPRESS_MAX_INPUT) {
+		return false;
+	}
+
+	LP_BATCH_JOB* job = (LP_BATCH_JOB*)lp_heapMalloc(LP_HEAP_TELEMETRY, sizeof(LP_BATCH_JOB));
+	char* buffer = (char*)lp_heapMalloc(LP_HEAP_TELEMETRY, _batchBufferSize);
+	uint8_t* compressed = (uint8_t*)lp_heapMalloc(LP_HEAP_TELEMETRY, _batchLength);
+
+	if (job != NULL && buffer != NULL && compressed != NULL) {
+		*job = (LP_BATCH_JOB){ .json = _batchBuffer, .length = _batchLength, .propertyTemplate = _batchTemplate, .compressed = compressed };
+
+		if (lp_submitWork(CompressBatchWork, CompressBatchDone, job)) {
+			_batchJobs++;
+			_batchBuffer = buffer;
+			return true;
+		}
+	}
+
+	lp_heapFree(LP_HEAP_TELEMETRY, job);
+	lp_heapFree(LP_HEAP_TELEMETRY, buffer);
+	lp_heapFree(LP_HEAP_TELEMETRY, compressed);
+	return false;
+}
+
+/// <summary>
+///     Close the JSON array and send the current batch as a single message
+/// </summary>
+bool lp_flushTelemetry(void) {
+	bool result;
+
+	if (_batchBuffer == NULL || _batchCount == 0) {
+		return true;
+	}
+
+	if (telemetryBatchTimer.eventLoopTimer != NULL) {
+		DisarmEventLoopTimer(telemetryBatchTimer.eventLoopTimer);
+	}
+
+	_batchBuffer[_batchLength++] = ']';
+	_batchBuffer[_batchLength] = 0;
+
+	if (SubmitBatch()) {
+		result = true;
+	}
+	else {
+		// each reading went to the local sink as it was queued
+		result = _batchTemplate != NULL ? SendToHubWithProperties(_batchBuffer, _batchTemplate, NULL, 0) : SendToHub(_batchBuffer, LP_PRIORITY_NORMAL);
+	}
+
+	_batchLength = 0;
+	_batchCount = 0;
+
+	return result;
+}
+
+/// <summary>
+///     Send flushed batches with this template (properties and encoding), NULL reverts to lp_sendMsg
+/// </summary>
+void lp_setTelemetryBatchTemplate(const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate) {
+	_batchTemplate = propertyTemplate;
+}
+
+/// <summary>
+///     Flush batches at 1/divisor of their packing limit and message count, so each message the SDK copies and
+///     holds until confirmed is smaller while memory is short. 1 restores full batches, the buffer is not resized
+/// </summary>
+void lp_scaleTelemetryBatch(unsigned int divisor) {
+	_batchDivisor = divisor > 0 ? divisor : 1;
+}
+
+/// <summary>
+///     The size IoT Hub meters messages in, LP_BILLING_UNIT_BYTES unless the hub tier bills differently
+/// </summary>
+void lp_setBillingUnit(size_t unitBytes) {
+	_billingUnitBytes = unitBytes > 0 ? unitBytes : LP_BILLING_UNIT_BYTES;
+}
+
+/// <summary>
+///     Time triggered flush for a partially filled telemetry batch
+/// </summary>
+static void TelemetryBatchFlushHandler(EventLoopTimer* eventLoopTimer) {
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_TelemetryBatchFlushHandler);
+		return;
+	}
+
+	lp_flushTelemetry();
+}
+
+/// <summary>
+///     The IoT Hub client, NULL off the comms thread in comms thread mode, the client is only used where it runs
+/// </summary>
+IOTHUB_DEVICE_CLIENT_LL_HANDLE lp_getAzureIotClientHandle(void) {
+	return lp_isCommsThreadRunning() && !lp_onCommsThread() ? NULL : iothubClientHandle;
+}
+
+
+/// <summary>
+///     Non blocking. Returns true when the IoT Hub client exists and accepts messages, otherwise makes sure
+///     the connection state machine is running and returns false so callers store and forward.
+/// </summary>
+bool lp_connectToAzureIot(void) {
+	if (cloudToDeviceTimer.eventLoopTimer == NULL && !lp_isCommsThreadRunning()) {
+		lp_startCloudToDevice();
+	}
+
+	return _connectionState == LP_CONNECTION_CONNECTING || _connectionState == LP_CONNECTION_AUTHENTICATED;
+}
+
+LP_CONNECTION_STATE lp_getConnectionState(void) {
+	return _connectionState;
+}
+
+static void SetConnectionState(LP_CONNECTION_STATE state) {
+	_connectionState = state;
+	clock_gettime(CLOCK_MONOTONIC, &_connectionStateEnteredAt);
+}
+
+static int MsInConnectionState(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int)((now.tv_sec - _connectionStateEnteredAt.tv_sec) * 1000 + (now.tv_nsec - _connectionStateEnteredAt.tv_nsec) / 1000000);
+}
+
+static uint32_t MsSince(const struct timespec* since) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)((now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000);
+}
+
+static void CountDoWork(void) {
+	pthread_mutex_lock(&_connectionStatsLock);
+
+	if (_doWorkIntervalOpen) {
+		uint32_t intervalMs = MsSince(&_lastDoWorkAt);
+
+		_connectionStats.doWorkIntervalLastMs = intervalMs;
+		_doWorkIntervalTotalMs += intervalMs;
+		_connectionStats.doWorkIntervalAvgMs = (uint32_t)(_doWorkIntervalTotalMs / ++_doWorkIntervals);
+		if (intervalMs > _connectionStats.doWorkIntervalMaxMs) {
+			_connectionStats.doWorkIntervalMaxMs = intervalMs;
+		}
+	}
+
+	_connectionStats.doWorkCalls++;
+	_doWorkIntervalOpen = true;
+	clock_gettime(CLOCK_MONOTONIC, &_lastDoWorkAt);
+
+	pthread_mutex_unlock(&_connectionStatsLock);
+}
+
+static void CountAuthentication(void) {
+	pthread_mutex_lock(&_connectionStatsLock);
+
+	if (_disconnectedAt.tv_sec != 0 || _disconnectedAt.tv_nsec != 0) {
+		_connectionStats.reconnects++;
+		_connectionStats.lastOutageMs = MsSince(&_disconnectedAt);
+		_connectionStats.totalOutageMs += _connectionStats.lastOutageMs;
+		_disconnectedAt = (struct timespec){ 0, 0 };
+	}
+
+	if (_hubRenewing) {
+		_connectionStats.renewals++;
+		_connectionStats.lastRenewalMs = _connectionStats.lastOutageMs;
+		_hubRenewing = false;
+	}
+
+	_connectionStats.connects++;
+
+	pthread_mutex_unlock(&_connectionStatsLock);
+
+	clock_gettime(CLOCK_MONOTONIC, &_keepAlivePeriodStart);
+	_keepAlivePeriodSent = _eventsHandedOver;
+	_keepAliveBusyPeriods = 0;
+}
+
+/// <summary>
+///     Counts keep-alive periods that carried messages, a connection whose data traffic already keeps the link
+///     alive gets a longer keep-alive on the next connection and pings less in its idle gaps
+/// </summary>
+static void TrackKeepAlive(void) {
+	if (MsSince(&_keepAlivePeriodStart) < (uint32_t)_keepAliveInUseSeconds * 1000) {
+		return;
+	}
+
+	bool busy = _eventsHandedOver != _keepAlivePeriodSent;
+	_keepAlivePeriodSent = _eventsHandedOver;
+	clock_gettime(CLOCK_MONOTONIC, &_keepAlivePeriodStart);
+
+	_keepAliveBusyPeriods = busy ? _keepAliveBusyPeriods + 1 : 0;
+
+	if (_keepAliveBusyPeriods >= LP_KEEPALIVE_BUSY_PERIODS && _keepAliveSeconds < _keepAliveMaxSeconds) {
+		_keepAliveSeconds = _keepAliveSeconds * 2 > _keepAliveMaxSeconds ? _keepAliveMaxSeconds : _keepAliveSeconds * 2;
+		_keepAliveBusyPeriods = 0;
+		LP_LOG(LP_LOG_INFO, "INFO: Telemetry keeps the link alive, next connection uses a %d second keep-alive\n", _keepAliveSeconds);
+	}
+}
+
+/// <summary>
+///     Connection and DoWork counters since start, DoWork intervals are measured within each connection
+/// </summary>
+void lp_getConnectionStats(LP_CONNECTION_STATS* stats) {
+	if (stats != NULL) {
+		pthread_mutex_lock(&_connectionStatsLock);
+		*stats = _connectionStats;
+		pthread_mutex_unlock(&_connectionStatsLock);
+	}
+}
+
+/// <summary>
+///     Run call on the app thread, posted from the comms thread and called straight away from the event loop
+/// </summary>
+static void OnAppThread(LP_COMMS_CALL call, void* context) {
+	if (lp_onCommsThread()) {
+		lp_postToAppThread(call, context);
+	}
+	else {
+		call(context);
+	}
+}
+
+static void BootMarkOnApp(void* context) {
+	lp_bootMark((const char*)context);
+}
+
+static void FlushReportedStateOnApp(void* context) {
+	lp_resendReportedState();
+}
+
+static void RefreshNetworkStateOnApp(void* context) {
+	lp_refreshNetworkState();
+}
+
+static void DrainOfflineQueueOnApp(void* context) {
+	atomic_store(&_appServicePosted, false);
+
+	if (_connectionState == LP_CONNECTION_AUTHENTICATED) {
+		DrainOfflineQueue();
+	}
+	atomic_store(&_appBacklog, (uint32_t)lp_offlineQueueCount());
+}
+
+static void AbandonClientOnApp(void* context) {
+	_clientsAbandoned++;
+	lp_abandonDirectMethods();	// pending method handles belong to the destroyed client
+}
+
+static void DestroyHubClient(void) {
+	_clientsDestroyed++;
+	OnAppThread(AbandonClientOnApp, NULL);
+
+	IoTHubDeviceClient_LL_Destroy(iothubClientHandle);
+	iothubClientHandle = NULL;
+}
+
+/// <summary>
+///     The network state module belongs to the app thread, the comms thread asks the OS
+/// </summary>
+static bool NetworkReady(void) {
+	bool isNetworkReady = false;
+
+	if (!lp_onCommsThread()) {
+		return lp_isNetworkReady();
+	}
+
+	return Networking_IsNetworkingReady(&isNetworkReady) == 0 && isNetworkReady;
+}
+
+/// <summary>
+///     Messages in flight or offline queued, DoWork stays at the busy cadence
+/// </summary>
+static bool OutboundPending(void) {
+	if (lp_onCommsThread()) {
+		return _commsInFlight > 0 || atomic_load(&_appBacklog) > 0;
+	}
+
+	return _telemetryStats.inFlight > 0 || lp_offlineQueueCount() > 0;
+}
+
+#if LP_ENABLE_TWINS
+static void TwinOnApp(void* context) {
+	LP_COMMS_TWIN* twin = (LP_COMMS_TWIN*)context;
+
+	lp_twinCallback(twin->updateState, twin->payload, twin->length, NULL);
+	free(twin);
+}
+
+static void CommsTwinCallback(DEVICE_TWIN_UPDATE_STATE updateState, const unsigned char* payload, size_t payloadSize, void* userContextCallback) {
+	LP_COMMS_TWIN* twin = malloc(sizeof(LP_COMMS_TWIN) + payloadSize);
+
+	if (twin == NULL) {
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: no memory to pass a device twin update to the app thread\n");
+		return;
+	}
+
+	*twin = (LP_COMMS_TWIN){ .updateState = updateState, .length = payloadSize };
+	memcpy(twin->payload, payload, payloadSize);
+	lp_postToAppThread(TwinOnApp, twin);
+}
+#endif
+
+#if LP_ENABLE_DIRECT_METHODS
+static void MethodOnApp(void* context) {
+	LP_COMMS_METHOD* method = (LP_COMMS_METHOD*)context;
+
+	lp_azureDirectMethodInboundHandler(method->methodName, method->payload, method->length, method->methodId, NULL);
+	free(method);
+}
+
+/// <summary>
+///     The invocation is answered from the app thread with lp_sendMethodResponse, the SDK keeps it open until then
+/// </summary>
+static int CommsMethodCallback(const char* methodName, const unsigned char* payload, size_t payloadSize, METHOD_HANDLE methodId, void* userContextCallback) {
+	static const char noMemoryResponse[] = "\"Device out of memory\"";
+	size_t nameLength = strlen(methodName) + 1;
+	LP_COMMS_METHOD* method = malloc(sizeof(LP_COMMS_METHOD) + payloadSize + nameLength);
+
+	if (method == NULL) {
+		IoTHubDeviceClient_LL_DeviceMethodResponse(iothubClientHandle, methodId, (const unsigned char*)noMemoryResponse,
+			sizeof(noMemoryResponse) - 1, 500);
+		return 0;
+	}
+
+	*method = (LP_COMMS_METHOD){ .methodId = methodId, .length = payloadSize };
+	memcpy(method->payload, payload, payloadSize);
+	memcpy(method->payload + payloadSize, methodName, nameLength);
+	method->methodName = (const char*)(method->payload + payloadSize);
+	lp_postToAppThread(MethodOnApp, method);
+
+	return 0;
+}
+#endif
+
+static void CloudMessageOnApp(void* context) {
+	LP_COMMS_CLOUD_MESSAGE* received = (LP_COMMS_CLOUD_MESSAGE*)context;
+
+	lp_dispatchCloudMessage(&received->message);
+	free(received);
+}
+
+static const char* CopyProperty(const char* value, unsigned char** to) {
+	size_t length;
+
+	if (value == NULL) {
+		return NULL;
+	}
+	length = strlen(value) + 1;
+	memcpy(*to, value, length);
+	*to += length;
+	return (const char*)(*to - length);
+}
+
+/// <summary>
+///     The disposition can not wait for the app thread, the message is accepted once copied, see cloud_messages.h
+/// </summary>
+static IOTHUBMESSAGE_DISPOSITION_RESULT CommsCloudMessageCallback(IOTHUB_MESSAGE_HANDLE message, void* userContextCallback) {
+	const char* properties[] = {
+		IoTHubMessage_GetProperty(message, LP_C2D_TYPE_PROPERTY),
+		IoTHubMessage_GetProperty(message, LP_C2D_TRANSFER_PROPERTY),
+		IoTHubMessage_GetProperty(message, LP_C2D_PART_PROPERTY),
+		IoTHubMessage_GetProperty(message, LP_C2D_SIZE_PROPERTY)
+	};
+	const unsigned char* body;
+	size_t length;
+	size_t propertyBytes = 0;
+	LP_COMMS_CLOUD_MESSAGE* received;
+	unsigned char* next;
+
+	if (IoTHubMessage_GetByteArray(message, &body, &length) != IOTHUB_MESSAGE_OK) {
+		return IOTHUBMESSAGE_REJECTED;
+	}
+
+	for (size_t i = 0; i < sizeof(properties) / sizeof(properties[0]); i++) {
+		propertyBytes += properties[i] != NULL ? strlen(properties[i]) + 1 : 0;
+	}
+
+	if ((received = malloc(sizeof(LP_COMMS_CLOUD_MESSAGE) + length + propertyBytes)) == NULL) {
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: no memory to pass a cloud message to the app thread\n");
+		return IOTHUBMESSAGE_ABANDONED;
+	}
+
+	memcpy(received->payload, body, length);
+	next = received->payload + length;
+	received->message = (LP_CLOUD_MESSAGE){
+		.type = CopyProperty(properties[0], &next),
+		.transfer = CopyProperty(properties[1], &next),
+		.part = CopyProperty(properties[2], &next),
+		.size = CopyProperty(properties[3], &next),
+		.body = received->payload,
+		.length = length
+	};
+	lp_postToAppThread(CloudMessageOnApp, received);
+
+	return IOTHUBMESSAGE_ACCEPTED;
+}
+
+static int CommsThreadStep(bool kicked) {
+	if (kicked) {
+		_doWorkIdlePeriodMs = _doWorkBusyPeriodMs;
+	}
+	return RunConnectionStateMachine();
+}
+
+/// <summary>
+///     Tear the clients down on the comms thread as it stops, the event loop reconnects from NETWORK_WAIT
+/// </summary>
+static void CommsThreadClose(void) {
+	if (_connectionState == LP_CONNECTION_AUTHENTICATED) {
+		clock_gettime(CLOCK_MONOTONIC, &_disconnectedAt);
+	}
+
+	if (iothubClientHandle != NULL) {
+		DestroyHubClient();
+	}
+
+	if (_provHandle != NULL) {
+		Prov_Device_LL_Destroy(_provHandle);
+		_provHandle = NULL;
+	}
+
+	iothubAuthenticated = false;
+	_hubRenewing = false;
+	_doWorkIntervalOpen = false;
+	_commsInFlight = 0;
+	SetConnectionState(LP_CONNECTION_NETWORK_WAIT);
+}
+
+/// <summary>
+///     Move the IoT Hub client and its connection state machine to a thread of their own, so TLS handshakes and
+///     slow sends no longer hold up the event loop. Set the DoWork cadence and keep-alive first.
+/// </summary>
+bool lp_startCommsThread(void) {
+	bool timerRunning = cloudToDeviceTimer.eventLoopTimer != NULL;
+
+	if (lp_isCommsThreadRunning()) {
+		return true;
+	}
+
+	lp_addShutdownHook(CloudToDeviceShutdown);
+
+	// the thread picks the state machine up where the timer left it
+	lp_stopCloudToDevice();
+	atomic_store(&_appBacklog, (uint32_t)lp_offlineQueueCount());
+
+	if (!lp_openCommsThread(CommsThreadStep, CommsThreadClose)) {
+		if (timerRunning) {
+			lp_startCloudToDevice();
+		}
+		return false;
+	}
+
+	return true;
+}
+
+void lp_stopCommsThread(void) {
+	lp_closeCommsThread();
+}
+
+static bool UseConnectionString(void) {
+	return _connectionString != NULL && strlen(_connectionString) != 0;
+}
+
+/// <summary>
+///     Uniform in 0 to maxMs. The seed comes from getrandom, or the clock where that fails, never a constant, so a fleet
+///     rebooted together does not draw the same delays
+/// </summary>
+static int RandomDelayMs(int maxMs) {
+	struct timespec now;
+
+	if (maxMs <= 0) {
+		return 0;
+	}
+
+	if (_jitterState == 0) {
+		if (getrandom(&_jitterState, sizeof(_jitterState), GRND_NONBLOCK) != sizeof(_jitterState) || _jitterState == 0) {
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			_jitterState = (uint32_t)now.tv_nsec ^ (uint32_t)now.tv_sec ^ 0x9e3779b9u;
+		}
+	}
+
+	_jitterState ^= _jitterState << 13;
+	_jitterState ^= _jitterState >> 17;
+	_jitterState ^= _jitterState << 5;
+
+	return (int)(((uint64_t)_jitterState * ((uint64_t)maxMs + 1)) >> 32);
+}
+
+/// <summary>
+///     Tears down the hub and DPS clients and waits out a back off of full jitter, random up to a ceiling that
+///     doubles from _backoffBaseMs per failure to _backoffCapMs
+/// </summary>
+static int EnterBackoff(void) {
+	int64_t ceilingMs = (int64_t)_backoffBaseMs << (_backoffAttempts < 20 ? _backoffAttempts : 20);
+	int delayMs;
+
+	if (_connectionState == LP_CONNECTION_CONNECTING) {
+		_hubHostNameVerified = false;	// the cached hub never authenticated, provision again next time
+	}
+
+	if (_connectionState == LP_CONNECTION_AUTHENTICATED) {
+		clock_gettime(CLOCK_MONOTONIC, &_disconnectedAt);
+	}
+
+	if (iothubClientHandle != NULL) {
+		DestroyHubClient();
+	}
+
+	if (_provHandle != NULL) {
+		Prov_Device_LL_Destroy(_provHandle);
+		_provHandle = NULL;
+	}
+
+	iothubAuthenticated = false;
+	_hubRenewing = false;
+	_doWorkIntervalOpen = false;
+
+	delayMs = RandomDelayMs(ceilingMs > _backoffCapMs ? _backoffCapMs : (int)ceilingMs);
+
+	_backoffAttempts++;
+	SetConnectionState(LP_CONNECTION_BACKOFF);
+	LP_LOG(LP_LOG_INFO, "Reconnect attempt %u in %d ms.\n", _backoffAttempts, delayMs);
+
+	return delayMs < _doWorkBusyPeriodMs ? _doWorkBusyPeriodMs : delayMs;
+}
+
+static int StartHubConnection(void) {
+	if (!SetupAzureClient()) {
+		return EnterBackoff();
+	}
+
+	_hubConnectionLost = false;
+	_hubRenewing = false;
+	SetConnectionState(LP_CONNECTION_CONNECTING);
+
+	return _doWorkBusyPeriodMs;	// pump the connection handshake promptly
+}
+
+/// <summary>
+///     One step of NetworkWait -> Provisioning -> Connecting -> Authenticated -> Backoff.
+///     Every step returns without blocking, the return value is the delay until the next step.
+/// </summary>
+static int RunConnectionStateMachine(void) {
+	IOTHUB_CLIENT_STATUS sendStatus = IOTHUB_CLIENT_SEND_STATUS_IDLE;
+	int delayMs;
+
+	switch (_connectionState) {
+	case LP_CONNECTION_NETWORK_WAIT:
+		if (!NetworkReady()) {
+			_holdoffPending = true;
+			return networkWaitPeriodMs;
+		}
+
+		// boot or the network back, devices behind the same access point would all connect on the same tick
+		if (_holdoffPending) {
+			_holdoffPending = false;
+			delayMs = RandomDelayMs(_holdoffMaxMs);
+			if (delayMs > 0) {
+				LP_LOG(LP_LOG_INFO, "Network ready, connecting in %d ms.\n", delayMs);
+				return delayMs;
+			}
+		}
+		OnAppThread(BootMarkOnApp, (void*)"network ready");
+
+		if (UseConnectionString() || (_hubHostName[0] != 0 && _hubHostNameVerified)) {
+			return StartHubConnection();
+		}
+
+		if (!StartDpsRegistration()) {
+			return EnterBackoff();
+		}
+
+		SetConnectionState(LP_CONNECTION_PROVISIONING);
+		return LP_DPS_POLL_MS;
+
+	case LP_CONNECTION_PROVISIONING:
+		Prov_Device_LL_DoWork(_provHandle);
+
+		if (_dpsStatus == LP_DPS_PENDING && MsInConnectionState() < LP_DPS_TIMEOUT_MS) {
+			return LP_DPS_POLL_MS;
+		}
+
+		Prov_Device_LL_Destroy(_provHandle);
+		_provHandle = NULL;
+
+		if (_dpsStatus != LP_DPS_ASSIGNED) {
+			LP_LOG(LP_LOG_ERROR, "ERROR: DPS did not assign an IoT Hub.\n");
+			return EnterBackoff();
+		}
+
+		LP_LOG(LP_LOG_INFO, "DPS assigned IoT Hub '%s'.\n", _hubHostName);
+		OnAppThread(BootMarkOnApp, (void*)"provisioned");
+		return StartHubConnection();
+
+	case LP_CONNECTION_CONNECTING:
+	case LP_CONNECTION_AUTHENTICATED:
+		CountDoWork();
+		IoTHubDeviceClient_LL_DoWork(iothubClientHandle);
+
+		if (_hubConnectionLost) {
+			return EnterBackoff();
+		}
+
+		// a token renewal keeps the client, CONNECTING waits for the SDK to authenticate it again and only
+		// tears it down for a full reconnect if that takes longer than connectTimeoutMs
+		if (_hubRenewing && _connectionState == LP_CONNECTION_AUTHENTICATED) {
+			clock_gettime(CLOCK_MONOTONIC, &_disconnectedAt);
+			SetConnectionState(LP_CONNECTION_CONNECTING);
+		}
+
+		if (_connectionState == LP_CONNECTION_CONNECTING) {
+			if (!iothubAuthenticated) {
+				if (MsInConnectionState() > connectTimeoutMs) {
+					LP_LOG(LP_LOG_ERROR, "ERROR: IoT Hub connection timed out.\n");
+					return EnterBackoff();
+				}
+				return _doWorkBusyPeriodMs;
+			}
+
+			SetConnectionState(LP_CONNECTION_AUTHENTICATED);
+			CountAuthentication();
+			OnAppThread(BootMarkOnApp, (void*)"authenticated");
+			_backoffAttempts = 0;
+			_doWorkIdlePeriodMs = _doWorkBusyPeriodMs;
+			OnAppThread(FlushReportedStateOnApp, NULL);
+		}
+
+		if (lp_onCommsThread()) {
+			if (!atomic_exchange(&_appServicePosted, true)) {		// one drain queued at a time
+				lp_postToAppThread(DrainOfflineQueueOnApp, NULL);
+			}
+		}
+		else {
+			DrainOfflineQueue();
+		}
+		TrackKeepAlive();
+
+		IoTHubDeviceClient_LL_GetSendStatus(iothubClientHandle, &sendStatus);
+
+		if (OutboundPending() || sendStatus == IOTHUB_CLIENT_SEND_STATUS_BUSY) {
+			delayMs = _doWorkBusyPeriodMs;
+			_doWorkIdlePeriodMs = _doWorkBusyPeriodMs;
+		}
+		else {
+			delayMs = _doWorkIdlePeriodMs;
+			_doWorkIdlePeriodMs = _doWorkIdlePeriodMs * 2 > _doWorkMaxIdlePeriodMs ? _doWorkMaxIdlePeriodMs : _doWorkIdlePeriodMs * 2;
+		}
+		return delayMs;
+
+	case LP_CONNECTION_BACKOFF:
+	default:
+		OnAppThread(RefreshNetworkStateOnApp, NULL);	// the failure may have been the network going down, do not wait for the next poll
+		SetConnectionState(LP_CONNECTION_NETWORK_WAIT);
+		return RunConnectionStateMachine();
+	}
+}
+
+/// <summary>
+///     DPS registration callback, caches the assigned IoT Hub host name
+/// </summary>
+static void DpsRegisterDeviceCallback(PROV_DEVICE_RESULT registerResult, const char* iothubUri, const char* deviceId, void* userContext) {
+	if (registerResult == PROV_DEVICE_RESULT_OK && iothubUri != NULL && strlen(iothubUri) < sizeof(_hubHostName)) {
+		strncpy(_hubHostName, iothubUri, sizeof(_hubHostName) - 1);
+		_hubHostName[sizeof(_hubHostName) - 1] = 0;
+		_dpsStatus = LP_DPS_ASSIGNED;
+	} else {
+		LP_LOG(LP_LOG_ERROR, "ERROR: DPS registration failed with result %d.\n", registerResult);
+		_dpsStatus = LP_DPS_FAILED;
+	}
+}
+
+/// <summary>
+///     Starts DPS registration to discover the device's IoT Hub, the PROVISIONING state pumps it to completion
+/// </summary>
+static bool StartDpsRegistration(void) {
+	_hubHostName[0] = 0;
+	_hubHostNameVerified = false;
+	_dpsStatus = LP_DPS_PENDING;
+
+	if (prov_dev_security_init(SECURE_DEVICE_TYPE_X509) != 0) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: failure to initialise DPS security.\n");
+		return false;
+	}
+
+	if ((_provHandle = Prov_Device_LL_Create(dpsUrl, scopeId, Prov_Device_MQTT_Protocol)) == NULL) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: failure to create DPS client.\n");
+		return false;
+	}
+
+	if (Prov_Device_LL_SetOption(_provHandle, "SetDeviceId", &deviceIdForDaaCertUsage) != PROV_DEVICE_RESULT_OK ||
+		Prov_Device_LL_Register_Device(_provHandle, DpsRegisterDeviceCallback, NULL, NULL, NULL) != PROV_DEVICE_RESULT_OK) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: failure to start DPS registration.\n");
+		Prov_Device_LL_Destroy(_provHandle);
+		_provHandle = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/// <summary>
+///     Creates the IoT Hub client directly against a known hub using the device certificate
+/// </summary>
+static bool CreateHubClient(const char* hubHostName) {
+	iothubClientHandle = IoTHubDeviceClient_LL_CreateWithAzureSphereFromDeviceAuth(hubHostName, MQTT_Protocol);
+	if (iothubClientHandle == NULL) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: failure to create IoT Hub Client for '%s'.\n", hubHostName);
+		return false;
+	}
+
+	if (IoTHubDeviceClient_LL_SetOption(iothubClientHandle, "SetDeviceId", &deviceIdForDaaCertUsage) != IOTHUB_CLIENT_OK) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: failure setting option \"SetDeviceId\"\n");
+		IoTHubDeviceClient_LL_Destroy(iothubClientHandle);
+		iothubClientHandle = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/// <summary>
+///     Sets up the Azure IoT Hub connection (creates the iothubClientHandle) from the connection string
+///     or the hub DPS assigned. When the SAS Token for a device expires the connection needs to be recreated
+///     which is why this is not simply a one time call. The handshake is pumped by the CONNECTING state.
+/// </summary>
+static bool SetupAzureClient() {
+	if (iothubClientHandle != NULL) {
+		DestroyHubClient();
+	}
+
+	// For lab purposes only where the device tenant and associated x500 certificate may not be available
+	// DO NOT use connection strings in production
+	if (UseConnectionString()) {
+		IOTHUB_CLIENT_TRANSPORT_PROVIDER protocol = MQTT_Protocol;
+		iothubClientHandle = IoTHubDeviceClient_LL_CreateFromConnectionString(_connectionString, protocol);
+		if (iothubClientHandle == NULL) {
+			LP_LOG(LP_LOG_ERROR, "Failure to create IoT Hub Client from connection string");
+			return false;
+		}
+	}
+	else {
+		LP_LOG(LP_LOG_INFO, "Connecting to IoT Hub '%s'.\n", _hubHostName);
+		if (!CreateHubClient(_hubHostName)) {
+			LP_LOG(LP_LOG_ERROR, "ERROR: failure to create IoTHub Handle.\n");
+			_hubHostNameVerified = false;
+			return false;
+		}
+	}
+	   
+	_keepAliveInUseSeconds = _keepAliveSeconds;
+	pthread_mutex_lock(&_connectionStatsLock);
+	_connectionStats.keepAliveSeconds = (uint32_t)_keepAliveInUseSeconds;
+	pthread_mutex_unlock(&_connectionStatsLock);
+	if (IoTHubDeviceClient_LL_SetOption(iothubClientHandle, OPTION_KEEP_ALIVE, &_keepAliveInUseSeconds) != IOTHUB_CLIENT_OK) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: failure setting option \"%s\"\n", OPTION_KEEP_ALIVE);
+		return false;
+	}
+
+	// on the comms thread the inbound callbacks copy what the SDK passes and post it to the app thread
+#if LP_ENABLE_TWINS
+	IoTHubDeviceClient_LL_SetDeviceTwinCallback(iothubClientHandle, lp_onCommsThread() ? CommsTwinCallback : lp_twinCallback, NULL);
+#endif
+#if LP_ENABLE_DIRECT_METHODS
+	// inbound callback so direct method handlers can leave their response pending
+	IoTHubClientCore_LL_SetDeviceMethodCallback_Ex(iothubClientHandle,
+		lp_onCommsThread() ? CommsMethodCallback : lp_azureDirectMethodInboundHandler, NULL);
+#endif
+	// subscribing to cloud to device messages with no bindings would complete them unread
+	if (lp_isCloudMessageSetOpen()) {
+		IoTHubDeviceClient_LL_SetMessageCallback(iothubClientHandle, lp_onCommsThread() ? CommsCloudMessageCallback : lp_azureCloudMessageHandler, NULL);
+	}
+	IoTHubDeviceClient_LL_SetConnectionStatusCallback(iothubClientHandle, HubConnectionStatusCallback, NULL);
 
 	return true;
 }
 
 /// <summary>
 ///     Sets the IoT Hub authentication state for the app
-///     The SAS Token expires which will set the authentication state
+///     The SAS Token expires which will set the authentication state, the client is kept while the SDK renews it
+///     A hub that rejects the device credentials or reports it disabled invalidates the cached
+///     DPS assignment, the device may have been reprovisioned to another hub.
+///     Runs inside DoWork so teardown is left to the state machine.
 /// </summary>
 static void HubConnectionStatusCallback(IOTHUB_CLIENT_CONNECTION_STATUS result, IOTHUB_CLIENT_CONNECTION_STATUS_REASON reason, void* userContextCallback) {
 	iothubAuthenticated = (result == IOTHUB_CLIENT_CONNECTION_AUTHENTICATED);
-	Log_Debug("IoT Hub Connection Status: %s\n", GetReasonString(reason));
-}
-
-/// <summary>
-///     Converts AZURE_SPHERE_PROV_RETURN_VALUE to a string.
-/// </summary>
-static const char* getAzureSphereProvisioningResultString(
-	AZURE_SPHERE_PROV_RETURN_VALUE provisioningResult) {
-	switch (provisioningResult.result) {
-	case AZURE_SPHERE_PROV_RESULT_OK:
-		return "AZURE_SPHERE_PROV_RESULT_OK";
-	case AZURE_SPHERE_PROV_RESULT_INVALID_PARAM:
-		return "AZURE_SPHERE_PROV_RESULT_INVALID_PARAM";
-	case AZURE_SPHERE_PROV_RESULT_NETWORK_NOT_READY:
-		return "AZURE_SPHERE_PROV_RESULT_NETWORK_NOT_READY";
-	case AZURE_SPHERE_PROV_RESULT_DEVICEAUTH_NOT_READY:
-		return "AZURE_SPHERE_PROV_RESULT_DEVICEAUTH_NOT_READY";
-	case AZURE_SPHERE_PROV_RESULT_PROV_DEVICE_ERROR:
-		return "AZURE_SPHERE_PROV_RESULT_PROV_DEVICE_ERROR";
-	case AZURE_SPHERE_PROV_RESULT_GENERIC_ERROR:
-		return "AZURE_SPHERE_PROV_RESULT_GENERIC_ERROR";
-	default:
-		return "UNKNOWN_RETURN_VALUE";
+
+	if (iothubAuthenticated) {
+		_hubHostNameVerified = true;
+	} else if (reason == IOTHUB_CLIENT_CONNECTION_EXPIRED_SAS_TOKEN && !_hubConnectionLost) {
+		// the SDK's retry policy signs a new token and reconnects this client, recreating it would only
+		// add a client setup and leave pending method responses abandoned
+		_hubRenewing = true;
+	} else {
+		_hubConnectionLost = true;
+		if (reason == IOTHUB_CLIENT_CONNECTION_BAD_CREDENTIAL || reason == IOTHUB_CLIENT_CONNECTION_DEVICE_DISABLED) {
+			_hubHostNameVerified = false;
+		}
+		// a path that drops idle connections, a NAT or cellular carrier timeout, needs pings more often
+		if (reason == IOTHUB_CLIENT_CONNECTION_NO_PING_RESPONSE) {
+			pthread_mutex_lock(&_connectionStatsLock);
+			_connectionStats.noPingResponses++;
+			pthread_mutex_unlock(&_connectionStatsLock);
+			_keepAliveSeconds = _keepAliveInUseSeconds / 2 < _keepAliveMinSeconds ? _keepAliveMinSeconds : _keepAliveInUseSeconds / 2;
+			_keepAliveBusyPeriods = 0;
+		}
 	}
+
+	LP_LOG(LP_LOG_INFO, "IoT Hub Connection Status: %s\n", GetReasonString(reason));
 }
 
 /// <summary>
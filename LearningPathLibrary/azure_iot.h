@@ -1,34 +1,154 @@
 #pragma once
 
+#include "boot_profile.h"
+#include "comms_thread.h"
+#include "compression.h"
+#include "deferred_work.h"
 #include "device_twins.h"
 #include "direct_methods.h"
 #include "globals.h"
+#include "heap_stats.h"
 #include "iothubtransportmqtt.h"
+#include "json_arena.h"
+#include "local_sink.h"
+#include "logging.h"
+#include "network_state.h"
+#include "offline_queue.h"
+#include "shared/inter_core_protocol.h"
+#include "telemetry_encoder.h"
 #include "terminate.h"
 #include "timer.h"
+#include "timeseries.h"
 #include <applibs/log.h>
 #include <applibs/networking.h>
 #include <azure_sphere_provisioning.h>
 #include <errno.h>
 #include <iothub_client_options.h>
 #include <iothub_device_client_ll.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 //extern IOTHUB_DEVICE_CLIENT_LL_HANDLE iothubClientHandle;
 
+#define LP_KEEPALIVE_MIN_SECONDS 20			// lp_setKeepAlive defaults
+#define LP_KEEPALIVE_MAX_SECONDS 240
+#define LP_KEEPALIVE_BUSY_PERIODS 3			// periods in a row with messages sent before the keep-alive doubles
+#define LP_BILLING_UNIT_BYTES 4096			// IoT Hub meters device to cloud messages in 4 KB units, lp_setBillingUnit default
+#define LP_BILLING_HEADROOM_BYTES 128		// left in each packed batch for the system properties the hub also meters
+
+typedef enum {
+	LP_CONNECTION_NETWORK_WAIT,
+	LP_CONNECTION_PROVISIONING,
+	LP_CONNECTION_CONNECTING,
+	LP_CONNECTION_AUTHENTICATED,
+	LP_CONNECTION_BACKOFF
+} LP_CONNECTION_STATE;
+
 typedef struct LP_MESSAGE_PROPERTY
 {
 	const char* key;
 	const char* value;
 } LP_MESSAGE_PROPERTY;
 
+typedef enum {
+	LP_ENCODING_NONE = 0,
+	LP_ENCODING_LZ4 = 1
+} LP_PAYLOAD_ENCODING;
+
+typedef struct LP_MESSAGE_PROPERTY_TEMPLATE
+{
+	LP_MESSAGE_PROPERTY* properties;
+	size_t propertyCount;
+	size_t bytes;
+	LP_PAYLOAD_ENCODING encoding;
+	LP_MESSAGE_PRIORITY priority;
+} LP_MESSAGE_PROPERTY_TEMPLATE;
+
+typedef struct LP_TELEMETRY_STATS
+{
+	uint32_t sent;
+	uint32_t confirmed;
+	uint32_t failed;
+	uint32_t timeouts;
+	uint32_t inFlight;
+	uint32_t latencyP50Ms;
+	uint32_t latencyP95Ms;
+	uint32_t latencyP99Ms;
+	uint32_t latencyMaxMs;
+	uint32_t latencyRecentMs;		// moving average of the latest confirmations, follows the link where the percentiles are totals
+	uint32_t payloadBytes;
+	uint32_t wireBytes;
+	uint32_t meteredBytes;			// wire bytes plus application properties, what the hub bills
+	uint32_t billedUnits;			// billing units the sent messages used, each message rounds up to a whole unit
+	uint32_t packingPercent;		// meteredBytes as a share of the billed units' capacity
+} LP_TELEMETRY_STATS;
+
+typedef struct LP_CONNECTION_STATS
+{
+	uint32_t connects;				// IoT Hub authentications
+	uint32_t reconnects;			// authentications after a connection was lost
+	uint32_t lastOutageMs;			// authenticated connection lost to authenticated again
+	uint32_t totalOutageMs;
+	uint32_t doWorkCalls;
+	uint32_t doWorkIntervalLastMs;
+	uint32_t doWorkIntervalAvgMs;
+	uint32_t doWorkIntervalMaxMs;
+	uint32_t keepAliveSeconds;		// MQTT keep-alive the current connection negotiated
+	uint32_t noPingResponses;		// connections lost to an unanswered PINGREQ, each halves the keep-alive
+	uint32_t renewals;				// SAS token renewals the SDK completed on the same client, not recreated
+	uint32_t lastRenewalMs;			// token expired to authenticated again, included in the outage totals
+} LP_CONNECTION_STATS;
+
 void lp_setMessageProperties(LP_MESSAGE_PROPERTY** messageProperties, size_t messagePropertyCount);
 void lp_clearMessageProperties(void);
 bool lp_sendMsg(const char* msg);
+bool lp_sendMsgWithPriority(const char* msg, LP_MESSAGE_PRIORITY priority);
+bool lp_compileMessagePropertyTemplate(LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PROPERTY** messageProperties, size_t messagePropertyCount);
+bool lp_sendTelemetry(LP_TELEMETRY_ENCODER* encoder, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate);
+bool lp_sendTimeseries(const LP_TIMESERIES_BLOCK* block, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate);
+void lp_setMessagePriority(LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PRIORITY priority);
+void lp_setMessageEncoding(LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_PAYLOAD_ENCODING encoding);
+void lp_freeMessagePropertyTemplate(LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate);
+bool lp_sendMsgWithProperties(const char* msg, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate, LP_MESSAGE_PROPERTY** overrides, size_t overrideCount);
+bool lp_traceNextMessage(const LP_INTER_CORE_BLOCK* source);
+bool lp_openTelemetryBatch(size_t maxMessages, size_t maxBytes, int maxLatencyMs);
+void lp_closeTelemetryBatch(void);
+bool lp_enqueueTelemetry(const char* msg);
+bool lp_flushTelemetry(void);
+void lp_setTelemetryBatchTemplate(const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate);
+void lp_scaleTelemetryBatch(unsigned int divisor);
+void lp_setBillingUnit(size_t unitBytes);
+void lp_setOfflineQueueDrainRate(size_t messagesPerTick);
+void lp_getTelemetryStats(LP_TELEMETRY_STATS* stats);
+void lp_getConnectionStats(LP_CONNECTION_STATS* stats);
+void lp_resetTelemetryStats(void);
+bool lp_reportTelemetryStats(const char* twinProperty);
+bool lp_reportBootTimeline(const char* twinProperty);
+void lp_setBootTimelineTwin(const char* twinProperty);
 void lp_startCloudToDevice(void);
 void lp_stopCloudToDevice(void);
+void lp_setDoWorkCadence(int busyPeriodMs, int maxIdlePeriodMs);
+void lp_setKeepAlive(int minSeconds, int maxSeconds);
+void lp_setReconnectBackoff(int baseMs, int capMs, int holdoffMaxMs);
+void lp_getReconnectBackoff(int* baseMs, int* capMs, int* holdoffMaxMs);
+void lp_kickCloudToDevice(void);
+void lp_pumpCloudToDevice(void);
 void lp_setConnectionString(const char* connectionString); // Note, do not use Connection Strings for Production - this is here for lab workaround
 IOTHUB_DEVICE_CLIENT_LL_HANDLE lp_getAzureIotClientHandle(void);
 bool lp_connectToAzureIot(void);
-bool lp_isNetworkReady(void);
+LP_CONNECTION_STATE lp_getConnectionState(void);
+
+// Comms thread mode, optional: the IoT Hub client, its DoWork, TLS and connection state machine run on a thread of
+// their own so a handshake or a slow send does not add latency to timers, GPIO and inter-core messages. Call
+// lp_startCommsThread before or after connecting, messages, reported state and method responses are built on the
+// event loop and queued to the comms thread, confirmations, desired properties and method invocations come back
+// queued and the library's handlers run on the event loop as before. A message that finds the queue full fails
+// like a send to a busy client and goes to the offline queue. lp_getAzureIotClientHandle returns NULL on the event
+// loop in this mode and blob uploads are refused, the storage client would share the IoT Hub client across threads.
+// lp_stopCommsThread closes the connection, the next lp_connectToAzureIot reconnects from the event loop.
+bool lp_startCommsThread(void);
+void lp_stopCommsThread(void);
+// library internal, either mode, the callback runs on the event loop
+bool lp_sendReportedState(const unsigned char* document, size_t length, IOTHUB_CLIENT_REPORTED_STATE_CALLBACK callback, void* context);
+bool lp_sendMethodResponse(METHOD_HANDLE methodId, int statusCode, const unsigned char* response, size_t length);
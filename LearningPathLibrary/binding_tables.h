@@ -0,0 +1,81 @@
+#pragma once
+
+#include "cloud_messages.h"
+#include "device_twins.h"
+#include "direct_methods.h"
+#include "peripheral_gpio.h"
+#include "timer.h"
+
+// Binding sets declared from one X-macro list each. The table macro defines every binding the list names, static,
+// and the pointer set handed to lp_open*Set, so a binding can not be left out of its set. Property types, names and
+// periods are checked by the compiler rather than at startup, handler signatures by the initialisers. BINDING adds
+// a binding defined elsewhere, generated dcm_ bindings or lp_timerProfileDirectMethod.
+//
+//   #define DEVICE_TWINS(TWIN, BINDING) BINDING(dcm_DesiredTemperature) TWIN(relay1, "Relay1", LP_TYPE_BOOL, Relay1Handler)
+//   LP_DEVICE_TWIN_TABLE(deviceTwinBindingSet, DEVICE_TWINS);
+//
+// with one entry per line continued by backslashes in practice, Lab 7 declares its sets this way.
+//
+// List twins and methods in strcmp order of their names, uppercase before lowercase, and the library searches the
+// set in place instead of allocating and sorting an index, an unsorted list works as before.
+
+#define LP_BINDING_IGNORE_(_variable)
+#define LP_BINDING_ADDRESS_(_variable) &_variable,
+
+// Device twins, TWIN(variable, "property", LP_TYPE_..., handler or NULL)
+#define LP_TWIN_DEFINE_(_variable, _property, _type, _handler) \
+	_Static_assert(sizeof(_property) > 1, "device twin " #_variable " needs a property name"); \
+	_Static_assert((_type) == LP_TYPE_BOOL || (_type) == LP_TYPE_FLOAT || (_type) == LP_TYPE_INT || (_type) == LP_TYPE_STRING, \
+		"device twin " #_variable " needs LP_TYPE_BOOL, LP_TYPE_FLOAT, LP_TYPE_INT or LP_TYPE_STRING"); \
+	static LP_DEVICE_TWIN_BINDING _variable = { .twinProperty = _property, .twinType = _type, .handler = _handler };
+#define LP_TWIN_ADDRESS_(_variable, _property, _type, _handler) &_variable,
+
+#define LP_DEVICE_TWIN_TABLE(_set, _list) \
+	_list(LP_TWIN_DEFINE_, LP_BINDING_IGNORE_) \
+	static LP_DEVICE_TWIN_BINDING* _set[] = { _list(LP_TWIN_ADDRESS_, LP_BINDING_ADDRESS_) }
+
+// Direct methods, METHOD(variable, "name", handler), raw handler bindings are defined by hand and added with BINDING
+#define LP_METHOD_DEFINE_(_variable, _name, _handler) \
+	_Static_assert(sizeof(_name) > 1, "direct method " #_variable " needs a method name"); \
+	static LP_DIRECT_METHOD_BINDING _variable = { .methodName = _name, .handler = _handler };
+#define LP_METHOD_ADDRESS_(_variable, _name, _handler) &_variable,
+
+#define LP_DIRECT_METHOD_TABLE(_set, _list) \
+	_list(LP_METHOD_DEFINE_, LP_BINDING_IGNORE_) \
+	static LP_DIRECT_METHOD_BINDING* _set[] = { _list(LP_METHOD_ADDRESS_, LP_BINDING_ADDRESS_) }
+
+// Cloud to device messages, MESSAGE(variable, "type", handler), a binding with a maxSize is defined by hand
+#define LP_CLOUD_MESSAGE_DEFINE_(_variable, _type, _handler) \
+	_Static_assert(sizeof(_type) > 1, "cloud message " #_variable " needs a message type"); \
+	static LP_CLOUD_MESSAGE_BINDING _variable = { .messageType = _type, .handler = _handler };
+#define LP_CLOUD_MESSAGE_ADDRESS_(_variable, _type, _handler) &_variable,
+
+#define LP_CLOUD_MESSAGE_TABLE(_set, _list) \
+	_list(LP_CLOUD_MESSAGE_DEFINE_, LP_BINDING_IGNORE_) \
+	static LP_CLOUD_MESSAGE_BINDING* _set[] = { _list(LP_CLOUD_MESSAGE_ADDRESS_, LP_BINDING_ADDRESS_) }
+
+// Timers, TIMER(variable, seconds, nanoseconds, handler), a zero period for a one-shot timer, named after the variable.
+// Timers with slack or sampling are defined by hand and added with BINDING
+#define LP_TIMER_DEFINE_(_variable, _seconds, _nanoseconds, _handler) \
+	_Static_assert((_seconds) >= 0 && (_nanoseconds) >= 0 && (_nanoseconds) < 1000000000, "timer " #_variable " period out of range"); \
+	static LP_TIMER _variable = { .period = { _seconds, _nanoseconds }, .name = #_variable, .handler = _handler };
+#define LP_TIMER_ADDRESS_(_variable, _seconds, _nanoseconds, _handler) &_variable,
+
+#define LP_TIMER_TABLE(_set, _list) \
+	_list(LP_TIMER_DEFINE_, LP_BINDING_IGNORE_) \
+	static LP_TIMER* _set[] = { _list(LP_TIMER_ADDRESS_, LP_BINDING_ADDRESS_) }
+
+// GPIOs, GPIO_OUTPUT(variable, pin, initialState, invertPin) and GPIO_INPUT(variable, pin, onEdge or NULL),
+// opened with lp_openPeripheralGpio and named after the variable
+#define LP_GPIO_OUTPUT_DEFINE_(_variable, _pin, _initialState, _invertPin) \
+	static LP_PERIPHERAL_GPIO _variable = { .pin = _pin, .direction = LP_OUTPUT, .initialState = _initialState, .invertPin = _invertPin, \
+		.initialise = lp_openPeripheralGpio, .name = #_variable };
+#define LP_GPIO_INPUT_DEFINE_(_variable, _pin, _onEdge) \
+	static LP_PERIPHERAL_GPIO _variable = { .pin = _pin, .direction = LP_INPUT, .initialise = lp_openPeripheralGpio, .name = #_variable, \
+		.onEdge = _onEdge };
+#define LP_GPIO_OUTPUT_ADDRESS_(_variable, _pin, _initialState, _invertPin) &_variable,
+#define LP_GPIO_INPUT_ADDRESS_(_variable, _pin, _onEdge) &_variable,
+
+#define LP_PERIPHERAL_GPIO_TABLE(_set, _list) \
+	_list(LP_GPIO_OUTPUT_DEFINE_, LP_GPIO_INPUT_DEFINE_, LP_BINDING_IGNORE_) \
+	static LP_PERIPHERAL_GPIO* _set[] = { _list(LP_GPIO_OUTPUT_ADDRESS_, LP_GPIO_INPUT_ADDRESS_, LP_BINDING_ADDRESS_) }
@@ -0,0 +1,259 @@
+#include "blob_upload.h"
+
+typedef enum {
+	BLOB_STEP_INITIALISE,
+	BLOB_STEP_BLOCK,
+	BLOB_STEP_COMMIT
+} BLOB_STEP;
+
+static void BlobUploadHandler(EventLoopTimer* eventLoopTimer);
+
+static LP_TIMER blobUploadTimer = {
+	.period = { 0, 0 },			// one-shot timer, armed for each step
+	.name = "blobUploadTimer",
+	.handler = &BlobUploadHandler
+};
+
+static LP_BLOB_STATUS _status = LP_BLOB_IDLE;
+static BLOB_STEP _step = BLOB_STEP_INITIALISE;
+static char _blobName[LP_BLOB_NAME_MAX];
+static const uint8_t* _data = NULL;			// memory source
+static int _fd = -1;						// or file source, read a block at a time into _block
+static off_t _fileOffset = 0;
+static uint8_t* _block = NULL;
+static size_t _length = 0;
+static size_t _position = 0;
+static uint32_t _blockNumber = 0;
+static int _attempts = 0;
+static char* _correlationId = NULL;			// allocated by the SDK, released with free
+static char* _sasUri = NULL;
+static IOTHUB_CLIENT_LL_AZURE_STORAGE_CLIENT_HANDLE _storageClient = NULL;
+static LP_BLOB_CALLBACK _callback = NULL;
+static void* _callbackContext = NULL;
+static LP_BLOB_STATS _blobStats;
+
+static void ArmStep(int delayMs) {
+	lp_setOneShotTimer(&blobUploadTimer, &(struct timespec){delayMs / 1000, (delayMs % 1000) * 1000000});
+}
+
+static bool StartUpload(const char* blobName, size_t length, LP_BLOB_CALLBACK callback, void* context) {
+	if (_status == LP_BLOB_UPLOADING || lp_isCommsThreadRunning() || blobName == NULL || strlen(blobName) >= sizeof(_blobName) || length == 0 ||
+		(length + LP_BLOB_BLOCK_SIZE - 1) / LP_BLOB_BLOCK_SIZE > LP_BLOB_MAX_BLOCKS) {
+		return false;
+	}
+
+	if (blobUploadTimer.eventLoopTimer == NULL && !lp_startTimer(&blobUploadTimer)) {
+		return false;
+	}
+
+	strncpy(_blobName, blobName, sizeof(_blobName) - 1);
+	_length = length;
+	_position = 0;
+	_blockNumber = 0;
+	_attempts = 0;
+	_step = BLOB_STEP_INITIALISE;
+	_callback = callback;
+	_callbackContext = context;
+	_status = LP_BLOB_UPLOADING;
+	_blobStats.uploads++;
+
+	lp_connectToAzureIot();
+	ArmStep(LP_BLOB_STEP_MS);
+
+	return true;
+}
+
+/// <summary>
+///     Upload length bytes of data as blobName, data must stay valid until the callback
+/// </summary>
+bool lp_uploadBlob(const char* blobName, const void* data, size_t length, LP_BLOB_CALLBACK callback, void* context) {
+	if (data == NULL || _status == LP_BLOB_UPLOADING) {
+		return false;
+	}
+
+	_data = (const uint8_t*)data;
+	_fd = -1;
+
+	return StartUpload(blobName, length, callback, context);
+}
+
+/// <summary>
+///     Upload length bytes of fd from offset as blobName, read a block at a time, fd must stay open until the callback
+/// </summary>
+bool lp_uploadBlobFromFile(const char* blobName, int fd, off_t offset, size_t length, LP_BLOB_CALLBACK callback, void* context) {
+	if (fd < 0 || _status == LP_BLOB_UPLOADING) {
+		return false;
+	}
+
+	_block = (uint8_t*)lp_heapMalloc(LP_HEAP_BLOB, LP_BLOB_BLOCK_SIZE);
+	if (_block == NULL) {
+		return false;
+	}
+
+	_data = NULL;
+	_fd = fd;
+	_fileOffset = offset;
+
+	if (!StartUpload(blobName, length, callback, context)) {
+		lp_heapFree(LP_HEAP_BLOB, _block);
+		_block = NULL;
+		_fd = -1;
+		return false;
+	}
+	return true;
+}
+
+static void FinishUpload(bool succeeded) {
+	IOTHUB_DEVICE_CLIENT_LL_HANDLE client = lp_getAzureIotClientHandle();
+
+	// IoT Hub releases the SAS URI and raises its file upload notification on the completion
+	if (_correlationId != NULL && client != NULL) {
+		IoTHubDeviceClient_LL_AzureStorageNotifyBlobUploadCompletion(client, _correlationId, succeeded, succeeded ? 200 : 500,
+			succeeded ? "OK" : "Device upload failed");
+	}
+
+	if (_storageClient != NULL) {
+		IoTHubDeviceClient_LL_AzureStorageDestroyClient(_storageClient);
+		_storageClient = NULL;
+	}
+	free(_correlationId);
+	free(_sasUri);
+	_correlationId = _sasUri = NULL;
+
+	if (_block != NULL) {
+		lp_heapFree(LP_HEAP_BLOB, _block);
+		_block = NULL;
+	}
+	_data = NULL;
+	_fd = -1;
+
+	_status = succeeded ? LP_BLOB_SUCCEEDED : LP_BLOB_FAILED;
+	if (succeeded) {
+		_blobStats.succeeded++;
+	} else {
+		_blobStats.failed++;
+		LP_LOG(LP_LOG_WARNING, "WARNING: Blob upload '%s' failed at byte %zu of %zu\n", _blobName, _position, _length);
+	}
+
+	if (_callback != NULL) {
+		_callback(_blobName, succeeded, _callbackContext);
+	}
+}
+
+/// <summary>
+///     The step failed, returns the delay before retrying it or -1 once the upload has failed
+/// </summary>
+static int RetryStep(void) {
+	if (++_attempts >= LP_BLOB_RETRIES) {
+		FinishUpload(false);
+		return -1;
+	}
+
+	_blobStats.retries++;
+	return LP_BLOB_WAIT_MS;
+}
+
+static int InitialiseUpload(void) {
+	IOTHUB_DEVICE_CLIENT_LL_HANDLE client = lp_getAzureIotClientHandle();
+
+	if (lp_getConnectionState() != LP_CONNECTION_AUTHENTICATED || client == NULL) {
+		lp_connectToAzureIot();
+		return LP_BLOB_WAIT_MS;
+	}
+
+	if (IoTHubDeviceClient_LL_AzureStorageInitializeBlobUpload(client, _blobName, &_correlationId, &_sasUri) != IOTHUB_CLIENT_OK) {
+		return RetryStep();
+	}
+
+	_storageClient = IoTHubDeviceClient_LL_AzureStorageCreateClient(client, _sasUri);
+	if (_storageClient == NULL) {
+		return RetryStep();
+	}
+
+	_attempts = 0;
+	_step = BLOB_STEP_BLOCK;
+	return LP_BLOB_STEP_MS;
+}
+
+static int PutNextBlock(void) {
+	size_t blockLength = _length - _position > LP_BLOB_BLOCK_SIZE ? LP_BLOB_BLOCK_SIZE : _length - _position;
+	const uint8_t* block = _data != NULL ? _data + _position : _block;
+
+	if (_data == NULL && pread(_fd, _block, blockLength, _fileOffset + (off_t)_position) != (ssize_t)blockLength) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: Blob upload read failed: %s (%d)\n", strerror(errno), errno);
+		FinishUpload(false);
+		return -1;
+	}
+
+	if (IoTHubDeviceClient_LL_AzureStoragePutBlock(_storageClient, _blockNumber, block, blockLength) != IOTHUB_CLIENT_OK) {
+		return RetryStep();
+	}
+
+	_blobStats.blocks++;
+	_blobStats.bytes += blockLength;
+	_position += blockLength;
+	_blockNumber++;
+	_attempts = 0;
+
+	if (_position == _length) {
+		_step = BLOB_STEP_COMMIT;
+	}
+	return LP_BLOB_STEP_MS;
+}
+
+static int CommitUpload(void) {
+	if (IoTHubDeviceClient_LL_AzureStoragePutBlockList(_storageClient) != IOTHUB_CLIENT_OK) {
+		return RetryStep();
+	}
+
+	FinishUpload(true);
+	return -1;
+}
+
+/// <summary>
+///     Abandon the upload in progress, IoT Hub is told it failed and the callback is called
+/// </summary>
+void lp_cancelBlobUpload(void) {
+	if (_status == LP_BLOB_UPLOADING) {
+		FinishUpload(false);
+	}
+}
+
+LP_BLOB_STATUS lp_getBlobUploadStatus(void) {
+	return _status;
+}
+
+void lp_getBlobUploadStats(LP_BLOB_STATS* stats) {
+	if (stats != NULL) {
+		*stats = _blobStats;
+	}
+}
+
+static void BlobUploadHandler(EventLoopTimer* eventLoopTimer) {
+	int delayMs = -1;
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_BlobUploadHandler);
+		return;
+	}
+
+	if (_status != LP_BLOB_UPLOADING) {
+		return;
+	}
+
+	switch (_step) {
+	case BLOB_STEP_INITIALISE:
+		delayMs = InitialiseUpload();
+		break;
+	case BLOB_STEP_BLOCK:
+		delayMs = PutNextBlock();
+		break;
+	case BLOB_STEP_COMMIT:
+		delayMs = CommitUpload();
+		break;
+	}
+
+	if (delayMs >= 0 && _status == LP_BLOB_UPLOADING) {
+		ArmStep(delayMs);
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "azure_iot.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define LP_BLOB_BLOCK_SIZE 16384		// bytes per storage request, bounds the RAM a file upload holds and how long a step blocks
+#define LP_BLOB_MAX_BLOCKS 50000		// Azure Storage block blob limit
+#define LP_BLOB_NAME_MAX 128
+#define LP_BLOB_RETRIES 3				// attempts at each request before the upload fails
+#define LP_BLOB_STEP_MS 10				// between requests so timers and DoWork run in between
+#define LP_BLOB_WAIT_MS 1000			// before a retry, or while the hub is not connected
+
+typedef enum {
+	LP_BLOB_IDLE,
+	LP_BLOB_UPLOADING,
+	LP_BLOB_SUCCEEDED,
+	LP_BLOB_FAILED
+} LP_BLOB_STATUS;
+
+typedef struct LP_BLOB_STATS
+{
+	uint32_t uploads;
+	uint32_t succeeded;
+	uint32_t failed;
+	uint32_t blocks;
+	uint32_t retries;
+	uint64_t bytes;
+} LP_BLOB_STATS;
+
+typedef void (*LP_BLOB_CALLBACK)(const char* blobName, bool succeeded, void* context);
+
+// Bulk data, raw captures, FFT frames and logs, uploaded to the storage account linked to the IoT Hub instead of
+// sent as messages, no 256 KB message limit and no message metering. The upload runs on its own timer one
+// storage request per step, IoT Hub's SAS URI, one LP_BLOB_BLOCK_SIZE block at a time, the block list, then the
+// completion notification. Each request is a blocking HTTPS round trip, the block size bounds how long a step
+// holds the event loop. One upload at a time, it waits for the hub connection and the callback reports the result.
+//
+// From memory the data must stay valid until the callback, from a file, such as the mutable storage file, each
+// block is read as it is sent so only one block is held in RAM. Uploads are refused in comms thread mode.
+bool lp_uploadBlob(const char* blobName, const void* data, size_t length, LP_BLOB_CALLBACK callback, void* context);
+bool lp_uploadBlobFromFile(const char* blobName, int fd, off_t offset, size_t length, LP_BLOB_CALLBACK callback, void* context);
+void lp_cancelBlobUpload(void);
+LP_BLOB_STATUS lp_getBlobUploadStatus(void);
+void lp_getBlobUploadStats(LP_BLOB_STATS* stats);
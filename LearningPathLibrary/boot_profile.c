@@ -0,0 +1,80 @@
+#include "boot_profile.h"
+#include <applibs/log.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+	const char* phase;
+	uint32_t ms;
+} LP_BOOT_MARK;
+
+static struct timespec _processStart;
+static LP_BOOT_MARK _marks[LP_BOOT_PHASES];
+static size_t _markCount = 0;
+static LP_INIT_MODE _initMode = LP_INIT_SEQUENTIAL;
+
+// before main, so the timeline includes everything the app does
+__attribute__((constructor)) static void BootProfileStart(void) {
+	clock_gettime(CLOCK_MONOTONIC, &_processStart);
+}
+
+bool lp_bootMarked(const char* phase) {
+	for (size_t i = 0; i < _markCount; i++) {
+		if (strcmp(_marks[i].phase, phase) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/// <summary>
+///     Record when phase was reached, only its first time counts. phase must outlive the timeline
+/// </summary>
+void lp_bootMark(const char* phase) {
+	struct timespec now;
+
+	if (_markCount == LP_BOOT_PHASES || lp_bootMarked(phase)) {
+		return;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	_marks[_markCount].phase = phase;
+	_marks[_markCount].ms = (uint32_t)((now.tv_sec - _processStart.tv_sec) * 1000 + (now.tv_nsec - _processStart.tv_nsec) / 1000000);
+	_markCount++;
+}
+
+void lp_logBootTimeline(void) {
+	uint32_t previous = 0;
+
+	Log_Debug("Boot timeline (%s start up):\n", _initMode == LP_INIT_CONCURRENT ? "concurrent" : "sequential");
+	for (size_t i = 0; i < _markCount; i++) {
+		Log_Debug("  %6u ms  +%5u ms  %s\n", _marks[i].ms, _marks[i].ms - previous, _marks[i].phase);
+		previous = _marks[i].ms;
+	}
+}
+
+int lp_formatBootTimeline(char* buffer, size_t bufferSize) {
+	size_t length = 0;
+
+	for (size_t i = 0; i <= _markCount; i++) {
+		int n = i == _markCount
+			? snprintf(buffer + length, bufferSize - length, _markCount == 0 ? "{}" : "}")
+			: snprintf(buffer + length, bufferSize - length, "%c\"%s\":%u", i == 0 ? '{' : ',', _marks[i].phase, _marks[i].ms);
+
+		if (n < 0 || (size_t)n >= bufferSize - length) {
+			return -1;
+		}
+		length += (size_t)n;
+	}
+
+	return (int)length;
+}
+
+void lp_setInitMode(LP_INIT_MODE mode) {
+	_initMode = mode;
+}
+
+LP_INIT_MODE lp_getInitMode(void) {
+	return _initMode;
+}
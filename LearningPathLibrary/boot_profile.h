@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LP_BOOT_PHASES 16		// marks kept, later ones are dropped
+
+typedef enum {
+	LP_INIT_SEQUENTIAL = 0,		// each part of start up finishes before the next, the cloud connection starts last
+	LP_INIT_CONCURRENT			// sensor start up and cloud provisioning interleave on the event loop
+} LP_INIT_MODE;
+
+// Milliseconds since the process started, each phase named once. The library marks the network,
+// provisioning, authentication and first confirmed message, the app marks its own start up phases
+void lp_bootMark(const char* phase);
+bool lp_bootMarked(const char* phase);
+void lp_logBootTimeline(void);
+// {"phase":ms,...}, returns the length or -1 if it did not fit
+int lp_formatBootTimeline(char* buffer, size_t bufferSize);
+
+void lp_setInitMode(LP_INIT_MODE mode);
+LP_INIT_MODE lp_getInitMode(void);
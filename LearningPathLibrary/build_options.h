@@ -0,0 +1,16 @@
+#pragma once
+
+// Optional library modules, set by the azsphere_libs CMake options of the same names. A module compiled
+// out is replaced by its _stub.c, same API so apps build unchanged, opens and sends do nothing and report
+// failure, stats read zero. Apps that must act differently can test the same macros.
+#ifndef LP_ENABLE_TWINS
+#define LP_ENABLE_TWINS 1
+#endif
+
+#ifndef LP_ENABLE_DIRECT_METHODS
+#define LP_ENABLE_DIRECT_METHODS 1
+#endif
+
+#ifndef LP_ENABLE_INTERCORE
+#define LP_ENABLE_INTERCORE 1
+#endif
@@ -0,0 +1,246 @@
+#include "cloud_messages.h"
+#include "event_trace.h"
+#include "heap_stats.h"
+#include "memory_governor.h"
+#include "logging.h"
+#include <stdlib.h>
+#include <string.h>
+
+static LP_CLOUD_MESSAGE_BINDING** _cloudMessages = NULL;
+static size_t _cloudMessageCount = 0;
+
+/// <summary>
+///     The binding of the message type, or the catch-all binding with no type, a set has a few so it is scanned
+/// </summary>
+static LP_CLOUD_MESSAGE_BINDING* FindCloudMessage(const char* type) {
+	LP_CLOUD_MESSAGE_BINDING* catchAll = NULL;
+
+	for (size_t i = 0; i < _cloudMessageCount; i++) {
+		LP_CLOUD_MESSAGE_BINDING* binding = _cloudMessages[i];
+
+		if (binding->messageType == NULL) {
+			catchAll = binding;
+		} else if (type != NULL && strcmp(type, binding->messageType) == 0) {
+			return binding;
+		}
+	}
+	return catchAll;
+}
+
+static const char* TypeName(const LP_CLOUD_MESSAGE_BINDING* binding) {
+	return binding->messageType != NULL ? binding->messageType : "*";
+}
+
+static void DropTransfer(LP_CLOUD_MESSAGE_BINDING* binding) {
+	lp_heapFree(LP_HEAP_C2D, binding->assembly);
+	binding->assembly = NULL;
+	binding->assemblyLength = 0;
+	binding->assemblyCapacity = 0;
+	binding->nextPart = 0;
+	binding->parts = 0;
+	binding->transfer[0] = 0;
+}
+
+/// <summary>
+///     Parse "k/n", false unless 1 <= k <= n <= LP_C2D_MAX_PARTS
+/// </summary>
+static bool ParsePart(const char* text, uint32_t* part, uint32_t* parts) {
+	char* end;
+	unsigned long k = strtoul(text, &end, 10);
+	unsigned long n;
+
+	if (end == text || *end != '/') {
+		return false;
+	}
+	text = end + 1;
+	n = strtoul(text, &end, 10);
+	if (end == text || *end != 0 || k < 1 || k > n || n > LP_C2D_MAX_PARTS) {
+		return false;
+	}
+
+	*part = (uint32_t)k;
+	*parts = (uint32_t)n;
+	return true;
+}
+
+static LP_C2D_DISPOSITION Refuse(LP_CLOUD_MESSAGE_BINDING* binding) {
+	binding->refused++;
+	return LP_C2D_REJECTED;
+}
+
+/// <summary>
+///     Part 1 starts the transfer, sized from the size property or as n parts the length of this one
+/// </summary>
+static bool StartTransfer(LP_CLOUD_MESSAGE_BINDING* binding, const LP_CLOUD_MESSAGE* message, uint32_t parts, size_t maxSize) {
+	size_t capacity = message->length * parts;
+
+	if (message->size != NULL) {
+		unsigned long size = strtoul(message->size, NULL, 10);
+
+		if (size > maxSize) {
+			LP_LOG(LP_LOG_WARNING, "Cloud message %s transfer %s of %lu bytes over the %u byte limit\n",
+				TypeName(binding), message->transfer, size, (unsigned)maxSize);
+			return false;
+		}
+		if (size >= message->length) {
+			capacity = size;
+		}
+	}
+	if (capacity > maxSize || capacity / parts != message->length) {
+		capacity = maxSize;
+	}
+
+	if (!lp_memoryAdmitPayload(capacity)) {
+		return false;		// short of memory, not reassembled
+	}
+
+	if (binding->nextPart != 0) {
+		LP_LOG(LP_LOG_WARNING, "Cloud message %s transfer %s dropped at part %u of %u for transfer %s\n",
+			TypeName(binding), binding->transfer, binding->nextPart, binding->parts, message->transfer);
+	}
+	DropTransfer(binding);
+
+	if ((binding->assembly = (unsigned char*)lp_heapMalloc(LP_HEAP_C2D, capacity > 0 ? capacity : 1)) == NULL) {
+		return false;
+	}
+	binding->assemblyCapacity = capacity;
+	binding->nextPart = 1;
+	binding->parts = parts;
+	strncpy(binding->transfer, message->transfer, sizeof(binding->transfer) - 1);
+	binding->transfer[sizeof(binding->transfer) - 1] = 0;
+
+	return true;
+}
+
+/// <summary>
+///     Append a part in order, growing the buffer when the size property was missing or the parts uneven
+/// </summary>
+static bool AppendPart(LP_CLOUD_MESSAGE_BINDING* binding, const LP_CLOUD_MESSAGE* message, size_t maxSize) {
+	size_t needed = binding->assemblyLength + message->length;
+
+	if (needed > maxSize) {
+		LP_LOG(LP_LOG_WARNING, "Cloud message %s transfer %s over the %u byte limit at part %u\n",
+			TypeName(binding), binding->transfer, (unsigned)maxSize, binding->nextPart);
+		return false;
+	}
+
+	if (needed > binding->assemblyCapacity) {
+		size_t capacity = binding->assemblyCapacity * 2 > needed ? binding->assemblyCapacity * 2 : needed;
+		unsigned char* grown;
+
+		capacity = capacity < maxSize ? capacity : maxSize;
+		if ((grown = (unsigned char*)lp_heapRealloc(LP_HEAP_C2D, binding->assembly, capacity)) == NULL) {
+			return false;
+		}
+		binding->assembly = grown;
+		binding->assemblyCapacity = capacity;
+	}
+
+	memcpy(binding->assembly + binding->assemblyLength, message->body, message->length);
+	binding->assemblyLength = needed;
+	binding->nextPart++;
+
+	return true;
+}
+
+static LP_C2D_DISPOSITION Deliver(LP_CLOUD_MESSAGE_BINDING* binding, const unsigned char* body, size_t length) {
+	binding->received++;
+	return binding->handler != NULL ? binding->handler(body, length, binding) : LP_C2D_ACCEPTED;
+}
+
+/// <summary>
+///     Dispatch a received message or part, app thread only, the body is read and not kept
+/// </summary>
+LP_C2D_DISPOSITION lp_dispatchCloudMessage(const LP_CLOUD_MESSAGE* message) {
+	uint32_t tracedUs = lp_traceNow();
+	LP_CLOUD_MESSAGE_BINDING* binding = FindCloudMessage(message->type);
+	LP_C2D_DISPOSITION result;
+	uint32_t part = 1;
+	uint32_t parts = 1;
+	size_t maxSize;
+
+	if (binding == NULL) {
+		LP_LOG_LIMITED(LP_LOG_WARNING, LP_LOG_LIMIT_MS, "Cloud message of type %s not bound, rejected\n", message->type != NULL ? message->type : "(none)");
+		lp_traceSpan(LP_TRACE_C2D, NULL, tracedUs, LP_C2D_REJECTED);		// the type is in the SDK's message, not kept
+		return LP_C2D_REJECTED;
+	}
+
+	maxSize = binding->maxSize > 0 ? binding->maxSize : LP_C2D_DEFAULT_MAX_SIZE;
+
+	if (message->part != NULL && !ParsePart(message->part, &part, &parts)) {
+		LP_LOG(LP_LOG_WARNING, "Cloud message %s part '%s' not understood, rejected\n", TypeName(binding), message->part);
+		result = Refuse(binding);
+	} else if (parts == 1) {
+		// the whole body in one message, straight from the SDK's buffer
+		result = message->length <= maxSize && lp_memoryAdmitPayload(message->length) ? Deliver(binding, message->body, message->length) : Refuse(binding);
+	} else if (message->transfer == NULL) {
+		LP_LOG(LP_LOG_WARNING, "Cloud message %s part %s without a transfer, rejected\n", TypeName(binding), message->part);
+		result = Refuse(binding);
+	} else if (part == 1) {
+		if (StartTransfer(binding, message, parts, maxSize) && AppendPart(binding, message, maxSize)) {
+			result = LP_C2D_ACCEPTED;
+		} else {
+			DropTransfer(binding);
+			result = Refuse(binding);
+		}
+	} else if (binding->nextPart == 0 || strncmp(message->transfer, binding->transfer, sizeof(binding->transfer) - 1) != 0 || parts != binding->parts) {
+		result = Refuse(binding);		// a part of a transfer already dropped or never started
+	} else if (part == binding->nextPart - 1) {
+		result = LP_C2D_ACCEPTED;		// redelivered, already appended
+	} else if (part != binding->nextPart) {
+		LP_LOG(LP_LOG_WARNING, "Cloud message %s transfer %s part %u arrived for part %u, dropped\n",
+			TypeName(binding), binding->transfer, part, binding->nextPart);
+		DropTransfer(binding);
+		result = Refuse(binding);
+	} else if (!AppendPart(binding, message, maxSize)) {
+		DropTransfer(binding);
+		result = Refuse(binding);
+	} else {
+		result = LP_C2D_ACCEPTED;
+	}
+
+	// the last part completes the body, handled from the reassembly buffer and then freed
+	if (result == LP_C2D_ACCEPTED && parts > 1 && binding->nextPart > binding->parts) {
+		result = Deliver(binding, binding->assembly, binding->assemblyLength);
+		DropTransfer(binding);
+	}
+
+	lp_traceSpan(LP_TRACE_C2D, binding->messageType, tracedUs, (uint32_t)result);
+	return result;
+}
+
+/// <summary>
+///     The SDK's message callback, the body and properties are read in place
+/// </summary>
+IOTHUBMESSAGE_DISPOSITION_RESULT lp_azureCloudMessageHandler(IOTHUB_MESSAGE_HANDLE message, void* userContextCallback) {
+	LP_CLOUD_MESSAGE received = {
+		.type = IoTHubMessage_GetProperty(message, LP_C2D_TYPE_PROPERTY),
+		.transfer = IoTHubMessage_GetProperty(message, LP_C2D_TRANSFER_PROPERTY),
+		.part = IoTHubMessage_GetProperty(message, LP_C2D_PART_PROPERTY),
+		.size = IoTHubMessage_GetProperty(message, LP_C2D_SIZE_PROPERTY)
+	};
+
+	if (IoTHubMessage_GetByteArray(message, &received.body, &received.length) != IOTHUB_MESSAGE_OK) {
+		return IOTHUBMESSAGE_REJECTED;
+	}
+
+	return (IOTHUBMESSAGE_DISPOSITION_RESULT)lp_dispatchCloudMessage(&received);
+}
+
+void lp_openCloudMessageSet(LP_CLOUD_MESSAGE_BINDING* cloudMessages[], size_t cloudMessageCount) {
+	_cloudMessages = cloudMessages;
+	_cloudMessageCount = cloudMessageCount;
+}
+
+void lp_closeCloudMessageSet(void) {
+	for (size_t i = 0; i < _cloudMessageCount; i++) {
+		DropTransfer(_cloudMessages[i]);
+	}
+
+	_cloudMessages = NULL;
+	_cloudMessageCount = 0;
+}
+
+bool lp_isCloudMessageSetOpen(void) {
+	return _cloudMessages != NULL;
+}
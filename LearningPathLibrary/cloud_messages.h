@@ -0,0 +1,68 @@
+#pragma once
+
+#include <iothub_client_core_ll.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LP_C2D_TYPE_PROPERTY "type"				// names the binding a message is for
+#define LP_C2D_TRANSFER_PROPERTY "transfer"		// identifies the parts of one body
+#define LP_C2D_PART_PROPERTY "part"				// "k/n" numbered from 1, a message without it is the whole body
+#define LP_C2D_SIZE_PROPERTY "size"				// optional on part 1, bytes of the whole body
+#define LP_C2D_DEFAULT_MAX_SIZE 65536			// largest body a binding accepts unless it sets maxSize
+#define LP_C2D_MAX_PARTS 1024
+#define LP_C2D_TRANSFER_SIZE 40					// longest transfer id kept including the NUL, a GUID fits
+
+typedef enum {
+	LP_C2D_ACCEPTED = IOTHUBMESSAGE_ACCEPTED,
+	LP_C2D_REJECTED = IOTHUBMESSAGE_REJECTED,		// not wanted, the hub dead letters it
+	LP_C2D_ABANDONED = IOTHUBMESSAGE_ABANDONED		// not now, the hub redelivers it
+} LP_C2D_DISPOSITION;
+
+struct _cloudMessageBinding {
+	const char* messageType;				// the message's type property, NULL for messages no other binding takes
+	// the body is the SDK's buffer, or the reassembly buffer of a chunked one, valid until the handler returns
+	LP_C2D_DISPOSITION (*handler)(const unsigned char* body, size_t length, struct _cloudMessageBinding* binding);
+	size_t maxSize;							// optional, largest body reassembled, 0 for LP_C2D_DEFAULT_MAX_SIZE
+	unsigned int received;					// read only, bodies handed to the handler
+	unsigned int refused;					// read only, parts rejected, out of order, oversized or after a failed allocation
+	unsigned char* assembly;				// internal, the chunked body being reassembled
+	size_t assemblyLength;
+	size_t assemblyCapacity;
+	uint32_t nextPart;						// 0 when no body is being reassembled
+	uint32_t parts;
+	char transfer[LP_C2D_TRANSFER_SIZE];
+};
+
+typedef struct _cloudMessageBinding LP_CLOUD_MESSAGE_BINDING;
+
+// what lp_dispatchCloudMessage needs of a received message, the properties NULL when absent
+typedef struct LP_CLOUD_MESSAGE
+{
+	const char* type;
+	const char* transfer;
+	const char* part;
+	const char* size;
+	const unsigned char* body;
+	size_t length;
+} LP_CLOUD_MESSAGE;
+
+// Cloud to device messages dispatched on their type property to a set of bindings, for configuration too large or
+// too rarely changed for a twin property, rule sets and calibration tables. A message's body goes to the handler
+// where the SDK holds it, not copied.
+//
+// A body larger than one message, IoT Hub takes 64 KB, is sent as parts with the same transfer property and part
+// "1/n" to "n/n", in order as the hub delivers a device's messages. The parts are appended to one buffer, sized
+// from the size property of part 1 when it has one, and the handler gets the whole body with the last part. Part 1
+// starts a new transfer in place of one not completed, a part repeated as a redelivery is accepted once and any
+// other part out of order drops the transfer. The buffer is freed once the handler returns.
+//
+// Bindings are looked up, and handlers run, on the app thread. Open the set before lp_connectToAzureIot, the
+// client subscribes to cloud to device messages only when it is created with a set open. Over MQTT the hub does not
+// take a rejection or an abandon, the message is completed whatever the handler returns, and on the comms thread,
+// see lp_startCommsThread, the message is copied and accepted before the handler runs.
+void lp_openCloudMessageSet(LP_CLOUD_MESSAGE_BINDING* cloudMessages[], size_t cloudMessageCount);
+void lp_closeCloudMessageSet(void);
+bool lp_isCloudMessageSetOpen(void);
+IOTHUBMESSAGE_DISPOSITION_RESULT lp_azureCloudMessageHandler(IOTHUB_MESSAGE_HANDLE message, void* userContextCallback);
+LP_C2D_DISPOSITION lp_dispatchCloudMessage(const LP_CLOUD_MESSAGE* message);
@@ -0,0 +1,292 @@
+#include "comms_thread.h"
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct COMMS_CALL
+{
+	LP_COMMS_CALL call;
+	void* context;
+} COMMS_CALL;
+
+typedef struct COMMS_QUEUE
+{
+	COMMS_CALL calls[LP_COMMS_QUEUE_SIZE];
+	_Atomic uint32_t head;		// next slot the producer fills, written only by the producer
+	_Atomic uint32_t tail;		// next slot the consumer runs, written only by the consumer
+	_Atomic uint32_t highWater;
+	int eventFd;
+} COMMS_QUEUE;
+
+_Static_assert((LP_COMMS_QUEUE_SIZE & (LP_COMMS_QUEUE_SIZE - 1)) == 0, "LP_COMMS_QUEUE_SIZE must be a power of two");
+
+static void CommsQueueHandler(EventLoop* el, int fd, EventLoop_IoEvents events, void* context);
+
+static COMMS_QUEUE _toComms = { .eventFd = -1 };
+static COMMS_QUEUE _toApp = { .eventFd = -1 };
+static EventRegistration* _toAppRegistration = NULL;
+static pthread_t _commsThread;
+static _Atomic bool _commsRunning = false;		// set by lp_openCommsThread, cleared by the comms thread as it exits
+static _Atomic bool _commsStopping = false;
+static _Atomic bool _commsKicked = false;
+static int (*_commsStep)(bool kicked) = NULL;
+static void (*_commsClose)(void) = NULL;
+
+static _Atomic uint32_t _toCommsPosted = 0;
+static _Atomic uint32_t _toCommsRefused = 0;
+static _Atomic uint32_t _toAppPosted = 0;
+static _Atomic uint32_t _toAppWaits = 0;
+static _Atomic uint32_t _commsSteps = 0;
+
+static bool QueuePush(COMMS_QUEUE* queue, LP_COMMS_CALL call, void* context) {
+	uint32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+	uint32_t depth = head - atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+	if (depth >= LP_COMMS_QUEUE_SIZE) {
+		return false;
+	}
+
+	queue->calls[head & (LP_COMMS_QUEUE_SIZE - 1)] = (COMMS_CALL){ call, context };
+	atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+
+	if (depth + 1 > atomic_load_explicit(&queue->highWater, memory_order_relaxed)) {
+		atomic_store_explicit(&queue->highWater, depth + 1, memory_order_relaxed);
+	}
+
+	// every post wakes the consumer, it drains to empty after each wakeup so a skipped write could strand a call
+	uint64_t one = 1;
+	if (write(queue->eventFd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: comms queue wakeup failed: %d (%s)\n", errno, strerror(errno));
+	}
+
+	return true;
+}
+
+/// <summary>
+///     Run the queued calls, consumer side. Calls posted while it runs are run too.
+/// </summary>
+static void QueueRun(COMMS_QUEUE* queue) {
+	uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+	while (tail != atomic_load_explicit(&queue->head, memory_order_acquire)) {
+		COMMS_CALL call = queue->calls[tail & (LP_COMMS_QUEUE_SIZE - 1)];
+
+		atomic_store_explicit(&queue->tail, ++tail, memory_order_release);		// the slot is copied, free it first
+		call.call(call.context);
+	}
+}
+
+static void QueueReset(COMMS_QUEUE* queue) {
+	uint64_t count;
+
+	if (read(queue->eventFd, &count, sizeof(count)) == -1 && errno != EAGAIN) {
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: comms queue wakeup read failed: %d (%s)\n", errno, strerror(errno));
+	}
+}
+
+static int MsUntil(const struct timespec* due) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	int64_t ms = (due->tv_sec - now.tv_sec) * 1000 + (due->tv_nsec - now.tv_nsec) / 1000000;
+	return ms < 0 ? 0 : ms > INT32_MAX ? INT32_MAX : (int)ms;
+}
+
+/// <summary>
+///     The comms thread, runs posted calls and the step function until lp_closeCommsThread, then the close function
+/// </summary>
+static void* CommsThreadMain(void* unused) {
+	struct pollfd wakeup = { .fd = _toComms.eventFd, .events = POLLIN };
+	struct timespec due;
+
+	clock_gettime(CLOCK_MONOTONIC, &due);
+
+	while (!atomic_load(&_commsStopping)) {
+		int waitMs = MsUntil(&due);
+
+		if (waitMs > 0 && !atomic_load(&_commsKicked)) {
+			poll(&wakeup, 1, waitMs);
+		}
+
+		QueueReset(&_toComms);
+		QueueRun(&_toComms);
+
+		bool kicked = atomic_exchange(&_commsKicked, false);
+
+		if (kicked || MsUntil(&due) == 0) {
+			int delayMs = _commsStep(kicked);
+
+			atomic_fetch_add_explicit(&_commsSteps, 1, memory_order_relaxed);
+			clock_gettime(CLOCK_MONOTONIC, &due);
+			due.tv_sec += delayMs / 1000;
+			due.tv_nsec += (delayMs % 1000) * 1000000;
+			if (due.tv_nsec >= 1000000000) {
+				due.tv_sec++;
+				due.tv_nsec -= 1000000000;
+			}
+		}
+	}
+
+	_commsClose();
+	QueueRun(&_toComms);		// calls posted before the stop still own their contexts
+
+	atomic_store(&_commsRunning, false);
+	return NULL;
+}
+
+static void CloseEventFds(void) {
+	if (_toAppRegistration != NULL) {
+		EventLoop_UnregisterIo(lp_getTimerEventLoop(), _toAppRegistration);
+		_toAppRegistration = NULL;
+	}
+	if (_toComms.eventFd != -1) {
+		close(_toComms.eventFd);
+		_toComms.eventFd = -1;
+	}
+	if (_toApp.eventFd != -1) {
+		close(_toApp.eventFd);
+		_toApp.eventFd = -1;
+	}
+}
+
+/// <summary>
+///     Start the comms thread running step, whose return value is the delay in milliseconds until it runs again.
+///     kicked is true when lp_kickCommsThread brought the step forward. close runs on the comms thread when it stops.
+/// </summary>
+bool lp_openCommsThread(int (*step)(bool kicked), void (*close)(void)) {
+	if (atomic_load(&_commsRunning)) {
+		return true;
+	}
+
+	if (step == NULL || close == NULL) {
+		return false;
+	}
+
+	_toComms.eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	_toApp.eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if (_toComms.eventFd == -1 || _toApp.eventFd == -1) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: Unable to create the comms thread eventfds: %d (%s)\n", errno, strerror(errno));
+		CloseEventFds();
+		return false;
+	}
+
+	_toAppRegistration = EventLoop_RegisterIo(lp_getTimerEventLoop(), _toApp.eventFd, EventLoop_Input, CommsQueueHandler, NULL);
+	if (_toAppRegistration == NULL) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: Unable to register the comms queue event: %d (%s)\n", errno, strerror(errno));
+		CloseEventFds();
+		return false;
+	}
+
+	_commsStep = step;
+	_commsClose = close;
+	atomic_store(&_commsStopping, false);
+	atomic_store(&_commsKicked, false);
+	atomic_store(&_commsRunning, true);
+
+	int result = pthread_create(&_commsThread, NULL, CommsThreadMain, NULL);
+	if (result != 0) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: Unable to start the comms thread: %d (%s)\n", result, strerror(result));
+		atomic_store(&_commsRunning, false);
+		CloseEventFds();
+		return false;
+	}
+
+	return true;
+}
+
+void lp_closeCommsThread(void) {
+	struct pollfd wakeup;
+
+	if (!atomic_load(&_commsRunning)) {
+		return;
+	}
+
+	atomic_store(&_commsStopping, true);
+	lp_kickCommsThread();
+
+	// the close function may post to the app thread and wait for room, keep running the app queue until it is done
+	wakeup = (struct pollfd){ .fd = _toApp.eventFd, .events = POLLIN };
+	while (atomic_load(&_commsRunning)) {
+		poll(&wakeup, 1, 10);
+		QueueReset(&_toApp);
+		QueueRun(&_toApp);
+	}
+
+	pthread_join(_commsThread, NULL);
+	QueueRun(&_toApp);
+	CloseEventFds();
+}
+
+bool lp_isCommsThreadRunning(void) {
+	return atomic_load(&_commsRunning);
+}
+
+bool lp_onCommsThread(void) {
+	return atomic_load(&_commsRunning) && pthread_equal(pthread_self(), _commsThread);
+}
+
+bool lp_postToCommsThread(LP_COMMS_CALL call, void* context) {
+	if (!atomic_load(&_commsRunning) || atomic_load(&_commsStopping)) {
+		return false;
+	}
+
+	if (!QueuePush(&_toComms, call, context)) {
+		atomic_fetch_add_explicit(&_toCommsRefused, 1, memory_order_relaxed);
+		return false;
+	}
+
+	atomic_fetch_add_explicit(&_toCommsPosted, 1, memory_order_relaxed);
+	return true;
+}
+
+void lp_postToAppThread(LP_COMMS_CALL call, void* context) {
+	while (!QueuePush(&_toApp, call, context)) {
+		atomic_fetch_add_explicit(&_toAppWaits, 1, memory_order_relaxed);
+		poll(NULL, 0, LP_COMMS_FULL_WAIT_MS);
+	}
+
+	atomic_fetch_add_explicit(&_toAppPosted, 1, memory_order_relaxed);
+}
+
+void lp_kickCommsThread(void) {
+	uint64_t one = 1;
+
+	if (atomic_load(&_commsRunning) && !atomic_exchange(&_commsKicked, true)) {
+		if (write(_toComms.eventFd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+			LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: comms thread kick failed: %d (%s)\n", errno, strerror(errno));
+		}
+	}
+}
+
+void lp_getCommsThreadStats(LP_COMMS_THREAD_STATS* stats) {
+	if (stats == NULL) {
+		return;
+	}
+
+	stats->toComms = atomic_load_explicit(&_toCommsPosted, memory_order_relaxed);
+	stats->toCommsRefused = atomic_load_explicit(&_toCommsRefused, memory_order_relaxed);
+	stats->toCommsHighWater = atomic_load_explicit(&_toComms.highWater, memory_order_relaxed);
+	stats->toApp = atomic_load_explicit(&_toAppPosted, memory_order_relaxed);
+	stats->toAppWaits = atomic_load_explicit(&_toAppWaits, memory_order_relaxed);
+	stats->toAppHighWater = atomic_load_explicit(&_toApp.highWater, memory_order_relaxed);
+	stats->steps = atomic_load_explicit(&_commsSteps, memory_order_relaxed);
+}
+
+/// <summary>
+///     App thread side of the queue from the comms thread, dispatched by the event loop
+/// </summary>
+static void CommsQueueHandler(EventLoop* el, int fd, EventLoop_IoEvents events, void* context) {
+	uint64_t count;
+
+	if (read(fd, &count, sizeof(count)) == -1 && errno != EAGAIN) {
+		lp_terminate(ExitCode_CommsThreadHandler);
+		return;
+	}
+
+	QueueRun(&_toApp);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "logging.h"
+#include "terminate.h"
+#include "timer.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LP_COMMS_QUEUE_SIZE 128			// calls queued each way, a power of two
+#define LP_COMMS_FULL_WAIT_MS 1			// the comms thread retries a full queue to the app thread this often
+
+typedef void (*LP_COMMS_CALL)(void* context);
+
+typedef struct LP_COMMS_THREAD_STATS
+{
+	uint32_t toComms;					// calls the app thread posted to the comms thread
+	uint32_t toCommsRefused;			// posts refused with the queue full, the caller falls back
+	uint32_t toCommsHighWater;
+	uint32_t toApp;						// calls the comms thread posted to the app thread
+	uint32_t toAppWaits;				// the comms thread waited for the app thread to make room
+	uint32_t toAppHighWater;
+	uint32_t steps;						// times the comms thread ran its step function
+} LP_COMMS_THREAD_STATS;
+
+// A second thread and a pair of single producer, single consumer queues of calls between it and the app's event
+// loop, each queue an array of call and context pairs indexed by two atomic counters, one written by each side,
+// with an eventfd that wakes the consumer. The app thread dispatches its queue from lp_getTimerEventLoop(), the comms
+// thread sleeps in poll on its own until its step function's delay is up, a kick or a posted call. A call runs on
+// the consumer's thread and owns its context.
+//
+// The library's IoT Hub client runs here in lp_startCommsThread mode, see azure_iot.h, so only azure_iot.c opens it.
+bool lp_openCommsThread(int (*step)(bool kicked), void (*close)(void));
+// runs the close function on the comms thread, dispatches the calls it posts while closing, then joins it
+void lp_closeCommsThread(void);
+bool lp_isCommsThreadRunning(void);
+bool lp_onCommsThread(void);
+// app thread only, false if the thread is not running or the queue is full
+bool lp_postToCommsThread(LP_COMMS_CALL call, void* context);
+// comms thread only, waits for room, the app thread never waits on the comms thread
+void lp_postToAppThread(LP_COMMS_CALL call, void* context);
+// run the step function now, from either thread
+void lp_kickCommsThread(void);
+void lp_getCommsThreadStats(LP_COMMS_THREAD_STATS* stats);
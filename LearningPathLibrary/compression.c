@@ -0,0 +1,230 @@
+#include "compression.h"
+#include <string.h>
+
+// LZ4 block format, no frame header. The compressor is a single pass greedy matcher with a
+// 4096 entry hash table (8 KB) so the working set stays small on the A7.
+#define LZ4_HASH_LOG 12
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5			// the block must end with at least 5 literal bytes
+#define LZ4_MATCH_FIND_LIMIT 12		// a match may not start in the last 12 bytes
+#define LZ4_MAX_OFFSET 65535
+
+_Static_assert((1 << LZ4_HASH_LOG) == LP_COMPRESS_TABLE_ENTRIES, "LP_COMPRESS_TABLE_ENTRIES must match LZ4_HASH_LOG");
+
+static uint16_t _hashTable[LP_COMPRESS_TABLE_ENTRIES];		// lp_compressLz4, event loop callers
+
+static uint32_t Read32(const uint8_t* p) {
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static uint32_t Hash(uint32_t sequence) {
+	return (sequence * 2654435761U) >> (32 - LZ4_HASH_LOG);
+}
+
+/// <summary>
+///     Writes an LZ4 length continuation, 255 per byte until the remainder
+/// </summary>
+static uint8_t* WriteLength(uint8_t* op, const uint8_t* opEnd, size_t length) {
+	while (length >= 255) {
+		if (op >= opEnd) {
+			return NULL;
+		}
+		*op++ = 255;
+		length -= 255;
+	}
+
+	if (op >= opEnd) {
+		return NULL;
+	}
+	*op++ = (uint8_t)length;
+
+	return op;
+}
+
+/// <summary>
+///     Emits one sequence, the literals from anchor followed by an optional match (matchLength 0 for the final literals)
+/// </summary>
+static uint8_t* WriteSequence(uint8_t* op, const uint8_t* opEnd, const uint8_t* anchor, size_t literalLength, size_t offset, size_t matchLength) {
+	size_t matchCode = matchLength > 0 ? matchLength - LZ4_MIN_MATCH : 0;
+	uint8_t* token = op;
+
+	if (op >= opEnd) {
+		return NULL;
+	}
+
+	*token = (uint8_t)(((literalLength >= 15 ? 15 : literalLength) << 4) | (matchCode >= 15 ? 15 : matchCode));
+	op++;
+
+	if (literalLength >= 15 && (op = WriteLength(op, opEnd, literalLength - 15)) == NULL) {
+		return NULL;
+	}
+
+	if ((size_t)(opEnd - op) < literalLength) {
+		return NULL;
+	}
+	memcpy(op, anchor, literalLength);
+	op += literalLength;
+
+	if (matchLength == 0) {
+		return op;
+	}
+
+	if (opEnd - op < 2) {
+		return NULL;
+	}
+	*op++ = (uint8_t)(offset & 0xff);
+	*op++ = (uint8_t)(offset >> 8);
+
+	if (matchCode >= 15 && (op = WriteLength(op, opEnd, matchCode - 15)) == NULL) {
+		return NULL;
+	}
+
+	return op;
+}
+
+/// <summary>
+///     Worst case compressed size, incompressible input grows by one byte per 255 plus the token
+/// </summary>
+size_t lp_compressBound(size_t length) {
+	return length + length / 255 + 16;
+}
+
+/// <summary>
+///     Compresses source into destination as an LZ4 block.
+///     Returns the compressed length, or 0 if the input is too large or the output does not fit in destinationCapacity
+/// </summary>
+size_t lp_compressLz4(const uint8_t* source, size_t sourceLength, uint8_t* destination, size_t destinationCapacity) {
+	return lp_compressLz4WithTable(source, sourceLength, destination, destinationCapacity, _hashTable);
+}
+
+/// <summary>
+///     lp_compressLz4 with the caller's LP_COMPRESS_TABLE_ENTRIES hash table, for threads other than the event loop
+/// </summary>
+size_t lp_compressLz4WithTable(const uint8_t* source, size_t sourceLength, uint8_t* destination, size_t destinationCapacity, uint16_t* hashTable) {
+	const uint8_t* ip = source;
+	const uint8_t* anchor = source;
+	const uint8_t* end = source + sourceLength;
+	uint8_t* op = destination;
+	const uint8_t* opEnd = destination + destinationCapacity;
+
+	if (source == NULL || destination == NULL || hashTable == NULL || sourceLength > LP_COMPRESS_MAX_INPUT) {
+		return 0;
+	}
+
+	memset(hashTable, 0, LP_COMPRESS_TABLE_ENTRIES * sizeof(uint16_t));
+
+	if (sourceLength > LZ4_MATCH_FIND_LIMIT) {
+		const uint8_t* matchFindEnd = end - LZ4_MATCH_FIND_LIMIT;
+		const uint8_t* matchEnd = end - LZ4_LAST_LITERALS;
+
+		while (ip < matchFindEnd) {
+			uint32_t sequence = Read32(ip);
+			uint32_t h = Hash(sequence);
+			const uint8_t* ref = source + hashTable[h];
+
+			hashTable[h] = (uint16_t)(ip - source);
+
+			if (ref >= ip || ip - ref > LZ4_MAX_OFFSET || Read32(ref) != sequence) {
+				ip++;
+				continue;
+			}
+
+			size_t matchLength = LZ4_MIN_MATCH;
+			while (ip + matchLength < matchEnd && ref[matchLength] == ip[matchLength]) {
+				matchLength++;
+			}
+
+			if ((op = WriteSequence(op, opEnd, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), matchLength)) == NULL) {
+				return 0;
+			}
+
+			ip += matchLength;
+			anchor = ip;
+		}
+	}
+
+	if ((op = WriteSequence(op, opEnd, anchor, (size_t)(end - anchor), 0, 0)) == NULL) {
+		return 0;
+	}
+
+	return (size_t)(op - destination);
+}
+
+/// <summary>
+///     Decompresses an LZ4 block. Returns the decompressed length, or 0 if the block is malformed or does not fit
+/// </summary>
+size_t lp_decompressLz4(const uint8_t* source, size_t sourceLength, uint8_t* destination, size_t destinationCapacity) {
+	const uint8_t* ip = source;
+	const uint8_t* end = source + sourceLength;
+	uint8_t* op = destination;
+	uint8_t* opEnd = destination + destinationCapacity;
+
+	if (source == NULL || destination == NULL) {
+		return 0;
+	}
+
+	while (ip < end) {
+		uint8_t token = *ip++;
+		size_t literalLength = token >> 4;
+		size_t matchLength = token & 0x0f;
+
+		if (literalLength == 15) {
+			uint8_t b;
+			do {
+				if (ip >= end) {
+					return 0;
+				}
+				b = *ip++;
+				literalLength += b;
+			} while (b == 255);
+		}
+
+		if ((size_t)(end - ip) < literalLength || (size_t)(opEnd - op) < literalLength) {
+			return 0;
+		}
+		memcpy(op, ip, literalLength);
+		ip += literalLength;
+		op += literalLength;
+
+		if (ip == end) {
+			break;	// the final sequence carries literals only
+		}
+
+		if (end - ip < 2) {
+			return 0;
+		}
+		size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+		ip += 2;
+
+		if (offset == 0 || offset > (size_t)(op - destination)) {
+			return 0;
+		}
+
+		if (matchLength == 15) {
+			uint8_t b;
+			do {
+				if (ip >= end) {
+					return 0;
+				}
+				b = *ip++;
+				matchLength += b;
+			} while (b == 255);
+		}
+		matchLength += LZ4_MIN_MATCH;
+
+		if ((size_t)(opEnd - op) < matchLength) {
+			return 0;
+		}
+
+		// byte copy, matches may overlap their own output
+		const uint8_t* match = op - offset;
+		for (size_t i = 0; i < matchLength; i++) {
+			op[i] = match[i];
+		}
+		op += matchLength;
+	}
+
+	return (size_t)(op - destination);
+}
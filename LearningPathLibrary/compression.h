@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LP_COMPRESS_MAX_INPUT 65535		// positions are held in 16 bits, larger payloads are sent uncompressed
+#define LP_COMPRESS_TABLE_ENTRIES 4096	// uint16_t hash table entries a compression needs
+
+size_t lp_compressBound(size_t length);
+size_t lp_compressLz4(const uint8_t* source, size_t sourceLength, uint8_t* destination, size_t destinationCapacity);
+size_t lp_compressLz4WithTable(const uint8_t* source, size_t sourceLength, uint8_t* destination, size_t destinationCapacity, uint16_t* hashTable);
+size_t lp_decompressLz4(const uint8_t* source, size_t sourceLength, uint8_t* destination, size_t destinationCapacity);
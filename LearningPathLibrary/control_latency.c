@@ -0,0 +1,137 @@
+#include "control_latency.h"
+
+typedef struct {
+	const char* property;			// NULL for a free slot
+	LP_INTER_CORE_CMD cmd;
+	uint32_t version;
+	uint64_t receivedUtcMs;
+	uint32_t dispatchUs;
+} LP_CONTROL_TRACE;
+
+static const char* _reportedProperty = NULL;
+static uint32_t _receivedUs = 0;			// the desired update being applied
+static uint32_t _receivedVersion = 0;
+static uint64_t _receivedUtcMs = 0;
+static LP_CONTROL_TRACE _traces[LP_CONTROL_MAX_TRACES];	// awaiting the real-time app's answer
+
+/// <summary>
+///     Benchmark mode on, reports under reportedProperty, NULL turns it off
+/// </summary>
+void lp_enableControlLatency(const char* reportedProperty) {
+	_reportedProperty = reportedProperty;
+	_receivedUs = 0;
+	memset(_traces, 0, sizeof(_traces));
+}
+
+bool lp_controlLatencyEnabled(void) {
+	return _reportedProperty != NULL;
+}
+
+uint32_t lp_controlLatencyNow(void) {
+	return _reportedProperty != NULL ? lp_interCoreTraceClockUs() : 0;
+}
+
+/// <summary>
+///     The desired update lp_twinCallback was called with at receivedUs, dated in UTC for the hub's timestamps,
+///     0 once it is applied so controls from elsewhere, a button, are not taken for it
+/// </summary>
+void lp_controlLatencyReceived(uint32_t receivedUs, uint32_t desiredVersion) {
+	struct timespec now;
+
+	_receivedUs = receivedUs;
+	if (receivedUs == 0 || _reportedProperty == NULL) {
+		return;
+	}
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	_receivedVersion = desiredVersion;
+	_receivedUtcMs = (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000 - (lp_interCoreTraceClockUs() - receivedUs) / 1000;
+}
+
+static void Report(const char* property, const char* report) {
+	char path[LP_CONTROL_REPORT_SIZE];
+
+	if (snprintf(path, sizeof(path), "%s.%s", _reportedProperty, property) >= (int)sizeof(path) || !lp_reportedDocumentSetString(path, report)) {
+		LP_LOG(LP_LOG_WARNING, "Control latency of %s not reported\n", property);
+	}
+}
+
+void lp_controlLatencyActuated(const char* property) {
+	char report[LP_CONTROL_REPORT_SIZE];
+
+	if (_reportedProperty == NULL || _receivedUs == 0 || property == NULL) {
+		return;
+	}
+
+	snprintf(report, sizeof(report), "v=%u;received=%llu;dispatch=%u", _receivedVersion, (unsigned long long)_receivedUtcMs,
+		lp_interCoreTraceClockUs() - _receivedUs);
+	Report(property, report);
+}
+
+/// <summary>
+///     The real-time app's answer, its trailer splits the round trip into its share and the transport both ways
+/// </summary>
+static void ControlResponseHandler(LP_INTER_CORE_BLOCK* response, bool timedOut) {
+	char report[LP_CONTROL_REPORT_SIZE];
+	LP_CONTROL_TRACE* trace = NULL;
+	uint32_t transportUs;
+	int length;
+
+	for (int i = 0; i < LP_CONTROL_MAX_TRACES; i++) {
+		if (_traces[i].property != NULL && _traces[i].cmd == response->cmd) {
+			trace = &_traces[i];
+			break;
+		}
+	}
+
+	if (trace == NULL) {
+		return;		// benchmark mode turned off meanwhile
+	}
+
+	length = snprintf(report, sizeof(report), "v=%u;received=%llu;dispatch=%u", trace->version, (unsigned long long)trace->receivedUtcMs,
+		trace->dispatchUs);
+
+	if (timedOut || !response->traced) {
+		snprintf(report + length, sizeof(report) - (size_t)length, ";timeout=1");
+	}
+	else {
+		transportUs = response->traceRoundTripUs > response->traceWaitUs + response->traceSampleUs ?
+			(response->traceRoundTripUs - response->traceWaitUs - response->traceSampleUs) / 2 : 0;
+		snprintf(report + length, sizeof(report) - (size_t)length, ";transport=%u;actuate=%u;ack=%u", transportUs, response->traceWaitUs,
+			response->traceSampleUs + transportUs);
+	}
+
+	Report(trace->property, report);
+	trace->property = NULL;
+}
+
+bool lp_controlLatencyRequest(const char* property, LP_INTER_CORE_BLOCK* request) {
+	LP_CONTROL_TRACE* trace = NULL;
+
+	if (_reportedProperty == NULL || _receivedUs == 0 || property == NULL || request == NULL) {
+		return false;
+	}
+
+	for (int i = 0; i < LP_CONTROL_MAX_TRACES; i++) {
+		if (_traces[i].property == NULL) {
+			trace = &_traces[i];
+			break;
+		}
+	}
+
+	if (trace == NULL) {
+		return false;
+	}
+
+	*trace = (LP_CONTROL_TRACE){ .property = property, .cmd = request->cmd, .version = _receivedVersion, .receivedUtcMs = _receivedUtcMs,
+		.dispatchUs = lp_interCoreTraceClockUs() - _receivedUs };
+
+	request->traced = 1;
+	if (!lp_interCoreRequest(request, LP_CONTROL_TIMEOUT_MS, ControlResponseHandler)) {
+		request->traced = 0;
+		trace->property = NULL;
+		return false;
+	}
+
+	return true;
+}
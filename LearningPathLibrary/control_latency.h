@@ -0,0 +1,43 @@
+#pragma once
+
+#include "device_twins.h"
+#include "inter_core.h"
+#include "logging.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define LP_CONTROL_MAX_TRACES 4				// controls of one desired update traced at once, more are not traced
+#define LP_CONTROL_REPORT_SIZE 160
+#define LP_CONTROL_TIMEOUT_MS 2000			// for the real-time app's answer, an app that does not answer reports timeout=1
+
+// Cloud to actuator latency benchmark. With a reported property named, every desired update lp_twinCallback
+// receives is stamped, and each control the app hands on within it is reported as a string at
+// <reportedProperty>.<property>, in microseconds:
+//
+//   v=12;received=1760000000123;dispatch=850                                       actuated by the A7, lp_controlLatencyActuated
+//   v=12;received=1760000000123;dispatch=900;transport=140;actuate=35;ack=160      by the real-time app, lp_controlLatencyRequest
+//
+//   v           the desired $version the control came in
+//   received    device UTC milliseconds lp_twinCallback was called, against the hub's desired $lastUpdated this is
+//               IoT Hub and the DoWork cadence, and only as good as the device clock
+//   dispatch    lp_twinCallback to the actuator written, or to the inter-core request sent: parse, handler and commit
+//   transport   one way inter-core, half the request round trip less the real-time app's share, its polling included
+//   actuate     the request arriving on the real-time app to the control applied, CONTROL_PROBE_PIN toggled then
+//   ack         applied to the answer decoded here
+//
+// tools/device-twin-test/dt_latency.py drives the changes and collects the distributions. With no reported property
+// the stamps cost a branch, and lp_controlLatencyRequest returns false so the app sends the control as it would.
+void lp_enableControlLatency(const char* reportedProperty);
+bool lp_controlLatencyEnabled(void);
+// the control for property was written by this core, call straight after the GPIO write
+void lp_controlLatencyActuated(const char* property);
+// send the control as a traced request the real-time app answers once applied, false when not benchmarking or it
+// could not be sent, the app then sends it as usual
+bool lp_controlLatencyRequest(const char* property, LP_INTER_CORE_BLOCK* request);
+
+// for lp_twinCallback, lp_controlLatencyNow is 0 when not benchmarking and lp_controlLatencyReceived then does nothing
+uint32_t lp_controlLatencyNow(void);
+void lp_controlLatencyReceived(uint32_t receivedUs, uint32_t desiredVersion);
@@ -0,0 +1,284 @@
+#include "coroutine.h"
+
+static void CoroutineTimerHandler(EventLoopTimer* eventLoopTimer);
+
+static LP_COROUTINE* _coroutines = NULL;		// running, waiting on an await
+
+static LP_TIMER coroutineTimer = {
+	.period = { 0, 0 },			// one-shot timer, armed for the nearest deadline of the running coroutines
+	.name = "coroutineTimer",
+	.handler = &CoroutineTimerHandler
+};
+
+static struct timespec AfterMs(int ms) {
+	struct timespec at;
+
+	clock_gettime(CLOCK_MONOTONIC, &at);
+	ms = ms < 0 ? 0 : ms;
+	at.tv_sec += ms / 1000;
+	at.tv_nsec += (ms % 1000) * 1000000;
+	if (at.tv_nsec >= 1000000000) {
+		at.tv_sec++;
+		at.tv_nsec -= 1000000000;
+	}
+	return at;
+}
+
+static bool IsDue(const struct timespec* at, const struct timespec* now) {
+	return at->tv_sec < now->tv_sec || (at->tv_sec == now->tv_sec && at->tv_nsec <= now->tv_nsec);
+}
+
+/// <summary>
+///     Arm the shared timer for the nearest deadline, disarm it when no coroutine has one
+/// </summary>
+static void ArmCoroutineTimer(void) {
+	const struct timespec* nearest = NULL;
+	struct timespec now, delay;
+
+	for (LP_COROUTINE* coroutine = _coroutines; coroutine != NULL; coroutine = coroutine->next) {
+		if (coroutine->hasDeadline && (nearest == NULL || !IsDue(nearest, &coroutine->deadline))) {
+			nearest = &coroutine->deadline;
+		}
+	}
+
+	if (nearest == NULL) {
+		if (coroutineTimer.eventLoopTimer != NULL) {
+			lp_changeTimer(&coroutineTimer, &(struct timespec){0, 0});
+		}
+		return;
+	}
+
+	if (coroutineTimer.eventLoopTimer == NULL && !lp_startTimer(&coroutineTimer)) {
+		return;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	delay = (struct timespec){ 0, 1 };		// due already, run on the next event loop pass
+	if (!IsDue(nearest, &now)) {
+		delay.tv_sec = nearest->tv_sec - now.tv_sec;
+		delay.tv_nsec = nearest->tv_nsec - now.tv_nsec;
+		if (delay.tv_nsec < 0) {
+			delay.tv_sec--;
+			delay.tv_nsec += 1000000000;
+		}
+	}
+
+	lp_setOneShotTimer(&coroutineTimer, &delay);
+}
+
+static void Unlink(LP_COROUTINE* coroutine) {
+	for (LP_COROUTINE** link = &_coroutines; *link != NULL; link = &(*link)->next) {
+		if (*link == coroutine) {
+			*link = coroutine->next;
+			break;
+		}
+	}
+	coroutine->next = NULL;
+	coroutine->running = false;
+}
+
+static void ClearWait(LP_COROUTINE* coroutine) {
+	if (coroutine->ioRegistration != NULL) {
+		EventLoop_UnregisterIo(lp_getTimerEventLoop(), coroutine->ioRegistration);
+		coroutine->ioRegistration = NULL;
+	}
+	coroutine->wait = LP_COROUTINE_WAIT_NONE;
+	coroutine->hasDeadline = false;
+}
+
+/// <summary>
+///     Run the coroutine from where it waits to its next await or its end
+/// </summary>
+static void Step(LP_COROUTINE* coroutine) {
+	LP_COROUTINE_STATUS status;
+
+	ClearWait(coroutine);
+	status = coroutine->run(coroutine);
+
+	if (!coroutine->running) {
+		return;		// stopped from inside run
+	}
+
+	if (status == LP_COROUTINE_DONE) {
+		ClearWait(coroutine);
+		coroutine->resumeAt = 0;
+		Unlink(coroutine);
+	}
+}
+
+bool lp_startCoroutine(LP_COROUTINE* coroutine) {
+	if (coroutine == NULL || coroutine->run == NULL || coroutine->running) {
+		return false;
+	}
+
+	coroutine->resumeAt = 0;
+	coroutine->timedOut = false;
+	coroutine->ioEvents = 0;
+	coroutine->wait = LP_COROUTINE_WAIT_NONE;
+	coroutine->hasDeadline = false;
+	coroutine->ioRegistration = NULL;
+	coroutine->running = true;
+	coroutine->next = _coroutines;
+	_coroutines = coroutine;
+
+	Step(coroutine);
+	ArmCoroutineTimer();
+
+	return true;
+}
+
+void lp_stopCoroutine(LP_COROUTINE* coroutine) {
+	if (coroutine == NULL || !coroutine->running) {
+		return;
+	}
+
+	ClearWait(coroutine);
+	coroutine->resumeAt = 0;
+	Unlink(coroutine);
+	ArmCoroutineTimer();
+}
+
+bool lp_isCoroutineRunning(const LP_COROUTINE* coroutine) {
+	return coroutine != NULL && coroutine->running;
+}
+
+/// <summary>
+///     Stop every running coroutine and the shared timer, called when shutting down
+/// </summary>
+void lp_stopCoroutines(void) {
+	while (_coroutines != NULL) {
+		LP_COROUTINE* coroutine = _coroutines;
+
+		ClearWait(coroutine);
+		coroutine->resumeAt = 0;
+		Unlink(coroutine);
+	}
+
+	if (coroutineTimer.eventLoopTimer != NULL) {
+		lp_stopTimer(&coroutineTimer);
+	}
+}
+
+static void ResumeAcked(void* context) {
+	LP_COROUTINE* coroutine = (LP_COROUTINE*)context;
+
+	if (coroutine->running && coroutine->wait == LP_COROUTINE_WAIT_RESUMING) {
+		Step(coroutine);
+		ArmCoroutineTimer();
+	}
+}
+
+bool lp_ackCoroutine(LP_COROUTINE* coroutine) {
+	if (coroutine == NULL || !coroutine->running || coroutine->wait != LP_COROUTINE_WAIT_ACK) {
+		return false;
+	}
+
+	coroutine->timedOut = false;
+	coroutine->wait = LP_COROUTINE_WAIT_RESUMING;
+	coroutine->hasDeadline = false;
+	lp_deferWork(ResumeAcked, coroutine);		// not from inside the caller, which may be mid way through its own state
+
+	return true;
+}
+
+void lp_coroutineWaitMs(LP_COROUTINE* coroutine, int ms) {
+	coroutine->wait = LP_COROUTINE_WAIT_TIME;
+	coroutine->deadline = AfterMs(ms);
+	coroutine->hasDeadline = true;
+}
+
+static void CoroutineIoHandler(EventLoop* el, int fd, EventLoop_IoEvents events, void* context) {
+	LP_COROUTINE* coroutine = (LP_COROUTINE*)context;
+
+	if (!coroutine->running || coroutine->wait != LP_COROUTINE_WAIT_IO) {
+		return;
+	}
+
+	coroutine->timedOut = false;
+	coroutine->ioEvents = events;
+	Step(coroutine);
+	ArmCoroutineTimer();
+}
+
+bool lp_coroutineWaitIo(LP_COROUTINE* coroutine, int fd, EventLoop_IoEvents events, int timeoutMs) {
+	coroutine->ioEvents = 0;
+	coroutine->ioRegistration = EventLoop_RegisterIo(lp_getTimerEventLoop(), fd, events, CoroutineIoHandler, coroutine);
+	if (coroutine->ioRegistration == NULL) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: coroutine '%s' could not wait on fd %d\n", coroutine->name != NULL ? coroutine->name : "", fd);
+		coroutine->timedOut = true;
+		return false;
+	}
+
+	coroutine->wait = LP_COROUTINE_WAIT_IO;
+	coroutine->hasDeadline = timeoutMs > 0;
+	if (coroutine->hasDeadline) {
+		coroutine->deadline = AfterMs(timeoutMs);
+	}
+	return true;
+}
+
+void lp_coroutineWaitAck(LP_COROUTINE* coroutine, int timeoutMs) {
+	coroutine->wait = LP_COROUTINE_WAIT_ACK;
+	coroutine->hasDeadline = timeoutMs > 0;
+	if (coroutine->hasDeadline) {
+		coroutine->deadline = AfterMs(timeoutMs);
+	}
+}
+
+void lp_coroutineWaitUntil(LP_COROUTINE* coroutine, int timeoutMs) {
+	coroutine->timedOut = false;
+	coroutine->untilForever = timeoutMs <= 0;
+	coroutine->timeoutAt = AfterMs(timeoutMs);
+}
+
+/// <summary>
+///     LP_AWAIT_UNTIL's condition is false, true to poll again, false with timedOut set once the timeout has passed
+/// </summary>
+bool lp_coroutinePoll(LP_COROUTINE* coroutine) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (!coroutine->untilForever && IsDue(&coroutine->timeoutAt, &now)) {
+		coroutine->timedOut = true;
+		return false;
+	}
+
+	lp_coroutineWaitMs(coroutine, LP_COROUTINE_POLL_MS);
+	if (!coroutine->untilForever && IsDue(&coroutine->timeoutAt, &coroutine->deadline)) {
+		coroutine->deadline = coroutine->timeoutAt;		// the last poll is at the timeout
+	}
+	return true;
+}
+
+/// <summary>
+///     Resume every coroutine whose deadline has passed, the wake up of LP_AWAIT_MS or the timeout of an await
+/// </summary>
+static void CoroutineTimerHandler(EventLoopTimer* eventLoopTimer) {
+	struct timespec now;
+	LP_COROUTINE* coroutine;
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_CoroutineHandler);
+		return;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	// from the head after each step, a step may start or stop coroutines, deadlines it sets are after now
+	do {
+		for (coroutine = _coroutines; coroutine != NULL; coroutine = coroutine->next) {
+			if (coroutine->hasDeadline && IsDue(&coroutine->deadline, &now)) {
+				break;
+			}
+		}
+
+		if (coroutine != NULL) {
+			if (coroutine->wait == LP_COROUTINE_WAIT_IO || coroutine->wait == LP_COROUTINE_WAIT_ACK) {
+				coroutine->timedOut = true;
+			}
+			Step(coroutine);
+		}
+	} while (coroutine != NULL);
+
+	ArmCoroutineTimer();
+}
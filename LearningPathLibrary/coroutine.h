@@ -0,0 +1,101 @@
+#pragma once
+
+#include "deferred_work.h"
+#include "logging.h"
+#include "terminate.h"
+#include "timer.h"
+#include <applibs/eventloop.h>
+#include <stdbool.h>
+#include <time.h>
+
+#define LP_COROUTINE_POLL_MS 50		// how often LP_AWAIT_UNTIL tests its condition
+
+typedef enum {
+	LP_COROUTINE_WAITING,
+	LP_COROUTINE_DONE
+} LP_COROUTINE_STATUS;
+
+typedef enum {
+	LP_COROUTINE_WAIT_NONE = 0,
+	LP_COROUTINE_WAIT_TIME,			// LP_AWAIT_MS and the LP_AWAIT_UNTIL polls
+	LP_COROUTINE_WAIT_IO,
+	LP_COROUTINE_WAIT_ACK,
+	LP_COROUTINE_WAIT_RESUMING		// acknowledged, the resume is deferred to the event loop
+} LP_COROUTINE_WAIT;
+
+typedef struct LP_COROUTINE {
+	LP_COROUTINE_STATUS (*run)(struct LP_COROUTINE* coroutine);
+	void* context;					// optional, the flow's state, locals of run do not survive an await
+	const char* name;
+	bool timedOut;					// read only, set by the last LP_AWAIT_IO, LP_AWAIT_ACK or LP_AWAIT_UNTIL
+	EventLoop_IoEvents ioEvents;	// read only, the events the last LP_AWAIT_IO resumed on
+	int resumeAt;					// internal, the line of the await run resumes at, 0 from the top
+	LP_COROUTINE_WAIT wait;			// internal
+	bool hasDeadline;
+	struct timespec deadline;		// CLOCK_MONOTONIC, the wake up or the timeout
+	struct timespec timeoutAt;		// LP_AWAIT_UNTIL's timeout, the deadline is its next poll
+	bool untilForever;
+	EventRegistration* ioRegistration;
+	bool running;
+	struct LP_COROUTINE* next;
+} LP_COROUTINE;
+
+// Stackless coroutines, protothreads, for multi-step flows on the event loop that would otherwise block it or be
+// split across one-shot timers, start a conversion, wait, read, report, or report, wait for the ack, reboot. run is
+// written top to bottom between LP_COROUTINE_BEGIN and LP_COROUTINE_END and each await returns to the event loop,
+// run is called again from the await once its wait is over:
+//
+//   static LP_COROUTINE_STATUS MeasureFlow(LP_COROUTINE* coroutine)
+//   {
+//       LP_COROUTINE_BEGIN(coroutine);
+//       StartConversion();
+//       LP_AWAIT_MS(coroutine, 20);
+//       ReadConversion();
+//       LP_AWAIT_ACK(coroutine, 5000);          // lp_ackCoroutine from the reply handler
+//       if (coroutine->timedOut) { LP_COROUTINE_EXIT(coroutine); }
+//       LP_COROUTINE_END(coroutine);
+//   }
+//   static LP_COROUTINE measureFlow = { .run = MeasureFlow, .name = "measureFlow" };
+//   lp_startCoroutine(&measureFlow);
+//
+// The resume point is a switch case, so locals of run are lost at each await, keep state in context or statics,
+// put at most one await on a line and no await inside a switch of run's own. Running coroutines share one library
+// timer armed for the nearest deadline, starting one never allocates. Event loop thread only.
+#define LP_COROUTINE_BEGIN(_co) switch ((_co)->resumeAt) { case 0:
+#define LP_COROUTINE_END(_co) } (_co)->resumeAt = 0; return LP_COROUTINE_DONE
+#define LP_COROUTINE_EXIT(_co) do { (_co)->resumeAt = 0; return LP_COROUTINE_DONE; } while (0)
+
+// resume once _ms milliseconds have passed
+#define LP_AWAIT_MS(_co, _ms) \
+	do { lp_coroutineWaitMs((_co), (_ms)); (_co)->resumeAt = __LINE__; return LP_COROUTINE_WAITING; case __LINE__:; } while (0)
+
+// resume when _fd is ready for _events, EventLoop_Input or EventLoop_Output, or after _timeoutMs, 0 waits for ever.
+// timedOut is also set, without waiting, when the fd could not be registered
+#define LP_AWAIT_IO(_co, _fd, _events, _timeoutMs) \
+	do { if (!lp_coroutineWaitIo((_co), (_fd), (_events), (_timeoutMs))) { break; } (_co)->resumeAt = __LINE__; \
+		return LP_COROUTINE_WAITING; case __LINE__:; } while (0)
+
+// resume when lp_ackCoroutine is called, from a reply or a confirmation callback, or after _timeoutMs, 0 waits for ever
+#define LP_AWAIT_ACK(_co, _timeoutMs) \
+	do { lp_coroutineWaitAck((_co), (_timeoutMs)); (_co)->resumeAt = __LINE__; return LP_COROUTINE_WAITING; case __LINE__:; } while (0)
+
+// resume once _condition holds, tested now and every LP_COROUTINE_POLL_MS, or after _timeoutMs, 0 waits for ever
+#define LP_AWAIT_UNTIL(_co, _condition, _timeoutMs) \
+	do { lp_coroutineWaitUntil((_co), (_timeoutMs)); (_co)->resumeAt = __LINE__; case __LINE__: \
+		if (!(_condition) && lp_coroutinePoll(_co)) { return LP_COROUTINE_WAITING; } } while (0)
+
+// false when the coroutine is already running, otherwise run is called straight away up to its first await
+bool lp_startCoroutine(LP_COROUTINE* coroutine);
+// abandons the flow where it waits, the next start runs it from the top
+void lp_stopCoroutine(LP_COROUTINE* coroutine);
+bool lp_isCoroutineRunning(const LP_COROUTINE* coroutine);
+// ends an LP_AWAIT_ACK, the coroutine resumes after the caller returns, false when it was not waiting for one
+bool lp_ackCoroutine(LP_COROUTINE* coroutine);
+void lp_stopCoroutines(void);
+
+// used by the await macros
+void lp_coroutineWaitMs(LP_COROUTINE* coroutine, int ms);
+bool lp_coroutineWaitIo(LP_COROUTINE* coroutine, int fd, EventLoop_IoEvents events, int timeoutMs);
+void lp_coroutineWaitAck(LP_COROUTINE* coroutine, int timeoutMs);
+void lp_coroutineWaitUntil(LP_COROUTINE* coroutine, int timeoutMs);
+bool lp_coroutinePoll(LP_COROUTINE* coroutine);
@@ -0,0 +1,137 @@
+#include "deferred_work.h"
+
+typedef struct
+{
+	LP_DEFERRED_WORK_HANDLER handler;
+	void* context;			// caller context, or data for lp_deferWorkCopy
+	uint8_t data[LP_DEFERRED_WORK_DATA_SIZE] __attribute__((aligned(8)));
+	bool copied;
+} LP_DEFERRED_WORK;
+
+static void DeferredWorkHandler(EventLoopTimer* eventLoopTimer);
+
+// ring of work drained from the event loop, bulk work queued from I/O callbacks runs after they return
+static LP_DEFERRED_WORK _workQueue[LP_DEFERRED_WORK_QUEUE_SIZE];
+static size_t _workHead = 0;
+static size_t _workCount = 0;
+static LP_DEFERRED_WORK_STATS _workStats = { 0, 0, 0, 0, 0 };
+
+static LP_TIMER deferredWorkTimer = {
+	.period = { 0, 0 },			// one-shot timer, armed to the next event loop iteration while work is queued
+	.name = "deferredWorkTimer",
+	.handler = &DeferredWorkHandler
+};
+
+static void ScheduleDrain(void) {
+	if (deferredWorkTimer.eventLoopTimer == NULL) {
+		lp_startTimer(&deferredWorkTimer);
+	}
+	lp_setOneShotTimer(&deferredWorkTimer, &(struct timespec){0, 1});
+}
+
+static LP_DEFERRED_WORK* EnqueueWork(LP_DEFERRED_WORK_HANDLER handler) {
+	LP_DEFERRED_WORK* work;
+
+	if (_workCount == LP_DEFERRED_WORK_QUEUE_SIZE) {
+		_workStats.ranInline++;
+		return NULL;
+	}
+
+	work = &_workQueue[(_workHead + _workCount) % LP_DEFERRED_WORK_QUEUE_SIZE];
+	work->handler = handler;
+
+	if (_workCount++ == 0) {
+		ScheduleDrain();
+	}
+
+	_workStats.queued++;
+	if (_workCount > _workStats.highWater) {
+		_workStats.highWater = _workCount;
+	}
+
+	return work;
+}
+
+/// <summary>
+///     Queue handler(context) to run from the event loop after the current callback returns.
+///     Returns false if the queue was full and the work ran inline.
+/// </summary>
+bool lp_deferWork(LP_DEFERRED_WORK_HANDLER handler, void* context) {
+	LP_DEFERRED_WORK* work = EnqueueWork(handler);
+
+	if (work == NULL) {
+		handler(context);
+		return false;
+	}
+
+	work->context = context;
+	work->copied = false;
+	return true;
+}
+
+/// <summary>
+///     Queue handler with a copy of up to LP_DEFERRED_WORK_DATA_SIZE bytes of data, the handler receives the copy.
+///     Returns false if the data was too large or the queue was full and the work ran inline.
+/// </summary>
+bool lp_deferWorkCopy(LP_DEFERRED_WORK_HANDLER handler, const void* data, size_t size) {
+	LP_DEFERRED_WORK* work = size <= LP_DEFERRED_WORK_DATA_SIZE ? EnqueueWork(handler) : NULL;
+
+	if (work == NULL) {
+		handler((void*)data);
+		return false;
+	}
+
+	memcpy(work->data, data, size);
+	work->copied = true;
+	return true;
+}
+
+/// <summary>
+///     Drop queued work without running it, called when shutting down
+/// </summary>
+void lp_cancelDeferredWork(void) {
+	_workHead = 0;
+	_workCount = 0;
+
+	if (deferredWorkTimer.eventLoopTimer != NULL) {
+		lp_stopTimer(&deferredWorkTimer);
+	}
+}
+
+void lp_getDeferredWorkStats(LP_DEFERRED_WORK_STATS* stats) {
+	*stats = _workStats;
+}
+
+static int64_t MonotonicMs(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/// <summary>
+///     Run queued work until the queue is empty or the budget is spent, then yield to other events
+/// </summary>
+static void DeferredWorkHandler(EventLoopTimer* eventLoopTimer) {
+	int64_t deadline = MonotonicMs() + LP_DEFERRED_WORK_BUDGET_MS;
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_DeferredWorkHandler);
+		return;
+	}
+
+	while (_workCount > 0) {
+		LP_DEFERRED_WORK work = _workQueue[_workHead];	// copied out, the handler may queue more work
+
+		_workHead = (_workHead + 1) % LP_DEFERRED_WORK_QUEUE_SIZE;
+		_workCount--;
+		_workStats.executed++;
+
+		work.handler(work.copied ? (void*)work.data : work.context);
+
+		if (_workCount > 0 && MonotonicMs() >= deadline) {
+			_workStats.yields++;
+			ScheduleDrain();
+			return;
+		}
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "terminate.h"
+#include "timer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define LP_DEFERRED_WORK_QUEUE_SIZE 32		// queued work items, lp_deferWork runs the work inline when full
+#define LP_DEFERRED_WORK_DATA_SIZE 144		// bytes lp_deferWorkCopy can copy with a work item, room for an LP_INTER_CORE_BLOCK
+#define LP_DEFERRED_WORK_BUDGET_MS 5		// event loop time one drain may use before yielding to other events
+
+typedef void (*LP_DEFERRED_WORK_HANDLER)(void* context);
+
+typedef struct LP_DEFERRED_WORK_STATS
+{
+	unsigned int queued;
+	unsigned int executed;
+	unsigned int ranInline;		// the queue was full so the caller ran the work
+	unsigned int yields;		// drains that hit the time budget with work left over
+	size_t highWater;			// deepest the queue has been
+} LP_DEFERRED_WORK_STATS;
+
+bool lp_deferWork(LP_DEFERRED_WORK_HANDLER handler, void* context);
+bool lp_deferWorkCopy(LP_DEFERRED_WORK_HANDLER handler, const void* data, size_t size);
+void lp_cancelDeferredWork(void);
+void lp_getDeferredWorkStats(LP_DEFERRED_WORK_STATS* stats);
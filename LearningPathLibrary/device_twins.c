@@ -1,58 +1,410 @@
 #include "device_twins.h"
+#include "control_latency.h"
+#include "event_trace.h"
+#include "rate_limit.h"
 
-static void SetDesiredState(JSON_Object* desiredProperties, LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
-static bool DeviceTwinUpdateReportedState(char* reportedPropertiesString);
+static bool SetDesiredState(JSON_Object* desiredProperties, LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+static bool ApplyDesiredState(JSON_Object* desiredProperties, LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+static bool DeviceTwinUpdateReportedState(char* reportedPropertiesString, uint32_t sequence);
+static size_t TwinStateSize(LP_DEVICE_TWIN_TYPE twinType);
+static void ReportedStateFlushHandler(EventLoopTimer* eventLoopTimer);
+static void LoadTwinCache(void);
+static void SaveTwinCache(void);
+static bool SetReportedValue(LP_DEVICE_TWIN_BINDING* deviceTwinBinding, void* state);
+static void ArmReportedStateFlush(int delayMs);
+static bool QueueWritableAcks(void);
 
 
+// interned in parson so the {"value":..} captured for every desired property references the key rather than
+// allocating a copy, the bound property names join them when a set is opened
+static const char _valueKey[] = "value";
+static const char* const _twinKeys[] = { "desired", "reported", "$version", _valueKey };
+static JSON_Path* _valuePath = NULL;		// every desired update of every binding looks the value up
+
 static LP_DEVICE_TWIN_BINDING** _deviceTwins = NULL;
 static size_t _deviceTwinCount = 0;
 
+#define LP_REPORT_STRING_RESERVE 64		// scratch buffer allowance per string property
+#define LP_REPORT_ACK_RESERVE 64		// and per property for a writable property acknowledgement
+#define LP_ACK_COMPLETED 200
+static LP_DEVICE_TWIN_BINDING** _deviceTwinIndex = NULL;
+static char* _reportScratch = NULL;
+static size_t _reportScratchSize = 0;
+static size_t _deviceTwinIndexCount = 0;
+static bool _deviceTwinIndexOwned = false;		// false when the set was already sorted and is its own index
+static double _desiredVersion = 0;
+static bool _desiredVersionValid = false;
+
+typedef struct {
+	LP_DEVICE_TWIN_BINDING* binding;
+	JSON_Value* value;
+} LP_DESIRED_CAPTURE;
+
+// desired values captured by the streaming parse, applied once the document $version is known
+static LP_DESIRED_CAPTURE* _desiredCaptures = NULL;
+static size_t _desiredCaptureCount = 0;
+
+// the bindings an update changed, passed to the commit handler once they are all applied
+static LP_DEVICE_TWIN_BINDING** _desiredChanged = NULL;
+static size_t _desiredChangedCount = 0;
+static void (*_commitHandler)(LP_DEVICE_TWIN_BINDING* changed[], size_t changedCount) = NULL;
+static bool _applyingDesired = false;		// immediate reports are held for one document after the commit
+static bool _reportAfterCommit = false;
+static bool _writableAcks = false;
+static uint32_t _applyingVersion = 0;		// desired $version of the update being applied, 0 without one
+
+typedef struct {
+	DEVICE_TWIN_UPDATE_STATE updateState;
+	size_t desiredDepth;		// 1 for a desired patch, 2 for the desired section of a full twin
+	bool versionValid;
+	double version;
+} LP_TWIN_DISPATCH;
+
+#define LP_TWIN_CACHE_MAGIC 0x4C505457		// "LPTW"
+
+typedef struct {
+	uint32_t magic;
+	uint32_t length;		// desired patch text that follows the header
+	uint32_t hash;			// of the text, a torn write is ignored rather than applied
+} TWIN_CACHE_HEADER;
+
+static bool _twinCacheEnabled = false;
+static int _twinCacheFd = -1;
+static bool _twinCacheLoading = false;		// applying the cache, so it is not written back
+static bool _twinCacheDirty = false;		// a desired value or the $version changed since the cache was written
+
+static int _reportedStateFlushIntervalMs = 0;
+static bool _reportedStateFlushArmed = false;
+
+#define LP_REPORT_RETRY_MIN_MS 1000			// first retry after a refused report, doubling while refusals continue
+#define LP_REPORT_RETRY_MAX_MS 60000
+static uint32_t _reportSequence = 0;		// numbers the documents sent, 0 is the untracked diagnostics reports
+static int _reportRetryMs = 0;				// zero while reports are being accepted
+static struct timespec _reportRetryAt;
+static LP_DEVICE_TWIN_STATS _twinStats;
+
+#define LP_REPORTED_PATH_MAX 128			// longest dotted path tracked, a change deeper down marks its parent
+#define LP_REPORT_DOCUMENT_DELAY_MS 10		// with no flush interval, sets made together go in one document
+
+typedef struct {
+	char* path;
+	size_t capacity;			// grow only, a slot keeps its buffer for the next path
+	bool pending;				// changed since it was last sent
+	uint32_t sequence;			// the document carrying it while in flight, 0 otherwise
+} LP_REPORTED_PATH;
+
+// the reported document and the paths changed in it that are not acknowledged yet
+static JSON_Value* _reportedDocument = NULL;
+static LP_REPORTED_PATH* _reportedPaths = NULL;
+static size_t _reportedPathCount = 0;
+static size_t _reportedPathCapacity = 0;
+
+static LP_TIMER reportedStateFlushTimer = {
+	.period = { 0, 0 },			// one-shot timer, armed by the first dirty binding
+	.name = "reportedStateFlushTimer",
+	.handler = &ReportedStateFlushHandler
+};
+
+
+static int CompareBindingProperty(const void* a, const void* b) {
+	return strcmp((*(LP_DEVICE_TWIN_BINDING* const*)a)->twinProperty, (*(LP_DEVICE_TWIN_BINDING* const*)b)->twinProperty);
+}
+
+static bool IsSortedByProperty(LP_DEVICE_TWIN_BINDING* deviceTwins[], size_t deviceTwinCount) {
+	for (size_t i = 1; i < deviceTwinCount; i++) {
+		if (strcmp(deviceTwins[i - 1]->twinProperty, deviceTwins[i]->twinProperty) > 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+///     Orders a length delimited member name against a null terminated property name
+/// </summary>
+static int CompareName(const char* name, size_t length, const char* twinProperty) {
+	int cmp = strncmp(name, twinProperty, length);
+	if (cmp == 0 && twinProperty[length] != 0) {
+		return -1; // name is a prefix of the property
+	}
+	return cmp;
+}
+
+/// <summary>
+///     Binary search the sorted binding index for a desired property name
+/// </summary>
+static LP_DEVICE_TWIN_BINDING* FindDeviceTwin(const char* twinProperty, size_t length) {
+	size_t low = 0;
+	size_t high = _deviceTwinIndexCount;
+
+	if (_deviceTwinIndex == NULL) {
+		// index allocation failed, fall back to a linear scan
+		for (size_t i = 0; i < _deviceTwinCount; i++) {
+			if (CompareName(twinProperty, length, _deviceTwins[i]->twinProperty) == 0) {
+				return _deviceTwins[i];
+			}
+		}
+		return NULL;
+	}
+
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+		int cmp = CompareName(twinProperty, length, _deviceTwinIndex[mid]->twinProperty);
+
+		if (cmp == 0) {
+			return _deviceTwinIndex[mid];
+		}
+		if (cmp < 0) {
+			high = mid;
+		} else {
+			low = mid + 1;
+		}
+	}
+
+	return NULL;
+}
+
+/// <summary>
+///     Shutdown hook, once connected flush the dirty bindings and wait for the reports in flight to be acknowledged.
+///     Nothing is persisted, the app reports its state again once it restarts.
+/// </summary>
+static bool DeviceTwinShutdown(bool final) {
+	static bool flushed = false;
+
+	if (final || lp_getConnectionState() != LP_CONNECTION_AUTHENTICATED) {
+		return false;
+	}
+
+	if (!flushed) {
+		flushed = true;
+		lp_flushReportedState();
+	}
+
+	for (size_t i = 0; i < _deviceTwinCount; i++) {
+		if (_deviceTwins[i]->reportState == LP_REPORT_IN_FLIGHT) {
+			return true;
+		}
+	}
+	for (size_t i = 0; i < _reportedPathCount; i++) {
+		if (_reportedPaths[i].sequence != 0) {
+			return true;
+		}
+	}
+	return false;
+}
 
 void lp_openDeviceTwinSet(LP_DEVICE_TWIN_BINDING* deviceTwins[], size_t deviceTwinCount) {
+	lp_addShutdownHook(DeviceTwinShutdown);
+
 	_deviceTwins = deviceTwins;
 	_deviceTwinCount = deviceTwinCount;
 
+	_reportScratchSize = 3; // braces and NULL termination
+	json_intern_keys(_twinKeys, sizeof(_twinKeys) / sizeof(_twinKeys[0]));
+	if (_valuePath == NULL) {
+		_valuePath = json_path_compile(_valueKey);
+	}
+
 	for (int i = 0; i < _deviceTwinCount; i++) {
 		lp_openDeviceTwin(_deviceTwins[i]);
+		json_intern_keys(&_deviceTwins[i]->twinProperty, 1);	// past JSON_INTERN_CAPACITY names are copied as before
+		_reportScratchSize += strlen(_deviceTwins[i]->twinProperty) + 6 +
+			(_deviceTwins[i]->twinType == LP_TYPE_STRING ? LP_REPORT_STRING_RESERVE : 20) + (_writableAcks ? LP_REPORT_ACK_RESERVE : 0);
+	}
+
+	// reported documents are serialised here, only a document with unusually long strings needs a heap buffer
+	_reportScratch = (char*)lp_heapMalloc(LP_HEAP_TWINS, _reportScratchSize);
+	if (_reportScratch == NULL) {
+		_reportScratchSize = 0;
+	}
+
+	// sorted by property name so each desired key resolves to its binding with a binary search, a set declared
+	// in name order, see LP_DEVICE_TWIN_TABLE, is searched in place
+	_deviceTwinIndexCount = 0;
+	_deviceTwinIndexOwned = false;
+	if (deviceTwinCount == 0) {
+		_deviceTwinIndex = NULL;
+		return;
+	}
+
+	if (IsSortedByProperty(deviceTwins, deviceTwinCount)) {
+		_deviceTwinIndex = deviceTwins;
+	} else {
+		_deviceTwinIndex = (LP_DEVICE_TWIN_BINDING**)lp_heapMalloc(LP_HEAP_TWINS, deviceTwinCount * sizeof(LP_DEVICE_TWIN_BINDING*));
+		if (_deviceTwinIndex == NULL) {
+			return;
+		}
+
+		memcpy(_deviceTwinIndex, deviceTwins, deviceTwinCount * sizeof(LP_DEVICE_TWIN_BINDING*));
+		qsort(_deviceTwinIndex, deviceTwinCount, sizeof(LP_DEVICE_TWIN_BINDING*), CompareBindingProperty);
+		_deviceTwinIndexOwned = true;
+	}
+	_deviceTwinIndexCount = deviceTwinCount;
+
+	// at most one captured value per binding, duplicate desired keys keep the first as the DOM parse did,
+	// the changed list shares the allocation
+	_desiredCaptureCount = 0;
+	_desiredChangedCount = 0;
+	_desiredCaptures = (LP_DESIRED_CAPTURE*)lp_heapMalloc(LP_HEAP_TWINS,
+		deviceTwinCount * (sizeof(LP_DESIRED_CAPTURE) + sizeof(LP_DEVICE_TWIN_BINDING*)));
+	_desiredChanged = _desiredCaptures == NULL ? NULL : (LP_DEVICE_TWIN_BINDING**)(_desiredCaptures + deviceTwinCount);
+
+	if (_twinCacheEnabled && _twinCacheFd == -1) {
+		_twinCacheFd = Storage_OpenMutableFile();
+		if (_twinCacheFd == -1) {
+			LP_LOG(LP_LOG_WARNING, "WARNING: Device Twin cache unable to open mutable storage: %s (%d)\n", strerror(errno), errno);
+		}
 	}
+	LoadTwinCache();
 }
 
 void lp_closeDeviceTwinSet(void) {
+	json_path_free(_valuePath);
+	_valuePath = NULL;
+
+	if (_reportScratch != NULL) {
+		lp_heapFree(LP_HEAP_TWINS, _reportScratch);
+		_reportScratch = NULL;
+		_reportScratchSize = 0;
+	}
+
+	if (_deviceTwinIndexOwned) {
+		lp_heapFree(LP_HEAP_TWINS, _deviceTwinIndex);
+	}
+	_deviceTwinIndex = NULL;
+	_deviceTwinIndexCount = 0;
+	_deviceTwinIndexOwned = false;
+	_desiredVersionValid = false;		// a reopened set applies the next full twin whatever its $version
+
+	if (_desiredCaptures != NULL) {
+		lp_heapFree(LP_HEAP_TWINS, _desiredCaptures);
+		_desiredCaptures = NULL;
+		_desiredCaptureCount = 0;
+		_desiredChanged = NULL;
+		_desiredChangedCount = 0;
+	}
+
+	if (reportedStateFlushTimer.eventLoopTimer != NULL) {
+		lp_stopTimer(&reportedStateFlushTimer);
+	}
+	_reportedStateFlushArmed = false;
+
+	if (_twinCacheFd != -1) {
+		close(_twinCacheFd);
+		_twinCacheFd = -1;
+	}
+
 	for (int i = 0; i < _deviceTwinCount; i++) { lp_closeDeviceTwin(_deviceTwins[i]); }
 }
 
 void lp_openDeviceTwin(LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {
 	if (deviceTwinBinding->twinType == LP_TYPE_UNKNOWN) {
-		Log_Debug("\n\nDevice Twin '%s' missing type information.\nInclude .twinType option in LP_DEVICE_TWIN_BINDING definition.\nExample .twinType=LP_TYPE_BOOL. Valid types include LP_TYPE_BOOL, LP_TYPE_INT, LP_TYPE_FLOAT, LP_TYPE_STRING.\n\n", deviceTwinBinding->twinProperty);
+		LP_LOG(LP_LOG_ERROR, "\n\nDevice Twin '%s' missing type information.\nInclude .twinType option in LP_DEVICE_TWIN_BINDING definition.\nExample .twinType=LP_TYPE_BOOL. Valid types include LP_TYPE_BOOL, LP_TYPE_INT, LP_TYPE_FLOAT, LP_TYPE_STRING.\n\n", deviceTwinBinding->twinProperty);
 		lp_terminate(ExitCode_OpenDeviceTwin);
 	}
 
-	// types JSON and String allocated dynamically when called in azure_iot.c
+	// int, float and bool state lives inline in the binding, strings are passed through from the twin document
+	memset(&deviceTwinBinding->twinValue, 0, sizeof(deviceTwinBinding->twinValue));
+
 	switch (deviceTwinBinding->twinType) {
 	case LP_TYPE_INT:
-		deviceTwinBinding->twinState = malloc(sizeof(int));
-		*(int*)deviceTwinBinding->twinState = 0;
-		break;
 	case LP_TYPE_FLOAT:
-		deviceTwinBinding->twinState = malloc(sizeof(float));
-		*(float*)deviceTwinBinding->twinState = 0.0f;
-		break;
 	case LP_TYPE_BOOL:
-		deviceTwinBinding->twinState = malloc(sizeof(bool));
-		*(bool*)deviceTwinBinding->twinState = false;
+		deviceTwinBinding->twinState = &deviceTwinBinding->twinValue;
 		break;
 	default:
+		deviceTwinBinding->twinState = NULL;
 		break;
 	}
 }
 
 void lp_closeDeviceTwin(LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {
-	if (deviceTwinBinding->twinState != NULL) {
-		free(deviceTwinBinding->twinState);
-		deviceTwinBinding->twinState = NULL;
+	deviceTwinBinding->twinState = NULL;
+
+	if (deviceTwinBinding->reportedString != NULL) {
+		lp_heapFree(LP_HEAP_TWINS, deviceTwinBinding->reportedString);
+		deviceTwinBinding->reportedString = NULL;
+		deviceTwinBinding->reportedStringCapacity = 0;
+	}
+
+	if (deviceTwinBinding->desiredString != NULL) {
+		lp_heapFree(LP_HEAP_TWINS, deviceTwinBinding->desiredString);
+		deviceTwinBinding->desiredString = NULL;
+	}
+}
+
+/// <summary>
+///     Streaming parse member callback, only desired keys with a binding are built, reported and metadata are stepped over
+/// </summary>
+static JSON_Sax_Action TwinMember(void* context, const char* name, size_t length, size_t depth) {
+	LP_TWIN_DISPATCH* dispatch = (LP_TWIN_DISPATCH*)context;
+
+	if (depth < dispatch->desiredDepth) {
+		return CompareName(name, length, "desired") == 0 ? JSONSaxDescend : JSONSaxSkip;
+	}
+
+	if (depth != dispatch->desiredDepth) {
+		return JSONSaxSkip;
 	}
+
+	if (CompareName(name, length, "$version") == 0 || FindDeviceTwin(name, length) != NULL) {
+		return JSONSaxCapture;
+	}
+
+	return JSONSaxSkip;
+}
+
+/// <summary>
+///     Streaming parse value callback, holds each captured binding value until the whole document is read
+/// </summary>
+static JSON_Status TwinValue(void* context, const char* name, size_t length, JSON_Value* value, size_t depth) {
+	LP_TWIN_DISPATCH* dispatch = (LP_TWIN_DISPATCH*)context;
+	LP_DEVICE_TWIN_BINDING* deviceTwinBinding = NULL;
+
+	if (CompareName(name, length, "$version") == 0) {
+		if (json_value_get_type(value) == JSONNumber) {
+			dispatch->version = json_value_get_number(value);
+			dispatch->versionValid = true;
+		}
+		json_value_free(value);
+		return JSONSuccess;
+	}
+
+	deviceTwinBinding = FindDeviceTwin(name, length);
+
+	for (size_t i = 0; i < _desiredCaptureCount; i++) {
+		if (_desiredCaptures[i].binding == deviceTwinBinding) {
+			deviceTwinBinding = NULL;
+			break;
+		}
+	}
+
+	if (deviceTwinBinding != NULL && _desiredCaptures == NULL) {
+		// no capture list, apply as read without the $version check
+		JSON_Object* currentJSONProperties = json_value_get_object(value);
+		if (currentJSONProperties != NULL && SetDesiredState(currentJSONProperties, deviceTwinBinding) &&
+			deviceTwinBinding->twinType == LP_TYPE_STRING) {
+			deviceTwinBinding->twinState = NULL;		// no commit, the string is freed with the value
+		}
+	}
+
+	if (deviceTwinBinding == NULL || _desiredCaptures == NULL || _desiredCaptureCount >= _deviceTwinCount) {
+		json_value_free(value);
+		return JSONSuccess;
+	}
+
+	_desiredCaptures[_desiredCaptureCount].binding = deviceTwinBinding;
+	_desiredCaptures[_desiredCaptureCount].value = value;
+	_desiredCaptureCount++;
+
+	return JSONSuccess;
 }
 
+static const JSON_Sax_Handler _twinSaxHandler = {
+	.member = TwinMember,
+	.value = TwinValue
+};
+
 /// <summary>
 ///     Callback invoked when a Device Twin update is received from IoT Hub.
 /// </summary>
@@ -60,194 +412,1277 @@ void lp_closeDeviceTwin(LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {
 /// <param name="payloadSize">size of the Device Twin JSON document</param>
 void lp_twinCallback(DEVICE_TWIN_UPDATE_STATE updateState, const unsigned char* payload,
 	size_t payloadSize, void* userContextCallback) {
-	JSON_Value* root_value = NULL;
-	JSON_Object* root_object = NULL;
+	LP_TWIN_DISPATCH dispatch = {
+		.updateState = updateState,
+		.desiredDepth = updateState == DEVICE_TWIN_UPDATE_COMPLETE ? 2 : 1,
+		.versionValid = false,
+		.version = 0
+	};
+	uint32_t receivedUs = _twinCacheLoading ? 0 : lp_controlLatencyNow();		// 0 unless benchmarking cloud to actuator latency
+
+	_desiredCaptureCount = 0;
+
+	lp_jsonArenaBegin();	// captured values are built in the arena and released in one reset on return
 
-	char* payLoadString = (char*)malloc(payloadSize + 1);
-	if (payLoadString == NULL) {
+	// a full twin carries a large reported section that is never read, stream the desired keys
+	// with a binding into small values and skip everything else without allocating
+	if (json_parse_sax((const char*)payload, payloadSize, &_twinSaxHandler, &dispatch) != JSONSuccess) {
 		goto cleanup;
 	}
 
-	memcpy(payLoadString, payload, payloadSize);
-	payLoadString[payloadSize] = 0; //null terminate string
+	if (!_twinCacheLoading) {
+		lp_kickCloudToDevice();	// desired property changes are often followed by reported property updates
+	}
 
-	root_value = json_parse_string(payLoadString);
-	if (root_value == NULL) {
-		goto cleanup;
+	// the desired section version increases with every change, a full twin resent with the
+	// version already applied (for example after a reconnect) carries nothing new. A full twin
+	// with an older version means the twin was recreated so it is applied.
+	if (dispatch.versionValid) {
+		if (_desiredVersionValid && (updateState == DEVICE_TWIN_UPDATE_COMPLETE ? dispatch.version == _desiredVersion : dispatch.version <= _desiredVersion)) {
+			LP_LOG(LP_LOG_DEBUG, "INFO: Device Twin desired version %.0f already applied\n", dispatch.version);
+			goto cleanup;
+		}
+		_twinCacheDirty = _twinCacheDirty || !_desiredVersionValid || dispatch.version != _desiredVersion;
+		_desiredVersion = dispatch.version;
+		_desiredVersionValid = true;
 	}
+	_applyingVersion = dispatch.versionValid && dispatch.version > 0 && dispatch.version <= UINT32_MAX ? (uint32_t)dispatch.version : 0;
+	lp_controlLatencyReceived(receivedUs, _applyingVersion);
 
-	root_object = json_value_get_object(root_value);
-	if (root_object == NULL) {
-		goto cleanup;
+	// every changed binding is applied and its handler run before the commit handler sees them together,
+	// reports the handlers make are sent as one document after the commit
+	_applyingDesired = true;
+	_reportAfterCommit = false;
+	_desiredChangedCount = 0;
+
+	for (size_t i = 0; i < _desiredCaptureCount; i++) {
+		JSON_Object* currentJSONProperties = json_value_get_object(_desiredCaptures[i].value);
+		if (currentJSONProperties != NULL && SetDesiredState(currentJSONProperties, _desiredCaptures[i].binding)) {
+			_desiredChanged[_desiredChangedCount++] = _desiredCaptures[i].binding;
+		}
 	}
 
-	JSON_Object* desiredProperties = json_object_dotget_object(root_object, "desired");
-	if (desiredProperties == NULL) {
-		desiredProperties = root_object;
+	if (_commitHandler != NULL && _desiredChangedCount > 0) {
+		_commitHandler(_desiredChanged, _desiredChangedCount);
 	}
 
-	for (int i = 0; i < _deviceTwinCount; i++) {
-		JSON_Object* currentJSONProperties = json_object_dotget_object(desiredProperties, _deviceTwins[i]->twinProperty);
-		if (currentJSONProperties != NULL) {
-			SetDesiredState(currentJSONProperties, _deviceTwins[i]);
+	if (QueueWritableAcks()) {
+		if (_reportedStateFlushIntervalMs == 0) {
+			_reportAfterCommit = true;
+		}
+		else {
+			ArmReportedStateFlush(_reportedStateFlushIntervalMs);
 		}
 	}
 
+	_applyingDesired = false;
+
+	for (size_t i = 0; i < _desiredChangedCount; i++) {
+		if (_desiredChanged[i]->twinType == LP_TYPE_STRING) {
+			_desiredChanged[i]->twinState = NULL;
+		}
+	}
+	_desiredChangedCount = 0;
+
+	if (_reportAfterCommit) {
+		_reportAfterCommit = false;
+		lp_flushReportedState();
+	}
+
 cleanup:
-	// Release the allocated memory.
-	if (root_value != NULL) {
-		json_value_free(root_value);
+	lp_controlLatencyReceived(0, 0);
+
+	// Release the captured values.
+	for (size_t i = 0; i < _desiredCaptureCount; i++) {
+		json_value_free(_desiredCaptures[i].value);
+	}
+	_desiredCaptureCount = 0;
+
+	lp_jsonArenaEnd();
+
+	if (_twinCacheDirty && !_twinCacheLoading) {
+		SaveTwinCache();
+	}
+}
+
+/// <summary>
+///     FNV-1a hash so the last applied desired string can be compared without keeping a copy
+/// </summary>
+static uint32_t HashString(const char* value) {
+	uint32_t hash = 2166136261U;
+	for (; *value != 0; value++) {
+		hash = (hash ^ (uint8_t)*value) * 16777619U;
+	}
+	return hash;
+}
+
+/// <summary>
+///     True when the desired value equals the one last applied to the binding, so its handler has already run
+/// </summary>
+static bool DesiredUnchanged(LP_DEVICE_TWIN_BINDING* deviceTwinBinding, double desiredValue) {
+	if (deviceTwinBinding->desiredApplied && deviceTwinBinding->lastDesiredValue == desiredValue) {
+		return true;
+	}
+
+	deviceTwinBinding->desiredApplied = true;
+	deviceTwinBinding->lastDesiredValue = desiredValue;
+	_twinCacheDirty = true;
+	return false;
+}
+
+/// <summary>
+///     Default outcome of a desired change, set before its handler runs so the handler can override it
+/// </summary>
+static void BeginAck(LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {
+	if (_writableAcks && _applyingVersion != 0) {
+		deviceTwinBinding->ackStatus = LP_ACK_COMPLETED;
+		deviceTwinBinding->ackVersion = _applyingVersion;
+		deviceTwinBinding->ackDescription = "completed";
+	}
+}
+
+/// <summary>
+///     Report the changed bindings back with their acknowledgement, a value the handlers already reported is kept.
+///     True when any was queued.
+/// </summary>
+static bool QueueWritableAcks(void) {
+	size_t queued = 0;
+
+	if (!_writableAcks || _applyingVersion == 0) {
+		return false;
+	}
+
+	for (size_t i = 0; i < _desiredChangedCount; i++) {
+		LP_DEVICE_TWIN_BINDING* binding = _desiredChanged[i];
+
+		if (binding->ackVersion != _applyingVersion) {
+			continue;
+		}
+		if (binding->twinReportPending || SetReportedValue(binding, binding->twinState)) {
+			binding->twinReportPending = true;
+			binding->reportState = LP_REPORT_PENDING;
+			queued++;
+		}
 	}
 
-	if (payLoadString != NULL) {
-		free(payLoadString);
-		payLoadString = NULL;
+	_twinStats.acks += (uint32_t)queued;
+	return queued > 0;
+}
+
+/// <summary>
+///     Set the acknowledgement of the desired change being applied, from its handler or the commit handler
+/// </summary>
+void lp_ackDesiredState(LP_DEVICE_TWIN_BINDING* deviceTwinBinding, int status, const char* description) {
+	if (deviceTwinBinding == NULL || !_applyingDesired || deviceTwinBinding->ackVersion != _applyingVersion) {
+		return;
 	}
+
+	deviceTwinBinding->ackStatus = status;
+	deviceTwinBinding->ackDescription = description == NULL ? "" : description;
+}
+
+void lp_setWritablePropertyAcks(bool enabled) {
+	_writableAcks = enabled;
+}
+
+/// <summary>
+///     ApplyDesiredState, traced with its handler while the event trace is armed
+/// </summary>
+static bool SetDesiredState(JSON_Object* jsonObject, LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {
+	uint32_t tracedUs = lp_traceNow();
+	bool changed = ApplyDesiredState(jsonObject, deviceTwinBinding);
+
+	lp_traceSpan(LP_TRACE_TWIN, deviceTwinBinding->twinProperty, tracedUs, changed);
+	return changed;
 }
 
 /// <summary>
-///     Checks to see if the device twin twinProperty(name) is found in the json object. If yes, then act upon the request
+///     Checks to see if the device twin twinProperty(name) is found in the json object. If yes, then act upon the request.
+///     Values already applied are skipped so a full twin resent on reconnect does not fire handlers again.
+///     Returns true when the value changed, a string binding's twinState then points into the twin document
+///     until the caller clears it.
 /// </summary>
-static void SetDesiredState(JSON_Object* jsonObject, LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {
+static bool ApplyDesiredState(JSON_Object* jsonObject, LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {
+	JSON_Value* desired = _valuePath != NULL ? json_path_eval(jsonObject, _valuePath) : json_object_get_value(jsonObject, _valueKey);
 
 	switch (deviceTwinBinding->twinType) {
 	case LP_TYPE_INT:
-		if (json_object_has_value_of_type(jsonObject, "value", JSONNumber)) {
-			*(int*)deviceTwinBinding->twinState = (int)json_object_get_number(jsonObject, "value");
+		if (json_value_get_type(desired) == JSONNumber) {
+			int value = (int)json_value_get_number(desired);
+			if (DesiredUnchanged(deviceTwinBinding, value)) {
+				break;
+			}
+
+			*(int*)deviceTwinBinding->twinState = value;
 
 			deviceTwinBinding->twinStateUpdated = true;
 
+			BeginAck(deviceTwinBinding);
 			if (deviceTwinBinding->handler != NULL) {
 				deviceTwinBinding->handler(deviceTwinBinding);
 			}
+			return true;
 		}
 		break;
 	case LP_TYPE_FLOAT:
-		if (json_object_has_value_of_type(jsonObject, "value", JSONNumber)) {
-			*(float*)deviceTwinBinding->twinState = (float)json_object_get_number(jsonObject, "value");
+		if (json_value_get_type(desired) == JSONNumber) {
+			float value = (float)json_value_get_number(desired);
+			if (DesiredUnchanged(deviceTwinBinding, value)) {
+				break;
+			}
+
+			*(float*)deviceTwinBinding->twinState = value;
 
 			deviceTwinBinding->twinStateUpdated = true;
 
+			BeginAck(deviceTwinBinding);
 			if (deviceTwinBinding->handler != NULL) {
 				deviceTwinBinding->handler(deviceTwinBinding);
 			}
+			return true;
 		}
 		break;
 	case LP_TYPE_BOOL:
-		if (json_object_has_value_of_type(jsonObject, "value", JSONBoolean)) {
-			*(bool*)deviceTwinBinding->twinState = (bool)json_object_get_boolean(jsonObject, "value");
+		if (json_value_get_type(desired) == JSONBoolean) {
+			bool value = (bool)json_value_get_boolean(desired);
+			if (DesiredUnchanged(deviceTwinBinding, value)) {
+				break;
+			}
+
+			*(bool*)deviceTwinBinding->twinState = value;
 
 			deviceTwinBinding->twinStateUpdated = true;
 
+			BeginAck(deviceTwinBinding);
 			if (deviceTwinBinding->handler != NULL) {
 				deviceTwinBinding->handler(deviceTwinBinding);
 			}
+			return true;
 		}
 		break;
 	case LP_TYPE_STRING:
-		if (json_object_has_value_of_type(jsonObject, "value", JSONString)) {
-			deviceTwinBinding->twinState = (char*)json_object_get_string(jsonObject, "value");
+		if (json_value_get_type(desired) == JSONString) {
+			const char* value = json_value_get_string(desired);
+			if (DesiredUnchanged(deviceTwinBinding, HashString(value))) {
+				break;
+			}
+
+			// the cache writes the value back as it was received, only kept while the cache is open
+			if (_twinCacheFd != -1) {
+				size_t length = strlen(value) + 1;
+				char* copy = (char*)lp_heapRealloc(LP_HEAP_TWINS, deviceTwinBinding->desiredString, length);
+				if (copy != NULL) {
+					memcpy(copy, value, length);
+					deviceTwinBinding->desiredString = copy;
+				} else {
+					lp_heapFree(LP_HEAP_TWINS, deviceTwinBinding->desiredString);
+					deviceTwinBinding->desiredString = NULL;		// left out of the cache rather than cached stale
+				}
+			}
 
+			deviceTwinBinding->twinState = (char*)value;
+
+			BeginAck(deviceTwinBinding);
 			if (deviceTwinBinding->handler != NULL) {
 				deviceTwinBinding->handler(deviceTwinBinding);
 			}
-			deviceTwinBinding->twinState = NULL;
+			return true;
 		}
 		break;
 	default:
 		break;
 	}
+
+	return false;
 }
 
-bool lp_deviceTwinReportState(LP_DEVICE_TWIN_BINDING* deviceTwinBinding, void* state) {
-	int len = 0;
-	size_t reportLen = 10; // initialize to 10 chars to allow for JSON and NULL termination. This is generous by a couple of bytes
-	bool result = false;
+/// <summary>
+///     Record the value to report and mark the binding dirty
+/// </summary>
+static bool SetReportedValue(LP_DEVICE_TWIN_BINDING* deviceTwinBinding, void* state) {
+	switch (deviceTwinBinding->twinType) {
+	case LP_TYPE_INT:
+	case LP_TYPE_FLOAT:
+	case LP_TYPE_BOOL:
+		if (deviceTwinBinding->twinState == NULL) {
+			return false;
+		}
+		if (deviceTwinBinding->twinState != state) {
+			memcpy(deviceTwinBinding->twinState, state, TwinStateSize(deviceTwinBinding->twinType));
+		}
+		break;
+	case LP_TYPE_STRING:
+		if (deviceTwinBinding->reportedString == NULL || strcmp(deviceTwinBinding->reportedString, (char*)state) != 0) {
+			size_t length = strlen((char*)state) + 1;
 
-	if (deviceTwinBinding == NULL) {
+			// grow only, a string property settles at its longest value rather than allocating per report
+			if (length > deviceTwinBinding->reportedStringCapacity) {
+				char* grown = (char*)lp_heapRealloc(LP_HEAP_TWINS, deviceTwinBinding->reportedString, length);
+				if (grown == NULL) {
+					return false;
+				}
+				deviceTwinBinding->reportedString = grown;
+				deviceTwinBinding->reportedStringCapacity = length;
+			}
+			memcpy(deviceTwinBinding->reportedString, state, length);
+		}
+		break;
+	default:
+		LP_LOG(LP_LOG_ERROR, "Device Twin Type Unknown");
 		return false;
 	}
 
-	if (!lp_connectToAzureIot()) {
+	deviceTwinBinding->twinReportPending = true;
+	deviceTwinBinding->reportState = LP_REPORT_PENDING;
+	return true;
+}
+
+/// <summary>
+///     True when state is within the binding's deadband of the last reported value, so reporting it would not
+///     tell the cloud anything new. A value still waiting to be sent is always replaced.
+/// </summary>
+static bool IsInsignificantChange(LP_DEVICE_TWIN_BINDING* deviceTwinBinding, void* state) {
+	if (!deviceTwinBinding->lastReportValid || deviceTwinBinding->twinReportPending) {
 		return false;
 	}
 
-	reportLen += strlen(deviceTwinBinding->twinProperty); // allow for twin property name in JSON response
-
-	if (deviceTwinBinding->twinType == LP_TYPE_STRING) {
-		reportLen += strlen((char*)state);
+	switch (deviceTwinBinding->twinType) {
+	case LP_TYPE_INT:
+		return (double)*(int*)state == deviceTwinBinding->lastReportedValue;
+	case LP_TYPE_BOOL:
+		return (double)*(bool*)state == deviceTwinBinding->lastReportedValue;
+	case LP_TYPE_FLOAT: {
+		double last = deviceTwinBinding->lastReportedValue;
+		double change = (double)*(float*)state - last;
+		change = change < 0 ? -change : change;
+		if (change == 0.0) {
+			return true;
+		}
+		return (deviceTwinBinding->deadband > 0.0f && change <= deviceTwinBinding->deadband) ||
+			(deviceTwinBinding->deadbandPercent > 0.0f && change <= (last < 0 ? -last : last) * deviceTwinBinding->deadbandPercent / 100.0);
 	}
-	else {
-		reportLen += 20; // allow 20 chars for Int, float, and boolean serialization
+	case LP_TYPE_STRING:
+		return deviceTwinBinding->reportedString != NULL && strcmp(deviceTwinBinding->reportedString, (char*)state) == 0;
+	default:
+		return false;
 	}
+}
 
-	char* reportedPropertiesString = (char*)malloc(reportLen);
-	if (reportedPropertiesString == NULL) {
-		return false;
+/// <summary>
+///     Milliseconds left before the binding's minimum report interval allows another report
+/// </summary>
+static int ReportHoldMs(LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {
+	struct timespec now;
+
+	if (deviceTwinBinding->minReportIntervalMs <= 0 || !deviceTwinBinding->lastReportValid) {
+		return 0;
 	}
 
-	memset(reportedPropertiesString, 0, reportLen);
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	long elapsedMs = (now.tv_sec - deviceTwinBinding->lastReportedAt.tv_sec) * 1000 + (now.tv_nsec - deviceTwinBinding->lastReportedAt.tv_nsec) / 1000000;
+
+	return elapsedMs >= deviceTwinBinding->minReportIntervalMs ? 0 : deviceTwinBinding->minReportIntervalMs - (int)elapsedMs;
+}
 
+/// <summary>
+///     Keep the value and time of a report being sent, the deadband and minimum interval start from it
+/// </summary>
+static void RecordReported(LP_DEVICE_TWIN_BINDING* deviceTwinBinding, struct timespec* now, uint32_t sequence) {
 	switch (deviceTwinBinding->twinType) {
 	case LP_TYPE_INT:
-		*(int*)deviceTwinBinding->twinState = *(int*)state;
-		len = snprintf(reportedPropertiesString, reportLen, "{\"%s\":%d}", deviceTwinBinding->twinProperty,
-			(*(int*)deviceTwinBinding->twinState));
+		deviceTwinBinding->lastReportedValue = *(int*)deviceTwinBinding->twinState;
 		break;
 	case LP_TYPE_FLOAT:
-		*(float*)deviceTwinBinding->twinState = *(float*)state;
-		len = snprintf(reportedPropertiesString, reportLen, "{\"%s\":%f}", deviceTwinBinding->twinProperty,
-			(*(float*)deviceTwinBinding->twinState));
+		deviceTwinBinding->lastReportedValue = *(float*)deviceTwinBinding->twinState;
 		break;
 	case LP_TYPE_BOOL:
-		*(bool*)deviceTwinBinding->twinState = *(bool*)state;
-		len = snprintf(reportedPropertiesString, reportLen, "{\"%s\":%s}", deviceTwinBinding->twinProperty,
-			(*(bool*)deviceTwinBinding->twinState ? "true" : "false"));
-		break;
-	case LP_TYPE_STRING:
-		deviceTwinBinding->twinState = NULL;
-		len = snprintf(reportedPropertiesString, reportLen, "{\"%s\":\"%s\"}", deviceTwinBinding->twinProperty, (char*)state);
-		break;
-	case LP_TYPE_UNKNOWN:
-		Log_Debug("Device Twin Type Unknown");
+		deviceTwinBinding->lastReportedValue = *(bool*)deviceTwinBinding->twinState;
 		break;
 	default:
 		break;
 	}
 
-	if (len > 0) {
-		result = DeviceTwinUpdateReportedState(reportedPropertiesString);
-	}
+	deviceTwinBinding->lastReportedAt = *now;
+	deviceTwinBinding->lastReportValid = true;
+	deviceTwinBinding->twinReportPending = false;
+	deviceTwinBinding->reportState = LP_REPORT_IN_FLIGHT;
+	deviceTwinBinding->reportSequence = sequence;
+}
 
-	if (reportedPropertiesString != NULL) {
-		free(reportedPropertiesString);
-		reportedPropertiesString = NULL;
+/// <summary>
+///     Milliseconds left of the backoff after a refused report, due bindings wait for it like a rate limit
+/// </summary>
+static int ReportRetryMs(void) {
+	struct timespec now;
+
+	if (_reportRetryMs == 0) {
+		return 0;
 	}
 
-	return result;
-}
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	long remainingMs = (_reportRetryAt.tv_sec - now.tv_sec) * 1000 + (_reportRetryAt.tv_nsec - now.tv_nsec) / 1000000;
 
+	return remainingMs > 0 ? (int)remainingMs : 0;
+}
 
-static bool DeviceTwinUpdateReportedState(char* reportedPropertiesString) {
-	if (IoTHubDeviceClient_LL_SendReportedState(
-		lp_getAzureIotClientHandle(), (unsigned char*)reportedPropertiesString,
-		strlen(reportedPropertiesString), lp_deviceTwinsReportStatusCallback, 0) != IOTHUB_CLIENT_OK) 
-	{
-		Log_Debug("ERROR: failed to set reported state for '%s'.\n", reportedPropertiesString);
-		return false;
+/// <summary>
+///     Start the one shot reported state flush in delayMs, a flush already armed keeps its time
+/// </summary>
+static void ArmReportedStateFlush(int delayMs) {
+	if (reportedStateFlushTimer.eventLoopTimer == NULL && !lp_startTimer(&reportedStateFlushTimer)) {
+		return;
 	}
-	else {
-		Log_Debug("INFO: Reported state twinStateUpdated '%s'.\n", reportedPropertiesString);
-		return true;
+
+	if (!_reportedStateFlushArmed) {
+		_reportedStateFlushArmed = true;
+		lp_setOneShotTimer(&reportedStateFlushTimer, &(struct timespec){delayMs / 1000, (delayMs % 1000) * 1000000});
 	}
+}
 
-	IoTHubDeviceClient_LL_DoWork(lp_getAzureIotClientHandle());
+static bool IsPathWithin(const char* path, const char* parent) {
+	size_t length = strlen(parent);
+	return strncmp(path, parent, length) == 0 && path[length] == '.';
 }
 
+static void DropReportedPath(size_t index) {
+	LP_REPORTED_PATH dropped = _reportedPaths[index];
+
+	// the last one moves into the hole and the dropped buffer goes to the end, kept for reuse
+	_reportedPaths[index] = _reportedPaths[--_reportedPathCount];
+	_reportedPaths[_reportedPathCount] = dropped;
+}
 
 /// <summary>
-///     Callback invoked when the Device Twin reported properties are accepted by IoT Hub.
+///     Mark path pending. When replaced is set its value is now a leaf or gone, so whatever was marked inside it
+///     is covered by it; otherwise it is an object and the members marked inside stay, a removed one must go as null
 /// </summary>
-void lp_deviceTwinsReportStatusCallback(int result, void* context) {
-	Log_Debug("INFO: Device Twin reported properties update result: HTTP status code %d\n", result);
+static bool MarkReportedPath(const char* path, bool present, bool replaced) {
+	size_t length = strlen(path) + 1;
+	LP_REPORTED_PATH* slot = NULL;
+
+	for (size_t i = 0; i < _reportedPathCount; i++) {
+		if (present && _reportedPaths[i].pending && IsPathWithin(path, _reportedPaths[i].path)) {
+			return true;		// a pending parent is sent whole, as it is in the document at the flush
+		}
+	}
+
+	for (size_t i = _reportedPathCount; i-- > 0;) {
+		if (strcmp(_reportedPaths[i].path, path) == 0) {
+			slot = &_reportedPaths[i];
+		}
+		else if (replaced && IsPathWithin(_reportedPaths[i].path, path)) {
+			DropReportedPath(i);
+		}
+	}
+
+	if (slot == NULL) {
+		if (_reportedPathCount == _reportedPathCapacity) {
+			size_t capacity = _reportedPathCapacity == 0 ? 8 : _reportedPathCapacity * 2;
+			LP_REPORTED_PATH* grown = (LP_REPORTED_PATH*)lp_heapRealloc(LP_HEAP_TWINS, _reportedPaths, capacity * sizeof(LP_REPORTED_PATH));
+			if (grown == NULL) {
+				return false;
+			}
+			memset(grown + _reportedPathCapacity, 0, (capacity - _reportedPathCapacity) * sizeof(LP_REPORTED_PATH));
+			_reportedPaths = grown;
+			_reportedPathCapacity = capacity;
+		}
+
+		slot = &_reportedPaths[_reportedPathCount];
+		if (length > slot->capacity) {
+			char* grown = (char*)lp_heapRealloc(LP_HEAP_TWINS, slot->path, length);
+			if (grown == NULL) {
+				return false;
+			}
+			slot->path = grown;
+			slot->capacity = length;
+		}
+		memcpy(slot->path, path, length);
+		slot->sequence = 0;
+		_reportedPathCount++;
+	}
+
+	slot->pending = true;
+	return true;
+}
+
+/// <summary>
+///     Mark what changes from before to after at path, recursing into members while both are objects. path is
+///     a buffer of LP_REPORTED_PATH_MAX the members are appended to, after NULL for a removal
+/// </summary>
+static bool MarkReportedChanges(char* path, size_t length, const JSON_Value* before, const JSON_Value* after) {
+	const JSON_Object* beforeObject = json_value_get_object(before);
+	const JSON_Object* afterObject = json_value_get_object(after);
+
+	if (json_value_equals(before, after)) {
+		return true;
+	}
+
+	if (beforeObject == NULL || afterObject == NULL) {
+		return MarkReportedPath(path, after != NULL, afterObject == NULL);
+	}
+
+	// members are marked before the object is, a name that does not fit, or would split, marks the object
+	for (int pass = 0; pass < 2; pass++) {
+		const JSON_Object* object = pass == 0 ? afterObject : beforeObject;
+
+		for (size_t i = 0; i < json_object_get_count(object); i++) {
+			const char* name = json_object_get_name(object, i);
+			size_t nameLength = strlen(name);
+
+			if (pass == 1 && json_object_has_value(afterObject, name)) {
+				continue;		// compared in the first pass
+			}
+			if (length + 1 + nameLength >= LP_REPORTED_PATH_MAX || strchr(name, '.') != NULL) {
+				path[length] = 0;
+				return MarkReportedPath(path, true, false);
+			}
+
+			path[length] = '.';
+			memcpy(path + length + 1, name, nameLength + 1);
+			if (!MarkReportedChanges(path, length + 1 + nameLength, json_object_get_value(beforeObject, name),
+				json_object_get_value(afterObject, name))) {
+				return false;
+			}
+		}
+	}
+
+	path[length] = 0;
+	return true;
+}
+
+static bool ReportedDocumentPending(void) {
+	for (size_t i = 0; i < _reportedPathCount; i++) {
+		if (_reportedPaths[i].pending) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static int CompareReportedPathLength(const void* a, const void* b) {
+	size_t lengthA = strlen(((const LP_REPORTED_PATH*)a)->path);
+	size_t lengthB = strlen(((const LP_REPORTED_PATH*)b)->path);
+	return lengthA < lengthB ? -1 : lengthA > lengthB;
+}
+
+/// <summary>
+///     The pending paths as a merge patch, each parent before the members inside it so a removed member set as
+///     null lands in the copy of its parent. Serialised by parson, free it with json_free_serialized_string
+/// </summary>
+static char* SerializeReportedPatch(void) {
+	JSON_Value* patch = json_value_init_object();
+	const JSON_Object* document = json_value_get_object(_reportedDocument);
+	char* serialized = NULL;
+
+	if (patch == NULL) {
+		return NULL;
+	}
+
+	qsort(_reportedPaths, _reportedPathCount, sizeof(LP_REPORTED_PATH), CompareReportedPathLength);
+
+	for (size_t i = 0; i < _reportedPathCount; i++) {
+		if (!_reportedPaths[i].pending) {
+			continue;
+		}
+
+		JSON_Value* current = json_object_dotget_value(document, _reportedPaths[i].path);
+		JSON_Value* copy = current != NULL ? json_value_deep_copy(current) : json_value_init_null();
+
+		if (copy == NULL) {
+			json_value_free(patch);
+			return NULL;
+		}
+		if (json_object_dotset_value(json_value_get_object(patch), _reportedPaths[i].path, copy) != JSONSuccess) {
+			json_value_free(copy);		// inside a parent sent as a leaf, the parent replaces it
+		}
+	}
+
+	serialized = json_serialize_to_string(patch);
+	json_value_free(patch);
+	return serialized;
+}
+
+static void ReportedPathsSent(uint32_t sequence) {
+	for (size_t i = 0; i < _reportedPathCount; i++) {
+		if (_reportedPaths[i].pending) {
+			_reportedPaths[i].pending = false;
+			_reportedPaths[i].sequence = sequence;
+			_twinStats.documentPaths++;
+		}
+	}
+}
+
+/// <summary>
+///     Acknowledged paths are dropped unless they changed again, refused ones are pending again. sequence 0 has
+///     every path in flight pending again, their report went to a connection that is gone
+/// </summary>
+static void ReportedPathsAcknowledged(uint32_t sequence, bool accepted) {
+	for (size_t i = _reportedPathCount; i-- > 0;) {
+		LP_REPORTED_PATH* path = &_reportedPaths[i];
+
+		if (path->sequence == 0 || (sequence != 0 && path->sequence != sequence)) {
+			continue;
+		}
+
+		path->sequence = 0;
+		if (!accepted) {
+			path->pending = true;
+			_twinStats.resent++;
+		}
+		else if (!path->pending) {
+			DropReportedPath(i);
+		}
+	}
+}
+
+/// <summary>
+///     Copy value in at path, NULL removes it, and mark what changed. The document and its copies are kept
+///     out of the arena, a handler reporting from inside a twin or method callback runs in its scope.
+/// </summary>
+static bool SetReportedDocument(const char* path, const JSON_Value* value) {
+	char changed[LP_REPORTED_PATH_MAX];
+	size_t length = path != NULL ? strlen(path) : 0;
+	JSON_Object* document = NULL;
+	JSON_Value* before = NULL;
+	JSON_Value* copy = NULL;
+	bool result = false;
+	int arenaDepth;
+
+	if (length == 0 || length >= sizeof(changed)) {
+		return false;
+	}
+
+	// null removes a reported property, the document does not keep it
+	if (json_value_get_type(value) == JSONNull) {
+		value = NULL;
+	}
+
+	arenaDepth = lp_jsonArenaSuspend();
+
+	if (_reportedDocument == NULL && (_reportedDocument = json_value_init_object()) == NULL) {
+		goto resume;
+	}
+
+	document = json_value_get_object(_reportedDocument);
+	before = json_object_dotget_value(document, path);
+
+	if (json_value_equals(before, value)) {
+		result = true;
+		goto resume;
+	}
+
+	// marked against the value it replaces, before the set frees it
+	memcpy(changed, path, length + 1);
+	if (!MarkReportedChanges(changed, length, before, value)) {
+		goto resume;
+	}
+
+	if (value == NULL) {
+		result = json_object_dotremove(document, path) == JSONSuccess;
+	}
+	else {
+		copy = json_value_deep_copy(value);
+		result = copy != NULL && json_object_dotset_value(document, path, copy) == JSONSuccess;
+		if (!result) {
+			json_value_free(copy);
+		}
+	}
+
+	if (result) {
+		if (_applyingDesired && _reportedStateFlushIntervalMs == 0) {
+			_reportAfterCommit = true;
+		}
+		else {
+			ArmReportedStateFlush(_reportedStateFlushIntervalMs > 0 ? _reportedStateFlushIntervalMs : LP_REPORT_DOCUMENT_DELAY_MS);
+		}
+	}
+
+resume:
+	lp_jsonArenaResume(arenaDepth);
+	return result;
+}
+
+/// <summary>
+///     Serialise the dirty bindings into one reported properties document and send it as a single twin PATCH,
+///     with the pending paths of the reported document merged in
+/// </summary>
+static bool ReportBindings(LP_DEVICE_TWIN_BINDING** bindings, size_t bindingCount) {
+	size_t reportLen = 3; // braces and NULL termination
+	size_t dirtyCount = 0;
+	int len = 0;
+	int nextHoldMs = 0;
+	bool result = false;
+	bool documentPending = ReportedDocumentPending();
+	char* patch = NULL;
+
+	for (size_t i = 0; i < bindingCount; i++) {
+		if (!bindings[i]->twinReportPending) {
+			continue;
+		}
+
+		// bindings still inside their minimum report interval wait for a later flush
+		int holdMs = ReportHoldMs(bindings[i]);
+		bindings[i]->reportDue = holdMs == 0;
+		if (!bindings[i]->reportDue) {
+			nextHoldMs = nextHoldMs == 0 || holdMs < nextHoldMs ? holdMs : nextHoldMs;
+			continue;
+		}
+
+		reportLen += strlen(bindings[i]->twinProperty) + 6; // quotes, colon, comma and string value quotes
+		reportLen += bindings[i]->twinType == LP_TYPE_STRING ? strlen(bindings[i]->reportedString) : 20; // allow 20 chars for Int, float, and boolean serialization
+		if (_writableAcks && bindings[i]->ackVersion != 0) {
+			reportLen += sizeof("{\"value\":,\"ac\":,\"av\":,\"ad\":\"\"}") + 21 + strlen(bindings[i]->ackDescription);
+		}
+		dirtyCount++;
+	}
+
+	dirtyCount += documentPending ? 1 : 0;
+
+	// after a refusal the due bindings wait out the retry backoff, coalescing, then go in one document
+	int retryMs = dirtyCount > 0 ? ReportRetryMs() : 0;
+	if (retryMs > 0) {
+		nextHoldMs = nextHoldMs == 0 || retryMs < nextHoldMs ? retryMs : nextHoldMs;
+		dirtyCount = 0;
+	}
+
+	// out of reported state tokens the due bindings stay dirty, coalescing, until the flush a token allows
+	if (dirtyCount > 0 && !lp_rateLimitTake(LP_RATE_REPORTED)) {
+		int waitMs = lp_rateLimitWaitMs(LP_RATE_REPORTED);
+		nextHoldMs = nextHoldMs == 0 || waitMs < nextHoldMs ? waitMs : nextHoldMs;
+		dirtyCount = 0;
+	}
+
+	if (nextHoldMs > 0) {
+		ArmReportedStateFlush(nextHoldMs);
+	}
+
+	if (dirtyCount == 0) {
+		return true;
+	}
+
+	// the patch is built and serialised in the arena and copied into the document before the scope ends
+	if (documentPending) {
+		lp_jsonArenaBegin();
+		patch = SerializeReportedPatch();
+		if (patch == NULL) {
+			lp_jsonArenaEnd();
+			return false;
+		}
+		reportLen += strlen(patch);
+	}
+
+	char* reportedPropertiesString = reportLen <= _reportScratchSize ? _reportScratch : (char*)lp_heapMalloc(LP_HEAP_TWINS, reportLen);
+
+	if (reportedPropertiesString != NULL) {
+		reportedPropertiesString[len++] = '{';
+
+		// the members inside the patch braces go first, the bindings follow them
+		size_t patchLen = patch != NULL ? strlen(patch) : 0;
+		if (patchLen > 2) {
+			memcpy(reportedPropertiesString + len, patch + 1, patchLen - 2);
+			len += (int)(patchLen - 2);
+		}
+	}
+
+	if (patch != NULL) {
+		json_free_serialized_string(patch);
+		lp_jsonArenaEnd();
+	}
+
+	if (reportedPropertiesString == NULL) {
+		return false;
+	}
+
+	for (size_t i = 0; i < bindingCount; i++) {
+		LP_DEVICE_TWIN_BINDING* binding = bindings[i];
+		int fieldLen = 0;
+
+		if (!binding->twinReportPending || !binding->reportDue) {
+			continue;
+		}
+
+		const char* separator = len > 1 ? "," : "";
+		// once acknowledged a writable property keeps the acknowledgement form, a bare value would replace it
+		bool ackForm = _writableAcks && binding->ackVersion != 0;
+
+		fieldLen = snprintf(reportedPropertiesString + len, reportLen - (size_t)len, "%s\"%s\":%s", separator, binding->twinProperty,
+			ackForm ? "{\"value\":" : "");
+		if (fieldLen >= 0 && (size_t)(len + fieldLen) < reportLen - 1) {
+			len += fieldLen;
+			fieldLen = 0;
+
+			switch (binding->twinType) {
+			case LP_TYPE_INT:
+				fieldLen = snprintf(reportedPropertiesString + len, reportLen - (size_t)len, "%d", (*(int*)binding->twinState));
+				break;
+			case LP_TYPE_FLOAT:
+				fieldLen = snprintf(reportedPropertiesString + len, reportLen - (size_t)len, "%f", (*(float*)binding->twinState));
+				break;
+			case LP_TYPE_BOOL:
+				fieldLen = snprintf(reportedPropertiesString + len, reportLen - (size_t)len, "%s", (*(bool*)binding->twinState ? "true" : "false"));
+				break;
+			case LP_TYPE_STRING:
+				fieldLen = snprintf(reportedPropertiesString + len, reportLen - (size_t)len, "\"%s\"", binding->reportedString);
+				break;
+			default:
+				break;
+			}
+		}
+
+		if (ackForm && fieldLen >= 0 && (size_t)(len + fieldLen) < reportLen - 1) {
+			len += fieldLen;
+			fieldLen = snprintf(reportedPropertiesString + len, reportLen - (size_t)len, ",\"ac\":%d,\"av\":%u,\"ad\":\"%s\"}",
+				binding->ackStatus, binding->ackVersion, binding->ackDescription);
+		}
+
+		if (fieldLen < 0 || (size_t)(len + fieldLen) >= reportLen - 1) {
+			if (reportedPropertiesString != _reportScratch) {
+				lp_heapFree(LP_HEAP_TWINS, reportedPropertiesString);
+			}
+			return false;
+		}
+		len += fieldLen;
+	}
+
+	reportedPropertiesString[len++] = '}';
+	reportedPropertiesString[len] = 0;
+
+	if (++_reportSequence == 0) {
+		_reportSequence = 1;
+	}
+
+	result = DeviceTwinUpdateReportedState(reportedPropertiesString, _reportSequence);
+
+	if (!result) {
+		_twinStats.documentFailures++;
+	}
+	else {
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		_twinStats.documents++;
+
+		for (size_t i = 0; i < bindingCount; i++) {
+			if (bindings[i]->twinReportPending && bindings[i]->reportDue) {
+				RecordReported(bindings[i], &now, _reportSequence);
+			}
+		}
+
+		if (documentPending) {
+			ReportedPathsSent(_reportSequence);
+		}
+	}
+
+	if (reportedPropertiesString != _reportScratch) {
+		lp_heapFree(LP_HEAP_TWINS, reportedPropertiesString);
+	}
+
+	return result;
+}
+
+/// <summary>
+///     Report a device twin property. With no flush interval set the property is sent straight away, otherwise
+///     the binding is marked dirty and all dirty bindings in the device twin set are sent together as one
+///     document when the interval expires or lp_flushReportedState is called. While IoT Hub is not connected
+///     the latest value is kept and reported once the connection authenticates. A report IoT Hub refuses, or that a
+///     disconnect leaves unacknowledged, is sent again, see lp_deviceTwinsReportStatusCallback.
+///     Changes inside the binding's deadband are dropped and changes inside its minimum report interval are
+///     held until the interval expires.
+/// </summary>
+bool lp_deviceTwinReportState(LP_DEVICE_TWIN_BINDING* deviceTwinBinding, void* state) {
+	if (deviceTwinBinding == NULL || state == NULL) {
+		return false;
+	}
+
+	_twinStats.reportCalls++;
+
+	if (IsInsignificantChange(deviceTwinBinding, state)) {
+		_twinStats.deadbandDropped++;
+		return true;
+	}
+
+	if (deviceTwinBinding->twinReportPending) {
+		_twinStats.coalesced++;
+	}
+
+	if (!SetReportedValue(deviceTwinBinding, state)) {
+		return false;
+	}
+
+	if (!lp_connectToAzureIot()) {
+		return false;
+	}
+
+	int holdMs = ReportHoldMs(deviceTwinBinding);
+	if (holdMs > 0) {
+		ArmReportedStateFlush(holdMs);
+		return true;
+	}
+
+	if (_reportedStateFlushIntervalMs == 0) {
+		if (_applyingDesired) {
+			_reportAfterCommit = true;		// sent with the other reports of this desired update
+			return true;
+		}
+		return ReportBindings(&deviceTwinBinding, 1);
+	}
+
+	ArmReportedStateFlush(_reportedStateFlushIntervalMs);
+
+	return true;
+}
+
+/// <summary>
+///     Send every dirty binding in the device twin set as a single reported properties document.
+///     Called by the flush timer and when the IoT Hub connection authenticates.
+/// </summary>
+bool lp_flushReportedState(void) {
+	if ((_deviceTwins == NULL && _reportedPathCount == 0) || !lp_connectToAzureIot()) {
+		return false;
+	}
+
+	return ReportBindings(_deviceTwins, _deviceTwinCount);
+}
+
+/// <summary>
+///     Run commitHandler once per desired update, after every changed binding is applied and its handler has run,
+///     with the changed bindings in document order. A string binding's twinState is valid until it returns. Reports
+///     made by the handlers and the commit handler go out together as one reported properties document.
+/// </summary>
+void lp_setDeviceTwinCommitHandler(void (*commitHandler)(LP_DEVICE_TWIN_BINDING* changed[], size_t changedCount)) {
+	_commitHandler = commitHandler;
+}
+
+/// <summary>
+///     Coalesce reported property updates for up to intervalMs, 0 reports each update immediately
+/// </summary>
+void lp_setReportedStateFlushInterval(int intervalMs) {
+	_reportedStateFlushIntervalMs = intervalMs < 0 ? 0 : intervalMs;
+
+	if (_reportedStateFlushIntervalMs > 0 && reportedStateFlushTimer.eventLoopTimer == NULL) {
+		lp_startTimer(&reportedStateFlushTimer);
+	}
+}
+
+bool lp_reportedDocumentSet(const char* path, const JSON_Value* value) {
+	return value != NULL && SetReportedDocument(path, value);
+}
+
+bool lp_reportedDocumentSetNumber(const char* path, double number) {
+	JSON_Value* value = json_value_init_number(number);
+	bool result = value != NULL && SetReportedDocument(path, value);
+
+	json_value_free(value);
+	return result;
+}
+
+bool lp_reportedDocumentSetString(const char* path, const char* string) {
+	JSON_Value* value = json_value_init_string(string);
+	bool result = value != NULL && SetReportedDocument(path, value);
+
+	json_value_free(value);
+	return result;
+}
+
+bool lp_reportedDocumentSetBoolean(const char* path, bool boolean) {
+	JSON_Value* value = json_value_init_boolean(boolean);
+	bool result = value != NULL && SetReportedDocument(path, value);
+
+	json_value_free(value);
+	return result;
+}
+
+bool lp_reportedDocumentRemove(const char* path) {
+	return SetReportedDocument(path, NULL);
+}
+
+const JSON_Object* lp_getReportedDocument(void) {
+	return json_value_get_object(_reportedDocument);
+}
+
+/// <summary>
+///     Reported property counters since start, coalesced and deadband dropped values cost no twin update
+/// </summary>
+void lp_getDeviceTwinStats(LP_DEVICE_TWIN_STATS* stats) {
+	if (stats != NULL) {
+		*stats = _twinStats;
+	}
+}
+
+/// <summary>
+///     Keep the desired values applied and their $version in mutable storage and apply them again when the next
+///     start opens the device twin set, so twin driven state does not wait for the cloud connection. The full
+///     twin that follows is reconciled like any other, an unchanged $version is skipped and changed values fire
+///     their handlers.
+/// </summary>
+void lp_enableDeviceTwinCache(void) {
+	_twinCacheEnabled = true;
+}
+
+/// <summary>
+///     Append value as the body of a JSON string, returns the length written or -1 when it does not fit
+/// </summary>
+static int EscapeJsonString(char* buffer, size_t capacity, const char* value) {
+	size_t len = 0;
+
+	for (; *value != 0; value++) {
+		unsigned char c = (unsigned char)*value;
+		int needed = c == '"' || c == '\\' ? 2 : c < 0x20 ? 6 : 1;
+
+		if (len + (size_t)needed >= capacity) {
+			return -1;
+		}
+
+		if (needed == 2) {
+			buffer[len++] = '\\';
+			buffer[len++] = (char)c;
+		} else if (needed == 6) {
+			snprintf(buffer + len, capacity - len, "\\u%04x", c);
+			len += 6;
+		} else {
+			buffer[len++] = (char)c;
+		}
+	}
+
+	buffer[len] = 0;
+	return (int)len;
+}
+
+/// <summary>
+///     Write the applied desired values as one desired patch with its $version, text first and the header last
+/// </summary>
+static void SaveTwinCache(void) {
+	char text[LP_STORAGE_TWIN_CACHE_SIZE - sizeof(TWIN_CACHE_HEADER)];
+	TWIN_CACHE_HEADER header = { .magic = LP_TWIN_CACHE_MAGIC };
+	size_t len = 0;
+	int fieldLen = 0;
+
+	_twinCacheDirty = false;
+
+	if (_twinCacheFd == -1) {
+		return;
+	}
+
+	text[len++] = '{';
+
+	for (size_t i = 0; i < _deviceTwinCount && fieldLen >= 0; i++) {
+		LP_DEVICE_TWIN_BINDING* binding = _deviceTwins[i];
+		const char* separator = len > 1 ? "," : "";
+
+		if (!binding->desiredApplied) {
+			continue;
+		}
+
+		switch (binding->twinType) {
+		case LP_TYPE_INT:
+			fieldLen = snprintf(text + len, sizeof(text) - len, "%s\"%s\":{\"value\":%d}", separator, binding->twinProperty,
+				(int)binding->lastDesiredValue);
+			break;
+		case LP_TYPE_FLOAT:
+			fieldLen = snprintf(text + len, sizeof(text) - len, "%s\"%s\":{\"value\":%.9g}", separator, binding->twinProperty,
+				binding->lastDesiredValue);
+			break;
+		case LP_TYPE_BOOL:
+			fieldLen = snprintf(text + len, sizeof(text) - len, "%s\"%s\":{\"value\":%s}", separator, binding->twinProperty,
+				binding->lastDesiredValue != 0 ? "true" : "false");
+			break;
+		case LP_TYPE_STRING:
+			if (binding->desiredString == NULL) {
+				continue;
+			}
+			fieldLen = snprintf(text + len, sizeof(text) - len, "%s\"%s\":{\"value\":\"", separator, binding->twinProperty);
+			if (fieldLen >= 0 && (size_t)fieldLen < sizeof(text) - len) {
+				int valueLen = EscapeJsonString(text + len + (size_t)fieldLen, sizeof(text) - len - (size_t)fieldLen, binding->desiredString);
+				fieldLen = valueLen < 0 ? -1 : fieldLen + valueLen;
+			}
+			if (fieldLen >= 0) {
+				int closeLen = snprintf(text + len + (size_t)fieldLen, sizeof(text) - len - (size_t)fieldLen, "\"}");
+				fieldLen = closeLen < 0 ? -1 : fieldLen + closeLen;
+			}
+			break;
+		default:
+			continue;
+		}
+
+		if (fieldLen < 0 || (size_t)fieldLen >= sizeof(text) - len) {
+			fieldLen = -1;
+			break;
+		}
+		len += (size_t)fieldLen;
+	}
+
+	if (fieldLen >= 0 && _desiredVersionValid) {
+		fieldLen = snprintf(text + len, sizeof(text) - len, "%s\"$version\":%.0f", len > 1 ? "," : "", _desiredVersion);
+		fieldLen = fieldLen < 0 || (size_t)fieldLen >= sizeof(text) - len ? -1 : fieldLen;
+		len += fieldLen > 0 ? (size_t)fieldLen : 0;
+	}
+
+	if (fieldLen < 0 || len + 2 > sizeof(text)) {
+		// an out of date cache would undo newer desired values on the next start, so drop it
+		LP_LOG(LP_LOG_WARNING, "WARNING: Device Twin desired state larger than the %d byte cache, cache cleared\n", LP_STORAGE_TWIN_CACHE_SIZE);
+		header.magic = 0;
+	} else {
+		text[len++] = '}';
+		text[len] = 0;
+		header.length = (uint32_t)len;
+		header.hash = HashString(text);
+
+		if (lseek(_twinCacheFd, LP_STORAGE_TWIN_CACHE_OFFSET + (off_t)sizeof(TWIN_CACHE_HEADER), SEEK_SET) == -1 ||
+			write(_twinCacheFd, text, len) != (ssize_t)len) {
+			LP_LOG(LP_LOG_ERROR, "ERROR: Device Twin cache write failed: %s (%d)\n", strerror(errno), errno);
+			return;
+		}
+	}
+
+	if (lseek(_twinCacheFd, LP_STORAGE_TWIN_CACHE_OFFSET, SEEK_SET) == -1 ||
+		write(_twinCacheFd, &header, sizeof(TWIN_CACHE_HEADER)) != sizeof(TWIN_CACHE_HEADER)) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: Device Twin cache write failed: %s (%d)\n", strerror(errno), errno);
+	}
+}
+
+/// <summary>
+///     Replay the cached desired patch through lp_twinCallback, firing the handlers before the cloud connects
+/// </summary>
+static void LoadTwinCache(void) {
+	char text[LP_STORAGE_TWIN_CACHE_SIZE - sizeof(TWIN_CACHE_HEADER) + 1];
+	TWIN_CACHE_HEADER header;
+
+	if (_twinCacheFd == -1) {
+		return;
+	}
+
+	if (lseek(_twinCacheFd, LP_STORAGE_TWIN_CACHE_OFFSET, SEEK_SET) == -1 ||
+		read(_twinCacheFd, &header, sizeof(TWIN_CACHE_HEADER)) != sizeof(TWIN_CACHE_HEADER) ||
+		header.magic != LP_TWIN_CACHE_MAGIC || header.length == 0 || header.length >= sizeof(text) ||
+		read(_twinCacheFd, text, header.length) != (ssize_t)header.length) {
+		return;
+	}
+
+	text[header.length] = 0;
+	if (HashString(text) != header.hash) {
+		LP_LOG(LP_LOG_WARNING, "WARNING: Device Twin cache is corrupt, waiting for the cloud twin\n");
+		return;
+	}
+
+	LP_LOG(LP_LOG_INFO, "INFO: Device Twin desired state applied from the warm start cache\n");
+
+	_twinCacheLoading = true;
+	lp_twinCallback(DEVICE_TWIN_UPDATE_PARTIAL, (const unsigned char*)text, header.length, NULL);
+	_twinCacheLoading = false;
+	_twinCacheDirty = false;
+}
+
+static void ReportedStateFlushHandler(EventLoopTimer* eventLoopTimer) {
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_ReportedStateFlushHandler);
+		return;
+	}
+
+	_reportedStateFlushArmed = false;
+	lp_flushReportedState();
+}
+
+static size_t TwinStateSize(LP_DEVICE_TWIN_TYPE twinType) {
+	switch (twinType) {
+	case LP_TYPE_INT:
+		return sizeof(int);
+	case LP_TYPE_FLOAT:
+		return sizeof(float);
+	case LP_TYPE_BOOL:
+		return sizeof(bool);
+	default:
+		return 0;
+	}
+}
+
+static bool DeviceTwinUpdateReportedState(char* reportedPropertiesString, uint32_t sequence) {
+	if (!lp_sendReportedState((unsigned char*)reportedPropertiesString, strlen(reportedPropertiesString),
+		lp_deviceTwinsReportStatusCallback, (void*)(uintptr_t)sequence)) 
+	{
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: failed to set reported state for '%s'.\n", reportedPropertiesString);
+		return false;
+	}
+	else {
+		LP_LOG(LP_LOG_DEBUG, "INFO: Reported state twinStateUpdated '%s'.\n", reportedPropertiesString);
+		lp_pumpCloudToDevice();
+		return true;
+	}
+}
+
+
+/// <summary>
+///     Callback invoked when IoT Hub accepts or refuses a reported properties document, context is its sequence.
+///     The bindings it carried are acknowledged, or pending again and retried with backoff, unless a later report
+///     of the binding has replaced it.
+/// </summary>
+void lp_deviceTwinsReportStatusCallback(int result, void* context) {
+	uint32_t sequence = (uint32_t)(uintptr_t)context;
+	bool accepted = result >= 200 && result < 300;
+
+	LP_LOG(LP_LOG_DEBUG, "INFO: Device Twin reported properties update result: HTTP status code %d\n", result);
+
+	if (sequence == 0) {
+		return;
+	}
+
+	if (accepted) {
+		_twinStats.acknowledged++;
+		_reportRetryMs = 0;
+	}
+	else {
+		_twinStats.refused++;
+		_reportRetryMs = _reportRetryMs == 0 ? LP_REPORT_RETRY_MIN_MS : _reportRetryMs * 2;
+		_reportRetryMs = _reportRetryMs > LP_REPORT_RETRY_MAX_MS ? LP_REPORT_RETRY_MAX_MS : _reportRetryMs;
+		clock_gettime(CLOCK_MONOTONIC, &_reportRetryAt);
+		_reportRetryAt.tv_sec += _reportRetryMs / 1000;
+		_reportRetryAt.tv_nsec += (_reportRetryMs % 1000) * 1000000;
+		if (_reportRetryAt.tv_nsec >= 1000000000) {
+			_reportRetryAt.tv_sec++;
+			_reportRetryAt.tv_nsec -= 1000000000;
+		}
+		LP_LOG_LIMITED(LP_LOG_WARNING, LP_LOG_LIMIT_MS, "WARNING: reported properties refused with status %d, retrying in %d ms\n", result, _reportRetryMs);
+	}
+
+	ReportedPathsAcknowledged(sequence, accepted);
+
+	for (size_t i = 0; _deviceTwins != NULL && i < _deviceTwinCount; i++) {
+		LP_DEVICE_TWIN_BINDING* binding = _deviceTwins[i];
+
+		if (binding->reportState != LP_REPORT_IN_FLIGHT || binding->reportSequence != sequence) {
+			continue;
+		}
+
+		binding->reportStatus = result;
+		if (accepted) {
+			binding->reportState = LP_REPORT_ACKED;
+		}
+		else {
+			binding->reportState = LP_REPORT_FAILED;		// twinState holds the value, or a newer one, to send again
+			binding->twinReportPending = true;
+			_twinStats.resent++;
+		}
+	}
+
+	if (!accepted) {
+		ArmReportedStateFlush(_reportRetryMs);
+	}
+}
+
+/// <summary>
+///     Called when the IoT Hub connection authenticates. Reports still in flight went to the previous connection and
+///     may never be acknowledged, they are marked pending and sent with the dirty bindings, acknowledged ones are not.
+/// </summary>
+void lp_resendReportedState(void) {
+	_reportRetryMs = 0;
+
+	ReportedPathsAcknowledged(0, false);
+
+	for (size_t i = 0; _deviceTwins != NULL && i < _deviceTwinCount; i++) {
+		if (_deviceTwins[i]->reportState == LP_REPORT_IN_FLIGHT) {
+			_deviceTwins[i]->reportState = LP_REPORT_PENDING;
+			_deviceTwins[i]->twinReportPending = true;
+			_twinStats.resent++;
+		}
+	}
+
+	lp_flushReportedState();
 }
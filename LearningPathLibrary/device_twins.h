@@ -1,9 +1,12 @@
 #pragma once
 
 #include "azure_iot.h"
+#include "build_options.h"
+#include "mutable_storage.h"
 #include "parson.h"
 #include "peripheral_gpio.h"
 #include <iothub_device_client_ll.h>
+#include <time.h>
 
 typedef enum {
 	LP_TYPE_UNKNOWN = 0,
@@ -13,18 +16,66 @@ typedef enum {
 	LP_TYPE_STRING = 4
 } LP_DEVICE_TWIN_TYPE;
 
+typedef enum {
+	LP_REPORT_NONE = 0,				// not reported yet
+	LP_REPORT_PENDING,				// waiting for a flush, or for a retry after a failure
+	LP_REPORT_IN_FLIGHT,			// handed to the SDK, not acknowledged yet
+	LP_REPORT_ACKED,				// IoT Hub accepted the last report
+	LP_REPORT_FAILED				// IoT Hub refused it, pending again until the retry
+} LP_DEVICE_TWIN_REPORT_STATE;
+
 struct _deviceTwinBinding {
-	const char* twinProperty;
+	const char* twinProperty;		// interned in parson once the set is opened, keep it valid for the life of the app
 	void* twinState;
+	union {
+		int intValue;
+		float floatValue;
+		bool boolValue;
+	} twinValue;					// inline storage twinState points at for int, float and bool bindings, tagged by twinType
 	bool twinStateUpdated;
+	bool desiredApplied;
+	double lastDesiredValue;		// last desired value applied, strings keep a hash
+	char* desiredString;			// last desired string applied, kept only for the warm start cache
+	bool twinReportPending;
+	char* reportedString;
+	size_t reportedStringCapacity;
+	float deadband;					// LP_TYPE_FLOAT reports within this absolute change of the last report are skipped
+	float deadbandPercent;			// or within this percentage of the last reported value, ints, bools and strings skip exact repeats
+	int minReportIntervalMs;		// significant changes inside this interval are held and reported when it expires
+	bool lastReportValid;
+	bool reportDue;
+	double lastReportedValue;
+	struct timespec lastReportedAt;
+	LP_DEVICE_TWIN_REPORT_STATE reportState;
+	int reportStatus;				// HTTP status of the last report acknowledged or refused, 0 before the first
+	uint32_t reportSequence;		// the document carrying the report in flight
+	int ackStatus;					// writable property acknowledgement, see lp_setWritablePropertyAcks
+	uint32_t ackVersion;			// desired $version acknowledged, 0 until the first
+	const char* ackDescription;
 	LP_DEVICE_TWIN_TYPE twinType;
 	void (*handler)(struct _deviceTwinBinding* deviceTwinBinding);
 };
 
 typedef struct _deviceTwinBinding LP_DEVICE_TWIN_BINDING;
 
+typedef struct LP_DEVICE_TWIN_STATS
+{
+	uint32_t reportCalls;			// lp_deviceTwinReportState
+	uint32_t coalesced;				// values replaced before they were reported
+	uint32_t deadbandDropped;		// values inside the binding's deadband of the last report
+	uint32_t documents;				// reported property documents handed to the SDK
+	uint32_t documentFailures;
+	uint32_t acknowledged;			// documents IoT Hub accepted
+	uint32_t refused;				// documents IoT Hub refused or dropped, 429 throttling and disconnects
+	uint32_t resent;				// properties reported again after a refusal or a reconnect
+	uint32_t acks;					// writable property acknowledgements queued
+	uint32_t documentPaths;			// reported document paths sent, see lp_reportedDocumentSet
+} LP_DEVICE_TWIN_STATS;
+
 void lp_twinCallback(DEVICE_TWIN_UPDATE_STATE updateState, const unsigned char* payload, size_t payloadSize, void* userContextCallback);
 void lp_deviceTwinsReportStatusCallback(int result, void* context);
+// once authenticated, reports the previous connection left unacknowledged are sent again with the dirty bindings
+void lp_resendReportedState(void);
 
 void lp_openDeviceTwinSet(LP_DEVICE_TWIN_BINDING* deviceTwins[], size_t deviceTwinCount);
 void lp_closeDeviceTwinSet(void);
@@ -32,3 +83,28 @@ void lp_closeDeviceTwinSet(void);
 void lp_openDeviceTwin(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
 void lp_closeDeviceTwin(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
 bool lp_deviceTwinReportState(LP_DEVICE_TWIN_BINDING* deviceTwinBinding, void* state);
+bool lp_flushReportedState(void);
+void lp_setReportedStateFlushInterval(int intervalMs);
+// Reported properties a binding cannot express, nested objects and arrays, kept as one document that mirrors the
+// reported section. path is dotted, "location.lat", and the value is copied in. A set is diffed against the
+// document and only the paths it changed are marked, parents of a changed member are not; the next flush sends
+// them as a merge patch in the same PATCH as the dirty bindings, a removed member as null. So a flush costs the
+// changes since the last one, not the size of the document. An unchanged value, numbers within parson's epsilon,
+// marks nothing. Members whose name has a '.' are tracked with the object they are in.
+bool lp_reportedDocumentSet(const char* path, const JSON_Value* value);
+bool lp_reportedDocumentSetNumber(const char* path, double number);
+bool lp_reportedDocumentSetString(const char* path, const char* string);
+bool lp_reportedDocumentSetBoolean(const char* path, bool boolean);
+bool lp_reportedDocumentRemove(const char* path);
+// read only, NULL before the first set
+const JSON_Object* lp_getReportedDocument(void);
+// IoT Plug and Play writable property acknowledgements, call before lp_openDeviceTwinSet. Each desired change is
+// reported back as {"value":..,"ac":200,"av":$version,"ad":"completed"} in the coalesced flush, a handler or the
+// commit handler may change the outcome with lp_ackDesiredState, description a string literal.
+void lp_setWritablePropertyAcks(bool enabled);
+void lp_ackDesiredState(LP_DEVICE_TWIN_BINDING* deviceTwinBinding, int status, const char* description);
+// apply every changed binding of a desired update, then combine their side effects in one call
+void lp_setDeviceTwinCommitHandler(void (*commitHandler)(LP_DEVICE_TWIN_BINDING* changed[], size_t changedCount));
+void lp_getDeviceTwinStats(LP_DEVICE_TWIN_STATS* stats);
+// call before lp_openDeviceTwinSet, needs "MutableStorage" in the manifest, see mutable_storage.h
+void lp_enableDeviceTwinCache(void);
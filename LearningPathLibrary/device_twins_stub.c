@@ -0,0 +1,73 @@
+#include "device_twins.h"
+
+// Built in place of device_twins.c when LP_ENABLE_TWINS is OFF, the twin callback is not registered with the
+// SDK so no desired properties arrive and nothing is reported.
+
+void lp_openDeviceTwinSet(LP_DEVICE_TWIN_BINDING* deviceTwins[], size_t deviceTwinCount) {
+	if (deviceTwinCount > 0) {
+		LP_LOG(LP_LOG_WARNING, "WARNING: device twins are not compiled in, LP_ENABLE_TWINS is OFF\n");
+	}
+}
+
+void lp_closeDeviceTwinSet(void) {}
+
+void lp_openDeviceTwin(LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {}
+
+void lp_closeDeviceTwin(LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {}
+
+void lp_twinCallback(DEVICE_TWIN_UPDATE_STATE updateState, const unsigned char* payload, size_t payloadSize, void* userContextCallback) {}
+
+bool lp_deviceTwinReportState(LP_DEVICE_TWIN_BINDING* deviceTwinBinding, void* state) {
+	return false;
+}
+
+bool lp_flushReportedState(void) {
+	return false;
+}
+
+void lp_resendReportedState(void) {}
+
+void lp_setReportedStateFlushInterval(int intervalMs) {}
+
+bool lp_reportedDocumentSet(const char* path, const JSON_Value* value) {
+	return false;
+}
+
+bool lp_reportedDocumentSetNumber(const char* path, double number) {
+	return false;
+}
+
+bool lp_reportedDocumentSetString(const char* path, const char* string) {
+	return false;
+}
+
+bool lp_reportedDocumentSetBoolean(const char* path, bool boolean) {
+	return false;
+}
+
+bool lp_reportedDocumentRemove(const char* path) {
+	return false;
+}
+
+const JSON_Object* lp_getReportedDocument(void) {
+	return NULL;
+}
+
+void lp_setWritablePropertyAcks(bool enabled) {}
+
+void lp_ackDesiredState(LP_DEVICE_TWIN_BINDING* deviceTwinBinding, int status, const char* description) {}
+
+void lp_setDeviceTwinCommitHandler(void (*commitHandler)(LP_DEVICE_TWIN_BINDING* changed[], size_t changedCount)) {}
+
+void lp_enableDeviceTwinCache(void) {}
+
+void lp_getDeviceTwinStats(LP_DEVICE_TWIN_STATS* stats) {
+	if (stats != NULL) {
+		*stats = (LP_DEVICE_TWIN_STATS){ 0 };
+	}
+}
+
+// lp_reportTelemetryStats and lp_reportBootTimeline send reported properties without bindings
+void lp_deviceTwinsReportStatusCallback(int result, void* context) {
+	LP_LOG(LP_LOG_DEBUG, "INFO: Device Twin reported properties update result: HTTP status code %d\n", result);
+}
@@ -1,143 +1,954 @@
 #include "direct_methods.h"
+#include "event_trace.h"
+#include "inter_core.h"
+#include "memory_governor.h"
 
 static LP_DIRECT_METHOD_BINDING** _directMethods;
 static size_t _directMethodCount;
+static LP_DIRECT_METHOD_BINDING** _directMethodIndex = NULL;
+static bool _directMethodIndexOwned = false;		// false when the set was already sorted and is its own index
+
+// common responses are sent from static data, already quoted as JSON strings
+static const char methodSucceededResponse[] = "\"Method Succeeded\"";
+static const char methodNotFoundResponse[] = "\"Method not found\"";
+static const char methodErrorResponse[] = "\"Method Error\"";
+static const char methodBusyResponse[] = "\"Method Busy\"";
+static const char methodTimeoutResponse[] = "\"Method Timeout\"";
+static const char invalidJsonResponse[] = "\"Invalid JSON\"";
+static const char methodPendingResponse[] = "\"Method can not be pending in a batch\"";
+static const char payloadTooLargeResponse[] = "\"Payload too large, memory low\"";
+static const char forwardTooLargeResponse[] = "\"Payload too large for the real-time app\"";
+static const char realTimeUnavailableResponse[] = "\"Real-time app not available\"";
+
+// custom response for the invocation in progress that is JSON other than a string, set by Batch
+static char _batchResponse[LP_METHOD_BATCH_RESPONSE_SIZE];
+static size_t _jsonResponseLength = 0;
+
+#define LP_METHOD_BATCH_SHORT_RESULT 40		// ,{"status":-2147483648,"response":null} with room to spare
+
+// custom response for the invocation in progress, set by the handler with lp_setMethodResponse
+static char _methodResponse[LP_METHOD_RESPONSE_SIZE];
+static size_t _methodResponseLength = 0;
+
+// LP_IC_METHOD of the invocation being forwarded, copied again by the inter-core send
+static uint8_t _forwardMessage[LP_INTER_CORE_MAX_MESSAGE_SIZE];
+static uint16_t _forwardSequence = 0;
+
+static void DirectMethodTimeoutHandler(EventLoopTimer* eventLoopTimer);
+
+static LP_TIMER directMethodTimeoutTimer = {
+	.period = { 0, 0 },			// one-shot timer, armed for the nearest pending method deadline
+	.name = "directMethodTimeoutTimer",
+	.handler = &DirectMethodTimeoutHandler
+};
+
+static int ElapsedMs(const struct timespec* from, const struct timespec* to);
+static void ForwardedMethodResponseHandler(LP_INTER_CORE_CMD cmd, const uint8_t* payload, size_t length);
+
+static int CompareMethodName(const void* a, const void* b)
+{
+	return strcmp((*(LP_DIRECT_METHOD_BINDING* const*)a)->methodName, (*(LP_DIRECT_METHOD_BINDING* const*)b)->methodName);
+}
+
+static bool IsSortedByName(LP_DIRECT_METHOD_BINDING* directMethods[], size_t directMethodCount)
+{
+	for (size_t i = 1; i < directMethodCount; i++)
+	{
+		if (strcmp(directMethods[i - 1]->methodName, directMethods[i]->methodName) > 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+///     Binary search the sorted method table, linear scan if the table could not be allocated
+/// </summary>
+static LP_DIRECT_METHOD_BINDING* FindDirectMethod(const char* methodName)
+{
+	size_t low = 0;
+	size_t high = _directMethodCount;
+
+	if (methodName == NULL)
+	{
+		return NULL;
+	}
+
+	if (_directMethodIndex == NULL)
+	{
+		for (size_t i = 0; i < _directMethodCount; i++)
+		{
+			if (strcmp(methodName, _directMethods[i]->methodName) == 0)
+			{
+				return _directMethods[i];
+			}
+		}
+		return NULL;
+	}
+
+	while (low < high)
+	{
+		size_t mid = low + (high - low) / 2;
+		int cmp = strcmp(methodName, _directMethodIndex[mid]->methodName);
+
+		if (cmp == 0)
+		{
+			return _directMethodIndex[mid];
+		}
+		if (cmp < 0)
+		{
+			high = mid;
+		}
+		else
+		{
+			low = mid + 1;
+		}
+	}
+
+	return NULL;
+}
 
 void lp_openDirectMethodSet(LP_DIRECT_METHOD_BINDING* directMethods[], size_t directMethodCount)
 {
 	_directMethods = directMethods;
 	_directMethodCount = directMethodCount;
+
+	lp_setInterCoreMethodResponseHandler(ForwardedMethodResponseHandler);
+
+	// sorted by method name so each invocation resolves with a binary search, a set declared in name order,
+	// see LP_DIRECT_METHOD_TABLE, is searched in place
+	if (IsSortedByName(directMethods, directMethodCount))
+	{
+		_directMethodIndex = directMethods;
+		_directMethodIndexOwned = false;
+		return;
+	}
+
+	_directMethodIndex = (LP_DIRECT_METHOD_BINDING**)lp_heapMalloc(LP_HEAP_METHODS, directMethodCount * sizeof(LP_DIRECT_METHOD_BINDING*));
+	_directMethodIndexOwned = _directMethodIndex != NULL;
+	if (_directMethodIndex != NULL)
+	{
+		memcpy(_directMethodIndex, directMethods, directMethodCount * sizeof(LP_DIRECT_METHOD_BINDING*));
+		qsort(_directMethodIndex, directMethodCount, sizeof(LP_DIRECT_METHOD_BINDING*), CompareMethodName);
+	}
 }
 
 void lp_closeDirectMethodSet(void)
 {
+	lp_abandonDirectMethods();
+	lp_invalidateDirectMethodCache(NULL);
+	lp_setInterCoreMethodResponseHandler(NULL);
+
+	if (directMethodTimeoutTimer.eventLoopTimer != NULL)
+	{
+		lp_stopTimer(&directMethodTimeoutTimer);
+	}
+
+	if (_directMethodIndexOwned)
+	{
+		lp_heapFree(LP_HEAP_METHODS, _directMethodIndex);
+	}
+	_directMethodIndex = NULL;
+	_directMethodIndexOwned = false;
+
 	_directMethods = NULL;
 	_directMethodCount = 0;
 }
 
-/*
-This implementation of Direct Methods expects a JSON Payload Object
-*/
-int lp_azureDirectMethodHandler(const char* method_name, const unsigned char* payload, size_t payloadSize,
-	unsigned char** responsePayload, size_t* responsePayloadSize, void* userContextCallback)
+/// <summary>
+///     Escape text for a JSON string without splitting an escape sequence, false when text did not fit in capacity bytes
+/// </summary>
+bool lp_escapeJsonString(const char* text, char* out, size_t capacity, size_t* written)
+{
+	static const char hex[] = "0123456789abcdef";
+	size_t length = 0;
+
+	for (; text != NULL && *text != 0; text++)
+	{
+		unsigned char c = (unsigned char)*text;
+		size_t needed = (c == '"' || c == '\\') ? 2 : c < 0x20 ? 6 : 1;
+
+		if (length + needed > capacity)
+		{
+			*written = length;
+			return false;
+		}
+
+		if (needed == 2)
+		{
+			out[length++] = '\\';
+			out[length++] = (char)c;
+		}
+		else if (needed == 6)
+		{
+			memcpy(out + length, "\\u00", 4);
+			out[length + 4] = hex[c >> 4];
+			out[length + 5] = hex[c & 0xF];
+			length += 6;
+		}
+		else
+		{
+			out[length++] = (char)c;
+		}
+	}
+
+	*written = length;
+	return true;
+}
+
+/// <summary>
+///     Quote message as a JSON string into out, returns the payload length
+/// </summary>
+static size_t QuoteResponse(const char* message, char* out, size_t capacity, bool* complete)
+{
+	size_t written = 0;
+
+	out[0] = '"';
+	*complete = lp_escapeJsonString(message, out + 1, capacity - 2, &written);
+	out[written + 1] = '"';
+
+	return written + 2;
+}
+
+/// <summary>
+///     Set the response message for the direct method being handled, printf style and JSON escaped into a preallocated
+///     LP_METHOD_RESPONSE_SIZE buffer. Returns false if the message was truncated.
+/// </summary>
+bool lp_setMethodResponse(const char* format, ...)
 {
+	char message[LP_METHOD_RESPONSE_SIZE];
+	bool complete = false;
+	va_list args;
 
-	const char* methodSucceededMsg = "Method Succeeded";
-	const char* methodNotFoundMsg = "Method not found";
-	const char* methodErrorMsg = "Method Error";
-	const char* mallocFailedMsg = "Memory Allocation failed";
-	const char* invalidJsonMsg = "Invalid JSON";
+	va_start(args, format);
+	int length = vsnprintf(message, sizeof(message), format, args);
+	va_end(args);
 
+	if (length < 0)
+	{
+		_methodResponseLength = 0;
+		return false;
+	}
+
+	_methodResponseLength = QuoteResponse(message, _methodResponse, sizeof(_methodResponse), &complete);
+
+	return complete && (size_t)length < sizeof(message);
+}
+
+/// <summary>
+///     Send the response for an invocation accepted through the inbound method callback, the SDK copies the payload
+/// </summary>
+static bool SendMethodResponse(METHOD_HANDLE methodId, int responseCode, const unsigned char* responsePayload, size_t responsePayloadSize)
+{
+	lp_kickCloudToDevice();	// deliver the response promptly
+
+	return lp_sendMethodResponse(methodId, responseCode, responsePayload, responsePayloadSize);
+}
+
+/// <summary>
+///     FNV-1a of the payload, a cached response answers only the payload it was built for
+/// </summary>
+static uint32_t HashPayload(const unsigned char* payload, size_t payloadSize)
+{
+	uint32_t hash = 2166136261u;
+
+	for (size_t i = 0; i < payloadSize; i++)
+	{
+		hash = (hash ^ payload[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+/// <summary>
+///     The cached response when it is still live and was built for this payload
+/// </summary>
+static bool FindCachedResponse(LP_DIRECT_METHOD_BINDING* directMethodBinding, const unsigned char* payload, size_t payloadSize)
+{
+	struct timespec now;
+
+	if (directMethodBinding->cachedResponse == NULL || directMethodBinding->cachedPayloadSize != payloadSize)
+	{
+		return false;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (ElapsedMs(&directMethodBinding->cachedUntil, &now) >= 0)
+	{
+		lp_invalidateDirectMethodCache(directMethodBinding);
+		return false;
+	}
+
+	return directMethodBinding->cachedPayloadHash == HashPayload(payload, payloadSize);
+}
+
+/// <summary>
+///     Keep a copy of a succeeded response for cacheTtlMs, one response per method, the newest payload's
+/// </summary>
+static void CacheResponse(LP_DIRECT_METHOD_BINDING* directMethodBinding, const unsigned char* payload, size_t payloadSize,
+	const char* response, size_t responseLength)
+{
+	char* copy;
+
+	if (directMethodBinding->cachedResponse == NULL || directMethodBinding->cachedResponseLength < responseLength)
+	{
+		copy = (char*)lp_heapMalloc(LP_HEAP_METHODS, responseLength);
+		if (copy == NULL)
+		{
+			return;		// served uncached
+		}
+		lp_invalidateDirectMethodCache(directMethodBinding);
+		directMethodBinding->cachedResponse = copy;
+	}
+
+	memcpy(directMethodBinding->cachedResponse, response, responseLength);
+	directMethodBinding->cachedResponseLength = responseLength;
+	directMethodBinding->cachedPayloadHash = HashPayload(payload, payloadSize);
+	directMethodBinding->cachedPayloadSize = payloadSize;
+
+	clock_gettime(CLOCK_MONOTONIC, &directMethodBinding->cachedUntil);
+	directMethodBinding->cachedUntil.tv_sec += directMethodBinding->cacheTtlMs / 1000;
+	directMethodBinding->cachedUntil.tv_nsec += (directMethodBinding->cacheTtlMs % 1000) * 1000000;
+	if (directMethodBinding->cachedUntil.tv_nsec >= 1000000000)
+	{
+		directMethodBinding->cachedUntil.tv_sec++;
+		directMethodBinding->cachedUntil.tv_nsec -= 1000000000;
+	}
+}
+
+void lp_invalidateDirectMethodCache(LP_DIRECT_METHOD_BINDING* directMethodBinding)
+{
+	if (directMethodBinding == NULL)
+	{
+		for (size_t i = 0; i < _directMethodCount; i++)
+		{
+			lp_invalidateDirectMethodCache(_directMethods[i]);
+		}
+		return;
+	}
+
+	if (directMethodBinding->cachedResponse != NULL)
+	{
+		lp_heapFree(LP_HEAP_METHODS, directMethodBinding->cachedResponse);
+		directMethodBinding->cachedResponse = NULL;
+		directMethodBinding->cachedResponseLength = 0;
+	}
+}
+
+/// <summary>
+///     Run the binding handler. The response points at static data or the method response buffer and is valid until the
+///     next invocation, for LP_METHOD_PENDING no response is set.
+/// </summary>
+static int InvokeDirectMethod(LP_DIRECT_METHOD_BINDING* directMethodBinding, const unsigned char* payload, size_t payloadSize,
+	const unsigned char** responsePayload, size_t* responsePayloadSize)
+{
 	LP_DIRECT_METHOD_RESPONSE_CODE responseCode = LP_METHOD_NOT_FOUND;
 	char* responseMsg = NULL;
 
-	LP_DIRECT_METHOD_BINDING* directMethodBinding = NULL;
-
-	const char* responseMessage = methodNotFoundMsg;
+	const char* response = methodNotFoundResponse;
+	size_t responseLength = sizeof(methodNotFoundResponse) - 1;
 	int result = LP_METHOD_NOT_FOUND;
-	size_t responseMessageLength;
 
 	JSON_Value* root_value = NULL;
 	JSON_Object* jsonObject = NULL;
+	bool arenaOpen = false;
+	uint32_t tracedUs = lp_traceNow();
 
-	// Prepare the payload for the response. This is a heap allocated null terminated string.
-	// The Azure IoT Hub SDK is responsible of freeing it.
-	*responsePayload = NULL;  // Response payload content.
-	*responsePayloadSize = 0; // Response payload content size.
+	_methodResponseLength = 0;
+	_jsonResponseLength = 0;
 
-	char* payLoadString = (char*)malloc(payloadSize + 1);
-	if (payLoadString == NULL)
+	// an unknown method is answered without touching the payload
+	if (directMethodBinding == NULL ||
+		(directMethodBinding->handler == NULL && directMethodBinding->rawHandler == NULL && directMethodBinding->forwardCode == LP_IC_METHOD_NONE))
 	{
-		responseMessage = mallocFailedMsg;
-		result = LP_METHOD_FAILED;
 		goto cleanup;
 	}
 
-	memcpy(payLoadString, payload, payloadSize);
-	payLoadString[payloadSize] = 0; //null terminate string
+	// forwarded by the inbound callback only, the synchronous callback and Batch refuse it as pending before it is sent
+	if (directMethodBinding->forwardCode != LP_IC_METHOD_NONE)
+	{
+		response = NULL;
+		responseLength = 0;
+		result = LP_METHOD_PENDING;
+		goto cleanup;
+	}
 
-	root_value = json_parse_string(payLoadString);
-	if (root_value == NULL)
+	// an idempotent method answered a moment ago is answered the same without parsing or calling the handler
+	if (directMethodBinding->cacheTtlMs > 0 && FindCachedResponse(directMethodBinding, payload, payloadSize))
 	{
-		responseMessage = invalidJsonMsg;
-		result = LP_METHOD_FAILED;
+		directMethodBinding->cacheHits++;
+		response = directMethodBinding->cachedResponse;
+		responseLength = directMethodBinding->cachedResponseLength;
+		result = LP_METHOD_SUCCEEDED;
 		goto cleanup;
 	}
 
-	jsonObject = json_value_get_object(root_value);
-	if (jsonObject == NULL)
+	// short of memory a large payload is refused before it is parsed, the caller can retry once the app recovers
+	if (!lp_memoryAdmitPayload(payloadSize))
 	{
-		responseMessage = invalidJsonMsg;
-		result = LP_METHOD_FAILED;
+		response = payloadTooLargeResponse;
+		responseLength = sizeof(payloadTooLargeResponse) - 1;
+		result = LP_METHOD_TOO_LARGE;
 		goto cleanup;
 	}
 
-	// loop through array of DirectMethodBindings looking for a matching method name
-	for (int i = 0; i < _directMethodCount; i++)
+	if (directMethodBinding->rawHandler != NULL)
+	{
+		responseCode = directMethodBinding->rawHandler(payload, payloadSize, directMethodBinding, &responseMsg);
+	}
+	else
 	{
-		if (strcmp(method_name, _directMethods[i]->methodName) == 0)
+		lp_jsonArenaBegin();	// the payload DOM is built in the arena and released in one reset below
+		arenaOpen = true;
+
+		// parsed in place, the SDK buffer is not null terminated
+		root_value = json_parse_stringn((const char*)payload, payloadSize);
+		jsonObject = json_value_get_object(root_value);
+		if (jsonObject == NULL)
 		{
-			directMethodBinding = _directMethods[i];
-			break;
+			response = invalidJsonResponse;
+			responseLength = sizeof(invalidJsonResponse) - 1;
+			result = LP_METHOD_FAILED;
+			goto cleanup;
 		}
+
+		// a pending handler must copy what it needs from json, the DOM is released on return
+		responseCode = directMethodBinding->handler(jsonObject, directMethodBinding, &responseMsg);
 	}
 
-	if (directMethodBinding != NULL && directMethodBinding->handler != NULL)
-	{	// was a LP_DIRECT_METHOD_BINDING found
+	result = (int)responseCode;
 
-		responseCode = directMethodBinding->handler(jsonObject, directMethodBinding, &responseMsg);
+	if (responseMsg != NULL && strlen(responseMsg) > 0)
+	{ // a handler allocated response message, escaped into the response buffer and freed below
+		lp_setMethodResponse("%s", responseMsg);
+	}
+
+	if (responseCode == LP_METHOD_PENDING)
+	{ // 202, answered later by lp_completeDirectMethod
+		response = NULL;
+		responseLength = 0;
+	}
+	else if (_jsonResponseLength > 0)
+	{
+		response = _batchResponse;
+		responseLength = _jsonResponseLength;
+	}
+	else if (_methodResponseLength > 0)
+	{
+		response = _methodResponse;
+		responseLength = _methodResponseLength;
+	}
+	else if (responseCode == LP_METHOD_SUCCEEDED)
+	{
+		response = methodSucceededResponse;
+		responseLength = sizeof(methodSucceededResponse) - 1;
+	}
+	else if (responseCode != LP_METHOD_NOT_FOUND)
+	{
+		response = methodErrorResponse;
+		responseLength = sizeof(methodErrorResponse) - 1;
+	}
+
+	if (directMethodBinding->cacheTtlMs > 0 && responseCode == LP_METHOD_SUCCEEDED)
+	{
+		CacheResponse(directMethodBinding, payload, payloadSize, response, responseLength);
+	}
+
+cleanup:
+
+	*responsePayload = (const unsigned char*)response;
+	*responsePayloadSize = responseLength;
+
+	if (root_value != NULL)
+	{
+		json_value_free(root_value);
+	}
+
+	if (arenaOpen)
+	{
+		lp_jsonArenaEnd();
+	}
+
+	if (responseMsg != NULL)
+	{ // there was memory allocated for a response message so free it now
+		free(responseMsg);
+		responseMsg = NULL;
+	}
+
+	lp_traceSpan(LP_TRACE_METHOD, directMethodBinding != NULL ? directMethodBinding->methodName : NULL, tracedUs, (uint32_t)result);
+
+	return result;
+}
+
+/// <summary>
+///     Hand the invocation to the real-time app, pending until its LP_IC_METHOD_RESPONSE unless it could not be sent
+/// </summary>
+static int ForwardDirectMethod(LP_DIRECT_METHOD_BINDING* directMethodBinding, const unsigned char* payload, size_t payloadSize,
+	const unsigned char** responsePayload, size_t* responsePayloadSize)
+{
+	uint32_t tracedUs = lp_traceNow();
+	int result = LP_METHOD_PENDING;
+
+	*responsePayload = NULL;
+	*responsePayloadSize = 0;
 
-		result = (int)responseCode;
+	if (payloadSize > sizeof(_forwardMessage) - LP_IC_METHOD_HEADER_SIZE)
+	{
+		*responsePayload = (const unsigned char*)forwardTooLargeResponse;
+		*responsePayloadSize = sizeof(forwardTooLargeResponse) - 1;
+		result = LP_METHOD_TOO_LARGE;
+	}
+	else
+	{
+		if (++_forwardSequence == 0)
+		{
+			_forwardSequence = 1;		// zero is never an id, a binding that never forwarded matches nothing
+		}
 
-		switch (responseCode)
+		memcpy(_forwardMessage, &_forwardSequence, sizeof(uint16_t));
+		_forwardMessage[sizeof(uint16_t)] = (uint8_t)directMethodBinding->forwardCode;
+		if (payloadSize > 0)
 		{
-		case LP_METHOD_SUCCEEDED:	// 200
-			responseMessage = responseMsg == NULL || strlen(responseMsg) == 0 ? methodSucceededMsg : responseMsg;
-			break;
-		case LP_METHOD_FAILED:		// 500
-			responseMessage = responseMsg == NULL || strlen(responseMsg) == 0 ? methodErrorMsg : responseMsg;
-			break;
-		case LP_METHOD_NOT_FOUND:
+			memcpy(_forwardMessage + LP_IC_METHOD_HEADER_SIZE, payload, payloadSize);
+		}
+
+		// not ready, or another large message still going out, is answered now rather than at the timeout
+		if (!lp_isInterCoreReady() || !lp_sendInterCoreLarge(LP_IC_METHOD, _forwardMessage, LP_IC_METHOD_HEADER_SIZE + payloadSize))
+		{
+			*responsePayload = (const unsigned char*)realTimeUnavailableResponse;
+			*responsePayloadSize = sizeof(realTimeUnavailableResponse) - 1;
+			result = LP_METHOD_FAILED;
+		}
+		else
+		{
+			directMethodBinding->forwardId = _forwardSequence;
+		}
+	}
+
+	lp_traceSpan(LP_TRACE_METHOD, directMethodBinding->methodName, tracedUs, (uint32_t)result);
+
+	return result;
+}
+
+/// <summary>
+///     The real-time app's answer to a forwarded invocation, one answered late, after its timeout, is dropped
+/// </summary>
+static void ForwardedMethodResponseHandler(LP_INTER_CORE_CMD cmd, const uint8_t* payload, size_t length)
+{
+	char text[LP_METHOD_RESPONSE_SIZE];
+	LP_DIRECT_METHOD_BINDING* directMethodBinding = NULL;
+	METHOD_HANDLE methodId;
+	uint16_t forwardId;
+	uint16_t status;
+	size_t responseLength;
+
+	if (length < LP_IC_METHOD_RESPONSE_HEADER_SIZE)
+	{
+		return;
+	}
+
+	memcpy(&forwardId, payload, sizeof(uint16_t));
+	memcpy(&status, payload + sizeof(uint16_t), sizeof(uint16_t));
+	payload += LP_IC_METHOD_RESPONSE_HEADER_SIZE;
+	responseLength = length - LP_IC_METHOD_RESPONSE_HEADER_SIZE;
+
+	for (size_t i = 0; i < _directMethodCount; i++)
+	{
+		if (_directMethods[i]->pendingMethodId != NULL && _directMethods[i]->forwardCode != LP_IC_METHOD_NONE &&
+			_directMethods[i]->forwardId == forwardId)
+		{
+			directMethodBinding = _directMethods[i];
 			break;
 		}
 	}
 
-cleanup:
+	if (directMethodBinding == NULL)
+	{
+		LP_LOG(LP_LOG_DEBUG, "Forwarded method response %u answered late\n", forwardId);
+		return;
+	}
 
-	// Prepare the payload for the response.
-	// The Azure IoT Hub SDK is responsible of freeing it.
-	responseMessageLength = strlen(responseMessage);
-	*responsePayloadSize = responseMessageLength + 2; // add two as going to wrap the message with quotes for JSON
+	// a JSON object, array or string is the response as it is, other text is quoted, none is the status's own response
+	if (responseLength > 0 && (payload[0] == '{' || payload[0] == '[' || payload[0] == '"'))
+	{
+		methodId = directMethodBinding->pendingMethodId;
+		directMethodBinding->pendingMethodId = NULL;
+		SendMethodResponse(methodId, (int)status, payload, responseLength);
+		return;
+	}
 
-	*responsePayload = (unsigned char*)malloc(*responsePayloadSize);
+	responseLength = responseLength < sizeof(text) - 1 ? responseLength : sizeof(text) - 1;
+	memcpy(text, payload, responseLength);
+	text[responseLength] = 0;
+	lp_completeDirectMethod(directMethodBinding, (LP_DIRECT_METHOD_RESPONSE_CODE)status, text);
+}
+
+/*
+This implementation of Direct Methods expects a JSON Payload Object unless the binding has a rawHandler.
+Synchronous callback, handlers can not return LP_METHOD_PENDING, see lp_azureDirectMethodInboundHandler.
+*/
+int lp_azureDirectMethodHandler(const char* method_name, const unsigned char* payload, size_t payloadSize,
+	unsigned char** responsePayload, size_t* responsePayloadSize, void* userContextCallback)
+{
+	const unsigned char* response = NULL;
+	size_t responseLength = 0;
+
+	lp_kickCloudToDevice();	// pump the method response promptly
+
+	int result = InvokeDirectMethod(FindDirectMethod(method_name), payload, payloadSize, &response, &responseLength);
+
+	if (result == LP_METHOD_PENDING)
+	{
+		result = LP_METHOD_FAILED;
+		response = (const unsigned char*)methodErrorResponse;
+		responseLength = sizeof(methodErrorResponse) - 1;
+	}
+
+	// The Azure IoT Hub SDK is responsible of freeing the response payload so this path needs a heap copy
+	*responsePayload = (unsigned char*)malloc(responseLength);
+	*responsePayloadSize = *responsePayload != NULL ? responseLength : 0;
 	if (*responsePayload != NULL)
 	{
-		// response message needs to be wrapped in quotes as it is part of the JSON payload object
-		memcpy(*responsePayload, "\"", 1);
-		memcpy(*responsePayload + 1, responseMessage, responseMessageLength);
-		memcpy(*responsePayload + responseMessageLength + 1, "\"", 1);
+		memcpy(*responsePayload, response, responseLength);
 	}
-	else
+
+	return result;
+}
+
+static int ElapsedMs(const struct timespec* from, const struct timespec* to)
+{
+	return (int)((to->tv_sec - from->tv_sec) * 1000 + (to->tv_nsec - from->tv_nsec) / 1000000);
+}
+
+/// <summary>
+///     Arm the one-shot timeout timer for the nearest pending method deadline
+/// </summary>
+static void ArmDirectMethodTimeout(void)
+{
+	struct timespec now;
+	int delayMs = -1;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	for (size_t i = 0; i < _directMethodCount; i++)
 	{
-		*responsePayloadSize = 0;
+		if (_directMethods[i]->pendingMethodId != NULL)
+		{
+			int remainingMs = ElapsedMs(&now, &_directMethods[i]->pendingDeadline);
+			if (remainingMs < 1) { remainingMs = 1; }
+			if (delayMs < 0 || remainingMs < delayMs) { delayMs = remainingMs; }
+		}
 	}
 
-	if (root_value != NULL)
+	if (delayMs < 0)
 	{
-		json_value_free(root_value);
+		return;
 	}
 
-	if (payLoadString != NULL)
+	if (directMethodTimeoutTimer.eventLoopTimer == NULL && !lp_startTimer(&directMethodTimeoutTimer))
 	{
-		free(payLoadString);
-		payLoadString = NULL;
+		return;
 	}
 
-	if (responseMsg != NULL)
-	{ // there was memory allocated for a response message so free it now
-		free(responseMsg);
-		responseMsg = NULL;
+	lp_setOneShotTimer(&directMethodTimeoutTimer, &(struct timespec){delayMs / 1000, (delayMs % 1000) * 1000000});
+}
+
+/// <summary>
+///     Inbound method callback, responses are sent with IoTHubDeviceClient_LL_DeviceMethodResponse so a handler can
+///     return LP_METHOD_PENDING, keep DoWork running and answer from the event loop or an inter-core message later.
+/// </summary>
+int lp_azureDirectMethodInboundHandler(const char* method_name, const unsigned char* payload, size_t payloadSize,
+	METHOD_HANDLE methodId, void* userContextCallback)
+{
+	const unsigned char* responsePayload = NULL;
+	size_t responsePayloadSize = 0;
+	LP_DIRECT_METHOD_BINDING* directMethodBinding = FindDirectMethod(method_name);
+
+	lp_kickCloudToDevice();	// pump the method response promptly
+
+	if (directMethodBinding != NULL && directMethodBinding->pendingMethodId != NULL)
+	{	// one invocation in flight per method
+		SendMethodResponse(methodId, LP_METHOD_FAILED, (const unsigned char*)methodBusyResponse, sizeof(methodBusyResponse) - 1);
+		return 0;
+	}
+
+	int result = directMethodBinding != NULL && directMethodBinding->forwardCode != LP_IC_METHOD_NONE ?
+		ForwardDirectMethod(directMethodBinding, payload, payloadSize, &responsePayload, &responsePayloadSize) :
+		InvokeDirectMethod(directMethodBinding, payload, payloadSize, &responsePayload, &responsePayloadSize);
+
+	if (result == LP_METHOD_PENDING)
+	{
+		int timeoutMs = directMethodBinding->timeoutMs > 0 ? directMethodBinding->timeoutMs :
+			directMethodBinding->forwardCode != LP_IC_METHOD_NONE ? LP_METHOD_FORWARD_TIMEOUT_MS : LP_DIRECT_METHOD_DEFAULT_TIMEOUT_MS;
+
+		clock_gettime(CLOCK_MONOTONIC, &directMethodBinding->pendingDeadline);
+		directMethodBinding->pendingDeadline.tv_sec += timeoutMs / 1000;
+		directMethodBinding->pendingDeadline.tv_nsec += (timeoutMs % 1000) * 1000000;
+		if (directMethodBinding->pendingDeadline.tv_nsec >= 1000000000)
+		{
+			directMethodBinding->pendingDeadline.tv_sec++;
+			directMethodBinding->pendingDeadline.tv_nsec -= 1000000000;
+		}
+		directMethodBinding->pendingMethodId = methodId;
+
+		ArmDirectMethodTimeout();
+		return 0;
+	}
+
+	// sent straight from static data or the method response buffer, no allocation
+	SendMethodResponse(methodId, result, responsePayload, responsePayloadSize);
+
+	return 0;
+}
+
+/// <summary>
+///     Answer an invocation the binding handler left pending, false when nothing is pending (answered, timed out or abandoned)
+/// </summary>
+bool lp_completeDirectMethod(LP_DIRECT_METHOD_BINDING* directMethodBinding, LP_DIRECT_METHOD_RESPONSE_CODE responseCode, const char* responseMsg)
+{
+	char response[LP_METHOD_RESPONSE_SIZE];		// on the stack, a handler may complete another method while its own response is set
+	size_t responseLength = 0;
+	bool complete = false;
+	METHOD_HANDLE methodId;
+
+	if (directMethodBinding == NULL || directMethodBinding->pendingMethodId == NULL)
+	{
+		return false;
+	}
+
+	methodId = directMethodBinding->pendingMethodId;
+	directMethodBinding->pendingMethodId = NULL;
+
+	if (responseMsg != NULL && strlen(responseMsg) > 0)
+	{
+		responseLength = QuoteResponse(responseMsg, response, sizeof(response), &complete);
+		return SendMethodResponse(methodId, (int)responseCode, (const unsigned char*)response, responseLength);
+	}
+
+	if (responseCode == LP_METHOD_SUCCEEDED)
+	{
+		return SendMethodResponse(methodId, (int)responseCode, (const unsigned char*)methodSucceededResponse, sizeof(methodSucceededResponse) - 1);
+	}
+
+	if (responseCode == LP_METHOD_TIMEOUT)
+	{
+		return SendMethodResponse(methodId, (int)responseCode, (const unsigned char*)methodTimeoutResponse, sizeof(methodTimeoutResponse) - 1);
+	}
+
+	return SendMethodResponse(methodId, (int)responseCode, (const unsigned char*)methodErrorResponse, sizeof(methodErrorResponse) - 1);
+}
+
+/// <summary>
+///     Forget pending invocations when the IoT Hub client is destroyed, their method handles belong to it
+/// </summary>
+void lp_abandonDirectMethods(void)
+{
+	for (size_t i = 0; i < _directMethodCount; i++)
+	{
+		_directMethods[i]->pendingMethodId = NULL;
+	}
+}
+
+static void DirectMethodTimeoutHandler(EventLoopTimer* eventLoopTimer)
+{
+	struct timespec now;
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
+	{
+		lp_terminate(ExitCode_DirectMethodTimeoutHandler);
+		return;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	for (size_t i = 0; i < _directMethodCount; i++)
+	{
+		LP_DIRECT_METHOD_BINDING* directMethodBinding = _directMethods[i];
+
+		if (directMethodBinding->pendingMethodId != NULL && ElapsedMs(&directMethodBinding->pendingDeadline, &now) >= 0)
+		{
+			LP_LOG(LP_LOG_WARNING, "Direct method '%s' timed out\n", directMethodBinding->methodName);
+			lp_completeDirectMethod(directMethodBinding, LP_METHOD_TIMEOUT, NULL);
+		}
+	}
+
+	ArmDirectMethodTimeout();
+}
+
+/// <summary>
+///     TimerProfile direct method, turns on timer profiling, logs every timer and answers with the slowest handler
+/// </summary>
+static LP_DIRECT_METHOD_RESPONSE_CODE TimerProfileHandler(const unsigned char* payload, size_t payloadSize, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg)
+{
+	LP_TIMER_PROFILE profile;
+	LP_TIMER* slowest;
+
+	lp_setTimerProfiling(true);
+	lp_logTimerProfiles();
+
+	slowest = lp_getSlowestTimer(&profile);
+	if (slowest == NULL)
+	{
+		lp_setMethodResponse("Timer profiling enabled, call again for results");
+		return LP_METHOD_SUCCEEDED;
+	}
+
+	lp_setMethodResponse("Slowest %s: fires %u, overruns %u, lag max %u us, run avg %u max %u us",
+		slowest->name == NULL ? "(unnamed)" : slowest->name, profile.fires, profile.overruns, profile.lagMaxUs, profile.runAvgUs, profile.runMaxUs);
+
+	return LP_METHOD_SUCCEEDED;
+}
+
+LP_DIRECT_METHOD_BINDING lp_timerProfileDirectMethod = { .methodName = "TimerProfile", .rawHandler = TimerProfileHandler };
+
+/// <summary>
+///     Append text to the batch response up to limit bytes, false and nothing appended when it does not fit
+/// </summary>
+static bool AppendBatchResponse(size_t* length, size_t limit, const char* text, size_t textLength)
+{
+	if (*length + textLength > limit)
+	{
+		return false;
+	}
+
+	memcpy(_batchResponse + *length, text, textLength);
+	*length += textLength;
+	return true;
+}
+
+/// <summary>
+///     Run one batch command and append its result, {"method":name,"status":code,"response":json}, within limit.
+///     A result that does not fit is appended as {"method":name,"status":code,"response":null}, or without the name
+/// </summary>
+static int RunBatchCommand(JSON_Object* command, size_t* length, size_t limit)
+{
+	char head[LP_METHOD_RESPONSE_SIZE + 48];
+	char name[LP_METHOD_RESPONSE_SIZE];
+	size_t nameLength = 0;
+	size_t start = *length;
+	const char* methodName = json_object_get_string(command, "method");
+	JSON_Value* payloadValue = json_object_get_value(command, "payload");
+	LP_DIRECT_METHOD_BINDING* directMethodBinding = FindDirectMethod(methodName);
+	const unsigned char* response = NULL;
+	size_t responseLength = 0;
+	char* payload = NULL;
+	int result;
+
+	if (directMethodBinding == &lp_batchDirectMethod)
+	{
+		directMethodBinding = NULL;		// not found, batches do not nest
+	}
+
+	if (directMethodBinding != NULL && directMethodBinding->pendingMethodId != NULL)
+	{	// the method's own invocation is still in flight
+		result = LP_METHOD_FAILED;
+		response = (const unsigned char*)methodBusyResponse;
+		responseLength = sizeof(methodBusyResponse) - 1;
+	}
+	else
+	{
+		payload = payloadValue != NULL ? json_serialize_to_string(payloadValue) : NULL;
+		result = InvokeDirectMethod(directMethodBinding, (const unsigned char*)(payload != NULL ? payload : "{}"),
+			payload != NULL ? strlen(payload) : 2, &response, &responseLength);
+
+		if (result == LP_METHOD_PENDING)
+		{
+			LP_LOG(LP_LOG_WARNING, "Direct method '%s' returned pending in a batch\n", directMethodBinding->methodName);
+			result = LP_METHOD_FAILED;
+			response = (const unsigned char*)methodPendingResponse;
+			responseLength = sizeof(methodPendingResponse) - 1;
+		}
+	}
+
+	// the response is in the method response buffer or a cached copy until the next command, it is copied now
+	lp_escapeJsonString(methodName, name, sizeof(name) - 1, &nameLength);
+	name[nameLength] = 0;
+	snprintf(head, sizeof(head), "%s{\"method\":\"%s\",\"status\":%d,\"response\":", start > 1 ? "," : "", name, result);
+
+	if (!AppendBatchResponse(length, limit, head, strlen(head)) ||
+		!AppendBatchResponse(length, limit, (const char*)response, responseLength) ||
+		!AppendBatchResponse(length, limit, "}", 1))
+	{
+		*length = start;
+		if (!AppendBatchResponse(length, limit, head, strlen(head)) || !AppendBatchResponse(length, limit, "null}", 5))
+		{
+			*length = start;
+			snprintf(head, sizeof(head), "%s{\"status\":%d,\"response\":null}", start > 1 ? "," : "", result);
+			AppendBatchResponse(length, limit, head, strlen(head));
+		}
+	}
+
+	if (payload != NULL)
+	{
+		json_free_serialized_string(payload);
 	}
 
 	return result;
-}
\ No newline at end of file
+}
+
+/// <summary>
+///     Batch direct method, runs each command of the payload through the binding table and answers with their results
+/// </summary>
+static LP_DIRECT_METHOD_RESPONSE_CODE BatchHandler(const unsigned char* payload, size_t payloadSize, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg)
+{
+	LP_DIRECT_METHOD_RESPONSE_CODE responseCode = LP_METHOD_SUCCEEDED;
+	JSON_Value* root_value;
+	JSON_Object* root;
+	JSON_Array* commands;
+	bool stopOnError = false;
+	size_t length = 1;
+	size_t count;
+
+	lp_jsonArenaBegin();
+
+	root_value = json_parse_stringn((const char*)payload, payloadSize);
+	commands = json_value_get_array(root_value);
+	if (commands == NULL && (root = json_value_get_object(root_value)) != NULL)
+	{
+		commands = json_object_get_array(root, "commands");
+		stopOnError = json_object_get_boolean(root, "stopOnError") == 1;
+	}
+
+	count = json_array_get_count(commands);
+	if (commands == NULL || count > LP_METHOD_BATCH_MAX_COMMANDS)
+	{
+		if (commands == NULL)
+		{
+			lp_setMethodResponse("Batch expects an array of {method, payload}");
+		}
+		else
+		{
+			lp_setMethodResponse("Batch is limited to %d commands", LP_METHOD_BATCH_MAX_COMMANDS);
+		}
+		json_value_free(root_value);
+		lp_jsonArenaEnd();
+		return LP_METHOD_FAILED;
+	}
+
+	_batchResponse[0] = '[';
+	for (size_t i = 0; i < count; i++)
+	{
+		// room is kept for a short result of every command after this one and the closing bracket
+		size_t limit = sizeof(_batchResponse) - 1 - (count - i - 1) * LP_METHOD_BATCH_SHORT_RESULT;
+
+		if (RunBatchCommand(json_array_get_object(commands, i), &length, limit) != LP_METHOD_SUCCEEDED)
+		{
+			responseCode = LP_METHOD_FAILED;
+			if (stopOnError)
+			{
+				break;
+			}
+		}
+	}
+
+	json_value_free(root_value);
+	lp_jsonArenaEnd();
+
+	_batchResponse[length++] = ']';
+	_jsonResponseLength = length;
+
+	return responseCode;
+}
+
+LP_DIRECT_METHOD_BINDING lp_batchDirectMethod = { .methodName = "Batch", .rawHandler = BatchHandler };
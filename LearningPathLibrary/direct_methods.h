@@ -1,23 +1,77 @@
 #pragma once
 
 #include "azure_iot.h"
+#include "build_options.h"
 #include "peripheral_gpio.h"
+#include "shared/inter_core_protocol.h"
+#include <iothub_client_core_ll.h>
+#include <stdarg.h>
+#include <time.h>
+
+#define LP_DIRECT_METHOD_DEFAULT_TIMEOUT_MS 30000	// the IoT Hub default method response timeout
+#define LP_METHOD_RESPONSE_SIZE 256					// largest response payload from lp_setMethodResponse including the quotes
+#define LP_METHOD_BATCH_MAX_COMMANDS 16				// commands one Batch invocation runs, more are refused
+#define LP_METHOD_BATCH_RESPONSE_SIZE 4096			// the results array, a result that does not fit is sent with a null response
+#define LP_METHOD_FORWARD_TIMEOUT_MS 2000			// a forwarded method with no timeoutMs, the real-time app answers in milliseconds
 
 typedef enum 
 {
 	LP_METHOD_SUCCEEDED = 200,
+	LP_METHOD_PENDING = 202,		// handler continues the work and calls lp_completeDirectMethod later
 	LP_METHOD_FAILED = 500,
-	LP_METHOD_NOT_FOUND = 404
+	LP_METHOD_NOT_FOUND = 404,
+	LP_METHOD_TOO_LARGE = 413,		// refused by the memory governor, see memory_governor.h
+	LP_METHOD_TIMEOUT = 504
 } LP_DIRECT_METHOD_RESPONSE_CODE;
 
 struct _directMethodBinding {
 	const char* methodName;
 	LP_DIRECT_METHOD_RESPONSE_CODE(*handler)(JSON_Object* json, struct _directMethodBinding* peripheral, char** responseMsg);
+	// optional, receives the payload bytes without JSON parsing for binary or trivial payloads, used in place of handler
+	LP_DIRECT_METHOD_RESPONSE_CODE(*rawHandler)(const unsigned char* payload, size_t payloadSize, struct _directMethodBinding* peripheral, char** responseMsg);
+	int timeoutMs;							// a pending invocation is answered LP_METHOD_TIMEOUT after this, 0 for the default
+	// optional, forwards the payload as the hub sent it to the real-time app as an LP_IC_METHOD of this code, in place of
+	// the handlers: nothing is parsed here, the invocation is pending until the real-time app's LP_IC_METHOD_RESPONSE and
+	// its response is sent unchanged, text that is not JSON quoted as a string. Not cached, and refused by Batch.
+	LP_IC_METHOD_CODE forwardCode;
+	// optional, marks the method idempotent: a succeeded response is served again for this long to the same payload
+	// without calling the handler, 0 to call it every time, lp_invalidateDirectMethodCache when the state it reports changes
+	int cacheTtlMs;
+	unsigned int cacheHits;					// read only, invocations answered from the cache
+	METHOD_HANDLE pendingMethodId;			// invocation awaiting lp_completeDirectMethod, one per method
+	uint16_t forwardId;						// internal, correlates the forwarded invocation pending with its response
+	struct timespec pendingDeadline;
+	char* cachedResponse;					// internal, the serialized response and the payload it answered
+	size_t cachedResponseLength;
+	uint32_t cachedPayloadHash;
+	size_t cachedPayloadSize;
+	struct timespec cachedUntil;
 };
 
 typedef struct _directMethodBinding LP_DIRECT_METHOD_BINDING;
 
+extern LP_DIRECT_METHOD_BINDING lp_timerProfileDirectMethod;	// optional, add to the direct method set to profile timer handlers
+
+// Optional, add to the direct method set for a Batch method that runs several of the set's methods in one round trip.
+// The payload is an array of commands, or an object holding it as "commands" with "stopOnError" to skip the commands
+// after the first that does not succeed, each run in order through the binding table as if it had been invoked alone:
+//
+//   [{"method":"SetRelay","payload":{"state":true}},{"method":"ResetCounter"}]
+//   -> [{"method":"SetRelay","status":200,"response":"Method Succeeded"},{"method":"ResetCounter","status":404,"response":"Method not found"}]
+//
+// A missing payload is {}. Batch answers 200 when every command succeeded, 500 otherwise, with the results of the
+// commands run. A command may not be Batch or return LP_METHOD_PENDING, its result can not join the batch and is 500.
+extern LP_DIRECT_METHOD_BINDING lp_batchDirectMethod;
+
 void lp_openDirectMethodSet(LP_DIRECT_METHOD_BINDING* directMethods[], size_t directMethodCount);
 void lp_closeDirectMethodSet(void);
 int lp_azureDirectMethodHandler(const char* method_name, const unsigned char* payload, size_t payloadSize,
 	unsigned char** responsePayload, size_t* responsePayloadSize, void* userContextCallback);
+int lp_azureDirectMethodInboundHandler(const char* method_name, const unsigned char* payload, size_t payloadSize,
+	METHOD_HANDLE methodId, void* userContextCallback);
+bool lp_completeDirectMethod(LP_DIRECT_METHOD_BINDING* directMethodBinding, LP_DIRECT_METHOD_RESPONSE_CODE responseCode, const char* responseMsg);
+void lp_abandonDirectMethods(void);
+// drop the cached response of a method, or of every method for NULL, the next invocation calls its handler
+void lp_invalidateDirectMethodCache(LP_DIRECT_METHOD_BINDING* directMethodBinding);
+bool lp_setMethodResponse(const char* format, ...);
+bool lp_escapeJsonString(const char* text, char* out, size_t capacity, size_t* written);
@@ -0,0 +1,48 @@
+#include "direct_methods.h"
+
+// Built in place of direct_methods.c when LP_ENABLE_DIRECT_METHODS is OFF, the method callback is not registered
+// with the SDK so the hub answers invocations as not found.
+
+LP_DIRECT_METHOD_BINDING lp_timerProfileDirectMethod = { .methodName = "TimerProfile" };
+LP_DIRECT_METHOD_BINDING lp_batchDirectMethod = { .methodName = "Batch" };
+
+void lp_openDirectMethodSet(LP_DIRECT_METHOD_BINDING* directMethods[], size_t directMethodCount)
+{
+	if (directMethodCount > 0)
+	{
+		LP_LOG(LP_LOG_WARNING, "WARNING: direct methods are not compiled in, LP_ENABLE_DIRECT_METHODS is OFF\n");
+	}
+}
+
+void lp_closeDirectMethodSet(void) {}
+
+int lp_azureDirectMethodHandler(const char* method_name, const unsigned char* payload, size_t payloadSize,
+	unsigned char** responsePayload, size_t* responsePayloadSize, void* userContextCallback)
+{
+	*responsePayload = NULL;
+	*responsePayloadSize = 0;
+	return LP_METHOD_NOT_FOUND;
+}
+
+int lp_azureDirectMethodInboundHandler(const char* method_name, const unsigned char* payload, size_t payloadSize,
+	METHOD_HANDLE methodId, void* userContextCallback)
+{
+	return LP_METHOD_NOT_FOUND;
+}
+
+bool lp_completeDirectMethod(LP_DIRECT_METHOD_BINDING* directMethodBinding, LP_DIRECT_METHOD_RESPONSE_CODE responseCode, const char* responseMsg)
+{
+	return false;
+}
+
+void lp_abandonDirectMethods(void) {}
+
+bool lp_setMethodResponse(const char* format, ...)
+{
+	return false;
+}
+
+bool lp_escapeJsonString(const char* text, char* out, size_t capacity, size_t* written)
+{
+	return false;
+}
@@ -0,0 +1,405 @@
+#include "duty_cycle.h"
+
+#define LP_DUTY_CYCLE_MAGIC 0x4C504443		// "LPDC", the state in the offline queue header belongs to this module
+
+typedef enum {
+	DUTY_CYCLE_IDLE,
+	DUTY_CYCLE_SAMPLING,		// waiting for the sample handler to record its reading
+	DUTY_CYCLE_UPLOADING		// connecting, sending the backlog and lingering for the twin
+} DUTY_CYCLE_PHASE;
+
+// persisted with lp_offlineQueueSetState, fits LP_OFFLINE_QUEUE_STATE_SIZE
+typedef struct {
+	uint32_t magic;
+	LP_DUTY_CYCLE_SCHEDULE schedule;
+	int64_t lastUploadUtc;		// last upload attempt, a failed upload waits a full interval like a successful one
+	uint32_t wakes;
+	uint32_t uploads;
+} DUTY_CYCLE_STATE;
+
+static void DutyCyclePollHandler(EventLoopTimer* eventLoopTimer);
+static void DutyCycleSampleHandler(EventLoopTimer* eventLoopTimer);
+static void DutyCycleScheduleTwinHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+
+static LP_TIMER dutyCyclePollTimer = {
+	.period = { 1, 0 },
+	.name = "dutyCyclePollTimer",
+	.handler = &DutyCyclePollHandler
+};
+
+static LP_TIMER dutyCycleSampleTimer = {
+	.period = { 0, 0 },			// one-shot, the sample timeout and the next cycle when power down is refused
+	.name = "dutyCycleSampleTimer",
+	.handler = &DutyCycleSampleHandler
+};
+
+LP_DEVICE_TWIN_BINDING lp_dutyCycleScheduleTwin = { .twinProperty = "DutyCycle", .twinType = LP_TYPE_STRING, .handler = DutyCycleScheduleTwinHandler };
+
+static DUTY_CYCLE_STATE _state = { .schedule = { 600, 21600, 120 } };
+static DUTY_CYCLE_PHASE _phase = DUTY_CYCLE_IDLE;
+static bool (*_sampleHandler)(void) = NULL;
+static size_t _maxBatchBytes = LP_DUTY_CYCLE_BATCH_BYTES;
+static struct timespec _uploadDeadline;
+static struct timespec _connectedAt;
+static bool _backlogSent = false;
+static bool _reportFlushed = false;
+
+// backlog joined into upload messages, held in RAM for the length of one upload wake
+static char** _batches = NULL;
+static size_t _dutyBatchCount = 0;
+static size_t _batchSlots = 0;
+static char* _building = NULL;
+static size_t _buildingLength = 0;
+static size_t _buildingSize = 0;
+
+static bool ValidSchedule(const LP_DUTY_CYCLE_SCHEDULE* schedule) {
+	return schedule->sampleIntervalSeconds >= LP_DUTY_CYCLE_MIN_SAMPLE_SECONDS &&
+		schedule->uploadIntervalSeconds >= schedule->sampleIntervalSeconds &&
+		schedule->uploadWindowSeconds > LP_DUTY_CYCLE_SETTLE_SECONDS &&
+		schedule->uploadWindowSeconds < schedule->sampleIntervalSeconds;
+}
+
+static int64_t DutyElapsedMs(const struct timespec* from, const struct timespec* to) {
+	return (int64_t)(to->tv_sec - from->tv_sec) * 1000 + (to->tv_nsec - from->tv_nsec) / 1000000;
+}
+
+static bool SaveState(void) {
+	return lp_offlineQueueSetState(&_state, sizeof(_state));
+}
+
+/// <summary>
+///     Close the message being built and keep it for sending
+/// </summary>
+static bool CloseBatch(void) {
+	if (_building == NULL) {
+		return true;
+	}
+
+	if (_dutyBatchCount == _batchSlots) {
+		size_t slots = _batchSlots == 0 ? 4 : _batchSlots * 2;
+		char** grown = (char**)lp_heapRealloc(LP_HEAP_TELEMETRY, _batches, slots * sizeof(char*));
+		if (grown == NULL) {
+			return false;
+		}
+		_batches = grown;
+		_batchSlots = slots;
+	}
+
+	_building[_buildingLength++] = ']';
+	_building[_buildingLength] = 0;
+	_batches[_dutyBatchCount++] = _building;
+	_building = NULL;
+
+	return true;
+}
+
+/// <summary>
+///     Move every queued message into JSON array upload messages. An earlier upload pushed back by a failed
+///     send is spliced in rather than nested. Stops early, leaving the rest queued, when memory runs out.
+/// </summary>
+static void GatherBacklog(void) {
+	size_t pending = lp_offlineQueueCount();
+	const char* msg;
+
+	while (pending-- > 0 && (msg = lp_offlineQueuePeek()) != NULL) {
+		size_t length = strlen(msg);
+
+		if (length >= 2 && msg[0] == '[' && msg[length - 1] == ']') {
+			msg++;
+			length -= 2;
+		}
+
+		if (length > 0) {
+			// a comma or opening bracket, the closing bracket and the terminator
+			if (_building != NULL && _buildingLength + length + 3 > _buildingSize && !CloseBatch()) {
+				break;
+			}
+
+			if (_building == NULL) {
+				_buildingSize = length + 3 > _maxBatchBytes ? length + 3 : _maxBatchBytes;
+				if ((_building = (char*)lp_heapMalloc(LP_HEAP_TELEMETRY, _buildingSize)) == NULL) {
+					break;
+				}
+				_buildingLength = 0;
+			}
+
+			_building[_buildingLength] = _buildingLength == 0 ? '[' : ',';
+			_buildingLength++;
+			memcpy(_building + _buildingLength, msg, length);
+			_buildingLength += length;
+		}
+
+		lp_offlineQueuePop();
+	}
+
+	if (!CloseBatch()) {
+		// no room to keep it, back into the queue as it is
+		_building[_buildingLength++] = ']';
+		_building[_buildingLength] = 0;
+		lp_offlineQueuePush(_building, LP_PRIORITY_NORMAL);
+		lp_heapFree(LP_HEAP_TELEMETRY, _building);
+		_building = NULL;
+	}
+}
+
+/// <summary>
+///     Send the gathered upload messages, or with requeue put them back in the offline queue for the next upload.
+///     lp_sendMsg queues a message it could not hand to the SDK itself.
+/// </summary>
+static void ReleaseBatches(bool requeue) {
+	for (size_t i = 0; i < _dutyBatchCount; i++) {
+		if (requeue) {
+			lp_offlineQueuePush(_batches[i], LP_PRIORITY_NORMAL);
+		} else {
+			lp_sendMsg(_batches[i]);
+		}
+		lp_heapFree(LP_HEAP_TELEMETRY, _batches[i]);
+	}
+
+	lp_heapFree(LP_HEAP_TELEMETRY, _batches);
+	_batches = NULL;
+	_dutyBatchCount = _batchSlots = 0;
+}
+
+/// <summary>
+///     Persist the queue and the schedule and power down until the next sample. When power down is refused,
+///     a debugger attached or the manifest without ForcePowerDown, the next cycle runs in-process instead.
+/// </summary>
+static void PowerDown(void) {
+	if (dutyCyclePollTimer.eventLoopTimer != NULL) {
+		lp_stopTimer(&dutyCyclePollTimer);
+	}
+
+	if (_phase == DUTY_CYCLE_UPLOADING) {
+		ReleaseBatches(true);		// empty unless the upload window closed before the hub was reached
+		_state.lastUploadUtc = (int64_t)time(NULL);
+		_state.uploads++;
+	}
+	_phase = DUTY_CYCLE_IDLE;
+
+	if (!lp_offlineQueuePersist()) {
+		LP_LOG(LP_LOG_WARNING, "WARNING: Duty cycle could not persist every queued sample\n");
+	}
+	SaveState();
+
+	LP_LOG(LP_LOG_INFO, "INFO: Duty cycle powering down for %d seconds, wake %u\n", _state.schedule.sampleIntervalSeconds, _state.wakes);
+
+	if (PowerManagement_ForceSystemPowerDown((unsigned int)_state.schedule.sampleIntervalSeconds) == 0) {
+		lp_terminate(ExitCode_Success);
+		return;
+	}
+
+	LP_LOG(LP_LOG_WARNING, "WARNING: Power down refused: %s (%d), the next sample runs with the A7 up\n", strerror(errno), errno);
+	lp_setOneShotTimer(&dutyCycleSampleTimer, &(struct timespec){ _state.schedule.sampleIntervalSeconds, 0 });
+}
+
+/// <summary>
+///     The sample is recorded, power down again or stay up for the upload
+/// </summary>
+static void SampleComplete(void) {
+	int64_t now = (int64_t)time(NULL);
+
+	if (_phase != DUTY_CYCLE_SAMPLING) {
+		return;
+	}
+
+	if (dutyCycleSampleTimer.eventLoopTimer != NULL) {
+		DisarmEventLoopTimer(dutyCycleSampleTimer.eventLoopTimer);
+	}
+
+	// a clock set backwards counts as due rather than postponing the upload
+	if (_state.lastUploadUtc != 0 && now >= _state.lastUploadUtc && now - _state.lastUploadUtc < _state.schedule.uploadIntervalSeconds) {
+		PowerDown();
+		return;
+	}
+
+	_phase = DUTY_CYCLE_UPLOADING;
+	_backlogSent = _reportFlushed = false;
+	GatherBacklog();
+
+	clock_gettime(CLOCK_MONOTONIC, &_uploadDeadline);
+	_uploadDeadline.tv_sec += _state.schedule.uploadWindowSeconds;
+
+	if (!lp_startTimer(&dutyCyclePollTimer)) {
+		PowerDown();
+		return;
+	}
+	lp_connectToAzureIot();
+}
+
+static void RunCycle(void) {
+	_state.wakes++;
+	_phase = DUTY_CYCLE_SAMPLING;
+
+	if (_sampleHandler == NULL || _sampleHandler()) {
+		SampleComplete();
+		return;
+	}
+
+	lp_setOneShotTimer(&dutyCycleSampleTimer, &(struct timespec){ LP_DUTY_CYCLE_SAMPLE_TIMEOUT_MS / 1000, (LP_DUTY_CYCLE_SAMPLE_TIMEOUT_MS % 1000) * 1000000 });
+}
+
+/// <summary>
+///     Begin this wake's cycle. The offline queue must be open with spilling, the schedule persisted by an earlier
+///     wake or set by the twin is kept over defaults, which may be NULL. maxBatchBytes of 0 for LP_DUTY_CYCLE_BATCH_BYTES.
+/// </summary>
+bool lp_startDutyCycle(const LP_DUTY_CYCLE_SCHEDULE* defaults, bool (*sampleHandler)(void), size_t maxBatchBytes) {
+	DUTY_CYCLE_STATE recovered;
+
+	if (_phase != DUTY_CYCLE_IDLE) {
+		return true;
+	}
+
+	_sampleHandler = sampleHandler;
+	_maxBatchBytes = maxBatchBytes > 0 ? maxBatchBytes : LP_DUTY_CYCLE_BATCH_BYTES;
+
+	if (lp_offlineQueueGetState(&recovered, sizeof(recovered)) == sizeof(recovered) && recovered.magic == LP_DUTY_CYCLE_MAGIC &&
+		ValidSchedule(&recovered.schedule)) {
+		_state = recovered;
+	} else {
+		_state.magic = LP_DUTY_CYCLE_MAGIC;		// first wake, the schedule is the defaults or one set before start
+		_state.lastUploadUtc = 0;
+		_state.wakes = _state.uploads = 0;
+		if (defaults != NULL && ValidSchedule(defaults)) {
+			_state.schedule = *defaults;
+		}
+	}
+
+	if (!SaveState()) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: Duty cycle needs the offline queue opened with maxSpillBytes and MutableStorage in the manifest\n");
+		return false;
+	}
+
+	if (!lp_startTimer(&dutyCycleSampleTimer)) {
+		return false;
+	}
+
+	RunCycle();
+	return true;
+}
+
+/// <summary>
+///     Queue this wake's reading for the next upload, completes the sample phase
+/// </summary>
+bool lp_recordDutyCycleSample(const char* msg) {
+	bool queued = lp_offlineQueuePush(msg, LP_PRIORITY_NORMAL);
+
+	SampleComplete();
+	return queued;
+}
+
+bool lp_setDutyCycleSchedule(const LP_DUTY_CYCLE_SCHEDULE* schedule) {
+	if (schedule == NULL || !ValidSchedule(schedule)) {
+		return false;
+	}
+
+	_state.schedule = *schedule;
+	return _state.magic != LP_DUTY_CYCLE_MAGIC || SaveState();
+}
+
+void lp_getDutyCycleSchedule(LP_DUTY_CYCLE_SCHEDULE* schedule) {
+	if (schedule != NULL) {
+		*schedule = _state.schedule;
+	}
+}
+
+/// <summary>
+///     Send the backlog once connected, then power down when it is confirmed and the twin has had time to arrive,
+///     or when the upload window closes
+/// </summary>
+static void DutyCyclePollHandler(EventLoopTimer* eventLoopTimer) {
+	struct timespec now;
+	LP_TELEMETRY_STATS telemetry;
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_DutyCyclePollHandler);
+		return;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (DutyElapsedMs(&_uploadDeadline, &now) >= 0) {
+		LP_LOG(LP_LOG_WARNING, "WARNING: Duty cycle upload window closed, %zu messages kept for the next upload\n", _dutyBatchCount + lp_offlineQueueCount());
+		PowerDown();
+		return;
+	}
+
+	if (!lp_connectToAzureIot()) {
+		return;
+	}
+
+	if (!_backlogSent) {
+		ReleaseBatches(false);
+		_backlogSent = true;
+		_connectedAt = now;
+		return;
+	}
+
+	lp_getTelemetryStats(&telemetry);
+	if (lp_offlineQueueCount() > 0 || telemetry.inFlight > 0 || DutyElapsedMs(&_connectedAt, &now) < LP_DUTY_CYCLE_SETTLE_SECONDS * 1000) {
+		return;
+	}
+
+	// reported properties held by the flush interval go out now, one more tick for DoWork to send them
+	if (!_reportFlushed) {
+		lp_flushReportedState();
+		_reportFlushed = true;
+		return;
+	}
+
+	PowerDown();
+}
+
+static void DutyCycleSampleHandler(EventLoopTimer* eventLoopTimer) {
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_DutyCycleSampleHandler);
+		return;
+	}
+
+	if (_phase == DUTY_CYCLE_SAMPLING) {
+		LP_LOG(LP_LOG_WARNING, "WARNING: Duty cycle sample not recorded within %d ms\n", LP_DUTY_CYCLE_SAMPLE_TIMEOUT_MS);
+		SampleComplete();
+	} else if (_phase == DUTY_CYCLE_IDLE) {
+		RunCycle();
+	}
+}
+
+/// <summary>
+///     "sample=600,upload=21600,window=120", keys left out keep their value, an invalid schedule is not applied
+/// </summary>
+static void DutyCycleScheduleTwinHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {
+	LP_DUTY_CYCLE_SCHEDULE schedule;
+	char reported[64];
+	const char* text = (const char*)deviceTwinBinding->twinState;
+
+	lp_getDutyCycleSchedule(&schedule);
+
+	while (text != NULL && *text != 0) {
+		char key[8];
+		int value;
+		int consumed = 0;
+
+		if (sscanf(text, " %7[a-z] = %d%n", key, &value, &consumed) != 2) {
+			break;
+		}
+
+		if (strcmp(key, "sample") == 0) {
+			schedule.sampleIntervalSeconds = value;
+		} else if (strcmp(key, "upload") == 0) {
+			schedule.uploadIntervalSeconds = value;
+		} else if (strcmp(key, "window") == 0) {
+			schedule.uploadWindowSeconds = value;
+		}
+
+		text += consumed;
+		text += strspn(text, " ,;");
+	}
+
+	if (!lp_setDutyCycleSchedule(&schedule)) {
+		LP_LOG(LP_LOG_WARNING, "WARNING: Duty cycle schedule '%s' rejected\n", (const char*)deviceTwinBinding->twinState);
+	}
+
+	lp_getDutyCycleSchedule(&schedule);
+	snprintf(reported, sizeof(reported), "sample=%d,upload=%d,window=%d", schedule.sampleIntervalSeconds,
+		schedule.uploadIntervalSeconds, schedule.uploadWindowSeconds);
+	lp_deviceTwinReportState(deviceTwinBinding, reported);
+}
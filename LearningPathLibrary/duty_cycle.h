@@ -0,0 +1,41 @@
+#pragma once
+
+#include "azure_iot.h"
+#include "device_twins.h"
+#include "offline_queue.h"
+#include "timer.h"
+#include <applibs/powermanagement.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LP_DUTY_CYCLE_BATCH_BYTES 16384			// largest upload message when lp_startDutyCycle is given 0
+#define LP_DUTY_CYCLE_SAMPLE_TIMEOUT_MS 5000	// a sample handler returning false has this long to record its sample
+#define LP_DUTY_CYCLE_SETTLE_SECONDS 5			// an upload wake stays connected at least this long for desired properties
+#define LP_DUTY_CYCLE_MIN_SAMPLE_SECONDS 10
+
+typedef struct LP_DUTY_CYCLE_SCHEDULE
+{
+	int32_t sampleIntervalSeconds;		// powered down between samples
+	int32_t uploadIntervalSeconds;		// the first wake this long after the last upload connects and sends the backlog
+	int32_t uploadWindowSeconds;		// longest an upload wake stays up connecting and sending
+} LP_DUTY_CYCLE_SCHEDULE;
+
+// Duty cycled telemetry for sites that can not keep the A7 and Wi-Fi up between samples. Each boot is one wake:
+// the app opens the offline queue with spilling, opens its twins, then calls lp_startDutyCycle. The sample
+// handler records its reading with lp_recordDutyCycleSample, into the offline queue and not to the hub. A wake
+// that is not an upload wake persists the queue and calls PowerManagement_ForceSystemPowerDown straight away,
+// without connecting. An upload wake joins the backlog into JSON array messages of up to maxBatchBytes, connects,
+// sends them, lingers for desired properties and reported state, then powers down until the next sample.
+//
+// The samples and the schedule live in the offline queue's mutable storage file, the real-time core is powered
+// down with the A7 so it can not hold them. The app manifest needs "PowerControls": [ "ForcePowerDown" ] and
+// "MutableStorage", without power down rights the cycle continues in-process with the A7 left running.
+bool lp_startDutyCycle(const LP_DUTY_CYCLE_SCHEDULE* defaults, bool (*sampleHandler)(void), size_t maxBatchBytes);
+bool lp_recordDutyCycleSample(const char* msg);
+bool lp_setDutyCycleSchedule(const LP_DUTY_CYCLE_SCHEDULE* schedule);
+void lp_getDutyCycleSchedule(LP_DUTY_CYCLE_SCHEDULE* schedule);
+
+// optional, add to the device twin set to set the schedule from the cloud, a string "sample=600,upload=21600,window=120"
+// with any of the three keys, reported back as the schedule in effect
+extern LP_DEVICE_TWIN_BINDING lp_dutyCycleScheduleTwin;
@@ -0,0 +1,141 @@
+#include "event_loop.h"
+#include "event_trace.h"
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+
+static int64_t _budgetUs = LP_EVENT_LOOP_BUDGET_MS * 1000;
+static uint64_t _lagTotalUs = 0;
+static LP_EVENT_LOOP_STATS _loopStats;
+
+static int64_t NowUs(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/// <summary>
+///     Dispatch one ready event, false once none are left or the dispatch failed
+/// </summary>
+static bool DispatchOne(EventLoop* eventLoop, int64_t wokeUs) {
+	LP_TIMER_STATS before, after;
+
+	lp_getTimerStats(&before);
+
+	int64_t startedUs = NowUs();
+	uint32_t tracedUs = lp_traceNow();
+	EventLoop_Run_Result result = EventLoop_Run(eventLoop, 0, true);
+	int64_t runUs = NowUs() - startedUs;
+
+	if (result == EventLoop_Run_Failed) {
+		if (errno != EINTR) {
+			lp_terminate(ExitCode_Main_EventLoopFail);
+		}
+		return false;
+	}
+
+	if (result == EventLoop_Run_FinishedEmpty) {
+		return false;
+	}
+
+	int64_t lagUs = startedUs - wokeUs;
+	lp_traceSpan(LP_TRACE_DISPATCH, NULL, tracedUs, (uint32_t)lagUs);
+
+	_loopStats.dispatches++;
+	_lagTotalUs += (uint64_t)lagUs;
+	if (lagUs > _loopStats.lagMaxUs) {
+		_loopStats.lagMaxUs = (uint32_t)lagUs;
+	}
+	if (runUs > _loopStats.runMaxUs) {
+		_loopStats.runMaxUs = (uint32_t)runUs;
+	}
+
+	if (runUs > _budgetUs) {
+		lp_getTimerStats(&after);
+		_loopStats.overBudget++;
+		LP_LOG_LIMITED(LP_LOG_WARNING, LP_LOG_LIMIT_MS, "WARNING: %s dispatch ran %u us, over the %u us budget\n",
+			after.expirations != before.expirations ? "timer" : "I/O", (unsigned)runUs, (unsigned)_budgetUs);
+	}
+
+	return true;
+}
+
+/// <summary>
+///     Keep dispatching, so DoWork, confirmations and inter-core writes go on, while a shutdown hook has work in
+///     flight and the deadline allows, then let the hooks persist what is left. A loop that failed is not run again.
+/// </summary>
+static void RunShutdown(EventLoop* eventLoop, struct pollfd* wakeup) {
+	int64_t startedUs = NowUs();
+	int64_t deadlineUs = startedUs + (int64_t)lp_getShutdownDeadline() * 1000;
+	bool pending;
+
+	while ((pending = lp_runShutdownHooks(false)) && lp_getTerminationExitCode() != ExitCode_Main_EventLoopFail) {
+		int64_t remainingUs = deadlineUs - NowUs();
+
+		if (remainingUs <= 0) {
+			break;
+		}
+
+		int ready = poll(wakeup, 1, (int)((remainingUs + 999) / 1000));
+		if (ready == -1 && errno != EINTR) {
+			break;
+		}
+
+		if (ready > 0) {
+			int64_t wokeUs = NowUs();
+			int dispatched = 0;
+
+			_loopStats.wakeups++;
+			while (dispatched < LP_EVENT_LOOP_BATCH && DispatchOne(eventLoop, wokeUs)) {
+				dispatched++;
+			}
+		}
+	}
+
+	lp_runShutdownHooks(true);
+
+	LP_LOG(pending ? LP_LOG_WARNING : LP_LOG_INFO, "Shutdown %s in %u ms\n", pending ? "deadline passed with work in flight" : "flushed",
+		(unsigned)((NowUs() - startedUs) / 1000));
+}
+
+void lp_runEventLoop(void) {
+	EventLoop* eventLoop = lp_getTimerEventLoop();
+	struct pollfd wakeup = { .fd = EventLoop_GetWaitDescriptor(eventLoop), .events = POLLIN };
+
+	if (eventLoop == NULL || wakeup.fd == -1) {
+		lp_terminate(ExitCode_Main_EventLoopFail);
+		return;
+	}
+
+	while (!lp_isTerminationRequired()) {
+		// continue if interrupted by a signal, e.g. due to a breakpoint being set
+		if (poll(&wakeup, 1, -1) == -1) {
+			if (errno != EINTR) {
+				lp_terminate(ExitCode_Main_EventLoopFail);
+			}
+			continue;
+		}
+
+		int64_t wokeUs = NowUs();
+		int dispatched = 0;
+
+		_loopStats.wakeups++;
+		while (dispatched < LP_EVENT_LOOP_BATCH && !lp_isTerminationRequired() && DispatchOne(eventLoop, wokeUs)) {
+			dispatched++;
+		}
+	}
+
+	RunShutdown(eventLoop, &wakeup);
+}
+
+void lp_setEventLoopBudget(int budgetMs) {
+	_budgetUs = (int64_t)(budgetMs > 0 ? budgetMs : LP_EVENT_LOOP_BUDGET_MS) * 1000;
+}
+
+void lp_getEventLoopStats(LP_EVENT_LOOP_STATS* stats) {
+	if (stats != NULL) {
+		*stats = _loopStats;
+		stats->lagAvgUs = _loopStats.dispatches == 0 ? 0 : (uint32_t)(_lagTotalUs / _loopStats.dispatches);
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "exit_codes.h"
+#include "logging.h"
+#include "terminate.h"
+#include "timer.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LP_EVENT_LOOP_BATCH 16				// events dispatched per wakeup before the termination flag is checked again
+#define LP_EVENT_LOOP_BUDGET_MS 20			// default, a dispatch running longer than this is counted and logged
+
+typedef struct LP_EVENT_LOOP_STATS
+{
+	uint32_t wakeups;				// times the loop woke with events ready
+	uint32_t dispatches;			// events dispatched, the timers due at one expiry are one dispatch
+	uint32_t lagAvgUs;				// mean wait from the wakeup to an event's dispatch
+	uint32_t lagMaxUs;
+	uint32_t runMaxUs;				// longest dispatch
+	uint32_t overBudget;			// dispatches that ran longer than the budget
+} LP_EVENT_LOOP_STATS;
+
+// The app's main loop. lp_runEventLoop() sleeps on the wait descriptor of lp_getTimerEventLoop() and, once it is
+// readable, dispatches up to LP_EVENT_LOOP_BATCH ready events one at a time, timing each from the wakeup, so the
+// lag is how long an event waited behind the handlers dispatched before it in the batch. A dispatch over the budget
+// is counted and logged, naming a timer dispatch or I/O, run lp_setTimerProfiling to find the slow timer. It returns
+// once lp_isTerminationRequired(), a failed wait or dispatch terminates with ExitCode_Main_EventLoopFail, a signal
+// does not.
+//
+// Termination starts a shutdown phase first. The loop goes on dispatching for up to lp_setShutdownDeadline, default
+// LP_SHUTDOWN_DEFAULT_MS, while the library's shutdown hooks, see terminate.h, have work in flight: the telemetry
+// batch and offline queue are sent and DoWork runs until IoT Hub acknowledges them, dirty reported properties are
+// flushed and acknowledged, queued inter-core messages are written. Messages still unsent at the deadline are
+// persisted to the offline queue's spill journal. App timers go on firing meanwhile, a handler that should not
+// start new work can test lp_isTerminationRequired.
+//
+// The health record reports the lag and over budget counts, see health_telemetry.h.
+void lp_runEventLoop(void);
+// zero or less for LP_EVENT_LOOP_BUDGET_MS
+void lp_setEventLoopBudget(int budgetMs);
+void lp_getEventLoopStats(LP_EVENT_LOOP_STATS* stats);
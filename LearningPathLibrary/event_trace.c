@@ -0,0 +1,397 @@
+#include "event_trace.h"
+#include "azure_iot.h"
+#include "blob_upload.h"
+#include "compression.h"
+#include "exit_codes.h"
+#include "terminate.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define TRACE_FRAME_HEADER 8		// CSV length and block length of a blob frame
+#define TRACE_SUBJECT_CHARS 48		// of a subject in the CSV, keeps a line within LP_TRACE_LINE_SIZE
+
+static void EventTraceStopHandler(EventLoopTimer* eventLoopTimer);
+
+static LP_TIMER eventTraceTimer = {
+	.period = { 0, 0 },			// one-shot timer, armed by a capture with a duration
+	.name = "eventTraceTimer",
+	.handler = &EventTraceStopHandler
+};
+
+static LP_TRACE_RECORD* _traceRing = NULL;
+static uint32_t _traceCapacity = 0;
+static _Atomic uint32_t _traceClaimed = 0;		// records ever claimed, a record's slot is its claim modulo the capacity
+static _Atomic bool _traceArmed = false;			// the comms thread records sends
+static uint32_t _traceStartedUs = 0;
+static uint32_t _eventTraceId = 0;					// epoch seconds of the start, names the blob and tags the messages
+static LP_TRACE_SINK _traceSink = LP_TRACE_TO_BLOB;
+static uint8_t* _traceBlob = NULL;					// held until the upload's callback
+static char _traceBlobName[40];
+static bool _traceUploaded = false;					// the last dump went to a blob, not messages
+static LP_MESSAGE_PROPERTY _traceType = { .key = "type", .value = "eventTrace" };
+static LP_MESSAGE_PROPERTY* _traceProperties[] = { &_traceType };
+static LP_MESSAGE_PROPERTY_TEMPLATE _traceTemplate;
+
+static const char* _traceTypeNames[LP_TRACE_TYPES] = {
+	[LP_TRACE_DISPATCH] = "dispatch",
+	[LP_TRACE_TIMER] = "timer",
+	[LP_TRACE_TWIN] = "twin",
+	[LP_TRACE_METHOD] = "method",
+	[LP_TRACE_IC_IN] = "ic_in",
+	[LP_TRACE_IC_OUT] = "ic_out",
+	[LP_TRACE_SEND] = "send",
+	[LP_TRACE_C2D] = "c2d",
+	[LP_TRACE_MARK] = "mark"
+};
+
+static uint32_t TraceNowUs(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)((uint64_t)now.tv_sec * 1000000u + (uint64_t)now.tv_nsec / 1000u);
+}
+
+static void TraceRecord(LP_TRACE_TYPE type, const char* subject, uint32_t atUs, uint32_t durationUs, uint32_t arg) {
+	uint32_t slot = atomic_fetch_add(&_traceClaimed, 1) % _traceCapacity;
+
+	_traceRing[slot] = (LP_TRACE_RECORD){ .subject = subject, .atUs = atUs, .durationUs = durationUs, .arg = arg, .type = (uint8_t)type };
+}
+
+static void TraceTimer(const EventLoopTimer* timer, int64_t startedNs, int64_t runNs, int64_t lagNs) {
+	if (atomic_load(&_traceArmed)) {
+		TraceRecord(LP_TRACE_TIMER, lp_getTimerName(timer), (uint32_t)(startedNs / 1000), (uint32_t)(runNs / 1000),
+			lagNs > 0 ? (uint32_t)(lagNs / 1000) : 0);
+	}
+}
+
+/// <summary>
+///     Now in microseconds to begin a span, 0 while the trace is disarmed
+/// </summary>
+uint32_t lp_traceNow(void) {
+	if (!atomic_load(&_traceArmed)) {
+		return 0;
+	}
+
+	uint32_t now = TraceNowUs();
+	return now != 0 ? now : 1;
+}
+
+/// <summary>
+///     Record a span from beganUs, from lp_traceNow, to now. Nothing when the trace was armed after it began
+/// </summary>
+void lp_traceSpan(LP_TRACE_TYPE type, const char* subject, uint32_t beganUs, uint32_t arg) {
+	if (beganUs == 0 || !atomic_load(&_traceArmed)) {
+		return;
+	}
+
+	TraceRecord(type, subject, beganUs, TraceNowUs() - beganUs, arg);
+}
+
+void lp_traceEvent(LP_TRACE_TYPE type, const char* subject, uint32_t arg) {
+	if (atomic_load(&_traceArmed)) {
+		TraceRecord(type, subject, TraceNowUs(), 0, arg);
+	}
+}
+
+const char* lp_traceTypeName(LP_TRACE_TYPE type) {
+	return type < LP_TRACE_TYPES ? _traceTypeNames[type] : "unknown";
+}
+
+static uint32_t TraceRecordCount(void) {
+	uint32_t claimed = atomic_load(&_traceClaimed);
+	return claimed < _traceCapacity ? claimed : _traceCapacity;
+}
+
+static void TraceDisarm(void) {
+	atomic_store(&_traceArmed, false);
+	SetEventLoopTimerTraceHook(NULL);
+
+	if (eventTraceTimer.eventLoopTimer != NULL) {
+		lp_stopTimer(&eventTraceTimer);
+	}
+}
+
+static void TraceFreeRing(void) {
+	lp_heapFree(LP_HEAP_TRACE, _traceRing);
+	_traceRing = NULL;
+	_traceCapacity = 0;
+	atomic_store(&_traceClaimed, 0);
+}
+
+/// <summary>
+///     Capture up to records, 0 for LP_TRACE_DEFAULT_RECORDS, and dump them to sink after seconds, 0 to capture until
+///     lp_dumpEventTrace. One capture at a time, not while the last dump's upload holds its buffer
+/// </summary>
+bool lp_startEventTrace(size_t records, int seconds, LP_TRACE_SINK sink) {
+	if (_traceRing != NULL || _traceBlob != NULL) {
+		return false;
+	}
+
+	records = records == 0 ? LP_TRACE_DEFAULT_RECORDS : records > LP_TRACE_MAX_RECORDS ? LP_TRACE_MAX_RECORDS : records;
+
+	if ((_traceRing = (LP_TRACE_RECORD*)lp_heapCalloc(LP_HEAP_TRACE, records, sizeof(LP_TRACE_RECORD))) == NULL) {
+		return false;
+	}
+
+	_traceCapacity = (uint32_t)records;
+	_traceSink = sink;
+	_eventTraceId = (uint32_t)time(NULL);
+
+	if (seconds > 0 && ((eventTraceTimer.eventLoopTimer == NULL && !lp_startTimer(&eventTraceTimer)) ||
+		!lp_setOneShotTimer(&eventTraceTimer, &(struct timespec){ seconds, 0 }))) {
+		TraceFreeRing();
+		return false;
+	}
+
+	_traceStartedUs = TraceNowUs();
+	SetEventLoopTimerTraceHook(&TraceTimer);
+	atomic_store(&_traceArmed, true);
+
+	LP_LOG(LP_LOG_INFO, "Event trace %u started, %u records\n", _eventTraceId, _traceCapacity);
+	return true;
+}
+
+/// <summary>
+///     Discard the capture without dumping it
+/// </summary>
+void lp_stopEventTrace(void) {
+	TraceDisarm();
+	TraceFreeRing();
+}
+
+void lp_getEventTraceStatus(LP_TRACE_STATUS* status) {
+	uint32_t records = TraceRecordCount();
+
+	*status = (LP_TRACE_STATUS){
+		.armed = atomic_load(&_traceArmed),
+		.dumping = _traceBlob != NULL,
+		.records = records,
+		.capacity = _traceCapacity,
+		.overwritten = atomic_load(&_traceClaimed) - records
+	};
+}
+
+/// <summary>
+///     CSV lines of the records from *next on, the header first when *next is the oldest record, as fit in capacity.
+///     Advances *next past the records written
+/// </summary>
+static size_t TraceFormat(uint32_t* next, char* buffer, size_t capacity) {
+	uint32_t end = atomic_load(&_traceClaimed);
+	size_t length = 0;
+
+	if (*next == end - TraceRecordCount()) {
+		length = (size_t)snprintf(buffer, capacity, "at_us,type,subject,duration_us,arg\n");
+	}
+
+	for (; *next != end && capacity - length > LP_TRACE_LINE_SIZE; (*next)++) {
+		const LP_TRACE_RECORD* record = &_traceRing[*next % _traceCapacity];
+
+		length += (size_t)snprintf(buffer + length, capacity - length, "%ld,%s,%.*s,%u,%u\n",
+			(long)(int32_t)(record->atUs - _traceStartedUs), lp_traceTypeName((LP_TRACE_TYPE)record->type), TRACE_SUBJECT_CHARS,
+			record->subject != NULL ? record->subject : "", record->durationUs, record->arg);
+	}
+
+	return length;
+}
+
+static void PutLe32(uint8_t* destination, uint32_t value) {
+	for (int i = 0; i < 4; i++) {
+		destination[i] = (uint8_t)(value >> (8 * i));
+	}
+}
+
+static void TraceBlobUploaded(const char* blobName, bool succeeded, void* context) {
+	LP_LOG(succeeded ? LP_LOG_INFO : LP_LOG_ERROR, "Event trace blob %s %s\n", blobName, succeeded ? "uploaded" : "upload failed");
+
+	lp_heapFree(LP_HEAP_TRACE, _traceBlob);
+	_traceBlob = NULL;
+}
+
+/// <summary>
+///     Compress the CSV a frame at a time into one buffer and start its upload, false when the upload is refused
+/// </summary>
+static bool TraceDumpToBlob(void) {
+	char* csv = (char*)lp_heapMalloc(LP_HEAP_TRACE, LP_TRACE_FRAME_BYTES);
+	uint8_t* blob = NULL;
+	size_t blobLength = 0;
+	uint32_t next = atomic_load(&_traceClaimed) - TraceRecordCount();
+	bool first = true;
+
+	while (csv != NULL && (first || next != atomic_load(&_traceClaimed))) {
+		size_t length = TraceFormat(&next, csv, LP_TRACE_FRAME_BYTES);
+		uint8_t* grown = (uint8_t*)lp_heapRealloc(LP_HEAP_TRACE, blob, blobLength + TRACE_FRAME_HEADER + length);
+
+		if (grown == NULL) {
+			lp_heapFree(LP_HEAP_TRACE, csv);
+			csv = NULL;
+			break;
+		}
+		blob = grown;
+
+		uint8_t* frame = blob + blobLength;
+		size_t packed = lp_compressLz4((const uint8_t*)csv, length, frame + TRACE_FRAME_HEADER, length - 1);
+		if (packed == 0) {
+			memcpy(frame + TRACE_FRAME_HEADER, csv, length);		// incompressible, stored
+			packed = length;
+		}
+
+		PutLe32(frame, (uint32_t)length);
+		PutLe32(frame + 4, (uint32_t)packed);
+		blobLength += TRACE_FRAME_HEADER + packed;
+		first = false;
+	}
+
+	if (csv == NULL) {
+		lp_heapFree(LP_HEAP_TRACE, blob);
+		return false;
+	}
+	lp_heapFree(LP_HEAP_TRACE, csv);
+
+	snprintf(_traceBlobName, sizeof(_traceBlobName), "trace-%u.csv.lz4", _eventTraceId);
+
+	_traceBlob = blob;		// before the upload, its callback frees it
+
+	if (!lp_uploadBlob(_traceBlobName, blob, blobLength, &TraceBlobUploaded, NULL)) {
+		lp_heapFree(LP_HEAP_TRACE, _traceBlob);		// refused in comms thread mode or while another upload runs
+		_traceBlob = NULL;
+		return false;
+	}
+
+	LP_LOG(LP_LOG_INFO, "Event trace %u uploading as %s, %u bytes\n", _eventTraceId, _traceBlobName, (unsigned)blobLength);
+	return true;
+}
+
+/// <summary>
+///     Send the CSV as LZ4 encoded messages, properties trace for the capture and part "k/n"
+/// </summary>
+static bool TraceDumpToMessages(void) {
+	char* csv = (char*)lp_heapMalloc(LP_HEAP_TRACE, LP_TRACE_MESSAGE_BYTES + 1);
+	uint32_t oldest = atomic_load(&_traceClaimed) - TraceRecordCount();
+	uint32_t next = oldest;
+	char id[12];
+	char part[24];
+	LP_MESSAGE_PROPERTY traceProperty = { .key = "trace", .value = id };
+	LP_MESSAGE_PROPERTY partProperty = { .key = "part", .value = part };
+	LP_MESSAGE_PROPERTY* overrides[] = { &traceProperty, &partProperty };
+	uint32_t parts = 0;
+
+	if (csv == NULL) {
+		return false;
+	}
+
+	if (_traceTemplate.properties == NULL) {
+		if (!lp_compileMessagePropertyTemplate(&_traceTemplate, _traceProperties, sizeof(_traceProperties) / sizeof(_traceProperties[0]))) {
+			lp_heapFree(LP_HEAP_TRACE, csv);
+			return false;
+		}
+		lp_setMessageEncoding(&_traceTemplate, LP_ENCODING_LZ4);
+		lp_setMessagePriority(&_traceTemplate, LP_PRIORITY_BULK);
+	}
+
+	do {		// counted first so each part says how many there are
+		TraceFormat(&next, csv, LP_TRACE_MESSAGE_BYTES + 1);
+		parts++;
+	} while (next != atomic_load(&_traceClaimed));
+
+	snprintf(id, sizeof(id), "%u", _eventTraceId);
+	next = oldest;
+
+	for (uint32_t i = 1; i <= parts; i++) {
+		TraceFormat(&next, csv, LP_TRACE_MESSAGE_BYTES + 1);
+		snprintf(part, sizeof(part), "%u/%u", i, parts);
+		lp_sendMsgWithProperties(csv, &_traceTemplate, overrides, sizeof(overrides) / sizeof(overrides[0]));		// queued offline when not sent
+	}
+
+	lp_heapFree(LP_HEAP_TRACE, csv);
+	LP_LOG(LP_LOG_INFO, "Event trace %u sent in %u messages\n", _eventTraceId, parts);
+	return true;
+}
+
+/// <summary>
+///     Stop the capture and dump it, as messages when sink is a blob and the upload is refused. The ring is freed
+/// </summary>
+bool lp_dumpEventTrace(LP_TRACE_SINK sink) {
+	if (_traceRing == NULL) {
+		return false;
+	}
+
+	TraceDisarm();
+	_traceUploaded = sink == LP_TRACE_TO_BLOB && TraceDumpToBlob();
+	bool dumped = _traceUploaded || TraceDumpToMessages();
+	TraceFreeRing();
+
+	return dumped;
+}
+
+static void EventTraceStopHandler(EventLoopTimer* eventLoopTimer) {
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_EventTraceHandler);
+		return;
+	}
+
+	lp_dumpEventTrace(_traceSink);
+}
+
+/// <summary>
+///     EventTrace direct method, start, dump, stop or status of a capture
+/// </summary>
+static LP_DIRECT_METHOD_RESPONSE_CODE EventTraceHandler(JSON_Object* json, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg) {
+	const char* action = json_object_get_string(json, "action");
+	const char* sinkName = json_object_get_string(json, "sink");
+	LP_TRACE_SINK sink = sinkName == NULL ? _traceSink : strcmp(sinkName, "messages") == 0 ? LP_TRACE_TO_MESSAGES : LP_TRACE_TO_BLOB;
+	LP_TRACE_STATUS status;
+
+	lp_getEventTraceStatus(&status);
+
+	if (action == NULL || strcmp(action, "status") == 0) {
+		lp_setMethodResponse("Event trace %s, %u of %u records, %u overwritten%s", status.armed ? "armed" : "disarmed",
+			status.records, status.capacity, status.overwritten, status.dumping ? ", uploading the last dump" : "");
+		return LP_METHOD_SUCCEEDED;
+	}
+
+	if (strcmp(action, "start") == 0) {
+		double records = json_object_has_value_of_type(json, "records", JSONNumber) ? json_object_get_number(json, "records") : 0;
+		double seconds = json_object_has_value_of_type(json, "seconds", JSONNumber) ? json_object_get_number(json, "seconds") : 0;
+
+		if (records < 0 || seconds < 0 || seconds > INT32_MAX) {
+			lp_setMethodResponse("Invalid records or seconds");
+			return LP_METHOD_FAILED;
+		}
+		if (!lp_startEventTrace((size_t)records, (int)seconds, sink)) {
+			lp_setMethodResponse(status.armed ? "Event trace already running" : status.dumping ? "Event trace busy, the last dump is uploading" : "Event trace could not start");
+			return LP_METHOD_FAILED;
+		}
+		lp_getEventTraceStatus(&status);
+		lp_setMethodResponse("Event trace %u started, %u records", _eventTraceId, status.capacity);
+		return LP_METHOD_SUCCEEDED;
+	}
+
+	if (strcmp(action, "dump") == 0) {
+		if (status.capacity == 0) {
+			lp_setMethodResponse("No event trace to dump");
+			return LP_METHOD_FAILED;
+		}
+		if (!lp_dumpEventTrace(sink)) {
+			lp_setMethodResponse("Event trace %u dump failed", _eventTraceId);
+			return LP_METHOD_FAILED;
+		}
+		if (_traceUploaded) {
+			lp_setMethodResponse("Event trace %u, %u records, uploading %s", _eventTraceId, status.records, _traceBlobName);
+		} else {
+			lp_setMethodResponse("Event trace %u, %u records, sent as messages", _eventTraceId, status.records);
+		}
+		return LP_METHOD_SUCCEEDED;
+	}
+
+	if (strcmp(action, "stop") == 0) {
+		lp_stopEventTrace();
+		lp_setMethodResponse("Event trace stopped, %u records discarded", status.records);
+		return LP_METHOD_SUCCEEDED;
+	}
+
+	lp_setMethodResponse("Unknown action %s", action);
+	return LP_METHOD_FAILED;
+}
+
+LP_DIRECT_METHOD_BINDING lp_eventTraceDirectMethod = { .methodName = "EventTrace", .handler = EventTraceHandler };
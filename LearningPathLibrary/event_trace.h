@@ -0,0 +1,77 @@
+#pragma once
+
+#include "direct_methods.h"
+#include "heap_stats.h"
+#include "logging.h"
+#include "timer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LP_TRACE_DEFAULT_RECORDS 512
+#define LP_TRACE_MAX_RECORDS 4096
+#define LP_TRACE_LINE_SIZE 96				// longest CSV line of a record
+#define LP_TRACE_FRAME_BYTES 32768			// CSV per LZ4 frame of a blob, below LP_COMPRESS_MAX_INPUT
+#define LP_TRACE_MESSAGE_BYTES 8192			// CSV per message when the trace is sent as messages
+
+typedef enum {
+	LP_TRACE_DISPATCH,			// an event loop dispatch, arg its lag behind the wakeup in us
+	LP_TRACE_TIMER,				// a timer handler, arg its lag behind the scheduled expiry in us
+	LP_TRACE_TWIN,				// a desired property applied, arg 1 when it changed the binding
+	LP_TRACE_METHOD,			// a direct method, parse and handler, arg the status
+	LP_TRACE_IC_IN,				// an inter-core frame read, arg its bytes
+	LP_TRACE_IC_OUT,			// an inter-core frame sent, arg its bytes
+	LP_TRACE_SEND,				// a message handed to the IoT Hub client, arg its metered bytes
+	LP_TRACE_C2D,				// a cloud to device message or part dispatched, arg its disposition
+	LP_TRACE_MARK,				// lp_traceEvent or lp_traceSpan from the app, subject a string
+	LP_TRACE_TYPES
+} LP_TRACE_TYPE;
+
+typedef enum {
+	LP_TRACE_TO_BLOB,			// one blob of frames, 4 byte little endian CSV and block lengths then the LZ4 block
+	LP_TRACE_TO_MESSAGES		// LZ4 encoded messages of LP_TRACE_MESSAGE_BYTES, properties trace and part
+} LP_TRACE_SINK;
+
+typedef struct LP_TRACE_RECORD
+{
+	const char* subject;			// the name of the timer, twin, method, inter-core component or mark
+	uint32_t atUs;					// CLOCK_MONOTONIC, wraps every 71 minutes, dumped relative to the start
+	uint32_t durationUs;
+	uint32_t arg;
+	uint8_t type;
+} LP_TRACE_RECORD;
+
+typedef struct LP_TRACE_STATUS
+{
+	bool armed;
+	bool dumping;					// the last dump's blob upload has not completed
+	uint32_t records;				// in the ring, the newest capacity of them once it wrapped
+	uint32_t capacity;
+	uint32_t overwritten;
+} LP_TRACE_STATUS;
+
+// A ring of what the event loop spent its time on, for a device in the field that is sluggish. While armed the
+// event loop, timer, twin, direct method, inter-core and send paths each add a record with microsecond times,
+// a clock read or two each, and a disarmed trace costs a call and a branch. The ring is allocated when armed and
+// freed once dumped; the newest records are kept once it wraps. A dump stops the capture and goes out as CSV,
+//
+//   at_us,type,subject,duration_us,arg
+//
+// LZ4 compressed into one blob upload named trace-<epoch seconds>.csv.lz4, a block as long as its CSV is the
+// CSV stored, or as compressed messages when blob upload is refused or asked for.
+//
+// lp_eventTraceDirectMethod arms and dumps it from the cloud, {"action":"start","records":1024,"seconds":60,
+// "sink":"blob"} captures for a minute then dumps, without "seconds" until {"action":"dump"}, {"action":"stop"}
+// discards the capture and {"action":"status"} reports it.
+bool lp_startEventTrace(size_t records, int seconds, LP_TRACE_SINK sink);
+bool lp_dumpEventTrace(LP_TRACE_SINK sink);
+void lp_stopEventTrace(void);
+void lp_getEventTraceStatus(LP_TRACE_STATUS* status);
+
+// for the instrumented paths and the app, lp_traceNow is 0 when disarmed and lp_traceSpan then records nothing
+uint32_t lp_traceNow(void);
+void lp_traceSpan(LP_TRACE_TYPE type, const char* subject, uint32_t beganUs, uint32_t arg);
+void lp_traceEvent(LP_TRACE_TYPE type, const char* subject, uint32_t arg);
+const char* lp_traceTypeName(LP_TRACE_TYPE type);
+
+extern LP_DIRECT_METHOD_BINDING lp_eventTraceDirectMethod;		// optional, add to the direct method set
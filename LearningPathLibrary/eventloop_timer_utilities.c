@@ -2,6 +2,7 @@
    Licensed under the MIT License. */
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include <errno.h>
@@ -14,37 +15,435 @@
 
 #include "eventloop_timer_utilities.h"
 
-static int SetTimerPeriod(int timerFd, const struct timespec *initial,
-                          const struct timespec *repeat);
+// All timers of an event loop share one timerfd and one event loop registration. Armed timers are
+// kept in a binary min-heap ordered by deadline and every wakeup runs all timers that are due. A
+// timer with slack may run up to slack late, the timerfd is armed for the earliest deadline plus
+// slack so nearby expirations are serviced by a single wakeup.
+//
+// Timers come from a fixed pool allocated once, on the first create or by SetEventLoopTimerPoolSize,
+// and each scheduler's heap is sized to the pool, so creating and disposing timers never allocates.
 
-static int SetTimerPeriod(int timerFd, const struct timespec *initial,
-                          const struct timespec *repeat)
+#define NS_PER_SEC 1000000000LL
+#define NOT_SCHEDULED ((size_t)-1)
+#define MAX_CATCH_UP 8  // missed slots a catch up timer replays, older slots are skipped
+
+typedef struct TimerScheduler TimerScheduler;
+
+struct EventLoopTimer {
+    TimerScheduler *scheduler;
+    EventLoopTimerHandler handler;
+    int64_t deadline;   // CLOCK_MONOTONIC nanoseconds
+    int64_t period;     // zero for a one-shot timer
+    int64_t slack;      // how late the timer may run to share a wakeup
+    int64_t scheduled;  // intended expiry of the current or last firing
+    EventLoopTimerMissedPolicy missedPolicy;
+    size_t heapIndex;   // NOT_SCHEDULED when disarmed
+    bool expired;       // set before the handler runs, cleared by ConsumeEventLoopTimerEvent
+    uint32_t fires;
+    uint32_t overruns;  // whole periods missed while the event loop was busy
+    uint32_t profiled;  // fires measured with profiling enabled
+    int64_t lagTotal;
+    int64_t lagMax;
+    int64_t runTotal;
+    int64_t runMin;
+    int64_t runMax;
+    EventLoopTimer *nextFree;  // pool free list link while disposed
+};
+
+struct TimerScheduler {
+    EventLoop *eventLoop;
+    int fd;
+    EventRegistration *registration;
+    EventLoopTimer **heap;
+    size_t heapCount;
+    size_t heapCapacity;
+    size_t timerCount;  // scheduler is released with the last timer
+    int64_t armedDeadline;  // deadline the timerfd is armed for, zero when disarmed
+    bool dispatching;
+    EventLoopTimer *running;  // cleared if the running handler disposes its own timer
+    TimerScheduler *next;
+};
+
+static TimerScheduler *schedulers = NULL;
+static EventLoopTimerStats timerStats = {.wakeups = 0, .expirations = 0};
+static bool profiling = false;
+static EventLoopTimerTraceHook traceHook = NULL;
+static EventLoopTimer *timerPool = NULL;
+static EventLoopTimer *freeTimers = NULL;
+
+static int64_t ToNanoseconds(const struct timespec *value)
+{
+    return value == NULL ? 0 : (int64_t)value->tv_sec * NS_PER_SEC + value->tv_nsec;
+}
+
+static int64_t Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ToNanoseconds(&now);
+}
+
+static void HeapSwap(TimerScheduler *scheduler, size_t a, size_t b)
+{
+    EventLoopTimer *timer = scheduler->heap[a];
+    scheduler->heap[a] = scheduler->heap[b];
+    scheduler->heap[b] = timer;
+    scheduler->heap[a]->heapIndex = a;
+    scheduler->heap[b]->heapIndex = b;
+}
+
+static void HeapUp(TimerScheduler *scheduler, size_t index)
+{
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (scheduler->heap[parent]->deadline <= scheduler->heap[index]->deadline) {
+            break;
+        }
+        HeapSwap(scheduler, parent, index);
+        index = parent;
+    }
+}
+
+static void HeapDown(TimerScheduler *scheduler, size_t index)
 {
-    static const struct timespec nullTimeSpec = {.tv_sec = 0, .tv_nsec = 0};
-    struct itimerspec newValue = {.it_value = initial ? *initial : nullTimeSpec,
-                                  .it_interval = repeat ? *repeat : nullTimeSpec};
+    for (;;) {
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+
+        if (left < scheduler->heapCount &&
+            scheduler->heap[left]->deadline < scheduler->heap[smallest]->deadline) {
+            smallest = left;
+        }
+        if (right < scheduler->heapCount &&
+            scheduler->heap[right]->deadline < scheduler->heap[smallest]->deadline) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            return;
+        }
+        HeapSwap(scheduler, index, smallest);
+        index = smallest;
+    }
+}
+
+static void HeapRemove(TimerScheduler *scheduler, EventLoopTimer *timer)
+{
+    size_t index = timer->heapIndex;
+
+    if (index == NOT_SCHEDULED) {
+        return;
+    }
+
+    timer->heapIndex = NOT_SCHEDULED;
+    scheduler->heapCount--;
+
+    if (index != scheduler->heapCount) {
+        scheduler->heap[index] = scheduler->heap[scheduler->heapCount];
+        scheduler->heap[index]->heapIndex = index;
+        HeapUp(scheduler, index);
+        HeapDown(scheduler, scheduler->heap[index]->heapIndex);
+    }
+}
+
+static int HeapInsert(TimerScheduler *scheduler, EventLoopTimer *timer)
+{
+    if (scheduler->heapCount == scheduler->heapCapacity) {
+        size_t capacity = scheduler->heapCapacity == 0 ? 8 : scheduler->heapCapacity * 2;
+        EventLoopTimer **heap = realloc(scheduler->heap, capacity * sizeof(EventLoopTimer *));
+        if (heap == NULL) {
+            errno = ENOMEM;
+            return -1;
+        }
+        scheduler->heap = heap;
+        scheduler->heapCapacity = capacity;
+    }
+
+    timer->heapIndex = scheduler->heapCount;
+    scheduler->heap[scheduler->heapCount++] = timer;
+    HeapUp(scheduler, timer->heapIndex);
+
+    return 0;
+}
+
+/// <summary>
+/// Arm the shared timerfd for the earliest deadline plus slack, skipped while dispatching and when
+/// unchanged.
+/// </summary>
+static int ArmScheduler(TimerScheduler *scheduler)
+{
+    int64_t deadline = scheduler->heapCount > 0
+                           ? scheduler->heap[0]->deadline + scheduler->heap[0]->slack
+                           : 0;
+    struct itimerspec newValue = {.it_value = {.tv_sec = 0, .tv_nsec = 0},
+                                  .it_interval = {.tv_sec = 0, .tv_nsec = 0}};
+
+    if (scheduler->dispatching) {
+        return 0;
+    }
+
+    // a later deadline with less slack can be due first
+    for (size_t i = 1; i < scheduler->heapCount; i++) {
+        EventLoopTimer *timer = scheduler->heap[i];
+        if (timer->deadline + timer->slack < deadline) {
+            deadline = timer->deadline + timer->slack;
+        }
+    }
 
-    if (timerfd_settime(timerFd, /* flags */ 0, &newValue, /* old_value */ NULL) < 0) {
+    if (deadline == scheduler->armedDeadline) {
+        return 0;
+    }
+
+    newValue.it_value.tv_sec = deadline / NS_PER_SEC;
+    newValue.it_value.tv_nsec = deadline % NS_PER_SEC;
+
+    if (timerfd_settime(scheduler->fd, TFD_TIMER_ABSTIME, &newValue, /* old_value */ NULL) < 0) {
         Log_Debug("ERROR: Could not set timer period: %s (%d).\n", strerror(errno), errno);
         return -1;
     }
 
+    scheduler->armedDeadline = deadline;
     return 0;
 }
 
-struct EventLoopTimer {
-    EventLoop *eventLoop;
-    EventLoopTimerHandler handler;
-    int fd;
-    EventRegistration *registration;
-};
+static void ReleaseScheduler(TimerScheduler *scheduler)
+{
+    TimerScheduler **link = &schedulers;
+
+    // a handler disposing the last timer leaves the release to the end of the dispatch
+    if (scheduler->timerCount > 0 || scheduler->dispatching) {
+        return;
+    }
+
+    while (*link != scheduler) {
+        link = &(*link)->next;
+    }
+    *link = scheduler->next;
+
+    EventLoop_UnregisterIo(scheduler->eventLoop, scheduler->registration);
+    close(scheduler->fd);
+    free(scheduler->heap);
+    free(scheduler);
+}
 
 // This satisfies the EventLoopIoCallback signature.
-static void TimerCallback(EventLoop *el, int fd, EventLoop_IoEvents events, void *context)
+static void SchedulerCallback(EventLoop *el, int fd, EventLoop_IoEvents events, void *context)
+{
+    TimerScheduler *scheduler = (TimerScheduler *)context;
+    uint64_t timerData = 0;
+    int64_t now = Now();
+
+    if (read(scheduler->fd, &timerData, sizeof(timerData)) == -1 && errno != EAGAIN) {
+        Log_Debug("ERROR: Could not read timerfd %s (%d).\n", strerror(errno), errno);
+    }
+
+    scheduler->armedDeadline = 0;
+    scheduler->dispatching = true;
+
+    if (scheduler->heapCount > 0 && scheduler->heap[0]->deadline <= now) {
+        timerStats.wakeups++;
+    }
+
+    // periodic timers are rescheduled before their handler runs, past now except for a bounded
+    // number of catch up slots, so the loop ends
+    while (scheduler->heapCount > 0 && scheduler->heap[0]->deadline <= now) {
+        EventLoopTimer *timer = scheduler->heap[0];
+        int64_t scheduled = timer->deadline;
+
+        if (timer->period > 0) {
+            int64_t missed = (now - scheduled) / timer->period;
+
+            if (timer->missedPolicy == EventLoopTimer_CatchUpMissed && missed > MAX_CATCH_UP) {
+                timer->overruns += (uint32_t)(missed - MAX_CATCH_UP);
+                scheduled += (missed - MAX_CATCH_UP) * timer->period;
+                missed = MAX_CATCH_UP;
+            }
+
+            timer->deadline = scheduled + timer->period;
+            if (timer->deadline <= now) {
+                if (timer->missedPolicy == EventLoopTimer_SkipMissed) {
+                    timer->overruns += (uint32_t)missed;
+                    timer->deadline = scheduled + (missed + 1) * timer->period;  // stays on the period grid
+                } else if (timer->missedPolicy == EventLoopTimer_CollapseMissed) {
+                    timer->overruns += (uint32_t)missed;
+                    timer->deadline = now + timer->period;  // missed periods collapse into one expiry
+                }
+            }
+            HeapDown(scheduler, 0);
+        } else {
+            HeapRemove(scheduler, timer);
+        }
+
+        timer->scheduled = scheduled;
+
+        timerStats.expirations++;
+        timer->fires++;
+        timer->expired = true;
+
+        if (!profiling && traceHook == NULL) {
+            timer->handler(timer);  // may change, dispose or create timers
+            continue;
+        }
+
+        int64_t started = Now();
+        scheduler->running = timer;
+        timer->handler(timer);
+
+        if (scheduler->running == timer) {
+            int64_t lag = started - scheduled;
+            int64_t run = Now() - started;
+
+            if (profiling) {
+                timer->profiled++;
+                timer->lagTotal += lag;
+                timer->lagMax = lag > timer->lagMax ? lag : timer->lagMax;
+                timer->runTotal += run;
+                timer->runMin = timer->profiled == 1 || run < timer->runMin ? run : timer->runMin;
+                timer->runMax = run > timer->runMax ? run : timer->runMax;
+            }
+            if (traceHook != NULL) {
+                traceHook(timer, started, run, lag);
+            }
+        }
+        scheduler->running = NULL;
+    }
+
+    scheduler->dispatching = false;
+    ArmScheduler(scheduler);
+    ReleaseScheduler(scheduler);
+}
+
+static TimerScheduler *AcquireScheduler(EventLoop *eventLoop)
+{
+    TimerScheduler *scheduler = schedulers;
+
+    while (scheduler != NULL && scheduler->eventLoop != eventLoop) {
+        scheduler = scheduler->next;
+    }
+
+    if (scheduler != NULL) {
+        scheduler->timerCount++;
+        return scheduler;
+    }
+
+    scheduler = calloc(1, sizeof(TimerScheduler));
+    if (scheduler == NULL) {
+        return NULL;
+    }
+
+    scheduler->heap = calloc(timerStats.poolSize, sizeof(EventLoopTimer *));
+    if (scheduler->heap == NULL) {
+        free(scheduler);
+        return NULL;
+    }
+    scheduler->heapCapacity = timerStats.poolSize;
+
+    scheduler->eventLoop = eventLoop;
+    scheduler->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (scheduler->fd == -1) {
+        Log_Debug("ERROR: Unable to create timer: %s (%d).\n", strerror(errno), errno);
+        free(scheduler->heap);
+        free(scheduler);
+        return NULL;
+    }
+
+    scheduler->registration =
+        EventLoop_RegisterIo(eventLoop, scheduler->fd, EventLoop_Input, SchedulerCallback, scheduler);
+    if (scheduler->registration == NULL) {
+        Log_Debug("ERROR: Unable to register timer event: %s (%d).\n", strerror(errno), errno);
+        close(scheduler->fd);
+        free(scheduler->heap);
+        free(scheduler);
+        return NULL;
+    }
+
+    scheduler->timerCount = 1;
+    scheduler->next = schedulers;
+    schedulers = scheduler;
+
+    return scheduler;
+}
+
+static int SetTimerPeriod(EventLoopTimer *timer, const struct timespec *initial,
+                          const struct timespec *repeat)
 {
-    EventLoopTimer *timer = (EventLoopTimer *)context;
+    int64_t delay = ToNanoseconds(initial);
 
-    timer->handler(timer);
+    HeapRemove(timer->scheduler, timer);
+    timer->period = ToNanoseconds(repeat);
+    timer->expired = false;
+
+    // as with timerfd_settime a zero initial expiry disarms the timer
+    if (delay > 0) {
+        timer->deadline = Now() + delay;
+        if (HeapInsert(timer->scheduler, timer) == -1) {
+            Log_Debug("ERROR: Could not set timer period: %s (%d).\n", strerror(errno), errno);
+            return -1;
+        }
+    }
+
+    return ArmScheduler(timer->scheduler);
+}
+
+int SetEventLoopTimerPoolSize(size_t count)
+{
+    if (count == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (timerStats.poolInUse > 0) {
+        errno = EBUSY;
+        return -1;
+    }
+
+    EventLoopTimer *pool = calloc(count, sizeof(EventLoopTimer));
+    if (pool == NULL) {
+        return -1;
+    }
+
+    free(timerPool);
+    timerPool = pool;
+    timerStats.poolSize = (uint32_t)count;
+
+    freeTimers = NULL;
+    for (size_t i = count; i > 0; i--) {
+        timerPool[i - 1].nextFree = freeTimers;
+        freeTimers = &timerPool[i - 1];
+    }
+
+    return 0;
+}
+
+static EventLoopTimer *AllocateTimer(void)
+{
+    if (timerPool == NULL && SetEventLoopTimerPoolSize(EVENTLOOP_TIMER_POOL_DEFAULT) == -1) {
+        return NULL;
+    }
+
+    EventLoopTimer *timer = freeTimers;
+    if (timer == NULL) {
+        timerStats.poolRefused++;
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    freeTimers = timer->nextFree;
+    memset(timer, 0, sizeof(EventLoopTimer));
+
+    if (++timerStats.poolInUse > timerStats.poolHighWater) {
+        timerStats.poolHighWater = timerStats.poolInUse;
+    }
+
+    return timer;
+}
+
+static void FreeTimer(EventLoopTimer *timer)
+{
+    timer->handler = NULL;
+    timer->nextFree = freeTimers;
+    freeTimers = timer;
+    timerStats.poolInUse--;
 }
 
 EventLoopTimer *CreateEventLoopPeriodicTimer(EventLoop *eventLoop, EventLoopTimerHandler handler,
@@ -55,40 +454,26 @@ EventLoopTimer *CreateEventLoopPeriodicTimer(EventLoop *eventLoop, EventLoopTime
         return NULL;
     }
 
-    EventLoopTimer *timer = malloc(sizeof(EventLoopTimer));
+    EventLoopTimer *timer = AllocateTimer();
     if (timer == NULL) {
         return NULL;
     }
 
-    timer->eventLoop = eventLoop;
     timer->handler = handler;
+    timer->heapIndex = NOT_SCHEDULED;
 
-    // Initialize to unused values in case have to clean up partially initialized object.
-    timer->fd = -1;
-    timer->registration = NULL;
-
-    timer->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
-    if (timer->fd == -1) {
-        Log_Debug("ERROR: Unable to create timer: %s (%d).\n", strerror(errno), errno);
-        goto failed;
-    }
-
-    if (SetTimerPeriod(timer->fd, /* initial */ period, /* repeat */ period) == -1) {
-        goto failed;
+    timer->scheduler = AcquireScheduler(eventLoop);
+    if (timer->scheduler == NULL) {
+        FreeTimer(timer);
+        return NULL;
     }
 
-    timer->registration =
-        EventLoop_RegisterIo(eventLoop, timer->fd, EventLoop_Input, TimerCallback, timer);
-    if (timer->registration == NULL) {
-        Log_Debug("ERROR: Unable to register timer event: %s (%d).\n", strerror(errno), errno);
-        goto failed;
+    if (SetTimerPeriod(timer, /* initial */ period, /* repeat */ period) == -1) {
+        DisposeEventLoopTimer(timer);
+        return NULL;
     }
 
     return timer;
-
-failed:
-    DisposeEventLoopTimer(timer);
-    return NULL;
 }
 
 EventLoopTimer *CreateEventLoopDisarmedTimer(EventLoop *eventLoop, EventLoopTimerHandler handler)
@@ -102,38 +487,113 @@ void DisposeEventLoopTimer(EventLoopTimer *timer)
         return;
     }
 
-    EventLoop_UnregisterIo(timer->eventLoop, timer->registration);
-
-    if (timer->fd != -1) {
-        close(timer->fd);
+    if (timer->scheduler->running == timer) {
+        timer->scheduler->running = NULL;
     }
 
-    free(timer);
+    HeapRemove(timer->scheduler, timer);
+    ArmScheduler(timer->scheduler);
+    timer->scheduler->timerCount--;
+    ReleaseScheduler(timer->scheduler);
+
+    FreeTimer(timer);
 }
 
 int ConsumeEventLoopTimerEvent(EventLoopTimer *timer)
 {
-    uint64_t timerData = 0;
-
-    if (read(timer->fd, &timerData, sizeof(timerData)) == -1) {
+    if (!timer->expired) {
+        errno = EAGAIN;  // as reading an unexpired non blocking timerfd
         Log_Debug("ERROR: Could not read timerfd %s (%d).\n", strerror(errno), errno);
         return -1;
     }
 
+    timer->expired = false;
     return 0;
 }
 
 int SetEventLoopTimerPeriod(EventLoopTimer *timer, const struct timespec *period)
 {
-    return SetTimerPeriod(timer->fd, /* initial */ period, /* period */ period);
+    return SetTimerPeriod(timer, /* initial */ period, /* period */ period);
 }
 
 int SetEventLoopTimerOneShot(EventLoopTimer *timer, const struct timespec *delay)
 {
-    return SetTimerPeriod(timer->fd, /* initial */ delay, /* repeat */ NULL);
+    return SetTimerPeriod(timer, /* initial */ delay, /* repeat */ NULL);
 }
 
 int DisarmEventLoopTimer(EventLoopTimer *timer)
 {
-    return SetTimerPeriod(timer->fd, /* initial */ NULL, /* repeat */ NULL);
+    return SetTimerPeriod(timer, /* initial */ NULL, /* repeat */ NULL);
+}
+
+int SetEventLoopTimerSlack(EventLoopTimer *timer, const struct timespec *slack)
+{
+    if (slack != NULL && (slack->tv_sec < 0 || slack->tv_nsec < 0)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    timer->slack = ToNanoseconds(slack);
+    return ArmScheduler(timer->scheduler);
+}
+
+void GetEventLoopTimerStats(EventLoopTimerStats *stats)
+{
+    *stats = timerStats;
+}
+
+void SetEventLoopTimerProfiling(bool enabled)
+{
+    profiling = enabled;
+}
+
+void SetEventLoopTimerTraceHook(EventLoopTimerTraceHook hook)
+{
+    traceHook = hook;
+}
+
+void GetEventLoopTimerProfile(const EventLoopTimer *timer, EventLoopTimerProfile *profile)
+{
+    profile->fires = timer->fires;
+    profile->overruns = timer->overruns;
+    profile->profiled = timer->profiled;
+    profile->lagMaxUs = (uint32_t)(timer->lagMax / 1000);
+    profile->lagAvgUs = timer->profiled == 0 ? 0 : (uint32_t)(timer->lagTotal / timer->profiled / 1000);
+    profile->runMinUs = (uint32_t)(timer->runMin / 1000);
+    profile->runMaxUs = (uint32_t)(timer->runMax / 1000);
+    profile->runAvgUs = timer->profiled == 0 ? 0 : (uint32_t)(timer->runTotal / timer->profiled / 1000);
+}
+
+int SetEventLoopTimerMissedPolicy(EventLoopTimer *timer, EventLoopTimerMissedPolicy policy)
+{
+    if (policy != EventLoopTimer_CollapseMissed && policy != EventLoopTimer_SkipMissed &&
+        policy != EventLoopTimer_CatchUpMissed) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    timer->missedPolicy = policy;
+    return 0;
+}
+
+void GetEventLoopTimerScheduledTime(const EventLoopTimer *timer, struct timespec *scheduled)
+{
+    scheduled->tv_sec = (time_t)(timer->scheduled / NS_PER_SEC);
+    scheduled->tv_nsec = (long)(timer->scheduled % NS_PER_SEC);
+}
+
+int GetEventLoopTimerRemaining(const EventLoopTimer *timer, struct timespec *remaining)
+{
+    int64_t left;
+
+    if (timer->heapIndex == NOT_SCHEDULED) {
+        return -1;
+    }
+
+    left = timer->deadline - Now();
+    left = left > 0 ? left : 0;
+    remaining->tv_sec = (time_t)(left / NS_PER_SEC);
+    remaining->tv_nsec = (long)(left % NS_PER_SEC);
+
+    return 0;
 }
@@ -2,6 +2,8 @@
    Licensed under the MIT License. */
 
 #pragma once
+#include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 
 #include <unistd.h>
@@ -49,6 +51,19 @@ EventLoopTimer *CreateEventLoopPeriodicTimer(EventLoop *eventLoop, EventLoopTime
 /// information available in errno.</returns>.
 EventLoopTimer *CreateEventLoopDisarmedTimer(EventLoop *eventLoop, EventLoopTimerHandler handler);
 
+#ifndef EVENTLOOP_TIMER_POOL_DEFAULT
+#define EVENTLOOP_TIMER_POOL_DEFAULT 32  // timers in the pool when it was not sized before the first create
+#endif
+
+/// <summary>
+/// Size the pool every timer is allocated from, once, before timers are created. Creating a
+/// timer with all of them in use fails with ENOMEM, nothing is allocated after this call.
+/// </summary>
+/// <param name="count">Most timers alive at once, across all event loops.</param>
+/// <returns>0 on success; -1 on failure, in which case errno contains more information,
+/// EBUSY if any timer is alive.</returns>
+int SetEventLoopTimerPoolSize(size_t count);
+
 /// <summary>
 /// Dispose of a timer which was allocated with <see cref="CreateEventLoopPeriodicTimer" />
 /// or <see cref="CreateEventLoopDisarmedTimer" />.
@@ -100,3 +115,112 @@ int SetEventLoopTimerOneShot(EventLoopTimer *timer, const struct timespec *delay
 /// <seealso cref="SetEventLoopTimerOneShot" />
 /// <seealso cref="SetEventLoopTimerPeriod" />
 int DisarmEventLoopTimer(EventLoopTimer *timer);
+
+/// <summary>
+/// Allow the timer to expire up to slack late so it can share a wakeup with other timers
+/// on the same event loop. The deadline itself is unchanged, periodic timers keep their cadence.
+/// </summary>
+/// <param name="timer">LP_TIMER previously allocated with <see cref="CreateEventLoopPeriodicTimer" />
+/// or <see cref="CreateEventLoopDisarmedTimer" />.</param>
+/// <param name="slack">Tolerance, NULL or zero for exact expiry.</param>
+/// <returns>0 on success; -1 on failure, in which case errno contains more
+/// information.</returns>
+int SetEventLoopTimerSlack(EventLoopTimer *timer, const struct timespec *slack);
+
+/// <summary>
+/// Wakeup counters of the timer schedulers. Each expiration beyond the first in a
+/// wakeup would have been a wakeup of its own with one timerfd per timer. The pool
+/// counters are the timers allocated from the timer pool.
+/// </summary>
+typedef struct {
+    uint32_t wakeups;
+    uint32_t expirations;
+    uint32_t poolSize;
+    uint32_t poolInUse;
+    uint32_t poolHighWater;
+    uint32_t poolRefused;  // creates that failed with the pool exhausted
+} EventLoopTimerStats;
+
+/// <summary>
+/// Read the wakeup counters since startup.
+/// </summary>
+/// <param name="stats">Receives the counters.</param>
+void GetEventLoopTimerStats(EventLoopTimerStats *stats);
+
+/// <summary>
+/// Per timer counters. Fires and overruns are always counted, lag (actual versus scheduled expiry)
+/// and handler run time only while profiling is enabled.
+/// </summary>
+typedef struct {
+    uint32_t fires;
+    uint32_t overruns;
+    uint32_t profiled;
+    uint32_t lagAvgUs;
+    uint32_t lagMaxUs;
+    uint32_t runMinUs;
+    uint32_t runAvgUs;
+    uint32_t runMaxUs;
+} EventLoopTimerProfile;
+
+/// <summary>
+/// Measure lag and handler run time of every timer, two clock reads per expiry.
+/// </summary>
+/// <param name="enabled">true to start measuring, false to stop.</param>
+void SetEventLoopTimerProfiling(bool enabled);
+
+/// <summary>
+/// Called after each handler that did not dispose its own timer, with the CLOCK_MONOTONIC time the
+/// handler started, its run time and its lag behind the scheduled expiry, all in nanoseconds.
+/// </summary>
+typedef void (*EventLoopTimerTraceHook)(const EventLoopTimer *timer, int64_t startedNs, int64_t runNs, int64_t lagNs);
+
+/// <summary>
+/// Report every handler to a hook, two clock reads per expiry while one is set.
+/// </summary>
+/// <param name="hook">The hook, NULL to stop.</param>
+void SetEventLoopTimerTraceHook(EventLoopTimerTraceHook hook);
+
+/// <summary>
+/// Read the counters of a timer.
+/// </summary>
+/// <param name="timer">Successfully allocated timer.</param>
+/// <param name="profile">Receives the counters.</param>
+void GetEventLoopTimerProfile(const EventLoopTimer *timer, EventLoopTimerProfile *profile);
+
+/// <summary>
+/// What a periodic timer does with expiries missed while the event loop was busy. Deadlines are
+/// absolute monotonic times on the period grid, handler run time never shifts them.
+/// </summary>
+typedef enum {
+    /// <summary>Fire once and restart the period from now (default).</summary>
+    EventLoopTimer_CollapseMissed = 0,
+    /// <summary>Fire once and stay on the period grid, skipping missed slots.</summary>
+    EventLoopTimer_SkipMissed = 1,
+    /// <summary>Fire once per missed slot, up to 8, each with its own scheduled time.</summary>
+    EventLoopTimer_CatchUpMissed = 2
+} EventLoopTimerMissedPolicy;
+
+/// <summary>
+/// Set how a periodic timer handles missed expiries.
+/// </summary>
+/// <param name="timer">Successfully allocated timer.</param>
+/// <param name="policy">Missed expiry policy.</param>
+/// <returns>0 on success; -1 on failure, in which case errno contains more
+/// information.</returns>
+int SetEventLoopTimerMissedPolicy(EventLoopTimer *timer, EventLoopTimerMissedPolicy policy);
+
+/// <summary>
+/// The CLOCK_MONOTONIC time the current (or last) expiry was scheduled for, which can be
+/// earlier than the time the handler runs.
+/// </summary>
+/// <param name="timer">Successfully allocated timer.</param>
+/// <param name="scheduled">Receives the scheduled expiry.</param>
+void GetEventLoopTimerScheduledTime(const EventLoopTimer *timer, struct timespec *scheduled);
+
+/// <summary>
+/// The time left until the timer next expires, zero when it is due now.
+/// </summary>
+/// <param name="timer">Successfully allocated timer.</param>
+/// <param name="remaining">Receives the time left.</param>
+/// <returns>0 on success; -1 when the timer is disarmed.</returns>
+int GetEventLoopTimerRemaining(const EventLoopTimer *timer, struct timespec *remaining);
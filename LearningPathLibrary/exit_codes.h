@@ -18,11 +18,34 @@ typedef enum {
 	ExitCode_ConsumeEventLoopTimeEvent = 14,
 	ExitCode_Gpio_Read = 15,
 	ExitCode_InterCoreReceiveFailed = 16,
+	ExitCode_TelemetryBatchFlushHandler = 17,
+	ExitCode_ReportedStateFlushHandler = 18,
+	ExitCode_DirectMethodTimeoutHandler = 19,
 
 	ExitCode_IsButtonPressed = 20,
 	ExitCode_ButtonPressCheckHandler = 21,
 	ExitCode_Led2OffHandler = 22,
 
-	ExitCode_MissingRealTimeComponentId = 23
+	ExitCode_MissingRealTimeComponentId = 23,
+
+	ExitCode_DeferredWorkHandler = 24,
+	ExitCode_InterCoreRequestTimeoutHandler = 25,
+	ExitCode_ImuCalibrationHandler = 26,
+	ExitCode_HealthTelemetryHandler = 27,
+	ExitCode_DutyCyclePollHandler = 28,
+	ExitCode_DutyCycleSampleHandler = 29,
+	ExitCode_NetworkStateHandler = 30,
+	ExitCode_BlobUploadHandler = 31,
+	ExitCode_TelemetryFidelityHandler = 32,
+	ExitCode_CommsThreadHandler = 33,
+	ExitCode_WorkerPoolHandler = 34,
+	ExitCode_InterCoreTimeSyncHandler = 35,
+	ExitCode_InterCoreHandshakeHandler = 36,
+	ExitCode_SoakMonitorHandler = 37,
+	ExitCode_JournalCommitHandler = 38,
+	ExitCode_EventTraceHandler = 39,
+	ExitCode_CoroutineHandler = 40,
+	ExitCode_UpdateDeferralHandler = 41,
+	ExitCode_MemoryGovernorHandler = 42
 
 } ExitCode;
\ No newline at end of file
@@ -1,30 +1,130 @@
 #include "globals.h"
+#include <stdint.h>
+#include <stdio.h>
 
 
 char scopeId[SCOPEID_LENGTH];
 char rtAppComponentId[RT_APP_COMPONENT_LENGTH];  //initialized from cmdline argument
 //volatile sig_atomic_t terminationRequired = false;
 bool realTelemetry = false;		// Generate fake telemetry or use Seeed Studio Grove SHT31 Sensor
+const char* syntheticLoadArgs = NULL;
+const char* soakArgs = NULL;
 
 
 void lp_processCmdArgs(int argc, char* argv[]) {
-	do {
-		argc--;
-		switch (argc)
+	int position = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (strncmp(argv[i], LP_SYNTHETIC_LOAD_ARG, strlen(LP_SYNTHETIC_LOAD_ARG)) == 0) {
+			syntheticLoadArgs = argv[i] + strlen(LP_SYNTHETIC_LOAD_ARG);
+			continue;
+		}
+
+		if (strncmp(argv[i], LP_SOAK_ARG, strlen(LP_SOAK_ARG)) == 0) {
+			soakArgs = argv[i] + strlen(LP_SOAK_ARG);
+			continue;
+		}
+
+		switch (++position)
 		{
 		case 1:
-			strncpy(scopeId, argv[1], SCOPEID_LENGTH);
+			strncpy(scopeId, argv[i], SCOPEID_LENGTH);
 			break;
 		case 2:
-			strncpy(rtAppComponentId, argv[2], RT_APP_COMPONENT_LENGTH);
+			strncpy(rtAppComponentId, argv[i], RT_APP_COMPONENT_LENGTH);
 			break;
 		}
-	} while (argc > 1);
+	}
 }
 
-char* lp_getCurrentUtc(char* buffer, size_t bufferSize) {
-	time_t now = time(NULL);
-	struct tm* t = gmtime(&now);
-	strftime(buffer, bufferSize - 1, "%Y-%d-%m %H:%M:%S", t);
+// the date and time of day last formatted, only the fields that changed are redone
+static char _utcCache[20];		// 2020-07-01T10:20:30
+static time_t _utcCacheDay = -1;
+static time_t _utcCacheSecond = -1;
+
+// CLOCK_REALTIME less CLOCK_MONOTONIC, refreshed now and then to follow clock updates
+static int64_t _utcOffsetNs = 0;
+static time_t _utcOffsetAt = -1;
+
+static void PutTwoDigits(char* p, int value) {
+	p[0] = (char)('0' + value / 10);
+	p[1] = (char)('0' + value % 10);
+}
+
+/// <summary>
+///     ISO 8601 UTC with milliseconds, for example 2020-07-01T10:20:30.500Z. The date is only formatted
+///     when the day changes and the time of day only when the second does
+/// </summary>
+char* lp_formatUtc(const struct timespec* utc, char* buffer, size_t bufferSize) {
+	time_t second = utc->tv_sec;
+	int ms = (int)(utc->tv_nsec / 1000000);
+
+	if (bufferSize == 0) {
+		return buffer;
+	}
+
+	if (second != _utcCacheSecond) {
+		if (second / 86400 != _utcCacheDay) {
+			struct tm t;
+			gmtime_r(&second, &t);
+			strftime(_utcCache, sizeof(_utcCache), "%Y-%m-%dT", &t);
+			_utcCacheDay = second / 86400;
+		}
+
+		int timeOfDay = (int)(second % 86400);
+		PutTwoDigits(&_utcCache[11], timeOfDay / 3600);
+		_utcCache[13] = ':';
+		PutTwoDigits(&_utcCache[14], timeOfDay / 60 % 60);
+		_utcCache[16] = ':';
+		PutTwoDigits(&_utcCache[17], timeOfDay % 60);
+		_utcCache[19] = '\0';
+		_utcCacheSecond = second;
+	}
+
+	char truncated[LP_UTC_LENGTH];
+	char* out = bufferSize < LP_UTC_LENGTH ? truncated : buffer;	// short buffers get the leading bytes
+
+	memcpy(out, _utcCache, 19);
+	out[19] = '.';
+	out[20] = (char)('0' + ms / 100);
+	PutTwoDigits(&out[21], ms % 100);
+	out[23] = 'Z';
+	out[24] = '\0';
+
+	if (out != buffer) {
+		memcpy(buffer, truncated, bufferSize - 1);
+		buffer[bufferSize - 1] = '\0';
+	}
+
 	return buffer;
-}
\ No newline at end of file
+}
+
+char* lp_getCurrentUtc(char* buffer, size_t bufferSize) {
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	return lp_formatUtc(&now, buffer, bufferSize);
+}
+
+/// <summary>
+///     UTC of a CLOCK_MONOTONIC time, so samples can be stamped with the cheaper monotonic clock and converted
+///     when they are sent
+/// </summary>
+void lp_monotonicToUtc(const struct timespec* monotonic, struct timespec* utc) {
+	if (_utcOffsetAt < 0 || monotonic->tv_sec - _utcOffsetAt >= LP_UTC_OFFSET_REFRESH_S || monotonic->tv_sec < _utcOffsetAt) {
+		struct timespec realtime, now;
+		clock_gettime(CLOCK_REALTIME, &realtime);
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		_utcOffsetNs = ((int64_t)realtime.tv_sec - now.tv_sec) * 1000000000LL + (realtime.tv_nsec - now.tv_nsec);
+		_utcOffsetAt = now.tv_sec;
+	}
+
+	int64_t ns = (int64_t)monotonic->tv_sec * 1000000000LL + monotonic->tv_nsec + _utcOffsetNs;
+	utc->tv_sec = (time_t)(ns / 1000000000LL);
+	utc->tv_nsec = (long)(ns % 1000000000LL);
+}
+
+char* lp_getMonotonicUtc(const struct timespec* monotonic, char* buffer, size_t bufferSize) {
+	struct timespec utc;
+	lp_monotonicToUtc(monotonic, &utc);
+	return lp_formatUtc(&utc, buffer, bufferSize);
+}
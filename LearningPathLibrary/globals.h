@@ -8,6 +8,12 @@
 #define SCOPEID_LENGTH 20
 #define RT_APP_COMPONENT_LENGTH 36 + 1  // GUID 36 Char + 1 NULL terminate)
 
+#define LP_UTC_LENGTH 25			// 2020-07-01T10:20:30.500Z and the terminator
+#define LP_UTC_OFFSET_REFRESH_S 60	// how long a monotonic to UTC offset is used before it is read again
+
+#define LP_SYNTHETIC_LOAD_ARG "--load="	// may come anywhere in the CmdArgs, the scope and component IDs keep their places
+#define LP_SOAK_ARG "--soak="				// as may this one
+
 #define NELEMS(x)  (sizeof(x) / sizeof((x)[0]))
 
 extern char scopeId[SCOPEID_LENGTH]; // ScopeId for the Azure IoT Central application, set in app_manifest.json, CmdArgs
@@ -15,5 +21,10 @@ extern char rtAppComponentId[RT_APP_COMPONENT_LENGTH];  //initialized from cmdli
 
 //extern volatile sig_atomic_t terminationRequired;
 extern bool realTelemetry;		// flag for real or fake telemetry
+extern const char* syntheticLoadArgs;	// after LP_SYNTHETIC_LOAD_ARG in the CmdArgs, NULL without one, see synthetic_load.h
+extern const char* soakArgs;			// the sample period in seconds after LP_SOAK_ARG, NULL without one, see soak_monitor.h
 void lp_processCmdArgs(int argc, char* argv[]);
 char* lp_getCurrentUtc(char* buffer, size_t bufferSize);
+char* lp_formatUtc(const struct timespec* utc, char* buffer, size_t bufferSize);
+void lp_monotonicToUtc(const struct timespec* monotonic, struct timespec* utc);
+char* lp_getMonotonicUtc(const struct timespec* monotonic, char* buffer, size_t bufferSize);
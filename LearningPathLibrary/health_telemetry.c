@@ -0,0 +1,88 @@
+#include "health_telemetry.h"
+
+static void HealthTelemetryHandler(EventLoopTimer* eventLoopTimer);
+
+static LP_TIMER healthTelemetryTimer = {
+	.period = { LP_HEALTH_DEFAULT_PERIOD_SECONDS, 0 },
+	.name = "healthTelemetryTimer",
+	.handler = &HealthTelemetryHandler,
+	.sampling = LP_TIMER_SAMPLE_SKIP		// no slack, how late it fires is the event loop lag the record reports
+};
+
+static LP_MESSAGE_PROPERTY _healthType = { .key = "type", .value = "health" };
+static LP_MESSAGE_PROPERTY* _healthProperties[] = { &_healthType };
+static LP_MESSAGE_PROPERTY_TEMPLATE _healthTemplate;
+static uint32_t _lagUs = 0;		// how late the health timer last fired, the event loop's lag at that moment
+
+/// <summary>
+///     Send a health record every periodSeconds, zero or less for LP_HEALTH_DEFAULT_PERIOD_SECONDS
+/// </summary>
+bool lp_startHealthTelemetry(int periodSeconds) {
+	if (healthTelemetryTimer.eventLoopTimer != NULL) {
+		return true;
+	}
+
+	healthTelemetryTimer.period.tv_sec = periodSeconds > 0 ? periodSeconds : LP_HEALTH_DEFAULT_PERIOD_SECONDS;
+
+	if (_healthTemplate.properties == NULL) {
+		if (!lp_compileMessagePropertyTemplate(&_healthTemplate, _healthProperties, sizeof(_healthProperties) / sizeof(_healthProperties[0]))) {
+			return false;
+		}
+		lp_setMessagePriority(&_healthTemplate, LP_PRIORITY_BULK);		// offline, dropped ahead of telemetry
+	}
+
+	return lp_startTimer(&healthTelemetryTimer);
+}
+
+void lp_stopHealthTelemetry(void) {
+	if (healthTelemetryTimer.eventLoopTimer != NULL) {
+		lp_stopTimer(&healthTelemetryTimer);
+	}
+	lp_freeMessagePropertyTemplate(&_healthTemplate);
+}
+
+int lp_formatHealthRecord(char* buffer, size_t bufferSize) {
+	LP_TELEMETRY_STATS telemetry;
+	LP_CONNECTION_STATS connection;
+	LP_DEVICE_TWIN_STATS twins;
+	LP_INTER_CORE_STATS interCore;
+	LP_HEAP_STATS heap;
+	LP_EVENT_LOOP_STATS loop;
+
+	lp_getTelemetryStats(&telemetry);
+	lp_getConnectionStats(&connection);
+	lp_getDeviceTwinStats(&twins);
+	lp_getInterCoreStats(&interCore);
+	lp_getHeapStats(&heap);
+	lp_getEventLoopStats(&loop);
+
+	int len = snprintf(buffer, bufferSize,
+		"{\"Health\":{\"lagUs\":%u,\"loopLagMaxUs\":%u,\"overBudget\":%u,\"doWorkMs\":%u,\"doWorkMaxMs\":%u,\"sent\":%u,\"acked\":%u,\"failed\":%u,\"twinCoalesced\":%u,"
+		"\"twinDocs\":%u,\"icIn\":%u,\"icOut\":%u,\"icDropped\":%u,\"heapPeak\":%u,\"memPeakKB\":%u,\"reconnects\":%u,\"outageMs\":%u,\"keepAliveS\":%u}}",
+		_lagUs, loop.lagMaxUs, loop.overBudget, connection.doWorkIntervalAvgMs, connection.doWorkIntervalMaxMs, telemetry.sent, telemetry.confirmed,
+		telemetry.failed + telemetry.timeouts, twins.coalesced, twins.documents, interCore.messagesIn, interCore.messagesOut,
+		interCore.messagesDropped + interCore.timeouts, heap.total.peakBytes, heap.peakUserModeKB, connection.reconnects,
+		connection.totalOutageMs, connection.keepAliveSeconds);
+
+	return len < 0 || (size_t)len >= bufferSize ? -1 : len;
+}
+
+static void HealthTelemetryHandler(EventLoopTimer* eventLoopTimer) {
+	char record[LP_HEALTH_RECORD_SIZE];
+	struct timespec scheduled, now;
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_HealthTelemetryHandler);
+		return;
+	}
+
+	GetEventLoopTimerScheduledTime(eventLoopTimer, &scheduled);
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	int64_t lateUs = ((int64_t)now.tv_sec - scheduled.tv_sec) * 1000000 + (now.tv_nsec - scheduled.tv_nsec) / 1000;
+	_lagUs = lateUs > 0 ? (uint32_t)lateUs : 0;
+
+	if (lp_formatHealthRecord(record, sizeof(record)) > 0) {
+		lp_sendMsgWithProperties(record, &_healthTemplate, NULL, 0);
+	}
+}
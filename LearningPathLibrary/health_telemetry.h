@@ -0,0 +1,23 @@
+#pragma once
+
+#include "azure_iot.h"
+#include "event_loop.h"
+#include "inter_core.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+#define LP_HEALTH_DEFAULT_PERIOD_SECONDS 300
+#define LP_HEALTH_RECORD_SIZE 512
+
+// A compact record of the library's own counters, sent as a bulk priority message with the property
+// type=health so it can be routed apart from telemetry. Counters are totals since start, the cloud takes
+// the differences, so a record dropped by the offline queue loses no counts. One LP_TIMER drives it. lagUs is how
+// late that timer fired, loopLagMaxUs and overBudget come from lp_runEventLoop and stay zero without it.
+//
+// {"Health":{"lagUs":..,"loopLagMaxUs":..,"overBudget":..,"doWorkMs":..,"doWorkMaxMs":..,"sent":..,"acked":..,"failed":..,
+//   "twinCoalesced":..,"twinDocs":..,"icIn":..,"icOut":..,"icDropped":..,"heapPeak":..,"memPeakKB":..,"reconnects":..,"outageMs":..,"keepAliveS":..}}
+bool lp_startHealthTelemetry(int periodSeconds);
+void lp_stopHealthTelemetry(void);
+// the record the next period would send, returns its length or -1 if it did not fit
+int lp_formatHealthRecord(char* buffer, size_t bufferSize);
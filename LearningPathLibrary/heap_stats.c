@@ -0,0 +1,214 @@
+#include "heap_stats.h"
+#include "json_arena.h"
+#include <applibs/application.h>
+#include <applibs/log.h>
+#include <malloc.h>
+#include <signal.h>
+#include <stdlib.h>
+
+static LP_HEAP_USAGE _usage[LP_HEAP_SUBSYSTEMS];
+static LP_HEAP_USAGE _total;
+static bool _accounting = false;
+static LP_HEAP_STEADY_MODE _steadyMode = LP_HEAP_STEADY_OFF;
+static uint32_t _steadyAllocations = 0;
+static LP_HEAP_SUBSYSTEM _steadySubsystem;
+static const void* _steadyCaller = NULL;
+
+static const char* _subsystemNames[LP_HEAP_SUBSYSTEMS] = {
+	[LP_HEAP_TWINS] = "twins",
+	[LP_HEAP_METHODS] = "methods",
+	[LP_HEAP_TELEMETRY] = "telemetry",
+	[LP_HEAP_OFFLINE_QUEUE] = "offline_queue",
+	[LP_HEAP_JSON] = "json",
+	[LP_HEAP_BLOB] = "blob",
+	[LP_HEAP_HISTORY] = "history",
+	[LP_HEAP_JOURNAL] = "journal",
+	[LP_HEAP_TRACE] = "trace",
+	[LP_HEAP_C2D] = "c2d"
+};
+
+static void CountAllocation(LP_HEAP_USAGE* usage, size_t bytes) {
+	usage->bytes += (uint32_t)bytes;
+	usage->objects++;
+	usage->allocations++;
+
+	if (usage->bytes > usage->peakBytes) {
+		usage->peakBytes = usage->bytes;
+	}
+	if (usage->objects > usage->peakObjects) {
+		usage->peakObjects = usage->objects;
+	}
+}
+
+// blocks allocated before accounting started were never counted, they must not take the counts below zero
+static void CountFree(LP_HEAP_USAGE* usage, size_t bytes) {
+	usage->bytes = usage->bytes > bytes ? usage->bytes - (uint32_t)bytes : 0;
+	usage->objects = usage->objects > 0 ? usage->objects - 1 : 0;
+}
+
+static void Allocated(LP_HEAP_SUBSYSTEM subsystem, void* ptr) {
+	if (ptr == NULL) {
+		_usage[subsystem].failures++;
+		_total.failures++;
+		return;
+	}
+
+	size_t bytes = malloc_usable_size(ptr);
+	CountAllocation(&_usage[subsystem], bytes);
+	CountAllocation(&_total, bytes);
+}
+
+static void Freed(LP_HEAP_SUBSYSTEM subsystem, void* ptr) {
+	size_t bytes = malloc_usable_size(ptr);
+	CountFree(&_usage[subsystem], bytes);
+	CountFree(&_total, bytes);
+}
+
+static void SteadyAllocation(LP_HEAP_SUBSYSTEM subsystem, const void* caller) {
+	_steadyAllocations++;
+	_steadySubsystem = subsystem;
+	_steadyCaller = caller;
+
+	if (_steadyMode == LP_HEAP_STEADY_TRAP) {
+		Log_Debug("ERROR: %s heap allocation in steady state, called from %p\n", lp_heapSubsystemName(subsystem), caller);
+		raise(SIGTRAP);
+	}
+}
+
+void* lp_heapMalloc(LP_HEAP_SUBSYSTEM subsystem, size_t size) {
+	if (_steadyMode != LP_HEAP_STEADY_OFF) {
+		SteadyAllocation(subsystem, __builtin_return_address(0));
+	}
+
+	void* ptr = malloc(size);
+
+	if (_accounting && subsystem < LP_HEAP_SUBSYSTEMS) {
+		Allocated(subsystem, ptr);
+	}
+	return ptr;
+}
+
+void* lp_heapCalloc(LP_HEAP_SUBSYSTEM subsystem, size_t count, size_t size) {
+	if (_steadyMode != LP_HEAP_STEADY_OFF) {
+		SteadyAllocation(subsystem, __builtin_return_address(0));
+	}
+
+	void* ptr = calloc(count, size);
+
+	if (_accounting && subsystem < LP_HEAP_SUBSYSTEMS) {
+		Allocated(subsystem, ptr);
+	}
+	return ptr;
+}
+
+/// <summary>
+///     Counted as a free of the old block and an allocation of the new one, a failed realloc leaves the old block counted
+/// </summary>
+void* lp_heapRealloc(LP_HEAP_SUBSYSTEM subsystem, void* ptr, size_t size) {
+	// a block shrunk or grown within its usable size stays where it is
+	if (_steadyMode != LP_HEAP_STEADY_OFF && (ptr == NULL || size > malloc_usable_size(ptr))) {
+		SteadyAllocation(subsystem, __builtin_return_address(0));
+	}
+
+	if (!_accounting || subsystem >= LP_HEAP_SUBSYSTEMS) {
+		return realloc(ptr, size);
+	}
+
+	size_t oldBytes = ptr != NULL ? malloc_usable_size(ptr) : 0;
+	void* grown = realloc(ptr, size);
+
+	if (grown == NULL) {
+		_usage[subsystem].failures++;
+		_total.failures++;
+		return NULL;
+	}
+
+	if (ptr != NULL) {
+		CountFree(&_usage[subsystem], oldBytes);
+		CountFree(&_total, oldBytes);
+	}
+	Allocated(subsystem, grown);
+
+	return grown;
+}
+
+void lp_heapFree(LP_HEAP_SUBSYSTEM subsystem, void* ptr) {
+	if (ptr == NULL) {
+		return;
+	}
+
+	if (_accounting && subsystem < LP_HEAP_SUBSYSTEMS) {
+		Freed(subsystem, ptr);
+	}
+	free(ptr);
+}
+
+/// <summary>
+///     Start or stop counting, starting clears the counts. Installs the arena's parson allocation functions so
+///     DOMs built outside a scope are counted too, call before the first twin or method callback
+/// </summary>
+void lp_enableHeapAccounting(bool enabled) {
+	if (enabled && !_accounting) {
+		for (int i = 0; i < LP_HEAP_SUBSYSTEMS; i++) {
+			_usage[i] = (LP_HEAP_USAGE){ 0 };
+		}
+		_total = (LP_HEAP_USAGE){ 0 };
+		lp_jsonArenaInstall();
+	}
+
+	_accounting = enabled;
+}
+
+/// <summary>
+///     Mark the end of initialisation, allocations from here on are counted or trapped as mode says and the count
+///     starts from zero. LP_HEAP_STEADY_OFF stops checking, the count is kept for lp_getHeapStats.
+/// </summary>
+void lp_heapSteadyState(LP_HEAP_STEADY_MODE mode) {
+	if (mode != LP_HEAP_STEADY_OFF) {
+		_steadyAllocations = 0;
+		_steadyCaller = NULL;
+		lp_jsonArenaInstall();
+	}
+
+	_steadyMode = mode;
+}
+
+void lp_getHeapStats(LP_HEAP_STATS* stats) {
+	if (stats == NULL) {
+		return;
+	}
+
+	for (int i = 0; i < LP_HEAP_SUBSYSTEMS; i++) {
+		stats->subsystems[i] = _usage[i];
+	}
+	stats->total = _total;
+	stats->userModeKB = (uint32_t)Applications_GetUserModeMemoryUsageInKB();
+	stats->peakUserModeKB = (uint32_t)Applications_GetPeakUserModeMemoryUsageInKB();
+	stats->steadyAllocations = _steadyAllocations;
+	stats->steadySubsystem = _steadySubsystem;
+	stats->steadyCaller = _steadyCaller;
+}
+
+const char* lp_heapSubsystemName(LP_HEAP_SUBSYSTEM subsystem) {
+	return subsystem < LP_HEAP_SUBSYSTEMS ? _subsystemNames[subsystem] : "unknown";
+}
+
+void lp_logHeapStats(void) {
+	LP_HEAP_STATS stats;
+
+	lp_getHeapStats(&stats);
+
+	Log_Debug("Heap: user mode %u KB, peak %u KB\n", stats.userModeKB, stats.peakUserModeKB);
+	Log_Debug("  %-14s %8s %8s %7s %7s %8s\n", "subsystem", "bytes", "peak", "objects", "peak", "failures");
+	for (int i = 0; i < LP_HEAP_SUBSYSTEMS; i++) {
+		LP_HEAP_USAGE* usage = &stats.subsystems[i];
+		Log_Debug("  %-14s %8u %8u %7u %7u %8u\n", lp_heapSubsystemName((LP_HEAP_SUBSYSTEM)i), usage->bytes, usage->peakBytes,
+			usage->objects, usage->peakObjects, usage->failures);
+	}
+	Log_Debug("  %-14s %8u %8u %7u %7u %8u\n", "total", stats.total.bytes, stats.total.peakBytes, stats.total.objects,
+		stats.total.peakObjects, stats.total.failures);
+	if (stats.steadyAllocations > 0) {
+		Log_Debug("  %u steady state allocations, the last %s from %p\n", stats.steadyAllocations,
+			lp_heapSubsystemName(stats.steadySubsystem), stats.steadyCaller);
+	}
+}
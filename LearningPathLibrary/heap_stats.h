@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Allocation accounting for the library's own heap use. Every library malloc and free goes through
+// lp_heapMalloc and lp_heapFree naming the subsystem it belongs to, parson through the json_arena.h
+// allocation functions. Counting is off until lp_enableHeapAccounting, sizes are malloc_usable_size so
+// no header is added to any allocation and blocks allocated before accounting started can be freed after,
+// they are not counted and do not take the counts below zero.
+typedef enum {
+	LP_HEAP_TWINS,				// twin indexes, desired captures, report scratch and reported strings
+	LP_HEAP_METHODS,			// direct method index, responses handed to the SDK are not counted once handed over
+	LP_HEAP_TELEMETRY,			// message property templates, the telemetry batch, compression buffers
+	LP_HEAP_OFFLINE_QUEUE,		// queued messages and the message slots
+	LP_HEAP_JSON,				// parson DOMs and serialised strings outside, or overflowing, an arena scope
+	LP_HEAP_BLOB,				// the block buffer of a blob upload read from a file
+	LP_HEAP_HISTORY,			// the history ring's block index and read buffer
+	LP_HEAP_JOURNAL,			// storage journal batches and the records read back
+	LP_HEAP_TRACE,				// the event trace ring and its dump until sent or uploaded
+	LP_HEAP_C2D,				// cloud to device message bodies being reassembled from their parts
+	LP_HEAP_SUBSYSTEMS
+} LP_HEAP_SUBSYSTEM;
+
+// After lp_heapSteadyState marks initialisation done the hot paths should allocate nothing, every library
+// allocation from then on is a steady state allocation, counted or trapped with the subsystem and the
+// address it was called from. Parson's allocations outside an arena scope are JSON ones called from the arena.
+typedef enum {
+	LP_HEAP_STEADY_OFF,
+	LP_HEAP_STEADY_COUNT,		// counted in LP_HEAP_STATS, the last one's subsystem and caller kept
+	LP_HEAP_STEADY_TRAP			// the first is logged and raises SIGTRAP, a debugger stops with the backtrace
+} LP_HEAP_STEADY_MODE;
+
+typedef struct LP_HEAP_USAGE
+{
+	uint32_t bytes;				// live now
+	uint32_t peakBytes;
+	uint32_t objects;
+	uint32_t peakObjects;
+	uint32_t allocations;		// since accounting started
+	uint32_t failures;
+} LP_HEAP_USAGE;
+
+typedef struct LP_HEAP_STATS
+{
+	LP_HEAP_USAGE subsystems[LP_HEAP_SUBSYSTEMS];
+	LP_HEAP_USAGE total;		// peaks of the sum, not the sum of the peaks
+	uint32_t userModeKB;		// Applications_GetUserModeMemoryUsageInKB, the whole app and not just the library
+	uint32_t peakUserModeKB;	// Applications_GetPeakUserModeMemoryUsageInKB, checked against the app's memory limit
+	uint32_t steadyAllocations;	// since lp_heapSteadyState, a realloc within the block's usable size is not one
+	LP_HEAP_SUBSYSTEM steadySubsystem;	// of the last
+	const void* steadyCaller;	// return address of the last, resolve with addr2line against the unstripped image
+} LP_HEAP_STATS;
+
+void* lp_heapMalloc(LP_HEAP_SUBSYSTEM subsystem, size_t size);
+void* lp_heapCalloc(LP_HEAP_SUBSYSTEM subsystem, size_t count, size_t size);
+void* lp_heapRealloc(LP_HEAP_SUBSYSTEM subsystem, void* ptr, size_t size);
+void lp_heapFree(LP_HEAP_SUBSYSTEM subsystem, void* ptr);
+
+void lp_enableHeapAccounting(bool enabled);
+void lp_heapSteadyState(LP_HEAP_STEADY_MODE mode);
+void lp_getHeapStats(LP_HEAP_STATS* stats);
+void lp_logHeapStats(void);
+const char* lp_heapSubsystemName(LP_HEAP_SUBSYSTEM subsystem);
@@ -0,0 +1,393 @@
+#include "history_log.h"
+#include <applibs/storage.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LP_HISTORY_MAGIC 0x4C504853				// "LPHS"
+#define LP_HISTORY_DEFAULT_QUERY_SECONDS 3600
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint8_t channelCount;
+	uint8_t blockRecords;
+	uint32_t namesHash;			// of the channel names, a history of other channels is not read as this one
+	uint32_t blockCount;
+} HISTORY_HEADER;
+
+// written as its first 8 + 4 * channelCount bytes
+typedef struct {
+	uint32_t sequence;			// of the block it was written in, a record left from the previous pass differs
+	uint32_t timestamp;
+	float values[LP_HISTORY_MAX_CHANNELS];
+} HISTORY_RECORD;
+
+typedef struct {
+	float min;
+	float max;
+	double sum;
+} HISTORY_AGGREGATE;
+
+typedef struct {
+	uint32_t sequence;			// 0 for a block not written yet
+	uint32_t count;
+	uint32_t from;				// earliest and latest timestamp, a clock set back mid block does not hide records
+	uint32_t to;
+	HISTORY_AGGREGATE channels[LP_HISTORY_MAX_CHANNELS];
+} HISTORY_BLOCK;
+
+static int _historyFd = -1;
+static const char** _channelNames = NULL;
+static size_t _historyChannelCount = 0;
+static size_t _recordSize = 0;
+static uint32_t _blockCount = 0;
+static uint32_t _head = 0;					// block appended to
+static size_t _recordCount = 0;
+static HISTORY_BLOCK* _blocks = NULL;		// the time index, one entry per block in storage
+static uint8_t* _blockBuffer = NULL;		// one block read back for a query or the index rebuild
+
+static uint32_t HashNames(const char** names, size_t count) {
+	uint32_t hash = 2166136261u;		// FNV-1a, names separated by their terminators
+
+	for (size_t i = 0; i < count; i++) {
+		for (const char* c = names[i];; c++) {
+			hash = (hash ^ (uint8_t)*c) * 16777619u;
+			if (*c == 0) {
+				break;
+			}
+		}
+	}
+	return hash;
+}
+
+static off_t BlockOffset(uint32_t block) {
+	return LP_STORAGE_HISTORY_OFFSET + (off_t)sizeof(HISTORY_HEADER) + (off_t)block * LP_HISTORY_BLOCK_RECORDS * (off_t)_recordSize;
+}
+
+static void ResetAggregates(HISTORY_BLOCK* block, uint32_t sequence) {
+	*block = (HISTORY_BLOCK){ .sequence = sequence };
+}
+
+static void Accumulate(HISTORY_BLOCK* block, const HISTORY_RECORD* record) {
+	if (block->count == 0 || record->timestamp < block->from) {
+		block->from = record->timestamp;
+	}
+	if (block->count == 0 || record->timestamp > block->to) {
+		block->to = record->timestamp;
+	}
+
+	for (size_t c = 0; c < _historyChannelCount; c++) {
+		HISTORY_AGGREGATE* aggregate = &block->channels[c];
+		float value = record->values[c];
+
+		if (block->count == 0 || value < aggregate->min) {
+			aggregate->min = value;
+		}
+		if (block->count == 0 || value > aggregate->max) {
+			aggregate->max = value;
+		}
+		aggregate->sum += value;
+	}
+	block->count++;
+}
+
+static bool ReadBlock(uint32_t block) {
+	size_t length = LP_HISTORY_BLOCK_RECORDS * _recordSize;
+	return pread(_historyFd, _blockBuffer, length, BlockOffset(block)) == (ssize_t)length;
+}
+
+static const HISTORY_RECORD* BufferedRecord(size_t index, HISTORY_RECORD* record) {
+	memcpy(record, _blockBuffer + index * _recordSize, _recordSize);
+	return record;
+}
+
+/// <summary>
+///     Rebuild a block's index entry from storage, its records run while they carry the first one's sequence
+/// </summary>
+static void IndexBlock(uint32_t block) {
+	HISTORY_RECORD record;
+
+	ResetAggregates(&_blocks[block], 0);
+
+	if (!ReadBlock(block)) {
+		return;		// past the end of a file not filled yet
+	}
+
+	for (size_t i = 0; i < LP_HISTORY_BLOCK_RECORDS; i++) {
+		BufferedRecord(i, &record);
+		if (record.sequence == 0 || (i > 0 && record.sequence != _blocks[block].sequence)) {
+			break;
+		}
+		_blocks[block].sequence = record.sequence;
+		Accumulate(&_blocks[block], &record);
+	}
+}
+
+/// <summary>
+///     A history of another layout or other channels is zeroed, so none of its records read as this one's
+/// </summary>
+static bool ResetStorage(const HISTORY_HEADER* header) {
+	memset(_blockBuffer, 0, LP_HISTORY_BLOCK_RECORDS * _recordSize);
+
+	for (uint32_t block = 0; block < _blockCount; block++) {
+		if (pwrite(_historyFd, _blockBuffer, LP_HISTORY_BLOCK_RECORDS * _recordSize, BlockOffset(block)) != (ssize_t)(LP_HISTORY_BLOCK_RECORDS * _recordSize)) {
+			return false;
+		}
+	}
+
+	return pwrite(_historyFd, header, sizeof(HISTORY_HEADER), LP_STORAGE_HISTORY_OFFSET) == (ssize_t)sizeof(HISTORY_HEADER);
+}
+
+/// <summary>
+///     Open the history of channelCount channels, the names must stay valid while it is open. Records already in
+///     storage for the same channels are indexed and kept
+/// </summary>
+bool lp_openHistory(const char** channelNames, size_t channelCount) {
+	HISTORY_HEADER header, stored;
+
+	if (_historyFd != -1) {
+		return true;
+	}
+
+	if (channelNames == NULL || channelCount == 0 || channelCount > LP_HISTORY_MAX_CHANNELS) {
+		return false;
+	}
+
+	_recordSize = sizeof(uint32_t) * 2 + sizeof(float) * channelCount;
+	_blockCount = (uint32_t)((LP_STORAGE_HISTORY_SIZE - sizeof(HISTORY_HEADER)) / (LP_HISTORY_BLOCK_RECORDS * _recordSize));
+
+	// a single block would lose the whole history each time it is reused
+	if (LP_STORAGE_HISTORY_SIZE <= sizeof(HISTORY_HEADER) || _blockCount < 2) {
+		LP_LOG(LP_LOG_WARNING, "WARNING: History needs LP_HISTORY_KB of at least %u\n",
+			(unsigned)((sizeof(HISTORY_HEADER) + 2 * LP_HISTORY_BLOCK_RECORDS * _recordSize + 1023) / 1024));
+		return false;
+	}
+
+	_blocks = (HISTORY_BLOCK*)lp_heapCalloc(LP_HEAP_HISTORY, _blockCount, sizeof(HISTORY_BLOCK));
+	_blockBuffer = (uint8_t*)lp_heapMalloc(LP_HEAP_HISTORY, LP_HISTORY_BLOCK_RECORDS * _recordSize);
+	if (_blocks == NULL || _blockBuffer == NULL) {
+		lp_closeHistory();
+		return false;
+	}
+
+	_historyFd = Storage_OpenMutableFile();
+	if (_historyFd == -1) {
+		LP_LOG(LP_LOG_WARNING, "WARNING: History unable to open mutable storage: %s (%d)\n", strerror(errno), errno);
+		lp_closeHistory();
+		return false;
+	}
+
+	_channelNames = channelNames;
+	_historyChannelCount = channelCount;
+
+	header = (HISTORY_HEADER){
+		.magic = LP_HISTORY_MAGIC,
+		.version = LP_HISTORY_VERSION,
+		.channelCount = (uint8_t)channelCount,
+		.blockRecords = LP_HISTORY_BLOCK_RECORDS,
+		.namesHash = HashNames(channelNames, channelCount),
+		.blockCount = _blockCount };
+
+	if (pread(_historyFd, &stored, sizeof(stored), LP_STORAGE_HISTORY_OFFSET) != (ssize_t)sizeof(stored) || memcmp(&stored, &header, sizeof(header)) != 0) {
+		if (!ResetStorage(&header)) {
+			LP_LOG(LP_LOG_WARNING, "WARNING: History unable to initialise mutable storage: %s (%d)\n", strerror(errno), errno);
+			lp_closeHistory();
+			return false;
+		}
+	}
+
+	_head = 0;
+	_recordCount = 0;
+
+	for (uint32_t block = 0; block < _blockCount; block++) {
+		IndexBlock(block);
+		_recordCount += _blocks[block].count;
+
+		// sequences count up block by block, the newest block is the one appended to
+		if (_blocks[block].sequence != 0 && (_blocks[_head].sequence == 0 || (int32_t)(_blocks[block].sequence - _blocks[_head].sequence) > 0)) {
+			_head = block;
+		}
+	}
+
+	return true;
+}
+
+void lp_closeHistory(void) {
+	if (_historyFd != -1) {
+		close(_historyFd);
+		_historyFd = -1;
+	}
+
+	lp_heapFree(LP_HEAP_HISTORY, _blocks);
+	lp_heapFree(LP_HEAP_HISTORY, _blockBuffer);
+	_blocks = NULL;
+	_blockBuffer = NULL;
+	_channelNames = NULL;
+	_historyChannelCount = 0;
+	_recordCount = 0;
+}
+
+/// <summary>
+///     Append one record, once the region is full the oldest block is dropped from the index and overwritten
+/// </summary>
+bool lp_historyAppend(const float* values) {
+	HISTORY_RECORD record;
+	HISTORY_BLOCK* block;
+	struct timespec now;
+
+	if (_historyFd == -1 || values == NULL) {
+		return false;
+	}
+
+	block = &_blocks[_head];
+
+	if (block->sequence == 0) {
+		ResetAggregates(block, 1);
+	}
+	else if (block->count == LP_HISTORY_BLOCK_RECORDS) {
+		uint32_t sequence = block->sequence + 1 == 0 ? 1 : block->sequence + 1;
+
+		_head = (_head + 1) % _blockCount;
+		block = &_blocks[_head];
+		_recordCount -= block->count;
+		ResetAggregates(block, sequence);
+	}
+
+	clock_gettime(CLOCK_REALTIME, &now);
+
+	record.sequence = block->sequence;
+	record.timestamp = (uint32_t)now.tv_sec;
+	memcpy(record.values, values, sizeof(float) * _historyChannelCount);
+
+	if (pwrite(_historyFd, &record, _recordSize, BlockOffset(_head) + (off_t)block->count * (off_t)_recordSize) != (ssize_t)_recordSize) {
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: History write failed: %s (%d)\n", strerror(errno), errno);
+		return false;
+	}
+
+	Accumulate(block, &record);
+	_recordCount++;
+
+	return true;
+}
+
+static int FindChannel(const char* channel) {
+	for (size_t c = 0; channel != NULL && c < _historyChannelCount; c++) {
+		if (strcmp(_channelNames[c], channel) == 0) {
+			return (int)c;
+		}
+	}
+	return -1;
+}
+
+static void Merge(LP_HISTORY_SUMMARY* summary, double* sum, uint32_t count, float min, float max, double blockSum, uint32_t from, uint32_t to) {
+	if (summary->count == 0 || min < summary->min) {
+		summary->min = min;
+	}
+	if (summary->count == 0 || max > summary->max) {
+		summary->max = max;
+	}
+	if (summary->count == 0 || from < summary->first) {
+		summary->first = from;
+	}
+	if (summary->count == 0 || to > summary->last) {
+		summary->last = to;
+	}
+	summary->count += count;
+	*sum += blockSum;
+}
+
+/// <summary>
+///     Blocks wholly inside the range are summarised from the index, only the blocks the range starts or ends in
+///     are read back from storage
+/// </summary>
+bool lp_historyQuery(const char* channel, time_t from, time_t to, LP_HISTORY_SUMMARY* summary) {
+	int c = FindChannel(channel);
+	double sum = 0;
+	HISTORY_RECORD record;
+
+	if (_historyFd == -1 || c < 0 || summary == NULL) {
+		return false;
+	}
+
+	*summary = (LP_HISTORY_SUMMARY){ 0 };
+
+	for (uint32_t b = 0; b < _blockCount; b++) {
+		const HISTORY_BLOCK* block = &_blocks[b];
+
+		if (block->count == 0 || (time_t)block->to < from || (time_t)block->from > to) {
+			continue;
+		}
+
+		if ((time_t)block->from >= from && (time_t)block->to <= to) {
+			Merge(summary, &sum, block->count, block->channels[c].min, block->channels[c].max, block->channels[c].sum, block->from, block->to);
+			continue;
+		}
+
+		if (!ReadBlock(b)) {
+			return false;
+		}
+		summary->blocksRead++;
+
+		for (size_t i = 0; i < block->count; i++) {
+			BufferedRecord(i, &record);
+			if ((time_t)record.timestamp >= from && (time_t)record.timestamp <= to) {
+				Merge(summary, &sum, 1, record.values[c], record.values[c], record.values[c], record.timestamp, record.timestamp);
+			}
+		}
+	}
+
+	summary->mean = summary->count > 0 ? (float)(sum / summary->count) : 0;
+	return true;
+}
+
+size_t lp_historyCount(void) {
+	return _recordCount;
+}
+
+/// <summary>
+///     History direct method, a summary of the range for the channel asked for or for every channel
+/// </summary>
+static LP_DIRECT_METHOD_RESPONSE_CODE HistoryHandler(JSON_Object* json, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg) {
+	char response[LP_METHOD_RESPONSE_SIZE];
+	LP_HISTORY_SUMMARY summary;
+	const char* channel = json_object_get_string(json, "channel");
+	time_t now = time(NULL);
+	double seconds = json_object_has_value_of_type(json, "seconds", JSONNumber) ? json_object_get_number(json, "seconds") : LP_HISTORY_DEFAULT_QUERY_SECONDS;
+	time_t from = json_object_has_value_of_type(json, "from", JSONNumber) ? (time_t)json_object_get_number(json, "from") : now - (time_t)seconds;
+	time_t to = json_object_has_value_of_type(json, "to", JSONNumber) ? (time_t)json_object_get_number(json, "to") : now;
+	size_t len = 0;
+
+	if (_historyFd == -1) {
+		lp_setMethodResponse("History is not open");
+		return LP_METHOD_FAILED;
+	}
+
+	if (channel != NULL && FindChannel(channel) < 0) {
+		lp_setMethodResponse("Unknown channel %s", channel);
+		return LP_METHOD_FAILED;
+	}
+
+	response[0] = 0;
+
+	for (size_t c = 0; c < _historyChannelCount && len < sizeof(response); c++) {
+		if (channel != NULL && strcmp(channel, _channelNames[c]) != 0) {
+			continue;
+		}
+		if (!lp_historyQuery(_channelNames[c], from, to, &summary)) {
+			lp_setMethodResponse("History read failed");
+			return LP_METHOD_FAILED;
+		}
+
+		int written = summary.count == 0
+			? snprintf(response + len, sizeof(response) - len, "%s%s no samples", len > 0 ? "; " : "", _channelNames[c])
+			: snprintf(response + len, sizeof(response) - len, "%s%s %u samples min %.2f max %.2f mean %.2f", len > 0 ? "; " : "",
+				_channelNames[c], summary.count, summary.min, summary.max, summary.mean);
+		len = written < 0 ? sizeof(response) : len + (size_t)written;
+	}
+
+	lp_setMethodResponse("%s", response);
+	return LP_METHOD_SUCCEEDED;
+}
+
+LP_DIRECT_METHOD_BINDING lp_historyDirectMethod = { .methodName = "History", .handler = HistoryHandler };
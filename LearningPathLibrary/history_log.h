@@ -0,0 +1,47 @@
+#pragma once
+
+#include "direct_methods.h"
+#include "heap_stats.h"
+#include "logging.h"
+#include "mutable_storage.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define LP_HISTORY_MAX_CHANNELS 4
+#define LP_HISTORY_BLOCK_RECORDS 64			// records per block, the unit the time index summarises
+#define LP_HISTORY_VERSION 1
+
+typedef struct LP_HISTORY_SUMMARY
+{
+	uint32_t count;						// samples in the range, the rest is zero without any
+	float min;
+	float max;
+	float mean;
+	time_t first;						// of the first and last sample in the range
+	time_t last;
+	uint32_t blocksRead;				// blocks read from storage to answer, the others came from the index
+} LP_HISTORY_SUMMARY;
+
+// A ring of sampled readings in the application's mutable storage, kept on device so "what was the min and max
+// over the last hour" is answered locally rather than from the cloud. Each lp_historyAppend writes one fixed
+// size record, a wall clock timestamp and up to LP_HISTORY_MAX_CHANNELS floats. Records fill blocks of
+// LP_HISTORY_BLOCK_RECORDS and the oldest block is reused once the region is full. A RAM index keeps the time
+// span, min, max and sum of every block, rebuilt from storage when the history is opened, so a range query
+// reads only the blocks its ends fall in.
+//
+// The region is LP_STORAGE_HISTORY_SIZE bytes, reserved with the LP_HISTORY_KB CMake option, see
+// mutable_storage.h. A history written with other channels or another record layout is discarded on open.
+bool lp_openHistory(const char** channelNames, size_t channelCount);
+void lp_closeHistory(void);
+// values has one reading per channel, timestamped with CLOCK_REALTIME
+bool lp_historyAppend(const float* values);
+// samples of channel with from <= timestamp <= to, false for an unknown channel or a closed history
+bool lp_historyQuery(const char* channel, time_t from, time_t to, LP_HISTORY_SUMMARY* summary);
+size_t lp_historyCount(void);
+
+// optional, add to the direct method set. Payload {"channel":"Temperature","seconds":3600} or with "from" and
+// "to" in epoch seconds for a fixed range, no "channel" summarises every channel; seconds defaults to an hour.
+// Answers "Temperature 360 samples min 19.80 max 24.10 mean 21.73 ..." for each channel.
+extern LP_DIRECT_METHOD_BINDING lp_historyDirectMethod;
@@ -0,0 +1,99 @@
+#include "alloc_stats.h"
+#include <execinfo.h>
+#include <malloc.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+// glibc's own entry points, the benchmarks are linked without the sanitizers
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+#define ALLOC_TRAP_FRAMES 32
+
+static ALLOC_STATS _stats;
+static bool _trap = false;
+
+static void Allocated(void* ptr) {
+	if (_trap) {
+		void* frames[ALLOC_TRAP_FRAMES];
+
+		_trap = false;		// backtrace_symbols_fd does not allocate, but whatever the debugger does might
+		backtrace_symbols_fd(frames, backtrace(frames, ALLOC_TRAP_FRAMES), STDERR_FILENO);
+		raise(SIGTRAP);
+	}
+
+	if (ptr != NULL) {
+		size_t size = malloc_usable_size(ptr);
+
+		_stats.allocations++;
+		_stats.bytesAllocated += size;
+		_stats.liveBytes += size;
+		if (_stats.liveBytes > _stats.peakBytes) {
+			_stats.peakBytes = _stats.liveBytes;
+		}
+	}
+}
+
+static void Released(void* ptr) {
+	if (ptr != NULL) {
+		size_t size = malloc_usable_size(ptr);
+
+		_stats.frees++;
+		_stats.liveBytes = size > _stats.liveBytes ? 0 : _stats.liveBytes - size;
+	}
+}
+
+void* malloc(size_t size) {
+	void* ptr = __libc_malloc(size);
+	Allocated(ptr);
+	return ptr;
+}
+
+void* calloc(size_t count, size_t size) {
+	void* ptr = __libc_calloc(count, size);
+	Allocated(ptr);
+	return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+	size_t oldSize = ptr != NULL ? malloc_usable_size(ptr) : 0;
+	void* grown = __libc_realloc(ptr, size);
+
+	// a failed realloc leaves the block where it was
+	if (grown != NULL || size == 0) {
+		_stats.liveBytes = oldSize > _stats.liveBytes ? 0 : _stats.liveBytes - oldSize;
+		if (ptr != NULL) {
+			_stats.frees++;
+		}
+		Allocated(grown);
+	}
+	return grown;
+}
+
+void free(void* ptr) {
+	Released(ptr);
+	__libc_free(ptr);
+}
+
+void alloc_statsReset(void) {
+	size_t live = _stats.liveBytes;
+
+	memset(&_stats, 0, sizeof(_stats));
+	_stats.liveBytes = live;
+	_stats.peakBytes = live;
+}
+
+void alloc_statsGet(ALLOC_STATS* stats) {
+	*stats = _stats;
+}
+
+void alloc_statsTrap(bool trap) {
+	void* frames[1];
+
+	// the first backtrace loads libgcc's unwinder, which allocates
+	backtrace(frames, 1);
+	_trap = trap;
+}
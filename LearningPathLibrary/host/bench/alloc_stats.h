@@ -0,0 +1,22 @@
+#pragma once
+
+// Heap accounting for the host benchmarks, malloc, calloc, realloc and free are interposed
+// on the C library so every allocation of the library under test is counted.
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct ALLOC_STATS
+{
+	uint64_t allocations;		// malloc, calloc and realloc calls that returned memory
+	uint64_t frees;
+	uint64_t bytesAllocated;	// usable bytes of those allocations
+	size_t liveBytes;
+	size_t peakBytes;			// most live bytes since the last alloc_statsReset
+} ALLOC_STATS;
+
+// restarts the counters, the peak restarts from the bytes live now
+void alloc_statsReset(void);
+void alloc_statsGet(ALLOC_STATS* stats);
+// every allocation from now on prints its backtrace to stderr and raises SIGTRAP, for the steady state soak
+void alloc_statsTrap(bool trap);
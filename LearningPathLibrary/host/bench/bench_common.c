@@ -0,0 +1,81 @@
+#include "bench_common.h"
+#include "azure_iot.h"
+#include "sim.h"
+#include "timer.h"
+#include <time.h>
+
+#if LP_ENABLE_INTERCORE
+static char _componentId[] = "00000000-0000-0000-0000-000000000000";
+static LP_INTER_CORE_CONNECTION* _connection;
+static uint8_t _frames[2][LP_IC_MAX_FRAME_SIZE];
+static size_t _frameLengths[2];
+#endif
+
+uint64_t bench_nowNs(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+bool bench_connectSimulatedHub(unsigned int timeoutMs) {
+	uint64_t deadline = bench_nowNs() + (uint64_t)timeoutMs * 1000000u;
+
+	lp_setConnectionString(SIM_CONNECTION_STRING);
+	lp_setReconnectBackoff(1000, 5000, 0);	// no boot hold off, the simulated hub is the only device
+
+	// asked again each pass, after a disconnect the cloud to device timer may have to be restarted
+	while (!sim_hubIsConnected() && bench_nowNs() < deadline) {
+		lp_connectToAzureIot();
+		EventLoop_Run(lp_getTimerEventLoop(), 100, true);
+	}
+	return sim_hubIsConnected();
+}
+
+void bench_drain(void) {
+	IoTHubDeviceClient_LL_DoWork(lp_getAzureIotClientHandle());
+	EventLoop_Run(lp_getTimerEventLoop(), 0, true);
+}
+
+void bench_reportBackHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {
+	lp_deviceTwinReportState(deviceTwinBinding, deviceTwinBinding->twinState);
+}
+
+LP_DIRECT_METHOD_RESPONSE_CODE bench_restartHandler(JSON_Object* json, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg) {
+	if (!json_object_has_value_of_type(json, "delay", JSONNumber)) {
+		return LP_METHOD_FAILED;
+	}
+	lp_setMethodResponse("restarting in %d", (int)json_object_get_number(json, "delay"));
+	return LP_METHOD_SUCCEEDED;
+}
+
+#if LP_ENABLE_INTERCORE
+static void InterCoreHandler(LP_INTER_CORE_BLOCK* block) {
+	LP_INTER_CORE_BLOCK setting = {.cmd = LP_IC_SET_DESIRED_TEMPERATURE};
+
+	if (block->cmd == LP_IC_TEMPERATURE_PRESSURE_HUMIDITY) {
+		setting.temperature = block->temperature > 22 ? 21 : 23;
+		lp_interCoreQueue(_connection, &setting);
+	}
+}
+
+LP_INTER_CORE_CONNECTION* bench_openInterCore(void) {
+	LP_IC_FRAME_WRITER writer;
+	LP_INTER_CORE_BLOCK block = {.cmd = LP_IC_TEMPERATURE_PRESSURE_HUMIDITY, .humidity = 45.5f, .pressure = 1013.25f};
+
+	for (int f = 0; f < 2; f++) {
+		lp_icFrameBegin(&writer, _frames[f], sizeof(_frames[f]));
+		for (int i = 0; i < 4; i++) {
+			block.temperature = 20.0f + f * 4 + i;
+			lp_icFrameAppend(&writer, &block);
+		}
+		_frameLengths[f] = lp_icFrameEnd(&writer);
+	}
+
+	_connection = lp_interCoreOpen(_componentId, InterCoreHandler);
+	return _connection;
+}
+
+void bench_replayInterCoreFrame(unsigned int turn) {
+	lp_interCoreReplayFrame(_connection, _frames[turn & 1], _frameLengths[turn & 1]);
+}
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+
+// Scaffolding shared by the host benchmarks and soaks, the clock, the connection to the simulated
+// hub and the lab pattern handlers the replayed traffic is dispatched to.
+#include "device_twins.h"
+#include "direct_methods.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#if LP_ENABLE_INTERCORE
+#include "inter_core.h"
+#endif
+
+uint64_t bench_nowNs(void);
+// connects to the simulated hub with no boot hold off, false if it is not connected within timeoutMs
+bool bench_connectSimulatedHub(unsigned int timeoutMs);
+// one pass of the simulated hub and of the timers that are due
+void bench_drain(void);
+// the lab pattern, every desired change is applied and reported straight back
+void bench_reportBackHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+// the Restart method of the soaks, answers with the delay it was given
+LP_DIRECT_METHOD_RESPONSE_CODE bench_restartHandler(JSON_Object* json, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg);
+
+#if LP_ENABLE_INTERCORE
+// connects to the real-time app with the Lab 7 pattern handler, a reading is answered with the setting the
+// real-time app should be running, queued so the settings of one callback go out as one frame
+LP_INTER_CORE_CONNECTION* bench_openInterCore(void);
+// replays two frames of four readings, as the real-time app sends them, in turn
+void bench_replayInterCoreFrame(unsigned int turn);
+#endif
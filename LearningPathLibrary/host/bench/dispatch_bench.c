@@ -0,0 +1,308 @@
+// Device twin and direct method dispatch benchmark on the host simulation build.
+// Replays full and partial twin documents of varying size and binding count through
+// lp_twinCallback, and direct method payloads through both method entry points, then
+// prints one CSV row per case: time, allocations and heap growth per callback.
+//
+//   dispatch_bench [iterations] > dispatch.csv
+#include "alloc_stats.h"
+#include "bench_common.h"
+#include "azure_iot.h"
+#include "device_twins.h"
+#include "direct_methods.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DEFAULT_ITERATIONS 10000
+#define BENCH_WARMUP_ITERATIONS 100
+#define BENCH_MAX_BINDINGS 32
+#define BENCH_MAX_METHODS 16
+#define BENCH_DOCUMENT_SIZE 32768
+#define BENCH_VERSION_WIDTH 10		// the $version field is rewritten in place, padded with spaces to this width
+#define BENCH_CONNECT_TIMEOUT_MS 5000
+
+typedef struct {
+	char text[BENCH_DOCUMENT_SIZE];
+	size_t length;
+	size_t versionOffset;
+} BENCH_DOCUMENT;
+
+typedef struct {
+	uint64_t elapsedNs;
+	uint64_t allocations;
+	uint64_t bytesAllocated;
+	size_t baselineBytes;
+	unsigned int calls;
+} BENCH_RESULT;
+
+static LP_DEVICE_TWIN_BINDING _bindings[BENCH_MAX_BINDINGS];
+static LP_DEVICE_TWIN_BINDING* _bindingSet[BENCH_MAX_BINDINGS];
+static char _bindingNames[BENCH_MAX_BINDINGS][16];
+
+static LP_DIRECT_METHOD_BINDING _methods[BENCH_MAX_METHODS];
+static LP_DIRECT_METHOD_BINDING* _methodSet[BENCH_MAX_METHODS];
+static char _methodNames[BENCH_MAX_METHODS][16];
+
+// documents alternate between two sets of values so every replay changes what the handlers see
+static BENCH_DOCUMENT _documents[2];
+static char _methodPayload[BENCH_DOCUMENT_SIZE];
+static unsigned long _twinVersion = 1;
+static unsigned int _iterations = BENCH_DEFAULT_ITERATIONS;
+
+static void BeginResult(BENCH_RESULT* result) {
+	ALLOC_STATS stats;
+
+	memset(result, 0, sizeof(*result));
+	alloc_statsReset();
+	alloc_statsGet(&stats);
+	result->baselineBytes = stats.liveBytes;
+}
+
+static void PrintHeader(void) {
+	printf("benchmark,scenario,bindings,payload_bytes,iterations,ns_per_call,allocs_per_call,bytes_per_call,peak_heap_bytes\n");
+}
+
+static void PrintResult(const char* benchmark, const char* scenario, size_t bindings, size_t payloadBytes, const BENCH_RESULT* result) {
+	ALLOC_STATS stats;
+	double calls = result->calls > 0 ? result->calls : 1;
+
+	alloc_statsGet(&stats);
+	printf("%s,%s,%zu,%zu,%u,%.1f,%.2f,%.1f,%zu\n", benchmark, scenario, bindings, payloadBytes, result->calls,
+		result->elapsedNs / calls, result->allocations / calls, result->bytesAllocated / calls,
+		stats.peakBytes - result->baselineBytes);
+	fflush(stdout);
+}
+
+// the allocations of one call, the hub simulation runs outside the measured window
+#define MEASURE(result, call) do { \
+		ALLOC_STATS before, after; \
+		uint64_t start; \
+		alloc_statsGet(&before); \
+		start = bench_nowNs(); \
+		call; \
+		(result)->elapsedNs += bench_nowNs() - start; \
+		alloc_statsGet(&after); \
+		(result)->allocations += after.allocations - before.allocations; \
+		(result)->bytesAllocated += after.bytesAllocated - before.bytesAllocated; \
+		(result)->calls++; \
+	} while (0)
+
+static void DrainHub(void) {
+	IoTHubDeviceClient_LL_DoWork(lp_getAzureIotClientHandle());
+}
+
+static void OpenBindings(size_t count) {
+	static const LP_DEVICE_TWIN_TYPE types[] = { LP_TYPE_INT, LP_TYPE_FLOAT, LP_TYPE_BOOL, LP_TYPE_STRING };
+
+	for (size_t i = 0; i < count; i++) {
+		snprintf(_bindingNames[i], sizeof(_bindingNames[i]), "prop%02zu", i);
+		memset(&_bindings[i], 0, sizeof(_bindings[i]));
+		_bindings[i].twinProperty = _bindingNames[i];
+		_bindings[i].twinType = types[i % 4];
+		_bindings[i].handler = bench_reportBackHandler;
+		_bindingSet[i] = &_bindings[i];
+	}
+	lp_openDeviceTwinSet(_bindingSet, count);
+}
+
+static int AppendValue(char* out, size_t capacity, size_t binding, int variant) {
+	switch (binding % 4) {
+	case 0:
+		return snprintf(out, capacity, "{\"value\":%zu}", binding * 10 + (size_t)variant);
+	case 1:
+		return snprintf(out, capacity, "{\"value\":%zu.%d}", binding, 25 + variant * 50);
+	case 2:
+		return snprintf(out, capacity, "{\"value\":%s}", variant ? "true" : "false");
+	default:
+		return snprintf(out, capacity, "{\"value\":\"mode-%c\"}", 'a' + variant);
+	}
+}
+
+/// <summary>
+///     Builds a twin document, complete documents wrap the desired section and carry reportedBytes of reported
+///     properties and metadata the dispatcher has to step over, as the documents sent on connect do
+/// </summary>
+static void BuildTwinDocument(BENCH_DOCUMENT* document, bool complete, size_t bindings, size_t changed, size_t reportedBytes, int variant) {
+	char* out = document->text;
+	size_t capacity = sizeof(document->text);
+	size_t length = 0;
+
+#define APPEND(...) length += (size_t)snprintf(out + length, capacity - length, __VA_ARGS__)
+
+	APPEND("%s", complete ? "{\"desired\":{" : "{");
+	for (size_t i = 0; i < changed; i++) {
+		APPEND("\"%s\":", _bindingNames[i]);
+		length += (size_t)AppendValue(out + length, capacity - length, i, variant);
+		APPEND(",");
+	}
+	APPEND("\"$version\":");
+	document->versionOffset = length;
+	APPEND("%*s}", BENCH_VERSION_WIDTH, "");
+
+	if (complete) {
+		APPEND(",\"reported\":{");
+		for (size_t i = 0; i < bindings; i++) {
+			APPEND("\"%s\":", _bindingNames[i]);
+			length += (size_t)AppendValue(out + length, capacity - length, i, variant);
+			APPEND(",");
+		}
+		for (size_t i = 0; length < reportedBytes && length + 128 < capacity; i++) {
+			APPEND("\"telemetry%04zu\":{\"value\":21.5,\"$lastUpdated\":\"2026-10-14T09:30:00.1234567Z\"},", i);
+		}
+		APPEND("\"$version\":1}}");
+	}
+#undef APPEND
+
+	document->length = length;
+}
+
+static void SetVersion(BENCH_DOCUMENT* document, unsigned long version) {
+	char field[BENCH_VERSION_WIDTH + 1];
+
+	snprintf(field, sizeof(field), "%*lu", BENCH_VERSION_WIDTH, version);
+	memcpy(document->text + document->versionOffset, field, BENCH_VERSION_WIDTH);
+}
+
+static void RunTwin(const char* scenario, bool complete, size_t bindings, size_t changed, size_t reportedBytes) {
+	DEVICE_TWIN_UPDATE_STATE updateState = complete ? DEVICE_TWIN_UPDATE_COMPLETE : DEVICE_TWIN_UPDATE_PARTIAL;
+	BENCH_RESULT result;
+
+	OpenBindings(bindings);
+	BuildTwinDocument(&_documents[0], complete, bindings, changed, reportedBytes, 0);
+	BuildTwinDocument(&_documents[1], complete, bindings, changed, reportedBytes, 1);
+
+	for (unsigned int i = 0; i < BENCH_WARMUP_ITERATIONS; i++) {
+		BENCH_DOCUMENT* document = &_documents[i & 1];
+		SetVersion(document, ++_twinVersion);
+		lp_twinCallback(updateState, (const unsigned char*)document->text, document->length, NULL);
+		DrainHub();
+	}
+
+	BeginResult(&result);
+	for (unsigned int i = 0; i < _iterations; i++) {
+		BENCH_DOCUMENT* document = &_documents[i & 1];
+		SetVersion(document, ++_twinVersion);
+		MEASURE(&result, lp_twinCallback(updateState, (const unsigned char*)document->text, document->length, NULL));
+		DrainHub();
+	}
+	PrintResult("twin", scenario, bindings, _documents[0].length, &result);
+
+	lp_closeDeviceTwinSet();
+}
+
+static LP_DIRECT_METHOD_RESPONSE_CODE JsonMethodHandler(JSON_Object* json, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg) {
+	if (!json_object_has_value_of_type(json, "x", JSONNumber)) {
+		return LP_METHOD_FAILED;
+	}
+	lp_setMethodResponse("x=%d", (int)json_object_get_number(json, "x"));
+	return LP_METHOD_SUCCEEDED;
+}
+
+static LP_DIRECT_METHOD_RESPONSE_CODE RawMethodHandler(const unsigned char* payload, size_t payloadSize, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg) {
+	return payloadSize > 0 ? LP_METHOD_SUCCEEDED : LP_METHOD_FAILED;
+}
+
+static void OpenMethods(size_t count, bool raw) {
+	for (size_t i = 0; i < count; i++) {
+		snprintf(_methodNames[i], sizeof(_methodNames[i]), "Method%02zu", i);
+		memset(&_methods[i], 0, sizeof(_methods[i]));
+		_methods[i].methodName = _methodNames[i];
+		if (raw) {
+			_methods[i].rawHandler = RawMethodHandler;
+		} else {
+			_methods[i].handler = JsonMethodHandler;
+		}
+		_methodSet[i] = &_methods[i];
+	}
+	lp_openDirectMethodSet(_methodSet, count);
+}
+
+/// <summary>
+///     A method payload of about payloadBytes, the handler's x plus a telemetry array it does not read
+/// </summary>
+static size_t BuildMethodPayload(size_t payloadBytes) {
+	size_t length = (size_t)snprintf(_methodPayload, sizeof(_methodPayload), "{\"x\":7,\"samples\":[");
+
+	while (length + 16 < payloadBytes && length + 16 < sizeof(_methodPayload)) {
+		length += (size_t)snprintf(_methodPayload + length, sizeof(_methodPayload) - length, "%s12.345", _methodPayload[length - 1] == '[' ? "" : ",");
+	}
+	length += (size_t)snprintf(_methodPayload + length, sizeof(_methodPayload) - length, "]}");
+	return length;
+}
+
+static void RunMethod(const char* scenario, size_t methods, bool raw, bool found, bool inbound, size_t payloadBytes) {
+	const char* methodName = found ? _methodNames[methods - 1] : "Missing";
+	size_t payloadSize;
+	BENCH_RESULT result;
+	SIM_METHOD_RESULT methodResult;
+	unsigned char* response;
+	size_t responseSize;
+
+	OpenMethods(methods, raw);
+	payloadSize = BuildMethodPayload(payloadBytes);
+
+#define INVOKE() do { \
+		if (inbound) { \
+			sim_hubInvokeMethod(methodName, (const unsigned char*)_methodPayload, payloadSize, &methodResult); \
+		} else { \
+			lp_azureDirectMethodHandler(methodName, (const unsigned char*)_methodPayload, payloadSize, &response, &responseSize, NULL); \
+			free(response); \
+		} \
+	} while (0)
+
+	for (unsigned int i = 0; i < BENCH_WARMUP_ITERATIONS; i++) {
+		INVOKE();
+	}
+
+	BeginResult(&result);
+	for (unsigned int i = 0; i < _iterations; i++) {
+		MEASURE(&result, INVOKE());
+		DrainHub();
+	}
+#undef INVOKE
+
+	PrintResult(inbound ? "method_inbound" : "method_async", scenario, methods, payloadSize, &result);
+
+	lp_closeDirectMethodSet();
+}
+
+int main(int argc, char* argv[]) {
+	static const size_t bindingCounts[] = { 1, 8, 32 };
+	static const size_t reportedSizes[] = { 0, 2048, 8192 };
+	static const size_t payloadSizes[] = { 16, 1024, 8192 };
+
+	if (argc > 1) {
+		_iterations = (unsigned int)strtoul(argv[1], NULL, 10);
+	}
+
+	sim_setLogEnabled(false);
+
+	if (!bench_connectSimulatedHub(BENCH_CONNECT_TIMEOUT_MS)) {
+		fprintf(stderr, "ERROR: simulated IoT Hub did not connect\n");
+		return EXIT_FAILURE;
+	}
+
+	PrintHeader();
+
+	for (size_t b = 0; b < sizeof(bindingCounts) / sizeof(bindingCounts[0]); b++) {
+		for (size_t r = 0; r < sizeof(reportedSizes) / sizeof(reportedSizes[0]); r++) {
+			char scenario[32];
+			snprintf(scenario, sizeof(scenario), "full_reported_%zu", reportedSizes[r]);
+			RunTwin(scenario, true, bindingCounts[b], bindingCounts[b], reportedSizes[r]);
+		}
+		RunTwin("partial_one", false, bindingCounts[b], 1, 0);
+		RunTwin("partial_all", false, bindingCounts[b], bindingCounts[b], 0);
+	}
+
+	for (int inbound = 1; inbound >= 0; inbound--) {
+		for (size_t p = 0; p < sizeof(payloadSizes) / sizeof(payloadSizes[0]); p++) {
+			RunMethod("json", 1, false, true, inbound, payloadSizes[p]);
+			RunMethod("json", BENCH_MAX_METHODS, false, true, inbound, payloadSizes[p]);
+			RunMethod("raw", BENCH_MAX_METHODS, true, true, inbound, payloadSizes[p]);
+		}
+		RunMethod("not_found", BENCH_MAX_METHODS, false, false, inbound, payloadSizes[0]);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+// Inter-core replay on the host simulation build. Feeds a recording made on the device with
+// lp_setInterCoreRecording back through lp_interCoreReplayFrame, the decode, request matching
+// and delivery the A7 app runs for every frame the real-time app sends, into a callback that
+// formats each message as JSON telemetry as the labs' handlers do. Prints one CSV row per frame:
+// when it was recorded, its size and records, and the time it took to process.
+//
+//   intercore_replay recording [speed] > replay.csv
+//
+// speed 1 replays the frames at their recorded intervals, 10 ten times faster, 0 back to back.
+// The event loop runs between frames, so deferred work and timers the callback starts still run,
+// outside the times reported.
+#include "inter_core.h"
+#include "sim.h"
+#include "timer.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define REPLAY_JSON_BYTES 256
+
+static char _componentId[] = "00000000-0000-0000-0000-000000000000";
+static char _msgBuffer[REPLAY_JSON_BYTES];
+static volatile size_t _formatted;		// kept so the formatting is not optimised away
+
+static uint64_t NowNs(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+static void ReplayHandler(LP_INTER_CORE_BLOCK* block) {
+	int len;
+
+	switch (block->cmd) {
+	case LP_IC_TEMPERATURE_PRESSURE_HUMIDITY:
+		len = snprintf(_msgBuffer, sizeof(_msgBuffer), "{\"Temperature\":%.2f,\"Humidity\":%.2f,\"Pressure\":%.2f}",
+			block->temperature, block->humidity, block->pressure);
+		break;
+	default:
+		len = snprintf(_msgBuffer, sizeof(_msgBuffer), "{\"cmd\":%d,\"sequence\":%u}", block->cmd, block->sequence);
+		break;
+	}
+
+	_formatted += len > 0 ? (size_t)len : 0;
+}
+
+static bool ReadAll(int fd, void* buffer, size_t length) {
+	return read(fd, buffer, length) == (ssize_t)length;
+}
+
+// the event loop until dueNs, or once without waiting when it has passed
+static void RunUntil(EventLoop* eventLoop, uint64_t dueNs) {
+	do {
+		uint64_t now = NowNs();
+		int waitMs = now >= dueNs ? 0 : (int)((dueNs - now + 999999) / 1000000);
+
+		EventLoop_Run(eventLoop, waitMs, true);
+	} while (NowNs() < dueNs);
+}
+
+int main(int argc, char* argv[]) {
+	LP_INTER_CORE_RECORDING_HEADER header;
+	LP_INTER_CORE_RECORDED_FRAME recorded;
+	LP_INTER_CORE_STATS stats;
+	uint8_t frame[LP_IC_MAX_FRAME_SIZE];
+	uint64_t firstUs = 0, startNs;
+	unsigned int frames = 0;
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: intercore_replay recording [speed]\n");
+		return EXIT_FAILURE;
+	}
+
+	double speed = argc > 2 ? strtod(argv[2], NULL) : 1;
+	int fd = open(argv[1], O_RDONLY);
+
+	if (fd == -1 || !ReadAll(fd, &header, sizeof(header)) || header.magic != LP_INTER_CORE_RECORDING_MAGIC) {
+		fprintf(stderr, "ERROR: %s is not an inter-core recording\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	sim_setLogEnabled(false);
+
+	LP_INTER_CORE_CONNECTION* connection = lp_interCoreOpen(_componentId, ReplayHandler);
+	if (connection == NULL) {
+		fprintf(stderr, "ERROR: inter-core connection not opened\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("frame,recorded_us,bytes,records,process_ns\n");
+	startNs = NowNs();
+
+	while (ReadAll(fd, &recorded, sizeof(recorded))) {
+		if (recorded.length > sizeof(frame) || !ReadAll(fd, frame, recorded.length)) {
+			fprintf(stderr, "ERROR: recording truncated or corrupt at frame %u\n", frames);
+			return EXIT_FAILURE;
+		}
+
+		if (frames == 0) {
+			firstUs = recorded.monotonicUs;
+		}
+
+		uint64_t offsetUs = recorded.monotonicUs - firstUs;
+		RunUntil(lp_getTimerEventLoop(), speed > 0 ? startNs + (uint64_t)(offsetUs * 1000 / speed) : 0);
+
+		lp_interCoreGetStats(connection, &stats);
+		uint32_t recordsBefore = stats.messagesIn;
+
+		uint64_t began = NowNs();
+		lp_interCoreReplayFrame(connection, frame, recorded.length);
+		uint64_t elapsed = NowNs() - began;
+
+		lp_interCoreGetStats(connection, &stats);
+		printf("%u,%llu,%u,%u,%llu\n", frames, (unsigned long long)offsetUs, recorded.length, stats.messagesIn - recordsBefore,
+			(unsigned long long)elapsed);
+		frames++;
+	}
+
+	EventLoop_Run(lp_getTimerEventLoop(), 0, true);
+	lp_interCoreClose(connection);
+	close(fd);
+
+	return EXIT_SUCCESS;
+}
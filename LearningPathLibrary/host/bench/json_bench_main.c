@@ -0,0 +1,35 @@
+// parson throughput over the json_bench.c corpus on the host simulation build, the same
+// CSV rows the JsonBenchmark direct method logs on the device.
+//
+//   json_bench [iterations] > json.csv
+#include "json_bench.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_DEFAULT_ITERATIONS 2000
+
+int main(int argc, char* argv[]) {
+	unsigned int iterations = argc > 1 ? (unsigned int)strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_ITERATIONS;
+	char row[160];
+
+	sim_setLogEnabled(false);
+
+	printf("%s\n", LP_JSON_BENCH_CSV_HEADER);
+
+	for (size_t i = 0; i < lp_jsonBenchDocumentCount(); i++) {
+		for (int arena = 0; arena <= 1; arena++) {
+			LP_JSON_BENCH_RESULT result;
+
+			if (!lp_runJsonBench(i, arena, iterations, &result)) {
+				fprintf(stderr, "ERROR: benchmark of document %zu failed\n", i);
+				return EXIT_FAILURE;
+			}
+
+			lp_formatJsonBenchResult(&result, row, sizeof(row));
+			printf("%s\n", row);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
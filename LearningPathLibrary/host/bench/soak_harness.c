@@ -0,0 +1,205 @@
+// Long soak on the host simulation build. Runs the mix a device sees, telemetry, health records, partial
+// twin updates, direct methods, a reconnect every few hours and, with LP_ENABLE_INTERCORE, a frame from
+// the real-time app every second, on an accelerated clock: the mix is scheduled in simulated seconds and
+// each simulated second runs as fast as it can, so 30 days take minutes. The library's own timers and
+// backoffs still run on the real clock between the passes. soak_monitor.h samples every simulated hour.
+//
+//   soak_harness [days] [build] [samples.csv] > trend.csv
+//
+// Prints the trend report, one row per metric tagged with build, git describe for example, so the
+// reports of successive library builds can be kept together and compared, and fails if a metric other
+// than the lag grows. samples.csv gets every sample kept. lag_us is the longest pass of the mix, how long
+// the event loop would have been held, in the hour before each sample.
+#include "azure_iot.h"
+#include "bench_common.h"
+#include "health_telemetry.h"
+#include "sim.h"
+#include "soak_monitor.h"
+#include "telemetry_encoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SOAK_DEFAULT_DAYS 30
+#define SOAK_CONNECT_TIMEOUT_MS 10000
+#define SOAK_TELEMETRY_PERIOD_S 10
+#define SOAK_HEALTH_PERIOD_S LP_HEALTH_DEFAULT_PERIOD_SECONDS
+#define SOAK_TWIN_PERIOD_S 600
+#define SOAK_METHOD_PERIOD_S 1800
+#define SOAK_RECONNECT_PERIOD_S (6 * 3600)
+#define SOAK_SAMPLE_PERIOD_S 3600
+#define SOAK_TELEMETRY_BYTES 256
+#define SOAK_DOCUMENT_BYTES 256
+
+static LP_DEVICE_TWIN_BINDING _desiredTemperature = {.twinProperty = "DesiredTemperature", .twinType = LP_TYPE_FLOAT};
+static LP_DEVICE_TWIN_BINDING _reportPeriod = {.twinProperty = "ReportPeriod", .twinType = LP_TYPE_INT};
+static LP_DEVICE_TWIN_BINDING _mode = {.twinProperty = "Mode", .twinType = LP_TYPE_STRING};
+static LP_DEVICE_TWIN_BINDING* _bindingSet[] = {&_desiredTemperature, &_reportPeriod, &_mode};
+
+static LP_DIRECT_METHOD_BINDING _restart = {.methodName = "Restart"};
+static LP_DIRECT_METHOD_BINDING* _methodSet[] = {&_restart};
+
+static char _document[SOAK_DOCUMENT_BYTES];
+static unsigned long _twinVersion = 1;
+static uint8_t _telemetry[SOAK_TELEMETRY_BYTES];
+static unsigned int _reconnectsFailed = 0;
+
+static void SendTelemetry(uint32_t second) {
+	LP_TELEMETRY_ENCODER encoder;
+
+	// JSON and CBOR in turn
+	lp_telemetryBegin(&encoder, second / SOAK_TELEMETRY_PERIOD_S % 2 ? LP_TELEMETRY_CBOR : LP_TELEMETRY_JSON, _telemetry, sizeof(_telemetry));
+	lp_telemetryAddFloat(&encoder, "Temperature", 20.0f + (float)(second % 600) / 100);
+	lp_telemetryAddFloat(&encoder, "Humidity", 45.5f);
+	lp_telemetryAddInt(&encoder, "MsgId", second / SOAK_TELEMETRY_PERIOD_S);
+	lp_telemetryEnd(&encoder);
+	lp_sendTelemetry(&encoder, NULL);
+}
+
+static void SendHealth(void) {
+	char record[LP_HEALTH_RECORD_SIZE];
+
+	if (lp_formatHealthRecord(record, sizeof(record)) > 0) {
+		lp_sendMsg(record);
+	}
+}
+
+static void UpdateTwin(uint32_t second) {
+	unsigned int step = second / SOAK_TWIN_PERIOD_S;
+	int length = snprintf(_document, sizeof(_document),
+		"{\"DesiredTemperature\":{\"value\":%u.5},\"ReportPeriod\":{\"value\":%u},\"Mode\":{\"value\":\"%s\"},\"$version\":%lu}",
+		18 + step % 8, 10 + step % 3, step % 2 ? "eco" : "comfort", ++_twinVersion);
+
+	sim_hubDeliverTwin(DEVICE_TWIN_UPDATE_PARTIAL, (const unsigned char*)_document, (size_t)length);
+}
+
+static void InvokeMethod(uint32_t second) {
+	char payload[32];
+	SIM_METHOD_RESULT methodResult;
+	int length = snprintf(payload, sizeof(payload), "{\"delay\":%u}", second / SOAK_METHOD_PERIOD_S % 60);
+
+	sim_hubInvokeMethod("Restart", (const unsigned char*)payload, (size_t)length, &methodResult);
+}
+
+static void Reconnect(void) {
+	sim_hubDisconnect(IOTHUB_CLIENT_CONNECTION_NO_NETWORK);
+	bench_drain();
+	if (!bench_connectSimulatedHub(SOAK_CONNECT_TIMEOUT_MS)) {
+		_reconnectsFailed++;
+	}
+}
+
+/// <summary>
+///     What is due at this simulated second
+/// </summary>
+static void RunSecond(uint32_t second) {
+#if LP_ENABLE_INTERCORE
+	bench_replayInterCoreFrame(second);
+#endif
+	if (second % SOAK_TELEMETRY_PERIOD_S == 0) {
+		SendTelemetry(second);
+	}
+	if (second % SOAK_HEALTH_PERIOD_S == 0) {
+		SendHealth();
+	}
+	if (second % SOAK_TWIN_PERIOD_S == 0) {
+		UpdateTwin(second);
+	}
+	if (second % SOAK_METHOD_PERIOD_S == 0) {
+		InvokeMethod(second);
+	}
+	if (second % SOAK_RECONNECT_PERIOD_S == 0 && second > 0) {
+		Reconnect();
+	}
+	bench_drain();
+}
+
+static bool WriteSamples(const char* path) {
+	const LP_SOAK_SAMPLE* samples;
+	size_t count = lp_getSoakSamples(&samples);
+	char record[LP_SOAK_RECORD_SIZE];
+	FILE* out = fopen(path, "w");
+
+	if (out == NULL) {
+		return false;
+	}
+
+	fprintf(out, "elapsed_s,heap_bytes,heap_objects,user_mode_kb,peak_user_mode_kb,slack_kb,open_fds,lag_us,loop_lag_max_us\n");
+	for (size_t i = 0; i < count; i++) {
+		if (lp_formatSoakSample(&samples[i], record, sizeof(record)) > 0) {
+			fprintf(out, "%s\n", record);
+		}
+	}
+	return fclose(out) == 0;
+}
+
+int main(int argc, char* argv[]) {
+	unsigned int days = argc > 1 ? (unsigned int)strtoul(argv[1], NULL, 10) : SOAK_DEFAULT_DAYS;
+	const char* build = argc > 2 ? argv[2] : "unlabelled";
+	uint32_t seconds = days * 86400u;
+	uint64_t longestNs = 0;
+	bool growing = false;
+
+	sim_setLogEnabled(false);
+	lp_enableHeapAccounting(true);		// before the first library allocation, so the live heap is all of it
+
+	if (days == 0 || !bench_connectSimulatedHub(SOAK_CONNECT_TIMEOUT_MS)) {
+		fprintf(stderr, days == 0 ? "usage: soak_harness [days] [build] [samples.csv]\n" : "ERROR: simulated IoT Hub did not connect\n");
+		return EXIT_FAILURE;
+	}
+
+	_desiredTemperature.handler = bench_reportBackHandler;
+	_reportPeriod.handler = bench_reportBackHandler;
+	_mode.handler = bench_reportBackHandler;
+	lp_openDeviceTwinSet(_bindingSet, sizeof(_bindingSet) / sizeof(_bindingSet[0]));
+	_restart.handler = bench_restartHandler;
+	lp_openDirectMethodSet(_methodSet, sizeof(_methodSet) / sizeof(_methodSet[0]));
+#if LP_ENABLE_INTERCORE
+	bench_openInterCore();
+#endif
+
+	lp_resetSoakSamples();
+	for (uint32_t second = 0; second <= seconds; second++) {
+		if (second % SOAK_SAMPLE_PERIOD_S == 0) {
+			lp_soakSample(second, (uint32_t)(longestNs / 1000));
+			longestNs = 0;
+		}
+
+		uint64_t began = bench_nowNs();
+		RunSecond(second);
+		uint64_t elapsed = bench_nowNs() - began;
+
+		// a reconnect waits on the real clock for the library's backoff, that is not the mix holding the loop
+		if (elapsed > longestNs && second % SOAK_RECONNECT_PERIOD_S != 0) {
+			longestNs = elapsed;
+		}
+	}
+
+	printf("build,days,metric,first,last,max,per_day,growing\n");
+	for (LP_SOAK_METRIC metric = 0; metric < LP_SOAK_METRICS; metric++) {
+		LP_SOAK_TREND trend;
+		char record[LP_SOAK_RECORD_SIZE];
+
+		if (lp_getSoakTrend(metric, &trend) && lp_formatSoakTrend(&trend, record, sizeof(record)) > 0) {
+			printf("%s,%u,%s\n", build, days, record);
+			growing = growing || trend.growing;
+		}
+	}
+
+	if (argc > 3 && !WriteSamples(argv[3])) {
+		fprintf(stderr, "ERROR: samples not written to %s\n", argv[3]);
+		return EXIT_FAILURE;
+	}
+
+	if (_reconnectsFailed > 0) {
+		fprintf(stderr, "ERROR: %u reconnects timed out\n", _reconnectsFailed);
+		return EXIT_FAILURE;
+	}
+
+	if (growing) {
+		fprintf(stderr, "ERROR: memory or descriptors grew over the soak, see the growing column\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,203 @@
+// Steady state allocation soak on the host simulation build. Warms the hot paths up, marks the end of
+// initialisation with lp_heapSteadyState, then runs them for a number of cycles: partial twin updates
+// reported straight back, JSON and CBOR telemetry, direct methods and, with LP_ENABLE_INTERCORE, frames
+// from the real-time app whose handler queues settings back. Prints one CSV row per path with the
+// process-wide allocations counted by alloc_stats and the library's steady state allocations, and
+// fails if there are any.
+//
+//   steady_state_soak [cycles] [trap] > soak.csv
+//
+// trap stops at the first allocation instead, with its backtrace on stderr, run it under gdb.
+#include "alloc_stats.h"
+#include "azure_iot.h"
+#include "bench_common.h"
+#include "heap_stats.h"
+#include "sim.h"
+#include "telemetry_encoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SOAK_DEFAULT_CYCLES 10000
+#define SOAK_WARMUP_CYCLES 100
+#define SOAK_CONNECT_TIMEOUT_MS 5000
+#define SOAK_TELEMETRY_BYTES 256
+#define SOAK_DOCUMENT_BYTES 256
+
+typedef enum {
+	SOAK_TWIN,
+	SOAK_TELEMETRY_JSON,
+	SOAK_TELEMETRY_CBOR,
+	SOAK_METHOD,
+#if LP_ENABLE_INTERCORE
+	SOAK_INTER_CORE,
+#endif
+	SOAK_PATHS
+} SOAK_PATH;
+
+typedef struct {
+	const char* name;
+	unsigned int cycles;
+	uint64_t allocations;		// process wide, the simulated hub and the C library included
+	uint64_t bytesAllocated;
+	uint32_t libraryAllocations;	// lp_heap steady state allocations
+} SOAK_RESULT;
+
+static SOAK_RESULT _results[SOAK_PATHS] = {
+	[SOAK_TWIN] = {.name = "twin_partial"},
+	[SOAK_TELEMETRY_JSON] = {.name = "telemetry_json"},
+	[SOAK_TELEMETRY_CBOR] = {.name = "telemetry_cbor"},
+	[SOAK_METHOD] = {.name = "method"},
+#if LP_ENABLE_INTERCORE
+	[SOAK_INTER_CORE] = {.name = "inter_core"},
+#endif
+};
+
+static LP_DEVICE_TWIN_BINDING _desiredTemperature = {.twinProperty = "DesiredTemperature", .twinType = LP_TYPE_FLOAT};
+static LP_DEVICE_TWIN_BINDING _reportPeriod = {.twinProperty = "ReportPeriod", .twinType = LP_TYPE_INT};
+static LP_DEVICE_TWIN_BINDING _mode = {.twinProperty = "Mode", .twinType = LP_TYPE_STRING};
+static LP_DEVICE_TWIN_BINDING* _bindingSet[] = {&_desiredTemperature, &_reportPeriod, &_mode};
+
+static LP_DIRECT_METHOD_BINDING _restart = {.methodName = "Restart"};
+static LP_DIRECT_METHOD_BINDING* _methodSet[] = {&_restart};
+
+static char _documents[2][SOAK_DOCUMENT_BYTES];
+static unsigned long _twinVersion = 1;
+static uint8_t _telemetry[SOAK_TELEMETRY_BYTES];
+
+static void RunTwin(unsigned int cycle) {
+	char* document = _documents[cycle & 1];
+	int length = snprintf(document, SOAK_DOCUMENT_BYTES,
+		"{\"DesiredTemperature\":{\"value\":%d.5},\"ReportPeriod\":{\"value\":%u},\"Mode\":{\"value\":\"%s\"},\"$version\":%lu}",
+		18 + (int)(cycle & 7), 10 + (cycle & 1), (cycle & 1) ? "eco" : "comfort", ++_twinVersion);
+
+	lp_twinCallback(DEVICE_TWIN_UPDATE_PARTIAL, (const unsigned char*)document, (size_t)length, NULL);
+}
+
+static void RunTelemetry(LP_TELEMETRY_FORMAT format, unsigned int cycle) {
+	LP_TELEMETRY_ENCODER encoder;
+
+	lp_telemetryBegin(&encoder, format, _telemetry, sizeof(_telemetry));
+	lp_telemetryAddFloat(&encoder, "Temperature", 20.0f + (float)(cycle % 100) / 10);
+	lp_telemetryAddFloat(&encoder, "Humidity", 45.5f);
+	lp_telemetryAddInt(&encoder, "MsgId", cycle);
+	lp_telemetryAddBool(&encoder, "Heating", cycle & 1);
+	lp_telemetryEnd(&encoder);
+	lp_sendTelemetry(&encoder, NULL);
+}
+
+static void RunMethod(unsigned int cycle) {
+	static const char payloads[2][16] = {"{\"delay\":5}", "{\"delay\":10}"};
+	SIM_METHOD_RESULT methodResult;
+
+	sim_hubInvokeMethod("Restart", (const unsigned char*)payloads[cycle & 1], strlen(payloads[cycle & 1]), &methodResult);
+}
+
+static void RunPath(SOAK_PATH path, unsigned int cycle) {
+	switch (path) {
+	case SOAK_TWIN:
+		RunTwin(cycle);
+		break;
+	case SOAK_TELEMETRY_JSON:
+		RunTelemetry(LP_TELEMETRY_JSON, cycle);
+		break;
+	case SOAK_TELEMETRY_CBOR:
+		RunTelemetry(LP_TELEMETRY_CBOR, cycle);
+		break;
+	case SOAK_METHOD:
+		RunMethod(cycle);
+		break;
+#if LP_ENABLE_INTERCORE
+	case SOAK_INTER_CORE:
+		bench_replayInterCoreFrame(cycle);
+		break;
+#endif
+	default:
+		break;
+	}
+	// the simulated hub and the event loop run inside the measured window, a deferred report or a
+	// completion the path starts allocates there as much as in the call itself
+	bench_drain();
+}
+
+static void MeasurePath(SOAK_PATH path, unsigned int cycle) {
+	SOAK_RESULT* result = &_results[path];
+	ALLOC_STATS before, after;
+	LP_HEAP_STATS heapBefore, heapAfter;
+
+	alloc_statsGet(&before);
+	lp_getHeapStats(&heapBefore);
+	RunPath(path, cycle);
+	lp_getHeapStats(&heapAfter);
+	alloc_statsGet(&after);
+
+	result->allocations += after.allocations - before.allocations;
+	result->bytesAllocated += after.bytesAllocated - before.bytesAllocated;
+	result->libraryAllocations += heapAfter.steadyAllocations - heapBefore.steadyAllocations;
+	result->cycles++;
+}
+
+static void Open(void) {
+	_desiredTemperature.handler = bench_reportBackHandler;
+	_reportPeriod.handler = bench_reportBackHandler;
+	_mode.handler = bench_reportBackHandler;
+	lp_openDeviceTwinSet(_bindingSet, sizeof(_bindingSet) / sizeof(_bindingSet[0]));
+
+	_restart.handler = bench_restartHandler;
+	lp_openDirectMethodSet(_methodSet, sizeof(_methodSet) / sizeof(_methodSet[0]));
+
+#if LP_ENABLE_INTERCORE
+	bench_openInterCore();
+#endif
+}
+
+int main(int argc, char* argv[]) {
+	unsigned int cycles = argc > 1 ? (unsigned int)strtoul(argv[1], NULL, 10) : SOAK_DEFAULT_CYCLES;
+	bool trap = argc > 2 && strcmp(argv[2], "trap") == 0;
+	bool allocated = false;
+
+	sim_setLogEnabled(false);
+
+	if (!bench_connectSimulatedHub(SOAK_CONNECT_TIMEOUT_MS)) {
+		fprintf(stderr, "ERROR: simulated IoT Hub did not connect\n");
+		return EXIT_FAILURE;
+	}
+
+	Open();
+
+	for (unsigned int cycle = 0; cycle < SOAK_WARMUP_CYCLES; cycle++) {
+		for (SOAK_PATH path = 0; path < SOAK_PATHS; path++) {
+			RunPath(path, cycle);
+		}
+	}
+
+	alloc_statsReset();
+	alloc_statsTrap(trap);
+	lp_heapSteadyState(trap ? LP_HEAP_STEADY_TRAP : LP_HEAP_STEADY_COUNT);
+
+	// the paths interleave as they do on a device, each cycle runs every one
+	for (unsigned int cycle = 0; cycle < cycles; cycle++) {
+		for (SOAK_PATH path = 0; path < SOAK_PATHS; path++) {
+			MeasurePath(path, cycle);
+		}
+	}
+
+	lp_heapSteadyState(LP_HEAP_STEADY_OFF);
+	alloc_statsTrap(false);
+
+	printf("path,cycles,allocations,bytes_allocated,library_allocations\n");
+	for (SOAK_PATH path = 0; path < SOAK_PATHS; path++) {
+		const SOAK_RESULT* result = &_results[path];
+
+		printf("%s,%u,%llu,%llu,%u\n", result->name, result->cycles, (unsigned long long)result->allocations,
+			(unsigned long long)result->bytesAllocated, result->libraryAllocations);
+		allocated = allocated || result->allocations > 0 || result->libraryAllocations > 0;
+	}
+
+	if (allocated) {
+		fprintf(stderr, "ERROR: allocations in steady state, run with trap under gdb to find them\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
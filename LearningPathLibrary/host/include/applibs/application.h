@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stddef.h>
+
+// Host simulation of applibs application, there is no real-time core to connect to
+int Application_Connect(const char* componentId);
+
+// read from /proc/self/status, VmRSS and VmHWM
+size_t Applications_GetTotalMemoryUsageInKB(void);
+size_t Applications_GetUserModeMemoryUsageInKB(void);
+size_t Applications_GetPeakUserModeMemoryUsageInKB(void);
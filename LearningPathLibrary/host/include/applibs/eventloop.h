@@ -0,0 +1,31 @@
+#pragma once
+
+// Host simulation of the applibs event loop, an epoll set dispatching registered descriptors
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct EventLoop EventLoop;
+typedef struct EventRegistration EventRegistration;
+
+typedef uint32_t EventLoop_IoEvents;
+#define EventLoop_None 0x0u
+#define EventLoop_Input 0x1u
+#define EventLoop_Output 0x4u
+#define EventLoop_Error 0x8u
+
+typedef enum {
+	EventLoop_Run_Failed = -1,
+	EventLoop_Run_FinishedEmpty = 0,
+	EventLoop_Run_Finished = 1
+} EventLoop_Run_Result;
+
+typedef void EventLoopIoCallback(EventLoop* el, int fd, EventLoop_IoEvents events, void* context);
+
+EventLoop* EventLoop_Create(void);
+void EventLoop_Close(EventLoop* el);
+EventLoop_Run_Result EventLoop_Run(EventLoop* el, int duration_in_milliseconds, bool process_one_event);
+int EventLoop_Stop(EventLoop* el);
+int EventLoop_GetWaitDescriptor(EventLoop* el);
+EventRegistration* EventLoop_RegisterIo(EventLoop* el, int fd, EventLoop_IoEvents eventBitmask, EventLoopIoCallback* callback, void* context);
+int EventLoop_ModifyIoEvents(EventLoop* el, EventRegistration* reg, EventLoop_IoEvents eventBitmask);
+int EventLoop_UnregisterIo(EventLoop* el, EventRegistration* reg);
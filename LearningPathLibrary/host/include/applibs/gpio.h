@@ -0,0 +1,24 @@
+#pragma once
+
+// Host simulation of applibs GPIO, pins are held in memory and driven with sim_gpioSetInput
+#include <stdint.h>
+
+typedef int GPIO_Id;
+
+typedef enum {
+	GPIO_Value_Low = 0,
+	GPIO_Value_High = 1
+} GPIO_Value;
+typedef uint8_t GPIO_Value_Type;
+
+typedef enum {
+	GPIO_OutputMode_PushPull = 0,
+	GPIO_OutputMode_OpenDrain = 1,
+	GPIO_OutputMode_OpenSource = 2
+} GPIO_OutputMode;
+typedef uint8_t GPIO_OutputMode_Type;
+
+int GPIO_OpenAsOutput(GPIO_Id gpioId, GPIO_OutputMode_Type outputMode, GPIO_Value_Type initialValue);
+int GPIO_OpenAsInput(GPIO_Id gpioId);
+int GPIO_SetValue(int gpioFd, GPIO_Value_Type value);
+int GPIO_GetValue(int gpioFd, GPIO_Value_Type* outValue);
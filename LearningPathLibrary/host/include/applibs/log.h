@@ -0,0 +1,7 @@
+#pragma once
+
+// Host simulation of applibs logging, written to stderr unless sim_setLogEnabled(false)
+#include <stdarg.h>
+
+int Log_Debug(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+int Log_DebugVarArgs(const char* fmt, va_list args);
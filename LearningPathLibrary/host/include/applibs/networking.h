@@ -0,0 +1,6 @@
+#pragma once
+
+// Host simulation of applibs networking, ready unless sim_setNetworkReady(false)
+#include <stdbool.h>
+
+int Networking_IsNetworkingReady(bool* outIsNetworkingReady);
@@ -0,0 +1,5 @@
+#pragma once
+
+// Host simulation of applibs power management, both fail with EPERM like a device being debugged
+int PowerManagement_ForceSystemReboot(void);
+int PowerManagement_ForceSystemPowerDown(unsigned int maximum_residency_in_seconds);
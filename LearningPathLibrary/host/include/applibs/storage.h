@@ -0,0 +1,5 @@
+#pragma once
+
+// Host simulation of applibs mutable storage, one file named by sim_setMutableStoragePath
+int Storage_OpenMutableFile(void);
+int Storage_DeleteMutableFile(void);
@@ -0,0 +1,3 @@
+#pragma once
+
+const void* Prov_Device_MQTT_Protocol(void);
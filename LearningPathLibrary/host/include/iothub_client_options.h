@@ -0,0 +1,7 @@
+#pragma once
+
+#define OPTION_KEEP_ALIVE "keepalive"
+#define OPTION_LOG_TRACE "logtrace"
+#define OPTION_AUTO_URL_ENCODE_DECODE "auto_url_encode_decode"
+#define OPTION_MODEL_ID "model_id"
+#define OPTION_CONNECTION_TIMEOUT "connect_timeout"
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "iothub_device_client_ll.h"
+
+const void* MQTT_Protocol(void);
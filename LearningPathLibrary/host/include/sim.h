@@ -0,0 +1,80 @@
+#pragma once
+
+// Controls and observations for the host simulation of applibs and the IoT Hub client. The library
+// under test sees the usual headers, a test or benchmark drives the device side through these.
+#include <applibs/gpio.h>
+#include <iothub_device_client_ll.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SIM_HUB_HOSTNAME "sim.azure-devices.net"	// the hub simulated DPS assigns
+#define SIM_CONNECTION_STRING "HostName=" SIM_HUB_HOSTNAME ";DeviceId=sim;SharedAccessKey=c2lt"
+#define SIM_METHOD_RESPONSE_SIZE 1024				// bytes of a method response sim_hubInvokeMethod keeps
+#define SIM_MESSAGE_PROPERTIES 8					// application properties a message keeps
+#define SIM_PROPERTY_SIZE 64						// longest property key or value kept, including the NUL
+
+typedef struct SIM_HUB_STATS
+{
+	unsigned int messagesSent;
+	size_t messageBytes;
+	unsigned int reportedStatesSent;
+	size_t reportedStateBytes;
+	unsigned int methodResponses;
+	unsigned int doWorkCalls;
+	unsigned int blobBlocks;		// blocks put to storage, blobBytes their total size
+	size_t blobBytes;
+	unsigned int blobsCommitted;	// block lists put
+	unsigned int blobsNotified;		// upload completions the device reported, blobsFailed of them unsuccessful
+	unsigned int blobsFailed;
+	unsigned int cloudMessages;		// cloud to device messages delivered, by the disposition the client returned
+	unsigned int cloudMessagesRejected;
+	unsigned int cloudMessagesAbandoned;
+} SIM_HUB_STATS;
+
+typedef struct SIM_UPDATE_STATS
+{
+	unsigned int deferrals;			// SysEvent_DeferEvent calls, deferredMinutes their total
+	unsigned int deferredMinutes;
+	unsigned int resumes;			// SysEvent_ResumeEvent calls
+} SIM_UPDATE_STATS;
+
+typedef struct SIM_METHOD_RESULT
+{
+	bool responded;				// false while the handler has the response pending
+	int status;
+	char response[SIM_METHOD_RESPONSE_SIZE];
+	size_t responseSize;		// bytes the client sent, may exceed what response holds
+} SIM_METHOD_RESULT;
+
+void sim_setLogEnabled(bool enabled);
+void sim_setNetworkReady(bool ready);
+void sim_setMutableStoragePath(const char* path);
+
+// the level a pin opened as an input reads, pins default high as with the board pull ups
+void sim_gpioSetInput(GPIO_Id gpioId, GPIO_Value_Type value);
+// the level last written to a pin opened as an output, -1 when it is not open
+int sim_gpioGetOutput(GPIO_Id gpioId);
+
+// the client authenticates on its first DoWork, then delivers the document set here as the full twin
+void sim_hubSetTwinDocument(const char* json);
+void sim_hubDisconnect(IOTHUB_CLIENT_CONNECTION_STATUS_REASON reason);
+bool sim_hubIsConnected(void);
+// both deliver straight through the registered callback as DoWork would, false without a client
+bool sim_hubDeliverTwin(DEVICE_TWIN_UPDATE_STATE updateState, const unsigned char* payload, size_t payloadSize);
+bool sim_hubInvokeMethod(const char* methodName, const unsigned char* payload, size_t payloadSize, SIM_METHOD_RESULT* result);
+// a cloud to device message with propertyCount key and value pairs in properties, disposition may be NULL
+bool sim_hubDeliverMessage(const unsigned char* payload, size_t payloadSize, const char* const properties[], size_t propertyCount,
+	IOTHUBMESSAGE_DISPOSITION_RESULT* disposition);
+// the last reported state the client sent, NUL terminated, empty before the first
+const char* sim_hubLastReportedState(void);
+void sim_hubGetStats(SIM_HUB_STATS* stats);
+void sim_hubResetStats(void);
+// the next count block puts fail, as a storage request that timed out would
+void sim_hubFailBlobBlocks(unsigned int count);
+// the next count reported states are answered with status, 429 as IoT Hub throttling would
+void sim_hubRefuseReportedStates(unsigned int count, int status);
+
+// delivers UpdateReadyForInstall with status, SysEvent_Status_Pending and so on, through the registered callback as
+// the OS would for an update that allows maxDeferralMinutes, false when nothing is registered for it
+bool sim_raiseUpdateEvent(unsigned int status, unsigned int maxDeferralMinutes);
+void sim_getUpdateStats(SIM_UPDATE_STATS* stats);
@@ -0,0 +1,311 @@
+#include "sim.h"
+#include <applibs/application.h>
+#include <applibs/log.h>
+#include <applibs/networking.h>
+#include <applibs/powermanagement.h>
+#include <applibs/storage.h>
+#include <applibs/sysevent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SIM_GPIO_PINS 128
+#define SIM_GPIO_FDS 1024
+
+typedef struct {
+	bool open;
+	bool output;
+	GPIO_Value_Type input;
+	GPIO_Value_Type outputLevel;
+} SIM_PIN;
+
+// every open pin holds a real descriptor so the library can close it, the descriptor maps back to the pin
+static SIM_PIN _pins[SIM_GPIO_PINS];
+static int _pinByFd[SIM_GPIO_FDS];
+static bool _pinsInitialised = false;
+
+static bool _logEnabled = true;
+static bool _simNetworkReady = true;
+static const char* _storagePath = "mutable_storage.bin";
+
+void sim_setLogEnabled(bool enabled) {
+	_logEnabled = enabled;
+}
+
+void sim_setNetworkReady(bool ready) {
+	_simNetworkReady = ready;
+}
+
+void sim_setMutableStoragePath(const char* path) {
+	_storagePath = path;
+}
+
+int Log_DebugVarArgs(const char* fmt, va_list args) {
+	return _logEnabled ? vfprintf(stderr, fmt, args) : 0;
+}
+
+int Log_Debug(const char* fmt, ...) {
+	va_list args;
+	int result;
+
+	va_start(args, fmt);
+	result = Log_DebugVarArgs(fmt, args);
+	va_end(args);
+
+	return result;
+}
+
+static void InitialisePins(void) {
+	if (!_pinsInitialised) {
+		for (int i = 0; i < SIM_GPIO_PINS; i++) {
+			_pins[i].input = GPIO_Value_High;
+		}
+		for (int i = 0; i < SIM_GPIO_FDS; i++) {
+			_pinByFd[i] = -1;
+		}
+		_pinsInitialised = true;
+	}
+}
+
+static SIM_PIN* PinFromFd(int fd) {
+	InitialisePins();
+
+	if (fd < 0 || fd >= SIM_GPIO_FDS || _pinByFd[fd] < 0) {
+		errno = EBADF;
+		return NULL;
+	}
+	return &_pins[_pinByFd[fd]];
+}
+
+static int OpenPin(GPIO_Id gpioId, bool output, GPIO_Value_Type initialValue) {
+	int fd;
+
+	InitialisePins();
+
+	if (gpioId < 0 || gpioId >= SIM_GPIO_PINS) {
+		errno = ENODEV;
+		return -1;
+	}
+
+	if ((fd = open("/dev/null", O_RDWR | O_CLOEXEC)) == -1) {
+		return -1;
+	}
+
+	if (fd >= SIM_GPIO_FDS) {
+		close(fd);
+		errno = EMFILE;
+		return -1;
+	}
+
+	// a descriptor the kernel hands out again was closed, the pin it mapped to is closed with it
+	if (_pinByFd[fd] >= 0) {
+		_pins[_pinByFd[fd]].open = false;
+	}
+
+	_pinByFd[fd] = gpioId;
+	_pins[gpioId].open = true;
+	_pins[gpioId].output = output;
+	_pins[gpioId].outputLevel = initialValue;
+
+	return fd;
+}
+
+int GPIO_OpenAsOutput(GPIO_Id gpioId, GPIO_OutputMode_Type outputMode, GPIO_Value_Type initialValue) {
+	return OpenPin(gpioId, true, initialValue);
+}
+
+int GPIO_OpenAsInput(GPIO_Id gpioId) {
+	return OpenPin(gpioId, false, GPIO_Value_Low);
+}
+
+int GPIO_SetValue(int gpioFd, GPIO_Value_Type value) {
+	SIM_PIN* pin = PinFromFd(gpioFd);
+
+	if (pin == NULL || !pin->output) {
+		errno = pin == NULL ? EBADF : EPERM;
+		return -1;
+	}
+
+	pin->outputLevel = value;
+	return 0;
+}
+
+int GPIO_GetValue(int gpioFd, GPIO_Value_Type* outValue) {
+	SIM_PIN* pin = PinFromFd(gpioFd);
+
+	if (pin == NULL) {
+		return -1;
+	}
+
+	*outValue = pin->output ? pin->outputLevel : pin->input;
+	return 0;
+}
+
+void sim_gpioSetInput(GPIO_Id gpioId, GPIO_Value_Type value) {
+	InitialisePins();
+
+	if (gpioId >= 0 && gpioId < SIM_GPIO_PINS) {
+		_pins[gpioId].input = value;
+	}
+}
+
+int sim_gpioGetOutput(GPIO_Id gpioId) {
+	InitialisePins();
+
+	if (gpioId < 0 || gpioId >= SIM_GPIO_PINS || !_pins[gpioId].open || !_pins[gpioId].output) {
+		return -1;
+	}
+	return _pins[gpioId].outputLevel;
+}
+
+int Networking_IsNetworkingReady(bool* outIsNetworkingReady) {
+	*outIsNetworkingReady = _simNetworkReady;
+	return 0;
+}
+
+int Storage_OpenMutableFile(void) {
+	return open(_storagePath, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+}
+
+int Storage_DeleteMutableFile(void) {
+	return unlink(_storagePath) == -1 && errno != ENOENT ? -1 : 0;
+}
+
+int PowerManagement_ForceSystemReboot(void) {
+	errno = EPERM;
+	return -1;
+}
+
+int PowerManagement_ForceSystemPowerDown(unsigned int maximum_residency_in_seconds) {
+	errno = EPERM;		// the duty cycle then runs its next wake in-process
+	return -1;
+}
+
+int Application_Connect(const char* componentId) {
+	errno = ENOENT;		// no real-time core application on the host
+	return -1;
+}
+
+#define PROC_STATUS_BYTES 2048
+
+// read without stdio, fopen allocates and the steady state soak reads the memory usage between its checks
+static size_t ProcStatusKB(const char* field) {
+	char status[PROC_STATUS_BYTES];
+	size_t fieldLength = strlen(field);
+	int fd = open("/proc/self/status", O_RDONLY);
+	ssize_t length;
+
+	if (fd == -1) {
+		return 0;
+	}
+
+	length = read(fd, status, sizeof(status) - 1);
+	close(fd);
+	if (length <= 0) {
+		return 0;
+	}
+	status[length] = '\0';
+
+	for (const char* line = status; line != NULL; line = strchr(line, '\n')) {
+		line += *line == '\n' ? 1 : 0;
+		if (strncmp(line, field, fieldLength) == 0 && line[fieldLength] == ':') {
+			return (size_t)strtoul(line + fieldLength + 1, NULL, 10);
+		}
+	}
+
+	return 0;
+}
+
+size_t Applications_GetTotalMemoryUsageInKB(void) {
+	return ProcStatusKB("VmRSS");
+}
+
+size_t Applications_GetUserModeMemoryUsageInKB(void) {
+	return ProcStatusKB("VmRSS");
+}
+
+size_t Applications_GetPeakUserModeMemoryUsageInKB(void) {
+	return ProcStatusKB("VmHWM");
+}
+
+struct SysEvent_Info {
+	SysEvent_Info_UpdateData update;
+};
+
+// one registration, standing in for the OS's, the callback runs straight from sim_raiseUpdateEvent
+static char _sysEventRegistration;
+static SysEventsCallback* _sysEventCallback = NULL;
+static void* _sysEventContext = NULL;
+static SysEvent_Events _sysEventMask = SysEvent_Events_None;
+static SIM_UPDATE_STATS _simUpdateStats;
+
+EventRegistration* SysEvent_RegisterForEventNotifications(EventLoop* el, SysEvent_Events eventBitmask, SysEventsCallback callback, void* context) {
+	if (el == NULL || callback == NULL || _sysEventCallback != NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	_sysEventCallback = callback;
+	_sysEventContext = context;
+	_sysEventMask = eventBitmask;
+	return (EventRegistration*)&_sysEventRegistration;
+}
+
+int SysEvent_UnregisterForEventNotifications(EventRegistration* reg) {
+	if (reg != (EventRegistration*)&_sysEventRegistration || _sysEventCallback == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	_sysEventCallback = NULL;
+	return 0;
+}
+
+int SysEvent_DeferEvent(SysEvent_Events event, uint32_t requested_defer_time_in_minutes) {
+	if (event != SysEvent_Events_UpdateReadyForInstall) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	_simUpdateStats.deferrals++;
+	_simUpdateStats.deferredMinutes += requested_defer_time_in_minutes;
+	return 0;
+}
+
+int SysEvent_ResumeEvent(SysEvent_Events event) {
+	if (event != SysEvent_Events_UpdateReadyForInstall) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	_simUpdateStats.resumes++;
+	return 0;
+}
+
+int SysEvent_Info_GetUpdateData(const SysEvent_Info* info, SysEvent_Info_UpdateData* update_info) {
+	if (info == NULL || update_info == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	*update_info = info->update;
+	return 0;
+}
+
+bool sim_raiseUpdateEvent(unsigned int status, unsigned int maxDeferralMinutes) {
+	SysEvent_Info info = { { maxDeferralMinutes, SysEvent_UpdateType_App } };
+
+	if (_sysEventCallback == NULL || (_sysEventMask & SysEvent_Events_UpdateReadyForInstall) == 0) {
+		return false;
+	}
+
+	_sysEventCallback(SysEvent_Events_UpdateReadyForInstall, (SysEvent_Status)status, &info, _sysEventContext);
+	return true;
+}
+
+void sim_getUpdateStats(SIM_UPDATE_STATS* stats) {
+	*stats = _simUpdateStats;
+}
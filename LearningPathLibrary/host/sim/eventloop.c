@@ -0,0 +1,202 @@
+#include <applibs/eventloop.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SIM_EVENTS_PER_WAIT 16
+
+struct EventRegistration {
+	int fd;
+	EventLoopIoCallback* callback;
+	void* context;
+	EventRegistration* next;
+	bool removed;		// unregistered during dispatch, freed once the dispatch returns
+};
+
+struct EventLoop {
+	int epollFd;
+	bool stopped;
+	int dispatching;
+	EventRegistration* registrations;
+};
+
+static uint32_t ToEpoll(EventLoop_IoEvents events) {
+	return ((events & EventLoop_Input) ? EPOLLIN : 0) | ((events & EventLoop_Output) ? EPOLLOUT : 0);
+}
+
+static EventLoop_IoEvents FromEpoll(uint32_t events) {
+	return ((events & EPOLLIN) ? EventLoop_Input : 0) | ((events & EPOLLOUT) ? EventLoop_Output : 0) |
+		((events & (EPOLLERR | EPOLLHUP)) ? EventLoop_Error : 0);
+}
+
+static int64_t NowMs(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static void FreeRemoved(EventLoop* el) {
+	EventRegistration** link = &el->registrations;
+
+	while (*link != NULL) {
+		EventRegistration* reg = *link;
+		if (reg->removed) {
+			*link = reg->next;
+			free(reg);
+		} else {
+			link = &reg->next;
+		}
+	}
+}
+
+EventLoop* EventLoop_Create(void) {
+	EventLoop* el = calloc(1, sizeof(EventLoop));
+
+	if (el == NULL) {
+		return NULL;
+	}
+
+	if ((el->epollFd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+		free(el);
+		return NULL;
+	}
+
+	return el;
+}
+
+void EventLoop_Close(EventLoop* el) {
+	if (el == NULL) {
+		return;
+	}
+
+	while (el->registrations != NULL) {
+		EventRegistration* next = el->registrations->next;
+		free(el->registrations);
+		el->registrations = next;
+	}
+
+	close(el->epollFd);
+	free(el);
+}
+
+/// <summary>
+///     Waits up to duration ms, -1 for ever, dispatching ready descriptors until stopped, or after the
+///     first dispatch when process_one_event is set
+/// </summary>
+EventLoop_Run_Result EventLoop_Run(EventLoop* el, int duration_in_milliseconds, bool process_one_event) {
+	struct epoll_event events[SIM_EVENTS_PER_WAIT];
+	int64_t deadline = duration_in_milliseconds < 0 ? 0 : NowMs() + duration_in_milliseconds;
+	bool dispatched = false;
+
+	if (el == NULL) {
+		errno = EINVAL;
+		return EventLoop_Run_Failed;
+	}
+
+	el->stopped = false;
+
+	while (!el->stopped) {
+		int timeout = duration_in_milliseconds < 0 ? -1 : (int)(deadline - NowMs());
+		int count;
+
+		if (timeout < 0 && duration_in_milliseconds >= 0) {
+			timeout = 0;
+		}
+
+		// as on the device a signal ends the run with EINTR, the caller checks its terminate flag
+		if ((count = epoll_wait(el->epollFd, events, SIM_EVENTS_PER_WAIT, timeout)) == -1) {
+			return EventLoop_Run_Failed;
+		}
+
+		el->dispatching++;
+		for (int i = 0; i < count; i++) {
+			EventRegistration* reg = events[i].data.ptr;
+			if (!reg->removed) {
+				reg->callback(el, reg->fd, FromEpoll(events[i].events), reg->context);
+				dispatched = true;
+			}
+		}
+		if (--el->dispatching == 0) {
+			FreeRemoved(el);
+		}
+
+		if ((process_one_event && dispatched) || (count == 0 && timeout == 0)) {
+			break;
+		}
+	}
+
+	return dispatched ? EventLoop_Run_Finished : EventLoop_Run_FinishedEmpty;
+}
+
+int EventLoop_Stop(EventLoop* el) {
+	if (el == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+	el->stopped = true;
+	return 0;
+}
+
+int EventLoop_GetWaitDescriptor(EventLoop* el) {
+	return el == NULL ? -1 : el->epollFd;
+}
+
+EventRegistration* EventLoop_RegisterIo(EventLoop* el, int fd, EventLoop_IoEvents eventBitmask, EventLoopIoCallback* callback, void* context) {
+	EventRegistration* reg;
+	struct epoll_event event;
+
+	if (el == NULL || callback == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	if ((reg = calloc(1, sizeof(EventRegistration))) == NULL) {
+		return NULL;
+	}
+
+	reg->fd = fd;
+	reg->callback = callback;
+	reg->context = context;
+
+	event.events = ToEpoll(eventBitmask);
+	event.data.ptr = reg;
+
+	if (epoll_ctl(el->epollFd, EPOLL_CTL_ADD, fd, &event) == -1) {
+		free(reg);
+		return NULL;
+	}
+
+	reg->next = el->registrations;
+	el->registrations = reg;
+
+	return reg;
+}
+
+int EventLoop_ModifyIoEvents(EventLoop* el, EventRegistration* reg, EventLoop_IoEvents eventBitmask) {
+	struct epoll_event event = { .events = ToEpoll(eventBitmask), .data.ptr = reg };
+
+	if (el == NULL || reg == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return epoll_ctl(el->epollFd, EPOLL_CTL_MOD, reg->fd, &event);
+}
+
+int EventLoop_UnregisterIo(EventLoop* el, EventRegistration* reg) {
+	if (el == NULL || reg == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	epoll_ctl(el->epollFd, EPOLL_CTL_DEL, reg->fd, NULL);
+	reg->removed = true;
+
+	if (el->dispatching == 0) {
+		FreeRemoved(el);
+	}
+
+	return 0;
+}
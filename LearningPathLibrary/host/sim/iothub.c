@@ -0,0 +1,627 @@
+#include "sim.h"
+#include <azure_prov_client/prov_device_ll_client.h>
+#include <azure_prov_client/prov_security_factory.h>
+#include <azure_prov_client/prov_transport_mqtt_client.h>
+#include <azure_sphere_provisioning.h>
+#include <iothub_client_core_ll.h>
+#include <iothubtransportmqtt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_PENDING_CONFIRMATIONS 64
+#define SIM_PENDING_METHODS 8
+#define SIM_REPORTED_STATUS 204		// the status IoT Hub answers an accepted reported state with
+#define SIM_FREE_MESSAGES 16		// destroyed messages kept for reuse, the simulation allocates nothing per message once warm
+#define SIM_MESSAGE_ROUNDING 256	// message capacities round up, a payload a few bytes longer still fits a recycled one
+
+typedef struct {
+	IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK messageCallback;
+	IOTHUB_CLIENT_REPORTED_STATE_CALLBACK reportedCallback;
+	void* context;
+} SIM_CONFIRMATION;
+
+struct IOTHUB_CLIENT_CORE_LL_HANDLE_DATA_TAG {
+	bool authenticated;
+	bool disconnectPending;
+	IOTHUB_CLIENT_CONNECTION_STATUS_REASON disconnectReason;
+	IOTHUB_CLIENT_CONNECTION_STATUS_CALLBACK connectionCallback;
+	void* connectionContext;
+	IOTHUB_CLIENT_DEVICE_TWIN_CALLBACK twinCallback;
+	void* twinContext;
+	IOTHUB_CLIENT_DEVICE_METHOD_CALLBACK_ASYNC methodCallback;
+	IOTHUB_CLIENT_INBOUND_DEVICE_METHOD_CALLBACK inboundMethodCallback;
+	void* methodContext;
+	IOTHUB_CLIENT_MESSAGE_CALLBACK_ASYNC messageCallback;
+	void* messageContext;
+	SIM_CONFIRMATION confirmations[SIM_PENDING_CONFIRMATIONS];
+	size_t confirmationCount;
+};
+
+struct IOTHUB_MESSAGE_HANDLE_DATA_TAG {
+	size_t size;
+	size_t capacity;
+	IOTHUB_MESSAGE_HANDLE next;		// on the free list
+	size_t propertyCount;
+	char properties[SIM_MESSAGE_PROPERTIES][2][SIM_PROPERTY_SIZE];		// key and value, truncated
+	unsigned char bytes[];
+};
+
+struct IOTHUB_CLIENT_LL_AZURE_STORAGE_CLIENT_HANDLE_DATA_TAG {
+	uint32_t nextBlock;
+};
+
+struct PROV_INSTANCE_INFO_TAG {
+	PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK registerCallback;
+	void* registerContext;
+};
+
+// invocations waiting on IoTHubDeviceClient_LL_DeviceMethodResponse, the method handle is the slot
+static SIM_METHOD_RESULT* _pendingMethods[SIM_PENDING_METHODS];
+
+static IOTHUB_DEVICE_CLIENT_LL_HANDLE _client = NULL;
+static char* _twinDocument = NULL;
+static char* _lastReported = NULL;
+static size_t _lastReportedCapacity = 0;
+static SIM_HUB_STATS _stats;
+static unsigned int _failBlobBlocks = 0;
+static unsigned int _refuseReportedStates = 0;
+static int _refusedReportedStatus = 0;
+
+static int _transport;		// address only, stands in for the MQTT transport provider
+
+const void* MQTT_Protocol(void) {
+	return &_transport;
+}
+
+const void* Prov_Device_MQTT_Protocol(void) {
+	return &_transport;
+}
+
+static IOTHUB_DEVICE_CLIENT_LL_HANDLE CreateClient(void) {
+	if (_client != NULL) {
+		return NULL;	// the library holds one client at a time
+	}
+	return _client = calloc(1, sizeof(struct IOTHUB_CLIENT_CORE_LL_HANDLE_DATA_TAG));
+}
+
+IOTHUB_DEVICE_CLIENT_LL_HANDLE IoTHubDeviceClient_LL_CreateFromConnectionString(const char* connectionString, IOTHUB_CLIENT_TRANSPORT_PROVIDER protocol) {
+	return connectionString == NULL || protocol == NULL ? NULL : CreateClient();
+}
+
+IOTHUB_DEVICE_CLIENT_LL_HANDLE IoTHubDeviceClient_LL_CreateWithAzureSphereFromDeviceAuth(const char* iothub_uri, IOTHUB_CLIENT_TRANSPORT_PROVIDER protocol) {
+	return iothub_uri == NULL || protocol == NULL ? NULL : CreateClient();
+}
+
+void IoTHubDeviceClient_LL_Destroy(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle) {
+	if (iotHubClientHandle == NULL) {
+		return;
+	}
+
+	// as the SDK, outstanding sends are confirmed as destroyed
+	for (size_t i = 0; i < iotHubClientHandle->confirmationCount; i++) {
+		SIM_CONFIRMATION* confirmation = &iotHubClientHandle->confirmations[i];
+		if (confirmation->messageCallback != NULL) {
+			confirmation->messageCallback(IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, confirmation->context);
+		}
+	}
+
+	memset(_pendingMethods, 0, sizeof(_pendingMethods));
+
+	if (_client == iotHubClientHandle) {
+		_client = NULL;
+	}
+	free(iotHubClientHandle);
+}
+
+/// <summary>
+///     Authenticates on the first call and delivers the full twin, then confirms everything sent since the last call
+/// </summary>
+void IoTHubDeviceClient_LL_DoWork(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle) {
+	SIM_CONFIRMATION confirmations[SIM_PENDING_CONFIRMATIONS];
+	size_t count;
+
+	if (iotHubClientHandle == NULL) {
+		return;
+	}
+
+	_stats.doWorkCalls++;
+
+	if (iotHubClientHandle->disconnectPending) {
+		iotHubClientHandle->disconnectPending = false;
+		iotHubClientHandle->authenticated = false;
+		if (iotHubClientHandle->connectionCallback != NULL) {
+			iotHubClientHandle->connectionCallback(IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED, iotHubClientHandle->disconnectReason, iotHubClientHandle->connectionContext);
+		}
+		return;
+	}
+
+	if (!iotHubClientHandle->authenticated) {
+		iotHubClientHandle->authenticated = true;
+		if (iotHubClientHandle->connectionCallback != NULL) {
+			iotHubClientHandle->connectionCallback(IOTHUB_CLIENT_CONNECTION_AUTHENTICATED, IOTHUB_CLIENT_CONNECTION_OK, iotHubClientHandle->connectionContext);
+		}
+		if (_twinDocument != NULL && iotHubClientHandle->twinCallback != NULL) {
+			iotHubClientHandle->twinCallback(DEVICE_TWIN_UPDATE_COMPLETE, (const unsigned char*)_twinDocument, strlen(_twinDocument), iotHubClientHandle->twinContext);
+		}
+	}
+
+	// callbacks may send again, those are confirmed on the next call
+	count = iotHubClientHandle->confirmationCount;
+	memcpy(confirmations, iotHubClientHandle->confirmations, count * sizeof(SIM_CONFIRMATION));
+	iotHubClientHandle->confirmationCount = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		if (confirmations[i].messageCallback != NULL) {
+			confirmations[i].messageCallback(IOTHUB_CLIENT_CONFIRMATION_OK, confirmations[i].context);
+		} else if (confirmations[i].reportedCallback != NULL) {
+			int status = SIM_REPORTED_STATUS;
+			if (_refuseReportedStates > 0) {
+				_refuseReportedStates--;
+				status = _refusedReportedStatus;
+			}
+			confirmations[i].reportedCallback(status, confirmations[i].context);
+		}
+	}
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_SetOption(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, const char* optionName, const void* value) {
+	return iotHubClientHandle == NULL || optionName == NULL ? IOTHUB_CLIENT_INVALID_ARG : IOTHUB_CLIENT_OK;
+}
+
+static IOTHUB_CLIENT_RESULT QueueConfirmation(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, SIM_CONFIRMATION confirmation) {
+	if (iotHubClientHandle->confirmationCount == SIM_PENDING_CONFIRMATIONS) {
+		return IOTHUB_CLIENT_ERROR;
+	}
+	iotHubClientHandle->confirmations[iotHubClientHandle->confirmationCount++] = confirmation;
+	return IOTHUB_CLIENT_OK;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_SendEventAsync(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_MESSAGE_HANDLE eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback) {
+	if (iotHubClientHandle == NULL || eventMessageHandle == NULL) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+
+	if (QueueConfirmation(iotHubClientHandle, (SIM_CONFIRMATION){ .messageCallback = eventConfirmationCallback, .context = userContextCallback }) != IOTHUB_CLIENT_OK) {
+		return IOTHUB_CLIENT_ERROR;
+	}
+
+	_stats.messagesSent++;
+	_stats.messageBytes += eventMessageHandle->size;
+	return IOTHUB_CLIENT_OK;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_GetSendStatus(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_STATUS* iotHubClientStatus) {
+	if (iotHubClientHandle == NULL || iotHubClientStatus == NULL) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+	*iotHubClientStatus = iotHubClientHandle->confirmationCount > 0 ? IOTHUB_CLIENT_SEND_STATUS_BUSY : IOTHUB_CLIENT_SEND_STATUS_IDLE;
+	return IOTHUB_CLIENT_OK;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_SetConnectionStatusCallback(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_CONNECTION_STATUS_CALLBACK connectionStatusCallback, void* userContextCallback) {
+	if (iotHubClientHandle == NULL) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+	iotHubClientHandle->connectionCallback = connectionStatusCallback;
+	iotHubClientHandle->connectionContext = userContextCallback;
+	return IOTHUB_CLIENT_OK;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_SetDeviceTwinCallback(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_DEVICE_TWIN_CALLBACK deviceTwinCallback, void* userContextCallback) {
+	if (iotHubClientHandle == NULL) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+	iotHubClientHandle->twinCallback = deviceTwinCallback;
+	iotHubClientHandle->twinContext = userContextCallback;
+	return IOTHUB_CLIENT_OK;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_SendReportedState(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, const unsigned char* reportedState, size_t size, IOTHUB_CLIENT_REPORTED_STATE_CALLBACK reportedStateCallback, void* userContextCallback) {
+	if (iotHubClientHandle == NULL || reportedState == NULL || size == 0) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+
+	if (size + 1 > _lastReportedCapacity) {
+		char* grown = realloc(_lastReported, size + 1);
+		if (grown == NULL) {
+			return IOTHUB_CLIENT_ERROR;
+		}
+		_lastReported = grown;
+		_lastReportedCapacity = size + 1;
+	}
+
+	if (QueueConfirmation(iotHubClientHandle, (SIM_CONFIRMATION){ .reportedCallback = reportedStateCallback, .context = userContextCallback }) != IOTHUB_CLIENT_OK) {
+		return IOTHUB_CLIENT_ERROR;
+	}
+
+	memcpy(_lastReported, reportedState, size);
+	_lastReported[size] = 0;
+
+	_stats.reportedStatesSent++;
+	_stats.reportedStateBytes += size;
+	return IOTHUB_CLIENT_OK;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_SetDeviceMethodCallback(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_DEVICE_METHOD_CALLBACK_ASYNC deviceMethodCallback, void* userContextCallback) {
+	if (iotHubClientHandle == NULL) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+	iotHubClientHandle->methodCallback = deviceMethodCallback;
+	iotHubClientHandle->inboundMethodCallback = NULL;
+	iotHubClientHandle->methodContext = userContextCallback;
+	return IOTHUB_CLIENT_OK;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_SetDeviceMethodCallback_Ex(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_INBOUND_DEVICE_METHOD_CALLBACK inboundDeviceMethodCallback, void* userContextCallback) {
+	if (iotHubClientHandle == NULL) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+	iotHubClientHandle->inboundMethodCallback = inboundDeviceMethodCallback;
+	iotHubClientHandle->methodCallback = NULL;
+	iotHubClientHandle->methodContext = userContextCallback;
+	return IOTHUB_CLIENT_OK;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_SetMessageCallback(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_MESSAGE_CALLBACK_ASYNC messageCallback, void* userContextCallback) {
+	if (iotHubClientHandle == NULL) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+	iotHubClientHandle->messageCallback = messageCallback;
+	iotHubClientHandle->messageContext = userContextCallback;
+	return IOTHUB_CLIENT_OK;
+}
+
+static void RecordMethodResponse(SIM_METHOD_RESULT* result, const unsigned char* response, size_t respSize, int statusCode) {
+	size_t kept = respSize < SIM_METHOD_RESPONSE_SIZE - 1 ? respSize : SIM_METHOD_RESPONSE_SIZE - 1;
+
+	result->responded = true;
+	result->status = statusCode;
+	result->responseSize = respSize;
+	if (response != NULL) {
+		memcpy(result->response, response, kept);
+	}
+	result->response[response != NULL ? kept : 0] = 0;
+
+	_stats.methodResponses++;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_DeviceMethodResponse(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, METHOD_HANDLE methodId, const unsigned char* response, size_t respSize, int statusCode) {
+	uintptr_t slot = (uintptr_t)methodId - 1;
+
+	if (iotHubClientHandle == NULL || slot >= SIM_PENDING_METHODS || _pendingMethods[slot] == NULL) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+
+	RecordMethodResponse(_pendingMethods[slot], response, respSize, statusCode);
+	_pendingMethods[slot] = NULL;
+	return IOTHUB_CLIENT_OK;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_AzureStorageInitializeBlobUpload(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, const char* destinationFileName, char** uploadCorrelationId, char** azureBlobSasUri) {
+	char uri[256];
+
+	if (iotHubClientHandle == NULL || !iotHubClientHandle->authenticated || destinationFileName == NULL) {
+		return IOTHUB_CLIENT_ERROR;
+	}
+
+	snprintf(uri, sizeof(uri), "https://sim.blob.core.windows.net/sim/%s?sig=sim", destinationFileName);
+	*uploadCorrelationId = strdup("sim-correlation");
+	*azureBlobSasUri = strdup(uri);
+
+	return IOTHUB_CLIENT_OK;
+}
+
+IOTHUB_CLIENT_LL_AZURE_STORAGE_CLIENT_HANDLE IoTHubDeviceClient_LL_AzureStorageCreateClient(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, const char* azureBlobSasUri) {
+	return iotHubClientHandle == NULL || azureBlobSasUri == NULL ? NULL : calloc(1, sizeof(struct IOTHUB_CLIENT_LL_AZURE_STORAGE_CLIENT_HANDLE_DATA_TAG));
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_AzureStoragePutBlock(IOTHUB_CLIENT_LL_AZURE_STORAGE_CLIENT_HANDLE azureStorageClientHandle, uint32_t blockNumber, const uint8_t* dataPtr, size_t dataSize) {
+	if (azureStorageClientHandle == NULL || dataPtr == NULL || dataSize == 0) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+
+	if (_failBlobBlocks > 0) {
+		_failBlobBlocks--;
+		return IOTHUB_CLIENT_ERROR;
+	}
+
+	// blocks are put in order or repeated after a failure, never skipped
+	if (blockNumber > azureStorageClientHandle->nextBlock) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+
+	azureStorageClientHandle->nextBlock = blockNumber + 1;
+	_stats.blobBlocks++;
+	_stats.blobBytes += dataSize;
+
+	return IOTHUB_CLIENT_OK;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_AzureStoragePutBlockList(IOTHUB_CLIENT_LL_AZURE_STORAGE_CLIENT_HANDLE azureStorageClientHandle) {
+	if (azureStorageClientHandle == NULL) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+
+	_stats.blobsCommitted++;
+	return IOTHUB_CLIENT_OK;
+}
+
+void IoTHubDeviceClient_LL_AzureStorageDestroyClient(IOTHUB_CLIENT_LL_AZURE_STORAGE_CLIENT_HANDLE azureStorageClientHandle) {
+	free(azureStorageClientHandle);
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_AzureStorageNotifyBlobUploadCompletion(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, const char* uploadCorrelationId, bool isSuccess, int responseCode, const char* responseMessage) {
+	if (iotHubClientHandle == NULL || uploadCorrelationId == NULL) {
+		return IOTHUB_CLIENT_INVALID_ARG;
+	}
+
+	_stats.blobsNotified++;
+	if (!isSuccess) {
+		_stats.blobsFailed++;
+	}
+	return IOTHUB_CLIENT_OK;
+}
+
+// the real SDK allocates every message, these are recycled so the steady state soak sees the library's allocations only
+static IOTHUB_MESSAGE_HANDLE _freeMessages = NULL;
+static size_t _freeMessageCount = 0;
+
+static IOTHUB_MESSAGE_HANDLE TakeFreeMessage(size_t size) {
+	for (IOTHUB_MESSAGE_HANDLE* link = &_freeMessages; *link != NULL; link = &(*link)->next) {
+		IOTHUB_MESSAGE_HANDLE message = *link;
+
+		if (message->capacity >= size) {
+			*link = message->next;
+			_freeMessageCount--;
+			return message;
+		}
+	}
+	return NULL;
+}
+
+IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromByteArray(const unsigned char* byteArray, size_t size) {
+	IOTHUB_MESSAGE_HANDLE message;
+
+	if (byteArray == NULL && size > 0) {
+		return NULL;
+	}
+
+	if ((message = TakeFreeMessage(size)) == NULL) {
+		size_t capacity = (size + SIM_MESSAGE_ROUNDING) & ~(size_t)(SIM_MESSAGE_ROUNDING - 1);
+
+		if ((message = malloc(sizeof(*message) + capacity)) == NULL) {
+			return NULL;
+		}
+		message->capacity = capacity - 1;
+	}
+
+	message->size = size;
+	message->propertyCount = 0;
+	if (size > 0) {
+		memcpy(message->bytes, byteArray, size);
+	}
+	message->bytes[size] = 0;
+
+	return message;
+}
+
+IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromString(const char* source) {
+	return source == NULL ? NULL : IoTHubMessage_CreateFromByteArray((const unsigned char*)source, strlen(source));
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_GetByteArray(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const unsigned char** buffer, size_t* size) {
+	if (iotHubMessageHandle == NULL || buffer == NULL || size == NULL) {
+		return IOTHUB_MESSAGE_INVALID_ARG;
+	}
+	*buffer = iotHubMessageHandle->bytes;
+	*size = iotHubMessageHandle->size;
+	return IOTHUB_MESSAGE_OK;
+}
+
+static char (*FindProperty(IOTHUB_MESSAGE_HANDLE message, const char* key))[SIM_PROPERTY_SIZE] {
+	for (size_t i = 0; i < message->propertyCount; i++) {
+		if (strncmp(message->properties[i][0], key, SIM_PROPERTY_SIZE - 1) == 0) {
+			return message->properties[i];
+		}
+	}
+	return NULL;
+}
+
+/// <summary>
+///     Kept for IoTHubMessage_GetProperty, a key already set is replaced and properties past SIM_MESSAGE_PROPERTIES are dropped
+/// </summary>
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetProperty(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* key, const char* value) {
+	char (*property)[SIM_PROPERTY_SIZE];
+
+	if (iotHubMessageHandle == NULL || key == NULL || value == NULL) {
+		return IOTHUB_MESSAGE_INVALID_ARG;
+	}
+
+	if ((property = FindProperty(iotHubMessageHandle, key)) == NULL) {
+		if (iotHubMessageHandle->propertyCount == SIM_MESSAGE_PROPERTIES) {
+			return IOTHUB_MESSAGE_OK;
+		}
+		property = iotHubMessageHandle->properties[iotHubMessageHandle->propertyCount++];
+		snprintf(property[0], SIM_PROPERTY_SIZE, "%s", key);
+	}
+	snprintf(property[1], SIM_PROPERTY_SIZE, "%s", value);
+
+	return IOTHUB_MESSAGE_OK;
+}
+
+const char* IoTHubMessage_GetProperty(IOTHUB_MESSAGE_HANDLE msgHandle, const char* key) {
+	char (*property)[SIM_PROPERTY_SIZE];
+
+	if (msgHandle == NULL || key == NULL || (property = FindProperty(msgHandle, key)) == NULL) {
+		return NULL;
+	}
+	return property[1];
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetContentTypeSystemProperty(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* contentType) {
+	return iotHubMessageHandle == NULL || contentType == NULL ? IOTHUB_MESSAGE_INVALID_ARG : IOTHUB_MESSAGE_OK;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetContentEncodingSystemProperty(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* contentEncoding) {
+	return iotHubMessageHandle == NULL || contentEncoding == NULL ? IOTHUB_MESSAGE_INVALID_ARG : IOTHUB_MESSAGE_OK;
+}
+
+void IoTHubMessage_Destroy(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle) {
+	if (iotHubMessageHandle != NULL && _freeMessageCount < SIM_FREE_MESSAGES) {
+		iotHubMessageHandle->next = _freeMessages;
+		_freeMessages = iotHubMessageHandle;
+		_freeMessageCount++;
+		return;
+	}
+	free(iotHubMessageHandle);
+}
+
+int prov_dev_security_init(SECURE_DEVICE_TYPE hsm_type) {
+	return 0;
+}
+
+PROV_DEVICE_LL_HANDLE Prov_Device_LL_Create(const char* uri, const char* scope_id, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol) {
+	return uri == NULL || protocol == NULL ? NULL : calloc(1, sizeof(struct PROV_INSTANCE_INFO_TAG));
+}
+
+void Prov_Device_LL_Destroy(PROV_DEVICE_LL_HANDLE handle) {
+	free(handle);
+}
+
+PROV_DEVICE_RESULT Prov_Device_LL_Register_Device(PROV_DEVICE_LL_HANDLE handle, PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK register_callback, void* user_context, PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK reg_status_cb, void* status_user_ctext) {
+	if (handle == NULL || register_callback == NULL) {
+		return PROV_DEVICE_RESULT_INVALID_ARG;
+	}
+	handle->registerCallback = register_callback;
+	handle->registerContext = user_context;
+	return PROV_DEVICE_RESULT_OK;
+}
+
+void Prov_Device_LL_DoWork(PROV_DEVICE_LL_HANDLE handle) {
+	if (handle != NULL && handle->registerCallback != NULL) {
+		PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK callback = handle->registerCallback;
+		handle->registerCallback = NULL;
+		callback(PROV_DEVICE_RESULT_OK, SIM_HUB_HOSTNAME, "sim", handle->registerContext);
+	}
+}
+
+PROV_DEVICE_RESULT Prov_Device_LL_SetOption(PROV_DEVICE_LL_HANDLE handle, const char* optionName, const void* value) {
+	return handle == NULL || optionName == NULL ? PROV_DEVICE_RESULT_INVALID_ARG : PROV_DEVICE_RESULT_OK;
+}
+
+void sim_hubSetTwinDocument(const char* json) {
+	free(_twinDocument);
+	_twinDocument = json == NULL ? NULL : strdup(json);
+}
+
+void sim_hubDisconnect(IOTHUB_CLIENT_CONNECTION_STATUS_REASON reason) {
+	if (_client != NULL) {
+		_client->disconnectPending = true;
+		_client->disconnectReason = reason;
+	}
+}
+
+bool sim_hubIsConnected(void) {
+	return _client != NULL && _client->authenticated;
+}
+
+bool sim_hubDeliverTwin(DEVICE_TWIN_UPDATE_STATE updateState, const unsigned char* payload, size_t payloadSize) {
+	if (_client == NULL || _client->twinCallback == NULL) {
+		return false;
+	}
+	_client->twinCallback(updateState, payload, payloadSize, _client->twinContext);
+	return true;
+}
+
+/// <summary>
+///     The message is built and destroyed around the callback as the SDK does, the client must not keep the body
+/// </summary>
+bool sim_hubDeliverMessage(const unsigned char* payload, size_t payloadSize, const char* const properties[], size_t propertyCount,
+	IOTHUBMESSAGE_DISPOSITION_RESULT* disposition) {
+	IOTHUB_MESSAGE_HANDLE message;
+	IOTHUBMESSAGE_DISPOSITION_RESULT result;
+
+	if (_client == NULL || _client->messageCallback == NULL || (message = IoTHubMessage_CreateFromByteArray(payload, payloadSize)) == NULL) {
+		return false;
+	}
+
+	for (size_t i = 0; i < propertyCount; i++) {
+		IoTHubMessage_SetProperty(message, properties[2 * i], properties[2 * i + 1]);
+	}
+
+	result = _client->messageCallback(message, _client->messageContext);
+	IoTHubMessage_Destroy(message);
+
+	_stats.cloudMessages++;
+	if (result == IOTHUBMESSAGE_REJECTED) {
+		_stats.cloudMessagesRejected++;
+	} else if (result == IOTHUBMESSAGE_ABANDONED) {
+		_stats.cloudMessagesAbandoned++;
+	}
+	if (disposition != NULL) {
+		*disposition = result;
+	}
+	return true;
+}
+
+/// <summary>
+///     Invokes a method as IoT Hub would, result must stay valid until a pending response is sent
+/// </summary>
+bool sim_hubInvokeMethod(const char* methodName, const unsigned char* payload, size_t payloadSize, SIM_METHOD_RESULT* result) {
+	uintptr_t slot;
+
+	if (_client == NULL || result == NULL) {
+		return false;
+	}
+
+	memset(result, 0, sizeof(*result));
+
+	if (_client->methodCallback != NULL) {
+		unsigned char* response = NULL;
+		size_t responseSize = 0;
+		int status = _client->methodCallback(methodName, payload, payloadSize, &response, &responseSize, _client->methodContext);
+
+		RecordMethodResponse(result, response, responseSize, status);
+		free(response);
+		return true;
+	}
+
+	if (_client->inboundMethodCallback == NULL) {
+		return false;
+	}
+
+	for (slot = 0; slot < SIM_PENDING_METHODS && _pendingMethods[slot] != NULL; slot++) {
+	}
+	if (slot == SIM_PENDING_METHODS) {
+		return false;
+	}
+
+	_pendingMethods[slot] = result;
+	if (_client->inboundMethodCallback(methodName, payload, payloadSize, (METHOD_HANDLE)(slot + 1), _client->methodContext) != 0 && !result->responded) {
+		_pendingMethods[slot] = NULL;	// as the SDK, a failed inbound callback answers nothing and the handle is dropped
+		return false;
+	}
+	return true;
+}
+
+const char* sim_hubLastReportedState(void) {
+	return _lastReported != NULL ? _lastReported : "";
+}
+
+void sim_hubGetStats(SIM_HUB_STATS* stats) {
+	*stats = _stats;
+}
+
+void sim_hubResetStats(void) {
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+void sim_hubFailBlobBlocks(unsigned int count) {
+	_failBlobBlocks = count;
+}
+
+void sim_hubRefuseReportedStates(unsigned int count, int status) {
+	_refuseReportedStates = count;
+	_refusedReportedStatus = status;
+}
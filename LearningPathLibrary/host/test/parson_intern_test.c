@@ -0,0 +1,79 @@
+// Interned member names through json_object_clear and json_value_free: a name that is an interned key
+// references the key's own storage and must never reach the free function. Counts every parson
+// allocation so a name freed twice, or a key freed at all, fails the run rather than being missed.
+//
+//   parson_intern_test, exits non-zero on the first failure
+#include "parson.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char _desired[] = "desired";		// writable, as the twin bindings' names in an app are
+static char _value[] = "value";
+static const char* const _keys[] = { _desired, "$version", _value };
+
+static long _live = 0;
+static int _failures = 0;
+
+static void* CountingMalloc(size_t size) {
+	void* ptr = malloc(size);
+
+	if (ptr != NULL) {
+		_live++;
+	}
+	return ptr;
+}
+
+static void CountingFree(void* ptr) {
+	if (ptr == NULL) {
+		return;
+	}
+
+	if (ptr == (void*)_desired || ptr == (void*)_value || ptr == (void*)_keys[1]) {
+		fprintf(stderr, "FAIL: interned key \"%s\" freed\n", (const char*)ptr);
+		_failures++;
+		return;
+	}
+
+	_live--;
+	free(ptr);
+}
+
+static void Check(bool condition, const char* what) {
+	if (!condition) {
+		fprintf(stderr, "FAIL: %s\n", what);
+		_failures++;
+	}
+}
+
+int main(void) {
+	static const char document[] = "{\"desired\":{\"$version\":3,\"value\":{\"value\":1},\"other\":true},\"value\":\"x\"}";
+	JSON_Value* root;
+	JSON_Object* object;
+
+	json_set_allocation_functions(CountingMalloc, CountingFree);
+	Check(json_intern_keys(_keys, sizeof(_keys) / sizeof(_keys[0])) == JSONSuccess, "keys interned");
+
+	// parsed names of interned keys reference the keys, cleared with a plain name among them
+	root = json_parse_string(document);
+	object = json_value_get_object(root);
+	Check(object != NULL, "document parsed");
+	Check(json_object_clear(json_object_get_object(object, "desired")) == JSONSuccess, "parsed object cleared");
+	Check(json_object_get_count(json_object_get_object(object, "desired")) == 0, "cleared object empty");
+
+	// and those added by the key's own pointer, the object reused after the clear
+	Check(json_object_set_number(json_object_get_object(object, "desired"), _keys[1], 4) == JSONSuccess, "member added after clear");
+	Check(json_object_set_string(object, _value, "y") == JSONSuccess, "interned member replaced");
+	Check(json_object_clear(object) == JSONSuccess, "root cleared");
+	Check(json_object_set_boolean(object, _desired, 1) == JSONSuccess, "member added to cleared root");
+	json_value_free(root);
+
+	Check(strcmp(_desired, "desired") == 0 && strcmp(_value, "value") == 0, "interned keys intact");
+	Check(_live == 0, "every allocation freed once");
+
+	if (_failures == 0) {
+		printf("parson_intern_test passed\n");
+	}
+	return _failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
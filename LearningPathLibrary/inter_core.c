@@ -1,109 +1,1380 @@
 #include "inter_core.h"
+#include "event_trace.h"
+
+typedef struct
+{
+	uint16_t sequence; // zero when the slot is free
+	LP_INTER_CORE_CMD cmd;
+	struct timespec sentAt;
+	struct timespec deadline;
+	LP_INTER_CORE_RESPONSE_HANDLER responseHandler;
+} LP_INTER_CORE_REQUEST;
+
+typedef struct
+{
+	int64_t monotonicUs; // CLOCK_MONOTONIC at the midpoint of the sync round trip
+	uint32_t rtUs;		 // the real-time app's clock when it answered
+} LP_INTER_CORE_SYNC_POINT;
+
+struct _lpInterCoreConnection
+{
+	bool open;
+	char *componentId;
+	int sockFd;
+	EventRegistration *socketEventReg;
+	void (*callback)(LP_INTER_CORE_BLOCK *);
+	void (*batchCallback)(LP_INTER_CORE_BLOCK *, size_t);
+	LP_INTER_CORE_LARGE_HANDLER largeHandler;
+	bool awaitingOutput; // the socket was full, the event registration asks for output too
+
+	LP_INTER_CORE_REQUEST pendingRequests[LP_INTER_CORE_MAX_PENDING];
+	uint16_t lastSequence;
+	LP_INTER_CORE_STATS stats;
+	uint64_t roundTripTotalUs;
+	bool remoteCongested;
+	bool remoteReady; // the real-time app answered the handshake
+	int handshakesLeft;
+	unsigned int traceEvery; // requests per latency trace, zero for none
+	unsigned int traceCountdown;
+
+	LP_INTER_CORE_SYNC_POINT syncPoint;	 // the latest sync, stamps are converted from it
+	LP_INTER_CORE_SYNC_POINT driftPoint; // the start of the span the drift is measured over
+	bool synced;
+	bool driftMeasured;
+	double syncDrift; // real-time clock seconds per monotonic second, less one
+	uint32_t syncBestRoundTripUs;
+	int syncTimeoutMs;
+
+	LP_TIMER requestTimeoutTimer; // one-shot, armed for the nearest pending request deadline
+	LP_TIMER timeSyncTimer;		  // period set by lp_interCoreSetTimeSync
+	LP_TIMER handshakeTimer;
+
+	uint8_t largeOut[LP_INTER_CORE_MAX_MESSAGE_SIZE]; // the message being fragmented, copied so the caller's buffer is free
+	LP_IC_FRAGMENTER fragmenter;
+	bool sendingLarge;
+	uint8_t largeMessage; // number of the last fragmented message sent
+	uint8_t largeIn[LP_INTER_CORE_MAX_MESSAGE_SIZE];
+	LP_IC_REASSEMBLY reassembly;
+
+	uint8_t queuedFrame[LP_IC_MAX_FRAME_SIZE]; // lp_interCoreQueue records, sent together once the current callback returns
+	LP_IC_FRAME_WRITER queued;
+
+	int recordFd; // frames read are recorded to it, -1 when not recording
+};
+
+static LP_INTER_CORE_CONNECTION _connections[LP_INTER_CORE_MAX_CONNECTIONS];
+static LP_INTER_CORE_CONNECTION *_defaultConnection = NULL; // the lp_enableInterCoreCommunications connection
+static LP_INTER_CORE_CONNECTION *_responding = NULL;		// whose response handler is running, for the library's own handlers
+static LP_INTER_CORE_LARGE_HANDLER _methodResponseHandler = NULL;	// LP_IC_METHOD_RESPONSE messages, for direct_methods.c
 
 static void SocketEventHandler(EventLoop *el, int fd, EventLoop_IoEvents events, void *context);
-static bool ProcessMsg(void);
-static void (*_interCoreCallback)(LP_INTER_CORE_BLOCK *);
-static char *_rtAppComponentId = NULL;
-static int sockFd = -1;
-static EventRegistration *socketEventReg = NULL;
+static bool ProcessMsg(LP_INTER_CORE_CONNECTION *connection);
+static void SendFragments(LP_INTER_CORE_CONNECTION *connection);
+static void InterCoreRequestTimeoutHandler(EventLoopTimer *eventLoopTimer);
+static void InterCoreTimeSyncHandler(EventLoopTimer *eventLoopTimer);
+static void InterCoreHandshakeHandler(EventLoopTimer *eventLoopTimer);
+static int64_t MonotonicUs(void);
 
-static bool initialise_inter_core_communications(void)
+static bool initialise_inter_core_communications(LP_INTER_CORE_CONNECTION *connection)
 {
-	if (sockFd != -1) // Already initialised
+	if (connection->sockFd != -1) // Already initialised
 	{
 		return true;
 	}
 
-	if (_rtAppComponentId == NULL)
+	if (connection->componentId == NULL)
 	{
 		lp_terminate(ExitCode_MissingRealTimeComponentId);
 		return false;
 	}
 
 	// Open connection to real-time capable application.
-	sockFd = Application_Connect(rtAppComponentId);
-	if (sockFd == -1)
+	connection->sockFd = Application_Connect(connection->componentId);
+	if (connection->sockFd == -1)
 	{
-		Log_Debug("ERROR: Unable to create socket: %d (%s)\n", errno, strerror(errno));
+		LP_LOG(LP_LOG_ERROR, "ERROR: Unable to create socket: %d (%s)\n", errno, strerror(errno));
 		return false;
 	}
 
-	// Set timeout, to handle case where real-time capable application does not respond.
-	static const struct timeval recvTimeout = {.tv_sec = 5, .tv_usec = 0};
-	int result = setsockopt(sockFd, SOL_SOCKET, SO_RCVTIMEO, &recvTimeout, sizeof(recvTimeout));
-	if (result == -1)
+	// Non blocking, each socket event drains every queued message and a silent real-time app never stalls the event loop.
+	int flags = fcntl(connection->sockFd, F_GETFL, 0);
+	if (flags == -1 || fcntl(connection->sockFd, F_SETFL, flags | O_NONBLOCK) == -1)
 	{
-		Log_Debug("ERROR: Unable to set socket timeout: %d (%s)\n", errno, strerror(errno));
+		LP_LOG(LP_LOG_ERROR, "ERROR: Unable to set socket non blocking: %d (%s)\n", errno, strerror(errno));
+		close(connection->sockFd);
+		connection->sockFd = -1;
 		return false;
 	}
 
 	// Register handler for incoming messages from real-time capable application.
-	socketEventReg = EventLoop_RegisterIo(lp_getTimerEventLoop(), sockFd, EventLoop_Input, SocketEventHandler,
-										  /* context */ NULL);
-	if (socketEventReg == NULL)
+	connection->socketEventReg = EventLoop_RegisterIo(lp_getTimerEventLoop(), connection->sockFd, EventLoop_Input, SocketEventHandler, connection);
+	if (connection->socketEventReg == NULL)
 	{
-		Log_Debug("ERROR: Unable to register socket event: %d (%s)\n", errno, strerror(errno));
+		LP_LOG(LP_LOG_ERROR, "ERROR: Unable to register socket event: %d (%s)\n", errno, strerror(errno));
+		close(connection->sockFd);
+		connection->sockFd = -1;
 		return false;
 	}
 
 	return true;
 }
 
+/// <summary>
+///     The connection a library timer belongs to, NULL once it has been closed
+/// </summary>
+static LP_INTER_CORE_CONNECTION *TimerConnection(EventLoopTimer *eventLoopTimer)
+{
+	for (size_t i = 0; i < LP_INTER_CORE_MAX_CONNECTIONS; i++)
+	{
+		LP_INTER_CORE_CONNECTION *connection = &_connections[i];
+
+		if (connection->open &&
+			(connection->requestTimeoutTimer.eventLoopTimer == eventLoopTimer || connection->timeSyncTimer.eventLoopTimer == eventLoopTimer ||
+			 connection->handshakeTimer.eventLoopTimer == eventLoopTimer))
+		{
+			return connection;
+		}
+	}
+
+	return NULL;
+}
+
+/// <summary>
+///     Send one message, encoded as a single record frame. len is unused, the record length follows the command.
+/// </summary>
 bool lp_sendInterCoreMessage(LP_INTER_CORE_BLOCK *control_block, size_t len)
 {
-	initialise_inter_core_communications();
+	return lp_interCoreSend(_defaultConnection, control_block, 1);
+}
+
+bool lp_sendInterCoreBatch(LP_INTER_CORE_BLOCK *control_blocks, size_t count)
+{
+	return lp_interCoreSend(_defaultConnection, control_blocks, count);
+}
 
-	if (sockFd == -1)
+static bool SendFrame(LP_INTER_CORE_CONNECTION *connection, const uint8_t *frame, size_t frameLength, size_t records)
+{
+	uint32_t tracedUs = lp_traceNow();
+	int bytesSent = send(connection->sockFd, frame, frameLength, 0);
+	lp_traceSpan(LP_TRACE_IC_OUT, connection->componentId, tracedUs, (uint32_t)frameLength);
+
+	if (bytesSent == -1)
 	{
-		Log_Debug("Socket not initialized");
+		// EAGAIN when the real-time app is not keeping up, the message is dropped rather than blocking the event loop
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: Unable to send message: %d (%s)\n", errno, strerror(errno));
+		connection->stats.messagesDropped += (uint32_t)records;
 		return false;
 	}
 
-	int bytesSent = send(sockFd, (void *)control_block, len, 0);
-	if (bytesSent == -1)
+	connection->stats.messagesOut += (uint32_t)records;
+
+	return true;
+}
+
+/// <summary>
+///     Send messages as multi-record frames, as few frames as LP_IC_MAX_FRAME_SIZE allows
+/// </summary>
+bool lp_interCoreSend(LP_INTER_CORE_CONNECTION *connection, LP_INTER_CORE_BLOCK *control_blocks, size_t count)
+{
+	uint8_t frame[LP_IC_MAX_FRAME_SIZE];
+	LP_IC_FRAME_WRITER writer;
+	size_t next = 0;
+
+	if (connection == NULL || !connection->open) // never opened, as for a missing component ID
 	{
-		Log_Debug("ERROR: Unable to send message: %d (%s)\n", errno, strerror(errno));
+		lp_terminate(ExitCode_MissingRealTimeComponentId);
+		return false;
+	}
+
+	initialise_inter_core_communications(connection);
+
+	if (connection->sockFd == -1)
+	{
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "Socket not initialized");
+		connection->stats.messagesDropped += (uint32_t)count;
 		return false;
 	}
 
+	while (next < count)
+	{
+		size_t first = next;
+
+		lp_icFrameBegin(&writer, frame, sizeof(frame));
+		while (next < count && lp_icFrameAppend(&writer, &control_blocks[next]))
+		{
+			next++;
+		}
+
+		size_t frameLength = lp_icFrameEnd(&writer);
+		if (frameLength == 0)
+		{
+			LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: Unable to encode inter-core message\n");
+			connection->stats.messagesDropped += (uint32_t)(count - next);
+			return false;
+		}
+
+		if (!SendFrame(connection, frame, frameLength, next - first))
+		{
+			connection->stats.messagesDropped += (uint32_t)(count - next);
+			return false;
+		}
+	}
+
 	return true;
 }
 
-int lp_enableInterCoreCommunications(char *rtAppComponentId, void (*interCoreCallback)(LP_INTER_CORE_BLOCK *))
+/// <summary>
+///     A setting's bytes after the record header that say which setting it is, a poll or rule number, -1 for commands
+///     that are not settings. A later value of the same setting replaces a queued one rather than following it.
+/// </summary>
+static int SettingKeySize(LP_INTER_CORE_CMD cmd)
+{
+	switch (cmd)
+	{
+	case LP_IC_SET_DESIRED_TEMPERATURE:
+	case LP_IC_BLINK_RATE:
+	case LP_IC_LED_PATTERN:
+	case LP_IC_PROFILE_REQUEST:
+	case LP_IC_AUDIO_CAPTURE:
+	case LP_IC_THERMOSTAT:
+		return 0;
+	case LP_IC_TELEMETRY_WINDOW: // telemetryChannel
+	case LP_IC_RULE:			 // ruleId
+	case LP_IC_MODBUS_POLL:		 // modbusPoll
+		return 1;
+	default:
+		return -1;
+	}
+}
+
+/// <summary>
+///     Overwrite the queued record of the same setting with record, false when there is none
+/// </summary>
+static bool ReplaceQueuedSetting(LP_INTER_CORE_CONNECTION *connection, const uint8_t *record, size_t recordSize, int keySize)
+{
+	size_t offset = LP_IC_FRAME_HEADER_SIZE;
+
+	while (offset + LP_IC_RECORD_HEADER_SIZE <= connection->queued.length)
+	{
+		uint8_t *queued = connection->queuedFrame + offset;
+
+		// same command, unsequenced, and same length so the trailers match too
+		if (queued[0] == record[0] && queued[1] == record[1] &&
+			memcmp(queued + LP_IC_RECORD_HEADER_SIZE, record + LP_IC_RECORD_HEADER_SIZE, (size_t)keySize) == 0)
+		{
+			memcpy(queued, record, recordSize);
+			return true;
+		}
+
+		offset += LP_IC_RECORD_HEADER_SIZE + queued[1];
+	}
+
+	return false;
+}
+
+static void FlushQueued(LP_INTER_CORE_CONNECTION *connection)
+{
+	size_t frameLength = lp_icFrameEnd(&connection->queued);
+	size_t records = frameLength == 0 ? 0 : connection->queuedFrame[1];
+
+	if (records > 0)
+	{
+		initialise_inter_core_communications(connection);
+
+		if (connection->sockFd == -1)
+		{
+			LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "Socket not initialized");
+			connection->stats.messagesDropped += (uint32_t)records;
+		}
+		else
+		{
+			SendFrame(connection, connection->queuedFrame, frameLength, records);
+		}
+	}
+
+	lp_icFrameBegin(&connection->queued, connection->queuedFrame, sizeof(connection->queuedFrame));
+}
+
+static void FlushQueuedWork(void *context)
 {
-	_interCoreCallback = interCoreCallback;
-	_rtAppComponentId = rtAppComponentId;
+	LP_INTER_CORE_CONNECTION *connection = context;
 
-	return 0;
+	if (connection->open)
+	{
+		FlushQueued(connection);
+	}
 }
 
 /// <summary>
-///     Handle socket event by reading incoming data from real-time capable application.
+///     Queue a message to go with others queued by the same callback: once it returns they are sent as one frame, so a
+///     device twin update or a timer that sets several things costs the real-time app one wake up rather than one each.
+///     A setting queued again before then replaces the value waiting, only the latest is sent. Requests are not queued,
+///     lp_interCoreSendRequest sends straight away. False when the message cannot be encoded.
 /// </summary>
-static void SocketEventHandler(EventLoop *el, int fd, EventLoop_IoEvents events, void *context)
+bool lp_interCoreQueue(LP_INTER_CORE_CONNECTION *connection, const LP_INTER_CORE_BLOCK *control_block)
 {
-	if (!ProcessMsg())
+	uint8_t record[LP_IC_MAX_FRAME_SIZE];
+	LP_IC_FRAME_WRITER single;
+	int keySize;
+
+	if (connection == NULL || !connection->open)
 	{
-		lp_terminate(ExitCode_InterCoreHandler);
+		lp_terminate(ExitCode_MissingRealTimeComponentId);
+		return false;
+	}
+
+	keySize = control_block->sequence == 0 ? SettingKeySize(control_block->cmd) : -1;
+	if (keySize >= 0)
+	{
+		lp_icFrameBegin(&single, record, sizeof(record));
+		if (!lp_icFrameAppend(&single, control_block))
+		{
+			return false;
+		}
+
+		if (ReplaceQueuedSetting(connection, record + LP_IC_FRAME_HEADER_SIZE, single.length - LP_IC_FRAME_HEADER_SIZE, keySize))
+		{
+			connection->stats.messagesCoalesced++;
+			return true;
+		}
+	}
+
+	if (!lp_icFrameAppend(&connection->queued, control_block))
+	{
+		// the frame is full, it goes now and this message starts the next
+		FlushQueued(connection);
+		if (!lp_icFrameAppend(&connection->queued, control_block))
+		{
+			LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: Unable to encode inter-core message\n");
+			return false;
+		}
+	}
+
+	// the first of the batch schedules the flush, run inline when the deferred work queue is full
+	if (connection->queuedFrame[1] == 1)
+	{
+		lp_deferWork(FlushQueuedWork, connection);
 	}
+
+	return true;
+}
+
+bool lp_queueInterCoreMessage(const LP_INTER_CORE_BLOCK *control_block)
+{
+	return lp_interCoreQueue(_defaultConnection, control_block);
 }
 
 /// <summary>
-///     Handle socket event by reading incoming data from real-time capable application.
+///     Ask for output events only while fragments wait on a full socket, the event loop would spin otherwise
 /// </summary>
-static bool ProcessMsg()
+static void AwaitOutput(LP_INTER_CORE_CONNECTION *connection, bool awaiting)
 {
-	LP_INTER_CORE_BLOCK ic_control_block;
+	if (connection->awaitingOutput != awaiting &&
+		EventLoop_ModifyIoEvents(lp_getTimerEventLoop(), connection->socketEventReg, awaiting ? EventLoop_Input | EventLoop_Output : EventLoop_Input) == 0)
+	{
+		connection->awaitingOutput = awaiting;
+	}
+}
+
+/// <summary>
+///     Write fragments of the message being sent, a frame at a time, until it is done or the socket is full. The rest
+///     follows from the output event as the real-time app reads, so the message streams through the ring rather than
+///     having to fit it.
+/// </summary>
+static void SendFragments(LP_INTER_CORE_CONNECTION *connection)
+{
+	uint8_t frame[LP_IC_MAX_FRAME_SIZE];
+	LP_IC_FRAME_WRITER writer;
+
+	while (connection->sendingLarge)
+	{
+		LP_IC_FRAGMENTER resume = connection->fragmenter;
+
+		lp_icFrameBegin(&writer, frame, sizeof(frame));
+		while (lp_icFrameAppendFragment(&writer, &connection->fragmenter))
+		{
+		}
+
+		if (send(connection->sockFd, frame, lp_icFrameEnd(&writer), 0) == -1)
+		{
+			connection->fragmenter = resume;
+
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				AwaitOutput(connection, true);
+				return;
+			}
+
+			LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: Unable to send message: %d (%s)\n", errno, strerror(errno));
+			connection->stats.messagesDropped++;
+			connection->sendingLarge = false;
+			break;
+		}
+
+		if (lp_icFragmentDone(&connection->fragmenter))
+		{
+			connection->stats.largeMessagesOut++;
+			connection->sendingLarge = false;
+		}
+	}
+
+	AwaitOutput(connection, false);
+}
+
+/// <summary>
+///     Send a message larger than a frame as LP_IC_FRAGMENT records, up to LP_INTER_CORE_MAX_MESSAGE_SIZE bytes of
+///     payload. The payload is copied, fragments go as the socket takes them, the real-time app reassembles the message.
+///     False while the previous one is still being sent, see lp_interCoreIsSendingLarge.
+/// </summary>
+bool lp_interCoreSendLarge(LP_INTER_CORE_CONNECTION *connection, LP_INTER_CORE_CMD cmd, const void *payload, size_t length)
+{
+	if (connection == NULL || !connection->open || connection->sendingLarge || length > sizeof(connection->largeOut) ||
+		(payload == NULL && length > 0))
+	{
+		return false;
+	}
 
-	int bytesReceived = recv(sockFd, (void *)&ic_control_block, sizeof(ic_control_block), 0);
+	initialise_inter_core_communications(connection);
 
-	if (bytesReceived == -1)
+	if (connection->sockFd == -1)
 	{
-		lp_terminate(ExitCode_InterCoreReceiveFailed);
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "Socket not initialized");
+		connection->stats.messagesDropped++;
 		return false;
 	}
 
-	_interCoreCallback(&ic_control_block);
+	if (length > 0)
+	{
+		memcpy(connection->largeOut, payload, length);
+	}
+	lp_icFragmentBegin(&connection->fragmenter, ++connection->largeMessage, cmd, connection->largeOut, length);
+	connection->sendingLarge = true;
 
+	SendFragments(connection);
 	return true;
-}
\ No newline at end of file
+}
+
+bool lp_sendInterCoreLarge(LP_INTER_CORE_CMD cmd, const void *payload, size_t length)
+{
+	return lp_interCoreSendLarge(_defaultConnection, cmd, payload, length);
+}
+
+bool lp_interCoreIsSendingLarge(LP_INTER_CORE_CONNECTION *connection)
+{
+	return connection != NULL && connection->sendingLarge;
+}
+
+void lp_interCoreSetLargeHandler(LP_INTER_CORE_CONNECTION *connection, LP_INTER_CORE_LARGE_HANDLER largeHandler)
+{
+	if (connection != NULL)
+	{
+		connection->largeHandler = largeHandler;
+	}
+}
+
+void lp_setInterCoreLargeHandler(LP_INTER_CORE_LARGE_HANDLER largeHandler)
+{
+	lp_interCoreSetLargeHandler(_defaultConnection, largeHandler);
+}
+
+/// <summary>
+///     LP_IC_METHOD_RESPONSE messages of every connection go to this handler rather than the app's large handler
+/// </summary>
+void lp_setInterCoreMethodResponseHandler(LP_INTER_CORE_LARGE_HANDLER methodResponseHandler)
+{
+	_methodResponseHandler = methodResponseHandler;
+}
+
+/// <summary>
+///     An unsolicited heartbeat, the first frame the real-time app sees carries the component header it answers with
+/// </summary>
+static void SendHandshake(LP_INTER_CORE_CONNECTION *connection)
+{
+	lp_interCoreSend(connection, &(LP_INTER_CORE_BLOCK){.cmd = LP_IC_HEARTBEAT}, 1);
+}
+
+static void InterCoreHandshakeHandler(EventLoopTimer *eventLoopTimer)
+{
+	LP_INTER_CORE_CONNECTION *connection = TimerConnection(eventLoopTimer);
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
+	{
+		lp_terminate(ExitCode_InterCoreHandshakeHandler);
+		return;
+	}
+
+	if (connection == NULL)
+	{
+		return;
+	}
+
+	if (connection->remoteReady || --connection->handshakesLeft <= 0)
+	{
+		if (!connection->remoteReady)
+		{
+			LP_LOG(LP_LOG_WARNING, "WARNING: Real-time app %s did not answer the inter-core handshake\n", connection->componentId);
+		}
+		lp_stopTimer(&connection->handshakeTimer);
+		return;
+	}
+
+	SendHandshake(connection);
+}
+
+/// <summary>
+///     Shutdown hook, write the messages queued on every connection and wait for a fragmented message to finish.
+///     Nothing is persisted, the real-time app runs on and is set up again by the handshake when the app restarts.
+/// </summary>
+static bool InterCoreShutdown(bool final)
+{
+	bool pending = false;
+
+	for (size_t i = 0; i < LP_INTER_CORE_MAX_CONNECTIONS && !final; i++)
+	{
+		LP_INTER_CORE_CONNECTION *connection = &_connections[i];
+
+		if (!connection->open)
+		{
+			continue;
+		}
+		if (connection->queuedFrame[1] > 0)
+		{
+			FlushQueued(connection);
+		}
+		pending = pending || connection->sendingLarge;
+	}
+
+	return pending;
+}
+
+/// <summary>
+///     Connect to one real-time app, each of the two real-time cores may run one. Handshakes with the real-time app
+///     straight away, it holds back what it sampled until the A7 side has written and streams from the handshake on.
+///     The heartbeat is repeated until the real-time app answers, in case it had not taken up the shared buffers yet.
+///     NULL when LP_INTER_CORE_MAX_CONNECTIONS are already open or componentId is already connected.
+/// </summary>
+LP_INTER_CORE_CONNECTION *lp_interCoreOpen(char *componentId, void (*interCoreCallback)(LP_INTER_CORE_BLOCK *))
+{
+	LP_INTER_CORE_CONNECTION *connection = NULL;
+
+	if (componentId == NULL)
+	{
+		return NULL;
+	}
+
+	lp_addShutdownHook(InterCoreShutdown);
+
+	for (size_t i = 0; i < LP_INTER_CORE_MAX_CONNECTIONS; i++)
+	{
+		if (_connections[i].open && strcmp(_connections[i].componentId, componentId) == 0)
+		{
+			LP_LOG(LP_LOG_ERROR, "ERROR: Real-time app %s is already connected\n", componentId);
+			return NULL;
+		}
+
+		if (connection == NULL && !_connections[i].open)
+		{
+			connection = &_connections[i];
+		}
+	}
+
+	if (connection == NULL)
+	{
+		LP_LOG(LP_LOG_ERROR, "ERROR: Too many real-time app connections\n");
+		return NULL;
+	}
+
+	*connection = (LP_INTER_CORE_CONNECTION){
+		.open = true,
+		.componentId = componentId,
+		.sockFd = -1,
+		.recordFd = -1,
+		.callback = interCoreCallback,
+		.handshakesLeft = LP_INTER_CORE_HANDSHAKE_RETRIES,
+		.syncTimeoutMs = LP_INTER_CORE_DEFAULT_TIMEOUT_MS,
+		.requestTimeoutTimer = {.name = "interCoreRequestTimeoutTimer", .handler = &InterCoreRequestTimeoutHandler},
+		.timeSyncTimer = {.name = "interCoreTimeSyncTimer", .handler = &InterCoreTimeSyncHandler},
+		.handshakeTimer = {.period = {LP_INTER_CORE_HANDSHAKE_RETRY_MS / 1000, (LP_INTER_CORE_HANDSHAKE_RETRY_MS % 1000) * 1000000},
+						   .name = "interCoreHandshakeTimer",
+						   .handler = &InterCoreHandshakeHandler}};
+	lp_icReassemblyInit(&connection->reassembly, connection->largeIn, sizeof(connection->largeIn));
+	lp_icFrameBegin(&connection->queued, connection->queuedFrame, sizeof(connection->queuedFrame));
+
+	SendHandshake(connection);
+	lp_startTimer(&connection->handshakeTimer);
+
+	return connection;
+}
+
+/// <summary>
+///     Close the socket and stop the connection's timers, pending requests are passed to their handlers as timed out
+/// </summary>
+void lp_interCoreClose(LP_INTER_CORE_CONNECTION *connection)
+{
+	if (connection == NULL || !connection->open)
+	{
+		return;
+	}
+
+	lp_stopTimer(&connection->requestTimeoutTimer);
+	lp_stopTimer(&connection->timeSyncTimer);
+	lp_stopTimer(&connection->handshakeTimer);
+
+	if (connection->socketEventReg != NULL)
+	{
+		EventLoop_UnregisterIo(lp_getTimerEventLoop(), connection->socketEventReg);
+		connection->socketEventReg = NULL;
+	}
+
+	if (connection->sockFd != -1)
+	{
+		close(connection->sockFd);
+		connection->sockFd = -1;
+	}
+
+	connection->open = false;
+	connection->sendingLarge = false;
+
+	for (size_t i = 0; i < LP_INTER_CORE_MAX_PENDING; i++)
+	{
+		LP_INTER_CORE_REQUEST *request = &connection->pendingRequests[i];
+
+		if (request->sequence != 0)
+		{
+			LP_INTER_CORE_BLOCK timedOut = {.cmd = request->cmd, .sequence = request->sequence};
+
+			request->sequence = 0;
+			request->responseHandler(&timedOut, true);
+		}
+	}
+
+	if (connection == _defaultConnection)
+	{
+		_defaultConnection = NULL;
+	}
+}
+
+int lp_enableInterCoreCommunications(char *rtAppComponentId, void (*interCoreCallback)(LP_INTER_CORE_BLOCK *))
+{
+	lp_interCoreClose(_defaultConnection);
+	_defaultConnection = lp_interCoreOpen(rtAppComponentId, interCoreCallback);
+
+	return _defaultConnection != NULL ? 0 : -1;
+}
+
+/// <summary>
+///     Optional, receive all messages drained by one socket event in a single call instead of one callback per message
+/// </summary>
+void lp_interCoreSetBatchCallback(LP_INTER_CORE_CONNECTION *connection, void (*interCoreBatchCallback)(LP_INTER_CORE_BLOCK *, size_t))
+{
+	if (connection != NULL)
+	{
+		connection->batchCallback = interCoreBatchCallback;
+	}
+}
+
+void lp_setInterCoreBatchCallback(void (*interCoreBatchCallback)(LP_INTER_CORE_BLOCK *, size_t))
+{
+	lp_interCoreSetBatchCallback(_defaultConnection, interCoreBatchCallback);
+}
+
+/// <summary>
+///     Handle socket event by reading incoming data from real-time capable application.
+/// </summary>
+static void SocketEventHandler(EventLoop *el, int fd, EventLoop_IoEvents events, void *context)
+{
+	LP_INTER_CORE_CONNECTION *connection = (LP_INTER_CORE_CONNECTION *)context;
+
+	if ((events & EventLoop_Output) && connection->sendingLarge)
+	{
+		SendFragments(connection);
+	}
+
+	if ((events & EventLoop_Input) && !ProcessMsg(connection))
+	{
+		lp_terminate(ExitCode_InterCoreHandler);
+	}
+}
+
+static int64_t ElapsedUs(const struct timespec *from, const struct timespec *to)
+{
+	return (int64_t)(to->tv_sec - from->tv_sec) * 1000000 + (to->tv_nsec - from->tv_nsec) / 1000;
+}
+
+/// <summary>
+///     CLOCK_MONOTONIC in microseconds, wrapping, for the trace stamps of LP_INTER_CORE_BLOCK
+/// </summary>
+uint32_t lp_interCoreTraceClockUs(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)((uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000);
+}
+
+/// <summary>
+///     Ask the real-time app for a latency trace on every nth request, zero stops tracing. The traced responses
+///     carry the real-time app's intervals and the A7 stamps, see lp_traceNextMessage.
+/// </summary>
+void lp_interCoreSetTraceSampling(LP_INTER_CORE_CONNECTION *connection, unsigned int everyNth)
+{
+	if (connection != NULL)
+	{
+		connection->traceEvery = everyNth;
+		connection->traceCountdown = 0;
+	}
+}
+
+void lp_setInterCoreTraceSampling(unsigned int everyNth)
+{
+	lp_interCoreSetTraceSampling(_defaultConnection, everyNth);
+}
+
+/// <summary>
+///     Arm the one-shot timeout timer for the nearest pending request deadline
+/// </summary>
+static void ArmInterCoreRequestTimeout(LP_INTER_CORE_CONNECTION *connection)
+{
+	struct timespec now;
+	int64_t delayUs = -1;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	for (size_t i = 0; i < LP_INTER_CORE_MAX_PENDING; i++)
+	{
+		if (connection->pendingRequests[i].sequence != 0)
+		{
+			int64_t remainingUs = ElapsedUs(&now, &connection->pendingRequests[i].deadline);
+			if (remainingUs < 1000) { remainingUs = 1000; }
+			if (delayUs < 0 || remainingUs < delayUs) { delayUs = remainingUs; }
+		}
+	}
+
+	if (delayUs < 0)
+	{
+		return;
+	}
+
+	if (connection->requestTimeoutTimer.eventLoopTimer == NULL && !lp_startTimer(&connection->requestTimeoutTimer))
+	{
+		return;
+	}
+
+	lp_setOneShotTimer(&connection->requestTimeoutTimer, &(struct timespec){(time_t)(delayUs / 1000000), (long)(delayUs % 1000000) * 1000});
+}
+
+bool lp_interCoreRequest(LP_INTER_CORE_BLOCK *request, int timeoutMs, LP_INTER_CORE_RESPONSE_HANDLER responseHandler)
+{
+	return lp_interCoreSendRequest(_defaultConnection, request, timeoutMs, responseHandler);
+}
+
+/// <summary>
+///     Send a request the real-time app answers with a record of the same command. The response, or a timeout after
+///     timeoutMs, is passed to responseHandler once. False when the same command is already pending, the pending
+///     table is full or the send failed, so requests do not pile up behind a slow real-time app.
+/// </summary>
+bool lp_interCoreSendRequest(LP_INTER_CORE_CONNECTION *connection, LP_INTER_CORE_BLOCK *request, int timeoutMs,
+							 LP_INTER_CORE_RESPONSE_HANDLER responseHandler)
+{
+	LP_INTER_CORE_REQUEST *slot = NULL;
+
+	if (connection == NULL || request == NULL || responseHandler == NULL)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < LP_INTER_CORE_MAX_PENDING; i++)
+	{
+		if (connection->pendingRequests[i].sequence != 0 && connection->pendingRequests[i].cmd == request->cmd)
+		{
+			connection->stats.duplicates++;
+			return false;
+		}
+
+		if (slot == NULL && connection->pendingRequests[i].sequence == 0)
+		{
+			slot = &connection->pendingRequests[i];
+		}
+	}
+
+	if (slot == NULL)
+	{
+		LP_LOG_LIMITED(LP_LOG_WARNING, LP_LOG_LIMIT_MS, "ERROR: Too many inter-core requests pending\n");
+		return false;
+	}
+
+	if (timeoutMs <= 0)
+	{
+		timeoutMs = LP_INTER_CORE_DEFAULT_TIMEOUT_MS;
+	}
+
+	if (++connection->lastSequence == 0) // zero marks unsolicited messages
+	{
+		connection->lastSequence = 1;
+	}
+
+	request->sequence = connection->lastSequence;
+
+	bool sampled = connection->traceEvery > 0 && !request->traced && ++connection->traceCountdown >= connection->traceEvery;
+	if (sampled)
+	{
+		request->traced = 1;
+		connection->traceCountdown = 0;
+	}
+
+	bool sent = lp_interCoreSend(connection, request, 1);
+
+	if (sampled)
+	{
+		request->traced = 0;
+	}
+
+	if (!sent)
+	{
+		request->sequence = 0;
+		return false;
+	}
+
+	slot->sequence = request->sequence;
+	slot->cmd = request->cmd;
+	slot->responseHandler = responseHandler;
+
+	clock_gettime(CLOCK_MONOTONIC, &slot->sentAt);
+	slot->deadline = slot->sentAt;
+	slot->deadline.tv_sec += timeoutMs / 1000;
+	slot->deadline.tv_nsec += (timeoutMs % 1000) * 1000000;
+	if (slot->deadline.tv_nsec >= 1000000000)
+	{
+		slot->deadline.tv_sec++;
+		slot->deadline.tv_nsec -= 1000000000;
+	}
+
+	request->sequence = 0; // the caller's block may be reused for unsolicited messages
+	connection->stats.requests++;
+
+	ArmInterCoreRequestTimeout(connection);
+	return true;
+}
+
+/// <summary>
+///     Pass a response to the handler of its pending request, false when no request matches (unsolicited or late)
+/// </summary>
+static bool CompleteInterCoreRequest(LP_INTER_CORE_CONNECTION *connection, LP_INTER_CORE_BLOCK *response)
+{
+	LP_INTER_CORE_STATS *stats = &connection->stats;
+	struct timespec now;
+
+	for (size_t i = 0; i < LP_INTER_CORE_MAX_PENDING; i++)
+	{
+		LP_INTER_CORE_REQUEST *request = &connection->pendingRequests[i];
+
+		if (request->sequence == response->sequence && request->cmd == response->cmd)
+		{
+			clock_gettime(CLOCK_MONOTONIC, &now);
+
+			uint32_t roundTripUs = (uint32_t)ElapsedUs(&request->sentAt, &now);
+
+			stats->responses++;
+			stats->roundTripLastUs = roundTripUs;
+			connection->roundTripTotalUs += roundTripUs;
+			stats->roundTripAvgUs = (uint32_t)(connection->roundTripTotalUs / stats->responses);
+			if (stats->responses == 1 || roundTripUs < stats->roundTripMinUs)
+			{
+				stats->roundTripMinUs = roundTripUs;
+			}
+			if (roundTripUs > stats->roundTripMaxUs)
+			{
+				stats->roundTripMaxUs = roundTripUs;
+			}
+
+			if (response->traced)
+			{
+				response->traceRoundTripUs = roundTripUs;
+				response->traceDeliveredUs = lp_interCoreTraceClockUs();
+			}
+
+			// free the slot first, the handler may issue the next request
+			LP_INTER_CORE_RESPONSE_HANDLER responseHandler = request->responseHandler;
+			request->sequence = 0;
+
+			_responding = connection;
+			responseHandler(response, false);
+			_responding = NULL;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void InterCoreRequestTimeoutHandler(EventLoopTimer *eventLoopTimer)
+{
+	LP_INTER_CORE_CONNECTION *connection = TimerConnection(eventLoopTimer);
+	struct timespec now;
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
+	{
+		lp_terminate(ExitCode_InterCoreRequestTimeoutHandler);
+		return;
+	}
+
+	if (connection == NULL)
+	{
+		return;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	for (size_t i = 0; i < LP_INTER_CORE_MAX_PENDING; i++)
+	{
+		LP_INTER_CORE_REQUEST *request = &connection->pendingRequests[i];
+
+		if (request->sequence != 0 && ElapsedUs(&request->deadline, &now) >= 0)
+		{
+			LP_INTER_CORE_BLOCK timedOut = {.cmd = request->cmd, .sequence = request->sequence};
+			LP_INTER_CORE_RESPONSE_HANDLER responseHandler = request->responseHandler;
+
+			request->sequence = 0;
+			connection->stats.timeouts++;
+
+			LP_LOG_LIMITED(LP_LOG_WARNING, LP_LOG_LIMIT_MS, "Inter-core request %u timed out\n", timedOut.sequence);
+			_responding = connection;
+			responseHandler(&timedOut, true);
+			_responding = NULL;
+		}
+	}
+
+	ArmInterCoreRequestTimeout(connection);
+}
+
+void lp_interCoreGetStats(LP_INTER_CORE_CONNECTION *connection, LP_INTER_CORE_STATS *stats)
+{
+	if (stats != NULL)
+	{
+		*stats = connection != NULL ? connection->stats : (LP_INTER_CORE_STATS){0};
+	}
+}
+
+void lp_getInterCoreStats(LP_INTER_CORE_STATS *stats)
+{
+	lp_interCoreGetStats(_defaultConnection, stats);
+}
+
+/// <summary>
+///     True while the real-time app reports its outbound ring short of space, throttle requests until it clears
+/// </summary>
+bool lp_interCoreIsCongested(LP_INTER_CORE_CONNECTION *connection)
+{
+	return connection != NULL && connection->remoteCongested;
+}
+
+bool lp_isInterCoreCongested(void)
+{
+	return lp_interCoreIsCongested(_defaultConnection);
+}
+
+/// <summary>
+///     True once the real-time app has answered the handshake of lp_interCoreOpen
+/// </summary>
+bool lp_interCoreIsReady(LP_INTER_CORE_CONNECTION *connection)
+{
+	return connection != NULL && connection->remoteReady;
+}
+
+bool lp_isInterCoreReady(void)
+{
+	return lp_interCoreIsReady(_defaultConnection);
+}
+
+static int64_t MonotonicUs(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/// <summary>
+///     Relate the real-time app's clock to CLOCK_MONOTONIC. The real-time app read its clock somewhere in the round
+///     trip, taken as the midpoint, so a sync is only as good as its round trip is short and one much slower than the
+///     best seen is not used. Sync points LP_INTER_CORE_DRIFT_MIN_SPAN_S or more apart measure how fast its clock runs.
+/// </summary>
+static void TimeSyncResponseHandler(LP_INTER_CORE_BLOCK *response, bool timedOut)
+{
+	LP_INTER_CORE_CONNECTION *connection = _responding;
+
+	if (timedOut || connection == NULL)
+	{
+		return;
+	}
+
+	int64_t sentUs = (int64_t)response->syncA7Us;
+	uint32_t roundTripUs = (uint32_t)(MonotonicUs() - sentUs);
+
+	if (connection->syncBestRoundTripUs == 0 || roundTripUs < connection->syncBestRoundTripUs)
+	{
+		connection->syncBestRoundTripUs = roundTripUs;
+	}
+
+	if (roundTripUs > 2 * connection->syncBestRoundTripUs + LP_INTER_CORE_SYNC_SLACK_US)
+	{
+		// the best creeps up while syncs are turned away, a link that has slowed for good is used again
+		connection->syncBestRoundTripUs += connection->syncBestRoundTripUs / 4 + 1;
+		connection->stats.timeSyncsRejected++;
+		return;
+	}
+
+	LP_INTER_CORE_SYNC_POINT point = {.monotonicUs = sentUs + roundTripUs / 2, .rtUs = response->syncRtUs};
+	int64_t spanUs = point.monotonicUs - connection->driftPoint.monotonicUs;
+
+	if (!connection->synced || spanUs > INT32_MAX) // the real-time clock wraps, a span over half its range is started again
+	{
+		connection->driftPoint = point;
+	}
+	else if (spanUs >= (int64_t)LP_INTER_CORE_DRIFT_MIN_SPAN_S * 1000000)
+	{
+		double drift = (double)((int32_t)(point.rtUs - connection->driftPoint.rtUs) - spanUs) / (double)spanUs;
+
+		connection->syncDrift = connection->driftMeasured ? (3 * connection->syncDrift + drift) / 4 : drift;
+		connection->driftMeasured = true;
+		connection->driftPoint = point;
+	}
+
+	connection->syncPoint = point;
+	connection->synced = true;
+
+	connection->stats.timeSyncs++;
+	connection->stats.timeSyncRoundTripUs = roundTripUs;
+	connection->stats.timeSyncDriftPpb = (int32_t)(connection->syncDrift * 1e9);
+}
+
+static void SendTimeSync(LP_INTER_CORE_CONNECTION *connection)
+{
+	LP_INTER_CORE_BLOCK request = {.cmd = LP_IC_TIME_SYNC};
+
+	request.syncA7Us = (uint64_t)MonotonicUs();
+	lp_interCoreSendRequest(connection, &request, connection->syncTimeoutMs, TimeSyncResponseHandler);
+}
+
+static void InterCoreTimeSyncHandler(EventLoopTimer *eventLoopTimer)
+{
+	LP_INTER_CORE_CONNECTION *connection = TimerConnection(eventLoopTimer);
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
+	{
+		lp_terminate(ExitCode_InterCoreTimeSyncHandler);
+		return;
+	}
+
+	if (connection != NULL)
+	{
+		SendTimeSync(connection);
+	}
+}
+
+/// <summary>
+///     Sync with the real-time app's clock every periodMs, starting now, zero stops. The real-time app stamps its
+///     readings with that clock, lp_interCoreToMonotonic converts the stamps. Each real-time core has its own clock.
+/// </summary>
+bool lp_interCoreSetTimeSync(LP_INTER_CORE_CONNECTION *connection, int periodMs)
+{
+	if (periodMs <= 0)
+	{
+		if (connection != NULL)
+		{
+			lp_stopTimer(&connection->timeSyncTimer);
+		}
+		return true;
+	}
+
+	if (connection == NULL)
+	{
+		return false;
+	}
+
+	struct timespec period = {(time_t)(periodMs / 1000), (long)(periodMs % 1000) * 1000000};
+
+	connection->syncTimeoutMs = periodMs < LP_INTER_CORE_DEFAULT_TIMEOUT_MS ? periodMs : LP_INTER_CORE_DEFAULT_TIMEOUT_MS;
+
+	if (connection->timeSyncTimer.eventLoopTimer != NULL)
+	{
+		if (!lp_changeTimer(&connection->timeSyncTimer, &period))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		connection->timeSyncTimer.period = period;
+		if (!lp_startTimer(&connection->timeSyncTimer))
+		{
+			return false;
+		}
+	}
+
+	SendTimeSync(connection);
+	return true;
+}
+
+bool lp_setInterCoreTimeSync(int periodMs)
+{
+	return lp_interCoreSetTimeSync(_defaultConnection, periodMs);
+}
+
+/// <summary>
+///     The CLOCK_MONOTONIC time of a real-time app stamp, see LP_IC_STAMP_SIZE, false until the first time sync.
+///     lp_getMonotonicUtc turns it into UTC. A stamp is within 35 minutes of the latest sync, the clock wraps.
+/// </summary>
+bool lp_interCoreToMonotonic(LP_INTER_CORE_CONNECTION *connection, uint32_t stampUs, struct timespec *monotonic)
+{
+	if (connection == NULL || !connection->synced || monotonic == NULL)
+	{
+		return false;
+	}
+
+	int64_t rtElapsedUs = (int32_t)(stampUs - connection->syncPoint.rtUs);
+	int64_t us = connection->syncPoint.monotonicUs + rtElapsedUs - (int64_t)((double)rtElapsedUs * connection->syncDrift);
+
+	monotonic->tv_sec = (time_t)(us / 1000000);
+	monotonic->tv_nsec = (long)(us % 1000000) * 1000;
+	return true;
+}
+
+bool lp_interCoreStampToMonotonic(uint32_t stampUs, struct timespec *monotonic)
+{
+	return lp_interCoreToMonotonic(_defaultConnection, stampUs, monotonic);
+}
+
+static void UpdateFlowControl(LP_INTER_CORE_CONNECTION *connection, const LP_INTER_CORE_BLOCK *flowControl)
+{
+	bool congested = flowControl->congested != 0;
+
+	if (congested && !connection->remoteCongested)
+	{
+		connection->stats.congestions++;
+	}
+
+	if (congested != connection->remoteCongested)
+	{
+		LP_LOG(LP_LOG_INFO, "Real-time app %s %s\n", connection->componentId, congested ? "congested, throttling requests" : "congestion cleared");
+	}
+
+	connection->remoteCongested = congested;
+}
+
+static void DeliverMessages(LP_INTER_CORE_CONNECTION *connection, LP_INTER_CORE_BLOCK *ic_control_blocks, size_t count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (ic_control_blocks[i].traced)
+		{
+			ic_control_blocks[i].traceDeliveredUs = lp_interCoreTraceClockUs();
+		}
+	}
+
+	if (connection->batchCallback != NULL)
+	{
+		connection->batchCallback(ic_control_blocks, count);
+	}
+	else if (connection->callback != NULL)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			connection->callback(&ic_control_blocks[i]);
+		}
+	}
+}
+
+/// <summary>
+///     Decode one frame's records, library ones are acted on and the rest added to ic_control_blocks for delivery
+/// </summary>
+static bool ProcessFrame(LP_INTER_CORE_CONNECTION *connection, const uint8_t *frame, size_t length, LP_INTER_CORE_BLOCK *ic_control_blocks,
+						 size_t *count)
+{
+	LP_INTER_CORE_BLOCK ic_control_block;
+	LP_IC_FRAME_READER reader;
+
+	if (!lp_icFrameOpen(&reader, frame, length))
+	{
+		LP_LOG_LIMITED(LP_LOG_WARNING, LP_LOG_LIMIT_MS, "Inter-core frame of unknown protocol version dropped\n");
+		return false;
+	}
+
+	while (lp_icFrameNext(&reader, &ic_control_block))
+	{
+		connection->stats.messagesIn++;
+
+		if (ic_control_block.traced)
+		{
+			ic_control_block.traceReceivedUs = lp_interCoreTraceClockUs();
+		}
+
+		if (ic_control_block.cmd == LP_IC_FLOW_CONTROL)
+		{
+			UpdateFlowControl(connection, &ic_control_block);
+			continue;
+		}
+
+		if (ic_control_block.cmd == LP_IC_HEARTBEAT && ic_control_block.sequence == 0)
+		{
+			if (!connection->remoteReady)
+			{
+				connection->remoteReady = true;
+				lp_stopTimer(&connection->handshakeTimer);
+			}
+			continue;
+		}
+
+		if (ic_control_block.cmd == LP_IC_FRAGMENT)
+		{
+			if (lp_icReassemble(&connection->reassembly, &ic_control_block))
+			{
+				// the records before it first, in order
+				DeliverMessages(connection, ic_control_blocks, *count);
+				*count = 0;
+
+				connection->stats.largeMessagesIn++;
+				if (connection->reassembly.cmd == LP_IC_METHOD_RESPONSE && _methodResponseHandler != NULL)
+				{
+					_methodResponseHandler(LP_IC_METHOD_RESPONSE, connection->reassembly.buffer, connection->reassembly.total);
+				}
+				else if (connection->largeHandler != NULL)
+				{
+					connection->largeHandler((LP_INTER_CORE_CMD)connection->reassembly.cmd, connection->reassembly.buffer, connection->reassembly.total);
+				}
+			}
+			connection->stats.largeMessagesLost = connection->reassembly.lost;
+			continue;
+		}
+
+		if (ic_control_block.sequence != 0 && CompleteInterCoreRequest(connection, &ic_control_block))
+		{
+			continue;
+		}
+
+		ic_control_blocks[*count] = ic_control_block;
+		if (++*count == LP_INTER_CORE_DRAIN_BUDGET)
+		{
+			DeliverMessages(connection, ic_control_blocks, *count);
+			*count = 0;
+		}
+	}
+
+	return true;
+}
+
+/// <summary>
+///     Append a frame read to the recording, which is stopped if the write fails
+/// </summary>
+static void RecordFrame(LP_INTER_CORE_CONNECTION *connection, const uint8_t *frame, size_t length)
+{
+	LP_INTER_CORE_RECORDED_FRAME recorded = {.monotonicUs = (uint64_t)MonotonicUs(), .length = (uint32_t)length};
+	struct iovec parts[] = {{.iov_base = &recorded, .iov_len = sizeof(recorded)}, {.iov_base = (void *)frame, .iov_len = length}};
+
+	if (writev(connection->recordFd, parts, 2) != (ssize_t)(sizeof(recorded) + length))
+	{
+		LP_LOG(LP_LOG_ERROR, "ERROR: Inter-core recording stopped, unable to write: %d (%s)\n", errno, strerror(errno));
+		connection->recordFd = -1;
+	}
+}
+
+/// <summary>
+///     Drain up to LP_INTER_CORE_DRAIN_BUDGET queued frames from the real-time capable application and deliver
+///     their records. Responses to lp_interCoreSendRequest go to their request handler as they are decoded.
+///     Frames left over raise another socket event.
+/// </summary>
+static bool ProcessMsg(LP_INTER_CORE_CONNECTION *connection)
+{
+	LP_INTER_CORE_BLOCK ic_control_blocks[LP_INTER_CORE_DRAIN_BUDGET];
+	uint8_t frame[LP_IC_MAX_FRAME_SIZE];
+	size_t count = 0;
+
+	// a handler may close the connection, the socket goes with it
+	for (int frames = 0; frames < LP_INTER_CORE_DRAIN_BUDGET && connection->open; frames++)
+	{
+		int bytesReceived = recv(connection->sockFd, frame, sizeof(frame), 0);
+
+		if (bytesReceived == -1)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				break;
+			}
+
+			lp_terminate(ExitCode_InterCoreReceiveFailed);
+			return false;
+		}
+
+		if (connection->recordFd != -1)
+		{
+			RecordFrame(connection, frame, (size_t)bytesReceived);
+		}
+
+		lp_traceEvent(LP_TRACE_IC_IN, connection->componentId, (uint32_t)bytesReceived);
+		ProcessFrame(connection, frame, (size_t)bytesReceived, ic_control_blocks, &count);
+	}
+
+	DeliverMessages(connection, ic_control_blocks, count);
+
+	return true;
+}
+
+/// <summary>
+///     Record every frame read from the real-time app to fd, each as an LP_INTER_CORE_RECORDED_FRAME and its bytes after
+///     an LP_INTER_CORE_RECORDING_HEADER, for lp_interCoreReplayFrame. fd stays the caller's, -1 stops recording.
+/// </summary>
+bool lp_interCoreSetRecording(LP_INTER_CORE_CONNECTION *connection, int fd)
+{
+	LP_INTER_CORE_RECORDING_HEADER header = {.magic = LP_INTER_CORE_RECORDING_MAGIC, .protocolVersion = LP_IC_PROTOCOL_VERSION};
+
+	if (connection == NULL || !connection->open)
+	{
+		return false;
+	}
+
+	connection->recordFd = -1;
+	if (fd == -1)
+	{
+		return true;
+	}
+
+	if (write(fd, &header, sizeof(header)) != (ssize_t)sizeof(header))
+	{
+		LP_LOG(LP_LOG_ERROR, "ERROR: Unable to start inter-core recording: %d (%s)\n", errno, strerror(errno));
+		return false;
+	}
+
+	connection->recordFd = fd;
+
+	return true;
+}
+
+bool lp_setInterCoreRecording(int fd)
+{
+	return lp_interCoreSetRecording(_defaultConnection, fd);
+}
+
+/// <summary>
+///     Process a recorded frame as if the real-time app had just sent it, the records are delivered before it returns.
+///     Responses only complete requests this connection has pending, others are delivered as unsolicited messages.
+/// </summary>
+bool lp_interCoreReplayFrame(LP_INTER_CORE_CONNECTION *connection, const uint8_t *frame, size_t length)
+{
+	LP_INTER_CORE_BLOCK ic_control_blocks[LP_INTER_CORE_DRAIN_BUDGET];
+	size_t count = 0;
+
+	if (connection == NULL || !connection->open || frame == NULL)
+	{
+		return false;
+	}
+
+	bool decoded = ProcessFrame(connection, frame, length, ic_control_blocks, &count);
+	DeliverMessages(connection, ic_control_blocks, count);
+
+	return decoded;
+}
@@ -1,41 +1,126 @@
 #pragma once
 
 #include "eventloop_timer_utilities.h"
+#include "build_options.h"
+#include "logging.h"
 #include "terminate.h"
 #include <applibs/application.h>
 #include <applibs/eventloop.h>
 #include <applibs/log.h>
 #include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/uio.h>
+#include <time.h>
 #include <unistd.h>
 #include "timer.h"
+#include "deferred_work.h"
+#include "shared/inter_core_protocol.h"	// LP_INTER_CORE_BLOCK and the wire format shared with the real-time apps
 
-typedef enum 
-{
-	LP_IC_UNKNOWN,
-	LP_IC_HEARTBEAT,
-	LP_IC_TEMPERATURE_PRESSURE_HUMIDITY,
-	LP_IC_EVENT_BUTTON_A,
-	LP_IC_EVENT_BUTTON_B,
-	LP_IC_SET_DESIRED_TEMPERATURE,
-	LP_IC_BLINK_RATE
-} LP_INTER_CORE_CMD;
+#define LP_INTER_CORE_MAX_CONNECTIONS 2	// real-time apps talked to at once, one per real-time core
+#define LP_INTER_CORE_DRAIN_BUDGET 16	// frames read per socket event before yielding to the event loop
+#define LP_INTER_CORE_MAX_PENDING 8		// requests awaiting a response from the real-time app
+#define LP_INTER_CORE_DEFAULT_TIMEOUT_MS 1000
+#define LP_INTER_CORE_SYNC_SLACK_US 200			// a time sync round trip this much over twice the best seen is not used
+#define LP_INTER_CORE_DRIFT_MIN_SPAN_S 30		// sync points at least this far apart measure the real-time clock's drift
+#define LP_INTER_CORE_HANDSHAKE_RETRY_MS 500	// the handshake heartbeat is repeated this often until the real-time app answers
+#define LP_INTER_CORE_HANDSHAKE_RETRIES 20		// then given up, the real-time app may not be deployed
+#define LP_INTER_CORE_MAX_MESSAGE_SIZE 2048		// fragmented messages each way, per connection, up to LP_IC_MAX_MESSAGE_SIZE
 
-typedef struct
-{
-	LP_INTER_CORE_CMD cmd;
-	float	temperature;
-	float	pressure;
-	float	humidity;
-	int		blinkRate;
+/// <summary>
+///     Called once per request, with the response or, when timedOut, with the request's command and sequence number
+/// </summary>
+typedef void (*LP_INTER_CORE_RESPONSE_HANDLER)(LP_INTER_CORE_BLOCK* response, bool timedOut);
 
-} LP_INTER_CORE_BLOCK;
+/// <summary>
+///     Called with each fragmented message once all of it has arrived, payload is valid for the call only
+/// </summary>
+typedef void (*LP_INTER_CORE_LARGE_HANDLER)(LP_INTER_CORE_CMD cmd, const uint8_t* payload, size_t length);
 
+#define LP_INTER_CORE_RECORDING_MAGIC 0x4349504C	// "LPIC" at the start of a recording, little endian
+
+/// <summary>
+///     Recordings written by lp_interCoreSetRecording, the header then each frame as it was read
+/// </summary>
+typedef struct {
+	uint32_t magic;
+	uint32_t protocolVersion;	// LP_IC_PROTOCOL_VERSION of the recording build, the frames carry their own too
+} LP_INTER_CORE_RECORDING_HEADER;
+
+typedef struct {
+	uint64_t monotonicUs;		// CLOCK_MONOTONIC when the frame was read
+	uint32_t length;			// frame bytes that follow
+	uint32_t reserved;			// zero
+} LP_INTER_CORE_RECORDED_FRAME;
+
+typedef struct {
+	uint32_t requests;
+	uint32_t responses;
+	uint32_t timeouts;
+	uint32_t duplicates;		// requests refused while the same command was still pending
+	uint32_t congestions;		// times the real-time app reported its outbound ring short of space
+	uint32_t messagesIn;		// records received, flow control included
+	uint32_t messagesOut;		// records sent
+	uint32_t messagesDropped;	// records not sent, the socket was not open or the real-time app was not keeping up
+	uint32_t roundTripLastUs;
+	uint32_t roundTripAvgUs;
+	uint32_t roundTripMinUs;
+	uint32_t roundTripMaxUs;
+	uint32_t timeSyncs;			// LP_IC_TIME_SYNC round trips used to relate the real-time app's clock to CLOCK_MONOTONIC
+	uint32_t timeSyncsRejected;	// round trips too slow to be used, the midpoint is only as good as the round trip is short
+	uint32_t timeSyncRoundTripUs;	// of the sync in use
+	int32_t timeSyncDriftPpb;	// the real-time app's clock rate against CLOCK_MONOTONIC, positive when it runs fast
+	uint32_t largeMessagesIn;	// fragmented messages reassembled
+	uint32_t largeMessagesOut;	// fragmented messages sent in full
+	uint32_t largeMessagesLost;	// abandoned in reassembly, a fragment went missing or the message was too large
+	uint32_t messagesCoalesced;	// queued settings that replaced one of the same kind still waiting to be sent
+} LP_INTER_CORE_STATS;
+
+/// <summary>
+///     One real-time app, opened by lp_interCoreOpen. The lp_...InterCore... functions below act on the connection
+///     lp_enableInterCoreCommunications opened, for apps with a single real-time app.
+/// </summary>
+typedef struct _lpInterCoreConnection LP_INTER_CORE_CONNECTION;
+
+LP_INTER_CORE_CONNECTION* lp_interCoreOpen(char* componentId, void (*interCoreCallback)(LP_INTER_CORE_BLOCK*));
+void lp_interCoreClose(LP_INTER_CORE_CONNECTION* connection);
+bool lp_interCoreSend(LP_INTER_CORE_CONNECTION* connection, LP_INTER_CORE_BLOCK* control_blocks, size_t count);
+bool lp_interCoreQueue(LP_INTER_CORE_CONNECTION* connection, const LP_INTER_CORE_BLOCK* control_block);
+void lp_interCoreSetBatchCallback(LP_INTER_CORE_CONNECTION* connection, void (*interCoreBatchCallback)(LP_INTER_CORE_BLOCK*, size_t));
+bool lp_interCoreSendRequest(LP_INTER_CORE_CONNECTION* connection, LP_INTER_CORE_BLOCK* request, int timeoutMs,
+	LP_INTER_CORE_RESPONSE_HANDLER responseHandler);
+void lp_interCoreGetStats(LP_INTER_CORE_CONNECTION* connection, LP_INTER_CORE_STATS* stats);
+bool lp_interCoreIsCongested(LP_INTER_CORE_CONNECTION* connection);
+bool lp_interCoreIsReady(LP_INTER_CORE_CONNECTION* connection);
+void lp_interCoreSetTraceSampling(LP_INTER_CORE_CONNECTION* connection, unsigned int everyNth);
+bool lp_interCoreSetTimeSync(LP_INTER_CORE_CONNECTION* connection, int periodMs);
+bool lp_interCoreToMonotonic(LP_INTER_CORE_CONNECTION* connection, uint32_t stampUs, struct timespec* monotonic);
+bool lp_interCoreSendLarge(LP_INTER_CORE_CONNECTION* connection, LP_INTER_CORE_CMD cmd, const void* payload, size_t length);
+bool lp_interCoreIsSendingLarge(LP_INTER_CORE_CONNECTION* connection);
+void lp_interCoreSetLargeHandler(LP_INTER_CORE_CONNECTION* connection, LP_INTER_CORE_LARGE_HANDLER largeHandler);
+bool lp_interCoreSetRecording(LP_INTER_CORE_CONNECTION* connection, int fd);
+bool lp_interCoreReplayFrame(LP_INTER_CORE_CONNECTION* connection, const uint8_t* frame, size_t length);
 
 bool lp_sendInterCoreMessage(LP_INTER_CORE_BLOCK* control_block, size_t len);
+bool lp_sendInterCoreBatch(LP_INTER_CORE_BLOCK* control_blocks, size_t count);
+bool lp_queueInterCoreMessage(const LP_INTER_CORE_BLOCK* control_block);
 int lp_enableInterCoreCommunications(char* rtAppComponentId, void (*interCoreCallback)(LP_INTER_CORE_BLOCK*));
+void lp_setInterCoreBatchCallback(void (*interCoreBatchCallback)(LP_INTER_CORE_BLOCK*, size_t));
+bool lp_interCoreRequest(LP_INTER_CORE_BLOCK* request, int timeoutMs, LP_INTER_CORE_RESPONSE_HANDLER responseHandler);
+void lp_getInterCoreStats(LP_INTER_CORE_STATS* stats);
+bool lp_isInterCoreCongested(void);
+bool lp_isInterCoreReady(void);
+void lp_setInterCoreTraceSampling(unsigned int everyNth);
+uint32_t lp_interCoreTraceClockUs(void);
+bool lp_setInterCoreTimeSync(int periodMs);
+bool lp_interCoreStampToMonotonic(uint32_t stampUs, struct timespec* monotonic);
+bool lp_sendInterCoreLarge(LP_INTER_CORE_CMD cmd, const void* payload, size_t length);
+void lp_setInterCoreLargeHandler(LP_INTER_CORE_LARGE_HANDLER largeHandler);
+// the library's own, direct methods forwarded to the real-time app are answered through it
+void lp_setInterCoreMethodResponseHandler(LP_INTER_CORE_LARGE_HANDLER methodResponseHandler);
+bool lp_setInterCoreRecording(int fd);
@@ -0,0 +1,155 @@
+#include "inter_core.h"
+
+// Built in place of inter_core.c when LP_ENABLE_INTERCORE is OFF, for apps without a partner real-time app.
+
+bool lp_sendInterCoreMessage(LP_INTER_CORE_BLOCK *control_block, size_t len)
+{
+	return false;
+}
+
+bool lp_sendInterCoreBatch(LP_INTER_CORE_BLOCK *control_blocks, size_t count)
+{
+	return false;
+}
+
+bool lp_queueInterCoreMessage(const LP_INTER_CORE_BLOCK *control_block)
+{
+	return false;
+}
+
+int lp_enableInterCoreCommunications(char *rtAppComponentId, void (*interCoreCallback)(LP_INTER_CORE_BLOCK *))
+{
+	LP_LOG(LP_LOG_WARNING, "WARNING: inter-core communications are not compiled in, LP_ENABLE_INTERCORE is OFF\n");
+	return -1;
+}
+
+void lp_setInterCoreBatchCallback(void (*interCoreBatchCallback)(LP_INTER_CORE_BLOCK *, size_t)) {}
+
+bool lp_interCoreRequest(LP_INTER_CORE_BLOCK *request, int timeoutMs, LP_INTER_CORE_RESPONSE_HANDLER responseHandler)
+{
+	return false;
+}
+
+void lp_getInterCoreStats(LP_INTER_CORE_STATS *stats)
+{
+	if (stats != NULL)
+	{
+		*stats = (LP_INTER_CORE_STATS){0};
+	}
+}
+
+bool lp_isInterCoreCongested(void)
+{
+	return false;
+}
+
+bool lp_isInterCoreReady(void)
+{
+	return false;
+}
+
+void lp_setInterCoreTraceSampling(unsigned int everyNth) {}
+
+uint32_t lp_interCoreTraceClockUs(void)
+{
+	return 0;
+}
+
+bool lp_setInterCoreTimeSync(int periodMs)
+{
+	return false;
+}
+
+bool lp_interCoreStampToMonotonic(uint32_t stampUs, struct timespec *monotonic)
+{
+	return false;
+}
+
+LP_INTER_CORE_CONNECTION *lp_interCoreOpen(char *componentId, void (*interCoreCallback)(LP_INTER_CORE_BLOCK *))
+{
+	LP_LOG(LP_LOG_WARNING, "WARNING: inter-core communications are not compiled in, LP_ENABLE_INTERCORE is OFF\n");
+	return NULL;
+}
+
+void lp_interCoreClose(LP_INTER_CORE_CONNECTION *connection) {}
+
+bool lp_interCoreSend(LP_INTER_CORE_CONNECTION *connection, LP_INTER_CORE_BLOCK *control_blocks, size_t count)
+{
+	return false;
+}
+
+bool lp_interCoreQueue(LP_INTER_CORE_CONNECTION *connection, const LP_INTER_CORE_BLOCK *control_block)
+{
+	return false;
+}
+
+void lp_interCoreSetBatchCallback(LP_INTER_CORE_CONNECTION *connection, void (*interCoreBatchCallback)(LP_INTER_CORE_BLOCK *, size_t)) {}
+
+bool lp_interCoreSendRequest(LP_INTER_CORE_CONNECTION *connection, LP_INTER_CORE_BLOCK *request, int timeoutMs,
+							 LP_INTER_CORE_RESPONSE_HANDLER responseHandler)
+{
+	return false;
+}
+
+void lp_interCoreGetStats(LP_INTER_CORE_CONNECTION *connection, LP_INTER_CORE_STATS *stats)
+{
+	lp_getInterCoreStats(stats);
+}
+
+bool lp_interCoreIsCongested(LP_INTER_CORE_CONNECTION *connection)
+{
+	return false;
+}
+
+bool lp_interCoreIsReady(LP_INTER_CORE_CONNECTION *connection)
+{
+	return false;
+}
+
+void lp_interCoreSetTraceSampling(LP_INTER_CORE_CONNECTION *connection, unsigned int everyNth) {}
+
+bool lp_interCoreSetTimeSync(LP_INTER_CORE_CONNECTION *connection, int periodMs)
+{
+	return false;
+}
+
+bool lp_interCoreToMonotonic(LP_INTER_CORE_CONNECTION *connection, uint32_t stampUs, struct timespec *monotonic)
+{
+	return false;
+}
+
+bool lp_interCoreSendLarge(LP_INTER_CORE_CONNECTION *connection, LP_INTER_CORE_CMD cmd, const void *payload, size_t length)
+{
+	return false;
+}
+
+bool lp_interCoreIsSendingLarge(LP_INTER_CORE_CONNECTION *connection)
+{
+	return false;
+}
+
+void lp_interCoreSetLargeHandler(LP_INTER_CORE_CONNECTION *connection, LP_INTER_CORE_LARGE_HANDLER largeHandler) {}
+
+bool lp_sendInterCoreLarge(LP_INTER_CORE_CMD cmd, const void *payload, size_t length)
+{
+	return false;
+}
+
+void lp_setInterCoreLargeHandler(LP_INTER_CORE_LARGE_HANDLER largeHandler) {}
+
+void lp_setInterCoreMethodResponseHandler(LP_INTER_CORE_LARGE_HANDLER methodResponseHandler) {}
+
+bool lp_interCoreSetRecording(LP_INTER_CORE_CONNECTION *connection, int fd)
+{
+	return false;
+}
+
+bool lp_setInterCoreRecording(int fd)
+{
+	return false;
+}
+
+bool lp_interCoreReplayFrame(LP_INTER_CORE_CONNECTION *connection, const uint8_t *frame, size_t length)
+{
+	return false;
+}
@@ -0,0 +1,116 @@
+#include "json_arena.h"
+#include "heap_stats.h"
+
+#define LP_JSON_ARENA_ALIGN 8
+
+static void* ArenaMalloc(size_t size);
+static void ArenaFree(void* ptr);
+
+// parson allocations made inside a scope are pointer bumps in here and the whole
+// scope is released by resetting the offset, nothing built in a scope may outlive it.
+// Outside a scope parson keeps the nodes it frees for reuse, its pool is paused inside one
+// so no arena node is kept and no kept node is left in a DOM dropped with the scope.
+static uint8_t _arena[LP_JSON_ARENA_SIZE] __attribute__((aligned(LP_JSON_ARENA_ALIGN)));
+static size_t _arenaOffset = 0;
+static int _arenaDepth = 0;
+static bool _arenaInstalled = false;
+static LP_JSON_ARENA_STATS _arenaStats = { LP_JSON_ARENA_SIZE, 0, 0, 0 };
+
+static void* ArenaMalloc(size_t size) {
+	size_t aligned = (size + LP_JSON_ARENA_ALIGN - 1) & ~(size_t)(LP_JSON_ARENA_ALIGN - 1);
+
+	if (_arenaDepth > 0) {
+		if (aligned <= LP_JSON_ARENA_SIZE - _arenaOffset) {
+			void* ptr = &_arena[_arenaOffset];
+			_arenaOffset += aligned;
+			return ptr;
+		}
+		_arenaStats.overflows++;
+	}
+
+	return lp_heapMalloc(LP_HEAP_JSON, size);
+}
+
+static void ArenaFree(void* ptr) {
+	// arena memory is released as a whole by lp_jsonArenaEnd
+	if ((uint8_t*)ptr >= _arena && (uint8_t*)ptr < _arena + LP_JSON_ARENA_SIZE) {
+		return;
+	}
+
+	lp_heapFree(LP_HEAP_JSON, ptr);
+}
+
+/// <summary>
+///     Give parson the arena's allocation functions, outside a scope they pass through to the counted heap.
+///     Done by the first lp_jsonArenaBegin, or earlier so parson's allocations before then are counted too
+/// </summary>
+void lp_jsonArenaInstall(void) {
+	if (!_arenaInstalled) {
+		json_set_allocation_functions(ArenaMalloc, ArenaFree);
+		json_set_node_pool(LP_JSON_NODE_POOL_LIMIT);
+		json_pause_node_pool(_arenaDepth > 0);
+		_arenaInstalled = true;
+	}
+}
+
+/// <summary>
+///     Start a scope in which parson builds its DOM in the arena, scopes nest and only the outermost end resets it
+/// </summary>
+void lp_jsonArenaBegin(void) {
+	lp_jsonArenaInstall();
+	if (_arenaDepth++ == 0) {
+		json_pause_node_pool(1);
+	}
+}
+
+/// <summary>
+///     End a scope, every value parsed or serialised since lp_jsonArenaBegin must already be freed or dropped
+/// </summary>
+void lp_jsonArenaEnd(void) {
+	if (_arenaDepth == 0 || --_arenaDepth > 0) {
+		return;
+	}
+
+	_arenaStats.lastUsed = _arenaOffset;
+	if (_arenaOffset > _arenaStats.highWater) {
+		_arenaStats.highWater = _arenaOffset;
+	}
+
+	_arenaOffset = 0;
+	json_pause_node_pool(0);
+}
+
+/// <summary>
+///     Step out of every open scope, parson allocates from the counted heap until lp_jsonArenaResume. For a
+///     DOM kept across callbacks and changed from a handler that runs inside a scope
+/// </summary>
+int lp_jsonArenaSuspend(void) {
+	int depth = _arenaDepth;
+
+	_arenaDepth = 0;
+	json_pause_node_pool(0);
+	return depth;
+}
+
+void lp_jsonArenaResume(int depth) {
+	_arenaDepth = depth;
+	json_pause_node_pool(depth > 0);
+}
+
+/// <summary>
+///     Arena usage so LP_JSON_ARENA_SIZE can be sized from the high-water mark, and the node pool's churn
+/// </summary>
+void lp_getJsonArenaStats(LP_JSON_ARENA_STATS* stats) {
+	JSON_Node_Pool_Stats pool;
+
+	if (stats != NULL) {
+		*stats = _arenaStats;
+		json_get_node_pool_stats(&pool);
+		for (int i = 0; i < JSONNodeClasses; i++) {
+			stats->nodesReused += pool.reused[i];
+			stats->nodesAllocated += pool.allocated[i];
+			stats->nodesReleased += pool.released[i];
+			stats->nodesPooled += pool.pooled[i];
+		}
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "parson.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define LP_JSON_ARENA_SIZE 4096		// bytes of DOM a single twin or direct method callback can build without malloc
+#define LP_JSON_NODE_POOL_LIMIT 32	// freed parson values, objects and arrays of each kept for reuse outside a scope
+
+typedef struct LP_JSON_ARENA_STATS
+{
+	size_t capacity;			// arena size in bytes
+	size_t highWater;			// most arena bytes used by any one scope
+	size_t lastUsed;			// arena bytes used by the most recent scope
+	unsigned int overflows;		// allocations that did not fit and fell back to malloc
+	// DOM nodes outside a scope, the reported document and other DOMs kept across callbacks, a steady state reuses
+	// every node it frees and allocates none
+	unsigned long nodesReused;		// created from a node kept on parson's free lists
+	unsigned long nodesAllocated;	// created from the heap, the free lists were empty
+	unsigned long nodesReleased;	// freed to the heap, the free lists were full
+	size_t nodesPooled;				// kept now
+} LP_JSON_ARENA_STATS;
+
+void lp_jsonArenaInstall(void);
+void lp_jsonArenaBegin(void);
+void lp_jsonArenaEnd(void);
+// returns the depth to hand back to lp_jsonArenaResume
+int lp_jsonArenaSuspend(void);
+void lp_jsonArenaResume(int depth);
+void lp_getJsonArenaStats(LP_JSON_ARENA_STATS* stats);
@@ -0,0 +1,283 @@
+#include "json_bench.h"
+#include "json_arena.h"
+#include <stdio.h>
+#include <time.h>
+
+#define BATCH_READINGS 32
+#define BATCH_SIZE 4096
+#define BATCH_DOCUMENT 4		// index of the telemetry batch in _documents
+#define WRITER_SIZE 8192		// serialisation buffer reused across iterations, grown outside arena scopes only
+
+typedef struct
+{
+	const char* name;
+	const char* json;
+	size_t length;
+} JSON_BENCH_DOCUMENT;
+
+// representative of what the library parses and builds: the full twin sent on connect with its
+// metadata, a desired property change, telemetry singly and batched, and method payloads
+static const char twinFull[] =
+	"{\"desired\":{"
+	"\"DesiredTemperature\":{\"value\":22.5},"
+	"\"DesiredHumidity\":{\"value\":45},"
+	"\"LedBlinkRate\":{\"value\":2},"
+	"\"RelayEnabled\":{\"value\":true},"
+	"\"DisplayMessage\":{\"value\":\"Hello from IoT Central\"},"
+	"\"$metadata\":{\"$lastUpdated\":\"2026-10-14T08:15:02.3349886Z\",\"$lastUpdatedVersion\":17,"
+	"\"DesiredTemperature\":{\"$lastUpdated\":\"2026-10-14T08:15:02.3349886Z\",\"$lastUpdatedVersion\":17,\"value\":{\"$lastUpdated\":\"2026-10-14T08:15:02.3349886Z\",\"$lastUpdatedVersion\":17}},"
+	"\"DesiredHumidity\":{\"$lastUpdated\":\"2026-10-13T21:40:11.1265433Z\",\"$lastUpdatedVersion\":12,\"value\":{\"$lastUpdated\":\"2026-10-13T21:40:11.1265433Z\",\"$lastUpdatedVersion\":12}},"
+	"\"LedBlinkRate\":{\"$lastUpdated\":\"2026-10-12T10:02:54.9028140Z\",\"$lastUpdatedVersion\":9,\"value\":{\"$lastUpdated\":\"2026-10-12T10:02:54.9028140Z\",\"$lastUpdatedVersion\":9}},"
+	"\"RelayEnabled\":{\"$lastUpdated\":\"2026-10-11T16:27:38.7710928Z\",\"$lastUpdatedVersion\":5,\"value\":{\"$lastUpdated\":\"2026-10-11T16:27:38.7710928Z\",\"$lastUpdatedVersion\":5}},"
+	"\"DisplayMessage\":{\"$lastUpdated\":\"2026-10-10T09:11:07.0047215Z\",\"$lastUpdatedVersion\":3,\"value\":{\"$lastUpdated\":\"2026-10-10T09:11:07.0047215Z\",\"$lastUpdatedVersion\":3}}},"
+	"\"$version\":17},"
+	"\"reported\":{"
+	"\"DesiredTemperature\":{\"value\":22.5,\"ac\":200,\"av\":17,\"ad\":\"completed\"},"
+	"\"DesiredHumidity\":{\"value\":45,\"ac\":200,\"av\":12,\"ad\":\"completed\"},"
+	"\"LedBlinkRate\":{\"value\":2,\"ac\":200,\"av\":9,\"ad\":\"completed\"},"
+	"\"RelayEnabled\":{\"value\":true,\"ac\":200,\"av\":5,\"ad\":\"completed\"},"
+	"\"DisplayMessage\":{\"value\":\"Hello from IoT Central\",\"ac\":200,\"av\":3,\"ad\":\"completed\"},"
+	"\"DeviceStartTimeUtc\":\"2026-10-14T06:00:12.417Z\","
+	"\"SoftwareVersion\":\"1.4.2\","
+	"\"BootTimeline\":[{\"mark\":\"network ready\",\"ms\":1840},{\"mark\":\"provisioned\",\"ms\":3125},{\"mark\":\"authenticated\",\"ms\":3902},{\"mark\":\"first message\",\"ms\":4388}],"
+	"\"$metadata\":{\"$lastUpdated\":\"2026-10-14T08:15:03.9126011Z\","
+	"\"DesiredTemperature\":{\"$lastUpdated\":\"2026-10-14T08:15:03.9126011Z\"},"
+	"\"DesiredHumidity\":{\"$lastUpdated\":\"2026-10-13T21:40:12.6301572Z\"},"
+	"\"LedBlinkRate\":{\"$lastUpdated\":\"2026-10-12T10:02:56.1187734Z\"},"
+	"\"RelayEnabled\":{\"$lastUpdated\":\"2026-10-11T16:27:40.0342219Z\"},"
+	"\"DisplayMessage\":{\"$lastUpdated\":\"2026-10-10T09:11:08.7712653Z\"},"
+	"\"DeviceStartTimeUtc\":{\"$lastUpdated\":\"2026-10-14T06:00:13.0021847Z\"},"
+	"\"SoftwareVersion\":{\"$lastUpdated\":\"2026-10-14T06:00:13.0021847Z\"},"
+	"\"BootTimeline\":{\"$lastUpdated\":\"2026-10-14T06:00:17.5580023Z\"}},"
+	"\"$version\":48}}";
+
+static const char twinPartial[] = "{\"DesiredTemperature\":{\"value\":23.5},\"$version\":18}";
+
+// the settings a desired update carries most, blink rates, enum codes, periods and thresholds, all short numbers
+static const char twinSettings[] =
+	"{\"LedBlinkRate\":{\"value\":2},\"ReportPeriod\":{\"value\":30},\"SamplePeriodMs\":{\"value\":1000},"
+	"\"DisplayMode\":{\"value\":3},\"FanSpeed\":{\"value\":1},\"AlarmCode\":{\"value\":4012},"
+	"\"DesiredTemperature\":{\"value\":22.5},\"DesiredHumidity\":{\"value\":45},\"Hysteresis\":{\"value\":0.25},"
+	"\"TelemetryFidelity\":{\"value\":2},\"ThermostatMode\":{\"value\":1},\"WindowMs\":{\"value\":60000},"
+	"\"Kp\":{\"value\":0.08},\"Ki\":{\"value\":0.002},\"Kd\":{\"value\":1.5},\"$version\":1207}";
+
+static const char telemetry[] =
+	"{\"msgId\":1042,\"temperature\":22.41,\"humidity\":48.2,\"pressure\":1013.62,\"light\":312,"
+	"\"occupied\":true,\"timestamp\":\"2026-10-14T09:30:00.125Z\"}";
+
+static const char methodSmall[] = "{\"duration\":30}";
+
+static const char methodConfig[] =
+	"{\"sampleRateMs\":1000,\"reportIntervalS\":30,"
+	"\"thresholds\":{\"temperature\":{\"low\":18.0,\"high\":28.5},\"humidity\":{\"low\":30,\"high\":70},\"pressure\":{\"low\":980,\"high\":1040}},"
+	"\"channels\":[{\"id\":0,\"name\":\"temperature\",\"enabled\":true},{\"id\":1,\"name\":\"humidity\",\"enabled\":true},"
+	"{\"id\":2,\"name\":\"pressure\",\"enabled\":false},{\"id\":3,\"name\":\"light\",\"enabled\":true}],"
+	"\"label\":\"Building 2, floor 3, room 314\"}";
+
+static char _telemetryBatch[BATCH_SIZE];		// built on first use, as lp_azureMsgBatch sends a batch
+static char _writerBuffer[WRITER_SIZE];
+
+static JSON_BENCH_DOCUMENT _documents[] = {
+	{ "twin_full", twinFull, sizeof(twinFull) - 1 },
+	{ "twin_partial", twinPartial, sizeof(twinPartial) - 1 },
+	{ "twin_settings", twinSettings, sizeof(twinSettings) - 1 },
+	{ "telemetry", telemetry, sizeof(telemetry) - 1 },
+	{ "telemetry_batch", _telemetryBatch, 0 },
+	{ "method_small", methodSmall, sizeof(methodSmall) - 1 },
+	{ "method_config", methodConfig, sizeof(methodConfig) - 1 }
+};
+
+static JSON_Malloc_Function _countedMalloc = NULL;
+static JSON_Free_Function _countedFree = NULL;
+static unsigned long _allocations = 0;
+
+static void* CountingMalloc(size_t size) {
+	_allocations++;
+	return _countedMalloc(size);
+}
+
+static void CountingFree(void* ptr) {
+	_countedFree(ptr);
+}
+
+static double NowSeconds(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static void BuildTelemetryBatch(void) {
+	size_t length = 0;
+
+	for (int i = 0; i < BATCH_READINGS && length + 128 < sizeof(_telemetryBatch); i++) {
+		length += (size_t)snprintf(_telemetryBatch + length, sizeof(_telemetryBatch) - length,
+			"%c{\"msgId\":%d,\"temperature\":%.2f,\"humidity\":%.1f,\"pressure\":%.2f,\"timestamp\":\"2026-10-14T09:%02d:%02d.000Z\"}",
+			i == 0 ? '[' : ',', 1042 + i, 21.5 + i * 0.07, 47.0 + (i % 5) * 0.3, 1013.0 + (i % 7) * 0.11, 30 + i / 60, i % 60);
+	}
+	_telemetryBatch[length++] = ']';
+	_telemetryBatch[length] = 0;
+
+	_documents[BATCH_DOCUMENT].length = length;
+}
+
+static JSON_Sax_Action SkipMember(void* context, const char* name, size_t length, size_t depth) {
+	return JSONSaxSkip;
+}
+
+static const JSON_Sax_Handler skipHandler = { .member = SkipMember, .value = NULL };
+
+static double MBps(size_t bytes, unsigned int iterations, double seconds) {
+	return seconds > 0 ? (double)bytes * iterations / seconds / 1e6 : 0;
+}
+
+size_t lp_jsonBenchDocumentCount(void) {
+	return NELEMS(_documents);
+}
+
+/// <summary>
+///     Parse, walk and serialise one corpus document iterations times. Parson's allocation functions
+///     are wrapped for the run to count allocations and put back afterwards.
+/// </summary>
+bool lp_runJsonBench(size_t document, bool arena, unsigned int iterations, LP_JSON_BENCH_RESULT* result) {
+	LP_JSON_ARENA_STATS arenaBefore, arenaAfter;
+	JSON_BENCH_DOCUMENT* doc;
+	JSON_Writer writer;
+	unsigned long parseAllocations = 0, serializeAllocations = 0, arenaParseOverflows = 0;
+	double parseSeconds = 0, saxSeconds = 0, serializeSeconds = 0, start;
+	size_t serializedBytes = 0;
+	bool saxValid = true, ok = true;
+
+	if (document >= NELEMS(_documents) || iterations == 0 || result == NULL) {
+		return false;
+	}
+
+	if (_documents[BATCH_DOCUMENT].length == 0) {
+		BuildTelemetryBatch();
+	}
+	doc = &_documents[document];
+
+	// the arena installs its allocation functions on first use, install them before wrapping
+	lp_jsonArenaBegin();
+	lp_jsonArenaEnd();
+
+	json_get_allocation_functions(&_countedMalloc, &_countedFree);
+	json_set_allocation_functions(CountingMalloc, CountingFree);
+	// a buffer grown inside an arena scope would be released with the scope
+	json_writer_init(&writer, _writerBuffer, sizeof(_writerBuffer), !arena);
+
+	for (unsigned int i = 0; i < iterations && ok; i++) {
+		JSON_Value* value;
+
+		if (arena) {
+			lp_jsonArenaBegin();
+			lp_getJsonArenaStats(&arenaBefore);
+		}
+
+		_allocations = 0;
+		start = NowSeconds();
+		value = json_parse_stringn(doc->json, doc->length);
+		parseSeconds += NowSeconds() - start;
+		parseAllocations += _allocations;
+
+		if (arena) {
+			lp_getJsonArenaStats(&arenaAfter);
+			arenaParseOverflows += arenaAfter.overflows - arenaBefore.overflows;
+		}
+
+		if (value == NULL) {
+			ok = false;
+		} else {
+			json_writer_reset(&writer);
+			_allocations = 0;
+			start = NowSeconds();
+			ok = json_serialize_to_writer(value, &writer) == JSONSuccess;
+			serializeSeconds += NowSeconds() - start;
+			serializeAllocations += _allocations;
+			serializedBytes = writer.length;
+			json_value_free(value);
+		}
+
+		if (arena) {
+			lp_jsonArenaEnd();
+		}
+
+		if (saxValid) {
+			start = NowSeconds();
+			saxValid = json_parse_sax(doc->json, doc->length, &skipHandler, NULL) == JSONSuccess;
+			saxSeconds += NowSeconds() - start;
+		}
+	}
+
+	json_writer_free(&writer);
+	json_set_allocation_functions(_countedMalloc, _countedFree);
+
+	result->document = doc->name;
+	result->arena = arena;
+	result->bytes = doc->length;
+	result->serializedBytes = serializedBytes;
+	result->iterations = iterations;
+	result->parseMBps = MBps(doc->length, iterations, parseSeconds);
+	result->saxMBps = saxValid ? MBps(doc->length, iterations, saxSeconds) : 0;
+	result->serializeMBps = MBps(serializedBytes, iterations, serializeSeconds);
+	result->parseAllocs = (double)(arena ? arenaParseOverflows : parseAllocations) / iterations;
+	result->serializeAllocs = (double)serializeAllocations / iterations;
+
+	return ok;
+}
+
+/// <summary>
+///     One CSV row matching LP_JSON_BENCH_CSV_HEADER, no newline
+/// </summary>
+int lp_formatJsonBenchResult(const LP_JSON_BENCH_RESULT* result, char* buffer, size_t size) {
+	return snprintf(buffer, size, "%s,%d,%zu,%u,%.2f,%.2f,%.2f,%.1f,%.1f", result->document, result->arena, result->bytes,
+		result->iterations, result->parseMBps, result->saxMBps, result->serializeMBps, result->parseAllocs, result->serializeAllocs);
+}
+
+/// <summary>
+///     JsonBenchmark direct method, {"iterations":n} optional. Logs a CSV row per document and arena setting and
+///     answers with the throughput over the whole corpus.
+/// </summary>
+static LP_DIRECT_METHOD_RESPONSE_CODE JsonBenchHandler(JSON_Object* json, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg) {
+	unsigned int iterations = LP_JSON_BENCH_ITERATIONS;
+	double parseSeconds = 0, serializeSeconds = 0, allocations = 0;
+	size_t bytes = 0, serializedBytes = 0;
+	char row[160];
+
+	if (json_object_has_value_of_type(json, "iterations", JSONNumber)) {
+		double requested = json_object_get_number(json, "iterations");
+		iterations = requested < 1 ? 1 : requested > LP_JSON_BENCH_MAX_ITERATIONS ? LP_JSON_BENCH_MAX_ITERATIONS : (unsigned int)requested;
+	}
+
+	Log_Debug("%s\n", LP_JSON_BENCH_CSV_HEADER);
+
+	for (size_t i = 0; i < lp_jsonBenchDocumentCount(); i++) {
+		for (int arena = 0; arena <= 1; arena++) {
+			LP_JSON_BENCH_RESULT result;
+
+			if (!lp_runJsonBench(i, arena, iterations, &result)) {
+				lp_setMethodResponse("Benchmark of %s failed", _documents[i].name);
+				return LP_METHOD_FAILED;
+			}
+
+			lp_formatJsonBenchResult(&result, row, sizeof(row));
+			Log_Debug("%s\n", row);
+
+			// the corpus totals weight each document by its size, from the time one iteration took
+			if (!arena) {
+				bytes += result.bytes;
+				serializedBytes += result.serializedBytes;
+				parseSeconds += result.parseMBps > 0 ? result.bytes / (result.parseMBps * 1e6) : 0;
+				serializeSeconds += result.serializeMBps > 0 ? result.serializedBytes / (result.serializeMBps * 1e6) : 0;
+				allocations += result.parseAllocs;
+			}
+		}
+	}
+
+	lp_setMethodResponse("%zu documents, %zu bytes: parse %.2f MB/s, serialize %.2f MB/s, %.1f allocations per parse",
+		lp_jsonBenchDocumentCount(), bytes, parseSeconds > 0 ? bytes / parseSeconds / 1e6 : 0,
+		serializeSeconds > 0 ? serializedBytes / serializeSeconds / 1e6 : 0, allocations / lp_jsonBenchDocumentCount());
+
+	return LP_METHOD_SUCCEEDED;
+}
+
+LP_DIRECT_METHOD_BINDING lp_jsonBenchDirectMethod = { .methodName = "JsonBenchmark", .handler = JsonBenchHandler };
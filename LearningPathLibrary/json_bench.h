@@ -0,0 +1,30 @@
+#pragma once
+
+#include "direct_methods.h"
+#include "parson.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define LP_JSON_BENCH_ITERATIONS 20			// per document when the JsonBenchmark method names none
+#define LP_JSON_BENCH_MAX_ITERATIONS 1000	// the method runs inside the event loop, keep it bounded
+#define LP_JSON_BENCH_CSV_HEADER "document,arena,bytes,iterations,parse_mbps,sax_mbps,serialize_mbps,parse_allocs,serialize_allocs"
+
+typedef struct LP_JSON_BENCH_RESULT
+{
+	const char* document;
+	bool arena;					// parsed and serialised inside a json_arena.h scope
+	size_t bytes;
+	size_t serializedBytes;		// compact output, whitespace in the document is not reproduced
+	unsigned int iterations;
+	double parseMBps;			// json_parse_stringn to a DOM
+	double saxMBps;				// json_parse_sax skipping every member, 0 for documents that are not an object
+	double serializeMBps;		// json_serialize_to_writer into a reused buffer
+	double parseAllocs;			// heap allocations per parse, arena scopes count only the ones that overflowed
+	double serializeAllocs;
+} LP_JSON_BENCH_RESULT;
+
+extern LP_DIRECT_METHOD_BINDING lp_jsonBenchDirectMethod;	// optional, add to the direct method set to benchmark parson on the device
+
+size_t lp_jsonBenchDocumentCount(void);
+bool lp_runJsonBench(size_t document, bool arena, unsigned int iterations, LP_JSON_BENCH_RESULT* result);
+int lp_formatJsonBenchResult(const LP_JSON_BENCH_RESULT* result, char* buffer, size_t size);
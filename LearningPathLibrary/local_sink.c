@@ -0,0 +1,84 @@
+#include "local_sink.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static int _sinkFd = -1;
+static struct sockaddr_in _sinkAddress;
+static LP_LOCAL_SINK_STATS _sinkStats;
+
+/// <summary>
+///     Open the sink to address:port, a dotted IPv4 address. ttl, zero or less for LP_LOCAL_SINK_TTL, bounds how
+///     many routers a multicast datagram crosses and is ignored for a unicast address.
+/// </summary>
+bool lp_openLocalSink(const char* address, uint16_t port, int ttl) {
+	struct sockaddr_in sinkAddress = { .sin_family = AF_INET, .sin_port = htons(port) };
+
+	if (address == NULL || port == 0 || inet_pton(AF_INET, address, &sinkAddress.sin_addr) != 1) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: Local sink address is not an IPv4 address and port\n");
+		return false;
+	}
+
+	lp_closeLocalSink();
+
+	if ((_sinkFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) == -1) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: Unable to create the local sink socket: %d (%s)\n", errno, strerror(errno));
+		return false;
+	}
+
+	if (IN_MULTICAST(ntohl(sinkAddress.sin_addr.s_addr))) {
+		unsigned char hops = (unsigned char)(ttl > 0 ? (ttl > 255 ? 255 : ttl) : LP_LOCAL_SINK_TTL);
+
+		if (setsockopt(_sinkFd, IPPROTO_IP, IP_MULTICAST_TTL, &hops, sizeof(hops)) == -1) {
+			LP_LOG(LP_LOG_ERROR, "ERROR: Unable to set the local sink multicast TTL: %d (%s)\n", errno, strerror(errno));
+			lp_closeLocalSink();
+			return false;
+		}
+	}
+
+	_sinkAddress = sinkAddress;
+	return true;
+}
+
+void lp_closeLocalSink(void) {
+	if (_sinkFd != -1) {
+		close(_sinkFd);
+		_sinkFd = -1;
+	}
+}
+
+bool lp_isLocalSinkOpen(void) {
+	return _sinkFd != -1;
+}
+
+bool lp_publishLocal(const void* msg, size_t length) {
+	if (_sinkFd == -1 || msg == NULL || length == 0) {
+		return false;
+	}
+
+	if (length > LP_LOCAL_SINK_MAX_DATAGRAM) {
+		_sinkStats.oversize++;
+		return false;
+	}
+
+	if (sendto(_sinkFd, msg, length, 0, (const struct sockaddr*)&_sinkAddress, sizeof(_sinkAddress)) == -1) {
+		_sinkStats.dropped++;
+		if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			LP_LOG_LIMITED(LP_LOG_WARNING, LP_LOG_LIMIT_MS, "WARNING: local sink send failed: %d (%s)\n", errno, strerror(errno));
+		}
+		return false;
+	}
+
+	_sinkStats.published++;
+	_sinkStats.bytes += length;
+	return true;
+}
+
+void lp_getLocalSinkStats(LP_LOCAL_SINK_STATS* stats) {
+	if (stats != NULL) {
+		*stats = _sinkStats;
+	}
+}
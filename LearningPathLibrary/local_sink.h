@@ -0,0 +1,33 @@
+#pragma once
+
+#include "logging.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LP_LOCAL_SINK_MAX_DATAGRAM 1472		// an Ethernet frame less the IP and UDP headers, larger messages are not sent
+#define LP_LOCAL_SINK_TTL 1					// lp_openLocalSink default for a multicast group, stays on the local subnet
+
+typedef struct LP_LOCAL_SINK_STATS
+{
+	uint32_t published;
+	uint32_t dropped;				// the socket buffer was full or the send failed, never retried
+	uint32_t oversize;				// over LP_LOCAL_SINK_MAX_DATAGRAM
+	uint64_t bytes;
+} LP_LOCAL_SINK_STATS;
+
+// A low latency copy of telemetry for consumers on the LAN, a PLC dashboard or on-premises gateway that can not
+// wait for the round trip through IoT Hub. Once the sink is open every message given to lp_sendMsg,
+// lp_sendMsgWithPriority, lp_sendMsgWithProperties or lp_enqueueTelemetry is sent as one UDP datagram to the
+// address, a unicast gateway or an IPv4 multicast group, as it is handed in and before it joins the telemetry
+// batch, so the LAN sees each reading at once and the hub sees the batch. Flushed batches are not sent again.
+//
+// Delivery is best effort: the socket is non-blocking, a datagram that does not fit the socket buffer is dropped and
+// counted, nothing is queued while the network is down. The app manifest needs the gateway address, or for
+// multicast the group, in "AllowedConnections".
+bool lp_openLocalSink(const char* address, uint16_t port, int ttl);
+void lp_closeLocalSink(void);
+bool lp_isLocalSinkOpen(void);
+// false when the sink is closed or the message was not sent
+bool lp_publishLocal(const void* msg, size_t length);
+void lp_getLocalSinkStats(LP_LOCAL_SINK_STATS* stats);
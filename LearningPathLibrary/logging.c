@@ -0,0 +1,49 @@
+#include "logging.h"
+
+static int _logLevel = LP_LOG_LEVEL;
+static uint32_t _suppressed = 0;
+
+/// <summary>
+///     Log only messages at level or more severe, a level above LP_LOG_LEVEL has no effect as those calls were compiled out
+/// </summary>
+void lp_setLogLevel(int level) {
+	_logLevel = level;
+}
+
+int lp_getLogLevel(void) {
+	return _logLevel;
+}
+
+/// <summary>
+///     True when the call site last logged at least intervalMs ago, reports the messages dropped in between first
+/// </summary>
+bool lp_logLimit(LP_LOG_LIMIT* limit, int intervalMs) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	if (limit->logged) {
+		int64_t elapsedMs = ((int64_t)now.tv_sec - limit->loggedAt.tv_sec) * 1000 + (now.tv_nsec - limit->loggedAt.tv_nsec) / 1000000;
+		if (elapsedMs < intervalMs) {
+			limit->suppressed++;
+			_suppressed++;
+			return false;
+		}
+	}
+
+	if (limit->suppressed > 0) {
+		Log_Debug("(%u similar messages not logged)\n", limit->suppressed);
+	}
+
+	limit->logged = true;
+	limit->loggedAt = now;
+	limit->suppressed = 0;
+
+	return true;
+}
+
+/// <summary>
+///     Messages dropped by LP_LOG_LIMITED since start
+/// </summary>
+uint32_t lp_getLogSuppressed(void) {
+	return _suppressed;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <applibs/log.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#define LP_LOG_NONE 0
+#define LP_LOG_ERROR 1
+#define LP_LOG_WARNING 2
+#define LP_LOG_INFO 3
+#define LP_LOG_DEBUG 4
+
+// Least severe level compiled in, set by the azsphere_libs LP_LOG_LEVEL CMake option. A call above it is removed
+// by the compiler with its format string and arguments, lp_setLogLevel lowers the level further at run time.
+#ifndef LP_LOG_LEVEL
+#define LP_LOG_LEVEL LP_LOG_INFO
+#endif
+
+#define LP_LOG_LIMIT_MS 10000		// LP_LOG_LIMITED interval for messages that repeat while a fault lasts
+
+typedef struct {
+	bool logged;
+	struct timespec loggedAt;
+	uint32_t suppressed;		// calls since loggedAt that were not formatted
+} LP_LOG_LIMIT;
+
+void lp_setLogLevel(int level);
+int lp_getLogLevel(void);
+bool lp_logLimit(LP_LOG_LIMIT* limit, int intervalMs);
+uint32_t lp_getLogSuppressed(void);
+
+#define LP_LOG(_level, ...) \
+	do { \
+		if ((_level) <= LP_LOG_LEVEL && (_level) <= lp_getLogLevel()) { \
+			Log_Debug(__VA_ARGS__); \
+		} \
+	} while (0)
+
+// at most one message from this call site per intervalMs, the next one logged says how many were dropped
+#define LP_LOG_LIMITED(_level, _intervalMs, ...) \
+	do { \
+		static LP_LOG_LIMIT _lpLogLimit; \
+		if ((_level) <= LP_LOG_LEVEL && (_level) <= lp_getLogLevel() && lp_logLimit(&_lpLogLimit, (_intervalMs))) { \
+			Log_Debug(__VA_ARGS__); \
+		} \
+	} while (0)
@@ -0,0 +1,146 @@
+#include "memory_governor.h"
+#include "azure_iot.h"
+
+static void MemoryGovernorHandler(EventLoopTimer* eventLoopTimer);
+
+static LP_MEMORY_WATERMARKS _watermarks;
+static LP_MEMORY_GOVERNOR_STATS _memoryStats;
+
+static LP_TIMER memoryGovernorTimer = {
+	.period = { 1, 0 },			// LP_MEMORY_DEFAULT_PERIOD_MS unless lp_startMemoryGovernor is given a period
+	.name = "memoryGovernorTimer",
+	.handler = &MemoryGovernorHandler
+};
+
+static const char* LevelName(LP_MEMORY_LEVEL level) {
+	return level == LP_MEMORY_CRITICAL ? "critical" : level == LP_MEMORY_ELEVATED ? "elevated" : "normal";
+}
+
+static uint32_t BelowWatermark(uint32_t watermark) {
+	return (uint32_t)(watermark - (uint64_t)watermark * LP_MEMORY_HYSTERESIS_PERCENT / 100);
+}
+
+/// <summary>
+///     The level one measure is at, a watermark raises it once reached and it stays until below the hysteresis band
+/// </summary>
+static LP_MEMORY_LEVEL LevelFor(uint32_t value, uint32_t elevated, uint32_t critical, LP_MEMORY_LEVEL current) {
+	if (critical > 0 && (value >= critical || (current == LP_MEMORY_CRITICAL && value > BelowWatermark(critical)))) {
+		return LP_MEMORY_CRITICAL;
+	}
+
+	if (elevated > 0 && (value >= elevated || (current >= LP_MEMORY_ELEVATED && value > BelowWatermark(elevated)))) {
+		return LP_MEMORY_ELEVATED;
+	}
+
+	return LP_MEMORY_NORMAL;
+}
+
+/// <summary>
+///     Sample both measures, move to the higher of their levels and shed what the level sheds
+/// </summary>
+static void SampleMemory(void) {
+	LP_HEAP_STATS heap;
+	LP_MEMORY_LEVEL level, libraryLevel;
+
+	_memoryStats.totalKB = (uint32_t)Applications_GetTotalMemoryUsageInKB();
+	if (_memoryStats.totalKB > _memoryStats.peakTotalKB) {
+		_memoryStats.peakTotalKB = _memoryStats.totalKB;
+	}
+
+	if (_watermarks.libraryElevatedBytes > 0 || _watermarks.libraryCriticalBytes > 0) {
+		lp_getHeapStats(&heap);
+		_memoryStats.libraryBytes = heap.total.bytes;
+	}
+
+	level = LevelFor(_memoryStats.totalKB, _watermarks.elevatedKB, _watermarks.criticalKB, _memoryStats.level);
+	libraryLevel = LevelFor(_memoryStats.libraryBytes, _watermarks.libraryElevatedBytes, _watermarks.libraryCriticalBytes, _memoryStats.level);
+	level = libraryLevel > level ? libraryLevel : level;
+
+	if (level != _memoryStats.level) {
+		if (level > _memoryStats.level) {
+			_memoryStats.elevations += _memoryStats.level == LP_MEMORY_NORMAL ? 1 : 0;
+			_memoryStats.criticals += level == LP_MEMORY_CRITICAL ? 1 : 0;
+		}
+
+		LP_LOG(level > _memoryStats.level ? LP_LOG_WARNING : LP_LOG_INFO, "Memory %s, %u KB in use, library %u bytes\n",
+			LevelName(level), _memoryStats.totalKB, _memoryStats.libraryBytes);
+
+		lp_scaleTelemetryBatch(level == LP_MEMORY_CRITICAL ? 4 : level == LP_MEMORY_ELEVATED ? 2 : 1);
+		_memoryStats.level = level;
+	}
+
+	// every sample, messages queued since the last are shed too
+	if (level >= LP_MEMORY_ELEVATED) {
+		_memoryStats.shedBulk += (uint32_t)lp_offlineQueueShed(LP_PRIORITY_BULK);
+	}
+
+	if (level == LP_MEMORY_CRITICAL) {
+		_memoryStats.shedNormal += (uint32_t)lp_offlineQueueShed(LP_PRIORITY_NORMAL);
+	}
+}
+
+static void MemoryGovernorHandler(EventLoopTimer* eventLoopTimer) {
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_MemoryGovernorHandler);
+		return;
+	}
+
+	SampleMemory();
+}
+
+/// <summary>
+///     Sample every periodMs, zero or less for LP_MEMORY_DEFAULT_PERIOD_MS, restarting applies new watermarks
+/// </summary>
+bool lp_startMemoryGovernor(const LP_MEMORY_WATERMARKS* watermarks, int periodMs) {
+	if (watermarks == NULL) {
+		return false;
+	}
+
+	_watermarks = *watermarks;
+
+	if (_watermarks.libraryElevatedBytes > 0 || _watermarks.libraryCriticalBytes > 0) {
+		lp_enableHeapAccounting(true);
+	}
+
+	if (memoryGovernorTimer.eventLoopTimer != NULL) {
+		SampleMemory();
+		return true;
+	}
+
+	periodMs = periodMs > 0 ? periodMs : LP_MEMORY_DEFAULT_PERIOD_MS;
+	memoryGovernorTimer.period = (struct timespec){ periodMs / 1000, (periodMs % 1000) * 1000000 };
+
+	if (!lp_startTimer(&memoryGovernorTimer)) {
+		return false;
+	}
+
+	SampleMemory();
+	return true;
+}
+
+void lp_stopMemoryGovernor(void) {
+	if (memoryGovernorTimer.eventLoopTimer != NULL) {
+		lp_stopTimer(&memoryGovernorTimer);
+	}
+
+	lp_scaleTelemetryBatch(1);
+	_memoryStats.level = LP_MEMORY_NORMAL;
+}
+
+LP_MEMORY_LEVEL lp_getMemoryLevel(void) {
+	return _memoryStats.level;
+}
+
+bool lp_memoryAdmitPayload(size_t bytes) {
+	if (_memoryStats.level == LP_MEMORY_NORMAL || _watermarks.maxPayloadBytes == 0 || bytes <= _watermarks.maxPayloadBytes) {
+		return true;
+	}
+
+	_memoryStats.refusedPayloads++;
+	LP_LOG_LIMITED(LP_LOG_WARNING, LP_LOG_LIMIT_MS, "Memory %s, %zu byte payload refused\n", LevelName(_memoryStats.level), bytes);
+	return false;
+}
+
+void lp_getMemoryGovernorStats(LP_MEMORY_GOVERNOR_STATS* stats) {
+	*stats = _memoryStats;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "heap_stats.h"
+#include "logging.h"
+#include "offline_queue.h"
+#include "terminate.h"
+#include "timer.h"
+#include <applibs/application.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LP_MEMORY_DEFAULT_PERIOD_MS 1000
+#define LP_MEMORY_HYSTERESIS_PERCENT 10		// a level is left once usage is this far below the watermark that raised it
+
+typedef enum {
+	LP_MEMORY_NORMAL,
+	LP_MEMORY_ELEVATED,			// queued bulk telemetry shed, batches halved, oversized payloads refused
+	LP_MEMORY_CRITICAL			// and queued normal telemetry spilled or shed, batches a quarter
+} LP_MEMORY_LEVEL;
+
+typedef struct LP_MEMORY_WATERMARKS
+{
+	uint32_t elevatedKB;					// Applications_GetTotalMemoryUsageInKB, 0 for no watermark
+	uint32_t criticalKB;
+	uint32_t libraryElevatedBytes;			// the library's own live heap, LP_HEAP_STATS total, 0 for no watermark
+	uint32_t libraryCriticalBytes;
+	size_t maxPayloadBytes;					// direct method and cloud to device payloads refused above this unless normal
+} LP_MEMORY_WATERMARKS;
+
+typedef struct LP_MEMORY_GOVERNOR_STATS
+{
+	LP_MEMORY_LEVEL level;
+	uint32_t totalKB;						// the last sample
+	uint32_t peakTotalKB;
+	uint32_t libraryBytes;
+	uint32_t elevations;					// NORMAL to ELEVATED or above
+	uint32_t criticals;						// to CRITICAL
+	uint32_t shedBulk;						// queued messages released from RAM, bulk dropped
+	uint32_t shedNormal;					// normal spilled, or dropped without spilling
+	uint32_t refusedPayloads;
+} LP_MEMORY_GOVERNOR_STATS;
+
+// Sheds load before the app reaches its memory limit and the OS kills it. Every periodMs the app's total memory
+// and the library's live heap are sampled against the watermarks, the higher of the two levels applies. Above
+// elevated, queued bulk telemetry is dropped every sample, telemetry batches flush at half size, and direct method
+// and cloud to device payloads over maxPayloadBytes are refused, 413 and rejected, so the sender can retry later.
+// Above critical, queued normal telemetry also leaves RAM, spilled to mutable storage when the offline queue spills,
+// and batches flush at a quarter. A level is left LP_MEMORY_HYSTERESIS_PERCENT below its watermark. Twin documents
+// are not refused, the SDK already holds the document and dropping it would lose desired state.
+//
+// Library watermarks turn on heap accounting, lp_enableHeapAccounting.
+bool lp_startMemoryGovernor(const LP_MEMORY_WATERMARKS* watermarks, int periodMs);
+void lp_stopMemoryGovernor(void);
+LP_MEMORY_LEVEL lp_getMemoryLevel(void);
+// false, and counted, when a payload of this size should be refused at the current level
+bool lp_memoryAdmitPayload(size_t bytes);
+void lp_getMemoryGovernorStats(LP_MEMORY_GOVERNOR_STATS* stats);
@@ -0,0 +1,21 @@
+#pragma once
+
+// Layout of the application's one mutable storage file, shared by the library modules that persist state. Each
+// module opens the file itself and only reads, writes and truncates its own region.
+//
+//   [0, LP_STORAGE_HISTORY_OFFSET)                        device twin warm start cache, see lp_enableDeviceTwinCache
+//   [LP_STORAGE_HISTORY_OFFSET, LP_STORAGE_SPILL_OFFSET)  sample history ring, see lp_openHistory, none by default
+//   [LP_STORAGE_SPILL_OFFSET, ...)                        offline queue spill journal, maxSpillBytes, see storage_journal.h
+//
+// The manifest's "MutableStorage": { "SizeKB": n } must cover LP_STORAGE_SPILL_OFFSET plus maxSpillBytes. The spill
+// is last because its size is only known at run time. Reserving a history moves the spill, a spill written with
+// another reservation or size is not recovered.
+#ifndef LP_HISTORY_KB
+#define LP_HISTORY_KB 0				// set by the azsphere_libs LP_HISTORY_KB CMake option
+#endif
+
+#define LP_STORAGE_TWIN_CACHE_OFFSET 0
+#define LP_STORAGE_TWIN_CACHE_SIZE 1024
+#define LP_STORAGE_HISTORY_OFFSET (LP_STORAGE_TWIN_CACHE_OFFSET + LP_STORAGE_TWIN_CACHE_SIZE)
+#define LP_STORAGE_HISTORY_SIZE (LP_HISTORY_KB * 1024)
+#define LP_STORAGE_SPILL_OFFSET (LP_STORAGE_HISTORY_OFFSET + LP_STORAGE_HISTORY_SIZE)
@@ -0,0 +1,102 @@
+#include "network_state.h"
+
+static void NetworkStateHandler(EventLoopTimer* eventLoopTimer);
+
+static LP_TIMER networkStateTimer = {
+	.period = { 0, 0 },			// one-shot timer, rearmed with the adaptive period after each refresh
+	.name = "networkStateTimer",
+	.handler = &NetworkStateHandler
+};
+
+static bool _networkReady = false;
+static bool _networkStateValid = false;
+static int _pollPeriodMs = LP_NETWORK_POLL_DOWN_MS;
+static void (*_networkStateCallback)(bool networkReady) = NULL;
+
+static void ArmNetworkStateTimer(void) {
+	if (networkStateTimer.eventLoopTimer == NULL && !lp_startTimer(&networkStateTimer)) {
+		return;
+	}
+
+	// the up period has slack so the check shares a wakeup with other work, a down network is watched closely
+	int slackMs = _networkReady ? _pollPeriodMs / 4 : 0;
+	lp_setTimerSlack(&networkStateTimer, &(struct timespec){slackMs / 1000, (slackMs % 1000) * 1000000});
+	lp_setOneShotTimer(&networkStateTimer, &(struct timespec){_pollPeriodMs / 1000, (_pollPeriodMs % 1000) * 1000000});
+}
+
+/// <summary>
+///     Read networking readiness now, logs and calls the state callback on a change and restarts the adaptive period
+/// </summary>
+bool lp_refreshNetworkState(void) {
+	bool isNetworkReady = false;
+	bool wasValid = _networkStateValid;
+	bool wasReady = _networkReady;
+
+	if (Networking_IsNetworkingReady(&isNetworkReady) == -1) {
+		if (!wasValid || wasReady) {
+			LP_LOG(LP_LOG_ERROR, "Failed to get Network state\n");
+		}
+		isNetworkReady = false;
+	}
+
+	_networkReady = isNetworkReady;
+	_networkStateValid = true;
+
+	if (!wasValid || wasReady != isNetworkReady) {
+		if (isNetworkReady) {
+			LP_LOG(LP_LOG_INFO, "INFO: Network ready\n");
+		} else {
+			LP_LOG(LP_LOG_WARNING, "\nNetwork not ready.\nFrom azure sphere command prompt, run azsphere device wifi show-status\n\n");
+		}
+
+		_pollPeriodMs = isNetworkReady ? LP_NETWORK_POLL_UP_MIN_MS : LP_NETWORK_POLL_DOWN_MS;
+
+		if (wasValid && _networkStateCallback != NULL) {
+			_networkStateCallback(isNetworkReady);
+		}
+	} else if (isNetworkReady && _pollPeriodMs < LP_NETWORK_POLL_UP_MAX_MS) {
+		_pollPeriodMs = _pollPeriodMs * 2 > LP_NETWORK_POLL_UP_MAX_MS ? LP_NETWORK_POLL_UP_MAX_MS : _pollPeriodMs * 2;
+	}
+
+	ArmNetworkStateTimer();
+
+	return isNetworkReady;
+}
+
+/// <summary>
+///     Cached networking readiness, read on first use and kept current by the network state timer
+/// </summary>
+bool lp_isNetworkReady(void) {
+	if (!_networkStateValid) {
+		return lp_refreshNetworkState();
+	}
+	return _networkReady;
+}
+
+/// <summary>
+///     Set the readiness change callback, it is called once straight away with the current state
+/// </summary>
+void lp_setNetworkStateCallback(void (*callback)(bool networkReady)) {
+	_networkStateCallback = callback;
+
+	if (callback != NULL) {
+		callback(lp_isNetworkReady());
+	}
+}
+
+void lp_stopNetworkState(void) {
+	if (networkStateTimer.eventLoopTimer != NULL) {
+		lp_stopTimer(&networkStateTimer);
+	}
+	_networkStateValid = false;
+	_networkStateCallback = NULL;
+}
+
+static void NetworkStateHandler(EventLoopTimer* eventLoopTimer) {
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_NetworkStateHandler);
+		return;
+	}
+
+	lp_refreshNetworkState();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "logging.h"
+#include "terminate.h"
+#include "timer.h"
+#include <applibs/log.h>
+#include <applibs/networking.h>
+#include <stdbool.h>
+
+#define LP_NETWORK_POLL_DOWN_MS 1000		// refresh period while the network is not ready
+#define LP_NETWORK_POLL_UP_MIN_MS 5000		// while ready the period doubles from here after each unchanged refresh
+#define LP_NETWORK_POLL_UP_MAX_MS 60000
+
+// Networking readiness cached by the library. One timer refreshes it with Networking_IsNetworkingReady, every
+// second while the network is down and backing off to a minute while it stays up, so lp_isNetworkReady is a
+// flag check. The connection state machine refreshes it straight away after a failed connection.
+bool lp_isNetworkReady(void);
+bool lp_refreshNetworkState(void);
+// called from the event loop when readiness changes, replaces polling lp_isNetworkReady from an app timer
+void lp_setNetworkStateCallback(void (*callback)(bool networkReady));
+void lp_stopNetworkState(void);
@@ -0,0 +1,312 @@
+#include "offline_queue.h"
+
+static const char* SpillPeek(void);
+static char* RingRemoveOldest(LP_MESSAGE_PRIORITY priority);
+
+typedef struct {
+	char** slots;
+	size_t head;
+	size_t count;
+} PRIORITY_RING;
+
+// one ring per priority class, all sharing the maxMessages and maxBytes budget
+static PRIORITY_RING _rings[LP_PRIORITY_CLASSES];
+static char** _slots = NULL;
+static size_t _slotCount = 0;
+static size_t _count = 0;
+static size_t _bytes = 0;
+static size_t _maxBytes = 0;
+static size_t _dropped = 0;
+
+// spilled messages, their terminators included, and lp_offlineQueueSetState, written in batches
+static LP_JOURNAL _spill = { .name = "offlineQueueSpill", .offset = LP_STORAGE_SPILL_OFFSET };
+
+/// <summary>
+///     Open a bounded RAM queue of up to maxMessages pending messages consuming at most maxBytes.
+///     When maxSpillBytes is non zero the oldest messages are spilled to the mutable storage file
+///     rather than dropped when the RAM queue is full. Spilled messages survive an application restart.
+///     The app_manifest.json must include "MutableStorage": { "SizeKB": n } to enable spilling, the spill area
+///     starts LP_STORAGE_SPILL_OFFSET bytes into the file and is a journal, see storage_journal.h, of at least
+///     LP_JOURNAL_MIN_SIZE bytes.
+/// </summary>
+bool lp_openOfflineQueue(size_t maxMessages, size_t maxBytes, size_t maxSpillBytes) {
+	if (_slots != NULL) {
+		return true;
+	}
+
+	if (maxMessages < 1 || maxBytes < 1) {
+		return false;
+	}
+
+	_slots = (char**)lp_heapCalloc(LP_HEAP_OFFLINE_QUEUE, maxMessages * LP_PRIORITY_CLASSES, sizeof(char*));
+	if (_slots == NULL) {
+		return false;
+	}
+
+	for (int i = 0; i < LP_PRIORITY_CLASSES; i++) {
+		_rings[i].slots = _slots + i * maxMessages;
+		_rings[i].head = _rings[i].count = 0;
+	}
+
+	_slotCount = maxMessages;
+	_maxBytes = maxBytes;
+	_count = _bytes = _dropped = 0;
+
+	// messages spilled before the last restart are recovered
+	if (maxSpillBytes > 0) {
+		_spill.size = (uint32_t)maxSpillBytes;
+		if (!lp_openJournal(&_spill)) {
+			LP_LOG(LP_LOG_WARNING, "WARNING: Offline queue unable to open the spill journal. Spilling disabled\n");
+		}
+	}
+
+	return true;
+}
+
+void lp_closeOfflineQueue(void) {
+	if (_slots != NULL) {
+		for (int i = 0; i < LP_PRIORITY_CLASSES; i++) {
+			while (_rings[i].count > 0) {
+				lp_heapFree(LP_HEAP_OFFLINE_QUEUE, RingRemoveOldest((LP_MESSAGE_PRIORITY)i));
+			}
+		}
+		lp_heapFree(LP_HEAP_OFFLINE_QUEUE, _slots);
+		_slots = NULL;
+	}
+
+	lp_closeJournal(&_spill);
+
+	_slotCount = _bytes = 0;
+}
+
+static char* RingRemoveOldest(LP_MESSAGE_PRIORITY priority) {
+	PRIORITY_RING* ring = &_rings[priority];
+	char* oldest = ring->slots[ring->head];
+
+	ring->slots[ring->head] = NULL;
+	ring->head = (ring->head + 1) % _slotCount;
+	ring->count--;
+	_bytes -= strlen(oldest) + 1;
+	_count--;
+
+	return oldest;
+}
+
+/// <summary>
+///     Make room for a message of the given priority. Bulk messages are dropped first, then the oldest
+///     normal and finally critical messages are spilled to mutable storage if enabled, otherwise dropped.
+///     A message never evicts one of higher priority, returns false if msg itself should be dropped.
+/// </summary>
+static bool EvictFor(LP_MESSAGE_PRIORITY priority) {
+	char* victim;
+
+	if (_rings[LP_PRIORITY_BULK].count > 0) {
+		lp_heapFree(LP_HEAP_OFFLINE_QUEUE, RingRemoveOldest(LP_PRIORITY_BULK));
+		_dropped++;
+		return true;
+	}
+
+	if (priority == LP_PRIORITY_BULK) {
+		return false;
+	}
+
+	if (_rings[LP_PRIORITY_NORMAL].count > 0) {
+		victim = RingRemoveOldest(LP_PRIORITY_NORMAL);
+	}
+	else if (priority == LP_PRIORITY_CRITICAL && _rings[LP_PRIORITY_CRITICAL].count > 0) {
+		victim = RingRemoveOldest(LP_PRIORITY_CRITICAL);
+	}
+	else {
+		return false;
+	}
+
+	if (!lp_journalAppend(&_spill, victim, strlen(victim) + 1)) {
+		_dropped++;
+	}
+	lp_heapFree(LP_HEAP_OFFLINE_QUEUE, victim);
+
+	return true;
+}
+
+/// <summary>
+///     Queue a copy of msg in its priority class. When the RAM queue is full room is made by EvictFor.
+/// </summary>
+bool lp_offlineQueuePush(const char* msg, LP_MESSAGE_PRIORITY priority) {
+	size_t msgLength;
+
+	if (_slots == NULL || msg == NULL || priority < 0 || priority >= LP_PRIORITY_CLASSES) {
+		return false;
+	}
+
+	msgLength = strlen(msg) + 1;
+	if (msgLength > _maxBytes) {
+		_dropped++;
+		return false;
+	}
+
+	while (_count == _slotCount || _bytes + msgLength > _maxBytes) {
+		if (!EvictFor(priority)) {
+			_dropped++;
+			return false;
+		}
+	}
+
+	char* copy = (char*)lp_heapMalloc(LP_HEAP_OFFLINE_QUEUE, msgLength);
+	if (copy == NULL) {
+		_dropped++;
+		return false;
+	}
+	memcpy(copy, msg, msgLength);
+
+	PRIORITY_RING* ring = &_rings[priority];
+	ring->slots[(ring->head + ring->count) % _slotCount] = copy;
+	ring->count++;
+	_bytes += msgLength;
+	_count++;
+
+	return true;
+}
+
+/// <summary>
+///     Returns the next message to send without removing it, or NULL if the queue is empty.
+///     Critical messages pre-empt everything, then spilled messages (older than anything in RAM),
+///     then normal and last bulk messages.
+/// </summary>
+const char* lp_offlineQueuePeek(void) {
+	if (_slots != NULL && _rings[LP_PRIORITY_CRITICAL].count > 0) {
+		return _rings[LP_PRIORITY_CRITICAL].slots[_rings[LP_PRIORITY_CRITICAL].head];
+	}
+
+	if (lp_journalCount(&_spill) > 0) {
+		return SpillPeek();
+	}
+
+	if (_slots != NULL && _rings[LP_PRIORITY_NORMAL].count > 0) {
+		return _rings[LP_PRIORITY_NORMAL].slots[_rings[LP_PRIORITY_NORMAL].head];
+	}
+
+	if (_slots != NULL && _rings[LP_PRIORITY_BULK].count > 0) {
+		return _rings[LP_PRIORITY_BULK].slots[_rings[LP_PRIORITY_BULK].head];
+	}
+
+	return NULL;
+}
+
+/// <summary>
+///     Remove the message returned by the last call to lp_offlineQueuePeek
+/// </summary>
+void lp_offlineQueuePop(void) {
+	if (_slots != NULL && _rings[LP_PRIORITY_CRITICAL].count > 0) {
+		lp_heapFree(LP_HEAP_OFFLINE_QUEUE, RingRemoveOldest(LP_PRIORITY_CRITICAL));
+		return;
+	}
+
+	if (lp_journalCount(&_spill) > 0) {
+		lp_journalConsume(&_spill);
+		return;
+	}
+
+	if (_slots != NULL && _rings[LP_PRIORITY_NORMAL].count > 0) {
+		lp_heapFree(LP_HEAP_OFFLINE_QUEUE, RingRemoveOldest(LP_PRIORITY_NORMAL));
+	}
+	else if (_slots != NULL && _rings[LP_PRIORITY_BULK].count > 0) {
+		lp_heapFree(LP_HEAP_OFFLINE_QUEUE, RingRemoveOldest(LP_PRIORITY_BULK));
+	}
+}
+
+/// <summary>
+///     Release the RAM held by one priority class, oldest first. Bulk messages are dropped, normal and critical ones
+///     are spilled to mutable storage when spilling is enabled and dropped otherwise. Returns how many left RAM
+/// </summary>
+size_t lp_offlineQueueShed(LP_MESSAGE_PRIORITY priority) {
+	size_t shed = 0;
+
+	if (_slots == NULL || priority < 0 || priority >= LP_PRIORITY_CLASSES) {
+		return 0;
+	}
+
+	while (_rings[priority].count > 0) {
+		char* msg = RingRemoveOldest(priority);
+
+		if (priority == LP_PRIORITY_BULK || !lp_journalAppend(&_spill, msg, strlen(msg) + 1)) {
+			_dropped++;
+		}
+		lp_heapFree(LP_HEAP_OFFLINE_QUEUE, msg);
+		shed++;
+	}
+
+	return shed;
+}
+
+size_t lp_offlineQueueCount(void) {
+	return _count + lp_journalCount(&_spill);
+}
+
+size_t lp_offlineQueuePriorityCount(LP_MESSAGE_PRIORITY priority) {
+	return priority >= 0 && priority < LP_PRIORITY_CLASSES ? _rings[priority].count : 0;
+}
+
+size_t lp_offlineQueueDropped(void) {
+	return _dropped;
+}
+
+/// <summary>
+///     Write every message held in RAM to the spill file, critical first then normal and bulk, so the whole
+///     queue survives PowerManagement_ForceSystemPowerDown. The spill is committed before it returns. Returns
+///     false if spilling is not enabled or a message did not fit and was dropped.
+/// </summary>
+bool lp_offlineQueuePersist(void) {
+	bool persisted = true;
+
+	if (_slots == NULL || _spill.batch == NULL) {
+		return _slots != NULL && _count == 0;
+	}
+
+	for (int i = 0; i < LP_PRIORITY_CLASSES; i++) {
+		while (_rings[i].count > 0) {
+			char* msg = RingRemoveOldest((LP_MESSAGE_PRIORITY)i);
+
+			if (!lp_journalAppend(&_spill, msg, strlen(msg) + 1)) {
+				_dropped++;
+				persisted = false;
+			}
+			lp_heapFree(LP_HEAP_OFFLINE_QUEUE, msg);
+		}
+	}
+
+	return lp_journalCommit(&_spill) && persisted;
+}
+
+/// <summary>
+///     Keep up to LP_OFFLINE_QUEUE_STATE_SIZE bytes of application state in the spill journal, in order with the
+///     records so it is never out of step with them, and committed before it returns. Needs spilling enabled.
+/// </summary>
+bool lp_offlineQueueSetState(const void* state, size_t stateLength) {
+	if (stateLength > LP_OFFLINE_QUEUE_STATE_SIZE) {
+		return false;
+	}
+
+	return lp_journalSetState(&_spill, state, stateLength) && lp_journalCommit(&_spill);
+}
+
+/// <summary>
+///     Copy the state recovered from the spill file, returns its length, 0 when none was kept
+/// </summary>
+size_t lp_offlineQueueGetState(void* state, size_t capacity) {
+	return lp_journalGetState(&_spill, state, capacity);
+}
+
+/// <summary>
+///     The oldest spilled message, one that is not a string is dropped
+/// </summary>
+static const char* SpillPeek(void) {
+	size_t length;
+	const char* record;
+
+	while ((record = (const char*)lp_journalPeek(&_spill, &length)) != NULL && record[length - 1] != 0) {
+		lp_journalConsume(&_spill);
+		_dropped++;
+	}
+
+	return record;
+}
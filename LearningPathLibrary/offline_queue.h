@@ -0,0 +1,36 @@
+#pragma once
+
+#include "heap_stats.h"
+#include "logging.h"
+#include "mutable_storage.h"
+#include "storage_journal.h"
+#include <applibs/log.h>
+#include <applibs/storage.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef enum {
+	LP_PRIORITY_NORMAL = 0,
+	LP_PRIORITY_CRITICAL = 1,
+	LP_PRIORITY_BULK = 2
+} LP_MESSAGE_PRIORITY;
+
+#define LP_PRIORITY_CLASSES 3
+#define LP_OFFLINE_QUEUE_STATE_SIZE 48		// application state kept in the spill file header
+
+bool lp_openOfflineQueue(size_t maxMessages, size_t maxBytes, size_t maxSpillBytes);
+void lp_closeOfflineQueue(void);
+bool lp_offlineQueuePush(const char* msg, LP_MESSAGE_PRIORITY priority);
+const char* lp_offlineQueuePeek(void);
+void lp_offlineQueuePop(void);
+size_t lp_offlineQueueCount(void);
+size_t lp_offlineQueuePriorityCount(LP_MESSAGE_PRIORITY priority);
+size_t lp_offlineQueueDropped(void);
+size_t lp_offlineQueueShed(LP_MESSAGE_PRIORITY priority);
+bool lp_offlineQueuePersist(void);
+bool lp_offlineQueueSetState(const void* state, size_t stateLength);
+size_t lp_offlineQueueGetState(void* state, size_t capacity);
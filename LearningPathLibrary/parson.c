@@ -41,25 +41,38 @@
 #include <ctype.h>
 #include <math.h>
 #include <errno.h>
+#include <stdint.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
 
 /* Apparently sscanf is not implemented in some "standard" libraries, so don't use it, if you
  * don't have to. */
 #define sscanf THINK_TWICE_ABOUT_USING_SSCANF
 
 #define STARTING_CAPACITY 16
+#define OBJECT_HASH_THRESHOLD 16 /* objects with at least this many keys get a hash index */
+#define INTERN_CELLS (JSON_INTERN_CAPACITY * 2) /* power of two */
 #define MAX_NESTING 2048
 
+#define FAST_NUMBER_DIGITS 15 /* mantissa digits read without strtod, any 15 digit integer is exact in a double */
+
 #define FLOAT_FORMAT "%1.17g" /* do not increase precision without incresing NUM_BUF_SIZE */
 /* double printed with "%1.17g" shouldn't be longer than 25 bytes so let's use 64 */
 #define NUM_BUF_SIZE 64
 
 #define SIZEOF_TOKEN(a) (sizeof(a) - 1)
 #define SKIP_CHAR(str) ((*str)++)
-#define SKIP_WHITESPACES(str)                 \
-    while (isspace((unsigned char)(**str))) { \
-        SKIP_CHAR(str);                       \
+/* reads as '\0' past the end of a length bounded parse, see json_parse_stringn */
+#define PEEK_CHAR(str) ((parse_end == NULL || *(str) < parse_end) ? **(str) : '\0')
+#define REMAINING(str) (parse_end == NULL ? (size_t)-1 : (size_t)(parse_end - *(str)))
+#define SKIP_WHITESPACES(str)                      \
+    while (isspace((unsigned char)PEEK_CHAR(str))) { \
+        SKIP_CHAR(str);                            \
     }
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
 
 #undef malloc
 #undef free
@@ -69,6 +82,11 @@ static JSON_Free_Function parson_free = free;
 
 #define IS_CONT(b) (((unsigned char)(b)&0xC0) == 0x80) /* is utf-8 continuation byte */
 
+/* Four bytes at a time: SWAR_BELOW is nonzero if any byte of w is below n, for n up to 0x80 */
+#define SWAR_ONES 0x01010101u
+#define SWAR_HIGHS 0x80808080u
+#define SWAR_BELOW(w, n) (((w) - SWAR_ONES * (n)) & ~(w) & SWAR_HIGHS)
+
 /* Type definitions */
 typedef union json_value_value {
     char *string;
@@ -89,6 +107,9 @@ struct json_object_t {
     JSON_Value *wrapping_value;
     char **names;
     JSON_Value **values;
+    unsigned long *hashes; /* hash of each name, parallel to names */
+    size_t *cells;         /* open addressing index of item position + 1, NULL below OBJECT_HASH_THRESHOLD */
+    size_t cell_capacity;  /* power of two, at least twice capacity */
     size_t count;
     size_t capacity;
 };
@@ -100,23 +121,55 @@ struct json_array_t {
     size_t capacity;
 };
 
+struct json_path_segment_t {
+    const char *name; /* null terminated, the interned key when there is one */
+    size_t name_len;
+    unsigned long hash;
+};
+
+struct json_path_t {
+    size_t count;
+    struct json_path_segment_t *segments; /* follow the path in its allocation, then the names */
+};
+
 /* Various */
 static void remove_comments(char *string, const char *start_token, const char *end_token);
 static char *parson_strndup(const char *string, size_t n);
 static char *parson_strdup(const char *string);
 static int hex_char_to_int(char c);
+static const char *parse_end = NULL; /* end of the buffer for json_parse_stringn, NULL for null terminated input */
+
 static int parse_utf16_hex(const char *string, unsigned int *result);
 static int num_bytes_in_utf8_sequence(unsigned char c);
 static int verify_utf8_sequence(const unsigned char *string, int *len);
 static int is_valid_utf8(const char *string, size_t string_len);
+static size_t ascii_prefix(const char *string, size_t len);
+static size_t plain_prefix(const char *string, size_t len);
 static int is_decimal(const char *string, size_t length);
 
+/* Node pools */
+static void *node_alloc(enum json_node_class node_class, size_t size);
+static void node_release(enum json_node_class node_class, void *node);
+static void node_pool_trim(size_t limit);
+
+/* Interned keys */
+static const char *intern_find(const char *name, size_t name_len, unsigned long hash);
+static int intern_owns(const char *name, unsigned long hash);
+static void json_key_free(char *name, unsigned long hash);
+
 /* JSON Object */
 static JSON_Object *json_object_init(JSON_Value *wrapping_value);
 static JSON_Status json_object_add(JSON_Object *object, const char *name, JSON_Value *value);
 static JSON_Status json_object_addn(JSON_Object *object, const char *name, size_t name_len,
                                     JSON_Value *value);
+static JSON_Status json_object_add_key(JSON_Object *object, char *name, size_t name_len,
+                                       unsigned long hash, JSON_Value *value);
+static int json_object_name_matches(const char *stored, const char *name, size_t name_len);
 static JSON_Status json_object_resize(JSON_Object *object, size_t new_capacity);
+static unsigned long json_object_hash(const char *name, size_t name_len);
+static JSON_Status json_object_build_cells(JSON_Object *object);
+static size_t json_object_find(const JSON_Object *object, const char *name, size_t name_len,
+                               unsigned long hash);
 static JSON_Value *json_object_getn_value(const JSON_Object *object, const char *name,
                                           size_t name_len);
 static JSON_Status json_object_remove_internal(JSON_Object *object, const char *name,
@@ -139,13 +192,19 @@ static JSON_Status skip_quotes(const char **string);
 static int parse_utf16(const char **unprocessed, char **processed);
 static char *process_string(const char *input, size_t len);
 static char *get_quoted_string(const char **string);
+static char *get_quoted_key(const char **string, size_t *key_len, unsigned long *hash);
 static JSON_Value *parse_object_value(const char **string, size_t nesting);
 static JSON_Value *parse_array_value(const char **string, size_t nesting);
 static JSON_Value *parse_string_value(const char **string);
 static JSON_Value *parse_boolean_value(const char **string);
 static JSON_Value *parse_number_value(const char **string);
+static int parse_number_fast(const char **string, double *number);
 static JSON_Value *parse_null_value(const char **string);
 static JSON_Value *parse_value(const char **string, size_t nesting);
+static JSON_Status sax_skip_token(const char **string, const char *token);
+static JSON_Status sax_skip_value(const char **string, size_t nesting);
+static JSON_Status sax_parse_object(const char **string, const JSON_Sax_Handler *handler, void *context,
+                                    size_t depth);
 
 /* Serialization */
 static int json_serialize_to_buffer_r(const JSON_Value *value, char *buf, int level, int is_pretty,
@@ -153,6 +212,11 @@ static int json_serialize_to_buffer_r(const JSON_Value *value, char *buf, int le
 static int json_serialize_string(const char *string, char *buf);
 static int append_indent(char *buf, int level);
 static int append_string(char *buf, const char *string);
+static int writer_reserve(JSON_Writer *writer, size_t size);
+static void writer_append(JSON_Writer *writer, const char *string, size_t len);
+static void writer_append_string(JSON_Writer *writer, const char *string);
+static void writer_append_number(JSON_Writer *writer, double num);
+static void writer_append_value(JSON_Writer *writer, const JSON_Value *value, int level);
 
 /* Various */
 static char *parson_strndup(const char *string, size_t n)
@@ -186,6 +250,9 @@ static int hex_char_to_int(char c)
 static int parse_utf16_hex(const char *s, unsigned int *result)
 {
     int x1, x2, x3, x4;
+    if (parse_end != NULL && parse_end - s < 4) {
+        return 0;
+    }
     if (s[0] == '\0' || s[1] == '\0' || s[2] == '\0' || s[3] == '\0') {
         return 0;
     }
@@ -262,6 +329,10 @@ static int is_valid_utf8(const char *string, size_t string_len)
     int len = 0;
     const char *string_end = string + string_len;
     while (string < string_end) {
+        string += ascii_prefix(string, (size_t)(string_end - string));
+        if (string == string_end) {
+            break;
+        }
         if (!verify_utf8_sequence((const unsigned char *)string, &len)) {
             return 0;
         }
@@ -270,6 +341,60 @@ static int is_valid_utf8(const char *string, size_t string_len)
     return 1;
 }
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+static int neon_any(uint8x16_t bytes)
+{
+    uint8x8_t folded = vorr_u8(vget_low_u8(bytes), vget_high_u8(bytes));
+    return vget_lane_u64(vreinterpret_u64_u8(folded), 0) != 0;
+}
+#endif
+
+/* Length of the leading run of bytes below 0x80, in whole words, the caller goes on a byte at a time */
+static size_t ascii_prefix(const char *string, size_t len)
+{
+    size_t i = 0;
+    uint32_t word;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 16 <= len; i += 16) {
+        if (neon_any(vtstq_u8(vld1q_u8((const uint8_t *)string + i), vdupq_n_u8(0x80)))) {
+            break;
+        }
+    }
+#endif
+    for (; i + 4 <= len; i += 4) {
+        memcpy(&word, string + i, 4);
+        if (word & SWAR_HIGHS) {
+            break;
+        }
+    }
+    return i;
+}
+
+/* Length of the leading run, in whole words, that process_string copies as is: no control
+   character, no '\\' and no '\0'. Bytes of 0x80 and up are part of a run, utf-8 is copied unchecked. */
+static size_t plain_prefix(const char *string, size_t len)
+{
+    size_t i = 0;
+    uint32_t word;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const uint8x16_t space = vdupq_n_u8(0x20), backslash = vdupq_n_u8('\\');
+    uint8x16_t bytes;
+    for (; i + 16 <= len; i += 16) {
+        bytes = vld1q_u8((const uint8_t *)string + i);
+        if (neon_any(vorrq_u8(vcltq_u8(bytes, space), vceqq_u8(bytes, backslash)))) {
+            break;
+        }
+    }
+#endif
+    for (; i + 4 <= len; i += 4) {
+        memcpy(&word, string + i, 4);
+        if (SWAR_BELOW(word, 0x20) | SWAR_BELOW(word ^ (SWAR_ONES * '\\'), 1)) {
+            break;
+        }
+    }
+    return i;
+}
+
 static int is_decimal(const char *string, size_t length)
 {
     if (length > 1 && string[0] == '0' && string[1] != '.') {
@@ -322,16 +447,118 @@ static void remove_comments(char *string, const char *start_token, const char *e
     }
 }
 
+/* Node pools, a freed node is pushed on its type's list with the link in its first bytes */
+static void *node_pools[JSONNodeClasses];
+static size_t node_pool_limit = 0;
+static int node_pool_paused = 0;
+static JSON_Node_Pool_Stats node_pool_stats;
+
+static void *node_alloc(enum json_node_class node_class, size_t size)
+{
+    void *node = node_pools[node_class];
+    if (node_pool_paused) {
+        return parson_malloc(size);
+    }
+    if (node != NULL) {
+        node_pools[node_class] = *(void **)node;
+        node_pool_stats.pooled[node_class]--;
+        node_pool_stats.reused[node_class]++;
+        return node;
+    }
+    node_pool_stats.allocated[node_class]++;
+    return parson_malloc(size);
+}
+
+static void node_release(enum json_node_class node_class, void *node)
+{
+    if (node == NULL) {
+        return;
+    }
+    if (node_pool_paused) {
+        parson_free(node);
+        return;
+    }
+    if (node_pool_stats.pooled[node_class] < node_pool_limit) {
+        *(void **)node = node_pools[node_class];
+        node_pools[node_class] = node;
+        if (++node_pool_stats.pooled[node_class] > node_pool_stats.high_water[node_class]) {
+            node_pool_stats.high_water[node_class] = node_pool_stats.pooled[node_class];
+        }
+        return;
+    }
+    node_pool_stats.released[node_class]++;
+    parson_free(node);
+}
+
+/* Free kept nodes until at most limit of each type are left */
+static void node_pool_trim(size_t limit)
+{
+    int node_class;
+    void *node;
+    for (node_class = 0; node_class < JSONNodeClasses; node_class++) {
+        while (node_pool_stats.pooled[node_class] > limit) {
+            node = node_pools[node_class];
+            node_pools[node_class] = *(void **)node;
+            node_pool_stats.pooled[node_class]--;
+            parson_free(node);
+        }
+    }
+}
+
+/* Interned keys, registered for the life of the program so a name that is one of them stays one */
+static const char *intern_keys[JSON_INTERN_CAPACITY];
+static size_t intern_lengths[JSON_INTERN_CAPACITY];
+static unsigned long intern_hashes[JSON_INTERN_CAPACITY];
+static unsigned char intern_cells[INTERN_CELLS]; /* open addressing index of key position + 1 */
+static size_t intern_count = 0;
+
+static const char *intern_find(const char *name, size_t name_len, unsigned long hash)
+{
+    size_t i, cell = hash & (INTERN_CELLS - 1);
+    while (intern_cells[cell] != 0) {
+        i = intern_cells[cell] - 1;
+        if (intern_hashes[i] == hash && intern_lengths[i] == name_len &&
+            memcmp(intern_keys[i], name, name_len) == 0) {
+            return intern_keys[i];
+        }
+        cell = (cell + 1) & (INTERN_CELLS - 1);
+    }
+    return NULL;
+}
+
+/* Whether name is an interned key itself, rather than a copy of one */
+static int intern_owns(const char *name, unsigned long hash)
+{
+    size_t cell = hash & (INTERN_CELLS - 1);
+    while (intern_cells[cell] != 0) {
+        if (intern_keys[intern_cells[cell] - 1] == name) {
+            return 1;
+        }
+        cell = (cell + 1) & (INTERN_CELLS - 1);
+    }
+    return 0;
+}
+
+static void json_key_free(char *name, unsigned long hash)
+{
+    if (intern_count == 0 || !intern_owns(name, hash)) {
+        parson_free(name);
+    }
+}
+
 /* JSON Object */
 static JSON_Object *json_object_init(JSON_Value *wrapping_value)
 {
-    JSON_Object *new_obj = (JSON_Object *)parson_malloc(sizeof(JSON_Object));
+    JSON_Object *new_obj = (JSON_Object *)node_alloc(JSONNodeObject, sizeof(JSON_Object));
     if (new_obj == NULL) {
         return NULL;
     }
     new_obj->wrapping_value = wrapping_value;
     new_obj->names = (char **)NULL;
     new_obj->values = (JSON_Value **)NULL;
+    new_obj->hashes = (unsigned long *)NULL;
+    new_obj->cells = (size_t *)NULL;
+    new_obj->cell_capacity = 0;
     new_obj->capacity = 0;
     new_obj->count = 0;
     return new_obj;
@@ -348,11 +575,32 @@ static JSON_Status json_object_add(JSON_Object *object, const char *name, JSON_V
 static JSON_Status json_object_addn(JSON_Object *object, const char *name, size_t name_len,
                                     JSON_Value *value)
 {
-    size_t index = 0;
+    unsigned long hash = 0;
+    char *key = NULL;
     if (object == NULL || name == NULL || value == NULL) {
         return JSONFailure;
     }
-    if (json_object_getn_value(object, name, name_len) != NULL) {
+    hash = json_object_hash(name, name_len);
+    key = intern_count > 0 ? (char *)intern_find(name, name_len, hash) : NULL;
+    if (key == NULL) {
+        key = parson_strndup(name, name_len);
+        if (key == NULL) {
+            return JSONFailure;
+        }
+    }
+    if (json_object_add_key(object, key, name_len, hash, value) == JSONFailure) {
+        json_key_free(key, hash);
+        return JSONFailure;
+    }
+    return JSONSuccess;
+}
+
+/* Adds a member under name, an interned key or a string the object takes ownership of on success */
+static JSON_Status json_object_add_key(JSON_Object *object, char *name, size_t name_len,
+                                       unsigned long hash, JSON_Value *value)
+{
+    size_t index = 0, cell = 0;
+    if (json_object_find(object, name, name_len, hash) != object->count) {
         return JSONFailure;
     }
     if (object->count >= object->capacity) {
@@ -362,13 +610,20 @@ static JSON_Status json_object_addn(JSON_Object *object, const char *name, size_
         }
     }
     index = object->count;
-    object->names[index] = parson_strndup(name, name_len);
-    if (object->names[index] == NULL) {
-        return JSONFailure;
-    }
+    object->names[index] = name;
+    object->hashes[index] = hash;
     value->parent = json_object_get_wrapping_value(object);
     object->values[index] = value;
     object->count++;
+    if (object->cells != NULL) {
+        cell = hash & (object->cell_capacity - 1);
+        while (object->cells[cell] != 0) {
+            cell = (cell + 1) & (object->cell_capacity - 1);
+        }
+        object->cells[cell] = index + 1;
+    } else if (object->count >= OBJECT_HASH_THRESHOLD) {
+        json_object_build_cells(object); /* lookups stay linear if this fails */
+    }
     return JSONSuccess;
 }
 
@@ -376,6 +631,7 @@ static JSON_Status json_object_resize(JSON_Object *object, size_t new_capacity)
 {
     char **temp_names = NULL;
     JSON_Value **temp_values = NULL;
+    unsigned long *temp_hashes = NULL;
 
     if ((object->names == NULL && object->values != NULL) ||
         (object->names != NULL && object->values == NULL) || new_capacity == 0) {
@@ -390,57 +646,144 @@ static JSON_Status json_object_resize(JSON_Object *object, size_t new_capacity)
         parson_free(temp_names);
         return JSONFailure;
     }
+    temp_hashes = (unsigned long *)parson_malloc(new_capacity * sizeof(unsigned long));
+    if (temp_hashes == NULL) {
+        parson_free(temp_names);
+        parson_free(temp_values);
+        return JSONFailure;
+    }
     if (object->names != NULL && object->values != NULL && object->count > 0) {
         memcpy(temp_names, object->names, object->count * sizeof(char *));
         memcpy(temp_values, object->values, object->count * sizeof(JSON_Value *));
+        memcpy(temp_hashes, object->hashes, object->count * sizeof(unsigned long));
     }
     parson_free(object->names);
     parson_free(object->values);
+    parson_free(object->hashes);
     object->names = temp_names;
     object->values = temp_values;
+    object->hashes = temp_hashes;
     object->capacity = new_capacity;
+    if (object->cells != NULL) {
+        json_object_build_cells(object); /* grow the index with the items */
+    }
     return JSONSuccess;
 }
 
-static JSON_Value *json_object_getn_value(const JSON_Object *object, const char *name,
-                                          size_t name_len)
+static unsigned long json_object_hash(const char *name, size_t name_len)
 {
-    size_t i, name_length;
-    for (i = 0; i < json_object_get_count(object); i++) {
-        name_length = strlen(object->names[i]);
-        if (name_length != name_len) {
-            continue;
+    unsigned long hash = 2166136261UL; /* FNV-1a */
+    size_t i;
+    for (i = 0; i < name_len; i++) {
+        hash = (hash ^ (unsigned char)name[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+/* (Re)builds the hash index for the current capacity, on failure the object falls back to linear lookups */
+static JSON_Status json_object_build_cells(JSON_Object *object)
+{
+    size_t i, cell, cell_capacity = 1;
+    size_t *cells = NULL;
+    while (cell_capacity < object->capacity * 2) {
+        cell_capacity <<= 1;
+    }
+    if (object->cells != NULL && object->cell_capacity == cell_capacity) {
+        cells = object->cells;
+    } else {
+        cells = (size_t *)parson_malloc(cell_capacity * sizeof(size_t));
+        parson_free(object->cells);
+        object->cells = cells;
+        object->cell_capacity = cells != NULL ? cell_capacity : 0;
+        if (cells == NULL) {
+            return JSONFailure;
         }
-        if (strncmp(object->names[i], name, name_len) == 0) {
-            return object->values[i];
+    }
+    memset(cells, 0, cell_capacity * sizeof(size_t));
+    for (i = 0; i < object->count; i++) {
+        cell = object->hashes[i] & (cell_capacity - 1);
+        while (cells[cell] != 0) {
+            cell = (cell + 1) & (cell_capacity - 1);
         }
+        cells[cell] = i + 1;
     }
-    return NULL;
+    return JSONSuccess;
+}
+
+/* An interned key looked up by the same pointer matches without comparing the characters */
+static int json_object_name_matches(const char *stored, const char *name, size_t name_len)
+{
+    if (stored == name) {
+        return name[name_len] == '\0';
+    }
+    return strncmp(stored, name, name_len) == 0 && stored[name_len] == '\0';
+}
+
+/* Returns the item position of name, or count when it is not in the object */
+static size_t json_object_find(const JSON_Object *object, const char *name, size_t name_len,
+                               unsigned long hash)
+{
+    size_t i, cell;
+    if (object == NULL) {
+        return 0;
+    }
+    if (object->cells != NULL) {
+        cell = hash & (object->cell_capacity - 1);
+        while (object->cells[cell] != 0) {
+            i = object->cells[cell] - 1;
+            if (object->hashes[i] == hash && json_object_name_matches(object->names[i], name, name_len)) {
+                return i;
+            }
+            cell = (cell + 1) & (object->cell_capacity - 1);
+        }
+        return object->count;
+    }
+    for (i = 0; i < object->count; i++) {
+        if (object->hashes[i] == hash && json_object_name_matches(object->names[i], name, name_len)) {
+            return i;
+        }
+    }
+    return object->count;
+}
+
+static JSON_Value *json_object_getn_value(const JSON_Object *object, const char *name,
+                                          size_t name_len)
+{
+    size_t i;
+    if (object == NULL) {
+        return NULL;
+    }
+    i = json_object_find(object, name, name_len, json_object_hash(name, name_len));
+    return i < object->count ? object->values[i] : NULL;
 }
 
 static JSON_Status json_object_remove_internal(JSON_Object *object, const char *name,
                                                int free_value)
 {
-    size_t i = 0, last_item_index = 0;
-    if (object == NULL || json_object_get_value(object, name) == NULL) {
+    size_t i = 0, last_item_index = 0, name_len = 0;
+    if (object == NULL || name == NULL) {
         return JSONFailure;
     }
-    last_item_index = json_object_get_count(object) - 1;
-    for (i = 0; i < json_object_get_count(object); i++) {
-        if (strcmp(object->names[i], name) == 0) {
-            parson_free(object->names[i]);
-            if (free_value) {
-                json_value_free(object->values[i]);
-            }
-            if (i != last_item_index) { /* Replace key value pair with one from the end */
-                object->names[i] = object->names[last_item_index];
-                object->values[i] = object->values[last_item_index];
-            }
-            object->count -= 1;
-            return JSONSuccess;
-        }
+    name_len = strlen(name);
+    i = json_object_find(object, name, name_len, json_object_hash(name, name_len));
+    if (i >= object->count) {
+        return JSONFailure;
+    }
+    last_item_index = object->count - 1;
+    json_key_free(object->names[i], object->hashes[i]);
+    if (free_value) {
+        json_value_free(object->values[i]);
+    }
+    if (i != last_item_index) { /* Replace key value pair with one from the end */
+        object->names[i] = object->names[last_item_index];
+        object->values[i] = object->values[last_item_index];
+        object->hashes[i] = object->hashes[last_item_index];
+    }
+    object->count -= 1;
+    if (object->cells != NULL) {
+        json_object_build_cells(object); /* linear probing has no cheap delete */
     }
-    return JSONFailure; /* No execution path should end here */
+    return JSONSuccess;
 }
 
 static JSON_Status json_object_dotremove_internal(JSON_Object *object, const char *name,
@@ -464,18 +807,20 @@ static void json_object_free(JSON_Object *object)
 {
     size_t i;
     for (i = 0; i < object->count; i++) {
-        parson_free(object->names[i]);
+        json_key_free(object->names[i], object->hashes[i]);
         json_value_free(object->values[i]);
     }
     parson_free(object->names);
     parson_free(object->values);
-    parson_free(object);
+    parson_free(object->hashes);
+    parson_free(object->cells);
+    node_release(JSONNodeObject, object);
 }
 
 /* JSON Array */
 static JSON_Array *json_array_init(JSON_Value *wrapping_value)
 {
-    JSON_Array *new_array = (JSON_Array *)parson_malloc(sizeof(JSON_Array));
+    JSON_Array *new_array = (JSON_Array *)node_alloc(JSONNodeArray, sizeof(JSON_Array));
     if (new_array == NULL) {
         return NULL;
     }
@@ -526,13 +871,13 @@ static void json_array_free(JSON_Array *array)
         json_value_free(array->items[i]);
     }
     parson_free(array->items);
-    parson_free(array);
+    node_release(JSONNodeArray, array);
 }
 
 /* JSON Value */
 static JSON_Value *json_value_init_string_no_copy(char *string)
 {
-    JSON_Value *new_value = (JSON_Value *)parson_malloc(sizeof(JSON_Value));
+    JSON_Value *new_value = (JSON_Value *)node_alloc(JSONNodeValue, sizeof(JSON_Value));
     if (!new_value) {
         return NULL;
     }
@@ -545,16 +890,16 @@ static JSON_Value *json_value_init_string_no_copy(char *string)
 /* Parser */
 static JSON_Status skip_quotes(const char **string)
 {
-    if (**string != '\"') {
+    if (PEEK_CHAR(string) != '\"') {
         return JSONFailure;
     }
     SKIP_CHAR(string);
-    while (**string != '\"') {
-        if (**string == '\0') {
+    while (PEEK_CHAR(string) != '\"') {
+        if (PEEK_CHAR(string) == '\0') {
             return JSONFailure;
-        } else if (**string == '\\') {
+        } else if (PEEK_CHAR(string) == '\\') {
             SKIP_CHAR(string);
-            if (**string == '\0') {
+            if (PEEK_CHAR(string) == '\0') {
                 return JSONFailure;
             }
         }
@@ -614,19 +959,27 @@ static int parse_utf16(const char **unprocessed, char **processed)
 }
 
 /* Copies and processes passed string up to supplied length.
-Example: "\u006Corem ipsum" -> lorem ipsum */
+Example: "\u006Corem ipsum" -> lorem ipsum
+An escape never processes to more bytes than it takes, so the output is written in one pass into
+a buffer of len + 1 and kept as it is, up to five bytes in six of a \u escape left unused. */
 static char *process_string(const char *input, size_t len)
 {
     const char *input_ptr = input;
-    size_t initial_size = (len + 1) * sizeof(char);
-    size_t final_size = 0;
-    char *output = NULL, *output_ptr = NULL, *resized_output = NULL;
-    output = (char *)parson_malloc(initial_size);
+    size_t run = 0;
+    char *output = NULL, *output_ptr = NULL;
+    output = (char *)parson_malloc((len + 1) * sizeof(char));
     if (output == NULL) {
         goto error;
     }
     output_ptr = output;
     while ((*input_ptr != '\0') && (size_t)(input_ptr - input) < len) {
+        run = plain_prefix(input_ptr, len - (size_t)(input_ptr - input));
+        if (run > 0) {
+            memcpy(output_ptr, input_ptr, run);
+            output_ptr += run;
+            input_ptr += run;
+            continue;
+        }
         if (*input_ptr == '\\') {
             input_ptr++;
             switch (*input_ptr) {
@@ -672,16 +1025,7 @@ static char *process_string(const char *input, size_t len)
         input_ptr++;
     }
     *output_ptr = '\0';
-    /* resize to new length */
-    final_size = (size_t)(output_ptr - output) + 1;
-    /* todo: don't resize if final_size == initial_size */
-    resized_output = (char *)parson_malloc(final_size);
-    if (resized_output == NULL) {
-        goto error;
-    }
-    memcpy(resized_output, output, final_size);
-    parson_free(output);
-    return resized_output;
+    return output;
 error:
     parson_free(output);
     return NULL;
@@ -701,13 +1045,45 @@ static char *get_quoted_string(const char **string)
     return process_string(string_start + 1, string_len);
 }
 
+/* A member name as get_quoted_string returns it, or the interned key it matches without a copy. A name
+   with no escapes reads the same processed, so its hash and the intern lookup are done on the input. */
+static char *get_quoted_key(const char **string, size_t *key_len, unsigned long *hash)
+{
+    const char *string_start = *string;
+    size_t string_len = 0;
+    int escaped = 0;
+    char *key = NULL;
+    if (skip_quotes(string) != JSONSuccess) {
+        return NULL;
+    }
+    string_len = (size_t)(*string - string_start - 2);
+    escaped = memchr(string_start + 1, '\\', string_len) != NULL;
+    if (!escaped) {
+        *hash = json_object_hash(string_start + 1, string_len);
+        key = intern_count > 0 ? (char *)intern_find(string_start + 1, string_len, *hash) : NULL;
+        if (key != NULL) {
+            *key_len = string_len;
+            return key;
+        }
+    }
+    key = process_string(string_start + 1, string_len);
+    if (key == NULL) {
+        return NULL;
+    }
+    *key_len = escaped ? strlen(key) : string_len;
+    if (escaped) {
+        *hash = json_object_hash(key, *key_len);
+    }
+    return key;
+}
+
 static JSON_Value *parse_value(const char **string, size_t nesting)
 {
     if (nesting > MAX_NESTING) {
         return NULL;
     }
     SKIP_WHITESPACES(string);
-    switch (**string) {
+    switch (PEEK_CHAR(string)) {
     case '{':
         return parse_object_value(string, nesting + 1);
     case '[':
@@ -741,56 +1117,58 @@ static JSON_Value *parse_object_value(const char **string, size_t nesting)
     JSON_Value *output_value = NULL, *new_value = NULL;
     JSON_Object *output_object = NULL;
     char *new_key = NULL;
+    size_t new_key_len = 0;
+    unsigned long new_key_hash = 0;
     output_value = json_value_init_object();
     if (output_value == NULL) {
         return NULL;
     }
-    if (**string != '{') {
+    if (PEEK_CHAR(string) != '{') {
         json_value_free(output_value);
         return NULL;
     }
     output_object = json_value_get_object(output_value);
     SKIP_CHAR(string);
     SKIP_WHITESPACES(string);
-    if (**string == '}') { /* empty object */
+    if (PEEK_CHAR(string) == '}') { /* empty object */
         SKIP_CHAR(string);
         return output_value;
     }
-    while (**string != '\0') {
-        new_key = get_quoted_string(string);
+    while (PEEK_CHAR(string) != '\0') {
+        new_key = get_quoted_key(string, &new_key_len, &new_key_hash);
         if (new_key == NULL) {
             json_value_free(output_value);
             return NULL;
         }
         SKIP_WHITESPACES(string);
-        if (**string != ':') {
-            parson_free(new_key);
+        if (PEEK_CHAR(string) != ':') {
+            json_key_free(new_key, new_key_hash);
             json_value_free(output_value);
             return NULL;
         }
         SKIP_CHAR(string);
         new_value = parse_value(string, nesting);
         if (new_value == NULL) {
-            parson_free(new_key);
+            json_key_free(new_key, new_key_hash);
             json_value_free(output_value);
             return NULL;
         }
-        if (json_object_add(output_object, new_key, new_value) == JSONFailure) {
-            parson_free(new_key);
+        /* the object takes the key rather than copying it */
+        if (json_object_add_key(output_object, new_key, new_key_len, new_key_hash, new_value) == JSONFailure) {
+            json_key_free(new_key, new_key_hash);
             json_value_free(new_value);
             json_value_free(output_value);
             return NULL;
         }
-        parson_free(new_key);
         SKIP_WHITESPACES(string);
-        if (**string != ',') {
+        if (PEEK_CHAR(string) != ',') {
             break;
         }
         SKIP_CHAR(string);
         SKIP_WHITESPACES(string);
     }
     SKIP_WHITESPACES(string);
-    if (**string != '}' || /* Trim object after parsing is over */
+    if (PEEK_CHAR(string) != '}' || /* Trim object after parsing is over */
         json_object_resize(output_object, json_object_get_count(output_object)) == JSONFailure) {
         json_value_free(output_value);
         return NULL;
@@ -807,18 +1185,18 @@ static JSON_Value *parse_array_value(const char **string, size_t nesting)
     if (output_value == NULL) {
         return NULL;
     }
-    if (**string != '[') {
+    if (PEEK_CHAR(string) != '[') {
         json_value_free(output_value);
         return NULL;
     }
     output_array = json_value_get_array(output_value);
     SKIP_CHAR(string);
     SKIP_WHITESPACES(string);
-    if (**string == ']') { /* empty array */
+    if (PEEK_CHAR(string) == ']') { /* empty array */
         SKIP_CHAR(string);
         return output_value;
     }
-    while (**string != '\0') {
+    while (PEEK_CHAR(string) != '\0') {
         new_array_value = parse_value(string, nesting);
         if (new_array_value == NULL) {
             json_value_free(output_value);
@@ -830,14 +1208,14 @@ static JSON_Value *parse_array_value(const char **string, size_t nesting)
             return NULL;
         }
         SKIP_WHITESPACES(string);
-        if (**string != ',') {
+        if (PEEK_CHAR(string) != ',') {
             break;
         }
         SKIP_CHAR(string);
         SKIP_WHITESPACES(string);
     }
     SKIP_WHITESPACES(string);
-    if (**string != ']' || /* Trim array after parsing is over */
+    if (PEEK_CHAR(string) != ']' || /* Trim array after parsing is over */
         json_array_resize(output_array, json_array_get_count(output_array)) == JSONFailure) {
         json_value_free(output_value);
         return NULL;
@@ -865,39 +1243,261 @@ static JSON_Value *parse_boolean_value(const char **string)
 {
     size_t true_token_size = SIZEOF_TOKEN("true");
     size_t false_token_size = SIZEOF_TOKEN("false");
-    if (strncmp("true", *string, true_token_size) == 0) {
+    if (REMAINING(string) >= true_token_size && strncmp("true", *string, true_token_size) == 0) {
         *string += true_token_size;
         return json_value_init_boolean(1);
-    } else if (strncmp("false", *string, false_token_size) == 0) {
+    } else if (REMAINING(string) >= false_token_size && strncmp("false", *string, false_token_size) == 0) {
         *string += false_token_size;
         return json_value_init_boolean(0);
     }
     return NULL;
 }
 
+/* Integers and decimals of at most FAST_NUMBER_DIGITS digits without an exponent, the ones twins and
+   methods carry. The mantissa and a power of ten up to 1e15 are both exact in a double, so the one
+   divide rounds correctly and the value is the one strtod would give. Returns 0 and leaves string where
+   it was for anything else, strtod then parses or rejects it. */
+static int parse_number_fast(const char **string, double *number)
+{
+    static const double powers_of_ten[FAST_NUMBER_DIGITS + 1] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    const char *p = *string;
+    const char *end = parse_end;
+    unsigned long long mantissa = 0;
+    size_t digits = 0, fraction = 0;
+    int negative = 0;
+    char c;
+#define FAST_PEEK() ((end == NULL || p < end) ? *p : '\0')
+    if (FAST_PEEK() == '-') {
+        negative = 1;
+        p++;
+    }
+    if (FAST_PEEK() == '0' && (end == NULL || p + 1 < end) && isdigit((unsigned char)p[1])) {
+        return 0; /* a leading zero, rejected on the strtod path */
+    }
+    while (isdigit((unsigned char)(c = FAST_PEEK()))) {
+        if (++digits > FAST_NUMBER_DIGITS) {
+            return 0;
+        }
+        mantissa = mantissa * 10 + (unsigned long long)(c - '0');
+        p++;
+    }
+    if (digits == 0) {
+        return 0;
+    }
+    if (c == '.') {
+        p++;
+        while (isdigit((unsigned char)(c = FAST_PEEK()))) {
+            if (++digits > FAST_NUMBER_DIGITS) {
+                return 0;
+            }
+            mantissa = mantissa * 10 + (unsigned long long)(c - '0');
+            fraction++;
+            p++;
+        }
+        if (fraction == 0) {
+            return 0;
+        }
+    }
+    if (isalnum((unsigned char)c) || c == '.' || c == '+' || c == '-') {
+        return 0; /* an exponent, or not a number at all */
+    }
+#undef FAST_PEEK
+    *number = (double)mantissa / powers_of_ten[fraction];
+    if (negative) {
+        *number = -*number;
+    }
+    *string = p;
+    return 1;
+}
+
 static JSON_Value *parse_number_value(const char **string)
 {
     char *end;
     double number = 0;
+    char num_buf[NUM_BUF_SIZE];
+    const char *start = *string;
+    if (parse_number_fast(string, &number)) {
+        return json_value_init_number(number);
+    }
+    if (parse_end != NULL) {
+        /* strtod needs a terminator, copy the bounded tail so it cannot read past the buffer */
+        size_t len = MIN(REMAINING(string), NUM_BUF_SIZE - 1);
+        memcpy(num_buf, *string, len);
+        num_buf[len] = '\0';
+        start = num_buf;
+    }
     errno = 0;
-    number = strtod(*string, &end);
-    if (errno || !is_decimal(*string, (size_t)(end - *string))) {
+    number = strtod(start, &end);
+    if (errno || !is_decimal(start, (size_t)(end - start))) {
         return NULL;
     }
-    *string = end;
+    *string += end - start;
     return json_value_init_number(number);
 }
 
 static JSON_Value *parse_null_value(const char **string)
 {
     size_t token_size = SIZEOF_TOKEN("null");
-    if (strncmp("null", *string, token_size) == 0) {
+    if (REMAINING(string) >= token_size && strncmp("null", *string, token_size) == 0) {
         *string += token_size;
         return json_value_init_null();
     }
     return NULL;
 }
 
+/* Event driven parser, skipped values are only checked for structure and never allocate */
+static JSON_Status sax_skip_token(const char **string, const char *token)
+{
+    size_t token_size = strlen(token);
+    if (REMAINING(string) < token_size || strncmp(token, *string, token_size) != 0) {
+        return JSONFailure;
+    }
+    *string += token_size;
+    return JSONSuccess;
+}
+
+static JSON_Status sax_skip_value(const char **string, size_t nesting)
+{
+    char close_char = '\0';
+    const char *start = NULL;
+    if (nesting > MAX_NESTING) {
+        return JSONFailure;
+    }
+    SKIP_WHITESPACES(string);
+    switch (PEEK_CHAR(string)) {
+    case '{':
+    case '[':
+        close_char = PEEK_CHAR(string) == '{' ? '}' : ']';
+        SKIP_CHAR(string);
+        SKIP_WHITESPACES(string);
+        if (PEEK_CHAR(string) == close_char) {
+            SKIP_CHAR(string);
+            return JSONSuccess;
+        }
+        while (PEEK_CHAR(string) != '\0') {
+            if (close_char == '}') {
+                SKIP_WHITESPACES(string);
+                if (skip_quotes(string) != JSONSuccess) {
+                    return JSONFailure;
+                }
+                SKIP_WHITESPACES(string);
+                if (PEEK_CHAR(string) != ':') {
+                    return JSONFailure;
+                }
+                SKIP_CHAR(string);
+            }
+            if (sax_skip_value(string, nesting + 1) != JSONSuccess) {
+                return JSONFailure;
+            }
+            SKIP_WHITESPACES(string);
+            if (PEEK_CHAR(string) == close_char) {
+                SKIP_CHAR(string);
+                return JSONSuccess;
+            }
+            if (PEEK_CHAR(string) != ',') {
+                return JSONFailure;
+            }
+            SKIP_CHAR(string);
+            SKIP_WHITESPACES(string);
+        }
+        return JSONFailure;
+    case '\"':
+        return skip_quotes(string);
+    case 't':
+        return sax_skip_token(string, "true");
+    case 'f':
+        return sax_skip_token(string, "false");
+    case 'n':
+        return sax_skip_token(string, "null");
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        start = *string;
+        while (PEEK_CHAR(string) != '\0' && strchr("+-.eE0123456789", PEEK_CHAR(string)) != NULL) {
+            SKIP_CHAR(string);
+        }
+        return *string > start ? JSONSuccess : JSONFailure;
+    default:
+        return JSONFailure;
+    }
+}
+
+static JSON_Status sax_parse_object(const char **string, const JSON_Sax_Handler *handler, void *context,
+                                    size_t depth)
+{
+    const char *name = NULL;
+    size_t name_len = 0;
+    JSON_Sax_Action action = JSONSaxSkip;
+    JSON_Value *value = NULL;
+    if (depth > MAX_NESTING) {
+        return JSONFailure;
+    }
+    SKIP_WHITESPACES(string);
+    if (PEEK_CHAR(string) != '{') {
+        return JSONFailure;
+    }
+    SKIP_CHAR(string);
+    SKIP_WHITESPACES(string);
+    if (PEEK_CHAR(string) == '}') {
+        SKIP_CHAR(string);
+        return JSONSuccess;
+    }
+    while (PEEK_CHAR(string) != '\0') {
+        SKIP_WHITESPACES(string);
+        name = *string + 1;
+        if (skip_quotes(string) != JSONSuccess) {
+            return JSONFailure;
+        }
+        name_len = (size_t)(*string - name - 1);
+        SKIP_WHITESPACES(string);
+        if (PEEK_CHAR(string) != ':') {
+            return JSONFailure;
+        }
+        SKIP_CHAR(string);
+        SKIP_WHITESPACES(string);
+        action = handler->member != NULL ? handler->member(context, name, name_len, depth) : JSONSaxSkip;
+        if (action == JSONSaxDescend && PEEK_CHAR(string) == '{') {
+            if (sax_parse_object(string, handler, context, depth + 1) != JSONSuccess) {
+                return JSONFailure;
+            }
+        } else if (action == JSONSaxSkip) {
+            if (sax_skip_value(string, depth) != JSONSuccess) {
+                return JSONFailure;
+            }
+        } else { /* captured, as is a descend into a value that is not an object */
+            value = parse_value(string, depth);
+            if (value == NULL) {
+                return JSONFailure;
+            }
+            if (handler->value == NULL) {
+                json_value_free(value);
+            } else if (handler->value(context, name, name_len, value, depth) != JSONSuccess) {
+                return JSONFailure;
+            }
+        }
+        SKIP_WHITESPACES(string);
+        if (PEEK_CHAR(string) == '}') {
+            SKIP_CHAR(string);
+            return JSONSuccess;
+        }
+        if (PEEK_CHAR(string) != ',') {
+            return JSONFailure;
+        }
+        SKIP_CHAR(string);
+        SKIP_WHITESPACES(string);
+    }
+    return JSONFailure;
+}
+
 /* Serialization */
 #define APPEND_STRING(str)                   \
     do {                                     \
@@ -1213,6 +1813,191 @@ static int append_string(char *buf, const char *string)
 #undef APPEND_STRING
 #undef APPEND_INDENT
 
+/* Writer, one pass with no sizing walk */
+static int writer_reserve(JSON_Writer *writer, size_t size)
+{
+    size_t new_capacity = 0;
+    char *new_buffer = NULL;
+    if (writer->status != JSONSuccess) {
+        return 0;
+    }
+    if (writer->length + size + 1 <= writer->capacity) {
+        return 1;
+    }
+    if (!writer->can_grow) {
+        writer->status = JSONFailure;
+        return 0;
+    }
+    new_capacity = MAX(writer->capacity * 2, STARTING_CAPACITY * 8);
+    while (new_capacity < writer->length + size + 1) {
+        new_capacity *= 2;
+    }
+    new_buffer = (char *)parson_malloc(new_capacity);
+    if (new_buffer == NULL) {
+        writer->status = JSONFailure;
+        return 0;
+    }
+    if (writer->length > 0) {
+        memcpy(new_buffer, writer->buffer, writer->length);
+    }
+    if (writer->owned) {
+        parson_free(writer->buffer);
+    }
+    writer->buffer = new_buffer;
+    writer->capacity = new_capacity;
+    writer->owned = 1;
+    return 1;
+}
+
+static void writer_append(JSON_Writer *writer, const char *string, size_t len)
+{
+    if (!writer_reserve(writer, len)) {
+        return;
+    }
+    memcpy(writer->buffer + writer->length, string, len);
+    writer->length += len;
+    writer->buffer[writer->length] = '\0';
+}
+
+static void writer_append_string(JSON_Writer *writer, const char *string)
+{
+    static const char hex[] = "0123456789abcdef";
+    const char *run = string;
+    char escape[7] = {'\\', 'u', '0', '0', '0', '0', '\0'};
+    size_t escape_len = 0;
+    writer_append(writer, "\"", 1);
+    for (; *string != '\0'; string++) {
+        switch (*string) {
+        case '\"': escape[1] = '\"'; escape_len = 2; break;
+        case '\\': escape[1] = '\\'; escape_len = 2; break;
+        case '/': escape[1] = '/'; escape_len = 2; break; /* to make json embeddable in xml\/html */
+        case '\b': escape[1] = 'b'; escape_len = 2; break;
+        case '\f': escape[1] = 'f'; escape_len = 2; break;
+        case '\n': escape[1] = 'n'; escape_len = 2; break;
+        case '\r': escape[1] = 'r'; escape_len = 2; break;
+        case '\t': escape[1] = 't'; escape_len = 2; break;
+        default:
+            if ((unsigned char)*string >= 0x20) {
+                continue;
+            }
+            escape[1] = 'u';
+            escape[4] = hex[((unsigned char)*string >> 4) & 0xF];
+            escape[5] = hex[(unsigned char)*string & 0xF];
+            escape_len = 6;
+            break;
+        }
+        writer_append(writer, run, (size_t)(string - run)); /* unescaped bytes are copied in runs */
+        writer_append(writer, escape, escape_len);
+        run = string + 1;
+    }
+    writer_append(writer, run, (size_t)(string - run));
+    writer_append(writer, "\"", 1);
+}
+
+static void writer_append_number(JSON_Writer *writer, double num)
+{
+    static const double scale[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+    char num_buf[NUM_BUF_SIZE];
+    char *end = num_buf + NUM_BUF_SIZE, *pos = end;
+    unsigned long long digits = 0;
+    int negative = num < 0 || (num == 0 && signbit(num));
+    int frac_digits = 0, written = 0;
+    double magnitude = negative ? -num : num;
+    if (magnitude < 1e15 && num == (double)(long long)num) {
+        digits = (unsigned long long)magnitude; /* integral, same digits %1.17g would give */
+    } else if (writer->precision >= 0 && writer->precision <= 9 && magnitude * scale[writer->precision] < 9e18) {
+        frac_digits = writer->precision;
+        digits = (unsigned long long)(magnitude * scale[frac_digits] + 0.5);
+        while (frac_digits > 0 && digits % 10 == 0) { /* 21.50 is written 21.5 */
+            digits /= 10;
+            frac_digits--;
+        }
+    } else {
+        written = sprintf(num_buf, FLOAT_FORMAT, num);
+        if (written > 0) {
+            writer_append(writer, num_buf, (size_t)written);
+        } else {
+            writer->status = JSONFailure;
+        }
+        return;
+    }
+    do {
+        *--pos = (char)('0' + digits % 10);
+        digits /= 10;
+        if (--frac_digits == 0) {
+            *--pos = '.';
+        }
+    } while (digits > 0 || frac_digits >= 0);
+    if (negative && (num == 0 || !(pos[0] == '0' && pos + 1 == end))) {
+        *--pos = '-'; /* a value rounded to zero drops the sign, -0 keeps it as %1.17g does */
+    }
+    writer_append(writer, pos, (size_t)(end - pos));
+}
+
+static void writer_append_value(JSON_Writer *writer, const JSON_Value *value, int level)
+{
+    JSON_Array *array = NULL;
+    JSON_Object *object = NULL;
+    const char *string = NULL;
+    size_t i = 0, count = 0;
+    if (level > MAX_NESTING) {
+        writer->status = JSONFailure;
+        return;
+    }
+    switch (json_value_get_type(value)) {
+    case JSONArray:
+        array = json_value_get_array(value);
+        count = json_array_get_count(array);
+        writer_append(writer, "[", 1);
+        for (i = 0; i < count && writer->status == JSONSuccess; i++) {
+            if (i > 0) {
+                writer_append(writer, ",", 1);
+            }
+            writer_append_value(writer, json_array_get_value(array, i), level + 1);
+        }
+        writer_append(writer, "]", 1);
+        break;
+    case JSONObject:
+        object = json_value_get_object(value);
+        count = json_object_get_count(object);
+        writer_append(writer, "{", 1);
+        for (i = 0; i < count && writer->status == JSONSuccess; i++) {
+            if (i > 0) {
+                writer_append(writer, ",", 1);
+            }
+            writer_append_string(writer, object->names[i]);
+            writer_append(writer, ":", 1);
+            writer_append_value(writer, object->values[i], level + 1);
+        }
+        writer_append(writer, "}", 1);
+        break;
+    case JSONString:
+        string = json_value_get_string(value);
+        if (string == NULL) {
+            writer->status = JSONFailure;
+            break;
+        }
+        writer_append_string(writer, string);
+        break;
+    case JSONBoolean:
+        if (json_value_get_boolean(value)) {
+            writer_append(writer, "true", 4);
+        } else {
+            writer_append(writer, "false", 5);
+        }
+        break;
+    case JSONNumber:
+        writer_append_number(writer, json_value_get_number(value));
+        break;
+    case JSONNull:
+        writer_append(writer, "null", 4);
+        break;
+    default:
+        writer->status = JSONFailure;
+        break;
+    }
+}
+
 /* Parser API */
 JSON_Value *json_parse_string(const char *string)
 {
@@ -1225,6 +2010,38 @@ JSON_Value *json_parse_string(const char *string)
     return parse_value((const char **)&string, 0);
 }
 
+JSON_Value *json_parse_stringn(const char *string, size_t length)
+{
+    JSON_Value *result = NULL;
+    if (string == NULL) {
+        return NULL;
+    }
+    if (length >= 3 && string[0] == '\xEF' && string[1] == '\xBB' && string[2] == '\xBF') {
+        string = string + 3; /* Support for UTF-8 BOM */
+        length -= 3;
+    }
+    parse_end = string + length;
+    result = parse_value((const char **)&string, 0);
+    parse_end = NULL;
+    return result;
+}
+
+JSON_Status json_parse_sax(const char *string, size_t length, const JSON_Sax_Handler *handler, void *context)
+{
+    JSON_Status status = JSONFailure;
+    if (string == NULL || handler == NULL) {
+        return JSONFailure;
+    }
+    if (length >= 3 && string[0] == '\xEF' && string[1] == '\xBB' && string[2] == '\xBF') {
+        string = string + 3; /* Support for UTF-8 BOM */
+        length -= 3;
+    }
+    parse_end = string + length;
+    status = sax_parse_object((const char **)&string, handler, context, 1);
+    parse_end = NULL;
+    return status;
+}
+
 JSON_Value *json_parse_string_with_comments(const char *string)
 {
     JSON_Value *result = NULL;
@@ -1312,6 +2129,72 @@ int json_object_dotget_boolean(const JSON_Object *object, const char *name)
     return json_value_get_boolean(json_object_dotget_value(object, name));
 }
 
+JSON_Path *json_path_compile(const char *name)
+{
+    JSON_Path *path = NULL;
+    char *names = NULL, *segment = NULL, *dot_position = NULL;
+    const char *interned = NULL;
+    size_t count = 1, name_len = 0, i = 0;
+    if (name == NULL) {
+        return NULL;
+    }
+    name_len = strlen(name);
+    for (i = 0; i < name_len; i++) {
+        count += name[i] == '.';
+    }
+    path = (JSON_Path *)parson_malloc(sizeof(JSON_Path) + count * sizeof(struct json_path_segment_t) +
+                                      name_len + 1);
+    if (path == NULL) {
+        return NULL;
+    }
+    path->count = count;
+    path->segments = (struct json_path_segment_t *)(path + 1);
+    names = (char *)(path->segments + count);
+    memcpy(names, name, name_len + 1);
+    segment = names;
+    for (i = 0; i < count; i++) {
+        dot_position = strchr(segment, '.');
+        if (dot_position != NULL) {
+            *dot_position = '\0';
+        }
+        path->segments[i].name_len = strlen(segment);
+        path->segments[i].hash = json_object_hash(segment, path->segments[i].name_len);
+        interned = intern_count > 0 ?
+            intern_find(segment, path->segments[i].name_len, path->segments[i].hash) : NULL;
+        path->segments[i].name = interned != NULL ? interned : segment;
+        segment += path->segments[i].name_len + 1;
+    }
+    return path;
+}
+
+void json_path_free(JSON_Path *path)
+{
+    parson_free(path);
+}
+
+JSON_Value *json_path_eval(const JSON_Object *object, const JSON_Path *path)
+{
+    const struct json_path_segment_t *segment = NULL;
+    JSON_Value *value = NULL;
+    size_t i = 0, item = 0;
+    if (path == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < path->count; i++) {
+        if (object == NULL) {
+            return NULL;
+        }
+        segment = &path->segments[i];
+        item = json_object_find(object, segment->name, segment->name_len, segment->hash);
+        if (item >= object->count) {
+            return NULL;
+        }
+        value = object->values[item];
+        object = json_value_get_object(value);
+    }
+    return value;
+}
+
 size_t json_object_get_count(const JSON_Object *object)
 {
     return object ? object->count : 0;
@@ -1456,12 +2339,12 @@ void json_value_free(JSON_Value *value)
     default:
         break;
     }
-    parson_free(value);
+    node_release(JSONNodeValue, value);
 }
 
 JSON_Value *json_value_init_object(void)
 {
-    JSON_Value *new_value = (JSON_Value *)parson_malloc(sizeof(JSON_Value));
+    JSON_Value *new_value = (JSON_Value *)node_alloc(JSONNodeValue, sizeof(JSON_Value));
     if (!new_value) {
         return NULL;
     }
@@ -1469,7 +2352,7 @@ JSON_Value *json_value_init_object(void)
     new_value->type = JSONObject;
     new_value->value.object = json_object_init(new_value);
     if (!new_value->value.object) {
-        parson_free(new_value);
+        node_release(JSONNodeValue, new_value);
         return NULL;
     }
     return new_value;
@@ -1477,7 +2360,7 @@ JSON_Value *json_value_init_object(void)
 
 JSON_Value *json_value_init_array(void)
 {
-    JSON_Value *new_value = (JSON_Value *)parson_malloc(sizeof(JSON_Value));
+    JSON_Value *new_value = (JSON_Value *)node_alloc(JSONNodeValue, sizeof(JSON_Value));
     if (!new_value) {
         return NULL;
     }
@@ -1485,7 +2368,7 @@ JSON_Value *json_value_init_array(void)
     new_value->type = JSONArray;
     new_value->value.array = json_array_init(new_value);
     if (!new_value->value.array) {
-        parson_free(new_value);
+        node_release(JSONNodeValue, new_value);
         return NULL;
     }
     return new_value;
@@ -1520,7 +2403,7 @@ JSON_Value *json_value_init_number(double number)
     if ((number * 0.0) != 0.0) { /* nan and inf test */
         return NULL;
     }
-    new_value = (JSON_Value *)parson_malloc(sizeof(JSON_Value));
+    new_value = (JSON_Value *)node_alloc(JSONNodeValue, sizeof(JSON_Value));
     if (new_value == NULL) {
         return NULL;
     }
@@ -1532,7 +2415,7 @@ JSON_Value *json_value_init_number(double number)
 
 JSON_Value *json_value_init_boolean(int boolean)
 {
-    JSON_Value *new_value = (JSON_Value *)parson_malloc(sizeof(JSON_Value));
+    JSON_Value *new_value = (JSON_Value *)node_alloc(JSONNodeValue, sizeof(JSON_Value));
     if (!new_value) {
         return NULL;
     }
@@ -1544,7 +2427,7 @@ JSON_Value *json_value_init_boolean(int boolean)
 
 JSON_Value *json_value_init_null(void)
 {
-    JSON_Value *new_value = (JSON_Value *)parson_malloc(sizeof(JSON_Value));
+    JSON_Value *new_value = (JSON_Value *)node_alloc(JSONNodeValue, sizeof(JSON_Value));
     if (!new_value) {
         return NULL;
     }
@@ -1657,22 +2540,72 @@ JSON_Status json_serialize_to_buffer(const JSON_Value *value, char *buf, size_t
 
 char *json_serialize_to_string(const JSON_Value *value)
 {
-    JSON_Status serialization_result = JSONFailure;
-    size_t buf_size_bytes = json_serialization_size(value);
-    char *buf = NULL;
-    if (buf_size_bytes == 0) {
+    JSON_Writer writer;
+    json_writer_init(&writer, NULL, 0, 1);
+    if (json_serialize_to_writer(value, &writer) == JSONFailure) {
+        json_writer_free(&writer);
         return NULL;
     }
-    buf = (char *)parson_malloc(buf_size_bytes);
-    if (buf == NULL) {
-        return NULL;
+    return writer.buffer;
+}
+
+void json_writer_init(JSON_Writer *writer, char *buf, size_t buf_size_in_bytes, int can_grow)
+{
+    if (writer == NULL) {
+        return;
     }
-    serialization_result = json_serialize_to_buffer(value, buf, buf_size_bytes);
-    if (serialization_result == JSONFailure) {
-        json_free_serialized_string(buf);
-        return NULL;
+    writer->buffer = buf;
+    writer->capacity = buf != NULL ? buf_size_in_bytes : 0;
+    writer->length = 0;
+    writer->can_grow = can_grow;
+    writer->owned = 0;
+    writer->precision = -1;
+    writer->status = JSONSuccess;
+    if (writer->capacity > 0) {
+        writer->buffer[0] = '\0';
+    }
+}
+
+void json_writer_set_precision(JSON_Writer *writer, int precision)
+{
+    if (writer != NULL) {
+        writer->precision = precision > 9 ? 9 : precision;
     }
-    return buf;
+}
+
+void json_writer_reset(JSON_Writer *writer)
+{
+    if (writer == NULL) {
+        return;
+    }
+    writer->length = 0;
+    writer->status = JSONSuccess;
+    if (writer->capacity > 0) {
+        writer->buffer[0] = '\0';
+    }
+}
+
+JSON_Status json_serialize_to_writer(const JSON_Value *value, JSON_Writer *writer)
+{
+    if (writer == NULL || writer->status != JSONSuccess || value == NULL) {
+        return JSONFailure;
+    }
+    writer_append_value(writer, value, 0);
+    return writer->status;
+}
+
+void json_writer_free(JSON_Writer *writer)
+{
+    if (writer == NULL) {
+        return;
+    }
+    if (writer->owned) {
+        parson_free(writer->buffer);
+    }
+    writer->buffer = NULL;
+    writer->capacity = 0;
+    writer->length = 0;
+    writer->owned = 0;
 }
 
 size_t json_serialization_size_pretty(const JSON_Value *value)
@@ -1875,21 +2808,17 @@ JSON_Status json_array_append_null(JSON_Array *array)
 
 JSON_Status json_object_set_value(JSON_Object *object, const char *name, JSON_Value *value)
 {
-    size_t i = 0;
-    JSON_Value *old_value;
+    size_t i = 0, name_len = 0;
     if (object == NULL || name == NULL || value == NULL || value->parent != NULL) {
         return JSONFailure;
     }
-    old_value = json_object_get_value(object, name);
-    if (old_value != NULL) { /* free and overwrite old value */
-        json_value_free(old_value);
-        for (i = 0; i < json_object_get_count(object); i++) {
-            if (strcmp(object->names[i], name) == 0) {
-                value->parent = json_object_get_wrapping_value(object);
-                object->values[i] = value;
-                return JSONSuccess;
-            }
-        }
+    name_len = strlen(name);
+    i = json_object_find(object, name, name_len, json_object_hash(name, name_len));
+    if (i < object->count) { /* free and overwrite old value */
+        json_value_free(object->values[i]);
+        value->parent = json_object_get_wrapping_value(object);
+        object->values[i] = value;
+        return JSONSuccess;
     }
     /* add new key value pair */
     return json_object_add(object, name, value);
@@ -2028,10 +2957,13 @@ JSON_Status json_object_clear(JSON_Object *object)
         return JSONFailure;
     }
     for (i = 0; i < json_object_get_count(object); i++) {
-        parson_free(object->names[i]);
+        json_key_free(object->names[i], object->hashes[i]);
         json_value_free(object->values[i]);
     }
     object->count = 0;
+    if (object->cells != NULL) {
+        memset(object->cells, 0, object->cell_capacity * sizeof(size_t));
+    }
     return JSONSuccess;
 }
 
@@ -2197,6 +3129,63 @@ int json_boolean(const JSON_Value *value)
 
 void json_set_allocation_functions(JSON_Malloc_Function malloc_fun, JSON_Free_Function free_fun)
 {
+    node_pool_trim(0); /* kept nodes go back to the functions they came from */
     parson_malloc = malloc_fun;
     parson_free = free_fun;
 }
+
+JSON_Status json_intern_keys(const char *const *keys, size_t count)
+{
+    size_t i, cell, length;
+    unsigned long hash;
+    for (i = 0; i < count; i++) {
+        if (keys[i] == NULL) {
+            return JSONFailure;
+        }
+        length = strlen(keys[i]);
+        hash = json_object_hash(keys[i], length);
+        if (intern_find(keys[i], length, hash) != NULL) {
+            continue;
+        }
+        if (intern_count >= JSON_INTERN_CAPACITY) {
+            return JSONFailure;
+        }
+        intern_keys[intern_count] = keys[i];
+        intern_lengths[intern_count] = length;
+        intern_hashes[intern_count] = hash;
+        cell = hash & (INTERN_CELLS - 1);
+        while (intern_cells[cell] != 0) {
+            cell = (cell + 1) & (INTERN_CELLS - 1);
+        }
+        intern_cells[cell] = (unsigned char)(intern_count + 1);
+        intern_count++;
+    }
+    return JSONSuccess;
+}
+
+void json_get_allocation_functions(JSON_Malloc_Function *malloc_fun, JSON_Free_Function *free_fun)
+{
+    *malloc_fun = parson_malloc;
+    *free_fun = parson_free;
+}
+
+void json_set_node_pool(size_t limit)
+{
+    node_pool_limit = limit;
+    node_pool_trim(limit);
+}
+
+void json_pause_node_pool(int paused)
+{
+    node_pool_paused = paused;
+}
+
+void json_get_node_pool_stats(JSON_Node_Pool_Stats *stats)
+{
+    if (stats != NULL) {
+        *stats = node_pool_stats;
+    }
+}
+
+/* Keep the sscanf guard local to this file when sources are combined into one unit. */
+#undef sscanf
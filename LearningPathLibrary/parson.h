@@ -56,16 +56,69 @@ typedef int JSON_Value_Type;
 enum json_result_t { JSONSuccess = 0, JSONFailure = -1 };
 typedef int JSON_Status;
 
+/* What json_parse_sax does with the value of an object member */
+enum json_sax_action {
+    JSONSaxSkip = 0,    /* step over the value without allocating */
+    JSONSaxDescend = 1, /* report the members of an object value, other values are captured */
+    JSONSaxCapture = 2  /* build the value and pass it to the value callback */
+};
+typedef int JSON_Sax_Action;
+
+/* Callbacks for json_parse_sax. name is the raw member name between the quotes, escapes are not
+   processed and it is not null terminated. depth is 1 for members of the root object. */
+typedef struct json_sax_handler_t {
+    JSON_Sax_Action (*member)(void *context, const char *name, size_t name_len, size_t depth);
+    /* receives ownership of a captured value, returning JSONFailure stops the parse */
+    JSON_Status (*value)(void *context, const char *name, size_t name_len, JSON_Value *value, size_t depth);
+} JSON_Sax_Handler;
+
 typedef void *(*JSON_Malloc_Function)(size_t);
 typedef void (*JSON_Free_Function)(void *);
 
 /* Call only once, before calling any other function from parson API. If not called, malloc and free
    from stdlib will be used for all allocations */
 void json_set_allocation_functions(JSON_Malloc_Function malloc_fun, JSON_Free_Function free_fun);
+/* The functions set now, so a caller can wrap them and put them back */
+void json_get_allocation_functions(JSON_Malloc_Function *malloc_fun, JSON_Free_Function *free_fun);
+
+/* Freed values, objects and arrays are kept on a free list per node type, up to limit of each, and the next
+   one created of the type reuses a kept node rather than allocating. A limit of 0, the default, frees the
+   kept nodes and stops keeping them. Kept nodes belong to the allocation functions set when they were
+   allocated, setting others frees them first. While paused nodes are neither taken, kept nor counted, for
+   allocation functions that release their memory in bulk, an arena. */
+enum json_node_class {
+    JSONNodeValue,
+    JSONNodeObject,
+    JSONNodeArray,
+    JSONNodeClasses
+};
+typedef struct json_node_pool_stats_t {
+    size_t pooled[JSONNodeClasses];         /* kept now */
+    size_t high_water[JSONNodeClasses];     /* most kept at once */
+    unsigned long reused[JSONNodeClasses];  /* created from a kept node */
+    unsigned long allocated[JSONNodeClasses];   /* created through the malloc function */
+    unsigned long released[JSONNodeClasses];    /* freed through the free function, the list was full */
+} JSON_Node_Pool_Stats;
+void json_set_node_pool(size_t limit);
+void json_pause_node_pool(int paused);
+void json_get_node_pool_stats(JSON_Node_Pool_Stats *stats);
+
+/* Member names that are one of the interned keys reference the key rather than a copy, parsed or added,
+   and a lookup passing the key's own pointer matches without comparing the characters. Register at start up,
+   before any parse on another thread: keys stay registered for the life of the program and must outlive every
+   value. Keys already registered are skipped, JSONFailure once JSON_INTERN_CAPACITY are. */
+#define JSON_INTERN_CAPACITY 64
+JSON_Status json_intern_keys(const char *const *keys, size_t count);
 
 /*  Parses first JSON value in a string, returns NULL in case of error */
 JSON_Value *json_parse_string(const char *string);
 
+/* Parses a buffer of length bytes that need not be null terminated. Returns NULL in case of error. */
+JSON_Value *json_parse_stringn(const char *string, size_t length);
+
+/* Walks a JSON object of length bytes raising handler callbacks, only captured values are allocated */
+JSON_Status json_parse_sax(const char *string, size_t length, const JSON_Sax_Handler *handler, void *context);
+
 /*  Parses first JSON value in a string and ignores comments (/ * * / and //),
     returns NULL in case of error */
 JSON_Value *json_parse_string_with_comments(const char *string);
@@ -75,6 +128,24 @@ size_t json_serialization_size(const JSON_Value *value); /* returns 0 on fail */
 JSON_Status json_serialize_to_buffer(const JSON_Value *value, char *buf, size_t buf_size_in_bytes);
 char *json_serialize_to_string(const JSON_Value *value);
 
+/* Single pass serialization into a writer. The writer starts on a caller buffer (which may be NULL)
+   and, when can_grow is set, moves to a parson allocated buffer it doubles as needed. */
+typedef struct json_writer_t {
+    char *buffer;   /* null terminated output, valid while status is JSONSuccess */
+    size_t capacity;
+    size_t length;  /* bytes written, excluding the terminator */
+    int can_grow;
+    int owned;      /* buffer is parson allocated, release with json_writer_free */
+    int precision;  /* fraction digits for numbers, negative keeps full precision */
+    JSON_Status status;
+} JSON_Writer;
+
+void json_writer_init(JSON_Writer *writer, char *buf, size_t buf_size_in_bytes, int can_grow);
+void json_writer_set_precision(JSON_Writer *writer, int precision); /* 0 to 9 digits, -1 for full */
+void json_writer_reset(JSON_Writer *writer);                        /* keeps the buffer for the next payload */
+JSON_Status json_serialize_to_writer(const JSON_Value *value, JSON_Writer *writer); /* appends, compact */
+void json_writer_free(JSON_Writer *writer);                         /* frees only a parson allocated buffer */
+
 /* Pretty serialization */
 size_t json_serialization_size_pretty(const JSON_Value *value); /* returns 0 on fail */
 JSON_Status json_serialize_to_buffer_pretty(const JSON_Value *value, char *buf,
@@ -122,6 +193,14 @@ double json_object_dotget_number(const JSON_Object *object,
 int json_object_dotget_boolean(const JSON_Object *object,
                                const char *name); /* returns -1 on fail */
 
+/* A dotted name split and hashed once, each segment matched to its interned key, for a lookup repeated on
+   every update. json_path_eval finds what dotget finds without scanning or hashing the name again. Compile
+   after the keys are interned and free with json_path_free. */
+typedef struct json_path_t JSON_Path;
+JSON_Path *json_path_compile(const char *name);
+void json_path_free(JSON_Path *path);
+JSON_Value *json_path_eval(const JSON_Object *object, const JSON_Path *path);
+
 /* Functions to get available names */
 size_t json_object_get_count(const JSON_Object *object);
 const char *json_object_get_name(const JSON_Object *object, size_t index);
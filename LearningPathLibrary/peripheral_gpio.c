@@ -1,8 +1,100 @@
 #include "peripheral_gpio.h"
 
+static void GpioScanHandler(EventLoopTimer* eventLoopTimer);
+
 static LP_PERIPHERAL_GPIO** _peripheralSet = NULL;
 static size_t _peripheralSetCount = 0;
 
+static const struct timespec scanIdlePeriod = { 0, LP_GPIO_SCAN_IDLE_MS * 1000 * 1000 };
+static const struct timespec scanFastPeriod = { 0, LP_GPIO_SCAN_FAST_MS * 1000 * 1000 };
+static LP_TIMER gpioScanTimer = { .period = { 0, LP_GPIO_SCAN_IDLE_MS * 1000 * 1000 }, .name = "gpioScanTimer", .handler = GpioScanHandler };
+static bool _scanFast = false;
+
+static bool isScannedInput(LP_PERIPHERAL_GPIO* peripheral)
+{
+	return peripheral->direction == LP_INPUT && peripheral->onEdge != NULL && peripheral->opened && peripheral->fd >= 0;
+}
+
+static bool isActiveLevel(LP_PERIPHERAL_GPIO* peripheral, GPIO_Value_Type value)
+{
+	return (value == GPIO_Value_Low) != peripheral->invertPin;
+}
+
+// one GPIO_SetValue, none when the pin is already at the level
+static bool writeOutput(LP_PERIPHERAL_GPIO* peripheral, bool on)
+{
+	GPIO_Value_Type value = on != peripheral->invertPin ? GPIO_Value_High : GPIO_Value_Low;
+
+	if (value == peripheral->outputState) { return false; }
+
+	GPIO_SetValue(peripheral->fd, value);
+	peripheral->outputState = value;
+	return true;
+}
+
+static long elapsedMs(const struct timespec* since, const struct timespec* now)
+{
+	return (now->tv_sec - since->tv_sec) * 1000 + (now->tv_nsec - since->tv_nsec) / (1000 * 1000);
+}
+
+/// <summary>
+/// Sample every input with an edge handler, report the debounced edges and pick the next scan period
+/// </summary>
+static void GpioScanHandler(EventLoopTimer* eventLoopTimer)
+{
+	struct timespec now;
+	bool settling = false;
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
+	{
+		lp_terminate(ExitCode_ConsumeEventLoopTimeEvent);
+		return;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	for (int i = 0; i < _peripheralSetCount; i++)
+	{
+		LP_PERIPHERAL_GPIO* peripheral = _peripheralSet[i];
+		GPIO_Value_Type value;
+
+		if (!isScannedInput(peripheral)) { continue; }
+
+		if (GPIO_GetValue(peripheral->fd, &value) != 0)
+		{
+			lp_terminate(ExitCode_Gpio_Read);
+			return;
+		}
+
+		if (value != peripheral->lastSample)
+		{
+			peripheral->lastSample = value;
+			peripheral->lastSampleChange = now;
+		}
+
+		if (value != peripheral->debouncedState)
+		{
+			unsigned int debounceMs = peripheral->debounceMs != 0 ? peripheral->debounceMs : LP_GPIO_DEBOUNCE_MS;
+
+			if (elapsedMs(&peripheral->lastSampleChange, &now) >= debounceMs)
+			{
+				peripheral->debouncedState = value;
+				peripheral->onEdge(peripheral, isActiveLevel(peripheral, value));
+			}
+			else
+			{
+				settling = true;
+			}
+		}
+	}
+
+	if (settling != _scanFast)
+	{
+		_scanFast = settling;
+		lp_changeTimer(&gpioScanTimer, settling ? &scanFastPeriod : &scanIdlePeriod);
+	}
+}
+
 bool lp_openPeripheralGpio(LP_PERIPHERAL_GPIO* peripheral)
 {
 	if (peripheral == NULL || peripheral->pin < 0) { return false; }
@@ -27,24 +119,32 @@ bool lp_openPeripheralGpio(LP_PERIPHERAL_GPIO* peripheral)
 		peripheral->fd = GPIO_OpenAsOutput(peripheral->pin, GPIO_OutputMode_PushPull, peripheral->initialState);
 		if (peripheral->fd < 0)
 		{
-			Log_Debug(
+			LP_LOG(LP_LOG_ERROR,
 				"Error opening GPIO: %s (%d). Check that app_manifest.json includes the GPIO used.\n",
 				strerror(errno), errno);
 			return false;
 		}
+		peripheral->outputState = peripheral->initialState;
 		break;
 	case LP_INPUT:
 		peripheral->fd = GPIO_OpenAsInput(peripheral->pin);
 		if (peripheral->fd < 0)
 		{
-			Log_Debug(
+			LP_LOG(LP_LOG_ERROR,
 				"Error opening GPIO: %s (%d). Check that app_manifest.json includes the GPIO used.\n",
 				strerror(errno), errno);
 			return false;
 		}
+		// the level at open is the starting state, not an edge
+		if (GPIO_GetValue(peripheral->fd, &peripheral->debouncedState) != 0)
+		{
+			peripheral->debouncedState = GPIO_Value_High;
+		}
+		peripheral->lastSample = peripheral->debouncedState;
+		clock_gettime(CLOCK_MONOTONIC, &peripheral->lastSampleChange);
 		break;
 	case LP_DIRECTION_UNKNOWN:
-		Log_Debug("Unknown direction for peripheral %s", peripheral->name);
+		LP_LOG(LP_LOG_ERROR, "Unknown direction for peripheral %s", peripheral->name);
 		return false;
 		break;
 	}
@@ -66,10 +166,19 @@ void lp_openPeripheralGpioSet(LP_PERIPHERAL_GPIO** peripheralSet, size_t periphe
 			if (!_peripheralSet[i]->initialise(_peripheralSet[i]))
 			{
 				lp_terminate(ExitCode_Open_Peripheral);
-				break;
+				return;
 			}
 		}
 	}
+
+	for (int i = 0; i < _peripheralSetCount; i++)
+	{
+		if (isScannedInput(_peripheralSet[i]))
+		{
+			lp_startTimer(&gpioScanTimer);
+			break;
+		}
+	}
 }
 
 /// <summary>
@@ -84,7 +193,7 @@ void lp_closePeripheralGpio(LP_PERIPHERAL_GPIO* peripheral)
 		int result = close(peripheral->fd);
 		if (result != 0)
 		{
-			Log_Debug("ERROR: Could not close peripheral %s: %s (%d).\n", peripheral->name == NULL ? "No name" : peripheral->name, strerror(errno), errno);
+			LP_LOG(LP_LOG_ERROR, "ERROR: Could not close peripheral %s: %s (%d).\n", peripheral->name == NULL ? "No name" : peripheral->name, strerror(errno), errno);
 		}
 	}
 	peripheral->fd = -1;
@@ -93,6 +202,9 @@ void lp_closePeripheralGpio(LP_PERIPHERAL_GPIO* peripheral)
 
 void lp_closePeripheralGpioSet(void)
 {
+	lp_stopTimer(&gpioScanTimer);
+	_scanFast = false;
+
 	for (int i = 0; i < _peripheralSetCount; i++)
 	{
 		lp_closePeripheralGpio(_peripheralSet[i]);
@@ -103,14 +215,14 @@ void lp_gpioOn(LP_PERIPHERAL_GPIO* peripheral)
 {
 	if (peripheral == NULL || peripheral->fd < 0 || peripheral->pin < 0 || !peripheral->opened) { return; }
 
-	GPIO_SetValue(peripheral->fd, peripheral->invertPin ? GPIO_Value_Low : GPIO_Value_High);
+	writeOutput(peripheral, true);
 }
 
 void lp_gpioOff(LP_PERIPHERAL_GPIO* peripheral)
 {
 	if (peripheral == NULL || peripheral->fd < 0 || peripheral->pin < 0 || !peripheral->opened) { return; }
 
-	GPIO_SetValue(peripheral->fd, peripheral->invertPin ? GPIO_Value_High : GPIO_Value_Low);
+	writeOutput(peripheral, false);
 }
 
 /// <summary>
@@ -135,3 +247,69 @@ bool lp_gpioGetState(LP_PERIPHERAL_GPIO* peripheral, GPIO_Value_Type* oldState)
 	}
 	return isGpioOn;
 }
+
+/// <summary>
+/// The debounced level of an input with an edge handler, otherwise its level now
+/// </summary>
+bool lp_gpioIsActive(LP_PERIPHERAL_GPIO* peripheral)
+{
+	GPIO_Value_Type value;
+
+	if (peripheral == NULL || peripheral->direction != LP_INPUT || !peripheral->opened) { return false; }
+
+	if (peripheral->onEdge != NULL)
+	{
+		return isActiveLevel(peripheral, peripheral->debouncedState);
+	}
+
+	return GPIO_GetValue(peripheral->fd, &value) == 0 && isActiveLevel(peripheral, value);
+}
+
+/// <summary>
+/// Record the state wanted for one output of the group, written by the next lp_gpioGroupApply
+/// </summary>
+void lp_gpioGroupSet(LP_PERIPHERAL_GPIO_GROUP* group, size_t index, bool on)
+{
+	if (group == NULL || index >= group->count || index >= 32) { return; }
+
+	uint32_t bit = 1u << index;
+	group->desired = on ? group->desired | bit : group->desired & ~bit;
+	group->pending |= bit;
+}
+
+/// <summary>
+/// Record the state of every output of the group, bit 0 the first peripheral
+/// </summary>
+void lp_gpioGroupSetAll(LP_PERIPHERAL_GPIO_GROUP* group, uint32_t onMask)
+{
+	if (group == NULL) { return; }
+
+	uint32_t all = group->count >= 32 ? UINT32_MAX : (1u << group->count) - 1;
+	group->desired = onMask & all;
+	group->pending = all;
+}
+
+/// <summary>
+/// Write the recorded states, returns the number of pins that changed
+/// </summary>
+int lp_gpioGroupApply(LP_PERIPHERAL_GPIO_GROUP* group)
+{
+	int written = 0;
+
+	if (group == NULL) { return 0; }
+
+	for (size_t i = 0; group->pending != 0 && i < group->count && i < 32; i++)
+	{
+		uint32_t bit = 1u << i;
+		LP_PERIPHERAL_GPIO* peripheral = group->peripherals[i];
+
+		if ((group->pending & bit) == 0) { continue; }
+		group->pending &= ~bit;
+
+		if (peripheral == NULL || peripheral->fd < 0 || !peripheral->opened || peripheral->direction != LP_OUTPUT) { continue; }
+
+		if (writeOutput(peripheral, (group->desired & bit) != 0)) { written++; }
+	}
+
+	return written;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 //#include "epoll_timerfd_utilities.h"
+#include "logging.h"
 #include "parson.h"
 #include <applibs/gpio.h>
 #include <applibs/log.h>
@@ -10,6 +11,13 @@
 #include <string.h>
 #include <unistd.h>
 #include "terminate.h"
+#include "timer.h"
+
+// Inputs with an onEdge handler are sampled together by one scan timer, slow while every input is steady and
+// fast while one is bouncing. An edge is reported once the pin has held its new level for debounceMs
+#define LP_GPIO_SCAN_IDLE_MS 50
+#define LP_GPIO_SCAN_FAST_MS 5
+#define LP_GPIO_DEBOUNCE_MS 20		// when the input sets none
 
 typedef enum
 {
@@ -28,10 +36,26 @@ struct _peripheralGpio
 	char* name;
 	LP_GPIO_DIRECTION direction;
 	bool opened;
+	void (*onEdge)(struct _peripheralGpio* peripheralGpio, bool active);	// optional, inputs, active is low unless invertPin
+	unsigned int debounceMs;		// optional, inputs with onEdge
+	GPIO_Value_Type debouncedState;	// internal
+	GPIO_Value_Type lastSample;		// internal
+	struct timespec lastSampleChange;	// internal
+	GPIO_Value_Type outputState;	// internal, outputs, the level last written
 };
 
 typedef struct _peripheralGpio LP_PERIPHERAL_GPIO;
 
+// Outputs updated together, lp_gpioGroupSet records the wanted state and lp_gpioGroupApply writes the pins
+// set since the last apply in one pass, skipping those already at that level
+typedef struct
+{
+	LP_PERIPHERAL_GPIO** peripherals;
+	size_t count;					// up to 32
+	uint32_t desired;				// internal, bit per peripheral, set is on
+	uint32_t pending;				// internal, set since the last apply
+} LP_PERIPHERAL_GPIO_GROUP;
+
 bool lp_openPeripheralGpio(LP_PERIPHERAL_GPIO* peripheral);
 void lp_openPeripheralGpioSet(LP_PERIPHERAL_GPIO** peripheralSet, size_t peripheralSetCount);
 void lp_closePeripheralGpioSet(void);
@@ -39,3 +63,7 @@ void lp_closePeripheralGpio(LP_PERIPHERAL_GPIO* peripheral);
 void lp_gpioOn(LP_PERIPHERAL_GPIO* peripheral);
 void lp_gpioOff(LP_PERIPHERAL_GPIO* peripheral);
 bool lp_gpioGetState(LP_PERIPHERAL_GPIO* peripheral, GPIO_Value_Type* oldState);
+bool lp_gpioIsActive(LP_PERIPHERAL_GPIO* peripheral);
+void lp_gpioGroupSet(LP_PERIPHERAL_GPIO_GROUP* group, size_t index, bool on);
+void lp_gpioGroupSetAll(LP_PERIPHERAL_GPIO_GROUP* group, uint32_t onMask);
+int lp_gpioGroupApply(LP_PERIPHERAL_GPIO_GROUP* group);
@@ -0,0 +1,123 @@
+#include "rate_limit.h"
+
+typedef struct RATE_BUCKET
+{
+	uint32_t perMinute;
+	uint32_t burst;
+	double tokens;
+	struct timespec refilledAt;
+} RATE_BUCKET;
+
+static void RateLimitTwinHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+
+LP_DEVICE_TWIN_BINDING lp_rateLimitTwin = { .twinProperty = "RateLimit", .twinType = LP_TYPE_STRING, .handler = RateLimitTwinHandler };
+
+static RATE_BUCKET _buckets[LP_RATE_CLASSES];
+static LP_RATE_LIMIT_STATS _rateStats;
+static const char* _classNames[LP_RATE_CLASSES] = { "telemetry", "reported" };
+
+static void Refill(RATE_BUCKET* bucket) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	double elapsedSeconds = (double)(now.tv_sec - bucket->refilledAt.tv_sec) + (now.tv_nsec - bucket->refilledAt.tv_nsec) / 1e9;
+
+	bucket->tokens += elapsedSeconds * bucket->perMinute / 60.0;
+	if (bucket->tokens > bucket->burst) {
+		bucket->tokens = bucket->burst;
+	}
+	bucket->refilledAt = now;
+}
+
+/// <summary>
+///     Limit a class to perMinute sends with bursts of up to burst, the bucket starts full. perMinute 0 removes the limit
+/// </summary>
+void lp_setRateLimit(LP_RATE_CLASS rateClass, uint32_t perMinute, uint32_t burst) {
+	if (rateClass < 0 || rateClass >= LP_RATE_CLASSES) {
+		return;
+	}
+
+	RATE_BUCKET* bucket = &_buckets[rateClass];
+
+	bucket->perMinute = perMinute;
+	bucket->burst = burst > 0 ? burst : 1;
+	bucket->tokens = bucket->burst;
+	clock_gettime(CLOCK_MONOTONIC, &bucket->refilledAt);
+}
+
+/// <summary>
+///     Take a token for one send, false when the class must wait, always true for a class without a limit
+/// </summary>
+bool lp_rateLimitTake(LP_RATE_CLASS rateClass) {
+	if (rateClass < 0 || rateClass >= LP_RATE_CLASSES) {
+		return true;
+	}
+
+	RATE_BUCKET* bucket = &_buckets[rateClass];
+
+	if (bucket->perMinute > 0) {
+		Refill(bucket);
+
+		if (bucket->tokens < 1.0) {
+			_rateStats.deferred[rateClass]++;
+			LP_LOG_LIMITED(LP_LOG_INFO, LP_LOG_LIMIT_MS, "INFO: %s rate limited, sends deferred\n", _classNames[rateClass]);
+			return false;
+		}
+		bucket->tokens -= 1.0;
+	}
+
+	_rateStats.admitted[rateClass]++;
+	return true;
+}
+
+int lp_rateLimitWaitMs(LP_RATE_CLASS rateClass) {
+	if (rateClass < 0 || rateClass >= LP_RATE_CLASSES || _buckets[rateClass].perMinute == 0) {
+		return 0;
+	}
+
+	RATE_BUCKET* bucket = &_buckets[rateClass];
+
+	Refill(bucket);
+
+	if (bucket->tokens >= 1.0) {
+		return 0;
+	}
+
+	int waitMs = (int)((1.0 - bucket->tokens) * 60000.0 / bucket->perMinute) + 1;
+	return waitMs < LP_RATE_LIMIT_MIN_WAIT_MS ? LP_RATE_LIMIT_MIN_WAIT_MS : waitMs;
+}
+
+void lp_getRateLimitStats(LP_RATE_LIMIT_STATS* stats) {
+	if (stats != NULL) {
+		*stats = _rateStats;
+	}
+}
+
+static void RateLimitTwinHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {
+	char reported[80];
+	const char* text = (const char*)deviceTwinBinding->twinState;
+
+	while (text != NULL && *text != 0) {
+		char key[12];
+		unsigned int perMinute, burst = 0;
+		int consumed = 0;
+
+		if (sscanf(text, " %11[a-z] = %u%n / %u%n", key, &perMinute, &consumed, &burst, &consumed) < 2) {
+			break;
+		}
+
+		for (int i = 0; i < LP_RATE_CLASSES; i++) {
+			if (strcmp(key, _classNames[i]) == 0) {
+				lp_setRateLimit((LP_RATE_CLASS)i, perMinute, burst > 0 ? burst : _buckets[i].burst);
+			}
+		}
+
+		text += consumed;
+		text += strspn(text, " ,;");
+	}
+
+	snprintf(reported, sizeof(reported), "telemetry=%u/%u,reported=%u/%u", _buckets[LP_RATE_TELEMETRY].perMinute,
+		_buckets[LP_RATE_TELEMETRY].burst, _buckets[LP_RATE_REPORTED].perMinute, _buckets[LP_RATE_REPORTED].burst);
+	lp_deviceTwinReportState(deviceTwinBinding, reported);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "device_twins.h"
+#include "logging.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LP_RATE_LIMIT_MIN_WAIT_MS 10		// shortest retry lp_rateLimitWaitMs returns
+
+typedef enum {
+	LP_RATE_TELEMETRY,			// IoTHubDeviceClient_LL_SendEventAsync
+	LP_RATE_REPORTED,			// IoTHubDeviceClient_LL_SendReportedState
+	LP_RATE_CLASSES
+} LP_RATE_CLASS;
+
+typedef struct LP_RATE_LIMIT_STATS
+{
+	uint32_t admitted[LP_RATE_CLASSES];
+	uint32_t deferred[LP_RATE_CLASSES];		// held back for a later token, not dropped
+} LP_RATE_LIMIT_STATS;
+
+// Token buckets in front of the hub's device to cloud messages and reported property updates. IoT Hub throttles
+// are per hub unit and shared by the fleet, a burst from every device after an outage trips them and the 429s
+// cost retries. A bucket holds up to burst tokens and refills at perMinute, each send takes one. Telemetry that
+// finds the bucket empty goes to the offline queue, which drains one token at a time; critical messages always
+// go and take a token when there is one. Reported properties stay dirty and coalesce until the flush a token
+// allows. perMinute 0, the default, switches a class off.
+void lp_setRateLimit(LP_RATE_CLASS rateClass, uint32_t perMinute, uint32_t burst);
+bool lp_rateLimitTake(LP_RATE_CLASS rateClass);
+// milliseconds until the class has a token, 0 if it has one now
+int lp_rateLimitWaitMs(LP_RATE_CLASS rateClass);
+void lp_getRateLimitStats(LP_RATE_LIMIT_STATS* stats);
+
+// optional, add to the device twin set to set the limits from the cloud, a string "telemetry=120/20,reported=30/5"
+// of perMinute/burst for either class, reported back as the limits in effect
+extern LP_DEVICE_TWIN_BINDING lp_rateLimitTwin;
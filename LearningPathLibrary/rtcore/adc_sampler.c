@@ -0,0 +1,115 @@
+#include "adc_sampler.h"
+#include <stdbool.h>
+#include "printf.h"
+
+typedef struct {
+	uint16_t samples[ADC_SAMPLER_RING_SIZE];
+	volatile uint32_t written;			/* total samples written, the ring index is written modulo the size */
+} adc_ring;
+
+static adc_ring rings[ADC_CHANNEL_MAX];
+static u32 batch[ADC_CHANNEL_MAX][ADC_RING_BUF_SIZE];
+static u32 batch_length[ADC_CHANNEL_MAX];
+static u16 sampled_channels;
+static bool sampler_open = false;
+
+int adc_sampler_open(u16 channel_map) {
+	int i;
+
+	if (sampler_open || channel_map == 0)
+		return -1;
+
+	/* periodic mode, the controller averages and sweeps the channels on its own clock */
+	if (mtk_os_hal_adc_ctlr_init(ADC_PMODE_PERIODIC, ADC_FIFO_DIRECT, channel_map) != 0) {
+		printf("adc init fail\n");
+		return -1;
+	}
+
+	for (i = 0; i < ADC_CHANNEL_MAX; i++)
+		rings[i].written = 0;
+
+	sampled_channels = channel_map;
+	sampler_open = true;
+
+	return 0;
+}
+
+void adc_sampler_close(void) {
+	if (!sampler_open)
+		return;
+
+	mtk_os_hal_adc_ctlr_deinit();
+	sampler_open = false;
+}
+
+/* Block until the controller FIFO fills, then append the batch to the channel rings.
+   Returns the samples added, or -1 on error */
+int adc_sampler_poll(void) {
+	adc_ring *ring;
+	uint32_t written;
+	int channel, added = 0;
+	u32 i;
+
+	if (!sampler_open)
+		return -1;
+
+	for (channel = 0; channel < ADC_CHANNEL_MAX; channel++)
+		batch_length[channel] = 0;
+
+	if (mtk_os_hal_adc_period_get_data(batch, batch_length) != 0)
+		return -1;
+
+	for (channel = 0; channel < ADC_CHANNEL_MAX; channel++) {
+		if (!(sampled_channels & BIT(channel)))
+			continue;
+
+		ring = &rings[channel];
+		written = ring->written;
+		for (i = 0; i < batch_length[channel] && i < ADC_RING_BUF_SIZE; i++)
+			ring->samples[(written + i) % ADC_SAMPLER_RING_SIZE] = (uint16_t)batch[channel][i];
+
+		ring->written = written + i;		/* publish once the batch is in the ring */
+		added += (int)i;
+	}
+
+	return added;
+}
+
+/* Min, mean and max of the newest window samples of a channel, a window of zero or past
+   ADC_SAMPLER_WINDOW_MAX covers ADC_SAMPLER_WINDOW_MAX samples */
+int adc_sampler_summary(adc_channel channel, uint16_t window, adc_sampler_stats *stats) {
+	uint32_t written, sum = 0, i;
+	uint16_t sample;
+
+	if (!sampler_open || stats == NULL || channel >= ADC_CHANNEL_MAX || !(sampled_channels & BIT(channel)))
+		return -1;
+
+	if (window == 0 || window > ADC_SAMPLER_WINDOW_MAX)
+		window = ADC_SAMPLER_WINDOW_MAX;
+
+	written = rings[channel].written;
+	if (window > written)
+		window = (uint16_t)written;
+
+	stats->samples = window;
+	stats->min = ADC_SAMPLER_FULL_SCALE;
+	stats->mean = 0;
+	stats->max = 0;
+
+	if (window == 0) {
+		stats->min = 0;
+		return 0;
+	}
+
+	for (i = written - window; i != written; i++) {
+		sample = rings[channel].samples[i % ADC_SAMPLER_RING_SIZE];
+		sum += sample;
+		if (sample < stats->min)
+			stats->min = sample;
+		if (sample > stats->max)
+			stats->max = sample;
+	}
+	stats->mean = (uint16_t)((sum + window / 2) / window);
+
+	return 0;
+}
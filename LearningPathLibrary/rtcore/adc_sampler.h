@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include "os_hal_adc.h"
+
+/* Periodic ADC sampling into a ring per channel. adc_sampler_poll collects one FIFO batch and is
+   the only writer, adc_sampler_summary may run from another task at the same time: a poll only
+   publishes a batch once it is written and a summary never reaches back further than one batch
+   short of the ring, so the samples it reads are not overwritten under it. */
+#define ADC_SAMPLER_RING_SIZE 256		/* samples held per channel */
+#define ADC_SAMPLER_WINDOW_MAX (ADC_SAMPLER_RING_SIZE - ADC_RING_BUF_SIZE)
+#define ADC_SAMPLER_FULL_SCALE 4095		/* 12 bit codes, 2.5 V reference */
+
+typedef struct {
+	uint16_t samples;		/* samples in the window, zero when the channel has none yet */
+	uint16_t min;
+	uint16_t mean;
+	uint16_t max;
+} adc_sampler_stats;
+
+int adc_sampler_open(u16 channel_map);
+void adc_sampler_close(void);
+int adc_sampler_poll(void);
+int adc_sampler_summary(adc_channel channel, uint16_t window, adc_sampler_stats *stats);
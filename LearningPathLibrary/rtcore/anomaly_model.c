@@ -0,0 +1,167 @@
+#include "anomaly_model.h"
+#include <math.h>
+#include <string.h>
+#include "mt3620.h"
+#include "memory_placement.h"
+
+/* Stand-in until the A7 app sends a trained model, version 1 from tools/anomaly-model/build_anomaly_model.py --baseline
+   --mean 2,2,2,0.5,0.5,0.5 --std 1,1,1,0.5,0.5,0.5 --threshold 9. One layer of zero weights reconstructs every window
+   as the mean, so the score is the mean squared z score of the features against a board at rest, a few mg of sensor
+   noise on each axis, and it goes active with the features three deviations out on average */
+static LP_RT_FLASH_CONST const uint8_t default_model[] = {
+	0x4c, 0x50, 0x41, 0x4d, 0x01, 0x06, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x81, 0x80, 0x80, 0x3d,
+	0x00, 0x00, 0x10, 0x41, 0x66, 0x66, 0xe6, 0x3f, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x80, 0x3f,
+	0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x80, 0x3f,
+	0x00, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x00, 0x40,
+	0x00, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x00, 0x40, 0x06, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x40,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x11, 0x99, 0xa2
+};
+
+/* two slots so a model is written while the other one scores, the default runs from the image */
+static LP_RT_BULK uint8_t slots[2][LP_ANOMALY_MAX_SIZE] __attribute__((aligned(4)));
+static LP_ANOMALY_MODEL slot_models[2];
+static LP_ANOMALY_MODEL default_parsed;
+static const LP_ANOMALY_MODEL *model;		/* scoring, NULL when the default failed its check */
+static int free_slot;						/* the one anomaly_model_load writes, not the one scoring */
+static volatile bool load_pending;			/* set by the inter-core task once a slot is written, cleared as it is taken */
+static bool active;
+static uint32_t last_cycles;
+
+LP_RT_COLD int anomaly_model_init(void) {
+	model = NULL;
+	free_slot = 0;
+	load_pending = false;
+	active = false;
+
+	if (!lp_anomalyModelParse(&default_parsed, default_model, sizeof(default_model)) || default_parsed.inputs != ANOMALY_MODEL_FEATURES)
+		return -1;
+
+	model = &default_parsed;
+
+	/* DWT cycle counter for the cycles per window figure */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	return 0;
+}
+
+int anomaly_model_load(const uint8_t *blob, uint32_t length) {
+	LP_ANOMALY_MODEL *parsed = &slot_models[free_slot];
+
+	if (load_pending || blob == NULL || length > LP_ANOMALY_MAX_SIZE)
+		return -1;
+
+	memcpy(slots[free_slot], blob, length);
+	if (!lp_anomalyModelParse(parsed, slots[free_slot], length) || parsed->inputs != ANOMALY_MODEL_FEATURES)
+		return -1;
+
+	__DMB();					/* the slot is written before the flag, the scoring task reads them in that order */
+	load_pending = true;
+
+	return 0;
+}
+
+static int32_t requantize(int32_t acc, int32_t multiplier, int8_t shift) {
+	int total_shift = 31 - shift;
+
+	return (int32_t)(((int64_t)acc * multiplier + ((int64_t)1 << (total_shift - 1))) >> total_shift);
+}
+
+/* One layer, arm_fully_connected_s8's arithmetic. Four int8 weights and inputs are loaded as a word, sign extended
+   to two pairs of int16 by SXTB16, the inputs with their zero point taken off by SXTAB16, and multiplied and
+   accumulated a pair at a time by SMLAD */
+static LP_RT_HOT void fully_connected(const LP_ANOMALY_LAYER *layer, const int8_t *in, int8_t *out) {
+	int16_t offset = (int16_t)-layer->inZeroPoint;
+	uint32_t offset_pair = ((uint32_t)(uint16_t)offset << 16) | (uint16_t)offset;
+	int32_t low = layer->activation == LP_ANOMALY_RELU ? layer->outZeroPoint : INT8_MIN;
+	const int8_t *row = layer->weights;
+	uint32_t weights, inputs;
+	int32_t acc, value;
+	int i, j;
+
+	for (i = 0; i < layer->outputs; i++, row += layer->inputs) {
+		memcpy(&acc, layer->bias + i * sizeof(int32_t), sizeof(acc));
+
+		for (j = 0; j + 3 < layer->inputs; j += 4) {
+			memcpy(&weights, row + j, sizeof(weights));
+			memcpy(&inputs, in + j, sizeof(inputs));
+			acc = (int32_t)__SMLAD(__SXTB16(weights), __SXTAB16(offset_pair, inputs), (uint32_t)acc);
+			acc = (int32_t)__SMLAD(__SXTB16(__ROR(weights, 8)), __SXTAB16(offset_pair, __ROR(inputs, 8)), (uint32_t)acc);
+		}
+
+		for (; j < layer->inputs; j++)
+			acc += row[j] * (in[j] + offset);
+
+		value = requantize(acc, layer->multiplier, layer->shift) + layer->outZeroPoint;
+		out[i] = (int8_t)(value < low ? low : value > INT8_MAX ? INT8_MAX : value);
+	}
+}
+
+/* Score one window's features, ANOMALY_MODEL_FEATURES of them, and step the active state on the model's threshold
+   and hysteresis. A model loaded since the last window takes over here, from the state the one before left */
+LP_RT_HOT int anomaly_model_score(const float *features, int count, anomaly_result *result) {
+	int8_t buffers[2][LP_ANOMALY_MAX_WIDTH] __attribute__((aligned(4)));
+	int8_t quantized[LP_ANOMALY_MAX_WIDTH] __attribute__((aligned(4)));
+	uint32_t start = DWT->CYCCNT;
+	const int8_t *in = quantized;
+	float mean, gain, z, score;
+	int32_t error, sum_squares = 0;
+	bool was_active;
+	int i;
+
+	if (load_pending) {
+		model = &slot_models[free_slot];
+		free_slot ^= 1;
+		__DMB();
+		load_pending = false;
+	}
+
+	if (model == NULL || features == NULL || result == NULL || count != model->inputs)
+		return -1;
+
+	for (i = 0; i < model->inputs; i++) {
+		memcpy(&mean, model->normalisation + i * LP_ANOMALY_INPUT_SIZE, sizeof(float));
+		memcpy(&gain, model->normalisation + i * LP_ANOMALY_INPUT_SIZE + sizeof(float), sizeof(float));
+		z = fmaxf(fminf((features[i] - mean) * gain / model->inputScale, 256), -256);	/* saturated below, kept in range of the conversion */
+		quantized[i] = (int8_t)__SSAT((int32_t)lrintf(z) + model->inputZeroPoint, 8);
+	}
+
+	for (i = 0; i < model->layerCount; i++) {
+		fully_connected(&model->layers[i], in, buffers[i & 1]);
+		in = buffers[i & 1];
+	}
+
+	for (i = 0; i < model->inputs; i++) {
+		error = in[i] - quantized[i];
+		sum_squares += error * error;
+	}
+
+	score = (float)sum_squares / model->inputs * model->inputScale * model->inputScale;
+
+	was_active = active;
+	if (!active && score >= model->threshold)
+		active = true;
+	else if (active && score < model->threshold - model->hysteresis)
+		active = false;
+
+	result->score = score;
+	result->threshold = model->threshold;
+	result->version = model->version;
+	result->active = active;
+	result->changed = active != was_active;
+
+	last_cycles = DWT->CYCCNT - start;
+
+	return 0;
+}
+
+uint16_t anomaly_model_version(void) {
+	return model != NULL ? model->version : 0;
+}
+
+uint32_t anomaly_model_cycles(void) {
+	return last_cycles;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "anomaly_model_format.h"
+
+/* Anomaly scoring of the IMU DSP features, an int8 autoencoder run once per feature window, see shared/anomaly_model_format.h
+   for the model. The layers run four weights at a time with the dual 16 bit multiply-accumulates, as CMSIS-NN does it,
+   so a model of a few hundred weights costs a few thousand cycles a window. The image holds a default model, the A7
+   app replaces it with one sent as LP_IC_ANOMALY_MODEL, which takes effect from the next window. Only the scores
+   cross to the A7, the features stay here. */
+#define ANOMALY_MODEL_FEATURES 6	/* RMS then band RMS of the accelerometer x, y and z */
+
+typedef struct {
+	float score;			/* the window's, in z units squared */
+	float threshold;
+	uint16_t version;		/* of the model that scored it */
+	bool active;
+	bool changed;			/* active became set or cleared with this window */
+} anomaly_result;
+
+int anomaly_model_init(void);
+/* From the inter-core task, the blob is copied. -1 when it is not a model of ANOMALY_MODEL_FEATURES inputs or
+   the one sent before has not taken effect yet */
+int anomaly_model_load(const uint8_t *blob, uint32_t length);
+int anomaly_model_score(const float *features, int count, anomaly_result *result);
+uint16_t anomaly_model_version(void);
+uint32_t anomaly_model_cycles(void);	/* of the last window scored */
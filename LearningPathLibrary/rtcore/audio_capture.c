@@ -0,0 +1,86 @@
+#include "audio_capture.h"
+#include <stdbool.h>
+#include "printf.h"
+
+/* the DMA reaches SYSRAM but not TCM */
+#define I2S_DMA_BUFFER __attribute__((section(".sysram")))
+
+static I2S_DMA_BUFFER uint32_t rx_words[AUDIO_CAPTURE_WORDS] __attribute__((aligned(4)));
+static I2S_DMA_BUFFER uint32_t tx_words[AUDIO_CAPTURE_WORDS] __attribute__((aligned(4)));
+static audio_period_callback period_done;
+static volatile int next_period;		/* the period the DMA is filling */
+static i2s_no capture_port;
+static bool capture_open = false;
+
+/* the OS HAL has already moved the RX pointer past the period that completed */
+static void rx_callback(void *data) {
+	int period = next_period;
+
+	next_period = (period + 1) % AUDIO_CAPTURE_PERIODS;
+	period_done(period);
+}
+
+static void tx_callback(void *data) {
+}
+
+int audio_capture_open(i2s_no port, audio_period_callback done) {
+	audio_parameter parameter = {
+		.i2s_initial_type = MHAL_I2S_TYPE_EXTERNAL_MODE,
+		.sample_rate = MHAL_I2S_SAMPLE_RATE_16K,
+		.bits_per_sample = MHAL_I2S_BITS_PER_SAMPLE_32,
+		.channel_number = MHAL_I2S_MONO,
+		.channels_per_sample = MHAL_I2S_LINK_CHANNLE_PER_SAMPLE_2,
+		.msb_offset = 0,
+		.word_select_inverse = MHAL_FN_DIS,
+		.lr_swap = MHAL_FN_DIS,
+		.tx_mode = MHAL_I2S_TX_MONO_DUPLICATE_DISABLE,
+		.rx_down_rate = MHAL_I2S_RX_DOWN_RATE_DISABLE,
+		.tx_buffer_addr = (unsigned int *)tx_words,
+		.tx_buffer_len = AUDIO_CAPTURE_WORDS,
+		.tx_period_len = AUDIO_FRAME_SAMPLES,
+		.rx_buffer_addr = (unsigned int *)rx_words,
+		.rx_buffer_len = AUDIO_CAPTURE_WORDS,
+		.rx_period_len = AUDIO_FRAME_SAMPLES,
+		.tx_callback_func = tx_callback,
+		.rx_callback_func = rx_callback,
+	};
+
+	if (capture_open || done == NULL)
+		return -1;
+
+	period_done = done;
+	next_period = 0;
+
+	if (mtk_os_hal_request_i2s(port) != 0) {
+		printf("i2s request fail\n");
+		return -1;
+	}
+
+	if (mtk_os_hal_config_i2s(port, &parameter) != 0 || mtk_os_hal_enable_i2s(port) != 0) {
+		printf("i2s start fail\n");
+		mtk_os_hal_free_i2s(port);
+		return -1;
+	}
+
+	capture_port = port;
+	capture_open = true;
+
+	return 0;
+}
+
+void audio_capture_close(void) {
+	if (!capture_open)
+		return;
+
+	mtk_os_hal_disable_i2s(capture_port);
+	mtk_os_hal_free_i2s(capture_port);
+	capture_open = false;
+}
+
+/* The samples of a period named by the callback, left justified in 32 bit words */
+const int32_t *audio_capture_frame(int period) {
+	if (period < 0 || period >= AUDIO_CAPTURE_PERIODS)
+		return NULL;
+
+	return (const int32_t *)&rx_words[period * AUDIO_FRAME_SAMPLES];
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+#include "os_hal_i2s.h"
+#include "audio_features.h"
+
+/* 16 kHz mono I2S capture into a DMA virtual FIFO of two periods, one frame each, so the DMA
+   fills one while the other is processed: ping-pong without the CPU copying a sample. The
+   period callback runs in the DMA interrupt as each period completes, the frame it names is
+   stable for one period, 32 ms, before the DMA comes back round to it. The link also needs a
+   TX FIFO, it sends a silent buffer that is never written. */
+#define AUDIO_CAPTURE_PERIODS 2
+#define AUDIO_CAPTURE_WORDS (AUDIO_CAPTURE_PERIODS * AUDIO_FRAME_SAMPLES)	/* the MHAL wants at least 1024 */
+
+typedef void (*audio_period_callback)(int period);
+
+int audio_capture_open(i2s_no port, audio_period_callback done);
+void audio_capture_close(void);
+const int32_t *audio_capture_frame(int period);
@@ -0,0 +1,170 @@
+#include "audio_features.h"
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+#include "mt3620.h"
+#include "memory_placement.h"
+
+#define FULL_SCALE 2147483648.0f	/* I2S slots are 32 bit, the microphone's bits left justified */
+#define SINE_POWER 0.5f				/* mean square of a full scale sine, the 0 dB reference */
+#define HANN_POWER 0.375f			/* mean square of the Hann window, undone on the band levels */
+#define TWO_PI 6.28318531f
+
+static float window[AUDIO_FRAME_SAMPLES];
+static float cos_table[AUDIO_FRAME_SAMPLES / 2], sin_table[AUDIO_FRAME_SAMPLES / 2];
+static uint16_t bit_reverse[AUDIO_FRAME_SAMPLES];
+static float re[AUDIO_FRAME_SAMPLES], im[AUDIO_FRAME_SAMPLES];
+
+/* power sums over the frames since the last take */
+static float sum_power;
+static float sum_band_power[AUDIO_BANDS];
+static float peak;
+static uint16_t frames;
+static bool features_open = false;
+static uint32_t cycles;
+static uint32_t cycle_frames;
+
+LP_RT_COLD int audio_features_init(void) {
+	int i, bit;
+	uint16_t reversed;
+
+	for (i = 0; i < AUDIO_FRAME_SAMPLES; i++) {
+		window[i] = 0.5f - 0.5f * cosf(TWO_PI * i / AUDIO_FRAME_SAMPLES);
+
+		reversed = 0;
+		for (bit = 0; bit < AUDIO_FRAME_LOG2; bit++)
+			reversed |= (uint16_t)(((i >> bit) & 1) << (AUDIO_FRAME_LOG2 - 1 - bit));
+		bit_reverse[i] = reversed;
+	}
+
+	for (i = 0; i < AUDIO_FRAME_SAMPLES / 2; i++) {
+		cos_table[i] = cosf(TWO_PI * i / AUDIO_FRAME_SAMPLES);
+		sin_table[i] = sinf(TWO_PI * i / AUDIO_FRAME_SAMPLES);
+	}
+
+	sum_power = 0;
+	memset(sum_band_power, 0, sizeof(sum_band_power));
+	peak = 0;
+	frames = 0;
+	cycles = 0;
+	cycle_frames = 0;
+
+	/* DWT cycle counter for the cycles per frame figure, shared with imu_dsp */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	features_open = true;
+
+	return 0;
+}
+
+/* decimation in time on re and im, already in bit reversed order */
+static LP_RT_HOT void fft(void) {
+	float wr, wi, tr, ti;
+	int size, half, step, start, k, i, j;
+
+	for (size = 2; size <= AUDIO_FRAME_SAMPLES; size <<= 1) {
+		half = size >> 1;
+		step = AUDIO_FRAME_SAMPLES / size;
+
+		for (start = 0; start < AUDIO_FRAME_SAMPLES; start += size) {
+			for (k = 0; k < half; k++) {
+				wr = cos_table[k * step];
+				wi = -sin_table[k * step];
+				i = start + k;
+				j = i + half;
+
+				tr = wr * re[j] - wi * im[j];
+				ti = wr * im[j] + wi * re[j];
+				re[j] = re[i] - tr;
+				im[j] = im[i] - ti;
+				re[i] += tr;
+				im[i] += ti;
+			}
+		}
+	}
+}
+
+/* Fold one frame of AUDIO_FRAME_SAMPLES samples into the period's features. The frame's
+   mean is removed first, a microphone's DC offset would otherwise read as level */
+LP_RT_HOT int audio_features_frame(const int32_t *samples) {
+	uint32_t start = DWT->CYCCNT;
+	float x, mean = 0, power = 0, frame_peak = 0, band_power;
+	int i, band, bin, last;
+
+	if (!features_open || samples == NULL)
+		return -1;
+
+	for (i = 0; i < AUDIO_FRAME_SAMPLES; i++)
+		mean += (float)samples[i];
+	mean /= AUDIO_FRAME_SAMPLES;
+
+	for (i = 0; i < AUDIO_FRAME_SAMPLES; i++) {
+		x = ((float)samples[i] - mean) / FULL_SCALE;
+		power += x * x;
+		if (fabsf(x) > frame_peak)
+			frame_peak = fabsf(x);
+
+		re[bit_reverse[i]] = x * window[i];
+		im[bit_reverse[i]] = 0;
+	}
+
+	fft();
+
+	/* one sided, so each bin counts twice, and N squared from the unscaled transform */
+	for (band = 0, bin = 1; band < AUDIO_BANDS; band++) {
+		last = (2 << band) - 1;
+		for (band_power = 0; bin <= last && bin < AUDIO_FRAME_SAMPLES / 2; bin++)
+			band_power += re[bin] * re[bin] + im[bin] * im[bin];
+		sum_band_power[band] += 2 * band_power / ((float)AUDIO_FRAME_SAMPLES * AUDIO_FRAME_SAMPLES * HANN_POWER);
+	}
+
+	sum_power += power / AUDIO_FRAME_SAMPLES;
+	if (frame_peak > peak)
+		peak = frame_peak;
+	if (frames < UINT16_MAX)
+		frames++;
+
+	cycles += DWT->CYCCNT - start;
+	cycle_frames++;
+
+	return 0;
+}
+
+static float level_dbfs(float power) {
+	float db = power > 0 ? 10 * log10f(power / SINE_POWER) : AUDIO_FLOOR_DBFS;
+
+	return db > AUDIO_FLOOR_DBFS ? db : AUDIO_FLOOR_DBFS;
+}
+
+/* Average the frames since the previous take into features, and start the next period.
+   With no frames every level is AUDIO_FLOOR_DBFS */
+int audio_features_take(audio_feature_vector *features) {
+	int band;
+
+	if (!features_open || features == NULL)
+		return -1;
+
+	features->frames = frames;
+	features->rms_dbfs = level_dbfs(frames ? sum_power / frames : 0);
+	features->peak_dbfs = level_dbfs(peak * peak * SINE_POWER);		/* a full scale peak reads 0 dB */
+	for (band = 0; band < AUDIO_BANDS; band++)
+		features->band_dbfs[band] = level_dbfs(frames ? sum_band_power[band] / frames : 0);
+
+	sum_power = 0;
+	memset(sum_band_power, 0, sizeof(sum_band_power));
+	peak = 0;
+	frames = 0;
+
+	return 0;
+}
+
+/* Cycles audio_features_frame spent per frame since the last call */
+uint32_t audio_features_cycles_per_frame(void) {
+	uint32_t result = cycle_frames ? cycles / cycle_frames : 0;
+
+	cycles = 0;
+	cycle_frames = 0;
+
+	return result;
+}
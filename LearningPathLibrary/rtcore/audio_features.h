@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+#include "inter_core_protocol.h"
+
+/* Sound level features of I2S audio frames, so only a few numbers per period cross to the A7
+   rather than 64 KB of samples a second. Each frame is windowed and transformed with an in-place
+   radix-2 FFT in single precision on the FPU. The RMS and peak are taken on the samples, the band
+   levels from the spectrum, bins 2^b up to 2^(b+1) - 1 make band b, octaves from 31 Hz at 16 kHz.
+   Levels are dB relative to a full scale sine, averaged as power over the frames of a period. */
+#define AUDIO_SAMPLE_RATE_HZ 16000
+#define AUDIO_FRAME_SAMPLES 512		/* 32 ms, 31.25 Hz per bin */
+#define AUDIO_FRAME_LOG2 9
+#define AUDIO_BANDS LP_IC_AUDIO_BANDS
+#define AUDIO_FLOOR_DBFS -120.0f	/* silence, and any level below it */
+
+typedef struct {
+	uint16_t frames;			/* folded in since the previous audio_features_take */
+	float rms_dbfs;
+	float peak_dbfs;
+	float band_dbfs[AUDIO_BANDS];
+} audio_feature_vector;
+
+int audio_features_init(void);
+int audio_features_frame(const int32_t *samples);
+int audio_features_take(audio_feature_vector *features);
+uint32_t audio_features_cycles_per_frame(void);
@@ -0,0 +1,47 @@
+#include "buttons.h"
+#include "printf.h"
+
+static gpio_pin button_gpios[BUTTONS_MAX];
+static int button_count = 0;
+static button_press_handler press_handler = NULL;
+
+/* EINT handlers take no argument, so each button slot gets its own */
+static void button_0_isr(void) { press_handler(0); }
+static void button_1_isr(void) { press_handler(1); }
+static void button_2_isr(void) { press_handler(2); }
+static void button_3_isr(void) { press_handler(3); }
+
+static void (*const button_isrs[BUTTONS_MAX])(void) = { button_0_isr, button_1_isr, button_2_isr, button_3_isr };
+
+/* Buttons are active low, a press is a debounced falling edge. The pins stay requested as inputs until buttons_close */
+int buttons_open(const os_hal_gpio_pin* pins, int count, os_hal_eint_debounce_time debounce, button_press_handler handler) {
+	if (pins == NULL || handler == NULL || count > BUTTONS_MAX || button_count != 0)
+		return -1;
+
+	press_handler = handler;
+
+	for (int i = 0; i < count; i++) {
+		if (gpio_pin_open_input(&button_gpios[i], pins[i]) != 0) {
+			buttons_close();
+			return -1;
+		}
+		button_count++;
+
+		if (mtk_os_hal_eint_register((eint_number)pins[i], HAL_EINT_EDGE_FALLING, button_isrs[i]) < 0 ||
+			mtk_os_hal_eint_set_debounce((eint_number)pins[i], debounce) < 0) {
+			printf("register eint[%d] fail\n", pins[i]);
+			buttons_close();
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+void buttons_close(void) {
+	while (button_count > 0) {
+		button_count--;
+		mtk_os_hal_eint_unregister((eint_number)button_gpios[button_count].pin);
+		gpio_pin_close(&button_gpios[button_count]);
+	}
+}
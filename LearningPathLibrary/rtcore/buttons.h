@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdint.h>
+#include "os_hal_eint.h"
+#include "gpio_pins.h"
+
+/* Buttons on EINT, GPIO n is EINT n for the first 24 pins */
+#define BUTTONS_MAX 4
+
+/* Called from the EINT interrupt with the index of the pressed button in the pins passed to buttons_open */
+typedef void (*button_press_handler)(int button);
+
+int buttons_open(const os_hal_gpio_pin* pins, int count, os_hal_eint_debounce_time debounce, button_press_handler handler);
+void buttons_close(void);
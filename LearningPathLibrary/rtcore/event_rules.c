@@ -0,0 +1,112 @@
+#include "event_rules.h"
+#include <math.h>
+#include <stddef.h>
+#include "memory_placement.h"
+
+typedef struct {
+	LP_IC_RULE_KIND kind;
+	uint8_t channel;
+	float threshold;
+	float hysteresis;
+} rule_config;
+
+typedef struct {
+	rule_config config;
+	uint32_t applied;			/* requested_count this config was copied at */
+	bool active;
+	bool span_started;
+	float span_start;			/* value at the start of the rate of change span */
+	uint32_t span_samples;
+} rule_state;
+
+static rule_config requested[LP_IC_MAX_RULES];
+static volatile uint32_t requested_count[LP_IC_MAX_RULES];	/* bumped after requested is written */
+static rule_state rules[LP_IC_MAX_RULES];
+static uint32_t rate_span = 1;
+static float rate_scale = 1;		/* per second from the change over one span */
+
+/* Every rule starts cleared, rules set before this call are kept */
+void event_rules_init(float sample_rate_hz) {
+	rate_span = (uint32_t)(sample_rate_hz / EVENT_RULES_RATE_SPAN_HZ);
+	if (rate_span == 0)
+		rate_span = 1;
+	rate_scale = sample_rate_hz / rate_span;
+}
+
+/* A kind of LP_IC_RULE_NONE clears the rule without an event */
+int event_rules_set(uint8_t rule, LP_IC_RULE_KIND kind, uint8_t channel, float threshold, float hysteresis) {
+	if (rule >= LP_IC_MAX_RULES || kind > LP_IC_RULE_RATE || channel >= LP_IC_CHANNEL_COUNT)
+		return -1;
+
+	requested[rule].kind = kind;
+	requested[rule].channel = channel;
+	requested[rule].threshold = threshold;
+	requested[rule].hysteresis = fabsf(hysteresis);
+	requested_count[rule]++;
+
+	return 0;
+}
+
+/* True while the rule holds, the hysteresis keeps an active rule held until the value is back past it */
+static bool rule_holds(const rule_state *r, float value) {
+	const rule_config *c = &r->config;
+
+	switch (c->kind) {
+	case LP_IC_RULE_ABOVE:
+		return r->active ? value >= c->threshold - c->hysteresis : value > c->threshold;
+	case LP_IC_RULE_BELOW:
+		return r->active ? value <= c->threshold + c->hysteresis : value < c->threshold;
+	case LP_IC_RULE_RATE:
+		value = fabsf(value);
+		return r->active ? value >= c->threshold - c->hysteresis : value > c->threshold;
+	default:
+		return false;
+	}
+}
+
+LP_RT_HOT void event_rules_evaluate(uint8_t channel, float value, event_rule_handler handler) {
+	rule_state *r;
+	uint32_t count;
+	float measured;
+	bool holds;
+	int i;
+
+	for (i = 0; i < LP_IC_MAX_RULES; i++) {
+		r = &rules[i];
+
+		count = requested_count[i];
+		if (count != r->applied) {
+			r->config = requested[i];
+			r->applied = count;
+			r->active = false;
+			r->span_started = false;
+		}
+
+		if (r->config.kind == LP_IC_RULE_NONE || r->config.channel != channel)
+			continue;
+
+		measured = value;
+
+		if (r->config.kind == LP_IC_RULE_RATE) {
+			if (!r->span_started) {
+				r->span_start = value;
+				r->span_samples = 0;
+				r->span_started = true;
+			}
+
+			if (++r->span_samples < rate_span)
+				continue;
+
+			measured = (value - r->span_start) * rate_scale;
+			r->span_start = value;
+			r->span_samples = 0;
+		}
+
+		holds = rule_holds(r, measured);
+		if (holds != r->active) {
+			r->active = holds;
+			if (handler != NULL)
+				handler((uint8_t)i, channel, holds, measured);
+		}
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inter_core_protocol.h"
+
+/* Threshold and rate of change rules evaluated on every sample, only the moments a rule becomes
+   active or clears are reported. event_rules_evaluate runs from the sampling task only,
+   event_rules_set may run from another task: the new rule is taken up on the next sample. */
+#define EVENT_RULES_RATE_SPAN_HZ 10		/* rate of change is measured over a tenth of a second */
+
+typedef void (*event_rule_handler)(uint8_t rule, uint8_t channel, bool active, float value);
+
+void event_rules_init(float sample_rate_hz);
+int event_rules_set(uint8_t rule, LP_IC_RULE_KIND kind, uint8_t channel, float threshold, float hysteresis);
+void event_rules_evaluate(uint8_t channel, float value, event_rule_handler handler);
@@ -0,0 +1,88 @@
+#include "gpio_pins.h"
+#include "printf.h"
+
+static int gpio_pin_open(gpio_pin* gpio, os_hal_gpio_pin pin, os_hal_gpio_direction direction) {
+	if (gpio == NULL || gpio->open)
+		return -1;
+
+	if (mtk_os_hal_gpio_request(pin) != 0) {
+		printf("request gpio[%d] fail\n", pin);
+		return -1;
+	}
+
+	gpio->pin = pin;
+	gpio->open = true;
+	mtk_os_hal_gpio_set_direction(pin, direction);
+	return 0;
+}
+
+int gpio_pin_open_output(gpio_pin* gpio, os_hal_gpio_pin pin, os_hal_gpio_data level) {
+	if (gpio_pin_open(gpio, pin, OS_HAL_GPIO_DIR_OUTPUT) != 0)
+		return -1;
+
+	gpio_pin_set(gpio, level);
+	return 0;
+}
+
+int gpio_pin_open_input(gpio_pin* gpio, os_hal_gpio_pin pin) {
+	return gpio_pin_open(gpio, pin, OS_HAL_GPIO_DIR_INPUT);
+}
+
+void gpio_pin_close(gpio_pin* gpio) {
+	if (gpio != NULL && gpio->open) {
+		mtk_os_hal_gpio_free(gpio->pin);
+		gpio->open = false;
+	}
+}
+
+void gpio_pin_set(gpio_pin* gpio, os_hal_gpio_data level) {
+	gpio->level = level;
+	mtk_os_hal_gpio_set_output(gpio->pin, level);
+}
+
+os_hal_gpio_data gpio_pin_get(gpio_pin* gpio) {
+	os_hal_gpio_data value = OS_HAL_GPIO_DATA_LOW;
+
+	mtk_os_hal_gpio_get_input(gpio->pin, &value);
+	return value;
+}
+
+void gpio_pin_toggle(gpio_pin* gpio) {
+	gpio_pin_set(gpio, gpio->level == OS_HAL_GPIO_DATA_LOW ? OS_HAL_GPIO_DATA_HIGH : OS_HAL_GPIO_DATA_LOW);
+}
+
+int gpio_port_open_output(gpio_port* port, const os_hal_gpio_pin* pins, int count, uint32_t value) {
+	if (port == NULL || pins == NULL || count > GPIO_PORT_MAX)
+		return -1;
+
+	port->count = 0;
+	port->value = value;
+
+	for (int i = 0; i < count; i++) {
+		port->pins[i].open = false;
+		if (gpio_pin_open_output(&port->pins[i], pins[i], (value >> i) & 1 ? OS_HAL_GPIO_DATA_HIGH : OS_HAL_GPIO_DATA_LOW) != 0) {
+			gpio_port_close(port);
+			return -1;
+		}
+		port->count++;
+	}
+
+	return 0;
+}
+
+void gpio_port_close(gpio_port* port) {
+	while (port->count > 0)
+		gpio_pin_close(&port->pins[--port->count]);
+}
+
+/* Only the pins whose level changes are written */
+void gpio_port_write(gpio_port* port, uint32_t value) {
+	uint32_t changed = port->value ^ value;
+
+	for (int i = 0; i < port->count; i++) {
+		if ((changed >> i) & 1)
+			gpio_pin_set(&port->pins[i], (value >> i) & 1 ? OS_HAL_GPIO_DATA_HIGH : OS_HAL_GPIO_DATA_LOW);
+	}
+
+	port->value = value;
+}
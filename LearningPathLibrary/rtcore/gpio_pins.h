@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "os_hal_gpio.h"
+
+/* GPIO pins requested and configured once, then driven directly without a request/free per access */
+#define GPIO_PORT_MAX 8
+
+typedef struct {
+	os_hal_gpio_pin pin;
+	os_hal_gpio_data level;		/* last level written, outputs only */
+	bool open;
+} gpio_pin;
+
+/* Outputs driven together, bit n of a port value is the level of pins[n] */
+typedef struct {
+	gpio_pin pins[GPIO_PORT_MAX];
+	int count;
+	uint32_t value;
+} gpio_port;
+
+int gpio_pin_open_output(gpio_pin* gpio, os_hal_gpio_pin pin, os_hal_gpio_data level);
+int gpio_pin_open_input(gpio_pin* gpio, os_hal_gpio_pin pin);
+void gpio_pin_close(gpio_pin* gpio);
+void gpio_pin_set(gpio_pin* gpio, os_hal_gpio_data level);
+os_hal_gpio_data gpio_pin_get(gpio_pin* gpio);
+void gpio_pin_toggle(gpio_pin* gpio);
+
+int gpio_port_open_output(gpio_port* port, const os_hal_gpio_pin* pins, int count, uint32_t value);
+void gpio_port_close(gpio_port* port);
+void gpio_port_write(gpio_port* port, uint32_t value);
@@ -0,0 +1,31 @@
+#include "i2c.h"
+
+int32_t i2c_write(int* fD, uint8_t reg, uint8_t* buf, uint16_t len) {
+	return i2c_bus_write(i2c_lsm6dso_addr, reg, buf, len, I2C_BUS_PRIORITY_CALLER);
+}
+
+int32_t i2c_read(int* fD, uint8_t reg, uint8_t* buf, uint16_t len) {
+	return i2c_bus_read(i2c_lsm6dso_addr, reg, buf, len, I2C_BUS_PRIORITY_CALLER, 0);
+}
+
+void i2c_enum(void) {
+	uint8_t i;
+	uint8_t data;
+
+	printf("[ISU%d] Enumerate I2C Bus, Start\n", i2c_port_num);
+	for (i = 0; i < 0x80; i += 2) {
+		printf("[ISU%d] Address:0x%02X, ", i2c_port_num, i);
+		if (mtk_os_hal_i2c_read(i2c_port_num, i, &data, 1) == 0)
+			printf("Found 0x%02X\n", i);
+	}
+	printf("[ISU%d] Enumerate I2C Bus, Finish\n\n", i2c_port_num);
+}
+
+/* From the bus task, which owns the controller */
+int i2c_init(void) {
+	/* MT3620 I2C Init */
+	mtk_os_hal_i2c_ctrl_init(i2c_port_num);
+	mtk_os_hal_i2c_speed_init(i2c_port_num, i2c_speed);
+
+	return 0;
+}
\ No newline at end of file
@@ -1,16 +1,22 @@
 #pragma once
 
 #include <stdint.h>
+#include "i2c_bus.h"
 #include "lsm6dso_reg.h"
 #include "os_hal_i2c.h"
 
 /* I2C */
-#define I2C_MAX_LEN 64
+#define I2C_MAX_LEN 256
+#define I2C_BURST_MAX_LEN I2C_MAX_LEN		/* transfers past the 8 byte controller FIFO go through DMA */
+
+/* DMA reaches SYSRAM but not TCM, the bus task's buffers are declared with this */
+#define I2C_DMA_BUFFER __attribute__((section(".sysram")))
 static const uint8_t i2c_port_num = OS_HAL_I2C_ISU2;
 static const uint8_t i2c_speed = I2C_SCL_1000kHz;
 static const uint8_t i2c_lsm6dso_addr = LSM6DSO_I2C_ADD_L >> 1;
 
 
+/* The LSM6DSO driver's register access, through the bus task at the priority of the calling task */
 int32_t i2c_write(int* fD, uint8_t reg, uint8_t* buf, uint16_t len);
 int32_t i2c_read(int* fD, uint8_t reg, uint8_t* buf, uint16_t len);
 void i2c_enum(void);
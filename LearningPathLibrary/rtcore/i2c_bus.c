@@ -0,0 +1,259 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "i2c_bus.h"
+#include "i2c.h"
+#include "inter_core_protocol.h"
+#include "sample_clock.h"
+
+#define I2C_BUS_DONE_FLAG 0x1		/* a request, its transfer is done */
+#define I2C_BUS_XFER_FLAG 0x1		/* the bus task, the controller finished a read */
+
+typedef struct {
+	uint8_t addr;
+	uint8_t reg;
+	uint8_t write;
+	uint8_t flags;
+	uint16_t len;
+	unsigned priority;
+	uint8_t *buf;			/* read into, or the bytes written */
+	uint32_t asked_us;
+	int result;
+	/* used by whichever task holds the request, a set before it waits may wake the last holder, which waits again */
+	rtos_event done;
+} i2c_bus_request;
+
+static i2c_bus_request requests[I2C_BUS_REQUESTS];
+static rtos_queue free_queue;			/* indexes of the requests callers may fill */
+static RTOS_QUEUE_STORAGE(free_queue_storage, sizeof(int), I2C_BUS_REQUESTS);
+static rtos_queue asked_queue;			/* and of those filled, for the bus task */
+static RTOS_QUEUE_STORAGE(asked_queue_storage, sizeof(int), I2C_BUS_REQUESTS);
+static rtos_event bus_event;
+static volatile int xfer_result;
+static I2C_DMA_BUFFER uint8_t bus_tx[I2C_MAX_LEN];
+static I2C_DMA_BUFFER uint8_t bus_rx[I2C_MAX_LEN];
+
+/* the bus task's alone, the requests it has taken in the order they were asked */
+static int pending[I2C_BUS_REQUESTS];
+static int pending_count;
+
+/* running totals written by the bus task only, a take reads them against the last */
+static i2c_bus_stats totals;
+static volatile bool max_wait_taken;
+static i2c_bus_stats taken;
+static uint32_t taken_us;
+
+static void bus_read_done(int result, void *context) {
+	xfer_result = result;
+	rtos_event_set_isr(&bus_event, I2C_BUS_XFER_FLAG);
+}
+
+static int bus_read(uint8_t addr, uint8_t reg, uint16_t len) {
+	bus_tx[0] = reg;
+	if (mtk_os_hal_i2c_write_read_async(i2c_port_num, addr, bus_tx, bus_rx, 1, len, bus_read_done, NULL) != 0)
+		return -1;
+
+	if (rtos_event_wait(&bus_event, I2C_BUS_XFER_FLAG, I2C_BUS_TIMEOUT_MS) == 0) {
+		mtk_os_hal_i2c_abort_async(i2c_port_num);		/* no completion interrupt, reset the controller so the bus is usable again */
+		return -1;
+	}
+
+	return xfer_result == 0 ? 0 : -1;
+}
+
+static int bus_write(const i2c_bus_request *request) {
+	bus_tx[0] = request->reg;
+	memcpy(&bus_tx[1], request->buf, request->len);
+	return mtk_os_hal_i2c_write(i2c_port_num, request->addr, bus_tx, request->len + 1) == 0 ? 0 : -1;
+}
+
+/* Another waiting read the lead's read can take in, the span grown to cover it stays within I2C_MAX_LEN */
+static bool merge_read(const i2c_bus_request *lead, const i2c_bus_request *other, int *lo, int *hi) {
+	int other_lo = other->reg, other_hi = other->reg + other->len;
+
+	if (other->write || (other->flags & I2C_BUS_NO_MERGE) || other->addr != lead->addr)
+		return false;
+
+	if (other_lo > *hi + I2C_BUS_MERGE_GAP || other_hi + I2C_BUS_MERGE_GAP < *lo)
+		return false;
+
+	other_lo = other_lo < *lo ? other_lo : *lo;
+	other_hi = other_hi > *hi ? other_hi : *hi;
+	if (other_hi - other_lo > I2C_MAX_LEN)
+		return false;
+
+	*lo = other_lo;
+	*hi = other_hi;
+	return true;
+}
+
+/* Run the most urgent waiting transfer, with every read merged into it, and hand each caller its result */
+static void run_next(void) {
+	bool member[I2C_BUS_REQUESTS] = { false };
+	i2c_bus_request *lead, *request;
+	uint32_t started_us, wait_us;
+	int first = 0, lo, hi, result, i, kept;
+	bool grown;
+
+	for (i = 1; i < pending_count; i++)
+		if (requests[pending[i]].priority > requests[pending[first]].priority)
+			first = i;		/* strictly above, so the oldest of a priority goes first */
+
+	lead = &requests[pending[first]];
+	member[first] = true;
+	lo = lead->reg;
+	hi = lead->reg + lead->len;
+
+	/* a read taken in can bring the span within reach of another, so pass again until none joins */
+	if (!lead->write && !(lead->flags & I2C_BUS_NO_MERGE)) {
+		do {
+			grown = false;
+			for (i = 0; i < pending_count; i++)
+				if (!member[i] && merge_read(lead, &requests[pending[i]], &lo, &hi))
+					member[i] = grown = true;
+		} while (grown);
+	}
+
+	started_us = sample_clock_now_us();
+	if (max_wait_taken) {
+		totals.max_wait_us = 0;
+		max_wait_taken = false;
+	}
+	for (i = 0; i < pending_count; i++) {
+		wait_us = started_us - requests[pending[i]].asked_us;
+		if (member[i] && wait_us > totals.max_wait_us)
+			totals.max_wait_us = wait_us;
+	}
+
+	result = lead->write ? bus_write(lead) : bus_read(lead->addr, (uint8_t)lo, (uint16_t)(hi - lo));
+
+	totals.busy_us += sample_clock_now_us() - started_us;
+	totals.transfers++;
+	totals.bytes += lead->write ? lead->len : (uint32_t)(hi - lo);
+	if (result != 0)
+		totals.errors++;
+
+	for (i = 0, kept = 0; i < pending_count; i++) {
+		if (!member[i]) {
+			pending[kept++] = pending[i];
+			continue;
+		}
+
+		request = &requests[pending[i]];
+		if (result == 0 && !request->write)
+			memcpy(request->buf, &bus_rx[request->reg - lo], request->len);
+		request->result = result;
+		rtos_event_set(&request->done, I2C_BUS_DONE_FLAG);
+	}
+	pending_count = kept;
+}
+
+int i2c_bus_init(void) {
+	int i;
+
+	if (rtos_queue_create(&free_queue, "i2c free", sizeof(int), I2C_BUS_REQUESTS, free_queue_storage) != 0 ||
+		rtos_queue_create(&asked_queue, "i2c asked", sizeof(int), I2C_BUS_REQUESTS, asked_queue_storage) != 0 ||
+		rtos_event_create(&bus_event, "i2c bus") != 0)
+		return -1;
+
+	for (i = 0; i < I2C_BUS_REQUESTS; i++) {
+		if (rtos_event_create(&requests[i].done, "i2c request") != 0)
+			return -1;
+		rtos_queue_send(&free_queue, &i);
+	}
+
+	return 0;
+}
+
+void i2c_bus_task(void) {
+	int slot;
+
+	if (i2c_init() != 0)
+		return;
+	i2c_enum();
+	taken_us = sample_clock_now_us();
+
+	while (true) {
+		/* sleeps while nothing is asked, then takes in all that was asked meanwhile so the most urgent goes first */
+		if (pending_count == 0 && rtos_queue_receive(&asked_queue, &slot, RTOS_WAIT_FOREVER) == 0) {
+			pending[pending_count++] = slot;
+			totals.requests++;
+		}
+		while (pending_count < I2C_BUS_REQUESTS && rtos_queue_receive(&asked_queue, &slot, RTOS_NO_WAIT) == 0) {
+			pending[pending_count++] = slot;
+			totals.requests++;
+		}
+
+		if (pending_count > 0)
+			run_next();
+	}
+}
+
+static int bus_transfer(uint8_t addr, uint8_t reg, uint8_t *buf, uint16_t len, unsigned priority, uint8_t flags, uint8_t write) {
+	i2c_bus_request *request;
+	int slot, result;
+
+	if (buf == NULL || len == 0 || len > (write ? I2C_MAX_LEN - 1 : I2C_MAX_LEN))
+		return -1;
+
+	if (rtos_queue_receive(&free_queue, &slot, RTOS_WAIT_FOREVER) != 0)
+		return -1;
+
+	request = &requests[slot];
+	request->addr = addr;
+	request->reg = reg;
+	request->write = write;
+	request->flags = flags;
+	request->len = len;
+	request->priority = priority != I2C_BUS_PRIORITY_CALLER ? priority : rtos_task_priority();
+	request->buf = buf;
+	request->asked_us = sample_clock_now_us();
+
+	/* never more asked than there are requests, so the send finds room */
+	rtos_queue_send(&asked_queue, &slot);
+	rtos_event_wait(&request->done, I2C_BUS_DONE_FLAG, RTOS_WAIT_FOREVER);		/* the bus task times the transfer out */
+
+	result = request->result;
+	rtos_queue_send(&free_queue, &slot);
+	return result;
+}
+
+int i2c_bus_read(uint8_t addr, uint8_t reg, uint8_t *buf, uint16_t len, unsigned priority, uint8_t flags) {
+	return bus_transfer(addr, reg, buf, len, priority, flags, 0);
+}
+
+int i2c_bus_write(uint8_t addr, uint8_t reg, const uint8_t *buf, uint16_t len, unsigned priority) {
+	return bus_transfer(addr, reg, (uint8_t *)buf, len, priority, 0, 1);
+}
+
+void i2c_bus_stats_take(i2c_bus_stats *stats_out) {
+	i2c_bus_stats now = totals;
+	uint32_t now_us = sample_clock_now_us();
+
+	stats_out->window_us = now_us - taken_us;
+	stats_out->busy_us = now.busy_us - taken.busy_us;
+	stats_out->requests = now.requests - taken.requests;
+	stats_out->transfers = now.transfers - taken.transfers;
+	stats_out->bytes = now.bytes - taken.bytes;
+	stats_out->max_wait_us = now.max_wait_us;
+	stats_out->errors = now.errors - taken.errors;
+
+	taken = now;
+	taken_us = now_us;
+	max_wait_taken = true;		/* cleared by the bus task at its next transfer */
+}
+
+void i2c_bus_report(rtos_profile_sender send) {
+	i2c_bus_stats stats;
+
+	i2c_bus_stats_take(&stats);
+	send(&(LP_INTER_CORE_BLOCK){ .cmd = LP_IC_BUS_PROFILE,
+		.busPermille = stats.window_us != 0 ? (uint16_t)((uint64_t)stats.busy_us * 1000 / stats.window_us) : 0,
+		.busRequests = stats.requests, .busTransfers = stats.transfers, .busBytes = stats.bytes,
+		.busMaxWaitUs = stats.max_wait_us, .busErrors = stats.errors });
+
+	printf("i2c bus %u.%u%% busy, %u requests in %u transfers, %u bytes, %u us longest wait, %u errors\n",
+		(unsigned)(stats.window_us != 0 ? (uint64_t)stats.busy_us * 100 / stats.window_us : 0),
+		(unsigned)(stats.window_us != 0 ? (uint64_t)stats.busy_us * 1000 / stats.window_us % 10 : 0),
+		(unsigned)stats.requests, (unsigned)stats.transfers, (unsigned)stats.bytes, (unsigned)stats.max_wait_us, (unsigned)stats.errors);
+}
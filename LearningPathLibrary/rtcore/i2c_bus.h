@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include "rtos.h"
+
+/* One task owns the ISU I2C controller and runs the transfers the other tasks ask for one at a time, so no two
+   tasks drive it at once and a FIFO drain is not held behind a slow environmental reading. Transfers wait in
+   priority order, the priority of the task that asked unless one is given, the oldest first within a priority,
+   and the caller sleeps until its transfer is done. The bus task is created above every task that asks, a
+   caller's priority only orders the waiting transfers.
+
+   Reads of one device waiting together whose registers overlap, or lie within I2C_BUS_MERGE_GAP registers of
+   each other, go on the bus as one read and each caller is copied its share: one address phase, and the
+   readings taken at the same moment. The device must increment the register address across a read, the
+   LSM6DSO does by default. A read with side effects, a FIFO drain, is passed I2C_BUS_NO_MERGE.
+
+   Data moves through the bus task's own SYSRAM buffers, so callers' buffers may be anywhere, TCM included.
+   Every i2c_bus_stats_take is one window of the utilisation: the share of it a transfer was on the bus, the
+   longest any caller waited for its transfer to start, and the reads merged. */
+#define I2C_BUS_REQUESTS 6				/* transfers waiting at once, one per task using the bus is enough */
+#define I2C_BUS_MERGE_GAP 2				/* unused registers a merged read may span, read and discarded */
+#define I2C_BUS_TIMEOUT_MS 20			/* a 224 byte read takes about 2 ms at 1 MHz, two ticks of the ThreadX clock */
+#define I2C_BUS_PRIORITY_CALLER 0		/* the priority of the asking task, 1 to RTOS_PRIORITIES */
+
+#define I2C_BUS_NO_MERGE 0x1
+
+typedef struct {
+	uint32_t window_us;			/* since the last take */
+	uint32_t busy_us;			/* transfers on the bus */
+	uint32_t requests;			/* transfers asked for */
+	uint32_t transfers;			/* run on the bus, requests less those merged into another's read */
+	uint32_t bytes;
+	uint32_t max_wait_us;		/* asked for to started */
+	uint32_t errors;			/* failed or timed out, the controller is reset after a timeout */
+} i2c_bus_stats;
+
+int i2c_bus_init(void);		/* before the scheduler starts and before any task asks */
+void i2c_bus_task(void);	/* the task entry, created at a priority above every task using the bus */
+
+/* Register reads and writes of the device at address addr, 7 bit. Return 0, or -1 when the transfer failed or
+   was too long for I2C_MAX_LEN */
+int i2c_bus_read(uint8_t addr, uint8_t reg, uint8_t *buf, uint16_t len, unsigned priority, uint8_t flags);
+int i2c_bus_write(uint8_t addr, uint8_t reg, const uint8_t *buf, uint16_t len, unsigned priority);
+
+void i2c_bus_stats_take(i2c_bus_stats *stats_out);
+/* Takes the stats and sends them as one LP_IC_BUS_PROFILE, after the thread records of a profile report */
+void i2c_bus_report(rtos_profile_sender send);
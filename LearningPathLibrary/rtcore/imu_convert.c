@@ -0,0 +1,63 @@
+#include "imu_convert.h"
+#include <string.h>
+#include "mt3620.h"
+#include "memory_placement.h"
+
+/* Offsets for the three words of two triplets, X0 Y0, Z0 X1 and Y1 Z1, low half first */
+static void offset_words(const int16_t offset[3], uint32_t words[3]) {
+	words[0] = (uint16_t)offset[0] | ((uint32_t)(uint16_t)offset[1] << 16);
+	words[1] = (uint16_t)offset[2] | ((uint32_t)(uint16_t)offset[0] << 16);
+	words[2] = (uint16_t)offset[1] | ((uint32_t)(uint16_t)offset[2] << 16);
+}
+
+static inline int16_t low(uint32_t pair) {
+	return (int16_t)pair;
+}
+
+static inline int16_t high(uint32_t pair) {
+	return (int16_t)(pair >> 16);
+}
+
+LP_RT_HOT void imu_convert_float(const int16_t *raw, int count, const int16_t offset[3], float scale, float *out, int out_stride) {
+	uint32_t offsets[3], pair[3];
+	int i, axis;
+
+	offset_words(offset, offsets);
+
+	for (i = 0; i + 1 < count; i += 2, raw += 6, out += 2 * out_stride) {
+		memcpy(pair, raw, sizeof(pair));
+		pair[0] = __QSUB16(pair[0], offsets[0]);
+		pair[1] = __QSUB16(pair[1], offsets[1]);
+		pair[2] = __QSUB16(pair[2], offsets[2]);
+
+		out[0] = low(pair[0]) * scale;
+		out[1] = high(pair[0]) * scale;
+		out[2] = low(pair[1]) * scale;
+		out[out_stride] = high(pair[1]) * scale;
+		out[out_stride + 1] = low(pair[2]) * scale;
+		out[out_stride + 2] = high(pair[2]) * scale;
+	}
+
+	if (i < count)
+		for (axis = 0; axis < 3; axis++)
+			out[axis] = (int16_t)__SSAT(raw[axis] - offset[axis], 16) * scale;
+}
+
+LP_RT_HOT void imu_convert_q15(const int16_t *raw, int count, const int16_t offset[3], int16_t *out) {
+	uint32_t offsets[3], pair[3];
+	int i, axis;
+
+	offset_words(offset, offsets);
+
+	for (i = 0; i + 1 < count; i += 2, raw += 6, out += 6) {
+		memcpy(pair, raw, sizeof(pair));
+		pair[0] = __QSUB16(pair[0], offsets[0]);
+		pair[1] = __QSUB16(pair[1], offsets[1]);
+		pair[2] = __QSUB16(pair[2], offsets[2]);
+		memcpy(out, pair, sizeof(pair));
+	}
+
+	if (i < count)
+		for (axis = 0; axis < 3; axis++)
+			out[axis] = (int16_t)__SSAT(raw[axis] - offset[axis], 16);
+}
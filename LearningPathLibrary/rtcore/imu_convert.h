@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdint.h>
+
+/* Raw IMU triplets, X, Y and Z as the FIFO gives them, to scaled values in one pass over a block.
+   The calibration offset is taken off two axes at a time with the saturating dual 16 bit subtract,
+   two samples are three words, so the offset words repeat every iteration and no sample needs its
+   own setup. The float kernel then converts and scales on the FPU, the q15 kernel stops at the
+   offset, one q15 step being one LSB of the full scale, for kernels that stay in q15. */
+
+/* count triplets of raw, less offset, times scale into out, each triplet out_stride floats after the last */
+void imu_convert_float(const int16_t *raw, int count, const int16_t offset[3], float scale, float *out, int out_stride);
+/* count triplets of raw, less offset, into out packed */
+void imu_convert_q15(const int16_t *raw, int count, const int16_t offset[3], int16_t *out);
@@ -0,0 +1,271 @@
+#include "imu_dsp.h"
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+#include "mt3620.h"
+#include "memory_placement.h"
+
+/* one q15 step is one raw LSB at the full scales lsm6dso_init sets, +-4 g and +-2000 dps */
+#define ACCEL_FULL_SCALE_MG (32768 * 0.122f)
+#define GYRO_FULL_SCALE_DPS (32768 * 0.070f)
+#define BUTTERWORTH_Q 0.70710678f
+#define TWO_PI 6.28318531f
+#define DC_BLOCK_POLE 0.995f		/* ahead of the band filter, about 0.3 Hz at the FIFO rate */
+
+typedef struct {
+	uint8_t stages;
+	float full_scale;
+	/* low-pass, direct form II transposed */
+	float b0, b1, b2, a1, a2;
+	float z1, z2;
+	/* band, DC blocker then Goertzel, gravity would otherwise leak into the band */
+	float dc_x1, dc_y1;
+	bool dc_primed;
+	float coeff;
+	float s1, s2;
+	/* window, q15 sums */
+	int64_t sum_squares;
+	int32_t sum;
+	uint32_t samples;
+	imu_dsp_result result;
+} dsp_channel;
+
+static dsp_channel channels[IMU_DSP_CHANNELS];
+static float sample_rate;
+static bool dsp_open = false;
+static uint32_t cycles;
+static uint32_t cycle_samples;
+
+LP_RT_COLD int imu_dsp_init(float sample_rate_hz) {
+	int i;
+
+	if (sample_rate_hz <= 0)
+		return -1;
+
+	memset(channels, 0, sizeof(channels));
+	for (i = 0; i < IMU_DSP_CHANNELS; i++)
+		channels[i].full_scale = i < IMU_DSP_GYRO_X ? ACCEL_FULL_SCALE_MG : GYRO_FULL_SCALE_DPS;
+
+	sample_rate = sample_rate_hz;
+	cycles = 0;
+	cycle_samples = 0;
+
+	/* DWT cycle counter for the cycles per sample figure */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	dsp_open = true;
+
+	return 0;
+}
+
+/* Select the stages of a channel, cutoff_hz is used with IMU_DSP_LOWPASS and band_hz with IMU_DSP_BAND.
+   Both must be below half the sample rate. Restarts the channel */
+LP_RT_COLD int imu_dsp_configure(imu_dsp_channel channel, uint8_t stages, float cutoff_hz, float band_hz) {
+	dsp_channel *c;
+	float w0, alpha, cos_w0, a0;
+
+	if (!dsp_open || channel >= IMU_DSP_CHANNELS)
+		return -1;
+
+	if (((stages & IMU_DSP_LOWPASS) && (cutoff_hz <= 0 || cutoff_hz >= sample_rate / 2)) ||
+		((stages & IMU_DSP_BAND) && (band_hz <= 0 || band_hz >= sample_rate / 2)))
+		return -1;
+
+	c = &channels[channel];
+	c->stages = 0;
+
+	if (stages & IMU_DSP_LOWPASS) {
+		w0 = TWO_PI * cutoff_hz / sample_rate;
+		cos_w0 = cosf(w0);
+		alpha = sinf(w0) / (2 * BUTTERWORTH_Q);
+		a0 = 1 + alpha;
+
+		c->b0 = (1 - cos_w0) / 2 / a0;
+		c->b1 = (1 - cos_w0) / a0;
+		c->b2 = c->b0;
+		c->a1 = -2 * cos_w0 / a0;
+		c->a2 = (1 - alpha) / a0;
+	}
+
+	if (stages & IMU_DSP_BAND)
+		c->coeff = 2 * cosf(TWO_PI * band_hz / sample_rate);
+
+	c->z1 = c->z2 = 0;
+	c->dc_x1 = c->dc_y1 = 0;
+	c->dc_primed = false;
+	c->result.windows++;
+	c->s1 = c->s2 = 0;
+	c->sum_squares = 0;
+	c->sum = 0;
+	c->samples = 0;
+	memset(&c->result, 0, sizeof(c->result));
+	c->stages = stages;
+
+	return 0;
+}
+
+static float sample_value(const lsm6dso_sample *sample, int channel) {
+	return channel < IMU_DSP_GYRO_X ? sample->acceleration_mg[channel] : sample->angular_rate_dps[channel - IMU_DSP_GYRO_X];
+}
+
+static LP_RT_HOT void lowpass_block(dsp_channel *c, const float *x, int count) {
+	float y = c->result.filtered, z1 = c->z1, z2 = c->z2;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		y = c->b0 * x[i] + z1;
+		z1 = c->b1 * x[i] - c->a1 * y + z2;
+		z2 = c->b2 * x[i] - c->a2 * y;
+	}
+
+	c->z1 = z1;
+	c->z2 = z2;
+	c->result.filtered = y;
+}
+
+static LP_RT_HOT void band_block(dsp_channel *c, const float *x, int count) {
+	float s, s1 = c->s1, s2 = c->s2, y, x1, y1;
+	int i;
+
+	if (!c->dc_primed) {
+		c->dc_x1 = x[0];		/* start from the first sample rather than a step from zero */
+		c->dc_primed = true;
+	}
+	x1 = c->dc_x1;
+	y1 = c->dc_y1;
+
+	for (i = 0; i < count; i++) {
+		y = x[i] - x1 + DC_BLOCK_POLE * y1;
+		x1 = x[i];
+		y1 = y;
+
+		s = y + c->coeff * s1 - s2;
+		s2 = s1;
+		s1 = s;
+	}
+
+	c->dc_x1 = x1;
+	c->dc_y1 = y1;
+	c->s1 = s1;
+	c->s2 = s2;
+}
+
+/* sum and sum of squares of the block in q15, two samples per SMLAD and SMLALD */
+static LP_RT_HOT void rms_block(dsp_channel *c, const float *x, int count) {
+	int16_t q[IMU_DSP_BLOCK_MAX] __attribute__((aligned(4)));
+	float scale = 32768 / c->full_scale;
+	uint64_t sum_squares = (uint64_t)c->sum_squares;
+	uint32_t sum = (uint32_t)c->sum, pair;
+	int i;
+
+	for (i = 0; i < count; i++)
+		q[i] = (int16_t)__SSAT((int32_t)(x[i] * scale), 16);
+
+	for (i = 0; i + 1 < count; i += 2) {
+		memcpy(&pair, &q[i], sizeof(pair));
+		sum_squares = __SMLALD(pair, pair, sum_squares);
+		sum = __SMLAD(pair, 0x00010001, sum);
+	}
+
+	if (i < count) {
+		sum_squares += (int64_t)q[i] * q[i];
+		sum += (uint32_t)(int32_t)q[i];
+	}
+
+	c->sum_squares = (int64_t)sum_squares;
+	c->sum = (int32_t)sum;
+}
+
+static void close_window(dsp_channel *c) {
+	int64_t n = c->samples, spread;
+	float power;
+
+	if (c->stages & IMU_DSP_RMS) {
+		/* n squared times the variance, exact in integers so a large mean does not cancel a small RMS */
+		spread = n * c->sum_squares - (int64_t)c->sum * c->sum;
+		c->result.rms = sqrtf((float)(spread > 0 ? spread : 0)) / (float)n * c->full_scale / 32768;
+	}
+
+	if (c->stages & IMU_DSP_BAND) {
+		power = c->s1 * c->s1 + c->s2 * c->s2 - c->coeff * c->s1 * c->s2;
+		c->result.band_rms = sqrtf(fmaxf(2 * power, 0)) / (float)n;
+	}
+
+	c->result.windows++;
+	c->s1 = c->s2 = 0;
+	c->sum_squares = 0;
+	c->sum = 0;
+	c->samples = 0;
+}
+
+/* Run the configured stages over a block of up to IMU_DSP_BLOCK_MAX samples, a block that
+   crosses a window boundary is split so every window is IMU_DSP_WINDOW samples. Returns the
+   samples processed */
+LP_RT_HOT int imu_dsp_process(const lsm6dso_sample *samples, int count) {
+	float x[IMU_DSP_BLOCK_MAX];
+	uint32_t start = DWT->CYCCNT;
+	dsp_channel *c;
+	int channel, i, offset, segment;
+
+	if (!dsp_open || samples == NULL || count <= 0)
+		return -1;
+
+	if (count > IMU_DSP_BLOCK_MAX)
+		count = IMU_DSP_BLOCK_MAX;
+
+	for (channel = 0; channel < IMU_DSP_CHANNELS; channel++) {
+		c = &channels[channel];
+		if (c->stages == 0)
+			continue;
+
+		for (i = 0; i < count; i++)
+			x[i] = sample_value(&samples[i], channel);
+
+		if (c->stages & IMU_DSP_LOWPASS)
+			lowpass_block(c, x, count);
+
+		if (!(c->stages & (IMU_DSP_RMS | IMU_DSP_BAND)))
+			continue;
+
+		for (offset = 0; offset < count; offset += segment) {
+			segment = count - offset;
+			if (segment > IMU_DSP_WINDOW - (int)c->samples)
+				segment = IMU_DSP_WINDOW - (int)c->samples;
+
+			if (c->stages & IMU_DSP_BAND)
+				band_block(c, &x[offset], segment);
+			if (c->stages & IMU_DSP_RMS)
+				rms_block(c, &x[offset], segment);
+
+			c->samples += (uint32_t)segment;
+			if (c->samples >= IMU_DSP_WINDOW)
+				close_window(c);
+		}
+	}
+
+	cycles += DWT->CYCCNT - start;
+	cycle_samples += (uint32_t)count;
+
+	return count;
+}
+
+int imu_dsp_result_get(imu_dsp_channel channel, imu_dsp_result *result) {
+	if (!dsp_open || channel >= IMU_DSP_CHANNELS || result == NULL)
+		return -1;
+
+	*result = channels[channel].result;
+
+	return 0;
+}
+
+/* Cycles imu_dsp_process spent per IMU sample, all channels together, since the last call */
+uint32_t imu_dsp_cycles_per_sample(void) {
+	uint32_t per_sample = cycle_samples > 0 ? cycles / cycle_samples : 0;
+
+	cycles = 0;
+	cycle_samples = 0;
+
+	return per_sample;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+#include "lsm6dso_driver.h"
+
+/* Signal processing on IMU FIFO blocks, each axis is a channel with its own stages.
+   The low-pass runs in single precision on the FPU, RMS runs on q15 samples with the
+   dual 16 bit multiply-accumulates and band energy is a Goertzel filter on one frequency, which
+   costs far less than a full FFT when only one band is watched. */
+#define IMU_DSP_LOWPASS 0x1		/* 2nd order Butterworth IIR, result in filtered */
+#define IMU_DSP_RMS 0x2			/* RMS about the mean over each window */
+#define IMU_DSP_BAND 0x4		/* RMS of the band_hz component over each window */
+
+#define IMU_DSP_WINDOW 256		/* samples per RMS and band window, about 0.6 s at the FIFO rate */
+#define IMU_DSP_BLOCK_MAX 64	/* samples per imu_dsp_process call */
+
+typedef enum {
+	IMU_DSP_ACCEL_X,
+	IMU_DSP_ACCEL_Y,
+	IMU_DSP_ACCEL_Z,
+	IMU_DSP_GYRO_X,
+	IMU_DSP_GYRO_Y,
+	IMU_DSP_GYRO_Z,
+	IMU_DSP_CHANNELS
+} imu_dsp_channel;
+
+/* in the channel's units, mg or dps */
+typedef struct {
+	float filtered;			/* last low-pass output */
+	float rms;				/* last completed window */
+	float band_rms;
+	uint32_t windows;		/* completed, wrapping, a change says rms and band_rms are new */
+} imu_dsp_result;
+
+int imu_dsp_init(float sample_rate_hz);
+int imu_dsp_configure(imu_dsp_channel channel, uint8_t stages, float cutoff_hz, float band_hz);
+int imu_dsp_process(const lsm6dso_sample *samples, int count);
+int imu_dsp_result_get(imu_dsp_channel channel, imu_dsp_result *result);
+uint32_t imu_dsp_cycles_per_sample(void);
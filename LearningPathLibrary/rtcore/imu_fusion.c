@@ -0,0 +1,103 @@
+#include "imu_fusion.h"
+#include <math.h>
+#include "memory_placement.h"
+
+#define DEG_TO_RAD 0.0174532925f
+#define RAD_TO_DEG 57.2957795f
+
+LP_RT_COLD void imu_fusion_init(imu_fusion *f, float sample_rate_hz, float beta) {
+	f->q[0] = 1;
+	f->q[1] = 0;
+	f->q[2] = 0;
+	f->q[3] = 0;
+	f->beta = beta;
+	f->dt = 1 / sample_rate_hz;
+	f->aligned = false;
+}
+
+/* Start from the roll and pitch the accelerometer reads, the filter would take seconds to get there */
+static void imu_fusion_align(imu_fusion *f, float ax, float ay, float az) {
+	float roll = atan2f(ay, az);
+	float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+	float cr = cosf(roll / 2), sr = sinf(roll / 2);
+	float cp = cosf(pitch / 2), sp = sinf(pitch / 2);
+
+	f->q[0] = cr * cp;
+	f->q[1] = sr * cp;
+	f->q[2] = cr * sp;
+	f->q[3] = -sr * sp;
+	f->aligned = true;
+}
+
+/* One filter step, acceleration in any unit as only its direction is used */
+LP_RT_HOT void imu_fusion_update(imu_fusion *f, const float angular_rate_dps[3], const float acceleration[3]) {
+	float q0 = f->q[0], q1 = f->q[1], q2 = f->q[2], q3 = f->q[3];
+	float gx = angular_rate_dps[0] * DEG_TO_RAD;
+	float gy = angular_rate_dps[1] * DEG_TO_RAD;
+	float gz = angular_rate_dps[2] * DEG_TO_RAD;
+	float ax = acceleration[0], ay = acceleration[1], az = acceleration[2];
+	float norm, qd0, qd1, qd2, qd3, s0, s1, s2, s3;
+
+	norm = ax * ax + ay * ay + az * az;
+
+	if (!f->aligned && norm > 0) {
+		imu_fusion_align(f, ax, ay, az);
+		return;
+	}
+
+	/* rate of change from the gyro */
+	qd0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+	qd1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+	qd2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+	qd3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+	/* gradient step towards gravity, skipped in free fall */
+	if (norm > 0) {
+		norm = 1 / sqrtf(norm);
+		ax *= norm;
+		ay *= norm;
+		az *= norm;
+
+		s0 = 4 * q0 * q2 * q2 + 2 * q2 * ax + 4 * q0 * q1 * q1 - 2 * q1 * ay;
+		s1 = 4 * q1 * q3 * q3 - 2 * q3 * ax + 4 * q0 * q0 * q1 - 2 * q0 * ay - 4 * q1 +
+			8 * q1 * q1 * q1 + 8 * q1 * q2 * q2 + 4 * q1 * az;
+		s2 = 4 * q0 * q0 * q2 + 2 * q0 * ax + 4 * q2 * q3 * q3 - 2 * q3 * ay - 4 * q2 +
+			8 * q2 * q1 * q1 + 8 * q2 * q2 * q2 + 4 * q2 * az;
+		s3 = 4 * q1 * q1 * q3 - 2 * q1 * ax + 4 * q2 * q2 * q3 - 2 * q2 * ay;
+
+		norm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+		if (norm > 0) {
+			norm = f->beta / sqrtf(norm);
+			qd0 -= norm * s0;
+			qd1 -= norm * s1;
+			qd2 -= norm * s2;
+			qd3 -= norm * s3;
+		}
+	}
+
+	q0 += qd0 * f->dt;
+	q1 += qd1 * f->dt;
+	q2 += qd2 * f->dt;
+	q3 += qd3 * f->dt;
+
+	norm = 1 / sqrtf(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+	f->q[0] = q0 * norm;
+	f->q[1] = q1 * norm;
+	f->q[2] = q2 * norm;
+	f->q[3] = q3 * norm;
+}
+
+/* Roll about X, pitch about Y and yaw about Z, applied yaw first */
+void imu_fusion_euler(const imu_fusion *f, float *roll_deg, float *pitch_deg, float *yaw_deg) {
+	float q0 = f->q[0], q1 = f->q[1], q2 = f->q[2], q3 = f->q[3];
+	float sin_pitch = 2 * (q0 * q2 - q3 * q1);
+
+	if (sin_pitch > 1)
+		sin_pitch = 1;
+	else if (sin_pitch < -1)
+		sin_pitch = -1;
+
+	*roll_deg = atan2f(2 * (q0 * q1 + q2 * q3), 1 - 2 * (q1 * q1 + q2 * q2)) * RAD_TO_DEG;
+	*pitch_deg = asinf(sin_pitch) * RAD_TO_DEG;
+	*yaw_deg = atan2f(2 * (q0 * q3 + q1 * q2), 1 - 2 * (q2 * q2 + q3 * q3)) * RAD_TO_DEG;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdbool.h>
+
+/* Orientation from the accelerometer and gyro with Madgwick's gradient descent filter, updated
+   once per IMU sample. Yaw drifts without a magnetometer, roll and pitch are held by gravity. */
+#define IMU_FUSION_BETA 0.1f		/* accelerometer correction gain, higher converges faster but passes more vibration */
+
+typedef struct {
+	float q[4];				/* unit quaternion w, x, y, z, sensor frame to earth frame */
+	float beta;
+	float dt;				/* seconds per sample */
+	bool aligned;			/* set once the first sample has levelled the quaternion */
+} imu_fusion;
+
+void imu_fusion_init(imu_fusion *f, float sample_rate_hz, float beta);
+void imu_fusion_update(imu_fusion *f, const float angular_rate_dps[3], const float acceleration[3]);
+void imu_fusion_euler(const imu_fusion *f, float *roll_deg, float *pitch_deg, float *yaw_deg);
@@ -0,0 +1,453 @@
+#include "inter_core_link.h"
+#include "mt3620-intercore.h"
+#include "os_hal_mbox.h"
+#include "mt3620-baremetal.h"
+#include "rtos.h"
+#include "watchdog.h"
+#include <string.h>
+#include "memory_placement.h"
+
+#define LINK_SW_INT_MASK 0x3		/* software interrupts the A7 raises on mailbox channel 0 when it writes or reads the shared buffers */
+#define LINK_DATA_FLAG 0x1
+#define LINK_MESSAGE_FLAG 0x2		/* a record is queued */
+#define LINK_BUFFERS_FLAG 0x4		/* the mailbox published a set of shared buffers */
+#define LINK_LARGE_FLAG 0x8			/* a fragmented message is queued, or has more fragments to go */
+#define LINK_LARGE_BURST 4			/* fragment frames per pass, records queued meanwhile go between them */
+#define LINK_FIFO_IRQ 9				/* CM4_IRQ_A7N2M4_NE, mailbox channel 0 FIFO not empty */
+#define LINK_IDLE_WAIT_MS 1000		/* fallback poll should an interrupt be missed */
+#define LINK_LOW_WATERMARK_DIVISOR 4	/* congested once less than a quarter of the outbound ring is free */
+#define LINK_HIGH_WATERMARK_DIVISOR 2	/* and clear again when half of it is free */
+#define LINK_STREAM_RECORD_BYTES 32		/* a telemetry summary with its stamp, the longest record of a burst */
+#define LINK_CYCLES_PER_US 197			/* 197.6 MHz core clock, trace intervals read about 0.3% long */
+
+/* Cortex-M4 debug registers by address, mt3620.h clashes with the ThreadX types */
+#define LINK_DEMCR (*(volatile uint32_t *)0xE000EDFC)
+#define LINK_DEMCR_TRCENA (1UL << 24)
+#define LINK_DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define LINK_DWT_CTRL_CYCCNTENA (1UL << 0)
+#define LINK_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+
+static const size_t payload_start = 20;
+static uint8_t rx_buf[256];
+static uint8_t tx_buf[256];		/* component header of the A7 app, then staging for frames that wrap the ring */
+static BufferHeader *outbound, *inbound;	/* NULL until the buffers are published */
+static uint32_t shared_buf_size;
+static bool ready;				/* the A7 app has written, so its component header is known */
+
+/* written by the mailbox FIFO interrupt, taken by the link task with that interrupt disabled */
+static IntercoreNegotiation negotiation;
+static BufferHeader *offered_outbound, *offered_inbound;
+static uint32_t offered_size;
+static bool congestion_reported;
+
+static rtos_queue tx_queue;
+static RTOS_QUEUE_STORAGE(tx_queue_storage, sizeof(LP_INTER_CORE_BLOCK), INTER_CORE_LINK_QUEUE_LENGTH);
+/* records from inter_core_link_stream, encoded as they go on the wire */
+static rtos_stream burst_stream;
+static RTOS_STREAM_STORAGE(burst_stream_storage, LINK_STREAM_RECORD_BYTES, INTER_CORE_LINK_STREAM_LENGTH);
+static uint8_t streamed[LP_IC_MAX_FRAME_SIZE];	/* taken from burst_stream but not yet in a frame */
+static int streamed_length;
+static rtos_event link_event;
+static volatile uint32_t drops;
+
+static LP_INTER_CORE_BLOCK pending;	/* taken from tx_queue but did not fit the last frame */
+static bool has_pending;
+
+/* records queued before the A7 app has written, encoded as the frames they go out as, oldest first */
+static LP_RT_BULK uint8_t early_frames[INTER_CORE_LINK_EARLY_FRAMES][LP_IC_MAX_FRAME_SIZE];
+static uint8_t early_lengths[INTER_CORE_LINK_EARLY_FRAMES];
+static uint32_t early_first, early_count;
+static LP_IC_FRAME_WRITER early_writer;	/* the newest early frame */
+
+/* one fragmented message each way. The buffer out is taken with the token in large_free, filled, and handed
+   to the link task through large_queue, which returns the token once the last fragment is written */
+typedef struct {
+	LP_INTER_CORE_CMD cmd;
+	uint32_t length;
+} large_message;
+
+static LP_RT_BULK uint8_t large_out[INTER_CORE_LINK_MAX_MESSAGE_SIZE];
+static LP_RT_BULK uint8_t large_in[INTER_CORE_LINK_MAX_MESSAGE_SIZE];
+static rtos_queue large_free, large_queue;
+static RTOS_QUEUE_STORAGE(large_free_storage, sizeof(int), 1);
+static RTOS_QUEUE_STORAGE(large_queue_storage, sizeof(large_message), 1);
+static LP_IC_FRAGMENTER fragmenter;
+static bool large_sending;
+static uint8_t large_number;	/* of the last message fragmented */
+static LP_IC_REASSEMBLY reassembly;
+static inter_core_link_large_handler large_handler;
+
+LP_RT_COLD int inter_core_link_init(void) {
+	/* the cycle counter behind the trace stamps, left running if the profiler or the IMU DSP started it */
+	LINK_DEMCR |= LINK_DEMCR_TRCENA;
+	LINK_DWT_CTRL |= LINK_DWT_CTRL_CYCCNTENA;
+
+	int token = 0;
+
+	if (rtos_queue_create(&tx_queue, "inter core tx", sizeof(LP_INTER_CORE_BLOCK), INTER_CORE_LINK_QUEUE_LENGTH, tx_queue_storage) != 0 ||
+		rtos_stream_create(&burst_stream, "inter core burst", sizeof(burst_stream_storage), burst_stream_storage) != 0 ||
+		rtos_queue_create(&large_free, "inter core large", sizeof(int), 1, large_free_storage) != 0 ||
+		rtos_queue_create(&large_queue, "inter core large tx", sizeof(large_message), 1, large_queue_storage) != 0 ||
+		rtos_queue_send(&large_free, &token) != 0)
+		return -1;
+
+	lp_icReassemblyInit(&reassembly, large_in, sizeof(large_in));
+	return rtos_event_create(&link_event, "inter core");
+}
+
+void inter_core_link_send(const LP_INTER_CORE_BLOCK *block) {
+	if (rtos_queue_send(&tx_queue, block) != 0) {
+		drops++;
+		return;
+	}
+	rtos_event_set(&link_event, LINK_MESSAGE_FLAG);
+}
+
+/* encoded here, so the link task copies the record's bytes into the frame rather than its fields */
+void inter_core_link_stream(const LP_INTER_CORE_BLOCK *block) {
+	uint8_t frame[LP_IC_MAX_FRAME_SIZE];
+	LP_IC_FRAME_WRITER writer;
+	uint32_t length;
+
+	if (block->traced) {
+		inter_core_link_send(block);	/* the interval is taken as the frame is written */
+		return;
+	}
+
+	lp_icFrameBegin(&writer, frame, sizeof(frame));
+	if (!lp_icFrameAppend(&writer, block)) {
+		drops++;
+		return;
+	}
+	length = (uint32_t)(lp_icFrameEnd(&writer) - LP_IC_FRAME_HEADER_SIZE);
+
+	if (rtos_stream_send(&burst_stream, frame + LP_IC_FRAME_HEADER_SIZE, length) == 0)
+		return;
+
+	inter_core_link_flush();	/* the link task runs ahead of the sender and drains the stream before this returns */
+	if (rtos_stream_send(&burst_stream, frame + LP_IC_FRAME_HEADER_SIZE, length) != 0)
+		drops++;
+}
+
+void inter_core_link_flush(void) {
+	rtos_event_set(&link_event, LINK_MESSAGE_FLAG);
+}
+
+uint32_t inter_core_link_drops(void) {
+	return drops;
+}
+
+int inter_core_link_send_large(LP_INTER_CORE_CMD cmd, const void *payload, uint32_t length) {
+	large_message message = { .cmd = cmd, .length = length };
+	int token;
+
+	if (length > sizeof(large_out) || (payload == NULL && length > 0) || rtos_queue_receive(&large_free, &token, RTOS_NO_WAIT) != 0)
+		return -1;
+
+	memcpy(large_out, payload, length);
+	rtos_queue_send(&large_queue, &message);	/* cannot be full, it holds the one message the token allows */
+	rtos_event_set(&link_event, LINK_LARGE_FLAG);
+
+	return 0;
+}
+
+void inter_core_link_set_large_handler(inter_core_link_large_handler handler) {
+	large_handler = handler;
+}
+
+uint32_t inter_core_link_large_lost(void) {
+	return reassembly.lost;
+}
+
+uint32_t inter_core_link_trace_stamp(void) {
+	return LINK_DWT_CYCCNT;
+}
+
+uint32_t inter_core_link_trace_us(uint32_t stamp) {
+	return (LINK_DWT_CYCCNT - stamp) / LINK_CYCLES_PER_US;
+}
+
+/* a traced record is queued with the cycle count at its sample, written with the interval since */
+static bool append_record(LP_IC_FRAME_WRITER *writer, const LP_INTER_CORE_BLOCK *block) {
+	LP_INTER_CORE_BLOCK stamped;
+
+	if (!block->traced)
+		return lp_icFrameAppend(writer, block);
+
+	stamped = *block;
+	stamped.traceSampleUs = inter_core_link_trace_us(block->traceSampleUs);
+	return lp_icFrameAppend(writer, &stamped);
+}
+
+static bool next_queued(LP_INTER_CORE_BLOCK *block) {
+	if (has_pending) {
+		*block = pending;
+		has_pending = false;
+		return true;
+	}
+	return rtos_queue_receive(&tx_queue, block, RTOS_NO_WAIT) == 0;
+}
+
+static bool next_streamed(void) {
+	if (streamed_length == 0)
+		streamed_length = rtos_stream_receive(&burst_stream, streamed, sizeof(streamed));
+	return streamed_length > 0;		/* a record never outgrows streamed, it was encoded to fit a frame */
+}
+
+/* streamed records as fit after the queued ones, the one that does not waits for the next frame */
+static void append_streamed(LP_IC_FRAME_WRITER *writer) {
+	while (next_streamed() && lp_icFrameAppendEncoded(writer, streamed, (size_t)streamed_length))
+		streamed_length = 0;
+}
+
+/* first and whatever else is queued or streamed as one frame, one ring write and one mailbox kick, in place
+   when the frame fits without wrapping. first is NULL when only streamed records are waiting */
+static int write_frame(const LP_INTER_CORE_BLOCK *first) {
+	LP_IC_FRAME_WRITER writer;
+	uint8_t *frame = ReserveData(inbound, outbound, shared_buf_size, payload_start + LP_IC_MAX_FRAME_SIZE);
+	bool in_place = frame != NULL;
+	uint32_t frame_size;
+
+	if (in_place)
+		memcpy(frame, tx_buf, payload_start);	/* the component header is written once, straight into the ring */
+	else
+		frame = tx_buf;		/* the frame would wrap around the end of the shared buffer, stage it for EnqueueData */
+
+	lp_icFrameBegin(&writer, frame + payload_start, LP_IC_MAX_FRAME_SIZE);
+	if (first != NULL)
+		append_record(&writer, first);
+
+	while (next_queued(&pending)) {
+		if (!append_record(&writer, &pending)) {
+			has_pending = true;		/* the frame is full, it starts the next one */
+			break;
+		}
+	}
+	if (!has_pending)
+		append_streamed(&writer);
+
+	frame_size = payload_start + lp_icFrameEnd(&writer);
+
+	return in_place
+		? CommitData(outbound, shared_buf_size, frame_size)
+		: EnqueueData(inbound, outbound, shared_buf_size, tx_buf, frame_size);
+}
+
+/* until the A7 app has written, a full stash makes room by dropping its oldest frame, the latest readings
+   are the ones worth sending. A traced record's interval ends when it was stashed */
+static void stash_frame(void) {
+	uint32_t slot;
+
+	if (early_count == INTER_CORE_LINK_EARLY_FRAMES) {
+		drops += early_frames[early_first][1];
+		early_first = (early_first + 1) % INTER_CORE_LINK_EARLY_FRAMES;
+		early_count--;
+	}
+	slot = (early_first + early_count++) % INTER_CORE_LINK_EARLY_FRAMES;
+	lp_icFrameBegin(&early_writer, early_frames[slot], LP_IC_MAX_FRAME_SIZE);
+}
+
+static void stash_queued(void) {
+	LP_INTER_CORE_BLOCK block;
+
+	while (next_queued(&block)) {
+		if (early_count == 0 || !append_record(&early_writer, &block)) {
+			stash_frame();
+			append_record(&early_writer, &block);
+		}
+		early_lengths[(early_first + early_count - 1) % INTER_CORE_LINK_EARLY_FRAMES] = (uint8_t)lp_icFrameEnd(&early_writer);
+	}
+
+	while (next_streamed()) {
+		if (early_count == 0 || !lp_icFrameAppendEncoded(&early_writer, streamed, (size_t)streamed_length)) {
+			stash_frame();
+			lp_icFrameAppendEncoded(&early_writer, streamed, (size_t)streamed_length);
+		}
+		streamed_length = 0;
+		early_lengths[(early_first + early_count - 1) % INTER_CORE_LINK_EARLY_FRAMES] = (uint8_t)lp_icFrameEnd(&early_writer);
+	}
+}
+
+/* the stash in order behind the component header, once the A7 app has written */
+static void send_stashed(void) {
+	uint32_t slot;
+
+	stash_queued();
+
+	for (; early_count > 0; early_count--) {
+		slot = early_first;
+		early_first = (early_first + 1) % INTER_CORE_LINK_EARLY_FRAMES;
+
+		memcpy(tx_buf + payload_start, early_frames[slot], early_lengths[slot]);
+		if (EnqueueData(inbound, outbound, shared_buf_size, tx_buf, payload_start + early_lengths[slot]) != 0)
+			drops += early_frames[slot][1];
+	}
+	early_first = 0;
+}
+
+/* after each frame and when the A7 app signals it has read from the ring */
+static void update_flow_control(void) {
+	uint32_t free_space = GetFreeSpace(inbound, outbound, shared_buf_size);
+	bool congested = congestion_reported
+		? free_space < shared_buf_size / LINK_HIGH_WATERMARK_DIVISOR
+		: free_space < shared_buf_size / LINK_LOW_WATERMARK_DIVISOR;
+
+	if (congested != congestion_reported) {
+		LP_INTER_CORE_BLOCK flow_control = { .cmd = LP_IC_FLOW_CONTROL, .congested = congested };
+
+		/* retried after the next frame or interrupt if the ring has no room for it now */
+		if (write_frame(&flow_control) == 0)
+			congestion_reported = congested;
+	}
+}
+
+static void send_queued(void) {
+	LP_INTER_CORE_BLOCK block;
+
+	while (next_queued(&block)) {
+		write_frame(&block);	/* dropped when the ring is full, the A7 app is already throttled by then */
+		update_flow_control();
+	}
+
+	while (next_streamed()) {
+		write_frame(NULL);
+		update_flow_control();
+	}
+}
+
+/* fragments of the message going out, a few frames at a time so queued records are not held up behind it. A
+   full ring leaves the rest for the mailbox interrupt of the A7 app reading, the message streams through it */
+static void send_large(void) {
+	LP_IC_FRAME_WRITER writer;
+	LP_IC_FRAGMENTER resume;
+	large_message message;
+	uint32_t frames;
+	int token = 0;
+
+	if (!large_sending && rtos_queue_receive(&large_queue, &message, RTOS_NO_WAIT) == 0) {
+		lp_icFragmentBegin(&fragmenter, ++large_number, message.cmd, large_out, message.length);
+		large_sending = true;
+	}
+
+	for (frames = 0; large_sending && frames < LINK_LARGE_BURST; frames++) {
+		resume = fragmenter;
+		lp_icFrameBegin(&writer, tx_buf + payload_start, LP_IC_MAX_FRAME_SIZE);
+		while (lp_icFrameAppendFragment(&writer, &fragmenter))
+			;
+
+		if (EnqueueData(inbound, outbound, shared_buf_size, tx_buf, payload_start + lp_icFrameEnd(&writer)) != 0) {
+			fragmenter = resume;
+			return;
+		}
+		update_flow_control();
+
+		if (lp_icFragmentDone(&fragmenter)) {
+			large_sending = false;
+			rtos_queue_send(&large_free, &token);
+		}
+	}
+
+	if (large_sending)
+		rtos_event_set(&link_event, LINK_LARGE_FLAG);	/* comes round again after the records queued meanwhile */
+}
+
+/* switch to the buffers last published, after start up or once the A7 app has restarted */
+static void adopt_buffers(void) {
+	DisableNvicInterrupt(LINK_FIFO_IRQ);
+	outbound = offered_outbound;
+	inbound = offered_inbound;
+	shared_buf_size = offered_size;
+	EnableNvicInterrupt(LINK_FIFO_IRQ);
+
+	ready = false;		/* the component header is taken again from the first frame */
+	congestion_reported = false;
+	if (large_sending)		/* the new A7 app gets the whole message */
+		lp_icFragmentBegin(&fragmenter, fragmenter.message, (LP_INTER_CORE_CMD)fragmenter.cmd, large_out, fragmenter.length);
+	lp_icReassemblyAbandon(&reassembly);
+}
+
+static LP_RT_HOT void mailbox_interrupt(struct mtk_os_hal_mbox_cb_data *data) {
+	if (data->swint.swint_sts & LINK_SW_INT_MASK)
+		rtos_event_set_isr(&link_event, LINK_DATA_FLAG);
+}
+
+/* the A7 side writes the buffer addresses into the mailbox FIFO, taken here as they arrive rather than
+   by spinning on the FIFO count */
+static LP_RT_HOT void mailbox_fifo_interrupt(struct mtk_os_hal_mbox_cb_data *data) {
+	if (!data->event.ne_sts)
+		return;
+
+	if (PollIntercoreBuffers(&negotiation, &offered_outbound, &offered_inbound, &offered_size) == 1)
+		rtos_event_set_isr(&link_event, LINK_BUFFERS_FLAG);
+
+	/* the OS HAL masks the level triggered interrupt, the FIFO is drained or holds another set */
+	EnableNvicInterrupt(LINK_FIFO_IRQ);
+}
+
+void inter_core_link_run(inter_core_link_handler handler, int watchdog_slot) {
+	struct mbox_fifo_event fifo_mask = { .ne_sts = 1 };
+	LP_IC_FRAME_READER reader;
+	LP_INTER_CORE_BLOCK received;
+	LP_INTER_CORE_BLOCK heartbeat = { .cmd = LP_IC_HEARTBEAT };
+	uint32_t data_size, flags;
+	bool handshake;
+	int r;
+
+	/* woken from the mailbox interrupts rather than polling the mailbox or the shared buffer */
+	mtk_os_hal_mbox_open_channel(OS_HAL_MBOX_CH0);
+	mtk_os_hal_mbox_sw_int_register_cb(OS_HAL_MBOX_CH0, mailbox_interrupt, LINK_SW_INT_MASK);
+	mtk_os_hal_mbox_fifo_register_cb(OS_HAL_MBOX_CH0, mailbox_fifo_interrupt, &fifo_mask);
+
+	while (1) {
+		watchdog_check_in(watchdog_slot);
+
+		if (ready) {
+			send_queued();
+			send_large();
+		} else {
+			stash_queued();
+		}
+
+		r = -1;
+		if (outbound != NULL) {
+			data_size = sizeof(rx_buf);
+			r = DequeueData(outbound, inbound, shared_buf_size, rx_buf, &data_size);
+		}
+
+		if (r == 0 && data_size > payload_start) {
+			if (!ready) {
+				memcpy(tx_buf, rx_buf, payload_start);	/* component header echoed in every outbound frame */
+				ready = true;
+				send_stashed();
+			}
+
+			/* each frame may carry several records */
+			handshake = false;
+			lp_icFrameOpen(&reader, &rx_buf[payload_start], data_size - payload_start);
+			while (lp_icFrameNext(&reader, &received)) {
+				handshake |= received.cmd == LP_IC_HEARTBEAT && received.sequence == 0;
+				if (received.cmd != LP_IC_FRAGMENT)
+					handler(&received);
+				else if (lp_icReassemble(&reassembly, &received) && large_handler != NULL)
+					large_handler((LP_INTER_CORE_CMD)reassembly.cmd, reassembly.buffer, reassembly.total);
+			}
+
+			/* the A7 app repeats its handshake heartbeat until one comes back, whatever it is answered with */
+			if (handshake) {
+				write_frame(&heartbeat);
+				update_flow_control();
+			}
+		}
+
+		if (r != 0) {
+			/* ring drained, block until the A7 app raises the mailbox interrupt or a record is queued. Until
+			   the A7 app has written, queued records are stashed for it */
+			flags = rtos_event_wait(&link_event, LINK_DATA_FLAG | LINK_MESSAGE_FLAG | LINK_BUFFERS_FLAG | LINK_LARGE_FLAG, LINK_IDLE_WAIT_MS);
+
+			if (flags & LINK_BUFFERS_FLAG)
+				adopt_buffers();
+			else if (ready)
+				update_flow_control();		/* the interrupt may be the A7 app reading from the ring, space freed */
+		}
+	}
+}
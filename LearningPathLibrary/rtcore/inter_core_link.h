@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include "inter_core_protocol.h"
+
+/* The link to the A7 app over the shared buffers. One task runs inter_core_link_run and is the only
+   reader and writer of both rings: it wakes on the mailbox interrupt the A7 app raises and on records the
+   other tasks queue with inter_core_link_send, and writes as many queued records as fit into each frame.
+   Outbound free space is watched against two watermarks, crossing one sends an LP_IC_FLOW_CONTROL so the
+   A7 app throttles its requests. The shared buffers are taken from the mailbox interrupt whenever they are
+   published, so the other tasks keep running while the A7 side starts or restarts.
+
+   Until the A7 app first writes, the frame that carries its component header, queued records are encoded
+   into a stash of INTER_CORE_LINK_EARLY_FRAMES frames, the oldest dropped and counted once it is full. The
+   A7 library writes a heartbeat as soon as it is enabled and repeats it until a heartbeat comes back, the
+   link answers each one and sends the stash in order ahead of anything queued later, so readings flow from
+   the moment both sides are up rather than from the A7 app's first request. */
+#define INTER_CORE_LINK_QUEUE_LENGTH 16
+#define INTER_CORE_LINK_STREAM_LENGTH 32	/* telemetry summaries a burst of inter_core_link_stream holds, shorter records more */
+#define INTER_CORE_LINK_EARLY_FRAMES 8	/* SYSRAM, a frame each */
+#define INTER_CORE_LINK_MAX_MESSAGE_SIZE 2048	/* fragmented messages each way, SYSRAM */
+
+/* Runs in the link task for each record the A7 app sent */
+typedef void (*inter_core_link_handler)(const LP_INTER_CORE_BLOCK *block);
+
+/* Runs in the link task for each fragmented message once all of it has arrived, payload is valid for the call */
+typedef void (*inter_core_link_large_handler)(LP_INTER_CORE_CMD cmd, const uint8_t *payload, uint32_t length);
+
+/* Before the scheduler starts */
+int inter_core_link_init(void);
+
+/* From any task, never blocks, dropped and counted when the queue is full */
+void inter_core_link_send(const LP_INTER_CORE_BLOCK *block);
+uint32_t inter_core_link_drops(void);
+
+/* For the one task that sends records in bursts, the IMU aggregation a block at a time. Each record is encoded
+   as it goes on the wire and copied into a message buffer only that task writes, without a lock, and the link task is woken once by
+   inter_core_link_flush at the end of the burst, so they go out together in as few frames as they fit rather
+   than a frame each as the higher priority link task preempts every send. A full stream is flushed and the
+   record written again, it is dropped and counted only when the link task could not make room. A traced record
+   goes through inter_core_link_send, its interval ends as the frame is written */
+void inter_core_link_stream(const LP_INTER_CORE_BLOCK *block);
+void inter_core_link_flush(void);
+
+/* A message larger than a frame, up to INTER_CORE_LINK_MAX_MESSAGE_SIZE, as LP_IC_FRAGMENT records. From any task,
+   never blocks: the payload is copied and streamed through the ring as it has room, between the queued records.
+   -1 while the previous message is still going out, or when it is too long */
+int inter_core_link_send_large(LP_INTER_CORE_CMD cmd, const void *payload, uint32_t length);
+void inter_core_link_set_large_handler(inter_core_link_large_handler handler);	/* before the link task runs */
+uint32_t inter_core_link_large_lost(void);		/* messages from the A7 app abandoned in reassembly */
+
+/* Latency trace stamps, cycle counts. A record queued with traced set and traceSampleUs holding the stamp
+   taken at its sample goes out with traceSampleUs the microseconds from the sample to the frame write */
+uint32_t inter_core_link_trace_stamp(void);
+uint32_t inter_core_link_trace_us(uint32_t stamp);	/* since stamp, intervals up to about 21 s */
+
+/* The body of the link task, does not return. Checks in on watchdog_slot each time round, -1 for none */
+void inter_core_link_run(inter_core_link_handler handler, int watchdog_slot);
@@ -0,0 +1,87 @@
+#include "led_pwm.h"
+#include "printf.h"
+
+#define LED_PWM_FREQUENCY 1000			/* Hz, flicker free and one stay cycle per millisecond */
+#define LED_PWM_DUTY_MAX 1000			/* duty cycles are per mille */
+#define LED_PWM_CHANNEL_BITS (OS_HAL_PWM_0 | OS_HAL_PWM_1 | OS_HAL_PWM_2)
+
+static const pwm_channels led_channels[] = { PWM_CHANNEL0, PWM_CHANNEL1, PWM_CHANNEL2 };	/* red, green, blue */
+static pwm_groups led_group;
+static bool led_open = false;
+
+static u32 stay_cycles(uint16_t ms) {
+	u32 cycles = (u32)ms * LED_PWM_FREQUENCY / 1000;
+
+	if (cycles < 1)
+		return 1;
+	return cycles > LED_PWM_BLINK_MAX_MS ? LED_PWM_BLINK_MAX_MS : cycles;
+}
+
+int led_pwm_open(pwm_groups group) {
+	int i;
+
+	if (led_open)
+		return -1;
+
+	if (mtk_os_hal_pwm_ctlr_init(group, LED_PWM_CHANNEL_BITS) != 0) {
+		printf("pwm group[%d] init fail\n", group);
+		return -1;
+	}
+
+	led_group = group;
+	led_open = true;
+
+	/* the LEDs are active low, inverted outputs make the duty cycle the brightness */
+	for (i = 0; i < 3; i++)
+		mtk_os_hal_pwm_feature_enable(led_group, led_channels[i], false, false, true);
+
+	return led_pwm_set(0, 0, 0);
+}
+
+void led_pwm_close(void) {
+	int i;
+
+	if (!led_open)
+		return;
+
+	for (i = 0; i < 3; i++)
+		mtk_os_hal_pwm_stop_normal(led_group, led_channels[i]);
+
+	mtk_os_hal_pwm_ctlr_deinit(led_group, LED_PWM_CHANNEL_BITS);
+	led_open = false;
+}
+
+/* colour is 0xRRGGBB, shown for on_ms then dark for off_ms. An off_ms of zero holds the colour
+   steady, an on_ms of zero turns the LED off. Steady colours use identical states so every
+   pattern runs in the same mode. */
+int led_pwm_set(uint32_t colour, uint16_t on_ms, uint16_t off_ms) {
+	struct mtk_com_pwm_data state = { 0 };
+	int i;
+
+	if (!led_open)
+		return -1;
+
+	state.frequency = LED_PWM_FREQUENCY;
+	state.replay_mode = 1;
+	state.s0_stay_cycle = stay_cycles(on_ms);
+	state.s1_stay_cycle = stay_cycles(off_ms);
+
+	for (i = 0; i < 3; i++) {
+		u32 duty = on_ms == 0 ? 0 : ((colour >> (16 - 8 * i)) & 0xFF) * LED_PWM_DUTY_MAX / 0xFF;
+
+		state.stage = PWM_STAGE_S0;
+		state.duty_cycle = duty;
+		if (mtk_os_hal_pwm_config_freq_duty_2_state(led_group, led_channels[i], state) != 0)
+			return -1;
+
+		state.stage = PWM_STAGE_S1;
+		state.duty_cycle = off_ms == 0 ? duty : 0;
+		if (mtk_os_hal_pwm_config_freq_duty_2_state(led_group, led_channels[i], state) != 0)
+			return -1;
+
+		if (mtk_os_hal_pwm_config_stay_cycle_2_state(led_group, led_channels[i], state) != 0)
+			return -1;
+	}
+
+	return 0;
+}
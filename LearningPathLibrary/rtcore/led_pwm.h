@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdint.h>
+#include "os_hal_pwm.h"
+
+/* RGB LED on channels 0, 1 and 2 of one PWM group. Colour mixing and blinking run in the PWM
+   block's two state mode, so nothing on the core wakes per blink. */
+#define LED_PWM_BLINK_MAX_MS 4095	/* 12 bit stay counters at one PWM period per millisecond */
+
+int led_pwm_open(pwm_groups group);
+void led_pwm_close(void);
+int led_pwm_set(uint32_t colour, uint16_t on_ms, uint16_t off_ms);
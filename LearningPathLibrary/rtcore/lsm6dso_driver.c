@@ -33,6 +33,8 @@
  * MEDIATEK SOFTWARE AT ISSUE.
  */
 
+#include <stdbool.h>
+
 #include "printf.h"
 #include "mt3620.h"
 
@@ -41,9 +43,12 @@
 
 #include "lsm6dso_driver.h"
 #include "lsm6dso_reg.h"
+#include "i2c.h"
+#include "imu_convert.h"
 
 static int lsm6dso_handle;
 static lsm6dso_ctx_t dev_ctx;
+static lsm6dso_shadow_t dev_shadow;		/* configuration registers, setters cost one I2C write each */
 static axis3bit16_t data_raw_acceleration;
 static axis3bit16_t data_raw_angular_rate;
 static axis3bit16_t raw_angular_rate_calibration;
@@ -52,6 +57,22 @@ static float acceleration_mg[3];
 static float angular_rate_dps[3];
 static float lsm6dsoTemperature_degC;
 
+/* FIFO words per I2C read, the register address wraps from FIFO_DATA_OUT_Z_H back to
+   FIFO_DATA_OUT_TAG so consecutive words come out of one burst */
+#define LSM6DSO_FIFO_BURST_WORDS (I2C_BURST_MAX_LEN / LSM6DSO_FIFO_WORD_SIZE)
+#define LSM6DSO_FIFO_HAS_XL 0x1
+#define LSM6DSO_FIFO_HAS_GY 0x2
+#define LSM6DSO_DECODE_CHUNK 16		/* samples paired before each block conversion */
+#define LSM6DSO_XL_MG_PER_LSB 0.122f		/* +-4 g */
+#define LSM6DSO_GY_DPS_PER_LSB 0.070f		/* +-2000 dps */
+#define LSM6DSO_SAMPLE_STRIDE (int)(sizeof(lsm6dso_sample) / sizeof(float))
+
+static bool fifo_enabled = false;
+static int16_t fifo_pending_xl[3], fifo_pending_gy[3];		/* sample being assembled from its accelerometer and gyro words */
+static uint8_t fifo_pending_mask = 0;
+static uint8_t fifo_sample_mask = LSM6DSO_FIFO_HAS_XL | LSM6DSO_FIFO_HAS_GY;	/* words that complete a sample */
+static const int16_t accel_offset[3] = { 0, 0, 0 };
+
 
 /******************************************************************************/
 /* Functions */
@@ -127,10 +148,181 @@ void update_temperature(void)
 }
 
 float get_temperature(void) {
-	update_temperature();
+	/* with the FIFO running the temperature is batched too, so no bus access here */
+	if (!fifo_enabled)
+		update_temperature();
 	return lsm6dsoTemperature_degC;
 }
 
+/* Pair one FIFO word into raw triplets, returns 1 when it completed a sample in xl and gy */
+static int lsm6dso_fifo_pair_word(const uint8_t *word, int16_t *xl, int16_t *gy)
+{
+	int16_t raw[3];
+
+	memcpy(raw, &word[1], sizeof(raw));
+
+	switch ((lsm6dso_fifo_tag_t)(word[0] >> 3)) {
+	case LSM6DSO_XL_NC_TAG:
+		memcpy(fifo_pending_xl, raw, sizeof(raw));
+		fifo_pending_mask |= LSM6DSO_FIFO_HAS_XL;
+		break;
+	case LSM6DSO_GYRO_NC_TAG:
+		memcpy(fifo_pending_gy, raw, sizeof(raw));
+		fifo_pending_mask |= LSM6DSO_FIFO_HAS_GY;
+		break;
+	case LSM6DSO_TEMPERATURE_TAG:
+		lsm6dsoTemperature_degC = lsm6dso_from_lsb_to_celsius(raw[0]);
+		break;
+	default:
+		break;
+	}
+
+	if (fifo_pending_mask != fifo_sample_mask)
+		return 0;
+
+	memcpy(xl, fifo_pending_xl, sizeof(fifo_pending_xl));
+	memcpy(gy, fifo_pending_gy, sizeof(fifo_pending_gy));
+	fifo_pending_mask = 0;
+	return 1;
+}
+
+/* Output data rates the FIFO batches at, the setting for each is its index plus one in the ODR and BATCHED_AT enums */
+static const uint16_t fifo_rates_hz[] = { 12, 26, 52, 104, 208, 417, 833 };	/* 12 is 12.5 Hz */
+
+/* The supported rate nearest odr_hz, zero for zero */
+uint16_t lsm6dso_fifo_rate(uint16_t odr_hz)
+{
+	unsigned i;
+
+	if (odr_hz == 0)
+		return 0;
+
+	for (i = 0; i + 1 < sizeof(fifo_rates_hz) / sizeof(fifo_rates_hz[0]); i++) {
+		if (odr_hz < (fifo_rates_hz[i] + fifo_rates_hz[i + 1]) / 2)
+			break;
+	}
+	return fifo_rates_hz[i];
+}
+
+/* Batch the accelerometer, and the gyro when asked, at the supported rate nearest odr_hz and raise INT1 once
+   watermark words are queued. A rate of zero powers both down with the FIFO bypassed. Without the gyro a
+   sample is one word and its angular rate reads zero. May be called again to change the rate */
+int lsm6dso_fifo_init(uint16_t odr_hz, uint16_t watermark, int gyro)
+{
+	lsm6dso_pin_int1_route_t int1_route;
+	uint16_t rate = lsm6dso_fifo_rate(odr_hz);
+	uint8_t setting = 0;		/* ODR_OFF and NOT_BATCHED */
+
+	fifo_enabled = false;
+	fifo_pending_mask = 0;
+
+	while (rate != 0 && fifo_rates_hz[setting++] != rate)
+		;
+	gyro = gyro && rate != 0;
+
+	/* without the gyro words every sample takes the calibration as its raw reading, which converts to zero */
+	fifo_sample_mask = gyro ? (LSM6DSO_FIFO_HAS_XL | LSM6DSO_FIFO_HAS_GY) : LSM6DSO_FIFO_HAS_XL;
+	memcpy(fifo_pending_gy, raw_angular_rate_calibration.i16bit, sizeof(fifo_pending_gy));
+
+	if (lsm6dso_fifo_mode_set(&dev_ctx, LSM6DSO_BYPASS_MODE) != 0)		/* empties the FIFO */
+		return -1;
+
+	/* the setters between here and lsm6dso_shadow_apply change the copy, then go out as a burst per run of registers */
+	lsm6dso_shadow_defer(&dev_ctx);
+
+	lsm6dso_xl_data_rate_set(&dev_ctx, (lsm6dso_odr_xl_t)setting);
+	lsm6dso_gy_data_rate_set(&dev_ctx, gyro ? (lsm6dso_odr_g_t)setting : LSM6DSO_GY_ODR_OFF);
+
+	/* LPF2 at ODR/100 would filter out the vibration, keep the LPF1 bandwidth of ODR/2 */
+	lsm6dso_xl_filter_lp2_set(&dev_ctx, PROPERTY_DISABLE);
+
+	lsm6dso_fifo_watermark_set(&dev_ctx, watermark);
+	lsm6dso_fifo_xl_batch_set(&dev_ctx, (lsm6dso_bdr_xl_t)setting);
+	lsm6dso_fifo_gy_batch_set(&dev_ctx, gyro ? (lsm6dso_bdr_gy_t)setting : LSM6DSO_GY_NOT_BATCHED);
+	lsm6dso_fifo_temp_batch_set(&dev_ctx, rate != 0 ? LSM6DSO_TEMP_BATCHED_AT_12Hz5 : LSM6DSO_TEMP_NOT_BATCHED);
+
+	lsm6dso_pin_int1_route_get(&dev_ctx, &int1_route);
+	int1_route.int1_ctrl.int1_fifo_th = rate != 0 ? PROPERTY_ENABLE : PROPERTY_DISABLE;
+	lsm6dso_pin_int1_route_set(&dev_ctx, &int1_route);
+
+	if (lsm6dso_shadow_apply(&dev_ctx) != 0)
+		return -1;
+
+	if (rate == 0)
+		return 0;
+
+	if (lsm6dso_fifo_mode_set(&dev_ctx, LSM6DSO_STREAM_MODE) != 0)
+		return -1;
+
+	fifo_enabled = true;
+	return 0;
+}
+
+/* Unread FIFO words, FIFO_STATUS1 and FIFO_STATUS2 in one read. Returns -1 on a bus error */
+int lsm6dso_fifo_level(void)
+{
+	uint8_t status[2];
+
+	if (!fifo_enabled)
+		return -1;
+
+	if (lsm6dso_read_reg(&dev_ctx, LSM6DSO_FIFO_STATUS1, status, sizeof(status)) != 0)
+		return -1;
+
+	return ((status[1] & 0x03) << 8) | status[0];
+}
+
+/* Decode count words read from FIFO_DATA_OUT_TAG into at most max samples, returns the sample count.
+   A word completes at most one sample, so count no greater than max never overruns samples */
+int lsm6dso_fifo_decode(const uint8_t *words, int count, lsm6dso_sample *samples, int max)
+{
+	int16_t xl[LSM6DSO_DECODE_CHUNK * 3] __attribute__((aligned(4)));
+	int16_t gy[LSM6DSO_DECODE_CHUNK * 3] __attribute__((aligned(4)));
+	int i = 0, decoded = 0, paired;
+
+	/* pair raw triplets a chunk at a time, then scale the chunk with the gyro calibration taken off in the same pass */
+	while (i < count && decoded < max) {
+		for (paired = 0; i < count && paired < LSM6DSO_DECODE_CHUNK && decoded + paired < max; i++)
+			paired += lsm6dso_fifo_pair_word(&words[i * LSM6DSO_FIFO_WORD_SIZE], &xl[paired * 3], &gy[paired * 3]);
+
+		imu_convert_float(xl, paired, accel_offset, LSM6DSO_XL_MG_PER_LSB, samples[decoded].acceleration_mg,
+			LSM6DSO_SAMPLE_STRIDE);
+		imu_convert_float(gy, paired, raw_angular_rate_calibration.i16bit, LSM6DSO_GY_DPS_PER_LSB,
+			samples[decoded].angular_rate_dps, LSM6DSO_SAMPLE_STRIDE);
+		decoded += paired;
+	}
+
+	return decoded;
+}
+
+/* Drain the words queued when called into at most max samples, returns the sample count or -1 on a bus error */
+int lsm6dso_fifo_read(lsm6dso_sample *samples, int max)
+{
+	uint8_t words[LSM6DSO_FIFO_BURST_WORDS * LSM6DSO_FIFO_WORD_SIZE];
+	int level, burst, count = 0;
+
+	if (samples == NULL)
+		return -1;
+
+	level = lsm6dso_fifo_level();
+	if (level < 0)
+		return -1;
+
+	while (level > 0 && count < max) {
+		burst = level < LSM6DSO_FIFO_BURST_WORDS ? level : LSM6DSO_FIFO_BURST_WORDS;
+		if (burst > max - count)
+			burst = max - count;
+
+		if (lsm6dso_read_reg(&dev_ctx, LSM6DSO_FIFO_DATA_OUT_TAG, words, burst * LSM6DSO_FIFO_WORD_SIZE) != 0)
+			return -1;
+		level -= burst;
+
+		count += lsm6dso_fifo_decode(words, burst, &samples[count], max - count);
+	}
+
+	return count;
+}
+
 
 int lsm6dso_init(void *i2c_write, void *i2c_read)
 {
@@ -160,6 +352,13 @@ int lsm6dso_init(void *i2c_write, void *i2c_read)
 		lsm6dso_reset_get(&dev_ctx, &reg);
 	} while (reg);
 
+	/* defaults again, read back in a burst per run of configuration registers */
+	lsm6dso_shadow_attach(&dev_ctx, &dev_shadow);
+	if (lsm6dso_shadow_load(&dev_ctx) != 0) {
+		printf("LSM6DSO shadow load fail\n");
+		return -1;
+	}
+
 	/* Disable I3C interface */
 	lsm6dso_i3c_disable_set(&dev_ctx, LSM6DSO_I3C_DISABLE);
 
@@ -40,8 +40,25 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
+/* FIFO batching, accelerometer and gyro words at the same rate are paired into samples. The rate
+   lsm6dso_fifo_init is given until the A7 app sets another */
+#define LSM6DSO_FIFO_ODR_HZ 417
+#define LSM6DSO_FIFO_WORD_SIZE 7		/* tag byte then X, Y and Z */
+
+typedef struct {
+	float acceleration_mg[3];
+	float angular_rate_dps[3];
+} lsm6dso_sample;
+
 void lsm6dso_show_result(void);
 int lsm6dso_init(void *i2c_write, void *i2c_read);
+int lsm6dso_fifo_init(uint16_t odr_hz, uint16_t watermark, int gyro);
+uint16_t lsm6dso_fifo_rate(uint16_t odr_hz);
+int lsm6dso_fifo_level(void);
+int lsm6dso_fifo_decode(const uint8_t *words, int count, lsm6dso_sample *samples, int max);
+int lsm6dso_fifo_read(lsm6dso_sample *samples, int max);
 float get_temperature(void);
 
 
@@ -35,6 +35,7 @@
   */
 
 #include "lsm6dso_reg.h"
+#include <stddef.h>
 
 /**
   * @defgroup  LSM6DSO
@@ -53,6 +54,93 @@
   *
 */
 
+/* User bank registers only the host changes, so a copy of what was last
+   read or written stays true until a reset: FUNC_CFG_ACCESS, PIN_CTRL,
+   FIFO_CTRL1 to FIFO_CTRL4, COUNTER_BDR_REG2, INT1_CTRL, INT2_CTRL,
+   CTRL1_XL to CTRL10_C, TAP_CFG0 to MD2_CFG, I3C_BUS_AVB and the user
+   offsets. COUNTER_BDR_REG1 has a self clearing bit and is left out, as are
+   the status and output registers. One bit per register. */
+static const uint8_t shadow_regs[LSM6DSO_SHADOW_REGS / 8U] = {
+  0x86U, 0x77U, 0xFFU, 0x03U, 0x00U, 0x00U, 0x00U, 0x00U,
+  0x00U, 0x00U, 0xC0U, 0xFFU, 0x04U, 0x00U, 0x38U, 0x00U,
+};
+
+#define SHADOW_BIT(bits, reg)  (((bits)[(reg) >> 3] >> ((reg) & 7U)) & 1U)
+#define SHADOW_WRITABLE        0
+#define SHADOW_VALID           1
+
+/* Every register of reg to reg + len - 1 is shadowed in the bank selected,
+   and with SHADOW_VALID holds a value */
+static int32_t shadow_holds(const lsm6dso_shadow_t *shadow, uint8_t reg,
+                            uint16_t len, int32_t valid)
+{
+  uint16_t r;
+
+  if ((shadow == NULL) || (len == 0U) ||
+      ((uint16_t)reg + len > LSM6DSO_SHADOW_REGS)) {
+    return 0;
+  }
+
+  for (r = reg; r < (uint16_t)reg + len; r++) {
+    if ((SHADOW_BIT(shadow_regs, r) == 0U) ||
+        ((shadow->bank != 0U) && (r != LSM6DSO_FUNC_CFG_ACCESS)) ||
+        ((valid != 0) && (SHADOW_BIT(shadow->valid, r) == 0U))) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* A write setting SW_RESET or BOOT in CTRL3_C, after which every register
+   is back to its default and the bits clear themselves */
+static int32_t shadow_resets(uint8_t reg, const uint8_t *data, uint16_t len)
+{
+  if ((reg > LSM6DSO_CTRL3_C) || ((uint16_t)reg + len <= LSM6DSO_CTRL3_C)) {
+    return 0;
+  }
+  return ((data[LSM6DSO_CTRL3_C - reg] & 0x81U) != 0U) ? 1 : 0;
+}
+
+static void shadow_clear(lsm6dso_shadow_t *shadow)
+{
+  uint8_t i;
+
+  for (i = 0; i < sizeof(shadow->valid); i++) {
+    shadow->valid[i] = 0U;
+    shadow->dirty[i] = 0U;
+  }
+  shadow->bank = 0U;
+}
+
+/* Copies the registers of a read or write that are shadowed */
+static void shadow_store(lsm6dso_shadow_t *shadow, uint8_t reg,
+                         const uint8_t *data, uint16_t len, uint8_t dirty)
+{
+  uint16_t r;
+  uint8_t bank;
+
+  if (shadow == NULL) {
+    return;
+  }
+
+  bank = shadow->bank;
+  for (r = reg; (r < (uint16_t)reg + len) && (r < LSM6DSO_SHADOW_REGS); r++) {
+    if ((SHADOW_BIT(shadow_regs, r) == 0U) ||
+        ((bank != 0U) && (r != LSM6DSO_FUNC_CFG_ACCESS)) ||
+        ((r == LSM6DSO_CTRL3_C) && ((data[r - reg] & 0x81U) != 0U))) {
+      continue;  /* a reset still running is read back, not copied */
+    }
+    shadow->value[r] = data[r - reg];
+    shadow->valid[r >> 3] |= (uint8_t)(1U << (r & 7U));
+    if (dirty != 0U) {
+      shadow->dirty[r >> 3] |= (uint8_t)(1U << (r & 7U));
+    }
+    if (r == LSM6DSO_FUNC_CFG_ACCESS) {
+      shadow->bank = (uint8_t)(data[r - reg] >> 6);
+    }
+  }
+}
+
 /**
   * @brief  Read generic device register
   *
@@ -67,7 +155,19 @@ int32_t lsm6dso_read_reg(lsm6dso_ctx_t* ctx, uint8_t reg, uint8_t* data,
                          uint16_t len)
 {
   int32_t ret;
+  uint16_t i;
+
+  if (shadow_holds(ctx->shadow, reg, len, SHADOW_VALID)) {
+    for (i = 0; i < len; i++) {
+      data[i] = ctx->shadow->value[reg + i];
+    }
+    return 0;
+  }
+
   ret = ctx->read_reg(ctx->handle, reg, data, len);
+  if (ret == 0) {
+    shadow_store(ctx->shadow, reg, data, len, 0);
+  }
   return ret;
 }
 
@@ -84,8 +184,150 @@ int32_t lsm6dso_read_reg(lsm6dso_ctx_t* ctx, uint8_t reg, uint8_t* data,
 int32_t lsm6dso_write_reg(lsm6dso_ctx_t* ctx, uint8_t reg, uint8_t* data,
                           uint16_t len)
 {
+  lsm6dso_shadow_t *shadow = ctx->shadow;
   int32_t ret;
+
+  if ((shadow != NULL) && (shadow->deferred != 0U)) {
+    if ((reg > LSM6DSO_FUNC_CFG_ACCESS) &&
+        shadow_holds(shadow, reg, len, SHADOW_WRITABLE) &&
+        (shadow_resets(reg, data, len) == 0)) {
+      shadow_store(shadow, reg, data, len, 1);
+      return 0;
+    }
+    /* a bank switch or a reset must not overtake the writes held back */
+    ret = lsm6dso_shadow_apply(ctx);
+    shadow->deferred = 1U;
+    if (ret != 0) {
+      return ret;
+    }
+  }
+
   ret = ctx->write_reg(ctx->handle, reg, data, len);
+  if ((ret == 0) && (shadow != NULL)) {
+    if (shadow_resets(reg, data, len) != 0) {
+      shadow_clear(shadow);
+    }
+    else {
+      shadow_store(shadow, reg, data, len, 0);
+    }
+  }
+  return ret;
+}
+
+/**
+  * @brief  Keep a write-through copy of the configuration registers, so the
+  *         read half of each read-modify-write setter comes from memory and
+  *         only the write reaches the bus. Registers are copied as they are
+  *         read or written, lsm6dso_shadow_load fills the copy at once.
+  *
+  * @param  ctx     read / write interface definitions(ptr)
+  * @param  shadow  the copy, owned by the caller for as long as ctx(ptr)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t lsm6dso_shadow_attach(lsm6dso_ctx_t *ctx, lsm6dso_shadow_t *shadow)
+{
+  if (shadow != NULL) {
+    shadow_clear(shadow);
+    shadow->deferred = 0U;
+  }
+  ctx->shadow = shadow;
+  return 0;
+}
+
+/**
+  * @brief  Read every shadowed register, one burst per run of consecutive
+  *         registers. Needs the user bank selected.
+  *
+  * @param  ctx   read / write interface definitions(ptr)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t lsm6dso_shadow_load(lsm6dso_ctx_t *ctx)
+{
+  uint8_t data[LSM6DSO_SHADOW_REGS];
+  uint16_t first, last;
+  int32_t ret = 0;
+
+  if (ctx->shadow == NULL) {
+    return 0;
+  }
+
+  for (first = 0; (first < LSM6DSO_SHADOW_REGS) && (ret == 0); first = last) {
+    if (SHADOW_BIT(shadow_regs, first) == 0U) {
+      last = first + 1U;
+      continue;
+    }
+    for (last = first; (last < LSM6DSO_SHADOW_REGS) &&
+         (SHADOW_BIT(shadow_regs, last) != 0U); last++) {
+    }
+    ret = ctx->read_reg(ctx->handle, (uint8_t)first, data, last - first);
+    if (ret == 0) {
+      shadow_store(ctx->shadow, (uint8_t)first, data, last - first, 0);
+    }
+  }
+  return ret;
+}
+
+/**
+  * @brief  Hold back writes to shadowed registers until lsm6dso_shadow_apply,
+  *         so a change of mode made of several setters costs a burst per run
+  *         of consecutive registers. Other writes, a bank switch or a reset
+  *         apply what is held first.
+  *
+  * @param  ctx   read / write interface definitions(ptr)
+  *
+  */
+void lsm6dso_shadow_defer(lsm6dso_ctx_t *ctx)
+{
+  if (ctx->shadow != NULL) {
+    ctx->shadow->deferred = 1U;
+  }
+}
+
+/**
+  * @brief  Write the registers held back since lsm6dso_shadow_defer, lowest
+  *         address first, and stop holding writes back. Registers between two
+  *         held back ones are rewritten with their copy when that keeps the
+  *         burst whole. Relies on IF_INC in CTRL3_C, set by default.
+  *
+  * @param  ctx   read / write interface definitions(ptr)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t lsm6dso_shadow_apply(lsm6dso_ctx_t *ctx)
+{
+  lsm6dso_shadow_t *shadow = ctx->shadow;
+  uint16_t first, last, end;
+  int32_t ret = 0;
+
+  if (shadow == NULL) {
+    return 0;
+  }
+  shadow->deferred = 0U;
+
+  for (first = 0; (first < LSM6DSO_SHADOW_REGS) && (ret == 0); first = end) {
+    end = first + 1U;
+    if (SHADOW_BIT(shadow->dirty, first) == 0U) {
+      continue;
+    }
+    /* extend over valid copies to the last held back register of the run */
+    for (last = first; (end < LSM6DSO_SHADOW_REGS) &&
+         (SHADOW_BIT(shadow_regs, end) != 0U) &&
+         (SHADOW_BIT(shadow->valid, end) != 0U); end++) {
+      if (SHADOW_BIT(shadow->dirty, end) != 0U) {
+        last = end;
+      }
+    }
+    end = last + 1U;
+    ret = ctx->write_reg(ctx->handle, (uint8_t)first, &shadow->value[first],
+                         end - first);
+    if (ret == 0) {
+      for (last = first; last < end; last++) {
+        shadow->dirty[last >> 3] &= (uint8_t)~(1U << (last & 7U));
+      }
+    }
+  }
   return ret;
 }
 
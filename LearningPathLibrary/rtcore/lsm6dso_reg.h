@@ -129,12 +129,25 @@ typedef struct{
 typedef int32_t (*lsm6dso_write_ptr)(int*, uint8_t, uint8_t*, uint16_t);
 typedef int32_t (*lsm6dso_read_ptr) (int*, uint8_t, uint8_t*, uint16_t);
 
+/** Write-through copy of the configuration registers, see lsm6dso_shadow_attach **/
+#define LSM6DSO_SHADOW_REGS                  0x80U
+
+typedef struct {
+  uint8_t value[LSM6DSO_SHADOW_REGS];
+  uint8_t valid[LSM6DSO_SHADOW_REGS / 8U];
+  uint8_t dirty[LSM6DSO_SHADOW_REGS / 8U];  /* held back by lsm6dso_shadow_defer */
+  uint8_t bank;                             /* FUNC_CFG_ACCESS reg_access, only the user bank is copied */
+  uint8_t deferred;
+} lsm6dso_shadow_t;
+
 typedef struct {
   /** Component mandatory fields **/
   lsm6dso_write_ptr  write_reg;
   lsm6dso_read_ptr   read_reg;
   /** Customizable optional pointer **/
   int *handle;
+  /** Optional register shadow, NULL reads and writes every register on the bus **/
+  lsm6dso_shadow_t  *shadow;
 } lsm6dso_ctx_t;
 
 /**
@@ -1553,6 +1566,11 @@ int32_t lsm6dso_read_reg(lsm6dso_ctx_t *ctx, uint8_t reg, uint8_t* data,
 int32_t lsm6dso_write_reg(lsm6dso_ctx_t *ctx, uint8_t reg, uint8_t* data,
                           uint16_t len);
 
+int32_t lsm6dso_shadow_attach(lsm6dso_ctx_t *ctx, lsm6dso_shadow_t *shadow);
+int32_t lsm6dso_shadow_load(lsm6dso_ctx_t *ctx);
+void lsm6dso_shadow_defer(lsm6dso_ctx_t *ctx);
+int32_t lsm6dso_shadow_apply(lsm6dso_ctx_t *ctx);
+
 extern float_t lsm6dso_from_fs2_to_mg(int16_t lsb);
 extern float_t lsm6dso_from_fs4_to_mg(int16_t lsb);
 extern float_t lsm6dso_from_fs8_to_mg(int16_t lsb);
@@ -0,0 +1,21 @@
+#pragma once
+
+/* Where code and data live on the M4. TCM is zero wait state but its 192 KB also holds every
+   stack, SYSRAM is the 64 KB the DMA engines reach, a little slower, and FLASH runs code in
+   place behind a small cache, slow on a miss but free of the RAM budget. The lab linker scripts
+   put unmarked code and data where their regions.ld says, TCM in linker/tcm and code and
+   read-only data in FLASH in linker/xip, and these sections where they are named whichever
+   layout is built, RT_MEMORY_LAYOUT picks it. The builds write a map, tools/rt-memory-map
+   reports from it what each region holds. FLASH is beyond the reach of a branch from TCM, the
+   linker puts a veneer on those calls, a few cycles, so a hot loop should not call out of TCM.
+
+   LP_RT_HOT		interrupt handlers and DSP inner loops, TCM in either layout
+   LP_RT_COLD		initialisation run once, executed in place from FLASH
+   LP_RT_FLASH_CONST	large constant tables read now and then, FLASH
+   LP_RT_BULK		large buffers the CPU walks rarely, SYSRAM, zeroed at load like BSS
+   LP_RT_DMA		buffers a DMA engine reads or writes, SYSRAM, which TCM is not */
+#define LP_RT_HOT __attribute__((section(".tcm_text")))
+#define LP_RT_COLD __attribute__((section(".flash_text"), noinline))
+#define LP_RT_FLASH_CONST __attribute__((section(".flash_rodata")))
+#define LP_RT_BULK __attribute__((section(".bss.sysram")))		/* a .bss prefix makes it NOBITS, no zeros in the image */
+#define LP_RT_DMA __attribute__((section(".sysram"), aligned(4)))
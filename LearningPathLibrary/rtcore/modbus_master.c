@@ -0,0 +1,127 @@
+#include "modbus_master.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define EXCEPTION_FLAG 0x80
+#define GAP_FIXED_BAUD 19200		/* above it the spec fixes the gap at 1750 us */
+#define GAP_FIXED_US 1750
+#define CHARACTER_BITS 11			/* start, eight data, parity or a second stop, stop */
+
+_Static_assert(MODBUS_POLLS <= 32, "modbus_batch.polls has a bit per poll");
+
+/* CRC-16/MODBUS, reflected 0x8005 from 0xFFFF, sent low byte first */
+uint16_t modbus_crc16(const uint8_t *data, int length) {
+	uint16_t crc = 0xFFFF;
+	int i, bit;
+
+	for (i = 0; i < length; i++) {
+		crc ^= data[i];
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+	}
+
+	return crc;
+}
+
+/* The 3.5 character silence that ends an RTU frame */
+uint32_t modbus_gap_us(uint32_t baud) {
+	if (baud == 0 || baud > GAP_FIXED_BAUD)
+		return GAP_FIXED_US;
+
+	return (7 * CHARACTER_BITS * 1000000 + 2 * baud - 1) / (2 * baud);
+}
+
+static bool poll_before(const modbus_poll *a, const modbus_poll *b) {
+	return a->slave != b->slave ? a->slave < b->slave : a->first < b->first;
+}
+
+/* Merge the polls in due into batches, in slave and register order. batches has room for
+   MODBUS_POLLS, returns the number planned */
+int modbus_batch_plan(const modbus_poll *polls, uint32_t due, modbus_batch *batches) {
+	int order[MODBUS_POLLS];
+	int sorted = 0, planned = 0, i, j;
+	modbus_batch *batch = NULL;
+	const modbus_poll *poll;
+	uint32_t end, batch_end;
+
+	if (polls == NULL || batches == NULL)
+		return 0;
+
+	for (i = 0; i < MODBUS_POLLS; i++) {
+		if ((due & (1u << i)) == 0 || polls[i].count == 0)
+			continue;
+		for (j = sorted; j > 0 && poll_before(&polls[i], &polls[order[j - 1]]); j--)
+			order[j] = order[j - 1];
+		order[j] = i;
+		sorted++;
+	}
+
+	for (i = 0; i < sorted; i++) {
+		poll = &polls[order[i]];
+		end = (uint32_t)poll->first + poll->count;
+
+		if (batch != NULL) {
+			batch_end = (uint32_t)batch->first + batch->count;
+			if (batch->slave == poll->slave && poll->first <= batch_end + MODBUS_BATCH_GAP &&
+				(end > batch_end ? end : batch_end) - batch->first <= MODBUS_BATCH_REGISTERS) {
+				if (end > batch_end)
+					batch->count = (uint16_t)(end - batch->first);
+				batch->polls |= 1u << order[i];
+				continue;
+			}
+		}
+
+		batch = &batches[planned++];
+		batch->slave = poll->slave;
+		batch->first = poll->first;
+		batch->count = poll->count;
+		batch->polls = 1u << order[i];
+	}
+
+	return planned;
+}
+
+/* The read holding registers request for a batch, MODBUS_REQUEST_BYTES long */
+int modbus_read_request(uint8_t *request, const modbus_batch *batch) {
+	uint16_t crc;
+
+	if (request == NULL || batch == NULL || batch->count == 0 || batch->count > MODBUS_BATCH_REGISTERS)
+		return -1;
+
+	request[0] = batch->slave;
+	request[1] = MODBUS_READ_HOLDING;
+	request[2] = (uint8_t)(batch->first >> 8);
+	request[3] = (uint8_t)batch->first;
+	request[4] = (uint8_t)(batch->count >> 8);
+	request[5] = (uint8_t)batch->count;
+	crc = modbus_crc16(request, 6);
+	request[6] = (uint8_t)crc;
+	request[7] = (uint8_t)(crc >> 8);
+
+	return MODBUS_REQUEST_BYTES;
+}
+
+/* Check a response to a batch's request and decode its registers into values, batch->count of them.
+   Returns LP_IC_MODBUS_OK, the slave's exception code or LP_IC_MODBUS_BAD_RESPONSE */
+int modbus_read_response(const uint8_t *response, int length, const modbus_batch *batch, uint16_t *values) {
+	int i;
+
+	if (response == NULL || batch == NULL || values == NULL || length < 5)
+		return LP_IC_MODBUS_BAD_RESPONSE;
+
+	if (modbus_crc16(response, length - 2) != (response[length - 2] | (response[length - 1] << 8)) ||
+		response[0] != batch->slave)
+		return LP_IC_MODBUS_BAD_RESPONSE;
+
+	if (response[1] == (MODBUS_READ_HOLDING | EXCEPTION_FLAG) && length == 5 && response[2] != LP_IC_MODBUS_OK &&
+		response[2] < LP_IC_MODBUS_BAD_RESPONSE)
+		return response[2];
+
+	if (response[1] != MODBUS_READ_HOLDING || response[2] != 2 * batch->count || length != 5 + 2 * batch->count)
+		return LP_IC_MODBUS_BAD_RESPONSE;
+
+	for (i = 0; i < batch->count; i++)
+		values[i] = (uint16_t)((response[3 + 2 * i] << 8) | response[4 + 2 * i]);
+
+	return LP_IC_MODBUS_OK;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+#include "inter_core_protocol.h"
+
+/* Modbus RTU master framing, and the batching of register reads, the serial line is the caller's.
+   A poll names a run of holding registers on a slave and how often to read it. The polls due at
+   once are merged into as few read holding registers requests as possible: polls on one slave
+   whose runs overlap or lie within MODBUS_BATCH_GAP registers of each other share a request of up
+   to MODBUS_BATCH_REGISTERS, the registers between them read and thrown away, so a meter with a
+   dozen scattered readings costs one round trip rather than a dozen. */
+#define MODBUS_POLLS LP_IC_MODBUS_POLLS
+#define MODBUS_POLL_REGISTERS LP_IC_MODBUS_REGISTERS
+#define MODBUS_BATCH_REGISTERS 125		/* the most one read holding registers response carries */
+#define MODBUS_BATCH_GAP 8				/* unwanted registers read to save a request */
+#define MODBUS_REQUEST_BYTES 8
+#define MODBUS_READ_HOLDING 0x03
+
+typedef struct {
+	uint8_t slave;
+	uint16_t first;
+	uint8_t count;			/* zero for an unused poll */
+	uint32_t period_ms;
+} modbus_poll;
+
+typedef struct {
+	uint8_t slave;
+	uint16_t first;
+	uint16_t count;
+	uint32_t polls;			/* bit n when poll n is part of the batch */
+} modbus_batch;
+
+uint16_t modbus_crc16(const uint8_t *data, int length);
+uint32_t modbus_gap_us(uint32_t baud);
+int modbus_batch_plan(const modbus_poll *polls, uint32_t due, modbus_batch *batches);
+int modbus_read_request(uint8_t *request, const modbus_batch *batch);
+int modbus_read_response(const uint8_t *response, int length, const modbus_batch *batch, uint16_t *values);
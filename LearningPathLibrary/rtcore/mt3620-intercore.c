@@ -5,28 +5,29 @@
 
 #include "mt3620-baremetal.h"
 #include "mt3620-intercore.h"
-#include "mt3620-uart-poll.h"
+#include "printf.h"
 
 static const uintptr_t MAILBOX_BASE = 0x21050000;
 
-static void ReceiveMessage(uint32_t *command, uint32_t *data);
+static bool ReceiveMessage(uint32_t *command, uint32_t *data);
 static uint32_t GetBufferSize(uint32_t bufferBase);
 static BufferHeader *GetBufferHeader(uint32_t bufferBase);
 static uint8_t *DataAreaOffset8(BufferHeader *header, size_t offset);
 static uint32_t *DataAreaOffset32(BufferHeader *header, size_t offset);
 static uint32_t RoundUp(uint32_t value, uint32_t alignment);
 
-static void ReceiveMessage(uint32_t *command, uint32_t *data)
+static bool ReceiveMessage(uint32_t *command, uint32_t *data)
 {
     // FIFO_POP_CNT
-    while (ReadReg32(MAILBOX_BASE, 0x58) == 0) {
-        // empty.
+    if (ReadReg32(MAILBOX_BASE, 0x58) == 0) {
+        return false;
     }
 
     // DATA_POP0
     *data = ReadReg32(MAILBOX_BASE, 0x54);
     // CMD_POP0
     *command = ReadReg32(MAILBOX_BASE, 0x50);
+    return true;
 }
 
 static uint32_t GetBufferSize(uint32_t bufferBase)
@@ -39,40 +40,58 @@ static BufferHeader *GetBufferHeader(uint32_t bufferBase)
     return (BufferHeader *)(bufferBase & ~0x1F);
 }
 
-int GetIntercoreBuffers(BufferHeader **outbound, BufferHeader **inbound, uint32_t *bufSize)
+int PollIntercoreBuffers(IntercoreNegotiation *negotiation, BufferHeader **outbound,
+                         BufferHeader **inbound, uint32_t *bufSize)
 {
-    // Wait for the mailbox to be set up.
-    uint32_t baseRead = 0, baseWrite = 0;
-    while (true) {
-        uint32_t cmd, data;
-        ReceiveMessage(&cmd, &data);
+    uint32_t cmd, data;
+    bool complete = false;
+
+    // Take whatever the mailbox holds, a later set of addresses replaces an earlier one.
+    while (!complete && ReceiveMessage(&cmd, &data)) {
         if (cmd == 0xba5e0001) {
-            baseWrite = data;
+            negotiation->baseWrite = data;
         } else if (cmd == 0xba5e0002) {
-            baseRead = data;
+            negotiation->baseRead = data;
         } else if (cmd == 0xba5e0003) {
-            break;
+            complete = true;
         }
     }
 
-    uint32_t inboundBufferSize = GetBufferSize(baseRead);
-    uint32_t outboundBufferSize = GetBufferSize(baseWrite);
+    if (!complete) {
+        return 0;
+    }
+
+    uint32_t inboundBufferSize = GetBufferSize(negotiation->baseRead);
+    uint32_t outboundBufferSize = GetBufferSize(negotiation->baseWrite);
 
     if (inboundBufferSize != outboundBufferSize) {
-        Uart_WriteStringPoll("GetIntercoreBuffers: Mismatched buffer sizes\r\n");
+        printf("GetIntercoreBuffers: Mismatched buffer sizes\n");
         return -1;
     }
 
     if (inboundBufferSize <= sizeof(BufferHeader)) {
-        Uart_WriteStringPoll("GetIntercoreBuffers: buffer size smaller than header\n");
+        printf("GetIntercoreBuffers: buffer size smaller than header\n");
         return -1;
     }
 
     *bufSize = inboundBufferSize - sizeof(BufferHeader);
-    *inbound = GetBufferHeader(baseRead);
-    *outbound = GetBufferHeader(baseWrite);
+    *inbound = GetBufferHeader(negotiation->baseRead);
+    *outbound = GetBufferHeader(negotiation->baseWrite);
 
-    return 0;
+    return 1;
+}
+
+int GetIntercoreBuffers(BufferHeader **outbound, BufferHeader **inbound, uint32_t *bufSize)
+{
+    // Wait for the mailbox to be set up.
+    IntercoreNegotiation negotiation = {0};
+    int result;
+
+    while ((result = PollIntercoreBuffers(&negotiation, outbound, inbound, bufSize)) == 0) {
+        // empty.
+    }
+
+    return result == 1 ? 0 : -1;
 }
 
 static uint8_t *DataAreaOffset8(BufferHeader *header, size_t offset)
@@ -103,7 +122,7 @@ int EnqueueData(BufferHeader *inbound, BufferHeader *outbound, uint32_t bufSize,
     uint32_t localWritePosition = outbound->writePosition;
 
     if (remoteReadPosition >= bufSize) {
-        Uart_WriteStringPoll("EnqueueData: remoteReadPosition invalid\r\n");
+        printf("EnqueueData: remoteReadPosition invalid\n");
         return -1;
     }
 
@@ -117,7 +136,7 @@ int EnqueueData(BufferHeader *inbound, BufferHeader *outbound, uint32_t bufSize,
 
     // If there isn't enough space to enqueue a block, then abort the operation.
     if (availSpace < sizeof(uint32_t) + dataSize + RINGBUFFER_ALIGNMENT) {
-        Uart_WriteStringPoll("EnqueueData: not enough space to enqueue block\r\n");
+        printf("EnqueueData: not enough space to enqueue block\n");
         return -1;
     }
 
@@ -128,7 +147,7 @@ int EnqueueData(BufferHeader *inbound, BufferHeader *outbound, uint32_t bufSize,
     // There must be enough space between the write pointer and the end of the buffer to store the
     // block size as a contiguous 4-byte value. The remainder of message can wrap around.
     if (dataToEnd < sizeof(uint32_t)) {
-        Uart_WriteStringPoll("EnqueueData: not enough space for block size\r\n");
+        printf("EnqueueData: not enough space for block size\n");
         return -1;
     }
 
@@ -160,6 +179,87 @@ int EnqueueData(BufferHeader *inbound, BufferHeader *outbound, uint32_t bufSize,
     return 0;
 }
 
+uint32_t GetFreeSpace(BufferHeader *inbound, BufferHeader *outbound, uint32_t bufSize)
+{
+    uint32_t remoteReadPosition = inbound->readPosition;
+    uint32_t localWritePosition = outbound->writePosition;
+
+    if (remoteReadPosition >= bufSize) {
+        return 0;
+    }
+
+    uint32_t availSpace;
+    if (remoteReadPosition <= localWritePosition) {
+        availSpace = remoteReadPosition - localWritePosition + bufSize;
+    } else {
+        availSpace = remoteReadPosition - localWritePosition;
+    }
+
+    // Less the block size word and the alignment slack EnqueueData keeps free.
+    if (availSpace <= sizeof(uint32_t) + RINGBUFFER_ALIGNMENT) {
+        return 0;
+    }
+
+    return availSpace - sizeof(uint32_t) - RINGBUFFER_ALIGNMENT;
+}
+
+void *ReserveData(BufferHeader *inbound, BufferHeader *outbound, uint32_t bufSize,
+                  uint32_t maxSize)
+{
+    uint32_t remoteReadPosition = inbound->readPosition;
+    uint32_t localWritePosition = outbound->writePosition;
+
+    if (remoteReadPosition >= bufSize) {
+        printf("ReserveData: remoteReadPosition invalid\n");
+        return NULL;
+    }
+
+    // Same free space rule as EnqueueData.
+    uint32_t availSpace;
+    if (remoteReadPosition <= localWritePosition) {
+        availSpace = remoteReadPosition - localWritePosition + bufSize;
+    } else {
+        availSpace = remoteReadPosition - localWritePosition;
+    }
+
+    if (availSpace < sizeof(uint32_t) + maxSize + RINGBUFFER_ALIGNMENT) {
+        return NULL;
+    }
+
+    // The block size and the whole message must fit before the end of the buffer, the caller
+    // writes the reserved area as one contiguous region.
+    if (bufSize - localWritePosition < sizeof(uint32_t) + maxSize) {
+        return NULL;
+    }
+
+    return DataAreaOffset8(outbound, localWritePosition + sizeof(uint32_t));
+}
+
+int CommitData(BufferHeader *outbound, uint32_t bufSize, uint32_t dataSize)
+{
+    uint32_t localWritePosition = outbound->writePosition;
+
+    if (localWritePosition >= bufSize || bufSize - localWritePosition < sizeof(uint32_t) + dataSize) {
+        printf("CommitData: block does not fit the reserved area\n");
+        return -1;
+    }
+
+    // Write block size to first word in block, the message is already in place.
+    *DataAreaOffset32(outbound, localWritePosition) = dataSize;
+
+    // Advance write position.
+    localWritePosition =
+        RoundUp(localWritePosition + sizeof(uint32_t) + dataSize, RINGBUFFER_ALIGNMENT);
+    if (localWritePosition >= bufSize) {
+        localWritePosition -= bufSize;
+    }
+    outbound->writePosition = localWritePosition;
+
+    // SW_TX_INT_PORT[0] = 1 -> indicate message sent.
+    WriteReg32(MAILBOX_BASE, 0x14, 1U << 0);
+    return 0;
+}
+
 int DequeueData(BufferHeader *outbound, BufferHeader *inbound, uint32_t bufSize, void *dest,
                 uint32_t *dataSize)
 {
@@ -167,7 +267,7 @@ int DequeueData(BufferHeader *outbound, BufferHeader *inbound, uint32_t bufSize,
     uint32_t localReadPosition = outbound->readPosition;
 
     if (remoteWritePosition >= bufSize) {
-        Uart_WriteStringPoll("DequeueData: remoteWritePosition invalid\r\n");
+        printf("DequeueData: remoteWritePosition invalid\n");
         return -1;
     }
 
@@ -184,7 +284,7 @@ int DequeueData(BufferHeader *outbound, BufferHeader *inbound, uint32_t bufSize,
     // There must be at least four contiguous bytes to hold the block size.
     if (availData < sizeof(uint32_t)) {
         if (availData > 0) {
-            Uart_WriteStringPoll("DequeueData: availData < 4 bytes\r\n");
+            printf("DequeueData: availData < 4 bytes\n");
         }
 
         return -1;
@@ -192,7 +292,7 @@ int DequeueData(BufferHeader *outbound, BufferHeader *inbound, uint32_t bufSize,
 
     size_t dataToEnd = bufSize - localReadPosition;
     if (dataToEnd < sizeof(uint32_t)) {
-        Uart_WriteStringPoll("DequeueData: dataToEnd < 4 bytes\r\n");
+        printf("DequeueData: dataToEnd < 4 bytes\n");
         return -1;
     }
 
@@ -200,13 +300,13 @@ int DequeueData(BufferHeader *outbound, BufferHeader *inbound, uint32_t bufSize,
 
     // Ensure the block size is no greater than the available data.
     if (blockSize + sizeof(uint32_t) > availData) {
-        Uart_WriteStringPoll("DequeueData: message size greater than available data\r\n");
+        printf("DequeueData: message size greater than available data\n");
         return -1;
     }
 
     // Abort if the caller-supplied buffer is not large enough to hold the message.
     if (blockSize > *dataSize) {
-        Uart_WriteStringPoll("DequeueData: message too large for buffer\r\n");
+        printf("DequeueData: message too large for buffer\n");
         *dataSize = blockSize;
         return -1;
     }
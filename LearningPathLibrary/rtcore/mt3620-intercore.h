@@ -30,9 +30,34 @@ typedef struct {
 /// <summary>Blocks inside the shared buffer have this alignment.</summary>
 #define RINGBUFFER_ALIGNMENT 16
 
+/// <summary>
+/// The buffer addresses received so far, kept by the caller of <see cref="PollIntercoreBuffers" />
+/// between calls. Zero it before the first call.
+/// </summary>
+typedef struct {
+    uint32_t baseRead;
+    uint32_t baseWrite;
+} IntercoreNegotiation;
+
+/// <summary>
+/// <para>Takes the messages waiting in the mailbox without blocking, and reports the inbound and
+/// outbound buffers once the high-level side has published a complete set of addresses.</para>
+/// <para>Safe to call from the mailbox FIFO interrupt. A set published again, as when the
+/// application restarts, is reported again.</para>
+/// </summary>
+/// <param name="negotiation">State carried between calls.</param>
+/// <param name="outbound">Set when 1 is returned, see <see cref="GetIntercoreBuffers" />.</param>
+/// <param name="inbound">Set when 1 is returned.</param>
+/// <param name="bufSize">Set when 1 is returned.</param>
+/// <returns>1 when the buffers are set, 0 when the mailbox is drained before the set is complete,
+/// -1 when the published buffers are invalid.</returns>
+int PollIntercoreBuffers(IntercoreNegotiation *negotiation, BufferHeader **outbound,
+                         BufferHeader **inbound, uint32_t *bufSize);
+
 /// <summary>
 /// <para>Gets the inbound and outbound buffers used to communicate with the high-level
-/// application.  This function blocks until that data is available from the mailbox.</para>
+/// application.  This function blocks until that data is available from the mailbox, use
+/// <see cref="PollIntercoreBuffers" /> from an interrupt instead to keep the core free.</para>
 /// <para>The retrieved pointers are then supplied to <see cref="EnqueueData" /> and
 /// <see cref="DequeueData" />.</para>
 /// </summary>
@@ -60,6 +85,52 @@ int GetIntercoreBuffers(BufferHeader **outbound, BufferHeader **inbound, uint32_
 int EnqueueData(BufferHeader *inbound, BufferHeader *outbound, uint32_t bufSize, const void *src,
                 uint32_t dataSize);
 
+/// <summary>
+/// <para>Reserve space for a block in the shared buffer so the caller can write the message
+/// in place, without staging it in a local buffer for <see cref="EnqueueData" />.</para>
+/// <para>The reserved area is contiguous. NULL is returned when there is not enough free space,
+/// or when the block would wrap around the end of the buffer; use <see cref="EnqueueData" />
+/// in that case.</para>
+/// </summary>
+/// <param name="inbound">The inbound buffer, as obtained from <see cref="GetIntercoreBuffers" />.
+/// </param>
+/// <param name="outbound">The outbound buffer, as obtained from <see cref="GetIntercoreBuffers" />.
+/// </param>
+/// <param name="bufSize">
+/// The total buffer size, as obtained from <see cref="GetIntercoreBuffers" />.
+/// </param>
+/// <param name="maxSize">Largest message the caller will write, in bytes.</param>
+/// <returns>Start of the reserved area in the shared buffer, or NULL.</returns>
+void *ReserveData(BufferHeader *inbound, BufferHeader *outbound, uint32_t bufSize,
+                  uint32_t maxSize);
+
+/// <summary>
+/// Publish a block written in place after <see cref="ReserveData" />, advance the write position
+/// and notify the high-level application.
+/// </summary>
+/// <param name="outbound">The outbound buffer, as obtained from <see cref="GetIntercoreBuffers" />.
+/// </param>
+/// <param name="bufSize">
+/// The total buffer size, as obtained from <see cref="GetIntercoreBuffers" />.
+/// </param>
+/// <param name="dataSize">Length of the message written, no more than the reserved maxSize.</param>
+/// <returns>0 on success, -1 otherwise.</returns>
+int CommitData(BufferHeader *outbound, uint32_t bufSize, uint32_t dataSize);
+
+/// <summary>
+/// Free space in the shared buffer, the largest message <see cref="EnqueueData" /> can accept now.
+/// Callers compare it with their own watermarks to apply backpressure.
+/// </summary>
+/// <param name="inbound">The inbound buffer, as obtained from <see cref="GetIntercoreBuffers" />.
+/// </param>
+/// <param name="outbound">The outbound buffer, as obtained from <see cref="GetIntercoreBuffers" />.
+/// </param>
+/// <param name="bufSize">
+/// The total buffer size, as obtained from <see cref="GetIntercoreBuffers" />.
+/// </param>
+/// <returns>Free bytes for message data, 0 when full or the read position is invalid.</returns>
+uint32_t GetFreeSpace(BufferHeader *inbound, BufferHeader *outbound, uint32_t bufSize);
+
 /// <summary>
 /// Remove data from the shared buffer, which has been written by the high-level application.
 /// </summary>
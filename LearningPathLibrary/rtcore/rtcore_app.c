@@ -0,0 +1,1718 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include <string.h>
+
+#include "printf.h"
+#include "os_hal_gpio.h"
+
+#include "hw/azure_sphere_learning_path.h"
+#include "rtos.h"
+#include "rtcore_app.h"
+#include "inter_core_link.h"
+#include "uart_log.h"
+#include "watchdog.h"
+#include "buttons.h"
+#include "gpio_pins.h"
+#include "led_pwm.h"
+#include "adc_sampler.h"
+#include "telemetry_window.h"
+#include "event_rules.h"
+#include "memory_placement.h"
+#include "sample_clock.h"
+
+#ifdef OEM_AVNET
+#include "lsm6dso_driver.h"
+#include "lsm6dso_reg.h"
+#include "imu_dsp.h"
+#include "imu_fusion.h"
+#include "anomaly_model.h"
+#include "i2c.h"
+#include "thermostat.h"
+#endif // OEM_AVNET
+
+#ifdef AUDIO_I2S_PORT
+#include "audio_capture.h"
+#include "audio_features.h"
+#endif // AUDIO_I2S_PORT
+
+#ifdef SPI_ADC_BUS
+#include "spi_sampler.h"
+#endif // SPI_ADC_BUS
+
+#ifdef MODBUS_UART_PORT
+#include "modbus_master.h"
+#include "uart_frames.h"
+#endif // MODBUS_UART_PORT
+
+
+#define BUTTON_QUEUE_LENGTH 4
+#define BUTTON_DEBOUNCE OS_HAL_EINT_DB_TIME_4	// contact bounce is filtered by the EINT block, not by polling
+#define VIRTUAL_BUTTON_MS 10000
+#define SENSOR_QUEUE_LENGTH 4
+#define DIAGNOSTICS_REQUEST_FLAG 0x1
+#define LED_DEADLINE_MS 4000		// twice the slowest blink
+#define VIRTUAL_BUTTON_DEADLINE_MS (2 * VIRTUAL_BUTTON_MS)
+#define INTER_CORE_DEADLINE_MS 3000	// the link task wakes at least once a second
+
+// the more urgent a task, the less it runs per wakeup
+#define I2C_BUS_PRIORITY 6			// above every task using the I2C bus, it sleeps while a transfer is on the bus
+#define BUTTON_PRIORITY 5
+#define IMU_SAMPLE_PRIORITY 5
+#define INTER_CORE_PRIORITY 4
+#define SENSOR_PRIORITY 3
+#define MODBUS_PRIORITY 3			// waits out each response, the frames arrive by DMA
+#define SPI_ADC_PRIORITY 3		// a block every 16 ms at 4 kHz, the ring holds three more
+#define AUDIO_PRIORITY 3		// a frame's FFT takes well under a millisecond, the DMA allows a 32 ms period
+#define IMU_AGGREGATE_PRIORITY 3		// below the inter-core task, so a full burst stream is drained as soon as it is flushed
+#define DIAGNOSTICS_PRIORITY 2
+#define WATCHDOG_PRIORITY 2		// above the polling ADC task, so a task hogging the core below it is caught too
+#define ADC_PRIORITY 1		// the bare-metal OS HAL polls for the ADC FIFO, so it runs below every other task
+
+#ifdef OEM_AVNET
+#define IMU_FIFO_WATERMARK 64		// FIFO words, 32 accelerometer and gyro pairs, until LP_IC_SENSOR_POLICY sets another
+#define IMU_BLOCK_SAMPLES 48		// headroom for words queued between the watermark and the drain
+#define IMU_WATERMARK_SAMPLES 32	// most samples a watermark may stand for, it keeps that headroom
+#define IMU_BLOCK_COUNT 2			// one being filled while the other is processed
+#define IMU_BURST_WORDS 32			// FIFO words per DMA read, 224 bytes
+#define IMU_FIFO_FLAG 0x1
+#define IMU_POLICY_FLAG 0x4			// LP_IC_SENSOR_POLICY arrived, wakes a powered down imu_sample_task
+#define IMU_TELEMETRY_WINDOW (10 * LSM6DSO_FIFO_ODR_HZ)	// samples per summary until the A7 app sets a window, 10 seconds
+#define IMU_DSP_STAGES (IMU_DSP_LOWPASS | IMU_DSP_RMS | IMU_DSP_BAND)	// on the accelerometer axes, the gyro axes are not filtered
+#define IMU_DSP_TILT_CUTOFF_HZ 2.0f		// low-pass leaves gravity, so the filtered axes give the tilt
+#define IMU_DSP_BAND_HZ 50.0f			// vibration band, mains driven motors
+#define IMU_DSP_REPORT_MS 10000			// cycles per sample and vibration printed over UART
+#define IMU_ORIENTATION_HZ 5			// fused at the FIFO rate, sent to the A7 five times a second
+#define IMU_DEADLINE_MS 1000		// a block is read and processed every watermark period
+#define ANOMALY_REPORT_MS 10000			// LP_IC_ANOMALY_SCORE between changes of the anomaly state
+#define IMU_JITTER_REPORT_MS 10000		// sample clock jitter sent to the A7 and printed over UART
+#define THERMOSTAT_REPORT_MS 10000		// LP_IC_THERMOSTAT_STATUS between switches while the thermostat runs
+
+typedef struct
+{
+	int count;
+	uint32_t stamp_us;		// sample clock when the FIFO level was read, the last sample's time give or take a sample period
+	uint16_t odr_hz;		// the FIFO rate the samples were taken at
+	lsm6dso_sample samples[IMU_BLOCK_SAMPLES];
+} imu_sample_block;		// one FIFO drain, passed between the IMU tasks by index
+#endif // OEM_AVNET
+
+#ifdef ADC_CONTROLLER
+#define ADC_CHANNELS ADC_BIT0		// channel 0 is the light sensor on the Avnet starter kit
+#define ADC_RETRY_MS 1000
+#define ADC_DEADLINE_MS (2 * ADC_RETRY_MS)
+#endif // ADC_CONTROLLER
+
+#ifdef AUDIO_I2S_PORT
+#define AUDIO_QUEUE_LENGTH 1		// the completed period, the DMA is filling the other one
+#define AUDIO_WAIT_MS 500			// wakes to check in, and to start or stop capture, while no frames arrive
+#define AUDIO_DEADLINE_MS (2 * AUDIO_WAIT_MS)
+#define AUDIO_REPORT_MS 10000		// cycles per frame and frames lost printed over UART
+#endif // AUDIO_I2S_PORT
+
+#ifdef SPI_ADC_BUS
+#ifndef SPI_ADC_RATE_HZ
+#define SPI_ADC_RATE_HZ 4096		// GPT1 trigger, 32768 / 8
+#endif // SPI_ADC_RATE_HZ
+#ifndef SPI_ADC_OPCODE
+#define SPI_ADC_OPCODE 0			// no command, the ADC shifts out the last conversion
+#define SPI_ADC_OPCODE_LEN 0
+#endif // SPI_ADC_OPCODE
+#define SPI_ADC_SAMPLE_BYTES 3		// 24 bit conversions
+#define SPI_ADC_SPEED_KHZ 8000
+#define SPI_ADC_BLOCK_FLAG 0x1
+#define SPI_ADC_WAIT_MS 500
+#define SPI_ADC_DEADLINE_MS (2 * SPI_ADC_WAIT_MS)
+#define SPI_ADC_REPORT_MS 10000		// rate, losses and block levels printed over UART
+#endif // SPI_ADC_BUS
+
+#ifdef MODBUS_UART_PORT
+#ifndef MODBUS_BAUD
+#define MODBUS_BAUD 9600
+#endif // MODBUS_BAUD
+#define MODBUS_PARITY UART_EVEN_PARITY	// 8E1, the RTU default
+#define MODBUS_QUEUE_LENGTH MODBUS_POLLS
+#define MODBUS_RESPONSE_MS 100		// a slave has this long to answer, most take a few milliseconds
+#define MODBUS_MIN_PERIOD_MS 100
+#define MODBUS_FRAME_FLAG 0x1
+#define MODBUS_POLL_FLAG 0x2
+#define MODBUS_WAIT_MS 500
+#define MODBUS_DEADLINE_MS (2 * MODBUS_WAIT_MS + MODBUS_RESPONSE_MS)	// checks in between batches too
+#define MODBUS_REPORT_MS 10000		// requests, failures and lost frames printed over UART
+
+typedef struct
+{
+	int index;
+	modbus_poll poll;
+} modbus_poll_update;		// an LP_IC_MODBUS_POLL, passed from the inter-core task to modbus_task
+#endif // MODBUS_UART_PORT
+
+
+enum LEDS
+{
+	RED,
+	GREEN,
+	BLUE
+};
+
+enum BUTTONS
+{
+	BUTTON_INDEX_A,
+	BUTTON_INDEX_B
+};
+
+static enum LEDS current_led = RED;
+
+#ifdef LED_PWM_CONTROLLER
+// the PWM block mixes the colour and runs the blink, led_timer only expires when the pattern changes
+static const uint32_t rgb_led_colours[] = { [RED] = 0xFF0000, [GREEN] = 0x00FF00, [BLUE] = 0x0000FF };
+static LP_INTER_CORE_BLOCK led_pattern;		// last LP_IC_LED_PATTERN, overrides the temperature status while its colour is nonzero
+#else
+#define RGB_LED_OFF 0x7		// the LEDs are active low, all three driven high
+
+static const os_hal_gpio_pin rgb_led_pins[] = { [RED] = LED_RED, [GREEN] = LED_GREEN, [BLUE] = LED_BLUE };
+static gpio_port rgb_led;
+#endif // LED_PWM_CONTROLLER
+
+static const int blinkIntervalsMs[] = { 125, 250, 500, 750, 1000, 2000 };
+static int blinkIntervalIndex = 3;
+static const int numBlinkIntervals = sizeof(blinkIntervalsMs) / sizeof(blinkIntervalsMs[0]);
+
+typedef struct
+{
+	uint16_t cmd;		// LP_IC_TEMPERATURE_PRESSURE_HUMIDITY or LP_IC_SET_DESIRED_TEMPERATURE
+	uint16_t sequence;	// of the reading request, echoed in the reading
+	int32_t temperature;	// desired
+	uint8_t traced;		// the request asked for a latency trace
+	uint32_t received;	// inter_core_link_trace_stamp when the request arrived
+} sensor_request;
+
+static volatile uint16_t profile_period = 0;	// seconds between unrequested profile reports, zero for none
+
+// watchdog slots of the tasks and timers that wake on their own, those blocking until there is work have none
+static int led_watchdog = -1;
+static int button_watchdog = -1;
+static int inter_core_watchdog = -1;
+#ifdef OEM_AVNET
+static int imu_sample_watchdog = -1;
+static int imu_aggregate_watchdog = -1;
+#endif // OEM_AVNET
+#ifdef ADC_CONTROLLER
+static int adc_watchdog = -1;
+#endif // ADC_CONTROLLER
+#ifdef AUDIO_I2S_PORT
+static int audio_watchdog = -1;
+#endif // AUDIO_I2S_PORT
+#ifdef SPI_ADC_BUS
+static int spi_adc_watchdog = -1;
+#endif // SPI_ADC_BUS
+#ifdef MODBUS_UART_PORT
+static int modbus_watchdog = -1;
+#endif // MODBUS_UART_PORT
+
+static rtos_timer led_timer;			// the GPIO blink's next toggle, or the PWM block's next pattern
+static bool led_open = false;			// the LED pins or PWM block are held, led_timer may run
+#if defined(OEM_SEEED_STUDIO_MINI)
+static rtos_timer virtual_button_timer;
+#endif // OEM_SEEED_STUDIO_MINI
+static rtos_event diagnostics_event;	// an LP_IC_PROFILE_REQUEST arrived
+static rtos_queue button_queue;			// button indexes posted from the EINT interrupt
+static RTOS_QUEUE_STORAGE(button_queue_storage, sizeof(int), BUTTON_QUEUE_LENGTH);
+static rtos_queue sensor_queue;			// requests the inter-core task forwards to sensor_task
+static RTOS_QUEUE_STORAGE(sensor_queue_storage, sizeof(sensor_request), SENSOR_QUEUE_LENGTH);
+
+#ifdef OEM_AVNET
+static imu_sample_block imu_blocks[IMU_BLOCK_COUNT];
+static rtos_queue imu_free_queue;		// indexes of the blocks imu_sample_task may fill
+static RTOS_QUEUE_STORAGE(imu_free_queue_storage, sizeof(int), IMU_BLOCK_COUNT);
+static rtos_queue imu_full_queue;		// and of those waiting for imu_aggregate_task
+static RTOS_QUEUE_STORAGE(imu_full_queue_storage, sizeof(int), IMU_BLOCK_COUNT);
+static rtos_event imu_event;			// set from the IMU FIFO watermark, or sample clock, interrupt
+static uint8_t imu_words[IMU_BURST_WORDS * LSM6DSO_FIFO_WORD_SIZE];
+static volatile float vibration_rms_mg = 0;	// spread of the acceleration magnitude over the last block
+static telemetry_window telemetry_windows[LP_IC_CHANNEL_COUNT];		// every IMU sample is folded in, only summaries cross to the A7
+static imu_fusion fusion;
+static int orientation_decimation = LSM6DSO_FIFO_ODR_HZ / IMU_ORIENTATION_HZ;
+static int orientation_countdown = LSM6DSO_FIFO_ODR_HZ / IMU_ORIENTATION_HZ;
+static volatile uint16_t imu_policy_odr_hz = LSM6DSO_FIFO_ODR_HZ;	// LP_IC_SENSOR_POLICY as inter_core_handler took it
+static volatile uint16_t imu_policy_watermark = IMU_FIFO_WATERMARK;
+static volatile uint8_t imu_policy_gyro = 1;
+static volatile uint8_t imu_policy_requested = 1;	// bumped after the policy is written, imu_sample_task applies it
+static uint8_t imu_policy_applied = 0;
+static uint16_t imu_odr_hz = 0;						// the FIFO rate set, zero while the IMU is powered down
+static uint32_t imu_wait_ms = 0;					// time to fill to the watermark
+static uint16_t processing_odr_hz = 0;				// imu_aggregate_task, the rate its filters are set for
+static uint32_t imu_stamp_us;			// sample clock time of the sample being processed, stamps what it sends
+static uint32_t anomaly_window = 0;		// imu_aggregate_task, the DSP window last scored
+static uint16_t anomaly_windows = 0;	// scored since the last LP_IC_ANOMALY_SCORE, and the highest score of them
+static float anomaly_peak = 0;
+static uint32_t anomaly_last_report = 0;
+static volatile bool anomaly_report_due = false;	// an LP_IC_ANOMALY_MODEL was handled, the A7 app hears which model runs
+static bool thermostat_relay_closed = false;
+static uint32_t thermostat_last_report = 0;
+#ifdef LSM6DSO_INT1
+static gpio_pin imu_int1;
+#endif // LSM6DSO_INT1
+#ifdef THERMOSTAT_RELAY
+static gpio_pin thermostat_relay;
+#endif // THERMOSTAT_RELAY
+#ifdef CONTROL_PROBE_PIN
+static gpio_pin control_probe;			// toggled as each benchmarked control request is applied
+#endif // CONTROL_PROBE_PIN
+#endif // OEM_AVNET
+
+#ifdef AUDIO_I2S_PORT
+static rtos_queue audio_queue;			// periods posted from the I2S DMA interrupt
+static RTOS_QUEUE_STORAGE(audio_queue_storage, sizeof(int), AUDIO_QUEUE_LENGTH);
+static volatile uint16_t audio_period_ms = 0;	// milliseconds per LP_IC_AUDIO_FEATURES, zero while capture is stopped
+static volatile uint32_t audio_frames_lost = 0;	// periods completed while the previous one was still queued
+#endif // AUDIO_I2S_PORT
+
+#ifdef SPI_ADC_BUS
+static rtos_event spi_adc_event;		// set from the SPI completion interrupt once per block
+#endif // SPI_ADC_BUS
+
+#ifdef MODBUS_UART_PORT
+static rtos_event modbus_event;			// a frame from the DMA interrupt, or a poll update from the inter-core task
+static rtos_queue modbus_queue;			// poll updates
+static RTOS_QUEUE_STORAGE(modbus_queue_storage, sizeof(modbus_poll_update), MODBUS_QUEUE_LENGTH);
+static modbus_poll modbus_polls[MODBUS_POLLS];		// owned by modbus_task, off its stack with the batch buffers
+static uint32_t modbus_next_due[MODBUS_POLLS];
+static modbus_batch modbus_batches[MODBUS_POLLS];
+static uint16_t modbus_values[MODBUS_BATCH_REGISTERS];
+#ifdef MODBUS_DE_PIN
+static gpio_pin modbus_de;				// RS-485 driver enable, high while the request goes out
+#endif // MODBUS_DE_PIN
+#endif // MODBUS_UART_PORT
+
+// each task has its stack at compile time
+static rtos_task inter_core_task_tcb, sensor_task_tcb, diagnostics_task_tcb, watchdog_task_tcb;
+#if ! defined(OEM_SEEED_STUDIO_MINI)
+static rtos_task button_task_tcb;
+static RTOS_STACK(button_task_stack, RTCORE_APP_STACK_SIZE);
+#endif // OEM_SEEED_STUDIO_MINI
+static RTOS_STACK(inter_core_task_stack, RTCORE_APP_STACK_SIZE);
+static RTOS_STACK(sensor_task_stack, RTCORE_APP_STACK_SIZE);
+static RTOS_STACK(diagnostics_task_stack, RTCORE_APP_STACK_SIZE);
+static RTOS_STACK(watchdog_task_stack, RTCORE_APP_STACK_SIZE);
+#ifdef OEM_AVNET
+static rtos_task i2c_bus_task_tcb, imu_sample_task_tcb, imu_aggregate_task_tcb;
+static RTOS_STACK(i2c_bus_task_stack, RTCORE_APP_STACK_SIZE);
+static RTOS_STACK(imu_sample_task_stack, RTCORE_APP_STACK_SIZE);
+static RTOS_STACK(imu_aggregate_task_stack, RTCORE_APP_STACK_SIZE);
+#endif // OEM_AVNET
+#ifdef ADC_CONTROLLER
+static rtos_task adc_task_tcb;
+static RTOS_STACK(adc_task_stack, RTCORE_APP_STACK_SIZE);
+#endif // ADC_CONTROLLER
+#ifdef AUDIO_I2S_PORT
+static rtos_task audio_task_tcb;
+static RTOS_STACK(audio_task_stack, RTCORE_APP_STACK_SIZE);
+#endif // AUDIO_I2S_PORT
+#ifdef SPI_ADC_BUS
+static rtos_task spi_adc_task_tcb;
+static RTOS_STACK(spi_adc_task_stack, RTCORE_APP_STACK_SIZE);
+#endif // SPI_ADC_BUS
+#ifdef MODBUS_UART_PORT
+static rtos_task modbus_task_tcb;
+static RTOS_STACK(modbus_task_stack, RTCORE_APP_STACK_SIZE);
+#endif // MODBUS_UART_PORT
+
+
+/// <summary>
+/// Have led_timer reprogram the PWM block on the timer task, the GPIO blink picks up a change on its next toggle
+/// </summary>
+static void update_status_led(void)
+{
+#ifdef LED_PWM_CONTROLLER
+	if (led_open)
+	{
+		rtos_timer_start(&led_timer, 0);	// a full timer command queue leaves the change for the next one
+	}
+#endif // LED_PWM_CONTROLLER
+}
+
+static void set_temperature_status(int temperature, int desired_temperature)
+{
+	if (temperature == desired_temperature)
+	{
+		current_led = GREEN;
+	}
+
+	if (temperature < desired_temperature)
+	{
+		current_led = BLUE;
+	}
+
+	if (temperature > desired_temperature)
+	{
+		current_led = RED;
+	}
+
+	update_status_led();
+}
+
+#ifdef LED_PWM_CONTROLLER
+/// <summary>
+/// Program the PWM block with the LED pattern, or the temperature status and blink rate when there is none
+/// </summary>
+static void led_expired(void)
+{
+	static uint32_t applied_colour = 0;
+	static uint16_t applied_on_ms = 0, applied_off_ms = 0;
+	uint32_t colour;
+	uint16_t on_ms, off_ms;
+
+	if (led_pattern.ledColour != 0)
+	{
+		colour = led_pattern.ledColour;
+		on_ms = led_pattern.ledOnMs;
+		off_ms = led_pattern.ledOffMs;
+	}
+	else
+	{
+		colour = rgb_led_colours[current_led];
+		on_ms = off_ms = (uint16_t)blinkIntervalsMs[blinkIntervalIndex];
+	}
+
+	// reprogramming restarts the blink, so telemetry that leaves the status unchanged leaves the LED alone
+	if (colour != applied_colour || on_ms != applied_on_ms || off_ms != applied_off_ms)
+	{
+		led_pwm_set(colour, on_ms, off_ms);
+		applied_colour = colour;
+		applied_on_ms = on_ms;
+		applied_off_ms = off_ms;
+	}
+}
+
+static int open_status_led(void)
+{
+	return led_pwm_open((pwm_groups)LED_PWM_CONTROLLER);
+}
+#else
+/// <summary>
+/// Toggle the status LED and arm the next toggle at the blink rate as it is now
+/// </summary>
+static void led_expired(void)
+{
+	static bool led_lit = false;
+
+	// one port write lights the current colour and turns off the one it replaced
+	led_lit = !led_lit;
+	gpio_port_write(&rgb_led, led_lit ? RGB_LED_OFF & ~(1u << current_led) : RGB_LED_OFF);
+	watchdog_check_in(led_watchdog);
+
+	rtos_timer_start(&led_timer, (uint32_t)blinkIntervalsMs[blinkIntervalIndex]);
+}
+
+/// <summary>
+/// LED pins are requested once and held, the blink only writes levels
+/// </summary>
+static int open_status_led(void)
+{
+	return gpio_port_open_output(&rgb_led, rgb_led_pins, sizeof(rgb_led_pins) / sizeof(rgb_led_pins[0]), RGB_LED_OFF);
+}
+#endif // LED_PWM_CONTROLLER
+
+/// <summary>
+/// Button A steps the blink rate, the A7 app hears of both presses and of the new rate
+/// </summary>
+static void button_a_pressed(void)
+{
+	LP_INTER_CORE_BLOCK event = { .cmd = LP_IC_EVENT_BUTTON_A };
+
+	blinkIntervalIndex = (blinkIntervalIndex + 1) % numBlinkIntervals;
+	update_status_led();
+
+	inter_core_link_send(&event);
+	event.cmd = LP_IC_BLINK_RATE;		// one record on the stack, the timer task's is small
+	event.blinkRate = blinkIntervalIndex;
+	inter_core_link_send(&event);
+}
+
+static void button_b_pressed(void)
+{
+	inter_core_link_send(&(LP_INTER_CORE_BLOCK){ .cmd = LP_IC_EVENT_BUTTON_B });
+}
+
+#if ! defined(OEM_SEEED_STUDIO_MINI)
+/// <summary>
+/// EINT interrupt for a debounced button press, hands the button to button_task
+/// </summary>
+static void button_interrupt_handler(int button)
+{
+	rtos_queue_send_isr(&button_queue, &button);
+}
+
+static void button_task(void)
+{
+	static const os_hal_gpio_pin buttons[] = { [BUTTON_INDEX_A] = BUTTON_A, [BUTTON_INDEX_B] = BUTTON_B };
+	int button;
+
+	if (buttons_open(buttons, sizeof(buttons) / sizeof(buttons[0]), BUTTON_DEBOUNCE, button_interrupt_handler) != 0)
+	{
+		return;
+	}
+
+	while (true)
+	{
+		// blocks until a press, idle buttons cost no wakeups
+		if (rtos_queue_receive(&button_queue, &button, RTOS_WAIT_FOREVER) != 0)
+		{
+			continue;
+		}
+
+		if (button == BUTTON_INDEX_A)
+		{
+			button_a_pressed();
+		}
+
+		if (button == BUTTON_INDEX_B)
+		{
+			button_b_pressed();
+		}
+	}
+}
+#else
+/// <summary>
+/// The Seeed Studio Mini has no buttons, press A and B in turn every VIRTUAL_BUTTON_MS from a periodic timer
+/// </summary>
+static void virtual_button_expired(void)
+{
+	static bool toggle = false;
+
+	if (toggle)
+	{
+		button_a_pressed();
+	}
+	else
+	{
+		button_b_pressed();
+	}
+
+	toggle = !toggle;
+	watchdog_check_in(button_watchdog);
+}
+#endif // OEM_SEEED_STUDIO_MINI
+
+#ifdef OEM_AVNET
+#ifdef LSM6DSO_INT1
+/// <summary>
+/// LSM6DSO INT1, raised when the FIFO reaches IMU_FIFO_WATERMARK words
+/// </summary>
+static void imu_interrupt_handler(void)
+{
+	rtos_event_set_isr(&imu_event, IMU_FIFO_FLAG);
+}
+#else
+/// <summary>
+/// Sample clock tick, runs from the GPT3 interrupt once per watermark period
+/// </summary>
+static void imu_clock_tick(uint32_t stamp_us)
+{
+	rtos_event_set_isr(&imu_event, IMU_FIFO_FLAG);
+}
+
+/// <summary>
+/// Send the sample clock's jitter histogram since the last report to the A7, once per IMU_JITTER_REPORT_MS
+/// </summary>
+static void report_imu_jitter(void)
+{
+	sample_clock_stats stats;
+	LP_INTER_CORE_BLOCK block = { .cmd = LP_IC_SAMPLE_JITTER };
+
+	sample_clock_stats_take(&stats);
+	block.jitterPeriodUs = stats.period_us;
+	block.jitterIntervals = stats.intervals;
+	block.jitterMissed = stats.missed;
+	block.jitterMinErrorUs = stats.min_error_us;
+	block.jitterMaxErrorUs = stats.max_error_us;
+	block.jitterMaxLateUs = stats.max_late_us;
+	memcpy(block.jitterHistogram, stats.histogram, sizeof(block.jitterHistogram));
+	inter_core_link_send(&block);
+
+	printf("imu clock %u intervals, error %d to %d us, %u us latest, %u missed\n", (unsigned)stats.intervals,
+		(int)stats.min_error_us, (int)stats.max_error_us, (unsigned)stats.max_late_us, (unsigned)stats.missed);
+}
+#endif // LSM6DSO_INT1
+
+/// <summary>
+/// Drain the IMU FIFO into a sample block in DMA bursts, sleeping while each burst is on the bus. The bursts go
+/// ahead of the sensor task's reads, this task asks at a higher priority. Returns the sample count, or -1 on a bus error
+/// </summary>
+static int read_imu_block(lsm6dso_sample* imu_block)
+{
+	int level, burst, count = 0;
+
+	level = lsm6dso_fifo_level();
+	if (level < 0)
+	{
+		return -1;
+	}
+
+	while (level > 0 && count < IMU_BLOCK_SAMPLES)
+	{
+		burst = level < IMU_BURST_WORDS ? level : IMU_BURST_WORDS;
+		if (burst > IMU_BLOCK_SAMPLES - count)
+		{
+			burst = IMU_BLOCK_SAMPLES - count;
+		}
+
+		// every read of the FIFO takes words out of it, so it is never merged with another
+		if (i2c_bus_read(i2c_lsm6dso_addr, LSM6DSO_FIFO_DATA_OUT_TAG, imu_words, (uint16_t)(burst * LSM6DSO_FIFO_WORD_SIZE),
+			I2C_BUS_PRIORITY_CALLER, I2C_BUS_NO_MERGE) != 0)
+		{
+			return -1;
+		}
+		level -= burst;
+
+		count += lsm6dso_fifo_decode(imu_words, burst, &imu_block[count], IMU_BLOCK_SAMPLES - count);
+	}
+
+	return count;
+}
+
+/// <summary>
+/// An event rule became active or cleared, the A7 app forwards the event rather than every reading
+/// </summary>
+static void rule_event_handler(uint8_t rule, uint8_t channel, bool active, float value)
+{
+	inter_core_link_stream(&(LP_INTER_CORE_BLOCK){ .cmd = LP_IC_RULE_EVENT, .ruleId = rule, .telemetryChannel = channel,
+		.ruleActive = active, .ruleValue = value, .stamped = 1, .stampUs = imu_stamp_us });
+}
+
+/// <summary>
+/// Fold one sample into the channel's window, a completed window goes to the A7 app as one summary record.
+/// The event rules of the channel are evaluated on the same sample
+/// </summary>
+static void aggregate_telemetry(LP_IC_TELEMETRY_CHANNEL channel, float value)
+{
+	telemetry_summary summary;
+
+	event_rules_evaluate((uint8_t)channel, value, rule_event_handler);
+
+	if (telemetry_window_add(&telemetry_windows[channel], value, &summary))
+	{
+		inter_core_link_stream(&(LP_INTER_CORE_BLOCK){ .cmd = LP_IC_TELEMETRY_SUMMARY, .telemetryChannel = (uint8_t)channel,
+			.telemetrySamples = summary.samples, .telemetryMin = summary.min, .telemetryMax = summary.max,
+			.telemetryMean = summary.mean, .telemetryStdDev = summary.stddev, .telemetryLast = summary.last,
+			.stamped = 1, .stampUs = imu_stamp_us });
+	}
+}
+
+/// <summary>
+/// Score the feature window the DSP stage closed, if it closed one. The A7 app hears of the score on every change of
+/// the anomaly state and once per ANOMALY_REPORT_MS between, the highest of the windows since the last record
+/// </summary>
+static void score_anomaly(void)
+{
+	imu_dsp_result axis;
+	float features[ANOMALY_MODEL_FEATURES];
+	anomaly_result result;
+
+	if (imu_dsp_result_get(IMU_DSP_ACCEL_X, &axis) != 0 || axis.windows == anomaly_window)
+	{
+		return;
+	}
+	anomaly_window = axis.windows;
+
+	for (int channel = IMU_DSP_ACCEL_X; channel <= IMU_DSP_ACCEL_Z; channel++)
+	{
+		imu_dsp_result_get((imu_dsp_channel)channel, &axis);
+		features[channel - IMU_DSP_ACCEL_X] = axis.rms;
+		features[3 + channel - IMU_DSP_ACCEL_X] = axis.band_rms;
+	}
+
+#ifdef ANOMALY_MODEL_CAPTURE
+	// training windows for tools/anomaly-model, hundredths of mg
+	printf("anomaly features %d %d %d %d %d %d\n", (int)(features[0] * 100), (int)(features[1] * 100), (int)(features[2] * 100),
+		(int)(features[3] * 100), (int)(features[4] * 100), (int)(features[5] * 100));
+#endif // ANOMALY_MODEL_CAPTURE
+
+	if (anomaly_model_score(features, ANOMALY_MODEL_FEATURES, &result) != 0)
+	{
+		return;
+	}
+
+	if (anomaly_windows == 0 || result.score > anomaly_peak)
+	{
+		anomaly_peak = result.score;
+	}
+	if (anomaly_windows < UINT16_MAX)
+	{
+		anomaly_windows++;
+	}
+
+	if (result.changed || anomaly_report_due || rtos_time_ms() - anomaly_last_report >= ANOMALY_REPORT_MS)
+	{
+		inter_core_link_stream(&(LP_INTER_CORE_BLOCK){ .cmd = LP_IC_ANOMALY_SCORE, .anomalyActive = result.active,
+			.anomalyModel = result.version, .anomalyWindows = anomaly_windows, .anomalyScore = result.changed ? result.score : anomaly_peak,
+			.anomalyThreshold = result.threshold, .stamped = 1, .stampUs = imu_stamp_us });
+		anomaly_report_due = false;
+		anomaly_windows = 0;
+		anomaly_last_report = rtos_time_ms();
+	}
+}
+
+/// <summary>
+/// Filter one block of IMU samples, the RMS deviation of the acceleration magnitude tracks vibration.
+/// What is sent is stamped with the time of the sample behind it, counted back from the drain at stamp_us
+/// </summary>
+static void process_imu_block(const lsm6dso_sample* samples, int count, uint32_t stamp_us, uint16_t odr_hz)
+{
+	float magnitude, sum = 0, sum_squares = 0, mean;
+	uint32_t sample_us = 1000000 / odr_hz;
+
+	for (int i = 0; i < count; i++)
+	{
+		imu_stamp_us = stamp_us - (uint32_t)(count - 1 - i) * sample_us;
+		magnitude = sqrtf(samples[i].acceleration_mg[0] * samples[i].acceleration_mg[0] +
+			samples[i].acceleration_mg[1] * samples[i].acceleration_mg[1] +
+			samples[i].acceleration_mg[2] * samples[i].acceleration_mg[2]);
+		sum += magnitude;
+		sum_squares += magnitude * magnitude;
+
+		imu_fusion_update(&fusion, samples[i].angular_rate_dps, samples[i].acceleration_mg);
+		if (--orientation_countdown == 0)
+		{
+			orientation_countdown = orientation_decimation;
+			inter_core_link_stream(&(LP_INTER_CORE_BLOCK){ .cmd = LP_IC_ORIENTATION,
+				.orientation = { fusion.q[0], fusion.q[1], fusion.q[2], fusion.q[3] }, .stamped = 1, .stampUs = imu_stamp_us });
+		}
+
+		aggregate_telemetry(LP_IC_CHANNEL_ACCELERATION, magnitude);
+		aggregate_telemetry(LP_IC_CHANNEL_ANGULAR_RATE, sqrtf(samples[i].angular_rate_dps[0] * samples[i].angular_rate_dps[0] +
+			samples[i].angular_rate_dps[1] * samples[i].angular_rate_dps[1] +
+			samples[i].angular_rate_dps[2] * samples[i].angular_rate_dps[2]));
+	}
+
+	mean = sum / count;
+	vibration_rms_mg = sqrtf(fmaxf(sum_squares / count - mean * mean, 0));
+
+	imu_dsp_process(samples, count);
+	score_anomaly();
+}
+
+/// <summary>
+/// Print the signal processing cost, the vertical vibration and the tilt, once per IMU_DSP_REPORT_MS
+/// </summary>
+static void report_imu_dsp(void)
+{
+	imu_dsp_result z;
+	float roll, pitch, yaw;
+
+	if (imu_dsp_result_get(IMU_DSP_ACCEL_Z, &z) == 0)
+	{
+		printf("imu dsp %u cycles/sample, z rms %d mg, %d Hz band %d mg\n", (unsigned)imu_dsp_cycles_per_sample(),
+			(int)z.rms, (int)IMU_DSP_BAND_HZ, (int)z.band_rms);
+	}
+
+	imu_fusion_euler(&fusion, &roll, &pitch, &yaw);
+	printf("imu roll %d, pitch %d, yaw %d degrees\n", (int)roll, (int)pitch, (int)yaw);
+	printf("anomaly model %u, %u cycles/window\n", (unsigned)anomaly_model_version(), (unsigned)anomaly_model_cycles());
+}
+
+/// <summary>
+/// Decide the relay on the temperature the FIFO batched with the block just read, NAN when the read failed, so the
+/// relay follows the temperature within a block rather than a cloud round trip. The A7 app hears of every switch
+/// </summary>
+static void control_temperature(float temperature, uint32_t stamp_us)
+{
+	thermostat_state state;
+
+	thermostat_update(temperature, rtos_time_ms(), &state);
+
+	if (state.relay != thermostat_relay_closed)
+	{
+#ifdef THERMOSTAT_RELAY
+		gpio_pin_set(&thermostat_relay, state.relay ? OS_HAL_GPIO_DATA_HIGH : OS_HAL_GPIO_DATA_LOW);
+#endif // THERMOSTAT_RELAY
+		thermostat_relay_closed = state.relay;
+	}
+	else if (state.mode == LP_IC_THERMOSTAT_OFF || rtos_time_ms() - thermostat_last_report < THERMOSTAT_REPORT_MS)
+	{
+		return;
+	}
+
+	inter_core_link_send(&(LP_INTER_CORE_BLOCK){ .cmd = LP_IC_THERMOSTAT_STATUS, .thermostatMode = (uint8_t)state.mode,
+		.thermostatRelay = state.relay, .temperature = state.temperature, .thermostatSetpoint = state.setpoint,
+		.thermostatOutput = state.output, .stamped = 1, .stampUs = stamp_us });
+	thermostat_last_report = rtos_time_ms();
+}
+
+/// <summary>
+/// Set the FIFO to the policy inter_core_handler last took and send the A7 the policy as set. The watermark is
+/// held to IMU_WATERMARK_SAMPLES and to a quarter of IMU_DEADLINE_MS of samples, so a slow rate still drains in time
+/// </summary>
+static void apply_imu_policy(void)
+{
+	uint16_t words_per_sample, samples;
+	uint8_t gyro;
+
+	imu_policy_applied = imu_policy_requested;
+	imu_odr_hz = lsm6dso_fifo_rate(imu_policy_odr_hz);
+	gyro = imu_policy_gyro != 0 && imu_odr_hz != 0;
+	words_per_sample = gyro ? 2 : 1;
+
+	samples = (imu_policy_watermark != 0 ? imu_policy_watermark : IMU_FIFO_WATERMARK) / words_per_sample;
+	if (samples > IMU_WATERMARK_SAMPLES)
+	{
+		samples = IMU_WATERMARK_SAMPLES;
+	}
+	if (samples > imu_odr_hz * IMU_DEADLINE_MS / 4000)
+	{
+		samples = (uint16_t)(imu_odr_hz * IMU_DEADLINE_MS / 4000);
+	}
+	if (samples == 0)
+	{
+		samples = 1;
+	}
+
+#ifndef LSM6DSO_INT1
+	sample_clock_stop();
+#endif // LSM6DSO_INT1
+
+	if (lsm6dso_fifo_init(imu_odr_hz, (uint16_t)(samples * words_per_sample), gyro) != 0)
+	{
+		imu_odr_hz = 0;
+	}
+	imu_wait_ms = imu_odr_hz != 0 ? (uint32_t)samples * 1000 / imu_odr_hz : IMU_DEADLINE_MS / 2;
+
+#ifndef LSM6DSO_INT1
+	// GPT3 wakes the task once per watermark period, on time whatever the scheduler did
+	if (imu_odr_hz != 0 && sample_clock_start(imu_wait_ms * 1000, imu_clock_tick) != 0)
+	{
+		imu_odr_hz = 0;
+	}
+#endif // LSM6DSO_INT1
+
+	inter_core_link_send(&(LP_INTER_CORE_BLOCK){ .cmd = LP_IC_SENSOR_POLICY, .policyOdrHz = imu_odr_hz,
+		.policyWatermark = imu_odr_hz != 0 ? (uint16_t)(samples * words_per_sample) : 0, .policyGyro = gyro });
+	printf("imu policy %u Hz, watermark %u samples, gyro %s\n", (unsigned)imu_odr_hz, (unsigned)samples, gyro ? "on" : "off");
+}
+
+/// <summary>
+/// Drain the IMU FIFO into the free sample blocks and hand each one to imu_aggregate_task, so the FIFO is read
+/// on time whatever the filters cost
+/// </summary>
+static void imu_sample_task(void)
+{
+	int block;
+
+	// the IMU batches samples in its FIFO, this task wakes once per block rather than once per sample. The bus task
+	// owns the I2C controller, the driver's reads and writes wait their turn for it
+	if (lsm6dso_init(i2c_write, i2c_read) != 0)
+	{
+		return;
+	}
+
+#ifdef LSM6DSO_INT1
+	if (gpio_pin_open_input(&imu_int1, LSM6DSO_INT1) != 0 ||
+		mtk_os_hal_eint_register((eint_number)LSM6DSO_INT1, HAL_EINT_EDGE_RISING, imu_interrupt_handler) < 0)
+	{
+		return;
+	}
+#else
+	// INT1 is not wired to a GPIO, apply_imu_policy starts GPT3 at the watermark period instead
+	uint32_t last_report = rtos_time_ms();
+#endif // LSM6DSO_INT1
+
+#ifdef THERMOSTAT_RELAY
+	if (gpio_pin_open_output(&thermostat_relay, THERMOSTAT_RELAY, OS_HAL_GPIO_DATA_LOW) != 0)
+	{
+		return;
+	}
+#endif // THERMOSTAT_RELAY
+
+	while (true)
+	{
+		if (imu_policy_applied != imu_policy_requested)
+		{
+			apply_imu_policy();
+		}
+
+		// powered down, nothing to drain until the next policy
+		if (imu_odr_hz == 0)
+		{
+			rtos_event_wait(&imu_event, IMU_POLICY_FLAG, imu_wait_ms);
+			watchdog_check_in(imu_sample_watchdog);
+			continue;
+		}
+
+		// sleeps while both blocks are with imu_aggregate_task, the FIFO holds the samples meanwhile
+		if (rtos_queue_receive(&imu_free_queue, &block, RTOS_WAIT_FOREVER) != 0)
+		{
+			continue;
+		}
+
+		rtos_event_wait(&imu_event, IMU_FIFO_FLAG, 2 * imu_wait_ms);	// the timeout recovers a missed edge or tick
+
+		imu_blocks[block].stamp_us = sample_clock_now_us();
+		imu_blocks[block].odr_hz = imu_odr_hz;
+		imu_blocks[block].count = read_imu_block(imu_blocks[block].samples);
+		control_temperature(imu_blocks[block].count > 0 ? get_temperature() : NAN, imu_blocks[block].stamp_us);
+		watchdog_check_in(imu_sample_watchdog);
+		if (imu_blocks[block].count <= 0 || rtos_queue_send(&imu_full_queue, &block) != 0)
+		{
+			rtos_queue_send(&imu_free_queue, &block);
+		}
+
+#ifndef LSM6DSO_INT1
+		if (rtos_time_ms() - last_report >= IMU_JITTER_REPORT_MS)
+		{
+			last_report = rtos_time_ms();
+			report_imu_jitter();
+		}
+#endif // LSM6DSO_INT1
+	}
+}
+
+/// <summary>
+/// Filters, fusion and rules are set for the sample rate, set again when a block comes at a new one
+/// </summary>
+static void configure_imu_processing(uint16_t odr_hz)
+{
+	processing_odr_hz = odr_hz;
+	imu_dsp_init(odr_hz);
+	imu_fusion_init(&fusion, odr_hz, IMU_FUSION_BETA);
+	event_rules_init(odr_hz);
+	for (int channel = IMU_DSP_ACCEL_X; channel <= IMU_DSP_ACCEL_Z; channel++)
+	{
+		imu_dsp_configure((imu_dsp_channel)channel, IMU_DSP_STAGES, IMU_DSP_TILT_CUTOFF_HZ, IMU_DSP_BAND_HZ);
+	}
+
+	orientation_decimation = odr_hz > IMU_ORIENTATION_HZ ? odr_hz / IMU_ORIENTATION_HZ : 1;
+	orientation_countdown = orientation_decimation;
+}
+
+/// <summary>
+/// Windows are counted in samples, scale them with the rate so a summary still covers the same time
+/// </summary>
+static void rescale_telemetry_windows(uint16_t from_hz, uint16_t to_hz)
+{
+	for (int channel = 0; channel < LP_IC_CHANNEL_COUNT; channel++)
+	{
+		uint32_t window = telemetry_windows[channel].window * (uint32_t)to_hz / from_hz;
+
+		if (telemetry_windows[channel].window == 0)
+		{
+			continue;	// the channel is off
+		}
+		telemetry_window_set(&telemetry_windows[channel], window == 0 ? 1 : window > TELEMETRY_WINDOW_MAX ? TELEMETRY_WINDOW_MAX : (uint16_t)window);
+	}
+}
+
+/// <summary>
+/// Filter, fuse and aggregate the sample blocks from imu_sample_task, the results are streamed to the link task
+/// a block at a time
+/// </summary>
+static void imu_aggregate_task(void)
+{
+	int block;
+
+	for (int channel = 0; channel < LP_IC_CHANNEL_COUNT; channel++)
+	{
+		telemetry_window_init(&telemetry_windows[channel], IMU_TELEMETRY_WINDOW);
+	}
+
+	configure_imu_processing(LSM6DSO_FIFO_ODR_HZ);
+	uint32_t last_report = rtos_time_ms();
+	anomaly_last_report = last_report;
+
+	while (true)
+	{
+		// the timeout keeps the watchdog fed while the IMU is powered down
+		if (rtos_queue_receive(&imu_full_queue, &block, IMU_DEADLINE_MS / 2) != 0)
+		{
+			watchdog_check_in(imu_aggregate_watchdog);
+			continue;
+		}
+
+		if (imu_blocks[block].odr_hz != processing_odr_hz)
+		{
+			rescale_telemetry_windows(processing_odr_hz, imu_blocks[block].odr_hz);
+			configure_imu_processing(imu_blocks[block].odr_hz);
+		}
+
+		process_imu_block(imu_blocks[block].samples, imu_blocks[block].count, imu_blocks[block].stamp_us,
+			imu_blocks[block].odr_hz);
+		rtos_queue_send(&imu_free_queue, &block);
+		inter_core_link_flush();	// what the block produced goes out together, the link task wakes once for it
+		watchdog_check_in(imu_aggregate_watchdog);
+
+		if (rtos_time_ms() - last_report >= IMU_DSP_REPORT_MS)
+		{
+			last_report = rtos_time_ms();
+			report_imu_dsp();
+		}
+	}
+}
+#endif // OEM_AVNET
+
+#ifdef ADC_CONTROLLER
+/// <summary>
+/// Sample the ADC channels continuously, the A7 asks for summaries of the buffered samples over inter-core
+/// </summary>
+static void adc_task(void)
+{
+	if (adc_sampler_open(ADC_CHANNELS) != 0)
+	{
+		return;
+	}
+
+	while (true)
+	{
+		watchdog_check_in(adc_watchdog);
+
+		// sleeps on the ADC FIFO interrupt between batches on FreeRTOS
+		if (adc_sampler_poll() < 0)
+		{
+			rtos_delay(ADC_RETRY_MS);
+		}
+	}
+}
+#endif // ADC_CONTROLLER
+
+#ifdef AUDIO_I2S_PORT
+/// <summary>
+/// I2S DMA completion of a period, runs from the DMA interrupt and hands the period to audio_task
+/// </summary>
+static void audio_period_done(int period)
+{
+	if (rtos_queue_send_isr(&audio_queue, &period) != 0)
+	{
+		audio_frames_lost++;
+	}
+}
+
+static void send_audio_features(uint16_t period_ms)
+{
+	audio_feature_vector features;
+	LP_INTER_CORE_BLOCK block = { .cmd = LP_IC_AUDIO_FEATURES, .stamped = 1, .stampUs = sample_clock_now_us() };	// the period just ended
+
+	if (audio_features_take(&features) != 0)
+	{
+		return;
+	}
+
+	block.audioPeriodMs = period_ms;
+	block.audioFrames = features.frames;
+	block.audioRmsDbfs = features.rms_dbfs;
+	block.audioPeakDbfs = features.peak_dbfs;
+	memcpy(block.audioBandDbfs, features.band_dbfs, sizeof(block.audioBandDbfs));
+	inter_core_link_send(&block);
+}
+
+/// <summary>
+/// Capture audio while the A7 app asks for it and reduce every frame to its levels, only one feature vector
+/// per period crosses to the A7
+/// </summary>
+static void audio_task(void)
+{
+	int period;
+	bool capturing = false;
+	uint32_t period_start = 0, last_report = rtos_time_ms();
+	audio_feature_vector discarded;
+
+	audio_features_init();
+
+	while (true)
+	{
+		watchdog_check_in(audio_watchdog);
+
+		if (!capturing && audio_period_ms != 0)
+		{
+			// a failed open is retried on the next wakeup
+			capturing = audio_capture_open(AUDIO_I2S_PORT, audio_period_done) == 0;
+			audio_features_take(&discarded);
+			period_start = rtos_time_ms();
+		}
+		else if (capturing && audio_period_ms == 0)
+		{
+			audio_capture_close();
+			capturing = false;
+		}
+
+		if (rtos_queue_receive(&audio_queue, &period, AUDIO_WAIT_MS) == 0 && capturing)
+		{
+			audio_features_frame(audio_capture_frame(period));
+		}
+
+		uint16_t period_ms = audio_period_ms;
+		if (capturing && period_ms != 0 && rtos_time_ms() - period_start >= period_ms)
+		{
+			period_start = rtos_time_ms();
+			send_audio_features(period_ms);
+		}
+
+		if (capturing && rtos_time_ms() - last_report >= AUDIO_REPORT_MS)
+		{
+			last_report = rtos_time_ms();
+			printf("audio %u cycles/frame, %u frames lost\n", (unsigned)audio_features_cycles_per_frame(), (unsigned)audio_frames_lost);
+		}
+	}
+}
+#endif // AUDIO_I2S_PORT
+
+#ifdef SPI_ADC_BUS
+static void spi_adc_block_ready(void)
+{
+	rtos_event_set_isr(&spi_adc_event, SPI_ADC_BLOCK_FLAG);
+}
+
+/// <summary>
+/// Drain the blocks the SPI sampler fills from its interrupts, one wakeup per SPI_SAMPLER_BLOCK samples
+/// </summary>
+static void spi_adc_task(void)
+{
+	const spi_sampler_config config = {
+		.bus = SPI_ADC_BUS,
+		.spi = { .cpol = SPI_CPOL_0, .cpha = SPI_CPHA_1, .rx_mlsb = SPI_MSB, .tx_mlsb = SPI_MSB, .slave_sel = SPI_SELECT_DEVICE_0 },
+		.speed_khz = SPI_ADC_SPEED_KHZ,
+		.opcode = SPI_ADC_OPCODE,
+		.opcode_len = SPI_ADC_OPCODE_LEN,
+		.sample_bytes = SPI_ADC_SAMPLE_BYTES,
+#ifdef SPI_ADC_DATA_READY
+		.trigger = SPI_SAMPLER_TRIGGER_DATA_READY,
+		.data_ready_pin = SPI_ADC_DATA_READY,
+#else
+		.trigger = SPI_SAMPLER_TRIGGER_TIMER,
+		.rate_hz = SPI_ADC_RATE_HZ,
+#endif // SPI_ADC_DATA_READY
+	};
+	const uint8_t* block;
+	spi_sampler_stats stats, last_stats = { 0 };
+	int32_t value, min = INT32_MAX, max = INT32_MIN;
+	uint32_t last_report = rtos_time_ms();
+
+	if (spi_sampler_open(&config, spi_adc_block_ready) != 0 || spi_sampler_start() != 0)
+	{
+		return;
+	}
+
+	while (true)
+	{
+		rtos_event_wait(&spi_adc_event, SPI_ADC_BLOCK_FLAG, SPI_ADC_WAIT_MS);
+		watchdog_check_in(spi_adc_watchdog);
+
+		while ((block = spi_sampler_block_get()) != NULL)
+		{
+			for (int i = 0; i < SPI_SAMPLER_BLOCK; i++)
+			{
+				value = spi_sampler_value(block, i);
+				min = value < min ? value : min;
+				max = value > max ? value : max;
+			}
+			spi_sampler_block_release();
+		}
+
+		if (rtos_time_ms() - last_report >= SPI_ADC_REPORT_MS)
+		{
+			spi_sampler_stats_get(&stats);
+			printf("spi adc %u samples/s, %u missed, %u overruns, %u errors, min %d, max %d\n",
+				(unsigned)((stats.samples - last_stats.samples) * 1000 / (rtos_time_ms() - last_report)),
+				(unsigned)(stats.missed - last_stats.missed), (unsigned)(stats.overruns - last_stats.overruns),
+				(unsigned)(stats.errors - last_stats.errors), (int)min, (int)max);
+			last_stats = stats;
+			last_report = rtos_time_ms();
+			min = INT32_MAX;
+			max = INT32_MIN;
+		}
+	}
+}
+#endif // SPI_ADC_BUS
+
+#ifdef MODBUS_UART_PORT
+static void modbus_frame_ready(void)
+{
+	rtos_event_set_isr(&modbus_event, MODBUS_FRAME_FLAG);
+}
+
+/// <summary>
+/// One read holding registers round trip for a batch, returns an LP_IC_MODBUS_STATUS or the slave's exception code
+/// </summary>
+static int modbus_transact(const modbus_batch* batch, uint16_t* values)
+{
+	uint8_t request[MODBUS_REQUEST_BYTES];
+	const uart_frame* frame;
+	uint32_t start, elapsed;
+	int status = LP_IC_MODBUS_TIMEOUT;
+
+	if (modbus_read_request(request, batch) < 0)
+	{
+		return LP_IC_MODBUS_BAD_RESPONSE;
+	}
+
+	uart_frames_flush();
+	rtos_event_wait(&modbus_event, MODBUS_FRAME_FLAG, 0);
+#ifdef MODBUS_DE_PIN
+	gpio_pin_set(&modbus_de, OS_HAL_GPIO_DATA_HIGH);
+#endif // MODBUS_DE_PIN
+	uart_frames_write(request, sizeof(request));
+#ifdef MODBUS_DE_PIN
+	while (!uart_frames_tx_done())
+	{
+		rtos_delay(1);
+	}
+	gpio_pin_set(&modbus_de, OS_HAL_GPIO_DATA_LOW);
+#endif // MODBUS_DE_PIN
+
+	start = rtos_time_ms();
+	while (status == LP_IC_MODBUS_TIMEOUT && (elapsed = rtos_time_ms() - start) < MODBUS_RESPONSE_MS)
+	{
+		rtos_event_wait(&modbus_event, MODBUS_FRAME_FLAG, MODBUS_RESPONSE_MS - elapsed);
+
+		while (status == LP_IC_MODBUS_TIMEOUT && (frame = uart_frames_get()) != NULL)
+		{
+			// a transceiver that hears itself hands back the request first
+			if (frame->length != sizeof(request) || memcmp(frame->data, request, sizeof(request)) != 0)
+			{
+				status = modbus_read_response(frame->data, frame->length, batch, values);
+			}
+			uart_frames_release();
+		}
+	}
+
+	return status;
+}
+
+static void send_modbus_readings(int index, const modbus_poll* poll, int status, const uint16_t* values)
+{
+	LP_INTER_CORE_BLOCK block = { .cmd = LP_IC_MODBUS_READINGS, .modbusPoll = (uint8_t)index, .modbusSlave = poll->slave,
+		.modbusFirst = poll->first, .modbusCount = poll->count, .modbusStatus = (uint8_t)status, .stamped = 1,
+		.stampUs = sample_clock_now_us() };		// the response just arrived
+
+	if (status == LP_IC_MODBUS_OK)
+	{
+		memcpy(block.modbusValues, values, poll->count * sizeof(uint16_t));
+	}
+	inter_core_link_send(&block);
+}
+
+/// <summary>
+/// Read the polls the A7 app sets as they fall due, the polls due together batched into as few requests as the
+/// register map allows, and forward each poll's registers
+/// </summary>
+static void modbus_task(void)
+{
+	const uart_frames_config config = { .port = MODBUS_UART_PORT, .baud = MODBUS_BAUD, .parity = MODBUS_PARITY,
+		.stop_bits = UART_STOP_1_BIT, .idle_us = modbus_gap_us(MODBUS_BAUD) };
+	modbus_poll_update update;
+	uint32_t now, due, wait, requests = 0, failures = 0, last_report = rtos_time_ms();
+	uart_frames_stats stats;
+	int batch_count, status;
+
+	if (uart_frames_open(&config, modbus_frame_ready) != 0)
+	{
+		return;
+	}
+#ifdef MODBUS_DE_PIN
+	gpio_pin_open_output(&modbus_de, MODBUS_DE_PIN, OS_HAL_GPIO_DATA_LOW);
+#endif // MODBUS_DE_PIN
+
+	while (true)
+	{
+		watchdog_check_in(modbus_watchdog);
+
+		while (rtos_queue_receive(&modbus_queue, &update, 0) == 0)
+		{
+			modbus_polls[update.index] = update.poll;
+			modbus_next_due[update.index] = rtos_time_ms();	// read straight away, then every period
+		}
+
+		now = rtos_time_ms();
+		due = 0;
+		wait = MODBUS_WAIT_MS;
+		for (int i = 0; i < MODBUS_POLLS; i++)
+		{
+			if (modbus_polls[i].count == 0)
+			{
+				continue;
+			}
+			if ((int32_t)(now - modbus_next_due[i]) >= 0)
+			{
+				due |= 1u << i;
+				modbus_next_due[i] = now + modbus_polls[i].period_ms;
+			}
+			else if (modbus_next_due[i] - now < wait)
+			{
+				wait = modbus_next_due[i] - now;
+			}
+		}
+
+		batch_count = modbus_batch_plan(modbus_polls, due, modbus_batches);
+		for (int b = 0; b < batch_count; b++)
+		{
+			status = modbus_transact(&modbus_batches[b], modbus_values);
+			requests++;
+			failures += status != LP_IC_MODBUS_OK;
+
+			for (int i = 0; i < MODBUS_POLLS; i++)
+			{
+				if (modbus_batches[b].polls & (1u << i))
+				{
+					send_modbus_readings(i, &modbus_polls[i], status, &modbus_values[modbus_polls[i].first - modbus_batches[b].first]);
+				}
+			}
+			watchdog_check_in(modbus_watchdog);
+		}
+
+		if (rtos_time_ms() - last_report >= MODBUS_REPORT_MS)
+		{
+			uart_frames_stats_get(&stats);
+			printf("modbus %u requests, %u failed, %u frames, %u dropped, %u truncated\n", (unsigned)requests, (unsigned)failures,
+				(unsigned)stats.frames, (unsigned)stats.dropped, (unsigned)stats.truncated);
+			last_report = rtos_time_ms();
+		}
+
+		if (batch_count == 0)
+		{
+			rtos_event_wait(&modbus_event, MODBUS_POLL_FLAG, wait);
+		}
+	}
+}
+#endif // MODBUS_UART_PORT
+
+/// <summary>
+/// Answer the sensor reading requests the inter-core task forwards, and keep the status LED on the desired temperature
+/// </summary>
+static void sensor_task(void)
+{
+	sensor_request request;
+	int desired_temperature = 0;
+	int last_temperature = 0;
+	int rand_number;
+
+	srand((unsigned int)time(NULL)); // seed the random number generator for fake telemetry
+
+	while (true)
+	{
+		if (rtos_queue_receive(&sensor_queue, &request, RTOS_WAIT_FOREVER) != 0)
+		{
+			continue;
+		}
+
+		if (request.cmd == LP_IC_SET_DESIRED_TEMPERATURE)
+		{
+			desired_temperature = request.temperature;
+			set_temperature_status(last_temperature, desired_temperature);
+			continue;
+		}
+
+		LP_INTER_CORE_BLOCK reading = { .cmd = LP_IC_TEMPERATURE_PRESSURE_HUMIDITY, .sequence = request.sequence };
+
+		if (request.traced)
+		{
+			reading.traced = 1;
+			reading.traceSampleUs = inter_core_link_trace_stamp();		// turned into an interval when the frame is written
+			reading.traceWaitUs = inter_core_link_trace_us(request.received);
+		}
+
+#ifdef OEM_AVNET
+
+		reading.temperature = get_temperature();
+
+		rand_number = (rand() % 20) - 10;
+		reading.humidity = (float)(50.0 + rand_number);
+
+		rand_number = (rand() % 50) - 25;
+		reading.pressure = (float)(1000.0 + rand_number);
+
+#endif // OEM_AVNET
+
+		// The Seeed Studio Developer boards do not include any sensors so create some fake telemetry
+#if ! defined(OEM_AVNET)
+
+		rand_number = (rand() % 10) - 5;
+		reading.temperature = (float)(25.0 + rand_number);
+
+		rand_number = (rand() % 20) - 10;
+		reading.humidity = (float)(50.0 + rand_number);
+
+		rand_number = (rand() % 50) - 25;
+		reading.pressure = (float)(1000.0 + rand_number);
+
+#endif // OEM_SEEED_STUDIO
+
+		reading.stamped = 1;
+		reading.stampUs = sample_clock_now_us();
+		inter_core_link_send(&reading);
+
+		last_temperature = round(reading.temperature);
+		set_temperature_status(last_temperature, desired_temperature);
+	}
+}
+
+/// <summary>
+/// Report CPU share and stack high-water mark per task when the A7 app asks and every period after
+/// </summary>
+static void diagnostics_task(void)
+{
+	while (true)
+	{
+		uint16_t period = profile_period;
+
+		rtos_event_wait(&diagnostics_event, DIAGNOSTICS_REQUEST_FLAG, period == 0 ? RTOS_WAIT_FOREVER : period * 1000u);
+		rtos_profile_report(inter_core_link_send);
+		rtcore_app_report_memory();
+#ifdef OEM_AVNET
+		i2c_bus_report(inter_core_link_send);
+#endif // OEM_AVNET
+		printf("%u log bytes dropped\n", (unsigned)uart_log_drops());
+	}
+}
+
+/// <summary>
+/// Restart the hardware watchdog while every registered task keeps checking in, and tell the A7 app why the core
+/// last reset and which task is about to reset it
+/// </summary>
+static void watchdog_task(void)
+{
+	LP_INTER_CORE_BLOCK report = { .cmd = LP_IC_WATCHDOG, .watchdogReset = watchdog_reset_cause() };
+	const char* late;
+	bool reported = false;
+
+	inter_core_link_send(&report);		// held by the link until the A7 app first writes
+
+	while (true)
+	{
+		rtos_delay(WATCHDOG_SUPERVISE_MS);
+
+		late = watchdog_supervise();
+		if (late == NULL)
+		{
+			reported = false;
+		}
+		else if (!reported)
+		{
+			printf("%s missed its watchdog deadline\n", late);
+			strncpy(report.watchdogTask, late, LP_IC_THREAD_NAME_SIZE - 1);
+			inter_core_link_send(&report);		// best effort, the link task may be the one that is stuck
+			reported = true;
+		}
+	}
+}
+
+/// <summary>
+/// A control request from the A7 app's latency benchmark, lp_controlLatencyRequest, answered as soon as it is applied.
+/// The probe pin toggles at that moment, the trace trailer carries arrival to applied and applied to the frame write
+/// </summary>
+static void control_applied(const LP_INTER_CORE_BLOCK* received, uint32_t arrived)
+{
+	LP_INTER_CORE_BLOCK response = *received;	// the sequence echoed
+
+#ifdef CONTROL_PROBE_PIN
+	gpio_pin_toggle(&control_probe);
+#endif // CONTROL_PROBE_PIN
+
+	if (received->traced)
+	{
+		response.traceSampleUs = inter_core_link_trace_stamp();		// turned into an interval when the frame is written
+		response.traceWaitUs = inter_core_link_trace_us(arrived);
+	}
+	inter_core_link_send(&response);
+}
+
+/// <summary>
+/// One record from the A7 app, runs in the inter-core task so anything slow is handed to another task
+/// </summary>
+static void inter_core_handler(const LP_INTER_CORE_BLOCK* received)
+{
+	uint32_t arrived = received->traced ? inter_core_link_trace_stamp() : 0;
+
+	switch (received->cmd)
+	{
+	case LP_IC_HEARTBEAT:
+		break;
+	case LP_IC_SET_DESIRED_TEMPERATURE:
+		// sensor_task owns the temperatures behind the status LED
+		rtos_queue_send(&sensor_queue, &(sensor_request){ .cmd = LP_IC_SET_DESIRED_TEMPERATURE, .temperature = (int32_t)round(received->temperature) });
+#ifdef OEM_AVNET
+		thermostat_set_point(received->temperature);
+#endif // OEM_AVNET
+		break;
+	case LP_IC_THERMOSTAT:
+#ifdef OEM_AVNET
+		if (thermostat_configure(&(thermostat_config){ .mode = (LP_IC_THERMOSTAT_MODE)received->thermostatMode,
+			.cooling = received->thermostatCooling != 0, .hysteresis = received->thermostatHysteresis, .kp = received->thermostatGains[0],
+			.ki = received->thermostatGains[1], .kd = received->thermostatGains[2], .window_ms = received->thermostatWindowMs }) != 0)
+		{
+			printf("thermostat settings refused\n");
+		}
+#endif // OEM_AVNET
+		break;
+	case LP_IC_BLINK_RATE:
+		blinkIntervalIndex = received->blinkRate % numBlinkIntervals;
+		update_status_led();
+		if (received->sequence != 0)
+		{
+			control_applied(received, arrived);		// a request, only the benchmark asks for an answer
+		}
+		break;
+	case LP_IC_LED_PATTERN:
+#ifdef LED_PWM_CONTROLLER
+		led_pattern = *received;
+		update_status_led();
+#endif // LED_PWM_CONTROLLER
+		break;
+	case LP_IC_ADC_SUMMARY:
+	{
+		LP_INTER_CORE_BLOCK adc_summary = *received;	// answered here, the request's sequence number is echoed
+#ifdef ADC_CONTROLLER
+		adc_sampler_stats stats;
+
+		if (adc_sampler_summary((adc_channel)adc_summary.adcChannel, adc_summary.adcSamples, &stats) == 0)
+		{
+			adc_summary.adcSamples = stats.samples;
+			adc_summary.adcMin = stats.min;
+			adc_summary.adcMean = stats.mean;
+			adc_summary.adcMax = stats.max;
+		}
+		else
+#endif // ADC_CONTROLLER
+		{
+			adc_summary.adcSamples = 0;	// channel not sampled
+		}
+		inter_core_link_send(&adc_summary);
+		break;
+	}
+	case LP_IC_TELEMETRY_WINDOW:
+#ifdef OEM_AVNET
+		if (received->telemetryChannel < LP_IC_CHANNEL_COUNT)
+		{
+			telemetry_window_set(&telemetry_windows[received->telemetryChannel], received->telemetrySamples);
+		}
+#endif // OEM_AVNET
+		break;
+	case LP_IC_SENSOR_POLICY:
+#ifdef OEM_AVNET
+		imu_policy_odr_hz = received->policyOdrHz;
+		imu_policy_watermark = received->policyWatermark;
+		imu_policy_gyro = received->policyGyro;
+		imu_policy_requested++;
+		rtos_event_set(&imu_event, IMU_POLICY_FLAG);	// imu_sample_task applies it on its next wakeup
+#endif // OEM_AVNET
+		break;
+	case LP_IC_RULE:
+#ifdef OEM_AVNET
+		event_rules_set(received->ruleId, (LP_IC_RULE_KIND)received->ruleKind, received->telemetryChannel,
+			received->ruleThreshold, received->ruleHysteresis);
+#endif // OEM_AVNET
+		break;
+	case LP_IC_AUDIO_CAPTURE:
+#ifdef AUDIO_I2S_PORT
+		audio_period_ms = received->audioPeriodMs;		// audio_task starts or stops capture on its next wakeup
+#endif // AUDIO_I2S_PORT
+		break;
+	case LP_IC_MODBUS_POLL:
+#ifdef MODBUS_UART_PORT
+		if (received->modbusPoll < MODBUS_POLLS && received->modbusCount <= MODBUS_POLL_REGISTERS &&
+			(uint32_t)received->modbusFirst + received->modbusCount <= UINT16_MAX + 1)
+		{
+			modbus_poll_update update = { .index = received->modbusPoll, .poll = { .slave = received->modbusSlave,
+				.first = received->modbusFirst, .count = received->modbusCount,
+				.period_ms = received->modbusPeriodMs > MODBUS_MIN_PERIOD_MS ? received->modbusPeriodMs : MODBUS_MIN_PERIOD_MS } };
+
+			rtos_queue_send(&modbus_queue, &update);
+			rtos_event_set(&modbus_event, MODBUS_POLL_FLAG);
+		}
+#endif // MODBUS_UART_PORT
+		break;
+	case LP_IC_PROFILE_REQUEST:
+		profile_period = received->profilePeriod;
+		rtos_event_set(&diagnostics_event, DIAGNOSTICS_REQUEST_FLAG);		// reports now, then sleeps for the new period
+		break;
+	case LP_IC_TIME_SYNC:
+	{
+		LP_INTER_CORE_BLOCK sync = { .cmd = LP_IC_TIME_SYNC, .sequence = received->sequence, .syncA7Us = received->syncA7Us,
+			.syncRtUs = sample_clock_now_us() };	// answered here, straight away, the A7 halves the round trip
+
+		inter_core_link_send(&sync);
+		break;
+	}
+	case LP_IC_TEMPERATURE_PRESSURE_HUMIDITY:
+		// a full queue drops the request, the A7 app times it out
+		rtos_queue_send(&sensor_queue, &(sensor_request){ .cmd = LP_IC_TEMPERATURE_PRESSURE_HUMIDITY, .sequence = received->sequence,
+			.traced = received->traced, .received = arrived });
+		break;
+	default:
+		break;
+	}
+}
+
+/// <summary>
+/// A direct method the A7 app forwarded, answered from the link task with what it holds, nothing is waited for. The
+/// payload is the method's as the hub sent it, RtStatus takes none. A reply that can not be sent, the previous large
+/// message still going out, is answered by the A7 app's timeout
+/// </summary>
+static void answer_method(const uint8_t* message, uint32_t length)
+{
+	static uint8_t reply[LP_IC_METHOD_RESPONSE_HEADER_SIZE + 160];		// copied by the send
+	char* text = (char*)reply + LP_IC_METHOD_RESPONSE_HEADER_SIZE;
+	uint16_t status = 200;
+	int written = 0;
+
+	if (length < LP_IC_METHOD_HEADER_SIZE)
+	{
+		return;
+	}
+
+	switch ((LP_IC_METHOD_CODE)message[sizeof(uint16_t)])
+	{
+	case LP_IC_METHOD_RT_STATUS:
+#ifdef OEM_AVNET
+		written = snprintf(text, sizeof(reply) - LP_IC_METHOD_RESPONSE_HEADER_SIZE,
+			"{\"uptimeMs\":%u,\"linkDrops\":%u,\"odrHz\":%u,\"gyro\":%u,\"anomalyModel\":%u}", (unsigned)rtos_time_ms(),
+			(unsigned)inter_core_link_drops(), (unsigned)imu_odr_hz, (unsigned)imu_policy_gyro, (unsigned)anomaly_model_version());
+#else
+		written = snprintf(text, sizeof(reply) - LP_IC_METHOD_RESPONSE_HEADER_SIZE, "{\"uptimeMs\":%u,\"linkDrops\":%u}",
+			(unsigned)rtos_time_ms(), (unsigned)inter_core_link_drops());
+#endif // OEM_AVNET
+		break;
+	default:
+		status = 404;		// text, the A7 app quotes it as a JSON string
+		written = snprintf(text, sizeof(reply) - LP_IC_METHOD_RESPONSE_HEADER_SIZE, "Method %u not known", (unsigned)message[sizeof(uint16_t)]);
+		break;
+	}
+
+	if (written < 0 || written >= (int)(sizeof(reply) - LP_IC_METHOD_RESPONSE_HEADER_SIZE))
+	{
+		written = 0;
+		status = 500;
+	}
+
+	memcpy(reply, message, sizeof(uint16_t));		// the correlation id, as it came
+	memcpy(reply + sizeof(uint16_t), &status, sizeof(uint16_t));
+	inter_core_link_send_large(LP_IC_METHOD_RESPONSE, reply, LP_IC_METHOD_RESPONSE_HEADER_SIZE + (uint32_t)written);
+}
+
+/// <summary>
+/// A fragmented message from the A7 app, reassembled. A model replaces the one scoring from the next window, the
+/// LP_IC_ANOMALY_SCORE after it carries the version that runs, the old one's when the model was refused
+/// </summary>
+static void inter_core_large_handler(LP_INTER_CORE_CMD cmd, const uint8_t* payload, uint32_t length)
+{
+	switch (cmd)
+	{
+	case LP_IC_METHOD:
+		answer_method(payload, length);
+		break;
+	case LP_IC_ANOMALY_MODEL:
+#ifdef OEM_AVNET
+		if (anomaly_model_load(payload, length) != 0)
+		{
+			printf("anomaly model of %u bytes refused\n", (unsigned)length);
+		}
+		anomaly_report_due = true;
+#endif // OEM_AVNET
+		break;
+	default:
+		break;
+	}
+}
+
+static void inter_core_task(void)
+{
+	inter_core_link_run(inter_core_handler, inter_core_watchdog);
+}
+
+LP_RT_COLD void rtcore_app_start(void)
+{
+	inter_core_link_init();
+	inter_core_link_set_large_handler(inter_core_large_handler);
+	sample_clock_init();		// the microsecond clock readings are stamped with
+#ifdef CONTROL_PROBE_PIN
+	gpio_pin_open_output(&control_probe, CONTROL_PROBE_PIN, OS_HAL_GPIO_DATA_LOW);
+#endif // CONTROL_PROBE_PIN
+	led_open = open_status_led() == 0 && rtos_timer_create(&led_timer, "led", led_expired, false) == 0;
+	if (led_open)
+	{
+		rtos_timer_start(&led_timer, 0);	// the first toggle, or the first pattern
+	}
+	rtos_event_create(&diagnostics_event, "diagnostics");
+	rtos_queue_create(&button_queue, "button", sizeof(int), BUTTON_QUEUE_LENGTH, button_queue_storage);
+	rtos_queue_create(&sensor_queue, "sensor", sizeof(sensor_request), SENSOR_QUEUE_LENGTH, sensor_queue_storage);
+#ifdef SPI_ADC_BUS
+	rtos_event_create(&spi_adc_event, "spi adc");
+#endif // SPI_ADC_BUS
+#ifdef MODBUS_UART_PORT
+	rtos_event_create(&modbus_event, "modbus");
+	rtos_queue_create(&modbus_queue, "modbus", sizeof(modbus_poll_update), MODBUS_QUEUE_LENGTH, modbus_queue_storage);
+#endif // MODBUS_UART_PORT
+#ifdef AUDIO_I2S_PORT
+	rtos_queue_create(&audio_queue, "audio", sizeof(int), AUDIO_QUEUE_LENGTH, audio_queue_storage);
+#endif // AUDIO_I2S_PORT
+
+#ifdef OEM_AVNET
+	anomaly_model_init();		// the default in the image, before the link task can hand it another
+	i2c_bus_init();
+	rtos_event_create(&imu_event, "imu");
+	rtos_queue_create(&imu_free_queue, "imu free", sizeof(int), IMU_BLOCK_COUNT, imu_free_queue_storage);
+	rtos_queue_create(&imu_full_queue, "imu full", sizeof(int), IMU_BLOCK_COUNT, imu_full_queue_storage);
+	for (int block = 0; block < IMU_BLOCK_COUNT; block++)
+	{
+		rtos_queue_send(&imu_free_queue, &block);
+	}
+#endif // OEM_AVNET
+
+#if defined(OEM_SEEED_STUDIO_MINI)
+	if (rtos_timer_create(&virtual_button_timer, "virtual buttons", virtual_button_expired, true) == 0)
+	{
+		rtos_timer_start(&virtual_button_timer, VIRTUAL_BUTTON_MS);
+	}
+#else
+	rtos_task_create(&button_task_tcb, "button", button_task, button_task_stack, sizeof(button_task_stack), BUTTON_PRIORITY);
+#endif // OEM_SEEED_STUDIO_MINI
+	rtos_task_create(&inter_core_task_tcb, "inter core", inter_core_task, inter_core_task_stack, sizeof(inter_core_task_stack), INTER_CORE_PRIORITY);
+	rtos_task_create(&sensor_task_tcb, "sensor", sensor_task, sensor_task_stack, sizeof(sensor_task_stack), SENSOR_PRIORITY);
+#ifdef OEM_AVNET
+	rtos_task_create(&i2c_bus_task_tcb, "i2c bus", i2c_bus_task, i2c_bus_task_stack, sizeof(i2c_bus_task_stack), I2C_BUS_PRIORITY);
+	rtos_task_create(&imu_sample_task_tcb, "sample imu", imu_sample_task, imu_sample_task_stack, sizeof(imu_sample_task_stack),
+		IMU_SAMPLE_PRIORITY);
+	rtos_task_create(&imu_aggregate_task_tcb, "aggregate imu", imu_aggregate_task, imu_aggregate_task_stack, sizeof(imu_aggregate_task_stack),
+		IMU_AGGREGATE_PRIORITY);
+#endif // OEM_AVNET
+#ifdef ADC_CONTROLLER
+	rtos_task_create(&adc_task_tcb, "sample adc", adc_task, adc_task_stack, sizeof(adc_task_stack), ADC_PRIORITY);
+#endif // ADC_CONTROLLER
+#ifdef SPI_ADC_BUS
+	rtos_task_create(&spi_adc_task_tcb, "spi adc", spi_adc_task, spi_adc_task_stack, sizeof(spi_adc_task_stack), SPI_ADC_PRIORITY);
+#endif // SPI_ADC_BUS
+#ifdef MODBUS_UART_PORT
+	rtos_task_create(&modbus_task_tcb, "modbus", modbus_task, modbus_task_stack, sizeof(modbus_task_stack), MODBUS_PRIORITY);
+#endif // MODBUS_UART_PORT
+#ifdef AUDIO_I2S_PORT
+	rtos_task_create(&audio_task_tcb, "audio", audio_task, audio_task_stack, sizeof(audio_task_stack), AUDIO_PRIORITY);
+#endif // AUDIO_I2S_PORT
+	rtos_task_create(&diagnostics_task_tcb, "diagnostics", diagnostics_task, diagnostics_task_stack, sizeof(diagnostics_task_stack),
+		DIAGNOSTICS_PRIORITY);
+
+	// the tasks are registered with the names they are profiled under, the timers with their own
+#ifndef LED_PWM_CONTROLLER
+	led_watchdog = watchdog_register("led", LED_DEADLINE_MS);
+#endif // LED_PWM_CONTROLLER
+#if defined(OEM_SEEED_STUDIO_MINI)
+	button_watchdog = watchdog_register("virtual buttons", VIRTUAL_BUTTON_DEADLINE_MS);
+#endif // OEM_SEEED_STUDIO_MINI
+	inter_core_watchdog = watchdog_register("inter core", INTER_CORE_DEADLINE_MS);
+#ifdef OEM_AVNET
+	imu_sample_watchdog = watchdog_register("sample imu", IMU_DEADLINE_MS);
+	imu_aggregate_watchdog = watchdog_register("aggregate imu", IMU_DEADLINE_MS);
+#endif // OEM_AVNET
+#ifdef ADC_CONTROLLER
+	adc_watchdog = watchdog_register("sample adc", ADC_DEADLINE_MS);
+#endif // ADC_CONTROLLER
+#ifdef SPI_ADC_BUS
+	spi_adc_watchdog = watchdog_register("spi adc", SPI_ADC_DEADLINE_MS);
+#endif // SPI_ADC_BUS
+#ifdef MODBUS_UART_PORT
+	modbus_watchdog = watchdog_register("modbus", MODBUS_DEADLINE_MS);
+#endif // MODBUS_UART_PORT
+#ifdef AUDIO_I2S_PORT
+	audio_watchdog = watchdog_register("audio", AUDIO_DEADLINE_MS);
+#endif // AUDIO_I2S_PORT
+	rtos_task_create(&watchdog_task_tcb, "watchdog", watchdog_task, watchdog_task_stack, sizeof(watchdog_task_stack), WATCHDOG_PRIORITY);
+	watchdog_start();
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+/* The RT core application both the FreeRTOS and the ThreadX lab run: the status LED and buttons, the
+   sensor readings, the IMU pipeline and the diagnostics the A7 app asks for, all written against rtos.h
+   and sent through inter_core_link.h. The lab provides the kernel start up, the C library hooks and
+   rtcore_app_report_memory. */
+#define RTCORE_APP_STACK_SIZE 1024		/* bytes, every task */
+
+/* Creates the queues, events and tasks, call before the scheduler starts */
+void rtcore_app_start(void);
+
+/* Defined by the lab, prints what is left of its heap or pools after each diagnostics report */
+void rtcore_app_report_memory(void);
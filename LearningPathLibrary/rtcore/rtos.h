@@ -0,0 +1,148 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inter_core_protocol.h"
+
+/* The kernel services the RT core application is written against, so rtcore_app.c builds unchanged on
+   FreeRTOS (OSAI_FREERTOS) and on ThreadX. Every object lives in storage the caller declares and is
+   created before the scheduler starts, nothing is allocated from a heap. Times are milliseconds, rounded
+   up to whole ticks. Priorities run from 1, least urgent, to RTOS_PRIORITIES as on FreeRTOS, the ThreadX
+   port turns them around. */
+#define RTOS_PRIORITIES 6
+#define RTOS_NO_WAIT 0
+#define RTOS_WAIT_FOREVER UINT32_MAX
+
+/* Stacks are 8 byte aligned for the AAPCS */
+#define RTOS_STACK(name, bytes) uint64_t name[(bytes) / sizeof(uint64_t)]
+
+typedef void (*rtos_task_entry)(void);
+typedef void (*rtos_timer_callback)(void);
+
+#if defined(OSAI_FREERTOS)
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "message_buffer.h"
+#include "timers.h"
+
+typedef struct {
+	StaticTask_t tcb;
+	TaskHandle_t handle;
+	rtos_task_entry entry;
+} rtos_task;
+
+typedef struct {
+	StaticQueue_t control;
+	QueueHandle_t handle;
+} rtos_queue;
+
+/* Bits kept beside the waiting task, set bits give it a task notification rather than a semaphore */
+typedef struct {
+	volatile uint32_t bits;
+	TaskHandle_t waiter;	/* NULL until the task first waits */
+} rtos_event;
+
+typedef struct {
+	StaticMessageBuffer_t control;
+	MessageBufferHandle_t handle;
+} rtos_stream;
+
+typedef struct {
+	StaticTimer_t control;
+	TimerHandle_t handle;
+	rtos_timer_callback callback;
+} rtos_timer;
+
+#define RTOS_QUEUE_STORAGE_BYTES(item_size, length) ((item_size) * (length))
+#define RTOS_STREAM_HEADER_BYTES sizeof(size_t)
+
+#else
+
+#include "tx_api.h"
+
+typedef struct {
+	TX_THREAD thread;
+	rtos_task_entry entry;
+} rtos_task;
+
+/* A TX_QUEUE copies messages of up to 16 words, larger items are copied into blocks of a pool and
+   the queue carries the block pointers */
+typedef struct {
+	TX_QUEUE queue;
+	TX_BLOCK_POOL pool;
+	uint32_t item_size;
+} rtos_queue;
+
+typedef TX_EVENT_FLAGS_GROUP rtos_event;
+
+/* ThreadX has no message buffer, a ring of length prefixed messages with one index written by each side */
+typedef struct {
+	uint8_t *buffer;
+	uint32_t size;
+	volatile uint32_t head;		/* offset of the next write, moved by the sending task */
+	volatile uint32_t tail;		/* and of the next read, by the receiving task */
+} rtos_stream;
+
+#define RTOS_STREAM_HEADER_BYTES sizeof(uint32_t)
+
+typedef struct {
+	TX_TIMER timer;
+	rtos_timer_callback callback;
+	bool periodic;
+} rtos_timer;
+
+#define RTOS_QUEUE_COPY_WORDS 16
+#define RTOS_QUEUE_WORDS(item_size) (((item_size) + sizeof(ULONG) - 1) / sizeof(ULONG))
+#define RTOS_QUEUE_STORAGE_BYTES(item_size, length) (RTOS_QUEUE_WORDS(item_size) <= RTOS_QUEUE_COPY_WORDS \
+	? RTOS_QUEUE_WORDS(item_size) * sizeof(ULONG) * (length) \
+	: (RTOS_QUEUE_WORDS(item_size) * sizeof(ULONG) + sizeof(VOID *) + sizeof(ULONG)) * (length))
+
+#endif /* OSAI_FREERTOS */
+
+#define RTOS_QUEUE_STORAGE(name, item_size, length) \
+	uint32_t name[(RTOS_QUEUE_STORAGE_BYTES(item_size, length) + sizeof(uint32_t) - 1) / sizeof(uint32_t)]
+
+/* Room for length messages of message_size each, behind their length prefixes. FreeRTOS keeps a byte free */
+#define RTOS_STREAM_STORAGE_BYTES(message_size, length) (((message_size) + RTOS_STREAM_HEADER_BYTES) * (length) + 1)
+#define RTOS_STREAM_STORAGE(name, message_size, length) uint8_t name[RTOS_STREAM_STORAGE_BYTES(message_size, length)]
+
+/* A task that returns from its entry is deleted */
+int rtos_task_create(rtos_task *task, const char *name, rtos_task_entry entry, void *stack, uint32_t stack_size, unsigned priority);
+
+/* storage is sized with RTOS_QUEUE_STORAGE. Sends never block and return -1 when the queue is full */
+int rtos_queue_create(rtos_queue *queue, const char *name, uint32_t item_size, uint32_t length, void *storage);
+int rtos_queue_send(rtos_queue *queue, const void *item);
+int rtos_queue_send_isr(rtos_queue *queue, const void *item);
+int rtos_queue_receive(rtos_queue *queue, void *item, uint32_t timeout_ms);
+
+/* A message buffer between one sending task and one receiving task, messages are copied in and out of the
+   storage without a lock or a queue. Neither side blocks: the sender wakes the receiver with an
+   event once it has written a burst, and send returns -1 when there is no room. receive returns the length
+   of the message taken, 0 when the stream is empty, or -1, leaving it, when it is longer than size */
+int rtos_stream_create(rtos_stream *stream, const char *name, uint32_t storage_size, void *storage);
+int rtos_stream_send(rtos_stream *stream, const void *message, uint32_t length);
+int rtos_stream_receive(rtos_stream *stream, void *message, uint32_t size);
+
+/* Callbacks run one at a time on the kernel's timer task, the FreeRTOS timer daemon or the ThreadX system timer
+   thread, so work that only wakes on a period needs no task and stack of its own. A callback must not block or
+   wait. start arms the timer ms from now, a periodic one every ms after, and rearms one already running. From
+   tasks and callbacks, -1 when the FreeRTOS timer command queue is full */
+int rtos_timer_create(rtos_timer *timer, const char *name, rtos_timer_callback callback, bool periodic);
+int rtos_timer_start(rtos_timer *timer, uint32_t ms);
+
+/* Returns the bits of mask that were set, and clears them, or zero on the timeout */
+int rtos_event_create(rtos_event *event, const char *name);
+void rtos_event_set(rtos_event *event, uint32_t bits);
+void rtos_event_set_isr(rtos_event *event, uint32_t bits);
+uint32_t rtos_event_wait(rtos_event *event, uint32_t mask, uint32_t timeout_ms);
+
+void rtos_delay(uint32_t ms);
+void rtos_yield(void);		/* to the next ready task of the same priority, if there is one */
+uint32_t rtos_time_ms(void);		/* since the scheduler started, wraps */
+unsigned rtos_task_priority(void);	/* of the calling task, as it was created */
+
+/* CPU share and stack use per task from the kernel's profiling, see task_profile.h and thread_profile.h */
+typedef void (*rtos_profile_sender)(const LP_INTER_CORE_BLOCK *block);
+int rtos_profile_report(rtos_profile_sender send);
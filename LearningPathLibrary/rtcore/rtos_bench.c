@@ -0,0 +1,440 @@
+#include "rtos_bench.h"
+#include "rtos.h"
+#include "rtcore_app.h"
+#include "printf.h"
+#include <stdlib.h>
+
+#ifdef RTOS_BENCH_LOOPBACK_OUT
+#include "gpio_pins.h"
+#include "os_hal_eint.h"
+#endif /* RTOS_BENCH_LOOPBACK_OUT */
+
+#define BENCH_CONTROL_PRIORITY RTOS_PRIORITIES	/* above the workers, it only runs between tests */
+#define BENCH_HIGH_PRIORITY 4
+#define BENCH_LOW_PRIORITY 2				/* the low and the peer task, so they can yield to each other */
+#define BENCH_START_DELAY_MS 1000			/* the banner of the lab out of the UART before the first run */
+#define BENCH_TIMEOUT_MS 5000				/* for any one test, the EINT test takes 2 s on the 10 ms ThreadX tick */
+#define BENCH_EINT_ITERATIONS 100			/* each waits a tick or two for the pin to settle */
+#define BENCH_BURST_LENGTH 16
+#define BENCH_CPU_HZ 197600000
+#define BENCH_ALLOC_SIZES 3
+
+#if defined(OSAI_FREERTOS)
+#define BENCH_KERNEL "FreeRTOS " tskKERNEL_VERSION_NUMBER
+#else
+#define BENCH_KERNEL "ThreadX"
+#endif /* OSAI_FREERTOS */
+
+/* Cortex-M4 debug registers by address, mt3620.h clashes with the ThreadX types */
+#define BENCH_DEMCR (*(volatile uint32_t *)0xE000EDFC)
+#define BENCH_DEMCR_TRCENA (1UL << 24)
+#define BENCH_DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define BENCH_DWT_CTRL_CYCCNTENA (1UL << 0)
+#define BENCH_CYCCNT (*(volatile uint32_t *)0xE0001004)
+
+/* go for the workers, done back to the control task, one bit per worker */
+#define BENCH_GO (1u << 0)
+#define BENCH_LOW (1u << 0)
+#define BENCH_PEER (1u << 1)
+#define BENCH_HIGH (1u << 2)
+
+/* to the high task waiting in signal_wait */
+#define BENCH_SIGNAL (1u << 0)
+#define BENCH_STOP (1u << 1)
+
+typedef enum {
+	BENCH_YIELD,
+	BENCH_EVENT_WAKE,
+	BENCH_QUEUE_PAIR,
+	BENCH_QUEUE_WAKE,
+	BENCH_QUEUE_BURST,
+	BENCH_EINT,
+	BENCH_ALLOC
+} bench_test;
+
+typedef enum {
+	STAT_YIELD,
+	STAT_EVENT_WAKE,
+	STAT_QUEUE_PAIR,
+	STAT_QUEUE_WAKE,
+	STAT_EINT_ENTRY,
+	STAT_ISR_WAKE,
+	STAT_MALLOC,		/* then free, for each of alloc_sizes */
+	STAT_COUNT = STAT_MALLOC + 2 * BENCH_ALLOC_SIZES
+} bench_stat_index;
+
+typedef struct {
+	const char *name;
+	uint32_t samples;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+} bench_stat;
+
+/* 16 bytes, copied by value on both kernels */
+typedef struct {
+	uint32_t stamp;
+	uint32_t data[3];
+} bench_item;
+
+static bench_stat stats[STAT_COUNT] = {
+	{ .name = "yield" }, { .name = "event wake" }, { .name = "queue pair" }, { .name = "queue wake" }, { .name = "eint entry" }, { .name = "isr wake" },
+	{ .name = "malloc 16" }, { .name = "free 16" }, { .name = "malloc 32" }, { .name = "free 32" }, { .name = "malloc 200" }, { .name = "free 200" }
+};
+static const uint32_t alloc_sizes[BENCH_ALLOC_SIZES] = { 16, 32, 200 };
+
+static rtos_task control_task_tcb, low_task_tcb, peer_task_tcb, high_task_tcb;
+static RTOS_STACK(control_task_stack, RTCORE_APP_STACK_SIZE);
+static RTOS_STACK(low_task_stack, RTCORE_APP_STACK_SIZE);
+static RTOS_STACK(peer_task_stack, RTCORE_APP_STACK_SIZE);
+static RTOS_STACK(high_task_stack, RTCORE_APP_STACK_SIZE);
+
+static rtos_event low_go, peer_go, high_go, done_event, signal_event;
+static rtos_queue pair_queue, wake_queue, burst_queue;
+static RTOS_QUEUE_STORAGE(pair_queue_storage, sizeof(bench_item), 1);
+static RTOS_QUEUE_STORAGE(wake_queue_storage, sizeof(bench_item), 4);
+static RTOS_QUEUE_STORAGE(burst_queue_storage, sizeof(bench_item), BENCH_BURST_LENGTH);
+
+static volatile bench_test current_test;
+static volatile uint32_t yield_stamp;
+static volatile uint32_t yield_owner;		/* the worker bit of the task that stamped last */
+static volatile uint32_t signal_stamp;		/* before the event is set or the pin driven */
+static volatile uint32_t isr_stamp;
+static uint32_t wake_start, wake_end;		/* cycles of the queue wake and burst tests, for items/s */
+static uint32_t burst_start, burst_end;
+static uint32_t alloc_failures;
+
+#ifdef RTOS_BENCH_LOOPBACK_OUT
+static gpio_pin loopback_out;
+static gpio_pin loopback_in;
+static bool loopback_open = false;
+#endif /* RTOS_BENCH_LOOPBACK_OUT */
+
+static void record(bench_stat_index index, uint32_t cycles) {
+	bench_stat *stat = &stats[index];
+
+	if (stat->samples == 0 || cycles < stat->min)
+		stat->min = cycles;
+	if (cycles > stat->max)
+		stat->max = cycles;
+	stat->sum += cycles;
+	stat->samples++;
+}
+
+static void yield_side(uint32_t side) {
+	for (uint32_t i = 0; i < RTOS_BENCH_ITERATIONS; i++) {
+		yield_owner = side;
+		yield_stamp = BENCH_CYCCNT;
+		rtos_yield();
+		if (yield_owner != side)
+			record(STAT_YIELD, BENCH_CYCCNT - yield_stamp);		/* the peer ran, and stamped before it yielded back */
+	}
+}
+
+/* The high task, until the low task stops it. A signal from the EINT interrupt is timed in two parts */
+static void signal_wait(bool from_isr) {
+	for (;;) {
+		uint32_t bits = rtos_event_wait(&signal_event, BENCH_SIGNAL | BENCH_STOP, RTOS_WAIT_FOREVER);
+		uint32_t now = BENCH_CYCCNT;
+
+		if (bits & BENCH_SIGNAL) {
+			if (from_isr) {
+				record(STAT_EINT_ENTRY, isr_stamp - signal_stamp);
+				record(STAT_ISR_WAKE, now - isr_stamp);
+			} else {
+				record(STAT_EVENT_WAKE, now - signal_stamp);
+			}
+		}
+		if (bits & BENCH_STOP)
+			return;
+	}
+}
+
+static void event_signal(void) {
+	for (uint32_t i = 0; i < RTOS_BENCH_ITERATIONS; i++) {
+		signal_stamp = BENCH_CYCCNT;
+		rtos_event_set(&signal_event, BENCH_SIGNAL);	/* the high task runs before this returns */
+	}
+	rtos_event_set(&signal_event, BENCH_STOP);
+}
+
+static void queue_pair(void) {
+	bench_item item = { 0 };
+
+	for (uint32_t i = 0; i < RTOS_BENCH_ITERATIONS; i++) {
+		uint32_t start = BENCH_CYCCNT;
+
+		rtos_queue_send(&pair_queue, &item);
+		rtos_queue_receive(&pair_queue, &item, RTOS_NO_WAIT);
+		record(STAT_QUEUE_PAIR, BENCH_CYCCNT - start);
+	}
+}
+
+static void queue_produce(void) {
+	bench_item item = { 0 };
+
+	wake_start = BENCH_CYCCNT;
+	for (uint32_t i = 0; i < RTOS_BENCH_ITERATIONS; i++) {
+		item.stamp = BENCH_CYCCNT;
+		rtos_queue_send(&wake_queue, &item);		/* never full, the high task takes each item as it is sent */
+	}
+}
+
+static void queue_consume(void) {
+	bench_item item;
+
+	for (uint32_t i = 0; i < RTOS_BENCH_ITERATIONS; i++) {
+		if (rtos_queue_receive(&wake_queue, &item, RTOS_WAIT_FOREVER) == 0)
+			record(STAT_QUEUE_WAKE, BENCH_CYCCNT - item.stamp);
+	}
+	wake_end = BENCH_CYCCNT;
+}
+
+/* A queue's length at a time, then the peer drains it, so one context switch each way per burst */
+static void burst_produce(void) {
+	bench_item item = { 0 };
+	uint32_t sent = 0;
+
+	burst_start = BENCH_CYCCNT;
+	while (sent < RTOS_BENCH_ITERATIONS) {
+		for (uint32_t k = 0; k < BENCH_BURST_LENGTH && sent < RTOS_BENCH_ITERATIONS; k++) {
+			if (rtos_queue_send(&burst_queue, &item) != 0)
+				break;
+			sent++;
+		}
+		rtos_yield();
+	}
+}
+
+static void burst_consume(void) {
+	bench_item item;
+	uint32_t received = 0;
+
+	while (received < RTOS_BENCH_ITERATIONS) {
+		while (rtos_queue_receive(&burst_queue, &item, RTOS_NO_WAIT) == 0)
+			received++;
+		if (received < RTOS_BENCH_ITERATIONS)
+			rtos_yield();
+	}
+	burst_end = BENCH_CYCCNT;
+}
+
+#ifdef RTOS_BENCH_LOOPBACK_OUT
+static void loopback_isr(void) {
+	isr_stamp = BENCH_CYCCNT;
+	rtos_event_set_isr(&signal_event, BENCH_SIGNAL);
+}
+
+/* The stamp is taken ahead of the OS HAL GPIO write, so the eint entry figure includes it */
+static void loopback_drive(void) {
+	for (uint32_t i = 0; i < BENCH_EINT_ITERATIONS; i++) {
+		signal_stamp = BENCH_CYCCNT;
+		gpio_pin_set(&loopback_out, OS_HAL_GPIO_DATA_HIGH);
+		rtos_delay(1);
+		gpio_pin_set(&loopback_out, OS_HAL_GPIO_DATA_LOW);
+		rtos_delay(1);
+	}
+	rtos_event_set(&signal_event, BENCH_STOP);
+}
+#endif /* RTOS_BENCH_LOOPBACK_OUT */
+
+/* The lab's malloc and free, the FreeRTOS heap or the ThreadX block pools */
+static void alloc_free(void) {
+	for (int size = 0; size < BENCH_ALLOC_SIZES; size++) {
+		for (uint32_t i = 0; i < RTOS_BENCH_ITERATIONS; i++) {
+			uint32_t start = BENCH_CYCCNT;
+			void *block = malloc(alloc_sizes[size]);
+			uint32_t allocated = BENCH_CYCCNT;
+
+			if (block == NULL) {
+				alloc_failures++;
+				continue;
+			}
+			free(block);
+			record(STAT_MALLOC + 2 * size, allocated - start);
+			record(STAT_MALLOC + 2 * size + 1, BENCH_CYCCNT - allocated);
+		}
+	}
+}
+
+static void low_task(void) {
+	for (;;) {
+		rtos_event_wait(&low_go, BENCH_GO, RTOS_WAIT_FOREVER);
+		switch (current_test) {
+		case BENCH_YIELD:
+			yield_side(BENCH_LOW);
+			break;
+		case BENCH_EVENT_WAKE:
+			event_signal();
+			break;
+		case BENCH_QUEUE_PAIR:
+			queue_pair();
+			break;
+		case BENCH_QUEUE_WAKE:
+			queue_produce();
+			break;
+		case BENCH_QUEUE_BURST:
+			burst_produce();
+			break;
+#ifdef RTOS_BENCH_LOOPBACK_OUT
+		case BENCH_EINT:
+			loopback_drive();
+			break;
+#endif /* RTOS_BENCH_LOOPBACK_OUT */
+		case BENCH_ALLOC:
+			alloc_free();
+			break;
+		default:
+			break;
+		}
+		rtos_event_set(&done_event, BENCH_LOW);
+	}
+}
+
+static void peer_task(void) {
+	for (;;) {
+		rtos_event_wait(&peer_go, BENCH_GO, RTOS_WAIT_FOREVER);
+		if (current_test == BENCH_YIELD)
+			yield_side(BENCH_PEER);
+		else if (current_test == BENCH_QUEUE_BURST)
+			burst_consume();
+		rtos_event_set(&done_event, BENCH_PEER);
+	}
+}
+
+static void high_task(void) {
+	for (;;) {
+		rtos_event_wait(&high_go, BENCH_GO, RTOS_WAIT_FOREVER);
+		if (current_test == BENCH_EVENT_WAKE || current_test == BENCH_EINT)
+			signal_wait(current_test == BENCH_EINT);
+		else if (current_test == BENCH_QUEUE_WAKE)
+			queue_consume();
+		rtos_event_set(&done_event, BENCH_HIGH);
+	}
+}
+
+/* The workers are started together and run while this task waits, false when one has not finished */
+static bool run(bench_test test, uint32_t workers) {
+	uint32_t done = 0;
+
+	current_test = test;
+	if (workers & BENCH_LOW)
+		rtos_event_set(&low_go, BENCH_GO);
+	if (workers & BENCH_PEER)
+		rtos_event_set(&peer_go, BENCH_GO);
+	if (workers & BENCH_HIGH)
+		rtos_event_set(&high_go, BENCH_GO);
+
+	while (done != workers) {
+		uint32_t bits = rtos_event_wait(&done_event, workers & ~done, BENCH_TIMEOUT_MS);
+
+		if (bits == 0)
+			return false;
+		done |= bits;
+	}
+	return true;
+}
+
+static uint32_t items_per_second(uint32_t cycles) {
+	return cycles != 0 ? (uint32_t)((uint64_t)RTOS_BENCH_ITERATIONS * BENCH_CPU_HZ / cycles) : 0;
+}
+
+static void print_results(uint32_t overhead) {
+	printf("bench %s, %u iterations, cycle counter read %u cycles, not subtracted\n", BENCH_KERNEL,
+		(unsigned)RTOS_BENCH_ITERATIONS, (unsigned)overhead);
+	for (int i = 0; i < STAT_COUNT; i++) {
+		const bench_stat *stat = &stats[i];
+		uint32_t average;
+
+		if (stat->samples == 0)
+			continue;
+		average = (uint32_t)(stat->sum / stat->samples);
+		printf("bench %-10s %4u samples, cycles %5u min %5u avg %6u max, %5u ns avg\n", stat->name, (unsigned)stat->samples,
+			(unsigned)stat->min, (unsigned)average, (unsigned)stat->max, (unsigned)((uint64_t)average * 10000 / (BENCH_CPU_HZ / 100000)));
+	}
+	printf("bench queue wake %u items/s, queue burst %u items/s\n", (unsigned)items_per_second(wake_end - wake_start),
+		(unsigned)items_per_second(burst_end - burst_start));
+	if (alloc_failures != 0)
+		printf("bench %u allocations failed\n", (unsigned)alloc_failures);
+#ifndef RTOS_BENCH_LOOPBACK_OUT
+	printf("bench eint skipped, define RTOS_BENCH_LOOPBACK_OUT and RTOS_BENCH_LOOPBACK_IN\n");
+#else
+	if (!loopback_open)
+		printf("bench eint skipped, loopback pins not opened\n");
+#endif /* RTOS_BENCH_LOOPBACK_OUT */
+}
+
+/* One run after another, the results are printed once the last test is done so the UART interrupt
+   stays out of the figures */
+static void control_task(void) {
+	static const struct {
+		bench_test test;
+		uint32_t workers;
+		const char *name;
+	} tests[] = {
+		{ BENCH_YIELD, BENCH_LOW | BENCH_PEER, "yield" },
+		{ BENCH_EVENT_WAKE, BENCH_LOW | BENCH_HIGH, "event wake" },
+		{ BENCH_QUEUE_PAIR, BENCH_LOW, "queue pair" },
+		{ BENCH_QUEUE_WAKE, BENCH_LOW | BENCH_HIGH, "queue wake" },
+		{ BENCH_QUEUE_BURST, BENCH_LOW | BENCH_PEER, "queue burst" },
+		{ BENCH_EINT, BENCH_LOW | BENCH_HIGH, "eint" },
+		{ BENCH_ALLOC, BENCH_LOW, "allocator" }
+	};
+
+	rtos_delay(BENCH_START_DELAY_MS);
+	for (;;) {
+		uint32_t overhead = BENCH_CYCCNT;
+
+		overhead = BENCH_CYCCNT - overhead;
+		for (int i = 0; i < STAT_COUNT; i++) {
+			stats[i].samples = 0;
+			stats[i].min = 0;
+			stats[i].max = 0;
+			stats[i].sum = 0;
+		}
+		wake_start = wake_end = burst_start = burst_end = 0;
+		alloc_failures = 0;
+
+		for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+#ifdef RTOS_BENCH_LOOPBACK_OUT
+			if (tests[i].test == BENCH_EINT && !loopback_open)
+				continue;
+#else
+			if (tests[i].test == BENCH_EINT)
+				continue;
+#endif /* RTOS_BENCH_LOOPBACK_OUT */
+			if (!run(tests[i].test, tests[i].workers)) {
+				printf("bench %s did not finish in %u ms, stopped\n", tests[i].name, (unsigned)BENCH_TIMEOUT_MS);
+				return;
+			}
+		}
+
+		print_results(overhead);
+		rtos_delay(RTOS_BENCH_PERIOD_MS);
+	}
+}
+
+void rtos_bench_start(void) {
+	BENCH_DEMCR |= BENCH_DEMCR_TRCENA;
+	BENCH_DWT_CTRL |= BENCH_DWT_CTRL_CYCCNTENA;
+
+	rtos_event_create(&low_go, "bench low");
+	rtos_event_create(&peer_go, "bench peer");
+	rtos_event_create(&high_go, "bench high");
+	rtos_event_create(&done_event, "bench done");
+	rtos_event_create(&signal_event, "bench signal");
+	rtos_queue_create(&pair_queue, "bench pair", sizeof(bench_item), 1, pair_queue_storage);
+	rtos_queue_create(&wake_queue, "bench wake", sizeof(bench_item), 4, wake_queue_storage);
+	rtos_queue_create(&burst_queue, "bench burst", sizeof(bench_item), BENCH_BURST_LENGTH, burst_queue_storage);
+
+#ifdef RTOS_BENCH_LOOPBACK_OUT
+	loopback_open = gpio_pin_open_output(&loopback_out, RTOS_BENCH_LOOPBACK_OUT, OS_HAL_GPIO_DATA_LOW) == 0 &&
+		gpio_pin_open_input(&loopback_in, RTOS_BENCH_LOOPBACK_IN) == 0 &&
+		mtk_os_hal_eint_register((eint_number)RTOS_BENCH_LOOPBACK_IN, HAL_EINT_EDGE_RISING, loopback_isr) >= 0;
+#endif /* RTOS_BENCH_LOOPBACK_OUT */
+
+	rtos_task_create(&control_task_tcb, "bench", control_task, control_task_stack, sizeof(control_task_stack), BENCH_CONTROL_PRIORITY);
+	rtos_task_create(&high_task_tcb, "bench high", high_task, high_task_stack, sizeof(high_task_stack), BENCH_HIGH_PRIORITY);
+	rtos_task_create(&low_task_tcb, "bench low", low_task, low_task_stack, sizeof(low_task_stack), BENCH_LOW_PRIORITY);
+	rtos_task_create(&peer_task_tcb, "bench peer", peer_task, peer_task_stack, sizeof(peer_task_stack), BENCH_LOW_PRIORITY);
+}
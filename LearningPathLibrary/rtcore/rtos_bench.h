@@ -0,0 +1,22 @@
+#pragma once
+
+/* Kernel microbenchmarks, built in place of the application with RTOS_BENCH so the FreeRTOS and the ThreadX
+   lab run the same measurements through rtos.h. Each figure is timed with the DWT cycle counter at the
+   197.6 MHz core clock and printed over the UART log as min, average and max cycles:
+
+     yield               a task yielding to another of its priority, one context switch
+     event wake          rtos_event_set from a task to a waiting task of higher priority running
+     queue pair          rtos_queue_send then rtos_queue_receive of a 16 byte item in one task
+     queue wake          rtos_queue_send to a waiting task of higher priority, and that task's items/s
+     queue burst         a queue filled by one task and drained by another of its priority, items/s
+     eint entry          a GPIO driven high to its EINT interrupt running, with RTOS_BENCH_LOOPBACK_OUT
+     isr wake            rtos_event_set_isr in that interrupt to the waiting task running
+     malloc / free       the lab's malloc and free at three sizes
+
+   The EINT figures need RTOS_BENCH_LOOPBACK_OUT=<gpio> wired to RTOS_BENCH_LOOPBACK_IN=<gpio>, an input below
+   GPIO 24, and both pins in the app manifest's Gpio capabilities. The run repeats every RTOS_BENCH_PERIOD_MS. */
+#define RTOS_BENCH_ITERATIONS 1000
+#define RTOS_BENCH_PERIOD_MS 10000
+
+/* Creates the benchmark tasks, call before the scheduler starts and in place of rtcore_app_start */
+void rtos_bench_start(void);
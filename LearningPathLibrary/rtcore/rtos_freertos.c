@@ -0,0 +1,148 @@
+#include "rtos.h"
+#include "task_profile.h"
+
+static TickType_t to_ticks(uint32_t ms) {
+	if (ms == RTOS_WAIT_FOREVER)
+		return portMAX_DELAY;
+	return (TickType_t)(((uint64_t)ms * configTICK_RATE_HZ + 999) / 1000);
+}
+
+/* FreeRTOS tasks must not return */
+static void task_start(void *parameters) {
+	((rtos_task *)parameters)->entry();
+	vTaskDelete(NULL);
+}
+
+int rtos_task_create(rtos_task *task, const char *name, rtos_task_entry entry, void *stack, uint32_t stack_size, unsigned priority) {
+	task->entry = entry;
+	task->handle = task_profile_create(task_start, name, task, stack, (uint16_t)(stack_size / sizeof(StackType_t)), priority, &task->tcb);
+	return task->handle != NULL ? 0 : -1;
+}
+
+int rtos_queue_create(rtos_queue *queue, const char *name, uint32_t item_size, uint32_t length, void *storage) {
+	queue->handle = xQueueCreateStatic(length, item_size, storage, &queue->control);
+	return queue->handle != NULL ? 0 : -1;
+}
+
+int rtos_queue_send(rtos_queue *queue, const void *item) {
+	return xQueueSend(queue->handle, item, 0) == pdTRUE ? 0 : -1;
+}
+
+int rtos_queue_send_isr(rtos_queue *queue, const void *item) {
+	BaseType_t woken = pdFALSE;
+	BaseType_t sent = xQueueSendFromISR(queue->handle, item, &woken);
+
+	portYIELD_FROM_ISR(woken);
+	return sent == pdTRUE ? 0 : -1;
+}
+
+int rtos_queue_receive(rtos_queue *queue, void *item, uint32_t timeout_ms) {
+	return xQueueReceive(queue->handle, item, to_ticks(timeout_ms)) == pdTRUE ? 0 : -1;
+}
+
+/* Sends and receives never block, so the message buffer never notifies a task and the notifications stay the events' */
+int rtos_stream_create(rtos_stream *stream, const char *name, uint32_t storage_size, void *storage) {
+	stream->handle = xMessageBufferCreateStatic(storage_size - 1, storage, &stream->control);
+	return stream->handle != NULL ? 0 : -1;
+}
+
+int rtos_stream_send(rtos_stream *stream, const void *message, uint32_t length) {
+	return xMessageBufferSend(stream->handle, message, length, 0) == length ? 0 : -1;
+}
+
+int rtos_stream_receive(rtos_stream *stream, void *message, uint32_t size) {
+	size_t length = xMessageBufferReceive(stream->handle, message, size, 0);
+
+	if (length == 0 && xMessageBufferIsEmpty(stream->handle) == pdFALSE)
+		return -1;
+	return (int)length;
+}
+
+static void timer_expired(TimerHandle_t handle) {
+	((rtos_timer *)pvTimerGetTimerID(handle))->callback();
+}
+
+/* Created stopped, the period is set as it starts */
+int rtos_timer_create(rtos_timer *timer, const char *name, rtos_timer_callback callback, bool periodic) {
+	timer->callback = callback;
+	timer->handle = xTimerCreateStatic(name, portMAX_DELAY, periodic ? pdTRUE : pdFALSE, timer, timer_expired, &timer->control);
+	return timer->handle != NULL ? 0 : -1;
+}
+
+int rtos_timer_start(rtos_timer *timer, uint32_t ms) {
+	TickType_t ticks = to_ticks(ms);
+
+	return xTimerChangePeriod(timer->handle, ticks > 0 ? ticks : 1, 0) == pdPASS ? 0 : -1;
+}
+
+int rtos_event_create(rtos_event *event, const char *name) {
+	event->bits = 0;
+	event->waiter = NULL;
+	return 0;
+}
+
+void rtos_event_set(rtos_event *event, uint32_t bits) {
+	TaskHandle_t waiter;
+
+	taskENTER_CRITICAL();
+	event->bits |= bits;
+	waiter = event->waiter;
+	taskEXIT_CRITICAL();
+	if (waiter != NULL)
+		xTaskNotifyGive(waiter);
+}
+
+void rtos_event_set_isr(rtos_event *event, uint32_t bits) {
+	BaseType_t woken = pdFALSE;
+	UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+	TaskHandle_t waiter;
+
+	event->bits |= bits;
+	waiter = event->waiter;
+	taskEXIT_CRITICAL_FROM_ISR(saved);
+	if (waiter != NULL)
+		vTaskNotifyGiveFromISR(waiter, &woken);
+	portYIELD_FROM_ISR(woken);
+}
+
+/* One waiter per event, bits outside the mask stay set for a later wait. A task waiting on several events
+   shares one notification between them, the bits tell which it was for and a wakeup for another is waited out */
+uint32_t rtos_event_wait(rtos_event *event, uint32_t mask, uint32_t timeout_ms) {
+	TickType_t timeout = to_ticks(timeout_ms);
+	TimeOut_t start;
+	uint32_t taken;
+
+	vTaskSetTimeOutState(&start);
+	while (1) {
+		taskENTER_CRITICAL();
+		event->waiter = xTaskGetCurrentTaskHandle();	/* before the bits are read, so a set after it notifies */
+		taken = event->bits & mask;
+		event->bits &= ~taken;
+		taskEXIT_CRITICAL();
+
+		if (taken != 0 || xTaskCheckForTimeOut(&start, &timeout) == pdTRUE)
+			return taken;
+
+		ulTaskNotifyTake(pdTRUE, timeout);
+	}
+}
+
+void rtos_delay(uint32_t ms) {
+	vTaskDelay(to_ticks(ms));
+}
+
+void rtos_yield(void) {
+	taskYIELD();
+}
+
+uint32_t rtos_time_ms(void) {
+	return (uint32_t)(xTaskGetTickCount() * (1000 / configTICK_RATE_HZ));
+}
+
+unsigned rtos_task_priority(void) {
+	return (unsigned)uxTaskPriorityGet(NULL);
+}
+
+int rtos_profile_report(rtos_profile_sender send) {
+	return task_profile_report(send);
+}
@@ -0,0 +1,204 @@
+#include "rtos.h"
+#include "thread_profile.h"
+#include <string.h>
+
+static ULONG to_ticks(uint32_t ms) {
+	if (ms == RTOS_WAIT_FOREVER)
+		return TX_WAIT_FOREVER;
+	return (ULONG)(((uint64_t)ms * TX_TIMER_TICKS_PER_SECOND + 999) / 1000);
+}
+
+static void task_start(ULONG input) {
+	((rtos_task *)input)->entry();
+}
+
+int rtos_task_create(rtos_task *task, const char *name, rtos_task_entry entry, void *stack, uint32_t stack_size, unsigned priority) {
+	UINT tx_priority = RTOS_PRIORITIES + 1 - priority;		/* ThreadX runs the lowest number first */
+
+	task->entry = entry;
+	return tx_thread_create(&task->thread, (CHAR *)name, task_start, (ULONG)task, stack, stack_size, tx_priority, tx_priority,
+		TX_NO_TIME_SLICE, TX_AUTO_START) == TX_SUCCESS ? 0 : -1;
+}
+
+int rtos_queue_create(rtos_queue *queue, const char *name, uint32_t item_size, uint32_t length, void *storage) {
+	ULONG words = RTOS_QUEUE_WORDS(item_size);
+	ULONG pool_size;
+
+	queue->item_size = item_size;
+	if (words <= RTOS_QUEUE_COPY_WORDS)
+		return tx_queue_create(&queue->queue, (CHAR *)name, words, storage, words * sizeof(ULONG) * length) == TX_SUCCESS ? 0 : -1;
+
+	pool_size = (words * sizeof(ULONG) + sizeof(VOID *)) * length;
+	if (tx_block_pool_create(&queue->pool, (CHAR *)name, item_size, storage, pool_size) != TX_SUCCESS)
+		return -1;
+	return tx_queue_create(&queue->queue, (CHAR *)name, TX_1_ULONG, (UCHAR *)storage + pool_size, length * sizeof(ULONG)) == TX_SUCCESS
+		? 0 : -1;
+}
+
+/* No wait, so the same call is safe from an interrupt */
+int rtos_queue_send(rtos_queue *queue, const void *item) {
+	ULONG message[RTOS_QUEUE_COPY_WORDS];
+	VOID *block;
+
+	if (queue->item_size <= sizeof(message)) {
+		memcpy(message, item, queue->item_size);
+		return tx_queue_send(&queue->queue, message, TX_NO_WAIT) == TX_SUCCESS ? 0 : -1;
+	}
+
+	if (tx_block_allocate(&queue->pool, &block, TX_NO_WAIT) != TX_SUCCESS)
+		return -1;
+	memcpy(block, item, queue->item_size);
+	if (tx_queue_send(&queue->queue, &block, TX_NO_WAIT) != TX_SUCCESS) {
+		tx_block_release(block);
+		return -1;
+	}
+	return 0;
+}
+
+int rtos_queue_send_isr(rtos_queue *queue, const void *item) {
+	return rtos_queue_send(queue, item);
+}
+
+int rtos_queue_receive(rtos_queue *queue, void *item, uint32_t timeout_ms) {
+	ULONG message[RTOS_QUEUE_COPY_WORDS];
+	VOID *block;
+
+	if (queue->item_size <= sizeof(message)) {
+		if (tx_queue_receive(&queue->queue, message, to_ticks(timeout_ms)) != TX_SUCCESS)
+			return -1;
+		memcpy(item, message, queue->item_size);
+		return 0;
+	}
+
+	if (tx_queue_receive(&queue->queue, &block, to_ticks(timeout_ms)) != TX_SUCCESS)
+		return -1;
+	memcpy(item, block, queue->item_size);
+	tx_block_release(block);
+	return 0;
+}
+
+/* One core, so the compiler keeps the copy ahead of the index that publishes it and the CPU writes in order */
+#define STREAM_BARRIER() __asm volatile("" ::: "memory")
+
+int rtos_stream_create(rtos_stream *stream, const char *name, uint32_t storage_size, void *storage) {
+	stream->buffer = storage;
+	stream->size = storage_size;
+	stream->head = 0;
+	stream->tail = 0;
+	return 0;
+}
+
+static uint32_t stream_write(rtos_stream *stream, uint32_t at, const void *data, uint32_t length) {
+	uint32_t first = length < stream->size - at ? length : stream->size - at;
+
+	memcpy(stream->buffer + at, data, first);
+	memcpy(stream->buffer, (const uint8_t *)data + first, length - first);
+	return (at + length) % stream->size;
+}
+
+static uint32_t stream_read(rtos_stream *stream, uint32_t at, void *data, uint32_t length) {
+	uint32_t first = length < stream->size - at ? length : stream->size - at;
+
+	memcpy(data, stream->buffer + at, first);
+	memcpy((uint8_t *)data + first, stream->buffer, length - first);
+	return (at + length) % stream->size;
+}
+
+/* A byte is kept free as on FreeRTOS, so head equal to tail is empty */
+int rtos_stream_send(rtos_stream *stream, const void *message, uint32_t length) {
+	uint32_t head = stream->head;
+	uint32_t used = (head + stream->size - stream->tail) % stream->size;
+
+	if (stream->size - 1 - used < sizeof(uint32_t) + length)
+		return -1;
+
+	head = stream_write(stream, head, &length, sizeof(uint32_t));
+	head = stream_write(stream, head, message, length);
+	STREAM_BARRIER();
+	stream->head = head;
+	return 0;
+}
+
+int rtos_stream_receive(rtos_stream *stream, void *message, uint32_t size) {
+	uint32_t tail = stream->tail;
+	uint32_t length;
+
+	if (stream->head == tail)
+		return 0;
+	STREAM_BARRIER();
+
+	tail = stream_read(stream, tail, &length, sizeof(uint32_t));
+	if (length > size)
+		return -1;
+	tail = stream_read(stream, tail, message, length);
+	STREAM_BARRIER();
+	stream->tail = tail;
+	return (int)length;
+}
+
+static void timer_expired(ULONG input) {
+	((rtos_timer *)input)->callback();
+}
+
+/* Created stopped, the period is set as it starts */
+int rtos_timer_create(rtos_timer *timer, const char *name, rtos_timer_callback callback, bool periodic) {
+	timer->callback = callback;
+	timer->periodic = periodic;
+	return tx_timer_create(&timer->timer, (CHAR *)name, timer_expired, (ULONG)timer, 1, periodic ? 1 : 0, TX_NO_ACTIVATE) == TX_SUCCESS
+		? 0 : -1;
+}
+
+int rtos_timer_start(rtos_timer *timer, uint32_t ms) {
+	ULONG ticks = to_ticks(ms);
+
+	if (ticks == 0)
+		ticks = 1;
+	tx_timer_deactivate(&timer->timer);
+	return tx_timer_change(&timer->timer, ticks, timer->periodic ? ticks : 0) == TX_SUCCESS &&
+		tx_timer_activate(&timer->timer) == TX_SUCCESS ? 0 : -1;
+}
+
+int rtos_event_create(rtos_event *event, const char *name) {
+	return tx_event_flags_create(event, (CHAR *)name) == TX_SUCCESS ? 0 : -1;
+}
+
+void rtos_event_set(rtos_event *event, uint32_t bits) {
+	tx_event_flags_set(event, bits, TX_OR);
+}
+
+void rtos_event_set_isr(rtos_event *event, uint32_t bits) {
+	tx_event_flags_set(event, bits, TX_OR);
+}
+
+uint32_t rtos_event_wait(rtos_event *event, uint32_t mask, uint32_t timeout_ms) {
+	ULONG actual;
+
+	if (tx_event_flags_get(event, mask, TX_OR_CLEAR, &actual, to_ticks(timeout_ms)) != TX_SUCCESS)
+		return 0;
+	return actual & mask;
+}
+
+void rtos_delay(uint32_t ms) {
+	tx_thread_sleep(to_ticks(ms));
+}
+
+void rtos_yield(void) {
+	tx_thread_relinquish();
+}
+
+uint32_t rtos_time_ms(void) {
+	return (uint32_t)(tx_time_get() * (1000 / TX_TIMER_TICKS_PER_SECOND));
+}
+
+unsigned rtos_task_priority(void) {
+	TX_THREAD *thread = tx_thread_identify();
+	UINT tx_priority;
+
+	if (thread == TX_NULL || tx_thread_info_get(thread, TX_NULL, TX_NULL, TX_NULL, &tx_priority, TX_NULL, TX_NULL, TX_NULL, TX_NULL) != TX_SUCCESS)
+		return 1;
+	return RTOS_PRIORITIES + 1 - tx_priority;
+}
+
+int rtos_profile_report(rtos_profile_sender send) {
+	return thread_profile_report(send);
+}
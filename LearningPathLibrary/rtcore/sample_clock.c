@@ -0,0 +1,123 @@
+#include "sample_clock.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "mt3620.h"
+#include "os_hal_gpt.h"
+#include "printf.h"
+#include "memory_placement.h"
+
+#define CLOCK_GPT OS_HAL_GPT3		/* counts up in microseconds, GPT0 to GPT2 belong to tickless idle, the SPI sampler and the profiler */
+#define GPT3_EXPIRE (*(volatile uint32_t *)0x2103005C)	/* the OS HAL only sets it while the timer is stopped */
+
+static sample_clock_handler tick_handler;
+static uint32_t period;
+static uint32_t deadline;			/* ideal time of the tick armed */
+static uint32_t last_late;			/* how late the previous tick was, an interval's error is the change */
+static bool measuring;
+static bool running = false;
+static bool counting = false;
+static sample_clock_stats stats;
+
+static LP_RT_HOT void record(int32_t error) {
+	uint32_t magnitude = (uint32_t)(error < 0 ? -error : error);
+	uint32_t bin = magnitude == 0 ? 0 : 32 - __CLZ(magnitude);
+
+	stats.histogram[bin < SAMPLE_CLOCK_BINS ? bin : SAMPLE_CLOCK_BINS - 1]++;
+	if (stats.intervals == 0 || error < stats.min_error_us)
+		stats.min_error_us = error;
+	if (stats.intervals == 0 || error > stats.max_error_us)
+		stats.max_error_us = error;
+	stats.intervals++;
+}
+
+static LP_RT_HOT void expired(void *data) {
+	uint32_t now = mtk_os_hal_gpt_get_cur_count(CLOCK_GPT);
+	uint32_t late = now - deadline;
+
+	if (!running)
+		return;
+
+	/* ticks due at deadlines a whole number of periods apart, so the interval's error is the change in lateness */
+	if (measuring)
+		record((int32_t)(late - last_late));
+	measuring = true;
+	last_late = late;
+	if (late > stats.max_late_us)
+		stats.max_late_us = late;
+
+	tick_handler(now);
+
+	deadline += period;
+	while ((int32_t)(deadline - mtk_os_hal_gpt_get_cur_count(CLOCK_GPT)) < SAMPLE_CLOCK_LEAD_US) {
+		deadline += period;
+		stats.missed++;
+	}
+	GPT3_EXPIRE = deadline;
+}
+
+static struct os_gpt_int clock_int = { .gpt_cb_hdl = expired, .gpt_cb_data = NULL };
+
+/* Starts the count, once, the expiry is left a wrap away until the clock is started */
+LP_RT_COLD int sample_clock_init(void) {
+	if (counting)
+		return 0;
+
+	mtk_os_hal_gpt_init();
+	if (mtk_os_hal_gpt_config(CLOCK_GPT, false, &clock_int) != 0 ||
+		mtk_os_hal_gpt_reset_timer(CLOCK_GPT, UINT32_MAX, false) != 0 ||
+		mtk_os_hal_gpt_start(CLOCK_GPT) != 0) {
+		printf("sample clock gpt fail\n");
+		return -1;
+	}
+	counting = true;
+
+	return 0;
+}
+
+/* Ticks every period_us from now, a start while running restarts the clock at the new period */
+LP_RT_COLD int sample_clock_start(uint32_t period_us, sample_clock_handler handler) {
+	uint32_t primask;
+
+	if (period_us < SAMPLE_CLOCK_MIN_PERIOD_US || period_us > INT32_MAX || handler == NULL || sample_clock_init() != 0)
+		return -1;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	tick_handler = handler;
+	period = period_us;
+	memset(&stats, 0, sizeof(stats));
+	stats.period_us = period_us;
+	measuring = false;
+	deadline = mtk_os_hal_gpt_get_cur_count(CLOCK_GPT) + period_us;
+	GPT3_EXPIRE = deadline;
+	running = true;
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+/* The ticks stop, the count runs on */
+void sample_clock_stop(void) {
+	running = false;
+}
+
+/* The GPT3 count, microseconds wrapping after 71 minutes, the time base of the tick timestamps */
+uint32_t sample_clock_now_us(void) {
+	return mtk_os_hal_gpt_get_cur_count(CLOCK_GPT);
+}
+
+/* The jitter since the last take, which starts the next report from empty */
+void sample_clock_stats_take(sample_clock_stats *stats_out) {
+	uint32_t primask;
+
+	if (stats_out == NULL)
+		return;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	*stats_out = stats;
+	memset(&stats, 0, sizeof(stats));
+	stats.period_us = period;
+	__set_PRIMASK(primask);
+}
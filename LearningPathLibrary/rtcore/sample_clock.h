@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+#include "inter_core_protocol.h"
+
+/* A fixed sample rate from a hardware timer rather than the scheduler. GPT3 counts microseconds
+   from 26 MHz and interrupts when it reaches its expiry, which the interrupt moves on by exactly
+   one period each time, so the ticks keep to the ideal times whatever ran in between and never
+   drift. The handler is called from the interrupt with the count it was entered at, the sample's
+   microsecond timestamp, and wakes whatever takes the sample.
+
+   Every interval between ticks is measured against the period and counted in a histogram by how
+   far it was off, a bin per power of two microseconds, the LP_IC_SAMPLE_JITTER record carries it
+   to the A7. A tick the interrupt came too late to arm within SAMPLE_CLOCK_LEAD_US is skipped and
+   counted as missed. Clearing the GPT3 interrupt spins for 5 us in the HDL, so every timestamp is
+   that much after the expiry, a constant the intervals do not see.
+
+   The count runs from sample_clock_init whether or not the clock ticks, it is the core's microsecond
+   timebase, the stamp of readings sent to the A7 and what LP_IC_TIME_SYNC relates to the A7's clock. */
+#define SAMPLE_CLOCK_BINS LP_IC_JITTER_BINS	/* 0, 1, 2-3, 4-7 ... 32-63, 64 us and more */
+#define SAMPLE_CLOCK_MIN_PERIOD_US 100
+#define SAMPLE_CLOCK_LEAD_US 10				/* an expiry closer than this may be passed before it is set */
+
+typedef struct {
+	uint32_t period_us;
+	uint32_t intervals;			/* measured since the last take */
+	uint32_t missed;			/* ticks skipped */
+	int32_t min_error_us;		/* interval less the period, negative when early */
+	int32_t max_error_us;
+	uint32_t max_late_us;		/* interrupt entry after the ideal time */
+	uint32_t histogram[SAMPLE_CLOCK_BINS];	/* intervals by how far they were off, either way */
+} sample_clock_stats;
+
+typedef void (*sample_clock_handler)(uint32_t stamp_us);	/* from the GPT3 interrupt */
+
+int sample_clock_init(void);
+int sample_clock_start(uint32_t period_us, sample_clock_handler handler);
+void sample_clock_stop(void);
+uint32_t sample_clock_now_us(void);
+void sample_clock_stats_take(sample_clock_stats *stats_out);
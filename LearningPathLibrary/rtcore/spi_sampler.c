@@ -0,0 +1,180 @@
+#include "spi_sampler.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include "os_hal_eint.h"
+#include "os_hal_gpt.h"
+#include "printf.h"
+#include "memory_placement.h"
+
+#define SAMPLER_GPT OS_HAL_GPT1		/* repeat mode, GPT0 and GPT2 belong to tickless idle and the profiler */
+#define RING_SAMPLES (SPI_SAMPLER_BLOCKS * SPI_SAMPLER_BLOCK)
+
+/* the DMA reaches SYSRAM but not TCM */
+static LP_RT_DMA uint8_t ring[RING_SAMPLES * SPI_SAMPLER_SLOT_BYTES];
+
+static spi_sampler_config sampler;
+static struct mtk_spi_transfer xfer;
+static spi_sampler_block_handler block_handler;
+static gpio_pin data_ready;
+static volatile uint32_t written;		/* completed samples, the ring slot is written modulo RING_SAMPLES */
+static volatile uint32_t released;		/* samples the consumer is done with, whole blocks */
+static volatile bool busy;				/* a transfer is on the bus */
+static volatile uint8_t busy_triggers;
+static volatile uint32_t generation;	/* tags each transfer, a completion given up on is ignored if it comes late */
+static volatile bool running = false;
+static bool sampler_open = false;
+static spi_sampler_stats stats;
+
+static LP_RT_HOT int transfer_done(void *context) {
+	if ((uint32_t)(uintptr_t)context != generation)
+		return 0;
+
+	busy = false;
+	written++;
+	stats.samples++;
+	if (written % SPI_SAMPLER_BLOCK == 0)
+		block_handler();
+
+	return 0;
+}
+
+/* from the GPT or EINT interrupt, one transfer per trigger */
+static LP_RT_HOT void trigger(void) {
+	if (!running)
+		return;
+
+	if (busy) {
+		if (++busy_triggers < SPI_SAMPLER_STALL_TRIGGERS) {
+			stats.missed++;
+			return;
+		}
+		stats.errors++;		/* the completion was lost, start over */
+		busy = false;
+	}
+
+	if (written - released >= RING_SAMPLES) {
+		stats.overruns++;
+		return;
+	}
+
+	xfer.rx_buf = &ring[(written % RING_SAMPLES) * SPI_SAMPLER_SLOT_BYTES];
+	busy = true;
+	busy_triggers = 0;
+	generation++;
+
+	if (mtk_os_hal_spim_async_transfer(sampler.bus, &sampler.spi, &xfer, transfer_done, (void *)(uintptr_t)generation) != 0) {
+		busy = false;
+		stats.errors++;
+	}
+}
+
+static LP_RT_HOT void timer_trigger(void *data) {
+	trigger();
+}
+
+static struct os_gpt_int timer_int = { .gpt_cb_hdl = timer_trigger, .gpt_cb_data = NULL };
+
+LP_RT_COLD int spi_sampler_open(const spi_sampler_config *config, spi_sampler_block_handler handler) {
+	if (sampler_open || config == NULL || handler == NULL || config->sample_bytes == 0 ||
+		config->sample_bytes > SPI_SAMPLER_SLOT_BYTES || config->opcode_len > 4)
+		return -1;
+
+	if (config->trigger == SPI_SAMPLER_TRIGGER_TIMER && (config->rate_hz == 0 || config->rate_hz > SPI_SAMPLER_GPT_HZ))
+		return -1;
+
+	sampler = *config;
+	block_handler = handler;
+	xfer = (struct mtk_spi_transfer){ .tx_buf = NULL, .len = config->sample_bytes, .opcode = config->opcode,
+		.opcode_len = config->opcode_len, .use_dma = 1, .speed_khz = config->speed_khz };
+
+	if (mtk_os_hal_spim_ctlr_init(config->bus) != 0) {
+		printf("spim init fail\n");
+		return -1;
+	}
+
+	if (config->trigger == SPI_SAMPLER_TRIGGER_TIMER) {
+		mtk_os_hal_gpt_init();
+		if (mtk_os_hal_gpt_config(SAMPLER_GPT, true, &timer_int) != 0) {
+			printf("sampler gpt fail\n");
+			mtk_os_hal_spim_ctlr_deinit(config->bus);
+			return -1;
+		}
+	} else if (gpio_pin_open_input(&data_ready, config->data_ready_pin) != 0 ||
+		mtk_os_hal_eint_register((eint_number)config->data_ready_pin, HAL_EINT_EDGE_FALLING, trigger) < 0) {
+		printf("register eint[%d] fail\n", config->data_ready_pin);
+		gpio_pin_close(&data_ready);
+		mtk_os_hal_spim_ctlr_deinit(config->bus);
+		return -1;
+	}
+
+	written = released = 0;
+	busy = false;
+	sampler_open = true;
+
+	return 0;
+}
+
+void spi_sampler_close(void) {
+	if (!sampler_open)
+		return;
+
+	spi_sampler_stop();
+	if (sampler.trigger == SPI_SAMPLER_TRIGGER_DATA_READY) {
+		mtk_os_hal_eint_unregister((eint_number)sampler.data_ready_pin);
+		gpio_pin_close(&data_ready);
+	}
+	mtk_os_hal_spim_ctlr_deinit(sampler.bus);
+	sampler_open = false;
+}
+
+/* Starts triggering, the ring keeps what the consumer has not released */
+int spi_sampler_start(void) {
+	if (!sampler_open)
+		return -1;
+
+	running = true;
+	if (sampler.trigger == SPI_SAMPLER_TRIGGER_TIMER) {
+		mtk_os_hal_gpt_reset_timer(SAMPLER_GPT, SPI_SAMPLER_GPT_HZ / sampler.rate_hz, true);
+		mtk_os_hal_gpt_start(SAMPLER_GPT);
+	}
+
+	return 0;
+}
+
+/* A transfer on the bus completes into the ring */
+void spi_sampler_stop(void) {
+	if (sampler_open && sampler.trigger == SPI_SAMPLER_TRIGGER_TIMER)
+		mtk_os_hal_gpt_stop(SAMPLER_GPT);
+	running = false;
+}
+
+/* The oldest complete block, SPI_SAMPLER_BLOCK slots of SPI_SAMPLER_SLOT_BYTES, or NULL.
+   It stays in place until spi_sampler_block_release */
+const uint8_t *spi_sampler_block_get(void) {
+	if (!sampler_open || written - released < SPI_SAMPLER_BLOCK)
+		return NULL;
+
+	return &ring[(released % RING_SAMPLES) * SPI_SAMPLER_SLOT_BYTES];
+}
+
+void spi_sampler_block_release(void) {
+	if (written - released >= SPI_SAMPLER_BLOCK)
+		released += SPI_SAMPLER_BLOCK;
+}
+
+/* Sample index of a block, sign extended from sample_bytes MSB first */
+int32_t spi_sampler_value(const uint8_t *block, int index) {
+	const uint8_t *slot = &block[index * SPI_SAMPLER_SLOT_BYTES];
+	uint32_t value = 0;
+	int i, shift = 32 - 8 * sampler.sample_bytes;
+
+	for (i = 0; i < sampler.sample_bytes; i++)
+		value = (value << 8) | slot[i];
+
+	return (int32_t)(value << shift) >> shift;
+}
+
+void spi_sampler_stats_get(spi_sampler_stats *stats_out) {
+	if (stats_out != NULL)
+		*stats_out = stats;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include "os_hal_spim.h"
+#include "gpio_pins.h"
+
+/* Continuous sampling of an external SPI ADC with no task wakeup per sample. A trigger interrupt,
+   GPT1 at the sample rate or the ADC's data ready edge, starts one DMA transfer and the RX DMA
+   writes the conversion straight into its slot of a ring in SYSRAM. The SPI completion interrupt
+   advances the ring and, once per SPI_SAMPLER_BLOCK samples, calls the block handler, which
+   wakes the consumer. The bus belongs to the sampler while it is open.
+
+   A trigger that finds the previous transfer still on the bus is counted as missed, and one
+   that finds the ring full of blocks the consumer has not released as an overrun. A completion
+   that never comes is given up on after SPI_SAMPLER_STALL_TRIGGERS triggers. */
+#define SPI_SAMPLER_BLOCK 64			/* samples per block handler call */
+#define SPI_SAMPLER_BLOCKS 4			/* ring, one with the consumer while the others fill */
+#define SPI_SAMPLER_SLOT_BYTES 4		/* each conversion gets a word, up to 32 bits */
+#define SPI_SAMPLER_GPT_HZ 32768		/* timer trigger rates are SPI_SAMPLER_GPT_HZ / n */
+#define SPI_SAMPLER_STALL_TRIGGERS 4
+
+typedef enum {
+	SPI_SAMPLER_TRIGGER_TIMER,
+	SPI_SAMPLER_TRIGGER_DATA_READY		/* falling edge of an EINT capable pin */
+} spi_sampler_trigger;
+
+typedef struct {
+	spim_num bus;
+	struct mtk_spi_config spi;
+	uint32_t speed_khz;
+	uint32_t opcode;				/* sent ahead of each read, a read data command, say */
+	uint8_t opcode_len;				/* 0 to 4 */
+	uint8_t sample_bytes;			/* 1 to SPI_SAMPLER_SLOT_BYTES, MSB first */
+	spi_sampler_trigger trigger;
+	uint32_t rate_hz;				/* SPI_SAMPLER_TRIGGER_TIMER */
+	os_hal_gpio_pin data_ready_pin;	/* SPI_SAMPLER_TRIGGER_DATA_READY */
+} spi_sampler_config;
+
+typedef struct {
+	uint32_t samples;		/* completed transfers */
+	uint32_t missed;		/* triggers with a transfer on the bus */
+	uint32_t overruns;		/* triggers with the ring full */
+	uint32_t errors;		/* transfers that failed to start or never completed */
+} spi_sampler_stats;
+
+typedef void (*spi_sampler_block_handler)(void);	/* from the SPI completion interrupt */
+
+int spi_sampler_open(const spi_sampler_config *config, spi_sampler_block_handler handler);
+void spi_sampler_close(void);
+int spi_sampler_start(void);
+void spi_sampler_stop(void);
+const uint8_t *spi_sampler_block_get(void);
+void spi_sampler_block_release(void);
+int32_t spi_sampler_value(const uint8_t *block, int index);
+void spi_sampler_stats_get(spi_sampler_stats *stats);
@@ -0,0 +1,117 @@
+#include "task_profile.h"
+#include "timers.h"
+#include "os_hal_gpt.h"
+#include <string.h>
+
+#define TASK_PROFILE_GPT OS_HAL_GPT2		/* free-running, 32 kHz, wraps after 37 hours */
+
+typedef struct {
+	uint16_t stack_depth;		/* words, zero when not known */
+	uint32_t reported;			/* run time counter at the last report */
+	volatile uint32_t switches;
+} task_entry;
+
+/* by FreeRTOS task number, numbered from one in order of creation */
+static task_entry tasks[TASK_PROFILE_MAX_TASKS + 1];
+static TaskStatus_t status[TASK_PROFILE_MAX_TASKS];
+static uint32_t report_last;
+
+void task_profile_clock_init(void) {
+	mtk_os_hal_gpt_init();
+	mtk_os_hal_gpt_config(TASK_PROFILE_GPT, true, NULL);
+	mtk_os_hal_gpt_start(TASK_PROFILE_GPT);
+}
+
+uint32_t task_profile_clock(void) {
+	return mtk_os_hal_gpt_get_cur_count(TASK_PROFILE_GPT);
+}
+
+/* from the scheduler, with the new task already selected */
+void task_profile_switched_in(uint32_t task_number) {
+	if (task_number <= TASK_PROFILE_MAX_TASKS)
+		tasks[task_number].switches++;
+}
+
+static task_entry *find_task(TaskHandle_t handle) {
+	UBaseType_t number = uxTaskGetTaskNumber(handle);
+
+	return number <= TASK_PROFILE_MAX_TASKS ? &tasks[number] : NULL;
+}
+
+TaskHandle_t task_profile_create(TaskFunction_t code, const char *name, void *parameters, StackType_t *stack, uint16_t stack_depth,
+	UBaseType_t priority, StaticTask_t *tcb) {
+	task_entry *t;
+	TaskHandle_t created = xTaskCreateStatic(code, name, stack_depth, parameters, priority, stack, tcb);
+
+	if (created == NULL)
+		return NULL;
+
+	t = find_task(created);
+	if (t != NULL)
+		t->stack_depth = stack_depth;
+
+	return created;
+}
+
+/* The kernel creates its own tasks when the scheduler starts */
+static uint16_t stack_depth(const TaskStatus_t *s, const task_entry *t) {
+	if (t != NULL && t->stack_depth != 0)
+		return t->stack_depth;
+	if (s->xHandle == xTaskGetIdleTaskHandle())
+		return configMINIMAL_STACK_SIZE;
+	if (s->xHandle == xTimerGetTimerDaemonTaskHandle())
+		return configTIMER_TASK_STACK_DEPTH;
+	return 0;
+}
+
+static uint16_t permille(uint32_t part, uint32_t whole) {
+	return whole == 0 ? 0 : (uint16_t)((uint64_t)part * 1000 / whole);
+}
+
+int task_profile_report(task_profile_sender send) {
+	LP_INTER_CORE_BLOCK block;
+	task_entry *t;
+	uint32_t total, elapsed, run;
+	uint16_t depth;
+	UBaseType_t count, i;
+
+	count = uxTaskGetSystemState(status, TASK_PROFILE_MAX_TASKS, &total);
+	if (count == 0)
+		return -1;		/* more tasks than TASK_PROFILE_MAX_TASKS */
+
+	elapsed = total - report_last;
+	report_last = total;
+
+	for (i = 0; i < count; i++) {
+		t = find_task(status[i].xHandle);
+		depth = stack_depth(&status[i], t);
+
+		memset(&block, 0, sizeof(block));
+		block.cmd = LP_IC_THREAD_PROFILE;
+		block.profileThread = (uint8_t)i;
+		block.profileThreads = (uint8_t)count;
+		strncpy(block.profileName, status[i].pcTaskName, LP_IC_THREAD_NAME_SIZE - 1);
+
+		run = status[i].ulRunTimeCounter;
+		if (t != NULL) {
+			block.profileCpuPermille = permille(run - t->reported, elapsed);
+			block.profileSwitches = t->switches;
+			t->reported = run;
+		}
+
+		if (depth != 0) {
+			block.profileStackUsed = (uint16_t)((depth - status[i].usStackHighWaterMark) * sizeof(StackType_t));
+			block.profileStackSize = (uint16_t)(depth * sizeof(StackType_t));
+		}
+		send(&block);
+	}
+
+	memset(&block, 0, sizeof(block));
+	block.cmd = LP_IC_HEAP_PROFILE;
+	block.heapSize = configTOTAL_HEAP_SIZE;
+	block.heapFree = xPortGetFreeHeapSize();
+	block.heapMinFree = xPortGetMinimumEverFreeHeapSize();
+	send(&block);
+
+	return 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "inter_core_protocol.h"
+
+/* Where the M4 time goes, from the FreeRTOS run time statistics counted on GPT2. Stack high-water marks
+   are the words FreeRTOS finds untouched at the end of each stack, sizes are those the tasks were created
+   with through task_profile_create. The idle and timer tasks are sized from FreeRTOSConfig.h. */
+#define TASK_PROFILE_MAX_TASKS 16
+
+typedef void (*task_profile_sender)(const LP_INTER_CORE_BLOCK *block);
+
+/* xTaskCreateStatic that keeps the stack depth for the report */
+TaskHandle_t task_profile_create(TaskFunction_t code, const char *name, void *parameters, StackType_t *stack, uint16_t stack_depth,
+	UBaseType_t priority, StaticTask_t *tcb);
+
+/* One LP_IC_THREAD_PROFILE per task, CPU since the last report, then an LP_IC_HEAP_PROFILE */
+int task_profile_report(task_profile_sender send);
@@ -0,0 +1,67 @@
+#include "telemetry_window.h"
+#include <math.h>
+#include <stddef.h>
+#include "memory_placement.h"
+
+static void telemetry_window_restart(telemetry_window *w) {
+	w->samples = 0;
+	w->mean = 0;
+	w->m2 = 0;
+}
+
+void telemetry_window_init(telemetry_window *w, uint16_t window) {
+	w->requested = window;
+	w->window = window;
+	w->last = 0;
+	telemetry_window_restart(w);
+}
+
+/* A window of zero turns the channel off, the samples gathered so far are dropped */
+void telemetry_window_set(telemetry_window *w, uint16_t window) {
+	w->requested = window;
+}
+
+/* Fold one sample into the window. Returns true with summary filled in when the sample
+   completes the window, the next sample starts a new one */
+LP_RT_HOT bool telemetry_window_add(telemetry_window *w, float value, telemetry_summary *summary) {
+	float delta;
+
+	if (w->requested != w->window) {
+		w->window = w->requested;
+		telemetry_window_restart(w);
+	}
+
+	if (w->window == 0)
+		return false;
+
+	/* Welford's update, stable in single precision over a full window */
+	w->samples++;
+	delta = value - w->mean;
+	w->mean += delta / w->samples;
+	w->m2 += delta * (value - w->mean);
+	w->last = value;
+
+	if (w->samples == 1) {
+		w->min = value;
+		w->max = value;
+	} else if (value < w->min) {
+		w->min = value;
+	} else if (value > w->max) {
+		w->max = value;
+	}
+
+	if (w->samples < w->window)
+		return false;
+
+	if (summary != NULL) {
+		summary->samples = w->samples;
+		summary->min = w->min;
+		summary->max = w->max;
+		summary->mean = w->mean;
+		summary->stddev = sqrtf(w->m2 / w->samples);
+		summary->last = w->last;
+	}
+
+	telemetry_window_restart(w);
+	return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Windowed statistics of one telemetry channel, folded in one sample at a time so a window of
+   thousands of samples costs no buffer. telemetry_window_add runs from the sampling task only,
+   telemetry_window_set may run from another task: it only posts the new window, the next add
+   restarts the window with it. */
+#define TELEMETRY_WINDOW_MAX UINT16_MAX
+
+typedef struct {
+	uint16_t samples;
+	float min;
+	float max;
+	float mean;
+	float stddev;		/* population standard deviation over the window */
+	float last;
+} telemetry_summary;
+
+typedef struct {
+	volatile uint16_t requested;	/* written by telemetry_window_set */
+	uint16_t window;				/* samples per summary, zero while the channel is off */
+	uint16_t samples;
+	float min;
+	float max;
+	float mean;
+	float m2;						/* sum of squared differences from the running mean */
+	float last;
+} telemetry_window;
+
+void telemetry_window_init(telemetry_window *w, uint16_t window);
+void telemetry_window_set(telemetry_window *w, uint16_t window);
+bool telemetry_window_add(telemetry_window *w, float value, telemetry_summary *summary);
@@ -0,0 +1,132 @@
+#include "thermostat.h"
+#include <math.h>
+#include <stddef.h>
+#include "memory_placement.h"
+
+static thermostat_config requested = { .mode = LP_IC_THERMOSTAT_OFF, .window_ms = THERMOSTAT_MIN_WINDOW_MS };
+static volatile uint32_t requested_count;	/* bumped after requested is written */
+static volatile float requested_setpoint;
+static thermostat_config config = { .mode = LP_IC_THERMOSTAT_OFF, .window_ms = THERMOSTAT_MIN_WINDOW_MS };
+static uint32_t applied;					/* requested_count config was copied at */
+static bool relay;
+static bool started;						/* the last update's time and temperature are valid */
+static float last_temperature;
+static uint32_t last_ms;
+static float slope;							/* smoothed degrees per second */
+static float integral;
+static float output;
+static uint32_t window_start;
+static bool window_done;					/* the relay opened in this window, it stays open to the end */
+
+/* Taken up on the next update, a new mode starts the controller afresh */
+int thermostat_configure(const thermostat_config *c) {
+	if (c == NULL || c->mode > LP_IC_THERMOSTAT_PID || !(c->hysteresis >= 0) || !(c->kp >= 0) || !(c->ki >= 0) || !(c->kd >= 0) ||
+		(c->mode == LP_IC_THERMOSTAT_PID && c->window_ms < THERMOSTAT_MIN_WINDOW_MS))
+		return -1;
+
+	requested = *c;
+	requested_count++;
+
+	return 0;
+}
+
+void thermostat_set_point(float setpoint) {
+	requested_setpoint = setpoint;
+}
+
+static float clamp(float value, float low, float high) {
+	return value < low ? low : value > high ? high : value;
+}
+
+/* Closed once the error reaches the hysteresis, open once it is as far the other way, held in between */
+static bool hysteresis(float error) {
+	if (error >= config.hysteresis)
+		return true;
+	if (error <= -config.hysteresis)
+		return false;
+	return relay;
+}
+
+static float pid(float error, float temperature, float dt) {
+	float rate;
+
+	if (dt > 0) {
+		rate = (temperature - last_temperature) / dt;
+		slope += (rate - slope) * dt / (THERMOSTAT_DERIVATIVE_TAU_S + dt);
+		integral = clamp(integral + config.ki * error * dt, 0, 1);
+	}
+
+	/* the error changes as the temperature does the other way when heating, the same way when cooling */
+	return clamp(config.kp * error + integral + config.kd * (config.cooling ? slope : -slope), 0, 1);
+}
+
+/* Closed for the output's share of the window, once per window */
+static bool proportion(uint32_t now_ms) {
+	uint32_t on_ms;
+
+	if (now_ms - window_start >= config.window_ms) {
+		window_start = now_ms - window_start >= 2 * config.window_ms ? now_ms : window_start + config.window_ms;
+		window_done = false;
+	}
+
+	on_ms = (uint32_t)(output * config.window_ms);
+	if (on_ms < THERMOSTAT_MIN_SWITCH_MS)
+		on_ms = 0;
+	else if (config.window_ms - on_ms < THERMOSTAT_MIN_SWITCH_MS)
+		on_ms = config.window_ms;
+
+	if (!window_done && now_ms - window_start >= on_ms)
+		window_done = on_ms < config.window_ms;
+
+	return !window_done;
+}
+
+/* The relay for one reading, true when closed */
+LP_RT_HOT bool thermostat_update(float temperature, uint32_t now_ms, thermostat_state *state) {
+	uint32_t count = requested_count;
+	float setpoint = requested_setpoint;
+	float error;
+
+	if (count != applied) {
+		if (requested.mode != config.mode) {
+			integral = 0;
+			window_start = now_ms;
+			window_done = false;
+		}
+		config = requested;
+		applied = count;
+	}
+
+	if (!isfinite(temperature) || config.mode == LP_IC_THERMOSTAT_OFF) {
+		relay = false;
+		output = 0;
+		integral = 0;
+		started = false;
+	} else {
+		if (!started)
+			slope = 0;
+		error = config.cooling ? temperature - setpoint : setpoint - temperature;
+
+		if (config.mode == LP_IC_THERMOSTAT_HYSTERESIS) {
+			relay = hysteresis(error);
+			output = relay ? 1 : 0;
+		} else {
+			output = pid(error, temperature, started ? (now_ms - last_ms) / 1000.0f : 0);
+			relay = proportion(now_ms);
+		}
+
+		last_temperature = temperature;
+		last_ms = now_ms;
+		started = true;
+	}
+
+	if (state != NULL) {
+		state->mode = config.mode;
+		state->relay = relay;
+		state->temperature = temperature;
+		state->setpoint = setpoint;
+		state->output = output;
+	}
+
+	return relay;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inter_core_protocol.h"
+
+/* The relay driven from the temperature on the real-time core, every reading decides it rather than
+   a cloud round trip. Hysteresis closes the relay when the temperature is the hysteresis or more on
+   the wrong side of the setpoint and opens it once it is as far on the right side. PID drives a
+   duty cycle instead, which the relay follows by being closed for that share of every window, the
+   derivative is taken on the temperature so a new setpoint does not kick the output, and the
+   integral is held to the output range so it does not wind up while the output is saturated. A
+   duty that would switch the relay for less than THERMOSTAT_MIN_SWITCH_MS is rounded to off or on.
+
+   thermostat_update runs from the sampling task only, thermostat_configure and thermostat_set_point
+   may run from another task: they are taken up on the next update. A reading that is not a number,
+   the sensor failed, opens the relay. */
+#define THERMOSTAT_MIN_SWITCH_MS 1000		/* relay contacts wear, nothing shorter than this */
+#define THERMOSTAT_MIN_WINDOW_MS (4 * THERMOSTAT_MIN_SWITCH_MS)
+#define THERMOSTAT_DERIVATIVE_TAU_S 2.0f	/* the temperature is quantised, its rate is smoothed over this */
+
+typedef struct {
+	LP_IC_THERMOSTAT_MODE mode;
+	bool cooling;				/* the relay drives a cooler, closed above the setpoint */
+	float hysteresis;			/* degrees C */
+	float kp;					/* duty per degree */
+	float ki;					/* duty per degree second */
+	float kd;					/* duty per degree per second */
+	uint32_t window_ms;
+} thermostat_config;
+
+typedef struct {
+	LP_IC_THERMOSTAT_MODE mode;
+	bool relay;					/* closed */
+	float temperature;
+	float setpoint;
+	float output;				/* 0 to 1, the share of the window the relay is closed */
+} thermostat_state;
+
+int thermostat_configure(const thermostat_config *config);
+void thermostat_set_point(float setpoint);
+bool thermostat_update(float temperature, uint32_t now_ms, thermostat_state *state);
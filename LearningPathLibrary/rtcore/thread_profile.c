@@ -0,0 +1,192 @@
+#include "thread_profile.h"
+#include "tx_api.h"
+#include "tx_thread.h"
+
+#ifdef TX_EXECUTION_PROFILE_ENABLE
+
+/* Cortex-M4 debug registers by address, mt3620.h clashes with the ThreadX types */
+#define DEMCR (*(volatile ULONG *)0xE000EDFC)
+#define DEMCR_TRCENA (1UL << 24)
+#define DWT_CTRL (*(volatile ULONG *)0xE0001000)
+#define DWT_CTRL_CYCCNTENA (1UL << 0)
+#define DWT_CYCCNT (*(volatile ULONG *)0xE0001004)
+
+#define THREAD_NAME_PREFIX "thread "
+
+static unsigned long long clock_now;		/* CYCCNT extended to 64 bits, the SysTick keeps the extension inside one wrap */
+static uint32_t clock_last;
+static unsigned long long isr_total, isr_last_start, isr_reported;
+static unsigned int isr_nesting;
+static TX_THREAD *running;			/* thread whose interval is open, NULL in an ISR or between threads */
+static TX_THREAD *interrupted;		/* running when the outermost ISR started, resumed when it ends */
+static unsigned long long report_last;
+
+/* called with interrupts disabled */
+static unsigned long long profile_clock(void) {
+	uint32_t cycles = DWT_CYCCNT;
+
+	clock_now += (uint32_t)(cycles - clock_last);
+	clock_last = cycles;
+	return clock_now;
+}
+
+static void thread_start(TX_THREAD *thread, unsigned long long now) {
+	if (thread != TX_NULL)
+		thread->tx_thread_execution_time_last_start = now;
+	running = thread;
+}
+
+static void thread_stop(unsigned long long now) {
+	if (running != TX_NULL)
+		running->tx_thread_execution_time_total += now - running->tx_thread_execution_time_last_start;
+	running = TX_NULL;
+}
+
+/* The scheduler hooks, thread_enter runs with interrupts enabled so every hook masks them */
+VOID _tx_execution_thread_enter(VOID) {
+	TX_INTERRUPT_SAVE_AREA
+
+	TX_DISABLE
+	thread_start(_tx_thread_current_ptr, profile_clock());
+	TX_RESTORE
+}
+
+VOID _tx_execution_thread_exit(VOID) {
+	TX_INTERRUPT_SAVE_AREA
+
+	TX_DISABLE
+	thread_stop(profile_clock());
+	TX_RESTORE
+}
+
+VOID _tx_execution_isr_enter(VOID) {
+	TX_INTERRUPT_SAVE_AREA
+	unsigned long long now;
+
+	TX_DISABLE
+	if (isr_nesting++ == 0) {
+		now = profile_clock();
+		interrupted = running;
+		thread_stop(now);
+		isr_last_start = now;
+	}
+	TX_RESTORE
+}
+
+VOID _tx_execution_isr_exit(VOID) {
+	TX_INTERRUPT_SAVE_AREA
+	unsigned long long now;
+
+	TX_DISABLE
+	if (isr_nesting > 0 && --isr_nesting == 0) {
+		now = profile_clock();
+		isr_total += now - isr_last_start;
+		thread_start(interrupted, now);
+	}
+	TX_RESTORE
+}
+
+void thread_profile_init(void) {
+	DEMCR |= DEMCR_TRCENA;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+	clock_last = DWT_CYCCNT;
+}
+
+/* Bytes of the stack ever written, the untouched low end still holds the fill */
+static uint16_t stack_used(const TX_THREAD *thread) {
+	const ULONG *word = (const ULONG *)thread->tx_thread_stack_start;
+	const ULONG *end = (const ULONG *)((const UCHAR *)thread->tx_thread_stack_start + thread->tx_thread_stack_size);
+
+	while (word < end && *word == TX_STACK_FILL)
+		word++;
+
+	return (uint16_t)((const UCHAR *)end - (const UCHAR *)word);
+}
+
+static uint16_t permille(unsigned long long part, unsigned long long whole) {
+	return whole == 0 ? 0 : (uint16_t)(part * 1000 / whole);
+}
+
+/* The demo's "thread " prefix is dropped so the part that tells threads apart fits */
+static void set_name(LP_INTER_CORE_BLOCK *block, const char *name) {
+	if (name == TX_NULL)
+		name = "";
+	if (strncmp(name, THREAD_NAME_PREFIX, sizeof(THREAD_NAME_PREFIX) - 1) == 0)
+		name += sizeof(THREAD_NAME_PREFIX) - 1;
+	strncpy(block->profileName, name, LP_IC_THREAD_NAME_SIZE - 1);
+}
+
+int thread_profile_report(thread_profile_sender send) {
+	TX_INTERRUPT_SAVE_AREA
+	LP_INTER_CORE_BLOCK block;
+	TX_THREAD *thread;
+	unsigned long long now, elapsed, total, busy = 0;
+	ULONG count, i;
+
+	TX_DISABLE
+	now = profile_clock();
+	TX_RESTORE
+	elapsed = now - report_last;
+	report_last = now;
+
+	count = _tx_thread_created_count;
+	thread = _tx_thread_created_ptr;
+
+	for (i = 0; i < count && thread != TX_NULL; i++) {
+		memset(&block, 0, sizeof(block));
+		block.cmd = LP_IC_THREAD_PROFILE;
+		block.profileThread = (uint8_t)i;
+		block.profileThreads = (uint8_t)(count + 2);
+		set_name(&block, thread->tx_thread_name);
+
+		/* the reporting thread is running, its open interval counts too */
+		TX_DISABLE
+		total = thread->tx_thread_execution_time_total;
+		if (thread == running)
+			total += profile_clock() - thread->tx_thread_execution_time_last_start;
+		block.profileSwitches = thread->tx_thread_run_count;
+		TX_RESTORE
+
+		block.profileCpuPermille = permille(total - thread->tx_thread_execution_time_reported, elapsed);
+		busy += total - thread->tx_thread_execution_time_reported;
+		thread->tx_thread_execution_time_reported = total;
+		block.profileStackUsed = stack_used(thread);
+		block.profileStackSize = (uint16_t)thread->tx_thread_stack_size;
+		send(&block);
+
+		thread = thread->tx_thread_created_next;
+	}
+
+	memset(&block, 0, sizeof(block));
+	block.cmd = LP_IC_THREAD_PROFILE;
+	block.profileThreads = (uint8_t)(count + 2);
+
+	TX_DISABLE
+	total = isr_total;
+	TX_RESTORE
+	block.profileThread = (uint8_t)count;
+	set_name(&block, "isr");
+	block.profileCpuPermille = permille(total - isr_reported, elapsed);
+	busy += total - isr_reported;
+	isr_reported = total;
+	send(&block);
+
+	/* whatever no thread or ISR used, the scheduler waiting in WFI */
+	block.profileThread = (uint8_t)(count + 1);
+	set_name(&block, "idle");
+	block.profileCpuPermille = permille(elapsed > busy ? elapsed - busy : 0, elapsed);
+	send(&block);
+
+	return 0;
+}
+
+#else
+
+void thread_profile_init(void) {
+}
+
+int thread_profile_report(thread_profile_sender send) {
+	return -1;		/* built without TX_EXECUTION_PROFILE_ENABLE */
+}
+
+#endif /* TX_EXECUTION_PROFILE_ENABLE */
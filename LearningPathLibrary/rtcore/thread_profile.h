@@ -0,0 +1,14 @@
+#pragma once
+
+#include "inter_core_protocol.h"
+
+/* Where the M4 cycles go, timed with the DWT cycle counter from the ThreadX scheduler's execution change
+   hooks. Needs TX_EXECUTION_PROFILE_ENABLE, which adds the time fields to every TX_THREAD. ISR time is what
+   ThreadX wraps, the SysTick; the OS HAL and DMA handlers are counted in the thread they interrupted.
+   Stack high-water marks come from the 0xEF fill ThreadX writes when a thread is created. */
+typedef void (*thread_profile_sender)(const LP_INTER_CORE_BLOCK *block);
+
+void thread_profile_init(void);
+
+/* One LP_IC_THREAD_PROFILE per thread, then the ISR and idle shares, CPU since the last report */
+int thread_profile_report(thread_profile_sender send);
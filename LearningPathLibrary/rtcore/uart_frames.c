@@ -0,0 +1,230 @@
+#include "uart_frames.h"
+#include <stddef.h>
+#include "hdl_uart.h"
+#include "mt3620.h"
+#include "os_hal_dma.h"
+#include "printf.h"
+#include "memory_placement.h"
+
+#define UART_LSR_TEMT 0x40		/* UART_LSR_THRE and the last stop bit shifted out */
+#define DISCARD_CHUNK 32
+
+#define REG(offset) (*(volatile uint32_t *)(base + (offset)))
+
+static const uintptr_t port_base[] = {
+	[OS_HAL_UART_ISU0] = 0x38070500,
+	[OS_HAL_UART_ISU1] = 0x38080500,
+	[OS_HAL_UART_ISU2] = 0x38090500,
+	[OS_HAL_UART_ISU3] = 0x380a0500,
+	[OS_HAL_UART_ISU4] = 0x380b0500,
+};
+
+static const enum dma_channel port_rx_channel[] = {
+	[OS_HAL_UART_ISU0] = VDMA_ISU0_RX_CH14,
+	[OS_HAL_UART_ISU1] = VDMA_ISU1_RX_CH16,
+	[OS_HAL_UART_ISU2] = VDMA_ISU2_RX_CH18,
+	[OS_HAL_UART_ISU3] = VDMA_ISU3_RX_CH20,
+	[OS_HAL_UART_ISU4] = VDMA_ISU4_RX_CH22,
+};
+
+/* the DMA reaches SYSRAM but not TCM */
+static LP_RT_DMA uint8_t fifo[UART_FRAMES_FIFO];
+
+static uart_frame frames[UART_FRAMES_SLOTS];
+static uart_frames_config port;
+static uart_frames_handler frame_handler;
+static uintptr_t base;
+static enum dma_channel channel;
+static volatile uint32_t written;		/* completed frames, the slot filling is written modulo UART_FRAMES_SLOTS */
+static volatile uint32_t released;		/* frames the consumer is done with */
+static bool receiving;					/* bytes have arrived since the line was last idle */
+static bool discarding;					/* the frame being received found the ring full */
+static bool cut_short;
+static bool frames_open = false;
+static uart_frames_stats stats;
+
+static void discard_fifo(void) {
+	uint8_t scratch[DISCARD_CHUNK];
+
+	while (mtk_os_hal_dma_vff_read_data(channel, scratch, sizeof(scratch)) == sizeof(scratch))
+		;
+}
+
+/* from the DMA interrupt, idle once the line has been quiet for the gap */
+static LP_RT_HOT void drain(bool idle) {
+	uart_frame *frame = &frames[written % UART_FRAMES_SLOTS];
+	int n;
+
+	if (mtk_os_hal_dma_get_param(channel, OS_HAL_DMA_PARAM_VFF_FIFO_CNT) > 0) {
+		if (!receiving) {
+			receiving = true;
+			discarding = written - released >= UART_FRAMES_SLOTS;
+			if (discarding)
+				stats.dropped++;
+			else
+				frame->length = 0;
+		}
+
+		if (!discarding && frame->length < UART_FRAMES_MAX) {
+			n = mtk_os_hal_dma_vff_read_data(channel, &frame->data[frame->length], UART_FRAMES_MAX - frame->length);
+			if (n > 0)
+				frame->length += n;
+		}
+
+		/* whatever does not fit is dropped, the frame is cut short */
+		if (mtk_os_hal_dma_get_param(channel, OS_HAL_DMA_PARAM_VFF_FIFO_CNT) > 0) {
+			if (!discarding && !cut_short) {
+				cut_short = true;
+				stats.truncated++;
+			}
+			discard_fifo();
+		}
+	}
+
+	if (!idle || !receiving)
+		return;
+
+	receiving = false;
+	cut_short = false;
+	if (discarding) {
+		discarding = false;
+		return;
+	}
+
+	written++;
+	stats.frames++;
+	frame_handler();
+}
+
+static LP_RT_HOT void fifo_threshold(void *data) {
+	drain(false);
+}
+
+static LP_RT_HOT void fifo_timeout(void *data) {
+	drain(true);
+}
+
+LP_RT_COLD int uart_frames_open(const uart_frames_config *config, uart_frames_handler handler) {
+	struct dma_setting setting = {
+		.interrupt_flag = DMA_INT_VFIFO_TIMEOUT | DMA_INT_VFIFO_THRESHOLD,
+		.dir = PERI_2_MEM,
+		.dst_addr = (uint32_t)(uintptr_t)fifo,
+		.vfifo = { .fifo_thrsh = UART_FRAMES_FIFO / 2, .fifo_size = UART_FRAMES_FIFO },
+		.ctrl_mode = { .transize = DMA_SIZE_BYTE },
+	};
+
+	if (frames_open || config == NULL || handler == NULL || config->baud == 0 || config->idle_us == 0 ||
+		config->port < OS_HAL_UART_ISU0 || config->port > OS_HAL_UART_ISU4)
+		return -1;
+
+	port = *config;
+	frame_handler = handler;
+	base = port_base[config->port];
+	channel = port_rx_channel[config->port];
+	setting.src_addr = (uint32_t)base;
+	setting.vfifo.timeout_cnt = (uint32_t)((uint64_t)config->idle_us * UART_FRAMES_BUS_HZ / 1000000);
+
+	if (mtk_os_hal_uart_ctlr_init(config->port) != 0) {
+		printf("uart init fail\n");
+		return -1;
+	}
+	mtk_os_hal_uart_set_baudrate(config->port, config->baud);
+	mtk_os_hal_uart_set_format(config->port, UART_DATA_8_BITS, config->parity, config->stop_bits);
+
+	if (mtk_os_hal_dma_alloc_chan(channel) != 0 ||
+		mtk_os_hal_dma_register_isr(channel, fifo_threshold, NULL, DMA_INT_VFIFO_THRESHOLD) != 0 ||
+		mtk_os_hal_dma_register_isr(channel, fifo_timeout, NULL, DMA_INT_VFIFO_TIMEOUT) != 0 ||
+		mtk_os_hal_dma_config(channel, &setting) != 0) {
+		printf("uart vff dma fail\n");
+		mtk_os_hal_dma_release_chan(channel);
+		mtk_os_hal_uart_ctlr_deinit(config->port);
+		return -1;
+	}
+
+	written = released = 0;
+	receiving = discarding = cut_short = false;
+
+	/* same order as the OS HAL's own DMA receive: FIFO cleared, DMA running, then the handshake */
+	mtk_hdl_uart_dma_en((void *)base, true);
+	mtk_os_hal_dma_clr_dreq(channel);
+	if (mtk_os_hal_dma_start(channel) != 0) {
+		printf("uart vff dma start fail\n");
+		mtk_hdl_uart_dma_en((void *)base, false);
+		mtk_os_hal_dma_release_chan(channel);
+		mtk_os_hal_uart_ctlr_deinit(config->port);
+		return -1;
+	}
+	mtk_hdl_uart_rx_dma_handshake((void *)base, true);
+
+	frames_open = true;
+
+	return 0;
+}
+
+void uart_frames_close(void) {
+	if (!frames_open)
+		return;
+
+	mtk_hdl_uart_rx_dma_handshake((void *)base, false);
+	mtk_os_hal_dma_stop(channel);
+	mtk_os_hal_dma_release_chan(channel);
+	mtk_hdl_uart_dma_en((void *)base, false);
+	mtk_os_hal_uart_ctlr_deinit(port.port);
+	frames_open = false;
+}
+
+/* Spins only while more than UART_FRAMES_TX_FIFO bytes are outstanding */
+int uart_frames_write(const uint8_t *data, int length) {
+	int i;
+
+	if (!frames_open || data == NULL || length < 0)
+		return -1;
+
+	for (i = 0; i < length; i++) {
+		if (i % UART_FRAMES_TX_FIFO == 0)
+			while ((REG(UART_LSR) & UART_LSR_THRE) == 0)
+				;
+		REG(UART_THR) = data[i];
+	}
+
+	return 0;
+}
+
+/* The last byte written is off the wire, an RS-485 driver can be turned around */
+bool uart_frames_tx_done(void) {
+	return frames_open && (REG(UART_LSR) & UART_LSR_TEMT) != 0;
+}
+
+/* The oldest complete frame, or NULL. It stays in place until uart_frames_release */
+const uart_frame *uart_frames_get(void) {
+	if (!frames_open || written == released)
+		return NULL;
+
+	return &frames[released % UART_FRAMES_SLOTS];
+}
+
+void uart_frames_release(void) {
+	if (written != released)
+		released++;
+}
+
+/* Drops the complete frames, the frame being received and what the FIFO holds, before a request
+   so nothing stale is taken for its response */
+void uart_frames_flush(void) {
+	uint32_t primask;
+
+	if (!frames_open)
+		return;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	discard_fifo();
+	released = written;
+	receiving = discarding = cut_short = false;
+	__set_PRIMASK(primask);
+}
+
+void uart_frames_stats_get(uart_frames_stats *stats_out) {
+	if (stats_out != NULL)
+		*stats_out = stats;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "os_hal_uart.h"
+
+/* Frame oriented serial port for Modbus RTU and serial sensors that answer in bursts. The UART's
+   receive DMA writes every byte into a virtual FIFO in SYSRAM with no interrupt per byte. The VFF
+   timeout interrupt fires once the line has been idle for the configured gap, which ends the frame,
+   and the threshold interrupt drains a long frame before the FIFO can fill. Either way the DMA
+   interrupt copies the FIFO into a ring of frames and, at the end of a frame, calls the frame
+   handler, which wakes the consumer.
+
+   A frame that arrives with the ring full of frames the consumer has not released is dropped and
+   counted, one longer than UART_FRAMES_MAX is cut short and counted. Transmit is through the
+   UART's own FIFO, a request up to UART_FRAMES_TX_FIFO bytes costs no waiting at all. */
+#define UART_FRAMES_MAX 256			/* a Modbus RTU frame at most */
+#define UART_FRAMES_SLOTS 4
+#define UART_FRAMES_FIFO 512		/* VFF bytes, two frames of slack while the interrupt is held off */
+#define UART_FRAMES_TX_FIFO 16
+#define UART_FRAMES_BUS_HZ 197600000	/* the VFF timeout counts the M4 bus clock, the CPU clock */
+
+typedef struct {
+	UART_PORT port;				/* OS_HAL_UART_ISU0 to ISU4, the debug UART has no DMA */
+	uint32_t baud;
+	mhal_uart_parity parity;
+	mhal_uart_stop_bit stop_bits;
+	uint32_t idle_us;			/* line idle that ends a frame */
+} uart_frames_config;
+
+typedef struct {
+	uint16_t length;
+	uint8_t data[UART_FRAMES_MAX];
+} uart_frame;
+
+typedef struct {
+	uint32_t frames;		/* completed frames */
+	uint32_t dropped;		/* frames that found the ring full */
+	uint32_t truncated;		/* frames longer than UART_FRAMES_MAX */
+} uart_frames_stats;
+
+typedef void (*uart_frames_handler)(void);		/* from the DMA interrupt */
+
+int uart_frames_open(const uart_frames_config *config, uart_frames_handler handler);
+void uart_frames_close(void);
+int uart_frames_write(const uint8_t *data, int length);
+bool uart_frames_tx_done(void);
+const uart_frame *uart_frames_get(void);
+void uart_frames_release(void);
+void uart_frames_flush(void);
+void uart_frames_stats_get(uart_frames_stats *stats);
@@ -0,0 +1,95 @@
+#include "uart_log.h"
+#include "mt3620.h"
+#include <stdbool.h>
+#include "memory_placement.h"
+
+#define UART_THR 0x00
+#define UART_IER 0x04
+#define UART_IIR 0x08
+#define UART_IER_THRE 0x02		/* UART_INT_TX_BUFFER_EMPTY */
+#define UART_FIFO_DEPTH 16		/* bytes the transmit FIFO takes once it has emptied */
+#define RING_MASK (UART_LOG_RING_SIZE - 1)
+
+#define REG(offset) (*(volatile uint32_t *)(base + (offset)))
+
+static const uintptr_t port_base[] = {
+	[OS_HAL_UART_PORT0] = 0x21040000,
+	[OS_HAL_UART_ISU0] = 0x38070500,
+	[OS_HAL_UART_ISU1] = 0x38080500,
+	[OS_HAL_UART_ISU2] = 0x38090500,
+	[OS_HAL_UART_ISU3] = 0x380a0500,
+	[OS_HAL_UART_ISU4] = 0x380b0500,
+};
+
+static const int port_irq[] = {
+	[OS_HAL_UART_PORT0] = CM4_IRQ_UART,
+	[OS_HAL_UART_ISU0] = CM4_IRQ_ISU_G0_UART,
+	[OS_HAL_UART_ISU1] = CM4_IRQ_ISU_G1_UART,
+	[OS_HAL_UART_ISU2] = CM4_IRQ_ISU_G2_UART,
+	[OS_HAL_UART_ISU3] = CM4_IRQ_ISU_G3_UART,
+	[OS_HAL_UART_ISU4] = CM4_IRQ_ISU_G4_UART,
+};
+
+static uintptr_t base;
+static LP_RT_BULK char ring[UART_LOG_RING_SIZE];
+static volatile uint32_t head;		/* written with interrupts masked */
+static volatile uint32_t tail;		/* written by the interrupt only */
+static volatile uint32_t drops;
+static volatile bool draining;		/* the transmit interrupt is enabled */
+
+_Static_assert((UART_LOG_RING_SIZE & RING_MASK) == 0, "UART_LOG_RING_SIZE must be a power of two");
+
+static LP_RT_HOT void uart_log_irq(void) {
+	uint32_t t = tail;
+	int n;
+
+	(void)REG(UART_IIR);		/* reading the identification clears the transmit interrupt */
+
+	for (n = 0; n < UART_FIFO_DEPTH && t != head; n++, t++)
+		REG(UART_THR) = (uint8_t)ring[t & RING_MASK];
+	tail = t;
+
+	if (t == head) {
+		REG(UART_IER) = 0;
+		draining = false;
+	}
+}
+
+LP_RT_COLD int uart_log_open(UART_PORT port) {
+	if ((unsigned)port >= sizeof(port_base) / sizeof(port_base[0]))
+		return -1;
+
+	base = port_base[port];
+	REG(UART_IER) = 0;
+	CM4_Install_NVIC(port_irq[port], DEFAULT_PRI, IRQ_LEVEL_TRIGGER, uart_log_irq, true);
+
+	/* whatever was logged before the port was opened */
+	if (head != tail) {
+		draining = true;
+		REG(UART_IER) = UART_IER_THRE;
+	}
+	return 0;
+}
+
+void uart_log_putc(char c) {
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (head - tail >= UART_LOG_RING_SIZE) {
+		drops++;
+	} else {
+		ring[head & RING_MASK] = c;
+		head++;
+
+		/* an empty FIFO raises the interrupt as soon as it is enabled */
+		if (!draining && base != 0) {
+			draining = true;
+			REG(UART_IER) = UART_IER_THRE;
+		}
+	}
+	__set_PRIMASK(primask);
+}
+
+uint32_t uart_log_drops(void) {
+	return drops;
+}
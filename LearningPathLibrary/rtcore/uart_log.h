@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+#include "os_hal_uart.h"
+
+/* printf output through a ring the UART transmit interrupt drains, so a task that logs only pays for the
+   copy. The interrupt refills the transmit FIFO each time it empties and turns itself off once the ring is
+   drained. A full ring drops the character and counts it, nothing ever waits for the UART. */
+#define UART_LOG_RING_SIZE 2048		/* power of two, about 180 ms of output at 115200 baud */
+
+/* After mtk_os_hal_uart_ctlr_init, takes over the port's interrupt */
+int uart_log_open(UART_PORT port);
+
+/* From any task or interrupt, a few instructions with interrupts masked */
+void uart_log_putc(char c);
+uint32_t uart_log_drops(void);
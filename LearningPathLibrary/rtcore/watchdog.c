@@ -0,0 +1,74 @@
+#include "watchdog.h"
+#include "os_hal_wdt.h"
+#include "inter_core_protocol.h"
+#include "rtos.h"
+#include "memory_placement.h"
+
+typedef struct {
+	const char *name;
+	uint32_t deadline_ms;
+	uint32_t seen;			/* check ins at the last pass */
+	uint32_t seen_ms;		/* when they last changed */
+} watchdog_task;
+
+volatile uint32_t watchdog_check_ins[WATCHDOG_MAX_TASKS];
+
+static watchdog_task tasks[WATCHDOG_MAX_TASKS];
+static int task_count;
+static uint8_t reset_cause = LP_IC_RESET_POWER_ON;
+
+int watchdog_register(const char *name, uint32_t deadline_ms) {
+	if (task_count >= WATCHDOG_MAX_TASKS)
+		return -1;
+
+	tasks[task_count].name = name;
+	tasks[task_count].deadline_ms = deadline_ms;
+	return task_count++;
+}
+
+LP_RT_COLD int watchdog_start(void) {
+	mtk_os_hal_wdt_init();
+
+	switch (mtk_os_hal_wdt_get_reset_status()) {
+	case OS_WDT_SW_RST:
+		reset_cause = LP_IC_RESET_SOFTWARE;
+		break;
+	case OS_WDT_HW_RST:
+		reset_cause = LP_IC_RESET_WATCHDOG;
+		break;
+	default:
+		reset_cause = LP_IC_RESET_POWER_ON;
+		break;
+	}
+
+	if (mtk_os_hal_wdt_set_timeout(WATCHDOG_TIMEOUT_S) != 0)
+		return -1;
+	mtk_os_hal_wdt_config(OS_WDT_TRIGGER_RESET);
+	mtk_os_hal_wdt_enable();
+	return 0;
+}
+
+uint8_t watchdog_reset_cause(void) {
+	return reset_cause;
+}
+
+const char *watchdog_supervise(void) {
+	uint32_t now = rtos_time_ms();
+	const char *late = NULL;
+	int i;
+
+	for (i = 0; i < task_count; i++) {
+		uint32_t check_ins = watchdog_check_ins[i];
+
+		if (check_ins != tasks[i].seen) {
+			tasks[i].seen = check_ins;
+			tasks[i].seen_ms = now;
+		} else if (check_ins != 0 && now - tasks[i].seen_ms > tasks[i].deadline_ms && late == NULL) {
+			late = tasks[i].name;
+		}
+	}
+
+	if (late == NULL)
+		mtk_os_hal_wdt_restart();
+	return late;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+/* The M4 hardware watchdog, restarted only while every registered task keeps checking in. Slots are taken
+   with watchdog_register before the scheduler starts and a task calls watchdog_check_in each time round its
+   loop, a single increment. A slot is armed by its first check in, so a task that gave up during its own
+   set up does not reset the core. watchdog_supervise runs from a task of its own: once an armed task has
+   gone longer than its deadline without checking in, the counter is left to run out. Tasks that block
+   without a bound until there is work are not registered. */
+#define WATCHDOG_MAX_TASKS 8
+#define WATCHDOG_TIMEOUT_S 4			/* hardware, from the last restart to the reset */
+#define WATCHDOG_SUPERVISE_MS 1000		/* between supervisor passes, well inside the hardware timeout */
+
+extern volatile uint32_t watchdog_check_ins[WATCHDOG_MAX_TASKS];
+
+/* Before the scheduler starts, the slot for watchdog_check_in or -1 when they are all taken */
+int watchdog_register(const char *name, uint32_t deadline_ms);
+
+/* Reads why the core last reset, then starts the counter */
+int watchdog_start(void);
+
+/* An LP_IC_RESET_CAUSE */
+uint8_t watchdog_reset_cause(void);
+
+/* From the task holding the slot, -1 is ignored */
+static inline void watchdog_check_in(int slot) {
+	if (slot >= 0)
+		watchdog_check_ins[slot]++;
+}
+
+/* Restarts the counter when every armed task checked in within its deadline, otherwise leaves it running and
+   returns the name of the first task that did not */
+const char *watchdog_supervise(void);
@@ -0,0 +1,275 @@
+#include "sensor_cache.h"
+#include "terminate.h"
+#include <applibs/log.h>
+
+static void SensorReadHandler(EventLoopTimer* eventLoopTimer);
+static void SensorPrefetchHandler(EventLoopTimer* eventLoopTimer);
+
+static LP_SENSOR** _sensors = NULL;
+static size_t _sensorCount = 0;
+static LP_TIMER* _telemetryTimer = NULL;	// the prefetch sensors are read ahead of it, NULL polls them
+static int64_t _leadNs = 0;
+static LP_TIMER prefetchTimer = { .period = { 0, 0 }, .name = "sensorPrefetchTimer", .handler = SensorPrefetchHandler };
+
+static int64_t ToNs(const struct timespec* value) {
+	return (int64_t)value->tv_sec * 1000000000 + value->tv_nsec;
+}
+
+static struct timespec FromNs(int64_t ns) {
+	return (struct timespec){ (time_t)(ns / 1000000000), (long)(ns % 1000000000) };
+}
+
+static bool Prefetching(const LP_SENSOR* sensor) {
+	return sensor->prefetch && _telemetryTimer != NULL;
+}
+
+// the rate the cached values are refreshed at, the telemetry period for a prefetch sensor
+static const struct timespec* RefreshPeriod(const LP_SENSOR* sensor) {
+	return Prefetching(sensor) ? &_telemetryTimer->period : &sensor->period;
+}
+
+static void StoreRead(LP_SENSOR* sensor, bool ok, const float values[LP_SENSOR_VALUES]) {
+	sensor->reads++;
+	if (!ok) {
+		sensor->failures++;
+		return;
+	}
+
+	for (int i = 0; i < LP_SENSOR_VALUES; i++) {
+		sensor->values[i] = values[i];
+	}
+	clock_gettime(CLOCK_MONOTONIC, &sensor->sampledAt);
+}
+
+// worker side, the sensor's read and result fields are its own until the done function runs
+static void SensorReadWork(void* context) {
+	LP_SENSOR* sensor = (LP_SENSOR*)context;
+
+	sensor->readOk = sensor->read(sensor->readValues);
+}
+
+static void SensorReadDone(void* context) {
+	LP_SENSOR* sensor = (LP_SENSOR*)context;
+
+	sensor->reading = false;
+	StoreRead(sensor, sensor->readOk, sensor->readValues);
+}
+
+static void ReadSensor(LP_SENSOR* sensor) {
+	float values[LP_SENSOR_VALUES];
+
+	if (sensor->offload && lp_isWorkerPoolRunning()) {
+		if (sensor->reading) {
+			sensor->busy++;		// the bus is still on the last one, its values stand
+			return;
+		}
+
+		sensor->reading = true;
+		if (lp_submitWork(SensorReadWork, SensorReadDone, sensor)) {
+			return;
+		}
+		sensor->reading = false;	// queue full, read inline
+	}
+
+	StoreRead(sensor, sensor->read(values), values);
+}
+
+static void SensorReadHandler(EventLoopTimer* eventLoopTimer) {
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_ConsumeEventLoopTimeEvent);
+		return;
+	}
+
+	for (size_t i = 0; i < _sensorCount; i++) {
+		if (_sensors[i]->timer.eventLoopTimer == eventLoopTimer) {
+			ReadSensor(_sensors[i]);
+			return;
+		}
+	}
+}
+
+static void ArmPrefetch(int64_t delayNs) {
+	struct timespec delay = FromNs(delayNs > 0 ? delayNs : 1);	// a zero delay disarms
+
+	lp_setOneShotTimer(&prefetchTimer, &delay);
+}
+
+// Start the conversion and collect it with the sensor's own timer, which stays disarmed while prefetching
+static void PrefetchSensor(LP_SENSOR* sensor) {
+	if (sensor->start != NULL && !sensor->start()) {
+		sensor->reads++;
+		sensor->failures++;
+		return;
+	}
+
+	if (sensor->start == NULL || ToNs(&sensor->conversion) == 0) {
+		ReadSensor(sensor);
+		return;
+	}
+
+	lp_setOneShotTimer(&sensor->timer, &sensor->conversion);
+}
+
+/// <summary>
+///     Fires lead ahead of the telemetry timer, starts the prefetch sensors and follows the telemetry timer to
+///     its next expiry. A telemetry timer that was changed since is further off than lead, it is followed there
+///     and nothing is read, so the period after a lp_changeTimer is sent with values read on the old schedule.
+/// </summary>
+static void SensorPrefetchHandler(EventLoopTimer* eventLoopTimer) {
+	struct timespec remaining;
+	int64_t remainingNs;
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_ConsumeEventLoopTimeEvent);
+		return;
+	}
+
+	if (_telemetryTimer == NULL) {
+		return;
+	}
+
+	if (!lp_getTimerRemaining(_telemetryTimer, &remaining)) {
+		ArmPrefetch(_leadNs);	// not started yet, or a one-shot not armed, look again a lead later
+		return;
+	}
+
+	remainingNs = ToNs(&remaining);
+	if (remainingNs > _leadNs) {
+		ArmPrefetch(remainingNs - _leadNs);
+		return;
+	}
+
+	for (size_t i = 0; i < _sensorCount; i++) {
+		if (_sensors[i]->prefetch) {
+			PrefetchSensor(_sensors[i]);
+		}
+	}
+
+	// a periodic telemetry timer fires again a period after the expiry it is about to have
+	if (ToNs(&_telemetryTimer->period) > _leadNs) {
+		ArmPrefetch(remainingNs + ToNs(&_telemetryTimer->period) - _leadNs);
+	} else {
+		ArmPrefetch(_leadNs);
+	}
+}
+
+static void StartSensorTimer(LP_SENSOR* sensor) {
+	sensor->timer.period = Prefetching(sensor) ? (struct timespec){ 0, 0 } : sensor->period;	// zero starts it disarmed
+	sensor->timer.name = sensor->name;
+	sensor->timer.handler = SensorReadHandler;
+	if (sensor->readCostUs < LP_SENSOR_CHEAP_US) {
+		sensor->timer.slack = FromNs(ToNs(&sensor->period) / 4);
+	}
+
+	if (!lp_startTimer(&sensor->timer)) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: could not start the %s sensor timer\n", sensor->name);
+	}
+}
+
+/// <summary>
+///     Fill the cache and start each sensor's timer. Cheap sensors get a quarter period of slack so they
+///     ride along on other wakeups, costly ones run on time.
+/// </summary>
+void lp_startSensorSet(LP_SENSOR* sensorSet[], size_t sensorCount) {
+	_sensors = sensorSet;
+	_sensorCount = sensorCount;
+
+	for (size_t i = 0; i < _sensorCount; i++) {
+		LP_SENSOR* sensor = _sensors[i];
+
+		ReadSensor(sensor);
+		StartSensorTimer(sensor);
+	}
+
+	Log_Debug("Sensors read %u us a second\n", lp_getSensorLoadUs());
+}
+
+void lp_stopSensorSet(void) {
+	lp_stopTimer(&prefetchTimer);
+	_telemetryTimer = NULL;
+
+	for (size_t i = 0; i < _sensorCount; i++) {
+		lp_stopTimer(&_sensors[i]->timer);
+	}
+	_sensorCount = 0;
+}
+
+/// <summary>
+///     True before the first good read and once the sensor has missed its stale periods of reads
+/// </summary>
+bool lp_sensorIsStale(const LP_SENSOR* sensor) {
+	struct timespec now;
+	unsigned int periods = sensor->stalePeriods != 0 ? sensor->stalePeriods : LP_SENSOR_STALE_PERIODS;
+
+	if (sensor->sampledAt.tv_sec == 0 && sensor->sampledAt.tv_nsec == 0) {
+		return true;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	int64_t ageMs = (int64_t)(now.tv_sec - sensor->sampledAt.tv_sec) * 1000 + (now.tv_nsec - sensor->sampledAt.tv_nsec) / 1000000;
+	int64_t periodMs = ToNs(RefreshPeriod(sensor)) / 1000000;
+
+	return ageMs > periodMs * periods;
+}
+
+unsigned int lp_getSensorLoadUs(void) {
+	uint64_t load = 0;
+
+	for (size_t i = 0; i < _sensorCount; i++) {
+		uint64_t periodUs = (uint64_t)ToNs(RefreshPeriod(_sensors[i])) / 1000;
+		if (_sensors[i]->offload && lp_isWorkerPoolRunning()) {
+			continue;	// a worker's time
+		}
+		if (periodUs != 0) {
+			load += (uint64_t)_sensors[i]->readCostUs * 1000000 / periodUs;
+		}
+	}
+
+	return (unsigned int)load;
+}
+
+/// <summary>
+///     Read the prefetch sensors lead ahead of each telemetryTimer firing, their polling timers are disarmed
+///     and collect the conversions instead. A zero lead, or a NULL timer, goes back to polling them.
+/// </summary>
+bool lp_setSensorPrefetch(LP_TIMER* telemetryTimer, const struct timespec* lead) {
+	struct timespec remaining;
+	int64_t leadNs = lead != NULL ? ToNs(lead) : 0;
+
+	if (telemetryTimer == NULL || leadNs <= 0) {
+		lp_stopTimer(&prefetchTimer);
+		_telemetryTimer = NULL;
+
+		for (size_t i = 0; i < _sensorCount; i++) {
+			if (_sensors[i]->prefetch) {
+				lp_changeTimer(&_sensors[i]->timer, &_sensors[i]->period);
+			}
+		}
+		return true;
+	}
+
+	if (!lp_startTimer(&prefetchTimer)) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: could not start the sensor prefetch timer\n");
+		return false;
+	}
+
+	_telemetryTimer = telemetryTimer;
+	_leadNs = leadNs;
+
+	for (size_t i = 0; i < _sensorCount; i++) {
+		if (_sensors[i]->prefetch) {
+			lp_changeTimer(&_sensors[i]->timer, &(struct timespec){ 0, 0 });		// disarmed until a prefetch starts it
+			if (_sensors[i]->start != NULL && ToNs(&_sensors[i]->conversion) >= leadNs) {
+				LP_LOG(LP_LOG_WARNING, "WARNING: the %s sensor converts longer than the prefetch lead, its values are a period old\n", _sensors[i]->name);
+			}
+		}
+	}
+
+	if (lp_getTimerRemaining(telemetryTimer, &remaining) && ToNs(&remaining) > leadNs) {
+		ArmPrefetch(ToNs(&remaining) - leadNs);
+	} else {
+		ArmPrefetch(leadNs);
+	}
+
+	return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "logging.h"
+#include "timer.h"
+#include "worker_pool.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define LP_SENSOR_VALUES 4			// channels one sensor read returns
+#define LP_SENSOR_CHEAP_US 1000		// reads cheaper than this may run late to share a wakeup
+#define LP_SENSOR_STALE_PERIODS 3	// missed periods before the cached values are stale, when the sensor sets none
+
+// A sensor read at its own rate from the event loop, readers take the cached values and never wait
+typedef struct _lpSensor {
+	const char* name;
+	bool (*read)(float values[LP_SENSOR_VALUES]);	// false leaves the last good values cached
+	struct timespec period;				// the sensor's natural output data rate
+	unsigned int readCostUs;			// what one read costs the event loop
+	unsigned int stalePeriods;			// optional
+	bool prefetch;						// optional, read ahead of the telemetry timer once lp_setSensorPrefetch is called
+	bool (*start)(void);				// optional, starts a conversion that read collects conversion later
+	struct timespec conversion;
+	bool offload;						// optional, read runs on a worker once the worker pool is open, for reads that wait on a bus
+	float values[LP_SENSOR_VALUES];		// latest good read
+	struct timespec sampledAt;			// CLOCK_MONOTONIC of the latest good read, zero before the first
+	unsigned int reads;
+	unsigned int failures;
+	unsigned int busy;					// reads skipped with the last offloaded read not yet done
+	LP_TIMER timer;						// internal
+	bool reading;						// internal, an offloaded read is on a worker
+	bool readOk;						// internal, the worker's result, the event loop takes it in the done function
+	float readValues[LP_SENSOR_VALUES];
+} LP_SENSOR;
+
+// Reads every sensor once so the cache is filled, then starts their timers. An offload sensor's read function runs
+// on a worker and must touch only its values and a bus it serialises itself, its values are cached when the
+// worker is done, so a stalled bus holds up the worker and never the event loop.
+void lp_startSensorSet(LP_SENSOR* sensorSet[], size_t sensorCount);
+void lp_stopSensorSet(void);
+bool lp_sensorIsStale(const LP_SENSOR* sensor);
+// Event loop time the set uses, microseconds of reads a second
+unsigned int lp_getSensorLoadUs(void);
+
+// Reads the prefetch sensors lead ahead of each telemetryTimer firing instead of at their own period, so the
+// telemetry handler finds values a lead old for the price of one read a telemetry period. A sensor with a start
+// hook has its conversion started then and collected conversion later, so lead should cover the longest
+// conversion. A one-shot timer follows telemetryTimer's next expiry, it may be called before or after
+// lp_startSensorSet and keeps up with lp_changeTimer from the period after. A zero lead polls them again.
+bool lp_setSensorPrefetch(LP_TIMER* telemetryTimer, const struct timespec* lead);
@@ -0,0 +1,166 @@
+#pragma once
+
+// Anomaly model blob shared by the high-level (A7) library, which checks a model the cloud sends before passing it
+// on, the real-time (M4) apps, which run it, and tools/anomaly-model, which builds it. Header only and free of OS
+// dependencies so every core reads the same layout.
+//
+// The model is an int8 quantized autoencoder of fully connected layers over one window's features. The features are
+// normalised, z = (x - mean) * gain, and quantized to q = z / inputScale + inputZeroPoint. Each layer computes
+//
+//   out = requantize(bias + sum of weight * (in - inZeroPoint), multiplier, shift) + outZeroPoint
+//
+// clamped to int8, or from outZeroPoint up with LP_ANOMALY_RELU, the arithmetic of CMSIS-NN's arm_fully_connected_s8
+// with a per layer multiplier. A layer's inZeroPoint is the one before's outZeroPoint. The last layer reconstructs the
+// inputs at their own quantization, the score is the mean squared error of the reconstruction in z units squared,
+// and the model is active from a score of threshold until it falls below threshold less hysteresis.
+//
+// Blob:   header, inputs of (float mean, float gain), layers, uint32 FNV-1a checksum of the bytes before it
+// Header: "LPAM" format inputs layers inputZeroPoint, uint16 version, uint16 reserved, float inputScale threshold hysteresis
+// Layer:  outputs activation outZeroPoint shift, int32 multiplier, int32 bias[outputs], int8 weights[outputs][inputs]
+//
+// Values are little-endian and unaligned, a blob is read where it lies.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define LP_ANOMALY_MAGIC "LPAM"
+#define LP_ANOMALY_FORMAT 1
+#define LP_ANOMALY_HEADER_SIZE 24
+#define LP_ANOMALY_INPUT_SIZE (2 * sizeof(float))	// mean then gain
+#define LP_ANOMALY_LAYER_HEADER_SIZE 8
+#define LP_ANOMALY_CHECKSUM_SIZE sizeof(uint32_t)
+#define LP_ANOMALY_MAX_LAYERS 4
+#define LP_ANOMALY_MAX_WIDTH 32			// inputs and outputs of any layer
+#define LP_ANOMALY_MAX_SIZE 2048		// the inter-core link's fragmented message on both cores
+
+// LP_ANOMALY_LAYER activations
+typedef enum
+{
+	LP_ANOMALY_LINEAR,
+	LP_ANOMALY_RELU						// outputs below outZeroPoint, the quantized zero, are clamped to it
+} LP_ANOMALY_ACTIVATION;
+
+typedef struct
+{
+	uint8_t inputs;
+	uint8_t outputs;
+	uint8_t activation;			// an LP_ANOMALY_ACTIVATION
+	int8_t inZeroPoint;
+	int8_t outZeroPoint;
+	int8_t shift;				// of the requantization, left when positive
+	int32_t multiplier;			// q31, at least 0.5 unless zero
+	const uint8_t* bias;		// int32 per output, unaligned
+	const int8_t* weights;		// outputs rows of inputs
+} LP_ANOMALY_LAYER;
+
+// a checked blob, the pointers are into it so it must stay where it was parsed
+typedef struct
+{
+	uint16_t version;			// set by whoever built the model, reported with its scores
+	uint8_t inputs;
+	uint8_t layerCount;
+	int8_t inputZeroPoint;
+	float inputScale;
+	float threshold;
+	float hysteresis;
+	const uint8_t* normalisation;	// inputs pairs of float mean and gain, unaligned
+	LP_ANOMALY_LAYER layers[LP_ANOMALY_MAX_LAYERS];
+} LP_ANOMALY_MODEL;
+
+/// <summary>
+///     FNV-1a, the blob's trailer, catches a model truncated or garbled on its way from the tool
+/// </summary>
+static inline uint32_t lp_anomalyChecksum(const uint8_t* data, size_t length)
+{
+	uint32_t hash = 2166136261u;
+
+	for (size_t i = 0; i < length; i++)
+	{
+		hash = (hash ^ data[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+/// <summary>
+///     Check length bytes of blob and fill model from it, false when the blob is not a model this side can run: another
+///     format, a layer too wide, layer widths that do not chain, a last layer that does not reconstruct the inputs at
+///     their own quantization, a scale or threshold that is not positive, or a length or checksum that does not match
+/// </summary>
+static inline bool lp_anomalyModelParse(LP_ANOMALY_MODEL* model, const uint8_t* blob, size_t length)
+{
+	size_t offset = LP_ANOMALY_HEADER_SIZE;
+	uint32_t checksum;
+	uint8_t inputs;
+	int8_t inZeroPoint;
+
+	if (model == NULL || blob == NULL || length < LP_ANOMALY_HEADER_SIZE + LP_ANOMALY_CHECKSUM_SIZE || length > LP_ANOMALY_MAX_SIZE ||
+		memcmp(blob, LP_ANOMALY_MAGIC, 4) != 0 || blob[4] != LP_ANOMALY_FORMAT)
+	{
+		return false;
+	}
+
+	memcpy(&checksum, blob + length - LP_ANOMALY_CHECKSUM_SIZE, sizeof(checksum));
+	if (checksum != lp_anomalyChecksum(blob, length - LP_ANOMALY_CHECKSUM_SIZE))
+	{
+		return false;
+	}
+
+	memset(model, 0, sizeof(LP_ANOMALY_MODEL));
+	model->inputs = blob[5];
+	model->layerCount = blob[6];
+	model->inputZeroPoint = (int8_t)blob[7];
+	memcpy(&model->version, blob + 8, sizeof(uint16_t));
+	memcpy(&model->inputScale, blob + 12, sizeof(float));
+	memcpy(&model->threshold, blob + 16, sizeof(float));
+	memcpy(&model->hysteresis, blob + 20, sizeof(float));
+
+	if (model->inputs == 0 || model->inputs > LP_ANOMALY_MAX_WIDTH || model->layerCount == 0 || model->layerCount > LP_ANOMALY_MAX_LAYERS ||
+		!(model->inputScale > 0) || !(model->threshold > 0) || !(model->hysteresis >= 0) || model->hysteresis > model->threshold)
+	{
+		return false;	// written so a NaN fails too
+	}
+
+	model->normalisation = blob + offset;
+	offset += model->inputs * LP_ANOMALY_INPUT_SIZE;
+	inputs = model->inputs;
+	inZeroPoint = model->inputZeroPoint;
+
+	for (uint8_t i = 0; i < model->layerCount; i++)
+	{
+		LP_ANOMALY_LAYER* layer = &model->layers[i];
+		const uint8_t* header = blob + offset;
+
+		if (offset + LP_ANOMALY_LAYER_HEADER_SIZE > length - LP_ANOMALY_CHECKSUM_SIZE)
+		{
+			return false;
+		}
+
+		layer->inputs = inputs;
+		layer->outputs = header[0];
+		layer->activation = header[1];
+		layer->inZeroPoint = inZeroPoint;
+		layer->outZeroPoint = (int8_t)header[2];
+		layer->shift = (int8_t)header[3];
+		memcpy(&layer->multiplier, header + 4, sizeof(int32_t));
+		offset += LP_ANOMALY_LAYER_HEADER_SIZE;
+
+		if (layer->outputs == 0 || layer->outputs > LP_ANOMALY_MAX_WIDTH || layer->activation > LP_ANOMALY_RELU ||
+			layer->shift < -31 || layer->shift > 30 || layer->multiplier < 0)
+		{
+			return false;
+		}
+
+		layer->bias = blob + offset;
+		offset += layer->outputs * sizeof(int32_t);
+		layer->weights = (const int8_t*)(blob + offset);
+		offset += (size_t)layer->outputs * layer->inputs;
+
+		inputs = layer->outputs;
+		inZeroPoint = layer->outZeroPoint;
+	}
+
+	return offset == length - LP_ANOMALY_CHECKSUM_SIZE && inputs == model->inputs && inZeroPoint == model->inputZeroPoint;
+}
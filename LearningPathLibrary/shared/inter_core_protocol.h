@@ -0,0 +1,1012 @@
+#pragma once
+
+// Inter-core message protocol shared by the high-level (A7) library and the real-time (M4) apps.
+// Header only and free of OS dependencies so every core includes the same definitions.
+//
+// Frame:  [version][record count] record...
+// Record: [type][payload length] payload
+//
+// A request record sets LP_IC_SEQUENCED in its type and starts its payload with a 16 bit sequence number,
+// the peer echoes the sequence number in its response record so replies are matched to requests.
+//
+// Payload fields are little-endian and unaligned, both cores are little-endian ARM so values are copied raw.
+// Records of an unknown type are skipped by length, so new record types do not break older peers.
+//
+// A payload LP_IC_TRACE_SIZE longer than its record type carries a latency trace trailer. The A7 asks for a
+// trace by appending the trailer to a request, the real-time app fills it in on the response. Peers that
+// do not trace read the record as usual and ignore the extra bytes.
+//
+// A reading may also carry the real-time app's microsecond clock at its sample, LP_IC_STAMP_SIZE after the payload
+// and any trace trailer. The A7 keeps that clock in step with its own by LP_IC_TIME_SYNC exchanges and converts
+// the stamp to UTC, so a reading is dated when it was taken rather than when it was received. A payload 4 or 12
+// bytes longer than its record type is stamped, peers that do not stamp see a trace or nothing.
+//
+// A message too large for one frame, payloads up to LP_IC_MAX_MESSAGE_SIZE, goes as LP_IC_FRAGMENT records in order,
+// each carrying the message's type, its length and the next slice of its payload. The receiver reassembles them
+// into a buffer of its own with LP_IC_REASSEMBLY, a message that loses a fragment is abandoned.
+//
+// A direct method the A7 app forwards goes as an LP_IC_METHOD message, a correlation id and the method's code then
+// the invocation's payload as the hub sent it. The real-time app answers with an LP_IC_METHOD_RESPONSE of the same
+// id, its status then the response, which becomes the method response unchanged.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define LP_IC_PROTOCOL_VERSION 1
+#define LP_IC_FRAME_HEADER_SIZE 2
+#define LP_IC_RECORD_HEADER_SIZE 2
+#define LP_IC_MAX_FRAME_SIZE 236		// the M4 apps' 256 byte buffers less the 20 byte component header
+#define LP_IC_SEQUENCED 0x80			// record type flag, the payload starts with a sequence number
+#define LP_IC_SEQUENCE_SIZE 2
+#define LP_IC_MAX_RULES 4				// event rules a real-time app evaluates, numbered from zero
+#define LP_IC_THREAD_NAME_SIZE 16		// LP_IC_THREAD_PROFILE name, NUL terminated, longer names are truncated
+#define LP_IC_AUDIO_BANDS 8				// LP_IC_AUDIO_FEATURES octave bands, 31 to 62 Hz up to 4 to 8 kHz at 16 kHz capture
+#define LP_IC_MODBUS_POLLS 8				// LP_IC_MODBUS_POLL entries a real-time app reads, numbered from zero
+#define LP_IC_MODBUS_REGISTERS 16		// holding registers per poll, and per LP_IC_MODBUS_READINGS record
+#define LP_IC_JITTER_BINS 8				// LP_IC_SAMPLE_JITTER histogram, intervals off by 0, 1, 2-3, 4-7 ... 32-63, 64 us and more
+#define LP_IC_TRACE_SIZE (2 * sizeof(uint32_t))	// trace trailer, traceWaitUs then traceSampleUs
+#define LP_IC_STAMP_SIZE sizeof(uint32_t)		// sample stamp trailer, stampUs
+#define LP_IC_FRAGMENT_HEADER_SIZE 5			// LP_IC_FRAGMENT message and index, then the message type and length
+#define LP_IC_MAX_MESSAGE_SIZE 16384			// fragmented payload, 255 fragments in frames of their own, a side may hold less
+#define LP_IC_METHOD_HEADER_SIZE 3				// LP_IC_METHOD correlation id and LP_IC_METHOD_CODE, then the payload
+#define LP_IC_METHOD_RESPONSE_HEADER_SIZE 4		// LP_IC_METHOD_RESPONSE correlation id and status, then the response
+
+typedef enum
+{
+	LP_IC_UNKNOWN,
+	LP_IC_HEARTBEAT,
+	LP_IC_TEMPERATURE_PRESSURE_HUMIDITY,
+	LP_IC_EVENT_BUTTON_A,
+	LP_IC_EVENT_BUTTON_B,
+	LP_IC_SET_DESIRED_TEMPERATURE,
+	LP_IC_BLINK_RATE,
+	LP_IC_FLOW_CONTROL,					// real-time app outbound ring crossed a watermark, handled by the library
+	LP_IC_LED_PATTERN,					// status LED colour and blink, a colour of zero hands the LED back to the real-time app
+	LP_IC_ADC_SUMMARY,					// request names a channel and window, the response carries its buffered sample statistics
+	LP_IC_TELEMETRY_WINDOW,				// samples the real-time app aggregates per summary of a channel, zero stops the channel
+	LP_IC_TELEMETRY_SUMMARY,			// unsolicited, statistics of one completed window of a channel
+	LP_IC_ORIENTATION,					// unsolicited, device orientation fused from the accelerometer and gyro
+	LP_IC_RULE,							// sets or clears one event rule the real-time app evaluates on every sample of a channel
+	LP_IC_RULE_EVENT,					// unsolicited, a rule became active or cleared
+	LP_IC_PROFILE_REQUEST,				// asks for thread profiles now and then every period, a period of zero stops them
+	LP_IC_THREAD_PROFILE,				// one thread of a profile report, the report is one record per thread
+	LP_IC_HEAP_PROFILE,					// follows the thread records of a profile report from a real-time app with a heap
+	LP_IC_WATCHDOG,						// unsolicited, why the real-time core last reset, and the task about to make the watchdog reset it
+	LP_IC_AUDIO_CAPTURE,				// starts I2S capture with a feature vector every period, a period of zero stops it
+	LP_IC_AUDIO_FEATURES,				// unsolicited, sound level and octave band levels of the audio captured over one period
+	LP_IC_MODBUS_POLL,					// sets or clears one run of holding registers the real-time app reads from a Modbus slave every period
+	LP_IC_MODBUS_READINGS,				// unsolicited, the registers of one poll as read, or why they could not be
+	LP_IC_SAMPLE_JITTER,				// unsolicited, how far the intervals of the hardware timer sampling the real-time app were off
+	LP_IC_TIME_SYNC,					// request carries the A7's clock, the response adds the real-time app's clock on arrival
+	LP_IC_THERMOSTAT,					// how the real-time app controls the relay from the temperature, the setpoint is LP_IC_SET_DESIRED_TEMPERATURE
+	LP_IC_THERMOSTAT_STATUS,			// unsolicited, the relay as the thermostat left it, on every switch and now and then between
+	LP_IC_SENSOR_POLICY,				// IMU output data rate, FIFO watermark and gyro power, a rate of zero powers the IMU down
+	LP_IC_FRAGMENT,						// one slice of a message too large for a frame, reassembled before it is handled
+	LP_IC_ANOMALY_MODEL,				// fragmented only, a model blob for the real-time app's anomaly scoring, see anomaly_model_format.h
+	LP_IC_ANOMALY_SCORE,				// unsolicited, the anomaly score, when the model became active or cleared and now and then between
+	LP_IC_BUS_PROFILE,					// follows the thread records of a profile report, the I2C bus since the last report
+	LP_IC_METHOD,						// fragmented only, a direct method the A7 app forwards for the real-time app to answer
+	LP_IC_METHOD_RESPONSE				// fragmented only, the answer to one LP_IC_METHOD
+} LP_INTER_CORE_CMD;
+
+// channels the real-time apps aggregate for LP_IC_TELEMETRY_WINDOW and LP_IC_TELEMETRY_SUMMARY
+typedef enum
+{
+	LP_IC_CHANNEL_ACCELERATION,			// magnitude of the acceleration, mg
+	LP_IC_CHANNEL_ANGULAR_RATE,			// magnitude of the angular rate, dps
+	LP_IC_CHANNEL_COUNT
+} LP_IC_TELEMETRY_CHANNEL;
+
+// LP_IC_RULE conditions, the hysteresis is how far back past the threshold the value goes to clear the rule
+typedef enum
+{
+	LP_IC_RULE_NONE,					// rule cleared
+	LP_IC_RULE_ABOVE,					// active above the threshold
+	LP_IC_RULE_BELOW,					// active below the threshold
+	LP_IC_RULE_RATE						// active while the value changes faster than the threshold, units per second
+} LP_IC_RULE_KIND;
+
+// LP_IC_WATCHDOG causes of the last real-time core reset
+typedef enum
+{
+	LP_IC_RESET_POWER_ON,				// power on or the A7 restarting the real-time app
+	LP_IC_RESET_SOFTWARE,				// the real-time app reset itself
+	LP_IC_RESET_WATCHDOG				// the watchdog ran out, a task missed its deadline
+} LP_IC_RESET_CAUSE;
+
+// LP_IC_MODBUS_READINGS outcomes, other nonzero values are the exception code the slave answered with
+typedef enum
+{
+	LP_IC_MODBUS_OK = 0,
+	LP_IC_MODBUS_BAD_RESPONSE = 0xFE,	// wrong length, slave, function or CRC
+	LP_IC_MODBUS_TIMEOUT = 0xFF			// no answer within the response timeout
+} LP_IC_MODBUS_STATUS;
+
+// LP_IC_THERMOSTAT control laws
+typedef enum
+{
+	LP_IC_THERMOSTAT_OFF,				// relay held open
+	LP_IC_THERMOSTAT_HYSTERESIS,		// relay switched at the setpoint less and plus the hysteresis
+	LP_IC_THERMOSTAT_PID				// relay time proportioned over a window to the PID output
+} LP_IC_THERMOSTAT_MODE;
+
+// LP_IC_METHOD codes, the forwarded methods a real-time app answers, one that does not know the code answers 404
+typedef enum
+{
+	LP_IC_METHOD_NONE,					// not forwarded
+	LP_IC_METHOD_RT_STATUS				// the real-time app's uptime, link and sensor state
+} LP_IC_METHOD_CODE;
+
+// decoded form of one record, only the fields of the record type are set
+typedef struct
+{
+	LP_INTER_CORE_CMD cmd;
+	float	temperature;
+	float	pressure;
+	float	humidity;
+	int		blinkRate;
+	uint16_t sequence;		// request sequence number echoed in the response, zero when unsolicited
+	uint8_t congested;		// LP_IC_FLOW_CONTROL, nonzero while the sender's outbound ring is short of space
+	uint32_t ledColour;		// LP_IC_LED_PATTERN, 0xRRGGBB
+	uint16_t ledOnMs;		// LP_IC_LED_PATTERN, zero turns the LED off
+	uint16_t ledOffMs;		// LP_IC_LED_PATTERN, zero holds the colour steady
+	uint8_t adcChannel;		// LP_IC_ADC_SUMMARY, controller 0 channel 0 to 7
+	uint16_t adcSamples;	// LP_IC_ADC_SUMMARY, window requested, samples summarised in the response, zero for all buffered
+	uint16_t adcMin;		// LP_IC_ADC_SUMMARY, 12 bit codes, 2.5 V full scale
+	uint16_t adcMean;
+	uint16_t adcMax;
+	uint8_t telemetryChannel;	// LP_IC_TELEMETRY_WINDOW, LP_IC_TELEMETRY_SUMMARY, LP_IC_RULE and LP_IC_RULE_EVENT, an LP_IC_TELEMETRY_CHANNEL
+	uint16_t telemetrySamples;	// samples per window, samples in the summarised window
+	float	telemetryMin;		// LP_IC_TELEMETRY_SUMMARY, in the units of the channel
+	float	telemetryMax;
+	float	telemetryMean;
+	float	telemetryStdDev;
+	float	telemetryLast;
+	float	orientation[4];		// LP_IC_ORIENTATION, unit quaternion w, x, y, z from the sensor frame to the earth frame
+	uint8_t ruleId;				// LP_IC_RULE and LP_IC_RULE_EVENT, below LP_IC_MAX_RULES
+	uint8_t ruleKind;			// LP_IC_RULE, an LP_IC_RULE_KIND
+	uint8_t ruleActive;			// LP_IC_RULE_EVENT, nonzero when the rule became active, zero when it cleared
+	float	ruleThreshold;		// LP_IC_RULE, in the units of the channel
+	float	ruleHysteresis;
+	float	ruleValue;			// LP_IC_RULE_EVENT, the value, or rate of change, that crossed
+	uint16_t profilePeriod;		// LP_IC_PROFILE_REQUEST, seconds between reports
+	uint8_t profileThread;		// LP_IC_THREAD_PROFILE, index of the record in its report
+	uint8_t profileThreads;		// records in the report
+	char	profileName[LP_IC_THREAD_NAME_SIZE];
+	uint16_t profileCpuPermille;	// share of the cycles since the last report, parts per thousand
+	uint32_t profileSwitches;	// times the thread was scheduled since start
+	uint16_t profileStackUsed;	// stack high-water mark, bytes
+	uint16_t profileStackSize;
+	uint32_t heapSize;			// LP_IC_HEAP_PROFILE, bytes
+	uint32_t heapFree;
+	uint32_t heapMinFree;		// lowest free since start
+	uint8_t watchdogReset;		// LP_IC_WATCHDOG, an LP_IC_RESET_CAUSE
+	char	watchdogTask[LP_IC_THREAD_NAME_SIZE];	// LP_IC_WATCHDOG, the task that missed its deadline, empty in the report sent at start
+	uint8_t traced;				// any record, nonzero when it carries the trace trailer
+	uint32_t traceWaitUs;		// real-time app, request arrival to the sensor sample
+	uint32_t traceSampleUs;		// sample to the frame write, while queued on the real-time app the cycle count at the sample
+	uint32_t traceRoundTripUs;	// A7 only, not on the wire: request sent to response decoded
+	uint32_t traceReceivedUs;	// A7 only: CLOCK_MONOTONIC microseconds, wrapping, when ProcessMsg decoded the record
+	uint32_t traceDeliveredUs;	// A7 only: when it was passed to its response handler or the inter-core callback
+	uint8_t stamped;			// any record, nonzero when it carries the sample stamp trailer
+	uint32_t stampUs;			// real-time app microsecond clock, wrapping, when the reading was sampled
+	uint16_t audioPeriodMs;		// LP_IC_AUDIO_CAPTURE, milliseconds per feature vector, LP_IC_AUDIO_FEATURES, the period it covers
+	uint16_t audioFrames;		// LP_IC_AUDIO_FEATURES, FFT frames averaged, short of the period when the core lost some
+	float	audioRmsDbfs;		// LP_IC_AUDIO_FEATURES, dB relative to a full scale sine, -120 for silence
+	float	audioPeakDbfs;
+	float	audioBandDbfs[LP_IC_AUDIO_BANDS];
+	uint8_t modbusPoll;			// LP_IC_MODBUS_POLL and LP_IC_MODBUS_READINGS, below LP_IC_MODBUS_POLLS
+	uint8_t modbusSlave;		// slave address, 1 to 247
+	uint16_t modbusFirst;		// first holding register, zero based protocol address
+	uint8_t modbusCount;		// registers, up to LP_IC_MODBUS_REGISTERS, zero clears the poll
+	uint32_t modbusPeriodMs;	// LP_IC_MODBUS_POLL, milliseconds between reads
+	uint8_t modbusStatus;		// LP_IC_MODBUS_READINGS, an LP_IC_MODBUS_STATUS or the slave's exception code
+	uint16_t modbusValues[LP_IC_MODBUS_REGISTERS];	// LP_IC_MODBUS_READINGS, modbusCount of them when modbusStatus is LP_IC_MODBUS_OK
+	uint32_t jitterPeriodUs;	// LP_IC_SAMPLE_JITTER, the ideal interval
+	uint32_t jitterIntervals;	// intervals measured since the last report
+	uint32_t jitterMissed;		// samples skipped, the timer interrupt came too late to take them
+	int32_t jitterMinErrorUs;	// interval less the ideal, negative when short
+	int32_t jitterMaxErrorUs;
+	uint32_t jitterMaxLateUs;	// latest sample after its ideal time
+	uint32_t jitterHistogram[LP_IC_JITTER_BINS];	// intervals by how far they were off either way, LP_IC_JITTER_BINS
+	uint64_t syncA7Us;			// LP_IC_TIME_SYNC, A7 CLOCK_MONOTONIC microseconds when the request was sent, echoed
+	uint32_t syncRtUs;			// response, the real-time app's microsecond clock when the request arrived
+	uint8_t thermostatMode;		// LP_IC_THERMOSTAT and LP_IC_THERMOSTAT_STATUS, an LP_IC_THERMOSTAT_MODE
+	uint8_t thermostatCooling;	// LP_IC_THERMOSTAT, nonzero when the relay drives a cooler rather than a heater
+	float	thermostatHysteresis;	// degrees C either side of the setpoint
+	float	thermostatGains[3];	// PID proportional per degree, integral per degree second, derivative per degree per second
+	uint32_t thermostatWindowMs;	// PID relay period, the output is the share of it the relay is closed
+	uint8_t thermostatRelay;	// LP_IC_THERMOSTAT_STATUS, nonzero while closed, the temperature is in temperature
+	float	thermostatSetpoint;	// degrees C
+	float	thermostatOutput;	// 0 to 1, the share of the window the relay is closed
+	uint16_t policyOdrHz;		// LP_IC_SENSOR_POLICY, accelerometer and gyro rate, rounded to the nearest the IMU has
+	uint16_t policyWatermark;	// FIFO words per block the real-time app drains, zero for its default
+	uint8_t policyGyro;			// nonzero to batch the gyro, otherwise it is powered down and the angular rate reads zero
+	uint8_t fragmentMessage;	// LP_IC_FRAGMENT, numbers the messages, wrapping, so fragments of different ones are not joined
+	uint8_t fragmentIndex;		// slice of the message, from zero
+	uint8_t fragmentCmd;		// the message's type
+	uint16_t fragmentTotal;		// the message's payload bytes, all slices together
+	uint8_t fragmentLength;		// bytes in this slice
+	const uint8_t* fragmentData;	// not copied: the bytes to write, or the slice within the frame read
+	uint8_t anomalyActive;		// LP_IC_ANOMALY_SCORE, nonzero while the score is over the model's threshold
+	uint16_t anomalyModel;		// version of the model scoring, the one loaded once a LP_IC_ANOMALY_MODEL is taken
+	uint16_t anomalyWindows;	// feature windows scored since the last record
+	float	anomalyScore;		// highest of them, or on a change the window that made it
+	float	anomalyThreshold;
+	uint16_t busPermille;		// LP_IC_BUS_PROFILE, share of the time since the last report a transfer was on the bus, parts per thousand
+	uint32_t busRequests;		// transfers tasks asked for
+	uint32_t busTransfers;		// run on the bus, fewer than asked by the reads merged into another's
+	uint32_t busBytes;
+	uint32_t busMaxWaitUs;		// longest a task waited for its transfer to start
+	uint32_t busErrors;			// transfers failed or timed out
+
+} LP_INTER_CORE_BLOCK;
+
+typedef struct
+{
+	uint8_t* buffer;
+	size_t capacity;
+	size_t length;
+} LP_IC_FRAME_WRITER;
+
+typedef struct
+{
+	const uint8_t* buffer;
+	size_t length;
+	size_t offset;
+	uint8_t remaining;			// records not yet read
+} LP_IC_FRAME_READER;
+
+// splits one message into LP_IC_FRAGMENT records, the payload is read in place until the last is appended
+typedef struct
+{
+	const uint8_t* data;
+	uint16_t length;
+	uint16_t offset;			// bytes appended so far
+	uint8_t cmd;
+	uint8_t message;
+	uint8_t index;				// of the next fragment
+	bool started;
+} LP_IC_FRAGMENTER;
+
+// joins the fragments of one message at a time into buffer
+typedef struct
+{
+	uint8_t* buffer;
+	size_t capacity;
+	size_t received;
+	uint16_t total;
+	uint8_t cmd;
+	uint8_t message;
+	uint8_t next;				// index of the fragment expected
+	bool active;
+	uint32_t lost;				// messages abandoned, a fragment went missing or the message was larger than buffer
+} LP_IC_REASSEMBLY;
+
+/// <summary>
+///     Payload bytes of a record type, heartbeats and button events carry none
+/// </summary>
+static inline size_t lp_icPayloadSize(LP_INTER_CORE_CMD cmd)
+{
+	switch (cmd)
+	{
+	case LP_IC_TEMPERATURE_PRESSURE_HUMIDITY:
+		return 3 * sizeof(float);
+	case LP_IC_SET_DESIRED_TEMPERATURE:
+		return sizeof(float);
+	case LP_IC_BLINK_RATE:
+		return sizeof(int32_t);
+	case LP_IC_FLOW_CONTROL:
+		return sizeof(uint8_t);
+	case LP_IC_LED_PATTERN:
+		return 3 + 2 * sizeof(uint16_t);	// colour packed to 24 bits
+	case LP_IC_ADC_SUMMARY:
+		return sizeof(uint8_t) + 4 * sizeof(uint16_t);
+	case LP_IC_TELEMETRY_WINDOW:
+		return sizeof(uint8_t) + sizeof(uint16_t);
+	case LP_IC_TELEMETRY_SUMMARY:
+		return sizeof(uint8_t) + sizeof(uint16_t) + 5 * sizeof(float);
+	case LP_IC_ORIENTATION:
+		return 4 * sizeof(float);
+	case LP_IC_RULE:
+		return 3 * sizeof(uint8_t) + 2 * sizeof(float);
+	case LP_IC_RULE_EVENT:
+		return 3 * sizeof(uint8_t) + sizeof(float);
+	case LP_IC_PROFILE_REQUEST:
+		return sizeof(uint16_t);
+	case LP_IC_THREAD_PROFILE:
+		return 2 * sizeof(uint8_t) + LP_IC_THREAD_NAME_SIZE + 3 * sizeof(uint16_t) + sizeof(uint32_t);
+	case LP_IC_HEAP_PROFILE:
+		return 3 * sizeof(uint32_t);
+	case LP_IC_WATCHDOG:
+		return sizeof(uint8_t) + LP_IC_THREAD_NAME_SIZE;
+	case LP_IC_AUDIO_CAPTURE:
+		return sizeof(uint16_t);
+	case LP_IC_AUDIO_FEATURES:
+		return 2 * sizeof(uint16_t) + (2 + LP_IC_AUDIO_BANDS) * sizeof(float);
+	case LP_IC_MODBUS_POLL:
+		return 3 * sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint32_t);
+	case LP_IC_MODBUS_READINGS:
+		return 4 * sizeof(uint8_t) + (1 + LP_IC_MODBUS_REGISTERS) * sizeof(uint16_t);
+	case LP_IC_SAMPLE_JITTER:
+		return (6 + LP_IC_JITTER_BINS) * sizeof(uint32_t);
+	case LP_IC_TIME_SYNC:
+		return sizeof(uint64_t) + sizeof(uint32_t);
+	case LP_IC_THERMOSTAT:
+		return 2 * sizeof(uint8_t) + 4 * sizeof(float) + sizeof(uint32_t);
+	case LP_IC_THERMOSTAT_STATUS:
+		return 2 * sizeof(uint8_t) + 3 * sizeof(float);
+	case LP_IC_SENSOR_POLICY:
+		return 2 * sizeof(uint16_t) + sizeof(uint8_t);
+	case LP_IC_FRAGMENT:
+		return LP_IC_FRAGMENT_HEADER_SIZE;	// and the slice
+	case LP_IC_ANOMALY_SCORE:
+		return sizeof(uint8_t) + 2 * sizeof(uint16_t) + 2 * sizeof(float);
+	case LP_IC_BUS_PROFILE:
+		return sizeof(uint16_t) + 5 * sizeof(uint32_t);
+	default:
+		return 0;
+	}
+}
+
+static inline bool lp_icFrameBegin(LP_IC_FRAME_WRITER* writer, uint8_t* buffer, size_t capacity)
+{
+	writer->buffer = buffer;
+	writer->capacity = capacity < LP_IC_MAX_FRAME_SIZE ? capacity : LP_IC_MAX_FRAME_SIZE;
+	writer->length = 0;
+
+	if (writer->capacity < LP_IC_FRAME_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	buffer[0] = LP_IC_PROTOCOL_VERSION;
+	buffer[1] = 0;
+	writer->length = LP_IC_FRAME_HEADER_SIZE;
+
+	return true;
+}
+
+/// <summary>
+///     Append one record, false when the frame is full and the record was not written
+/// </summary>
+static inline bool lp_icFrameAppend(LP_IC_FRAME_WRITER* writer, const LP_INTER_CORE_BLOCK* block)
+{
+	bool fragment = block->cmd == LP_IC_FRAGMENT;
+	size_t payloadSize = lp_icPayloadSize(block->cmd) + (fragment ? block->fragmentLength : 0);
+	size_t sequenceSize = block->sequence != 0 && !fragment ? LP_IC_SEQUENCE_SIZE : 0;
+	size_t traceSize = block->traced && !fragment ? LP_IC_TRACE_SIZE : 0;
+	size_t stampSize = block->stamped && !fragment ? LP_IC_STAMP_SIZE : 0;	// a slice is any length, a fragment has no trailers
+	uint8_t* out;
+
+	if (writer->length < LP_IC_FRAME_HEADER_SIZE || writer->buffer[1] == UINT8_MAX ||
+		writer->length + LP_IC_RECORD_HEADER_SIZE + sequenceSize + payloadSize + traceSize + stampSize > writer->capacity)
+	{
+		return false;
+	}
+
+	out = writer->buffer + writer->length;
+	out[0] = (uint8_t)block->cmd | (sequenceSize > 0 ? LP_IC_SEQUENCED : 0);
+	out[1] = (uint8_t)(sequenceSize + payloadSize + traceSize + stampSize);
+	out += LP_IC_RECORD_HEADER_SIZE;
+
+	if (sequenceSize > 0)
+	{
+		memcpy(out, &block->sequence, LP_IC_SEQUENCE_SIZE);
+		out += LP_IC_SEQUENCE_SIZE;
+	}
+
+	if (traceSize > 0)
+	{
+		memcpy(out + payloadSize, &block->traceWaitUs, sizeof(uint32_t));
+		memcpy(out + payloadSize + sizeof(uint32_t), &block->traceSampleUs, sizeof(uint32_t));
+	}
+
+	if (stampSize > 0)
+	{
+		memcpy(out + payloadSize + traceSize, &block->stampUs, sizeof(uint32_t));
+	}
+
+	switch (block->cmd)
+	{
+	case LP_IC_TEMPERATURE_PRESSURE_HUMIDITY:
+		memcpy(out, &block->temperature, sizeof(float));
+		memcpy(out + sizeof(float), &block->pressure, sizeof(float));
+		memcpy(out + 2 * sizeof(float), &block->humidity, sizeof(float));
+		break;
+	case LP_IC_SET_DESIRED_TEMPERATURE:
+		memcpy(out, &block->temperature, sizeof(float));
+		break;
+	case LP_IC_BLINK_RATE:
+	{
+		int32_t blinkRate = (int32_t)block->blinkRate;
+		memcpy(out, &blinkRate, sizeof(int32_t));
+		break;
+	}
+	case LP_IC_FLOW_CONTROL:
+		out[0] = block->congested;
+		break;
+	case LP_IC_LED_PATTERN:
+		memcpy(out, &block->ledColour, 3);
+		memcpy(out + 3, &block->ledOnMs, sizeof(uint16_t));
+		memcpy(out + 3 + sizeof(uint16_t), &block->ledOffMs, sizeof(uint16_t));
+		break;
+	case LP_IC_ADC_SUMMARY:
+		out[0] = block->adcChannel;
+		memcpy(out + 1, &block->adcSamples, sizeof(uint16_t));
+		memcpy(out + 1 + sizeof(uint16_t), &block->adcMin, sizeof(uint16_t));
+		memcpy(out + 1 + 2 * sizeof(uint16_t), &block->adcMean, sizeof(uint16_t));
+		memcpy(out + 1 + 3 * sizeof(uint16_t), &block->adcMax, sizeof(uint16_t));
+		break;
+	case LP_IC_TELEMETRY_WINDOW:
+		out[0] = block->telemetryChannel;
+		memcpy(out + 1, &block->telemetrySamples, sizeof(uint16_t));
+		break;
+	case LP_IC_TELEMETRY_SUMMARY:
+		out[0] = block->telemetryChannel;
+		memcpy(out + 1, &block->telemetrySamples, sizeof(uint16_t));
+		out += 1 + sizeof(uint16_t);
+		memcpy(out, &block->telemetryMin, sizeof(float));
+		memcpy(out + sizeof(float), &block->telemetryMax, sizeof(float));
+		memcpy(out + 2 * sizeof(float), &block->telemetryMean, sizeof(float));
+		memcpy(out + 3 * sizeof(float), &block->telemetryStdDev, sizeof(float));
+		memcpy(out + 4 * sizeof(float), &block->telemetryLast, sizeof(float));
+		break;
+	case LP_IC_ORIENTATION:
+		memcpy(out, block->orientation, 4 * sizeof(float));
+		break;
+	case LP_IC_RULE:
+		out[0] = block->ruleId;
+		out[1] = block->ruleKind;
+		out[2] = block->telemetryChannel;
+		memcpy(out + 3, &block->ruleThreshold, sizeof(float));
+		memcpy(out + 3 + sizeof(float), &block->ruleHysteresis, sizeof(float));
+		break;
+	case LP_IC_RULE_EVENT:
+		out[0] = block->ruleId;
+		out[1] = block->telemetryChannel;
+		out[2] = block->ruleActive;
+		memcpy(out + 3, &block->ruleValue, sizeof(float));
+		break;
+	case LP_IC_PROFILE_REQUEST:
+		memcpy(out, &block->profilePeriod, sizeof(uint16_t));
+		break;
+	case LP_IC_THREAD_PROFILE:
+		out[0] = block->profileThread;
+		out[1] = block->profileThreads;
+		out += 2;
+		memcpy(out, block->profileName, LP_IC_THREAD_NAME_SIZE);
+		out += LP_IC_THREAD_NAME_SIZE;
+		memcpy(out, &block->profileCpuPermille, sizeof(uint16_t));
+		memcpy(out + sizeof(uint16_t), &block->profileSwitches, sizeof(uint32_t));
+		memcpy(out + sizeof(uint16_t) + sizeof(uint32_t), &block->profileStackUsed, sizeof(uint16_t));
+		memcpy(out + 2 * sizeof(uint16_t) + sizeof(uint32_t), &block->profileStackSize, sizeof(uint16_t));
+		break;
+	case LP_IC_HEAP_PROFILE:
+		memcpy(out, &block->heapSize, sizeof(uint32_t));
+		memcpy(out + sizeof(uint32_t), &block->heapFree, sizeof(uint32_t));
+		memcpy(out + 2 * sizeof(uint32_t), &block->heapMinFree, sizeof(uint32_t));
+		break;
+	case LP_IC_WATCHDOG:
+		out[0] = block->watchdogReset;
+		memcpy(out + 1, block->watchdogTask, LP_IC_THREAD_NAME_SIZE);
+		break;
+	case LP_IC_AUDIO_CAPTURE:
+		memcpy(out, &block->audioPeriodMs, sizeof(uint16_t));
+		break;
+	case LP_IC_AUDIO_FEATURES:
+		memcpy(out, &block->audioPeriodMs, sizeof(uint16_t));
+		memcpy(out + sizeof(uint16_t), &block->audioFrames, sizeof(uint16_t));
+		out += 2 * sizeof(uint16_t);
+		memcpy(out, &block->audioRmsDbfs, sizeof(float));
+		memcpy(out + sizeof(float), &block->audioPeakDbfs, sizeof(float));
+		memcpy(out + 2 * sizeof(float), block->audioBandDbfs, LP_IC_AUDIO_BANDS * sizeof(float));
+		break;
+	case LP_IC_MODBUS_POLL:
+		out[0] = block->modbusPoll;
+		out[1] = block->modbusSlave;
+		out[2] = block->modbusCount;
+		memcpy(out + 3, &block->modbusFirst, sizeof(uint16_t));
+		memcpy(out + 3 + sizeof(uint16_t), &block->modbusPeriodMs, sizeof(uint32_t));
+		break;
+	case LP_IC_MODBUS_READINGS:
+		out[0] = block->modbusPoll;
+		out[1] = block->modbusSlave;
+		out[2] = block->modbusCount;
+		out[3] = block->modbusStatus;
+		memcpy(out + 4, &block->modbusFirst, sizeof(uint16_t));
+		memcpy(out + 4 + sizeof(uint16_t), block->modbusValues, LP_IC_MODBUS_REGISTERS * sizeof(uint16_t));
+		break;
+	case LP_IC_SAMPLE_JITTER:
+		memcpy(out, &block->jitterPeriodUs, sizeof(uint32_t));
+		memcpy(out + sizeof(uint32_t), &block->jitterIntervals, sizeof(uint32_t));
+		memcpy(out + 2 * sizeof(uint32_t), &block->jitterMissed, sizeof(uint32_t));
+		memcpy(out + 3 * sizeof(uint32_t), &block->jitterMinErrorUs, sizeof(int32_t));
+		memcpy(out + 4 * sizeof(uint32_t), &block->jitterMaxErrorUs, sizeof(int32_t));
+		memcpy(out + 5 * sizeof(uint32_t), &block->jitterMaxLateUs, sizeof(uint32_t));
+		memcpy(out + 6 * sizeof(uint32_t), block->jitterHistogram, LP_IC_JITTER_BINS * sizeof(uint32_t));
+		break;
+	case LP_IC_TIME_SYNC:
+		memcpy(out, &block->syncA7Us, sizeof(uint64_t));
+		memcpy(out + sizeof(uint64_t), &block->syncRtUs, sizeof(uint32_t));
+		break;
+	case LP_IC_THERMOSTAT:
+		out[0] = block->thermostatMode;
+		out[1] = block->thermostatCooling;
+		memcpy(out + 2, &block->thermostatHysteresis, sizeof(float));
+		memcpy(out + 2 + sizeof(float), block->thermostatGains, 3 * sizeof(float));
+		memcpy(out + 2 + 4 * sizeof(float), &block->thermostatWindowMs, sizeof(uint32_t));
+		break;
+	case LP_IC_THERMOSTAT_STATUS:
+		out[0] = block->thermostatMode;
+		out[1] = block->thermostatRelay;
+		memcpy(out + 2, &block->temperature, sizeof(float));
+		memcpy(out + 2 + sizeof(float), &block->thermostatSetpoint, sizeof(float));
+		memcpy(out + 2 + 2 * sizeof(float), &block->thermostatOutput, sizeof(float));
+		break;
+	case LP_IC_SENSOR_POLICY:
+		memcpy(out, &block->policyOdrHz, sizeof(uint16_t));
+		memcpy(out + sizeof(uint16_t), &block->policyWatermark, sizeof(uint16_t));
+		out[2 * sizeof(uint16_t)] = block->policyGyro;
+		break;
+	case LP_IC_FRAGMENT:
+		out[0] = block->fragmentMessage;
+		out[1] = block->fragmentIndex;
+		out[2] = block->fragmentCmd;
+		memcpy(out + 3, &block->fragmentTotal, sizeof(uint16_t));
+		memcpy(out + LP_IC_FRAGMENT_HEADER_SIZE, block->fragmentData, block->fragmentLength);
+		break;
+	case LP_IC_ANOMALY_SCORE:
+		out[0] = block->anomalyActive;
+		memcpy(out + 1, &block->anomalyModel, sizeof(uint16_t));
+		memcpy(out + 1 + sizeof(uint16_t), &block->anomalyWindows, sizeof(uint16_t));
+		memcpy(out + 1 + 2 * sizeof(uint16_t), &block->anomalyScore, sizeof(float));
+		memcpy(out + 1 + 2 * sizeof(uint16_t) + sizeof(float), &block->anomalyThreshold, sizeof(float));
+		break;
+	case LP_IC_BUS_PROFILE:
+		memcpy(out, &block->busPermille, sizeof(uint16_t));
+		memcpy(out + sizeof(uint16_t), &block->busRequests, sizeof(uint32_t));
+		memcpy(out + sizeof(uint16_t) + sizeof(uint32_t), &block->busTransfers, sizeof(uint32_t));
+		memcpy(out + sizeof(uint16_t) + 2 * sizeof(uint32_t), &block->busBytes, sizeof(uint32_t));
+		memcpy(out + sizeof(uint16_t) + 3 * sizeof(uint32_t), &block->busMaxWaitUs, sizeof(uint32_t));
+		memcpy(out + sizeof(uint16_t) + 4 * sizeof(uint32_t), &block->busErrors, sizeof(uint32_t));
+		break;
+	default:
+		break;
+	}
+
+	writer->length += LP_IC_RECORD_HEADER_SIZE + sequenceSize + payloadSize + traceSize + stampSize;
+	writer->buffer[1]++;
+
+	return true;
+}
+
+/// <summary>
+///     Append a record lp_icFrameAppend encoded into another frame, its bytes after that frame's header, so a
+///     record encoded where it was produced is copied into the frame it goes out in without being decoded
+/// </summary>
+static inline bool lp_icFrameAppendEncoded(LP_IC_FRAME_WRITER* writer, const uint8_t* record, size_t length)
+{
+	if (writer->length < LP_IC_FRAME_HEADER_SIZE || writer->buffer[1] == UINT8_MAX || length < LP_IC_RECORD_HEADER_SIZE ||
+		writer->length + length > writer->capacity)
+	{
+		return false;
+	}
+
+	memcpy(writer->buffer + writer->length, record, length);
+	writer->length += length;
+	writer->buffer[1]++;
+
+	return true;
+}
+
+/// <summary>
+///     Length of the finished frame, zero when no record was appended
+/// </summary>
+static inline size_t lp_icFrameEnd(LP_IC_FRAME_WRITER* writer)
+{
+	return writer->length >= LP_IC_FRAME_HEADER_SIZE && writer->buffer[1] > 0 ? writer->length : 0;
+}
+
+/// <summary>
+///     Start reading a frame, false for a frame of another protocol version or a truncated header
+/// </summary>
+static inline bool lp_icFrameOpen(LP_IC_FRAME_READER* reader, const uint8_t* buffer, size_t length)
+{
+	reader->buffer = buffer;
+	reader->length = length;
+	reader->offset = LP_IC_FRAME_HEADER_SIZE;
+	reader->remaining = 0;
+
+	if (length < LP_IC_FRAME_HEADER_SIZE || buffer[0] != LP_IC_PROTOCOL_VERSION)
+	{
+		return false;
+	}
+
+	reader->remaining = buffer[1];
+	return true;
+}
+
+/// <summary>
+///     Decode the next known record into block, false at the end of the frame or on a truncated record
+/// </summary>
+static inline bool lp_icFrameNext(LP_IC_FRAME_READER* reader, LP_INTER_CORE_BLOCK* block)
+{
+	while (reader->remaining > 0 && reader->offset + LP_IC_RECORD_HEADER_SIZE <= reader->length)
+	{
+		const uint8_t* record = reader->buffer + reader->offset;
+		LP_INTER_CORE_CMD cmd = (LP_INTER_CORE_CMD)(record[0] & ~LP_IC_SEQUENCED);
+		size_t payloadSize = record[1];
+		const uint8_t* payload = record + LP_IC_RECORD_HEADER_SIZE;
+		uint16_t sequence = 0;
+
+		if (reader->offset + LP_IC_RECORD_HEADER_SIZE + payloadSize > reader->length)
+		{
+			break;
+		}
+
+		reader->offset += LP_IC_RECORD_HEADER_SIZE + payloadSize;
+		reader->remaining--;
+
+		if (record[0] & LP_IC_SEQUENCED)
+		{
+			if (payloadSize < LP_IC_SEQUENCE_SIZE)
+			{
+				continue;	// malformed, skipped
+			}
+			memcpy(&sequence, payload, LP_IC_SEQUENCE_SIZE);
+			payload += LP_IC_SEQUENCE_SIZE;
+			payloadSize -= LP_IC_SEQUENCE_SIZE;
+		}
+
+		if (payloadSize < lp_icPayloadSize(cmd))
+		{
+			continue;	// malformed, skipped
+		}
+
+		memset(block, 0, sizeof(LP_INTER_CORE_BLOCK));
+		block->cmd = cmd;
+		block->sequence = sequence;
+
+		if (cmd == LP_IC_FRAGMENT)
+		{
+			block->fragmentMessage = payload[0];
+			block->fragmentIndex = payload[1];
+			block->fragmentCmd = payload[2];
+			memcpy(&block->fragmentTotal, payload + 3, sizeof(uint16_t));
+			block->fragmentLength = (uint8_t)(payloadSize - LP_IC_FRAGMENT_HEADER_SIZE);
+			block->fragmentData = payload + LP_IC_FRAGMENT_HEADER_SIZE;
+			return true;
+		}
+
+		size_t extraSize = payloadSize - lp_icPayloadSize(cmd);
+
+		if (extraSize >= LP_IC_TRACE_SIZE)
+		{
+			block->traced = 1;
+			memcpy(&block->traceWaitUs, payload + lp_icPayloadSize(cmd), sizeof(uint32_t));
+			memcpy(&block->traceSampleUs, payload + lp_icPayloadSize(cmd) + sizeof(uint32_t), sizeof(uint32_t));
+		}
+
+		if (extraSize == LP_IC_STAMP_SIZE || extraSize == LP_IC_TRACE_SIZE + LP_IC_STAMP_SIZE)
+		{
+			block->stamped = 1;
+			memcpy(&block->stampUs, payload + payloadSize - LP_IC_STAMP_SIZE, sizeof(uint32_t));
+		}
+
+		switch (cmd)
+		{
+		case LP_IC_TEMPERATURE_PRESSURE_HUMIDITY:
+			memcpy(&block->temperature, payload, sizeof(float));
+			memcpy(&block->pressure, payload + sizeof(float), sizeof(float));
+			memcpy(&block->humidity, payload + 2 * sizeof(float), sizeof(float));
+			return true;
+		case LP_IC_SET_DESIRED_TEMPERATURE:
+			memcpy(&block->temperature, payload, sizeof(float));
+			return true;
+		case LP_IC_BLINK_RATE:
+		{
+			int32_t blinkRate;
+			memcpy(&blinkRate, payload, sizeof(int32_t));
+			block->blinkRate = (int)blinkRate;
+			return true;
+		}
+		case LP_IC_FLOW_CONTROL:
+			block->congested = payload[0];
+			return true;
+		case LP_IC_LED_PATTERN:
+			memcpy(&block->ledColour, payload, 3);
+			memcpy(&block->ledOnMs, payload + 3, sizeof(uint16_t));
+			memcpy(&block->ledOffMs, payload + 3 + sizeof(uint16_t), sizeof(uint16_t));
+			return true;
+		case LP_IC_ADC_SUMMARY:
+			block->adcChannel = payload[0];
+			memcpy(&block->adcSamples, payload + 1, sizeof(uint16_t));
+			memcpy(&block->adcMin, payload + 1 + sizeof(uint16_t), sizeof(uint16_t));
+			memcpy(&block->adcMean, payload + 1 + 2 * sizeof(uint16_t), sizeof(uint16_t));
+			memcpy(&block->adcMax, payload + 1 + 3 * sizeof(uint16_t), sizeof(uint16_t));
+			return true;
+		case LP_IC_TELEMETRY_WINDOW:
+			block->telemetryChannel = payload[0];
+			memcpy(&block->telemetrySamples, payload + 1, sizeof(uint16_t));
+			return true;
+		case LP_IC_TELEMETRY_SUMMARY:
+			block->telemetryChannel = payload[0];
+			memcpy(&block->telemetrySamples, payload + 1, sizeof(uint16_t));
+			payload += 1 + sizeof(uint16_t);
+			memcpy(&block->telemetryMin, payload, sizeof(float));
+			memcpy(&block->telemetryMax, payload + sizeof(float), sizeof(float));
+			memcpy(&block->telemetryMean, payload + 2 * sizeof(float), sizeof(float));
+			memcpy(&block->telemetryStdDev, payload + 3 * sizeof(float), sizeof(float));
+			memcpy(&block->telemetryLast, payload + 4 * sizeof(float), sizeof(float));
+			return true;
+		case LP_IC_ORIENTATION:
+			memcpy(block->orientation, payload, 4 * sizeof(float));
+			return true;
+		case LP_IC_RULE:
+			block->ruleId = payload[0];
+			block->ruleKind = payload[1];
+			block->telemetryChannel = payload[2];
+			memcpy(&block->ruleThreshold, payload + 3, sizeof(float));
+			memcpy(&block->ruleHysteresis, payload + 3 + sizeof(float), sizeof(float));
+			return true;
+		case LP_IC_RULE_EVENT:
+			block->ruleId = payload[0];
+			block->telemetryChannel = payload[1];
+			block->ruleActive = payload[2];
+			memcpy(&block->ruleValue, payload + 3, sizeof(float));
+			return true;
+		case LP_IC_PROFILE_REQUEST:
+			memcpy(&block->profilePeriod, payload, sizeof(uint16_t));
+			return true;
+		case LP_IC_THREAD_PROFILE:
+			block->profileThread = payload[0];
+			block->profileThreads = payload[1];
+			payload += 2;
+			memcpy(block->profileName, payload, LP_IC_THREAD_NAME_SIZE);
+			block->profileName[LP_IC_THREAD_NAME_SIZE - 1] = '\0';
+			payload += LP_IC_THREAD_NAME_SIZE;
+			memcpy(&block->profileCpuPermille, payload, sizeof(uint16_t));
+			memcpy(&block->profileSwitches, payload + sizeof(uint16_t), sizeof(uint32_t));
+			memcpy(&block->profileStackUsed, payload + sizeof(uint16_t) + sizeof(uint32_t), sizeof(uint16_t));
+			memcpy(&block->profileStackSize, payload + 2 * sizeof(uint16_t) + sizeof(uint32_t), sizeof(uint16_t));
+			return true;
+		case LP_IC_HEAP_PROFILE:
+			memcpy(&block->heapSize, payload, sizeof(uint32_t));
+			memcpy(&block->heapFree, payload + sizeof(uint32_t), sizeof(uint32_t));
+			memcpy(&block->heapMinFree, payload + 2 * sizeof(uint32_t), sizeof(uint32_t));
+			return true;
+		case LP_IC_WATCHDOG:
+			block->watchdogReset = payload[0];
+			memcpy(block->watchdogTask, payload + 1, LP_IC_THREAD_NAME_SIZE);
+			block->watchdogTask[LP_IC_THREAD_NAME_SIZE - 1] = '\0';
+			return true;
+		case LP_IC_AUDIO_CAPTURE:
+			memcpy(&block->audioPeriodMs, payload, sizeof(uint16_t));
+			return true;
+		case LP_IC_AUDIO_FEATURES:
+			memcpy(&block->audioPeriodMs, payload, sizeof(uint16_t));
+			memcpy(&block->audioFrames, payload + sizeof(uint16_t), sizeof(uint16_t));
+			payload += 2 * sizeof(uint16_t);
+			memcpy(&block->audioRmsDbfs, payload, sizeof(float));
+			memcpy(&block->audioPeakDbfs, payload + sizeof(float), sizeof(float));
+			memcpy(block->audioBandDbfs, payload + 2 * sizeof(float), LP_IC_AUDIO_BANDS * sizeof(float));
+			return true;
+		case LP_IC_MODBUS_POLL:
+			block->modbusPoll = payload[0];
+			block->modbusSlave = payload[1];
+			block->modbusCount = payload[2];
+			memcpy(&block->modbusFirst, payload + 3, sizeof(uint16_t));
+			memcpy(&block->modbusPeriodMs, payload + 3 + sizeof(uint16_t), sizeof(uint32_t));
+			return true;
+		case LP_IC_MODBUS_READINGS:
+			block->modbusPoll = payload[0];
+			block->modbusSlave = payload[1];
+			block->modbusCount = payload[2];
+			block->modbusStatus = payload[3];
+			memcpy(&block->modbusFirst, payload + 4, sizeof(uint16_t));
+			memcpy(block->modbusValues, payload + 4 + sizeof(uint16_t), LP_IC_MODBUS_REGISTERS * sizeof(uint16_t));
+			return true;
+		case LP_IC_SAMPLE_JITTER:
+			memcpy(&block->jitterPeriodUs, payload, sizeof(uint32_t));
+			memcpy(&block->jitterIntervals, payload + sizeof(uint32_t), sizeof(uint32_t));
+			memcpy(&block->jitterMissed, payload + 2 * sizeof(uint32_t), sizeof(uint32_t));
+			memcpy(&block->jitterMinErrorUs, payload + 3 * sizeof(uint32_t), sizeof(int32_t));
+			memcpy(&block->jitterMaxErrorUs, payload + 4 * sizeof(uint32_t), sizeof(int32_t));
+			memcpy(&block->jitterMaxLateUs, payload + 5 * sizeof(uint32_t), sizeof(uint32_t));
+			memcpy(block->jitterHistogram, payload + 6 * sizeof(uint32_t), LP_IC_JITTER_BINS * sizeof(uint32_t));
+			return true;
+		case LP_IC_TIME_SYNC:
+			memcpy(&block->syncA7Us, payload, sizeof(uint64_t));
+			memcpy(&block->syncRtUs, payload + sizeof(uint64_t), sizeof(uint32_t));
+			return true;
+		case LP_IC_THERMOSTAT:
+			block->thermostatMode = payload[0];
+			block->thermostatCooling = payload[1];
+			memcpy(&block->thermostatHysteresis, payload + 2, sizeof(float));
+			memcpy(block->thermostatGains, payload + 2 + sizeof(float), 3 * sizeof(float));
+			memcpy(&block->thermostatWindowMs, payload + 2 + 4 * sizeof(float), sizeof(uint32_t));
+			return true;
+		case LP_IC_THERMOSTAT_STATUS:
+			block->thermostatMode = payload[0];
+			block->thermostatRelay = payload[1];
+			memcpy(&block->temperature, payload + 2, sizeof(float));
+			memcpy(&block->thermostatSetpoint, payload + 2 + sizeof(float), sizeof(float));
+			memcpy(&block->thermostatOutput, payload + 2 + 2 * sizeof(float), sizeof(float));
+			return true;
+		case LP_IC_SENSOR_POLICY:
+			memcpy(&block->policyOdrHz, payload, sizeof(uint16_t));
+			memcpy(&block->policyWatermark, payload + sizeof(uint16_t), sizeof(uint16_t));
+			block->policyGyro = payload[2 * sizeof(uint16_t)];
+			return true;
+		case LP_IC_ANOMALY_SCORE:
+			block->anomalyActive = payload[0];
+			memcpy(&block->anomalyModel, payload + 1, sizeof(uint16_t));
+			memcpy(&block->anomalyWindows, payload + 1 + sizeof(uint16_t), sizeof(uint16_t));
+			memcpy(&block->anomalyScore, payload + 1 + 2 * sizeof(uint16_t), sizeof(float));
+			memcpy(&block->anomalyThreshold, payload + 1 + 2 * sizeof(uint16_t) + sizeof(float), sizeof(float));
+			return true;
+		case LP_IC_BUS_PROFILE:
+			memcpy(&block->busPermille, payload, sizeof(uint16_t));
+			memcpy(&block->busRequests, payload + sizeof(uint16_t), sizeof(uint32_t));
+			memcpy(&block->busTransfers, payload + sizeof(uint16_t) + sizeof(uint32_t), sizeof(uint32_t));
+			memcpy(&block->busBytes, payload + sizeof(uint16_t) + 2 * sizeof(uint32_t), sizeof(uint32_t));
+			memcpy(&block->busMaxWaitUs, payload + sizeof(uint16_t) + 3 * sizeof(uint32_t), sizeof(uint32_t));
+			memcpy(&block->busErrors, payload + sizeof(uint16_t) + 4 * sizeof(uint32_t), sizeof(uint32_t));
+			return true;
+		case LP_IC_HEARTBEAT:
+		case LP_IC_EVENT_BUTTON_A:
+		case LP_IC_EVENT_BUTTON_B:
+			return true;
+		default:
+			continue;	// newer record type, skipped by length
+		}
+	}
+
+	reader->remaining = 0;
+	return false;
+}
+
+/// <summary>
+///     Start splitting length bytes of data as message cmd, false when it is longer than LP_IC_MAX_MESSAGE_SIZE.
+///     message tells it from the messages before it, the sender numbers them
+/// </summary>
+static inline bool lp_icFragmentBegin(LP_IC_FRAGMENTER* fragmenter, uint8_t message, LP_INTER_CORE_CMD cmd, const void* data, size_t length)
+{
+	if (length > LP_IC_MAX_MESSAGE_SIZE)
+	{
+		return false;
+	}
+
+	fragmenter->data = (const uint8_t*)data;
+	fragmenter->length = (uint16_t)length;
+	fragmenter->offset = 0;
+	fragmenter->cmd = (uint8_t)cmd;
+	fragmenter->message = message;
+	fragmenter->index = 0;
+	fragmenter->started = false;
+
+	return true;
+}
+
+/// <summary>
+///     True once every fragment of the message has been appended
+/// </summary>
+static inline bool lp_icFragmentDone(const LP_IC_FRAGMENTER* fragmenter)
+{
+	return fragmenter->started && fragmenter->offset == fragmenter->length;
+}
+
+/// <summary>
+///     Append the next fragment, as much of the payload as the frame has room for, false when the message is done or
+///     the frame has no room for a fragment with at least one byte
+/// </summary>
+static inline bool lp_icFrameAppendFragment(LP_IC_FRAME_WRITER* writer, LP_IC_FRAGMENTER* fragmenter)
+{
+	size_t overhead = LP_IC_RECORD_HEADER_SIZE + LP_IC_FRAGMENT_HEADER_SIZE;
+	size_t remaining = (size_t)(fragmenter->length - fragmenter->offset);
+	size_t room = writer->capacity > writer->length + overhead ? writer->capacity - writer->length - overhead : 0;
+	size_t slice;
+
+	if (lp_icFragmentDone(fragmenter) || fragmenter->index == UINT8_MAX)
+	{
+		return false;
+	}
+
+	if (room > UINT8_MAX - LP_IC_FRAGMENT_HEADER_SIZE)
+	{
+		room = UINT8_MAX - LP_IC_FRAGMENT_HEADER_SIZE;
+	}
+
+	slice = remaining < room ? remaining : room;
+	if (slice == 0 && remaining > 0)
+	{
+		return false;
+	}
+
+	LP_INTER_CORE_BLOCK block = {
+		.cmd = LP_IC_FRAGMENT,
+		.fragmentMessage = fragmenter->message,
+		.fragmentIndex = fragmenter->index,
+		.fragmentCmd = fragmenter->cmd,
+		.fragmentTotal = fragmenter->length,
+		.fragmentLength = (uint8_t)slice,
+		.fragmentData = fragmenter->data + fragmenter->offset};
+
+	if (!lp_icFrameAppend(writer, &block))
+	{
+		return false;
+	}
+
+	fragmenter->offset += (uint16_t)slice;
+	fragmenter->index++;
+	fragmenter->started = true;
+
+	return true;
+}
+
+static inline void lp_icReassemblyInit(LP_IC_REASSEMBLY* reassembly, uint8_t* buffer, size_t capacity)
+{
+	memset(reassembly, 0, sizeof(LP_IC_REASSEMBLY));
+	reassembly->buffer = buffer;
+	reassembly->capacity = capacity;
+}
+
+static inline void lp_icReassemblyAbandon(LP_IC_REASSEMBLY* reassembly)
+{
+	if (reassembly->active)
+	{
+		reassembly->lost++;
+	}
+	reassembly->active = false;
+}
+
+/// <summary>
+///     Take one LP_IC_FRAGMENT record, true when it completed its message: cmd, buffer and total. Fragments come in
+///     order, a first fragment starts a new message and a gap abandons the one being joined
+/// </summary>
+static inline bool lp_icReassemble(LP_IC_REASSEMBLY* reassembly, const LP_INTER_CORE_BLOCK* fragment)
+{
+	if (fragment->fragmentIndex == 0)
+	{
+		lp_icReassemblyAbandon(reassembly);
+
+		if (fragment->fragmentTotal > reassembly->capacity)
+		{
+			reassembly->lost++;
+			return false;
+		}
+
+		reassembly->active = true;
+		reassembly->total = fragment->fragmentTotal;
+		reassembly->cmd = fragment->fragmentCmd;
+		reassembly->message = fragment->fragmentMessage;
+		reassembly->received = 0;
+		reassembly->next = 0;
+	}
+	else if (!reassembly->active || fragment->fragmentMessage != reassembly->message || fragment->fragmentIndex != reassembly->next)
+	{
+		lp_icReassemblyAbandon(reassembly);
+		return false;
+	}
+
+	if (reassembly->received + fragment->fragmentLength > reassembly->total)
+	{
+		lp_icReassemblyAbandon(reassembly);
+		return false;
+	}
+
+	memcpy(reassembly->buffer + reassembly->received, fragment->fragmentData, fragment->fragmentLength);
+	reassembly->received += fragment->fragmentLength;
+	reassembly->next++;
+
+	if (reassembly->received < reassembly->total)
+	{
+		return false;
+	}
+
+	reassembly->active = false;
+	return true;
+}
@@ -0,0 +1,260 @@
+#include "soak_monitor.h"
+#include "exit_codes.h"
+#include "logging.h"
+#include "terminate.h"
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+static void SoakMonitorHandler(EventLoopTimer* eventLoopTimer);
+
+static LP_TIMER soakMonitorTimer = {
+	.period = { LP_SOAK_DEFAULT_PERIOD_SECONDS, 0 },
+	.name = "soakMonitorTimer",
+	.handler = &SoakMonitorHandler,
+	.sampling = LP_TIMER_SAMPLE_SKIP		// how late it fires is the event loop lag the sample records
+};
+
+static LP_SOAK_SAMPLE _soakSamples[LP_SOAK_MAX_SAMPLES];
+static size_t _soakCount = 0;
+static uint32_t _stride = 1;		// samples offered per sample kept, doubles each time the samples are thinned
+static uint32_t _offered = 0;
+static struct timespec _startedAt;
+
+static const char* _metricNames[LP_SOAK_METRICS] = {
+	[LP_SOAK_HEAP_BYTES] = "heap_bytes",
+	[LP_SOAK_HEAP_OBJECTS] = "heap_objects",
+	[LP_SOAK_USER_MODE_KB] = "user_mode_kb",
+	[LP_SOAK_SLACK_KB] = "slack_kb",
+	[LP_SOAK_OPEN_FDS] = "open_fds",
+	[LP_SOAK_LAG_US] = "lag_us",
+};
+
+static uint32_t CountOpenFds(void) {
+	long limit = sysconf(_SC_OPEN_MAX);
+	uint32_t open = 0;
+
+	if (limit <= 0 || limit > LP_SOAK_MAX_FDS) {
+		limit = LP_SOAK_MAX_FDS;
+	}
+
+	for (int fd = 0; fd < limit; fd++) {
+		if (fcntl(fd, F_GETFD) != -1) {
+			open++;
+		}
+	}
+	return open;
+}
+
+static double MetricValue(const LP_SOAK_SAMPLE* sample, LP_SOAK_METRIC metric) {
+	switch (metric) {
+	case LP_SOAK_HEAP_BYTES:
+		return sample->heapBytes;
+	case LP_SOAK_HEAP_OBJECTS:
+		return sample->heapObjects;
+	case LP_SOAK_USER_MODE_KB:
+		return sample->userModeKB;
+	case LP_SOAK_SLACK_KB:
+		return sample->slackKB;
+	case LP_SOAK_OPEN_FDS:
+		return sample->openFds;
+	case LP_SOAK_LAG_US:
+		return sample->lagUs;
+	default:
+		return 0;
+	}
+}
+
+/// <summary>
+///     Keep every other sample and from now on every other one offered, so a soak of any length fits
+/// </summary>
+static void ThinSamples(void) {
+	for (size_t i = 0; i < _soakCount / 2; i++) {
+		_soakSamples[i] = _soakSamples[i * 2];
+	}
+	_soakCount /= 2;
+	_stride *= 2;
+}
+
+/// <summary>
+///     One sample at elapsedSeconds on the caller's clock, lagUs how late it was taken
+/// </summary>
+void lp_soakSample(uint32_t elapsedSeconds, uint32_t lagUs) {
+	LP_HEAP_STATS heap;
+	LP_EVENT_LOOP_STATS loop;
+	char record[LP_SOAK_RECORD_SIZE];
+
+	if (_offered == 0) {
+		lp_enableHeapAccounting(true);
+	}
+
+	if (_offered++ % _stride != 0) {
+		return;
+	}
+
+	// this one is offered at a multiple of twice the stride, it stays once the others are thinned
+	if (_soakCount == LP_SOAK_MAX_SAMPLES) {
+		ThinSamples();
+	}
+
+	lp_getHeapStats(&heap);
+	lp_getEventLoopStats(&loop);
+
+	LP_SOAK_SAMPLE* sample = &_soakSamples[_soakCount++];
+	uint32_t heapKB = heap.total.bytes / 1024;
+
+	*sample = (LP_SOAK_SAMPLE){
+		.elapsedS = elapsedSeconds,
+		.heapBytes = heap.total.bytes,
+		.heapObjects = heap.total.objects,
+		.userModeKB = heap.userModeKB,
+		.peakUserModeKB = heap.peakUserModeKB,
+		.slackKB = heap.userModeKB > heapKB ? heap.userModeKB - heapKB : 0,
+		.openFds = CountOpenFds(),
+		.lagUs = lagUs,
+		.loopLagMaxUs = loop.lagMaxUs };
+
+	if (lp_formatSoakSample(sample, record, sizeof(record)) > 0) {
+		LP_LOG(LP_LOG_INFO, "Soak: %s\n", record);
+	}
+}
+
+void lp_resetSoakSamples(void) {
+	_soakCount = 0;
+	_stride = 1;
+	_offered = 0;
+}
+
+size_t lp_getSoakSamples(const LP_SOAK_SAMPLE** samples) {
+	if (samples != NULL) {
+		*samples = _soakSamples;
+	}
+	return _soakCount;
+}
+
+/// <summary>
+///     The least squares slope per day over the second half, the first half is the warm up
+/// </summary>
+bool lp_getSoakTrend(LP_SOAK_METRIC metric, LP_SOAK_TREND* trend) {
+	size_t from = _soakCount / 2;
+	size_t n = _soakCount - from;
+	double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+
+	if (trend == NULL || metric >= LP_SOAK_METRICS || n < 2) {
+		return false;
+	}
+
+	*trend = (LP_SOAK_TREND){
+		.metric = metric,
+		.first = MetricValue(&_soakSamples[0], metric),
+		.last = MetricValue(&_soakSamples[_soakCount - 1], metric) };
+
+	for (size_t i = 0; i < _soakCount; i++) {
+		trend->max = fmax(trend->max, MetricValue(&_soakSamples[i], metric));
+	}
+
+	for (size_t i = from; i < _soakCount; i++) {
+		double x = (_soakSamples[i].elapsedS - _soakSamples[from].elapsedS) / 86400.0;
+		double y = MetricValue(&_soakSamples[i], metric);
+
+		sumX += x;
+		sumY += y;
+		sumXX += x * x;
+		sumXY += x * y;
+	}
+
+	double spread = n * sumXX - sumX * sumX;
+	double days = (_soakSamples[_soakCount - 1].elapsedS - _soakSamples[0].elapsedS) / 86400.0;
+	double growth;
+
+	trend->perDay = spread > 0 ? (n * sumXY - sumX * sumY) / spread : 0;
+	growth = trend->perDay * days;
+	trend->growing = metric != LP_SOAK_LAG_US && growth >= 1 && growth * 1000 >= sumY / n * LP_SOAK_GROWTH_PERMILLE;
+
+	return true;
+}
+
+const char* lp_soakMetricName(LP_SOAK_METRIC metric) {
+	return metric < LP_SOAK_METRICS ? _metricNames[metric] : "unknown";
+}
+
+/// <summary>
+///     elapsed_s,heap_bytes,heap_objects,user_mode_kb,peak_user_mode_kb,slack_kb,open_fds,lag_us,loop_lag_max_us
+/// </summary>
+int lp_formatSoakSample(const LP_SOAK_SAMPLE* sample, char* buffer, size_t size) {
+	int len = snprintf(buffer, size, "%u,%u,%u,%u,%u,%u,%u,%u,%u", sample->elapsedS, sample->heapBytes, sample->heapObjects,
+		sample->userModeKB, sample->peakUserModeKB, sample->slackKB, sample->openFds, sample->lagUs, sample->loopLagMaxUs);
+
+	return len < 0 || (size_t)len >= size ? -1 : len;
+}
+
+/// <summary>
+///     metric,first,last,max,per_day,growing
+/// </summary>
+int lp_formatSoakTrend(const LP_SOAK_TREND* trend, char* buffer, size_t size) {
+	int len = snprintf(buffer, size, "%s,%.0f,%.0f,%.0f,%.2f,%d", lp_soakMetricName(trend->metric), trend->first, trend->last,
+		trend->max, trend->perDay, trend->growing);
+
+	return len < 0 || (size_t)len >= size ? -1 : len;
+}
+
+/// <summary>
+///     Sample every periodSeconds, zero or less for LP_SOAK_DEFAULT_PERIOD_SECONDS
+/// </summary>
+bool lp_startSoakMonitor(int periodSeconds) {
+	if (soakMonitorTimer.eventLoopTimer != NULL) {
+		return true;
+	}
+
+	soakMonitorTimer.period.tv_sec = periodSeconds > 0 ? periodSeconds : LP_SOAK_DEFAULT_PERIOD_SECONDS;
+	lp_resetSoakSamples();
+	clock_gettime(CLOCK_MONOTONIC, &_startedAt);
+
+	if (!lp_startTimer(&soakMonitorTimer)) {
+		return false;
+	}
+
+	LP_LOG(LP_LOG_INFO, "Soak: elapsed_s,heap_bytes,heap_objects,user_mode_kb,peak_user_mode_kb,slack_kb,open_fds,lag_us,loop_lag_max_us every %ld s\n",
+		(long)soakMonitorTimer.period.tv_sec);
+	lp_soakSample(0, 0);
+
+	return true;
+}
+
+/// <summary>
+///     Stops sampling and logs the trends, the samples are kept for lp_getSoakSamples
+/// </summary>
+void lp_stopSoakMonitor(void) {
+	LP_SOAK_TREND trend;
+	char record[LP_SOAK_RECORD_SIZE];
+
+	if (soakMonitorTimer.eventLoopTimer == NULL) {
+		return;
+	}
+
+	lp_stopTimer(&soakMonitorTimer);
+
+	for (LP_SOAK_METRIC metric = 0; metric < LP_SOAK_METRICS; metric++) {
+		if (lp_getSoakTrend(metric, &trend) && lp_formatSoakTrend(&trend, record, sizeof(record)) > 0) {
+			LP_LOG(LP_LOG_INFO, "Soak trend: %s\n", record);
+		}
+	}
+}
+
+static void SoakMonitorHandler(EventLoopTimer* eventLoopTimer) {
+	struct timespec scheduled, now;
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_SoakMonitorHandler);
+		return;
+	}
+
+	GetEventLoopTimerScheduledTime(eventLoopTimer, &scheduled);
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	int64_t lateUs = ((int64_t)now.tv_sec - scheduled.tv_sec) * 1000000 + (now.tv_nsec - scheduled.tv_nsec) / 1000;
+
+	lp_soakSample((uint32_t)(now.tv_sec - _startedAt.tv_sec), lateUs > 0 ? (uint32_t)lateUs : 0);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "event_loop.h"
+#include "heap_stats.h"
+#include "timer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LP_SOAK_DEFAULT_PERIOD_SECONDS 3600
+#define LP_SOAK_MAX_SAMPLES 768			// a month of hourly samples, longer soaks keep every other one
+#define LP_SOAK_MAX_FDS 1024			// descriptors probed for the open count
+#define LP_SOAK_GROWTH_PERMILLE 50		// growth over the soak, of the metric's mean, that marks a trend as growing
+#define LP_SOAK_RECORD_SIZE 160
+
+typedef struct LP_SOAK_SAMPLE
+{
+	uint32_t elapsedS;					// on the soak's clock, accelerated on the host harness
+	uint32_t heapBytes;					// live lp_heap bytes and objects
+	uint32_t heapObjects;
+	uint32_t userModeKB;
+	uint32_t peakUserModeKB;
+	uint32_t slackKB;					// user mode memory less the live heap, grows with fragmentation while the heap does not
+	uint32_t openFds;
+	uint32_t lagUs;						// how late the sample was taken, the event loop's lag at that moment
+	uint32_t loopLagMaxUs;				// LP_EVENT_LOOP_STATS lagMaxUs, zero without lp_runEventLoop
+} LP_SOAK_SAMPLE;
+
+typedef enum {
+	LP_SOAK_HEAP_BYTES,
+	LP_SOAK_HEAP_OBJECTS,
+	LP_SOAK_USER_MODE_KB,
+	LP_SOAK_SLACK_KB,
+	LP_SOAK_OPEN_FDS,
+	LP_SOAK_LAG_US,
+	LP_SOAK_METRICS
+} LP_SOAK_METRIC;
+
+typedef struct LP_SOAK_TREND
+{
+	LP_SOAK_METRIC metric;
+	double first;
+	double last;
+	double max;
+	double perDay;						// least squares slope over the second half of the samples
+	bool growing;						// perDay over the soak is LP_SOAK_GROWTH_PERMILLE of the mean or more, lag is never
+} LP_SOAK_TREND;
+
+// Samples what a slow leak shows up in after weeks in the field, the live heap, the user mode memory and the
+// part of it the heap does not account for, the open descriptors and the event loop lag, and fits a trend to
+// each. The first half of a soak is taken as warm up, caches and queues fill, the trends are fitted to the
+// second half. lp_startSoakMonitor samples on an LP_TIMER every periodSeconds on the device, alongside the app's
+// own traffic or a synthetic load, see synthetic_load.h; the host harness calls lp_soakSample on its accelerated
+// clock instead. Heap accounting is enabled at the first sample, blocks allocated before are not counted.
+//
+// Start it on the device from the "--soak=" command line argument, see soakArgs in globals.h, and read the
+// samples off the debug log, one LP_SOAK_RECORD_SIZE CSV line each.
+bool lp_startSoakMonitor(int periodSeconds);
+void lp_stopSoakMonitor(void);
+void lp_soakSample(uint32_t elapsedSeconds, uint32_t lagUs);
+void lp_resetSoakSamples(void);
+size_t lp_getSoakSamples(const LP_SOAK_SAMPLE** samples);
+// false with fewer than two samples in the second half
+bool lp_getSoakTrend(LP_SOAK_METRIC metric, LP_SOAK_TREND* trend);
+const char* lp_soakMetricName(LP_SOAK_METRIC metric);
+int lp_formatSoakSample(const LP_SOAK_SAMPLE* sample, char* buffer, size_t size);
+int lp_formatSoakTrend(const LP_SOAK_TREND* trend, char* buffer, size_t size);
@@ -0,0 +1,687 @@
+#include "storage_journal.h"
+#include "exit_codes.h"
+#include "terminate.h"
+#include <applibs/storage.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LP_JOURNAL_MAGIC 0x4C504A4E				// "LPJN"
+#define JOURNAL_SLOT_SIZE 32
+#define JOURNAL_LOG_OFFSET (2 * JOURNAL_SLOT_SIZE)
+
+typedef enum {
+	JOURNAL_DATA = 1,
+	JOURNAL_CONSUMED,			// payload the sequence of the last record consumed
+	JOURNAL_STATE,
+	JOURNAL_WRAP				// the log goes on at the start, the rest of the region is unused
+} JOURNAL_RECORD_TYPE;
+
+typedef struct {
+	uint32_t sequence;			// one more than the record before, a record left from an earlier lap breaks the run
+	uint8_t type;
+	uint8_t reserved[3];
+	uint32_t length;			// payload bytes, the record is padded to a multiple of four
+	uint32_t crc;				// of the header with crc zero and the payload
+} JOURNAL_RECORD;
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t reserved;
+	uint32_t logSize;
+	uint32_t epoch;				// the slot with the newer epoch is current
+	uint32_t start;
+	uint32_t sequence;			// of the record at start
+	uint32_t crc;
+} JOURNAL_CHECKPOINT;
+
+// kept free by appends for the records a commit or a checkpoint adds, the last consumed, a wrap and the state
+#define JOURNAL_RESERVE (3 * sizeof(JOURNAL_RECORD) + sizeof(uint32_t) + LP_JOURNAL_STATE_SIZE)
+
+static void JournalCommitHandler(EventLoopTimer* eventLoopTimer);
+
+static LP_TIMER journalCommitTimer = {
+	.period = { 0, 0 },			// one-shot timer, armed by the first change after a commit
+	.name = "journalCommitTimer",
+	.handler = &JournalCommitHandler
+};
+
+static LP_JOURNAL* _journals = NULL;
+static bool _commitArmed = false;
+
+static const uint32_t _crcNibbles[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+/// <summary>
+///     CRC-32 (IEEE) a nibble at a time, a 64 byte table rather than 1 KB for the few hundred bytes of a record
+/// </summary>
+static uint32_t JournalCrc(uint32_t crc, const void* data, size_t length) {
+	const uint8_t* bytes = (const uint8_t*)data;
+
+	crc = ~crc;
+	while (length-- > 0) {
+		crc ^= *bytes++;
+		crc = (crc >> 4) ^ _crcNibbles[crc & 15];
+		crc = (crc >> 4) ^ _crcNibbles[crc & 15];
+	}
+	return ~crc;
+}
+
+static uint32_t JournalRecordCrc(const JOURNAL_RECORD* header, const void* payload) {
+	JOURNAL_RECORD zeroed = *header;
+
+	zeroed.crc = 0;
+	return JournalCrc(JournalCrc(0, &zeroed, sizeof(zeroed)), payload, header->length);
+}
+
+static uint32_t JournalSpan(uint32_t length) {
+	return (uint32_t)sizeof(JOURNAL_RECORD) + ((length + 3) & ~3u);
+}
+
+static bool JournalIsBefore(uint32_t sequence, uint32_t other) {
+	return (int32_t)(sequence - other) < 0;
+}
+
+// a record never straddles the end of the log, fewer bytes than a header left there wrap without a WRAP record
+static uint32_t JournalNormalize(const LP_JOURNAL* journal, uint32_t position) {
+	return position + sizeof(JOURNAL_RECORD) > journal->logSize ? 0 : position;
+}
+
+static uint32_t JournalNext(const LP_JOURNAL* journal, uint32_t position, const JOURNAL_RECORD* header) {
+	return header->type == JOURNAL_WRAP ? 0 : JournalNormalize(journal, position + JournalSpan(header->length));
+}
+
+static uint32_t JournalTail(const LP_JOURNAL* journal) {
+	return journal->committed + journal->batchLength;
+}
+
+// bytes the log can grow by before it reaches the checkpoint
+static uint32_t JournalFree(const LP_JOURNAL* journal, uint32_t tail) {
+	return journal->start > tail ? journal->start - tail : journal->logSize - tail + journal->start;
+}
+
+static off_t JournalFileOffset(const LP_JOURNAL* journal, uint32_t position) {
+	return (off_t)journal->offset + JOURNAL_LOG_OFFSET + position;
+}
+
+static bool JournalRead(const LP_JOURNAL* journal, uint32_t position, void* buffer, uint32_t length) {
+	if (position >= journal->committed && position < JournalTail(journal)) {
+		memcpy(buffer, journal->batch + (position - journal->committed), length);
+		return true;
+	}
+	return pread(journal->fd, buffer, length, JournalFileOffset(journal, position)) == (ssize_t)length;
+}
+
+static bool JournalReserveRead(LP_JOURNAL* journal, uint32_t length) {
+	if (length > journal->readCapacity) {
+		uint8_t* read = (uint8_t*)lp_heapRealloc(LP_HEAP_JOURNAL, journal->read, length);
+		if (read == NULL) {
+			return false;
+		}
+		journal->read = read;
+		journal->readCapacity = length;
+	}
+	return true;
+}
+
+/// <summary>
+///     Read the record at position into the read buffer, false unless it is the expected one and whole
+/// </summary>
+static bool JournalReadRecord(LP_JOURNAL* journal, uint32_t position, uint32_t sequence, JOURNAL_RECORD* header) {
+	if (!JournalRead(journal, position, header, sizeof(JOURNAL_RECORD)) || header->sequence != sequence ||
+		header->type < JOURNAL_DATA || header->type > JOURNAL_WRAP || header->length > journal->logSize - position - sizeof(JOURNAL_RECORD) ||
+		(header->type == JOURNAL_WRAP && header->length != 0)) {
+		return false;
+	}
+
+	if (!JournalReserveRead(journal, header->length) ||
+		!JournalRead(journal, position + (uint32_t)sizeof(JOURNAL_RECORD), journal->read, header->length)) {
+		return false;
+	}
+
+	return JournalRecordCrc(header, journal->read) == header->crc;
+}
+
+/// <summary>
+///     Write the batch with one write and an fsync, the unit of flash wear the batch exists for
+/// </summary>
+static bool JournalWrite(LP_JOURNAL* journal) {
+	if (journal->batchLength == 0) {
+		return true;
+	}
+
+	if (pwrite(journal->fd, journal->batch, journal->batchLength, JournalFileOffset(journal, journal->committed)) != (ssize_t)journal->batchLength ||
+		fsync(journal->fd) != 0) {
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: Journal %s write failed: %s (%d)\n", journal->name, strerror(errno), errno);
+		return false;
+	}
+
+	journal->stats.commits++;
+	journal->stats.bytesWritten += journal->batchLength;
+	journal->committed = JournalNormalize(journal, journal->committed + journal->batchLength);
+	journal->batchLength = 0;
+
+	return true;
+}
+
+// a record larger than the batch goes straight out at committed, the batch written before it
+static bool JournalWriteThrough(LP_JOURNAL* journal, const JOURNAL_RECORD* header, const void* payload) {
+	off_t at = JournalFileOffset(journal, journal->committed);
+
+	if (pwrite(journal->fd, header, sizeof(JOURNAL_RECORD), at) != (ssize_t)sizeof(JOURNAL_RECORD) ||
+		pwrite(journal->fd, payload, header->length, at + (off_t)sizeof(JOURNAL_RECORD)) != (ssize_t)header->length ||
+		fsync(journal->fd) != 0) {
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: Journal %s write failed: %s (%d)\n", journal->name, strerror(errno), errno);
+		return false;
+	}
+
+	journal->stats.commits++;
+	journal->stats.bytesWritten += JournalSpan(header->length);
+	journal->committed = JournalNormalize(journal, journal->committed + JournalSpan(header->length));
+
+	return true;
+}
+
+/// <summary>
+///     Add a record to the batch, reserve bytes left free after it. A record that does not fit before the end of
+///     the log is preceded by a WRAP record and goes at the start, the batch before it written first
+/// </summary>
+static bool JournalPut(LP_JOURNAL* journal, uint8_t type, const void* payload, uint32_t length, uint32_t reserve, uint32_t* position) {
+	uint32_t span = JournalSpan(length);
+	uint32_t tail = JournalTail(journal);
+	bool wrap = tail + span > journal->logSize;
+	uint32_t need = wrap ? journal->logSize - tail + span : span;
+	uint32_t capacity = journal->batchCapacity + (type == JOURNAL_DATA ? 0 : (uint32_t)JOURNAL_RESERVE);
+	JOURNAL_RECORD header;
+
+	if (need + reserve >= JournalFree(journal, tail)) {
+		return false;
+	}
+
+	if (wrap) {
+		if (journal->logSize - tail >= sizeof(JOURNAL_RECORD)) {
+			JOURNAL_RECORD marker = { .sequence = journal->nextSequence, .type = JOURNAL_WRAP };
+
+			if (journal->batchLength + sizeof(marker) > journal->batchCapacity + JOURNAL_RESERVE && !JournalWrite(journal)) {
+				return false;
+			}
+			marker.crc = JournalRecordCrc(&marker, NULL);
+			memcpy(journal->batch + journal->batchLength, &marker, sizeof(marker));
+			journal->batchLength += (uint32_t)sizeof(marker);
+
+			if (!JournalWrite(journal)) {
+				journal->batchLength -= (uint32_t)sizeof(marker);
+				return false;
+			}
+			journal->nextSequence++;
+		}
+		else if (!JournalWrite(journal)) {
+			return false;
+		}
+		journal->committed = 0;
+		tail = 0;
+	}
+
+	header = (JOURNAL_RECORD){ .sequence = journal->nextSequence, .type = type, .length = length };
+	header.crc = JournalRecordCrc(&header, payload);
+
+	if (span > capacity) {
+		if (!JournalWrite(journal)) {
+			return false;
+		}
+		tail = journal->committed;
+		if (!JournalWriteThrough(journal, &header, payload)) {
+			return false;
+		}
+	}
+	else {
+		if (journal->batchLength + span > capacity && !JournalWrite(journal)) {
+			return false;
+		}
+		tail = JournalTail(journal);
+
+		uint8_t* at = journal->batch + journal->batchLength;
+		memcpy(at, &header, sizeof(header));
+		if (length > 0) {
+			memcpy(at + sizeof(header), payload, length);
+		}
+		memset(at + sizeof(header) + length, 0, span - sizeof(header) - length);
+		journal->batchLength += span;
+	}
+
+	*position = tail;
+	journal->nextSequence++;
+
+	return true;
+}
+
+static bool JournalWriteCheckpoint(LP_JOURNAL* journal, uint32_t epoch, uint32_t start, uint32_t sequence) {
+	JOURNAL_CHECKPOINT checkpoint = {
+		.magic = LP_JOURNAL_MAGIC,
+		.version = LP_JOURNAL_VERSION,
+		.logSize = journal->logSize,
+		.epoch = epoch,
+		.start = start,
+		.sequence = sequence };
+
+	checkpoint.crc = JournalCrc(0, &checkpoint, offsetof(JOURNAL_CHECKPOINT, crc));
+
+	if (pwrite(journal->fd, &checkpoint, sizeof(checkpoint), (off_t)journal->offset + (off_t)(epoch % 2) * JOURNAL_SLOT_SIZE) != (ssize_t)sizeof(checkpoint) ||
+		fsync(journal->fd) != 0) {
+		LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: Journal %s checkpoint failed: %s (%d)\n", journal->name, strerror(errno), errno);
+		return false;
+	}
+
+	journal->epoch = epoch;
+	journal->start = start;
+	return true;
+}
+
+/// <summary>
+///     Reclaim the consumed records by moving the checkpoint to the oldest live record, or to the state when
+///     none are live. A state the move would drop is added again first, so the checkpoint never passes it
+/// </summary>
+static bool JournalCheckpoint(LP_JOURNAL* journal) {
+	bool carryState = journal->stateLength > 0 && (journal->liveRecords == 0 || JournalIsBefore(journal->stateSequence, journal->headSequence));
+	uint32_t start, sequence, position;
+
+	if (!carryState && journal->liveRecords > 0 && journal->head == journal->start) {
+		return false;		// nothing consumed to reclaim
+	}
+
+	if (carryState) {
+		if (!JournalPut(journal, JOURNAL_STATE, journal->state, journal->stateLength, 0, &position)) {
+			return false;
+		}
+		journal->statePosition = position;
+		journal->stateSequence = journal->nextSequence - 1;
+	}
+
+	// whatever the checkpoint points at is on flash before it
+	if (!JournalWrite(journal)) {
+		return false;
+	}
+
+	if (journal->liveRecords > 0) {
+		start = journal->head;
+		sequence = journal->headSequence;
+	}
+	else if (journal->stateLength > 0) {
+		start = journal->statePosition;
+		sequence = journal->stateSequence;
+	}
+	else {
+		start = journal->committed;
+		sequence = journal->nextSequence;
+	}
+
+	if (start == journal->start && !carryState) {
+		return false;
+	}
+
+	if (!JournalWriteCheckpoint(journal, journal->epoch + 1, start, sequence)) {
+		return false;
+	}
+
+	journal->consumedCommitted = journal->consumed;
+	journal->stats.checkpoints++;
+
+	return true;
+}
+
+static void JournalArmCommit(void) {
+	if (_commitArmed) {
+		return;
+	}
+
+	if (journalCommitTimer.eventLoopTimer == NULL && !lp_startTimer(&journalCommitTimer)) {
+		return;		// without an event loop the batch goes out when it fills or on lp_journalCommit
+	}
+
+	_commitArmed = lp_setOneShotTimer(&journalCommitTimer,
+		&(struct timespec){ LP_JOURNAL_COMMIT_DELAY_MS / 1000, (LP_JOURNAL_COMMIT_DELAY_MS % 1000) * 1000000 });
+}
+
+static void JournalDropLive(LP_JOURNAL* journal) {
+	LP_LOG(LP_LOG_ERROR, "ERROR: Journal %s record %u is corrupt, %u live records dropped\n", journal->name, journal->headSequence, journal->liveRecords);
+
+	journal->consumed = journal->nextSequence - 1;
+	journal->liveRecords = 0;
+	journal->head = JournalTail(journal);
+	JournalArmCommit();
+}
+
+static bool JournalReadCheckpoint(const LP_JOURNAL* journal, int slot, JOURNAL_CHECKPOINT* checkpoint) {
+	return pread(journal->fd, checkpoint, sizeof(JOURNAL_CHECKPOINT), (off_t)journal->offset + (off_t)slot * JOURNAL_SLOT_SIZE) == (ssize_t)sizeof(JOURNAL_CHECKPOINT) &&
+		checkpoint->magic == LP_JOURNAL_MAGIC && checkpoint->version == LP_JOURNAL_VERSION && checkpoint->logSize == journal->logSize &&
+		checkpoint->start < journal->logSize && checkpoint->crc == JournalCrc(0, checkpoint, offsetof(JOURNAL_CHECKPOINT, crc));
+}
+
+/// <summary>
+///     Read the log from the newest checkpoint while each record follows the one before and its CRC holds, then
+///     find the oldest record the last CONSUMED record did not cover
+/// </summary>
+static bool JournalRecover(LP_JOURNAL* journal) {
+	JOURNAL_CHECKPOINT slots[2];
+	JOURNAL_CHECKPOINT* current = NULL;
+	JOURNAL_RECORD header;
+	uint32_t position, sequence, scanned = 0;
+
+	for (int slot = 0; slot < 2; slot++) {
+		if (JournalReadCheckpoint(journal, slot, &slots[slot]) && (current == NULL || JournalIsBefore(current->epoch, slots[slot].epoch))) {
+			current = &slots[slot];
+		}
+	}
+
+	if (current == NULL) {
+		struct timespec now;
+
+		// a sequence not written before, the records of another layout left in the region never continue it
+		clock_gettime(CLOCK_REALTIME, &now);
+		sequence = ((uint32_t)now.tv_sec * 1000003u) ^ (uint32_t)now.tv_nsec;
+		sequence = sequence == 0 ? 1 : sequence;
+
+		journal->nextSequence = sequence;
+		journal->consumed = journal->consumedCommitted = sequence - 1;
+		return JournalWriteCheckpoint(journal, 1, 0, sequence);
+	}
+
+	journal->epoch = current->epoch;
+	journal->start = current->start;
+	journal->consumed = current->sequence - 1;
+
+	position = JournalNormalize(journal, current->start);
+	sequence = current->sequence;
+
+	while (scanned < journal->logSize && JournalReadRecord(journal, position, sequence, &header)) {
+		if (header.type == JOURNAL_CONSUMED && header.length == sizeof(uint32_t)) {
+			uint32_t through;
+			memcpy(&through, journal->read, sizeof(through));
+			if (JournalIsBefore(journal->consumed, through)) {
+				journal->consumed = through;
+			}
+		}
+		else if (header.type == JOURNAL_STATE && header.length <= LP_JOURNAL_STATE_SIZE) {
+			memcpy(journal->state, journal->read, header.length);
+			journal->stateLength = header.length;
+			journal->statePosition = position;
+			journal->stateSequence = sequence;
+		}
+
+		scanned += header.type == JOURNAL_WRAP ? journal->logSize - position : JournalSpan(header.length);
+		position = JournalNext(journal, position, &header);
+		sequence++;
+	}
+
+	journal->committed = journal->head = position;
+	journal->nextSequence = sequence;
+	journal->consumedCommitted = journal->consumed;
+
+	for (position = JournalNormalize(journal, current->start), sequence = current->sequence; sequence != journal->nextSequence; sequence++) {
+		if (!JournalRead(journal, position, &header, sizeof(header))) {
+			return false;
+		}
+
+		if (header.type == JOURNAL_DATA && JournalIsBefore(journal->consumed, header.sequence) && journal->liveRecords++ == 0) {
+			journal->head = position;
+			journal->headSequence = header.sequence;
+		}
+		position = JournalNext(journal, position, &header);
+	}
+
+	journal->stats.recovered = journal->liveRecords;
+	return true;
+}
+
+/// <summary>
+///     Open the journal over its region, recovering the records and state written before the last restart
+/// </summary>
+bool lp_openJournal(LP_JOURNAL* journal) {
+	if (journal == NULL) {
+		return false;
+	}
+
+	if (journal->batch != NULL) {
+		return true;
+	}
+
+	if (journal->size < LP_JOURNAL_MIN_SIZE) {
+		return false;
+	}
+
+	journal->logSize = (journal->size - JOURNAL_LOG_OFFSET) & ~3u;
+	journal->batchCapacity = journal->batchSize > 0 ? journal->batchSize : LP_JOURNAL_DEFAULT_BATCH;
+	if (journal->batchCapacity > journal->logSize / 4) {
+		journal->batchCapacity = (journal->logSize / 4) & ~3u;
+	}
+
+	journal->batch = (uint8_t*)lp_heapMalloc(LP_HEAP_JOURNAL, journal->batchCapacity + JOURNAL_RESERVE);
+	if (journal->batch == NULL) {
+		return false;
+	}
+
+	journal->batchLength = journal->readCapacity = 0;
+	journal->read = NULL;
+	journal->epoch = journal->start = journal->committed = journal->head = journal->headSequence = 0;
+	journal->liveRecords = journal->stateLength = journal->statePosition = journal->stateSequence = 0;
+	journal->stats = (LP_JOURNAL_STATS){ 0 };
+
+	journal->fd = Storage_OpenMutableFile();
+	if (journal->fd == -1) {
+		LP_LOG(LP_LOG_WARNING, "WARNING: Journal %s unable to open mutable storage: %s (%d)\n", journal->name, strerror(errno), errno);
+		lp_heapFree(LP_HEAP_JOURNAL, journal->batch);
+		journal->batch = NULL;
+		return false;
+	}
+
+	journal->next = _journals;
+	_journals = journal;
+
+	if (!JournalRecover(journal)) {
+		lp_closeJournal(journal);
+		return false;
+	}
+
+	return true;
+}
+
+void lp_closeJournal(LP_JOURNAL* journal) {
+	if (journal == NULL || journal->batch == NULL) {
+		return;
+	}
+
+	lp_journalCommit(journal);
+
+	for (LP_JOURNAL** link = &_journals; *link != NULL; link = &(*link)->next) {
+		if (*link == journal) {
+			*link = journal->next;
+			break;
+		}
+	}
+
+	close(journal->fd);
+	journal->fd = -1;
+
+	lp_heapFree(LP_HEAP_JOURNAL, journal->batch);
+	lp_heapFree(LP_HEAP_JOURNAL, journal->read);
+	journal->batch = journal->read = NULL;
+	journal->readCapacity = 0;
+
+	if (_journals == NULL && journalCommitTimer.eventLoopTimer != NULL) {
+		lp_stopTimer(&journalCommitTimer);
+		_commitArmed = false;
+	}
+}
+
+bool lp_journalAppend(LP_JOURNAL* journal, const void* record, size_t length) {
+	uint32_t position;
+
+	if (journal == NULL || journal->batch == NULL || record == NULL || length == 0 || length > journal->logSize / 2) {
+		return false;
+	}
+
+	if (!JournalPut(journal, JOURNAL_DATA, record, (uint32_t)length, JOURNAL_RESERVE, &position) &&
+		(!JournalCheckpoint(journal) || !JournalPut(journal, JOURNAL_DATA, record, (uint32_t)length, JOURNAL_RESERVE, &position))) {
+		journal->stats.full++;
+		return false;
+	}
+
+	if (journal->liveRecords++ == 0) {
+		journal->head = position;
+		journal->headSequence = journal->nextSequence - 1;
+	}
+	journal->stats.appends++;
+	JournalArmCommit();
+
+	return true;
+}
+
+/// <summary>
+///     Write the batch and how far the consumer got, one write whatever was appended since the last commit
+/// </summary>
+bool lp_journalCommit(LP_JOURNAL* journal) {
+	uint32_t position;
+
+	if (journal == NULL || journal->batch == NULL) {
+		return false;
+	}
+
+	if (journal->consumed != journal->consumedCommitted) {
+		if (!JournalPut(journal, JOURNAL_CONSUMED, &journal->consumed, sizeof(uint32_t), 0, &position) && !JournalCheckpoint(journal)) {
+			return false;
+		}
+		journal->consumedCommitted = journal->consumed;
+	}
+
+	return JournalWrite(journal);
+}
+
+const void* lp_journalPeek(LP_JOURNAL* journal, size_t* length) {
+	JOURNAL_RECORD header;
+
+	if (journal == NULL || journal->batch == NULL || journal->liveRecords == 0) {
+		return NULL;
+	}
+
+	if (journal->head >= journal->committed && journal->head < JournalTail(journal)) {
+		const uint8_t* at = journal->batch + (journal->head - journal->committed);
+
+		memcpy(&header, at, sizeof(header));
+		if (length != NULL) {
+			*length = header.length;
+		}
+		return at + sizeof(header);
+	}
+
+	if (!JournalReadRecord(journal, journal->head, journal->headSequence, &header) || header.type != JOURNAL_DATA) {
+		JournalDropLive(journal);
+		return NULL;
+	}
+
+	if (length != NULL) {
+		*length = header.length;
+	}
+	return journal->read;
+}
+
+/// <summary>
+///     Drop the oldest live record, written with the next commit as the sequence consumed up to
+/// </summary>
+void lp_journalConsume(LP_JOURNAL* journal) {
+	JOURNAL_RECORD header;
+	uint32_t position;
+
+	if (journal == NULL || journal->batch == NULL || journal->liveRecords == 0) {
+		return;
+	}
+
+	if (!JournalRead(journal, journal->head, &header, sizeof(header)) || header.sequence != journal->headSequence) {
+		JournalDropLive(journal);
+		return;
+	}
+
+	journal->consumed = journal->headSequence;
+	journal->liveRecords--;
+	position = journal->head;
+
+	// the records between live ones are consumed markers, states and wraps
+	while (journal->liveRecords > 0) {
+		uint32_t sequence = header.sequence + 1;
+
+		position = JournalNext(journal, position, &header);
+		if (!JournalRead(journal, position, &header, sizeof(header)) || header.sequence != sequence) {
+			JournalDropLive(journal);
+			return;
+		}
+
+		if (header.type == JOURNAL_DATA) {
+			journal->head = position;
+			journal->headSequence = header.sequence;
+			break;
+		}
+	}
+
+	if (journal->liveRecords == 0) {
+		journal->head = JournalTail(journal);
+	}
+
+	JournalArmCommit();
+}
+
+size_t lp_journalCount(const LP_JOURNAL* journal) {
+	return journal != NULL && journal->batch != NULL ? journal->liveRecords : 0;
+}
+
+/// <summary>
+///     Keep up to LP_JOURNAL_STATE_SIZE bytes with the records, in order with them so a recovered state is never
+///     ahead of or behind the records recovered with it
+/// </summary>
+bool lp_journalSetState(LP_JOURNAL* journal, const void* state, size_t length) {
+	uint32_t position;
+
+	if (journal == NULL || journal->batch == NULL || length > LP_JOURNAL_STATE_SIZE || (state == NULL && length > 0)) {
+		return false;
+	}
+
+	if (!JournalPut(journal, JOURNAL_STATE, state, (uint32_t)length, JOURNAL_RESERVE, &position) &&
+		(!JournalCheckpoint(journal) || !JournalPut(journal, JOURNAL_STATE, state, (uint32_t)length, JOURNAL_RESERVE, &position))) {
+		return false;
+	}
+
+	if (length > 0) {
+		memcpy(journal->state, state, length);
+	}
+	journal->stateLength = (uint32_t)length;
+	journal->statePosition = position;
+	journal->stateSequence = journal->nextSequence - 1;
+	JournalArmCommit();
+
+	return true;
+}
+
+size_t lp_journalGetState(const LP_JOURNAL* journal, void* state, size_t capacity) {
+	if (journal == NULL || journal->batch == NULL || state == NULL || journal->stateLength > capacity) {
+		return 0;
+	}
+
+	memcpy(state, journal->state, journal->stateLength);
+	return journal->stateLength;
+}
+
+static void JournalCommitHandler(EventLoopTimer* eventLoopTimer) {
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_JournalCommitHandler);
+		return;
+	}
+
+	_commitArmed = false;
+
+	for (LP_JOURNAL* journal = _journals; journal != NULL; journal = journal->next) {
+		lp_journalCommit(journal);
+	}
+}
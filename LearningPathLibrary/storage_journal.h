@@ -0,0 +1,82 @@
+#pragma once
+
+#include "heap_stats.h"
+#include "logging.h"
+#include "mutable_storage.h"
+#include "timer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LP_JOURNAL_VERSION 1
+#define LP_JOURNAL_DEFAULT_BATCH 2048		// bytes of appends grouped into one write
+#define LP_JOURNAL_COMMIT_DELAY_MS 1000		// an append waits at most this long for the write it goes out in
+#define LP_JOURNAL_STATE_SIZE 64			// largest lp_journalSetState
+#define LP_JOURNAL_MIN_SIZE 512
+
+typedef struct LP_JOURNAL_STATS
+{
+	uint32_t appends;
+	uint32_t commits;					// writes, each followed by an fsync
+	uint32_t bytesWritten;
+	uint32_t checkpoints;				// times the consumed records were reclaimed
+	uint32_t recovered;					// live records found when the journal was opened
+	uint32_t full;						// appends refused, the live records already fill the region
+} LP_JOURNAL_STATS;
+
+typedef struct LP_JOURNAL
+{
+	const char* name;
+	uint32_t offset;					// region of the mutable storage file, see mutable_storage.h
+	uint32_t size;
+	uint32_t batchSize;					// optional, 0 for LP_JOURNAL_DEFAULT_BATCH
+	LP_JOURNAL_STATS stats;				// read only
+	// internal, positions are offsets into the log after the two checkpoint slots
+	int fd;
+	uint8_t* batch;						// appends not written yet, they go at committed
+	uint32_t batchLength;
+	uint32_t batchCapacity;
+	uint8_t* read;						// the record lp_journalPeek read back
+	uint32_t readCapacity;
+	uint32_t logSize;
+	uint32_t epoch;
+	uint32_t start;						// the checkpoint, where recovery starts reading
+	uint32_t committed;
+	uint32_t head;						// the oldest live record
+	uint32_t headSequence;
+	uint32_t liveRecords;
+	uint32_t nextSequence;
+	uint32_t consumed;					// sequence of the last record consumed, consumedCommitted as last written
+	uint32_t consumedCommitted;
+	uint32_t statePosition;
+	uint32_t stateSequence;
+	uint32_t stateLength;
+	uint8_t state[LP_JOURNAL_STATE_SIZE];
+	struct LP_JOURNAL* next;			// open journals, committed together
+} LP_JOURNAL;
+
+// A log of CRC'd records in one region of the mutable storage file, for a module that persists a stream of
+// records and consumes them oldest first. Appends are copied to a RAM batch, written with one write and fsync
+// when the batch fills, LP_JOURNAL_COMMIT_DELAY_MS after the first append, or on lp_journalCommit, so a burst
+// of records costs one flash write rather than one each. Consuming a record writes nothing until the next
+// commit, which records how far the consumer got.
+//
+// The log runs round the region. Once the end of the log reaches the consumed records they are reclaimed by
+// writing a new checkpoint, the start of the live records, into one of two slots at the region's start, so
+// live records are never copied. Recovery reads from the newest checkpoint while each record's sequence and
+// CRC hold, a torn last write ends the log where it was torn. One state blob, lp_journalSetState, is kept with
+// the records and carried forward when a checkpoint would drop it.
+//
+// A region of another size, or without a checkpoint, opens empty; the records of another layout are not read.
+bool lp_openJournal(LP_JOURNAL* journal);
+void lp_closeJournal(LP_JOURNAL* journal);
+// false when the region is full of live records, or a write failed
+bool lp_journalAppend(LP_JOURNAL* journal, const void* record, size_t length);
+// write the batch now, before a power down
+bool lp_journalCommit(LP_JOURNAL* journal);
+// the oldest live record, valid until the next call on the journal, NULL when none
+const void* lp_journalPeek(LP_JOURNAL* journal, size_t* length);
+void lp_journalConsume(LP_JOURNAL* journal);
+size_t lp_journalCount(const LP_JOURNAL* journal);
+bool lp_journalSetState(LP_JOURNAL* journal, const void* state, size_t length);
+size_t lp_journalGetState(const LP_JOURNAL* journal, void* state, size_t capacity);
@@ -0,0 +1,254 @@
+#include "synthetic_load.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static void LoadTickHandler(EventLoopTimer* eventLoopTimer);
+
+static LP_TIMER loadTimer = {
+	.period = { 0, LP_LOAD_TICK_MS * 1000000 },
+	.name = "syntheticLoad",
+	.handler = LoadTickHandler };
+
+static LP_SYNTHETIC_LOAD _load;
+static LP_SYNTHETIC_LOAD_RESULT _result;
+static struct timespec _startedAt, _lastTickAt;
+static uint32_t _messagesDue, _reportsDue, _interCoreDue;		// sent or dropped so far, the rates say how many should have been
+static LP_TELEMETRY_STATS _telemetryAtStart;
+static LP_INTER_CORE_STATS _interCoreAtStart;
+static char _payload[LP_LOAD_MAX_PAYLOAD + 1];
+
+LP_DEVICE_TWIN_BINDING lp_syntheticLoadTwin = { .twinProperty = "SyntheticLoad", .twinType = LP_TYPE_INT };
+
+static int64_t UsSince(const struct timespec* since) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int64_t)(now.tv_sec - since->tv_sec) * 1000000 + (now.tv_nsec - since->tv_nsec) / 1000;
+}
+
+/// <summary>
+///     How many of a kind to send now to keep up perSecond since the start, at most LP_LOAD_TICK_BURST
+/// </summary>
+static uint32_t Due(uint32_t perSecond, uint32_t sent, int64_t elapsedUs) {
+	uint64_t target = (uint64_t)perSecond * (uint64_t)elapsedUs / 1000000;
+	uint64_t due = target > sent ? target - sent : 0;
+
+	return due > LP_LOAD_TICK_BURST ? LP_LOAD_TICK_BURST : (uint32_t)due;
+}
+
+/// <summary>
+///     The sequence number and send time, padded to the payload size
+/// </summary>
+static const char* BuildMessage(uint32_t sequence) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	int length = snprintf(_payload, sizeof(_payload), "{\"load\":%u,\"us\":%lld,\"pad\":\"", sequence,
+		(long long)now.tv_sec * 1000000 + now.tv_nsec / 1000);
+
+	size_t padded = _load.payloadBytes - 2;		// the closing quote and brace
+	memset(_payload + length, 'x', padded - (size_t)length);
+	memcpy(_payload + padded, "\"}", 3);
+
+	return _payload;
+}
+
+static void UpdateResult(void) {
+	LP_TELEMETRY_STATS telemetry;
+	LP_INTER_CORE_STATS interCore;
+	double seconds;
+
+	lp_getTelemetryStats(&telemetry);
+	lp_getInterCoreStats(&interCore);
+
+	_result.elapsedMs = (uint32_t)(UsSince(&_startedAt) / 1000);
+	_result.confirmed = telemetry.confirmed - _telemetryAtStart.confirmed;
+	_result.failed = (telemetry.failed - _telemetryAtStart.failed) + (telemetry.timeouts - _telemetryAtStart.timeouts);
+	_result.latencyRecentMs = telemetry.latencyRecentMs;
+	_result.interCoreDropped = interCore.messagesDropped - _interCoreAtStart.messagesDropped;
+
+	seconds = _result.elapsedMs > 0 ? _result.elapsedMs / 1000.0 : 1;
+	_result.messagesPerSecond = (_result.messages - _result.messagesDropped) / seconds;
+	_result.reportsPerSecond = (_result.reports - _result.reportsDropped) / seconds;
+	_result.interCorePerSecond = (_result.interCore - _result.interCoreDropped) / seconds;
+}
+
+bool lp_startSyntheticLoad(const LP_SYNTHETIC_LOAD* load) {
+	if (load == NULL) {
+		return false;
+	}
+
+	lp_stopSyntheticLoad();
+
+	_load = *load;
+	_load.payloadBytes = _load.payloadBytes < LP_LOAD_MIN_PAYLOAD ? LP_LOAD_MIN_PAYLOAD :
+		_load.payloadBytes > LP_LOAD_MAX_PAYLOAD ? LP_LOAD_MAX_PAYLOAD : _load.payloadBytes;
+
+	_result = (LP_SYNTHETIC_LOAD_RESULT){ .running = true };
+	_messagesDue = _reportsDue = _interCoreDue = 0;
+	lp_getTelemetryStats(&_telemetryAtStart);
+	lp_getInterCoreStats(&_interCoreAtStart);
+	clock_gettime(CLOCK_MONOTONIC, &_startedAt);
+	_lastTickAt = _startedAt;
+
+	if (!lp_startTimer(&loadTimer)) {
+		_result.running = false;
+		return false;
+	}
+
+	LP_LOG(LP_LOG_INFO, "Synthetic load: %u messages/s of %u bytes, %u reports/s, %u inter-core/s for %u s\n", _load.messagesPerSecond,
+		_load.payloadBytes, _load.reportsPerSecond, _load.interCorePerSecond, _load.durationSeconds);
+
+	return true;
+}
+
+void lp_stopSyntheticLoad(void) {
+	char line[256];
+
+	if (!_result.running) {
+		return;
+	}
+
+	lp_stopTimer(&loadTimer);
+	UpdateResult();
+	_result.running = false;
+
+	lp_formatSyntheticLoadResult(&_result, line, sizeof(line));
+	LP_LOG(LP_LOG_INFO, "Synthetic load: %s\n", line);
+}
+
+void lp_getSyntheticLoadResult(LP_SYNTHETIC_LOAD_RESULT* result) {
+	if (result == NULL) {
+		return;
+	}
+
+	if (_result.running) {
+		UpdateResult();
+	}
+	*result = _result;
+}
+
+int lp_formatSyntheticLoadResult(const LP_SYNTHETIC_LOAD_RESULT* result, char* buffer, size_t size) {
+	return snprintf(buffer, size, "%u ms: %.1f messages/s (%u dropped, %u confirmed, %u failed, %u ms latency), "
+		"%.1f reports/s (%u dropped), %.1f inter-core/s (%u dropped), tick lag %u us",
+		result->elapsedMs, result->messagesPerSecond, result->messagesDropped, result->confirmed, result->failed,
+		result->latencyRecentMs, result->reportsPerSecond, result->reportsDropped, result->interCorePerSecond,
+		result->interCoreDropped, result->tickLagMaxUs);
+}
+
+/// <summary>
+///     "messages=50,bytes=256,reports=2,intercore=100,seconds=60", false on an unknown key or a malformed value
+/// </summary>
+bool lp_parseSyntheticLoad(const char* text, LP_SYNTHETIC_LOAD* load) {
+	if (text == NULL || load == NULL) {
+		return false;
+	}
+
+	*load = (LP_SYNTHETIC_LOAD){ .payloadBytes = LP_LOAD_MIN_PAYLOAD };
+
+	while (*text != 0) {
+		char key[10];
+		unsigned int value;
+		int consumed = 0;
+
+		if (sscanf(text, " %9[a-z] = %u%n", key, &value, &consumed) != 2) {
+			return false;
+		}
+
+		if (strcmp(key, "messages") == 0) {
+			load->messagesPerSecond = value;
+		} else if (strcmp(key, "bytes") == 0) {
+			load->payloadBytes = value;
+		} else if (strcmp(key, "reports") == 0) {
+			load->reportsPerSecond = value;
+		} else if (strcmp(key, "intercore") == 0) {
+			load->interCorePerSecond = value;
+		} else if (strcmp(key, "seconds") == 0) {
+			load->durationSeconds = value;
+		} else {
+			return false;
+		}
+
+		text += consumed;
+		text += strspn(text, " ,;");
+	}
+
+	return true;
+}
+
+static void LoadTickHandler(EventLoopTimer* eventLoopTimer) {
+	LP_INTER_CORE_BLOCK heartbeat = { .cmd = LP_IC_HEARTBEAT };
+
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_ConsumeEventLoopTimeEvent);
+		return;
+	}
+
+	int64_t lagUs = UsSince(&_lastTickAt) - LP_LOAD_TICK_MS * 1000;
+	int64_t elapsedUs = UsSince(&_startedAt);
+
+	clock_gettime(CLOCK_MONOTONIC, &_lastTickAt);
+	if (lagUs > _result.tickLagMaxUs) {
+		_result.tickLagMaxUs = (uint32_t)lagUs;
+	}
+
+	for (uint32_t i = Due(_load.messagesPerSecond, _messagesDue, elapsedUs); i > 0; i--) {
+		_result.messages++;
+		if (!lp_enqueueTelemetry(BuildMessage(_messagesDue++))) {
+			_result.messagesDropped++;
+		}
+	}
+
+	for (uint32_t i = Due(_load.reportsPerSecond, _reportsDue, elapsedUs); i > 0; i--) {
+		int sequence = (int)++_reportsDue;
+
+		_result.reports++;
+		if (!lp_deviceTwinReportState(&lp_syntheticLoadTwin, &sequence)) {
+			_result.reportsDropped++;
+		}
+	}
+
+	for (uint32_t i = Due(_load.interCorePerSecond, _interCoreDue, elapsedUs); i > 0; i--) {
+		_interCoreDue++;
+		_result.interCore++;
+		lp_sendInterCoreMessage(&heartbeat, sizeof(heartbeat));		// counted in the inter-core dropped stats
+	}
+
+	if (_load.durationSeconds > 0 && elapsedUs >= (int64_t)_load.durationSeconds * 1000000) {
+		lp_stopSyntheticLoad();
+	}
+}
+
+static uint32_t MethodRate(JSON_Object* json, const char* key) {
+	double value = json_object_get_number(json, key);
+	return value < 1 ? 0 : value > UINT32_MAX ? UINT32_MAX : (uint32_t)value;
+}
+
+static LP_DIRECT_METHOD_RESPONSE_CODE SyntheticLoadHandler(JSON_Object* json, LP_DIRECT_METHOD_BINDING* directMethodBinding, char** responseMsg) {
+	LP_SYNTHETIC_LOAD_RESULT result;
+	char line[LP_METHOD_RESPONSE_SIZE - 2];
+
+	if (json_object_get_boolean(json, "stop") == 1) {
+		lp_stopSyntheticLoad();
+	} else if (json_object_get_count(json) > 0) {
+		LP_SYNTHETIC_LOAD load = {
+			.messagesPerSecond = MethodRate(json, "messages"),
+			.payloadBytes = MethodRate(json, "bytes"),
+			.reportsPerSecond = MethodRate(json, "reports"),
+			.interCorePerSecond = MethodRate(json, "intercore"),
+			.durationSeconds = MethodRate(json, "seconds") };
+
+		if (!lp_startSyntheticLoad(&load)) {
+			lp_setMethodResponse("Synthetic load did not start");
+			return LP_METHOD_FAILED;
+		}
+	}
+
+	lp_getSyntheticLoadResult(&result);
+	lp_formatSyntheticLoadResult(&result, line, sizeof(line));
+	lp_setMethodResponse("%s%s", result.running ? "running " : "", line);
+
+	return LP_METHOD_SUCCEEDED;
+}
+
+LP_DIRECT_METHOD_BINDING lp_syntheticLoadDirectMethod = { .methodName = "SyntheticLoad", .handler = SyntheticLoadHandler };
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "azure_iot.h"
+#include "device_twins.h"
+#include "direct_methods.h"
+#include "inter_core.h"
+#include "timer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LP_LOAD_TICK_MS 10				// the generator's timer, each tick sends what the rates make due
+#define LP_LOAD_TICK_BURST 64			// most of one kind sent per tick, a generator that falls behind shows as a shortfall
+#define LP_LOAD_MAX_PAYLOAD 4096
+#define LP_LOAD_MIN_PAYLOAD 64			// room for the sequence number and send time every message carries
+
+typedef struct LP_SYNTHETIC_LOAD
+{
+	uint32_t messagesPerSecond;			// through lp_enqueueTelemetry, batched when a batch is open
+	uint32_t payloadBytes;				// each message padded to this, clamped to LP_LOAD_MIN_PAYLOAD to LP_LOAD_MAX_PAYLOAD
+	uint32_t reportsPerSecond;			// lp_syntheticLoadTwin reported
+	uint32_t interCorePerSecond;		// LP_IC_HEARTBEAT records to the real-time app
+	uint32_t durationSeconds;			// 0 runs until lp_stopSyntheticLoad
+} LP_SYNTHETIC_LOAD;
+
+typedef struct LP_SYNTHETIC_LOAD_RESULT
+{
+	bool running;
+	uint32_t elapsedMs;
+	uint32_t messages;
+	uint32_t messagesDropped;			// lp_enqueueTelemetry false, offline queued or refused
+	uint32_t confirmed;					// hub confirmations of any message during the run
+	uint32_t failed;					// confirmations with an error or timeout
+	uint32_t latencyRecentMs;			// LP_TELEMETRY_STATS latencyRecentMs at the end of the run
+	uint32_t reports;
+	uint32_t reportsDropped;
+	uint32_t interCore;
+	uint32_t interCoreDropped;			// LP_INTER_CORE_STATS messagesDropped during the run
+	uint32_t tickLagMaxUs;				// latest a generator tick fired, how far behind the event loop fell
+	double messagesPerSecond;			// achieved
+	double reportsPerSecond;
+	double interCorePerSecond;
+} LP_SYNTHETIC_LOAD_RESULT;
+
+// A configurable load to find the device's throughput ceiling after each library change. lp_startSyntheticLoad
+// sends telemetry, reported properties and inter-core records at the requested rates from a LP_LOAD_TICK_MS timer
+// on the event loop, along the paths app traffic takes, and records what was achieved, what was dropped and the
+// confirmation latency; raise the rates until achieved stops following requested. The run ends after
+// durationSeconds, or at lp_stopSyntheticLoad, and its result is logged.
+//
+// Start it from the "--load=" command line argument, see syntheticLoadArgs in globals.h, or with the optional
+// SyntheticLoad direct method. The report load needs lp_syntheticLoadTwin in the device twin set.
+bool lp_startSyntheticLoad(const LP_SYNTHETIC_LOAD* load);
+// "messages=50,bytes=256,reports=2,intercore=100,seconds=60", keys left out are 0 and bytes LP_LOAD_MIN_PAYLOAD
+bool lp_parseSyntheticLoad(const char* text, LP_SYNTHETIC_LOAD* load);
+void lp_stopSyntheticLoad(void);
+void lp_getSyntheticLoadResult(LP_SYNTHETIC_LOAD_RESULT* result);
+int lp_formatSyntheticLoadResult(const LP_SYNTHETIC_LOAD_RESULT* result, char* buffer, size_t size);
+
+extern LP_DEVICE_TWIN_BINDING lp_syntheticLoadTwin;
+// optional, add to the direct method set: a payload of rates as lp_parseSyntheticLoad names them starts a run,
+// {"stop":true} ends one, and the response is the result so far
+extern LP_DIRECT_METHOD_BINDING lp_syntheticLoadDirectMethod;
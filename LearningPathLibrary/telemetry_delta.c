@@ -0,0 +1,115 @@
+#include "telemetry_delta.h"
+#include "logging.h"
+#include <math.h>
+
+/// <summary>
+///     Outside the deadband of the value last sent, bools on any change
+/// </summary>
+static bool Changed(const LP_DELTA_FIELD* field, double value) {
+	if (field->type == LP_DELTA_BOOL) {
+		return (value != 0) != (field->sent != 0);
+	}
+	if (field->type == LP_DELTA_INT) {
+		value = round(value);
+	}
+	return fabs(value - field->sent) > field->deadband;
+}
+
+static void AddField(LP_TELEMETRY_ENCODER* encoder, const LP_DELTA_FIELD* field, double value) {
+	switch (field->type) {
+	case LP_DELTA_INT:
+		lp_telemetryAddInt(encoder, field->name, (int64_t)llround(value));
+		break;
+	case LP_DELTA_BOOL:
+		lp_telemetryAddBool(encoder, field->name, value != 0);
+		break;
+	default:
+		lp_telemetryAddFloat(encoder, field->name, (float)value);
+		break;
+	}
+}
+
+static bool KeyframeDue(const LP_TELEMETRY_DELTA* delta, const struct timespec* now) {
+	return !delta->primed || (delta->keyframeMessages > 0 && delta->sinceKeyframe + 1 >= delta->keyframeMessages) ||
+		(delta->keyframeSeconds > 0 && now->tv_sec - delta->keyframeAt.tv_sec >= (time_t)delta->keyframeSeconds);
+}
+
+/// <summary>
+///     One value for each field, sends the fields that changed, all of them on a keyframe, or nothing. False when
+///     the message did not fit or the client refused it, the next sample is then a keyframe
+/// </summary>
+bool lp_sendTelemetryDelta(LP_TELEMETRY_DELTA* delta, const double* values) {
+	uint8_t buffer[LP_DELTA_MESSAGE_SIZE];
+	LP_TELEMETRY_ENCODER encoder;
+	struct timespec now;
+	uint32_t included = 0;			// bit i for fields[i]
+	size_t count = 0;
+	bool keyframe;
+
+	if (delta == NULL || values == NULL || delta->fields == NULL || delta->fieldCount == 0 || delta->fieldCount > LP_DELTA_MAX_FIELDS) {
+		return false;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	keyframe = KeyframeDue(delta, &now);
+
+	for (size_t i = 0; i < delta->fieldCount; i++) {
+		if (keyframe || Changed(&delta->fields[i], values[i])) {
+			included |= 1u << i;
+			count++;
+		}
+	}
+
+	if (count == 0) {
+		delta->unchanged++;
+		return true;
+	}
+
+	lp_telemetryBegin(&encoder, delta->format, buffer, sizeof(buffer));
+	lp_telemetryAddInt(&encoder, LP_DELTA_SEQUENCE_FIELD, (int64_t)delta->sequence + 1);
+	if (keyframe) {
+		lp_telemetryAddBool(&encoder, LP_DELTA_KEYFRAME_FIELD, true);
+	}
+	for (size_t i = 0; i < delta->fieldCount; i++) {
+		if (included & (1u << i)) {
+			AddField(&encoder, &delta->fields[i], values[i]);
+		}
+	}
+
+	if (lp_telemetryEnd(&encoder) == 0) {
+		LP_LOG_LIMITED(LP_LOG_WARNING, LP_LOG_LIMIT_MS, "WARNING: telemetry delta larger than %d bytes dropped\n", LP_DELTA_MESSAGE_SIZE);
+		delta->primed = false;
+		return false;
+	}
+	if (!lp_sendTelemetry(&encoder, delta->propertyTemplate)) {
+		delta->primed = false;		// the cloud may not see these changes
+		return false;
+	}
+
+	for (size_t i = 0; i < delta->fieldCount; i++) {
+		if (included & (1u << i)) {
+			delta->fields[i].sent = delta->fields[i].type == LP_DELTA_INT ? round(values[i]) : values[i];
+		}
+	}
+
+	delta->sequence++;
+	delta->messages++;
+	delta->fieldsSent += (uint32_t)count;
+	delta->fieldsLeftOut += (uint32_t)(delta->fieldCount - count);
+	if (keyframe) {
+		delta->keyframes++;
+		delta->sinceKeyframe = 0;
+		delta->keyframeAt = now;
+		delta->primed = true;
+	} else {
+		delta->sinceKeyframe++;
+	}
+
+	return true;
+}
+
+void lp_forceTelemetryKeyframe(LP_TELEMETRY_DELTA* delta) {
+	if (delta != NULL) {
+		delta->primed = false;
+	}
+}
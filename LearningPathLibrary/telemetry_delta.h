@@ -0,0 +1,63 @@
+#pragma once
+
+#include "azure_iot.h"
+#include "telemetry_encoder.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define LP_DELTA_MAX_FIELDS 16
+#define LP_DELTA_MESSAGE_SIZE 512
+#define LP_DELTA_SEQUENCE_FIELD "seq"		// of each message sent, from 1 after a restart
+#define LP_DELTA_KEYFRAME_FIELD "key"		// true on a keyframe, absent on a delta
+
+typedef enum {
+	LP_DELTA_FLOAT,
+	LP_DELTA_INT,					// sent rounded
+	LP_DELTA_BOOL					// sent as value != 0
+} LP_DELTA_TYPE;
+
+typedef struct LP_DELTA_FIELD
+{
+	const char* name;
+	LP_DELTA_TYPE type;
+	double deadband;				// changes of no more than this from the value last sent are left out, 0 sends any change
+	double sent;					// internal, the value the cloud holds
+} LP_DELTA_FIELD;
+
+typedef struct LP_TELEMETRY_DELTA
+{
+	LP_DELTA_FIELD* fields;
+	size_t fieldCount;
+	uint32_t keyframeMessages;		// every this many messages is a keyframe, 0 for none on count
+	uint32_t keyframeSeconds;		// or the first this long after the last keyframe, 0 for none on time
+	LP_TELEMETRY_FORMAT format;
+	const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate;	// optional, NULL sends with the properties lp_setMessageProperties set
+	uint32_t sequence;				// read only, of the last message sent
+	uint32_t messages;				// read only, sent, keyframes included
+	uint32_t keyframes;
+	uint32_t unchanged;				// read only, samples with no field outside its deadband, nothing sent
+	uint32_t fieldsSent;			// read only, fields in the messages sent and fields left out of them
+	uint32_t fieldsLeftOut;
+	uint32_t sinceKeyframe;			// internal, deltas sent since the last keyframe
+	struct timespec keyframeAt;		// internal, CLOCK_MONOTONIC
+	bool primed;					// internal, false until a keyframe is sent
+} LP_TELEMETRY_DELTA;
+
+// Send-on-change telemetry for readings whose fields mostly hold still between samples, pressure, humidity and
+// light. Each sample goes to lp_sendTelemetryDelta, which sends only the fields that moved past their deadband
+// from the value last sent, so slow drift is still sent once it adds up, and sends nothing when none did.
+//
+//   keyframe  {"seq":40,"key":true,"Temperature":21.5,"Humidity":45.2,"Pressure":1013.2,"Light":310}
+//   delta     {"seq":41,"Temperature":21.7}
+//
+// A keyframe carries every field. It is sent first, then every keyframeMessages messages or keyframeSeconds
+// seconds, and after a message the client refused, since the cloud may not have its changes. There is no timer,
+// keyframeSeconds is checked as each sample comes in. lp_forceTelemetryKeyframe makes the next sample one, after a
+// reconnect or when the cloud asks. seq counts the messages sent, a gap in it tells the cloud that a delta went missing and its
+// view may be stale until the next keyframe; tools/telemetry-delta rebuilds whole readings from a stream.
+//
+// The struct is the app's, zero everything except the settings and fields. Not thread safe, app thread only.
+bool lp_sendTelemetryDelta(LP_TELEMETRY_DELTA* delta, const double* values);
+void lp_forceTelemetryKeyframe(LP_TELEMETRY_DELTA* delta);
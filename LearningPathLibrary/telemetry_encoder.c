@@ -0,0 +1,204 @@
+#include "telemetry_encoder.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// CBOR (RFC 7049) major types and simple values used by the encoder
+#define CBOR_UNSIGNED 0x00
+#define CBOR_NEGATIVE 0x20
+#define CBOR_TEXT 0x60
+#define CBOR_MAP_INDEFINITE 0xbf
+#define CBOR_FALSE 0xf4
+#define CBOR_TRUE 0xf5
+#define CBOR_FLOAT32 0xfa
+#define CBOR_BREAK 0xff
+
+static void Put(LP_TELEMETRY_ENCODER* encoder, const void* data, size_t length) {
+	if (encoder->overflow || encoder->capacity - encoder->length < length) {
+		encoder->overflow = true;
+		return;
+	}
+
+	memcpy(encoder->buffer + encoder->length, data, length);
+	encoder->length += length;
+}
+
+static void PutByte(LP_TELEMETRY_ENCODER* encoder, uint8_t value) {
+	Put(encoder, &value, 1);
+}
+
+/// <summary>
+///     Writes a CBOR major type with its argument in the shortest form
+/// </summary>
+static void PutCborHead(LP_TELEMETRY_ENCODER* encoder, uint8_t majorType, uint64_t argument) {
+	uint8_t head[9];
+	size_t length;
+
+	if (argument < 24) {
+		head[0] = (uint8_t)(majorType | argument);
+		length = 1;
+	} else if (argument <= 0xff) {
+		head[0] = majorType | 24;
+		length = 2;
+	} else if (argument <= 0xffff) {
+		head[0] = majorType | 25;
+		length = 3;
+	} else if (argument <= 0xffffffff) {
+		head[0] = majorType | 26;
+		length = 5;
+	} else {
+		head[0] = majorType | 27;
+		length = 9;
+	}
+
+	for (size_t i = 1; i < length; i++) {
+		head[i] = (uint8_t)(argument >> (8 * (length - 1 - i)));	// big endian
+	}
+
+	Put(encoder, head, length);
+}
+
+static void PutCborText(LP_TELEMETRY_ENCODER* encoder, const char* text) {
+	size_t length = strlen(text);
+	PutCborHead(encoder, CBOR_TEXT, length);
+	Put(encoder, text, length);
+}
+
+static void PutJsonText(LP_TELEMETRY_ENCODER* encoder, const char* text) {
+	PutByte(encoder, '"');
+	for (const char* c = text; *c != 0; c++) {
+		if (*c == '"' || *c == '\\') {
+			PutByte(encoder, '\\');
+			PutByte(encoder, (uint8_t)*c);
+		} else if ((unsigned char)*c < 0x20) {
+			char escaped[7];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*c);
+			Put(encoder, escaped, 6);
+		} else {
+			PutByte(encoder, (uint8_t)*c);
+		}
+	}
+	PutByte(encoder, '"');
+}
+
+/// <summary>
+///     Writes the field separator and name
+/// </summary>
+static void PutName(LP_TELEMETRY_ENCODER* encoder, const char* name) {
+	if (encoder->format == LP_TELEMETRY_CBOR) {
+		PutCborText(encoder, name);
+	} else {
+		if (encoder->fieldCount > 0) {
+			PutByte(encoder, ',');
+		}
+		PutJsonText(encoder, name);
+		PutByte(encoder, ':');
+	}
+	encoder->fieldCount++;
+}
+
+static void PutJsonNumber(LP_TELEMETRY_ENCODER* encoder, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+static void PutJsonNumber(LP_TELEMETRY_ENCODER* encoder, const char* format, ...) {
+	char number[32];
+	va_list args;
+
+	va_start(args, format);
+	int len = vsnprintf(number, sizeof(number), format, args);
+	va_end(args);
+
+	if (len < 0 || len >= (int)sizeof(number)) {
+		encoder->overflow = true;
+		return;
+	}
+
+	Put(encoder, number, (size_t)len);
+}
+
+/// <summary>
+///     Start a telemetry message in buffer. The same field calls produce JSON or CBOR depending on format,
+///     so sensor code does not change when the wire format does.
+/// </summary>
+void lp_telemetryBegin(LP_TELEMETRY_ENCODER* encoder, LP_TELEMETRY_FORMAT format, uint8_t* buffer, size_t capacity) {
+	memset(encoder, 0, sizeof(LP_TELEMETRY_ENCODER));
+	encoder->format = format;
+	encoder->buffer = buffer;
+	encoder->capacity = capacity;
+
+	if (format == LP_TELEMETRY_CBOR) {
+		PutByte(encoder, CBOR_MAP_INDEFINITE);
+	} else {
+		PutByte(encoder, '{');
+	}
+}
+
+void lp_telemetryAddInt(LP_TELEMETRY_ENCODER* encoder, const char* name, int64_t value) {
+	PutName(encoder, name);
+
+	if (encoder->format == LP_TELEMETRY_CBOR) {
+		if (value >= 0) {
+			PutCborHead(encoder, CBOR_UNSIGNED, (uint64_t)value);
+		} else {
+			PutCborHead(encoder, CBOR_NEGATIVE, (uint64_t)(-(value + 1)));
+		}
+	} else {
+		PutJsonNumber(encoder, "%lld", (long long)value);
+	}
+}
+
+void lp_telemetryAddFloat(LP_TELEMETRY_ENCODER* encoder, const char* name, float value) {
+	PutName(encoder, name);
+
+	if (encoder->format == LP_TELEMETRY_CBOR) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		PutByte(encoder, CBOR_FLOAT32);
+		PutByte(encoder, (uint8_t)(bits >> 24));
+		PutByte(encoder, (uint8_t)(bits >> 16));
+		PutByte(encoder, (uint8_t)(bits >> 8));
+		PutByte(encoder, (uint8_t)bits);
+	} else {
+		PutJsonNumber(encoder, "%.6g", (double)value);
+	}
+}
+
+void lp_telemetryAddBool(LP_TELEMETRY_ENCODER* encoder, const char* name, bool value) {
+	PutName(encoder, name);
+
+	if (encoder->format == LP_TELEMETRY_CBOR) {
+		PutByte(encoder, value ? CBOR_TRUE : CBOR_FALSE);
+	} else {
+		Put(encoder, value ? "true" : "false", value ? 4 : 5);
+	}
+}
+
+void lp_telemetryAddString(LP_TELEMETRY_ENCODER* encoder, const char* name, const char* value) {
+	PutName(encoder, name);
+
+	if (encoder->format == LP_TELEMETRY_CBOR) {
+		PutCborText(encoder, value);
+	} else {
+		PutJsonText(encoder, value);
+	}
+}
+
+/// <summary>
+///     Close the message. Returns its length, or 0 if the buffer was too small. JSON output is null terminated.
+/// </summary>
+size_t lp_telemetryEnd(LP_TELEMETRY_ENCODER* encoder) {
+	if (encoder->format == LP_TELEMETRY_CBOR) {
+		PutByte(encoder, CBOR_BREAK);
+	} else {
+		PutByte(encoder, '}');
+		PutByte(encoder, 0);
+		if (!encoder->overflow) {
+			encoder->length--;	// terminator is not part of the payload
+		}
+	}
+
+	return encoder->overflow ? 0 : encoder->length;
+}
+
+const char* lp_telemetryContentType(const LP_TELEMETRY_ENCODER* encoder) {
+	return encoder->format == LP_TELEMETRY_CBOR ? "application/cbor" : "application/json";
+}
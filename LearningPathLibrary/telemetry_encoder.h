@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+	LP_TELEMETRY_JSON = 0,
+	LP_TELEMETRY_CBOR = 1
+} LP_TELEMETRY_FORMAT;
+
+typedef struct LP_TELEMETRY_ENCODER
+{
+	LP_TELEMETRY_FORMAT format;
+	uint8_t* buffer;
+	size_t capacity;
+	size_t length;
+	size_t fieldCount;
+	bool overflow;
+} LP_TELEMETRY_ENCODER;
+
+void lp_telemetryBegin(LP_TELEMETRY_ENCODER* encoder, LP_TELEMETRY_FORMAT format, uint8_t* buffer, size_t capacity);
+void lp_telemetryAddInt(LP_TELEMETRY_ENCODER* encoder, const char* name, int64_t value);
+void lp_telemetryAddFloat(LP_TELEMETRY_ENCODER* encoder, const char* name, float value);
+void lp_telemetryAddBool(LP_TELEMETRY_ENCODER* encoder, const char* name, bool value);
+void lp_telemetryAddString(LP_TELEMETRY_ENCODER* encoder, const char* name, const char* value);
+size_t lp_telemetryEnd(LP_TELEMETRY_ENCODER* encoder);
+const char* lp_telemetryContentType(const LP_TELEMETRY_ENCODER* encoder);
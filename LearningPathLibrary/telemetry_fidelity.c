@@ -0,0 +1,240 @@
+#include "telemetry_fidelity.h"
+
+typedef struct FIDELITY_CHANNEL
+{
+	const char* name;
+	double sum;
+	double min;
+	double max;
+} FIDELITY_CHANNEL;
+
+static void TelemetryFidelityHandler(EventLoopTimer* eventLoopTimer);
+static void TelemetryFidelityTwinHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding);
+
+static LP_TIMER telemetryFidelityTimer = {
+	.period = { LP_FIDELITY_EVAL_SECONDS, 0 },
+	.name = "telemetryFidelityTimer",
+	.handler = &TelemetryFidelityHandler
+};
+
+LP_DEVICE_TWIN_BINDING lp_telemetryFidelityTwin = { .twinProperty = "TelemetryFidelity", .twinType = LP_TYPE_STRING, .handler = TelemetryFidelityTwinHandler };
+
+static const char* _levelNames[LP_FIDELITY_LEVELS] = { "raw", "10s", "60s" };
+static const LP_FIDELITY_POLICY _defaultPolicy = { .degradeQueueDepth = 20, .degradeLatencyMs = 5000, .recoverQueueDepth = 2, .recoverLatencyMs = 1500 };
+
+static FIDELITY_CHANNEL _channels[LP_FIDELITY_MAX_CHANNELS];
+static size_t _channelCount = 0;
+static const LP_MESSAGE_PROPERTY_TEMPLATE* _template = NULL;
+static LP_FIDELITY_POLICY _policy;
+static LP_FIDELITY_LEVEL _level = LP_FIDELITY_RAW;
+static LP_FIDELITY_LEVEL _pinned = LP_FIDELITY_LEVELS;		// LP_FIDELITY_LEVELS while the policy decides
+static uint32_t _samples = 0;				// in the summary being built
+static uint32_t _periods = 0;				// evaluations since the summary began
+static uint32_t _healthyEvaluations = 0;
+static uint32_t _lastConfirmed = 0;
+
+static bool SendTelemetryMessage(const char* msg) {
+	return _template != NULL ? lp_sendMsgWithProperties(msg, _template, NULL, 0) : lp_sendMsg(msg);
+}
+
+/// <summary>
+///     Send the summary built so far, if it holds any samples, and start the next
+/// </summary>
+static void SendSummary(void) {
+	char msg[LP_FIDELITY_MESSAGE_SIZE];
+	int len;
+
+	if (_samples > 0) {
+		len = snprintf(msg, sizeof(msg), "{\"periodS\":%u,\"n\":%u", (_periods > 0 ? _periods : 1) * LP_FIDELITY_EVAL_SECONDS, _samples);
+
+		for (size_t i = 0; i < _channelCount && len > 0 && (size_t)len < sizeof(msg); i++) {
+			len += snprintf(msg + len, sizeof(msg) - (size_t)len, ",\"%s\":{\"avg\":%.2f,\"min\":%.2f,\"max\":%.2f}", _channels[i].name,
+				_channels[i].sum / _samples, _channels[i].min, _channels[i].max);
+		}
+
+		if (len > 0 && (size_t)len + 1 < sizeof(msg)) {
+			msg[len++] = '}';
+			msg[len] = 0;
+			SendTelemetryMessage(msg);
+		} else {
+			LP_LOG_LIMITED(LP_LOG_WARNING, LP_LOG_LIMIT_MS, "WARNING: telemetry summary larger than %d bytes dropped\n", LP_FIDELITY_MESSAGE_SIZE);
+		}
+	}
+
+	_samples = 0;
+	_periods = 0;
+}
+
+static void ChangeLevel(LP_FIDELITY_LEVEL level) {
+	if (level == _level) {
+		return;
+	}
+
+	SendSummary();
+	LP_LOG(LP_LOG_INFO, "INFO: telemetry fidelity %s to %s\n", _levelNames[_level], _levelNames[level]);
+	_level = level;
+	_healthyEvaluations = 0;
+
+	lp_deviceTwinReportState(&lp_telemetryFidelityTwin, (void*)_levelNames[_level]);
+}
+
+/// <summary>
+///     Record every sample of channelCount named channels with lp_recordTelemetrySample, sent with propertyTemplate
+///     or lp_sendMsg when NULL. A NULL policy uses the defaults, 20 queued or 5 s down, 2 queued and 1.5 s back up.
+/// </summary>
+bool lp_openTelemetryFidelity(const char** channelNames, size_t channelCount, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate,
+	const LP_FIDELITY_POLICY* policy) {
+	LP_TELEMETRY_STATS stats;
+
+	if (channelNames == NULL || channelCount == 0 || channelCount > LP_FIDELITY_MAX_CHANNELS) {
+		return false;
+	}
+
+	if (telemetryFidelityTimer.eventLoopTimer == NULL && !lp_startTimer(&telemetryFidelityTimer)) {
+		return false;
+	}
+
+	for (size_t i = 0; i < channelCount; i++) {
+		_channels[i].name = channelNames[i];
+	}
+	_channelCount = channelCount;
+	_template = propertyTemplate;
+	_policy = policy != NULL ? *policy : _defaultPolicy;
+	_samples = _periods = _healthyEvaluations = 0;
+
+	lp_getTelemetryStats(&stats);
+	_lastConfirmed = stats.confirmed;
+
+	return true;
+}
+
+/// <summary>
+///     Send the summary in progress and stop evaluating
+/// </summary>
+void lp_closeTelemetryFidelity(void) {
+	SendSummary();
+
+	if (telemetryFidelityTimer.eventLoopTimer != NULL) {
+		lp_stopTimer(&telemetryFidelityTimer);
+	}
+	_channelCount = 0;
+}
+
+/// <summary>
+///     One value for each channel, sent at once at raw fidelity and otherwise added to the summary
+/// </summary>
+bool lp_recordTelemetrySample(const double* values) {
+	char msg[LP_FIDELITY_MESSAGE_SIZE];
+	int len;
+
+	if (values == NULL || _channelCount == 0) {
+		return false;
+	}
+
+	if (_level != LP_FIDELITY_RAW) {
+		for (size_t i = 0; i < _channelCount; i++) {
+			if (_samples == 0 || values[i] < _channels[i].min) {
+				_channels[i].min = values[i];
+			}
+			if (_samples == 0 || values[i] > _channels[i].max) {
+				_channels[i].max = values[i];
+			}
+			_channels[i].sum = (_samples == 0 ? 0 : _channels[i].sum) + values[i];
+		}
+		_samples++;
+		return true;
+	}
+
+	len = snprintf(msg, sizeof(msg), "{");
+	for (size_t i = 0; i < _channelCount && (size_t)len < sizeof(msg); i++) {
+		len += snprintf(msg + len, sizeof(msg) - (size_t)len, "%s\"%s\":%.2f", i > 0 ? "," : "", _channels[i].name, values[i]);
+	}
+
+	if ((size_t)len + 1 >= sizeof(msg)) {
+		return false;
+	}
+
+	msg[len++] = '}';
+	msg[len] = 0;
+
+	return SendTelemetryMessage(msg);
+}
+
+LP_FIDELITY_LEVEL lp_getTelemetryFidelity(void) {
+	return _level;
+}
+
+void lp_setTelemetryFidelity(LP_FIDELITY_LEVEL level) {
+	_pinned = level >= 0 && level < LP_FIDELITY_LEVELS ? level : LP_FIDELITY_LEVELS;
+
+	if (_pinned != LP_FIDELITY_LEVELS) {
+		ChangeLevel(_pinned);
+	}
+	_healthyEvaluations = 0;
+}
+
+/// <summary>
+///     Step fidelity down when the link is behind and back up after it has kept up for LP_FIDELITY_RECOVER_EVALS
+/// </summary>
+static void EvaluatePolicy(void) {
+	LP_TELEMETRY_STATS stats;
+	size_t queued = lp_offlineQueueCount();
+
+	lp_getTelemetryStats(&stats);
+
+	// no confirmations this evaluation, latency is high with messages waiting and not a concern without
+	bool confirmed = stats.confirmed != _lastConfirmed;
+	bool latencyHigh = confirmed ? stats.latencyRecentMs >= _policy.degradeLatencyMs : stats.inFlight > 0;
+	bool latencyLow = confirmed ? stats.latencyRecentMs <= _policy.recoverLatencyMs : stats.inFlight == 0;
+
+	_lastConfirmed = stats.confirmed;
+
+	if (_pinned != LP_FIDELITY_LEVELS) {
+		return;
+	}
+
+	if (queued >= _policy.degradeQueueDepth || latencyHigh) {
+		_healthyEvaluations = 0;
+		if (_level + 1 < LP_FIDELITY_LEVELS) {
+			ChangeLevel(_level + 1);
+		}
+	} else if (queued <= _policy.recoverQueueDepth && latencyLow) {
+		if (++_healthyEvaluations >= LP_FIDELITY_RECOVER_EVALS && _level > LP_FIDELITY_RAW) {
+			ChangeLevel(_level - 1);
+		}
+	} else {
+		_healthyEvaluations = 0;
+	}
+}
+
+static void TelemetryFidelityHandler(EventLoopTimer* eventLoopTimer) {
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_TelemetryFidelityHandler);
+		return;
+	}
+
+	EvaluatePolicy();
+
+	if (_level == LP_FIDELITY_RAW) {
+		return;
+	}
+
+	_periods++;
+	if (_level == LP_FIDELITY_SUMMARY_10S || _periods >= LP_FIDELITY_LONG_PERIODS) {
+		SendSummary();
+	}
+}
+
+static void TelemetryFidelityTwinHandler(LP_DEVICE_TWIN_BINDING* deviceTwinBinding) {
+	const char* desired = (const char*)deviceTwinBinding->twinState;
+	LP_FIDELITY_LEVEL level = LP_FIDELITY_LEVELS;
+
+	for (int i = 0; i < LP_FIDELITY_LEVELS; i++) {
+		if (desired != NULL && strcmp(desired, _levelNames[i]) == 0) {
+			level = (LP_FIDELITY_LEVEL)i;
+		}
+	}
+
+	lp_setTelemetryFidelity(level);
+	lp_deviceTwinReportState(deviceTwinBinding, (void*)_levelNames[_level]);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "azure_iot.h"
+#include "device_twins.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LP_FIDELITY_MAX_CHANNELS 8
+#define LP_FIDELITY_MESSAGE_SIZE 512
+#define LP_FIDELITY_EVAL_SECONDS 10			// policy evaluation and the short summary period
+#define LP_FIDELITY_LONG_PERIODS 6			// evaluations in a long summary, 60 seconds
+#define LP_FIDELITY_RECOVER_EVALS 3			// healthy evaluations in a row before fidelity steps back up
+
+typedef enum {
+	LP_FIDELITY_RAW,				// every sample sent as it is recorded
+	LP_FIDELITY_SUMMARY_10S,		// average, minimum and maximum of each channel every 10 seconds
+	LP_FIDELITY_SUMMARY_60S,		// and every 60 seconds
+	LP_FIDELITY_LEVELS
+} LP_FIDELITY_LEVEL;
+
+typedef struct LP_FIDELITY_POLICY
+{
+	uint32_t degradeQueueDepth;		// offline queued messages that step fidelity down
+	uint32_t degradeLatencyMs;		// recent confirmation latency that steps fidelity down
+	uint32_t recoverQueueDepth;		// both at or under these for LP_FIDELITY_RECOVER_EVALS evaluations step it up
+	uint32_t recoverLatencyMs;
+} LP_FIDELITY_POLICY;
+
+// Telemetry that trades resolution for delivery when the link is struggling. The app records each sample of its
+// channels with lp_recordTelemetrySample instead of sending it. Every LP_FIDELITY_EVAL_SECONDS the policy reads
+// the offline queue depth and the telemetry stats' recent confirmation latency, a full evaluation with messages
+// in flight and none confirmed counts as high latency. Past the degrade thresholds fidelity steps down a level,
+// raw to 10 second summaries to 60 second summaries, and steps back up one level at a time once the link has
+// stayed under the recover thresholds. Summaries are one message per period,
+//
+//   {"periodS":10,"n":10,"temperature":{"avg":21.50,"min":21.40,"max":21.60},...}
+//
+// and the partial summary is sent when the level changes, so no sample is lost in the switch.
+bool lp_openTelemetryFidelity(const char** channelNames, size_t channelCount, const LP_MESSAGE_PROPERTY_TEMPLATE* propertyTemplate,
+	const LP_FIDELITY_POLICY* policy);
+void lp_closeTelemetryFidelity(void);
+bool lp_recordTelemetrySample(const double* values);
+LP_FIDELITY_LEVEL lp_getTelemetryFidelity(void);
+// pin a level, LP_FIDELITY_LEVELS returns to the policy
+void lp_setTelemetryFidelity(LP_FIDELITY_LEVEL level);
+
+// optional, add to the device twin set to report the level in effect, "raw", "10s" or "60s", and to pin one from
+// the cloud with the same strings, "auto" returns to the policy
+extern LP_DEVICE_TWIN_BINDING lp_telemetryFidelityTwin;
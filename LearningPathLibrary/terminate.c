@@ -2,6 +2,9 @@
 
 static volatile sig_atomic_t terminationRequired = false;
 static volatile sig_atomic_t _exitCode = 0;
+static int _shutdownDeadlineMs = LP_SHUTDOWN_DEFAULT_MS;
+static LP_SHUTDOWN_HOOK _shutdownHooks[LP_SHUTDOWN_MAX_HOOKS];
+static size_t _shutdownHookCount = 0;
 
 void lp_registerTerminationHandler(void) {
 	struct sigaction action;
@@ -28,3 +31,39 @@ bool lp_isTerminationRequired(void) {
 int lp_getTerminationExitCode(void) {
 	return _exitCode;
 }
+
+void lp_setShutdownDeadline(int deadlineMs) {
+	_shutdownDeadlineMs = deadlineMs < 0 ? 0 : deadlineMs;
+}
+
+int lp_getShutdownDeadline(void) {
+	return _shutdownDeadlineMs;
+}
+
+bool lp_addShutdownHook(LP_SHUTDOWN_HOOK hook) {
+	for (size_t i = 0; i < _shutdownHookCount; i++) {
+		if (_shutdownHooks[i] == hook) {
+			return true;
+		}
+	}
+
+	if (hook == NULL || _shutdownHookCount == LP_SHUTDOWN_MAX_HOOKS) {
+		return false;
+	}
+
+	_shutdownHooks[_shutdownHookCount++] = hook;
+	return true;
+}
+
+/// <summary>
+///     Every hook runs each time, one still waiting on acknowledgements does not hold up the others' flushes
+/// </summary>
+bool lp_runShutdownHooks(bool final) {
+	bool pending = false;
+
+	for (size_t i = 0; i < _shutdownHookCount; i++) {
+		pending = _shutdownHooks[i](final) || pending;
+	}
+
+	return pending;
+}
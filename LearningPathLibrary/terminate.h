@@ -3,8 +3,23 @@
 #include "globals.h"
 #include "exit_codes.h"
 
+#define LP_SHUTDOWN_DEFAULT_MS 3000		// flush deadline, inside the grace the OS gives after SIGTERM before it kills the app
+#define LP_SHUTDOWN_MAX_HOOKS 8
+
+// Called by lp_runEventLoop once termination is required, each time round the shutdown phase with final false,
+// start or continue the flush and return true while something is still in flight. Then once with final true when
+// none is, or the deadline passed, to persist what is left. The return is ignored for the final call.
+typedef bool (*LP_SHUTDOWN_HOOK)(bool final);
+
 void lp_registerTerminationHandler(void);
 void lp_terminationHandler(int signalNumber);
 void lp_terminate(int exitCode);
 bool lp_isTerminationRequired(void);
-int lp_getTerminationExitCode(void);
\ No newline at end of file
+int lp_getTerminationExitCode(void);
+// how long lp_runEventLoop keeps dispatching after termination while the library flushes, 0 exits straight away
+void lp_setShutdownDeadline(int deadlineMs);
+int lp_getShutdownDeadline(void);
+// for the library's modules, a hook already added is not added again, false once LP_SHUTDOWN_MAX_HOOKS are
+bool lp_addShutdownHook(LP_SHUTDOWN_HOOK hook);
+// true while any hook has work in flight
+bool lp_runShutdownHooks(bool final);
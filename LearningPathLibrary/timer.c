@@ -1,6 +1,13 @@
 #include "timer.h"
+#include "globals.h"
+#include <applibs/log.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 static LP_TIMER** _timers = NULL;
+static LP_TIMER* _startedTimers = NULL;
 static size_t _timerCount = 0;
 static EventLoop* eventLoop = NULL;
 
@@ -44,6 +51,18 @@ bool lp_startTimer(LP_TIMER* timer) {
 		}
 	}
 
+	if (timer->slack.tv_sec != 0 || timer->slack.tv_nsec != 0) {
+		SetEventLoopTimerSlack(timer->eventLoopTimer, &timer->slack);
+	}
+
+	if (timer->sampling == LP_TIMER_SAMPLE_SKIP) {
+		SetEventLoopTimerMissedPolicy(timer->eventLoopTimer, EventLoopTimer_SkipMissed);
+	} else if (timer->sampling == LP_TIMER_SAMPLE_CATCH_UP) {
+		SetEventLoopTimerMissedPolicy(timer->eventLoopTimer, EventLoopTimer_CatchUpMissed);
+	}
+
+	timer->next = _startedTimers;
+	_startedTimers = timer;
 
 	return true;
 }
@@ -52,6 +71,14 @@ void lp_stopTimer(LP_TIMER* timer) {
 	if (timer->eventLoopTimer != NULL) {
 		DisposeEventLoopTimer(timer->eventLoopTimer);
 		timer->eventLoopTimer = NULL;
+
+		for (LP_TIMER** link = &_startedTimers; *link != NULL; link = &(*link)->next) {
+			if (*link == timer) {
+				*link = timer->next;
+				break;
+			}
+		}
+		timer->next = NULL;
 	}
 }
 
@@ -94,4 +121,148 @@ bool lp_setOneShotTimer(LP_TIMER* timer, const struct timespec* period) {
 	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+/// <summary>
+///     Time left until the timer next fires, false when it is not started or not armed
+/// </summary>
+bool lp_getTimerRemaining(LP_TIMER* timer, struct timespec* remaining) {
+	if (timer->eventLoopTimer == NULL) {
+		return false;
+	}
+
+	return GetEventLoopTimerRemaining(timer->eventLoopTimer, remaining) == 0;
+}
+
+/// <summary>
+///     Let the timer fire up to slack late so the scheduler can align it with nearby expirations
+/// </summary>
+bool lp_setTimerSlack(LP_TIMER* timer, const struct timespec* slack) {
+	timer->slack = *slack;
+
+	if (timer->eventLoopTimer == NULL) {
+		return true;	// applied when the timer is started
+	}
+
+	return SetEventLoopTimerSlack(timer->eventLoopTimer, slack) == 0;
+}
+
+void lp_getTimerStats(LP_TIMER_STATS* stats) {
+	EventLoopTimerStats timerStats;
+
+	GetEventLoopTimerStats(&timerStats);
+
+	stats->wakeups = timerStats.wakeups;
+	stats->expirations = timerStats.expirations;
+	stats->wakeupsSaved = timerStats.expirations - timerStats.wakeups;
+	stats->poolInUse = timerStats.poolInUse;
+	stats->poolHighWater = timerStats.poolHighWater;
+	stats->poolRefused = timerStats.poolRefused;
+}
+
+/// <summary>
+///     Allocate the pool all started timers come from, fails once a timer has been started
+/// </summary>
+bool lp_initTimerPool(size_t timerCount) {
+	if (SetEventLoopTimerPoolSize(timerCount) == -1) {
+		Log_Debug("ERROR: Unable to size the timer pool for %zu timers: %s (%d)\n", timerCount, strerror(errno), errno);
+		return false;
+	}
+	return true;
+}
+
+/// <summary>
+///     Measure handler lag and run time of all timers, fire and overrun counts are always kept
+/// </summary>
+void lp_setTimerProfiling(bool enabled) {
+	SetEventLoopTimerProfiling(enabled);
+}
+
+bool lp_getTimerProfile(LP_TIMER* timer, LP_TIMER_PROFILE* profile) {
+	if (timer->eventLoopTimer == NULL) {
+		return false;
+	}
+
+	GetEventLoopTimerProfile(timer->eventLoopTimer, profile);
+	return true;
+}
+
+/// <summary>
+///     The started timer with the longest handler run time, NULL when no timer has been profiled
+/// </summary>
+LP_TIMER* lp_getSlowestTimer(LP_TIMER_PROFILE* profile) {
+	LP_TIMER* slowest = NULL;
+	LP_TIMER_PROFILE candidate;
+
+	for (LP_TIMER* timer = _startedTimers; timer != NULL; timer = timer->next) {
+		GetEventLoopTimerProfile(timer->eventLoopTimer, &candidate);
+		if (candidate.profiled > 0 && (slowest == NULL || candidate.runMaxUs > profile->runMaxUs)) {
+			slowest = timer;
+			*profile = candidate;
+		}
+	}
+
+	return slowest;
+}
+
+/// <summary>
+///     The name of the started timer an event loop timer belongs to, NULL for a timer not started through lp_startTimer
+/// </summary>
+const char* lp_getTimerName(const EventLoopTimer* eventLoopTimer) {
+	for (LP_TIMER* timer = _startedTimers; timer != NULL; timer = timer->next) {
+		if (timer->eventLoopTimer == eventLoopTimer) {
+			return timer->name == NULL ? "(unnamed)" : timer->name;
+		}
+	}
+
+	return NULL;
+}
+
+void lp_logTimerProfiles(void) {
+	LP_TIMER_PROFILE profile;
+
+	for (LP_TIMER* timer = _startedTimers; timer != NULL; timer = timer->next) {
+		GetEventLoopTimerProfile(timer->eventLoopTimer, &profile);
+		Log_Debug("Timer %s: fires %u, overruns %u, lag avg %u max %u us, run min %u avg %u max %u us\n",
+			timer->name == NULL ? "(unnamed)" : timer->name, profile.fires, profile.overruns,
+			profile.lagAvgUs, profile.lagMaxUs, profile.runMinUs, profile.runAvgUs, profile.runMaxUs);
+	}
+}
+
+/// <summary>
+///     The wall clock time the current firing was scheduled for, use it in the handler to stamp samples
+///     with their intended time rather than the time the handler got to run
+/// </summary>
+bool lp_getTimerSampleTime(LP_TIMER* timer, struct timespec* sampleTime) {
+	struct timespec scheduled, monotonic, realtime;
+	int64_t lateNs, sampleNs;
+
+	if (timer->eventLoopTimer == NULL) {
+		return false;
+	}
+
+	GetEventLoopTimerScheduledTime(timer->eventLoopTimer, &scheduled);
+	clock_gettime(CLOCK_MONOTONIC, &monotonic);
+	clock_gettime(CLOCK_REALTIME, &realtime);
+
+	lateNs = ((int64_t)monotonic.tv_sec - scheduled.tv_sec) * 1000000000LL + (monotonic.tv_nsec - scheduled.tv_nsec);
+	sampleNs = ((int64_t)realtime.tv_sec * 1000000000LL + realtime.tv_nsec) - lateNs;
+
+	sampleTime->tv_sec = (time_t)(sampleNs / 1000000000LL);
+	sampleTime->tv_nsec = (long)(sampleNs % 1000000000LL);
+
+	return true;
+}
+
+/// <summary>
+///     ISO 8601 UTC sample time with milliseconds, for example 2020-07-01T10:20:30.500Z
+/// </summary>
+char* lp_getTimerSampleUtc(LP_TIMER* timer, char* buffer, size_t bufferSize) {
+	struct timespec sampleTime;
+
+	if (!lp_getTimerSampleTime(timer, &sampleTime)) {
+		clock_gettime(CLOCK_REALTIME, &sampleTime);
+	}
+
+	return lp_formatUtc(&sampleTime, buffer, bufferSize);
+}
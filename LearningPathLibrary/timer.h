@@ -2,15 +2,40 @@
 
 #include "eventloop_timer_utilities.h"
 #include "stdbool.h"
+#include <stdint.h>
 #include <applibs/eventloop.h>
 
-typedef struct {
+typedef enum {
+	LP_TIMER_RELATIVE = 0,			// missed periods collapse and the period restarts from the late firing
+	LP_TIMER_SAMPLE_SKIP,			// absolute period grid, missed slots are skipped
+	LP_TIMER_SAMPLE_CATCH_UP		// absolute period grid, missed slots fire back to back
+} LP_TIMER_SAMPLING;
+
+typedef struct _lpTimer {
 	void (*handler)(EventLoopTimer* timer);
 	struct timespec period;
 	EventLoopTimer* eventLoopTimer;
 	const char* name;
+	struct timespec slack;		// optional, the timer may fire this late to share a wakeup with nearby timers
+	LP_TIMER_SAMPLING sampling;		// optional, drift free sampling for periodic timers
+	struct _lpTimer* next;		// internal, started timers are listed for profiling
 } LP_TIMER;
 
+typedef EventLoopTimerProfile LP_TIMER_PROFILE;
+
+typedef struct {
+	uint32_t wakeups;
+	uint32_t expirations;
+	uint32_t wakeupsSaved;		// expirations serviced by a wakeup another timer caused
+	uint32_t poolInUse;			// started timers, app and library
+	uint32_t poolHighWater;
+	uint32_t poolRefused;		// starts that failed with the timer pool exhausted
+} LP_TIMER_STATS;
+
+// Started timers come from a fixed pool, so starting and stopping a timer never allocates. Size it for the app's
+// timers plus the library's with lp_initTimerPool before the first start, or it holds EVENTLOOP_TIMER_POOL_DEFAULT.
+bool lp_initTimerPool(size_t timerCount);
+
 void lp_startTimerSet(LP_TIMER* timerSet[], size_t timerCount);
 void lp_stopTimerSet(void);
 bool lp_startTimer(LP_TIMER* timer);
@@ -18,4 +43,14 @@ void lp_stopTimer(LP_TIMER* timer);
 EventLoop* lp_getTimerEventLoop(void);
 void lp_stopTimerEventLoop(void);
 bool lp_changeTimer(LP_TIMER* timer, const struct timespec* period);
-bool lp_setOneShotTimer(LP_TIMER* timer, const struct timespec* delay);
\ No newline at end of file
+bool lp_setOneShotTimer(LP_TIMER* timer, const struct timespec* delay);
+bool lp_setTimerSlack(LP_TIMER* timer, const struct timespec* slack);
+bool lp_getTimerRemaining(LP_TIMER* timer, struct timespec* remaining);
+void lp_getTimerStats(LP_TIMER_STATS* stats);
+void lp_setTimerProfiling(bool enabled);
+bool lp_getTimerProfile(LP_TIMER* timer, LP_TIMER_PROFILE* profile);
+LP_TIMER* lp_getSlowestTimer(LP_TIMER_PROFILE* profile);
+void lp_logTimerProfiles(void);
+const char* lp_getTimerName(const EventLoopTimer* eventLoopTimer);
+bool lp_getTimerSampleTime(LP_TIMER* timer, struct timespec* sampleTime);
+char* lp_getTimerSampleUtc(LP_TIMER* timer, char* buffer, size_t bufferSize);
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "timeseries.h"
+#include <string.h>
+
+#define TIMESERIES_COUNT_OFFSET 4		// after 'L' 'T', the version and the channel count
+#define TIMESERIES_NO_WINDOW 0xff		// leading bits of a channel with no XOR window yet
+
+/// <summary>
+///     Append the low bitCount bits of value, most significant first
+/// </summary>
+static void PutBits(LP_TIMESERIES_BLOCK* block, uint64_t value, unsigned int bitCount) {
+	if (block->overflow || block->bitLength + bitCount > block->capacity * 8) {
+		block->overflow = true;
+		return;
+	}
+
+	while (bitCount > 0) {
+		size_t byteIndex = block->bitLength / 8;
+		unsigned int bitOffset = (unsigned int)(block->bitLength % 8);
+		unsigned int take = 8 - bitOffset < bitCount ? 8 - bitOffset : bitCount;
+		uint8_t bits = (uint8_t)((value >> (bitCount - take)) & ((1u << take) - 1));
+
+		if (bitOffset == 0) {
+			block->buffer[byteIndex] = 0;
+		}
+		block->buffer[byteIndex] |= (uint8_t)(bits << (8 - bitOffset - take));
+
+		block->bitLength += take;
+		bitCount -= take;
+	}
+}
+
+static void PutDeltaOfDelta(LP_TIMESERIES_BLOCK* block, int64_t deltaOfDelta) {
+	if (deltaOfDelta == 0) {
+		PutBits(block, 0x0, 1);
+	} else if (deltaOfDelta >= -64 && deltaOfDelta <= 63) {
+		PutBits(block, 0x2, 2);
+		PutBits(block, (uint64_t)deltaOfDelta, 7);
+	} else if (deltaOfDelta >= -256 && deltaOfDelta <= 255) {
+		PutBits(block, 0x6, 3);
+		PutBits(block, (uint64_t)deltaOfDelta, 9);
+	} else if (deltaOfDelta >= -2048 && deltaOfDelta <= 2047) {
+		PutBits(block, 0xe, 4);
+		PutBits(block, (uint64_t)deltaOfDelta, 12);
+	} else {
+		PutBits(block, 0xf, 4);
+		PutBits(block, (uint64_t)deltaOfDelta, 32);
+	}
+}
+
+static void PutValue(LP_TIMESERIES_BLOCK* block, size_t channel, uint32_t value) {
+	uint32_t xor = value ^ block->lastValue[channel];
+
+	if (xor == 0) {
+		PutBits(block, 0x0, 1);
+		return;
+	}
+
+	unsigned int leading = (unsigned int)__builtin_clz(xor);		// at most 31, xor is not zero
+	unsigned int trailing = (unsigned int)__builtin_ctz(xor);
+
+	// inside the previous window the window is not repeated
+	if (block->leading[channel] != TIMESERIES_NO_WINDOW && leading >= block->leading[channel] && trailing >= block->trailing[channel]) {
+		PutBits(block, 0x2, 2);
+		PutBits(block, xor >> block->trailing[channel], 32 - block->leading[channel] - block->trailing[channel]);
+	} else {
+		unsigned int length = 32 - leading - trailing;
+
+		PutBits(block, 0x3, 2);
+		PutBits(block, leading, 5);
+		PutBits(block, length - 1, 5);
+		PutBits(block, xor >> trailing, length);
+
+		block->leading[channel] = (uint8_t)leading;
+		block->trailing[channel] = (uint8_t)trailing;
+	}
+}
+
+/// <summary>
+///     Start a block in buffer for channelCount float channels named channelNames, false if the header does not fit
+/// </summary>
+bool lp_timeseriesBegin(LP_TIMESERIES_BLOCK* block, uint8_t* buffer, size_t capacity, const char** channelNames, size_t channelCount) {
+	memset(block, 0, sizeof(LP_TIMESERIES_BLOCK));
+
+	if (buffer == NULL || channelNames == NULL || channelCount == 0 || channelCount > LP_TIMESERIES_MAX_CHANNELS) {
+		return false;
+	}
+
+	block->buffer = buffer;
+	block->capacity = capacity;
+	block->channelCount = (uint8_t)channelCount;
+	memset(block->leading, TIMESERIES_NO_WINDOW, sizeof(block->leading));
+
+	PutBits(block, 'L', 8);
+	PutBits(block, 'T', 8);
+	PutBits(block, LP_TIMESERIES_VERSION, 8);
+	PutBits(block, channelCount, 8);
+	PutBits(block, 0, 16);		// count, kept up to date by lp_timeseriesAppend
+
+	for (size_t i = 0; i < channelCount; i++) {
+		size_t nameLength = channelNames[i] != NULL ? strlen(channelNames[i]) : 0;
+
+		if (nameLength > 255) {
+			block->overflow = true;
+			break;
+		}
+
+		PutBits(block, nameLength, 8);
+		for (size_t j = 0; j < nameLength; j++) {
+			PutBits(block, (uint8_t)channelNames[i][j], 8);
+		}
+	}
+
+	block->headerLength = block->bitLength;
+
+	return !block->overflow;
+}
+
+/// <summary>
+///     Add a sample, one value per channel, timestamps in milliseconds and not decreasing
+/// </summary>
+bool lp_timeseriesAppend(LP_TIMESERIES_BLOCK* block, int64_t timestampMs, const float* values) {
+	LP_TIMESERIES_BLOCK before;
+	uint32_t bits[LP_TIMESERIES_MAX_CHANNELS];
+
+	if (block->buffer == NULL || block->overflow || values == NULL || block->count >= LP_TIMESERIES_MAX_SAMPLES) {
+		return false;
+	}
+
+	before = *block;
+	memcpy(bits, values, block->channelCount * sizeof(uint32_t));
+
+	if (block->count == 0) {
+		PutBits(block, (uint64_t)timestampMs, 64);
+		for (size_t i = 0; i < block->channelCount; i++) {
+			PutBits(block, bits[i], 32);
+		}
+	} else {
+		int64_t delta = timestampMs - block->lastTimestamp;
+		PutDeltaOfDelta(block, delta - block->lastDelta);
+		block->lastDelta = delta;
+
+		for (size_t i = 0; i < block->channelCount; i++) {
+			PutValue(block, i, bits[i]);
+		}
+	}
+
+	if (block->overflow) {
+		// roll back, clearing the bits the sample left in the last partial byte
+		*block = before;
+		if (block->bitLength % 8 != 0) {
+			block->buffer[block->bitLength / 8] &= (uint8_t)(0xff << (8 - block->bitLength % 8));
+		}
+		return false;
+	}
+
+	block->lastTimestamp = timestampMs;
+	memcpy(block->lastValue, bits, block->channelCount * sizeof(uint32_t));
+	block->count++;
+	block->buffer[TIMESERIES_COUNT_OFFSET] = (uint8_t)(block->count >> 8);
+	block->buffer[TIMESERIES_COUNT_OFFSET + 1] = (uint8_t)block->count;
+
+	return true;
+}
+
+/// <summary>
+///     Bytes of the block, the last byte padded with zero bits
+/// </summary>
+size_t lp_timeseriesLength(const LP_TIMESERIES_BLOCK* block) {
+	return (block->bitLength + 7) / 8;
+}
+
+/// <summary>
+///     Empty the block for the next series, keeping the channel names
+/// </summary>
+void lp_timeseriesReset(LP_TIMESERIES_BLOCK* block) {
+	block->bitLength = block->headerLength;
+	block->count = 0;
+	block->lastTimestamp = 0;
+	block->lastDelta = 0;
+	block->overflow = false;
+	memset(block->leading, TIMESERIES_NO_WINDOW, sizeof(block->leading));
+	block->buffer[TIMESERIES_COUNT_OFFSET] = 0;
+	block->buffer[TIMESERIES_COUNT_OFFSET + 1] = 0;
+
+	if (block->bitLength % 8 != 0) {
+		block->buffer[block->bitLength / 8] &= (uint8_t)(0xff << (8 - block->bitLength % 8));
+	}
+}
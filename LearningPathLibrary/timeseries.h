@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LP_TIMESERIES_MAX_CHANNELS 8
+#define LP_TIMESERIES_MAX_SAMPLES 65535
+#define LP_TIMESERIES_VERSION 1
+#define LP_TIMESERIES_CONTENT_TYPE "application/vnd.lp-timeseries"
+
+typedef struct LP_TIMESERIES_BLOCK
+{
+	uint8_t* buffer;
+	size_t capacity;
+	size_t bitLength;
+	size_t headerLength;
+	uint8_t channelCount;
+	uint32_t count;
+	int64_t lastTimestamp;
+	int64_t lastDelta;
+	uint32_t lastValue[LP_TIMESERIES_MAX_CHANNELS];
+	uint8_t leading[LP_TIMESERIES_MAX_CHANNELS];		// the XOR window of the last value that was not a repeat
+	uint8_t trailing[LP_TIMESERIES_MAX_CHANNELS];
+	bool overflow;
+} LP_TIMESERIES_BLOCK;
+
+// A block of samples of up to LP_TIMESERIES_MAX_CHANNELS float channels, encoded the way Gorilla (Pelkonen et al.,
+// VLDB 2015) encodes time series: timestamps as delta of deltas, a regular sample period costs one bit, and each
+// value as the XOR with the channel's previous value, an unchanged reading costs one bit and a small change the
+// few bits that differ. Slowly changing sensor series come to a byte or two per sample against 80 or so as JSON.
+//
+// Layout, big endian, bits written most significant first
+//   'L' 'T' version channelCount count:16 then per channel nameLength:8 name
+//   first sample   timestamp:64 then each value:32
+//   later samples  delta of delta, '0' | '10' 7 bits | '110' 9 bits | '1110' 12 bits | '1111' 32 bits, two's complement ms
+//                  each value '0' repeat | '10' meaningful bits in the previous window | '11' leading:5 length-1:5 bits
+//
+// Sent with lp_sendTimeseries as contentType LP_TIMESERIES_CONTENT_TYPE, tools/timeseries-decode decodes it.
+bool lp_timeseriesBegin(LP_TIMESERIES_BLOCK* block, uint8_t* buffer, size_t capacity, const char** channelNames, size_t channelCount);
+// false, with the block unchanged, when the sample does not fit or the block holds LP_TIMESERIES_MAX_SAMPLES
+bool lp_timeseriesAppend(LP_TIMESERIES_BLOCK* block, int64_t timestampMs, const float* values);
+size_t lp_timeseriesLength(const LP_TIMESERIES_BLOCK* block);
+void lp_timeseriesReset(LP_TIMESERIES_BLOCK* block);
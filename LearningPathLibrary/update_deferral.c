@@ -0,0 +1,209 @@
+#include "update_deferral.h"
+
+typedef enum {
+	LP_UPDATE_IDLE,
+	LP_UPDATE_DEFERRED,			// waiting for the backlog to drain
+	LP_UPDATE_FLUSHING,			// the shutdown hooks are flushing before the update is resumed
+	LP_UPDATE_ACCEPTED			// resumed, the OS terminates the app to install it
+} LP_UPDATE_STATE;
+
+static void UpdateDeferralHandler(EventLoopTimer* eventLoopTimer);
+
+static EventRegistration* _updateRegistration = NULL;
+static LP_UPDATE_STATE _updateState = LP_UPDATE_IDLE;
+static int _maxDeferMinutes = 0;
+static int _flushDeadlineMs = LP_UPDATE_DEFAULT_FLUSH_MS;
+static struct timespec _flushStartedAt;
+static LP_UPDATE_DEFERRAL_STATS _updateStats;
+
+static LP_TIMER updateDeferralTimer = {
+	.period = { 0, 0 },			// one-shot timer, the backlog poll while deferred and the flush poll
+	.name = "updateDeferralTimer",
+	.handler = &UpdateDeferralHandler
+};
+
+static void ArmUpdateTimer(int delayMs) {
+	if (updateDeferralTimer.eventLoopTimer == NULL && !lp_startTimer(&updateDeferralTimer)) {
+		return;
+	}
+	lp_setOneShotTimer(&updateDeferralTimer, &(struct timespec){delayMs / 1000, (delayMs % 1000) * 1000000});
+}
+
+/// <summary>
+///     Messages are leaving the device, the offline queue or confirmations over a live connection or a blob upload.
+///     Offline nothing drains, deferring would only hold the update until the deferral runs out
+/// </summary>
+static bool BacklogDraining(void) {
+	LP_TELEMETRY_STATS telemetry;
+
+	if (lp_getBlobUploadStatus() == LP_BLOB_UPLOADING) {
+		return true;
+	}
+
+	if (lp_getConnectionState() != LP_CONNECTION_AUTHENTICATED) {
+		return false;
+	}
+
+	lp_getTelemetryStats(&telemetry);
+	return lp_offlineQueueCount() > 0 || telemetry.inFlight > 0;
+}
+
+static void StartFlush(void) {
+	_updateState = LP_UPDATE_FLUSHING;
+	clock_gettime(CLOCK_MONOTONIC, &_flushStartedAt);
+	lp_kickCloudToDevice();
+	ArmUpdateTimer(LP_UPDATE_FLUSH_POLL_MS);
+}
+
+/// <summary>
+///     One flush step, the hooks as the shutdown phase runs them, then persist and resume the update once none has
+///     work in flight or the deadline passed. The event loop keeps running meanwhile so DoWork confirms the flush
+/// </summary>
+static void ContinueFlush(void) {
+	struct timespec now;
+	bool pending = lp_runShutdownHooks(false);
+	int elapsedMs;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	elapsedMs = (int)((now.tv_sec - _flushStartedAt.tv_sec) * 1000 + (now.tv_nsec - _flushStartedAt.tv_nsec) / 1000000);
+
+	if (pending && elapsedMs < _flushDeadlineMs) {
+		ArmUpdateTimer(LP_UPDATE_FLUSH_POLL_MS);
+		return;
+	}
+
+	lp_runShutdownHooks(true);
+
+	if (pending) {
+		_updateStats.flushTimeouts++;
+	}
+	_updateStats.accepted++;
+	_updateState = LP_UPDATE_ACCEPTED;
+
+	LP_LOG(pending ? LP_LOG_WARNING : LP_LOG_INFO, "Update accepted after %u minutes deferred, flush %s in %d ms\n",
+		_updateStats.deferredMinutes, pending ? "cut short" : "finished", elapsedMs);
+
+	if (SysEvent_ResumeEvent(SysEvent_Events_UpdateReadyForInstall) == -1) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: could not resume the update: %s (%d)\n", strerror(errno), errno);
+	}
+}
+
+/// <summary>
+///     Update ready for install. Pending asks whether to defer it, each deferral that runs out asks again
+/// </summary>
+static void UpdateEventCallback(SysEvent_Events event, SysEvent_Status status, const SysEvent_Info* info, void* context) {
+	SysEvent_Info_UpdateData update = { 0, SysEvent_UpdateType_Invalid };
+	int limitMinutes;
+
+	if (event != SysEvent_Events_UpdateReadyForInstall) {
+		return;
+	}
+
+	switch (status) {
+	case SysEvent_Status_Pending:
+		_updateStats.notifications++;
+		if (_updateState == LP_UPDATE_FLUSHING || _updateState == LP_UPDATE_ACCEPTED) {
+			return;		// already on its way
+		}
+
+		SysEvent_Info_GetUpdateData(info, &update);
+		limitMinutes = (int)update.max_deferral_time_in_minutes < _maxDeferMinutes ? (int)update.max_deferral_time_in_minutes : _maxDeferMinutes;
+
+		if (!BacklogDraining()) {
+			if (_updateState == LP_UPDATE_DEFERRED) {
+				StartFlush();	// drained as the deferral ran out
+			}
+			return;
+		}
+
+		if ((int)_updateStats.deferredMinutes + LP_UPDATE_DEFER_MINUTES > limitMinutes) {
+			_updateStats.limitReached++;
+			LP_LOG(LP_LOG_WARNING, "WARNING: %s update deferred %u minutes, the limit, flushing with the backlog still draining\n",
+				update.update_type == SysEvent_UpdateType_System ? "System" : "App", _updateStats.deferredMinutes);
+			StartFlush();
+			return;
+		}
+
+		if (SysEvent_DeferEvent(SysEvent_Events_UpdateReadyForInstall, LP_UPDATE_DEFER_MINUTES) == -1) {
+			LP_LOG(LP_LOG_ERROR, "ERROR: could not defer the update: %s (%d)\n", strerror(errno), errno);
+			StartFlush();
+			return;
+		}
+
+		_updateStats.deferrals++;
+		_updateStats.deferredMinutes += LP_UPDATE_DEFER_MINUTES;
+		_updateState = LP_UPDATE_DEFERRED;
+		LP_LOG(LP_LOG_INFO, "Update deferred while the telemetry backlog drains, %u of %d minutes\n", _updateStats.deferredMinutes, limitMinutes);
+		ArmUpdateTimer(LP_UPDATE_POLL_MS);
+		break;
+
+	case SysEvent_Status_Final:
+		LP_LOG(LP_LOG_INFO, "Update installing, the app will be terminated\n");
+		break;
+
+	case SysEvent_Status_Complete:
+		_updateState = LP_UPDATE_IDLE;
+		_updateStats.deferredMinutes = 0;
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void UpdateDeferralHandler(EventLoopTimer* eventLoopTimer) {
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0) {
+		lp_terminate(ExitCode_UpdateDeferralHandler);
+		return;
+	}
+
+	if (_updateState == LP_UPDATE_DEFERRED) {
+		if (BacklogDraining()) {
+			ArmUpdateTimer(LP_UPDATE_POLL_MS);
+		}
+		else {
+			StartFlush();
+		}
+	}
+	else if (_updateState == LP_UPDATE_FLUSHING) {
+		ContinueFlush();
+	}
+}
+
+/// <summary>
+///     Register for update notifications, maxDeferMinutes bounds how long one update is held, 0 flushes without deferring
+/// </summary>
+bool lp_startUpdateDeferral(int maxDeferMinutes, int flushDeadlineMs) {
+	_maxDeferMinutes = maxDeferMinutes < 0 ? 0 : maxDeferMinutes;
+	_flushDeadlineMs = flushDeadlineMs > 0 ? flushDeadlineMs : LP_UPDATE_DEFAULT_FLUSH_MS;
+
+	if (_updateRegistration != NULL) {
+		return true;
+	}
+
+	_updateRegistration = SysEvent_RegisterForEventNotifications(lp_getTimerEventLoop(), SysEvent_Events_UpdateReadyForInstall,
+		UpdateEventCallback, NULL);
+	if (_updateRegistration == NULL) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: could not register for update notifications, is SystemEventNotifications in the app manifest: %s (%d)\n",
+			strerror(errno), errno);
+		return false;
+	}
+
+	return true;
+}
+
+void lp_stopUpdateDeferral(void) {
+	if (_updateRegistration != NULL) {
+		SysEvent_UnregisterForEventNotifications(_updateRegistration);
+		_updateRegistration = NULL;
+	}
+
+	if (updateDeferralTimer.eventLoopTimer != NULL) {
+		lp_stopTimer(&updateDeferralTimer);
+	}
+	_updateState = LP_UPDATE_IDLE;
+}
+
+void lp_getUpdateDeferralStats(LP_UPDATE_DEFERRAL_STATS* stats) {
+	*stats = _updateStats;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "azure_iot.h"
+#include "blob_upload.h"
+#include "logging.h"
+#include "offline_queue.h"
+#include "terminate.h"
+#include "timer.h"
+#include <applibs/sysevent.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define LP_UPDATE_DEFER_MINUTES 1			// each deferral, the OS notifies again as it runs out if the backlog is still draining
+#define LP_UPDATE_POLL_MS 1000				// the backlog is checked this often while the update is deferred
+#define LP_UPDATE_FLUSH_POLL_MS 50			// and the shutdown hooks this often while they flush
+#define LP_UPDATE_DEFAULT_FLUSH_MS 10000	// flush deadline when lp_startUpdateDeferral is given 0
+
+typedef struct LP_UPDATE_DEFERRAL_STATS
+{
+	uint32_t notifications;			// update ready for install, pending, each time the OS asked
+	uint32_t deferrals;				// SysEvent_DeferEvent calls, deferredMinutes their total for the current update
+	uint32_t deferredMinutes;
+	uint32_t accepted;				// updates resumed once the backlog drained and the flush finished
+	uint32_t flushTimeouts;			// of those, flushes cut short by the deadline with work still in flight
+	uint32_t limitReached;			// updates let through with the backlog still draining, the deferral limit spent
+} LP_UPDATE_DEFERRAL_STATS;
+
+// Holds off an OTA update while the telemetry backlog drains, so the OS does not terminate the app with messages
+// queued. Registered for update notifications with SysEvent_RegisterForEventNotifications, when an update is ready
+// to install and the offline queue, messages awaiting confirmation or a blob upload are draining over a live
+// connection, the update is deferred LP_UPDATE_DEFER_MINUTES at a time, to at most maxDeferMinutes and what the OS
+// allows. Once nothing is draining, or the connection is lost so nothing will, the library's shutdown hooks flush
+// what is in flight for at most flushDeadlineMs, persist what is left, and the update is resumed. An update that
+// arrives with nothing draining is let through untouched, the hooks flush at SIGTERM as for any shutdown.
+//
+// The app manifest needs "SystemEventNotifications": true and "SoftwareUpdateDeferral": true.
+bool lp_startUpdateDeferral(int maxDeferMinutes, int flushDeadlineMs);
+void lp_stopUpdateDeferral(void);
+void lp_getUpdateDeferralStats(LP_UPDATE_DEFERRAL_STATS* stats);
@@ -0,0 +1,217 @@
+#include "worker_pool.h"
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct WORKER_JOB
+{
+	void (*work)(void* context);
+	void (*done)(void* context);
+	void* context;
+} WORKER_JOB;
+
+static void WorkerCompletionHandler(EventLoop* el, int fd, EventLoop_IoEvents events, void* context);
+
+// both rings hold LP_WORKER_QUEUE_SIZE, a job is refused while that many are outstanding so neither overflows
+static WORKER_JOB _jobs[LP_WORKER_QUEUE_SIZE];
+static WORKER_JOB _completions[LP_WORKER_QUEUE_SIZE];
+static size_t _jobHead = 0, _jobCount = 0;
+static size_t _completionHead = 0, _completionCount = 0;
+static size_t _outstanding = 0;			// event loop only, submitted and not yet done
+
+static pthread_mutex_t _poolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _jobReady = PTHREAD_COND_INITIALIZER;
+static pthread_t _workers[LP_WORKER_MAX_THREADS];
+static int _workerCount = 0;
+static bool _poolStopping = false;
+static int _completionFd = -1;
+static EventRegistration* _completionRegistration = NULL;
+static LP_WORKER_POOL_STATS _poolStats;		// workMaxUs under _poolLock, the rest event loop only
+
+static void* WorkerMain(void* unused) {
+	struct timespec started, finished;
+
+	pthread_mutex_lock(&_poolLock);
+
+	for (;;) {
+		while (_jobCount == 0 && !_poolStopping) {
+			pthread_cond_wait(&_jobReady, &_poolLock);
+		}
+
+		if (_jobCount == 0) {
+			break;		// stopping with the queue drained
+		}
+
+		WORKER_JOB job = _jobs[_jobHead];
+		_jobHead = (_jobHead + 1) % LP_WORKER_QUEUE_SIZE;
+		_jobCount--;
+		pthread_mutex_unlock(&_poolLock);
+
+		clock_gettime(CLOCK_MONOTONIC, &started);
+		job.work(job.context);
+		clock_gettime(CLOCK_MONOTONIC, &finished);
+
+		int64_t workUs = (finished.tv_sec - started.tv_sec) * 1000000 + (finished.tv_nsec - started.tv_nsec) / 1000;
+
+		pthread_mutex_lock(&_poolLock);
+		if (workUs > _poolStats.workMaxUs) {
+			_poolStats.workMaxUs = (uint32_t)workUs;
+		}
+		_completions[(_completionHead + _completionCount++) % LP_WORKER_QUEUE_SIZE] = job;
+
+		uint64_t one = 1;
+		if (write(_completionFd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+			LP_LOG_LIMITED(LP_LOG_ERROR, LP_LOG_LIMIT_MS, "ERROR: worker completion wakeup failed: %d (%s)\n", errno, strerror(errno));
+		}
+	}
+
+	pthread_mutex_unlock(&_poolLock);
+	return NULL;
+}
+
+/// <summary>
+///     Run the done functions of finished jobs, event loop side
+/// </summary>
+static void RunCompletions(void) {
+	WORKER_JOB job;
+
+	for (;;) {
+		pthread_mutex_lock(&_poolLock);
+		if (_completionCount == 0) {
+			pthread_mutex_unlock(&_poolLock);
+			return;
+		}
+		job = _completions[_completionHead];
+		_completionHead = (_completionHead + 1) % LP_WORKER_QUEUE_SIZE;
+		_completionCount--;
+		pthread_mutex_unlock(&_poolLock);
+
+		_outstanding--;
+		_poolStats.completed++;
+		if (job.done != NULL) {
+			job.done(job.context);
+		}
+	}
+}
+
+static void CloseCompletionFd(void) {
+	if (_completionRegistration != NULL) {
+		EventLoop_UnregisterIo(lp_getTimerEventLoop(), _completionRegistration);
+		_completionRegistration = NULL;
+	}
+	if (_completionFd != -1) {
+		close(_completionFd);
+		_completionFd = -1;
+	}
+}
+
+/// <summary>
+///     Start threads workers, clamped to 1 to LP_WORKER_MAX_THREADS, each with an LP_WORKER_STACK_BYTES stack
+/// </summary>
+bool lp_openWorkerPool(int threads) {
+	pthread_attr_t attributes;
+
+	if (_workerCount > 0) {
+		return true;
+	}
+
+	threads = threads < 1 ? 1 : threads > LP_WORKER_MAX_THREADS ? LP_WORKER_MAX_THREADS : threads;
+
+	if ((_completionFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) == -1) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: Unable to create the worker completion eventfd: %d (%s)\n", errno, strerror(errno));
+		return false;
+	}
+
+	_completionRegistration = EventLoop_RegisterIo(lp_getTimerEventLoop(), _completionFd, EventLoop_Input, WorkerCompletionHandler, NULL);
+	if (_completionRegistration == NULL) {
+		LP_LOG(LP_LOG_ERROR, "ERROR: Unable to register the worker completion event: %d (%s)\n", errno, strerror(errno));
+		CloseCompletionFd();
+		return false;
+	}
+
+	_poolStopping = false;
+	pthread_attr_init(&attributes);
+	pthread_attr_setstacksize(&attributes, LP_WORKER_STACK_BYTES);
+
+	for (int i = 0; i < threads; i++) {
+		int result = pthread_create(&_workers[_workerCount], &attributes, WorkerMain, NULL);
+		if (result != 0) {
+			LP_LOG(LP_LOG_ERROR, "ERROR: Unable to start worker %d: %d (%s)\n", i, result, strerror(result));
+			break;
+		}
+		_workerCount++;
+	}
+
+	pthread_attr_destroy(&attributes);
+
+	if (_workerCount == 0) {
+		CloseCompletionFd();
+		return false;
+	}
+
+	return true;
+}
+
+void lp_closeWorkerPool(void) {
+	if (_workerCount == 0) {
+		return;
+	}
+
+	pthread_mutex_lock(&_poolLock);
+	_poolStopping = true;
+	pthread_cond_broadcast(&_jobReady);
+	pthread_mutex_unlock(&_poolLock);
+
+	for (int i = 0; i < _workerCount; i++) {
+		pthread_join(_workers[i], NULL);
+	}
+	_workerCount = 0;
+
+	RunCompletions();
+	CloseCompletionFd();
+}
+
+bool lp_isWorkerPoolRunning(void) {
+	return _workerCount > 0;
+}
+
+bool lp_submitWork(void (*work)(void* context), void (*done)(void* context), void* context) {
+	if (work == NULL || _workerCount == 0 || _outstanding >= LP_WORKER_QUEUE_SIZE) {
+		_poolStats.refused++;
+		return false;
+	}
+
+	pthread_mutex_lock(&_poolLock);
+	_jobs[(_jobHead + _jobCount++) % LP_WORKER_QUEUE_SIZE] = (WORKER_JOB){ work, done, context };
+	pthread_cond_signal(&_jobReady);
+	pthread_mutex_unlock(&_poolLock);
+
+	_poolStats.submitted++;
+	if (++_outstanding > _poolStats.highWater) {
+		_poolStats.highWater = (uint32_t)_outstanding;
+	}
+
+	return true;
+}
+
+void lp_getWorkerPoolStats(LP_WORKER_POOL_STATS* stats) {
+	if (stats != NULL) {
+		pthread_mutex_lock(&_poolLock);
+		*stats = _poolStats;
+		pthread_mutex_unlock(&_poolLock);
+	}
+}
+
+static void WorkerCompletionHandler(EventLoop* el, int fd, EventLoop_IoEvents events, void* context) {
+	uint64_t count;
+
+	if (read(fd, &count, sizeof(count)) == -1 && errno != EAGAIN) {
+		lp_terminate(ExitCode_WorkerPoolHandler);
+		return;
+	}
+
+	RunCompletions();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "logging.h"
+#include "terminate.h"
+#include "timer.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LP_WORKER_MAX_THREADS 2			// the A7 has one core, a second worker only overlaps a job with a blocked one
+#define LP_WORKER_QUEUE_SIZE 16			// jobs submitted and not yet completed
+#define LP_WORKER_STACK_BYTES 65536		// each worker's stack, jobs keep large buffers in their context
+
+typedef struct LP_WORKER_POOL_STATS
+{
+	uint32_t submitted;
+	uint32_t refused;				// submits with the pool closed or LP_WORKER_QUEUE_SIZE jobs outstanding, run inline by the caller
+	uint32_t completed;				// completions run on the event loop
+	uint32_t highWater;				// most jobs outstanding at once
+	uint32_t workMaxUs;				// longest a job's work function ran
+} LP_WORKER_POOL_STATS;
+
+// A small fixed pool of worker threads for CPU heavy encoding, compression and post-processing, so it does not
+// hold up the event loop. A job's work function runs on a worker, its done function on the event loop: workers
+// put finished jobs on a completion queue and write an eventfd registered with lp_getTimerEventLoop(). Work
+// functions touch only their context, library state and the tracked heap belong to the event loop, so the
+// submitter allocates what the job needs and done frees it. With two workers jobs may complete out of order.
+//
+// The telemetry batch uses the pool once it is open, see lp_openTelemetryBatch.
+bool lp_openWorkerPool(int threads);
+// finishes the queued jobs and runs their done functions before returning
+void lp_closeWorkerPool(void);
+bool lp_isWorkerPoolRunning(void);
+// false when the job was not queued, the caller runs it inline
+bool lp_submitWork(void (*work)(void* context), void (*done)(void* context), void* context);
+void lp_getWorkerPoolStats(LP_WORKER_POOL_STATS* stats);
@@ -0,0 +1,361 @@
+/*
+ *   Inter-core latency and throughput benchmark
+ *
+ *   Pairs with RTApp_FreeRTOS or RTApp_ThreadX, which echo every frame they receive. Measures
+ *   lp_interCoreRequest round trips, windowed streaming throughput at several frame sizes and how
+ *   bursts of back to back frames survive the socket and the shared ring. Results are written to
+ *   the debug output, the real-time app prints the frames and bytes it receives each second over UART.
+ *
+ *   Set the real-time app component ID in the app_manifest CmdArgs, deploy both apps and read the Output window.
+ */
+
+ // Learning Path Libraries
+#include "event_loop.h"
+#include "exit_codes.h"
+#include "globals.h"
+#include "inter_core.h"
+#include "terminate.h"
+#include "timer.h"
+
+// System Libraries
+#include "applibs_versions.h"
+#include <applibs/log.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define PING_PONG_ITERATIONS 1000
+#define PING_PONG_TIMEOUT_MS 100
+#define STREAM_WINDOW_FRAMES 4			// frames in flight, enough to keep both directions busy without overrunning the ring
+#define STREAM_DURATION_SECONDS 3
+#define BURST_RECORDS_PER_FRAME 8
+#define BURST_TIMEOUT_SECONDS 2
+#define MAX_RECORDS_PER_FRAME 16		// sixteen sensor records fill a LP_IC_MAX_FRAME_SIZE frame
+
+typedef enum
+{
+	PHASE_CONNECT,
+	PHASE_PING_PONG,
+	PHASE_STREAM,
+	PHASE_BURST,
+	PHASE_DONE
+} BENCHMARK_PHASE;
+
+static const size_t streamRecordsPerFrame[] = { 1, 4, 8, 16 };
+static const size_t burstFrames[] = { 16, 64, 256 };
+
+static void BenchmarkStepHandler(EventLoopTimer* eventLoopTimer);
+static void SendPing(void);
+
+static LP_TIMER benchmarkStepTimer = {
+	.period = { 0, 0 },		// one-shot, phase deadlines and retries
+	.name = "benchmarkStepTimer",
+	.handler = BenchmarkStepHandler };
+
+LP_TIMER* timerSet[] = { &benchmarkStepTimer };
+
+static BENCHMARK_PHASE phase = PHASE_CONNECT;
+static size_t phaseIndex = 0;
+static struct timespec phaseStart;
+static LP_INTER_CORE_BLOCK records[MAX_RECORDS_PER_FRAME];
+
+static uint32_t pings = 0;
+
+// streaming and bursts, echoes are matched on the run tag so stragglers from an earlier run are not counted
+static float runTag = 0.0f;
+static size_t recordsPerFrame = 0;
+static uint32_t recordsSent = 0;
+static uint32_t recordsReceived = 0;
+static uint32_t sendFailures = 0;
+
+
+static int64_t ElapsedUs(const struct timespec* from, const struct timespec* to)
+{
+	return (int64_t)(to->tv_sec - from->tv_sec) * 1000000 + (to->tv_nsec - from->tv_nsec) / 1000;
+}
+
+static int64_t PhaseElapsedUs(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ElapsedUs(&phaseStart, &now);
+}
+
+static void StartPhase(BENCHMARK_PHASE nextPhase, size_t index)
+{
+	phase = nextPhase;
+	phaseIndex = index;
+	recordsSent = recordsReceived = sendFailures = 0;
+
+	runTag += 1.0f;
+	for (size_t i = 0; i < MAX_RECORDS_PER_FRAME; i++)
+	{
+		records[i].humidity = runTag;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &phaseStart);
+}
+
+/// <summary>
+/// Encoded size of a frame of count sensor records, as it crosses the shared ring
+/// </summary>
+static size_t FrameBytes(size_t count)
+{
+	uint8_t frame[LP_IC_MAX_FRAME_SIZE];
+	LP_IC_FRAME_WRITER writer;
+
+	lp_icFrameBegin(&writer, frame, sizeof(frame));
+	for (size_t i = 0; i < count; i++)
+	{
+		lp_icFrameAppend(&writer, &records[i]);
+	}
+
+	return lp_icFrameEnd(&writer);
+}
+
+/// <summary>
+/// The ping-pong phase is the only user of lp_interCoreRequest, so the library round trip counters are its results
+/// </summary>
+static void ReportPingPong(void)
+{
+	LP_INTER_CORE_STATS stats;
+
+	lp_getInterCoreStats(&stats);
+
+	Log_Debug("\nPing-pong, %u requests of %d bytes\n", pings, LP_IC_FRAME_HEADER_SIZE + LP_IC_RECORD_HEADER_SIZE + LP_IC_SEQUENCE_SIZE);
+	Log_Debug("  round trip min %u us, avg %u us, max %u us, %u lost\n",
+		stats.roundTripMinUs, stats.roundTripAvgUs, stats.roundTripMaxUs, stats.timeouts);
+}
+
+static void ReportStream(void)
+{
+	double seconds = PhaseElapsedUs() / 1000000.0;
+	double frames = (double)recordsReceived / (double)recordsPerFrame;
+	size_t frameBytes = FrameBytes(recordsPerFrame);
+
+	Log_Debug("  %2u records/frame %4u bytes: %8.0f frames/s %8.1f KB/s each way, %u records lost, %u send failures\n",
+		(unsigned int)recordsPerFrame, (unsigned int)frameBytes, frames / seconds, frames * frameBytes / seconds / 1024.0,
+		recordsSent - recordsReceived, sendFailures);
+}
+
+static void ReportBurst(void)
+{
+	Log_Debug("  %3u frames: %3u sent, %3u refused by the socket, %4u of %4u records echoed in %u ms\n",
+		(unsigned int)burstFrames[phaseIndex], (unsigned int)(recordsSent / BURST_RECORDS_PER_FRAME), sendFailures,
+		recordsReceived, recordsSent, (unsigned int)(PhaseElapsedUs() / 1000));
+}
+
+/// <summary>
+/// Keep STREAM_WINDOW_FRAMES frames in flight, topped up as echoes arrive
+/// </summary>
+static void FillStreamWindow(void)
+{
+	while (recordsSent - recordsReceived + recordsPerFrame <= STREAM_WINDOW_FRAMES * recordsPerFrame)
+	{
+		if (!lp_sendInterCoreBatch(records, recordsPerFrame))
+		{
+			sendFailures++;
+			break;		// retried when the next echo frees the window
+		}
+		recordsSent += (uint32_t)recordsPerFrame;
+	}
+}
+
+static void StartStream(size_t index)
+{
+	StartPhase(PHASE_STREAM, index);
+	recordsPerFrame = streamRecordsPerFrame[index];
+
+	if (index == 0)
+	{
+		Log_Debug("\nStreaming, %d frames in flight for %d seconds per size\n", STREAM_WINDOW_FRAMES, STREAM_DURATION_SECONDS);
+	}
+
+	FillStreamWindow();
+	lp_setOneShotTimer(&benchmarkStepTimer, &(struct timespec){ STREAM_DURATION_SECONDS, 0 });
+}
+
+static void StartBurst(size_t index)
+{
+	StartPhase(PHASE_BURST, index);
+	recordsPerFrame = BURST_RECORDS_PER_FRAME;
+
+	if (index == 0)
+	{
+		Log_Debug("\nBursts of %u byte frames sent back to back\n", (unsigned int)FrameBytes(BURST_RECORDS_PER_FRAME));
+	}
+
+	for (size_t i = 0; i < burstFrames[index]; i++)
+	{
+		if (lp_sendInterCoreBatch(records, BURST_RECORDS_PER_FRAME))
+		{
+			recordsSent += BURST_RECORDS_PER_FRAME;
+		}
+		else
+		{
+			sendFailures++;
+		}
+	}
+
+	lp_setOneShotTimer(&benchmarkStepTimer, &(struct timespec){ BURST_TIMEOUT_SECONDS, 0 });
+}
+
+static void FinishBenchmark(void)
+{
+	LP_INTER_CORE_STATS stats;
+
+	phase = PHASE_DONE;
+	lp_getInterCoreStats(&stats);
+
+	Log_Debug("\nLibrary counters: %u requests, %u responses, %u timeouts, %u congestions\n",
+		stats.requests, stats.responses, stats.timeouts, stats.congestions);
+	Log_Debug("Benchmark complete\n");
+
+	lp_terminate(ExitCode_Success);
+}
+
+/// <summary>
+/// The burst is over once every frame sent has been echoed, or at the timeout
+/// </summary>
+static void NextBurstOrFinish(void)
+{
+	ReportBurst();
+
+	if (phaseIndex + 1 < NELEMS(burstFrames))
+	{
+		StartBurst(phaseIndex + 1);
+	}
+	else
+	{
+		FinishBenchmark();
+	}
+}
+
+static void PingResponseHandler(LP_INTER_CORE_BLOCK* response, bool timedOut)
+{
+	pings++;
+
+	if (pings < PING_PONG_ITERATIONS)
+	{
+		SendPing();
+	}
+	else
+	{
+		ReportPingPong();
+		StartStream(0);
+	}
+}
+
+/// <summary>
+/// One request in flight at a time, the next is sent from the response handler
+/// </summary>
+static void SendPing(void)
+{
+	LP_INTER_CORE_BLOCK ping = { .cmd = LP_IC_HEARTBEAT };
+
+	if (!lp_interCoreRequest(&ping, PING_PONG_TIMEOUT_MS, PingResponseHandler))
+	{
+		// the socket refused the request, try again shortly rather than recursing
+		lp_setOneShotTimer(&benchmarkStepTimer, &(struct timespec){ 0, 1 * 1000 * 1000 });
+	}
+}
+
+/// <summary>
+/// Echoed sensor records, ping responses go to PingResponseHandler instead
+/// </summary>
+static void InterCoreBatchHandler(LP_INTER_CORE_BLOCK* ic_message_blocks, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		if (ic_message_blocks[i].cmd == LP_IC_TEMPERATURE_PRESSURE_HUMIDITY && ic_message_blocks[i].humidity == runTag)
+		{
+			recordsReceived++;
+		}
+	}
+
+	if (phase == PHASE_STREAM)
+	{
+		FillStreamWindow();
+	}
+	else if (phase == PHASE_BURST && recordsReceived >= recordsSent)
+	{
+		NextBurstOrFinish();
+	}
+}
+
+static void InterCoreHandler(LP_INTER_CORE_BLOCK* ic_message_block)
+{
+	InterCoreBatchHandler(ic_message_block, 1);
+}
+
+static void BenchmarkStepHandler(EventLoopTimer* eventLoopTimer)
+{
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
+	{
+		lp_terminate(ExitCode_ConsumeEventLoopTimeEvent);
+		return;
+	}
+
+	switch (phase)
+	{
+	case PHASE_CONNECT:
+		Log_Debug("Inter-core benchmark against %s\n", rtAppComponentId);
+		StartPhase(PHASE_PING_PONG, 0);
+		SendPing();
+		break;
+	case PHASE_PING_PONG:
+		SendPing();
+		break;
+	case PHASE_STREAM:
+		ReportStream();
+		if (phaseIndex + 1 < NELEMS(streamRecordsPerFrame))
+		{
+			StartStream(phaseIndex + 1);
+		}
+		else
+		{
+			StartBurst(0);
+		}
+		break;
+	case PHASE_BURST:
+		NextBurstOrFinish();
+		break;
+	default:
+		break;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	lp_registerTerminationHandler();
+
+	if (argc < 2)
+	{
+		Log_Debug("Real-time app component ID needs to be set in the app_manifest CmdArgs\n");
+		return ExitCode_MissingRealTimeComponentId;
+	}
+	strncpy(rtAppComponentId, argv[1], RT_APP_COMPONENT_LENGTH - 1);
+
+	for (size_t i = 0; i < MAX_RECORDS_PER_FRAME; i++)
+	{
+		records[i] = (LP_INTER_CORE_BLOCK){ .cmd = LP_IC_TEMPERATURE_PRESSURE_HUMIDITY, .temperature = 25.0f, .pressure = 1013.0f };
+	}
+
+	lp_enableInterCoreCommunications(rtAppComponentId, InterCoreHandler);
+	lp_setInterCoreBatchCallback(InterCoreBatchHandler);
+	lp_startTimerSet(timerSet, NELEMS(timerSet));
+
+	// lp_enableInterCoreCommunications handshakes with the real-time app, the benchmark starts once it has settled
+	lp_setOneShotTimer(&benchmarkStepTimer, &(struct timespec){ 1, 0 });
+
+	// Main loop
+	lp_runEventLoop();
+
+	lp_stopTimerSet();
+	lp_stopTimerEventLoop();
+
+	return lp_getTerminationExitCode();
+}
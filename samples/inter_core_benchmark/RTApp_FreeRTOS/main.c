@@ -0,0 +1,188 @@
+/*
+ *   Inter-core benchmark, FreeRTOS echo app
+ *
+ *   Echoes every frame the high-level benchmark app sends straight back through the shared ring,
+ *   unchanged, and prints the frames, records and bytes received each second over UART (ISU0, as in Lab 5).
+ *   Built from the Lab 5 FreeRTOS BSP, drivers and inter-core ring.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "printf.h"
+#include "mt3620.h"
+
+#include "os_hal_mbox.h"
+#include "os_hal_uart.h"
+
+#include "mt3620-intercore.h"
+#include "inter_core_protocol.h"
+
+
+/******************************************************************************/
+/* Configurations */
+/******************************************************************************/
+
+#define UART_PORT_NUM OS_HAL_UART_ISU0
+#define APP_STACK_SIZE_BYTES (1024 / 4)
+
+#define INTER_CORE_SW_INT_MASK 0x3			// software interrupts the A7 raises on mailbox channel 0 when it writes or reads the shared buffers
+#define INTER_CORE_IDLE_WAIT_MS 1000		// fallback poll should an interrupt be missed
+#define REPORT_INTERVAL_MS 1000
+
+static SemaphoreHandle_t InterCoreSemphr;
+
+static const size_t payloadStart = 20;
+static uint8_t buf[256];
+static BufferHeader* outbound, * inbound;
+static uint32_t sharedBufSize = 0;
+
+// written by EchoTask, sampled by ReportTask
+static volatile uint32_t rxFrames = 0;
+static volatile uint32_t rxRecords = 0;
+static volatile uint32_t rxBytes = 0;
+static volatile uint32_t echoDrops = 0;
+
+
+/******************************************************************************/
+/* Application Hooks */
+/******************************************************************************/
+// Hook for "stack over flow".
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char* pcTaskName)
+{
+	printf("%s: %s\n", __func__, pcTaskName);
+}
+
+// Hook for "memory allocation failed".
+void vApplicationMallocFailedHook(void)
+{
+	printf("%s\n", __func__);
+}
+
+// Hook for "printf".
+void _putchar(char character)
+{
+	mtk_os_hal_uart_put_char(UART_PORT_NUM, character);
+	if (character == '\n')
+		mtk_os_hal_uart_put_char(UART_PORT_NUM, '\r');
+}
+
+/******************************************************************************/
+/* Functions */
+/******************************************************************************/
+
+/// <summary>
+/// Mailbox software interrupt, wakes EchoTask as soon as the A7 app writes a message
+/// </summary>
+static void InterCoreInterruptHandler(struct mtk_os_hal_mbox_cb_data* data)
+{
+	BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+	if (data->swint.swint_sts & INTER_CORE_SW_INT_MASK)
+	{
+		xSemaphoreGiveFromISR(InterCoreSemphr, &higherPriorityTaskWoken);
+	}
+
+	portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+static void EchoTask(void* pParameters)
+{
+	LP_IC_FRAME_READER reader;
+	LP_INTER_CORE_BLOCK block;
+	uint32_t dataSize;
+
+	while (1)
+	{
+		dataSize = sizeof(buf);
+		int r = DequeueData(outbound, inbound, sharedBufSize, buf, &dataSize);
+
+		if (r == 0 && dataSize > payloadStart)
+		{
+			rxFrames++;
+			rxBytes += dataSize - payloadStart;
+
+			lp_icFrameOpen(&reader, &buf[payloadStart], dataSize - payloadStart);
+			while (lp_icFrameNext(&reader, &block))
+			{
+				rxRecords++;
+			}
+
+			// the component header and frame go back as received, sequence numbers included
+			if (EnqueueData(inbound, outbound, sharedBufSize, buf, dataSize) != 0)
+			{
+				echoDrops++;
+			}
+		}
+
+		if (r != 0)
+		{
+			// ring drained, block until the A7 app raises the mailbox interrupt
+			xSemaphoreTake(InterCoreSemphr, pdMS_TO_TICKS(INTER_CORE_IDLE_WAIT_MS));
+		}
+	}
+}
+
+/// <summary>
+/// Print the receive rate once a second while the benchmark is running
+/// </summary>
+static void ReportTask(void* pParameters)
+{
+	uint32_t lastFrames = 0, lastRecords = 0, lastBytes = 0, lastDrops = 0;
+	TickType_t lastWake = xTaskGetTickCount();
+
+	while (1)
+	{
+		vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(REPORT_INTERVAL_MS));
+
+		uint32_t frames = rxFrames, records = rxRecords, bytes = rxBytes, drops = echoDrops;
+
+		if (frames != lastFrames)
+		{
+			printf("rx %u frames/s, %u records/s, %u bytes/s, %u echoes dropped\n",
+				frames - lastFrames, records - lastRecords, bytes - lastBytes, drops - lastDrops);
+		}
+
+		lastFrames = frames;
+		lastRecords = records;
+		lastBytes = bytes;
+		lastDrops = drops;
+	}
+}
+
+
+_Noreturn void RTCoreMain(void)
+{
+	// Setup Vector Table
+	NVIC_SetupVectorTable();
+
+	// Init UART
+	mtk_os_hal_uart_ctlr_init(UART_PORT_NUM);
+	printf("\nFreeRTOS Inter-Core Benchmark\n");
+
+	InterCoreSemphr = xSemaphoreCreateBinary();
+	mtk_os_hal_mbox_open_channel(OS_HAL_MBOX_CH0);
+	mtk_os_hal_mbox_sw_int_register_cb(OS_HAL_MBOX_CH0, InterCoreInterruptHandler, INTER_CORE_SW_INT_MASK);
+
+	// Initialize Inter-Core Communications
+	if (GetIntercoreBuffers(&outbound, &inbound, &sharedBufSize) == -1)
+	{
+		for (;;)
+		{
+			// empty.
+		}
+	}
+
+	xTaskCreate(EchoTask, "Echo Task", APP_STACK_SIZE_BYTES, NULL, 3, NULL);
+	xTaskCreate(ReportTask, "Report Task", APP_STACK_SIZE_BYTES, NULL, 2, NULL);
+	vTaskStartScheduler();
+
+	for (;;)
+	{
+		__asm__("wfi");
+	}
+}
@@ -0,0 +1,173 @@
+/*
+ *   Inter-core benchmark, Azure RTOS ThreadX echo app
+ *
+ *   Echoes every frame the high-level benchmark app sends straight back through the shared ring,
+ *   unchanged, and prints the frames, records and bytes received each second over UART (ISU0, as in Lab 6).
+ *   Built from the Lab 6 ThreadX kernel, drivers and inter-core ring.
+ */
+
+#include "inter_core_protocol.h"
+#include "mt3620-intercore.h"
+#include "os_hal_mbox.h"
+#include "printf.h"
+#include "tx_api.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+
+#define DEMO_STACK_SIZE         1024
+#define DEMO_BYTE_POOL_SIZE     4096
+
+#define INTER_CORE_SW_INT_MASK 0x3			// software interrupts the A7 raises on mailbox channel 0 when it writes or reads the shared buffers
+#define INTER_CORE_DATA_FLAG 0x1
+#define INTER_CORE_IDLE_WAIT_TICKS 100		// fallback poll should an interrupt be missed
+#define REPORT_INTERVAL_TICKS 100			// one second at the 10 ms ThreadX tick
+
+
+// resources for inter core messaging
+static uint8_t buf[256];
+static BufferHeader* outbound, * inbound;
+static uint32_t sharedBufSize = 0;
+static const size_t payloadStart = 20;
+
+// written by thread_echo, sampled by thread_report
+static volatile uint32_t rx_frames = 0;
+static volatile uint32_t rx_records = 0;
+static volatile uint32_t rx_bytes = 0;
+static volatile uint32_t echo_drops = 0;
+
+
+// Define the ThreadX object control blocks...
+TX_THREAD               tx_thread_echo;
+TX_THREAD               tx_thread_report;
+TX_EVENT_FLAGS_GROUP    event_flags_inter_core;
+TX_BYTE_POOL            byte_pool_0;
+UCHAR                   memory_area[DEMO_BYTE_POOL_SIZE];
+
+
+// Define thread prototypes.
+void thread_echo(ULONG thread_input);
+void thread_report(ULONG thread_input);
+
+
+int main()
+{
+	tx_kernel_enter();	// Enter the Azure RTOS kernel.
+}
+
+
+// Define what the initial system looks like.
+void tx_application_define(void* first_unused_memory)
+{
+	CHAR* pointer;
+
+	tx_byte_pool_create(&byte_pool_0, "byte pool 0", memory_area, DEMO_BYTE_POOL_SIZE);		// Create a byte memory pool from which to allocate the thread stacks
+
+
+	tx_byte_allocate(&byte_pool_0, (VOID**)&pointer, DEMO_STACK_SIZE, TX_NO_WAIT);			// Allocate the stack for the echo thread
+	tx_thread_create(&tx_thread_echo, "thread echo", thread_echo, 0,
+		pointer, DEMO_STACK_SIZE, 2, 2, TX_NO_TIME_SLICE, TX_AUTO_START);
+
+
+	tx_byte_allocate(&byte_pool_0, (VOID**)&pointer, DEMO_STACK_SIZE, TX_NO_WAIT);			// Allocate the stack for the report thread
+	tx_thread_create(&tx_thread_report, "thread report", thread_report, 0,
+		pointer, DEMO_STACK_SIZE, 4, 4, TX_NO_TIME_SLICE, TX_AUTO_START);
+
+
+	tx_event_flags_create(&event_flags_inter_core, "event flags inter core");				// Set from the mailbox interrupt
+}
+
+
+/// <summary>
+/// Mailbox software interrupt, wakes thread_echo as soon as the A7 app writes a message
+/// </summary>
+static void inter_core_interrupt_handler(struct mtk_os_hal_mbox_cb_data* data)
+{
+	if (data->swint.swint_sts & INTER_CORE_SW_INT_MASK)
+	{
+		tx_event_flags_set(&event_flags_inter_core, INTER_CORE_DATA_FLAG, TX_OR);
+	}
+}
+
+void thread_echo(ULONG thread_input)
+{
+	ULONG actual_flags;
+	uint32_t dataSize;
+	LP_IC_FRAME_READER reader;
+	LP_INTER_CORE_BLOCK block;
+
+	printf("\nAzure RTOS Inter-Core Benchmark\n");
+
+	// Wake this thread from the mailbox interrupt rather than polling the shared buffer
+	mtk_os_hal_mbox_open_channel(OS_HAL_MBOX_CH0);
+	mtk_os_hal_mbox_sw_int_register_cb(OS_HAL_MBOX_CH0, inter_core_interrupt_handler, INTER_CORE_SW_INT_MASK);
+
+	if (GetIntercoreBuffers(&outbound, &inbound, &sharedBufSize) == -1)
+	{					// Initialize Inter-Core Communications
+		for (;;)
+		{ // empty.
+		}
+	}
+
+	while (1)
+	{
+		dataSize = sizeof(buf);
+		int r = DequeueData(outbound, inbound, sharedBufSize, buf, &dataSize);
+
+		if (r == 0 && dataSize > payloadStart)
+		{
+			rx_frames++;
+			rx_bytes += dataSize - payloadStart;
+
+			lp_icFrameOpen(&reader, &buf[payloadStart], dataSize - payloadStart);
+			while (lp_icFrameNext(&reader, &block))
+			{
+				rx_records++;
+			}
+
+			// the component header and frame go back as received, sequence numbers included
+			if (EnqueueData(inbound, outbound, sharedBufSize, buf, dataSize) != 0)
+			{
+				echo_drops++;
+			}
+		}
+
+		if (r != 0)
+		{
+			// ring drained, block until the A7 app raises the mailbox interrupt
+			tx_event_flags_get(&event_flags_inter_core, INTER_CORE_DATA_FLAG, TX_OR_CLEAR, &actual_flags, INTER_CORE_IDLE_WAIT_TICKS);
+		}
+	}
+}
+
+/// <summary>
+/// Print the receive rate once a second while the benchmark is running
+/// </summary>
+void thread_report(ULONG thread_input)
+{
+	uint32_t last_frames = 0, last_records = 0, last_bytes = 0, last_drops = 0;
+	ULONG next_report = tx_time_get() + REPORT_INTERVAL_TICKS;
+
+	while (1)
+	{
+		ULONG now = tx_time_get();
+		if ((LONG)(next_report - now) > 0)
+		{
+			tx_thread_sleep(next_report - now);
+		}
+		next_report += REPORT_INTERVAL_TICKS;
+
+		uint32_t frames = rx_frames, records = rx_records, bytes = rx_bytes, drops = echo_drops;
+
+		if (frames != last_frames)
+		{
+			printf("rx %u frames/s, %u records/s, %u bytes/s, %u echoes dropped\n",
+				frames - last_frames, records - last_records, bytes - last_bytes, drops - last_drops);
+		}
+
+		last_frames = frames;
+		last_records = records;
+		last_bytes = bytes;
+		last_drops = drops;
+	}
+}
@@ -0,0 +1,115 @@
+﻿/*
+ *   LZ4 telemetry compression benchmark
+ *
+ *   Measures the A7 CPU cost of lp_compressLz4 against the bytes saved for telemetry batches
+ *   built from the Lab 7 message template. Results are written to the debug output, no
+ *   network or peripherals are used.
+ *
+ *   Run with F5 (or azsphere device sideload) and read the Output window.
+ */
+
+ // Learning Path Libraries
+#include "compression.h"
+
+// System Libraries
+#include "applibs_versions.h"
+#include <applibs/log.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_BATCH_BYTES 8192
+#define ITERATIONS 200
+
+static const char* msgTemplate = "{ \"Temperature\": \"%3.2f\", \"Humidity\": \"%3.1f\", \"Pressure\":\"%3.1f\", \"Light\":%d, \"MsgId\":%d }";
+static const int batchSizes[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+static char batchBuffer[MAX_BATCH_BYTES];
+static uint8_t compressedBuffer[MAX_BATCH_BYTES + MAX_BATCH_BYTES / 255 + 16];
+static uint8_t roundTripBuffer[MAX_BATCH_BYTES];
+
+/// <summary>
+/// Build a JSON array of readings the way lp_enqueueTelemetry batches them, with plausible sensor drift
+/// </summary>
+static size_t BuildBatch(int messages)
+{
+	size_t length = 0;
+	float temperature = 22.0f;
+	float humidity = 45.0f;
+	float pressure = 1013.0f;
+
+	batchBuffer[length++] = '[';
+
+	for (int i = 0; i < messages; i++)
+	{
+		temperature += (float)(rand() % 21 - 10) / 100.0f;
+		humidity += (float)(rand() % 21 - 10) / 50.0f;
+		pressure += (float)(rand() % 21 - 10) / 20.0f;
+
+		if (i > 0)
+		{
+			batchBuffer[length++] = ',';
+		}
+
+		int len = snprintf(batchBuffer + length, sizeof(batchBuffer) - length - 1, msgTemplate, temperature, humidity, pressure, rand() % 1024, i);
+		if (len < 0 || (size_t)len >= sizeof(batchBuffer) - length - 1)
+		{
+			break;
+		}
+		length += (size_t)len;
+	}
+
+	batchBuffer[length++] = ']';
+	batchBuffer[length] = 0;
+
+	return length;
+}
+
+static long ElapsedNs(struct timespec* start, struct timespec* end)
+{
+	return (end->tv_sec - start->tv_sec) * 1000000000L + (end->tv_nsec - start->tv_nsec);
+}
+
+int main(int argc, char* argv[])
+{
+	struct timespec start, end;
+	size_t compressedLength = 0;
+
+	srand(1);
+
+	Log_Debug("LZ4 telemetry compression benchmark, %d iterations per batch size\n", ITERATIONS);
+	Log_Debug("%8s %10s %10s %8s %12s %12s\n", "messages", "bytes", "lz4 bytes", "saved", "compress us", "decompress us");
+
+	for (size_t b = 0; b < sizeof(batchSizes) / sizeof(batchSizes[0]); b++)
+	{
+		size_t length = BuildBatch(batchSizes[b]);
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (int i = 0; i < ITERATIONS; i++)
+		{
+			compressedLength = lp_compressLz4((const uint8_t*)batchBuffer, length, compressedBuffer, sizeof(compressedBuffer));
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		long compressNs = ElapsedNs(&start, &end) / ITERATIONS;
+
+		size_t roundTripLength = 0;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (int i = 0; i < ITERATIONS; i++)
+		{
+			roundTripLength = lp_decompressLz4(compressedBuffer, compressedLength, roundTripBuffer, sizeof(roundTripBuffer));
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		long decompressNs = ElapsedNs(&start, &end) / ITERATIONS;
+
+		bool verified = roundTripLength == length && memcmp(roundTripBuffer, batchBuffer, length) == 0;
+
+		Log_Debug("%8d %10u %10u %7d%% %12.1f %12.1f%s\n", batchSizes[b], (unsigned int)length, (unsigned int)compressedLength,
+			(int)(100 - (compressedLength * 100) / length), compressNs / 1000.0, decompressNs / 1000.0, verified ? "" : "  ROUND TRIP FAILED");
+	}
+
+	Log_Debug("Benchmark complete\n");
+
+	return 0;
+}
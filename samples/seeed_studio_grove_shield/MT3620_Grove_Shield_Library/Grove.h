@@ -9,6 +9,7 @@
 
 #include "HAL/GroveUART.h"
 #include "HAL/GroveI2C.h"
+#include "HAL/GroveI2CBridge.h"
 #include "HAL/GroveShield.h"
 
 #include "Common/Delay.h"
@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include "GroveUART.h"
+#include <applibs/i2c.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 // SC18IM700
@@ -101,11 +102,51 @@ void SC18IM700_WriteRegBytes(int fd, uint8_t *data, uint8_t dataSize)
 }
 
 
+static bool SC18IM700_I2cWriteRead(int fd, uint8_t address, const uint8_t* writeData, int writeSize, uint8_t* readData, int readSize)
+{
+	SC18IM700_I2cWrite(fd, address, writeData, writeSize);
+
+	return SC18IM700_I2cRead(fd, address, readData, readSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ISU I2C master, for boards with the Grove I2C header wired to an ISU
+
+static void I2CMaster_GroveWrite(int fd, uint8_t address, const uint8_t* data, int dataSize)
+{
+	I2CMaster_Write(fd, address >> 1, data, (size_t)dataSize);
+}
+
+static bool I2CMaster_GroveRead(int fd, uint8_t address, uint8_t* data, int dataSize)
+{
+	return I2CMaster_Read(fd, address >> 1, data, (size_t)dataSize) == dataSize;
+}
+
+static bool I2CMaster_GroveWriteRead(int fd, uint8_t address, const uint8_t* writeData, int writeSize, uint8_t* readData, int readSize)
+{
+	return I2CMaster_WriteThenRead(fd, address >> 1, writeData, (size_t)writeSize, readData, (size_t)readSize) == writeSize + readSize;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // GroveI2C
 
 void(*GroveI2C_Write)(int fd, uint8_t address, const uint8_t* data, int dataSize) = SC18IM700_I2cWrite;
 bool(*GroveI2C_Read)(int fd, uint8_t address, uint8_t* data, int dataSize) = SC18IM700_I2cRead;
+bool(*GroveI2C_WriteRead)(int fd, uint8_t address, const uint8_t* writeData, int writeSize, uint8_t* readData, int readSize) = SC18IM700_I2cWriteRead;
+
+void GroveI2C_UseSC18IM700(void)
+{
+	GroveI2C_Write = SC18IM700_I2cWrite;
+	GroveI2C_Read = SC18IM700_I2cRead;
+	GroveI2C_WriteRead = SC18IM700_I2cWriteRead;
+}
+
+void GroveI2C_UseI2CMaster(void)
+{
+	GroveI2C_Write = I2CMaster_GroveWrite;
+	GroveI2C_Read = I2CMaster_GroveRead;
+	GroveI2C_WriteRead = I2CMaster_GroveWriteRead;
+}
 
 void GroveI2C_WriteReg8(int fd, uint8_t address, uint8_t reg, uint8_t val)
 {
@@ -125,10 +166,8 @@ void GroveI2C_WriteBytes(int fd, uint8_t address, uint8_t *data, uint8_t dataSiz
 
 bool GroveI2C_ReadReg8(int fd, uint8_t address, uint8_t reg, uint8_t* val)
 {
-	GroveI2C_Write(fd, address, &reg, 1);
-
 	uint8_t recv[1];
-	if (!GroveI2C_Read(fd, address, recv, sizeof(recv))) return false;
+	if (!GroveI2C_WriteRead(fd, address, &reg, 1, recv, sizeof(recv))) return false;
 
 	*val = recv[0];
 
@@ -137,10 +176,8 @@ bool GroveI2C_ReadReg8(int fd, uint8_t address, uint8_t reg, uint8_t* val)
 
 bool GroveI2C_ReadReg16(int fd, uint8_t address, uint8_t reg, uint16_t* val)
 {
-	GroveI2C_Write(fd, address, &reg, 1);
-
 	uint8_t recv[2];
-	if (!GroveI2C_Read(fd, address, recv, sizeof(recv))) return false;
+	if (!GroveI2C_WriteRead(fd, address, &reg, 1, recv, sizeof(recv))) return false;
 
 	*val = (uint16_t)(recv[1] << 8 | recv[0]);
 
@@ -149,10 +186,8 @@ bool GroveI2C_ReadReg16(int fd, uint8_t address, uint8_t reg, uint16_t* val)
 
 bool GroveI2C_ReadReg24BE(int fd, uint8_t address, uint8_t reg, uint32_t* val)
 {
-	GroveI2C_Write(fd, address, &reg, 1);
-
 	uint8_t recv[3];
-	if (!GroveI2C_Read(fd, address, recv, sizeof(recv))) return false;
+	if (!GroveI2C_WriteRead(fd, address, &reg, 1, recv, sizeof(recv))) return false;
 
 	*val = (uint32_t)(recv[0] << 16 | recv[1] << 8 | recv[2]);
 
@@ -14,8 +14,15 @@ bool SC18IM700_ReadReg(int fd, uint8_t reg, uint8_t* data);
 void SC18IM700_WriteReg(int fd, uint8_t reg, uint8_t data);
 void SC18IM700_WriteRegBytes(int fd, uint8_t *data, uint8_t dataSize);
 
-void(*GroveI2C_Write)(int fd, uint8_t address, const uint8_t* data, int dataSize);
-bool(*GroveI2C_Read)(int fd, uint8_t address, uint8_t* data, int dataSize);
+// The backend the Grove I2C calls go through, the SC18IM700 UART bridge unless GroveI2C_UseI2CMaster was called.
+// Addresses are 8 bit, the 7 bit address shifted left, fd is the UART or the I2C master it goes over.
+extern void(*GroveI2C_Write)(int fd, uint8_t address, const uint8_t* data, int dataSize);
+extern bool(*GroveI2C_Read)(int fd, uint8_t address, uint8_t* data, int dataSize);
+// a register read, over an I2C master the write and the read are joined by a repeated start
+extern bool(*GroveI2C_WriteRead)(int fd, uint8_t address, const uint8_t* writeData, int writeSize, uint8_t* readData, int readSize);
+
+void GroveI2C_UseSC18IM700(void);
+void GroveI2C_UseI2CMaster(void);
 
 void GroveI2C_WriteReg8(int fd, uint8_t address, uint8_t reg, uint8_t val);
 void GroveI2C_WriteBytes(int fd, uint8_t address, uint8_t *data, uint8_t dataSize);
@@ -0,0 +1,287 @@
+#include "GroveI2CBridge.h"
+#include "GroveI2C.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#define STATUS_READ_SIZE	3						// 'R' 0x0A 'P', answered with one status byte
+#define MAX_FRAME_SIZE		(3 + GROVE_I2C_BRIDGE_MAX_DATA + 4 + STATUS_READ_SIZE)
+
+typedef struct
+{
+	uint8_t Frame[MAX_FRAME_SIZE];
+	int FrameSize;
+	int ReadSize;									// data bytes answered ahead of the status byte
+	GroveI2CBridge_Callback Callback;
+	void* Context;
+}
+Transaction;
+
+struct GroveI2CBridge
+{
+	int UartFd;
+	int UartFlags;									// restored on close
+	int TimerFd;
+	EventLoop* EventLoop;
+	EventRegistration* UartRegistration;
+	EventRegistration* TimerRegistration;
+	Transaction Queue[GROVE_I2C_BRIDGE_QUEUE_LENGTH];
+	int Head;										// oldest transaction
+	int Count;
+	int Sent;										// transactions from Head written and not yet answered
+	uint8_t Answer[GROVE_I2C_BRIDGE_MAX_DATA + 1];
+	int Received;									// bytes of the Head transaction's answer
+	bool InHandler;									// completions run, the next batch is written after them
+};
+
+static void ArmTimer(GroveI2CBridge* this, int ms)
+{
+	struct itimerspec period = { .it_value = { .tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000 } };
+	timerfd_settime(this->TimerFd, 0, &period, NULL);
+}
+
+static void Complete(GroveI2CBridge* this, bool ok)
+{
+	Transaction* transaction = &this->Queue[this->Head];
+	GroveI2CBridge_Callback callback = transaction->Callback;
+	void* context = transaction->Context;
+	int readSize = transaction->ReadSize;
+
+	this->Head = (this->Head + 1) % GROVE_I2C_BRIDGE_QUEUE_LENGTH;
+	this->Count--;
+	this->Sent--;
+	this->Received = 0;
+
+	if (callback != NULL)
+	{
+		callback(ok, readSize > 0 ? this->Answer : NULL, readSize, context);
+	}
+}
+
+// one UART write for as many queued frames as fit a batch, the bridge parses them in order
+static void WriteBatch(GroveI2CBridge* this)
+{
+	uint8_t batch[GROVE_I2C_BRIDGE_BATCH_BYTES > MAX_FRAME_SIZE ? GROVE_I2C_BRIDGE_BATCH_BYTES : MAX_FRAME_SIZE];
+	int batchSize = 0;
+	int frames = 0;
+
+	while (frames < this->Count)
+	{
+		Transaction* transaction = &this->Queue[(this->Head + frames) % GROVE_I2C_BRIDGE_QUEUE_LENGTH];
+
+		if (frames > 0 && batchSize + transaction->FrameSize > GROVE_I2C_BRIDGE_BATCH_BYTES)
+		{
+			break;
+		}
+
+		memcpy(&batch[batchSize], transaction->Frame, (size_t)transaction->FrameSize);
+		batchSize += transaction->FrameSize;
+		frames++;
+	}
+
+	this->Sent = frames;
+	this->Received = 0;
+
+	if (write(this->UartFd, batch, (size_t)batchSize) != batchSize)
+	{
+		ArmTimer(this, 1);		// fails the batch from the event loop, after the caller has returned
+		return;
+	}
+
+	ArmTimer(this, GROVE_I2C_BRIDGE_TIMEOUT_MS);
+}
+
+static void WriteNextBatch(GroveI2CBridge* this)
+{
+	if (this->Sent == 0 && this->Count > 0 && !this->InHandler)
+	{
+		WriteBatch(this);
+	}
+}
+
+static void UartHandler(EventLoop* el, int fd, EventLoop_IoEvents events, void* context)
+{
+	GroveI2CBridge* this = (GroveI2CBridge*)context;
+	uint8_t input[GROVE_I2C_BRIDGE_MAX_DATA + 1];
+	ssize_t inputSize;
+
+	this->InHandler = true;
+
+	while ((inputSize = read(fd, input, sizeof(input))) > 0)
+	{
+		for (ssize_t i = 0; i < inputSize; i++)
+		{
+			if (this->Sent == 0)
+			{
+				break;				// nothing was asked for, a late answer after a time out
+			}
+
+			Transaction* transaction = &this->Queue[this->Head];
+			this->Answer[this->Received++] = input[i];
+
+			if (this->Received == transaction->ReadSize + 1)
+			{
+				Complete(this, this->Answer[transaction->ReadSize] == I2C_OK);
+			}
+		}
+
+		if (this->Sent == 0)
+		{
+			ArmTimer(this, 0);
+		}
+	}
+
+	this->InHandler = false;
+	WriteNextBatch(this);
+}
+
+static void TimerHandler(EventLoop* el, int fd, EventLoop_IoEvents events, void* context)
+{
+	GroveI2CBridge* this = (GroveI2CBridge*)context;
+	uint8_t input[GROVE_I2C_BRIDGE_MAX_DATA + 1];
+	uint64_t expirations;
+
+	if (read(fd, &expirations, sizeof(expirations)) < 0)
+	{
+		return;
+	}
+
+	this->InHandler = true;
+
+	// a NACKed read answers with fewer bytes than asked, drop what arrived so the next batch starts in step
+	while (read(this->UartFd, input, sizeof(input)) > 0)
+	{
+	}
+
+	while (this->Sent > 0)
+	{
+		Complete(this, false);
+	}
+
+	this->InHandler = false;
+	WriteNextBatch(this);
+}
+
+static bool Submit(GroveI2CBridge* this, const uint8_t* frame, int frameSize, int readSize, GroveI2CBridge_Callback callback, void* context)
+{
+	if (this == NULL || this->Count == GROVE_I2C_BRIDGE_QUEUE_LENGTH)
+	{
+		return false;
+	}
+
+	Transaction* transaction = &this->Queue[(this->Head + this->Count) % GROVE_I2C_BRIDGE_QUEUE_LENGTH];
+	memcpy(transaction->Frame, frame, (size_t)frameSize);
+	memcpy(&transaction->Frame[frameSize], (const uint8_t[]){ 'R', 0x0A, 'P' }, STATUS_READ_SIZE);
+	transaction->FrameSize = frameSize + STATUS_READ_SIZE;
+	transaction->ReadSize = readSize;
+	transaction->Callback = callback;
+	transaction->Context = context;
+	this->Count++;
+
+	WriteNextBatch(this);
+	return true;
+}
+
+GroveI2CBridge* GroveI2CBridge_Open(int fd, EventLoop* eventLoop)
+{
+	GroveI2CBridge* this = (GroveI2CBridge*)calloc(1, sizeof(GroveI2CBridge));
+	if (this == NULL)
+	{
+		return NULL;
+	}
+
+	this->UartFd = fd;
+	this->EventLoop = eventLoop;
+	this->UartFlags = fcntl(fd, F_GETFL);
+	this->TimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+
+	if (this->UartFlags == -1 || fcntl(fd, F_SETFL, this->UartFlags | O_NONBLOCK) == -1 || this->TimerFd == -1 ||
+		(this->UartRegistration = EventLoop_RegisterIo(eventLoop, fd, EventLoop_Input, UartHandler, this)) == NULL ||
+		(this->TimerRegistration = EventLoop_RegisterIo(eventLoop, this->TimerFd, EventLoop_Input, TimerHandler, this)) == NULL)
+	{
+		GroveI2CBridge_Close(this);
+		return NULL;
+	}
+
+	return this;
+}
+
+void GroveI2CBridge_Close(GroveI2CBridge* this)
+{
+	if (this == NULL)
+	{
+		return;
+	}
+
+	if (this->TimerRegistration != NULL)
+	{
+		EventLoop_UnregisterIo(this->EventLoop, this->TimerRegistration);
+	}
+	if (this->UartRegistration != NULL)
+	{
+		EventLoop_UnregisterIo(this->EventLoop, this->UartRegistration);
+	}
+	if (this->TimerFd != -1)
+	{
+		close(this->TimerFd);
+	}
+	if (this->UartFlags != -1)
+	{
+		fcntl(this->UartFd, F_SETFL, this->UartFlags);
+	}
+
+	free(this);
+}
+
+bool GroveI2CBridge_Write(GroveI2CBridge* this, uint8_t address, const uint8_t* data, int dataSize, GroveI2CBridge_Callback callback, void* context)
+{
+	uint8_t frame[MAX_FRAME_SIZE];
+
+	if (dataSize <= 0 || dataSize > GROVE_I2C_BRIDGE_MAX_DATA)
+	{
+		return false;
+	}
+
+	frame[0] = 'S';
+	frame[1] = address & 0xfe;
+	frame[2] = (uint8_t)dataSize;
+	memcpy(&frame[3], data, (size_t)dataSize);
+	frame[3 + dataSize] = 'P';
+
+	return Submit(this, frame, 4 + dataSize, 0, callback, context);
+}
+
+bool GroveI2CBridge_Read(GroveI2CBridge* this, uint8_t address, int dataSize, GroveI2CBridge_Callback callback, void* context)
+{
+	if (dataSize <= 0 || dataSize > GROVE_I2C_BRIDGE_MAX_DATA)
+	{
+		return false;
+	}
+
+	return Submit(this, (const uint8_t[]){ 'S', address | 0x01, (uint8_t)dataSize, 'P' }, 4, dataSize, callback, context);
+}
+
+bool GroveI2CBridge_WriteRead(GroveI2CBridge* this, uint8_t address, const uint8_t* writeData, int writeSize, int readSize,
+	GroveI2CBridge_Callback callback, void* context)
+{
+	uint8_t frame[MAX_FRAME_SIZE];
+
+	if (writeSize <= 0 || writeSize > GROVE_I2C_BRIDGE_MAX_DATA || readSize <= 0 || readSize > GROVE_I2C_BRIDGE_MAX_DATA)
+	{
+		return false;
+	}
+
+	frame[0] = 'S';
+	frame[1] = address & 0xfe;
+	frame[2] = (uint8_t)writeSize;
+	memcpy(&frame[3], writeData, (size_t)writeSize);
+	frame[3 + writeSize] = 'S';
+	frame[4 + writeSize] = address | 0x01;
+	frame[5 + writeSize] = (uint8_t)readSize;
+	frame[6 + writeSize] = 'P';
+
+	return Submit(this, frame, 7 + writeSize, readSize, callback, context);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../applibs_versions.h"
+#include <applibs/eventloop.h>
+
+// Non-blocking SC18IM700 bridge. Transactions are queued, the queued frames are written to the UART
+// together, each followed by a read of the I2C status register, and complete from the event loop as
+// the bridge answers. The bridge owns the UART fd once opened, do not mix with the blocking GroveI2C calls.
+
+#define GROVE_I2C_BRIDGE_QUEUE_LENGTH	8
+#define GROVE_I2C_BRIDGE_MAX_DATA		32		// bytes written or read by one transaction
+#define GROVE_I2C_BRIDGE_BATCH_BYTES	16		// the SC18IM700 receive FIFO, a batch never overruns it
+#define GROVE_I2C_BRIDGE_TIMEOUT_MS		100		// a batch not answered by then fails and the UART is resynchronised
+
+// ok is false on a NACK, a bus time out or no answer. data holds the bytes read, NULL for a write
+typedef void (*GroveI2CBridge_Callback)(bool ok, const uint8_t* data, int dataSize, void* context);
+
+typedef struct GroveI2CBridge GroveI2CBridge;
+
+GroveI2CBridge* GroveI2CBridge_Open(int fd, EventLoop* eventLoop);
+void GroveI2CBridge_Close(GroveI2CBridge* bridge);
+
+// false when the queue is full or the transfer too long, the callback is not called then
+bool GroveI2CBridge_Write(GroveI2CBridge* bridge, uint8_t address, const uint8_t* data, int dataSize, GroveI2CBridge_Callback callback, void* context);
+bool GroveI2CBridge_Read(GroveI2CBridge* bridge, uint8_t address, int dataSize, GroveI2CBridge_Callback callback, void* context);
+// register style access, the write and the read are joined by a repeated start in one frame
+bool GroveI2CBridge_WriteRead(GroveI2CBridge* bridge, uint8_t address, const uint8_t* writeData, int writeSize, int readSize,
+	GroveI2CBridge_Callback callback, void* context);
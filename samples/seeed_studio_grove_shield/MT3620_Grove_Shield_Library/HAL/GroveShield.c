@@ -4,15 +4,21 @@
 #include "../Common/Delay.h"
 
 #include <applibs/log.h>
+#include <errno.h>
 #include <unistd.h>
 #include <string.h>
 
 #include "hw/azure_sphere_learning_path.h"
 
 
+#define GROVE_SHIELD_I2C_TIMEOUT_MS	100		// a transfer on the I2C master fails after this, a device holding the bus
+#define GROVE_SHIELD_PROBE_READS	16		// register read-backs a baudrate must answer without error to be used
+#define GROVE_SHIELD_PROBE_TIMEOUT_MS	20	// for each, a register read takes 4 characters, 4 ms at 9600
+
 /**
 	Set bauud rate for SC18IM700
 */
+const uint8_t baudrate_460800_conf[4] = { 0x00, 0x00, 0x01, 0x00 };
 const uint8_t baudrate_230400_conf[4] = { 0x00, 0x10, 0x01, 0x00 };
 const uint8_t baudrate_115200_conf[4] = { 0x00, 0x30, 0x01, 0x00};
 const uint8_t baudrate_19200_conf[4] = { 0x00, 0x70, 0x01, 0x01};
@@ -73,8 +79,122 @@ static void baudrate_conf(int *fd, UART_BaudRate_Type baudrate)
 	trial = 0;
 }
 
-void GroveShield_Initialize(int* fd, uint32_t baudrate)
+/**
+	Rates the SC18IM700 and the MT3620 UART both run at, fastest first. The conf is written as
+	BRG0 and BRG1 register and value pairs, the bridge runs at 7.3728 MHz / (16 + BRG).
+*/
+typedef struct
+{
+	UART_BaudRate_Type baudrate;
+	const uint8_t* conf;
+}
+bridge_rate;
+
+static const bridge_rate bridge_rates[] =
+{
+	{ 460800, baudrate_460800_conf },
+	{ 230400, baudrate_230400_conf },
+	{ 115200, baudrate_115200_conf },
+	{ 19200, baudrate_19200_conf },
+	{ 14400, baudrate_14400_conf },
+	{ 9600, baudrate_9600_conf },
+};
+
+#define BRIDGE_RATE_COUNT	(sizeof(bridge_rates) / sizeof(bridge_rates[0]))
+
+/** Reopens the UART at rate, true when the bridge answers every read-back of its BRG registers with rate's values */
+static bool probe_rate(int* fd, const bridge_rate* rate)
+{
+	if (*fd >= 0) close(*fd);
+	*fd = GroveUART_Open(MT3620_RDB_HEADER2_ISU0_UART, rate->baudrate);
+	if (*fd < 0) return false;
+
+	GroveUART_Flush(*fd);
+
+	for (int i = 0; i < GROVE_SHIELD_PROBE_READS; i++)
+	{
+		uint8_t reg = (uint8_t)(i % 2);
+		uint8_t send[3] = { 'R', reg, 'P' };
+		uint8_t value;
+
+		GroveUART_Write(*fd, send, (int)sizeof(send));
+		if (!GroveUART_ReadTimeout(*fd, &value, 1, GROVE_SHIELD_PROBE_TIMEOUT_MS) || value != rate->conf[2 * reg + 1]) return false;
+	}
+
+	return true;
+}
+
+/** The rate the bridge answers at, 9600 after power on or whatever an earlier run left it at, NULL when none */
+static const bridge_rate* find_rate(int* fd)
+{
+	for (int i = (int)BRIDGE_RATE_COUNT - 1; i >= 0; i--)
+	{
+		if (probe_rate(fd, &bridge_rates[i])) return &bridge_rates[i];
+	}
+
+	return NULL;
+}
+
+/** Steps the bridge and the UART up to the fastest rate that reads back reliably */
+static uint32_t baudrate_auto(int* fd)
+{
+	const bridge_rate* current = find_rate(fd);
+
+	if (current == NULL)
+	{
+		Log_Debug("[error] SC18IM700 does not answer at any baudrate.\n");
+		return 0;
+	}
+
+	for (const bridge_rate* to = bridge_rates; to < current; to++)
+	{
+		SC18IM700_WriteRegBytes(*fd, (uint8_t*)to->conf, 4);
+		if (probe_rate(fd, to)) return to->baudrate;
+
+		// the bridge may have switched, put it back from the faster rate, then the next slower is tried
+		SC18IM700_WriteRegBytes(*fd, (uint8_t*)current->conf, 4);
+		if (!probe_rate(fd, current) && (current = find_rate(fd)) == NULL)
+		{
+			Log_Debug("[error] SC18IM700 lost changing baudrate.\n");
+			return 0;
+		}
+	}
+
+	return current->baudrate;
+}
+
+uint32_t GroveShield_Initialize(int* fd, uint32_t baudrate)
 {
 	/**fd = GroveUART_Open(MT3620_RDB_HEADER2_ISU0_UART, 9600);*/
+	GroveI2C_UseSC18IM700();
+
+	if (baudrate == GROVE_SHIELD_BAUDRATE_AUTO)
+	{
+		*fd = -1;
+		return baudrate_auto(fd);
+	}
+
 	baudrate_conf(fd, baudrate);
+	return baudrate;
+}
+
+bool GroveShield_InitializeI2C(int* fd, I2C_InterfaceId isu, I2C_BusSpeed busSpeed)
+{
+	*fd = I2CMaster_Open(isu);
+	if (*fd == -1)
+	{
+		Log_Debug("[error] I2C master %d not opened: %s\n", isu, strerror(errno));
+		return false;
+	}
+
+	if (I2CMaster_SetBusSpeed(*fd, busSpeed) != 0 || I2CMaster_SetTimeout(*fd, GROVE_SHIELD_I2C_TIMEOUT_MS) != 0)
+	{
+		Log_Debug("[error] I2C master %d not configured: %s\n", isu, strerror(errno));
+		close(*fd);
+		*fd = -1;
+		return false;
+	}
+
+	GroveI2C_UseI2CMaster();
+	return true;
 }
\ No newline at end of file
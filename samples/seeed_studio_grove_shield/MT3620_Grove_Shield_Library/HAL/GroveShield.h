@@ -3,6 +3,14 @@
 
 #include "../applibs_versions.h"
 #include "stdint.h"
+#include <stdbool.h>
+#include <applibs/i2c.h>
 
 
-void GroveShield_Initialize(int* i2cFd, uint32_t baudrate);
\ No newline at end of file
+#define GROVE_SHIELD_BAUDRATE_AUTO	0	// the fastest rate the SC18IM700 reads back reliably at
+
+// Returns the baudrate the SC18IM700 and the UART were set to, 0 when the bridge did not answer at any
+uint32_t GroveShield_Initialize(int* i2cFd, uint32_t baudrate);
+// Grove I2C devices on an ISU I2C master rather than through the SC18IM700, for boards with the Grove I2C header
+// wired to an ISU. *i2cFd is the I2C master, passed to the sensors as the UART fd would be, GroveI2CBridge needs the UART.
+bool GroveShield_InitializeI2C(int* i2cFd, I2C_InterfaceId isu, I2C_BusSpeed busSpeed);
\ No newline at end of file
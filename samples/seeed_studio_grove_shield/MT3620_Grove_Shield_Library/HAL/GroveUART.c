@@ -2,6 +2,7 @@
 #include <unistd.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <poll.h>
 
 #include <applibs/uart.h>
 
@@ -31,3 +32,30 @@ bool GroveUART_Read(int fd, uint8_t* data, int dataSize)
 
 	return true;
 }
+
+bool GroveUART_ReadTimeout(int fd, uint8_t* data, int dataSize, int timeoutMs)
+{
+	struct pollfd readable = { .fd = fd, .events = POLLIN };
+	int totalReadSize = 0;
+
+	while (totalReadSize < dataSize)
+	{
+		if (poll(&readable, 1, timeoutMs) <= 0) return false;
+
+		int readSize = read(fd, &data[totalReadSize], (size_t)(dataSize - totalReadSize));
+		if (readSize < 0) return false;
+		totalReadSize += readSize;
+	}
+
+	return true;
+}
+
+void GroveUART_Flush(int fd)
+{
+	struct pollfd readable = { .fd = fd, .events = POLLIN };
+	uint8_t discard[16];
+
+	while (poll(&readable, 1, 0) > 0 && read(fd, discard, sizeof(discard)) > 0)
+	{
+	}
+}
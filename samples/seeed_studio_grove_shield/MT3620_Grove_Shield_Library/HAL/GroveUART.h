@@ -9,3 +9,7 @@
 int GroveUART_Open(UART_Id id, uint32_t baudRate);
 void GroveUART_Write(int fd, const uint8_t* data, int dataSize);
 bool GroveUART_Read(int fd, uint8_t* data, int dataSize);
+// false when dataSize bytes have not arrived within timeoutMs, for devices that may not answer
+bool GroveUART_ReadTimeout(int fd, uint8_t* data, int dataSize, int timeoutMs);
+// discard whatever has been received and not read
+void GroveUART_Flush(int fd);
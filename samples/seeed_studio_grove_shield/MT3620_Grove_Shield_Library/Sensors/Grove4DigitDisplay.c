@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <time.h>
 
 #include <applibs/gpio.h>
@@ -12,11 +13,18 @@
 
 static bool _clockpoint = false;
 
+#define DIGIT_COUNT		(4)
+
 typedef struct
 {
 	int ClkFd;
 	int DioFd;
 	float Brightness;
+	GPIO_Value_Type Clk;		// the level last driven on each line, a write to the same level is skipped
+	GPIO_Value_Type Dio;
+	uint8_t Segments[DIGIT_COUNT];	// what the display shows, valid once Shown
+	uint8_t Control;
+	bool Shown;
 }
 Grove4DigitDisplayInstance;
 
@@ -24,20 +32,38 @@ Grove4DigitDisplayInstance;
 ////////////////////////////////////////////////////////////////////////////////
 // TM1637
 
+static void SetClk(Grove4DigitDisplayInstance* this, GPIO_Value_Type value)
+{
+	if (this->Clk != value)
+	{
+		GPIO_SetValue(this->ClkFd, value);
+		this->Clk = value;
+	}
+}
+
+static void SetDio(Grove4DigitDisplayInstance* this, GPIO_Value_Type value)
+{
+	if (this->Dio != value)
+	{
+		GPIO_SetValue(this->DioFd, value);
+		this->Dio = value;
+	}
+}
+
 static void TM1637_Start(Grove4DigitDisplayInstance* this)
 {
-	GPIO_SetValue(this->ClkFd, GPIO_Value_High);
-	GPIO_SetValue(this->DioFd, GPIO_Value_Low);
+	SetClk(this, GPIO_Value_High);
+	SetDio(this, GPIO_Value_Low);
 	usleep(1);
 }
 
 static void TM1637_End(Grove4DigitDisplayInstance* this)
 {
-	GPIO_SetValue(this->ClkFd, GPIO_Value_Low);
+	SetClk(this, GPIO_Value_Low);
 	usleep(1);
-	GPIO_SetValue(this->ClkFd, GPIO_Value_High);
+	SetClk(this, GPIO_Value_High);
 	usleep(1);
-	GPIO_SetValue(this->DioFd, GPIO_Value_High);
+	SetDio(this, GPIO_Value_High);
 	usleep(1);
 }
 
@@ -45,29 +71,28 @@ static void TM1637_Write(Grove4DigitDisplayInstance* this, uint8_t data)
 {
 	for (int i = 0; i < 8; i++)
 	{
-		GPIO_SetValue(this->ClkFd, GPIO_Value_Low);
-		GPIO_SetValue(this->DioFd, data & 1 ? GPIO_Value_High : GPIO_Value_Low);
+		SetClk(this, GPIO_Value_Low);
+		SetDio(this, data & 1 ? GPIO_Value_High : GPIO_Value_Low);
 		data >>= 1;
 		usleep(1);
 
-		GPIO_SetValue(this->ClkFd, GPIO_Value_High);
+		SetClk(this, GPIO_Value_High);
 		usleep(1);
 	}
 
-	GPIO_SetValue(this->DioFd, GPIO_Value_High);
-	GPIO_SetValue(this->ClkFd, GPIO_Value_Low);
+	// release DIO for the acknowledge, the TM1637 pulls it low on the ninth clock
+	SetDio(this, GPIO_Value_High);
+	SetClk(this, GPIO_Value_Low);
 	usleep(1);
-
-	GPIO_Value_Type ack;
-	GPIO_GetValue(this->DioFd, &ack);
-	GPIO_SetValue(this->DioFd, GPIO_Value_Low);
-	GPIO_SetValue(this->ClkFd, GPIO_Value_High);
+	SetDio(this, GPIO_Value_Low);
+	SetClk(this, GPIO_Value_High);
 	usleep(1);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Grove4DigitDisplay
 
+#define ADDR_AUTO		(0x40)
 #define ADDR_FIXED		(0x44)
 
 static const uint8_t TubeTab[] =
@@ -78,42 +103,76 @@ static const uint8_t TubeTab[] =
 	0x39, 0x5e, 0x79, 0x71,	// 'C', 'd', 'E', 'F',
 };
 
+static uint8_t SegmentData(int dispData)
+{
+	if (dispData < 0 || dispData > 15) return 0x00;	// -1 for blank
+
+	return (uint8_t)(TubeTab[dispData] | (_clockpoint ? 0x80 : 0x00));
+}
+
+static void WriteControl(Grove4DigitDisplayInstance* this)
+{
+	// also turns the display on, so always sent until the first full update
+	uint8_t control = (uint8_t)(0x88 + this->Brightness * 7);
+	if (this->Shown && control == this->Control) return;
+
+	TM1637_Start(this);
+	TM1637_Write(this, control);
+	TM1637_End(this);
+	this->Control = control;
+}
+
 void* Grove4DigitDisplay_Open(GPIO_Id pin_clk, GPIO_Id pin_dio)
 {
 	Grove4DigitDisplayInstance* this = (Grove4DigitDisplayInstance*)malloc(sizeof(Grove4DigitDisplayInstance));
 
 	this->Brightness = 0.5f;
+	this->Shown = false;
 
 	this->ClkFd = GPIO_OpenAsOutput(pin_clk, GPIO_OutputMode_PushPull, GPIO_Value_High);
 	this->DioFd = GPIO_OpenAsOutput(pin_dio, GPIO_OutputMode_OpenDrain, GPIO_Value_High);
+	this->Clk = GPIO_Value_High;
+	this->Dio = GPIO_Value_High;
 	usleep(1);
 
 	return this;
 }
 
-void Grove4DigitDisplay_DisplayOneSegment(void* inst, int bitAddr, int dispData)
+void Grove4DigitDisplay_DisplaySegments(void* inst, const uint8_t* segments)
 {
 	Grove4DigitDisplayInstance* this = (Grove4DigitDisplayInstance*)inst;
 
-	uint8_t segData;
-	switch (dispData)
+	if (!this->Shown || memcmp(this->Segments, segments, DIGIT_COUNT) != 0)
 	{
-	case -1:	// Blank
-		segData = 0x00;
-		break;
-	default:
-		if (0 <= dispData && dispData <= 15)
-		{
-			segData = TubeTab[dispData];
-			if (_clockpoint)
-			{
-				segData |= 0x80;
-			}
-		}
-		else
+		// all four digits in one transfer, the address increments after each
+		TM1637_Start(this);
+		TM1637_Write(this, ADDR_AUTO);
+		TM1637_End(this);
+
+		TM1637_Start(this);
+		TM1637_Write(this, 0xc0);
+		for (int i = 0; i < DIGIT_COUNT; i++)
 		{
-			segData = 0x00;
+			TM1637_Write(this, segments[i]);
 		}
+		TM1637_End(this);
+
+		memcpy(this->Segments, segments, DIGIT_COUNT);
+	}
+
+	WriteControl(this);
+	this->Shown = true;
+}
+
+void Grove4DigitDisplay_DisplayOneSegment(void* inst, int bitAddr, int dispData)
+{
+	Grove4DigitDisplayInstance* this = (Grove4DigitDisplayInstance*)inst;
+
+	uint8_t segData = SegmentData(dispData);
+	if (this->Shown && this->Segments[bitAddr & 0x03] == segData)
+	{
+		WriteControl(this);
+		return;
 	}
 
 	TM1637_Start(this);
@@ -125,23 +184,25 @@ void Grove4DigitDisplay_DisplayOneSegment(void* inst, int bitAddr, int dispData)
 	TM1637_Write(this, segData);
 	TM1637_End(this);
 
-	TM1637_Start(this);
-	TM1637_Write(this, (uint8_t)(0x88 + this->Brightness * 7));
-	TM1637_End(this);
+	// the other digits are unknown until all four have been written once
+	this->Segments[bitAddr & 0x03] = segData;
+	WriteControl(this);
 }
 
 void Grove4DigitDisplay_DisplayValue(void* inst, int value)
 {
-	Grove4DigitDisplay_DisplayOneSegment(inst, 3, value % 10);
-	value /= 10;
-	Grove4DigitDisplay_DisplayOneSegment(inst, 2, value % 10);
-	value /= 10;
-	Grove4DigitDisplay_DisplayOneSegment(inst, 1, value % 10);
-	value /= 10;
-	Grove4DigitDisplay_DisplayOneSegment(inst, 0, value % 10);
+	uint8_t segments[DIGIT_COUNT];
+
+	for (int i = DIGIT_COUNT - 1; i >= 0; i--)
+	{
+		segments[i] = SegmentData(value % 10);
+		value /= 10;
+	}
+
+	Grove4DigitDisplay_DisplaySegments(inst, segments);
 }
 
 void Grove4DigitDisplay_DisplayClockPoint(bool clockpoint)
 {
 	_clockpoint = clockpoint;
-}
\ No newline at end of file
+}
@@ -7,8 +7,12 @@
 #include "../applibs_versions.h"
 #include <applibs/gpio.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 void* Grove4DigitDisplay_Open(GPIO_Id pin_clk, GPIO_Id pin_dio);
 void Grove4DigitDisplay_DisplayOneSegment(void* inst, int bitAddr, int dispData);
+// the four digits in one transfer, nothing is sent when the display already shows them
 void Grove4DigitDisplay_DisplayValue(void* inst, int value);
+// raw segment bytes of digits 0 to 3, bit 7 the clock point
+void Grove4DigitDisplay_DisplaySegments(void* inst, const uint8_t* segments);
 void Grove4DigitDisplay_DisplayClockPoint(bool clockpoint);
@@ -1,7 +1,10 @@
 #include "GroveAD7992.h"
+#include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
 #include "../HAL/GroveI2C.h"
 
 #include <applibs/gpio.h>
@@ -11,6 +14,9 @@
 #define AD7992_REG_CONVERSION_RESULT	(0x0)
 #define AD7992_REG_CONFIGURATION		(0x2)
 
+#define AD7992_CMD_CONVERT_BOTH			(0x30)		// command mode, Vin1 and Vin2 converted in turn, results read in sequence
+#define AD7992_CHANNELS					2
+
 #define CONVST_PIN   58
 #define ALART_PIN    57
 
@@ -21,16 +27,37 @@ typedef struct
 	int I2cFd;
 	int ConvstFd;
 	int AlertFd;
+	int Users;										// wrappers sharing the instance
+
+	EventLoop* EventLoop;
+	GroveI2CBridge* Bridge;
+	int TimerFd;
+	EventRegistration* TimerRegistration;
+	bool InFlight;									// a bridge conversion is queued
+	float Values[AD7992_CHANNELS];
 }
 GroveAD7992Instance;
 
+static GroveAD7992Instance* shared = NULL;
+
 void* GroveAD7992_Open(int i2cFd)
 {
-	GroveAD7992Instance* this = (GroveAD7992Instance*)malloc(sizeof(GroveAD7992Instance));
+	if (shared != NULL && shared->I2cFd == i2cFd)
+	{
+		shared->Users++;
+		return shared;
+	}
+
+	GroveAD7992Instance* this = (GroveAD7992Instance*)calloc(1, sizeof(GroveAD7992Instance));
 
 	this->I2cFd = i2cFd;
 	this->ConvstFd = GPIO_OpenAsOutput(CONVST_PIN, GPIO_OutputMode_PushPull, GPIO_Value_High);
 	this->AlertFd = GPIO_OpenAsInput(ALART_PIN);
+	this->Users = 1;
+	this->TimerFd = -1;
+	this->Values[0] = this->Values[1] = NAN;
+
+	shared = this;
 
 	return this;
 }
@@ -39,6 +66,11 @@ float GroveAD7992_Read(void* inst, int channel)
 {
 	GroveAD7992Instance* this = (GroveAD7992Instance*)inst;
 
+	if (this->TimerRegistration != NULL)
+	{
+		return channel >= 0 && channel < AD7992_CHANNELS ? this->Values[channel] : NAN;
+	}
+
 	// Select channel
 	GroveI2C_WriteReg8(this->I2cFd, AD7992_ADDRESS, AD7992_REG_CONFIGURATION, (channel == 0 ? 0x10 : 0x20) | 0x08);
 
@@ -67,3 +99,95 @@ float GroveAD7992_ConvertToMillisVolt(float value)
 	return (REF_VOL * value);
 }
 
+// each result is big endian, the channel in bits 13 and 12 ahead of the 12 bit value
+static void Decode(GroveAD7992Instance* this, const uint8_t* data)
+{
+	for (int i = 0; i < AD7992_CHANNELS; i++)
+	{
+		uint16_t result = (uint16_t)(data[2 * i] << 8 | data[2 * i + 1]);
+		int channel = (result >> 12) & 0x3;
+
+		if (channel < AD7992_CHANNELS)
+		{
+			this->Values[channel] = (float)(result & 0x0fff) / 0x0fff;
+		}
+	}
+}
+
+static void ConvertedAsync(bool ok, const uint8_t* data, int dataSize, void* context)
+{
+	GroveAD7992Instance* this = (GroveAD7992Instance*)context;
+
+	this->InFlight = false;
+	if (ok && dataSize == 2 * AD7992_CHANNELS)
+	{
+		Decode(this, data);
+	}
+}
+
+static void SampleHandler(EventLoop* el, int fd, EventLoop_IoEvents events, void* context)
+{
+	GroveAD7992Instance* this = (GroveAD7992Instance*)context;
+	const uint8_t command = AD7992_CMD_CONVERT_BOTH;
+	uint8_t results[2 * AD7992_CHANNELS];
+	uint64_t expirations;
+
+	if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) return;
+
+	if (this->Bridge != NULL)
+	{
+		// a conversion the bridge has not answered yet is not queued behind
+		if (!this->InFlight)
+		{
+			this->InFlight = GroveI2CBridge_WriteRead(this->Bridge, AD7992_ADDRESS, &command, 1, sizeof(results), ConvertedAsync, this);
+		}
+	}
+	else if (GroveI2C_WriteRead(this->I2cFd, AD7992_ADDRESS, &command, 1, results, sizeof(results)))
+	{
+		Decode(this, results);
+	}
+}
+
+bool GroveAD7992_StartSampling(void* inst, EventLoop* eventLoop, GroveI2CBridge* bridge, int periodMs)
+{
+	GroveAD7992Instance* this = (GroveAD7992Instance*)inst;
+	struct itimerspec period = { .it_interval = { periodMs / 1000, (periodMs % 1000) * 1000000 }, .it_value = { 0, 1 } };
+
+	if (this->TimerRegistration != NULL || periodMs <= 0) return false;
+
+	// command mode converts on the address pointer write, CONVST is held low
+	GPIO_SetValue(this->ConvstFd, GPIO_Value_Low);
+
+	this->EventLoop = eventLoop;
+	this->Bridge = bridge;
+	this->InFlight = false;
+	this->TimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+
+	if (this->TimerFd == -1 || timerfd_settime(this->TimerFd, 0, &period, NULL) == -1 ||
+		(this->TimerRegistration = EventLoop_RegisterIo(eventLoop, this->TimerFd, EventLoop_Input, SampleHandler, this)) == NULL)
+	{
+		GroveAD7992_StopSampling(this);
+		return false;
+	}
+
+	return true;
+}
+
+void GroveAD7992_StopSampling(void* inst)
+{
+	GroveAD7992Instance* this = (GroveAD7992Instance*)inst;
+
+	if (this->TimerRegistration != NULL)
+	{
+		EventLoop_UnregisterIo(this->EventLoop, this->TimerRegistration);
+		this->TimerRegistration = NULL;
+	}
+	if (this->TimerFd != -1)
+	{
+		close(this->TimerFd);
+		this->TimerFd = -1;
+	}
+
+	GPIO_SetValue(this->ConvstFd, GPIO_Value_High);
+	this->Values[0] = this->Values[1] = NAN;
+}
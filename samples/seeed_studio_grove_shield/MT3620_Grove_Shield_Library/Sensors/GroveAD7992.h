@@ -1,8 +1,19 @@
 #pragma once
 
+#include <stdbool.h>
 #include "../applibs_versions.h"
 #include <applibs/gpio.h>
+#include <applibs/eventloop.h>
+#include "../HAL/GroveI2CBridge.h"
+
+// One AD7992 serves every analog Grove sensor on the shield, GroveAD7992_Open returns the same instance for the
+// same I2C fd. Once sampling is started both channels are converted together in one command mode transaction
+// every period and GroveAD7992_Read returns the latest values, NAN before the first, without touching the bus.
+// Through a bridge the conversions queue on it, otherwise they are blocking GroveI2C calls from the event loop.
 
 void* GroveAD7992_Open(int i2cFd);
 float GroveAD7992_Read(void* inst, int channel);
 float GroveAD7992_ConvertToMillisVolt(float value);
+
+bool GroveAD7992_StartSampling(void* inst, EventLoop* eventLoop, GroveI2CBridge* bridge, int periodMs);
+void GroveAD7992_StopSampling(void* inst);
@@ -6,6 +6,7 @@ Grove OLED Display 96x96 v2.0
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <time.h>
 
 #include "GroveOledDisplay96x96.h"
@@ -22,6 +23,10 @@ Grove OLED Display 96x96 v2.0
 
 #define SeeedGrayOLED_Address		(0x3C << 1)
 
+#define OLED_BURST_SIZE				64		// data bytes in one I2C write
+
+#define FB_PAGE_COUNT				(OLED_HEIGHT / 8)
+
 
 /*Command and register */
 #define SeeedGrayOLED_Command_Mode          0x80
@@ -54,6 +59,12 @@ static char addressingMode;
 static uint8_t grayH;
 static uint8_t grayL;
 
+// 4 bit gray, two pixels a byte with the left one in the high nibble as the SSD1327 takes them
+static uint8_t framebuffer[OLED_HEIGHT][OLED_WIDTH / 2];
+// pixel columns of each 8 row page drawn since the last flush, from > to when clean
+static uint8_t dirtyFrom[FB_PAGE_COUNT];
+static uint8_t dirtyTo[FB_PAGE_COUNT];
+
 // This font can be freely used without any restriction(It is placed in public domain)
 const unsigned char BasicFont[][8] =
 {
@@ -165,6 +176,31 @@ static void sendData(uint8_t data)
 	GroveI2C_WriteReg8(_i2cFd, SeeedGrayOLED_Address, SeeedGrayOLED_Data_Mode, data);
 }
 
+// one I2C write per OLED_BURST_SIZE bytes rather than per byte
+static void sendDataBurst(const uint8_t* data, int dataSize)
+{
+	uint8_t send[1 + OLED_BURST_SIZE];
+	send[0] = SeeedGrayOLED_Data_Mode;
+
+	while (dataSize > 0)
+	{
+		int n = dataSize < OLED_BURST_SIZE ? dataSize : OLED_BURST_SIZE;
+		memcpy(&send[1], data, (size_t)n);
+		GroveI2C_Write(_i2cFd, SeeedGrayOLED_Address, send, 1 + n);
+		data += n;
+		dataSize -= n;
+	}
+}
+
+static void markDirty(int x0, int y0, int x1, int y1)
+{
+	for (int page = y0 / 8; page <= y1 / 8; page++)
+	{
+		if (dirtyFrom[page] > x0) dirtyFrom[page] = (uint8_t)x0;
+		if (dirtyTo[page] < x1 || dirtyFrom[page] > dirtyTo[page]) dirtyTo[page] = (uint8_t)x1;
+	}
+}
+
 void GroveOledDisplay_Init(int i2cFd, uint8_t IC)
 {
 	_i2cFd = i2cFd;
@@ -217,6 +253,7 @@ void GroveOledDisplay_Init(int i2cFd, uint8_t IC)
 		sendCommand(0x15);    // Set Column Address 
 		sendCommand(0x08);    // Start from 8th Column of driver IC. This is 0th Column for OLED 
 		sendCommand(0x37);    // End at  (8 + 47)th column. Each Column has 2 pixels(segments)
+		addressingMode = VERTICAL_MODE;
 
 		// Init gray level for text. Default:Brightest White
 		grayH = 0xF0;
@@ -245,6 +282,8 @@ void GroveOledDisplay_Init(int i2cFd, uint8_t IC)
 		sendCommand(0x00);
 		sendCommand(0x11);
 	}
+
+	fbClear(0);
 }
 
 void setContrastLevel(unsigned char ContrastLevel)
@@ -269,6 +308,7 @@ void setHorizontalMode(void)
 		sendCommand(0x15);    // Set Column Address 
 		sendCommand(0x08);    // Start from 8th Column of driver IC. This is 0th Column for OLED 
 		sendCommand(0x37);    // End at  (8 + 47)th column. Each Column has 2 pixels(or segments)
+		addressingMode = HORIZONTAL_MODE;
 	}
 	else if (Drive_IC == SH1107G)
 	{
@@ -283,6 +323,7 @@ void setVerticalMode(void)
 	{
 		sendCommand(0xA0); // remap to
 		sendCommand(0x46); // Vertical mode
+		addressingMode = VERTICAL_MODE;
 	}
 	else if (Drive_IC == SH1107G)
 	{
@@ -314,16 +355,14 @@ void setTextXY(unsigned char Row, unsigned char Column)
 
 void clearDisplay(void)
 {
+	static const uint8_t zeros[128];
 	unsigned char i, j;
 
 	if (Drive_IC == SSD1327)
 	{
 		for (j = 0; j < 48; j++)
 		{
-			for (i = 0; i < 96; i++)  //clear all columns
-			{
-				sendData(0x00);
-			}
+			sendDataBurst(zeros, 96);  //clear all columns
 		}
 	}
 	else if (Drive_IC == SH1107G)
@@ -332,9 +371,7 @@ void clearDisplay(void)
 			sendCommand((uint8_t)(0xb0 + i));
 			sendCommand(0x0);
 			sendCommand(0x10);
-			for (j = 0; j < 128; j++) {
-				sendData(0x00);
-			}
+			sendDataBurst(zeros, 128);
 		}
 	}
 }
@@ -548,4 +585,155 @@ void setNormalDisplay(void)
 void setInverseDisplay(void)
 {
 	sendCommand(SeeedGrayOLED_Inverse_Display_Cmd);
-}
\ No newline at end of file
+}
+
+void fbClear(uint8_t gray)
+{
+	gray &= 0x0F;
+	memset(framebuffer, gray << 4 | gray, sizeof(framebuffer));
+	markDirty(0, 0, OLED_WIDTH - 1, OLED_HEIGHT - 1);
+}
+
+void fbSetPixel(int x, int y, uint8_t gray)
+{
+	if (x < 0 || x >= OLED_WIDTH || y < 0 || y >= OLED_HEIGHT) return;
+
+	uint8_t* p = &framebuffer[y][x / 2];
+	*p = (x & 1) == 0 ? (uint8_t)((*p & 0x0F) | (gray << 4 & 0xF0)) : (uint8_t)((*p & 0xF0) | (gray & 0x0F));
+	markDirty(x, y, x, y);
+}
+
+uint8_t fbGetPixel(int x, int y)
+{
+	if (x < 0 || x >= OLED_WIDTH || y < 0 || y >= OLED_HEIGHT) return 0;
+
+	uint8_t b = framebuffer[y][x / 2];
+	return (x & 1) == 0 ? b >> 4 : b & 0x0F;
+}
+
+void fbFillRect(int x, int y, int w, int h, uint8_t gray)
+{
+	int x1 = x + w - 1, y1 = y + h - 1;
+
+	if (x < 0) x = 0;
+	if (y < 0) y = 0;
+	if (x1 >= OLED_WIDTH) x1 = OLED_WIDTH - 1;
+	if (y1 >= OLED_HEIGHT) y1 = OLED_HEIGHT - 1;
+	if (x > x1 || y > y1) return;
+
+	for (int row = y; row <= y1; row++)
+	{
+		for (int col = x; col <= x1; col++)
+		{
+			uint8_t* p = &framebuffer[row][col / 2];
+			*p = (col & 1) == 0 ? (uint8_t)((*p & 0x0F) | (gray << 4 & 0xF0)) : (uint8_t)((*p & 0xF0) | (gray & 0x0F));
+		}
+	}
+	markDirty(x, y, x1, y1);
+}
+
+void fbDrawHLine(int x, int y, int w, uint8_t gray)
+{
+	fbFillRect(x, y, w, 1, gray);
+}
+
+void fbDrawVLine(int x, int y, int h, uint8_t gray)
+{
+	fbFillRect(x, y, 1, h, gray);
+}
+
+void fbDrawRect(int x, int y, int w, int h, uint8_t gray)
+{
+	fbDrawHLine(x, y, w, gray);
+	fbDrawHLine(x, y + h - 1, w, gray);
+	fbDrawVLine(x, y, h, gray);
+	fbDrawVLine(x + w - 1, y, h, gray);
+}
+
+void fbDrawChar(int x, int y, unsigned char C, uint8_t gray, uint8_t background)
+{
+	if (C < 32 || C > 127)
+	{
+		C = ' ';
+	}
+
+	// each font byte is a column, bit 0 at the top
+	for (int i = 0; i < 8; i++)
+	{
+		for (int j = 0; j < 8; j++)
+		{
+			fbSetPixel(x + i, y + j, ((BasicFont[C - 32][i] >> j) & 0x01) != 0 ? gray : background);
+		}
+	}
+}
+
+void fbDrawString(int x, int y, const char* String, uint8_t gray, uint8_t background)
+{
+	for (; *String != '\0' && x < OLED_WIDTH; String++, x += 8)
+	{
+		fbDrawChar(x, y, (unsigned char)*String, gray, background);
+	}
+}
+
+void fbFlush(void)
+{
+	uint8_t buffer[OLED_WIDTH / 2 * 8];
+
+	for (int page = 0; page < FB_PAGE_COUNT; page++)
+	{
+		int from = dirtyFrom[page], to = dirtyTo[page];
+		if (from > to) continue;
+
+		int n = 0;
+
+		if (Drive_IC == SSD1327)
+		{
+			// a window over the dirty columns of the page, filled in the addressing mode set
+			from /= 2;
+			to /= 2;
+			sendCommand(0x15);
+			sendCommand((uint8_t)(0x08 + from));
+			sendCommand((uint8_t)(0x08 + to));
+			sendCommand(0x75);
+			sendCommand((uint8_t)(page * 8));
+			sendCommand((uint8_t)(page * 8 + 7));
+
+			if (addressingMode == HORIZONTAL_MODE)
+			{
+				for (int row = page * 8; row < page * 8 + 8; row++)
+				{
+					for (int col = from; col <= to; col++) buffer[n++] = framebuffer[row][col];
+				}
+			}
+			else
+			{
+				for (int col = from; col <= to; col++)
+				{
+					for (int row = page * 8; row < page * 8 + 8; row++) buffer[n++] = framebuffer[row][col];
+				}
+			}
+		}
+		else if (Drive_IC == SH1107G)
+		{
+			// monochrome, any gray but 0 is lit
+			sendCommand((uint8_t)(0xb0 + page));
+			sendCommand((uint8_t)(0x10 + ((from >> 4) & 0x07)));
+			sendCommand((uint8_t)(from & 0x0F));
+
+			for (int x = from; x <= to; x++)
+			{
+				uint8_t bits = 0;
+				for (int b = 0; b < 8; b++)
+				{
+					if (fbGetPixel(x, page * 8 + b) != 0) bits |= (uint8_t)(1 << b);
+				}
+				buffer[n++] = bits;
+			}
+		}
+
+		sendDataBurst(buffer, n);
+
+		dirtyFrom[page] = OLED_WIDTH - 1;
+		dirtyTo[page] = 0;
+	}
+}
@@ -9,6 +9,9 @@
 #define SH1107G  1
 #define SSD1327  2
 
+#define OLED_WIDTH   96
+#define OLED_HEIGHT  96
+
 void GroveOledDisplay_Init(int i2cFd, uint8_t IC);
 
 void setNormalDisplay(void);
@@ -30,4 +33,18 @@ void drawBitmap(const unsigned char *bitmaparray, int bytes);
 
 void setHorizontalScrollProperties(bool direction, unsigned char startRow, unsigned char endRow, unsigned char startColumn, unsigned char endColumn, unsigned char scrollSpeed);
 void activateScroll(void);
-void deactivateScroll(void);
\ No newline at end of file
+void deactivateScroll(void);
+
+// Framebuffer in RAM, drawing only touches memory and fbFlush sends what changed since the last flush,
+// each 8 row page from its first to its last dirty column in a few long I2C writes. Gray is 0 to 15, the
+// SH1107G lights any gray but 0. Independent of the text calls above, which write to the display directly
+void fbClear(uint8_t gray);
+void fbSetPixel(int x, int y, uint8_t gray);
+uint8_t fbGetPixel(int x, int y);
+void fbFillRect(int x, int y, int w, int h, uint8_t gray);
+void fbDrawHLine(int x, int y, int w, uint8_t gray);
+void fbDrawVLine(int x, int y, int h, uint8_t gray);
+void fbDrawRect(int x, int y, int w, int h, uint8_t gray);
+void fbDrawChar(int x, int y, unsigned char c, uint8_t gray, uint8_t background);
+void fbDrawString(int x, int y, const char *String, uint8_t gray, uint8_t background);
+void fbFlush(void);
@@ -2,68 +2,287 @@
 #include <stdlib.h>
 #include <math.h>
 #include "../HAL/GroveI2C.h"
+#include "../Common/Delay.h"
 
 #define BME280_ADDRESS				(0x76 << 1)
 
-#define BME280_REG_DIG_T1			(0x88)
-#define BME280_REG_DIG_T2			(0x8A)
-#define BME280_REG_DIG_T3			(0x8C)
+#define BME280_REG_CALIB00			(0x88)		// T1 to T3, P1 to P9, H1 at 0xa1
 #define BME280_REG_CHIPID			(0xD0)
+#define BME280_REG_RESET			(0xE0)
+#define BME280_REG_CALIB26			(0xE1)		// H2 to H6
 #define BME280_REG_CONTROLHUMID		(0xF2)
+#define BME280_REG_STATUS			(0xF3)
 #define BME280_REG_CONTROL			(0xF4)
-#define BME280_REG_TEMPDATA			(0xFA)
+#define BME280_REG_CONFIG			(0xF5)
+#define BME280_REG_PRESSDATA		(0xF7)		// pressure, temperature and humidity, 8 bytes
+
+#define BME280_CALIB00_SIZE			(26)
+#define BME280_CALIB26_SIZE			(7)
+#define BME280_BURST_SIZE			(8)
+
+#define BME280_MODE_SLEEP			(0x00)
+#define BME280_MODE_FORCED			(0x01)
+#define BME280_MODE_NORMAL			(0x03)
+
+#define BME280_SKIPPED				(0x80000)	// the reset value, the channel has not been measured yet
+
+typedef struct
+{
+	uint16_t T1;
+	int16_t T2, T3;
+	uint16_t P1;
+	int16_t P2, P3, P4, P5, P6, P7, P8, P9;
+	uint8_t H1, H3;
+	int16_t H2, H4, H5;
+	int8_t H6;
+}
+Bme280Calibration;
+
+typedef struct
+{
+	uint8_t OsrsT, OsrsP, OsrsH;	// register codes, 1 is x1 up to 5 for x16
+	uint8_t Filter;					// 0 off, 2 is 4, 4 is 16
+	uint8_t Standby;				// normal mode, 0 is 0.5 ms, 1 is 62.5 ms, 5 is 1000 ms
+	uint8_t Mode;
+}
+Bme280Settings;
+
+static const Bme280Settings OdrSettings[] =
+{
+	[GROVE_TEMP_HUMI_BARO_BME280_FORCED] = { 1, 1, 1, 0, 0, BME280_MODE_FORCED },
+	[GROVE_TEMP_HUMI_BARO_BME280_1_HZ] = { 2, 5, 1, 2, 5, BME280_MODE_NORMAL },
+	[GROVE_TEMP_HUMI_BARO_BME280_10_HZ] = { 1, 3, 1, 4, 1, BME280_MODE_NORMAL },
+	[GROVE_TEMP_HUMI_BARO_BME280_20_HZ] = { 2, 5, 1, 4, 0, BME280_MODE_NORMAL },
+};
 
 typedef struct
 {
 	int I2cFd;
-	float Temperature;
+	Bme280Calibration Calib;
+	const Bme280Settings* Settings;
+	int32_t Temperature;			// 0.01 degrees C
+	uint32_t Pressure;				// Q24.8 Pa
+	uint32_t Humidity;				// Q22.10 %RH
+	bool Valid;
+	GroveTempHumiBaroBME280_Callback ReadCallback;
+	void* ReadContext;
 }
 GroveTempHumiBaroBME280Instance;
 
+
+static bool ReadRegs(GroveTempHumiBaroBME280Instance* this, uint8_t reg, uint8_t* data, int dataSize)
+{
+	return GroveI2C_WriteRead(this->I2cFd, BME280_ADDRESS, &reg, 1, data, dataSize);
+}
+
+static bool ReadCalibration(GroveTempHumiBaroBME280Instance* this)
+{
+	uint8_t c[BME280_CALIB00_SIZE];
+	uint8_t h[BME280_CALIB26_SIZE];
+	if (!ReadRegs(this, BME280_REG_CALIB00, c, sizeof(c))) return false;
+	if (!ReadRegs(this, BME280_REG_CALIB26, h, sizeof(h))) return false;
+
+	Bme280Calibration* cal = &this->Calib;
+	cal->T1 = (uint16_t)(c[1] << 8 | c[0]);
+	cal->T2 = (int16_t)(c[3] << 8 | c[2]);
+	cal->T3 = (int16_t)(c[5] << 8 | c[4]);
+	cal->P1 = (uint16_t)(c[7] << 8 | c[6]);
+	cal->P2 = (int16_t)(c[9] << 8 | c[8]);
+	cal->P3 = (int16_t)(c[11] << 8 | c[10]);
+	cal->P4 = (int16_t)(c[13] << 8 | c[12]);
+	cal->P5 = (int16_t)(c[15] << 8 | c[14]);
+	cal->P6 = (int16_t)(c[17] << 8 | c[16]);
+	cal->P7 = (int16_t)(c[19] << 8 | c[18]);
+	cal->P8 = (int16_t)(c[21] << 8 | c[20]);
+	cal->P9 = (int16_t)(c[23] << 8 | c[22]);
+	cal->H1 = c[25];
+	cal->H2 = (int16_t)(h[1] << 8 | h[0]);
+	cal->H3 = h[2];
+	cal->H4 = (int16_t)((int8_t)h[3] * 16 | (h[4] & 0x0f));		// 12 bit, signed
+	cal->H5 = (int16_t)((int8_t)h[5] * 16 | h[4] >> 4);
+	cal->H6 = (int8_t)h[6];
+
+	return true;
+}
+
+// the datasheet's integer compensation, 4.2.3
+static void Compensate(GroveTempHumiBaroBME280Instance* this, const uint8_t* data)
+{
+	const Bme280Calibration* cal = &this->Calib;
+	int32_t adc_P = (int32_t)(data[0] << 12 | data[1] << 4 | data[2] >> 4);
+	int32_t adc_T = (int32_t)(data[3] << 12 | data[4] << 4 | data[5] >> 4);
+	int32_t adc_H = (int32_t)(data[6] << 8 | data[7]);
+
+	if (adc_T == BME280_SKIPPED) return;
+
+	int32_t var1 = (((adc_T >> 3) - ((int32_t)cal->T1 << 1)) * (int32_t)cal->T2) >> 11;
+	int32_t var2 = (((((adc_T >> 4) - (int32_t)cal->T1) * ((adc_T >> 4) - (int32_t)cal->T1)) >> 12) * (int32_t)cal->T3) >> 14;
+	int32_t t_fine = var1 + var2;
+	this->Temperature = (t_fine * 5 + 128) >> 8;
+
+	int64_t p1 = (int64_t)t_fine - 128000;
+	int64_t p2 = p1 * p1 * (int64_t)cal->P6;
+	p2 = p2 + ((p1 * (int64_t)cal->P5) * 131072);
+	p2 = p2 + ((int64_t)cal->P4 * 34359738368);
+	p1 = ((p1 * p1 * (int64_t)cal->P3) >> 8) + ((p1 * (int64_t)cal->P2) * 4096);
+	p1 = ((INT64_C(1) << 47) + p1) * (int64_t)cal->P1 >> 33;
+	if (p1 != 0 && adc_P != BME280_SKIPPED)
+	{
+		int64_t p = 1048576 - adc_P;
+		p = (((p << 31) - p2) * 3125) / p1;
+		p1 = ((int64_t)cal->P9 * (p >> 13) * (p >> 13)) >> 25;
+		p2 = ((int64_t)cal->P8 * p) >> 19;
+		this->Pressure = (uint32_t)(((p + p1 + p2) >> 8) + ((int64_t)cal->P7 << 4));
+	}
+
+	int32_t h = t_fine - 76800;
+	h = ((((adc_H << 14) - ((int32_t)cal->H4 << 20) - ((int32_t)cal->H5 * h)) + 16384) >> 15) *
+		(((((((h * (int32_t)cal->H6) >> 10) * (((h * (int32_t)cal->H3) >> 11) + 32768)) >> 10) + 2097152) * (int32_t)cal->H2 + 8192) >> 14);
+	h = h - (((((h >> 15) * (h >> 15)) >> 7) * (int32_t)cal->H1) >> 4);
+	h = h < 0 ? 0 : h > 419430400 ? 419430400 : h;
+	this->Humidity = (uint32_t)(h >> 12);
+
+	this->Valid = true;
+}
+
+static void BurstRead(bool ok, const uint8_t* data, int dataSize, void* context)
+{
+	GroveTempHumiBaroBME280Instance* this = (GroveTempHumiBaroBME280Instance*)context;
+
+	this->Valid = false;
+	if (ok && dataSize == BME280_BURST_SIZE) Compensate(this, data);
+
+	if (this->ReadCallback != NULL) this->ReadCallback(this, this->ReadContext);
+}
+
+static uint8_t ControlValue(const Bme280Settings* settings, uint8_t mode)
+{
+	return (uint8_t)(settings->OsrsT << 5 | settings->OsrsP << 2 | mode);
+}
+
 void* GroveTempHumiBaroBME280_Open(int i2cFd)
 {
 	GroveTempHumiBaroBME280Instance* this = (GroveTempHumiBaroBME280Instance*)malloc(sizeof(GroveTempHumiBaroBME280Instance));
 
 	this->I2cFd = i2cFd;
-	this->Temperature = NAN;
+	this->Valid = false;
+	this->ReadCallback = NULL;
 
 	uint8_t val8;
 	if (!GroveI2C_ReadReg8(this->I2cFd, BME280_ADDRESS, BME280_REG_CHIPID, &val8)) return NULL;
 	if (val8 != 0x60) return NULL;
 
-	GroveI2C_WriteReg8(this->I2cFd, BME280_ADDRESS, BME280_REG_CONTROLHUMID, 0x05);
-	GroveI2C_WriteReg8(this->I2cFd, BME280_ADDRESS, BME280_REG_CONTROL, 0xb7);
+	GroveI2C_WriteReg8(this->I2cFd, BME280_ADDRESS, BME280_REG_RESET, 0xb6);
+	usleep(3000);
+
+	// wait for the NVM copy to finish
+	do
+	{
+		if (!GroveI2C_ReadReg8(this->I2cFd, BME280_ADDRESS, BME280_REG_STATUS, &val8)) return NULL;
+	} while ((val8 & 0x01) != 0);
+
+	if (!ReadCalibration(this)) return NULL;
+
+	GroveTempHumiBaroBME280_Configure(this, GROVE_TEMP_HUMI_BARO_BME280_1_HZ);
 
 	return this;
 }
 
+void GroveTempHumiBaroBME280_Configure(void* inst, GroveTempHumiBaroBME280_Odr odr)
+{
+	GroveTempHumiBaroBME280Instance* this = (GroveTempHumiBaroBME280Instance*)inst;
+	const Bme280Settings* settings = &OdrSettings[odr];
+
+	this->Settings = settings;
+
+	// the config register is only taken in sleep mode, the humidity control only by the next control write
+	GroveI2C_WriteReg8(this->I2cFd, BME280_ADDRESS, BME280_REG_CONTROL, ControlValue(settings, BME280_MODE_SLEEP));
+	GroveI2C_WriteReg8(this->I2cFd, BME280_ADDRESS, BME280_REG_CONFIG, (uint8_t)(settings->Standby << 5 | settings->Filter << 2));
+	GroveI2C_WriteReg8(this->I2cFd, BME280_ADDRESS, BME280_REG_CONTROLHUMID, settings->OsrsH);
+	if (settings->Mode == BME280_MODE_NORMAL)
+	{
+		GroveI2C_WriteReg8(this->I2cFd, BME280_ADDRESS, BME280_REG_CONTROL, ControlValue(settings, BME280_MODE_NORMAL));
+	}
+}
+
 void GroveTempHumiBaroBME280_Read(void* inst)
 {
 	GroveTempHumiBaroBME280Instance* this = (GroveTempHumiBaroBME280Instance*)inst;
 
-	this->Temperature = NAN;
+	this->Valid = false;
 
-	uint16_t dig_T1;
-	int16_t dig_T2;
-	int16_t dig_T3;
-	if (!GroveI2C_ReadReg16(this->I2cFd, BME280_ADDRESS, BME280_REG_DIG_T1, &dig_T1)) return;
-	if (!GroveI2C_ReadReg16(this->I2cFd, BME280_ADDRESS, BME280_REG_DIG_T2, (uint16_t*)&dig_T2)) return;
-	if (!GroveI2C_ReadReg16(this->I2cFd, BME280_ADDRESS, BME280_REG_DIG_T3, (uint16_t*)&dig_T3)) return;
+	if (this->Settings->Mode == BME280_MODE_FORCED)
+	{
+		GroveI2C_WriteReg8(this->I2cFd, BME280_ADDRESS, BME280_REG_CONTROL, ControlValue(this->Settings, BME280_MODE_FORCED));
+		usleep(GroveTempHumiBaroBME280_GetMeasurementTimeMs(this) * 1000L);
+	}
 
-	int32_t adc_T;
-	if (!GroveI2C_ReadReg24BE(this->I2cFd, BME280_ADDRESS, BME280_REG_TEMPDATA, &adc_T)) return;
+	uint8_t data[BME280_BURST_SIZE];
+	if (!ReadRegs(this, BME280_REG_PRESSDATA, data, sizeof(data))) return;
 
-	adc_T >>= 4;
-	int32_t var1 = (((adc_T >> 3) - ((int32_t)(dig_T1 << 1))) * ((int32_t)dig_T2)) >> 11;
-	int32_t var2 = (((((adc_T >> 4) - ((int32_t)dig_T1)) * ((adc_T >> 4) - ((int32_t)dig_T1))) >> 12) * ((int32_t)dig_T3)) >> 14;
+	Compensate(this, data);
+}
 
-	int32_t t_fine = var1 + var2;
-	this->Temperature = (float)((t_fine * 5 + 128) >> 8) / 100;
+int GroveTempHumiBaroBME280_GetMeasurementTimeMs(void* inst)
+{
+	GroveTempHumiBaroBME280Instance* this = (GroveTempHumiBaroBME280Instance*)inst;
+	const Bme280Settings* settings = this->Settings;
+
+	// datasheet 9.1 maximum, in us: 1250 + 2300 * T + (2300 * P + 575) + (2300 * H + 575)
+	int us = 1250 + 2300 * (1 << (settings->OsrsT - 1)) + 2300 * (1 << (settings->OsrsP - 1)) + 575 +
+		2300 * (1 << (settings->OsrsH - 1)) + 575;
+
+	return (us + 999) / 1000;
+}
+
+void GroveTempHumiBaroBME280_StartAsync(void* inst, GroveI2CBridge* bridge)
+{
+	GroveTempHumiBaroBME280Instance* this = (GroveTempHumiBaroBME280Instance*)inst;
+
+	if (this->Settings->Mode != BME280_MODE_FORCED) return;
+
+	const uint8_t writeData[2] = { BME280_REG_CONTROL, ControlValue(this->Settings, BME280_MODE_FORCED) };
+	GroveI2CBridge_Write(bridge, BME280_ADDRESS, writeData, sizeof(writeData), NULL, NULL);
+}
+
+void GroveTempHumiBaroBME280_CollectAsync(void* inst, GroveI2CBridge* bridge, GroveTempHumiBaroBME280_Callback callback, void* context)
+{
+	GroveTempHumiBaroBME280Instance* this = (GroveTempHumiBaroBME280Instance*)inst;
+	const uint8_t reg = BME280_REG_PRESSDATA;
+
+	this->ReadCallback = callback;
+	this->ReadContext = context;
+
+	if (!GroveI2CBridge_WriteRead(bridge, BME280_ADDRESS, &reg, 1, BME280_BURST_SIZE, BurstRead, this))
+	{
+		this->Valid = false;
+		if (callback != NULL) callback(this, context);
+	}
+}
+
+void GroveTempHumiBaroBME280_ReadAsync(void* inst, GroveI2CBridge* bridge, GroveTempHumiBaroBME280_Callback callback, void* context)
+{
+	GroveTempHumiBaroBME280_CollectAsync(inst, bridge, callback, context);
+	GroveTempHumiBaroBME280_StartAsync(inst, bridge);
 }
 
 float GroveTempHumiBaroBME280_GetTemperature(void* inst)
 {
 	GroveTempHumiBaroBME280Instance* this = (GroveTempHumiBaroBME280Instance*)inst;
 
-	return this->Temperature;
+	return this->Valid ? (float)this->Temperature / 100 : NAN;
+}
+
+float GroveTempHumiBaroBME280_GetHumidity(void* inst)
+{
+	GroveTempHumiBaroBME280Instance* this = (GroveTempHumiBaroBME280Instance*)inst;
+
+	return this->Valid ? (float)this->Humidity / 1024 : NAN;
+}
+
+float GroveTempHumiBaroBME280_GetPressure(void* inst)
+{
+	GroveTempHumiBaroBME280Instance* this = (GroveTempHumiBaroBME280Instance*)inst;
+
+	return this->Valid ? (float)this->Pressure / 25600 : NAN;
 }
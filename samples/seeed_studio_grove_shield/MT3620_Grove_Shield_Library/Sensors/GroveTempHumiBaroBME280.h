@@ -4,6 +4,37 @@
 
 #pragma once
 #include "../applibs_versions.h"
+#include "../HAL/GroveI2CBridge.h"
+
+// output data rates, each with the oversampling and IIR filter of the matching datasheet use case.
+// FORCED measures once per start, the others run in normal mode and a read returns the latest result
+typedef enum
+{
+	GROVE_TEMP_HUMI_BARO_BME280_FORCED,		// weather monitoring, x1 oversampling, no filter
+	GROVE_TEMP_HUMI_BARO_BME280_1_HZ,		// humidity and indoor climate, pressure x16, filter 4
+	GROVE_TEMP_HUMI_BARO_BME280_10_HZ,		// pressure x4, filter 16
+	GROVE_TEMP_HUMI_BARO_BME280_20_HZ		// indoor navigation, pressure x16, filter 16, no standby
+}
+GroveTempHumiBaroBME280_Odr;
+
+typedef void (*GroveTempHumiBaroBME280_Callback)(void* inst, void* context);
+
+// reads the calibration once and starts at 1 Hz
 void* GroveTempHumiBaroBME280_Open(int i2cFd);
+void GroveTempHumiBaroBME280_Configure(void* inst, GroveTempHumiBaroBME280_Odr odr);
+// one burst read, in forced mode starts a measurement and sleeps through it first
 void GroveTempHumiBaroBME280_Read(void* inst);
-float GroveTempHumiBaroBME280_GetTemperature(void* inst);
+
+// forced mode, how long a measurement started takes at the configured oversampling
+int GroveTempHumiBaroBME280_GetMeasurementTimeMs(void* inst);
+// through the bridge, the callback runs from the event loop once the burst is read. Start does nothing in
+// normal mode, in forced mode collect from a one shot timer GetMeasurementTimeMs after it
+void GroveTempHumiBaroBME280_StartAsync(void* inst, GroveI2CBridge* bridge);
+void GroveTempHumiBaroBME280_CollectAsync(void* inst, GroveI2CBridge* bridge, GroveTempHumiBaroBME280_Callback callback, void* context);
+// collect then start the next measurement in one UART write, so from a periodic timer each call returns the
+// measurement started by the previous one, NAN after the first call in forced mode
+void GroveTempHumiBaroBME280_ReadAsync(void* inst, GroveI2CBridge* bridge, GroveTempHumiBaroBME280_Callback callback, void* context);
+
+float GroveTempHumiBaroBME280_GetTemperature(void* inst);		// degrees C
+float GroveTempHumiBaroBME280_GetHumidity(void* inst);			// %RH
+float GroveTempHumiBaroBME280_GetPressure(void* inst);			// hPa
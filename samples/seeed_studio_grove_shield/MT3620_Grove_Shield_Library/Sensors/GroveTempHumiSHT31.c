@@ -15,16 +15,32 @@
 #define CMD_SINGLE_HIGH		(0x2400)
 #define CMD_HEATER_ENABLE	(0x306d)
 #define CMD_HEATER_DISABLE	(0x3066)
+#define CMD_FETCH_DATA		(0xe000)
+#define CMD_BREAK			(0x3093)
 
 typedef struct
 {
 	int I2cFd;
 	float Temperature;
 	float Humidity;
+	bool Periodic;				// measuring on its own, a collect fetches the latest result
+	GroveTempHumiSHT31_Callback ReadCallback;
+	void* ReadContext;
 }
 GroveTempHumiSHT31Instance;
 
 
+// high repeatability commands of each periodic rate
+static const uint16_t PeriodicCommands[] =
+{
+	[GROVE_TEMP_HUMI_SHT31_HALF_MPS] = 0x2032,
+	[GROVE_TEMP_HUMI_SHT31_1_MPS] = 0x2130,
+	[GROVE_TEMP_HUMI_SHT31_2_MPS] = 0x2236,
+	[GROVE_TEMP_HUMI_SHT31_4_MPS] = 0x2334,
+	[GROVE_TEMP_HUMI_SHT31_10_MPS] = 0x2737,
+	[GROVE_TEMP_HUMI_SHT31_ART] = 0x2b32,
+};
+
 static void SendCommand(GroveTempHumiSHT31Instance* this, uint16_t cmd)
 {
 	uint8_t writeData[2];
@@ -33,6 +49,12 @@ static void SendCommand(GroveTempHumiSHT31Instance* this, uint16_t cmd)
 	GroveI2C_Write(this->I2cFd, SHT31_ADDRESS, writeData, sizeof(writeData));
 }
 
+static bool SendCommandAsync(GroveI2CBridge* bridge, uint16_t cmd)
+{
+	const uint8_t writeData[2] = { (uint8_t)(cmd >> 8), (uint8_t)(cmd & 0xff) };
+	return GroveI2CBridge_Write(bridge, SHT31_ADDRESS, writeData, sizeof(writeData), NULL, NULL);
+}
+
 static uint8_t CalcCRC8(const uint8_t* data, int dataSize)
 {
 	uint8_t crc = 0xff;
@@ -50,6 +72,35 @@ static uint8_t CalcCRC8(const uint8_t* data, int dataSize)
 	return crc;
 }
 
+static void Decode(GroveTempHumiSHT31Instance* this, const uint8_t* readData)
+{
+	if (readData[2] != CalcCRC8(&readData[0], 2)) return;
+	if (readData[5] != CalcCRC8(&readData[3], 2)) return;
+
+	uint16_t ST;
+	ST = readData[0];
+	ST = (uint16_t)(ST << 8);
+	ST = (uint16_t)(ST | readData[1]);
+
+	uint16_t SRH;
+	SRH = readData[3];
+	SRH = (uint16_t)(SRH << 8);
+	SRH = (uint16_t)(SRH | readData[4]);
+
+	this->Temperature = (float)ST * 175 / 0xffff - 45;
+	this->Humidity = (float)SRH * 100 / 0xffff;
+}
+
+static void MeasurementRead(bool ok, const uint8_t* data, int dataSize, void* context)
+{
+	GroveTempHumiSHT31Instance* this = (GroveTempHumiSHT31Instance*)context;
+
+	this->Temperature = NAN;
+	if (ok && dataSize == 6) Decode(this, data);
+
+	if (this->ReadCallback != NULL) this->ReadCallback(this, this->ReadContext);
+}
+
 void* GroveTempHumiSHT31_Open(int i2cFd)
 {
 	GroveTempHumiSHT31Instance* this = (GroveTempHumiSHT31Instance*)malloc(sizeof(GroveTempHumiSHT31Instance));
@@ -57,6 +108,8 @@ void* GroveTempHumiSHT31_Open(int i2cFd)
 	this->I2cFd = i2cFd;
 	this->Temperature = NAN;
 	this->Humidity = NAN;
+	this->Periodic = false;
+	this->ReadCallback = NULL;
 
 	SendCommand(this, CMD_SOFT_RESET);
 	usleep(1000);
@@ -68,29 +121,93 @@ void GroveTempHumiSHT31_Read(void* inst)
 {
 	GroveTempHumiSHT31Instance* this = (GroveTempHumiSHT31Instance*)inst;
 
-	this->Temperature = NAN;
+	if (!this->Periodic)
+	{
+		GroveTempHumiSHT31_Start(this);
+		usleep(GROVE_TEMP_HUMI_SHT31_MEASUREMENT_MS * 1000);
+	}
+
+	GroveTempHumiSHT31_Collect(this);
+}
+
+void GroveTempHumiSHT31_StartPeriodic(void* inst, GroveTempHumiSHT31_Rate rate)
+{
+	GroveTempHumiSHT31Instance* this = (GroveTempHumiSHT31Instance*)inst;
+
+	if (this->Periodic)
+	{
+		GroveTempHumiSHT31_StopPeriodic(this);
+	}
+
+	SendCommand(this, PeriodicCommands[rate]);
+	this->Periodic = true;
+}
+
+void GroveTempHumiSHT31_StopPeriodic(void* inst)
+{
+	GroveTempHumiSHT31Instance* this = (GroveTempHumiSHT31Instance*)inst;
+
+	SendCommand(this, CMD_BREAK);
+	usleep(1000);
+	this->Periodic = false;
+}
+
+void GroveTempHumiSHT31_Start(void* inst)
+{
+	GroveTempHumiSHT31Instance* this = (GroveTempHumiSHT31Instance*)inst;
 
 	SendCommand(this, CMD_SINGLE_HIGH);
-	usleep(20000);
+}
+
+void GroveTempHumiSHT31_Collect(void* inst)
+{
+	GroveTempHumiSHT31Instance* this = (GroveTempHumiSHT31Instance*)inst;
+
+	this->Temperature = NAN;
+
+	if (this->Periodic)
+	{
+		SendCommand(this, CMD_FETCH_DATA);
+	}
 
 	uint8_t readData[6];
 	if (!GroveI2C_Read(this->I2cFd, SHT31_ADDRESS, readData, sizeof(readData))) return;
 
-	if (readData[2] != CalcCRC8(&readData[0], 2)) return;
-	if (readData[5] != CalcCRC8(&readData[3], 2)) return;
+	Decode(this, readData);
+}
 
-	uint16_t ST;
-	ST = readData[0];
-	ST = (uint16_t)(ST << 8);
-	ST = (uint16_t)(ST | readData[1]);
+void GroveTempHumiSHT31_StartAsync(void* inst, GroveI2CBridge* bridge)
+{
+	SendCommandAsync(bridge, CMD_SINGLE_HIGH);
+}
 
-	uint16_t SRH;
-	SRH = readData[3];
-	SRH = (uint16_t)(SRH << 8);
-	SRH = (uint16_t)(SRH | readData[4]);
+void GroveTempHumiSHT31_CollectAsync(void* inst, GroveI2CBridge* bridge, GroveTempHumiSHT31_Callback callback, void* context)
+{
+	GroveTempHumiSHT31Instance* this = (GroveTempHumiSHT31Instance*)inst;
 
-	this->Temperature = (float)ST * 175 / 0xffff - 45;
-	this->Humidity = (float)SRH * 100 / 0xffff;
+	this->ReadCallback = callback;
+	this->ReadContext = context;
+
+	// the fetch and the read share one UART write
+	if ((this->Periodic && !SendCommandAsync(bridge, CMD_FETCH_DATA)) ||
+		!GroveI2CBridge_Read(bridge, SHT31_ADDRESS, 6, MeasurementRead, this))
+	{
+		this->Temperature = NAN;
+		if (callback != NULL) callback(this, context);
+	}
+}
+
+void GroveTempHumiSHT31_ReadAsync(void* inst, GroveI2CBridge* bridge, GroveTempHumiSHT31_Callback callback, void* context)
+{
+	GroveTempHumiSHT31Instance* this = (GroveTempHumiSHT31Instance*)inst;
+
+	// read the measurement the previous call started and start the next, both in one UART write,
+	// so the conversion time passes between calls rather than in a sleep
+	GroveTempHumiSHT31_CollectAsync(this, bridge, callback, context);
+	if (!this->Periodic)
+	{
+		GroveTempHumiSHT31_StartAsync(this, bridge);
+	}
 }
 
 void GroveTempHumiSHT31_EnableHeater(void* inst)
@@ -3,8 +3,43 @@
 //WIKI_URL          http://wiki.seeedstudio.com/Grove-TempAndHumi_Sensor-SHT31/
 
 #pragma once
+#include "../HAL/GroveI2CBridge.h"
+
+#define GROVE_TEMP_HUMI_SHT31_MEASUREMENT_MS	20		// single shot, from start to collect at high repeatability
+
+// measurements per second in periodic mode, ART measures at 4 per second with a faster response
+typedef enum
+{
+	GROVE_TEMP_HUMI_SHT31_HALF_MPS,
+	GROVE_TEMP_HUMI_SHT31_1_MPS,
+	GROVE_TEMP_HUMI_SHT31_2_MPS,
+	GROVE_TEMP_HUMI_SHT31_4_MPS,
+	GROVE_TEMP_HUMI_SHT31_10_MPS,
+	GROVE_TEMP_HUMI_SHT31_ART
+}
+GroveTempHumiSHT31_Rate;
+
+typedef void (*GroveTempHumiSHT31_Callback)(void* inst, void* context);
+
 void* GroveTempHumiSHT31_Open(int i2cFd);
+// start and collect, sleeping through the conversion in single shot mode
 void GroveTempHumiSHT31_Read(void* inst);
+
+// the sensor measures on its own, each collect fetches the latest result without waiting. Collect no faster
+// than the rate, a fetch with no new result reads NAN
+void GroveTempHumiSHT31_StartPeriodic(void* inst, GroveTempHumiSHT31_Rate rate);
+void GroveTempHumiSHT31_StopPeriodic(void* inst);
+
+// single shot split in two, collect GROVE_TEMP_HUMI_SHT31_MEASUREMENT_MS after the start, from a one shot timer
+void GroveTempHumiSHT31_Start(void* inst);
+void GroveTempHumiSHT31_Collect(void* inst);
+
+// the same through the bridge, the callback runs from the event loop once the result is read
+void GroveTempHumiSHT31_StartAsync(void* inst, GroveI2CBridge* bridge);
+void GroveTempHumiSHT31_CollectAsync(void* inst, GroveI2CBridge* bridge, GroveTempHumiSHT31_Callback callback, void* context);
+// collect then start the next single shot in one UART write, so each call returns the measurement started by
+// the previous one, NAN after the first call since open
+void GroveTempHumiSHT31_ReadAsync(void* inst, GroveI2CBridge* bridge, GroveTempHumiSHT31_Callback callback, void* context);
 void GroveTempHumiSHT31_EnableHeater(void* inst);
 void GroveTempHumiSHT31_DisableHeater(void* inst);
 float GroveTempHumiSHT31_GetTemperature(void* inst);
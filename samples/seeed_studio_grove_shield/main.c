@@ -38,6 +38,7 @@
 
 // Learning Path Libraries
 #include "azure_iot.h"
+#include "event_loop.h"
 #include "exit_codes.h"
 #include "globals.h"
 #include "peripheral_gpio.h"
@@ -62,18 +63,22 @@
 // Required for Grove Sensors
 static int i2cFd;
 static void *sht31;
+static GroveI2CBridge *i2cBridge;
 
 #define JSON_MESSAGE_BYTES 256 // Number of bytes to allocate for the JSON telemetry message for IoT Central
 
 // Forward signatures
 static void LedOffHandler(EventLoopTimer *eventLoopTimer);
 static void MeasureSensorHandler(EventLoopTimer *eventLoopTimer);
+static void SensorCollectHandler(EventLoopTimer *eventLoopTimer);
+static void SensorReadHandler(void *inst, void *context);
 static void NetworkConnectionStatusHandler(EventLoopTimer *eventLoopTimer);
 static void DeviceTwinSetTemperatureHandler(LP_DEVICE_TWIN_BINDING *deviceTwinBinding);
 
 static char msgBuffer[JSON_MESSAGE_BYTES] = {0};
 
 static const struct timespec sendMsgLedBlinkPeriod = {0, 300 * 1000 * 1000};
+static const struct timespec sensorMeasurementPeriod = {0, GROVE_TEMP_HUMI_SHT31_MEASUREMENT_MS * 1000 * 1000};
 
 enum LEDS
 {
@@ -113,6 +118,7 @@ static LP_PERIPHERAL_GPIO *rgbLed[] = {&ledRed, &ledGreen, &ledBlue};
 static LP_TIMER sendMsgLedOffOneShotTimer = {.period = {0, 0}, .name = "sendMsgLedOffOneShotTimer", .handler = LedOffHandler};
 static LP_TIMER networkConnectionStatusTimer = {.period = {5, 0}, .name = "networkConnectionStatusTimer", .handler = NetworkConnectionStatusHandler};
 static LP_TIMER measureSensorTimer = {.period = {10, 0}, .name = "measureSensorTimer", .handler = MeasureSensorHandler};
+static LP_TIMER sensorCollectOneShotTimer = {.period = {0, 0}, .name = "sensorCollectOneShotTimer", .handler = SensorCollectHandler};
 
 // Azure IoT Device Twins
 static LP_DEVICE_TWIN_BINDING desiredTemperature = {.twinProperty = "DesiredTemperature", .twinType = LP_TYPE_FLOAT, .handler = DeviceTwinSetTemperatureHandler};
@@ -127,7 +133,7 @@ LP_PERIPHERAL_GPIO *peripheralGpioSet[] = {
 	&ledGreen,
 	&ledBlue,
 };
-LP_TIMER *timerSet[] = {&sendMsgLedOffOneShotTimer, &networkConnectionStatusTimer, &measureSensorTimer};
+LP_TIMER *timerSet[] = {&sendMsgLedOffOneShotTimer, &networkConnectionStatusTimer, &measureSensorTimer, &sensorCollectOneShotTimer};
 LP_DEVICE_TWIN_BINDING *deviceTwinBindingSet[] = {&desiredTemperature, &actualTemperature, &actualHvacState};
 
 // Message templates and property sets
@@ -216,22 +222,43 @@ void SetTemperatureStatusColour(float actual_temperature)
 }
 
 /// <summary>
-/// Read sensor and send to Azure IoT
+/// Start a single shot measurement, collected by a one shot timer once the conversion is done
 /// </summary>
 static void MeasureSensorHandler(EventLoopTimer *eventLoopTimer)
 {
-	static int msgId = 0;
-	int len = 0;
+	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
+	{
+		lp_terminate(ExitCode_ConsumeEventLoopTimeEvent);
+		return;
+	}
 
+	GroveTempHumiSHT31_StartAsync(sht31, i2cBridge);
+	lp_setOneShotTimer(&sensorCollectOneShotTimer, &sensorMeasurementPeriod);
+}
+
+/// <summary>
+/// Collect the measurement, the reading is sent from SensorReadHandler once the I2C bridge answers
+/// </summary>
+static void SensorCollectHandler(EventLoopTimer *eventLoopTimer)
+{
 	if (ConsumeEventLoopTimerEvent(eventLoopTimer) != 0)
 	{
 		lp_terminate(ExitCode_ConsumeEventLoopTimeEvent);
 		return;
 	}
 
-	GroveTempHumiSHT31_Read(sht31);
-	float temperature = GroveTempHumiSHT31_GetTemperature(sht31);
-	float humidity = GroveTempHumiSHT31_GetHumidity(sht31);
+	GroveTempHumiSHT31_CollectAsync(sht31, i2cBridge, SensorReadHandler, NULL);
+}
+
+/// <summary>
+/// Send the reading to Azure IoT, runs from the event loop
+/// </summary>
+static void SensorReadHandler(void *inst, void *context)
+{
+	static int msgId = 0;
+
+	float temperature = GroveTempHumiSHT31_GetTemperature(inst);
+	float humidity = GroveTempHumiSHT31_GetHumidity(inst);
 	if (isnan(temperature) || isnan(humidity))
 	{
 		return;
@@ -277,8 +304,10 @@ static void DeviceTwinSetTemperatureHandler(LP_DEVICE_TWIN_BINDING *deviceTwinBi
 static void InitPeripheralsAndHandlers(void)
 {
 	// Initialize Grove Shield and Grove Temperature and Humidity Sensor
-	GroveShield_Initialize(&i2cFd, 115200);
+	uint32_t baudrate = GroveShield_Initialize(&i2cFd, GROVE_SHIELD_BAUDRATE_AUTO);
+	Log_Debug("Grove shield bridge at %u baud\n", baudrate);
 	sht31 = GroveTempHumiSHT31_Open(i2cFd);
+	i2cBridge = GroveI2CBridge_Open(i2cFd, lp_getTimerEventLoop());	// sensor reads from here on queue on the event loop
 
 	lp_openPeripheralGpioSet(peripheralGpioSet, NELEMS(peripheralGpioSet));
 	lp_openDeviceTwinSet(deviceTwinBindingSet, NELEMS(deviceTwinBindingSet));
@@ -297,6 +326,8 @@ static void ClosePeripheralsAndHandlers(void)
 	lp_stopTimerSet();
 	lp_stopCloudToDevice();
 
+	GroveI2CBridge_Close(i2cBridge);
+
 	lp_closePeripheralGpioSet();
 	lp_closeDeviceTwinSet();
 
@@ -317,15 +348,7 @@ int main(int argc, char *argv[])
 	InitPeripheralsAndHandlers();
 
 	// Main loop
-	while (!lp_isTerminationRequired())
-	{
-		int result = EventLoop_Run(lp_getTimerEventLoop(), -1, true);
-		// Continue if interrupted by signal, e.g. due to breakpoint being set.
-		if (result == -1 && errno != EINTR)
-		{
-			lp_terminate(ExitCode_Main_EventLoopFail);
-		}
-	}
+	lp_runEventLoop();
 
 	ClosePeripheralsAndHandlers();
 
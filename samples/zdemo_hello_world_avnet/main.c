@@ -39,6 +39,7 @@
 
 // Learning Path Libraries
 #include "azure_iot.h"
+#include "event_loop.h"
 #include "exit_codes.h"
 #include "globals.h"
 #include "peripheral_gpio.h"
@@ -121,15 +122,7 @@ int main(int argc, char* argv[]) {
 	InitPeripheralsAndHandlers();
 
 	// Main loop
-	while (!lp_isTerminationRequired()) {
-
-		int result = EventLoop_Run(lp_getTimerEventLoop(), -1, true);
-
-		// Continue if interrupted by signal, e.g. due to breakpoint being set.
-		if (result == -1 && errno != EINTR) {
-			lp_terminate(ExitCode_Main_EventLoopFail);
-		}
-	}
+	lp_runEventLoop();
 
 	ClosePeripheralsAndHandlers();
 
@@ -0,0 +1,347 @@
+"""Build the int8 anomaly model the real-time apps score IMU feature windows with.
+
+The model is an autoencoder over the six features the real-time app computes for each IMU DSP window, the RMS
+and band RMS of the accelerometer x, y and z, see LearningPathLibrary/shared/anomaly_model_format.h for the blob
+and LearningPathLibrary/rtcore/anomaly_model.h for where it runs. It is trained here on windows of normal
+running, learns to reconstruct them, and scores a window by how badly it does.
+
+Features come from the real-time app's UART log, built with ANOMALY_MODEL_CAPTURE it prints every window as
+
+    anomaly features 212 198 305 41 37 52        # hundredths of mg, x y z RMS then x y z band RMS
+
+or from a CSV of six columns in mg. Training needs numpy, see requirements.txt, the rest does not.
+
+    python build_anomaly_model.py --train uart.log --hidden 8,3,8 --version 2 -o model.bin
+    python build_anomaly_model.py --check model.bin --score uart.log
+    python build_anomaly_model.py --baseline --mean 2,2,2,0.5,0.5,0.5 --std 1,1,1,0.5,0.5,0.5 --threshold 9 --c-array
+
+The threshold is the --percentile of the scores of the training windows, times --margin, the scores worked out
+with the same integer arithmetic the M4 uses. Send the blob as a cloud to device message with the property
+type=AnomalyModel, split into parts when it is larger than one message allows:
+
+    az iot device c2d-message send -n myhub -d mydevice --props "type=AnomalyModel" --data-file-path model.bin
+"""
+
+import argparse
+import csv
+import math
+import struct
+import sys
+
+MAGIC = b"LPAM"
+FORMAT = 1
+FEATURES = 6
+MAX_LAYERS = 4
+MAX_WIDTH = 32
+MAX_SIZE = 2048
+LINEAR, RELU = 0, 1
+CAPTURE_PREFIX = "anomaly features"
+CAPTURE_SCALE = 100.0       # hundredths of mg
+
+
+def checksum(data):
+    """FNV-1a, the blob's trailer"""
+    value = 2166136261
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def quantize_multiplier(real):
+    """q31 multiplier and shift of a positive rescale, as CMSIS-NN keeps them"""
+    if real <= 0:
+        return 0, 0
+    mantissa, exponent = math.frexp(real)
+    multiplier = int(round(mantissa * (1 << 31)))
+    if multiplier == 1 << 31:
+        multiplier //= 2
+        exponent += 1
+    if exponent < -31 or exponent > 30:
+        raise ValueError(f"rescale {real} out of range")
+    return multiplier, exponent
+
+
+def build_blob(model):
+    """The model dict as the M4 reads it"""
+    out = bytearray(MAGIC)
+    out += struct.pack("<BBBbHHfff", FORMAT, len(model["mean"]), len(model["layers"]), model["input_zero_point"],
+                       model["version"], 0, model["input_scale"], model["threshold"], model["hysteresis"])
+    for mean, gain in zip(model["mean"], model["gain"]):
+        out += struct.pack("<ff", mean, gain)
+    for layer in model["layers"]:
+        out += struct.pack("<BBbbi", len(layer["bias"]), layer["activation"], layer["out_zero_point"], layer["shift"],
+                           layer["multiplier"])
+        out += struct.pack(f"<{len(layer['bias'])}i", *layer["bias"])
+        for row in layer["weights"]:
+            out += struct.pack(f"<{len(row)}b", *row)
+    out += struct.pack("<I", checksum(out))
+    if len(out) > MAX_SIZE:
+        raise ValueError(f"model of {len(out)} bytes, the M4 holds {MAX_SIZE}")
+    return bytes(out)
+
+
+def parse_blob(blob):
+    """The model dict of a blob, ValueError where lp_anomalyModelParse would refuse it"""
+    if len(blob) < 28 or len(blob) > MAX_SIZE or blob[:4] != MAGIC or blob[4] != FORMAT:
+        raise ValueError("not an anomaly model of this format")
+    if struct.unpack_from("<I", blob, len(blob) - 4)[0] != checksum(blob[:-4]):
+        raise ValueError("checksum does not match")
+    _, inputs, layers, zero_point, version, _, scale, threshold, hysteresis = struct.unpack_from("<BBBbHHfff", blob, 4)
+    if not 0 < inputs <= MAX_WIDTH or not 0 < layers <= MAX_LAYERS or not scale > 0 or not threshold > 0 or \
+            not 0 <= hysteresis <= threshold:
+        raise ValueError("header out of range")
+    model = {"version": version, "input_zero_point": zero_point, "input_scale": scale, "threshold": threshold,
+             "hysteresis": hysteresis, "mean": [], "gain": [], "layers": []}
+    offset = 28 - 4
+    for _ in range(inputs):
+        mean, gain = struct.unpack_from("<ff", blob, offset)
+        model["mean"].append(mean)
+        model["gain"].append(gain)
+        offset += 8
+    width, in_zero_point = inputs, zero_point
+    for _ in range(layers):
+        if offset + 8 > len(blob) - 4:
+            raise ValueError("truncated")
+        outputs, activation, out_zero_point, shift, multiplier = struct.unpack_from("<BBbbi", blob, offset)
+        offset += 8
+        if not 0 < outputs <= MAX_WIDTH or activation > RELU or not -31 <= shift <= 30 or multiplier < 0:
+            raise ValueError("layer out of range")
+        if offset + 4 * outputs + outputs * width > len(blob) - 4:
+            raise ValueError("truncated")
+        bias = list(struct.unpack_from(f"<{outputs}i", blob, offset))
+        offset += 4 * outputs
+        weights = [list(struct.unpack_from(f"<{width}b", blob, offset + i * width)) for i in range(outputs)]
+        offset += outputs * width
+        model["layers"].append({"activation": activation, "in_zero_point": in_zero_point, "out_zero_point": out_zero_point,
+                                "shift": shift, "multiplier": multiplier, "bias": bias, "weights": weights})
+        width, in_zero_point = outputs, out_zero_point
+    if offset != len(blob) - 4 or width != inputs or in_zero_point != zero_point:
+        raise ValueError("layers do not reconstruct the inputs")
+    return model
+
+
+def saturate(value):
+    return max(-128, min(127, value))
+
+
+def requantize(acc, multiplier, shift):
+    total_shift = 31 - shift
+    return (acc * multiplier + (1 << (total_shift - 1))) >> total_shift
+
+
+def quantize_inputs(model, features):
+    out = []
+    for x, mean, gain in zip(features, model["mean"], model["gain"]):
+        z = max(-256.0, min(256.0, (x - mean) * gain / model["input_scale"]))
+        out.append(saturate(int(round(z)) + model["input_zero_point"]))
+    return out
+
+
+def score(model, features):
+    """The window's score as anomaly_model_score works it out"""
+    quantized = quantize_inputs(model, features)
+    values = quantized
+    for layer in model["layers"]:
+        low = layer["out_zero_point"] if layer["activation"] == RELU else -128
+        out = []
+        for row, bias in zip(layer["weights"], layer["bias"]):
+            acc = bias + sum(w * (v - layer["in_zero_point"]) for w, v in zip(row, values))
+            acc = (acc + (1 << 31)) % (1 << 32) - (1 << 31)     # SMLAD wraps at 32 bits
+            value = requantize(acc, layer["multiplier"], layer["shift"]) + layer["out_zero_point"]
+            out.append(max(low, min(127, value)))
+        values = out
+    error = sum((v - q) ** 2 for v, q in zip(values, quantized))
+    return error / len(quantized) * model["input_scale"] ** 2
+
+
+def read_features(path):
+    """Feature windows, a list of FEATURES floats each, from a UART log or a CSV in mg"""
+    windows = []
+    stream = sys.stdin if path == "-" else open(path, encoding="utf-8", errors="replace")
+    with stream:
+        text = stream.read()
+    if CAPTURE_PREFIX in text:
+        for line in text.splitlines():
+            _, found, rest = line.partition(CAPTURE_PREFIX)
+            values = rest.split()
+            if found and len(values) == FEATURES:
+                windows.append([int(v) / CAPTURE_SCALE for v in values])
+        return windows
+    for row in csv.reader(text.splitlines()):
+        try:
+            values = [float(v) for v in row]
+        except ValueError:
+            continue        # header
+        if len(values) == FEATURES:
+            windows.append(values)
+    return windows
+
+
+def input_quantization(input_range):
+    """Scale and zero point of z from -input_range up to input_range, a window further out saturates"""
+    return 2.0 * input_range / 255, 0
+
+
+def baseline(mean, std, threshold, hysteresis, version, input_range):
+    """One layer of zero weights, every window is reconstructed as the mean, the score is the mean squared z score"""
+    scale, zero_point = input_quantization(input_range)
+    multiplier, shift = quantize_multiplier(1.0)
+    return {"version": version, "input_zero_point": zero_point, "input_scale": scale, "threshold": threshold,
+            "hysteresis": hysteresis, "mean": list(mean), "gain": [1.0 / s for s in std],
+            "layers": [{"activation": LINEAR, "out_zero_point": zero_point, "shift": shift, "multiplier": multiplier,
+                        "bias": [0] * len(mean), "weights": [[0] * len(mean) for _ in mean]}]}
+
+
+def train(windows, hidden, epochs, rate, seed):
+    """Float autoencoder on the z scored windows, ReLU hidden layers and a linear output, full batch Adam"""
+    import numpy as np
+
+    data = np.array(windows, dtype=np.float64)
+    mean = data.mean(axis=0)
+    std = np.maximum(data.std(axis=0), 1e-3)
+    z = (data - mean) / std
+    widths = [FEATURES] + hidden + [FEATURES]
+    rng = np.random.default_rng(seed)
+    params = []
+    for n, m in zip(widths[:-1], widths[1:]):
+        params.append([rng.normal(0, math.sqrt(2.0 / n), (m, n)), np.zeros(m)])
+    moments = [[np.zeros_like(p) for p in layer] for layer in params]
+    squares = [[np.zeros_like(p) for p in layer] for layer in params]
+
+    for step in range(1, epochs + 1):
+        activations = [z]
+        for i, (w, b) in enumerate(params):
+            a = activations[-1] @ w.T + b
+            activations.append(a if i == len(params) - 1 else np.maximum(a, 0))
+        grad = 2 * (activations[-1] - z) / z.size
+        for i in reversed(range(len(params))):
+            w, b = params[i]
+            if i < len(params) - 1:
+                grad = grad * (activations[i + 1] > 0)
+            grads = [grad.T @ activations[i], grad.sum(axis=0)]
+            grad = grad @ w
+            for p, g, mo, sq in zip(params[i], grads, moments[i], squares[i]):
+                mo *= 0.9
+                mo += 0.1 * g
+                sq *= 0.999
+                sq += 0.001 * g * g
+                p -= rate * (mo / (1 - 0.9 ** step)) / (np.sqrt(sq / (1 - 0.999 ** step)) + 1e-8)
+
+    loss = float(np.mean((activations[-1] - z) ** 2))
+    return mean.tolist(), std.tolist(), params, z, loss
+
+
+def quantize(mean, std, params, z, version, input_range):
+    """Post-training int8 quantization, hidden layer ranges calibrated on the training windows"""
+    import numpy as np
+
+    scale, zero_point = input_quantization(input_range)
+    layers = []
+    in_scale, in_zero_point = scale, zero_point
+    activations = z
+    for i, (w, b) in enumerate(params):
+        last = i == len(params) - 1
+        activations = activations @ w.T + b
+        if last:
+            out_scale, out_zero_point = scale, zero_point
+        else:
+            activations = np.maximum(activations, 0)
+            high = max(float(activations.max()), 1e-6)
+            out_scale, out_zero_point = high / 255, -128
+        weight_scale = max(float(np.abs(w).max()), 1e-9) / 127
+        multiplier, shift = quantize_multiplier(in_scale * weight_scale / out_scale)
+        layers.append({"activation": LINEAR if last else RELU, "out_zero_point": out_zero_point, "shift": shift,
+                       "multiplier": multiplier,
+                       "bias": [int(round(v / (in_scale * weight_scale))) for v in b],
+                       "weights": [[saturate(int(round(v / weight_scale))) for v in row] for row in w]})
+        in_scale, in_zero_point = out_scale, out_zero_point
+    return {"version": version, "input_zero_point": zero_point, "input_scale": scale, "threshold": 1.0,
+            "hysteresis": 0.0, "mean": list(mean), "gain": [1.0 / s for s in std], "layers": layers}
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    rank = min(len(ordered) - 1, max(0, int(math.ceil(p / 100.0 * len(ordered))) - 1))
+    return ordered[rank]
+
+
+def floats(text):
+    return [float(v) for v in text.split(",")]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    mode = parser.add_mutually_exclusive_group(required=True)
+    mode.add_argument("--train", metavar="FEATURES", help="UART log or CSV of normal windows, - for stdin")
+    mode.add_argument("--baseline", action="store_true", help="no training, the mean squared z score of --mean and --std")
+    mode.add_argument("--check", metavar="BLOB", help="check a model and print what it holds")
+    parser.add_argument("-o", "--output", help="blob to write")
+    parser.add_argument("--c-array", action="store_true", help="print the blob as C bytes, for the default in the image")
+    parser.add_argument("--version", type=int, default=1, help="model version, reported with its scores")
+    parser.add_argument("--hidden", default="8,3,8", help="hidden layer widths")
+    parser.add_argument("--epochs", type=int, default=2000)
+    parser.add_argument("--rate", type=float, default=0.01, help="Adam learning rate")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--input-range", type=float, default=8.0, help="z scores quantized without saturating")
+    parser.add_argument("--percentile", type=float, default=99.5, help="of the training scores, the threshold")
+    parser.add_argument("--margin", type=float, default=1.5, help="threshold times the percentile")
+    parser.add_argument("--threshold", type=float, help="in place of the calibrated threshold")
+    parser.add_argument("--hysteresis", type=float, default=0.2, help="share of the threshold the score falls back to clear")
+    parser.add_argument("--mean", type=floats, help="--baseline feature means, mg")
+    parser.add_argument("--std", type=floats, help="--baseline feature deviations, mg")
+    parser.add_argument("--score", metavar="FEATURES", help="score these windows with the model, --check")
+    args = parser.parse_args()
+
+    if args.check:
+        with open(args.check, "rb") as f:
+            blob = f.read()
+        model = parse_blob(blob)
+    elif args.baseline:
+        if args.mean is None or args.std is None or len(args.mean) != FEATURES or len(args.std) != FEATURES:
+            parser.error(f"--baseline takes --mean and --std of {FEATURES} values")
+        threshold = args.threshold if args.threshold is not None else 9.0
+        model = baseline(args.mean, args.std, threshold, threshold * args.hysteresis, args.version, args.input_range)
+    else:
+        windows = read_features(args.train)
+        hidden = [int(v) for v in args.hidden.split(",") if v]
+        if len(windows) < 10:
+            parser.error(f"{len(windows)} feature windows in {args.train}, train on many more")
+        if len(hidden) + 1 > MAX_LAYERS or any(not 0 < h <= MAX_WIDTH for h in hidden):
+            parser.error(f"at most {MAX_LAYERS - 1} hidden layers of up to {MAX_WIDTH}")
+        mean, std, params, z, loss = train(windows, hidden, args.epochs, args.rate, args.seed)
+        model = quantize(mean, std, params, z, args.version, args.input_range)
+        scores = [score(model, w) for w in windows]
+        threshold = args.threshold if args.threshold is not None else max(percentile(scores, args.percentile) * args.margin, 1e-3)
+        model["threshold"] = threshold
+        model["hysteresis"] = threshold * args.hysteresis
+        print(f"{len(windows)} windows, float loss {loss:.4f}, quantized score median {percentile(scores, 50):.4f}, "
+              f"p{args.percentile:g} {percentile(scores, args.percentile):.4f}, threshold {threshold:.4f}", file=sys.stderr)
+
+    if not args.check:
+        blob = build_blob(model)
+        parse_blob(blob)        # as the device will
+
+    layers = " ".join(f"{len(layer['weights'][0])}->{len(layer['weights'])}" for layer in model["layers"])
+    print(f"model version {model['version']}, {len(blob)} bytes, layers {layers}, threshold {model['threshold']:.4f} "
+          f"hysteresis {model['hysteresis']:.4f}", file=sys.stderr)
+
+    if args.score:
+        windows = read_features(args.score)
+        scores = [score(model, w) for w in windows]
+        over = sum(1 for s in scores if s >= model["threshold"])
+        for s in scores:
+            print(f"{s:.4f}")
+        if scores:
+            print(f"{len(scores)} windows, {over} at or over the threshold, highest {max(scores):.4f}", file=sys.stderr)
+
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(blob)
+
+    if args.c_array:
+        for i in range(0, len(blob), 16):
+            print("\t" + " ".join(f"0x{b:02x}," for b in blob[i:i + 16]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,294 @@
+"""Generate typed telemetry structs, allocation free serializers and device twin bindings
+from an IoT Central device capability model (DCM).
+
+    python dcm_codegen.py --dcm <model.json> --out <path/without/extension> [--prefix dcm]
+
+Writes <out>.h and <out>.c. Telemetry is serialized as a fixed sequence of appends into a
+caller buffer of at least <PREFIX>_TELEMETRY_MAX_BYTES, there is no format string parsing at runtime.
+The compact serializer writes the same document with the short keys of the model's telemetry dictionary,
+see README.md, the keys and dictionary version follow from the telemetry names and schemas alone.
+"""
+
+import argparse
+import json
+import os
+import re
+
+# DCM schema -> (C type, LP_DEVICE_TWIN_TYPE, maximum serialized value length)
+SCHEMAS = {
+    "float": ("float", "LP_TYPE_FLOAT", None),
+    "double": ("float", "LP_TYPE_FLOAT", None),
+    "integer": ("int", "LP_TYPE_INT", 11),
+    "long": ("int", "LP_TYPE_INT", 11),
+    "boolean": ("bool", "LP_TYPE_BOOL", 5),
+    "string": ("const char*", "LP_TYPE_STRING", None),
+}
+
+APPENDERS = {"float": "AppendFloat", "double": "AppendFloat", "integer": "AppendInt", "long": "AppendInt",
+             "boolean": "AppendBool", "string": "AppendString"}
+
+# C appenders emitted into the generated source when the model uses them, in dependency order
+HELPERS = [
+    ("AppendLiteral", """static char* AppendLiteral(char* out, const char* literal, size_t length) {
+	memcpy(out, literal, length);
+	return out + length;
+}
+"""),
+    ("AppendUnsigned", """static char* AppendUnsigned(char* out, unsigned long value, int minDigits) {
+	char digits[10];
+	int count = 0;
+
+	do {
+		digits[count++] = (char)('0' + value % 10);
+		value /= 10;
+	} while ((value > 0 || count < minDigits) && count < (int)sizeof(digits));
+
+	while (count > 0) {
+		*out++ = digits[--count];
+	}
+	return out;
+}
+"""),
+    ("AppendInt", """static char* AppendInt(char* out, int value) {
+	if (value < 0) {
+		*out++ = '-';
+		return AppendUnsigned(out, 0UL - (unsigned long)value, 1);
+	}
+	return AppendUnsigned(out, (unsigned long)value, 1);
+}
+"""),
+    ("AppendFloat", """/// <summary>
+///     Fixed point with PREFIX_FLOAT_DECIMALS fraction digits, magnitudes past 999999999 are clamped and NaN is written as null
+/// </summary>
+static char* AppendFloat(char* out, float value) {
+	static const float scale[] = { 1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f, 100000.0f, 1000000.0f };
+	unsigned long whole, fraction;
+	float rounded;
+
+	if (value != value) {
+		return AppendLiteral(out, "null", 4);
+	}
+	if (value < 0) {
+		*out++ = '-';
+		value = -value;
+	}
+	if (value > 999999999.0f) {
+		value = 999999999.0f;
+	}
+
+	rounded = value + 0.5f / scale[PREFIX_FLOAT_DECIMALS];
+	whole = (unsigned long)rounded;
+	fraction = (unsigned long)((rounded - (float)whole) * scale[PREFIX_FLOAT_DECIMALS]);
+	out = AppendUnsigned(out, whole, 1);
+	if (PREFIX_FLOAT_DECIMALS > 0) {
+		*out++ = '.';
+		out = AppendUnsigned(out, fraction, PREFIX_FLOAT_DECIMALS);
+	}
+	return out;
+}
+"""),
+    ("AppendBool", """static char* AppendBool(char* out, bool value) {
+	return value ? AppendLiteral(out, "true", 4) : AppendLiteral(out, "false", 5);
+}
+"""),
+    ("AppendString", """static char* AppendString(char* out, const char* value) {
+	static const char hex[] = "0123456789abcdef";
+	size_t length = 0;
+
+	*out++ = '"';
+	for (; value != NULL && *value != 0 && length < PREFIX_MAX_STRING; value++, length++) {
+		unsigned char c = (unsigned char)*value;
+		if (c == '"' || c == '\\\\') {
+			*out++ = '\\\\';
+			*out++ = (char)c;
+		} else if (c < 0x20) {
+			out = AppendLiteral(out, "\\\\u00", 4);
+			*out++ = hex[c >> 4];
+			*out++ = hex[c & 0xF];
+		} else {
+			*out++ = (char)c;
+		}
+	}
+	*out++ = '"';
+	return out;
+}
+"""),
+]
+
+
+def compact_keys(telemetry):
+    """Short keys in template order, a to z then aa, ab and on"""
+    letters = "abcdefghijklmnopqrstuvwxyz"
+    keys = []
+    for index in range(len(telemetry)):
+        key = ""
+        index += 1
+        while index > 0:
+            index, digit = divmod(index - 1, 26)
+            key = letters[digit] + key
+        keys.append(key)
+    return keys
+
+
+def dictionary_version(telemetry):
+    """FNV-1a of the names and schemas in order, so any change to the telemetry is a new dictionary"""
+    value = 0x811C9DC5
+    for byte in ";".join("%s:%s" % item for item in telemetry).encode("utf-8"):
+        value = ((value ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return "%08x" % value
+
+
+def dictionary(telemetry):
+    """The dictionary as tools/telemetry-dictionary reads it"""
+    return {"version": dictionary_version(telemetry), "keys": dict(zip(compact_keys(telemetry), (name for name, _ in telemetry)))}
+
+
+def dictionary_text(telemetry):
+    """The reported twin property form, "<version> a:Name,b:Name", telemetry names need no escaping in it"""
+    return "%s %s" % (dictionary_version(telemetry), ",".join("%s:%s" % (key, name) for key, (name, _) in zip(compact_keys(telemetry), telemetry)))
+
+
+def c_identifier(name):
+    identifier = re.sub(r"[^0-9A-Za-z_]", "_", name)
+    return "_" + identifier if identifier[0].isdigit() else identifier
+
+
+def types_of(content):
+    kinds = content.get("@type", [])
+    return [kinds] if isinstance(kinds, str) else kinds
+
+
+def load_model(path):
+    with open(path, encoding="utf-8-sig") as f:
+        model = json.load(f)
+
+    telemetry, properties = [], []
+    for interface in model.get("implements", []):
+        for content in interface.get("schema", {}).get("contents", []):
+            schema = content.get("schema")
+            if not isinstance(schema, str) or schema not in SCHEMAS:
+                continue  # complex schemas and commands are not generated
+            kinds = types_of(content)
+            if "Telemetry" in kinds:
+                telemetry.append((content["name"], schema))
+            elif "Property" in kinds:
+                properties.append((content["name"], schema, bool(content.get("writable"))))
+    return telemetry, properties
+
+
+def value_length(schema, decimals, max_string):
+    length = SCHEMAS[schema][2]
+    if schema in ("float", "double"):
+        return 1 + 10 + 1 + decimals  # sign, integer digits (clamped to 1e9 as a float), point, fraction
+    if schema == "string":
+        return 2 + 6 * max_string  # quotes and worst case \u00XX escapes
+    return length
+
+
+def max_bytes(telemetry, keys, decimals, max_string):
+    total = 3  # braces and terminator
+    for (_, schema), key in zip(telemetry, keys):
+        total += len(key) + 4 + value_length(schema, decimals, max_string)  # quotes, colon, comma
+    return total
+
+
+def serializer(function, upper, max_define, telemetry, keys):
+    body = []
+    body.append("size_t %s(const %s_TELEMETRY* telemetry, char* buffer, size_t capacity) {" % (function, upper))
+    body.append("\tchar* out = buffer;\n")
+    body.append("\tif (telemetry == NULL || buffer == NULL || capacity < %s) {" % max_define)
+    body.append("\t\treturn 0;")
+    body.append("\t}\n")
+    for index, ((name, schema), key) in enumerate(zip(telemetry, keys)):
+        literal = ('{' if index == 0 else ',') + '\\"%s\\":' % key
+        body.append('\tout = AppendLiteral(out, "%s", %d);' % (literal, len(key) + 4))
+        body.append("\tout = %s(out, telemetry->%s);" % (APPENDERS[schema], c_identifier(name)))
+    if not telemetry:
+        body.append("\t*out++ = '{';")
+    body.append("\t*out++ = '}';")
+    body.append("\t*out = 0;\n")
+    body.append("\treturn (size_t)(out - buffer);")
+    body.append("}\n")
+    return body
+
+
+def generate(telemetry, properties, prefix, decimals, max_string, header_name, source):
+    upper = prefix.upper()
+    names = [name for name, _ in telemetry]
+    keys = compact_keys(telemetry)
+
+    header = []
+    header.append("#pragma once\n")
+    header.append("// Generated by tools/dcm-codegen/dcm_codegen.py from %s, do not edit\n" % os.path.basename(source))
+    header.append('#include "device_twins.h"\n#include <stdbool.h>\n#include <stddef.h>\n')
+    header.append("#define %s_TELEMETRY_MAX_BYTES %d\t\t// largest serialized telemetry document including the terminator" % (upper, max_bytes(telemetry, names, decimals, max_string)))
+    header.append("#define %s_TELEMETRY_COMPACT_MAX_BYTES %d\t// the same with the dictionary's short keys" % (upper, max_bytes(telemetry, keys, decimals, max_string)))
+    header.append("#define %s_DICTIONARY_VERSION \"%s\"\t// sent as the dict message property with compact telemetry" % (upper, dictionary_version(telemetry)))
+    header.append("#define %s_FLOAT_DECIMALS %d" % (upper, decimals))
+    header.append("#define %s_MAX_STRING %d\t\t\t\t// longer telemetry strings are truncated\n" % (upper, max_string))
+    header.append("typedef struct %s_TELEMETRY\n{" % upper)
+    for name, schema in telemetry:
+        header.append("\t%s %s;" % (SCHEMAS[schema][0], c_identifier(name)))
+    header.append("} %s_TELEMETRY;\n" % upper)
+    header.append("size_t %s_serializeTelemetry(const %s_TELEMETRY* telemetry, char* buffer, size_t capacity);" % (prefix, upper))
+    header.append("size_t %s_serializeTelemetryCompact(const %s_TELEMETRY* telemetry, char* buffer, size_t capacity);" % (prefix, upper))
+    header.append("extern const char %s_telemetryDictionary[];\t// <version> a:Name,b:Name, report it once as a string property\n" % prefix)
+    for name, schema, writable in properties:
+        header.append("extern LP_DEVICE_TWIN_BINDING %s_%s;%s" % (prefix, c_identifier(name), "\t\t// writable" if writable else ""))
+    header.append("")
+
+    used = set(APPENDERS[schema] for _, schema in telemetry)
+    if used & {"AppendInt", "AppendFloat"}:
+        used.add("AppendUnsigned")
+
+    body = []
+    body.append("// Generated by tools/dcm-codegen/dcm_codegen.py from %s, do not edit\n" % os.path.basename(source))
+    body.append('#include "%s"\n#include <string.h>\n' % header_name)
+    for helper, text in HELPERS:
+        if helper == "AppendLiteral" or helper in used:
+            body.append(text.replace("PREFIX_", upper + "_"))
+
+    body.append("/// <summary>")
+    body.append("///     Serialize telemetry into buffer, returns the length written or 0 when capacity is below %s_TELEMETRY_MAX_BYTES" % upper)
+    body.append("/// </summary>")
+    body.extend(serializer("%s_serializeTelemetry" % prefix, upper, "%s_TELEMETRY_MAX_BYTES" % upper, telemetry, names))
+
+    body.append("/// <summary>")
+    body.append("///     As %s_serializeTelemetry with the short keys of %s_telemetryDictionary, capacity at least %s_TELEMETRY_COMPACT_MAX_BYTES" % (prefix, prefix, upper))
+    body.append("/// </summary>")
+    body.extend(serializer("%s_serializeTelemetryCompact" % prefix, upper, "%s_TELEMETRY_COMPACT_MAX_BYTES" % upper, telemetry, keys))
+
+    body.append('const char %s_telemetryDictionary[] = "%s";\n' % (prefix, dictionary_text(telemetry)))
+
+    for name, schema, writable in properties:
+        body.append('LP_DEVICE_TWIN_BINDING %s_%s = { .twinProperty = "%s", .twinType = %s };' % (prefix, c_identifier(name), name, SCHEMAS[schema][1]))
+
+    return "\n".join(header) + "\n", "\n".join(body) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--dcm", required=True, help="IoT Central device capability model")
+    parser.add_argument("--out", required=True, help="output path without extension")
+    parser.add_argument("--prefix", default="dcm", help="prefix for generated functions and types")
+    parser.add_argument("--decimals", type=int, default=2, choices=range(0, 7), help="float fraction digits")
+    parser.add_argument("--max-string", type=int, default=32, help="longest telemetry string")
+    parser.add_argument("--dictionary", help="also write the telemetry dictionary as JSON, for the cloud side expander")
+    args = parser.parse_args()
+
+    telemetry, properties = load_model(args.dcm)
+    header_name = os.path.basename(args.out) + ".h"
+    header, body = generate(telemetry, properties, args.prefix, args.decimals, args.max_string, header_name, args.dcm)
+
+    for path, text in ((args.out + ".h", header), (args.out + ".c", body)):
+        with open(path, "w", encoding="utf-8", newline="\n") as f:
+            f.write(text)
+
+    if args.dictionary:
+        with open(args.dictionary, "w", encoding="utf-8", newline="\n") as f:
+            json.dump(dictionary(telemetry), f, indent=2)
+            f.write("\n")
+
+
+if __name__ == "__main__":
+    main()
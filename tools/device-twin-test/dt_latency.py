@@ -0,0 +1,193 @@
+"""Cloud to actuator control latency benchmark.
+
+Changes a desired control property one patch at a time and splits the time until the device
+applies it into stages, from the reports a Learning Path app writes with lp_enableControlLatency.
+Each change waits for its report, or --timeout, before the next is sent, so the stages measure
+one control in flight rather than a queue.
+
+    DEVICE_TWIN_HUB_NAME=myhub DEVICE_TWIN_AUTHORIZATION="SharedAccessSignature sr=..." \
+        python dt_latency.py --properties LedBlinkRate,Relay1 --count 200 --csv controls.csv
+
+The device defaults to DEVICE_TWIN_DEVICE_ID, as used by dt.py. Set controlLatencyProperty in
+Lab 7's main.c to "ControlLatency", or pass --report with the name the app uses.
+
+Stages, in milliseconds:
+    patch       the REST PATCH round trip, this machine to the hub and back
+    hub         the hub's desired $lastUpdated to lp_twinCallback on the device, needs the device
+                clock in step with the hub, NTP usually is to a few ms
+    dispatch    lp_twinCallback to the GPIO written, or to the request sent to the real-time app
+    transport   one way inter-core, real-time app controls only
+    actuate     the request arriving on the real-time app to the control applied
+    total       hub + dispatch, and + transport + actuate for real-time app controls
+"""
+
+import argparse
+import csv
+import json
+import os
+import statistics
+import time
+from datetime import datetime, timezone
+
+import requests
+
+API_VERSION = "2018-06-30"
+STAGES = ["patch", "hub", "dispatch", "transport", "actuate", "total"]
+
+
+def twin_url(hub_name, device_id):
+    return f"https://{hub_name}.azure-devices.net/twins/{device_id}?api-version={API_VERSION}"
+
+
+def parse_hub_time(text):
+    """IoT Hub $lastUpdated, seven fraction digits which fromisoformat does not take"""
+    if not text:
+        return None
+    main, _, fraction = text.rstrip("Z").partition(".")
+    stamp = datetime.fromisoformat(main).replace(tzinfo=timezone.utc).timestamp()
+    return stamp + (float("0." + fraction) if fraction else 0.0)
+
+
+def parse_report(text):
+    """v=12;received=1760000000123;dispatch=850... to a dict of ints"""
+    fields = {}
+    for field in (text or "").split(";"):
+        key, _, value = field.partition("=")
+        if value.isdigit():
+            fields[key] = int(value)
+    return fields
+
+
+def next_value(name, index):
+    # Relay1 is a bool binding, anything else is taken as an int, LedBlinkRate steps through its rates
+    if name == "Relay1":
+        return index % 2 == 0
+    return index % 5
+
+
+def desired_state(twin, name):
+    desired = twin.get("properties", {}).get("desired", {})
+    updated = desired.get("$metadata", {}).get(name, {}).get("$lastUpdated")
+    return desired.get("$version"), parse_hub_time(updated)
+
+
+def wait_for_report(session, url, args, name, version):
+    """The report for this desired $version, or None once --timeout has passed"""
+    deadline = time.monotonic() + args.timeout
+    while time.monotonic() < deadline:
+        response = session.get(url)
+        if response.status_code == 200:
+            reported = response.json().get("properties", {}).get("reported", {})
+            report = parse_report((reported.get(args.report) or {}).get(name))
+            # a later version answers too, the device applied the newest the hub had
+            if report.get("v", 0) >= version:
+                return report
+        time.sleep(args.poll_interval)
+    return None
+
+
+def measure(session, url, args, name, value):
+    body = json.dumps({"properties": {"desired": {name: {"value": value}}}})
+    started = time.monotonic()
+    response = session.patch(url, data=body)
+    patch_ms = (time.monotonic() - started) * 1000
+    if response.status_code != 200:
+        return {"error": f"patch {response.status_code}"}
+
+    version, updated_at = desired_state(response.json(), name)
+    if version is None:
+        return {"error": "no desired $version"}
+
+    report = wait_for_report(session, url, args, name, version)
+    if report is None:
+        return {"error": "no report"}
+    if report.get("timeout"):
+        return {"error": "real-time app did not answer"}
+
+    sample = {"patch": patch_ms, "dispatch": report["dispatch"] / 1000}
+    if updated_at is not None and "received" in report:
+        sample["hub"] = max(0.0, report["received"] - updated_at * 1000)
+    if "transport" in report:
+        sample["transport"] = report["transport"] / 1000
+        sample["actuate"] = report["actuate"] / 1000
+    if "hub" in sample:
+        sample["total"] = sample["hub"] + sample["dispatch"] + sample.get("transport", 0.0) + sample.get("actuate", 0.0)
+    return sample
+
+
+def percentile(values, fraction):
+    if not values:
+        return float("nan")
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def summarise(name, samples, errors):
+    print(f"{name}: {len(samples)} measured, {len(errors)} failed" + (f" ({', '.join(sorted(set(errors)))})" if errors else ""))
+    print(f"    {'ms':<10}{'p50':>9}{'p90':>9}{'p99':>9}{'max':>9}")
+    for stage in STAGES:
+        values = [sample[stage] for sample in samples if stage in sample]
+        if values:
+            print(f"    {stage:<10}{statistics.median(values):>9.2f}{percentile(values, 0.9):>9.2f}"
+                  f"{percentile(values, 0.99):>9.2f}{max(values):>9.2f}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--hub-name", default=os.environ.get("DEVICE_TWIN_HUB_NAME"))
+    parser.add_argument("--authorization", default=os.environ.get("DEVICE_TWIN_AUTHORIZATION"),
+                        help="service SAS token with registry write and service connect")
+    parser.add_argument("--device", default=os.environ.get("DEVICE_TWIN_DEVICE_ID"))
+    parser.add_argument("--properties", default="LedBlinkRate,Relay1", help="comma separated controls, changed in turn")
+    parser.add_argument("--report", default="ControlLatency", help="the reported property the app passes lp_enableControlLatency")
+    parser.add_argument("--count", type=int, default=100, help="changes per property")
+    parser.add_argument("--interval", type=float, default=1.0, help="seconds between one report and the next change")
+    parser.add_argument("--timeout", type=float, default=30.0, help="seconds to wait for each report")
+    parser.add_argument("--poll-interval", type=float, default=0.2, help="seconds between reads of the reported properties")
+    parser.add_argument("--csv", help="write one row per change to this file")
+    args = parser.parse_args()
+
+    if not args.hub_name or not args.authorization or not args.device:
+        parser.error("hub name, authorization and device are required")
+
+    properties = [name for name in args.properties.split(",") if name]
+    url = twin_url(args.hub_name, args.device)
+    session = requests.Session()
+    session.headers.update({"Authorization": args.authorization, "Content-Type": "application/json"})
+    samples = {name: [] for name in properties}
+    errors = {name: [] for name in properties}
+
+    csv_file = open(args.csv, "w", newline="") if args.csv else None
+    writer = csv.writer(csv_file) if csv_file else None
+    if writer:
+        writer.writerow(["property", "value"] + [f"{stage}_ms" for stage in STAGES] + ["error"])
+
+    try:
+        for index in range(args.count):
+            for name in properties:
+                value = next_value(name, index)
+                try:
+                    sample = measure(session, url, args, name, value)
+                except requests.RequestException as error:
+                    sample = {"error": type(error).__name__}
+
+                if "error" in sample:
+                    errors[name].append(sample["error"])
+                else:
+                    samples[name].append(sample)
+                if writer:
+                    writer.writerow([name, value] + [f"{sample[stage]:.3f}" if stage in sample else "" for stage in STAGES]
+                                    + [sample.get("error", "")])
+                time.sleep(args.interval)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if csv_file:
+            csv_file.close()
+
+    for name in properties:
+        summarise(name, samples[name], errors[name])
+
+
+if __name__ == "__main__":
+    main()
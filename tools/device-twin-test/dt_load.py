@@ -0,0 +1,217 @@
+"""Concurrent device twin load generator.
+
+Patches desired properties on many devices at a fixed rate and measures the time until each
+device echoes the value back as a reported property, the Learning Path labs report every desired
+change straight back. Values are unique per patch so an echo identifies the patch it answers.
+A patch whose value is overtaken by a later one before it is echoed was coalesced by the device.
+
+    DEVICE_TWIN_HUB_NAME=myhub DEVICE_TWIN_AUTHORIZATION="SharedAccessSignature sr=..." \
+        python dt_load.py --devices dev1,dev2 --properties DesiredTemperature,DesiredHumidity \
+        --rate 4 --duration 60 --csv echoes.csv
+
+The devices default to DEVICE_TWIN_DEVICE_ID, as used by dt.py.
+"""
+
+import argparse
+import asyncio
+import csv
+import json
+import os
+import statistics
+import time
+from datetime import datetime, timezone
+
+import aiohttp
+
+API_VERSION = "2018-06-30"
+
+
+class PropertyState:
+    def __init__(self):
+        self.pending = {}  # value -> time the patch was accepted
+
+
+class DeviceStats:
+    def __init__(self, device_id, properties):
+        self.device_id = device_id
+        self.properties = {name: PropertyState() for name in properties}
+        self.sent = 0
+        self.accepted = 0
+        self.throttled = 0
+        self.failed = 0
+        self.echoed = 0
+        self.coalesced = 0
+        self.latencies = []  # seconds from patch accepted to the hub recording the echo
+
+
+def twin_url(hub_name, device_id):
+    return f"https://{hub_name}.azure-devices.net/twins/{device_id}?api-version={API_VERSION}"
+
+
+def parse_hub_time(text):
+    """IoT Hub $lastUpdated, seven fraction digits which fromisoformat does not take"""
+    if not text:
+        return None
+    main, _, fraction = text.rstrip("Z").partition(".")
+    stamp = datetime.fromisoformat(main).replace(tzinfo=timezone.utc).timestamp()
+    return stamp + (float("0." + fraction) if fraction else 0.0)
+
+
+async def send_patches(session, args, stats, sequence, semaphore, deadline):
+    """Patches every property of one device per tick, ticks paced to --rate"""
+    url = twin_url(args.hub_name, stats.device_id)
+    interval = 1.0 / args.rate
+    next_tick = time.monotonic()
+
+    while time.monotonic() < deadline:
+        desired = {}
+        for name in stats.properties:
+            desired[name] = {"value": next(sequence)}
+        body = json.dumps({"properties": {"desired": desired}})
+
+        async with semaphore:
+            stats.sent += 1
+            try:
+                async with session.patch(url, data=body) as response:
+                    accepted_at = time.time()
+                    if response.status == 200:
+                        stats.accepted += 1
+                        for name, entry in desired.items():
+                            stats.properties[name].pending[entry["value"]] = accepted_at
+                    elif response.status == 429:
+                        stats.throttled += 1
+                        next_tick += float(response.headers.get("Retry-After", 1))
+                    else:
+                        stats.failed += 1
+            except aiohttp.ClientError:
+                stats.failed += 1
+
+        next_tick += interval
+        await asyncio.sleep(max(0.0, next_tick - time.monotonic()))
+
+
+async def poll_echoes(session, args, stats, semaphore, stop, writer):
+    """Reads the reported properties, matching echoed values to the patches they answer, until stop is
+    set and every patch is answered or the drain time has passed"""
+    url = twin_url(args.hub_name, stats.device_id)
+
+    while True:
+        async with semaphore:
+            try:
+                async with session.get(url) as response:
+                    if response.status != 200:
+                        await asyncio.sleep(args.poll_interval)
+                        continue
+                    twin = await response.json()
+            except aiohttp.ClientError:
+                await asyncio.sleep(args.poll_interval)
+                continue
+
+        seen_at = time.time()
+        reported = twin.get("properties", {}).get("reported", {})
+        metadata = reported.get("$metadata", {})
+
+        for name, state in stats.properties.items():
+            value = reported.get(name)
+            if isinstance(value, dict):
+                value = value.get("value")
+            if value is None or value not in state.pending:
+                continue
+
+            sent_at = state.pending.pop(value)
+            # the hub's own time of the echo, or when this poll saw it if the metadata is missing
+            echoed_at = parse_hub_time(metadata.get(name, {}).get("$lastUpdated")) or seen_at
+            latency = max(0.0, echoed_at - sent_at)
+
+            # earlier patches still pending were overtaken before the device reported them
+            for older in [v for v, t in state.pending.items() if t <= sent_at]:
+                del state.pending[older]
+                stats.coalesced += 1
+
+            stats.echoed += 1
+            stats.latencies.append(latency)
+            if writer:
+                writer.writerow([stats.device_id, name, value, f"{sent_at:.3f}", f"{echoed_at:.3f}", f"{latency * 1000:.1f}"])
+
+        if stop.is_set() and (time.monotonic() > stop.drain_until or not any(state.pending for state in stats.properties.values())):
+            break
+        await asyncio.sleep(args.poll_interval)
+
+
+def percentile(values, fraction):
+    if not values:
+        return float("nan")
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def summarise(label, stats_list):
+    latencies = [latency for stats in stats_list for latency in stats.latencies]
+    total = lambda field: sum(getattr(stats, field) for stats in stats_list)
+    lost = sum(len(state.pending) for stats in stats_list for state in stats.properties.values())
+    ms = lambda value: f"{value * 1000:.0f}"
+
+    print(f"{label}: patches {total('sent')} accepted {total('accepted')} throttled {total('throttled')} "
+          f"failed {total('failed')} | echoed {total('echoed')} coalesced {total('coalesced')} unanswered {lost}")
+    if latencies:
+        print(f"    latency ms p50 {ms(statistics.median(latencies))} p90 {ms(percentile(latencies, 0.9))} "
+              f"p99 {ms(percentile(latencies, 0.99))} max {ms(max(latencies))}")
+
+
+async def run(args):
+    devices = [device for device in args.devices.split(",") if device]
+    properties = [name for name in args.properties.split(",") if name]
+    stats_list = [DeviceStats(device, properties) for device in devices]
+    headers = {"Authorization": args.authorization, "Content-Type": "application/json"}
+    semaphore = asyncio.Semaphore(args.max_in_flight)
+    stop = asyncio.Event()
+    # integers round trip through int and float bindings, a float binding reports them as n.000000
+    sequence = iter(range(int(time.time()) % 100000 * 1000, 1 << 31))
+
+    csv_file = open(args.csv, "w", newline="") if args.csv else None
+    writer = csv.writer(csv_file) if csv_file else None
+    if writer:
+        writer.writerow(["device", "property", "value", "sent_utc_s", "echoed_utc_s", "latency_ms"])
+
+    try:
+        async with aiohttp.ClientSession(headers=headers) as session:
+            deadline = time.monotonic() + args.duration
+            pollers = [asyncio.create_task(poll_echoes(session, args, stats, semaphore, stop, writer)) for stats in stats_list]
+            await asyncio.gather(*(send_patches(session, args, stats, sequence, semaphore, deadline) for stats in stats_list))
+
+            stop.drain_until = time.monotonic() + args.drain
+            stop.set()
+            await asyncio.gather(*pollers)
+    finally:
+        if csv_file:
+            csv_file.close()
+
+    for stats in stats_list:
+        summarise(stats.device_id, [stats])
+    if len(stats_list) > 1:
+        summarise("all devices", stats_list)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--hub-name", default=os.environ.get("DEVICE_TWIN_HUB_NAME"))
+    parser.add_argument("--authorization", default=os.environ.get("DEVICE_TWIN_AUTHORIZATION"),
+                        help="service SAS token with registry write and service connect")
+    parser.add_argument("--devices", default=os.environ.get("DEVICE_TWIN_DEVICE_ID", ""), help="comma separated device ids")
+    parser.add_argument("--properties", default="DesiredTemperature", help="comma separated desired properties set in every patch")
+    parser.add_argument("--rate", type=float, default=1.0, help="patches per second per device")
+    parser.add_argument("--duration", type=float, default=60.0, help="seconds to send patches for")
+    parser.add_argument("--max-in-flight", type=int, default=16, help="concurrent HTTP requests across all devices")
+    parser.add_argument("--poll-interval", type=float, default=0.5, help="seconds between reads of each device's reported properties")
+    parser.add_argument("--drain", type=float, default=30.0, help="seconds to keep waiting for echoes after the last patch")
+    parser.add_argument("--csv", help="write one row per echo to this file")
+    args = parser.parse_args()
+
+    if not args.hub_name or not args.authorization or not args.devices:
+        parser.error("hub name, authorization and at least one device are required")
+
+    asyncio.run(run(args))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,153 @@
+"""Memory use of a real-time app by region, read from the GNU ld map file the lab builds write.
+
+Lab_5 and Lab_6 link with -Wl,-Map, the map lands next to the image in the build directory. Each
+output section is put under the MEMORY region holding its address, TCM, SYSRAM or FLASH, and the
+largest input sections are listed so it is plain what to move when a region fills. TCM also holds
+the main stack, from the top down, so its free space is all the stack the app has.
+
+    python rt_memory_map.py out/ARM-Debug/FreeRTOS_RTcore_GPIO.map
+    python rt_memory_map.py --top 20 --region TCM demo_threadx.map
+    python rt_memory_map.py --compare tcm.map xip.map     # the layouts side by side
+
+See LearningPathLibrary/rtcore/memory_placement.h for LP_RT_HOT, LP_RT_COLD and the rest.
+"""
+
+import argparse
+import re
+import sys
+
+REGION_LINE = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(\S+))?\s*$")
+SECTION_LINE = re.compile(r"^ ?(\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(.*\S))?\s*$")
+
+
+def parse(path):
+    """Returns (regions, output sections, input sections). A region is (name, origin, length), a
+    section (name, address, size, object file), the object file None for an output section"""
+    with open(path) as f:
+        lines = f.read().splitlines()
+
+    regions = []
+    outputs = []
+    inputs = []
+    state = None
+    pending = None
+
+    for line in lines:
+        if line.startswith("Memory Configuration"):
+            state = "memory"
+            continue
+        if line.startswith("Linker script and memory map"):
+            state = "map"
+            continue
+
+        if state == "memory":
+            match = REGION_LINE.match(line)
+            if match and match.group(1) not in ("Name", "*default*"):
+                regions.append((match.group(1), int(match.group(2), 16), int(match.group(3), 16)))
+            continue
+
+        if state != "map" or not line.strip():
+            continue
+
+        # a long section name sits alone on its line, the address and size on the next
+        if pending is None and re.match(r"^ ?\.\S+$", line):
+            pending = line
+            continue
+        if pending is not None:
+            line = pending + line
+            pending = None
+
+        match = SECTION_LINE.match(line)
+        if not match or match.group(1) is None:
+            continue
+        name, address, size = match.group(1), int(match.group(2), 16), int(match.group(3), 16)
+        if address == 0 or size == 0:
+            continue
+        if line.startswith(" "):
+            inputs.append((name, address, size, match.group(4)))
+        elif not name.startswith("LOAD") and not name.startswith("OUTPUT"):
+            outputs.append((name, address, size, None))
+
+    return regions, outputs, inputs
+
+
+def region_of(regions, address):
+    for name, origin, length in regions:
+        if origin <= address < origin + length:
+            return name
+    return None
+
+
+def report(path, top, only_region):
+    regions, outputs, inputs = parse(path)
+    if not regions:
+        sys.exit(f"{path}: no Memory Configuration, not a GNU ld map file")
+
+    used = {name: 0 for name, _, _ in regions}
+    print(f"{path}\n")
+    print(f"{'region':<10}{'used':>10}{'free':>10}{'size':>10}   use")
+    for name, address, size, _ in outputs:
+        region = region_of(regions, address)
+        if region is not None:
+            used[region] += size
+    for name, origin, length in regions:
+        if only_region and name != only_region:
+            continue
+        share = used[name] / length if length else 0
+        bar = "#" * round(share * 30)
+        print(f"{name:<10}{used[name]:>10}{length - used[name]:>10}{length:>10}   {bar:<30} {share:.0%}")
+
+    print(f"\n{'section':<24}{'region':<10}{'address':>12}{'size':>10}")
+    for name, address, size, _ in outputs:
+        region = region_of(regions, address)
+        if region is None or (only_region and region != only_region):
+            continue
+        print(f"{name:<24}{region:<10}{address:>#12x}{size:>10}")
+
+    if top:
+        listed = [s for s in inputs if not only_region or region_of(regions, s[1]) == only_region]
+        listed.sort(key=lambda s: s[2], reverse=True)
+        print(f"\nlargest {min(top, len(listed))} input sections")
+        for name, address, size, obj in listed[:top]:
+            print(f"{size:>8}  {region_of(regions, address) or '?':<8}{name:<28}{obj or ''}")
+
+    return {name: used[name] for name, _, _ in regions}
+
+
+def compare(paths):
+    totals = []
+    for path in paths:
+        regions, outputs, _ = parse(path)
+        used = {name: 0 for name, _, _ in regions}
+        for _, address, size, _ in outputs:
+            region = region_of(regions, address)
+            if region is not None:
+                used[region] += size
+        totals.append((path, regions, used))
+
+    names = [name for name, _, _ in totals[0][1]]
+    print(f"{'region':<10}" + "".join(f"{path[-24:]:>26}" for path, _, _ in totals))
+    for name in names:
+        print(f"{name:<10}" + "".join(f"{used.get(name, 0):>26}" for _, _, used in totals))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("maps", nargs="+", help="map files written by -Wl,-Map")
+    parser.add_argument("--top", type=int, default=10, help="largest input sections to list, 0 for none")
+    parser.add_argument("--region", help="only this region, TCM, SYSRAM or FLASH")
+    parser.add_argument("--compare", action="store_true", help="used bytes per region of each map, side by side")
+    args = parser.parse_args()
+
+    if args.compare:
+        compare(args.maps)
+        return
+
+    for index, path in enumerate(args.maps):
+        if index:
+            print()
+        report(path, args.top, args.region)
+
+
+if __name__ == "__main__":
+    main()
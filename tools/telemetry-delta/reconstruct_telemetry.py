@@ -0,0 +1,119 @@
+"""Rebuild whole readings from the Learning Path library's send-on-change telemetry.
+
+A device sending with lp_sendTelemetryDelta, see LearningPathLibrary/telemetry_delta.h, sends a keyframe
+with every field and, between keyframes, only the fields that moved past their deadband:
+
+    {"seq":40,"key":true,"Temperature":21.5,"Humidity":45.2,"Pressure":1013.2,"Light":310}
+    {"seq":41,"Temperature":21.7}
+
+Each message applied to a Reconstructor gives the reading as the device had it, the fields left out carried
+from the messages before. seq counts the device's messages, so a gap means a delta went missing and the
+reading is marked stale until the next keyframe. A device restarts seq at 1 with a keyframe.
+
+    python reconstruct_telemetry.py messages.jsonl               # CSV to stdout
+    python reconstruct_telemetry.py --json messages.jsonl
+    az iot hub monitor-events -n myhub --output json | python reconstruct_telemetry.py --device-field device -
+
+Input is one JSON object per line, the message body, or with --device-field an envelope holding the device id
+and the body under "payload" as az iot hub monitor-events prints it. CBOR bodies decode with cbor2 to the same
+dict. Use Reconstructor from cloud code, an Azure Function or a stream job, one per device.
+"""
+
+import argparse
+import csv
+import json
+import sys
+
+SEQUENCE_FIELD = "seq"
+KEYFRAME_FIELD = "key"
+SEQUENCE_MODULO = 1 << 32
+
+
+class Reconstructor:
+    def __init__(self):
+        self.fields = {}
+        self.sequence = None
+        self.stale = True       # until the first keyframe
+        self.gaps = 0
+        self.messages = 0
+
+    def apply(self, body):
+        """Returns (seq, {field: value}, stale) for the message, the fields of the whole reading"""
+        sequence = body.get(SEQUENCE_FIELD)
+        keyframe = bool(body.get(KEYFRAME_FIELD, False))
+        values = {k: v for k, v in body.items() if k not in (SEQUENCE_FIELD, KEYFRAME_FIELD)}
+
+        if keyframe:
+            self.fields = dict(values)
+            self.stale = False
+        else:
+            if self.sequence is not None and sequence is not None and sequence != (self.sequence + 1) % SEQUENCE_MODULO:
+                self.gaps += 1
+                self.stale = True
+            self.fields.update(values)
+
+        self.sequence = sequence
+        self.messages += 1
+        return sequence, dict(self.fields), self.stale
+
+
+def read_messages(stream, device_field):
+    """Yields (device, body) for each line, the device None without device_field"""
+    for line in stream:
+        line = line.strip()
+        if not line:
+            continue
+        message = json.loads(line)
+        if device_field is None:
+            yield None, message
+            continue
+        body = message.get("payload", message)
+        if isinstance(body, str):
+            body = json.loads(body)
+        yield message.get(device_field), body
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("messages", help="file of JSON lines, - for stdin")
+    parser.add_argument("--json", action="store_true", help="JSON lines of readings instead of CSV")
+    parser.add_argument("--device-field", help="envelope field naming the device, the body under payload")
+    args = parser.parse_args()
+
+    stream = sys.stdin if args.messages == "-" else open(args.messages, encoding="utf-8")
+    devices = {}
+    rows = []
+    names = []
+    delta_bytes = 0
+    full_bytes = 0
+
+    with stream:
+        for device, body in read_messages(stream, args.device_field):
+            reconstructor = devices.setdefault(device, Reconstructor())
+            sequence, fields, stale = reconstructor.apply(body)
+            for name in fields:
+                if name not in names:
+                    names.append(name)
+            rows.append((device, sequence, stale, fields))
+            delta_bytes += len(json.dumps(body, separators=(",", ":")))
+            full_bytes += len(json.dumps(dict(fields, **{SEQUENCE_FIELD: sequence}), separators=(",", ":")))
+
+            if args.json:
+                record = dict(fields, seq=sequence, stale=stale)
+                if device is not None:
+                    record["device"] = device
+                print(json.dumps(record))
+
+    if not args.json:
+        writer = csv.writer(sys.stdout)
+        writer.writerow(["device", "seq", "stale"] + names)
+        for device, sequence, stale, fields in rows:
+            writer.writerow([device or "", sequence, int(stale)] + [fields.get(name, "") for name in names])
+
+    gaps = sum(r.gaps for r in devices.values())
+    print(f"{len(rows)} messages, {gaps} gaps, {delta_bytes} bytes sent against {full_bytes} as whole readings",
+          file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,130 @@
+"""Expand the Learning Path compact telemetry back to the IoT Central template's field names.
+
+A device built with compact telemetry, see tools/dcm-codegen, sends the template's telemetry with short keys
+and the dictionary version as the dict message property, and reports the dictionary once as the
+TelemetryDictionary twin property:
+
+    {"a":21.50,"b":45.20,"c":1013.20,"d":40}                      dict=a321b580
+    TelemetryDictionary "a321b580 a:Temperature,b:Humidity,c:Pressure,d:MsgId"
+
+Each message applied to an Expander gets its full names back. Keys outside the dictionary, sampledAt for one,
+pass through, and so do messages without a dict property. A message whose version is not known is left as
+sent and counted, a device on a newer template needs its dictionary added first.
+
+    python expand_telemetry.py --dcm ../../iot_central/Azure_Sphere_Developer_Learning_Path.json messages.jsonl
+    python expand_telemetry.py --dictionary dcm_model.dictionary.json messages.jsonl
+    az iot hub monitor-events -n myhub --properties app --output json | \\
+        python expand_telemetry.py --twin "a321b580 a:Temperature,b:Humidity,c:Pressure,d:MsgId" -
+
+Input is one JSON object per line, the body, or an envelope as az iot hub monitor-events prints it with the body
+under "payload" and the dict property under "properties"."application". Output is one JSON object per line.
+Use Expander from cloud code, an Azure Function or a stream job, ahead of whatever reads the field names.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+DICTIONARY_PROPERTY = "dict"
+
+
+def parse_twin(text):
+    """The TelemetryDictionary property, "<version> a:Name,b:Name", as (version, {key: name})"""
+    version, _, pairs = text.strip().partition(" ")
+    keys = {}
+    for pair in pairs.split(","):
+        key, separator, name = pair.partition(":")
+        if separator:
+            keys[key] = name
+    return version, keys
+
+
+def from_dcm(path):
+    """The dictionary dcm_codegen.py builds into the device for this template"""
+    sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "dcm-codegen"))
+    import dcm_codegen
+
+    telemetry, _ = dcm_codegen.load_model(path)
+    dictionary = dcm_codegen.dictionary(telemetry)
+    return dictionary["version"], dictionary["keys"]
+
+
+class Expander:
+    def __init__(self):
+        self.dictionaries = {}
+        self.expanded = 0
+        self.unknown = 0
+
+    def add(self, version, keys):
+        self.dictionaries[version] = dict(keys)
+
+    def expand(self, body, version):
+        """Returns the body with its full names, unchanged for no version or one not known"""
+        if version is None:
+            return body
+        keys = self.dictionaries.get(version)
+        if keys is None:
+            self.unknown += 1
+            return body
+        self.expanded += 1
+        return {keys.get(key, key): value for key, value in body.items()}
+
+
+def read_messages(stream):
+    """Yields (body, version, envelope) for each line, the envelope None for a bare body"""
+    for line in stream:
+        line = line.strip()
+        if not line:
+            continue
+        message = json.loads(line)
+        if "payload" not in message:
+            yield message, None, None
+            continue
+        body = message["payload"]
+        if isinstance(body, str):
+            body = json.loads(body)
+        application = message.get("properties", {}).get("application", {})
+        yield body, application.get(DICTIONARY_PROPERTY), message
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("messages", help="file of JSON lines, - for stdin")
+    parser.add_argument("--dcm", action="append", default=[], help="IoT Central device template the device was built from")
+    parser.add_argument("--dictionary", action="append", default=[], help="dictionary JSON dcm_codegen.py --dictionary wrote")
+    parser.add_argument("--twin", action="append", default=[], help="TelemetryDictionary property value the device reported")
+    parser.add_argument("--version", help="dict version of bare bodies, which carry no properties")
+    args = parser.parse_args()
+
+    expander = Expander()
+    for path in args.dcm:
+        expander.add(*from_dcm(path))
+    for path in args.dictionary:
+        with open(path, encoding="utf-8") as f:
+            dictionary = json.load(f)
+        expander.add(dictionary["version"], dictionary["keys"])
+    for text in args.twin:
+        expander.add(*parse_twin(text))
+    if not expander.dictionaries:
+        parser.error("give the dictionary with --dcm, --dictionary or --twin")
+
+    stream = sys.stdin if args.messages == "-" else open(args.messages, encoding="utf-8")
+    compact_bytes = 0
+    full_bytes = 0
+
+    with stream:
+        for body, version, envelope in read_messages(stream):
+            expanded = expander.expand(body, version if envelope is not None else args.version)
+            compact_bytes += len(json.dumps(body, separators=(",", ":")))
+            full_bytes += len(json.dumps(expanded, separators=(",", ":")))
+            if envelope is not None:
+                envelope = dict(envelope, payload=expanded)
+            print(json.dumps(envelope if envelope is not None else expanded))
+
+    print(f"{expander.expanded} messages expanded, {expander.unknown} with an unknown dictionary, "
+          f"{compact_bytes} bytes sent against {full_bytes} with the full names", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,143 @@
+"""Per-hop latency of traced telemetry, read from the IoT Hub Event Hub-compatible endpoint.
+
+A device tracing its readings, lp_setInterCoreTraceSampling and lp_traceNextMessage in the Learning
+Path library, adds an lp-trace property to every traced message:
+
+    id=12;wait=40;sample=310;transport=95;dispatch=20;handler=1800;sent=1760000000123;ack=11:84000
+
+All hops are microseconds, in the order a reading travels:
+
+    wait        real-time app, the request arriving to the sensor sample
+    sample      the sample to the inter-core frame write (EnqueueData)
+    transport   the frame write to the A7 ProcessMsg, half the request round trip less the real-time app's share
+    dispatch    ProcessMsg to the application's inter-core handler
+    handler     the handler to lp_sendMsg, deferred work and formatting included
+    hub         lp_sendMsg to iothub-enqueuedtime, device UTC against hub UTC so only as good as the device clock
+    confirm     lp_sendMsg to the SDK confirmation, carried by the device's next traced message as ack
+
+    TELEMETRY_TRACE_CONNECTION_STRING="Endpoint=sb://...;EntityPath=myhub" \\
+        python trace_latency.py --duration 600 --csv hops.csv
+"""
+
+import argparse
+import csv
+import os
+import statistics
+import time
+
+from azure.eventhub import EventHubConsumerClient
+
+TRACE_PROPERTY = b"lp-trace"
+HOPS = ["wait", "sample", "transport", "dispatch", "handler", "hub", "confirm"]
+
+
+def parse_trace(text):
+    fields = {}
+    for item in text.split(";"):
+        key, _, value = item.partition("=")
+        fields[key] = value
+    return fields
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+class TraceCollector:
+    def __init__(self, writer):
+        self.writer = writer
+        self.traces = {}  # (device, id) -> hop name -> microseconds
+        self.hops = {name: [] for name in HOPS}
+        self.totals = []  # wait through hub, the sample to the hub enqueuing the message
+        self.malformed = 0
+
+    def add(self, device, property_text, enqueued_ms):
+        fields = parse_trace(property_text)
+        try:
+            trace_id = int(fields["id"])
+            hops = {name: int(fields[name]) for name in HOPS[:5]}
+            hops["hub"] = max(0, int((enqueued_ms - int(fields["sent"])) * 1000)) if enqueued_ms is not None else None
+        except (KeyError, ValueError):
+            self.malformed += 1
+            return
+
+        self.traces[(device, trace_id)] = hops
+        for name, value in hops.items():
+            if value is not None:
+                self.hops[name].append(value)
+        if hops["hub"] is not None:
+            self.totals.append(sum(hops[name] for name in HOPS[:6]))
+
+        # the confirmation of an earlier traced message from the same device
+        ack_id, _, ack_us = fields.get("ack", "").partition(":")
+        if ack_id.isdigit() and ack_us.isdigit():
+            self.hops["confirm"].append(int(ack_us))
+            acked = self.traces.get((device, int(ack_id)))
+            if acked is not None:
+                acked["confirm"] = int(ack_us)
+
+        if self.writer:
+            self.writer.writerow([device, trace_id] + ["" if hops.get(name) is None else hops[name] for name in HOPS[:6]])
+
+    def summarise(self):
+        ms = lambda value: f"{value / 1000:.2f}"
+        print(f"traced messages {len(self.traces)} malformed {self.malformed}")
+        print(f"{'hop':<10} {'count':>6} {'p50 ms':>9} {'p90 ms':>9} {'p99 ms':>9} {'max ms':>9}")
+        for name, values in list(self.hops.items()) + [("total", self.totals)]:
+            if values:
+                print(f"{name:<10} {len(values):>6} {ms(statistics.median(values)):>9} {ms(percentile(values, 0.9)):>9} "
+                      f"{ms(percentile(values, 0.99)):>9} {ms(max(values)):>9}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--connection-string", default=os.environ.get("TELEMETRY_TRACE_CONNECTION_STRING"),
+                        help="Event Hub-compatible endpoint of the IoT Hub, with EntityPath")
+    parser.add_argument("--consumer-group", default="$Default")
+    parser.add_argument("--duration", type=float, default=300.0, help="seconds to collect for")
+    parser.add_argument("--from-start", action="store_true", help="read the events retained by the hub, not only new ones")
+    parser.add_argument("--csv", help="write one row per traced message to this file")
+    args = parser.parse_args()
+
+    if not args.connection_string:
+        parser.error("the Event Hub-compatible connection string is required")
+
+    csv_file = open(args.csv, "w", newline="") if args.csv else None
+    writer = csv.writer(csv_file) if csv_file else None
+    if writer:
+        writer.writerow(["device", "id"] + [f"{name}_us" for name in HOPS[:6]])
+
+    collector = TraceCollector(writer)
+    client = EventHubConsumerClient.from_connection_string(args.connection_string, consumer_group=args.consumer_group)
+    deadline = time.monotonic() + args.duration
+
+    def on_event(partition_context, event):
+        if event is None:
+            if time.monotonic() > deadline:
+                client.close()
+            return
+
+        trace = event.properties.get(TRACE_PROPERTY) if event.properties else None
+        if trace is not None:
+            device = event.system_properties.get(b"iothub-connection-device-id", b"").decode()
+            enqueued = event.enqueued_time.timestamp() * 1000 if event.enqueued_time else None
+            collector.add(device, trace.decode() if isinstance(trace, bytes) else trace, enqueued)
+
+        if time.monotonic() > deadline:
+            client.close()
+
+    try:
+        with client:
+            client.receive(on_event=on_event, starting_position="-1" if args.from_start else "@latest", max_wait_time=1)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if csv_file:
+            csv_file.close()
+
+    collector.summarise()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,135 @@
+"""Decode the Learning Path library's time series blocks, contentType application/vnd.lp-timeseries.
+
+A device fills an LP_TIMESERIES_BLOCK with lp_timeseriesAppend and sends it with lp_sendTimeseries.
+Timestamps are delta of delta encoded and each float channel is XOR encoded against its previous
+value, the Gorilla scheme, see LearningPathLibrary/timeseries.h for the bit layout.
+
+    python decode_timeseries.py block.bin                  # CSV to stdout
+    python decode_timeseries.py --json block.bin
+    python decode_timeseries.py --hex 4c540102...          # a body copied from a message viewer
+
+Use decode() from cloud code, an Azure Function or a stream job, on the raw message body.
+"""
+
+import argparse
+import csv
+import json
+import struct
+import sys
+
+MAGIC = b"LT"
+VERSION = 1
+NO_WINDOW = None
+
+
+class BitReader:
+    def __init__(self, data, bit_offset=0):
+        self.data = data
+        self.position = bit_offset
+
+    def read(self, count):
+        value = 0
+        for _ in range(count):
+            byte = self.data[self.position >> 3]
+            value = (value << 1) | ((byte >> (7 - (self.position & 7))) & 1)
+            self.position += 1
+        return value
+
+    def read_signed(self, count):
+        value = self.read(count)
+        return value - (1 << count) if value & (1 << (count - 1)) else value
+
+
+def to_float(bits):
+    return struct.unpack(">f", struct.pack(">I", bits))[0]
+
+
+def decode(body):
+    """Returns (channel names, [(timestamp_ms, [values...]), ...])"""
+    if len(body) < 6 or body[:2] != MAGIC:
+        raise ValueError("not a time series block")
+    if body[2] != VERSION:
+        raise ValueError(f"unsupported time series version {body[2]}")
+
+    channel_count = body[3]
+    count = (body[4] << 8) | body[5]
+    offset = 6
+    names = []
+    for _ in range(channel_count):
+        length = body[offset]
+        names.append(body[offset + 1:offset + 1 + length].decode("utf-8"))
+        offset += 1 + length
+
+    reader = BitReader(body, offset * 8)
+    samples = []
+    timestamp = delta = 0
+    values = [0] * channel_count
+    windows = [NO_WINDOW] * channel_count  # (leading, trailing)
+
+    for index in range(count):
+        if index == 0:
+            timestamp = reader.read_signed(64)
+            values = [reader.read(32) for _ in range(channel_count)]
+        else:
+            if reader.read(1) == 0:
+                delta_of_delta = 0
+            elif reader.read(1) == 0:
+                delta_of_delta = reader.read_signed(7)
+            elif reader.read(1) == 0:
+                delta_of_delta = reader.read_signed(9)
+            elif reader.read(1) == 0:
+                delta_of_delta = reader.read_signed(12)
+            else:
+                delta_of_delta = reader.read_signed(32)
+            delta += delta_of_delta
+            timestamp += delta
+
+            for channel in range(channel_count):
+                if reader.read(1) == 0:
+                    continue
+                if reader.read(1) == 0:
+                    if windows[channel] is NO_WINDOW:
+                        raise ValueError("value reuses a window that was never set")
+                    leading, trailing = windows[channel]
+                else:
+                    leading = reader.read(5)
+                    length = reader.read(5) + 1
+                    trailing = 32 - leading - length
+                    windows[channel] = (leading, trailing)
+                meaningful = reader.read(32 - leading - trailing)
+                values[channel] ^= meaningful << trailing
+
+        samples.append((timestamp, [to_float(bits) for bits in values]))
+
+    return names, samples
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("block", help="file holding the message body, or hex digits with --hex")
+    parser.add_argument("--hex", action="store_true", help="the argument is the body as hex")
+    parser.add_argument("--json", action="store_true", help="JSON array of samples instead of CSV")
+    args = parser.parse_args()
+
+    if args.hex:
+        body = bytes.fromhex(args.block)
+    else:
+        with open(args.block, "rb") as f:
+            body = f.read()
+
+    names, samples = decode(body)
+
+    if args.json:
+        json.dump([dict(timestamp=t, **dict(zip(names, v))) for t, v in samples], sys.stdout)
+        print()
+    else:
+        writer = csv.writer(sys.stdout)
+        writer.writerow(["timestamp"] + names)
+        for timestamp, values in samples:
+            writer.writerow([timestamp] + [f"{v:.6g}" for v in values])
+
+    print(f"{len(samples)} samples, {len(body)} bytes, {len(body) / max(1, len(samples)):.1f} bytes per sample", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()